@@ -109,6 +109,26 @@ class GenMlirLazyIr(torchgen.dest.GenLazyIR):
         )
 
 
+@dataclass(frozen=True)
+class GenMlirLazyNativeFuncDefinition(torchgen.dest.GenLazyNativeFuncDefinition):
+    def shape_inference(self, func, schema: LazyIrSchema) -> str:
+        # Run the upstream shape inference through the shape cache, keyed by
+        # the op and its (non-generator) arguments.
+        key_args = "".join(
+            f", {a.name}" for a in schema.filtered_args(generator=False)
+        )
+        return reindent(
+            f"""
+            std::vector<torch::lazy::Shape> shapes =
+                torch::lazy::ComputeShapesCached("{func.func.name}", [&]() {{
+                  {super().shape_inference(func, schema).strip()}
+                  return shapes;
+                }}{key_args});
+            """,
+            "        ",
+        )
+
+
 class GenTorchMlirLTC:
     def __init__(self, binary_dir):
         self.script_path = Path(__file__).resolve()
@@ -399,6 +419,8 @@ class GenTorchMlirLTC:
                 #include <torch/csrc/lazy/core/shape_inference.h>
                 #include <vector>
 
+                #include "base_lazy_backend/shape_cache.h"
+
                 namespace torch {{
                 namespace lazy {{
 
@@ -494,6 +516,7 @@ class GenTorchMlirLTC:
             create_aten_from_ltc_tensor="CreateFunctionalizedAtenFromLtcTensor",
             shape_inference_hdr=str(self.generated_path.joinpath("shape_inference.h")),
             lazy_ir_generator=GenMlirLazyIr,
+            native_func_definition_generator=GenMlirLazyNativeFuncDefinition,
         )
 
     def __call__(self):
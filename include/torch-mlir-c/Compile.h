@@ -0,0 +1,67 @@
+//===-- torch-mlir-c/Compile.h - C API for batch compilation ------*- C -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM
+// Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TORCHMLIR_C_COMPILE_H
+#define TORCHMLIR_C_COMPILE_H
+
+#include "mlir-c/Support.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//===----------------------------------------------------------------------===//
+// Compiler pool.
+//===----------------------------------------------------------------------===//
+
+/// A thread pool with one context per thread, in which all dialects of
+/// torch-mlir are registered and loaded up front. Each context keeps the pass
+/// managers of the pipelines that it ran, so that their passes are only
+/// initialized, e.g. parse the abstract interpretation library and freeze
+/// their patterns, once per context.
+typedef struct {
+  void *ptr;
+} TorchMlirCompilerPool;
+
+/// Creates a pool of `numThreads` threads, or of one thread per hardware
+/// thread if `numThreads` is 0. The passes of the pipelines that it runs must
+/// have been registered, e.g. with `torchMlirRegisterAllPasses`.
+MLIR_CAPI_EXPORTED TorchMlirCompilerPool
+torchMlirCompilerPoolCreate(intptr_t numThreads);
+
+/// Destroys `pool`, after the compilations running in it have finished.
+MLIR_CAPI_EXPORTED void
+torchMlirCompilerPoolDestroy(TorchMlirCompilerPool pool);
+
+/// Receives the result of the module at `index` of a batch: its bytecode
+/// after the pipeline, or the diagnostics that the compilation emitted if it
+/// failed.
+typedef void (*TorchMlirCompileBatchCallback)(intptr_t index,
+                                              MlirLogicalResult result,
+                                              MlirStringRef output,
+                                              void *userData);
+
+/// Parses each of the `numModules` `modules`, given as MLIR bytecode or text,
+/// runs the textual `pipeline` on it and writes it as bytecode, on the
+/// threads of `pool`. The modules are independent, so they are compiled
+/// concurrently, each in the context of the thread that picks it up.
+///
+/// `callback` is called once per module, in order, on the calling thread
+/// once all of them are compiled. Returns failure if any of them failed.
+MLIR_CAPI_EXPORTED MlirLogicalResult torchMlirCompileBatch(
+    TorchMlirCompilerPool pool, MlirStringRef pipeline, intptr_t numModules,
+    const MlirStringRef *modules, TorchMlirCompileBatchCallback callback,
+    void *userData);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TORCHMLIR_C_COMPILE_H
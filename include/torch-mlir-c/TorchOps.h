@@ -32,6 +32,41 @@ MLIR_CAPI_EXPORTED MlirValue torchMlirAdjustStaticInformation(
     MlirBlock block, MlirOperation insertBefore, MlirValue value,
     MlirType desiredType, bool userAllowsRefinement);
 
+//===----------------------------------------------------------------------===//
+// Batched construction.
+//===----------------------------------------------------------------------===//
+
+/// Describes one operation for `torchMlirBlockAppendOperations`. Operands are
+/// given as indices into the value table of that call.
+typedef struct {
+  MlirStringRef name;
+  MlirLocation location;
+  intptr_t numOperands;
+  const intptr_t *operandIndices;
+  intptr_t numResults;
+  const MlirType *resultTypes;
+  intptr_t numAttributes;
+  const MlirNamedAttribute *attributes;
+} TorchMlirOperationSpec;
+
+/// Builds `numOperations` operations and appends them to `block` in order,
+/// avoiding a C API round trip per operation for importers that build large
+/// graphs.
+///
+/// Operands refer to a value table that starts with the `numValues` values in
+/// `values` and is extended with the results of each operation as it is
+/// built, so an operation may use the results of any operation before it.
+/// `results` must have room for the results of all operations and receives
+/// them in the same order.
+///
+/// If an operand index is out of range, emits an error at the location of
+/// the offending operation, erases the operations built so far and returns
+/// failure.
+MLIR_CAPI_EXPORTED MlirLogicalResult torchMlirBlockAppendOperations(
+    MlirBlock block, intptr_t numValues, const MlirValue *values,
+    intptr_t numOperations, const TorchMlirOperationSpec *operations,
+    MlirValue *results);
+
 #ifdef __cplusplus
 }
 #endif
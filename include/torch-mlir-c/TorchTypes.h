@@ -251,6 +251,12 @@ MLIR_CAPI_EXPORTED MlirType torchMlirTorchNonValueTensorTypeGet(
     MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
     MlirType optionalDtype);
 
+/// Gets a !torch.tensor type with a sparsity encoding, which may be null.
+/// The other arguments are as for `torchMlirTorchNonValueTensorTypeGet`.
+MLIR_CAPI_EXPORTED MlirType torchMlirTorchNonValueTensorTypeGetWithSparsity(
+    MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
+    MlirType optionalDtype, MlirAttribute optionalSparsity);
+
 /// Gets the !torch.tensor type with the least static information.
 MLIR_CAPI_EXPORTED MlirType
 torchMlirTorchNonValueTensorTypeGetWithLeastStaticInformation(
@@ -299,6 +305,12 @@ MLIR_CAPI_EXPORTED MlirType torchMlirTorchValueTensorTypeGet(
     MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
     MlirType optionalDtype);
 
+/// Gets a !torch.vtensor type with a sparsity encoding, which may be null.
+/// The other arguments are as for `torchMlirTorchValueTensorTypeGet`.
+MLIR_CAPI_EXPORTED MlirType torchMlirTorchValueTensorTypeGetWithSparsity(
+    MlirContext context, intptr_t numSizes, const int64_t *optionalSizes,
+    MlirType optionalDtype, MlirAttribute optionalSparsity);
+
 /// Gets the !torch.tensor type with the least static information.
 MLIR_CAPI_EXPORTED MlirType
 torchMlirTorchValueTensorTypeGetWithLeastStaticInformation(MlirContext context);
@@ -0,0 +1,28 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TORCH_MLIR_DIALECTS_DIALECT_TMTENSOR_IR_TILINGINTERFACEIMPL_H_
+#define TORCH_MLIR_DIALECTS_DIALECT_TMTENSOR_IR_TILINGINTERFACEIMPL_H_
+
+namespace mlir {
+class DialectRegistry;
+
+namespace torch {
+namespace TMTensor {
+
+/// Registers external models of the upstream `TilingInterface` for the
+/// TMTensor ops, so that the tile-and-fuse transformations can tile them and
+/// fuse them with their producers.
+void registerTilingInterfaceExternalModels(DialectRegistry &registry);
+
+} // namespace TMTensor
+} // namespace torch
+} // namespace mlir
+
+#endif // TORCH_MLIR_DIALECTS_DIALECT_TMTENSOR_IR_TILINGINTERFACEIMPL_H_
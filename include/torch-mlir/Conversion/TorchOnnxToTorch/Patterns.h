@@ -471,7 +471,9 @@ public:
   /// default domain, this is the canonical ONNX operator name (i.e.
   /// "Acos").
   /// Multiple conversions can be registered for the same op, most
-  /// commonly differing by their `sinceVersion`.
+  /// commonly differing by their `sinceVersion`. They are tried in the
+  /// order they are registered, and those with a `sinceVersion` above the
+  /// domain version are dropped here rather than skipped on every op.
   void onOp(StringRef name, int64_t sinceVersion, HandlerFn callback);
   void onOp(StringRef name, int64_t sinceVersion,
             HandlerFnWithOptions callback);
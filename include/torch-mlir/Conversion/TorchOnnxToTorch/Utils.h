@@ -132,6 +132,18 @@ LogicalResult createDequantizeTensor(ConversionPatternRewriter &rewriter,
                                      Location loc, Value input, Value scale,
                                      Value zeroPoint, Value &output);
 
+/// Evaluates `value`, a signed 0-D or 1-D integer tensor, when it is computed
+/// from constants and static shapes by the ops of ONNX shape computations:
+/// Constant, Shape, Gather, Unsqueeze, Squeeze, Concat and Cast.
+LogicalResult evaluateConstantIntTensor(Value value,
+                                        SmallVectorImpl<int64_t> &values);
+
+/// Replaces the op of `binder` with a literal when its result has a static
+/// shape and `evaluateConstantIntTensor` evaluates it, so that shape
+/// computations on static shapes are folded while they are converted.
+LogicalResult foldConstantIntTensor(OpBinder binder,
+                                    ConversionPatternRewriter &rewriter);
+
 } // namespace mlir::torch::onnx_c
 
 #endif // TORCHMLIR_CONVERSION_TORCHONNXTOTORCH_UTILS_H
@@ -24,7 +24,19 @@ namespace torch {
 std::unique_ptr<OperationPass<func::FuncOp>> createConvertTorchToLinalgPass();
 
 std::unique_ptr<OperationPass<func::FuncOp>>
-createConvertTorchToLinalgPass(bool allowNonFinites);
+createConvertTorchToLinalgPass(bool allowNonFinites,
+                               bool channelsLastConv = false,
+                               StringRef convStrategy = "direct",
+                               bool fuseElementwise = false,
+                               int64_t splitReductionFactor = 0,
+                               StringRef rng = "squares",
+                               bool concatInPlace = false,
+                               bool separablePooling = false,
+                               bool decomposeZeroPoints = false,
+                               bool subPixelConvTranspose = false,
+                               bool convBackwardGemm = false,
+                               bool foldWindowPadding = false,
+                               bool transposedMatmulOperands = false);
 
 } // namespace torch
 } // namespace mlir
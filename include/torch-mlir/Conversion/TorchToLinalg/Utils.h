@@ -38,6 +38,23 @@ Value getDynamicZeroPaddedTensor(Operation *op, OpBuilder &b, Value &input,
                                  SmallVectorImpl<Value> &padding,
                                  int unpaddedDims = 0, Value pad = {});
 
+// How `getIndexPaddedTensor` fills the padding: with the input reflected
+// through its border, which is not repeated, or with the border replicated.
+enum class IndexPaddingMode { Reflect, Replicate };
+
+// Pads the trailing dims of `input` by `padInts`, which holds the low and high
+// padding of each of them from the last one, as in PyTorch. The result is a
+// single `linalg.generic` reading, for each of its elements, the element of
+// the input at the reflected or clamped index.
+Value getIndexPaddedTensor(OpBuilder &b, Location loc, Value input,
+                           ArrayRef<int64_t> padInts, IndexPaddingMode mode);
+
+// Creates a tensor of `sizes` with all of its elements `value`, as a
+// `linalg.generic` without inputs rather than a `linalg.fill`, so that
+// elementwise fusion fuses it into its consumers.
+Value createSplatTensor(OpBuilder &b, Location loc,
+                        ArrayRef<OpFoldResult> sizes, Value value);
+
 // Helper function to caculate the output tensor dims for convolution-like ops.
 // Along each dim:
 // dim_out =
@@ -77,11 +94,24 @@ Value createReductionLinalgGeneric(
     function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild);
 
 // Create a pointwise operation that uses values in `tensorOperands`, such that
-// the element type of the resulting tensor is `resultElementType`.
+// the element type of the resulting tensor is `resultElementType`. Broadcasts
+// are expressed in the indexing maps only. The static sizes of
+// `resultShapeHint`, if given, are used for the result even when no operand
+// has them, which allows operands to be broadcast to sizes they only have
+// after an `aten.broadcast_to`.
 Value createElementwiseLinalgGeneric(
     OpBuilder &b, Location loc, ValueRange tensorOperands,
     Type resultElementType,
-    function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild);
+    function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild,
+    ArrayRef<int64_t> resultShapeHint = {});
+
+// Same as above, with one result per element type in `resultElementTypes`,
+// all of the broadcasted shape of `tensorOperands`.
+SmallVector<Value> createElementwiseLinalgGeneric(
+    OpBuilder &b, Location loc, ValueRange tensorOperands,
+    TypeRange resultElementTypes,
+    function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild,
+    ArrayRef<int64_t> resultShapeHint = {});
 
 // Broadcasts input tensor based on the broadcastToShape.
 LogicalResult broadcastToGivenShape(Operation *op, PatternRewriter &rewriter,
@@ -42,6 +42,12 @@ template <typename T>
 std::optional<Value> getConstTensor(PatternRewriter &rewriter, Operation *op,
                                     ArrayRef<T> vec, ArrayRef<int64_t> shape);
 
+// Create a constant tensor of integers used as indices or dimension sizes,
+// with elements of `dimSizeIndexBits` bits.
+Value getConstIndexTensor(PatternRewriter &rewriter, Operation *op,
+                          ArrayRef<int64_t> values, ArrayRef<int64_t> shape,
+                          size_t dimSizeIndexBits);
+
 template <typename T>
 Value getSplatConstTensor(ConversionPatternRewriter &rewriter, Operation *op,
                           T val, Type dtype, llvm::ArrayRef<int64_t> dshape);
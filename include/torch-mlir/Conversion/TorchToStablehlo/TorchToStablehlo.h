@@ -27,7 +27,9 @@ createConvertTorchToStablehloPass();
 // parameters
 std::unique_ptr<OperationPass<func::FuncOp>>
 createConvertTorchToStablehloPass(bool enableStaticShape, bool enableI32Index,
-                                  bool allowNonFinites);
+                                  bool allowNonFinites,
+                                  bool globalPoolAsReduce = false,
+                                  bool threadRngState = false);
 
 } // namespace torch
 } // namespace mlir
@@ -58,6 +58,13 @@ std::optional<Value> convertGatherNdOp(PatternRewriter &rewriter, Operation *op,
                                        Type out_type, Value params_value,
                                        Value indices_value);
 
+// Lowers a gather of whole slices of params along `axis`, as in
+// torch.aten.index_select or row indexing, to a single tosa.gather.
+std::optional<Value> convertGatherAlongAxisOp(PatternRewriter &rewriter,
+                                              Operation *op, Type outType,
+                                              Value paramsValue,
+                                              Value indexValue, int32_t axis);
+
 std::optional<Value> convertScatterNdOp(PatternRewriter &rewriter,
                                         Operation *op, Type outType,
                                         Value paramsValue, Value indicesValue,
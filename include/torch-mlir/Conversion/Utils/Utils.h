@@ -13,6 +13,9 @@
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "llvm/ADT/StringMap.h"
+
+#include <chrono>
 
 namespace mlir {
 namespace torch {
@@ -125,6 +128,40 @@ LogicalResult getQuantizationParams(Value value, Value &zeropoint, Value &scale,
 APFloat getFloatInf(mlir::FloatType fpType, bool negative,
                     bool allowNonFinites);
 
+// A listener that records, for each pattern of a conversion, how many times
+// it was tried, how many times it succeeded, and the time spent in it. Set it
+// as the `listener` of the `ConversionConfig` of the conversion, then `print`
+// it. The time of a pattern excludes the time of the patterns that legalize
+// the ops it creates, which the conversion driver applies within it.
+class PatternStatisticsListener : public RewriterBase::Listener {
+public:
+  void notifyPatternBegin(const Pattern &pattern, Operation *op) override;
+  void notifyPatternEnd(const Pattern &pattern, LogicalResult status) override;
+
+  // Prints the statistics of the patterns that were tried, in the decreasing
+  // order of their time, under a header that names the pass and `op`.
+  void print(raw_ostream &os, StringRef passName, Operation *op) const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct PatternStatistics {
+    int64_t attempts = 0;
+    int64_t successes = 0;
+    Clock::duration time = Clock::duration::zero();
+  };
+
+  struct ActivePattern {
+    PatternStatistics *statistics;
+    Clock::time_point start;
+    // The time spent in the patterns applied within this one.
+    Clock::duration nestedTime;
+  };
+
+  llvm::StringMap<PatternStatistics> statistics;
+  SmallVector<ActivePattern> activePatterns;
+};
+
 } // namespace Torch
 } // namespace torch
 } // namespace mlir
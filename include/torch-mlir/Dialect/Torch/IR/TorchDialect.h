@@ -10,7 +10,15 @@
 #ifndef TORCHMLIR_DIALECT_TORCH_IR_TORCHDIALECT_H
 #define TORCHMLIR_DIALECT_TORCH_IR_TORCHDIALECT_H
 
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Dialect.h"
+#include "mlir/Support/ThreadLocalCache.h"
+#include "mlir/Support/TypeID.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+
+#include <memory>
+#include <mutex>
 
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h.inc"
 
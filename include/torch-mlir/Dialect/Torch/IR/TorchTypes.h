@@ -100,6 +100,15 @@ public:
       std::optional<ArrayRef<int64_t>> optionalSizes, Type optionalDtype,
       Attribute optionalSparsity) const;
 
+  /// Return a type of the same kind and sizes as this one, but with the given
+  /// raw optional dtype. This is memoized per context, see
+  /// `TorchDialect::getOrCreateDerivedTensorType`.
+  Type getWithDtype(Type optionalDtype) const;
+
+  /// Return a type of the same kind, rank and dtype as this one, but with all
+  /// sizes unknown. This is memoized per context.
+  Type getWithUnknownSizes() const;
+
   /// Return a type with the same shape and dtype as this one, but with
   /// value semantics.
   ValueTensorType getWithValueSemantics() const;
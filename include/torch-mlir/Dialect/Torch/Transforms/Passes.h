@@ -75,6 +75,31 @@ struct TorchLoweringPipelineOptions
           "disabled, non-finites will be replaced with the closest finite "
           "value for a given dtype."),
       llvm::cl::init(true)};
+
+  // If this option is true, LowerToBackendContract only re-runs the
+  // simplification pipeline on functions that do not yet satisfy the backend
+  // contract after the first iteration.
+  Option<bool> incrementalBackendContract{
+      *this, "incremental-backend-contract",
+      llvm::cl::desc("Only re-simplify functions that do not yet satisfy the "
+                     "backend contract."),
+      llvm::cl::init(false)};
+
+  // The arguments of the public functions whose buffers are donated by the
+  // caller, so that their updates are done in place.
+  ListOption<int64_t> donatedArgs{
+      *this, "donated-args",
+      llvm::cl::desc("Indices of the donated arguments of the public "
+                     "functions. See `torch-adjust-calling-conventions`.")};
+
+  // If this option is true, the value-semantic ops of in-place ops keep a
+  // hint that their result may reuse the buffer of their first operand.
+  Option<bool> inplaceDestinations{
+      *this, "inplace-destinations",
+      llvm::cl::desc("Keep the destinations of in-place ops as hints for "
+                     "backends that update tensors in place. See "
+                     "`torch-reduce-op-variants`."),
+      llvm::cl::init(false)};
 };
 
 /// Creates a pipeline that lowers the object graph IR that is produced by
@@ -115,10 +140,14 @@ void createTorchDtypeRefinementPipeline(
 
 std::unique_ptr<OperationPass<ModuleOp>> createAdjustCallingConventionsPass();
 
+std::unique_ptr<OperationPass<ModuleOp>>
+createAdjustCallingConventionsPass(ArrayRef<int64_t> donatedArgs);
+
 std::unique_ptr<OperationPass<ModuleOp>> createInlineGlobalSlotsPass();
 
 std::unique_ptr<OperationPass<func::FuncOp>>
-createReduceOpVariantsPass(StringRef extraLibrary);
+createReduceOpVariantsPass(StringRef extraLibrary,
+                           bool markInplaceDestinations = false);
 
 std::unique_ptr<OperationPass<func::FuncOp>> createMaximizeValueSemanticsPass();
 
@@ -131,7 +160,11 @@ std::unique_ptr<OperationPass<func::FuncOp>> createScalarizeShapesPass();
 
 std::unique_ptr<OperationPass<func::FuncOp>> createRecomposeComplexOpsPass();
 
-std::unique_ptr<OperationPass<func::FuncOp>> createFuseQuantizedOpsPass();
+std::unique_ptr<OperationPass<func::FuncOp>>
+createRecomposeConvolutionEpiloguesPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createFuseQuantizedOpsPass(bool perChannel = false);
 std::unique_ptr<OperationPass<func::FuncOp>>
 createMatchQuantizedCustomOpsPass();
 
@@ -154,13 +187,22 @@ std::unique_ptr<OperationPass<ModuleOp>> createEraseModuleInitializerPass();
 
 std::unique_ptr<OperationPass<ModuleOp>> createLowerToBackendContractPass(
     int maxIterations, bool decompose, bool shapeDtypeRefine,
-    ArrayRef<std::string> backendLegalOps, StringRef extraLibrary);
+    ArrayRef<std::string> backendLegalOps, StringRef extraLibrary,
+    bool incremental = false);
 
 std::unique_ptr<OperationPass<ModuleOp>>
 createVerifyBackendContractNoDecompositionsPass();
 
+std::unique_ptr<OperationPass<ModuleOp>> createOpProfilePass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createEstimatePeakMemoryPass();
+
 StringRef getAbstractInterpLibrary();
 
+/// Returns the abstract interpretation library serialized as MLIR bytecode,
+/// or an empty string if the build did not embed it.
+StringRef getAbstractInterpLibraryBytecode();
+
 static const char kTorchOpPrefix[] = R"(torch.)";
 
 void populateRestructureNonConstantAxesPattern(RewritePatternSet &patterns,
@@ -169,6 +211,35 @@ void populateRestructureNonConstantAxesPattern(RewritePatternSet &patterns,
 std::unique_ptr<OperationPass<func::FuncOp>>
 createRestructureNonConstantAxesPass();
 
+std::unique_ptr<OperationPass<func::FuncOp>> createPropagateTransposesPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createPropagateShardingPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createScheduleCollectivesPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createNameLocationsPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createPartitionPipelineStagesPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createOutlineShapeFunctionsPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createHoistLoopInvariantsPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createRematerializeActivationsPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createAutoMixedPrecisionPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createFoldConstantWeightsPass();
+
+std::unique_ptr<OperationPass<func::FuncOp>> createFoldQuantizedWeightsPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createSpecializeShapesPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createBatchFunctionsPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createPrunePublicFunctionPass();
+
 } // namespace Torch
 
 /// Registers all Torch transformation passes.
@@ -80,8 +80,25 @@ std::optional<unsigned> getTensorRank(Value tensor);
 // Helper function to get the number of elements in a tensor.
 std::optional<int64_t> getTensorNumel(Value tensor);
 
+// The number of bytes of `tensor`, if it has a static shape and a known dtype.
+std::optional<int64_t> getTensorStaticBytes(Value tensor);
+
 bool isViewLikeOp(Operation *op);
 
+// The class of `op` for cost estimates: `matmul`, `convolution`,
+// `attention`, `view` or `other`.
+StringRef getOpCostClass(Operation *op);
+
+// An estimate of the floating point operations of `op`, from the static
+// shapes of its operands and results:
+// - 2 * M * N * K for matmuls;
+// - 2 * (the result elements) * (the input channels per group) * (the kernel
+//   size) for convolutions, and the same with the input of transposed ones;
+// - 2 * L * S * (E + Ev) per batch and head for attention;
+// - none for views, and one per element of the largest tensor otherwise.
+// Returns std::nullopt if a size it depends on is not static.
+std::optional<int64_t> estimateOpFlops(Operation *op);
+
 Value getConstantWithGivenDtypeAndValue(PatternRewriter &rewriter, Location loc,
                                         float value, Type dtype);
 
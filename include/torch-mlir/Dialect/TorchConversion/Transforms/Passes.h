@@ -31,6 +31,97 @@ struct LinalgOnTensorsBackendPipelineOptions
           "disabled, non-finites will be replaced with the closest finite "
           "value for a given dtype."),
       llvm::cl::init(true)};
+  Option<bool> channelsLastConv{
+      *this, "channels-last-conv",
+      llvm::cl::desc(
+          "When enabled, convolutions are lowered to channels-last linalg ops "
+          "and the resulting layout transposes are propagated so that "
+          "consecutive convolutions share them."),
+      llvm::cl::init(false)};
+  Option<std::string> convStrategy{
+      *this, "conv-strategy",
+      llvm::cl::desc(
+          "How 2D convolutions with static shapes are lowered: direct, "
+          "im2col, winograd or auto. See `convert-torch-to-linalg`."),
+      llvm::cl::init("direct")};
+  Option<bool> fuseElementwise{
+      *this, "fuse-elementwise",
+      llvm::cl::desc("When enabled, chains of elementwise ops are emitted as "
+                     "single linalg.generic ops by TorchToLinalg."),
+      llvm::cl::init(false)};
+  Option<int64_t> splitReductionFactor{
+      *this, "split-reduction-factor",
+      llvm::cl::desc("When at least 2, reductions to fewer values than this "
+                     "factor are split into this many partial reductions. "
+                     "See `convert-torch-to-linalg`."),
+      llvm::cl::init(0)};
+  Option<std::string> rng{
+      *this, "rng",
+      llvm::cl::desc("The random number generator used by TorchToLinalg: "
+                     "squares or philox. See `convert-torch-to-linalg`."),
+      llvm::cl::init("squares")};
+  Option<bool> concatInPlace{
+      *this, "concat-in-place",
+      llvm::cl::desc("When enabled, the producers of concatenated tensors "
+                     "compute them in slices of the concatenation. See "
+                     "`convert-torch-to-linalg`."),
+      llvm::cl::init(false)};
+  Option<bool> separablePooling{
+      *this, "separable-pooling",
+      llvm::cl::desc("When enabled, pools are emitted as one 1-D pool or "
+                     "windowed sum per spatial dim. See "
+                     "`convert-torch-to-linalg`."),
+      llvm::cl::init(false)};
+  Option<bool> decomposeZeroPoints{
+      *this, "decompose-zero-points",
+      llvm::cl::desc("When enabled, quantized matmuls and convolutions are "
+                     "emitted as integer contractions followed by zero point "
+                     "corrections. See `convert-torch-to-linalg`."),
+      llvm::cl::init(false)};
+  Option<bool> subPixelConvTranspose{
+      *this, "subpixel-conv-transpose",
+      llvm::cl::desc("When enabled, strided transposed convolutions are "
+                     "emitted as one dense convolution per output phase. See "
+                     "`convert-torch-to-linalg`."),
+      llvm::cl::init(false)};
+  Option<bool> convBackwardGemm{
+      *this, "conv-backward-gemm",
+      llvm::cl::desc("When enabled, convolution weight gradients are emitted "
+                     "as im2col followed by a matmul. See "
+                     "`convert-torch-to-linalg`."),
+      llvm::cl::init(false)};
+  Option<bool> foldWindowPadding{
+      *this, "fold-window-padding",
+      llvm::cl::desc("When enabled, convolutions and pools read their input "
+                     "through bounds checks instead of a padded copy. See "
+                     "`convert-torch-to-linalg`."),
+      llvm::cl::init(false)};
+  Option<bool> propagateTransposes{
+      *this, "propagate-transposes",
+      llvm::cl::desc("When enabled, permutes and transposes are sunk and "
+                     "cancelled by `torch-propagate-transposes` before "
+                     "lowering, and matmuls read transposed operands in "
+                     "place. See `transposed-matmul-operands` of "
+                     "`convert-torch-to-linalg`."),
+      llvm::cl::init(false)};
+  Option<int64_t> packWeightsBlockSize{
+      *this, "pack-weights-block-size",
+      llvm::cl::desc("When positive, the constant weights of matmuls are "
+                     "packed into tiles of this size at compile time. See "
+                     "`torch-pack-linalg-weights`."),
+      llvm::cl::init(0)};
+  Option<bool> narrowIndices{
+      *this, "narrow-indices",
+      llvm::cl::desc("When enabled, index tensors and index arithmetic that "
+                     "are proven to fit in i32 are narrowed to i32. See "
+                     "`torch-narrow-linalg-indices`."),
+      llvm::cl::init(false)};
+  Option<bool> nameLocations{
+      *this, "name-locations",
+      llvm::cl::desc("When enabled, the locations of the torch ops are named "
+                     "after the ops by `torch-name-locations`, so that the "
+                     "lowered ops can be traced back to them."),
+      llvm::cl::init(false)};
 };
 
 /// Creates a pipeline that lowers from the torch backend contract to the
@@ -57,6 +148,13 @@ struct TosaBackendPipelineOptions
       ::llvm::cl::desc("If non-empty, only these patterns are enabled during "
                        "Torch to TOSA conversion"),
       llvm::cl::ZeroOrMore};
+  Option<bool> nhwcLayout{
+      *this, "nhwc-layout",
+      llvm::cl::desc("When enabled, the layout transposes of convolutions and "
+                     "pools are cancelled by "
+                     "`torch-propagate-tosa-transposes`, so that the network "
+                     "stays NHWC between them."),
+      llvm::cl::init(false)};
 };
 
 /// Creates a pipeline that lowers from the torch backend contract to the
@@ -65,6 +163,12 @@ void createTorchBackendToTosaBackendPipeline(
     OpPassManager &pm, const TosaBackendPipelineOptions &options);
 
 std::unique_ptr<OperationPass<ModuleOp>> createVerifyTosaBackendContractPass();
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createFoldTosaWeightLayoutsPass();
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createPropagateTosaTransposesPass();
 #endif // TORCH_MLIR_ENABLE_TOSA
 
 // Do not register the stablehlo options if the stablehlo target is disabled
@@ -79,7 +183,9 @@ struct StablehloBackendPipelineOptions
   // are unlikely to exceed the range of i32(4GiB)
   Option<bool> enableI32Index{
       *this, "enable-i32-index",
-      llvm::cl::desc("Enable truncate index from i64 to i32(unsafely)"),
+      llvm::cl::desc("Enable truncate index from i64 to i32(unsafely). The "
+                     "pipeline then fails if a shape computation is left "
+                     "in i64."),
       llvm::cl::init(false)};
   Option<bool> allowNonFinites{
       *this, "allow-non-finites",
@@ -89,11 +195,45 @@ struct StablehloBackendPipelineOptions
           "disabled, non-finites will be replaced with the closest finite "
           "value for a given dtype."),
       llvm::cl::init(true)};
+  Option<bool> propagateTransposes{
+      *this, "propagate-transposes",
+      llvm::cl::desc("When enabled, permutes and transposes are sunk and "
+                     "cancelled by `torch-propagate-transposes` before "
+                     "lowering."),
+      llvm::cl::init(false)};
+  Option<bool> globalPoolAsReduce{
+      *this, "global-pool-as-reduce",
+      llvm::cl::desc("When enabled, pools over the whole of the spatial dims "
+                     "are lowered to `stablehlo.reduce`."),
+      llvm::cl::init(false)};
+  Option<bool> threadRngState{
+      *this, "thread-rng-state",
+      llvm::cl::desc("When enabled, random ops draw from a THREE_FRY state "
+                     "that is taken and returned by each function."),
+      llvm::cl::init(false)};
+  Option<bool> refineShapes{
+      *this, "refine-shapes",
+      llvm::cl::desc("When disabled, the pipeline stops before the shape "
+                     "refinement stages, which "
+                     "`torch-stablehlo-refine-shapes-pipeline` runs on the "
+                     "result, e.g. once per set of argument shapes."),
+      llvm::cl::init(true)};
+  Option<bool> composites{
+      *this, "composites",
+      llvm::cl::desc("When enabled, scaled dot product attention, layer and "
+                     "RMS norms and GELUs are kept as `stablehlo.composite`s, "
+                     "so that backends can match them to fused kernels."),
+      llvm::cl::init(false)};
 };
 
 void createTorchBackendToStablehloBackendPipeline(
     OpPassManager &pm, const StablehloBackendPipelineOptions &options);
 
+/// Creates the shape refinement stages of
+/// `createTorchBackendToStablehloBackendPipeline`.
+void createStablehloRefineShapesPipeline(
+    OpPassManager &pm, const StablehloBackendPipelineOptions &options);
+
 std::unique_ptr<OperationPass<ModuleOp>>
 createFuncBackendTypeConversionForStablehloPass();
 
@@ -102,6 +242,14 @@ createFinalizingBackendTypeConversionForStablehloPass();
 
 std::unique_ptr<OperationPass<ModuleOp>>
 createVerifyStablehloBackendContractPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createVerifyStablehloI32IndexPass();
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createOutlineStablehloCompositesPass();
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createConvertCallsToStablehloCompositesPass();
 #endif // TORCH_MLIR_ENABLE_STABLEHLO
 
 std::unique_ptr<OperationPass<ModuleOp>> createFuncBackendTypeConversionPass();
@@ -119,6 +267,18 @@ createUnpackQuantTensorPass();
 std::unique_ptr<InterfacePass<FunctionOpInterface>>
 createConvertCustomQuantOpPass();
 
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createPropagateLinalgTransposesPass();
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createNarrowLinalgIndicesPass();
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createPackLinalgWeightsPass(int64_t blockSize = 16);
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createUnifySymbolicDimsPass();
+
 std::unique_ptr<OperationPass<ModuleOp>>
 createVerifyLinalgOnTensorsBackendContractPass();
 
@@ -0,0 +1,180 @@
+//===- Compile.cpp - C API for batch compilation --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir-c/Compile.h"
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/CAPI/Support.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "torch-mlir/InitAll.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/ThreadPool.h"
+
+#include <mutex>
+
+using namespace mlir;
+
+namespace {
+// A context of the pool, with the pass managers of the pipelines that ran in
+// it. A context is only used by one thread at a time.
+struct CompilerContext {
+  explicit CompilerContext(const DialectRegistry &registry)
+      : context(registry, MLIRContext::Threading::DISABLED) {
+    context.loadAllAvailableDialects();
+  }
+
+  MLIRContext context;
+  llvm::StringMap<std::unique_ptr<PassManager>> passManagers;
+};
+
+struct CompilerPool {
+  explicit CompilerPool(unsigned numThreads)
+      : threadPool(llvm::hardware_concurrency(numThreads)) {
+    torch::registerAllDialects(registry);
+    torch::registerAllExtensions(registry);
+    torch::registerOptionalInputDialects(registry);
+    for (unsigned i = 0, e = threadPool.getMaxConcurrency(); i < e; ++i)
+      contexts.push_back(std::make_unique<CompilerContext>(registry));
+    for (auto &context : contexts)
+      freeContexts.push_back(context.get());
+  }
+
+  // Takes a context that no other thread uses. There is one per thread of
+  // the pool, but a new one is made if the callers of the pool use their
+  // own threads too.
+  CompilerContext *acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeContexts.empty()) {
+      contexts.push_back(std::make_unique<CompilerContext>(registry));
+      return contexts.back().get();
+    }
+    return freeContexts.pop_back_val();
+  }
+
+  void release(CompilerContext *context) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeContexts.push_back(context);
+  }
+
+  DialectRegistry registry;
+  std::mutex mutex;
+  std::vector<std::unique_ptr<CompilerContext>> contexts;
+  SmallVector<CompilerContext *> freeContexts;
+  // Declared last, so that its threads are joined before the contexts that
+  // they use are destroyed.
+  llvm::DefaultThreadPool threadPool;
+};
+} // namespace
+
+static CompilerPool *unwrap(TorchMlirCompilerPool pool) {
+  return static_cast<CompilerPool *>(pool.ptr);
+}
+
+// Drops the data of the resource blobs, e.g. the weights, that `module`
+// references. The context would otherwise keep it for as long as the pool
+// lives, after the module is gone.
+static void releaseResourceBlobs(Operation *module) {
+  module->walk([](Operation *op) {
+    for (NamedAttribute attr : op->getAttrs()) {
+      attr.getValue().walk([](DenseResourceElementsAttr resource) {
+        if (AsmResourceBlob *blob = resource.getRawHandle().getBlob())
+          *blob = AsmResourceBlob();
+      });
+    }
+  });
+}
+
+static LogicalResult compileModule(CompilerContext &compilerContext,
+                                   StringRef pipeline, StringRef source,
+                                   std::string &output) {
+  MLIRContext *context = &compilerContext.context;
+  std::string diagnostics;
+  llvm::raw_string_ostream diagnosticsOs(diagnostics);
+  ScopedDiagnosticHandler handler(context, [&](Diagnostic &diag) {
+    diagnosticsOs << diag.getLocation() << ": "
+                  << (diag.getSeverity() == DiagnosticSeverity::Error
+                          ? "error: "
+                          : "")
+                  << diag << "\n";
+    for (Diagnostic &note : diag.getNotes())
+      diagnosticsOs << note.getLocation() << ": note: " << note << "\n";
+    return success();
+  });
+  auto fail = [&]() {
+    output = std::move(diagnostics);
+    return failure();
+  };
+
+  std::unique_ptr<PassManager> &pm = compilerContext.passManagers[pipeline];
+  if (!pm) {
+    auto newPm = std::make_unique<PassManager>(context);
+    if (failed(parsePassPipeline(pipeline, *newPm, diagnosticsOs)))
+      return fail();
+    pm = std::move(newPm);
+  }
+
+  OwningOpRef<ModuleOp> module =
+      parseSourceString<ModuleOp>(source, ParserConfig(context));
+  if (!module)
+    return fail();
+  LogicalResult result = pm->run(*module);
+  if (succeeded(result)) {
+    llvm::raw_string_ostream os(output);
+    result = writeBytecodeToFile(*module, os);
+  }
+  releaseResourceBlobs(*module);
+  if (failed(result))
+    return fail();
+  return success();
+}
+
+TorchMlirCompilerPool torchMlirCompilerPoolCreate(intptr_t numThreads) {
+  return {new CompilerPool(numThreads)};
+}
+
+void torchMlirCompilerPoolDestroy(TorchMlirCompilerPool pool) {
+  delete unwrap(pool);
+}
+
+MlirLogicalResult torchMlirCompileBatch(TorchMlirCompilerPool pool,
+                                       MlirStringRef pipeline,
+                                       intptr_t numModules,
+                                       const MlirStringRef *modules,
+                                       TorchMlirCompileBatchCallback callback,
+                                       void *userData) {
+  CompilerPool *compilerPool = unwrap(pool);
+  StringRef pipelineRef = unwrap(pipeline);
+  std::vector<std::string> outputs(numModules);
+  std::vector<char> succeededModules(numModules);
+  llvm::ThreadPoolTaskGroup tasks(compilerPool->threadPool);
+  for (intptr_t i = 0; i < numModules; ++i) {
+    tasks.async([&, i]() {
+      CompilerContext *context = compilerPool->acquire();
+      succeededModules[i] = succeeded(compileModule(
+          *context, pipelineRef, unwrap(modules[i]), outputs[i]));
+      compilerPool->release(context);
+    });
+  }
+  tasks.wait();
+
+  bool allSucceeded = true;
+  for (intptr_t i = 0; i < numModules; ++i) {
+    allSucceeded &= succeededModules[i];
+    callback(i, wrap(success(succeededModules[i])),
+             mlirStringRefCreate(outputs[i].data(), outputs[i].size()),
+             userData);
+  }
+  return wrap(success(allSucceeded));
+}
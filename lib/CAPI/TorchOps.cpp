@@ -12,6 +12,7 @@
 #include "mlir/CAPI/IR.h"
 #include "mlir/CAPI/Support.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Diagnostics.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 
 using namespace mlir;
@@ -36,3 +37,60 @@ MlirValue torchMlirAdjustStaticInformation(MlirBlock block_,
   return wrap(Torch::adjustStaticInformation(
       builder, value.getLoc(), value, desiredType, userAllowsRefinement));
 }
+
+//===----------------------------------------------------------------------===//
+// Batched construction
+//===----------------------------------------------------------------------===//
+
+MlirLogicalResult
+torchMlirBlockAppendOperations(MlirBlock block_, intptr_t numValues,
+                               const MlirValue *values, intptr_t numOperations,
+                               const TorchMlirOperationSpec *operations,
+                               MlirValue *results) {
+  Block *block = unwrap(block_);
+  SmallVector<Value> valueTable;
+  valueTable.reserve(numValues);
+  for (intptr_t i = 0; i < numValues; ++i)
+    valueTable.push_back(unwrap(values[i]));
+
+  SmallVector<Operation *> built;
+  built.reserve(numOperations);
+  auto eraseBuilt = [&]() {
+    for (Operation *op : llvm::reverse(built))
+      op->erase();
+  };
+
+  size_t numResults = 0;
+  SmallVector<Value> operands;
+  for (intptr_t i = 0; i < numOperations; ++i) {
+    const TorchMlirOperationSpec &spec = operations[i];
+    Location loc = unwrap(spec.location);
+    operands.clear();
+    for (intptr_t j = 0; j < spec.numOperands; ++j) {
+      intptr_t index = spec.operandIndices[j];
+      if (index < 0 || static_cast<size_t>(index) >= valueTable.size()) {
+        emitError(loc) << "operand #" << j << " of '" << unwrap(spec.name)
+                       << "' refers to value #" << index << " but only "
+                       << valueTable.size() << " values are defined";
+        eraseBuilt();
+        return mlirLogicalResultFailure();
+      }
+      operands.push_back(valueTable[index]);
+    }
+
+    OperationState state(loc, unwrap(spec.name));
+    state.addOperands(operands);
+    for (intptr_t j = 0; j < spec.numResults; ++j)
+      state.addTypes(unwrap(spec.resultTypes[j]));
+    for (intptr_t j = 0; j < spec.numAttributes; ++j)
+      state.addAttribute(unwrap(spec.attributes[j].name),
+                         unwrap(spec.attributes[j].attribute));
+    Operation *op = Operation::create(state);
+    block->push_back(op);
+    built.push_back(op);
+    llvm::append_range(valueTable, op->getResults());
+    for (Value result : op->getResults())
+      results[numResults++] = wrap(result);
+  }
+  return mlirLogicalResultSuccess();
+}
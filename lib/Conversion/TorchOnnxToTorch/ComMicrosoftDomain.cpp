@@ -17,6 +17,36 @@ using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::onnx_c;
 
+// The data of `value`, an integer tensor defined by an `onnx.Constant` or a
+// literal, as a tensor of `type`, which has the same number of elements.
+static FailureOr<DenseElementsAttr> getConstantData(Value value,
+                                                    RankedTensorType type) {
+  Operation *op = value.getDefiningOp();
+  Attribute attr;
+  if (auto literal = dyn_cast_or_null<Torch::ValueTensorLiteralOp>(op))
+    attr = literal.getValue();
+  else if (auto constOp = dyn_cast_or_null<Torch::OperatorOp>(op);
+           constOp && constOp.getName() == "onnx.Constant")
+    attr = constOp->getAttr("torch.onnx.value");
+  if (auto dense = dyn_cast_or_null<DenseIntElementsAttr>(attr)) {
+    if (dense.getNumElements() != type.getNumElements() ||
+        dense.getElementType() != type.getElementType())
+      return failure();
+    return dense.reshape(type);
+  }
+  if (auto resource = dyn_cast_or_null<DenseResourceElementsAttr>(attr)) {
+    AsmResourceBlob *blob = resource.getRawHandle().getBlob();
+    if (!blob || resource.getType().getNumElements() != type.getNumElements() ||
+        resource.getType().getElementType() != type.getElementType())
+      return failure();
+    bool isSplat = false;
+    if (!DenseElementsAttr::isValidRawBuffer(type, blob->getData(), isSplat))
+      return failure();
+    return DenseElementsAttr::getFromRawBuffer(type, blob->getData());
+  }
+  return failure();
+}
+
 void mlir::torch::onnx_c::populateComMicrosoftDomain(
     OnnxCustomOpConversionPattern &patterns) {
   patterns.onOp(
@@ -510,8 +540,7 @@ void mlir::torch::onnx_c::populateComMicrosoftDomain(
             seqLensKType.getOptionalDtype().isInteger(32)) {
           seqlensK = Torch::AtenToDtypeOp::create(
               rewriter, loc,
-              seqLensKType.getWithSizesAndDtype(
-                  seqLensKType.getOptionalSizes(),
+              seqLensKType.getWithDtype(
                   rewriter.getIntegerType(/*width=*/64, /*isSigned=*/true)),
               seqlensK, cstInt64Dtype, /*non_blocking=*/cstFalse,
               /*copy=*/cstFalse, /*memory_format=*/cstNone);
@@ -710,76 +739,95 @@ void mlir::torch::onnx_c::populateComMicrosoftDomain(
             rewriter, loc, qRangeType, cstSequenceLength, cstInt64Dtype,
             /*layout=*/cstNone, /*device=*/cstNone, /*pin_memory=*/cstNone);
 
-        // pastLen -> [B, 1, 1, 1] via unsqueeze chain for 4D scatter index
-        // broadcasting
         auto intSiType = rewriter.getIntegerType(64, /*isSigned=*/true);
-        Value cstDim3 = Torch::ConstantIntOp::create(
-            rewriter, loc, rewriter.getI64IntegerAttr(3));
-        // [batch] -> [batch, 1]
-        Torch::ValueTensorType pastLenUnsq1Type = Torch::ValueTensorType::get(
-            context, SmallVector<int64_t>{batchSize, 1}, intSiType);
-        Value pastLenUnsq1 = Torch::AtenUnsqueezeOp::create(
-            rewriter, loc, pastLenUnsq1Type, pastLen, cstDim1);
-        // [batch, 1] -> [batch, 1, 1]
-        Torch::ValueTensorType pastLenUnsq2Type = Torch::ValueTensorType::get(
-            context, SmallVector<int64_t>{batchSize, 1, 1}, intSiType);
-        Value pastLenUnsq2 = Torch::AtenUnsqueezeOp::create(
-            rewriter, loc, pastLenUnsq2Type, pastLenUnsq1, cstDim2);
-        // [batch, 1, 1] -> [batch, 1, 1, 1]
-        Torch::ValueTensorType pastLenView4dType = Torch::ValueTensorType::get(
-            context, SmallVector<int64_t>{batchSize, 1, 1, 1}, intSiType);
-        Value pastLenView4d = Torch::AtenUnsqueezeOp::create(
-            rewriter, loc, pastLenView4dType, pastLenUnsq2, cstDim3);
-
-        // qRange -> [1, 1, seq, 1] via unsqueeze chain for scatter
-        // [seq] -> [1, seq]
-        Torch::ValueTensorType qUnsq0Type = Torch::ValueTensorType::get(
-            context, SmallVector<int64_t>{1, sequenceLength}, intSiType);
-        Value qUnsq0 = Torch::AtenUnsqueezeOp::create(rewriter, loc, qUnsq0Type,
-                                                      qRange, cstIntZero);
-        // [1, seq] -> [1, 1, seq]
-        Torch::ValueTensorType qUnsq1Type = Torch::ValueTensorType::get(
-            context, SmallVector<int64_t>{1, 1, sequenceLength}, intSiType);
-        Value qUnsq1 = Torch::AtenUnsqueezeOp::create(rewriter, loc, qUnsq1Type,
-                                                      qUnsq0, cstIntZero);
-        // [1, 1, seq] -> [1, 1, seq, 1]
-        Torch::ValueTensorType scatterQViewType = Torch::ValueTensorType::get(
-            context, SmallVector<int64_t>{1, 1, sequenceLength, 1}, intSiType);
-        Value scatterQRangeView = Torch::AtenUnsqueezeOp::create(
-            rewriter, loc, scatterQViewType, qUnsq1, cstDim3);
-
-        // scatterIdxBase = pastLen[B,1,1,1] + qRange[1,1,seq,1]
-        //               -> [B, 1, seq, 1]
-        SmallVector<int64_t> scatterIdxBaseSizes{batchSize, 1, sequenceLength,
-                                                 1};
-        Torch::ValueTensorType scatterIdxBaseType = Torch::ValueTensorType::get(
-            context, scatterIdxBaseSizes,
-            rewriter.getIntegerType(64, /*isSigned=*/true));
-        Value scatterIdxBase = Torch::AtenAddTensorOp::create(
-            rewriter, loc, scatterIdxBaseType, pastLenView4d, scatterQRangeView,
-            cstIntOne);
-
-        // Expand to [B, kv_heads, seq, head_size] to match current K/V shape
-        SmallVector<int64_t> scatterExpandSizes{batchSize, kvNumHeads,
-                                                sequenceLength, headSize};
-        Torch::ValueTensorType scatterIdxType = Torch::ValueTensorType::get(
-            context, scatterExpandSizes,
-            rewriter.getIntegerType(64, /*isSigned=*/true));
-        Value scatterExpandSizeList = Torch::PrimListConstructOp::create(
-            rewriter, loc, intListType,
-            SmallVector<Value>{cstBatchSize, cstKVNumHeads, cstSequenceLength,
-                               cstHeadSize});
-        Value scatterIdx = Torch::AtenExpandOp::create(
-            rewriter, loc, scatterIdxType, scatterIdxBase,
-            scatterExpandSizeList, /*implicit=*/cstFalse);
-
-        // Scatter current K/V into buffer at position pastLen[b] + q
-        presentKey = Torch::AtenScatterSrcOp::create(
-            rewriter, loc, resultTypes[1], presentKey, cstDim2, scatterIdx,
-            kRotary);
-        presentValue = Torch::AtenScatterSrcOp::create(
-            rewriter, loc, resultTypes[2], presentValue, cstDim2, scatterIdx,
-            vInput);
+        if (batchSize == 1) {
+          // With a single batch the past length is one scalar, so the current
+          // K/V are written in place as a slice of the padded buffer rather
+          // than through a materialized index tensor.
+          Value pastLenScalar = Torch::AtenItemOp::create(
+              rewriter, loc, rewriter.getType<Torch::IntType>(), pastLen);
+          Value pastLenEnd = Torch::AtenAddIntOp::create(
+              rewriter, loc, pastLenScalar, cstSequenceLength);
+          presentKey = Torch::AtenSliceScatterOp::create(
+              rewriter, loc, resultTypes[1], presentKey, kRotary, cstDim2,
+              pastLenScalar, pastLenEnd, cstIntOne);
+          presentValue = Torch::AtenSliceScatterOp::create(
+              rewriter, loc, resultTypes[2], presentValue, vInput, cstDim2,
+              pastLenScalar, pastLenEnd, cstIntOne);
+        } else {
+          // pastLen -> [B, 1, 1, 1] via unsqueeze chain for 4D scatter index
+          // broadcasting
+          Value cstDim3 = Torch::ConstantIntOp::create(
+              rewriter, loc, rewriter.getI64IntegerAttr(3));
+          // [batch] -> [batch, 1]
+          Torch::ValueTensorType pastLenUnsq1Type = Torch::ValueTensorType::get(
+              context, SmallVector<int64_t>{batchSize, 1}, intSiType);
+          Value pastLenUnsq1 = Torch::AtenUnsqueezeOp::create(
+              rewriter, loc, pastLenUnsq1Type, pastLen, cstDim1);
+          // [batch, 1] -> [batch, 1, 1]
+          Torch::ValueTensorType pastLenUnsq2Type = Torch::ValueTensorType::get(
+              context, SmallVector<int64_t>{batchSize, 1, 1}, intSiType);
+          Value pastLenUnsq2 = Torch::AtenUnsqueezeOp::create(
+              rewriter, loc, pastLenUnsq2Type, pastLenUnsq1, cstDim2);
+          // [batch, 1, 1] -> [batch, 1, 1, 1]
+          Torch::ValueTensorType pastLenView4dType =
+              Torch::ValueTensorType::get(
+                  context, SmallVector<int64_t>{batchSize, 1, 1, 1}, intSiType);
+          Value pastLenView4d = Torch::AtenUnsqueezeOp::create(
+              rewriter, loc, pastLenView4dType, pastLenUnsq2, cstDim3);
+
+          // qRange -> [1, 1, seq, 1] via unsqueeze chain for scatter
+          // [seq] -> [1, seq]
+          Torch::ValueTensorType qUnsq0Type = Torch::ValueTensorType::get(
+              context, SmallVector<int64_t>{1, sequenceLength}, intSiType);
+          Value qUnsq0 = Torch::AtenUnsqueezeOp::create(
+              rewriter, loc, qUnsq0Type, qRange, cstIntZero);
+          // [1, seq] -> [1, 1, seq]
+          Torch::ValueTensorType qUnsq1Type = Torch::ValueTensorType::get(
+              context, SmallVector<int64_t>{1, 1, sequenceLength}, intSiType);
+          Value qUnsq1 = Torch::AtenUnsqueezeOp::create(
+              rewriter, loc, qUnsq1Type, qUnsq0, cstIntZero);
+          // [1, 1, seq] -> [1, 1, seq, 1]
+          Torch::ValueTensorType scatterQViewType =
+              Torch::ValueTensorType::get(
+                  context, SmallVector<int64_t>{1, 1, sequenceLength, 1},
+                  intSiType);
+          Value scatterQRangeView = Torch::AtenUnsqueezeOp::create(
+              rewriter, loc, scatterQViewType, qUnsq1, cstDim3);
+
+          // scatterIdxBase = pastLen[B,1,1,1] + qRange[1,1,seq,1]
+          //               -> [B, 1, seq, 1]
+          SmallVector<int64_t> scatterIdxBaseSizes{batchSize, 1,
+                                                   sequenceLength, 1};
+          Torch::ValueTensorType scatterIdxBaseType =
+              Torch::ValueTensorType::get(context, scatterIdxBaseSizes,
+                                          intSiType);
+          Value scatterIdxBase = Torch::AtenAddTensorOp::create(
+              rewriter, loc, scatterIdxBaseType, pastLenView4d,
+              scatterQRangeView, cstIntOne);
+
+          // Expand to [B, kv_heads, seq, head_size] to match current K/V shape
+          SmallVector<int64_t> scatterExpandSizes{batchSize, kvNumHeads,
+                                                  sequenceLength, headSize};
+          Torch::ValueTensorType scatterIdxType = Torch::ValueTensorType::get(
+              context, scatterExpandSizes,
+              rewriter.getIntegerType(64, /*isSigned=*/true));
+          Value scatterExpandSizeList = Torch::PrimListConstructOp::create(
+              rewriter, loc, intListType,
+              SmallVector<Value>{cstBatchSize, cstKVNumHeads,
+                                 cstSequenceLength, cstHeadSize});
+          Value scatterIdx = Torch::AtenExpandOp::create(
+              rewriter, loc, scatterIdxType, scatterIdxBase,
+              scatterExpandSizeList, /*implicit=*/cstFalse);
+
+          // Scatter current K/V into buffer at position pastLen[b] + q
+          presentKey = Torch::AtenScatterSrcOp::create(
+              rewriter, loc, resultTypes[1], presentKey, cstDim2, scatterIdx,
+              kRotary);
+          presentValue = Torch::AtenScatterSrcOp::create(
+              rewriter, loc, resultTypes[2], presentValue, cstDim2, scatterIdx,
+              vInput);
+        }
 
         // Generate causal attention mask.
         // With scatter, KV layout matches ORT: current at pastLen[b].
@@ -1462,6 +1510,141 @@ void mlir::torch::onnx_c::populateComMicrosoftDomain(
             binder.op, resultType, transposedLhs, transposedRhs);
         return success();
       });
+  patterns.onOp(
+      "MatMulNBits", 1,
+      [](OpBinder binder, ConversionPatternRewriter &rewriter) {
+        // The weights stay packed: the op is lowered to the
+        // `quant.matmul_rhs_group_quant` op, whose packed bytes
+        // `torch-unpack-quant-tensor` reinterprets as `bits`-wide integers
+        // and which `torch-convert-custom-quant-op` lowers to a contraction
+        // that dequantizes each weight as it reads it.
+        Torch::ValueTensorType resultType;
+        SmallVector<Value> operands;
+        int64_t k, n, bits, blockSize;
+        if (binder.tensorOperandsList(operands) ||
+            binder.s64IntegerAttr(k, "K", 0) ||
+            binder.s64IntegerAttr(n, "N", 0) ||
+            binder.s64IntegerAttr(bits, "bits", 4) ||
+            binder.s64IntegerAttr(blockSize, "block_size", 0) ||
+            binder.tensorResultType(resultType))
+          return failure();
+        auto isPresent = [&](unsigned index) {
+          return index < operands.size() &&
+                 !isa<Torch::NoneType>(operands[index].getType());
+        };
+        if (operands.size() < 3 || !isPresent(1) || !isPresent(2))
+          return failure();
+        if (isPresent(4))
+          return rewriter.notifyMatchFailure(
+              binder.op, "unimplemented: g_idx is not supported");
+        if ((bits != 2 && bits != 4 && bits != 8) || k <= 0 || n <= 0 ||
+            blockSize <= 0 || k % blockSize != 0)
+          return rewriter.notifyMatchFailure(
+              binder.op, "unsupported bits, block_size, K or N");
+
+        Location loc = binder.getLoc();
+        Value a = operands[0];
+        auto aType = cast<Torch::ValueTensorType>(a.getType());
+        if (!aType.hasSizes() || aType.getSizes().size() != 3 ||
+            !aType.hasDtype() || !isa<FloatType>(aType.getDtype()))
+          return rewriter.notifyMatchFailure(
+              binder.op, "unimplemented: A must be a rank-3 float tensor");
+        auto floatType = cast<FloatType>(aType.getDtype());
+        int64_t numBlocks = k / blockSize;
+
+        // The packed weights, [N, n_blocks, blob_size] bytes, are the
+        // [N, K * bits / 8] bytes that `torch-unpack-quant-tensor` expects.
+        Type byteType = rewriter.getIntegerType(8, /*isSigned=*/false);
+        auto weightsType = RankedTensorType::get({n, k * bits / 8}, byteType);
+        FailureOr<DenseElementsAttr> weights =
+            getConstantData(operands[1], weightsType);
+        if (failed(weights))
+          return rewriter.notifyMatchFailure(
+              binder.op, "unimplemented: B must be a constant");
+        Value packedWeights = Torch::ValueTensorLiteralOp::create(
+            rewriter, loc,
+            Torch::ValueTensorType::get(binder.op->getContext(),
+                                        SmallVector<int64_t>{n, k * bits / 8},
+                                        byteType),
+            *weights);
+
+        // The scales and zero points have one value per block.
+        SmallVector<int64_t> groupSizes{n, numBlocks, 1};
+        auto groupType = Torch::ValueTensorType::get(binder.op->getContext(),
+                                                     groupSizes, floatType);
+        Value groupSizeList =
+            createConstantIntList(binder, rewriter, groupSizes);
+        auto reshapeToGroups = [&](Value value) -> Value {
+          return Torch::AtenReshapeOp::create(rewriter, loc, groupType, value,
+                                              groupSizeList);
+        };
+        Value scales = reshapeToGroups(operands[2]);
+
+        Value zeroPoints;
+        auto zeroPointsType = RankedTensorType::get(groupSizes, floatType);
+        if (!isPresent(3)) {
+          // The default zero point is the middle of the unsigned range.
+          zeroPoints = Torch::ValueTensorLiteralOp::create(
+              rewriter, loc, groupType,
+              SplatElementsAttr::get(
+                  zeroPointsType,
+                  rewriter.getFloatAttr(floatType, 1 << (bits - 1))));
+        } else if (auto zpType = dyn_cast<Torch::ValueTensorType>(
+                       operands[3].getType());
+                   zpType && zpType.hasDtype() &&
+                   zpType.getDtype() == floatType) {
+          zeroPoints = reshapeToGroups(operands[3]);
+        } else {
+          // Packed zero points are unpacked here, as they are small.
+          int64_t bytesPerRow = llvm::divideCeil(numBlocks * bits, 8);
+          FailureOr<DenseElementsAttr> packedZeroPoints = getConstantData(
+              operands[3], RankedTensorType::get({n * bytesPerRow}, byteType));
+          if (failed(packedZeroPoints))
+            return rewriter.notifyMatchFailure(
+                binder.op, "unimplemented: packed zero points must be a "
+                           "constant");
+          SmallVector<APInt> bytes(packedZeroPoints->getValues<APInt>());
+          SmallVector<APFloat> values;
+          for (int64_t row = 0; row < n; ++row) {
+            for (int64_t block = 0; block < numBlocks; ++block) {
+              int64_t bitOffset = block * bits;
+              uint64_t byte =
+                  bytes[row * bytesPerRow + bitOffset / 8].getZExtValue();
+              uint64_t zeroPoint =
+                  (byte >> (bitOffset % 8)) & ((1 << bits) - 1);
+              APFloat value(static_cast<double>(zeroPoint));
+              bool losesInfo;
+              value.convert(floatType.getFloatSemantics(),
+                            APFloat::rmNearestTiesToEven, &losesInfo);
+              values.push_back(value);
+            }
+          }
+          zeroPoints = Torch::ValueTensorLiteralOp::create(
+              rewriter, loc, groupType,
+              DenseElementsAttr::get(zeroPointsType, values));
+        }
+
+        Value cstBits = Torch::ConstantIntOp::create(
+            rewriter, loc, rewriter.getI64IntegerAttr(bits));
+        Value cstBlockSize = Torch::ConstantIntOp::create(
+            rewriter, loc, rewriter.getI64IntegerAttr(blockSize));
+        Value result =
+            Torch::OperatorOp::create(
+                rewriter, loc, TypeRange{resultType},
+                rewriter.getStringAttr("quant.matmul_rhs_group_quant"),
+                ValueRange{a, packedWeights, scales, zeroPoints, cstBits,
+                           cstBlockSize},
+                /*regionsCount=*/0)
+                .getResult(0);
+        if (isPresent(5)) {
+          Value cstOne = Torch::ConstantIntOp::create(
+              rewriter, loc, rewriter.getI64IntegerAttr(1));
+          result = Torch::AtenAddTensorOp::create(rewriter, loc, resultType,
+                                                  result, operands[5], cstOne);
+        }
+        rewriter.replaceOp(binder.op, result);
+        return success();
+      });
   patterns.onOp(
       "QLinearMul", 1,
       [](OpBinder binder, ConversionPatternRewriter &rewriter) {
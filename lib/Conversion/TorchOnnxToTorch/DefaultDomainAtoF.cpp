@@ -1087,6 +1087,9 @@ void mlir::torch::onnx_c::populateDefaultDomainAtoF(
             binder.s64IntegerAttr(dim, "axis", 0) ||
             binder.tensorResultType(resultType))
           return failure();
+        // Shape computations on static shapes are folded to literals.
+        if (succeeded(foldConstantIntTensor(binder, rewriter)))
+          return success();
         Type listElemType =
             cast<Torch::BaseTensorType>(tensors[0].getType())
                 .getWithSizesAndDtype(/*optionalSizes=*/std::nullopt,
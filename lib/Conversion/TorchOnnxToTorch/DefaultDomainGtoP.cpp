@@ -2062,6 +2062,9 @@ void mlir::torch::onnx_c::populateDefaultDomainGtoP(
             binder.tensorResultType(resultType) ||
             binder.s64IntegerAttr(axis, "axis", 0))
           return failure();
+        // Shape computations on static shapes are folded to literals.
+        if (succeeded(foldConstantIntTensor(binder, rewriter)))
+          return success();
         Location loc = binder.getLoc();
         auto ctx = binder.op->getContext();
         auto indicesTy = cast<Torch::ValueTensorType>(indices.getType());
@@ -2687,8 +2690,7 @@ void mlir::torch::onnx_c::populateDefaultDomainGtoP(
             Torch::ConstantBoolOp::create(rewriter, binder.getLoc(), false);
         Value none = Torch::ConstantNoneOp::create(rewriter, binder.getLoc());
         if (*stashDtype != xType.getOptionalDtype()) {
-          auto newXType =
-              xType.getWithSizesAndDtype(xType.getOptionalSizes(), *stashDtype);
+          auto newXType = xType.getWithDtype(*stashDtype);
           Value dtypeValue = Torch::ConstantIntOp::create(
               rewriter, binder.getLoc(),
               rewriter.getI64IntegerAttr(stashTypeIntTorch.value()));
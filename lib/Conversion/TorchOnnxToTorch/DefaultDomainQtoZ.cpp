@@ -1230,6 +1230,9 @@ void mlir::torch::onnx_c::populateDefaultDomainQtoZ(
         if (binder.tensorOperands(data, axes) ||
             binder.tensorResultType(resultType))
           return failure();
+        // Shape computations on static shapes are folded to literals.
+        if (succeeded(foldConstantIntTensor(binder, rewriter)))
+          return success();
         auto inputType = dyn_cast<Torch::ValueTensorType>(data.getType());
         if (!inputType.hasSizes() || !resultType.hasSizes())
           return rewriter.notifyMatchFailure(
@@ -1716,6 +1719,9 @@ void mlir::torch::onnx_c::populateDefaultDomainQtoZ(
         if (binder.tensorOperand(operand) ||
             binder.tensorResultType(resultType))
           return failure();
+        // Shape computations on static shapes are folded to literals.
+        if (succeeded(foldConstantIntTensor(binder, rewriter)))
+          return success();
 
         auto inputType = dyn_cast<Torch::ValueTensorType>(operand.getType());
         if (!inputType || !inputType.hasSizes())
@@ -2199,6 +2205,44 @@ void mlir::torch::onnx_c::populateDefaultDomainQtoZ(
           }
         }
 
+        // A shape computed from constants and static shapes gives the sizes
+        // directly, rather than through a select and item per dim.
+        SmallVector<int64_t> shapeValues;
+        if (succeeded(evaluateConstantIntTensor(shape, shapeValues))) {
+          auto dataType = cast<Torch::ValueTensorType>(data.getType());
+          SmallVector<Value> resultShape;
+          for (auto [i, size] : llvm::enumerate(shapeValues)) {
+            // Unless `allowzero` is set, a zero copies the input dim.
+            if (size != 0 || allowzero != 0) {
+              resultShape.push_back(Torch::ConstantIntOp::create(
+                  rewriter, binder.getLoc(), rewriter.getI64IntegerAttr(size)));
+              continue;
+            }
+            if (!dataType.hasSizes() || i >= dataType.getSizes().size())
+              return failure();
+            int64_t dataSize = dataType.getSizes()[i];
+            if (dataSize != Torch::kUnknownSize) {
+              resultShape.push_back(Torch::ConstantIntOp::create(
+                  rewriter, binder.getLoc(),
+                  rewriter.getI64IntegerAttr(dataSize)));
+              continue;
+            }
+            Value dim = Torch::ConstantIntOp::create(
+                rewriter, binder.getLoc(), rewriter.getI64IntegerAttr(i));
+            resultShape.push_back(Torch::AtenSizeIntOp::create(
+                rewriter, binder.getLoc(), rewriter.getType<Torch::IntType>(),
+                data, dim));
+          }
+          Value resultShapeList = Torch::PrimListConstructOp::create(
+              rewriter, binder.getLoc(),
+              Torch::ListType::get(
+                  Torch::IntType::get(binder.op->getContext())),
+              resultShape);
+          rewriter.replaceOpWithNewOp<Torch::AtenReshapeOp>(
+              binder.op, resultType, data, resultShapeList);
+          return success();
+        }
+
         Torch::BaseTensorType shapeType =
             cast<Torch::BaseTensorType>(shape.getType());
         SmallVector<Value> dimList;
@@ -3263,9 +3307,7 @@ void mlir::torch::onnx_c::populateDefaultDomainQtoZ(
             Torch::ConstantBoolOp::create(rewriter, binder.getLoc(), false);
         Value newBatchIndices = Torch::AtenToDtypeOp::create(
             rewriter, loc,
-            batchIndicesType.getWithSizesAndDtype(
-                batchIndicesType.getOptionalSizes(),
-                roisType.getOptionalDtype()),
+            batchIndicesType.getWithDtype(roisType.getOptionalDtype()),
             batchIndices, dTypeInt, cstFalse, cstFalse, none);
         SmallVector<int64_t> roiSizes(roisType.getSizes());
         roiSizes.back() = 5;
@@ -3303,8 +3345,7 @@ void mlir::torch::onnx_c::populateDefaultDomainQtoZ(
           return success();
         }
         // mode == "max"
-        auto indicesType = resultType.getWithSizesAndDtype(
-            resultType.getOptionalSizes(), batchIndicesType.getDtype());
+        auto indicesType = resultType.getWithDtype(batchIndicesType.getDtype());
         auto roiPool = Torch::TorchvisionRoiPoolOp::create(
             rewriter, loc, TypeRange{resultType, indicesType}, input, newRois,
             cstSpatialScale, pooledHeight, pooledWidth);
@@ -32,6 +32,55 @@ Value getDirection(ImplicitLocOpBuilder b, int64_t direction, Value input) {
   return AtenSelectIntOp::create(b, outputType, input, selectDim, cstDirection);
 }
 
+/**
+ * @brief Computes the input projections of all the timesteps of a layer.
+ *
+ * The input projection X_t*W^T + Wb of a recurrent layer does not depend on
+ * the hidden state, so it is computed for all the timesteps as one large
+ * matmul before the loop over them, rather than as seq_length small ones in
+ * the loop. The loop then only selects the projection of its timestep.
+ *
+ * @param X The input, of shape [seq_length, batch_size, input_size].
+ * @param W The input weights of all the gates, of shape
+ * [num_gates*hidden_size, input_size].
+ * @param Wb The input biases of all the gates, of shape
+ * [num_gates*hidden_size].
+ * @return The projections, of shape [seq_length, batch_size,
+ * num_gates*hidden_size].
+ */
+static Value projectInputs(ImplicitLocOpBuilder &b, Value X, Value W,
+                           Value Wb) {
+  auto xTy = cast<ValueTensorType>(X.getType());
+  auto wTy = cast<ValueTensorType>(W.getType());
+  auto projectionTy = b.getType<ValueTensorType>(
+      llvm::SmallVector<int64_t>{xTy.getSizes()[0], xTy.getSizes()[1],
+                                 wTy.getSizes()[0]},
+      xTy.getDtype());
+  return AtenLinearOp::create(b, projectionTy, X, W, Wb);
+}
+
+/**
+ * @brief Slices the input projection of one gate out of those of all gates.
+ *
+ * @param XWt The input projections of a timestep, as computed by
+ * projectInputs, of shape [batch_size, num_gates*hidden_size].
+ * @param gateTy The type of the projection of a gate, [batch_size,
+ * hidden_size].
+ * @param gate The index of the gate in the ONNX order of the weights.
+ */
+static Value sliceGateProjection(ImplicitLocOpBuilder &b, Value XWt,
+                                 ValueTensorType gateTy, int64_t gate) {
+  int64_t hidden_size = gateTy.getSizes()[1];
+  auto intType = b.getType<IntType>();
+  Value cstOne = ConstantIntOp::create(b, intType, b.getI64IntegerAttr(1));
+  Value start = ConstantIntOp::create(
+      b, intType, b.getI64IntegerAttr(gate * hidden_size));
+  Value end = ConstantIntOp::create(
+      b, intType, b.getI64IntegerAttr((gate + 1) * hidden_size));
+  return AtenSliceTensorOp::create(b, gateTy, XWt, /*dim=*/cstOne, start, end,
+                                   /*step=*/cstOne);
+}
+
 struct RnnWeights {
   Value Wi;
   Value Ri;
@@ -43,14 +92,15 @@ struct RnnActivations {
   std::string f;
 };
 
-Value rnn_cell(ImplicitLocOpBuilder &b, Value Xt, Value H_prev,
+// XWt is the input projection of the timestep, see projectInputs.
+Value rnn_cell(ImplicitLocOpBuilder &b, Value XWt, Value H_prev,
                RnnWeights weights, RnnActivations activations) {
   auto hTy = cast<ValueTensorType>(H_prev.getType());
 
   auto intType = b.getType<IntType>();
   Value cstOne = ConstantIntOp::create(b, intType, b.getI64IntegerAttr(1));
 
-  Value i_x = AtenLinearOp::create(b, hTy, Xt, weights.Wi, weights.Wbi);
+  Value i_x = XWt;
   Value i_h = AtenLinearOp::create(b, hTy, H_prev, weights.Ri, weights.Rbi);
   Value i = AtenAddTensorOp::create(b, hTy, i_x, i_h, cstOne);
 
@@ -71,7 +121,6 @@ RnnLayerOutput rnn_layer(ImplicitLocOpBuilder &b, Value X, Value initial_h,
   auto hTy = cast<ValueTensorType>(initial_h.getType());
   int64_t seq_len = xTy.getSizes()[0];
   int64_t batch_size = xTy.getSizes()[1];
-  int64_t input_size = xTy.getSizes()[2];
   int64_t hidden_size = hTy.getSizes()[1];
 
   auto intType = b.getType<IntType>();
@@ -101,6 +150,8 @@ RnnLayerOutput rnn_layer(ImplicitLocOpBuilder &b, Value X, Value initial_h,
   Value Y_initial = AtenZerosOp::create(b, yTy, YShapeList, hDtypeIntVal,
                                         cstNone, cstNone, cstNone);
 
+  Value XW = projectInputs(b, X, weights.Wi, weights.Wbi);
+
   Value maxTripCount =
       ConstantIntOp::create(b, intType, b.getI64IntegerAttr(seq_len));
   Value loopConditionTrue = ConstantBoolOp::create(b, true);
@@ -125,13 +176,12 @@ RnnLayerOutput rnn_layer(ImplicitLocOpBuilder &b, Value X, Value initial_h,
     Value Y_prev = loopBody->getArgument(1);
     Value H_prev = loopBody->getArgument(2);
 
-    auto xTy = cast<ValueTensorType>(X.getType());
-    auto XtType = b.getType<ValueTensorType>(
-        llvm::SmallVector<int64_t>{batch_size, input_size}, xTy.getDtype());
+    auto XWtType = b.getType<ValueTensorType>(
+        llvm::SmallVector<int64_t>{batch_size, hidden_size}, xTy.getDtype());
 
-    Value Xt = AtenSelectIntOp::create(b, XtType, X, cstZero, loopIndex);
+    Value XWt = AtenSelectIntOp::create(b, XWtType, XW, cstZero, loopIndex);
 
-    Value H_new = rnn_cell(b, Xt, H_prev, weights, activations);
+    Value H_new = rnn_cell(b, XWt, H_prev, weights, activations);
 
     Type hTyUnsqueezed = b.getType<ValueTensorType>(
         llvm::SmallVector<int64_t>{1, batch_size, hidden_size}, hTy.getDtype());
@@ -431,13 +481,13 @@ LogicalResult OnnxRnnExpander(OpBinder binder,
 // @struct LstmWeights
 // @brief A structure to hold LSTM weights.
 //
-// Each W_ weight matrix should have shape [hidden_size, input_size].
+// The W weight matrix of all the gates should have shape
+// [4 * hidden_size, input_size], and its bias Wb shape [4 * hidden_size].
 // Each R_ weight matrix should have shape [hidden_size, hidden_size].
-// Each bias vector should have shape [4 * hidden_size].
+// Each Rb_ bias vector should have shape [hidden_size].
 struct LstmWeights {
-  Value W_i, W_o, W_f, W_c;
+  Value W, Wb;
   Value R_i, R_o, R_f, R_c;
-  Value Wb_i, Wb_o, Wb_f, Wb_c;
   Value Rb_i, Rb_o, Rb_f, Rb_c;
 };
 struct LstmActivations {
@@ -453,7 +503,8 @@ struct LstmCellState {
 // This function represents a Long Short-Term Memory (LSTM) cell operation.
 //
 // @param b A builder for constructing operations.
-// @param Xt The input sequence. It has a shape of [batch_size, input_size].
+// @param XWt The input projection of the timestep, see projectInputs. It has
+// a shape of [batch_size, 4 * hidden_size].
 // @param H_prev The previous hidden state. It has a shape of [batch_size,
 // hidden_size].
 // @param C_prev The previous cell state. It has a shape of [batch_size,
@@ -462,7 +513,7 @@ struct LstmCellState {
 // @param activations The activation functions for the LSTM cell. Members f,g,h
 // correspond to f,g,h in https://onnx.ai/onnx/operators/onnx__LSTM.html
 // @return The state of the LSTM cell after the operation.
-LstmCellState lstm_cell(ImplicitLocOpBuilder &b, Value Xt, Value H_prev,
+LstmCellState lstm_cell(ImplicitLocOpBuilder &b, Value XWt, Value H_prev,
                         Value C_prev, LstmWeights weights,
                         LstmActivations activations) {
 
@@ -473,22 +524,22 @@ LstmCellState lstm_cell(ImplicitLocOpBuilder &b, Value Xt, Value H_prev,
 
   // Apply linear/matmul for each gate separately
   // names are consistent with ONNX LSTM documentation
-  Value i_x = AtenLinearOp::create(b, hTy, Xt, weights.W_i, weights.Wb_i);
+  Value i_x = sliceGateProjection(b, XWt, hTy, 0);
   Value i_h = AtenLinearOp::create(b, hTy, H_prev, weights.R_i, weights.Rb_i);
   Value i = AtenAddTensorOp::create(b, hTy, i_x, i_h, cstOne);
   Value i_act = createActivationByName(b, activations.f, i);
 
-  Value o_x = AtenLinearOp::create(b, hTy, Xt, weights.W_o, weights.Wb_o);
+  Value o_x = sliceGateProjection(b, XWt, hTy, 1);
   Value o_h = AtenLinearOp::create(b, hTy, H_prev, weights.R_o, weights.Rb_o);
   Value o = AtenAddTensorOp::create(b, hTy, o_x, o_h, cstOne);
   Value o_act = createActivationByName(b, activations.f, o);
 
-  Value f_x = AtenLinearOp::create(b, hTy, Xt, weights.W_f, weights.Wb_f);
+  Value f_x = sliceGateProjection(b, XWt, hTy, 2);
   Value f_h = AtenLinearOp::create(b, hTy, H_prev, weights.R_f, weights.Rb_f);
   Value f = AtenAddTensorOp::create(b, hTy, f_x, f_h, cstOne);
   Value f_act = createActivationByName(b, activations.f, f);
 
-  Value ct_x = AtenLinearOp::create(b, hTy, Xt, weights.W_c, weights.Wb_c);
+  Value ct_x = sliceGateProjection(b, XWt, hTy, 3);
   Value ct_h = AtenLinearOp::create(b, hTy, H_prev, weights.R_c, weights.Rb_c);
   Value ct = AtenAddTensorOp::create(b, hTy, ct_x, ct_h, cstOne);
   Value ct_act = createActivationByName(b, activations.g, ct);
@@ -512,10 +563,11 @@ struct LstmLayerOutput {
 // @brief This function implements the LSTM (Long Short-Term Memory) layer
 // operation.
 //
+// The input projections of all the timesteps are computed before the loop.
 // The core computation is performed in a loop that iterates over the sequence
-// length. In each iteration, it selects the corresponding input, computes the
-// new hidden state and cell state using the lstm_cell function, and updates the
-// output tensor.
+// length. In each iteration, it selects the corresponding input projection,
+// computes the new hidden state and cell state using the lstm_cell function,
+// and updates the output tensor.
 //
 // @return A struct containing the hidden state history, final hidden state,
 // and final cell state.
@@ -529,7 +581,6 @@ LstmLayerOutput lstm_layer(ConversionPatternRewriter &rewriter, Location &loc,
   // these names are snake_case for consistency with onnx.LSTM documentation
   Value seq_len = getTensorDimSize(rewriter, X, 0);
   Value batch_size = getTensorDimSize(rewriter, X, 1);
-  Value input_size = getTensorDimSize(rewriter, X, 2);
   int64_t hidden_size = hTy.getSizes()[1];
 
   auto cTy = hTy;
@@ -556,6 +607,8 @@ LstmLayerOutput lstm_layer(ConversionPatternRewriter &rewriter, Location &loc,
   Value Y_initial = AtenZerosOp::create(b, yTy, YShapeList, hDtypeIntVal,
                                         cstNone, cstNone, cstNone);
 
+  Value XW = projectInputs(b, X, weights.W, weights.Wb);
+
   // Create a for-like PrimLoopOp.
   Value maxTripCount = seq_len;
   Value loopConditionTrue = ConstantBoolOp::create(b, true);
@@ -583,13 +636,15 @@ LstmLayerOutput lstm_layer(ConversionPatternRewriter &rewriter, Location &loc,
     Value C_prev = loopBody->getArgument(3);
 
     auto xTy = cast<ValueTensorType>(X.getType());
-    auto XtType =
-        getTensorTypeFromShapeValues({batch_size, input_size}, xTy.getDtype());
+    Value cstGatesSize =
+        ConstantIntOp::create(b, intType, b.getI64IntegerAttr(4 * hidden_size));
+    auto XWtType = getTensorTypeFromShapeValues({batch_size, cstGatesSize},
+                                                xTy.getDtype());
 
-    Value Xt = AtenSelectIntOp::create(b, XtType, X, cstZero, loopIndex);
+    Value XWt = AtenSelectIntOp::create(b, XWtType, XW, cstZero, loopIndex);
 
     auto [H_new, C_new] =
-        lstm_cell(b, Xt, H_prev, C_prev, weights, activations);
+        lstm_cell(b, XWt, H_prev, C_prev, weights, activations);
 
     auto hTyUnsqueezed = getTensorTypeFromShapeValues(
         {cstOne, batch_size, cstHiddenSize}, hTy.getDtype());
@@ -774,7 +829,6 @@ LogicalResult OnnxLstmExpander(OpBinder binder,
 
   int64_t x_input_size = xTy.getSizes()[2];
   int64_t w_input_size = wTy.getSizes()[2];
-  int64_t input_size = w_input_size;
   if (num_directions != wTy.getSizes()[0])
     return rewriter.notifyMatchFailure(
         binder.op, "num_directions (" + std::to_string(num_directions) +
@@ -918,9 +972,6 @@ LogicalResult OnnxLstmExpander(OpBinder binder,
   auto gateBiasType = b.getType<ValueTensorType>(
       llvm::SmallVector<int64_t>{hidden_size},
       cast<ValueTensorType>(Wb.getType()).getDtype());
-  auto gateWeightsTypeIH = b.getType<ValueTensorType>(
-      llvm::SmallVector<int64_t>{hidden_size, input_size},
-      cast<ValueTensorType>(W_forward.getType()).getDtype());
   auto gateWeightsTypeHH = b.getType<ValueTensorType>(
       llvm::SmallVector<int64_t>{hidden_size, hidden_size},
       cast<ValueTensorType>(R_forward.getType()).getDtype());
@@ -940,16 +991,14 @@ LogicalResult OnnxLstmExpander(OpBinder binder,
         slicerFunction(forgetGateWeightsEndIdx, cellGateWeightsEndIdx, WoB));
   };
 
-  auto sliceGateBias = [&](Value startIdx, Value endIdx, Value WoB) {
-    return AtenSliceTensorOp::create(b, gateBiasType, WoB, cstZero, startIdx,
-                                     endIdx, cstOne);
-  };
-  std::tie(weights.Wb_i, weights.Wb_o, weights.Wb_f, weights.Wb_c) =
-      sliceIOFC(sliceGateBias, Wb);
-
-  if (isBidirectional)
-    std::tie(weightsRev.Wb_i, weightsRev.Wb_o, weightsRev.Wb_f,
-             weightsRev.Wb_c) = sliceIOFC(sliceGateBias, Wb_reverse);
+  // The input weights are kept whole, so that lstm_layer projects the inputs
+  // of all the gates with one matmul.
+  weights.W = W_forward;
+  weights.Wb = Wb;
+  if (isBidirectional) {
+    weightsRev.W = W_reverse;
+    weightsRev.Wb = Wb_reverse;
+  }
 
   auto sliceGateBiasR = [&](Value startIdx, Value endIdx, Value WoB) {
     return AtenSliceTensorOp::create(b, gateBiasType, WoB, cstZero, startIdx,
@@ -962,17 +1011,6 @@ LogicalResult OnnxLstmExpander(OpBinder binder,
     std::tie(weightsRev.Rb_i, weightsRev.Rb_o, weightsRev.Rb_f,
              weightsRev.Rb_c) = sliceIOFC(sliceGateBiasR, Rb_reverse);
 
-  auto sliceGateWeightsIH = [&](Value startIdx, Value endIdx, Value WoB) {
-    return AtenSliceTensorOp::create(b, gateWeightsTypeIH, WoB, cstZero,
-                                     startIdx, endIdx, cstOne);
-  };
-  std::tie(weights.W_i, weights.W_o, weights.W_f, weights.W_c) =
-      sliceIOFC(sliceGateWeightsIH, W_forward);
-
-  if (isBidirectional)
-    std::tie(weightsRev.W_i, weightsRev.W_o, weightsRev.W_f, weightsRev.W_c) =
-        sliceIOFC(sliceGateWeightsIH, W_reverse);
-
   auto sliceGateWeightsHH = [&](Value startIdx, Value endIdx, Value WoB) {
     return AtenSliceTensorOp::create(b, gateWeightsTypeHH, WoB, cstZero,
                                      startIdx, endIdx, cstOne);
@@ -1091,22 +1129,18 @@ LogicalResult OnnxLstmExpander(OpBinder binder,
   return success();
 }
 
-// W[zrh] - W parameter weight matrix for update, reset, and hidden gates
+// W - W parameter weight matrix of the update, reset, and hidden gates
 // R[zrh] - R recurrence weight matrix for update, reset, and hidden gates
-// Wb[zrh] - W bias vectors for update, reset, and hidden gates
+// Wb - W bias vector of the update, reset, and hidden gates
 // Rb[zrh] - R bias vectors for update, reset, and hidden gates
 // backwards currently not supported
 
 struct GruWeights {
-  Value Wz;
-  Value Wr;
-  Value Wh;
+  Value W;
   Value Rz;
   Value Rr;
   Value Rh;
-  Value Wbz;
-  Value Wbr;
-  Value Wbh;
+  Value Wb;
   Value Rbz;
   Value Rbr;
   Value Rbh;
@@ -1122,7 +1156,8 @@ struct GruActivations {
   std::string g;
 };
 
-Value gru_cell(ImplicitLocOpBuilder &b, Value Xt, Value H_prev,
+// XWt is the input projection of the timestep, see projectInputs.
+Value gru_cell(ImplicitLocOpBuilder &b, Value XWt, Value H_prev,
                GruWeights weights, GruActivations activations,
                bool linear_before_reset) {
   auto hTy = cast<ValueTensorType>(H_prev.getType());
@@ -1130,17 +1165,17 @@ Value gru_cell(ImplicitLocOpBuilder &b, Value Xt, Value H_prev,
   auto intType = b.getType<IntType>();
   Value cstOne = ConstantIntOp::create(b, intType, b.getI64IntegerAttr(1));
 
-  Value z_w = AtenLinearOp::create(b, hTy, Xt, weights.Wz, weights.Wbz);
+  Value z_w = sliceGateProjection(b, XWt, hTy, 0);
   Value z_r = AtenLinearOp::create(b, hTy, H_prev, weights.Rz, weights.Rbz);
   Value z_pre = AtenAddTensorOp::create(b, hTy, z_w, z_r, cstOne);
   Value zt = createActivationByName(b, activations.f, z_pre);
 
-  Value r_w = AtenLinearOp::create(b, hTy, Xt, weights.Wr, weights.Wbr);
+  Value r_w = sliceGateProjection(b, XWt, hTy, 1);
   Value r_r = AtenLinearOp::create(b, hTy, H_prev, weights.Rr, weights.Rbr);
   Value r_pre = AtenAddTensorOp::create(b, hTy, r_w, r_r, cstOne);
   Value rt = createActivationByName(b, activations.f, r_pre);
 
-  Value h_w = AtenLinearOp::create(b, hTy, Xt, weights.Wh, weights.Wbh);
+  Value h_w = sliceGateProjection(b, XWt, hTy, 2);
   Value h_r;
   if (linear_before_reset) {
     // when linear_before_reset = 1, multiply r with H_prev to reset
@@ -1186,7 +1221,6 @@ GruLayerOutput gru_layer(ImplicitLocOpBuilder &b, Value X, Value initial_h,
 
   int64_t seq_len = xTySizes[0];
   int64_t batch_size = xTySizes[1];
-  int64_t input_size = xTySizes[2];
   int64_t hidden_size = hTySizes[1];
 
   auto intType = b.getType<IntType>();
@@ -1215,6 +1249,8 @@ GruLayerOutput gru_layer(ImplicitLocOpBuilder &b, Value X, Value initial_h,
   Value Y_initial = AtenZerosOp::create(b, yTy, YShapeList, hDtypeIntVal,
                                         cstNone, cstNone, cstNone);
 
+  Value XW = projectInputs(b, X, weights.W, weights.Wb);
+
   Value maxTripCount = cstSeqLen;
   Value loopConditionTrue = ConstantBoolOp::create(b, true);
 
@@ -1234,13 +1270,14 @@ GruLayerOutput gru_layer(ImplicitLocOpBuilder &b, Value X, Value initial_h,
     Value Y_prev = loopBody->getArgument(1);
     Value H_prev = loopBody->getArgument(2);
 
-    auto XtType = b.getType<ValueTensorType>(
-        llvm::SmallVector<int64_t>{batch_size, input_size}, xTy.getDtype());
+    auto XWtType = b.getType<ValueTensorType>(
+        llvm::SmallVector<int64_t>{batch_size, 3 * hidden_size},
+        xTy.getDtype());
 
-    Value Xt = AtenSelectIntOp::create(b, XtType, X, cstZero, loopIndex);
+    Value XWt = AtenSelectIntOp::create(b, XWtType, XW, cstZero, loopIndex);
 
     Value H_new =
-        gru_cell(b, Xt, H_prev, weights, activations, linear_before_reset);
+        gru_cell(b, XWt, H_prev, weights, activations, linear_before_reset);
 
     Type hTyUnsqueezed = b.getType<ValueTensorType>(
         llvm::SmallVector<int64_t>{1, batch_size, hidden_size}, hTy.getDtype());
@@ -1437,12 +1474,9 @@ LogicalResult OnnxGruExpander(OpBinder binder,
     return slices;
   };
 
-  // Slice W
-  auto wSliceType = b.getType<ValueTensorType>(
-      llvm::SmallVector<int64_t>{hidden_size, input_size}, wTy.getDtype());
-  auto W_slices = sliceTensor(W_forward, hidden_size, 3, wSliceType);
-  std::tie(weights.Wz, weights.Wr, weights.Wh) =
-      std::make_tuple(W_slices[0], W_slices[1], W_slices[2]);
+  // W is kept whole, so that gru_layer projects the inputs of all the gates
+  // with one matmul.
+  weights.W = W_forward;
 
   // Slice R
   auto rSliceType = b.getType<ValueTensorType>(
@@ -1451,14 +1485,22 @@ LogicalResult OnnxGruExpander(OpBinder binder,
   std::tie(weights.Rz, weights.Rr, weights.Rh) =
       std::make_tuple(R_slices[0], R_slices[1], R_slices[2]);
 
-  // Slice B
+  // Slice B into Wb and the biases of each gate of R
+  auto wbType = b.getType<ValueTensorType>(
+      llvm::SmallVector<int64_t>{3 * hidden_size}, wTy.getDtype());
+  Value cstWbSize =
+      ConstantIntOp::create(b, intType, b.getI64IntegerAttr(3 * hidden_size));
+  Value cstBSize =
+      ConstantIntOp::create(b, intType, b.getI64IntegerAttr(6 * hidden_size));
+  weights.Wb = AtenSliceTensorOp::create(b, wbType, B_forward, cstZero,
+                                         cstZero, cstWbSize, cstOne);
+  Value Rb = AtenSliceTensorOp::create(b, wbType, B_forward, cstZero,
+                                       cstWbSize, cstBSize, cstOne);
   auto bSliceType = b.getType<ValueTensorType>(
       llvm::SmallVector<int64_t>{hidden_size}, wTy.getDtype());
-  auto B_slices = sliceTensor(B_forward, hidden_size, 6, bSliceType);
-  std::tie(weights.Wbz, weights.Wbr, weights.Wbh, weights.Rbz, weights.Rbr,
-           weights.Rbh) =
-      std::make_tuple(B_slices[0], B_slices[1], B_slices[2], B_slices[3],
-                      B_slices[4], B_slices[5]);
+  auto Rb_slices = sliceTensor(Rb, hidden_size, 3, bSliceType);
+  std::tie(weights.Rbz, weights.Rbr, weights.Rbh) =
+      std::make_tuple(Rb_slices[0], Rb_slices[1], Rb_slices[2]);
 
   // Process inputs based on layout
   if (layout == 1) {
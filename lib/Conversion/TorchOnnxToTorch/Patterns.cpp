@@ -24,28 +24,21 @@ LogicalResult OnnxCustomOpConversionPattern::matchAndRewrite(
   auto foundIt = namedHandlers.find(op.getNameAttr());
   if (foundIt == namedHandlers.end())
     return failure();
-  auto &reggies = foundIt->second;
-  for (const HandlerReg &reg : reggies) {
-    if (domainVersion < reg.sinceVersion) {
-      LLVM_DEBUG(dbgs() << ": skipping conversion " << foundIt->first
-                        << ", sinceVersion=" << reg.sinceVersion
-                        << ", for domainVersion=" << domainVersion << "\n");
-      continue;
-    }
-    if (succeeded(reg.callback(OpBinder(op), rewriter))) {
+  // The conversions for versions newer than `domainVersion` were dropped
+  // when they were registered, so all of these apply.
+  for (const HandlerReg &reg : foundIt->second) {
+    if (succeeded(reg.callback(OpBinder(op), rewriter)))
       return success();
-    } else {
-      LLVM_DEBUG(dbgs() << ": conversion failed to apply: " << foundIt->first
-                        << ", sinceVersion=" << reg.sinceVersion << "\n");
-    }
+    LLVM_DEBUG(dbgs() << ": conversion failed to apply: " << foundIt->first
+                      << ", sinceVersion=" << reg.sinceVersion << "\n");
   }
   return rewriter.notifyMatchFailure(op, "no matching versioned converter");
 }
 
 void OnnxCustomOpConversionPattern::populateLegalizedNames(
     DenseSet<StringAttr> &legalizedNames) {
-  for (auto it : namedHandlers)
-    legalizedNames.insert(it.first);
+  for (StringAttr name : namedHandlers.keys())
+    legalizedNames.insert(name);
 }
 
 void OnnxCustomOpConversionPattern::onOp(StringRef name, int64_t sinceVersion,
@@ -53,7 +46,16 @@ void OnnxCustomOpConversionPattern::onOp(StringRef name, int64_t sinceVersion,
   SmallString<64> fullName(domainPrefix);
   fullName.append(name);
   StringAttr nameAttr = StringAttr::get(getContext(), fullName);
-  namedHandlers[nameAttr].push_back(HandlerReg(callback, sinceVersion));
+  // The name is legalized even if none of its conversions applies to this
+  // version, so that such ops fail the conversion rather than being kept.
+  SmallVector<HandlerReg, 1> &handlers = namedHandlers[nameAttr];
+  if (domainVersion < sinceVersion) {
+    LLVM_DEBUG(dbgs() << ": skipping conversion " << nameAttr
+                      << ", sinceVersion=" << sinceVersion
+                      << ", for domainVersion=" << domainVersion << "\n");
+    return;
+  }
+  handlers.push_back(HandlerReg(std::move(callback), sinceVersion));
 }
 
 void OnnxCustomOpConversionPattern::onOp(StringRef name, int64_t sinceVersion,
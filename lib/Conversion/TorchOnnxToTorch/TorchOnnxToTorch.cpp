@@ -27,6 +27,13 @@ namespace mlir::torch::onnx_c {
 
 #define DEBUG_TYPE "torch-onnx"
 
+/// The patterns for one opset version and the names they legalize, which
+/// are cached in the context and shared by all instances of the pass.
+struct ConversionTables {
+  FrozenRewritePatternSet patterns;
+  DenseSet<StringAttr> legalizedNames;
+};
+
 namespace {
 
 int64_t getDefaultOpsetVersion(Operation *containerOp) {
@@ -60,32 +67,56 @@ public:
       return signalPassFailure();
     }
 
-    OnnxTorchToTorchOptions options{allowNonFinites};
-
-    auto defaultDomainPatterns =
-        std::make_unique<OnnxCustomOpConversionPattern>(
-            context, "onnx.",
-            /*domainVersion=*/defaultOpsetVersion, options);
-    populateComMicrosoftDomain(*defaultDomainPatterns);
-    populateDefaultDomainAtoF(*defaultDomainPatterns);
-    populateDefaultDomainGtoP(*defaultDomainPatterns);
-    populateDefaultDomainQtoZ(*defaultDomainPatterns, options);
+    // Building the handler tables and running the conversion driver is not
+    // free, so functions without ONNX ops, e.g. ones that were already
+    // converted, are left alone.
+    bool hasOnnxOps = getOperation()
+                          .walk([](Torch::OperatorOp op) {
+                            return op.getName().starts_with("onnx.")
+                                       ? WalkResult::interrupt()
+                                       : WalkResult::advance();
+                          })
+                          .wasInterrupted();
+    if (!hasOnnxOps)
+      return;
+
+    // Building the several hundred handlers below is expensive, and so is
+    // uniquing their names, which takes the lock of the context. Each
+    // function of a module converted in parallel would otherwise pay for
+    // both, so the tables are built once per opset version and options.
+    std::string key = (getArgument() + ":" + Twine(defaultOpsetVersion) +
+                       (allowNonFinites ? ":1" : ":0"))
+                          .str();
+    auto *dialect = context->getOrLoadDialect<Torch::TorchDialect>();
+    auto *tables = dialect->getOrCreateCached<ConversionTables>(key, [&]() {
+      OnnxTorchToTorchOptions options{allowNonFinites};
+      auto defaultDomainPatterns =
+          std::make_unique<OnnxCustomOpConversionPattern>(
+              context, "onnx.",
+              /*domainVersion=*/defaultOpsetVersion, options);
+      populateComMicrosoftDomain(*defaultDomainPatterns);
+      populateDefaultDomainAtoF(*defaultDomainPatterns);
+      populateDefaultDomainGtoP(*defaultDomainPatterns);
+      populateDefaultDomainQtoZ(*defaultDomainPatterns, options);
+
+      // Ask each domain for its handled names, which configure the
+      // conversion target.
+      auto result = std::make_unique<ConversionTables>();
+      defaultDomainPatterns->populateLegalizedNames(result->legalizedNames);
+      RewritePatternSet patterns(context);
+      patterns.insert(std::move(defaultDomainPatterns));
+      result->patterns = FrozenRewritePatternSet(std::move(patterns));
+      return result;
+    });
 
-    // Ask each domain for its handled names and configure the
-    // conversion target.
     ConversionTarget target(*context);
-    DenseSet<StringAttr> legalizedNames;
-    defaultDomainPatterns->populateLegalizedNames(legalizedNames);
     target.addLegalDialect<Torch::TorchDialect>();
     target.addDynamicallyLegalOp<Torch::OperatorOp>([&](Torch::OperatorOp op) {
-      return !legalizedNames.contains(op.getNameAttr());
+      return !tables->legalizedNames.contains(op.getNameAttr());
     });
 
-    RewritePatternSet patterns(context);
-    patterns.insert(std::move(defaultDomainPatterns));
-
-    if (failed(applyPartialConversion(getOperation(), target,
-                                      std::move(patterns))))
+    if (failed(
+            applyPartialConversion(getOperation(), target, tables->patterns)))
       return signalPassFailure();
   }
 };
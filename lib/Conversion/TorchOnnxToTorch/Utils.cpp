@@ -201,3 +201,131 @@ LogicalResult mlir::torch::onnx_c::createDequantizeTensor(
 
   return success();
 }
+
+// Shape computations are short chains, so the evaluation gives up on longer
+// ones rather than walking far up the operands of every op it converts.
+static constexpr unsigned kMaxShapeComputationDepth = 16;
+
+static LogicalResult
+evaluateConstantIntTensorImpl(Value value, SmallVectorImpl<int64_t> &values,
+                              unsigned depth) {
+  auto type = dyn_cast<Torch::ValueTensorType>(value.getType());
+  if (depth > kMaxShapeComputationDepth || !type || !type.hasSizes() ||
+      type.getSizes().size() > 1 || !type.hasDtype() ||
+      !type.getDtype().isSignedInteger())
+    return failure();
+  Operation *op = value.getDefiningOp();
+  if (!op)
+    return failure();
+
+  // The operands of an op that is not converted yet are still the results of
+  // ONNX ops, while those converted by `foldConstantIntTensor` are literals.
+  SmallVector<int64_t> result;
+  if (auto literal = dyn_cast<Torch::ValueTensorLiteralOp>(op)) {
+    auto attr = dyn_cast<DenseIntElementsAttr>(literal.getValue());
+    if (!attr)
+      return failure();
+    for (const APInt &element : attr.getValues<APInt>())
+      result.push_back(element.getSExtValue());
+  } else if (auto onnxOp = dyn_cast<Torch::OperatorOp>(op)) {
+    StringRef name = onnxOp.getName();
+    OpBinder binder(op);
+    if (name == "onnx.Constant") {
+      if (!matchPattern(value, m_OnnxListOfConstantInts(result)))
+        return failure();
+    } else if (name == "onnx.Shape") {
+      auto inputType =
+          dyn_cast<Torch::ValueTensorType>(op->getOperand(0).getType());
+      if (!inputType || !inputType.areAllSizesKnown())
+        return failure();
+      ArrayRef<int64_t> sizes = inputType.getSizes();
+      int64_t rank = sizes.size();
+      int64_t start, end;
+      if (binder.s64IntegerAttr(start, "start", 0) ||
+          binder.s64IntegerAttr(end, "end", rank))
+        return failure();
+      start = std::clamp<int64_t>(start < 0 ? start + rank : start, 0, rank);
+      end = std::clamp<int64_t>(end < 0 ? end + rank : end, start, rank);
+      result.append(sizes.begin() + start, sizes.begin() + end);
+    } else if (name == "onnx.Gather") {
+      int64_t axis;
+      SmallVector<int64_t> data, indices;
+      if (binder.s64IntegerAttr(axis, "axis", 0) || (axis != 0 && axis != -1) ||
+          failed(evaluateConstantIntTensorImpl(op->getOperand(0), data,
+                                               depth + 1)) ||
+          failed(evaluateConstantIntTensorImpl(op->getOperand(1), indices,
+                                               depth + 1)) ||
+          cast<Torch::ValueTensorType>(op->getOperand(0).getType())
+                  .getSizes()
+                  .size() != 1)
+        return failure();
+      int64_t numElements = data.size();
+      for (int64_t index : indices) {
+        if (index < 0)
+          index += numElements;
+        if (index < 0 || index >= numElements)
+          return failure();
+        result.push_back(data[index]);
+      }
+    } else if (name == "onnx.Unsqueeze" || name == "onnx.Squeeze") {
+      // The tensors here have at most one element per dim, so these only
+      // change the rank.
+      if (op->getNumOperands() < 1 ||
+          failed(evaluateConstantIntTensorImpl(op->getOperand(0), result,
+                                               depth + 1)))
+        return failure();
+    } else if (name == "onnx.Concat") {
+      int64_t axis;
+      if (binder.s64IntegerAttr(axis, "axis", 0) || (axis != 0 && axis != -1))
+        return failure();
+      for (Value operand : op->getOperands())
+        if (failed(evaluateConstantIntTensorImpl(operand, result, depth + 1)))
+          return failure();
+    } else if (name == "onnx.Cast") {
+      if (failed(evaluateConstantIntTensorImpl(op->getOperand(0), result,
+                                               depth + 1)))
+        return failure();
+      unsigned bitWidth = type.getDtype().getIntOrFloatBitWidth();
+      for (int64_t &element : result)
+        element = APInt(64, element, /*isSigned=*/true)
+                      .sextOrTrunc(bitWidth)
+                      .getSExtValue();
+    } else {
+      return failure();
+    }
+  } else {
+    return failure();
+  }
+
+  int64_t numElements = type.getSizes().empty() ? 1 : type.getSizes()[0];
+  if (numElements != Torch::kUnknownSize &&
+      numElements != static_cast<int64_t>(result.size()))
+    return failure();
+  values.append(result.begin(), result.end());
+  return success();
+}
+
+LogicalResult mlir::torch::onnx_c::evaluateConstantIntTensor(
+    Value value, SmallVectorImpl<int64_t> &values) {
+  return evaluateConstantIntTensorImpl(value, values, /*depth=*/0);
+}
+
+LogicalResult mlir::torch::onnx_c::foldConstantIntTensor(
+    OpBinder binder, ConversionPatternRewriter &rewriter) {
+  if (binder.getNumResults() != 1)
+    return failure();
+  Value result = binder.op->getResult(0);
+  auto resultType = dyn_cast<Torch::ValueTensorType>(result.getType());
+  SmallVector<int64_t> values;
+  if (!resultType || !resultType.areAllSizesKnown() ||
+      failed(evaluateConstantIntTensor(result, values)))
+    return failure();
+  unsigned bitWidth = resultType.getDtype().getIntOrFloatBitWidth();
+  SmallVector<APInt> apValues;
+  for (int64_t value : values)
+    apValues.push_back(APInt(bitWidth, value, /*isSigned=*/true));
+  auto attr = DenseElementsAttr::get(resultType.toBuiltinTensor(), apValues);
+  rewriter.replaceOpWithNewOp<Torch::ValueTensorLiteralOp>(binder.op,
+                                                           resultType, attr);
+  return success();
+}
@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// Rewrites the 2D convolutions produced by the TorchToLinalg patterns into
+// forms that perform well without a dedicated convolution code generator:
+// im2col followed by a matmul, or Winograd F(2x2,3x3) / F(4x4,3x3).
+//
+//===----------------------------------------------------------------------===//
+
+#include "PopulatePatterns.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "llvm/ADT/StringSwitch.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::torch_to_linalg;
+
+std::optional<ConvolutionStrategy>
+torch_to_linalg::parseConvolutionStrategy(StringRef name) {
+  return llvm::StringSwitch<std::optional<ConvolutionStrategy>>(name)
+      .Case("direct", ConvolutionStrategy::Direct)
+      .Case("im2col", ConvolutionStrategy::Im2Col)
+      .Case("winograd", ConvolutionStrategy::Winograd)
+      .Case("auto", ConvolutionStrategy::Auto)
+      .Default(std::nullopt);
+}
+
+namespace {
+// The static shape of a 2D convolution, in PyTorch terms.
+struct ConvShape {
+  int64_t batch, inChannels, outChannels;
+  int64_t kernelH, kernelW, outH, outW;
+  bool unitStridesAndDilations;
+};
+} // namespace
+
+// Returns the shape of `op`, which is either channels-first (NCHW input and
+// FCHW filter) or channels-last (NHWC input and HWCF filter), or failure if
+// any of it is dynamic.
+static FailureOr<ConvShape> getStaticConvShape(linalg::LinalgOp op,
+                                               bool channelsLast) {
+  auto inputType = cast<RankedTensorType>(op.getDpsInputs()[0].getType());
+  auto filterType = cast<RankedTensorType>(op.getDpsInputs()[1].getType());
+  auto initType = cast<RankedTensorType>(op.getDpsInits()[0].getType());
+  if (!inputType.hasStaticShape() || !filterType.hasStaticShape() ||
+      !initType.hasStaticShape())
+    return failure();
+  ArrayRef<int64_t> in = inputType.getShape();
+  ArrayRef<int64_t> filter = filterType.getShape();
+
+  DenseIntElementsAttr stridesAttr, dilationsAttr;
+  if (auto nchw = dyn_cast<linalg::Conv2DNchwFchwOp>(op.getOperation())) {
+    stridesAttr = nchw.getStrides();
+    dilationsAttr = nchw.getDilations();
+  } else {
+    auto nhwc = cast<linalg::Conv2DNhwcHwcfOp>(op.getOperation());
+    stridesAttr = nhwc.getStrides();
+    dilationsAttr = nhwc.getDilations();
+  }
+  SmallVector<int64_t> strides(stridesAttr.getValues<int64_t>());
+  SmallVector<int64_t> dilations(dilationsAttr.getValues<int64_t>());
+
+  ConvShape shape;
+  shape.batch = in[0];
+  int64_t inH, inW;
+  if (channelsLast) {
+    inH = in[1];
+    inW = in[2];
+    shape.inChannels = in[3];
+    shape.kernelH = filter[0];
+    shape.kernelW = filter[1];
+    shape.outChannels = filter[3];
+  } else {
+    shape.inChannels = in[1];
+    inH = in[2];
+    inW = in[3];
+    shape.outChannels = filter[0];
+    shape.kernelH = filter[2];
+    shape.kernelW = filter[3];
+  }
+  // The input has already been padded.
+  shape.outH = (inH - dilations[0] * (shape.kernelH - 1) - 1) / strides[0] + 1;
+  shape.outW = (inW - dilations[1] * (shape.kernelW - 1) - 1) / strides[1] + 1;
+  auto isOne = [](int64_t v) { return v == 1; };
+  shape.unitStridesAndDilations =
+      llvm::all_of(strides, isOne) && llvm::all_of(dilations, isOne);
+  return shape;
+}
+
+static Value transpose(RewriterBase &rewriter, Location loc, Value value,
+                       ArrayRef<int64_t> perms) {
+  auto type = cast<RankedTensorType>(value.getType());
+  SmallVector<int64_t> shape = applyPermutation(type.getShape(), perms);
+  Value empty =
+      tensor::EmptyOp::create(rewriter, loc, shape, type.getElementType());
+  return linalg::TransposeOp::create(rewriter, loc, value, empty, perms)
+      ->getResult(0);
+}
+
+// Winograd is only defined upstream for NHWC inputs with FHWC filters, so
+// re-express `op` in that layout and apply F(m x m, 3x3) to it.
+static LogicalResult applyWinograd(RewriterBase &rewriter, linalg::LinalgOp op,
+                                   bool channelsLast,
+                                   linalg::WinogradConv2DFmr fmr) {
+  Location loc = op.getLoc();
+  rewriter.setInsertionPoint(op);
+  Value input = op.getDpsInputs()[0];
+  Value filter = op.getDpsInputs()[1];
+  Value init = op.getDpsInits()[0];
+  if (channelsLast) {
+    filter = transpose(rewriter, loc, filter, {3, 0, 1, 2});
+  } else {
+    input = transpose(rewriter, loc, input, {0, 2, 3, 1});
+    filter = transpose(rewriter, loc, filter, {0, 2, 3, 1});
+    init = transpose(rewriter, loc, init, {0, 2, 3, 1});
+  }
+  auto unitAttr = rewriter.getI64VectorAttr({1, 1});
+  auto conv = linalg::Conv2DNhwcFhwcOp::create(
+      rewriter, loc, init.getType(), ValueRange{input, filter}, init, unitAttr,
+      unitAttr);
+  Value result = conv.getResult(0);
+  if (!channelsLast)
+    result = transpose(rewriter, loc, result, {0, 3, 1, 2});
+  rewriter.replaceOp(op, result);
+  return linalg::winogradConv2D(rewriter, conv, fmr);
+}
+
+// Which rewrite to use for one convolution. Winograd trades multiplications
+// for transforms of the input, filter and output tiles, which only pays off
+// once there are enough channels to amortize them; F(4x4,3x3) saves more
+// multiplications than F(2x2,3x3) but wastes more work on partial tiles, so
+// it is kept for larger outputs. Everything else goes through im2col.
+static void rewriteConvolution(RewriterBase &rewriter, linalg::LinalgOp op,
+                               bool channelsLast,
+                               ConvolutionStrategy strategy) {
+  FailureOr<ConvShape> shape = getStaticConvShape(op, channelsLast);
+  if (failed(shape))
+    return;
+
+  bool winogradApplies = shape->kernelH == 3 && shape->kernelW == 3 &&
+                         shape->unitStridesAndDilations;
+  bool winogradPaysOff =
+      winogradApplies && shape->inChannels >= 8 && shape->outChannels >= 8;
+  if ((strategy == ConvolutionStrategy::Winograd && winogradApplies) ||
+      (strategy == ConvolutionStrategy::Auto && winogradPaysOff)) {
+    auto fmr = shape->outH >= 8 && shape->outW >= 8
+                   ? linalg::WinogradConv2DFmr::F_4_3
+                   : linalg::WinogradConv2DFmr::F_2_3;
+    (void)applyWinograd(rewriter, op, channelsLast, fmr);
+    return;
+  }
+  if (strategy == ConvolutionStrategy::Winograd)
+    return;
+
+  rewriter.setInsertionPoint(op);
+  if (channelsLast)
+    (void)linalg::rewriteInIm2Col(rewriter,
+                                  cast<linalg::Conv2DNhwcHwcfOp>(op));
+  else
+    (void)linalg::rewriteInIm2Col(rewriter,
+                                  cast<linalg::Conv2DNchwFchwOp>(op));
+}
+
+LogicalResult
+torch_to_linalg::applyConvolutionStrategy(Operation *root,
+                                          ConvolutionStrategy strategy) {
+  if (strategy == ConvolutionStrategy::Direct)
+    return success();
+
+  // The patterns compute padding and output sizes with index arithmetic on
+  // the converted torch scalars, so the convolutions only get their static
+  // types, which the rewrites below require, once that is folded.
+  MLIRContext *context = root->getContext();
+  RewritePatternSet canonicalizations(context);
+  for (Dialect *dialect : context->getLoadedDialects())
+    dialect->getCanonicalizationPatterns(canonicalizations);
+  for (RegisteredOperationName op : context->getRegisteredOperations())
+    op.getCanonicalizationPatterns(canonicalizations, context);
+  (void)applyPatternsGreedily(root, std::move(canonicalizations));
+
+  SmallVector<std::pair<linalg::LinalgOp, bool>> convs;
+  root->walk([&](Operation *op) {
+    if (isa<linalg::Conv2DNchwFchwOp>(op))
+      convs.push_back({cast<linalg::LinalgOp>(op), /*channelsLast=*/false});
+    else if (isa<linalg::Conv2DNhwcHwcfOp>(op))
+      convs.push_back({cast<linalg::LinalgOp>(op), /*channelsLast=*/true});
+  });
+  if (convs.empty())
+    return success();
+
+  IRRewriter rewriter(context);
+  for (auto [conv, channelsLast] : convs) {
+    if (conv.hasPureTensorSemantics())
+      rewriteConvolution(rewriter, conv, channelsLast, strategy);
+  }
+
+  // Leave plain linalg behind rather than the Winograd transform ops, which
+  // most backends do not handle.
+  RewritePatternSet patterns(context);
+  linalg::populateDecomposeWinogradOpsPatterns(patterns);
+  return applyPatternsGreedily(root, std::move(patterns));
+}
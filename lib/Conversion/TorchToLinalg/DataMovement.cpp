@@ -13,6 +13,7 @@
 
 #include "PopulatePatterns.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Arith/Utils/Utils.h"
 #include "mlir/Dialect/Complex/IR/Complex.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
@@ -142,27 +143,8 @@ LogicalResult prepareArgumentsForSlicingOp(OpTy op, OpAdaptor adaptor,
 //                   [7., 6., 5., 4., 5., 6., 7., 6.]]])
 // Checks: 1) Each of padding_left and padding_right must be non-negative and
 //            less than the size of the last dimension.
-// Implementation: a) Construct a result tensor of
-// shape of input tensor except for the last dimension.
-//                    The last dimension of the result tensor should be last
-//                    dimension of input tensor + left padding size + right
-//                    padding size. Initialize result tensor to all zeros
-//                 b) Setup affine map to take slice from input tensor of size
-//                 left padding starting from
-//                    second column onwards as first column is reflection
-//                    boundary
-//                 c) Reflect the affine map to have resultant slice reflected
-//                 d) Take the slice and write from begining in result tensor
-//                 e) write the original tensor next into result tensor
-//                 f) Setup affine map to take slice from input tensor of right
-//                 padding size ending
-//                    at second last column as last column is reflection
-//                    boundary for right padding
-//                 g) Reflect the affine map to have resultant slice reflected
-//                 h) Take the slice and write from left padding size + orignal
-//                 tensor last dim size
-//                    into result tensor
-// Uses the ideas/code used for AtenReflectionPad2dOp
+// Implementation: a single linalg.generic over the result whose body reads
+// the input at the index reflected into it, see `getIndexPaddedTensor`.
 namespace {
 class ConvertAtenReflectionPad1dOp
     : public OpConversionPattern<AtenReflectionPad1dOp> {
@@ -179,116 +161,14 @@ public:
       return rewriter.notifyMatchFailure(
           op, "only constant int padding range is supported");
 
-    MLIRContext *context = rewriter.getContext();
-    Location loc = op.getLoc();
-
-    // Lambda Unitility Functions
-    // Create an Integer expression of x + y
-    auto createIAdd = [&](Value x, Value y) {
-      return arith::AddIOp::create(rewriter, loc, x, y);
-    };
-
-    // Create an integer expression of x - y
-    auto createISub = [&](Value x, Value y) {
-      return arith::SubIOp::create(rewriter, loc, x, y);
-    };
-
-    enum PadLocation { PAD_LEFT = 0, PAD_RIGHT = 1, PAD_CENTER = 2 };
-
     Value input = adaptor.getSelf();
-    Type indexType = rewriter.getIndexType();
-    Value zero = getConstant(rewriter, loc, 0, indexType);
-    Value one = getConstant(rewriter, loc, 1, indexType);
-    auto inputType = llvm::cast<RankedTensorType>(input.getType());
     auto outputType = llvm::cast<RankedTensorType>(
         getTypeConverter()->convertType(op->getResult(0).getType()));
-    unsigned numDims = inputType.getRank();
-    assert(numDims >= 2 && "Not enough input dimensions");
-    int64_t lastDim = numDims - 1;
-    SmallVector<Value> inputShape = getTensorSizes(rewriter, loc, input);
-    Value lastDimSize = inputShape[lastDim]; // input [1,2,4], then lastDim = 2,
-                                             // inputShape[2] will give 4
-
-    Value tileWidth[3], extractOffset[3], insertOffset[3];
-
-    tileWidth[PAD_LEFT] =
-        getConstant(rewriter, loc, padInts[PAD_LEFT], indexType);
-    tileWidth[PAD_RIGHT] =
-        getConstant(rewriter, loc, padInts[PAD_RIGHT], indexType);
-    tileWidth[PAD_CENTER] = lastDimSize;
-
-    extractOffset[PAD_LEFT] = one;
-    // The offset for the right hand padding "bar" is:
-    //   [right] lastDimSize - (tileWidth[PAD_RIGHT] + one)
-    extractOffset[PAD_RIGHT] =
-        createISub(lastDimSize, createIAdd(tileWidth[PAD_RIGHT], one));
-    extractOffset[PAD_CENTER] = zero;
-
-    insertOffset[PAD_LEFT] = zero;
-    insertOffset[PAD_RIGHT] = createIAdd(lastDimSize, tileWidth[PAD_LEFT]);
-    insertOffset[PAD_CENTER] = tileWidth[PAD_LEFT];
-
-    SmallVector<Value> resultShape{inputShape};
-    // Result's last dimension will have size:
-    // lastDimSize + left padding size + right padding size
-    resultShape[lastDim] =
-        createIAdd(resultShape[lastDim],
-                   createIAdd(tileWidth[PAD_LEFT], tileWidth[PAD_RIGHT]));
-    Value resultTensor = createZeroInitTensor(rewriter, loc, resultShape,
-                                              inputType.getElementType());
-
-    // Helper to reflect/reverse the i-th dimension of an affine map without
-    // symbols. This only works if applied on a tensor for which the
-    // corresponding dimension has a statically known size
-    auto reflectDim = [](AffineMap map, unsigned numDims, int64_t i,
-                         int64_t size) {
-      AffineExpr d = map.getResult(i);
-      return map.replace(d, size - d - 1, numDims,
-                         0); // left reflect for (3,1) on input shape (1,2,4).
-                             // size = 3, lastDim=2, numDims=3
-    };
-
-    SmallVector<utils::IteratorType> iteratorTypes{
-        numDims, utils::IteratorType::parallel};
-    auto idMap = AffineMap::getMultiDimIdentityMap(numDims, context);
-    SmallVector<Value> allOneStrides(numDims, one);
-
-    auto addTileToResult = [&](PadLocation padPosition) {
-      // Create the tile by extracting a slice from the input tensor.
-      SmallVector<Value> extractShape{inputShape};
-      extractShape[lastDim] = tileWidth[padPosition];
-      SmallVector<Value> extractOffsets(numDims, zero);
-      extractOffsets[lastDim] = extractOffset[padPosition];
-      Value tile = tensor::ExtractSliceOp::create(
-          rewriter, loc, input, extractOffsets, extractShape, allOneStrides);
-
-      auto inputMap = AffineMap::getMultiDimIdentityMap(numDims, context);
-      // Setup the affine map function to resverse the tile along the horizontal
-      // for left and right slices
-      if (padPosition < PAD_CENTER) {
-        inputMap = reflectDim(inputMap, numDims, lastDim, padInts[padPosition]);
-        // Take reflected slice as per inputMap
-        tile = linalg::GenericOp::create(
-                   rewriter, loc, llvm::cast<RankedTensorType>(tile.getType()),
-                   tile, tile, ArrayRef({inputMap, idMap}), iteratorTypes,
-                   [](OpBuilder &b, Location nestedLoc, ValueRange args) {
-                     linalg::YieldOp::create(b, nestedLoc, args[0]);
-                   })
-                   .getResult(0);
-      }
-      // Insert the tile in the resultTensor
-      SmallVector<Value> insertOffsets(numDims, zero);
-      insertOffsets[lastDim] = insertOffset[padPosition];
-      resultTensor = tensor::InsertSliceOp::create(rewriter, loc, tile,
-                                                   resultTensor, insertOffsets,
-                                                   extractShape, allOneStrides);
-    };
-
-    if (padInts[PAD_LEFT] > 0)
-      addTileToResult(PAD_LEFT);
-    if (padInts[PAD_RIGHT] > 0)
-      addTileToResult(PAD_RIGHT);
-    addTileToResult(PAD_CENTER);
+    assert(cast<RankedTensorType>(input.getType()).getRank() >= 2 &&
+           "Not enough input dimensions");
+    Value resultTensor = torch_to_linalg::getIndexPaddedTensor(
+        rewriter, op.getLoc(), input, padInts,
+        torch_to_linalg::IndexPaddingMode::Reflect);
 
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, outputType, resultTensor);
     return success();
@@ -298,11 +178,11 @@ public:
 
 namespace {
 
-// Lower the aten.reflection.pad_2d operator into a sequence of
-// tensor.extract_slice, linalg.generic, and tensor_insert_slice
-// operations.
-
-// To understand the lowering, consider this pytorch example:
+// Lower the aten.reflection.pad_2d operator into a single linalg.generic
+// whose body reads the input at the index reflected into it, see
+// `getIndexPaddedTensor`.
+//
+// For example:
 //
 // >>> t = torch.tensor([[[1.0,2,3],[4,5,6], [7,8,9]]])
 // >>> t
@@ -317,25 +197,8 @@ namespace {
 //          [5., 4., 5., 6., 5., 4.],
 //          [2., 1., 2., 3., 2., 1.]]])
 //
-// The result can be subdivided into "tiles" corresponding to either
-// the input tensor (in the center) or slices of the input tensor
-// whose width and height is determined by the padding sizes and which
-// are reflected through the side of the central input tensor that
-// they touch.
-// In the example above, the tiles are:
-// top left: [[5]]
-// top center: [[4,5,6]]
-// top right: [[5,4]]
-// center left [[2,1],[5,4],[8,7]]
-// center: copy of the input tensor
-// center right: [[2,1],[5,4],[8,7]]
-// bottom left: [[5,4],[2,1]]
-// center bottom: [[2,3,2]]
-// center right: [[2,1]]
-//
-// The lowering uses a tensor.extract_slice operation to create each tile,
-// a linalg.generic for the reflection, and a tensor.insert_slice to
-// insert the tile in the resulting tensor.
+// Each padding must be smaller than the size of the dim it pads, which is
+// asserted at runtime, for the reflection to stay in the input.
 class ConvertAtenReflectionPad2dOp
     : public OpConversionPattern<AtenReflectionPad2dOp> {
 public:
@@ -352,56 +215,7 @@ public:
           op, "only support constant int pad ranges");
 
     Location loc = op.getLoc();
-    // Some generic helper functions for creating arithmetic operations.
-    auto createAdd = [&](Value x, Value y) {
-      return arith::AddIOp::create(rewriter, loc, x, y);
-    };
-
-    auto createAdds = [&](std::initializer_list<Value> values) {
-      assert(values.size() >= 2);
-      return std::accumulate(values.begin() + 1, values.end(), data(values)[0],
-                             createAdd);
-    };
-
-    auto createSub = [&](Value x, Value y) {
-      return arith::SubIOp::create(rewriter, loc, x, y);
-    };
-
-    auto createSubs = [&](std::initializer_list<Value> values) {
-      assert(values.size() >= 2);
-      return std::accumulate(values.begin() + 1, values.end(), data(values)[0],
-                             createSub);
-    };
-
-    // Enums for specifying the coordinates of a tile.  An "h" prefix
-    // is used to stand for "horizontal" and "v" for "vertical"
-    // throughout.
-    enum PadHLoc { LEFT = 0, RIGHT = 1, HCENTER = 2 };
-    enum PadVLoc { TOP = 0, BOTTOM = 1, VCENTER = 2 };
-
-    // Helper functions for obtaining information about the operator's
-    // padding arguments.
-    auto getHPadArgument = [&](PadHLoc l) {
-      assert(l < HCENTER);
-      return padInts[l];
-    };
-
-    auto getVPadArgument = [&](PadVLoc l) {
-      assert(l < VCENTER);
-      return padInts[2 + l];
-    };
-
-    auto shouldCreateTile = [&](PadVLoc v, PadHLoc h) {
-      if (!(h == HCENTER || getHPadArgument(h) > 0))
-        return false;
-      if (!(v == VCENTER || getVPadArgument(v) > 0))
-        return false;
-
-      return true;
-    };
-
     Value input = adaptor.getSelf();
-    MLIRContext *context = rewriter.getContext();
     auto inputType = llvm::cast<RankedTensorType>(input.getType());
     auto outputType = llvm::cast<RankedTensorType>(
         getTypeConverter()->convertType(op->getResult(0).getType()));
@@ -409,11 +223,8 @@ public:
 
     assert(numDims >= 2 && "Not enough input dimensions");
 
-    SmallVector<Value> inputShape = getTensorSizes(rewriter, loc, input);
     int64_t hDim = numDims - 1;
     int64_t vDim = numDims - 2;
-    Value hDimSize = inputShape[hDim];
-    Value vDimSize = inputShape[vDim];
 
     auto verifyPadding = [&](int64_t padArgument, int64_t dim,
                              StringRef errorMessage) {
@@ -427,167 +238,14 @@ public:
                            rewriter.getStringAttr(errorMessage));
     };
 
-    verifyPadding(getHPadArgument(LEFT), hDim, "Left padding too large");
-    verifyPadding(getHPadArgument(RIGHT), hDim, "Right padding too large");
-    verifyPadding(getVPadArgument(TOP), vDim, "Top padding too large");
-    verifyPadding(getVPadArgument(BOTTOM), vDim, "Bottom padding too large");
-
-    Type indexType = rewriter.getIndexType();
-    Value zero = getConstant(rewriter, loc, 0, indexType);
-    Value one = getConstant(rewriter, loc, 1, indexType);
-
-    Value tileWidth[3];
-    tileWidth[HCENTER] = hDimSize;
-    for (auto h : {LEFT, RIGHT})
-      tileWidth[h] = getConstant(rewriter, loc, getHPadArgument(h), indexType);
-
-    Value tileHeight[3];
-    tileHeight[VCENTER] = vDimSize;
-    for (auto v : {TOP, BOTTOM})
-      tileHeight[v] = getConstant(rewriter, loc, getVPadArgument(v), indexType);
-
-    // Create output shape and tensor
-    SmallVector<Value> resultShape{inputShape};
-    resultShape[vDim] =
-        createAdds({resultShape[vDim], tileHeight[TOP], tileHeight[BOTTOM]});
-    resultShape[hDim] =
-        createAdds({resultShape[hDim], tileWidth[LEFT], tileWidth[RIGHT]});
-
-    Value resultTensor = createZeroInitTensor(rewriter, loc, resultShape,
-                                              inputType.getElementType());
-
-    // Construction of the tiles
-
-    // Example: central left tile
-    //
-    // Let m the width of the left padding as returned by getHPadargument(LEFT)
-    // and n the size of the input tensor's "horizontal" dimension, i.e.
-    // hDimSize. Assume that the subtensor of the input tensor in the relevant
-    // (i.e. last two) dimensions is:
-    //
-    //     x_1,1 x_1,2 ... x_1,m
-    //     x_2,1 x_2,2 ... x_2,m
-    //              .
-    //              .
-    //              .
-    //     x_n,1 x_n,2 ... x_n,m
-    //
-    // The padding tile consists of the columns 2, ..., m + 1
-    // of the input in reverse order. The first column gets
-    // skipped because this is the column through which the
-    // reflection happens.
-    //
-    //      x_1,m x_1,m-1 ... x_1,2
-    //      x_2,m x_1,m-1 ... x_2,2
-    //              .
-    //              .
-    //              .
-    //      x_n,m x_n,m-1 ... x_n,2
-    //
-    // The tile will be inserted to the left of the copy of the input tensor
-    // in the output tensor, i.e. with horizontal offset 0.
-    // The top padding determines the vertical offset.
-
-    // Tiles on the diagonal (e.g. (TOP, LEFT)) are reflected through
-    // two sides, i.e. their columns and rows must be reversed.
-
-    // Setup information about the tiles
-
-    // Compute the offsets for extracting the slice from the
-    // input. We need to skip the row or column through which
-    // the tile should be reflected, if any (none for the center tile).
-    Value extractHOffset[3];
-    extractHOffset[LEFT] = one;
-    extractHOffset[HCENTER] = zero;
-    extractHOffset[RIGHT] = createSubs({hDimSize, tileWidth[RIGHT], one});
-
-    Value extractVOffset[3];
-    extractVOffset[TOP] = one;
-    extractVOffset[VCENTER] = zero;
-    extractVOffset[BOTTOM] = createSubs({vDimSize, tileHeight[BOTTOM], one});
-
-    // Compute the horizontal and vertical offsets for inserting
-    // the tiles in the resultTensor.
-    Value insertHOffset[3];
-    insertHOffset[LEFT] = zero;
-    insertHOffset[HCENTER] = tileWidth[LEFT];
-    insertHOffset[RIGHT] = createAdd(hDimSize, tileWidth[LEFT]);
-
-    Value insertVOffset[3];
-    insertVOffset[TOP] = zero;
-    insertVOffset[VCENTER] = tileHeight[TOP];
-    insertVOffset[BOTTOM] = createAdd(vDimSize, tileHeight[TOP]);
-
-    auto shouldHReflect = [](PadHLoc l) { return l == LEFT || l == RIGHT; };
-    auto shouldVReflect = [](PadVLoc l) { return l == TOP || l == BOTTOM; };
-
-    SmallVector<utils::IteratorType> iteratorTypes{
-        numDims, utils::IteratorType::parallel};
-    auto idMap = AffineMap::getMultiDimIdentityMap(numDims, context);
-    SmallVector<Value> allOneStrides(numDims, one);
-
-    auto createTile = [&](PadVLoc verticalPos, PadHLoc horizontalPos) {
-      // Create the tile by extracting a slice from the input tenor.
-      SmallVector<Value> extractShape{inputShape};
-      extractShape[hDim] = tileWidth[horizontalPos];
-      extractShape[vDim] = tileHeight[verticalPos];
-
-      SmallVector<Value> extractOffsets(numDims, zero);
-      extractOffsets[hDim] = extractHOffset[horizontalPos];
-      extractOffsets[vDim] = extractVOffset[verticalPos];
-
-      Value tile = tensor::ExtractSliceOp::create(
-          rewriter, loc, input, extractOffsets, extractShape, allOneStrides);
-
-      auto inputMap = AffineMap::getMultiDimIdentityMap(numDims, context);
-
-      tile =
-          linalg::GenericOp::create(
-              rewriter, loc, llvm::cast<RankedTensorType>(tile.getType()), tile,
-              tile, ArrayRef({inputMap, idMap}), iteratorTypes,
-              [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
-                // Use linalg.index to reflect the dims
-                SmallVector<Value> extractIndices(numDims);
-                for (unsigned i = 0; i < numDims; i++)
-                  extractIndices[i] = linalg::IndexOp::create(b, nestedLoc, i);
-
-                auto reflectDim = [&](int64_t padSize, Value dim) {
-                  Value reflectDimSize = getConstant(rewriter, loc, padSize - 1,
-                                                     rewriter.getIndexType());
-                  return arith::SubIOp::create(b, loc, reflectDimSize, dim);
-                };
-
-                // Reverse the tile along the horizontal, vertical, or both
-                // dimensions.
-                if (shouldHReflect(horizontalPos))
-                  extractIndices[hDim] = reflectDim(
-                      getHPadArgument(horizontalPos), extractIndices[hDim]);
-
-                if (shouldVReflect(verticalPos))
-                  extractIndices[vDim] = reflectDim(
-                      getVPadArgument(verticalPos), extractIndices[vDim]);
-
-                Value extractValue = tensor::ExtractOp::create(
-                    rewriter, nestedLoc, tile, extractIndices);
-                linalg::YieldOp::create(b, nestedLoc, extractValue);
-              })
-              .getResult(0);
-
-      // Insert the tile in the resultTensor.
-      SmallVector<Value> insertOffsets(numDims, zero);
-      insertOffsets[hDim] = insertHOffset[horizontalPos];
-      insertOffsets[vDim] = insertVOffset[verticalPos];
-
-      resultTensor = tensor::InsertSliceOp::create(rewriter, loc, tile,
-                                                   resultTensor, insertOffsets,
-                                                   extractShape, allOneStrides);
-    };
-
-    for (auto v : {TOP, BOTTOM, VCENTER})
-      for (auto h : {LEFT, RIGHT, HCENTER})
-        if (shouldCreateTile(v, h))
-          createTile(v, h);
+    verifyPadding(padInts[0], hDim, "Left padding too large");
+    verifyPadding(padInts[1], hDim, "Right padding too large");
+    verifyPadding(padInts[2], vDim, "Top padding too large");
+    verifyPadding(padInts[3], vDim, "Bottom padding too large");
 
+    Value resultTensor = torch_to_linalg::getIndexPaddedTensor(
+        rewriter, loc, input, padInts,
+        torch_to_linalg::IndexPaddingMode::Reflect);
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, outputType, resultTensor);
 
     return success();
@@ -1380,6 +1038,361 @@ public:
 };
 } // namespace
 
+namespace {
+// The size of a dimension as a constant times a product of symbolic factors.
+// Factors are affine expressions over the shape symbols of the function, so
+// two sizes built from the same symbols compare equal without knowing their
+// runtime values.
+struct SymbolicSize {
+  int64_t coefficient = 1;
+  SmallVector<AffineExpr> factors;
+
+  static SymbolicSize get(int64_t coefficient,
+                          ArrayRef<AffineExpr> factors = {}) {
+    SymbolicSize size;
+    size.coefficient = coefficient;
+    size.factors.assign(factors.begin(), factors.end());
+    llvm::sort(size.factors, [](AffineExpr a, AffineExpr b) {
+      return a.getAsOpaquePointer() < b.getAsOpaquePointer();
+    });
+    return size;
+  }
+
+  bool isOne() const { return coefficient == 1 && factors.empty(); }
+  bool isConstant() const { return factors.empty(); }
+
+  SymbolicSize operator*(const SymbolicSize &other) const {
+    SmallVector<AffineExpr> product(factors);
+    product.append(other.factors);
+    return get(coefficient * other.coefficient, product);
+  }
+
+  // Returns this size divided by `other`, if the quotient is exact.
+  std::optional<SymbolicSize> divide(const SymbolicSize &other) const {
+    if (other.coefficient == 0 || coefficient % other.coefficient != 0)
+      return std::nullopt;
+    SmallVector<AffineExpr> quotient(factors);
+    for (AffineExpr factor : other.factors) {
+      auto it = llvm::find(quotient, factor);
+      if (it == quotient.end())
+        return std::nullopt;
+      quotient.erase(it);
+    }
+    return get(coefficient / other.coefficient, quotient);
+  }
+
+  bool operator==(const SymbolicSize &other) const {
+    return coefficient == other.coefficient && factors == other.factors;
+  }
+  bool operator!=(const SymbolicSize &other) const { return !(*this == other); }
+};
+
+// Tracks the sizes of the dynamic dimensions feeding an `aten.view` back to
+// the symbols they are derived from: the `torch.symbolic_int` symbols bound
+// by `torch.bind_symbolic_shape`, the scalar shape arithmetic left behind by
+// `torch-scalarize-shapes`, and the size lists of the views and transposes
+// that produced the tensor. Anything else gets a fresh symbol of its own.
+class SymbolicSizeAnalysis {
+public:
+  SymbolicSizeAnalysis(MLIRContext *context) : context(context) {}
+
+  SymbolicSize getDimSize(Value tensor, int64_t dim) {
+    auto tensorType = cast<BaseTensorType>(tensor.getType());
+    if (!tensorType.hasSizes())
+      return getOpaqueDimSize(tensor, dim);
+    ArrayRef<int64_t> sizes = tensorType.getSizes();
+    int64_t rank = sizes.size();
+    if (sizes[dim] != kUnknownSize)
+      return SymbolicSize::get(sizes[dim]);
+
+    for (Operation *user : tensor.getUsers()) {
+      auto bind = dyn_cast<BindSymbolicShapeOp>(user);
+      if (!bind ||
+          bind.getShapeExpressions().getValue().getNumResults() != rank)
+        continue;
+      SmallVector<AffineExpr> symbols;
+      for (Value symbol : bind.getShapeSymbols())
+        symbols.push_back(getSymbol(symbol));
+      AffineExpr expr = bind.getShapeExpressions().getValue().getResult(dim);
+      return decompose(expr.replaceSymbols(symbols));
+    }
+
+    Operation *producer = tensor.getDefiningOp();
+    SmallVector<Value> sizeList;
+    SmallVector<int64_t> perms;
+    int64_t dim0, dim1;
+    if (isa_and_nonnull<AtenViewOp, AtenReshapeOp>(producer) &&
+        getListConstructElements(producer->getOperand(1), sizeList) &&
+        (int64_t)sizeList.size() == rank) {
+      int64_t size;
+      if (!matchPattern(sizeList[dim], m_TorchConstantInt(&size)))
+        return getIntValue(sizeList[dim]);
+    } else if (auto transpose = dyn_cast_or_null<AtenTransposeIntOp>(producer);
+               transpose &&
+               matchPattern(transpose.getDim0(), m_TorchConstantInt(&dim0)) &&
+               matchPattern(transpose.getDim1(), m_TorchConstantInt(&dim1)) &&
+               isValidDim(dim0, rank) && isValidDim(dim1, rank)) {
+      dim0 = toPositiveDim(dim0, rank);
+      dim1 = toPositiveDim(dim1, rank);
+      int64_t inputDim = dim == dim0 ? dim1 : dim == dim1 ? dim0 : dim;
+      return getDimSize(transpose.getSelf(), inputDim);
+    } else if (auto permute = dyn_cast_or_null<AtenPermuteOp>(producer);
+               permute &&
+               matchPattern(permute.getDims(),
+                            m_TorchListOfConstantInts(perms)) &&
+               (int64_t)perms.size() == rank &&
+               isValidDim(perms[dim], rank)) {
+      return getDimSize(permute.getSelf(), toPositiveDim(perms[dim], rank));
+    }
+    return getOpaqueDimSize(tensor, dim);
+  }
+
+  SymbolicSize getIntValue(Value value) {
+    int64_t constant;
+    if (matchPattern(value, m_TorchConstantInt(&constant)))
+      return SymbolicSize::get(constant);
+    if (auto sizeOp = value.getDefiningOp<AtenSizeIntOp>()) {
+      auto selfType = cast<BaseTensorType>(sizeOp.getSelf().getType());
+      int64_t dim;
+      if (selfType.hasSizes() &&
+          matchPattern(sizeOp.getDim(), m_TorchConstantInt(&dim)) &&
+          isValidDim(dim, selfType.getSizes().size()))
+        return getDimSize(sizeOp.getSelf(),
+                          toPositiveDim(dim, selfType.getSizes().size()));
+    }
+    if (auto mulOp = value.getDefiningOp<AtenMulIntOp>())
+      return getIntValue(mulOp.getA()) * getIntValue(mulOp.getB());
+    if (auto divOp = value.getDefiningOp<AtenFloordivIntOp>()) {
+      if (std::optional<SymbolicSize> quotient =
+              getIntValue(divOp.getA()).divide(getIntValue(divOp.getB())))
+        return *quotient;
+    }
+    return SymbolicSize::get(1, getSymbol(value));
+  }
+
+private:
+  AffineExpr getFreshSymbol() {
+    return getAffineSymbolExpr(numSymbols++, context);
+  }
+
+  SymbolicSize getOpaqueDimSize(Value tensor, int64_t dim) {
+    auto [it, inserted] = opaqueDims.try_emplace({tensor, dim}, AffineExpr());
+    if (inserted)
+      it->second = getFreshSymbol();
+    return SymbolicSize::get(1, it->second);
+  }
+
+  AffineExpr getSymbol(Value value) {
+    auto [it, inserted] = symbols.try_emplace(value, AffineExpr());
+    if (inserted)
+      it->second = getFreshSymbol();
+    return it->second;
+  }
+
+  // Splits products of symbols and constants into their factors. Any other
+  // expression, such as `s0 * 2 + s1`, is kept whole as a single factor.
+  static SymbolicSize decompose(AffineExpr expr) {
+    if (auto constant = dyn_cast<AffineConstantExpr>(expr))
+      return SymbolicSize::get(constant.getValue());
+    if (auto binary = dyn_cast<AffineBinaryOpExpr>(expr);
+        binary && binary.getKind() == AffineExprKind::Mul)
+      return decompose(binary.getLHS()) * decompose(binary.getRHS());
+    return SymbolicSize::get(1, expr);
+  }
+
+  MLIRContext *context;
+  unsigned numSymbols = 0;
+  DenseMap<Value, AffineExpr> symbols;
+  DenseMap<std::pair<Value, int64_t>, AffineExpr> opaqueDims;
+};
+} // namespace
+
+namespace {
+/// Converts `aten.view` ops whose dynamic sizes can be traced back to the
+/// dims of the input, through `torch.bind_symbolic_shape` bindings or the
+/// scalar shape computations, into a `tensor.collapse_shape` followed by a
+/// `tensor.expand_shape`. This handles the views with more than one dynamic
+/// dimension that `ConvertAtenViewOp` gives up on, such as splitting and
+/// merging attention heads with a dynamic batch and sequence length, which
+/// would otherwise become a `tensor.reshape` that needs a copy.
+class ConvertAtenViewOpSymbolic : public OpConversionPattern<AtenViewOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenViewOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (op->getParentOp()->hasAttr("torch.disable_legacy_view"))
+      return rewriter.notifyMatchFailure(op.getLoc(),
+                                         "legacy view lowering diabled");
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    SmallVector<Value> sizes;
+    if (!getListConstructElements(op.getSize(), sizes))
+      return rewriter.notifyMatchFailure(
+          op, "the target size is not constructed from ListConstruct");
+    auto selfType = cast<BaseTensorType>(op.getSelf().getType());
+    if (!selfType.hasSizes() || selfType.getSizes().empty() || sizes.empty())
+      return rewriter.notifyMatchFailure(op, "expected ranked non-0d tensors");
+
+    const TypeConverter *typeConverter = getTypeConverter();
+    auto resultType =
+        cast<RankedTensorType>(typeConverter->convertType(op.getType()));
+    int64_t inputRank = selfType.getSizes().size();
+    int64_t resultRank = sizes.size();
+    if (resultType.getRank() != resultRank)
+      return rewriter.notifyMatchFailure(
+          op, "desired size list length mismatches with the result type rank");
+
+    SymbolicSizeAnalysis analysis(op.getContext());
+    SmallVector<SymbolicSize> inputSizes;
+    for (int64_t dim = 0; dim < inputRank; ++dim)
+      inputSizes.push_back(analysis.getDimSize(op.getSelf(), dim));
+
+    std::optional<int64_t> inferredDim;
+    SmallVector<SymbolicSize> outputSizes;
+    for (auto [dim, size] : llvm::enumerate(sizes)) {
+      int64_t sizeInt;
+      if (matchPattern(size, m_TorchConstantInt(&sizeInt)) && sizeInt == -1) {
+        if (inferredDim)
+          return rewriter.notifyMatchFailure(
+              op, "at most one element in size list is allowed to be -1");
+        inferredDim = dim;
+        outputSizes.emplace_back();
+        continue;
+      }
+      outputSizes.push_back(analysis.getIntValue(size));
+    }
+    if (inferredDim) {
+      SymbolicSize numElements, knownElements;
+      for (const SymbolicSize &size : inputSizes)
+        numElements = numElements * size;
+      for (auto [dim, size] : llvm::enumerate(outputSizes)) {
+        if ((int64_t)dim != *inferredDim)
+          knownElements = knownElements * size;
+      }
+      std::optional<SymbolicSize> inferredSize =
+          numElements.divide(knownElements);
+      if (!inferredSize)
+        return rewriter.notifyMatchFailure(op, "cannot infer the -1 size");
+      outputSizes[*inferredDim] = *inferredSize;
+    }
+
+    // Group consecutive input and output dims until both sides of each group
+    // provably hold the same number of elements. A side is extended while its
+    // product divides the other; static sizes that divide neither, as in
+    // [2, 3] -> [3, 2], extend the smaller one.
+    SmallVector<ReassociationIndices> inputAssociations;
+    SmallVector<ReassociationIndices> outputAssociations;
+    int64_t inputDim = 0, outputDim = 0;
+    while (inputDim < inputRank && outputDim < resultRank) {
+      inputAssociations.push_back({inputDim});
+      outputAssociations.push_back({outputDim});
+      SymbolicSize inputProduct = inputSizes[inputDim++];
+      SymbolicSize outputProduct = outputSizes[outputDim++];
+      while (inputProduct != outputProduct) {
+        bool extendInput;
+        if (outputProduct.divide(inputProduct))
+          extendInput = true;
+        else if (inputProduct.divide(outputProduct))
+          extendInput = false;
+        else if (inputProduct.isConstant() && outputProduct.isConstant())
+          extendInput = inputProduct.coefficient < outputProduct.coefficient;
+        else
+          return rewriter.notifyMatchFailure(
+              op, "cannot match the dynamic sizes of the input and output");
+
+        if (extendInput) {
+          if (inputDim == inputRank)
+            return rewriter.notifyMatchFailure(op, "mismatched sizes");
+          inputAssociations.back().push_back(inputDim);
+          inputProduct = inputProduct * inputSizes[inputDim++];
+        } else {
+          if (outputDim == resultRank)
+            return rewriter.notifyMatchFailure(op, "mismatched sizes");
+          outputAssociations.back().push_back(outputDim);
+          outputProduct = outputProduct * outputSizes[outputDim++];
+        }
+      }
+    }
+    // Trailing size-1 dims join the last group.
+    for (; inputDim < inputRank; ++inputDim) {
+      if (!inputSizes[inputDim].isOne())
+        return rewriter.notifyMatchFailure(op, "mismatched sizes");
+      inputAssociations.back().push_back(inputDim);
+    }
+    for (; outputDim < resultRank; ++outputDim) {
+      if (!outputSizes[outputDim].isOne())
+        return rewriter.notifyMatchFailure(op, "mismatched sizes");
+      outputAssociations.back().push_back(outputDim);
+    }
+
+    // The collapsed type is dynamic wherever a group of the result is, so that
+    // both reshapes pass their verifiers.
+    Location loc = op.getLoc();
+    ArrayRef<int64_t> resultShape = resultType.getShape();
+    SmallVector<int64_t> collapsedShape;
+    for (ReassociationIndices &group : outputAssociations) {
+      int64_t size = 1;
+      for (int64_t dim : group) {
+        if (ShapedType::isDynamic(resultShape[dim])) {
+          size = ShapedType::kDynamic;
+          break;
+        }
+        size *= resultShape[dim];
+      }
+      collapsedShape.push_back(size);
+    }
+    auto collapsedType =
+        RankedTensorType::get(collapsedShape, resultType.getElementType());
+
+    auto hasMultipleDims = [](ReassociationIndices &group) {
+      return group.size() > 1;
+    };
+    Value collapsed = adaptor.getSelf();
+    if (llvm::any_of(inputAssociations, hasMultipleDims))
+      collapsed = tensor::CollapseShapeOp::create(rewriter, loc, collapsed,
+                                                  inputAssociations);
+    collapsed = rewriter.createOrFold<tensor::CastOp>(loc, collapsedType,
+                                                      collapsed);
+    if (!llvm::any_of(outputAssociations, hasMultipleDims)) {
+      rewriter.replaceOp(op, rewriter.createOrFold<tensor::CastOp>(
+                                 loc, resultType, collapsed));
+      return success();
+    }
+
+    SmallVector<Value> sizeValues =
+        getTypeConvertedValues(rewriter, loc, typeConverter, sizes);
+    SmallVector<OpFoldResult> outputShape(resultRank);
+    for (auto [collapsedDim, group] : llvm::enumerate(outputAssociations)) {
+      for (int64_t dim : group) {
+        if (!ShapedType::isDynamic(resultShape[dim]))
+          outputShape[dim] = rewriter.getIndexAttr(resultShape[dim]);
+        else if (dim != inferredDim)
+          outputShape[dim] = castIntToIndex(rewriter, loc, sizeValues[dim]);
+      }
+      if (!inferredDim || !llvm::is_contained(group, *inferredDim) ||
+          !ShapedType::isDynamic(resultShape[*inferredDim]))
+        continue;
+      // The inferred size is what the rest of its group leaves over.
+      Value inferredSize =
+          tensor::DimOp::create(rewriter, loc, collapsed, collapsedDim);
+      for (int64_t dim : group) {
+        if (dim == *inferredDim)
+          continue;
+        Value size = getValueOrCreateConstantIndexOp(rewriter, loc,
+                                                     outputShape[dim]);
+        inferredSize = arith::DivUIOp::create(rewriter, loc, inferredSize,
+                                              size);
+      }
+      outputShape[*inferredDim] = inferredSize;
+    }
+    rewriter.replaceOpWithNewOp<tensor::ExpandShapeOp>(
+        op, resultType, collapsed, outputAssociations, outputShape);
+    return success();
+  }
+};
+} // namespace
+
 namespace {
 class ConvertAtenViewOpToReshape : public OpConversionPattern<AtenViewOp> {
 public:
@@ -2844,9 +2857,12 @@ void mlir::torch::torch_to_linalg::populateDataMovementPatternsAndLegality(
   // ConvertAtenViewOpToReshape overly pessimizes and generates a lot of IR
   // due to not statically switching between inferred and non-inferred view
   // cases. They are ordered by optimiality of the lowerings they generate
-  // when they are able.
+  // when they are able. ConvertAtenViewOpSymbolic picks up the dynamic views
+  // the first one gives up on whenever it can prove how their sizes relate.
   target.addIllegalOp<AtenViewOp>();
   patterns.add<ConvertAtenViewOp>(typeConverter, context, /*benefit=*/300);
+  patterns.add<ConvertAtenViewOpSymbolic>(typeConverter, context,
+                                          /*benefit=*/250);
   patterns.add<ConvertAtenViewOpStrict>(typeConverter, context,
                                         /*benefit=*/200);
   patterns.add<ConvertAtenViewOpToReshape>(typeConverter, context,
@@ -2889,3 +2905,102 @@ void mlir::torch::torch_to_linalg::populateDataMovementPatternsAndLegality(
   });
   patterns.add<ConvertSparseOperatorOp>(typeConverter, context);
 }
+
+// Returns the linalg op whose only result is only used, possibly through a
+// tensor.cast, by `concat`, and whose init is a tensor.empty, so that it can
+// compute its result in the concatenated tensor instead.
+static linalg::LinalgOp getInPlaceConcatProducer(tensor::ConcatOp concat,
+                                                 Value input) {
+  if (auto cast = input.getDefiningOp<tensor::CastOp>()) {
+    if (!input.hasOneUse())
+      return nullptr;
+    input = cast.getSource();
+  }
+  auto producer = input.getDefiningOp<linalg::LinalgOp>();
+  if (!producer || !producer.hasPureTensorSemantics() || !input.hasOneUse() ||
+      producer->getNumResults() != 1 ||
+      producer->getBlock() != concat->getBlock() ||
+      !producer.getDpsInits()[0].getDefiningOp<tensor::EmptyOp>())
+    return nullptr;
+  return producer;
+}
+
+LogicalResult torch_to_linalg::writeConcatInputsInPlace(Operation *root) {
+  SmallVector<tensor::ConcatOp> concats;
+  root->walk([&](tensor::ConcatOp concat) { concats.push_back(concat); });
+
+  IRRewriter rewriter(root->getContext());
+  for (tensor::ConcatOp concat : concats) {
+    if (llvm::none_of(concat.getInputs(), [&](Value input) {
+          return getInPlaceConcatProducer(concat, input);
+        }))
+      continue;
+
+    // Decompose the concat into insert_slice ops into one tensor, and have
+    // the producers of its inputs write their results into the slices of
+    // that tensor. Bufferization then computes them in place in the result
+    // buffer instead of copying them there.
+    Location loc = concat.getLoc();
+    rewriter.setInsertionPoint(concat);
+    int64_t dim = concat.getDim();
+    auto resultType = cast<RankedTensorType>(concat.getType());
+    int64_t rank = resultType.getRank();
+    // The producers are moved right before the concat, so the sizes of their
+    // results are taken from their inits.
+    auto getInputSizes = [&](Value input) {
+      if (linalg::LinalgOp producer = getInPlaceConcatProducer(concat, input))
+        input = producer.getDpsInits()[0];
+      return tensor::getMixedSizes(rewriter, loc, input);
+    };
+    SmallVector<OpFoldResult> resultSizes =
+        getInputSizes(concat.getInputs()[0]);
+    resultSizes[dim] = rewriter.getIndexAttr(0);
+    auto add = [&](OpFoldResult lhs, OpFoldResult rhs) -> OpFoldResult {
+      std::optional<int64_t> lhsInt = getConstantIntValue(lhs);
+      std::optional<int64_t> rhsInt = getConstantIntValue(rhs);
+      if (lhsInt && rhsInt)
+        return rewriter.getIndexAttr(*lhsInt + *rhsInt);
+      return arith::AddIOp::create(
+                 rewriter, loc,
+                 getValueOrCreateConstantIndexOp(rewriter, loc, lhs),
+                 getValueOrCreateConstantIndexOp(rewriter, loc, rhs))
+          .getResult();
+    };
+    for (Value input : concat.getInputs())
+      resultSizes[dim] = add(resultSizes[dim], getInputSizes(input)[dim]);
+    Value result = tensor::EmptyOp::create(rewriter, loc, resultSizes,
+                                           resultType.getElementType());
+
+    SmallVector<OpFoldResult> offsets(rank, rewriter.getIndexAttr(0));
+    SmallVector<OpFoldResult> strides(rank, rewriter.getIndexAttr(1));
+    for (Value input : concat.getInputs()) {
+      SmallVector<OpFoldResult> sizes = getInputSizes(input);
+      if (linalg::LinalgOp producer = getInPlaceConcatProducer(concat, input)) {
+        OpOperand *init = producer.getDpsInitOperand(0);
+        Value slice = tensor::ExtractSliceOp::create(
+            rewriter, loc, cast<RankedTensorType>(init->get().getType()),
+            result, offsets, sizes, strides);
+        rewriter.modifyOpInPlace(producer, [&]() { init->set(slice); });
+        rewriter.moveOpBefore(producer, concat);
+        input = producer->getResult(0);
+      }
+      result = tensor::InsertSliceOp::create(rewriter, loc, input, result,
+                                             offsets, sizes, strides);
+      offsets[dim] = add(offsets[dim], sizes[dim]);
+    }
+
+    SmallVector<Operation *> deadCasts;
+    for (Value input : concat.getInputs()) {
+      if (auto cast = input.getDefiningOp<tensor::CastOp>())
+        deadCasts.push_back(cast);
+    }
+    if (result.getType() != resultType)
+      result = tensor::CastOp::create(rewriter, loc, resultType, result);
+    rewriter.replaceOp(concat, result);
+    for (Operation *cast : deadCasts) {
+      if (cast->use_empty())
+        rewriter.eraseOp(cast);
+    }
+  }
+  return success();
+}
@@ -11,9 +11,11 @@
 
 #include "PopulatePatterns.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Arith/Utils/Utils.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/Matchers.h"
 #include "torch-mlir/Conversion/TorchToLinalg/Utils.h"
 #include "torch-mlir/Conversion/Utils/Utils.h"
@@ -25,6 +27,25 @@ using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::Torch;
 
+static void createIndexBoundsAssertions(OpBuilder &b, Location loc,
+                                        Value input, Value index,
+                                        int64_t dim) {
+  // Assert index < input.sizes[dim]
+  Value indexLTInputDim = arith::CmpIOp::create(
+      b, loc, arith::CmpIPredicate::slt, castIntToIndex(b, loc, index),
+      getDimOp(b, loc, input, dim));
+  cf::AssertOp::create(b, loc, indexLTInputDim,
+                       b.getStringAttr("index must be smaller than dim size"));
+
+  // Assert index >= 0
+  Value cst0 =
+      arith::ConstantOp::create(b, loc, b.getZeroAttr(index.getType()));
+  Value indexGEThanZero =
+      arith::CmpIOp::create(b, loc, arith::CmpIPredicate::sge, index, cst0);
+  cf::AssertOp::create(b, loc, indexGEThanZero,
+                       b.getStringAttr("index must be larger or equal to 0"));
+}
+
 static void createLinalgPayloadCalculationForGatherOps(
     OpBuilder &b, Location loc, Value input, int64_t inputRank, Value index,
     int64_t dim, int64_t outputRank) {
@@ -42,25 +63,47 @@ static void createLinalgPayloadCalculationForGatherOps(
     }
   }
 
-  // Assert index < input.sizes[dim]
-  Value indexLTInputDim = arith::CmpIOp::create(
-      b, loc, arith::CmpIPredicate::slt, castIntToIndex(b, loc, index),
-      getDimOp(b, loc, input, dim));
-  cf::AssertOp::create(b, loc, indexLTInputDim,
-                       b.getStringAttr("index must be smaller than dim size"));
-
-  // Assert index >= 0
-  Value cst0 =
-      arith::ConstantOp::create(b, loc, b.getZeroAttr(index.getType()));
-  Value indexGEThanZero =
-      arith::CmpIOp::create(b, loc, arith::CmpIPredicate::sge, index, cst0);
-  cf::AssertOp::create(b, loc, indexGEThanZero,
-                       b.getStringAttr("index must be larger or equal to 0"));
+  createIndexBoundsAssertions(b, loc, input, index, dim);
 
   Value extract = tensor::ExtractOp::create(b, loc, input, indices);
   linalg::YieldOp::create(b, loc, extract);
 }
 
+// Gathers the slices of `input` at the positions `indices`, a 1-D tensor,
+// along `dim`. Each index is loaded once and its whole slice is copied with
+// a single extract_slice/insert_slice pair, which is a contiguous row copy
+// when `dim` is 0, instead of extracting every element of the result.
+static Value createSliceGather(OpBuilder &b, Location loc, Value input,
+                               Value indices, int64_t dim) {
+  int64_t rank = cast<RankedTensorType>(input.getType()).getRank();
+  SmallVector<OpFoldResult> sliceSizes = tensor::getMixedSizes(b, loc, input);
+  SmallVector<OpFoldResult> resultSizes(sliceSizes);
+  resultSizes[dim] = tensor::getMixedSize(b, loc, indices, 0);
+  sliceSizes[dim] = b.getIndexAttr(1);
+  SmallVector<OpFoldResult> strides(rank, b.getIndexAttr(1));
+  Value init = tensor::EmptyOp::create(b, loc, resultSizes,
+                                       getElementTypeOrSelf(input.getType()));
+
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  Value numIndices = getValueOrCreateConstantIndexOp(b, loc, resultSizes[dim]);
+  auto loop = scf::ForOp::create(
+      b, loc, zero, numIndices, one, ValueRange{init},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange iterArgs) {
+        Value index = tensor::ExtractOp::create(b, loc, indices, iv);
+        createIndexBoundsAssertions(b, loc, input, index, dim);
+        SmallVector<OpFoldResult> offsets(rank, b.getIndexAttr(0));
+        offsets[dim] = castIntToIndex(b, loc, index);
+        Value slice = tensor::ExtractSliceOp::create(b, loc, input, offsets,
+                                                     sliceSizes, strides);
+        offsets[dim] = iv;
+        Value result = tensor::InsertSliceOp::create(
+            b, loc, slice, iterArgs[0], offsets, sliceSizes, strides);
+        scf::YieldOp::create(b, loc, result);
+      });
+  return loop.getResult(0);
+}
+
 namespace {
 class ConvertAtenGatherOp : public OpConversionPattern<AtenGatherOp> {
 public:
@@ -129,40 +172,36 @@ public:
     auto weightTy = cast<RankedTensorType>(weight.getType());
     if (weightTy.getRank() != 2)
       return rewriter.notifyMatchFailure(op, "weight must be rank 2");
-    Value embeddingDim = getDimOp(rewriter, loc, weight, 1);
-    Type elemTy = weightTy.getElementType();
-
-    SmallVector<Value> sizes = getTensorSizes(rewriter, loc, indices);
-    sizes.push_back(embeddingDim);
-    int64_t resultRank = sizes.size();
 
+    // Gather the rows for the flattened indices, then restore their shape.
     auto indicesTy = cast<RankedTensorType>(indices.getType());
     int64_t indicesRank = indicesTy.getRank();
-    SmallVector<AffineExpr> indicesExprs;
-    for (int i = 0; i < indicesRank; i++)
-      indicesExprs.push_back(rewriter.getAffineDimExpr(i));
-    auto indicesAffineMap = AffineMap::get(
-        /*dimCount=*/resultRank,
-        /*symbolCount=*/0, indicesExprs, op->getContext());
-    SmallVector<AffineMap, 2> indexingMaps = {
-        indicesAffineMap,
-        rewriter.getMultiDimIdentityMap(resultRank),
-    };
-    SmallVector<utils::IteratorType> iteratorTypes(
-        sizes.size(), utils::IteratorType::parallel);
-    Value initTensor = tensor::EmptyOp::create(
-        rewriter, loc, getAsOpFoldResult(sizes), elemTy);
+    SmallVector<ReassociationIndices> reassociation;
+    if (indicesRank == 0) {
+      indices = tensor::ExpandShapeOp::create(
+          rewriter, loc,
+          RankedTensorType::get({1}, indicesTy.getElementType()), indices,
+          reassociation);
+    } else if (indicesRank > 1) {
+      reassociation.push_back(
+          llvm::to_vector(llvm::seq<int64_t>(0, indicesRank)));
+      indices = tensor::CollapseShapeOp::create(rewriter, loc, indices,
+                                                reassociation);
+      reassociation.push_back({indicesRank});
+    }
     Value embeddingResult =
-        linalg::GenericOp::create(
-            rewriter, loc, initTensor.getType(), indices, initTensor,
-            /*indexingMaps=*/indexingMaps, /*iteratorTypes=*/iteratorTypes,
-            [&](OpBuilder &b, Location loc, ValueRange args) {
-              Value index = args[0];
-              createLinalgPayloadCalculationForGatherOps(
-                  b, loc, weight, weightTy.getRank(), index, /*dim=*/0,
-                  resultRank);
-            })
-            .getResult(0);
+        createSliceGather(rewriter, loc, weight, indices, /*dim=*/0);
+    if (indicesRank == 0) {
+      embeddingResult = tensor::CollapseShapeOp::create(
+          rewriter, loc, embeddingResult,
+          ArrayRef<ReassociationIndices>{{0, 1}});
+    } else if (indicesRank > 1) {
+      SmallVector<OpFoldResult> sizes =
+          tensor::getMixedSizes(rewriter, loc, adaptor.getIndices());
+      sizes.push_back(tensor::getMixedSize(rewriter, loc, weight, 1));
+      embeddingResult = tensor::ExpandShapeOp::create(
+          rewriter, loc, newResultType, embeddingResult, reassociation, sizes);
+    }
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType,
                                                 embeddingResult);
     return success();
@@ -171,10 +210,9 @@ public:
 } // namespace
 
 namespace {
-// AtenEmbeddingPaddingIdxOp
-// SUM mode == integer 0
-// Sums bags of embeddings together from a weight tensor based on an index and
-// offset Vector. Example arguments weight = [[1, 3, 5, 3],
+// AtenEmbeddingBagPaddingIdxOp
+// Reduces bags of embeddings from a weight tensor based on an index and
+// offset vector. Example arguments weight = [[1, 3, 5, 3],
 //           [3, 4, 2, 1],
 //           [2, 2, 3, 2],
 //           [0, 4, 2, 1]]
@@ -182,29 +220,23 @@ namespace {
 // indices = [0, 2, 3, 1, 2, 3, 2, 1, 0, 1]
 // offsets = [0, 3, 5]
 //
-// output_tensor = initZeroTensor(offsets_length, embedding_size)
+// Bag `i` holds the indices in [offsets[i], offsets[i+1]), the last one
+// ending at indices_length. The reduction is a segmented one: a parallel
+// linalg.generic over the bags and the embedding dim, in which each element
+// only loops over the entries of its own bag, so that the embedding dim is
+// the contiguous innermost loop.
 //
 // for i in range(offsets_length):         <- dim0
-//     for j in range(indices_length):     <- dim1
-//         for k in range(embedding_size): <- dim2
-//             if(offsets[i] <= j and j < offsets[i+1]):
-//                 output_tensor[i][k] = output_tensor[i][k] +
-//                 weight[indices[j]][k]
-//             else:
-//                 break
-//
-// Indexing maps for linalg::Generic ops
-//
-//
-// indices_indexing_map  = (d0, d1, d2) -> (d1)
-// offset_indexing_map   = (d0, d1, d2) -> (d0)
-// output_indexing_map   = (d0, d1, d2) -> (d0, d2)
-//
-// TODO: Find an optimal lowering.
-//       current lowering is not optimal for bags of large embeddings.
-//       Since it traverses the output tensor multiple times.
-//
+//     for k in range(embedding_size):     <- dim1
+//         acc = 0, count = 0
+//         for j in range(offsets[i], offsets[i+1]):
+//             if indices[j] != padding_idx:
+//                 value = weight[indices[j]][k] * per_sample_weights[j]
+//                 acc = acc + value (max(acc, value) in the max mode)
+//                 count = count + 1
+//         output_tensor[i][k] = acc (acc / count in the mean mode)
 //
+// Empty bags, or bags of padding entries only, produce zeros.
 
 class ConvertAtenEmbeddingBagPaddingIdxOp
     : public OpConversionPattern<AtenEmbeddingBagPaddingIdxOp> {
@@ -216,7 +248,6 @@ public:
     if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
       return failure();
     Location loc = op->getLoc();
-    auto context = op->getContext();
     Value weight = adaptor.getWeight();
     Value indices = adaptor.getIndices();
     Value offsets = adaptor.getOffsets();
@@ -228,11 +259,10 @@ public:
       return rewriter.notifyMatchFailure(
           op, "mode is expected to be a constant integer value.");
     }
-
-    if (modeInt != torch_upstream::EmbeddingBagMode::MODE_SUM) {
-      return rewriter.notifyMatchFailure(op,
-                                         "Unimplemented: Mean and Max mode are "
-                                         "not supported yet for EmbeddingBag.");
+    if (modeInt != torch_upstream::EmbeddingBagMode::MODE_SUM &&
+        modeInt != torch_upstream::EmbeddingBagMode::MODE_MEAN &&
+        modeInt != torch_upstream::EmbeddingBagMode::MODE_MAX) {
+      return rewriter.notifyMatchFailure(op, "unknown EmbeddingBag mode.");
     }
 
     bool discardLastOffset;
@@ -242,10 +272,36 @@ public:
           op,
           "include_last_offset is expected to be a constant boolean value.");
     }
+    if (discardLastOffset) {
+      return rewriter.notifyMatchFailure(
+          op, "Unimplemented: include last offset is not yet "
+              "supported for EmbeddingBag.");
+    }
+
+    // A negative padding_idx, which is what _embedding_bag uses for None,
+    // does not skip any entry.
+    std::optional<int64_t> paddingIdx;
+    bool hasPaddingIdx = !isa<Torch::NoneType>(op.getPaddingIdx().getType());
+    if (hasPaddingIdx) {
+      int64_t paddingIdxInt;
+      if (!matchPattern(op.getPaddingIdx(),
+                        m_TorchConstantInt(&paddingIdxInt)))
+        return rewriter.notifyMatchFailure(
+            op, "padding_idx is expected to be None or a constant integer.");
+      if (paddingIdxInt >= 0)
+        paddingIdx = paddingIdxInt;
+    }
+
+    Value perSampleWeights;
+    if (!isa<Torch::NoneType>(op.getPerSampleWeights().getType()))
+      perSampleWeights = adaptor.getPerSampleWeights();
 
     auto weightTy = cast<RankedTensorType>(weight.getType());
     if (weightTy.getRank() != 2)
       return rewriter.notifyMatchFailure(op, "weight must be rank 2");
+    Type weightElemTy = weightTy.getElementType();
+    if (!isa<mlir::FloatType>(weightElemTy))
+      return rewriter.notifyMatchFailure(op, "weight must be a float tensor");
 
     auto indicesTy = cast<RankedTensorType>(indices.getType());
     if (indicesTy.getRank() != 1)
@@ -254,159 +310,226 @@ public:
     auto offsetsTy = cast<RankedTensorType>(offsets.getType());
     if (offsetsTy.getRank() != 1)
       return rewriter.notifyMatchFailure(op, "offsets much be a vector");
+    Type offsetElemTy = offsetsTy.getElementType();
 
-    Type weightElemTy = weightTy.getElementType();
-
-    int64_t iterationMapDimension = weightTy.getRank() + indicesTy.getRank();
-    SmallVector<AffineExpr> indicesExpr;
-    indicesExpr.push_back(mlir::getAffineDimExpr(1, context));
-    auto indicesIndexingMap =
-        AffineMap::get(/*dimCount=*/iterationMapDimension, /*symbolCount=*/0,
-                       indicesExpr, context);
-
-    SmallVector<AffineExpr> offsetsExpr;
-    offsetsExpr.push_back(mlir::getAffineDimExpr(0, context));
-
-    auto offsetIndexingMap =
-        AffineMap::get(/*dimCount=*/iterationMapDimension, /*symbolCount=*/0,
-                       offsetsExpr, context);
-
-    SmallVector<AffineExpr> outputExpr;
-    outputExpr.push_back(mlir::getAffineDimExpr(0, context));
-    outputExpr.push_back(mlir::getAffineDimExpr(2, context));
-
-    auto outputIndexingMap =
-        AffineMap::get(/*dimCount=*/iterationMapDimension, /*symbolCount=*/0,
-                       outputExpr, context);
-
-    SmallVector<AffineMap, 3> indexingMaps = {
-        indicesIndexingMap,
-        offsetIndexingMap,
-        outputIndexingMap,
+    bool isMax = modeInt == torch_upstream::EmbeddingBagMode::MODE_MAX;
+    bool isMean = modeInt == torch_upstream::EmbeddingBagMode::MODE_MEAN;
+    Value offsetsLength = getDimOp(rewriter, loc, offsets, 0);
+    Value indicesLength = getDimOp(rewriter, loc, indices, 0);
+
+    // Returns the [start, end) range of `bag` in `indices`.
+    auto getBagBounds = [&](OpBuilder &b, Location loc, Value bag) {
+      Value one = arith::ConstantIndexOp::create(b, loc, 1);
+      Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+      Value start = castIntToIndex(
+          b, loc, tensor::ExtractOp::create(b, loc, offsets, bag));
+      Value next = arith::AddIOp::create(b, loc, bag, one);
+      Value isLast = arith::CmpIOp::create(b, loc, arith::CmpIPredicate::eq,
+                                           next, offsetsLength);
+      // Clamp the index to avoid an out-of-bounds tensor.extract for the
+      // last bag, whose end is discarded by the select below.
+      Value safeNext = arith::SelectOp::create(b, loc, isLast, zero, next);
+      Value end = arith::SelectOp::create(
+          b, loc, isLast, indicesLength,
+          castIntToIndex(b, loc,
+                         tensor::ExtractOp::create(b, loc, offsets, safeNext)));
+      return std::make_pair(start, end);
+    };
+    // Returns whether entry `j` of `indices`, with value `index`, is reduced.
+    auto isNotPadding = [&](OpBuilder &b, Location loc, Value index) {
+      if (!paddingIdx)
+        return Value();
+      Value padding = arith::ConstantOp::create(
+          b, loc, b.getIntegerAttr(index.getType(), *paddingIdx));
+      return Value(arith::CmpIOp::create(b, loc, arith::CmpIPredicate::ne,
+                                         index, padding));
     };
-
-    // Reduce along the indices dim
-    SmallVector<utils::IteratorType> iteratorTypes(
-        {utils::IteratorType::parallel, utils::IteratorType::reduction,
-         utils::IteratorType::parallel});
 
     Value embeddingDim = getDimOp(rewriter, loc, weight, 1);
-    Value initTensor;
-    Value offsetsLength;
-    Value indicesLength;
-    if (!discardLastOffset) {
-      SmallVector<Value> sizes{getDimOp(rewriter, loc, offsets, 0),
-                               embeddingDim};
-
-      initTensor = createZeroInitTensor(rewriter, loc, sizes, weightElemTy);
-      offsetsLength = getDimOp(rewriter, loc, offsets, 0);
-      indicesLength = getDimOp(rewriter, loc, indices, 0);
-    } else {
-      return rewriter.notifyMatchFailure(
-          op, "Unimplemented: include last offset is not yet "
-              "supported for EmbeddingBag.");
-    }
+    SmallVector<Value> sizes{offsetsLength, embeddingDim};
+    SmallVector<Value> outputs{
+        tensor::EmptyOp::create(rewriter, loc, getAsOpFoldResult(sizes),
+                                weightElemTy)};
+    if (isMax)
+      outputs.push_back(
+          createZeroInitTensor(rewriter, loc, sizes, offsetElemTy));
+    SmallVector<AffineMap> indexingMaps(outputs.size(),
+                                        rewriter.getMultiDimIdentityMap(2));
+    SmallVector<utils::IteratorType> iteratorTypes(
+        2, utils::IteratorType::parallel);
+
+    auto embeddingBagOp = linalg::GenericOp::create(
+        rewriter, loc, ValueRange(outputs).getTypes(), ValueRange{}, outputs,
+        indexingMaps, iteratorTypes,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value bag = linalg::IndexOp::create(b, loc, 0);
+          Value column = linalg::IndexOp::create(b, loc, 1);
+          auto [start, end] = getBagBounds(b, loc, bag);
+          Value one = arith::ConstantIndexOp::create(b, loc, 1);
+          Value zeroCount = arith::ConstantIndexOp::create(b, loc, 0);
+          Value zeroElem =
+              arith::ConstantOp::create(b, loc, b.getZeroAttr(weightElemTy));
+          SmallVector<Value> iterArgs{zeroElem, zeroCount};
+          if (isMax)
+            iterArgs.push_back(
+                arith::ConstantOp::create(b, loc, b.getZeroAttr(offsetElemTy)));
+
+          auto loop = scf::ForOp::create(
+              b, loc, start, end, one, iterArgs,
+              [&](OpBuilder &b, Location loc, Value j, ValueRange acc) {
+                Value index = tensor::ExtractOp::create(b, loc, indices, j);
+                Value value = tensor::ExtractOp::create(
+                    b, loc, weight,
+                    ValueRange{castIntToIndex(b, loc, index), column});
+                if (perSampleWeights) {
+                  Value sampleWeight = convertScalarToDtype(
+                      b, loc,
+                      tensor::ExtractOp::create(b, loc, perSampleWeights, j),
+                      weightElemTy);
+                  value = arith::MulFOp::create(b, loc, value, sampleWeight);
+                }
 
-    Value embeddingBagResult =
-        linalg::GenericOp::create(
-            rewriter, loc, initTensor.getType(), ValueRange{indices, offsets},
-            initTensor,
-            /*indexingMaps=*/indexingMaps,
-            /*iteratorTypes=*/iteratorTypes,
-            [&](OpBuilder &b, Location loc, ValueRange args) {
-              Value indexInIndices = args[0];
-              Value offsetsI = args[1];
-              Value initTensorElem = args[2];
-
-              Value indexI = linalg::IndexOp::create(b, loc, /*value=*/0);
-              Value indexIToInt = castIndexToInt64(b, loc, indexI);
-              Value one =
-                  getConstant(b, loc, 1,
-                              mlir::IntegerType::get(getContext(), 64,
-                                                     IntegerType::Signless));
-              Value offsetIndexPlusOneInt =
-                  arith::AddIOp::create(b, loc, indexIToInt, one);
-
-              Value offsetIndexPlusOne =
-                  castIntToIndex(b, loc, offsetIndexPlusOneInt);
-              Value checkLast =
-                  arith::CmpIOp::create(b, loc, arith::CmpIPredicate::eq,
-                                        castIndexToInt64(b, loc, offsetsLength),
-                                        offsetIndexPlusOneInt);
-              // Clamp the index to avoid an unconditional out-of-bounds
-              // tensor.extract when i+1 == num_offsets (the last bag). When
-              // checkLast is true, the extracted value is discarded by the
-              // arith.select below, so any in-bounds index (0) is safe.
-              Value zeroIndex = arith::ConstantIndexOp::create(b, loc, 0);
-              Value safeOffsetIndexPlusOne = arith::SelectOp::create(
-                  b, loc, checkLast, zeroIndex, offsetIndexPlusOne);
-              Value nextOffset = arith::SelectOp::create(
-                  b, loc, checkLast, castIndexToInt64(b, loc, indicesLength),
-                  tensor::ExtractOp::create(b, loc, offsets,
-                                            safeOffsetIndexPlusOne));
-
-              Value indicesIndex = castIndexToInt64(
-                  b, loc, linalg::IndexOp::create(b, loc, /*value=*/1));
-
-              Value offsetLessThanIndicesIndex = arith::CmpIOp::create(
-                  b, loc, arith::CmpIPredicate::slt, offsetsI, indicesIndex);
-              Value offsetEqualToIndicesIndex = arith::CmpIOp::create(
-                  b, loc, arith::CmpIPredicate::eq, offsetsI, indicesIndex);
-              Value offsetLessThanOrEqualToIndicesIndex =
-                  arith::OrIOp::create(b, loc, offsetLessThanIndicesIndex,
-                                       offsetEqualToIndicesIndex);
-
-              Value indicesIndexLessThanNextOffset = arith::CmpIOp::create(
-                  b, loc, arith::CmpIPredicate::slt, indicesIndex, nextOffset);
-
-              Value indicesIndexWithinBounds = arith::AndIOp::create(
-                  b, loc, offsetLessThanOrEqualToIndicesIndex,
-                  indicesIndexLessThanNextOffset);
-
-              SmallVector<Value> indexIntoWeight;
-              indexIntoWeight.push_back(castIntToIndex(b, loc, indexInIndices));
-              indexIntoWeight.push_back(
-                  linalg::IndexOp::create(b, loc, /*value=*/2));
-              Value weightElem =
-                  tensor::ExtractOp::create(b, loc, weight, indexIntoWeight);
-
-              Value addResult =
-                  arith::AddFOp::create(b, loc, weightElem, initTensorElem);
-              Value select = arith::SelectOp::create(
-                  b, loc, indicesIndexWithinBounds, addResult, initTensorElem);
-              linalg::YieldOp::create(b, loc, select);
-            })
-            .getResult(0);
+                Value count = acc[1];
+                SmallVector<Value> results;
+                if (isMax) {
+                  // The first entry of a bag always replaces the initial
+                  // zero; ties keep the first maximum.
+                  Value isFirst = arith::CmpIOp::create(
+                      b, loc, arith::CmpIPredicate::eq, count, zeroCount);
+                  Value isGreater = arith::CmpFOp::create(
+                      b, loc, arith::CmpFPredicate::UGT, value, acc[0]);
+                  Value replace =
+                      arith::OrIOp::create(b, loc, isFirst, isGreater);
+                  Value maxIndex =
+                      convertScalarToDtype(b, loc, index, offsetElemTy);
+                  results.push_back(
+                      arith::SelectOp::create(b, loc, replace, value, acc[0]));
+                  results.push_back(arith::AddIOp::create(b, loc, count, one));
+                  results.push_back(arith::SelectOp::create(b, loc, replace,
+                                                            maxIndex, acc[2]));
+                } else {
+                  results.push_back(
+                      arith::AddFOp::create(b, loc, acc[0], value));
+                  results.push_back(arith::AddIOp::create(b, loc, count, one));
+                }
+                if (Value reduce = isNotPadding(b, loc, index)) {
+                  for (size_t i = 0, e = results.size(); i < e; ++i)
+                    results[i] = arith::SelectOp::create(b, loc, reduce,
+                                                         results[i], acc[i]);
+                }
+                scf::YieldOp::create(b, loc, results);
+              });
+
+          Value result = loop.getResult(0);
+          Value count = loop.getResult(1);
+          if (isMean) {
+            Value countElem = convertScalarToDtype(
+                b, loc, castIndexToInt64(b, loc, count), weightElemTy);
+            result = arith::DivFOp::create(b, loc, result, countElem);
+          }
+          Value isEmpty = arith::CmpIOp::create(
+              b, loc, arith::CmpIPredicate::eq, count, zeroCount);
+          SmallVector<Value> yields{
+              arith::SelectOp::create(b, loc, isEmpty, zeroElem, result)};
+          if (isMax)
+            yields.push_back(loop.getResult(2));
+          linalg::YieldOp::create(b, loc, yields);
+        });
 
     // cast outputType.
     auto restulType0 = typeConverter->convertType(op->getResult(0).getType());
-    Value castedEmbeddingBagResult =
-        tensor::CastOp::create(rewriter, loc, restulType0, embeddingBagResult);
-
-    // offset2 tensor, this should be an empty tensor for the sum mode
-    SmallVector<Value> offsetResultSize;
-    Type offsetElemTy = offsetsTy.getElementType();
-    Value zeroDim = arith::ConstantIndexOp::create(rewriter, loc, /*value=*/0);
-    offsetResultSize.push_back(zeroDim);
-    Value offsetResult = tensor::EmptyOp::create(
-        rewriter, loc, getAsOpFoldResult(offsetResultSize), offsetElemTy);
+    Value castedEmbeddingBagResult = tensor::CastOp::create(
+        rewriter, loc, restulType0, embeddingBagOp.getResult(0));
+
+    // offset2bag, the bag of every index. It is an empty tensor unless
+    // per_sample_weights or padding_idx are given outside the mean mode.
+    Value offsetResult;
+    if (!isMean && (perSampleWeights || hasPaddingIdx)) {
+      Value init = createZeroInitTensor(
+          rewriter, loc, ValueRange{indicesLength}, offsetElemTy);
+      Value zero = arith::ConstantIndexOp::create(rewriter, loc, 0);
+      Value one = arith::ConstantIndexOp::create(rewriter, loc, 1);
+      offsetResult =
+          scf::ForOp::create(
+              rewriter, loc, zero, offsetsLength, one, ValueRange{init},
+              [&](OpBuilder &b, Location loc, Value bag, ValueRange acc) {
+                auto [start, end] = getBagBounds(b, loc, bag);
+                Value length = arith::SubIOp::create(b, loc, end, start);
+                Value slice = tensor::ExtractSliceOp::create(
+                    b, loc, acc[0], ValueRange{start}, ValueRange{length},
+                    ValueRange{one});
+                Value bagId = convertScalarToDtype(
+                    b, loc, castIndexToInt64(b, loc, bag), offsetElemTy);
+                Value filled =
+                    linalg::FillOp::create(b, loc, bagId, slice).result();
+                scf::YieldOp::create(
+                    b, loc,
+                    ValueRange{tensor::InsertSliceOp::create(
+                        b, loc, filled, acc[0], ValueRange{start},
+                        ValueRange{length}, ValueRange{one})});
+              })
+              .getResult(0);
+    } else {
+      Value zeroDim =
+          arith::ConstantIndexOp::create(rewriter, loc, /*value=*/0);
+      offsetResult = tensor::EmptyOp::create(
+          rewriter, loc, getAsOpFoldResult(ValueRange{zeroDim}), offsetElemTy);
+    }
     auto resultType1 = typeConverter->convertType(op->getResult(1).getType());
     Value castedOffsetResult =
         tensor::CastOp::create(rewriter, loc, resultType1, offsetResult);
 
+    // bagsize, the number of reduced entries of every bag in the mean and max
+    // modes and a vector of zeros in the sum mode.
     SmallVector<Value> offsetSize = getTensorSizes(rewriter, loc, offsets);
-    // bagsize, vector of size offset with zeros, I think this is always just
-    // a vector of zeros in the sum mode
     Value bagSize =
         createZeroInitTensor(rewriter, loc, offsetSize, offsetElemTy);
+    if (isMean || isMax) {
+      bagSize =
+          linalg::GenericOp::create(
+              rewriter, loc, bagSize.getType(), ValueRange{}, bagSize,
+              rewriter.getMultiDimIdentityMap(1),
+              utils::IteratorType::parallel,
+              [&](OpBuilder &b, Location loc, ValueRange args) {
+                Value bag = linalg::IndexOp::create(b, loc, 0);
+                auto [start, end] = getBagBounds(b, loc, bag);
+                Value count = arith::SubIOp::create(b, loc, end, start);
+                if (paddingIdx) {
+                  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+                  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+                  count =
+                      scf::ForOp::create(
+                          b, loc, start, end, one, ValueRange{zero},
+                          [&](OpBuilder &b, Location loc, Value j,
+                              ValueRange acc) {
+                            Value index =
+                                tensor::ExtractOp::create(b, loc, indices, j);
+                            Value next =
+                                arith::AddIOp::create(b, loc, acc[0], one);
+                            scf::YieldOp::create(
+                                b, loc,
+                                ValueRange{arith::SelectOp::create(
+                                    b, loc, isNotPadding(b, loc, index), next,
+                                    acc[0])});
+                          })
+                          .getResult(0);
+                }
+                Value countInt = castIndexToInt64(b, loc, count);
+                linalg::YieldOp::create(
+                    b, loc,
+                    convertScalarToDtype(b, loc, countInt, offsetElemTy));
+              })
+              .getResult(0);
+    }
     auto resultType2 = typeConverter->convertType(op->getResult(2).getType());
     Value castedBagSizeResult =
         tensor::CastOp::create(rewriter, loc, resultType2, bagSize);
 
-    // max indices, vector of size offset with zeros, this is also always a
-    // vector of zeros in the sum mode. Its mainly used in the max mode.
+    // max indices, the index of the maximum of every element in the max mode
+    // and a vector of zeros otherwise.
     Value indicesOut =
-        createZeroInitTensor(rewriter, loc, offsetSize, offsetElemTy);
+        isMax ? embeddingBagOp.getResult(1)
+              : createZeroInitTensor(rewriter, loc, offsetSize, offsetElemTy);
     auto resultType3 = typeConverter->convertType(op->getResult(3).getType());
     Value castedMaxIndices =
         tensor::CastOp::create(rewriter, loc, resultType3, indicesOut);
@@ -425,11 +548,9 @@ namespace {
 // integer argument dim = 1. The size of the output tensor will be [4, 2, 6].
 // The approach is as follows:
 //
-// for i in range(input.size[0])
-//    for j in range(index.size[0])
-//       for k in range(input.size[2])
-//          indexValue = index[j]
-//          output[i,j,k] = input[i,indexValue,k]
+// for j in range(index.size[0])
+//    indexValue = index[j]
+//    output[:,j,:] = input[:,indexValue,:]
 
 class ConvertAtenIndexSelectOp : public OpConversionPattern<AtenIndexSelectOp> {
 public:
@@ -447,7 +568,6 @@ public:
     RankedTensorType inputType = cast<RankedTensorType>(input.getType());
     RankedTensorType resultType = cast<RankedTensorType>(
         getTypeConverter()->convertType(op->getResult(0).getType()));
-    Type elementType = resultType.getElementType();
     unsigned inputRank = inputType.getRank();
 
     int64_t dimInt;
@@ -464,42 +584,7 @@ public:
                                               reassociations);
     }
 
-    SmallVector<Value> resultShape = getTensorSizes(rewriter, loc, input);
-    resultShape[dimInt] = getTensorSizes(rewriter, loc, indices)[0];
-    Value initTensor = tensor::EmptyOp::create(
-        rewriter, loc, getAsOpFoldResult(resultShape), elementType);
-
-    SmallVector<AffineExpr> resultExpr;
-    AffineExpr indicesExpr = rewriter.getAffineDimExpr(dimInt);
-    SmallVector<utils::IteratorType> iteratorTypes(
-        inputRank, utils::IteratorType::parallel);
-
-    for (unsigned i = 0; i < inputRank; i++) {
-      resultExpr.push_back(rewriter.getAffineDimExpr(i));
-    }
-
-    auto indexingMaps = AffineMap::inferFromExprList({indicesExpr, resultExpr},
-                                                     rewriter.getContext());
-
-    Value finalRes =
-        linalg::GenericOp::create(
-            rewriter, loc, initTensor.getType(), ValueRange{indices},
-            initTensor,
-            /*indexingMaps=*/indexingMaps,
-            /*iteratorTypes=*/iteratorTypes,
-            [&](OpBuilder &b, Location loc, ValueRange args) {
-              Value index = arith::IndexCastOp::create(
-                  rewriter, loc, rewriter.getIndexType(), args[0]);
-              SmallVector<Value> indexTarget;
-              for (unsigned i = 0; i < inputRank; i++)
-                indexTarget.push_back(linalg::IndexOp::create(b, loc, i));
-              indexTarget[dimInt] = index;
-              Value extractedElement =
-                  tensor::ExtractOp::create(b, loc, input, indexTarget);
-              linalg::YieldOp::create(b, loc, extractedElement);
-            })
-            .getResult(0);
-
+    Value finalRes = createSliceGather(rewriter, loc, input, indices, dimInt);
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, finalRes);
     return success();
   }
@@ -517,6 +602,95 @@ static Value makeIndexValuePositive(OpBuilder &b, Location loc, Value index,
                                  index);
 }
 
+// Gathers `input[indexTensors[0], ..., indexTensors[k - 1]]`, where the `k`
+// index tensors have the same type and index the leading dims of `input`.
+// Each of their positions selects a contiguous block of the trailing dims, so
+// the indices are linearized into one index of the collapsed leading dims and
+// the blocks are copied by `createSliceGather`, which loads the indices once
+// per block instead of once per element of the result.
+static Value createLeadingIndexGather(OpBuilder &b, Location loc, Value input,
+                                      ValueRange indexTensors) {
+  int64_t inputRank = cast<RankedTensorType>(input.getType()).getRank();
+  int64_t indexRank =
+      cast<RankedTensorType>(indexTensors[0].getType()).getRank();
+  int64_t indexCount = indexTensors.size();
+  int64_t trailingRank = inputRank - indexCount;
+
+  SmallVector<OpFoldResult> indexSizes =
+      tensor::getMixedSizes(b, loc, indexTensors[0]);
+  Value linearInit =
+      tensor::EmptyOp::create(b, loc, indexSizes, b.getI64Type());
+  SmallVector<AffineMap> indexingMaps(indexCount + 1,
+                                      b.getMultiDimIdentityMap(indexRank));
+  SmallVector<utils::IteratorType> iteratorTypes(
+      indexRank, utils::IteratorType::parallel);
+  Value linear =
+      linalg::GenericOp::create(
+          b, loc, linearInit.getType(), indexTensors, linearInit,
+          indexingMaps, iteratorTypes,
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            Value linearIndex;
+            for (int64_t i = 0; i < indexCount; ++i) {
+              Value index = makeIndexValuePositive(b, loc, args[i], input, i);
+              if (!linearIndex) {
+                linearIndex = index;
+                continue;
+              }
+              Value size = castIndexToInt64(b, loc, getDimOp(b, loc, input, i));
+              linearIndex = arith::AddIOp::create(
+                  b, loc, arith::MulIOp::create(b, loc, linearIndex, size),
+                  index);
+            }
+            linalg::YieldOp::create(b, loc, linearIndex);
+          })
+          .getResult(0);
+
+  // Make the linear indices 1-D and collapse the indexed dims of the input
+  // into one.
+  if (indexRank == 0) {
+    linear = tensor::ExpandShapeOp::create(
+        b, loc, RankedTensorType::get({1}, b.getI64Type()), linear,
+        ArrayRef<ReassociationIndices>{});
+  } else if (indexRank > 1) {
+    SmallVector<ReassociationIndices> reassociation(1);
+    llvm::append_range(reassociation[0], llvm::seq<int64_t>(0, indexRank));
+    linear = tensor::CollapseShapeOp::create(b, loc, linear, reassociation);
+  }
+  if (indexCount > 1) {
+    SmallVector<ReassociationIndices> reassociation(1);
+    llvm::append_range(reassociation[0], llvm::seq<int64_t>(0, indexCount));
+    for (int64_t i = indexCount; i < inputRank; ++i)
+      reassociation.push_back({i});
+    input = tensor::CollapseShapeOp::create(b, loc, input, reassociation);
+  }
+
+  Value gathered = createSliceGather(b, loc, input, linear, /*dim=*/0);
+
+  // Restore the shape of the index tensors in the leading dims.
+  if (indexRank == 0) {
+    SmallVector<ReassociationIndices> reassociation = {{0, 1}};
+    for (int64_t i = 2; i <= trailingRank; ++i)
+      reassociation.push_back({i});
+    return tensor::CollapseShapeOp::create(b, loc, gathered, reassociation);
+  }
+  if (indexRank == 1)
+    return gathered;
+  SmallVector<ReassociationIndices> reassociation(1);
+  llvm::append_range(reassociation[0], llvm::seq<int64_t>(0, indexRank));
+  SmallVector<OpFoldResult> resultSizes(indexSizes);
+  SmallVector<OpFoldResult> gatheredSizes =
+      tensor::getMixedSizes(b, loc, gathered);
+  for (int64_t i = 1; i <= trailingRank; ++i) {
+    reassociation.push_back({indexRank + i - 1});
+    resultSizes.push_back(gatheredSizes[i]);
+  }
+  auto resultType =
+      RankedTensorType::get(decomposeMixedValues(resultSizes).first,
+                            getElementTypeOrSelf(gathered.getType()));
+  return tensor::ExpandShapeOp::create(b, loc, resultType, gathered,
+                                       reassociation, resultSizes);
+}
+
 // IndexTensor for multiple input tensors broadcasts their shapes to a common
 // shape and then replaces the indexed dims with the indices given by the
 // indexing tensors:
@@ -586,6 +760,19 @@ public:
     int replacedIndexCount = indexTensorDims.size();
     int64_t startIndex = contiguous ? firstIndexDim : 0;
 
+    // Index tensors of the same type that index the leading dims select
+    // contiguous blocks of the trailing dims, which are copied whole.
+    Type indexType = indexTensors[0].getType();
+    if (contiguous && firstIndexDim == 0 && replacedIndexCount < inputRank &&
+        getElementTypeOrSelf(indexType).isInteger(64) &&
+        llvm::all_of(indexTensors,
+                     [&](Value v) { return v.getType() == indexType; })) {
+      Value gathered =
+          createLeadingIndexGather(rewriter, loc, input, indexTensors);
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, gathered);
+      return success();
+    }
+
     // Currently we only support statically sized index tensors or dynamic size
     // index tensors without overlapping dynamic dims when there is more than
     // one index tensor.
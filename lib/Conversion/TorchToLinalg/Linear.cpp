@@ -14,6 +14,7 @@
 #include "mlir/Dialect/Complex/IR/Complex.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
 #include "mlir/IR/Matchers.h"
 #include "torch-mlir/Conversion/TorchToLinalg/Utils.h"
 #include "torch-mlir/Conversion/Utils/Utils.h"
@@ -50,6 +51,34 @@ static void signShift(PatternRewriter &rewriter, Location loc, Value &arg,
       });
 }
 
+// The zero point of the quantized `operand` as an i32, for the quantized
+// matmul and convolution ops, or null if it has none. A per-channel quantized
+// operand is only supported with zero points of 0, in which case its scales
+// only apply to the result, which `torch-fuse-quantized-ops` dequantizes per
+// channel.
+static FailureOr<Value>
+getI32ZeroPoint(ConversionPatternRewriter &rewriter, Location loc,
+                const TypeConverter *typeConverter, Value operand) {
+  if (auto make =
+          operand.getDefiningOp<Aten_MakePerChannelQuantizedTensorOp>()) {
+    DenseIntElementsAttr zeroPoints;
+    if (!matchPattern(make.getZeroPoint(), m_Constant(&zeroPoints)) ||
+        !llvm::all_of(zeroPoints.getValues<APInt>(),
+                      [](const APInt &zp) { return zp.isZero(); }))
+      return failure();
+    return Value(arith::ConstantIntOp::create(rewriter, loc, 0, 32));
+  }
+  Value zeroPoint;
+  getZeroPoint(operand, zeroPoint);
+  if (!zeroPoint)
+    return Value();
+  zeroPoint = typeConverter->materializeTargetConversion(
+      rewriter, loc, typeConverter->convertType(zeroPoint.getType()),
+      zeroPoint);
+  return Value(arith::TruncIOp::create(rewriter, loc, rewriter.getI32Type(),
+                                       zeroPoint));
+}
+
 static Value transposeValue(Location loc, Value value, ArrayRef<int64_t> perms,
                             PatternRewriter &rewriter) {
   auto valueTy = cast<RankedTensorType>(value.getType());
@@ -71,9 +100,69 @@ static Value transposeValue(Location loc, Value value, ArrayRef<int64_t> perms,
   return transpose;
 }
 
+// If `value` is a transpose of a matrix, returns the converted matrix so that
+// a matmul can read it through its indexing maps instead of materializing the
+// transpose.
+static Value getTransposedMatrix(Value value,
+                                 ConversionPatternRewriter &rewriter) {
+  Value matrix;
+  SmallVector<int64_t> perms;
+  int64_t dim0, dim1;
+  if (auto transpose = value.getDefiningOp<AtenTransposeIntOp>()) {
+    if (matchPattern(transpose.getDim0(), m_TorchConstantInt(&dim0)) &&
+        matchPattern(transpose.getDim1(), m_TorchConstantInt(&dim1)) &&
+        isValidDim(dim0, 2) && isValidDim(dim1, 2) &&
+        toPositiveDim(dim0, 2) != toPositiveDim(dim1, 2))
+      matrix = transpose.getSelf();
+  } else if (auto permute = value.getDefiningOp<AtenPermuteOp>()) {
+    if (matchPattern(permute.getDims(), m_TorchListOfConstantInts(perms)) &&
+        perms.size() == 2 && toPositiveDim(perms[0], 2) == 1 &&
+        toPositiveDim(perms[1], 2) == 0)
+      matrix = permute.getSelf();
+  } else if (auto t = value.getDefiningOp<AtenTOp>()) {
+    // `aten.t` of a vector is the vector itself, which the rank check below
+    // rules out.
+    matrix = t.getSelf();
+  }
+  if (!matrix)
+    return nullptr;
+  Value converted = rewriter.getRemappedValue(matrix);
+  auto convertedType =
+      converted ? dyn_cast<RankedTensorType>(converted.getType()) : nullptr;
+  // Sparse matrices are read in their storage order instead.
+  if (!convertedType || convertedType.getRank() != 2 ||
+      convertedType.getEncoding())
+    return nullptr;
+  return converted;
+}
+
+// Makes `matmul` read its operands through transposed indexing maps, as set by
+// `lhsTransposed` and `rhsTransposed`.
+static void setTransposedIndexingMaps(linalg::MatmulOp matmul,
+                                      bool lhsTransposed, bool rhsTransposed,
+                                      OpBuilder &b) {
+  if (!lhsTransposed && !rhsTransposed)
+    return;
+  AffineExpr m, n, k;
+  bindDims(b.getContext(), m, n, k);
+  auto getMap = [&](ArrayRef<AffineExpr> results) {
+    return AffineMap::get(3, 0, results, b.getContext());
+  };
+  matmul.setIndexingMapsAttr(b.getAffineMapArrayAttr(
+      {getMap(lhsTransposed ? ArrayRef<AffineExpr>{k, m}
+                            : ArrayRef<AffineExpr>{m, k}),
+       getMap(rhsTransposed ? ArrayRef<AffineExpr>{n, k}
+                            : ArrayRef<AffineExpr>{k, n}),
+       getMap({m, n})}));
+}
+
 class ConvertAtenMmOp : public OpConversionPattern<AtenMmOp> {
 public:
-  using OpConversionPattern::OpConversionPattern;
+  ConvertAtenMmOp(TypeConverter &typeConverter, MLIRContext *context,
+                  bool readTransposedOperands)
+      : OpConversionPattern(typeConverter, context),
+        readTransposedOperands(readTransposedOperands) {}
+
   LogicalResult
   matchAndRewrite(AtenMmOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -128,12 +217,30 @@ public:
     bool isUnsigned = torch_to_linalg::isUnsignedTorchType(lhsTorchType);
     bool isUnsignedR = torch_to_linalg::isUnsignedTorchType(rhsTorchType);
 
-    Value lhsDim0 = tensor::DimOp::create(rewriter, loc, lhs, 0);
-    Value rhsDim1 = tensor::DimOp::create(rewriter, loc, rhs, 1);
+    // Operands that are transposes, such as the weight in `mm(x, w.t())`, are
+    // read in place by the matmul.
+    bool lhsTransposed = false, rhsTransposed = false;
+    if (readTransposedOperands && !lhsZeroPoint) {
+      if (Value matrix = getTransposedMatrix(op.getSelf(), rewriter)) {
+        lhs = matrix;
+        lhsTransposed = true;
+      }
+      if (Value matrix = getTransposedMatrix(op.getMat2(), rewriter)) {
+        rhs = matrix;
+        rhsTransposed = true;
+      }
+    }
+
+    Value lhsDim0 =
+        tensor::DimOp::create(rewriter, loc, lhs, lhsTransposed ? 1 : 0);
+    Value rhsDim1 =
+        tensor::DimOp::create(rewriter, loc, rhs, rhsTransposed ? 0 : 1);
 
     if (!isAssumingStrictSymbolicShapes(rewriter)) {
-      Value lhsDim1 = tensor::DimOp::create(rewriter, loc, lhs, 1);
-      Value rhsDim0 = tensor::DimOp::create(rewriter, loc, rhs, 0);
+      Value lhsDim1 =
+          tensor::DimOp::create(rewriter, loc, lhs, lhsTransposed ? 0 : 1);
+      Value rhsDim0 =
+          tensor::DimOp::create(rewriter, loc, rhs, rhsTransposed ? 1 : 0);
       Value contractingDimEqual = arith::CmpIOp::create(
           rewriter, loc, arith::CmpIPredicate::eq, lhsDim1, rhsDim0);
       cf::AssertOp::create(
@@ -155,18 +262,15 @@ public:
 
     Value matmul;
     if (lhsZeroPoint) {
-      lhsZeroPoint = typeConverter->materializeTargetConversion(
-          rewriter, loc,
-          getTypeConverter()->convertType(lhsZeroPoint.getType()),
-          lhsZeroPoint);
-      rhsZeroPoint = typeConverter->materializeTargetConversion(
-          rewriter, loc,
-          getTypeConverter()->convertType(rhsZeroPoint.getType()),
-          rhsZeroPoint);
-      lhsZeroPoint = arith::TruncIOp::create(
-          rewriter, loc, rewriter.getI32Type(), lhsZeroPoint);
-      rhsZeroPoint = arith::TruncIOp::create(
-          rewriter, loc, rewriter.getI32Type(), rhsZeroPoint);
+      FailureOr<Value> lhsZp =
+          getI32ZeroPoint(rewriter, loc, typeConverter, op.getSelf());
+      FailureOr<Value> rhsZp =
+          getI32ZeroPoint(rewriter, loc, typeConverter, op.getMat2());
+      if (failed(lhsZp) || failed(rhsZp))
+        return rewriter.notifyMatchFailure(
+            op, "unsupported: per-channel zero points other than 0");
+      lhsZeroPoint = *lhsZp;
+      rhsZeroPoint = *rhsZp;
 
       // change uint8 quantization -> int8 quantization
       int64_t numBits =
@@ -179,15 +283,14 @@ public:
                    rewriter, loc, zeroFill.getType(),
                    ValueRange{lhs, rhs, lhsZeroPoint, rhsZeroPoint}, zeroFill)
                    .getResult(0);
-    } else if (isUnsigned) {
+    } else {
       auto matmulOp = linalg::MatmulOp::create(
           rewriter, loc, zeroFill.getType(), ValueRange{lhs, rhs}, zeroFill);
-      matmulOp.setCast(linalg::TypeFn::cast_unsigned);
+      if (isUnsigned)
+        matmulOp.setCast(linalg::TypeFn::cast_unsigned);
+      setTransposedIndexingMaps(matmulOp, lhsTransposed, rhsTransposed,
+                                rewriter);
       matmul = matmulOp->getResult(0);
-    } else {
-      matmul = linalg::MatmulOp::create(rewriter, loc, zeroFill.getType(),
-                                        ValueRange{lhs, rhs}, zeroFill)
-                   .getResult(0);
     }
 
     if (accumulatorDType != resultType.getElementType()) {
@@ -203,6 +306,9 @@ public:
 
     return success();
   }
+
+private:
+  bool readTransposedOperands;
 };
 } // namespace
 
@@ -288,18 +394,15 @@ public:
 
     if (lhsZeroPoint) {
       // get each zero point ready to pass to a quantized_matmul
-      lhsZeroPoint = typeConverter->materializeTargetConversion(
-          rewriter, loc,
-          getTypeConverter()->convertType(lhsZeroPoint.getType()),
-          lhsZeroPoint);
-      rhsZeroPoint = typeConverter->materializeTargetConversion(
-          rewriter, loc,
-          getTypeConverter()->convertType(rhsZeroPoint.getType()),
-          rhsZeroPoint);
-      lhsZeroPoint = arith::TruncIOp::create(
-          rewriter, loc, rewriter.getI32Type(), lhsZeroPoint);
-      rhsZeroPoint = arith::TruncIOp::create(
-          rewriter, loc, rewriter.getI32Type(), rhsZeroPoint);
+      FailureOr<Value> lhsZp =
+          getI32ZeroPoint(rewriter, loc, typeConverter, op.getSelf());
+      FailureOr<Value> rhsZp =
+          getI32ZeroPoint(rewriter, loc, typeConverter, op.getOther());
+      if (failed(lhsZp) || failed(rhsZp))
+        return rewriter.notifyMatchFailure(
+            op, "unsupported: per-channel zero points other than 0");
+      lhsZeroPoint = *lhsZp;
+      rhsZeroPoint = *rhsZp;
 
       // change uint8 quantization -> int8 quantization
       int64_t numBits =
@@ -362,6 +465,24 @@ public:
       // covered in the relevant section below
     }
 
+    // Transposed matrices, such as the weight of a decomposed `aten.linear`,
+    // are read in place by the matmul instead of being materialized.
+    bool lhsTransposed = false, rhsTransposed = false;
+    if (!lhsZeroPoint && rhsRank == 2) {
+      if (lhsRank == 2) {
+        if (Value matrix = getTransposedMatrix(op.getSelf(), rewriter)) {
+          lhs = matrix;
+          lhsTransposed = true;
+        }
+      }
+      if (lhsRank >= 2) {
+        if (Value matrix = getTransposedMatrix(op.getOther(), rewriter)) {
+          rhs = matrix;
+          rhsTransposed = true;
+        }
+      }
+    }
+
     // The different cases of torch_matmul op is mentioned here:
     // https://pytorch.org/docs/stable/generated/torch.matmul.html
 
@@ -428,10 +549,10 @@ public:
 
     // Fourth Case: Mat-Mat Multiplication.
     if (lhsRank == 2 && rhsRank == 2) {
-      Value lhsDim0 = getDimOp(rewriter, loc, lhs, 0);
-      Value lhsDim1 = getDimOp(rewriter, loc, lhs, 1);
-      Value rhsDim0 = getDimOp(rewriter, loc, rhs, 0);
-      Value rhsDim1 = getDimOp(rewriter, loc, rhs, 1);
+      Value lhsDim0 = getDimOp(rewriter, loc, lhs, lhsTransposed ? 1 : 0);
+      Value lhsDim1 = getDimOp(rewriter, loc, lhs, lhsTransposed ? 0 : 1);
+      Value rhsDim0 = getDimOp(rewriter, loc, rhs, rhsTransposed ? 1 : 0);
+      Value rhsDim1 = getDimOp(rewriter, loc, rhs, rhsTransposed ? 0 : 1);
       checkDimEqualHelper(rewriter, loc, lhsDim1, rhsDim0);
 
       Value zeroTensor = createZeroInitTensor(
@@ -444,9 +565,12 @@ public:
                 ValueRange{lhs, rhs, lhsZeroPoint, rhsZeroPoint}, zeroTensor)
                 .getResult(0);
       } else {
-        matmul = linalg::MatmulOp::create(rewriter, loc, zeroTensor.getType(),
-                                          ValueRange{lhs, rhs}, zeroTensor)
-                     .getResult(0);
+        auto matmulOp = linalg::MatmulOp::create(
+            rewriter, loc, zeroTensor.getType(), ValueRange{lhs, rhs},
+            zeroTensor);
+        setTransposedIndexingMaps(matmulOp, lhsTransposed, rhsTransposed,
+                                  rewriter);
+        matmul = matmulOp->getResult(0);
       }
       if (accumulatorDType != resultElementType) {
         matmul = torch_to_linalg::convertTensorToElementType(
@@ -469,6 +593,167 @@ public:
         return rewriter.notifyMatchFailure(op, "expected batch dimensions");
       }
 
+      // A batch of matrices times a matrix, as in `aten.linear` with a
+      // batched input, is one matmul of the rows of the batch, which reads
+      // the matrix in place, transposed or not, instead of broadcasting it.
+      // The rows are expanded back like in the collapsed case below, so at
+      // most one of the rows and batch dimensions may be dynamic.
+      ArrayRef<int64_t> lhsShape = lhsType.getShape();
+      ArrayRef<int64_t> rhsShape = rhsType.getShape();
+      unsigned rhsNDim = rhsTransposed ? 0 : rhsRank - 1;
+      unsigned rhsKDim = rhsTransposed ? 1 : rhsRank - 2;
+      bool isDense = !lhsType.getEncoding() && !rhsType.getEncoding();
+      if (isDense && rhsRank == 2 &&
+          llvm::count_if(lhsShape.drop_back(), ShapedType::isDynamic) <= 1) {
+        SmallVector<ReassociationIndices> reassociation(2);
+        for (unsigned i = 0; i < lhsRank - 1; i++)
+          reassociation[0].push_back(i);
+        reassociation[1].push_back(lhsRank - 1);
+        Value rows = tensor::CollapseShapeOp::create(rewriter, loc, lhs,
+                                                     reassociation);
+        Value rowsDim0 = getDimOp(rewriter, loc, rows, 0);
+        Value rowsDim1 = getDimOp(rewriter, loc, rows, 1);
+        Value rhsDim0 = getDimOp(rewriter, loc, rhs, rhsKDim);
+        Value rhsDim1 = getDimOp(rewriter, loc, rhs, rhsNDim);
+        checkDimEqualHelper(rewriter, loc, rowsDim1, rhsDim0);
+
+        Value zeroTensor = createZeroInitTensor(
+            rewriter, loc, ValueRange{rowsDim0, rhsDim1}, elementType);
+        Value matmul;
+        if (lhsZeroPoint) {
+          matmul = linalg::QuantizedMatmulOp::create(
+                       rewriter, loc, zeroTensor.getType(),
+                       ValueRange{rows, rhs, lhsZeroPoint, rhsZeroPoint},
+                       zeroTensor)
+                       .getResult(0);
+        } else {
+          auto matmulOp = linalg::MatmulOp::create(
+              rewriter, loc, zeroTensor.getType(), ValueRange{rows, rhs},
+              zeroTensor);
+          if (isUnsigned)
+            matmulOp.setCast(linalg::TypeFn::cast_unsigned);
+          setTransposedIndexingMaps(matmulOp, /*lhsTransposed=*/false,
+                                    rhsTransposed, rewriter);
+          matmul = matmulOp->getResult(0);
+        }
+        if (accumulatorDType != resultElementType) {
+          matmul = torch_to_linalg::convertTensorToElementType(
+              rewriter, loc, matmul, resultElementType);
+        }
+        SmallVector<int64_t> expandedShape(lhsShape.drop_back());
+        expandedShape.push_back(rhsShape[rhsNDim]);
+        auto expandedType = RankedTensorType::get(
+            expandedShape, resultElementType, resultType.getEncoding());
+        Value expanded = tensor::ExpandShapeOp::create(
+            rewriter, loc, expandedType, matmul, reassociation);
+        rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType,
+                                                    expanded);
+        return success();
+      }
+
+      // Batch dimensions that are statically broadcast, i.e. missing or of
+      // size 1 on one side only, are read in place through the indexing maps
+      // of a generic matmul instead of being materialized by a broadcast.
+      Type inputElementType = lhsType.getElementType();
+      if (isDense && !lhsZeroPoint &&
+          isa<FloatType, IntegerType>(inputElementType)) {
+        SmallVector<AffineExpr> lhsExpr, rhsExpr, outExpr;
+        SmallVector<Value> resultShape;
+        bool isBroadcast = false, isStaticBroadcast = true;
+        for (unsigned i = 0; i < batchRank && isStaticBroadcast; i++) {
+          AffineExpr dim = rewriter.getAffineDimExpr(i);
+          outExpr.push_back(dim);
+          // The dims of the operands that line up with batch dim `i` of the
+          // result, or -1 if they are missing.
+          int64_t lhsDim = int64_t(i) - (maxRank - lhsRank);
+          int64_t rhsDim = int64_t(i) - (maxRank - rhsRank);
+          int64_t lhsSize = lhsDim < 0 ? 1 : lhsShape[lhsDim];
+          int64_t rhsSize = rhsDim < 0 ? 1 : rhsShape[rhsDim];
+          bool lhsBroadcast = lhsSize == 1 && rhsSize != 1;
+          bool rhsBroadcast = rhsSize == 1 && lhsSize != 1;
+          if (!lhsBroadcast && !rhsBroadcast &&
+              (lhsSize != rhsSize || ShapedType::isDynamic(lhsSize))) {
+            isStaticBroadcast = false;
+            break;
+          }
+          isBroadcast |= lhsBroadcast || rhsBroadcast;
+          if (lhsDim >= 0) {
+            lhsExpr.push_back(lhsBroadcast ? rewriter.getAffineConstantExpr(0)
+                                           : dim);
+          }
+          if (rhsDim >= 0) {
+            rhsExpr.push_back(rhsBroadcast ? rewriter.getAffineConstantExpr(0)
+                                           : dim);
+          }
+          if (lhsDim < 0 || lhsBroadcast)
+            resultShape.push_back(getDimOp(rewriter, loc, rhs, rhsDim));
+          else
+            resultShape.push_back(getDimOp(rewriter, loc, lhs, lhsDim));
+        }
+        if (isBroadcast && isStaticBroadcast) {
+          Value lhsDim0 = getDimOp(rewriter, loc, lhs, lhsRank - 2);
+          Value lhsDim1 = getDimOp(rewriter, loc, lhs, lhsRank - 1);
+          Value rhsDim0 = getDimOp(rewriter, loc, rhs, rhsKDim);
+          Value rhsDim1 = getDimOp(rewriter, loc, rhs, rhsNDim);
+          checkDimEqualHelper(rewriter, loc, lhsDim1, rhsDim0);
+
+          AffineExpr m = rewriter.getAffineDimExpr(batchRank);
+          AffineExpr k = rewriter.getAffineDimExpr(batchRank + 1);
+          AffineExpr n = rewriter.getAffineDimExpr(batchRank + 2);
+          lhsExpr.append({m, k});
+          if (rhsTransposed)
+            rhsExpr.append({n, k});
+          else
+            rhsExpr.append({k, n});
+          outExpr.append({m, n});
+          resultShape.append({lhsDim0, rhsDim1});
+          Value zeroTensor =
+              createZeroInitTensor(rewriter, loc, resultShape, elementType);
+          SmallVector<utils::IteratorType> iteratorTypes(
+              batchRank, utils::IteratorType::parallel);
+          iteratorTypes.append({utils::IteratorType::parallel,
+                                utils::IteratorType::reduction,
+                                utils::IteratorType::parallel});
+          Value matmul =
+              linalg::GenericOp::create(
+                  rewriter, loc, zeroTensor.getType(),
+                  ValueRange{lhs, rhs}, zeroTensor,
+                  AffineMap::inferFromExprList({lhsExpr, rhsExpr, outExpr},
+                                               rewriter.getContext()),
+                  iteratorTypes,
+                  [&](OpBuilder &b, Location loc, ValueRange args) {
+                    Value l = convertScalarToDtype(b, loc, args[0],
+                                                   elementType,
+                                                   lhsTorchType.getDtype());
+                    Value r = convertScalarToDtype(b, loc, args[1],
+                                                   elementType,
+                                                   rhsTorchType.getDtype());
+                    Value sum;
+                    if (isa<FloatType>(elementType)) {
+                      Value mul = arith::MulFOp::create(b, loc, l, r);
+                      sum = arith::AddFOp::create(b, loc, mul, args[2]);
+                    } else {
+                      Value mul = arith::MulIOp::create(b, loc, l, r);
+                      sum = arith::AddIOp::create(b, loc, mul, args[2]);
+                    }
+                    linalg::YieldOp::create(b, loc, sum);
+                  })
+                  .getResult(0);
+          if (accumulatorDType != resultElementType) {
+            matmul = torch_to_linalg::convertTensorToElementType(
+                rewriter, loc, matmul, resultElementType);
+          }
+          rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType,
+                                                      matmul);
+          return success();
+        }
+      }
+
+      if (rhsTransposed) {
+        rhs = transposeValue(loc, rhs, {1, 0}, rewriter);
+        rhsType = cast<RankedTensorType>(rhs.getType());
+      }
+
       // The `broadcastedBatchShape` contains batch dimensions of the resultant
       // matrix.
       SmallVector<Value> broadcastedBatchShape(batchRank);
@@ -792,10 +1077,163 @@ bool isValueNegative(mlir::Value value) {
 }
 } // namespace
 
+namespace {
+// A phase of a transposed convolution along one spatial dim: the outputs
+// `outOffset + i * stride` for `i` in `[0, outSize)`, which read the kernel
+// taps `kernelOffset + j * stride` for `j` in `[0, kernelSize)` of the flipped
+// weight, over the input window `[inOffset, inOffset + inSize)`, padded by
+// `lowPad` and `highPad`.
+struct TransposedConvPhase {
+  int64_t outOffset, outSize;
+  int64_t kernelOffset, kernelSize;
+  int64_t inOffset, inSize, lowPad, highPad;
+};
+} // namespace
+
+// The phases of a transposed convolution along a spatial dim of input size
+// `in` and kernel size `kernel`, leaving out those no input contributes to.
+static SmallVector<TransposedConvPhase>
+getTransposedConvPhases(int64_t in, int64_t kernel, int64_t stride,
+                        int64_t padding, int64_t outputPadding) {
+  int64_t out = (in - 1) * stride - 2 * padding + kernel + outputPadding;
+  SmallVector<TransposedConvPhase> phases;
+  for (int64_t r = 0; r < stride && r < kernel; ++r) {
+    // The output `o` reads the taps `r + j * stride` of the unflipped kernel
+    // at the input `(o + padding - r) / stride - j`, if it is a multiple.
+    TransposedConvPhase phase;
+    phase.kernelSize = (kernel - r + stride - 1) / stride;
+    phase.kernelOffset = kernel - 1 - r - (phase.kernelSize - 1) * stride;
+    phase.outOffset = ((r - padding) % stride + stride) % stride;
+    if (phase.outOffset >= out)
+      continue;
+    phase.outSize = (out - phase.outOffset + stride - 1) / stride;
+    int64_t firstIn = (phase.outOffset + padding - r) / stride;
+    int64_t begin = firstIn - phase.kernelSize + 1;
+    int64_t end = firstIn + phase.outSize;
+    phase.inOffset = std::max<int64_t>(begin, 0);
+    phase.inSize = std::min(end, in) - phase.inOffset;
+    if (phase.inSize <= 0)
+      continue;
+    phase.lowPad = phase.inOffset - begin;
+    phase.highPad = end - phase.inOffset - phase.inSize;
+    phases.push_back(phase);
+  }
+  return phases;
+}
+
+// Computes the undilated transposed convolution of `input` with the flipped
+// weight `weight`, of layout `[F, C, K...]`, into `output` as one dense
+// convolution of stride 1 per phase of the output, i.e. per offset of the
+// outputs modulo the strides, instead of one convolution over the input
+// interleaved with zeros, where most products are with those zeros. Each
+// phase computes its outputs in a strided slice of `output`.
+static FailureOr<Value> createSubPixelTransposedConvolution(
+    OpBuilder &b, Operation *op, Value input, Value weight, Value output,
+    ArrayRef<int64_t> strides, ArrayRef<int64_t> padding,
+    ArrayRef<int64_t> outputPadding) {
+  Location loc = op->getLoc();
+  auto inputType = cast<RankedTensorType>(input.getType());
+  auto weightType = cast<RankedTensorType>(weight.getType());
+  ArrayRef<int64_t> inShape = inputType.getShape();
+  ArrayRef<int64_t> weightShape = weightType.getShape();
+  size_t numSpatialDims = inShape.size() - 2;
+  if (numSpatialDims < 1 || numSpatialDims > 3)
+    return failure();
+
+  SmallVector<SmallVector<TransposedConvPhase>> phases;
+  for (size_t i = 0; i < numSpatialDims; ++i) {
+    phases.push_back(getTransposedConvPhases(inShape[i + 2],
+                                             weightShape[i + 2], strides[i],
+                                             padding[i], outputPadding[i]));
+    // No input contributes to the output, which stays the bias.
+    if (phases.back().empty())
+      return output;
+  }
+
+  Type elementType = inputType.getElementType();
+  Value zero = arith::ConstantOp::create(b, loc, b.getZeroAttr(elementType));
+  auto getIndexAttrs = [&](ArrayRef<int64_t> ints) {
+    return llvm::to_vector(llvm::map_range(
+        ints, [&](int64_t i) -> OpFoldResult { return b.getIndexAttr(i); }));
+  };
+  auto unitStrides =
+      b.getI64VectorAttr(SmallVector<int64_t>(numSpatialDims, 1));
+  SmallVector<int64_t> outStrides{1, 1};
+  outStrides.append(strides.begin(), strides.end());
+
+  // Visit every combination of the phases along the spatial dims.
+  SmallVector<size_t> phaseIndices(numSpatialDims, 0);
+  while (true) {
+    SmallVector<int64_t> inOffsets{0, 0}, inSizes{inShape[0], inShape[1]};
+    SmallVector<int64_t> lowPads{0, 0}, highPads{0, 0};
+    SmallVector<int64_t> weightOffsets{0, 0};
+    SmallVector<int64_t> weightSizes{weightShape[0], weightShape[1]};
+    SmallVector<int64_t> outOffsets{0, 0}, outSizes{inShape[0], weightShape[0]};
+    for (size_t i = 0; i < numSpatialDims; ++i) {
+      const TransposedConvPhase &phase = phases[i][phaseIndices[i]];
+      inOffsets.push_back(phase.inOffset);
+      inSizes.push_back(phase.inSize);
+      lowPads.push_back(phase.lowPad);
+      highPads.push_back(phase.highPad);
+      weightOffsets.push_back(phase.kernelOffset);
+      weightSizes.push_back(phase.kernelSize);
+      outOffsets.push_back(phase.outOffset);
+      outSizes.push_back(phase.outSize);
+    }
+
+    Value window = tensor::ExtractSliceOp::create(
+        b, loc, input, getIndexAttrs(inOffsets), getIndexAttrs(inSizes),
+        getIndexAttrs(SmallVector<int64_t>(inShape.size(), 1)));
+    window = torch_to_linalg::getPaddedTensor(op, b, window, lowPads, highPads,
+                                              zero);
+    Value taps = tensor::ExtractSliceOp::create(
+        b, loc, weight, getIndexAttrs(weightOffsets),
+        getIndexAttrs(weightSizes), getIndexAttrs(outStrides));
+    Value init = tensor::ExtractSliceOp::create(
+        b, loc, output, getIndexAttrs(outOffsets), getIndexAttrs(outSizes),
+        getIndexAttrs(outStrides));
+    Value conv;
+    switch (numSpatialDims) {
+    case 1:
+      conv = linalg::Conv1DNcwFcwOp::create(b, loc, init.getType(),
+                                            ValueRange{window, taps}, init,
+                                            unitStrides, unitStrides)
+                 .getResult(0);
+      break;
+    case 2:
+      conv = linalg::Conv2DNchwFchwOp::create(b, loc, init.getType(),
+                                              ValueRange{window, taps}, init,
+                                              unitStrides, unitStrides)
+                 .getResult(0);
+      break;
+    default:
+      conv = linalg::Conv3DNcdhwFcdhwOp::create(b, loc, init.getType(),
+                                                ValueRange{window, taps}, init,
+                                                unitStrides, unitStrides)
+                 .getResult(0);
+      break;
+    }
+    output = tensor::InsertSliceOp::create(
+        b, loc, conv, output, getIndexAttrs(outOffsets),
+        getIndexAttrs(outSizes), getIndexAttrs(outStrides));
+
+    size_t dim = 0;
+    while (dim < numSpatialDims && ++phaseIndices[dim] == phases[dim].size())
+      phaseIndices[dim++] = 0;
+    if (dim == numSpatialDims)
+      break;
+  }
+  return output;
+}
+
 namespace {
 class ConvertAtenConvolutionOp : public OpConversionPattern<AtenConvolutionOp> {
 public:
-  using OpConversionPattern::OpConversionPattern;
+  ConvertAtenConvolutionOp(TypeConverter &typeConverter, MLIRContext *context,
+                           bool channelsLast, bool subPixelTransposed)
+      : OpConversionPattern(typeConverter, context),
+        channelsLast(channelsLast), subPixelTransposed(subPixelTransposed) {}
+
   LogicalResult
   matchAndRewrite(AtenConvolutionOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -840,6 +1278,25 @@ public:
       weightUnsigned = torch_to_linalg::isUnsignedTorchType(torchDtype);
     }
 
+    // A weight quantized per output channel accumulates like one with a zero
+    // point of 0; its scales are applied by the dequantize of the result.
+    auto perChannelWeight =
+        op.getWeight().getDefiningOp<Aten_MakePerChannelQuantizedTensorOp>();
+    if (perChannelWeight) {
+      FailureOr<Value> zp =
+          getI32ZeroPoint(rewriter, loc, typeConverter, op.getWeight());
+      if (failed(zp))
+        return rewriter.notifyMatchFailure(
+            op, "unsupported: per-channel zero points other than 0");
+      weightZp = *zp;
+      weight = perChannelWeight.getSelf();
+      weight = typeConverter->materializeTargetConversion(
+          rewriter, loc, typeConverter->convertType(weight.getType()), weight);
+      auto torchDtype =
+          cast<ValueTensorType>(perChannelWeight.getType()).getDtype();
+      weightUnsigned = torch_to_linalg::isUnsignedTorchType(torchDtype);
+    }
+
     if (static_cast<bool>(inputZp) != static_cast<bool>(weightZp)) {
       return rewriter.notifyMatchFailure(
           op, "lhs and rhs of convolution must either be both int or fp");
@@ -1044,6 +1501,20 @@ public:
                                            indices);
     };
 
+    // Undilated, strided transposed convolutions of static shapes may be
+    // emitted as one dense convolution per phase of the output.
+    SmallVector<int64_t> paddingInts, outputPaddingInts;
+    bool useSubPixel =
+        subPixelTransposed && transposed && numGroups == 1 && !inputZp &&
+        llvm::all_of(dilationInts, [](int64_t d) { return d == 1; }) &&
+        llvm::any_of(strideInts, [](int64_t s) { return s > 1; }) &&
+        cast<RankedTensorType>(input.getType()).hasStaticShape() &&
+        cast<RankedTensorType>(weight.getType()).hasStaticShape() &&
+        matchPattern(op.getPadding(), m_TorchListOfConstantInts(paddingInts)) &&
+        matchPattern(op.getOutputPadding(),
+                     m_TorchListOfConstantInts(outputPaddingInts));
+    SmallVector<int64_t> transposedStrideInts(strideInts);
+
     if (transposed) {
       bool isGroupedConv = numGroups > 1;
       weight = isGroupedConv ? expandWeight(weight) : weight;
@@ -1101,10 +1572,11 @@ public:
                    })
                    .getResult(0);
 
-      paddedInput = createTransposedInputPadding(
-          inBatch, inChannels, inDims, weightDims, paddingIntValues,
-          strideIntValues, dilationIntValues, outputPaddingIntValues, input,
-          inputDTy, pad, rewriter, loc, numSpatialDims, c0, c1);
+      if (!useSubPixel)
+        paddedInput = createTransposedInputPadding(
+            inBatch, inChannels, inDims, weightDims, paddingIntValues,
+            strideIntValues, dilationIntValues, outputPaddingIntValues, input,
+            inputDTy, pad, rewriter, loc, numSpatialDims, c0, c1);
 
       // Calculate output dims
       for (size_t i = 0; i < numSpatialDims; i++)
@@ -1128,6 +1600,18 @@ public:
             castIndexToInt(weightDims[i]), strideIntValues[i]));
     }
 
+    // Ungrouped, unquantized convolutions may be emitted in a channels-last
+    // layout, in which case the output is built with the channels innermost.
+    bool useChannelsLast =
+        channelsLast && numGroups == 1 && !inputZp && !useSubPixel;
+    SmallVector<int64_t> inPerms, weightPerms, outPerms;
+    if (useChannelsLast) {
+      getChannelsLastPermutations(numSpatialDims, inPerms, weightPerms,
+                                  outPerms);
+      outDims = applyPermutation(outDims, inPerms);
+    }
+    int64_t outChannelDim = useChannelsLast ? inRank - 1 : 1;
+
     Type accumulatorDType = getDefaultAccType(rewriter, inputDTy);
     Value initTensor = tensor::EmptyOp::create(
         rewriter, loc, getAsOpFoldResult(outDims), accumulatorDType);
@@ -1155,16 +1639,35 @@ public:
 
       auto resultRank = cast<RankedTensorType>(initTensor.getType()).getRank();
       SmallVector<int64_t, 4> addedDimensions;
-      // bias is used to initialize the channels - dimension 1 of
-      // output
+      // bias is used to initialize the channels dimension of output
       for (int i = 0; i < resultRank; ++i)
-        if (i != 1)
+        if (i != outChannelDim)
           addedDimensions.push_back(i);
       outputTensor = linalg::BroadcastOp::create(rewriter, loc, bias,
                                                  initTensor, addedDimensions)
                          ->getResult(0);
     }
 
+    Value conv;
+    if (useSubPixel) {
+      FailureOr<Value> result = createSubPixelTransposedConvolution(
+          rewriter, op, input, weight, outputTensor, transposedStrideInts,
+          paddingInts, outputPaddingInts);
+      if (failed(result))
+        return rewriter.notifyMatchFailure(
+            op, "unimplemented: only 1D, 2D, and 3D convolution supported");
+      conv = *result;
+      Type newResultType = getTypeConverter()->convertType(op.getType());
+      if (accumulatorDType != resultDTy) {
+        Type resultElementType =
+            cast<RankedTensorType>(newResultType).getElementType();
+        conv = torch_to_linalg::convertTensorToElementType(rewriter, loc, conv,
+                                                           resultElementType);
+      }
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, conv);
+      return success();
+    }
+
     auto stridesAttr = rewriter.getI64VectorAttr(strideInts);
     auto dilationAttr = rewriter.getI64VectorAttr(dilationInts);
 
@@ -1186,7 +1689,6 @@ public:
     SmallVector<Value> weightSliceSizes{weightStride, weightChannels};
     weightSliceSizes.append(weightDims);
 
-    Value conv;
     // the code so far is able to respect all numSpatialDims
     // the code below this point is numSpatialDims specific and numGroups
     // specific
@@ -1195,6 +1697,50 @@ public:
     // - grouped 1d-3d
     // - grouped 1d-3d (quantized)
     // - ungrouped 1d-3d
+    if (useChannelsLast) {
+      // The transposes of the input and weight are expected to cancel with
+      // those of neighbouring convolutions, or to fold into constants, in
+      // `torch-propagate-linalg-transposes`.
+      paddedInput = transposeValue(loc, paddedInput, inPerms, rewriter);
+      weight = transposeValue(loc, weight, weightPerms, rewriter);
+      switch (numSpatialDims) {
+      case 1:
+        conv = linalg::Conv1DNwcWcfOp::create(
+                   rewriter, loc, outputTensor.getType(),
+                   ValueRange{paddedInput, weight}, outputTensor, stridesAttr,
+                   dilationAttr)
+                   .getResult(0);
+        break;
+      case 2:
+        conv = linalg::Conv2DNhwcHwcfOp::create(
+                   rewriter, loc, outputTensor.getType(),
+                   ValueRange{paddedInput, weight}, outputTensor, stridesAttr,
+                   dilationAttr)
+                   .getResult(0);
+        break;
+      case 3:
+        conv = linalg::Conv3DNdhwcDhwcfOp::create(
+                   rewriter, loc, outputTensor.getType(),
+                   ValueRange{paddedInput, weight}, outputTensor, stridesAttr,
+                   dilationAttr)
+                   .getResult(0);
+        break;
+      default:
+        return rewriter.notifyMatchFailure(
+            op, "unimplemented: only 1D, 2D, and 3D convolution supported");
+      };
+      conv = transposeValue(loc, conv, outPerms, rewriter);
+      Type newResultType = getTypeConverter()->convertType(op.getType());
+      if (accumulatorDType != resultDTy) {
+        Type resultElementType =
+            cast<RankedTensorType>(newResultType).getElementType();
+        conv = torch_to_linalg::convertTensorToElementType(rewriter, loc, conv,
+                                                           resultElementType);
+      }
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, conv);
+      return success();
+    }
+
     if (numGroups == 1 && !inputZp) {
       switch (numSpatialDims) {
       case 1:
@@ -1559,6 +2105,11 @@ public:
     return success();
   }
 
+  static void getChannelsLastPermutations(size_t numSpatialDims,
+                                          SmallVectorImpl<int64_t> &inPerms,
+                                          SmallVectorImpl<int64_t> &weightPerms,
+                                          SmallVectorImpl<int64_t> &outPerms);
+
   static Value createTransposedInputPadding(
       Value inBatch, Value inChannels, SmallVector<Value> &inDims,
       SmallVector<Value> &weightDims, SmallVector<Value> &paddingIntValues,
@@ -1567,9 +2118,30 @@ public:
       SmallVector<Value> &outputPaddingIntValues, Value input, Type inputDTy,
       Value pad, PatternRewriter &rewriter, Location loc, size_t numSpatialDims,
       Value c0, Value c1);
+
+private:
+  bool channelsLast;
+  bool subPixelTransposed;
 };
 } // namespace
 
+// Computes the permutations taking NC[D]HW inputs and outputs to N[D]HWC and
+// FC[D]HW weights to [D]HWCF, and the one taking N[D]HWC results back.
+void ConvertAtenConvolutionOp::getChannelsLastPermutations(
+    size_t numSpatialDims, SmallVectorImpl<int64_t> &inPerms,
+    SmallVectorImpl<int64_t> &weightPerms, SmallVectorImpl<int64_t> &outPerms) {
+  inPerms.push_back(0);
+  for (size_t i = 0; i < numSpatialDims; ++i) {
+    inPerms.push_back(i + 2);
+    weightPerms.push_back(i + 2);
+  }
+  inPerms.push_back(1);
+  weightPerms.append({1, 0});
+  outPerms.append({0, static_cast<int64_t>(numSpatialDims) + 1});
+  for (size_t i = 0; i < numSpatialDims; ++i)
+    outPerms.push_back(i + 1);
+}
+
 /*
  * Calculates the dimensions and offsets needed to emulate a Transposed
  * Convolution (like PyTorch's ConvTranspose2d) using a standard
@@ -1717,7 +2289,9 @@ class ConvertAtenConvolutionBackwardOp
   using IT = utils::IteratorType;
 
 public:
-  using OpConversionPattern::OpConversionPattern;
+  ConvertAtenConvolutionBackwardOp(TypeConverter &typeConverter,
+                                   MLIRContext *context, bool useGemm)
+      : OpConversionPattern(typeConverter, context), useGemm(useGemm) {}
   LogicalResult
   matchAndRewrite(AtenConvolutionBackwardOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -1812,6 +2386,21 @@ public:
     paddingIntValues = getTypeConvertedValues(rewriter, loc, getTypeConverter(),
                                               paddingIntValues);
 
+    // Ungrouped convolutions of static shapes and constant paddings may have
+    // their weight gradient computed as a matmul, and, when undilated and
+    // strided, their input gradient one phase of the input at a time.
+    SmallVector<int64_t> paddingInts;
+    bool isGemmApplicable =
+        useGemm && !isGroupedConvBwd &&
+        cast<RankedTensorType>(gradOutput.getType()).hasStaticShape() &&
+        cast<RankedTensorType>(input.getType()).hasStaticShape() &&
+        cast<RankedTensorType>(weight.getType()).hasStaticShape() &&
+        matchPattern(op.getPadding(), m_TorchListOfConstantInts(paddingInts));
+    bool useSubPixel =
+        isGemmApplicable &&
+        llvm::all_of(dilationInts, [](int64_t d) { return d == 1; }) &&
+        llvm::any_of(strideInts, [](int64_t s) { return s > 1; });
+
     // The expandGroups lambda function below is used to expand the group
     // dimension for weights and input, output tensors.
     // For input tensor (dim = 1)      : N,C,H,W -> N,G,C/G,H,W
@@ -1949,7 +2538,11 @@ public:
       // zero-initialized tensor.
       SmallVector<Value> gradInputSizes = getTensorSizes(rewriter, loc, input);
       Value gradOutputModified;
-      if (llvm::any_of(strideInts, [](int64_t stride) { return stride > 1; })) {
+      if (useSubPixel) {
+        // The input gradient is the transposed convolution of `grad_output`,
+        // which the phases compute without scattering it.
+      } else if (llvm::any_of(strideInts,
+                              [](int64_t stride) { return stride > 1; })) {
         // Destination spatial sizes are computed as:
         //   size[i] = (D[i] - 1) + d[i] * (K[i] - 1) + 1
         // Offsets on spatial dims are paddings
@@ -2014,11 +2607,37 @@ public:
                                                   accumulatorDTy);
 
       // Create convolution for data gradient
-      auto convRes = createConvInputGradient(rewriter, loc, context,
-                                             isGroupedConvBwd, numSpatialDims,
-                                             dilationInts, gradOutputModified,
-                                             weightExpanded, gradInputInit)
-                         .getResult(0);
+      Value convRes;
+      if (useSubPixel) {
+        // The phases take the flipped weight as `[C, F, K...]`, and the output
+        // paddings the input positions that the floor of the forward output
+        // sizes left out.
+        ArrayRef<int64_t> inShape =
+            cast<RankedTensorType>(input.getType()).getShape();
+        ArrayRef<int64_t> goShape =
+            cast<RankedTensorType>(gradOutput.getType()).getShape();
+        SmallVector<int64_t> perms{1, 0}, outputPaddings;
+        for (size_t i = 0; i < numSpatialDims; ++i) {
+          perms.push_back(i + 2);
+          outputPaddings.push_back(inShape[i + 2] -
+                                   (goShape[i + 2] - 1) * strideInts[i] +
+                                   2 * paddingInts[i] - weightDimsInt[i + 2]);
+        }
+        FailureOr<Value> phases = createSubPixelTransposedConvolution(
+            rewriter, op, gradOutput,
+            transposeValue(loc, weightExpanded, perms, rewriter),
+            gradInputInit, strideInts, paddingInts, outputPaddings);
+        if (failed(phases))
+          return rewriter.notifyMatchFailure(
+              op, "unimplemented: only 1d-3d convolution bwd supported");
+        convRes = *phases;
+      } else {
+        convRes = createConvInputGradient(rewriter, loc, context,
+                                          isGroupedConvBwd, numSpatialDims,
+                                          dilationInts, gradOutputModified,
+                                          weightExpanded, gradInputInit)
+                      .getResult(0);
+      }
 
       auto returnTensorTy = cast<RankedTensorType>(
           getTypeConverter()->convertType(op->getResult(0).getType()));
@@ -2072,11 +2691,24 @@ public:
                                      accumulatorDTy);
 
       // Create convolution for weight gradient
-      auto convResult = createConvWeightGradient(
-                            rewriter, loc, context, isGroupedConvBwd,
-                            numSpatialDims, strideInts, dilationInts,
-                            paddedInput, gradOutputExpanded, gradWeightInit)
-                            .getResult(0);
+      Value convResult;
+      if (isGemmApplicable) {
+        SmallVector<int64_t> pads{0, 0};
+        pads.append(paddingInts);
+        Value staticPaddedInput = torch_to_linalg::getPaddedTensor(
+            op, rewriter, input, pads, pads, padVal);
+        ArrayRef<int64_t> weightShape =
+            cast<RankedTensorType>(weight.getType()).getShape();
+        convResult = createWeightGradientAsMatmul(
+            rewriter, loc, strideInts, dilationInts, weightShape.drop_front(2),
+            staticPaddedInput, gradOutput, accumulatorDTy);
+      } else {
+        convResult = createConvWeightGradient(
+                         rewriter, loc, context, isGroupedConvBwd,
+                         numSpatialDims, strideInts, dilationInts, paddedInput,
+                         gradOutputExpanded, gradWeightInit)
+                         .getResult(0);
+      }
 
       auto returnTensorTy = cast<RankedTensorType>(
           getTypeConverter()->convertType(op->getResult(1).getType()));
@@ -2329,6 +2961,87 @@ private:
           linalg::YieldOp::create(b, loc, sum);
         });
   }
+
+  // Computes the weight gradient of an ungrouped convolution of static shapes
+  // as a single matmul of `gradOutput`, as an `[F, N * O...]` matrix, with
+  // the im2col matrix of `paddedInput`, as a transposed `[C * K..., N * O...]`
+  // matrix, so that the batch and the output positions form its reduction.
+  static Value createWeightGradientAsMatmul(
+      PatternRewriter &b, Location loc, ArrayRef<int64_t> strideInts,
+      ArrayRef<int64_t> dilationInts, ArrayRef<int64_t> kernelSizes,
+      Value paddedInput, Value gradOutput, Type accType) {
+    MLIRContext *context = b.getContext();
+    auto inputType = cast<RankedTensorType>(paddedInput.getType());
+    ArrayRef<int64_t> goShape =
+        cast<RankedTensorType>(gradOutput.getType()).getShape();
+    int64_t numSpatialDims = kernelSizes.size();
+
+    // col[c, k..., n, o...] = x[n, c, s * o + d * k]
+    int64_t numDims = 2 + 2 * numSpatialDims;
+    SmallVector<AffineExpr> dims(numDims);
+    bindDimsList(context, MutableArrayRef{dims});
+    SmallVector<AffineExpr> inputExprs{dims[numSpatialDims + 1], dims[0]};
+    SmallVector<int64_t> colShape{inputType.getDimSize(1)};
+    colShape.append(kernelSizes.begin(), kernelSizes.end());
+    colShape.push_back(goShape[0]);
+    for (int64_t i = 0; i < numSpatialDims; ++i) {
+      inputExprs.push_back(strideInts[i] * dims[numSpatialDims + 2 + i] +
+                           dilationInts[i] * dims[1 + i]);
+      colShape.push_back(goShape[2 + i]);
+    }
+    SmallVector<AffineMap> indexingMaps{
+        AffineMap::get(numDims, 0, inputExprs, context),
+        AffineMap::getMultiDimIdentityMap(numDims, context)};
+    Value colInit =
+        tensor::EmptyOp::create(b, loc, colShape, inputType.getElementType());
+    Value col =
+        linalg::GenericOp::create(
+            b, loc, colInit.getType(), paddedInput, colInit, indexingMaps,
+            SmallVector<IT>(numDims, IT::parallel),
+            [&](OpBuilder &b, Location loc, ValueRange args) {
+              linalg::YieldOp::create(b, loc, args[0]);
+            })
+            .getResult(0);
+
+    SmallVector<ReassociationIndices> colIndices(2);
+    for (int64_t i = 0; i < numDims; ++i)
+      colIndices[i <= numSpatialDims ? 0 : 1].push_back(i);
+    col = tensor::CollapseShapeOp::create(b, loc, col, colIndices);
+
+    SmallVector<int64_t> perms{1, 0};
+    SmallVector<ReassociationIndices> goIndices{{0}, {1}};
+    for (int64_t i = 0; i < numSpatialDims; ++i) {
+      perms.push_back(i + 2);
+      goIndices[1].push_back(i + 2);
+    }
+    Value lhs = transposeValue(loc, gradOutput, perms, b);
+    lhs = tensor::CollapseShapeOp::create(b, loc, lhs, goIndices);
+
+    auto lhsType = cast<RankedTensorType>(lhs.getType());
+    auto colType = cast<RankedTensorType>(col.getType());
+    SmallVector<int64_t> gemmShape{lhsType.getDimSize(0),
+                                   colType.getDimSize(0)};
+    Value empty = tensor::EmptyOp::create(b, loc, gemmShape, accType);
+    Value zero = arith::ConstantOp::create(b, loc, b.getZeroAttr(accType));
+    Value init = linalg::FillOp::create(b, loc, zero, empty).getResult(0);
+    auto matmul =
+        linalg::MatmulOp::create(b, loc, init.getType(), ValueRange{lhs, col},
+                                 init);
+    setTransposedIndexingMaps(matmul, /*lhsTransposed=*/false,
+                              /*rhsTransposed=*/true, b);
+
+    SmallVector<int64_t> gradWeightShape{lhsType.getDimSize(0),
+                                         inputType.getDimSize(1)};
+    gradWeightShape.append(kernelSizes.begin(), kernelSizes.end());
+    SmallVector<ReassociationIndices> gradWeightIndices{{0}, {}};
+    for (int64_t i = 0; i <= numSpatialDims; ++i)
+      gradWeightIndices[1].push_back(i + 1);
+    return tensor::ExpandShapeOp::create(
+        b, loc, RankedTensorType::get(gradWeightShape, accType),
+        matmul.getResult(0), gradWeightIndices);
+  }
+
+  bool useGemm;
 };
 } // namespace
 
@@ -2612,10 +3325,13 @@ public:
 
 void mlir::torch::torch_to_linalg::populateLinearPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
-    ConversionTarget &target) {
+    ConversionTarget &target, bool channelsLastConv,
+    bool subPixelConvTranspose, bool convBackwardGemm,
+    bool transposedMatmulOperands) {
   MLIRContext *context = patterns.getContext();
   target.addIllegalOp<AtenMmOp>();
-  patterns.add<ConvertAtenMmOp>(typeConverter, context);
+  patterns.add<ConvertAtenMmOp>(typeConverter, context,
+                                transposedMatmulOperands);
   target.addIllegalOp<AtenFlipOp>();
   patterns.add<ConvertAtenFlipOp>(typeConverter, context);
   target.addIllegalOp<AtenMatmulOp>();
@@ -2623,9 +3339,12 @@ void mlir::torch::torch_to_linalg::populateLinearPatternsAndLegality(
   target.addIllegalOp<AtenBmmOp>();
   patterns.add<ConvertAtenBmmOp>(typeConverter, context);
   target.addIllegalOp<AtenConvolutionOp>();
-  patterns.add<ConvertAtenConvolutionOp>(typeConverter, context);
+  patterns.add<ConvertAtenConvolutionOp>(typeConverter, context,
+                                         channelsLastConv,
+                                         subPixelConvTranspose);
   target.addIllegalOp<AtenConvolutionBackwardOp>();
-  patterns.add<ConvertAtenConvolutionBackwardOp>(typeConverter, context);
+  patterns.add<ConvertAtenConvolutionBackwardOp>(typeConverter, context,
+                                                 convBackwardGemm);
   target.addIllegalOp<AtenFftRfftOp>();
   patterns.add<ConvertAtenFftRfftOp>(typeConverter, context);
   target.addIllegalOp<AtenOuterOp>();
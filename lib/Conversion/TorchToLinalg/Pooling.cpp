@@ -145,8 +145,27 @@ static Value padInputTensor(Operation *op, ConversionPatternRewriter &rewriter,
                                           highPaddingIncludingNC, initValue);
 }
 
+// Returns the static kernel sizes of `op` when, with `separablePooling`
+// enabled, it should be pooled one spatial dim at a time, or an empty vector.
+// That is only valid for undilated windows and only pays off for windows that
+// are longer than 1 in several dims.
+template <typename OpTy>
+static SmallVector<int64_t>
+getSeparableKernelSizes(OpTy op, bool separablePooling,
+                        ArrayRef<int64_t> dilationInts) {
+  SmallVector<int64_t> kernelSizeInts;
+  if (!separablePooling ||
+      !llvm::all_of(dilationInts, [](int64_t d) { return d == 1; }) ||
+      !matchPattern(op.getKernelSize(),
+                    m_TorchListOfConstantInts(kernelSizeInts)) ||
+      llvm::count_if(kernelSizeInts, [](int64_t k) { return k > 1; }) < 2)
+    return {};
+  return kernelSizeInts;
+}
+
 // Creates a pooling operation based on the type specified by `OpTy` and
-// arguments passed.
+// arguments passed. When `separableKernelSizes` is not empty, the window is
+// pooled as a sequence of 1-D windows of these sizes instead.
 template <typename OpTy>
 static LogicalResult createPoolingOp(
     Operation *op, ConversionPatternRewriter &rewriter, Value self,
@@ -154,7 +173,8 @@ static LogicalResult createPoolingOp(
     SmallVectorImpl<Value> &kernelSizeIntValues,
     SmallVectorImpl<int64_t> &strideInts, SmallVectorImpl<int64_t> &paddingInts,
     SmallVectorImpl<int64_t> &dilationInts, Attribute initValueAttr,
-    SmallVectorImpl<Value> &outTensorShape, Value &paddedInput, Value &result) {
+    SmallVectorImpl<Value> &outTensorShape, Value &paddedInput, Value &result,
+    ArrayRef<int64_t> separableKernelSizes = {}) {
   Location loc = op->getLoc();
   Type elementType = cast<RankedTensorType>(self.getType()).getElementType();
   if (!isa<mlir::FloatType>(elementType) && !supportNonFPInput)
@@ -172,10 +192,6 @@ static LogicalResult createPoolingOp(
 
   auto stridesAttr = rewriter.getI64VectorAttr(strideInts);
   auto dilationAttr = rewriter.getI64VectorAttr(dilationInts);
-  auto shape = castIntVectorToIndexVector(rewriter, loc, kernelSizeIntValues);
-  Value windowTensor = tensor::EmptyOp::create(
-      rewriter, loc, getAsOpFoldResult(shape), elementType);
-
   Value permutedInput = paddedInput, permutedOutput = outTensorInitialized;
   if (dimensionality == 3) {
     // Permute input and output tensor as follows:
@@ -194,10 +210,51 @@ static LogicalResult createPoolingOp(
           op, "failed to perform permutation of tensor");
   }
 
-  Value poolingResult = OpTy::create(rewriter, loc, permutedOutput.getType(),
-                                     ValueRange{permutedInput, windowTensor},
-                                     permutedOutput, stridesAttr, dilationAttr)
-                            .getResult(0);
+  Value poolingResult;
+  if (separableKernelSizes.empty()) {
+    auto shape = castIntVectorToIndexVector(rewriter, loc, kernelSizeIntValues);
+    Value windowTensor = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(shape), elementType);
+    poolingResult = OpTy::create(rewriter, loc, permutedOutput.getType(),
+                                 ValueRange{permutedInput, windowTensor},
+                                 permutedOutput, stridesAttr, dilationAttr)
+                        .getResult(0);
+  } else {
+    // The max or sum over a window is the max or sum over its rows of the max
+    // or sum over each row, so the window is pooled one spatial dim at a time,
+    // innermost first, for O(K1 + ... + Kn) rather than O(K1 * ... * Kn) work
+    // per output. Dims with a unit window and stride are left alone.
+    int64_t firstSpatialDim = dimensionality == 3 ? 1 : 2;
+    SmallVector<int64_t> dimsToPool;
+    for (int64_t i = dimensionality - 1; i >= 0; --i) {
+      if (separableKernelSizes[i] != 1 || strideInts[i] != 1)
+        dimsToPool.push_back(i);
+    }
+    poolingResult = permutedInput;
+    for (int64_t i : dimsToPool) {
+      Value init = permutedOutput;
+      if (i != dimsToPool.back()) {
+        SmallVector<Value> sizes;
+        for (int64_t d = 0; d < dimensionality + 2; ++d) {
+          Value source =
+              d == firstSpatialDim + i ? permutedOutput : poolingResult;
+          sizes.push_back(getDimOp(rewriter, loc, source, d));
+        }
+        init = createInitTensor(rewriter, loc, sizes, elementType, initValue);
+      }
+      SmallVector<int64_t> windowShape(dimensionality, 1);
+      windowShape[i] = separableKernelSizes[i];
+      SmallVector<int64_t> windowStrides(dimensionality, 1);
+      windowStrides[i] = strideInts[i];
+      Value window =
+          tensor::EmptyOp::create(rewriter, loc, windowShape, elementType);
+      poolingResult =
+          OpTy::create(rewriter, loc, init.getType(),
+                       ValueRange{poolingResult, window}, init,
+                       rewriter.getI64VectorAttr(windowStrides), dilationAttr)
+              .getResult(0);
+    }
+  }
 
   result = poolingResult;
   if (dimensionality == 3) {
@@ -421,9 +478,9 @@ class ConvertAtenMaxPoolOp : public OpConversionPattern<OpTy> {
 
 public:
   ConvertAtenMaxPoolOp(TypeConverter &typeConverter, MLIRContext *context,
-                       bool allowNonFinites)
+                       bool allowNonFinites, bool separablePooling)
       : OpConversionPattern<OpTy>(typeConverter, context),
-        allowNonFinites(allowNonFinites) {}
+        allowNonFinites(allowNonFinites), separablePooling(separablePooling) {}
 
 private:
   static const bool withIndices =
@@ -433,6 +490,7 @@ private:
 
   static const int64_t Dim = DimensionTraits<OpTy>::Dim;
   bool allowNonFinites;
+  bool separablePooling;
 
   LogicalResult createPoolingMax3D(OpTy &op, typename OpTy::Adaptor adaptor,
                                    ConversionPatternRewriter &rewriter,
@@ -525,10 +583,9 @@ private:
     return success();
   }
 
-  // Returns the corresponding indices of the input tensor for the max pooling
-  // result tensor.
-  //
-  // For finding the indices, we follow the below method:
+  // Computes the max pooling result and the corresponding indices of the
+  // input tensor in a single pass over the input, with one linalg.generic
+  // that carries both the running max and its index.
   //
   // Take maxpool2d as an example to illustrate. Let's say the input tensor is a
   // 4-d tensor. The maxpool2d and indices will also be a 4-d tensor. Then:
@@ -539,26 +596,40 @@ private:
   //                 for p in range(kH):
   //                     for r in range(kW):
   //                         indexH = m * stride[0] + p * dilation[0]
-  //                         indexW = n * stride[0] + r * dilation[0]
-  //                         if paddedInput[i, j, indexH, indexW] ==
-  //                            maxPool2d[i, j, m, n]:
+  //                         indexW = n * stride[1] + r * dilation[1]
+  //                         val = paddedInput[i, j, indexH, indexW]
+  //                         if val > maxPool2d[i, j, m, n] or isnan(val) or
+  //                            indices[i, j, m, n] == -1 and
+  //                            val == maxPool2d[i, j, m, n]:
+  //                              maxPool2d[i, j, m, n] = val
   //                              indices[i, j, m, n] =
   //                                (indexH - padding[0]) * W +
   //                                (indexW - padding[1])
   //
-  LogicalResult
-  computeMaxPoolingIndices(Value maxPool, Value paddedInput, OpTy &op,
-                           typename OpTy::Adaptor adaptor,
-                           ConversionPatternRewriter &rewriter,
-                           SmallVectorImpl<Value> &outTensorShape,
-                           SmallVectorImpl<Value> &kernelSizeIntValues,
-                           SmallVectorImpl<int64_t> &strideInts,
-                           SmallVectorImpl<int64_t> &paddingInts,
-                           SmallVectorImpl<int64_t> &dilationInts, int64_t rank,
-                           Value &indicesResult) const {
+  // As in PyTorch, the first max of a window wins, except that a NaN replaces
+  // any max.
+  LogicalResult createMaxPoolingWithIndices(
+      OpTy &op, typename OpTy::Adaptor adaptor,
+      ConversionPatternRewriter &rewriter, bool ceilMode,
+      SmallVectorImpl<Value> &kernelSizeIntValues,
+      SmallVectorImpl<int64_t> &strideInts,
+      SmallVectorImpl<int64_t> &paddingInts,
+      SmallVectorImpl<int64_t> &dilationInts, TypedAttr smallestValueAttr,
+      int64_t rank, Value &maxPool, Value &indicesResult) const {
     Location loc = op->getLoc();
+    Value self = adaptor.getSelf();
+    Type elementType = cast<RankedTensorType>(self.getType()).getElementType();
     RankedTensorType indicesRankedTensorType = cast<RankedTensorType>(
         this->getTypeConverter()->convertType(op->getResult(1).getType()));
+
+    Value initValue =
+        arith::ConstantOp::create(rewriter, loc, smallestValueAttr);
+    Value paddedInput = padInputTensor(op, rewriter, self, ceilMode, Dim,
+                                       strideInts, paddingInts, initValue);
+    SmallVector<Value> outTensorShape;
+    Value maxPoolTensor = computeOutputTensor(
+        op, rewriter, self, Dim, ceilMode, strideInts, paddingInts,
+        dilationInts, kernelSizeIntValues, outTensorShape, initValue);
     Value cstMinusOne = arith::ConstantOp::create(
         rewriter, loc, rewriter.getI64IntegerAttr(-1));
     Value indicesTensor =
@@ -573,25 +644,25 @@ private:
         getAsConstantIndexValues(rewriter, loc, dilationInts);
     SmallVector<Value> kernelStride =
         getAsConstantIndexValues(rewriter, loc, strideInts);
+    Value windowTensor = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(kernelSize), elementType);
 
-    Value windowTensor =
-        tensor::EmptyOp::create(rewriter, loc, getAsOpFoldResult(kernelSize),
-                                indicesRankedTensorType.getElementType());
-
+    // If computing maxpool2d, we have six dimensions here. Each corresponding
+    // to N, C, Hout, Wout, kH, and kW, respectively, as described in the
+    // algorithm above.
     SmallVector<AffineExpr> inputExprs, outputExprs, kernelExprs;
-    for (unsigned i = 0; i < rank; i++) {
-      inputExprs.push_back(rewriter.getAffineDimExpr(i));
+    for (unsigned i = 0; i < rank; i++)
       outputExprs.push_back(rewriter.getAffineDimExpr(i));
-    }
+    inputExprs.append({outputExprs[0], outputExprs[1]});
     for (unsigned i = 0; i < rank - 2; i++) {
-      kernelExprs.push_back(rewriter.getAffineDimExpr(i + rank));
+      AffineExpr kernelExpr = rewriter.getAffineDimExpr(i + rank);
+      kernelExprs.push_back(kernelExpr);
+      inputExprs.push_back(outputExprs[i + 2] * strideInts[i] +
+                           kernelExpr * dilationInts[i]);
     }
-
-    // If computing indices for maxpool2d, we have six dimensions here. Each
-    // corresponding to N, C, Hout, Wout, kH, and kW, respectively, as described
-    // in the algorithm above.
     SmallVector<AffineMap> indexingMaps = AffineMap::inferFromExprList(
-        {inputExprs, kernelExprs, outputExprs}, rewriter.getContext());
+        {inputExprs, kernelExprs, outputExprs, outputExprs},
+        rewriter.getContext());
     SmallVector<utils::IteratorType> iteratorTypes(
         rank, utils::IteratorType::parallel);
     iteratorTypes.append(rank - 2, utils::IteratorType::reduction);
@@ -603,60 +674,71 @@ private:
           getDimOp(rewriter, loc, adaptor.getSelf(), i + 2));
     }
 
-    indicesResult =
-        linalg::GenericOp::create(
-            rewriter, loc, /*resultTensorTypes=*/indicesTensor.getType(),
-            /*inputs=*/ValueRange({maxPool, windowTensor}),
-            /*outputs=*/indicesTensor,
-            /*indexingMaps=*/indexingMaps,
-            /*iteratorTypes=*/iteratorTypes,
-            [&](OpBuilder &b, Location loc, ValueRange args) {
-              Value maxVal = args[0], res = args[2];
-
-              SmallVector<Value> inputDims;
-              inputDims.append({linalg::IndexOp::create(b, loc, 0),
-                                linalg::IndexOp::create(b, loc, 1)});
-              for (unsigned i = 2; i < rank; i++) {
-                Value mainIndex = linalg::IndexOp::create(b, loc, i);
-                Value subIndex = linalg::IndexOp::create(b, loc, i + rank - 2);
-                Value origin = arith::MulIOp::create(b, loc, mainIndex,
-                                                     kernelStride[i - 2]);
-                Value offset =
-                    arith::MulIOp::create(b, loc, subIndex, dilation[i - 2]);
-                inputDims.push_back(
-                    arith::AddIOp::create(b, loc, origin, offset));
-              }
-
-              Value input =
-                  tensor::ExtractOp::create(b, loc, paddedInput, inputDims);
-              Value pred = arith::CmpFOp::create(
-                  b, loc, arith::CmpFPredicate::OEQ, input, maxVal);
-
-              Value outIndex =
-                  arith::ConstantOp::create(b, loc, b.getIndexAttr(0));
-              Value curInputStride =
-                  arith::ConstantOp::create(b, loc, b.getIndexAttr(1));
-              for (unsigned i = 0; i < rank - 2; i++) {
-                Value minusPadding = arith::SubIOp::create(
-                    b, loc, inputDims[rank - 1 - i], padding[rank - 3 - i]);
-                Value timesStride =
-                    arith::MulIOp::create(b, loc, minusPadding, curInputStride);
-                outIndex = arith::AddIOp::create(b, loc, outIndex, timesStride);
-                curInputStride = arith::MulIOp::create(
-                    b, loc, curInputStride, inputSubShape[rank - 3 - i]);
-              }
-              Value result = arith::SelectOp::create(
-                  b, loc, pred, castIndexToInt64(b, loc, outIndex), res);
-
-              Value predInvalidIndex = arith::CmpIOp::create(
-                  b, loc, arith::CmpIPredicate::eq, res, cstMinusOne);
-              Value out = arith::SelectOp::create(b, loc, predInvalidIndex,
-                                                  result, res);
+    auto maxPoolOp = linalg::GenericOp::create(
+        rewriter, loc,
+        /*resultTensorTypes=*/
+        TypeRange({maxPoolTensor.getType(), indicesTensor.getType()}),
+        /*inputs=*/ValueRange({paddedInput, windowTensor}),
+        /*outputs=*/ValueRange({maxPoolTensor, indicesTensor}),
+        /*indexingMaps=*/indexingMaps,
+        /*iteratorTypes=*/iteratorTypes,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value input = args[0], maxVal = args[2], res = args[3];
+
+          Value noIndexYet = arith::CmpIOp::create(
+              b, loc, arith::CmpIPredicate::eq, res, cstMinusOne);
+          Value isGreater, isFirstEqual;
+          if (isa<mlir::FloatType>(elementType)) {
+            Value isNaN = arith::CmpFOp::create(
+                b, loc, arith::CmpFPredicate::UNO, input, input);
+            isGreater = arith::OrIOp::create(
+                b, loc,
+                arith::CmpFOp::create(b, loc, arith::CmpFPredicate::OGT, input,
+                                      maxVal),
+                isNaN);
+            isFirstEqual = arith::CmpFOp::create(
+                b, loc, arith::CmpFPredicate::OEQ, input, maxVal);
+          } else {
+            auto predicate = elementType.isUnsignedInteger()
+                                 ? arith::CmpIPredicate::ugt
+                                 : arith::CmpIPredicate::sgt;
+            isGreater = arith::CmpIOp::create(b, loc, predicate, input, maxVal);
+            isFirstEqual = arith::CmpIOp::create(
+                b, loc, arith::CmpIPredicate::eq, input, maxVal);
+          }
+          isFirstEqual =
+              arith::AndIOp::create(b, loc, isFirstEqual, noIndexYet);
+          Value pred = arith::OrIOp::create(b, loc, isGreater, isFirstEqual);
+
+          Value outIndex = arith::ConstantOp::create(b, loc, b.getIndexAttr(0));
+          Value curInputStride =
+              arith::ConstantOp::create(b, loc, b.getIndexAttr(1));
+          for (unsigned i = 0; i < rank - 2; i++) {
+            unsigned dim = rank - 3 - i;
+            Value mainIndex = linalg::IndexOp::create(b, loc, dim + 2);
+            Value subIndex = linalg::IndexOp::create(b, loc, dim + rank);
+            Value origin =
+                arith::MulIOp::create(b, loc, mainIndex, kernelStride[dim]);
+            Value offset =
+                arith::MulIOp::create(b, loc, subIndex, dilation[dim]);
+            Value inputDim = arith::AddIOp::create(b, loc, origin, offset);
+            Value minusPadding =
+                arith::SubIOp::create(b, loc, inputDim, padding[dim]);
+            Value timesStride =
+                arith::MulIOp::create(b, loc, minusPadding, curInputStride);
+            outIndex = arith::AddIOp::create(b, loc, outIndex, timesStride);
+            curInputStride = arith::MulIOp::create(b, loc, curInputStride,
+                                                   inputSubShape[dim]);
+          }
 
-              linalg::YieldOp::create(b, loc, out);
-            })
-            .getResult(0);
+          Value newMax = arith::SelectOp::create(b, loc, pred, input, maxVal);
+          Value newIndex = arith::SelectOp::create(
+              b, loc, pred, castIndexToInt64(b, loc, outIndex), res);
+          linalg::YieldOp::create(b, loc, ValueRange({newMax, newIndex}));
+        });
 
+    maxPool = maxPoolOp.getResult(0);
+    indicesResult = maxPoolOp.getResult(1);
     return success();
   }
 
@@ -706,11 +788,29 @@ public:
     if (!smallestValueAttr)
       return rewriter.notifyMatchFailure(op, "invalid element type");
 
+    Type maxPoolResultType =
+        typeConverter->convertType(op->getResult(0).getType());
+    if constexpr (withIndices) {
+      Value maxPool, indicesResult;
+      if (failed(createMaxPoolingWithIndices(
+              op, adaptor, rewriter, ceilMode, kernelSizeIntValues, strideInts,
+              paddingInts, dilationInts, smallestValueAttr, selfRank, maxPool,
+              indicesResult)))
+        return rewriter.notifyMatchFailure(op,
+                                           "unable to compute maxpool indices");
+      Type indicesResultType =
+          typeConverter->convertType(op->getResult(1).getType());
+      Value outMaxPool = tensor::CastOp::create(rewriter, op->getLoc(),
+                                                maxPoolResultType, maxPool);
+      Value outIndices = tensor::CastOp::create(
+          rewriter, op->getLoc(), indicesResultType, indicesResult);
+      rewriter.replaceOp(op, {outMaxPool, outIndices});
+      return success();
+    }
+
     // `maxPool` contains the result of maxpool 1d/2d/3d operation over the
     // input, `paddedInput` means the padded result of input tensor.
     Value maxPool, paddedInput;
-    Type maxPoolResultType =
-        typeConverter->convertType(op->getResult(0).getType());
     SmallVector<Value, 5> outTensorShape;
     if constexpr (Dim == 1) {
       if (failed(createPoolingOp<linalg::PoolingNcwMaxOp>(
@@ -724,7 +824,8 @@ public:
               op, rewriter, self, /*supportNonFPInput=*/true, ceilMode,
               /*dimensionality=*/2, kernelSizeIntValues, strideInts,
               paddingInts, dilationInts, smallestValueAttr, outTensorShape,
-              paddedInput, maxPool)))
+              paddedInput, maxPool,
+              getSeparableKernelSizes(op, separablePooling, dilationInts))))
         return rewriter.notifyMatchFailure(op, "unable to compute maxpool2d");
     } else {
       if (failed(createPoolingMax3D(op, adaptor, rewriter, kernelSizeIntValues,
@@ -734,25 +835,8 @@ public:
         return rewriter.notifyMatchFailure(op, "unable to compute maxpool3d");
     }
 
-    Value outMaxPool = tensor::CastOp::create(rewriter, op->getLoc(),
-                                              maxPoolResultType, maxPool);
-    SmallVector<Value> outResult({outMaxPool});
-    if (withIndices) {
-      Value indicesResult;
-      if (failed(computeMaxPoolingIndices(
-              maxPool, paddedInput, op, adaptor, rewriter, outTensorShape,
-              kernelSizeIntValues, strideInts, paddingInts, dilationInts,
-              selfRank, indicesResult)))
-        return rewriter.notifyMatchFailure(op,
-                                           "unable to compute maxpool indices");
-      Type indicesResultType =
-          typeConverter->convertType(op->getResult(1).getType());
-      Value outIndices = tensor::CastOp::create(
-          rewriter, op->getLoc(), indicesResultType, indicesResult);
-      outResult.push_back(outIndices);
-    }
-    rewriter.replaceOp(op, outResult);
-
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, maxPoolResultType,
+                                                maxPool);
     return success();
   }
 };
@@ -1086,7 +1170,10 @@ namespace {
 template <typename OpTy, typename PoolingOpTy, int Dim>
 class ConvertAtenAvgPoolOp : public OpConversionPattern<OpTy> {
 public:
-  using OpConversionPattern<OpTy>::OpConversionPattern;
+  ConvertAtenAvgPoolOp(TypeConverter &typeConverter, MLIRContext *context,
+                       bool separablePooling)
+      : OpConversionPattern<OpTy>(typeConverter, context),
+        separablePooling(separablePooling) {}
 
   LogicalResult
   matchAndRewrite(OpTy op, typename OpTy::Adaptor adaptor,
@@ -1125,6 +1212,9 @@ public:
       SmallVectorImpl<Value> &kernelDimSizes,
       SmallVector<AffineMap> &indexingMapsAvg,
       SmallVector<utils::IteratorType> &iteratorTypesAvg);
+
+private:
+  bool separablePooling;
 };
 } // namespace
 
@@ -1175,7 +1265,8 @@ LogicalResult ConvertAtenAvgPoolOp<OpTy, PoolingOpTy, Dim>::matchAndRewrite(
           op, rewriter, self, /*supportNonFPInput=*/true, ceilMode,
           /*dimensionality=*/Dim, kernelSizeIntValues, strideInts, paddingInts,
           dilationInts, rewriter.getZeroAttr(inputElementType), outTensorShape,
-          paddedInput, sumPool)))
+          paddedInput, sumPool,
+          getSeparableKernelSizes(op, separablePooling, dilationInts))))
     return rewriter.notifyMatchFailure(op, "unable to compute sumpool");
 
   // Compute the average of sumPool.
@@ -1610,13 +1701,147 @@ class ConvertAtenAdaptivePoolOp : public OpConversionPattern<OpTy> {
 
 public:
   ConvertAtenAdaptivePoolOp(TypeConverter &typeConverter, MLIRContext *context,
-                            bool allowNonFinites)
+                            bool allowNonFinites, bool separablePooling)
       : OpConversionPattern<OpTy>(typeConverter, context),
-        allowNonFinites(allowNonFinites) {}
+        allowNonFinites(allowNonFinites), separablePooling(separablePooling) {}
 
 private:
   static const int64_t Dim = AdaptivePoolingOpTraits<OpTy>::Dim;
+  static constexpr bool isAvgPool = std::is_same_v<
+      typename AdaptivePoolingOpTraits<OpTy>::AdaptivePoolingHelper,
+      AdaptiveAvgPoolingHelper<OpTy>>;
   bool allowNonFinites;
+  bool separablePooling;
+
+  // Returns the bounds [start, end) of the adaptive window `o` of a spatial
+  // dim of size `inSize` pooled to `outSize`.
+  static std::pair<Value, Value> getAdaptiveWindow(OpBuilder &b, Location loc,
+                                                   Value o, Value inSize,
+                                                   Value outSize) {
+    Value one = arith::ConstantIndexOp::create(b, loc, 1);
+    Value oTimesIn = arith::MulIOp::create(b, loc, o, inSize);
+    Value start = arith::FloorDivSIOp::create(b, loc, oTimesIn, outSize);
+    Value nextStart = arith::AddIOp::create(b, loc, oTimesIn, inSize);
+    Value lastInWindow = arith::FloorDivSIOp::create(
+        b, loc, arith::SubIOp::create(b, loc, nextStart, one), outSize);
+    Value end = arith::AddIOp::create(b, loc, lastInWindow, one);
+    return {start, end};
+  }
+
+  // Sums `input` over the `outputSize` adaptive windows along `dim`.
+  static Value createAdaptiveSum(ConversionPatternRewriter &rewriter,
+                                 Location loc, Value input, int64_t dim,
+                                 Value outputSize) {
+    auto inputType = cast<RankedTensorType>(input.getType());
+    Type elementType = inputType.getElementType();
+    int64_t rank = inputType.getRank();
+    Value one = arith::ConstantIndexOp::create(rewriter, loc, 1);
+    Value zero = arith::ConstantOp::create(
+        rewriter, loc, elementType, rewriter.getFloatAttr(elementType, 0));
+
+    // No window is longer than 1 + ceildiv(inputSize - 1, outputSize).
+    Value inputSize = getDimOp(rewriter, loc, input, dim);
+    Value lastIndex = arith::SubIOp::create(rewriter, loc, inputSize, one);
+    Value maxWindowMinusOne =
+        arith::CeilDivSIOp::create(rewriter, loc, lastIndex, outputSize);
+    Value maxWindow =
+        arith::AddIOp::create(rewriter, loc, maxWindowMinusOne, one);
+    Value window = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(maxWindow), rewriter.getI1Type());
+
+    SmallVector<Value> outputSizes;
+    for (int64_t i = 0; i < rank; ++i) {
+      outputSizes.push_back(i == dim ? outputSize
+                                     : getDimOp(rewriter, loc, input, i));
+    }
+    Value init =
+        createInitTensor(rewriter, loc, outputSizes, elementType, zero);
+
+    // (d0, ..., dn, k) -> (k) for the window, and -> (d0, ..., dn) for the
+    // output, with k iterating over the taps of the window.
+    MLIRContext *context = rewriter.getContext();
+    SmallVector<AffineMap> indexingMaps = {
+        AffineMap::get(rank + 1, 0, rewriter.getAffineDimExpr(rank), context),
+        AffineMap::getMultiDimIdentityMap(rank + 1, context)
+            .getMajorSubMap(rank)};
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::parallel);
+    iteratorTypes.push_back(utils::IteratorType::reduction);
+    auto sum = linalg::GenericOp::create(
+        rewriter, loc, init.getType(), window, init, indexingMaps,
+        iteratorTypes, [&](OpBuilder &b, Location loc, ValueRange args) {
+          SmallVector<Value> indices;
+          for (int64_t i = 0; i < rank; ++i)
+            indices.push_back(linalg::IndexOp::create(b, loc, i));
+          Value k = linalg::IndexOp::create(b, loc, rank);
+          auto [start, end] =
+              getAdaptiveWindow(b, loc, indices[dim], inputSize, outputSize);
+          // Taps past the end of a shorter window are clamped to the last
+          // element of the input, so that they never read out of bounds, and
+          // then masked.
+          Value index = arith::AddIOp::create(b, loc, start, k);
+          Value inWindow = arith::CmpIOp::create(
+              b, loc, arith::CmpIPredicate::slt, index, end);
+          indices[dim] = arith::MinSIOp::create(b, loc, index, lastIndex);
+          Value element = tensor::ExtractOp::create(b, loc, input, indices);
+          element = arith::SelectOp::create(b, loc, inWindow, element, zero);
+          Value result = arith::AddFOp::create(b, loc, args[1], element);
+          linalg::YieldOp::create(b, loc, result);
+        });
+    return sum.getResult(0);
+  }
+
+  // Adaptive average pooling over several spatial dims as one windowed sum
+  // per spatial dim followed by a division by the window volumes, which
+  // takes O(K1 + ... + Kn) rather than O(K1 * ... * Kn) work per output.
+  LogicalResult
+  rewriteAsSeparableSums(OpTy op, ConversionPatternRewriter &rewriter,
+                         Value input, int64_t nonSpatial,
+                         ArrayRef<Value> inputSpatialSizes,
+                         ArrayRef<Value> outShapeIndexVector) const {
+    Location loc = op->getLoc();
+    auto resultType = cast<RankedTensorType>(
+        this->getTypeConverter()->convertType(op.getResult().getType()));
+    Type elementType = resultType.getElementType();
+
+    Value sum = input;
+    for (int64_t i = Dim - 1; i >= 0; --i) {
+      sum = createAdaptiveSum(rewriter, loc, sum, nonSpatial + i,
+                              outShapeIndexVector[i]);
+    }
+
+    auto sumType = cast<RankedTensorType>(sum.getType());
+    int64_t rank = sumType.getRank();
+    Value one = arith::ConstantIndexOp::create(rewriter, loc, 1);
+    Value outputTensor = tensor::EmptyOp::create(
+        rewriter, loc, tensor::getMixedSizes(rewriter, loc, sum), elementType);
+    SmallVector<AffineMap> indexingMaps(
+        2, rewriter.getMultiDimIdentityMap(rank));
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::parallel);
+    Value avgPool =
+        linalg::GenericOp::create(
+            rewriter, loc, outputTensor.getType(), sum, outputTensor,
+            indexingMaps, iteratorTypes,
+            [&](OpBuilder &b, Location loc, ValueRange args) {
+              Value volume = one;
+              for (int64_t i = 0; i < Dim; ++i) {
+                Value o = linalg::IndexOp::create(b, loc, nonSpatial + i);
+                auto [start, end] =
+                    getAdaptiveWindow(b, loc, o, inputSpatialSizes[i],
+                                      outShapeIndexVector[i]);
+                Value size = arith::SubIOp::create(b, loc, end, start);
+                volume = arith::MulIOp::create(b, loc, volume, size);
+              }
+              Value divisor = arith::SIToFPOp::create(
+                  b, loc, elementType, castIndexToInt64(b, loc, volume));
+              Value avg = arith::DivFOp::create(b, loc, args[0], divisor);
+              linalg::YieldOp::create(b, loc, avg);
+            })
+            .getResult(0);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, avgPool);
+    return success();
+  }
 
 public:
   LogicalResult
@@ -1656,6 +1881,12 @@ public:
       outShapeIndexVector.push_back(castIntToIndex(rewriter, loc, v));
     }
 
+    if constexpr (isAvgPool) {
+      if (separablePooling && Dim > 1 && isa<mlir::FloatType>(elementType))
+        return rewriteAsSeparableSums(op, rewriter, input, nonSpatial,
+                                      inputSpatialSizes, outShapeIndexVector);
+    }
+
     // make an iteration space of size kMax = 1 + ceildiv (hIn - 1) , hOut
     Type boolType = rewriter.getI1Type();
     SmallVector<Value> kIterSizeVector;
@@ -1814,27 +2045,23 @@ public:
 
 void mlir::torch::torch_to_linalg::populatePoolingPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
-    ConversionTarget &target, bool allowNonFinites) {
+    ConversionTarget &target, bool allowNonFinites, bool separablePooling) {
   MLIRContext *context = patterns.getContext();
   target.addIllegalOp<AtenMaxPool1dOp>();
   target.addIllegalOp<AtenMaxPool2dOp>();
   target.addIllegalOp<AtenMaxPool3dOp>();
-  patterns.add<ConvertAtenMaxPoolOp<AtenMaxPool1dOp>>(typeConverter, context,
-                                                      allowNonFinites);
-  patterns.add<ConvertAtenMaxPoolOp<AtenMaxPool2dOp>>(typeConverter, context,
-                                                      allowNonFinites);
-  patterns.add<ConvertAtenMaxPoolOp<AtenMaxPool3dOp>>(typeConverter, context,
-                                                      allowNonFinites);
+  patterns.add<ConvertAtenMaxPoolOp<AtenMaxPool1dOp>,
+               ConvertAtenMaxPoolOp<AtenMaxPool2dOp>,
+               ConvertAtenMaxPoolOp<AtenMaxPool3dOp>>(
+      typeConverter, context, allowNonFinites, separablePooling);
 
   target.addIllegalOp<AtenMaxPool1dWithIndicesOp>();
   target.addIllegalOp<AtenMaxPool2dWithIndicesOp>();
   target.addIllegalOp<AtenMaxPool3dWithIndicesOp>();
-  patterns.add<ConvertAtenMaxPoolOp<AtenMaxPool1dWithIndicesOp>>(
-      typeConverter, context, allowNonFinites);
-  patterns.add<ConvertAtenMaxPoolOp<AtenMaxPool2dWithIndicesOp>>(
-      typeConverter, context, allowNonFinites);
-  patterns.add<ConvertAtenMaxPoolOp<AtenMaxPool3dWithIndicesOp>>(
-      typeConverter, context, allowNonFinites);
+  patterns.add<ConvertAtenMaxPoolOp<AtenMaxPool1dWithIndicesOp>,
+               ConvertAtenMaxPoolOp<AtenMaxPool2dWithIndicesOp>,
+               ConvertAtenMaxPoolOp<AtenMaxPool3dWithIndicesOp>>(
+      typeConverter, context, allowNonFinites, separablePooling);
 
   target.addIllegalOp<AtenMaxUnpool3dOp>();
   patterns.add<ConvertAtenMaxUnpool3dOp>(typeConverter, context);
@@ -1845,29 +2072,29 @@ void mlir::torch::torch_to_linalg::populatePoolingPatternsAndLegality(
   target.addIllegalOp<AtenAvgPool1dOp, AtenAvgPool2dOp, AtenAvgPool3dOp>();
   patterns
       .add<ConvertAtenAvgPoolOp<AtenAvgPool1dOp, linalg::PoolingNcwSumOp, 1>>(
-          typeConverter, context);
+          typeConverter, context, separablePooling);
   patterns
       .add<ConvertAtenAvgPoolOp<AtenAvgPool2dOp, linalg::PoolingNchwSumOp, 2>>(
-          typeConverter, context);
+          typeConverter, context, separablePooling);
   patterns
       .add<ConvertAtenAvgPoolOp<AtenAvgPool3dOp, linalg::PoolingNdhwcSumOp, 3>>(
-          typeConverter, context);
+          typeConverter, context, separablePooling);
   target.addIllegalOp<AtenAdaptiveAvgPool1dOp, AtenAdaptiveAvgPool2dOp,
                       AtenAdaptiveAvgPool3dOp, Aten_AdaptiveAvgPool3dOp>();
   patterns.add<ConvertAtenAdaptivePoolOp<AtenAdaptiveAvgPool1dOp>>(
-      typeConverter, context);
+      typeConverter, context, allowNonFinites, separablePooling);
   patterns.add<ConvertAtenAdaptivePoolOp<AtenAdaptiveAvgPool2dOp>>(
-      typeConverter, context);
+      typeConverter, context, allowNonFinites, separablePooling);
   patterns.add<ConvertAtenAdaptivePoolOp<AtenAdaptiveAvgPool3dOp>>(
-      typeConverter, context);
+      typeConverter, context, allowNonFinites, separablePooling);
   patterns.add<ConvertAtenAdaptivePoolOp<Aten_AdaptiveAvgPool3dOp>>(
-      typeConverter, context);
+      typeConverter, context, allowNonFinites, separablePooling);
   target.addIllegalOp<AtenAdaptiveMaxPool1dOp, AtenAdaptiveMaxPool2dOp,
                       AtenAdaptiveMaxPool3dOp>();
   patterns.add<ConvertAtenAdaptivePoolOp<AtenAdaptiveMaxPool1dOp>>(
-      typeConverter, context);
+      typeConverter, context, allowNonFinites, separablePooling);
   patterns.add<ConvertAtenAdaptivePoolOp<AtenAdaptiveMaxPool2dOp>>(
-      typeConverter, context);
+      typeConverter, context, allowNonFinites, separablePooling);
   patterns.add<ConvertAtenAdaptivePoolOp<AtenAdaptiveMaxPool3dOp>>(
-      typeConverter, context);
+      typeConverter, context, allowNonFinites, separablePooling);
 }
@@ -41,21 +41,35 @@ void populateTensorScalarInteropPatternsAndLegality(
     ConversionTarget &target);
 void populateLinearPatternsAndLegality(TypeConverter &typeConverter,
                                        RewritePatternSet &patterns,
-                                       ConversionTarget &target);
+                                       ConversionTarget &target,
+                                       bool channelsLastConv,
+                                       bool subPixelConvTranspose,
+                                       bool convBackwardGemm,
+                                       bool transposedMatmulOperands);
 void populatePoolingPatternsAndLegality(TypeConverter &typeConverter,
                                         RewritePatternSet &patterns,
                                         ConversionTarget &target,
-                                        bool allowNonFinites);
+                                        bool allowNonFinites,
+                                        bool separablePooling);
+/// The counter-based generator used for random tensors. Squares64 needs
+/// 64-bit multiplies; Philox-4x32-10 only needs 32-bit ones and yields four
+/// samples per counter.
+enum class RandomAlgorithm { Squares, Philox };
+
+std::optional<RandomAlgorithm> parseRandomAlgorithm(StringRef name);
+
 void populateRandomPatternsAndLegality(TypeConverter &typeConverter,
                                        RewritePatternSet &patterns,
-                                       ConversionTarget &target);
+                                       ConversionTarget &target,
+                                       RandomAlgorithm algorithm);
 void populateUncategorizedPatternsAndLegality(TypeConverter &typeConverter,
                                               RewritePatternSet &patterns,
                                               ConversionTarget &target);
 void populateReductionPatternsAndLegality(TypeConverter &typeConverter,
                                           RewritePatternSet &patterns,
                                           ConversionTarget &target,
-                                          bool allowNonFinites);
+                                          bool allowNonFinites,
+                                          int64_t splitReductionFactor);
 void populateDataMovementPatternsAndLegality(TypeConverter &typeConverter,
                                              RewritePatternSet &patterns,
                                              ConversionTarget &target);
@@ -65,6 +79,48 @@ void populateIndirectDataMovementPatternsAndLegality(
 void populateTensorConstructorsPatternsAndLegality(TypeConverter &typeConverter,
                                                    RewritePatternSet &patterns,
                                                    ConversionTarget &target);
+/// Populates the lowerings of matmuls and adds with sparse operands, which
+/// take precedence over their dense lowerings.
+void populateSparsePatternsAndLegality(TypeConverter &typeConverter,
+                                       RewritePatternSet &patterns,
+                                       ConversionTarget &target);
+
+/// Emits each group of two or more elementwise ops in `root` that are
+/// connected by def-use edges and produce results of the same sizes as a
+/// single multi-result linalg.generic, ahead of the conversion patterns which
+/// would otherwise emit one generic per op.
+LogicalResult fuseElementwiseOps(Operation *root,
+                                 const TypeConverter &typeConverter);
+
+/// Rewrites the `tensor.concat` ops in `root` with an input produced by a
+/// linalg op into `tensor.insert_slice` ops into one tensor, of which that
+/// producer computes its input in a slice, so that it is written in place in
+/// the concatenated buffer after bufferization.
+LogicalResult writeConcatInputsInPlace(Operation *root);
+
+/// Rewrites the quantized matmuls and 2D convolutions in `root`, which
+/// subtract zero points in their inner loop, into the plain integer
+/// contraction followed by correction terms computed from the sums of the
+/// operands.
+void decomposeQuantizedZeroPoints(Operation *root);
+
+/// How the 2D convolutions of a function are lowered past their linalg named
+/// op form. `Auto` picks Winograd or im2col per convolution with a simple cost
+/// model.
+enum class ConvolutionStrategy { Direct, Im2Col, Winograd, Auto };
+
+std::optional<ConvolutionStrategy> parseConvolutionStrategy(StringRef name);
+
+/// Rewrites the `linalg.conv_2d_nchw_fchw` and `linalg.conv_2d_nhwc_hwcf` ops
+/// with static operands in `root` according to `strategy`. Convolutions the
+/// strategy does not apply to are left as they are.
+LogicalResult applyConvolutionStrategy(Operation *root,
+                                       ConvolutionStrategy strategy);
+
+/// Rewrites the convolutions and pools in `root` that read a constant
+/// `tensor.pad` of their input into `linalg.generic` ops reading the unpadded
+/// input with bounds checks, so that no padded copy of it is materialized.
+void readPaddingInWindows(Operation *root);
 
 } // namespace torch_to_linalg
 } // namespace torch
@@ -0,0 +1,259 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// Rewrites the quantized matmuls and convolutions produced by the
+// TorchToLinalg patterns, which subtract the zero points of their operands in
+// their inner loop, into the plain integer contraction followed by correction
+// terms. With zero points za and zb of the lhs A and rhs B,
+//
+//   sum_k (A[m,k] - za) * (B[k,n] - zb)
+//     = sum_k A[m,k] * B[k,n] - zb * sum_k A[m,k] - za * sum_k B[k,n]
+//       + K * za * zb
+//
+// where the sums of the operands are cheap reductions, so that backends can
+// use their integer dot product instructions for the contraction.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PopulatePatterns.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "torch-mlir/Conversion/Utils/Utils.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::torch_to_linalg;
+
+// Sums `input`, extended to `accType`, over all of its dims but `keptDims`.
+static Value createSum(OpBuilder &b, Location loc, Value input,
+                       ArrayRef<int64_t> keptDims, Type accType) {
+  int64_t rank = cast<RankedTensorType>(input.getType()).getRank();
+  SmallVector<Value> sizes;
+  SmallVector<AffineExpr> outExprs;
+  SmallVector<utils::IteratorType> iteratorTypes(
+      rank, utils::IteratorType::reduction);
+  for (int64_t dim : keptDims) {
+    sizes.push_back(getDimOp(b, loc, input, dim));
+    outExprs.push_back(b.getAffineDimExpr(dim));
+    iteratorTypes[dim] = utils::IteratorType::parallel;
+  }
+  Value init = createZeroInitTensor(b, loc, sizes, accType);
+  SmallVector<AffineMap> indexingMaps = {
+      b.getMultiDimIdentityMap(rank),
+      AffineMap::get(rank, 0, outExprs, b.getContext())};
+  return linalg::GenericOp::create(
+             b, loc, init.getType(), input, init, indexingMaps, iteratorTypes,
+             [&](OpBuilder &b, Location loc, ValueRange args) {
+               Value element = args[0];
+               if (element.getType() != accType)
+                 element = arith::ExtSIOp::create(b, loc, accType, element);
+               Value sum = arith::AddIOp::create(b, loc, element, args[1]);
+               linalg::YieldOp::create(b, loc, sum);
+             })
+      .getResult(0);
+}
+
+// Whether the zero point `zp` is known to be 0, so that its correction terms
+// vanish.
+static bool isZero(Value zp) { return matchPattern(zp, m_Zero()); }
+
+// The product of the sizes of `dims` of `tensor`, as an `accType` scalar.
+static Value createReductionSize(OpBuilder &b, Location loc, Value tensor,
+                                 ArrayRef<int64_t> dims, Type accType) {
+  Value size = arith::ConstantIndexOp::create(b, loc, 1);
+  for (int64_t dim : dims) {
+    size = b.createOrFold<arith::MulIOp>(loc, size,
+                                         getDimOp(b, loc, tensor, dim));
+  }
+  return b.createOrFold<arith::IndexCastOp>(loc, accType, size);
+}
+
+// Applies the zero point corrections to `product`, the integer contraction of
+// two operands with zero points `lhsZp` and `rhsZp`:
+//   product - rhsZp * lhsSums - lhsZp * rhsSums + size * lhsZp * rhsZp
+// where `lhsSums` and `rhsSums` are read through `lhsSumsMap` and
+// `rhsSumsMap`, and are null when the zero point that scales them is 0.
+static Value applyZeroPointCorrections(OpBuilder &b, Location loc,
+                                       Value product, Value lhsZp, Value rhsZp,
+                                       Value lhsSums, AffineMap lhsSumsMap,
+                                       Value rhsSums, AffineMap rhsSumsMap,
+                                       Value size) {
+  int64_t rank = cast<RankedTensorType>(product.getType()).getRank();
+  SmallVector<Value> inputs;
+  SmallVector<AffineMap> indexingMaps;
+  if (lhsSums) {
+    inputs.push_back(lhsSums);
+    indexingMaps.push_back(lhsSumsMap);
+  }
+  if (rhsSums) {
+    inputs.push_back(rhsSums);
+    indexingMaps.push_back(rhsSumsMap);
+  }
+  indexingMaps.push_back(b.getMultiDimIdentityMap(rank));
+  SmallVector<utils::IteratorType> iteratorTypes(rank,
+                                                 utils::IteratorType::parallel);
+  // The constant term is only needed when both zero points are not 0.
+  Value constant;
+  if (lhsSums && rhsSums) {
+    Value zps = arith::MulIOp::create(b, loc, lhsZp, rhsZp);
+    constant = arith::MulIOp::create(b, loc, zps, size);
+  }
+  return linalg::GenericOp::create(
+             b, loc, product.getType(), inputs, product, indexingMaps,
+             iteratorTypes,
+             [&](OpBuilder &b, Location loc, ValueRange args) {
+               Value result = args.back();
+               unsigned i = 0;
+               if (lhsSums) {
+                 Value term = arith::MulIOp::create(b, loc, rhsZp, args[i++]);
+                 result = arith::SubIOp::create(b, loc, result, term);
+               }
+               if (rhsSums) {
+                 Value term = arith::MulIOp::create(b, loc, lhsZp, args[i++]);
+                 result = arith::SubIOp::create(b, loc, result, term);
+               }
+               if (constant)
+                 result = arith::AddIOp::create(b, loc, result, constant);
+               linalg::YieldOp::create(b, loc, result);
+             })
+      .getResult(0);
+}
+
+// Rewrites a `linalg.quantized_matmul` or `linalg.quantized_batch_matmul`.
+static void decomposeQuantizedMatmul(IRRewriter &rewriter,
+                                     linalg::LinalgOp op) {
+  Location loc = op.getLoc();
+  rewriter.setInsertionPoint(op);
+  Value lhs = op.getDpsInputs()[0], rhs = op.getDpsInputs()[1];
+  Value lhsZp = op.getDpsInputs()[2], rhsZp = op.getDpsInputs()[3];
+  Value init = op.getDpsInits()[0];
+  Type accType = getElementTypeOrSelf(init.getType());
+  int64_t rank = cast<RankedTensorType>(init.getType()).getRank();
+
+  Value product;
+  if (rank == 2) {
+    product = linalg::MatmulOp::create(rewriter, loc, init.getType(),
+                                       ValueRange{lhs, rhs}, init)
+                  .getResult(0);
+  } else {
+    product = linalg::BatchMatmulOp::create(rewriter, loc, init.getType(),
+                                            ValueRange{lhs, rhs}, init)
+                  .getResult(0);
+  }
+  Value result = product;
+  if (!isZero(lhsZp) || !isZero(rhsZp)) {
+    // The sums of the rows of the lhs and of the columns of the rhs, per
+    // batch.
+    SmallVector<int64_t> lhsKept, rhsKept;
+    SmallVector<AffineExpr> lhsSumsExprs, rhsSumsExprs;
+    for (int64_t i = 0; i < rank - 2; ++i) {
+      lhsKept.push_back(i);
+      rhsKept.push_back(i);
+      lhsSumsExprs.push_back(rewriter.getAffineDimExpr(i));
+      rhsSumsExprs.push_back(rewriter.getAffineDimExpr(i));
+    }
+    lhsKept.push_back(rank - 2);
+    rhsKept.push_back(rank - 1);
+    lhsSumsExprs.push_back(rewriter.getAffineDimExpr(rank - 2));
+    rhsSumsExprs.push_back(rewriter.getAffineDimExpr(rank - 1));
+    Value lhsSums, rhsSums;
+    if (!isZero(rhsZp))
+      lhsSums = createSum(rewriter, loc, lhs, lhsKept, accType);
+    if (!isZero(lhsZp))
+      rhsSums = createSum(rewriter, loc, rhs, rhsKept, accType);
+    Value size = createReductionSize(rewriter, loc, lhs, {rank - 1}, accType);
+    result = applyZeroPointCorrections(
+        rewriter, loc, product, lhsZp, rhsZp, lhsSums,
+        AffineMap::get(rank, 0, lhsSumsExprs, rewriter.getContext()), rhsSums,
+        AffineMap::get(rank, 0, rhsSumsExprs, rewriter.getContext()), size);
+  }
+  rewriter.replaceOp(op, result);
+}
+
+// Rewrites a `linalg.conv_2d_nchw_fchw_q`, for which the sums of the input
+// are over the channels and the window of each output element.
+static void decomposeQuantizedConvolution(IRRewriter &rewriter,
+                                          linalg::Conv2DNchwFchwQOp op) {
+  Location loc = op.getLoc();
+  rewriter.setInsertionPoint(op);
+  Value input = op.getDpsInputs()[0], filter = op.getDpsInputs()[1];
+  Value inputZp = op.getDpsInputs()[2], filterZp = op.getDpsInputs()[3];
+  Value init = op.getDpsInits()[0];
+  Type accType = getElementTypeOrSelf(init.getType());
+
+  Value product =
+      linalg::Conv2DNchwFchwOp::create(
+          rewriter, loc, init.getType(), ValueRange{input, filter}, init,
+          op.getStrides(), op.getDilations())
+          .getResult(0);
+  Value result = product;
+  if (!isZero(inputZp) || !isZero(filterZp)) {
+    MLIRContext *context = rewriter.getContext();
+    AffineExpr n, f, h, w;
+    bindDims(context, n, f, h, w);
+    Value inputSums, filterSums;
+    if (!isZero(filterZp)) {
+      // Sum the channels first, then the windows of the channel sums, with a
+      // sum pool of the same strides and dilations as the convolution.
+      Value channelSums = createSum(rewriter, loc, input, {0, 2, 3}, accType);
+      auto channelSumsType = cast<RankedTensorType>(channelSums.getType());
+      SmallVector<int64_t> expandedShape(channelSumsType.getShape());
+      expandedShape.insert(expandedShape.begin() + 1, 1);
+      channelSums = tensor::ExpandShapeOp::create(
+          rewriter, loc, RankedTensorType::get(expandedShape, accType),
+          channelSums, ArrayRef<ReassociationIndices>{{0, 1}, {2}, {3}});
+      Value kernel = tensor::EmptyOp::create(
+          rewriter, loc,
+          getAsOpFoldResult(ValueRange{getDimOp(rewriter, loc, filter, 2),
+                                       getDimOp(rewriter, loc, filter, 3)}),
+          accType);
+      Value one = arith::ConstantIndexOp::create(rewriter, loc, 1);
+      Value windowSumsInit = createZeroInitTensor(
+          rewriter, loc,
+          ValueRange{getDimOp(rewriter, loc, init, 0), one,
+                     getDimOp(rewriter, loc, init, 2),
+                     getDimOp(rewriter, loc, init, 3)},
+          accType);
+      inputSums = linalg::PoolingNchwSumOp::create(
+                      rewriter, loc, windowSumsInit.getType(),
+                      ValueRange{channelSums, kernel}, windowSumsInit,
+                      op.getStrides(), op.getDilations())
+                      .getResult(0);
+    }
+    if (!isZero(inputZp))
+      filterSums = createSum(rewriter, loc, filter, {0}, accType);
+    Value size = createReductionSize(rewriter, loc, filter, {1, 2, 3}, accType);
+    result = applyZeroPointCorrections(
+        rewriter, loc, product, inputZp, filterZp, inputSums,
+        AffineMap::get(4, 0, {n, rewriter.getAffineConstantExpr(0), h, w},
+                       context),
+        filterSums, AffineMap::get(4, 0, {f}, context), size);
+  }
+  rewriter.replaceOp(op, result);
+}
+
+void torch_to_linalg::decomposeQuantizedZeroPoints(Operation *root) {
+  SmallVector<linalg::LinalgOp> ops;
+  root->walk([&](linalg::LinalgOp op) {
+    if (isa<linalg::QuantizedMatmulOp, linalg::QuantizedBatchMatmulOp,
+            linalg::Conv2DNchwFchwQOp>(op.getOperation()) &&
+        op.hasPureTensorSemantics())
+      ops.push_back(op);
+  });
+  IRRewriter rewriter(root->getContext());
+  for (linalg::LinalgOp op : ops) {
+    if (auto conv = dyn_cast<linalg::Conv2DNchwFchwQOp>(op.getOperation()))
+      decomposeQuantizedConvolution(rewriter, conv);
+    else
+      decomposeQuantizedMatmul(rewriter, op);
+  }
+}
@@ -11,6 +11,7 @@
 
 #include "PopulatePatterns.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Arith/Utils/Utils.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/Matchers.h"
@@ -19,6 +20,7 @@
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Utils/TorchUpstream.h"
 #include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
+#include "llvm/ADT/StringSwitch.h"
 
 using namespace mlir;
 using namespace mlir::torch;
@@ -128,10 +130,78 @@ static Value randomUniformF64(OpBuilder &b, Location loc, Value ctr, Value key,
   return uniformSample;
 }
 
+// Philox-4x32-10 algorithm for generating four 32-bit random numbers per
+// 64-bit counter, using 32-bit multiplies only.
+// See: https://doi.org/10.1145/2063384.2063405
+static SmallVector<Value> randomPhilox4x32(OpBuilder &b, Location loc,
+                                           Value ctr, Value key) {
+  Type i32Ty = b.getI32Type();
+  auto cst = [&](uint32_t value) -> Value {
+    return arith::ConstantOp::create(b, loc,
+                                     b.getIntegerAttr(i32Ty, APInt(32, value)));
+  };
+  Value cst32 = arith::ConstantOp::create(b, loc, b.getI64IntegerAttr(32));
+  auto lo = [&](Value val) -> Value {
+    return arith::TruncIOp::create(b, loc, i32Ty, val);
+  };
+  auto hi = [&](Value val) -> Value {
+    return lo(arith::ShRUIOp::create(b, loc, val, cst32));
+  };
+  auto bitwiseXOr = [&](Value lhs, Value rhs) -> Value {
+    return arith::XOrIOp::create(b, loc, lhs, rhs);
+  };
+
+  Value m0 = cst(0xD2511F53), m1 = cst(0xCD9E8D57);
+  Value w0 = cst(0x9E3779B9), w1 = cst(0xBB67AE85);
+  SmallVector<Value> x = {lo(ctr), hi(ctr), cst(0), cst(0)};
+  Value k0 = lo(key), k1 = hi(key);
+  for (int round = 0; round < 10; ++round) {
+    if (round > 0) {
+      k0 = arith::AddIOp::create(b, loc, k0, w0);
+      k1 = arith::AddIOp::create(b, loc, k1, w1);
+    }
+    auto p0 = arith::MulUIExtendedOp::create(b, loc, m0, x[0]);
+    auto p1 = arith::MulUIExtendedOp::create(b, loc, m1, x[2]);
+    x = {bitwiseXOr(bitwiseXOr(p1.getHigh(), x[1]), k0), p1.getLow(),
+         bitwiseXOr(bitwiseXOr(p0.getHigh(), x[3]), k1), p0.getLow()};
+  }
+  return x;
+}
+
+// generate uniform random Float64 from 32 random bits
+static Value randomUniformF64FromUInt32(OpBuilder &b, Location loc,
+                                        Value randomVal, Value min, Value max) {
+  // Keep the top 24 bits, so that the samples in [0, 1) are exactly
+  // representable in f32 and never round up to 1.
+  Value cst8 = arith::ConstantOp::create(b, loc, b.getI32IntegerAttr(8));
+  Value bits = arith::ShRUIOp::create(b, loc, randomVal, cst8);
+  Value epsilon = arith::ConstantOp::create(
+      b, loc, b.getFloatAttr(b.getF64Type(), 0x1.0p-24));
+  Value range = arith::SubFOp::create(b, loc, max, min);
+  Value scale = arith::MulFOp::create(b, loc, range, epsilon);
+  Value updateFloat = arith::UIToFPOp::create(b, loc, b.getF64Type(), bits);
+  Value updateScaled = arith::MulFOp::create(b, loc, updateFloat, scale);
+  return arith::AddFOp::create(b, loc, updateScaled, min);
+}
+
+std::optional<torch_to_linalg::RandomAlgorithm>
+torch_to_linalg::parseRandomAlgorithm(StringRef name) {
+  return llvm::StringSwitch<std::optional<RandomAlgorithm>>(name)
+      .Case("squares", RandomAlgorithm::Squares)
+      .Case("philox", RandomAlgorithm::Philox)
+      .Default(std::nullopt);
+}
+
 namespace {
 class ConvertAtenUniformOp : public OpConversionPattern<AtenUniformOp> {
+private:
+  torch_to_linalg::RandomAlgorithm algorithm;
+
 public:
-  using OpConversionPattern::OpConversionPattern;
+  ConvertAtenUniformOp(TypeConverter &typeConverter, MLIRContext *context,
+                       torch_to_linalg::RandomAlgorithm algorithm)
+      : OpConversionPattern(typeConverter, context), algorithm(algorithm) {}
+
   LogicalResult
   matchAndRewrite(AtenUniformOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -158,6 +228,17 @@ public:
     Value min = convertScalarToDtype(rewriter, loc, from, f64Ty);
     Value max = convertScalarToDtype(rewriter, loc, to, f64Ty);
 
+    // 32 random bits are enough for types narrower than f64.
+    if (algorithm == torch_to_linalg::RandomAlgorithm::Philox &&
+        !elemTy.isF64()) {
+      Value uniformRes =
+          createPhiloxUniform(rewriter, loc, self, key, min, max, elemTy);
+      Type newResultType = getTypeConverter()->convertType(op.getType());
+      rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType,
+                                                  uniformRes);
+      return success();
+    }
+
     // Construct the `linalg.generic` op.
     auto resultRank = resultType.getRank();
     SmallVector<AffineMap, 1> indexingMaps(
@@ -195,6 +276,64 @@ public:
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, uniformRes);
     return success();
   }
+
+private:
+  // Fills a tensor shaped like `self` with samples from the Philox lanes.
+  // Each of the ceil(numel / 4) counters yields one element of each quarter
+  // of the flattened result, so that every lane is stored contiguously.
+  Value createPhiloxUniform(OpBuilder &b, Location loc, Value self, Value key,
+                            Value min, Value max, Type elemTy) const {
+    constexpr int64_t numLanes = 4;
+    auto selfType = cast<RankedTensorType>(self.getType());
+    int64_t rank = selfType.getRank();
+    SmallVector<OpFoldResult> sizes = tensor::getMixedSizes(b, loc, self);
+    Value numel = arith::ConstantIndexOp::create(b, loc, 1);
+    for (OpFoldResult size : sizes)
+      numel = arith::MulIOp::create(
+          b, loc, numel, getValueOrCreateConstantIndexOp(b, loc, size));
+    Value numCounters = arith::CeilDivUIOp::create(
+        b, loc, numel, arith::ConstantIndexOp::create(b, loc, numLanes));
+
+    Value lane = tensor::EmptyOp::create(
+        b, loc, ArrayRef<OpFoldResult>{numCounters}, elemTy);
+    SmallVector<Value> lanes(numLanes, lane);
+    SmallVector<AffineMap> indexingMaps(numLanes,
+                                        b.getMultiDimIdentityMap(1));
+    auto philoxOp = linalg::GenericOp::create(
+        b, loc, ValueRange(lanes).getTypes(), /*inputs=*/ValueRange{},
+        /*outputs=*/lanes, indexingMaps, utils::IteratorType::parallel,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value ctr =
+              castIndexToInt64(b, loc, linalg::IndexOp::create(b, loc, 0));
+          SmallVector<Value> results;
+          for (Value bits : randomPhilox4x32(b, loc, ctr, key)) {
+            Value res = randomUniformF64FromUInt32(b, loc, bits, min, max);
+            results.push_back(arith::TruncFOp::create(b, loc, elemTy, res));
+          }
+          linalg::YieldOp::create(b, loc, results);
+        });
+
+    Value flat =
+        tensor::ConcatOp::create(b, loc, /*dim=*/0, philoxOp.getResults());
+    flat = tensor::ExtractSliceOp::create(
+        b, loc, flat, ArrayRef<OpFoldResult>{b.getIndexAttr(0)},
+        ArrayRef<OpFoldResult>{numel},
+        ArrayRef<OpFoldResult>{b.getIndexAttr(1)});
+    auto resultType = RankedTensorType::get(selfType.getShape(), elemTy);
+    if (rank == 0) {
+      flat = tensor::CastOp::create(
+          b, loc, RankedTensorType::get({1}, elemTy), flat);
+      return tensor::CollapseShapeOp::create(
+          b, loc, resultType, flat, ArrayRef<ReassociationIndices>{});
+    }
+    if (rank == 1)
+      return flat;
+    ReassociationIndices allDims =
+        llvm::to_vector(llvm::seq<int64_t>(0, rank));
+    return tensor::ExpandShapeOp::create(
+        b, loc, resultType, flat, ArrayRef<ReassociationIndices>{allDims},
+        sizes);
+  }
 };
 } // namespace
 
@@ -245,6 +384,28 @@ public:
           op, "torch.multinomial accepts only rank 1 or 2 tensors as weights");
     }
 
+    int64_t srcWidth = cast<mlir::FloatType>(elemTy).getWidth();
+    if (srcWidth > 64)
+      op->emitWarning("Op bitwidth will be truncated from " +
+                      std::to_string(srcWidth) + " bits to 64 bits.");
+    auto toF64 = [&](OpBuilder &b, Location loc, Value value) {
+      if (srcWidth < 64)
+        return arith::ExtFOp::create(b, loc, f64Ty, value).getResult();
+      if (srcWidth > 64)
+        return arith::TruncFOp::create(b, loc, f64Ty, value).getResult();
+      return value;
+    };
+
+    // A single distribution is sampled as a batch of one.
+    if (inputRank == 1) {
+      SmallVector<int64_t> batchShape{1, selfType.getDimSize(0)};
+      self = tensor::ExpandShapeOp::create(
+          rewriter, loc, RankedTensorType::get(batchShape, elemTy), self,
+          ArrayRef<ReassociationIndices>{{0, 1}},
+          ArrayRef<OpFoldResult>{
+              rewriter.getIndexAttr(1),
+              tensor::getMixedSize(rewriter, loc, self, 0)});
+    }
     Value cstZero = arith::ConstantOp::create(rewriter, loc, i64Ty,
                                               rewriter.getI64IntegerAttr(0));
     Value cstOne = arith::ConstantOp::create(rewriter, loc, i64Ty,
@@ -253,250 +414,141 @@ public:
     Value oneIndex = arith::ConstantIndexOp::create(rewriter, loc, 1);
     Value numSamplesIndex =
         arith::IndexCastOp::create(rewriter, loc, indexTy, numSamples);
-
-    Value numDistributions;
-    Value numCategoriesIndex;
-    ValueRange resultShape;
-    if (inputRank == 1) {
-      numDistributions = cstOne;
-      numCategoriesIndex =
-          tensor::DimOp::create(rewriter, loc, indexTy, self, zeroIndex);
-      resultShape = ValueRange{numSamplesIndex};
-    } else {
-      Value numDistIndex =
-          tensor::DimOp::create(rewriter, loc, indexTy, self, zeroIndex);
-      numCategoriesIndex =
-          tensor::DimOp::create(rewriter, loc, indexTy, self, oneIndex);
-      numDistributions =
-          arith::IndexCastOp::create(rewriter, loc, i64Ty, numDistIndex);
-      resultShape = ValueRange{numDistIndex, numSamplesIndex};
-    }
-
+    Value numDistIndex =
+        tensor::DimOp::create(rewriter, loc, indexTy, self, zeroIndex);
+    Value numCategoriesIndex =
+        tensor::DimOp::create(rewriter, loc, indexTy, self, oneIndex);
     Value numCategories =
         arith::IndexCastOp::create(rewriter, loc, i64Ty, numCategoriesIndex);
-    Value resultTensor = tensor::EmptyOp::create(
-        rewriter, loc, getAsOpFoldResult(resultShape), i64Ty);
 
     // sum weights for normalization
-    torch_to_linalg::ReductionOpInfo opInfo;
-    if (inputRank == 1)
-      opInfo = {false, self, {0}};
-    else
-      opInfo = {false, self, {1}};
-
+    torch_to_linalg::ReductionOpInfo opInfo = {false, self, {1}};
     Value initSum = arith::ConstantOp::create(rewriter, loc, f64Ty,
                                               rewriter.getF64FloatAttr(0.0));
-    int64_t srcWidth = cast<mlir::FloatType>(elemTy).getWidth();
-    if (srcWidth > 64)
-      op->emitWarning("Op bitwidth will be truncated from " +
-                      std::to_string(srcWidth) + " bits to 64 bits.");
     auto sumBody = [&](OpBuilder &b, Location loc, ValueRange payloadArgs) {
-      Value input = payloadArgs[0];
-      if (srcWidth < 64)
-        input = arith::ExtFOp::create(b, loc, f64Ty, input);
-      if (srcWidth > 64)
-        input = arith::TruncFOp::create(b, loc, f64Ty, input);
-      Value result = payloadArgs[1];
-      Value nextSum = arith::AddFOp::create(b, loc, input, result);
+      Value input = toF64(b, loc, payloadArgs[0]);
+      Value nextSum = arith::AddFOp::create(b, loc, input, payloadArgs[1]);
       linalg::YieldOp::create(b, loc, nextSum);
     };
     Value sumWeights = torch_to_linalg::createReductionLinalgGeneric(
         rewriter, loc, opInfo, initSum, sumBody);
 
-    // Get multinomial samples for each weight vector
-    auto multinomialComputation = [&](OpBuilder &b, Location loc, Value j,
-                                      ValueRange args) {
-      Value jIndex = arith::IndexCastOp::create(b, loc, indexTy, j);
-
-      Value sum;
-      if (inputRank == 1) {
-        sum = tensor::ExtractOp::create(b, loc, sumWeights, ValueRange{});
-      } else {
-        sum = tensor::ExtractOp::create(b, loc, sumWeights, ValueRange{jIndex});
-      }
-
-      // compute cdf in loop
-      Value initCdf = tensor::EmptyOp::create(
-          b, loc, getAsOpFoldResult(ValueRange{numCategoriesIndex}), f64Ty);
-      Value cdf =
-          scf::ForOp::create(
-              b, loc, cstZero, numCategories, cstOne, ValueRange{initCdf},
-              [&](OpBuilder &b, Location loc, Value i, ValueRange vals) {
-                Value distribution = vals[0];
-                // if (i > 0)
-                auto comparisonPredicate = arith::CmpIPredicateAttr::get(
-                    b.getContext(), arith::CmpIPredicate::sgt);
-                Value condition = arith::CmpIOp::create(
-                    b, loc, comparisonPredicate, i, cstZero);
-                Value iIndex = arith::IndexCastOp::create(b, loc, indexTy, i);
-                // curr_cum = i > 0 ? prob[i] + prob[i-1] : prob[i]
-                ValueRange ind;
-                if (inputRank == 1) {
-                  ind = ValueRange{iIndex};
-                } else {
-                  ind = ValueRange{jIndex, iIndex};
-                }
-                Value currWeight = tensor::ExtractOp::create(b, loc, self, ind);
-                if (srcWidth < 64)
-                  currWeight = arith::ExtFOp::create(b, loc, f64Ty, currWeight);
-                if (srcWidth > 64)
-                  currWeight =
-                      arith::TruncFOp::create(b, loc, f64Ty, currWeight);
-                Value currMass = arith::DivFOp::create(b, loc, currWeight, sum);
-                Value currCum =
-                    scf::IfOp::create(
-                        b, loc, condition,
-                        [&](OpBuilder &b, Location loc) {
-                          Value prevI =
-                              arith::SubIOp::create(b, loc, i, cstOne);
-                          Value prevIndex = arith::IndexCastOp::create(
-                              b, loc, indexTy, prevI);
-                          Value prevMass = tensor::ExtractOp::create(
-                              b, loc, distribution, ValueRange{prevIndex});
-                          Value currSum =
-                              arith::AddFOp::create(b, loc, currMass, prevMass);
-                          scf::YieldOp::create(b, loc, ValueRange(currSum));
-                        },
-                        [&](OpBuilder &b, Location loc) {
-                          scf::YieldOp::create(b, loc, ValueRange{currMass});
-                        })
-                        .getResult(0);
-
-                Value updatedCdf = tensor::InsertOp::create(
-                    b, loc, currCum, distribution, ValueRange(iIndex));
-                scf::YieldOp::create(b, loc, ValueRange(updatedCdf));
-              })
-              .getResult(0);
-
-      /*
-       * Above we've computed the CDF for the unnormalized distribution given to
-       * us by the user. In order to actually sample from this distribution we
-       * do the following below: 1) Sample a random floating point value, r in
-       * [0,1), from a uniform distribution. 2) Perform a binary search in the
-       * cdf to find the first bin in the CDF where cdf[i] < r. This guarantees
-       * a random sample from the provided distribution with the appropriate
-       * probabilities.
-       *
-       * This logic is pulled straight from PyTorch's Multinomial Kernel:
-       * https://github.com/pytorch/pytorch/blob/e4623de4cf6097ff399aa9eb0cef44b44ca76da4/aten/src/ATen/native/cpu/MultinomialKernel.cpp#L23
-       * */
-
-      // Get key, min and max used by RNG.
-      Value key = TorchConversion::GetNextSeedOp::create(b, loc);
-      Value min = arith::ConstantOp::create(b, loc, f64Ty,
-                                            rewriter.getF64FloatAttr(0.0));
-      Value max = arith::ConstantOp::create(b, loc, f64Ty,
-                                            rewriter.getF64FloatAttr(1.0));
-
-      // iterate and sample class indices
-      Value result = args[0];
-      Value finalResult =
-          scf::ForOp::create(
-              rewriter, loc, cstZero, numSamples, cstOne, ValueRange{result},
-              [&](OpBuilder &b, Location loc, Value i, ValueRange args) {
-                // Sample random float
-                Value uniformSample =
-                    randomUniformF64(b, loc, i, key, min, max);
-
-                // binary search in cdf to find our sample
-                Value left = arith::ConstantOp::create(b, loc, i64Ty,
-                                                       b.getI64IntegerAttr(0));
-                Value right = numCategories;
-
-                auto checkCondition = [&](OpBuilder &b, Location loc,
-                                          ValueRange vals) {
-                  Value left = vals[0];
-                  Value right = vals[1];
-
-                  // while (right > left)
-                  auto comparisonPredicate = arith::CmpIPredicateAttr::get(
-                      b.getContext(), arith::CmpIPredicate::sgt);
-                  Value loopCondition = arith::CmpIOp::create(
-                      b, loc, comparisonPredicate, right, left);
-                  scf::ConditionOp::create(b, loc, loopCondition, vals);
-                };
-
-                ValueRange whileResults =
-                    scf::WhileOp::create(
-                        b, loc, TypeRange{i64Ty, i64Ty},
-                        ValueRange{left, right}, checkCondition,
-                        [&](OpBuilder &b, Location loc, ValueRange vals) {
-                          Value left = vals[0];
-                          Value right = vals[1];
-
-                          Value two = arith::ConstantOp::create(
-                              b, loc, i64Ty, b.getI64IntegerAttr(2));
-                          Value diff =
-                              arith::SubIOp::create(b, loc, right, left);
-                          Value diffMid =
-                              arith::DivSIOp::create(b, loc, diff, two);
-                          Value midPointer =
-                              arith::AddIOp::create(b, loc, left, diffMid);
-                          Type indexTy = b.getIndexType();
-                          Value midIndex = arith::IndexCastOp::create(
-                              b, loc, indexTy, midPointer);
-
-                          // branch and update search indices
-                          auto thenBlock = [&](OpBuilder &b, Location loc) {
-                            // left = mid + 1
-                            Value newLeft = arith::AddIOp::create(
-                                b, loc, midPointer, cstOne);
-
-                            scf::YieldOp::create(b, loc,
-                                                 ValueRange{newLeft, right});
-                          };
-                          auto elseBlock = [&](OpBuilder &b, Location loc) {
-                            // right = mid
-                            scf::YieldOp::create(b, loc,
-                                                 ValueRange{left, midPointer});
-                          };
-
-                          Value cumProb = tensor::ExtractOp::create(
-                              b, loc, cdf, ValueRange{midIndex});
-                          auto cmpPredicate = arith::CmpFPredicateAttr::get(
-                              b.getContext(), arith::CmpFPredicate::OLT);
-                          Value branchCondition = arith::CmpFOp::create(
-                              b, loc, cmpPredicate, cumProb, uniformSample);
-                          ValueRange branchResults =
-                              scf::IfOp::create(b, loc, branchCondition,
-                                                thenBlock, elseBlock)
-                                  .getResults();
-                          Value newLeft = branchResults[0];
-                          Value newRight = branchResults[1];
-
-                          scf::YieldOp::create(b, loc,
-                                               ValueRange{newLeft, newRight});
-                        })
-                        .getResults();
-
-                // sample_idx = left_pointer
-                Value samplePointer = whileResults[0];
-                Value iIndex = arith::IndexCastOp::create(b, loc, indexTy, i);
-
-                Value prevResult = args[0];
-                Value newResult;
-                if (inputRank == 1) {
-                  // result[i] = sample_idx
-                  newResult = tensor::InsertOp::create(
-                      b, loc, samplePointer, prevResult, ValueRange{iIndex});
-                } else {
-                  // result[j][i] = sample_idx
-                  newResult = tensor::InsertOp::create(
-                      b, loc, samplePointer, prevResult,
-                      ValueRange{jIndex, iIndex});
-                }
-
-                scf::YieldOp::create(b, loc, ValueRange{newResult});
-              })
+    // The CDFs of the normalized distributions are computed once, in parallel
+    // over the distributions, each by a running sum over its categories.
+    Value initCdfs = tensor::EmptyOp::create(
+        rewriter, loc,
+        getAsOpFoldResult(ValueRange{numDistIndex, numCategoriesIndex}),
+        f64Ty);
+    auto cdfs = scf::ForallOp::create(
+        rewriter, loc, getAsOpFoldResult(ValueRange{numDistIndex}),
+        ValueRange{initCdfs}, /*mapping=*/std::nullopt,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value j = args[0];
+          Value sum = tensor::ExtractOp::create(b, loc, sumWeights, j);
+          Value initRow = tensor::EmptyOp::create(
+              b, loc, getAsOpFoldResult(ValueRange{numCategoriesIndex}), f64Ty);
+          Value row =
+              scf::ForOp::create(
+                  b, loc, zeroIndex, numCategoriesIndex, oneIndex,
+                  ValueRange{initSum, initRow},
+                  [&](OpBuilder &b, Location loc, Value i, ValueRange vals) {
+                    Value weight = tensor::ExtractOp::create(
+                        b, loc, self, ValueRange{j, i});
+                    Value mass = arith::DivFOp::create(
+                        b, loc, toF64(b, loc, weight), sum);
+                    Value cum = arith::AddFOp::create(b, loc, vals[0], mass);
+                    Value updatedRow = tensor::InsertOp::create(
+                        b, loc, cum, vals[1], ValueRange{i});
+                    scf::YieldOp::create(b, loc, ValueRange{cum, updatedRow});
+                  })
+                  .getResult(1);
+          auto inParallel = scf::InParallelOp::create(b, loc);
+          b.setInsertionPointToStart(inParallel.getBody());
+          tensor::ParallelInsertSliceOp::create(
+              b, loc, row, /*dest=*/args[1],
+              ArrayRef<OpFoldResult>{j, b.getIndexAttr(0)},
+              getAsOpFoldResult(ValueRange{oneIndex, numCategoriesIndex}),
+              ArrayRef<OpFoldResult>{b.getIndexAttr(1), b.getIndexAttr(1)});
+        });
+    Value cdf = cdfs.getResult(0);
+
+    /*
+     * Each sample draws a random floating point value r in [0,1) from a
+     * uniform distribution, then performs a binary search in the CDF of its
+     * distribution for the first bin i where !(cdf[i] < r). This guarantees
+     * a random sample from the provided distribution with the appropriate
+     * probabilities. The samples are drawn in parallel, with the
+     * counter-based RNG keyed once by the seed and counted by the position of
+     * the sample in the result.
+     *
+     * This logic is pulled straight from PyTorch's Multinomial Kernel:
+     * https://github.com/pytorch/pytorch/blob/e4623de4cf6097ff399aa9eb0cef44b44ca76da4/aten/src/ATen/native/cpu/MultinomialKernel.cpp#L23
+     * */
+    Value key = TorchConversion::GetNextSeedOp::create(rewriter, loc);
+    Value min = arith::ConstantOp::create(rewriter, loc, f64Ty,
+                                          rewriter.getF64FloatAttr(0.0));
+    Value max = arith::ConstantOp::create(rewriter, loc, f64Ty,
+                                          rewriter.getF64FloatAttr(1.0));
+    Value resultTensor = tensor::EmptyOp::create(
+        rewriter, loc,
+        getAsOpFoldResult(ValueRange{numDistIndex, numSamplesIndex}), i64Ty);
+    SmallVector<AffineMap> indexingMaps{
+        rewriter.getMultiDimIdentityMap(/*rank=*/2)};
+    SmallVector<utils::IteratorType> iteratorTypes(
+        2, utils::IteratorType::parallel);
+    auto sampleBody = [&](OpBuilder &b, Location loc, ValueRange) {
+      Value jIndex = linalg::IndexOp::create(b, loc, 0);
+      Value j = castIndexToInt64(b, loc, jIndex);
+      Value i = castIndexToInt64(b, loc, linalg::IndexOp::create(b, loc, 1));
+      Value ctr = arith::AddIOp::create(
+          b, loc, arith::MulIOp::create(b, loc, j, numSamples), i);
+      Value uniformSample = randomUniformF64(b, loc, ctr, key, min, max);
+
+      auto checkCondition = [&](OpBuilder &b, Location loc, ValueRange vals) {
+        // while (right > left)
+        Value loopCondition = arith::CmpIOp::create(
+            b, loc, arith::CmpIPredicate::sgt, vals[1], vals[0]);
+        scf::ConditionOp::create(b, loc, loopCondition, vals);
+      };
+      auto searchStep = [&](OpBuilder &b, Location loc, ValueRange vals) {
+        Value left = vals[0];
+        Value right = vals[1];
+        Value two = arith::ConstantOp::create(b, loc, i64Ty,
+                                              b.getI64IntegerAttr(2));
+        Value diff = arith::SubIOp::create(b, loc, right, left);
+        Value midPointer = arith::AddIOp::create(
+            b, loc, left, arith::DivSIOp::create(b, loc, diff, two));
+        Value midIndex =
+            arith::IndexCastOp::create(b, loc, indexTy, midPointer);
+        Value cumProb = tensor::ExtractOp::create(
+            b, loc, cdf, ValueRange{jIndex, midIndex});
+        Value branchCondition = arith::CmpFOp::create(
+            b, loc, arith::CmpFPredicate::OLT, cumProb, uniformSample);
+        // left = mid + 1 if cdf[mid] < r, else right = mid
+        Value newLeft = arith::SelectOp::create(
+            b, loc, branchCondition,
+            arith::AddIOp::create(b, loc, midPointer, cstOne), left);
+        Value newRight =
+            arith::SelectOp::create(b, loc, branchCondition, right, midPointer);
+        scf::YieldOp::create(b, loc, ValueRange{newLeft, newRight});
+      };
+      // sample_idx = left_pointer
+      Value samplePointer =
+          scf::WhileOp::create(b, loc, TypeRange{i64Ty, i64Ty},
+                               ValueRange{cstZero, numCategories},
+                               checkCondition, searchStep)
               .getResult(0);
-
-      scf::YieldOp::create(b, loc, ValueRange{finalResult});
+      linalg::YieldOp::create(b, loc, samplePointer);
     };
-
     Value finalResultTensor =
-        scf::ForOp::create(rewriter, loc, cstZero, numDistributions, cstOne,
-                           ValueRange{resultTensor}, multinomialComputation)
+        linalg::GenericOp::create(rewriter, loc, resultTensor.getType(),
+                                  /*inputs=*/ValueRange{}, resultTensor,
+                                  indexingMaps, iteratorTypes, sampleBody)
             .getResult(0);
+    if (inputRank == 1)
+      finalResultTensor = tensor::CollapseShapeOp::create(
+          rewriter, loc, finalResultTensor,
+          ArrayRef<ReassociationIndices>{{0, 1}});
 
     Type newResultType = getTypeConverter()->convertType(op.getType());
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType,
@@ -509,12 +561,12 @@ public:
 
 void mlir::torch::torch_to_linalg::populateRandomPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
-    ConversionTarget &target) {
+    ConversionTarget &target, RandomAlgorithm algorithm) {
   MLIRContext *context = patterns.getContext();
   target.addIllegalOp<AtenDropoutOp>();
   patterns.add<ConvertAtenDropoutOp>(typeConverter, context);
   target.addIllegalOp<AtenUniformOp>();
-  patterns.add<ConvertAtenUniformOp>(typeConverter, context);
+  patterns.add<ConvertAtenUniformOp>(typeConverter, context, algorithm);
   target.addIllegalOp<AtenMultinomialOp>();
   patterns.add<ConvertAtenMultinomialOp>(typeConverter, context);
 }
@@ -38,12 +38,17 @@ namespace {
 // value. It is initialized to 0 and is resulting integer type.
 //
 // The indexed_generic op updates both the maximum (minimum) value and index
-// if the current value exceeds the running max (min).
+// if the current value exceeds the running max (min), or is the first NaN.
+//
+// With a split reduction factor, a static reduced dim long enough is split
+// into chunks that are reduced in parallel, and the values and indices found
+// for the chunks are reduced the same way by a second op.
 template <typename OpTy>
 class ConvertAtenMinMaxDimOp : public OpConversionPattern<OpTy> {
 
 private:
   bool allowNonFinites;
+  int64_t splitReductionFactor;
 
 public:
   using OpConversionPattern<OpTy>::OpConversionPattern;
@@ -52,9 +57,10 @@ public:
   using OpAdaptor = typename OpTy::Adaptor;
 
   ConvertAtenMinMaxDimOp(TypeConverter &typeConverter, MLIRContext *context,
-                         bool allowNonFinites)
+                         bool allowNonFinites, int64_t splitReductionFactor)
       : OpConversionPattern<OpTy>(typeConverter, context),
-        allowNonFinites(allowNonFinites) {}
+        allowNonFinites(allowNonFinites),
+        splitReductionFactor(splitReductionFactor) {}
 
   LogicalResult
   matchAndRewrite(OpTy op, OpAdaptor adaptor,
@@ -105,22 +111,6 @@ public:
       }
     }
 
-    // Constant op to account for the reduction along dim.
-    SmallVector<Value> resultShape;
-    for (int64_t i = 0; i < inputType.getRank(); i++) {
-      if (dim != i) {
-        auto currentDimSize = tensor::DimOp::create(rewriter, loc, input, i);
-        resultShape.push_back(currentDimSize);
-      }
-    }
-    // First fill the output buffer for the index.
-    Value filledTensorIdx =
-        createZeroInitTensor(rewriter, loc, resultShape, idxElementType);
-
-    // Second fill the output buffer for the running max or min.
-    Value initTensorVal = tensor::EmptyOp::create(
-        rewriter, loc, getAsOpFoldResult(resultShape), inElementType);
-
     Value fillValue;
     if (isa<mlir::FloatType>(inElementType)) {
       fillValue = arith::ConstantOp::create(
@@ -142,90 +132,169 @@ public:
           rewriter, loc, rewriter.getIntegerAttr(inElementType, init));
     }
 
-    Value filledTensorVal =
-        linalg::FillOp::create(rewriter, loc, fillValue, initTensorVal)
-            .result();
-
-    SmallVector<utils::IteratorType> iteratorTypes(
-        inputType.getRank(), utils::IteratorType::parallel);
-    iteratorTypes[dim] = utils::IteratorType::reduction;
-
-    // Create the affine expressions that will be used to
-    // iterate over the input and output tensors.
-    // Here we also set the type of iterator: parallel or reduction.
-
-    SmallVector<AffineExpr> exprs;
-    SmallVector<AffineExpr> resultExprs;
-    for (auto size :
-         llvm::enumerate(makeShapeTorchCompatible(inputType.getShape()))) {
-      exprs.push_back(rewriter.getAffineDimExpr(size.index()));
-      if (unsigned(dim) != size.index())
-        resultExprs.push_back(rewriter.getAffineDimExpr(size.index()));
-    }
+    // Reduces `values` along `reductionDim` into the running max (min) and
+    // its index in a single pass. The index of an element is its position
+    // along `reductionDim`, plus `chunkSize` times its position along the
+    // previous dim when the reduced dim was split into chunks, or is read
+    // from `indices` when combining the results of the chunks.
+    auto reduceAlongDim = [&](Value values, Value indices,
+                              int64_t reductionDim, int64_t chunkSize) {
+      int64_t rank = cast<RankedTensorType>(values.getType()).getRank();
+      SmallVector<Value> resultShape;
+      SmallVector<AffineExpr> exprs, resultExprs;
+      for (int64_t i = 0; i < rank; i++) {
+        exprs.push_back(rewriter.getAffineDimExpr(i));
+        if (i == reductionDim)
+          continue;
+        resultShape.push_back(tensor::DimOp::create(rewriter, loc, values, i));
+        resultExprs.push_back(rewriter.getAffineDimExpr(i));
+      }
+      Value filledTensorIdx =
+          createZeroInitTensor(rewriter, loc, resultShape, idxElementType);
+      Value initTensorVal = tensor::EmptyOp::create(
+          rewriter, loc, getAsOpFoldResult(resultShape), inElementType);
+      Value filledTensorVal =
+          linalg::FillOp::create(rewriter, loc, fillValue, initTensorVal)
+              .result();
+
+      SmallVector<utils::IteratorType> iteratorTypes(
+          rank, utils::IteratorType::parallel);
+      iteratorTypes[reductionDim] = utils::IteratorType::reduction;
+      SmallVector<Value> inputs = {values};
+      SmallVector<AffineMap> maps = {
+          AffineMap::get(rank, 0, exprs, rewriter.getContext())};
+      if (indices) {
+        inputs.push_back(indices);
+        maps.push_back(maps.front());
+      }
+      maps.append(2, AffineMap::get(rank, 0, resultExprs,
+                                    rewriter.getContext()));
 
-    auto maps = AffineMap::inferFromExprList({exprs, resultExprs, resultExprs},
-                                             rewriter.getContext());
-    auto linalgOp = linalg::GenericOp::create(
-        rewriter, loc,
-        ArrayRef<Type>({filledTensorVal.getType(), filledTensorIdx.getType()}),
-        input, ValueRange({filledTensorVal, filledTensorIdx}), maps,
-        iteratorTypes,
-        [&](OpBuilder &nestedBuilder, Location nestedLoc,
-            ValueRange blockArgs) {
-          Value newValue = blockArgs[0];
-          Value oldValue = blockArgs[1];
-          Value oldIndex = blockArgs[2];
-
-          Value newIndex = arith::IndexCastOp::create(
-              rewriter, nestedLoc, oldIndex.getType(),
-              linalg::IndexOp::create(rewriter, loc, dim));
-
-          Value resultVal, predicate;
-          if (isa<mlir::FloatType>(inElementType)) {
-            arith::CmpFPredicate predType;
-            if (isMax) {
-              predType = arith::CmpFPredicate::OGT;
-              resultVal = arith::MaximumFOp::create(rewriter, nestedLoc,
-                                                    newValue, oldValue);
+      return linalg::GenericOp::create(
+          rewriter, loc,
+          ArrayRef<Type>(
+              {filledTensorVal.getType(), filledTensorIdx.getType()}),
+          inputs, ValueRange({filledTensorVal, filledTensorIdx}), maps,
+          iteratorTypes,
+          [&](OpBuilder &nestedBuilder, Location nestedLoc,
+              ValueRange blockArgs) {
+            Value newValue = blockArgs[0];
+            Value oldValue = blockArgs[blockArgs.size() - 2];
+            Value oldIndex = blockArgs.back();
+
+            Value newIndex;
+            if (indices) {
+              newIndex = blockArgs[1];
             } else {
-              predType = arith::CmpFPredicate::OLT;
-              resultVal = arith::MinimumFOp::create(rewriter, nestedLoc,
-                                                    newValue, oldValue);
+              newIndex =
+                  linalg::IndexOp::create(nestedBuilder, nestedLoc,
+                                          reductionDim);
+              if (chunkSize) {
+                Value chunk = linalg::IndexOp::create(
+                    nestedBuilder, nestedLoc, reductionDim - 1);
+                Value offset = arith::MulIOp::create(
+                    nestedBuilder, nestedLoc, chunk,
+                    arith::ConstantIndexOp::create(nestedBuilder, nestedLoc,
+                                                   chunkSize));
+                newIndex = arith::AddIOp::create(nestedBuilder, nestedLoc,
+                                                 offset, newIndex);
+              }
+              newIndex = arith::IndexCastOp::create(
+                  nestedBuilder, nestedLoc, oldIndex.getType(), newIndex);
             }
 
-            predicate = arith::CmpFOp::create(rewriter, nestedLoc, predType,
-                                              newValue, oldValue);
-          } else {
-            arith::CmpIPredicate predType;
-            if (isMax) {
-              predType = isUnsigned ? arith::CmpIPredicate::ugt
-                                    : arith::CmpIPredicate::sgt;
-              if (isUnsigned) {
-                resultVal = arith::MaxUIOp::create(rewriter, nestedLoc,
-                                                   newValue, oldValue);
+            Value resultVal, predicate;
+            if (isa<mlir::FloatType>(inElementType)) {
+              arith::CmpFPredicate predType;
+              if (isMax) {
+                predType = arith::CmpFPredicate::UGT;
+                resultVal = arith::MaximumFOp::create(
+                    nestedBuilder, nestedLoc, newValue, oldValue);
               } else {
-                resultVal = arith::MaxSIOp::create(rewriter, nestedLoc,
-                                                   newValue, oldValue);
+                predType = arith::CmpFPredicate::ULT;
+                resultVal = arith::MinimumFOp::create(
+                    nestedBuilder, nestedLoc, newValue, oldValue);
               }
+
+              // Ties keep the first index, and so does a NaN, which the
+              // value propagates: the index moves to an element that
+              // compares greater (less) or is NaN, unless the running value
+              // is already NaN.
+              predicate = arith::CmpFOp::create(nestedBuilder, nestedLoc,
+                                                predType, newValue, oldValue);
+              Value oldIsNotNan =
+                  arith::CmpFOp::create(nestedBuilder, nestedLoc,
+                                        arith::CmpFPredicate::ORD, oldValue,
+                                        oldValue);
+              predicate = arith::AndIOp::create(nestedBuilder, nestedLoc,
+                                                predicate, oldIsNotNan);
             } else {
-              predType = isUnsigned ? arith::CmpIPredicate::ult
-                                    : arith::CmpIPredicate::slt;
-              if (isUnsigned) {
-                resultVal = arith::MinUIOp::create(rewriter, nestedLoc,
-                                                   newValue, oldValue);
+              arith::CmpIPredicate predType;
+              if (isMax) {
+                predType = isUnsigned ? arith::CmpIPredicate::ugt
+                                      : arith::CmpIPredicate::sgt;
+                if (isUnsigned) {
+                  resultVal = arith::MaxUIOp::create(nestedBuilder, nestedLoc,
+                                                     newValue, oldValue);
+                } else {
+                  resultVal = arith::MaxSIOp::create(nestedBuilder, nestedLoc,
+                                                     newValue, oldValue);
+                }
               } else {
-                resultVal = arith::MinSIOp::create(rewriter, nestedLoc,
-                                                   newValue, oldValue);
+                predType = isUnsigned ? arith::CmpIPredicate::ult
+                                      : arith::CmpIPredicate::slt;
+                if (isUnsigned) {
+                  resultVal = arith::MinUIOp::create(nestedBuilder, nestedLoc,
+                                                     newValue, oldValue);
+                } else {
+                  resultVal = arith::MinSIOp::create(nestedBuilder, nestedLoc,
+                                                     newValue, oldValue);
+                }
               }
+              predicate = arith::CmpIOp::create(nestedBuilder, nestedLoc,
+                                                predType, newValue, oldValue);
             }
-            predicate = arith::CmpIOp::create(rewriter, nestedLoc, predType,
-                                              newValue, oldValue);
-          }
-          auto resultIndex = arith::SelectOp::create(
-              rewriter, nestedLoc, predicate, newIndex, oldIndex);
-          linalg::YieldOp::create(nestedBuilder, nestedLoc,
-                                  ValueRange({resultVal, resultIndex}));
-        });
+            auto resultIndex = arith::SelectOp::create(
+                nestedBuilder, nestedLoc, predicate, newIndex, oldIndex);
+            linalg::YieldOp::create(nestedBuilder, nestedLoc,
+                                    ValueRange({resultVal, resultIndex}));
+          });
+    };
+
+    // Rows too long for the parallel dims to keep all cores busy, such as
+    // the vocabulary-sized rows of greedy decoding, are reduced in chunks
+    // that run in parallel and whose results are combined in a second pass.
+    int64_t reducedSize = inputType.getDimSize(dim);
+    bool split = splitReductionFactor >= 2 && inputType.hasStaticShape() &&
+                 reducedSize / splitReductionFactor >= 2 &&
+                 reducedSize % splitReductionFactor == 0 &&
+                 inputType.getNumElements() / reducedSize <
+                     splitReductionFactor;
+    linalg::GenericOp linalgOp;
+    if (split) {
+      int64_t chunkSize = reducedSize / splitReductionFactor;
+      SmallVector<int64_t> splitShape(inputType.getShape());
+      splitShape[dim] = chunkSize;
+      splitShape.insert(splitShape.begin() + dim, splitReductionFactor);
+      SmallVector<ReassociationIndices> reassociation;
+      for (int64_t i = 0; i < inputType.getRank(); i++) {
+        if (i < dim)
+          reassociation.push_back({i});
+        else if (i == dim)
+          reassociation.push_back({i, i + 1});
+        else
+          reassociation.push_back({i + 1});
+      }
+      Value chunks = tensor::ExpandShapeOp::create(
+          rewriter, loc, RankedTensorType::get(splitShape, inElementType),
+          input, reassociation);
+      linalg::GenericOp partial =
+          reduceAlongDim(chunks, Value(), dim + 1, chunkSize);
+      linalgOp = reduceAlongDim(partial.getResult(0), partial.getResult(1),
+                                dim, /*chunkSize=*/0);
+    } else {
+      linalgOp = reduceAlongDim(input, Value(), dim, /*chunkSize=*/0);
+    }
 
     if (!keepDim) {
       Value rVal = tensor::CastOp::create(rewriter, loc, valResultType,
@@ -457,10 +526,26 @@ static Value createLinalgPayloadForReduceOp(OpBuilder &b, Location loc,
   return nullptr;
 }
 
+// Combines two partial results of a reduction produced by the payload above.
+static Value createLinalgPayloadForCombiningReduceOp(OpBuilder &b, Location loc,
+                                                     ValueRange payloadArgs,
+                                                     Operation *op,
+                                                     ArrayRef<Value> operands,
+                                                     Type resultElementType) {
+  // The partial results of norms are sums of powers.
+  if (isa<AtenNormScalarOp, AtenLinalgVectorNormOp, AtenFrobeniusNormDimOp>(op))
+    return arith::AddFOp::create(b, loc, payloadArgs[0], payloadArgs[1]);
+  // Every other reduction combines its partial results the way it combines
+  // elements.
+  return createLinalgPayloadForReduceOp(b, loc, payloadArgs, op, operands,
+                                        resultElementType);
+}
+
 namespace {
 class ConvertReductionOp : public ConversionPattern {
 private:
   bool allowNonFinites;
+  int64_t splitReductionFactor;
 
   /// Given a reduction operation that has the `keepdim` attribute and the
   /// (optional) `dim` attribute, return the source tensor operand and the
@@ -724,6 +809,97 @@ private:
     return err ? Value{} : reduceOp;
   }
 
+  /// Generate a reduction in two stages: `splitReductionFactor` partial
+  /// reductions over chunks of the reduced dims, which run in parallel, then
+  /// one reduction of the partial results. This is only done for reductions
+  /// of a static extent that is a multiple of the factor, over trailing dims,
+  /// to fewer values than the factor. Returns failure otherwise.
+  FailureOr<Value>
+  createSplitReductionOp(Location loc, Type elemType, Operation *op,
+                         ArrayRef<Value> operands,
+                         const torch_to_linalg::ReductionOpInfo &opInfo,
+                         ConversionPatternRewriter &rewriter) const {
+    Value input = opInfo.tensorOperand;
+    auto inputType = cast<RankedTensorType>(input.getType());
+    int64_t rank = inputType.getRank();
+    int64_t numParallel = rank - opInfo.dimSet.size();
+    if (splitReductionFactor < 2 || numParallel == rank)
+      return failure();
+    int64_t parallelSize = 1, reducedSize = 1;
+    for (int64_t i = 0; i < rank; ++i) {
+      int64_t size = inputType.getDimSize(i);
+      bool isReduced = opInfo.dimSet.contains(i);
+      if (isReduced != (i >= numParallel) || ShapedType::isDynamic(size))
+        return failure();
+      (isReduced ? reducedSize : parallelSize) *= size;
+    }
+    if (parallelSize >= splitReductionFactor ||
+        reducedSize % splitReductionFactor != 0 ||
+        reducedSize / splitReductionFactor < 2)
+      return failure();
+
+    // Collapse the reduced dims and split them into
+    // [splitReductionFactor, reducedSize / splitReductionFactor].
+    SmallVector<ReassociationIndices> reassociation;
+    for (int64_t i = 0; i < numParallel; ++i)
+      reassociation.push_back({i});
+    ReassociationIndices reduced =
+        llvm::to_vector(llvm::seq<int64_t>(numParallel, rank));
+    if (reduced.size() > 1) {
+      reassociation.push_back(reduced);
+      input = tensor::CollapseShapeOp::create(rewriter, loc, input,
+                                              reassociation);
+      reassociation.pop_back();
+    }
+    SmallVector<int64_t> splitShape(
+        inputType.getShape().take_front(numParallel));
+    splitShape.push_back(splitReductionFactor);
+    splitShape.push_back(reducedSize / splitReductionFactor);
+    reassociation.push_back({numParallel, numParallel + 1});
+    input = tensor::ExpandShapeOp::create(
+        rewriter, loc,
+        RankedTensorType::get(splitShape, inputType.getElementType()), input,
+        reassociation);
+    reassociation.pop_back();
+
+    bool err = false;
+    auto createStage = [&](Value tensor, int64_t dim, auto createPayload) {
+      auto bodyBuilder = [&](OpBuilder &builder, Location loc,
+                             ValueRange payloadArgs) {
+        Value result =
+            createPayload(builder, loc, payloadArgs, op, operands, elemType);
+        if (result)
+          linalg::YieldOp::create(builder, loc, result);
+        err |= !result;
+      };
+      Value initElem = createInitElementForReduceOp(
+          rewriter, loc, op, elemType, this->allowNonFinites);
+      torch_to_linalg::ReductionOpInfo stageInfo{false, tensor, {dim}};
+      return torch_to_linalg::createReductionLinalgGeneric(
+          rewriter, loc, stageInfo, initElem, bodyBuilder);
+    };
+    Value partials = createStage(input, numParallel + 1,
+                                 createLinalgPayloadForReduceOp);
+    Value result = createStage(partials, numParallel,
+                               createLinalgPayloadForCombiningReduceOp);
+    if (err)
+      return failure();
+
+    if (!opInfo.keepDim)
+      return result;
+    // Add back the reduced dims as unit dims.
+    SmallVector<int64_t> keepDimShape(
+        inputType.getShape().take_front(numParallel));
+    keepDimShape.append(rank - numParallel, 1);
+    if (numParallel > 0) {
+      reassociation.back().append(reduced.begin(), reduced.end());
+    }
+    return tensor::ExpandShapeOp::create(
+               rewriter, loc, RankedTensorType::get(keepDimShape, elemType),
+               result, reassociation)
+        .getResult();
+  }
+
   /// Depending on the operation, check validity of the result's element type.
   LogicalResult
   validateReductionElementType(Operation *op, Type elemType,
@@ -743,10 +919,11 @@ private:
 
 public:
   ConvertReductionOp(TypeConverter &typeConverter, MLIRContext *context,
-                     bool allowNonFinites)
+                     bool allowNonFinites, int64_t splitReductionFactor)
       : ConversionPattern(typeConverter, MatchAnyOpTypeTag(), /*benefit=*/1,
                           context),
-        allowNonFinites(allowNonFinites) {}
+        allowNonFinites(allowNonFinites),
+        splitReductionFactor(splitReductionFactor) {}
 
   LogicalResult
   matchAndRewrite(Operation *op, ArrayRef<Value> operands,
@@ -769,8 +946,12 @@ public:
     if (failed(elemTypeCheck))
       return elemTypeCheck;
 
+    FailureOr<Value> splitReduceOp = createSplitReductionOp(
+        loc, elemType, op, operands, *opInfo, rewriter);
     Value reduceOp =
-        createReductionOp(loc, elemType, op, operands, *opInfo, rewriter);
+        succeeded(splitReduceOp)
+            ? *splitReduceOp
+            : createReductionOp(loc, elemType, op, operands, *opInfo, rewriter);
     if (!reduceOp)
       return rewriter.notifyMatchFailure(
           op, "failed to create linalg.generic operation for reduction");
@@ -812,16 +993,474 @@ public:
 };
 } // namespace
 
+namespace {
+// Lowers softmax and log_softmax, when the backend keeps them legal, in two
+// passes over the input instead of the four of their decomposition. The first
+// pass reduces each row to its max `m` and to `s = sum(exp(x - m))`, updating
+// `s` online whenever the max grows. The second pass computes
+// `exp(x - m) / s`, or `x - (m + log(s))` for log_softmax. Only the per-row
+// statistics are materialized in between.
+//
+// The max starts at the lowest finite value rather than -inf, so that rows
+// starting with -inf do not poison the running sum with -inf - -inf.
+template <typename OpTy>
+class ConvertAtenSoftmaxOp : public OpConversionPattern<OpTy> {
+public:
+  using OpConversionPattern<OpTy>::OpConversionPattern;
+  using OpAdaptor = typename OpTy::Adaptor;
+
+  LogicalResult
+  matchAndRewrite(OpTy op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    constexpr bool isLogSoftmax =
+        llvm::is_one_of<OpTy, AtenLogSoftmaxIntOp, Aten_LogSoftmaxOp>::value;
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+
+    Location loc = op.getLoc();
+    Value input = adaptor.getSelf();
+    auto inputType = cast<RankedTensorType>(input.getType());
+    auto resultType = cast<RankedTensorType>(
+        this->getTypeConverter()->convertType(op.getType()));
+    if (!isa<mlir::FloatType>(inputType.getElementType()) ||
+        !isa<mlir::FloatType>(resultType.getElementType()))
+      return rewriter.notifyMatchFailure(op, "only float types supported");
+
+    int64_t rank = inputType.getRank();
+    int64_t dim;
+    if (!matchPattern(op.getDim(), m_TorchConstantInt(&dim)))
+      return rewriter.notifyMatchFailure(op, "dim must be constant");
+    dim = toPositiveDim(dim, rank);
+    if (!isValidDim(dim, rank))
+      return rewriter.notifyMatchFailure(op, "dim is not a valid dim");
+
+    // The result type already reflects `dtype` and `half_to_float`; the
+    // statistics are kept in the accumulator type for it.
+    Type accType = getDefaultAccType(rewriter, resultType.getElementType());
+    auto accFloatType = cast<mlir::FloatType>(accType);
+
+    SmallVector<Value> sizes = getTensorSizes(rewriter, loc, input);
+    SmallVector<Value> rowSizes(sizes);
+    rowSizes.erase(rowSizes.begin() + dim);
+    SmallVector<AffineExpr> rowExprs;
+    for (int64_t i = 0; i < rank; ++i)
+      if (i != dim)
+        rowExprs.push_back(rewriter.getAffineDimExpr(i));
+    AffineMap identityMap = rewriter.getMultiDimIdentityMap(rank);
+    AffineMap rowMap =
+        AffineMap::get(rank, /*symbolCount=*/0, rowExprs, op.getContext());
+
+    Value lowest = arith::ConstantOp::create(
+        rewriter, loc,
+        rewriter.getFloatAttr(
+            accType, APFloat::getLargest(accFloatType.getFloatSemantics(),
+                                         /*Negative=*/true)));
+    Value rowEmpty = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(rowSizes), accType);
+    Value maxInit =
+        linalg::FillOp::create(rewriter, loc, lowest, rowEmpty).result();
+    Value sumInit = createZeroInitTensor(rewriter, loc, rowSizes, accType);
+
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::parallel);
+    iteratorTypes[dim] = utils::IteratorType::reduction;
+    auto stats = linalg::GenericOp::create(
+        rewriter, loc, TypeRange{maxInit.getType(), sumInit.getType()}, input,
+        ValueRange{maxInit, sumInit},
+        ArrayRef<AffineMap>{identityMap, rowMap, rowMap}, iteratorTypes,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value x = convertScalarToDtype(b, loc, args[0], accType);
+          Value max = args[1], sum = args[2];
+          // With e = exp(-|x - max|), a new max rescales the sum by e and
+          // adds 1, otherwise the sum grows by e.
+          Value diff = arith::SubFOp::create(b, loc, x, max);
+          Value absDiff = math::AbsFOp::create(b, loc, diff);
+          Value e = math::ExpOp::create(
+              b, loc, arith::NegFOp::create(b, loc, absDiff));
+          Value isNewMax = arith::CmpFOp::create(
+              b, loc, arith::CmpFPredicate::OGT, x, max);
+          Value one = arith::ConstantOp::create(
+              b, loc, b.getFloatAttr(accType, 1.0));
+          Value rescaled = arith::AddFOp::create(
+              b, loc, arith::MulFOp::create(b, loc, sum, e), one);
+          Value grown = arith::AddFOp::create(b, loc, sum, e);
+          Value newSum =
+              arith::SelectOp::create(b, loc, isNewMax, rescaled, grown);
+          Value newMax = arith::MaximumFOp::create(b, loc, x, max);
+          linalg::YieldOp::create(b, loc, ValueRange{newMax, newSum});
+        });
+    Value rowMax = stats.getResult(0);
+    Value rowSum = stats.getResult(1);
+
+    SmallVector<utils::IteratorType> parallel(rank,
+                                              utils::IteratorType::parallel);
+    Value resultEmpty = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(sizes), resultType.getElementType());
+    Value result;
+    if constexpr (isLogSoftmax) {
+      // Fold the max and log of the sum into one offset per row.
+      SmallVector<utils::IteratorType> rowParallel(
+          rank - 1, utils::IteratorType::parallel);
+      AffineMap rowIdentityMap = rewriter.getMultiDimIdentityMap(rank - 1);
+      Value offset =
+          linalg::GenericOp::create(
+              rewriter, loc, rowEmpty.getType(), ValueRange{rowMax, rowSum},
+              rowEmpty,
+              ArrayRef<AffineMap>{rowIdentityMap, rowIdentityMap,
+                                  rowIdentityMap},
+              rowParallel,
+              [&](OpBuilder &b, Location loc, ValueRange args) {
+                Value logSum = math::LogOp::create(b, loc, args[1]);
+                linalg::YieldOp::create(
+                    b, loc, arith::AddFOp::create(b, loc, args[0], logSum)
+                                .getResult());
+              })
+              .getResult(0);
+      result = linalg::GenericOp::create(
+                   rewriter, loc, resultEmpty.getType(),
+                   ValueRange{input, offset}, resultEmpty,
+                   ArrayRef<AffineMap>{identityMap, rowMap, identityMap},
+                   parallel,
+                   [&](OpBuilder &b, Location loc, ValueRange args) {
+                     Value x = convertScalarToDtype(b, loc, args[0], accType);
+                     Value value = arith::SubFOp::create(b, loc, x, args[1]);
+                     Type resultElemType = args[2].getType();
+                     linalg::YieldOp::create(
+                         b, loc,
+                         convertScalarToDtype(b, loc, value, resultElemType));
+                   })
+                   .getResult(0);
+    } else {
+      result = linalg::GenericOp::create(
+                   rewriter, loc, resultEmpty.getType(),
+                   ValueRange{input, rowMax, rowSum}, resultEmpty,
+                   ArrayRef<AffineMap>{identityMap, rowMap, rowMap,
+                                       identityMap},
+                   parallel,
+                   [&](OpBuilder &b, Location loc, ValueRange args) {
+                     Value x = convertScalarToDtype(b, loc, args[0], accType);
+                     Value e = math::ExpOp::create(
+                         b, loc, arith::SubFOp::create(b, loc, x, args[1]));
+                     Value value = arith::DivFOp::create(b, loc, e, args[2]);
+                     Type resultElemType = args[3].getType();
+                     linalg::YieldOp::create(
+                         b, loc,
+                         convertScalarToDtype(b, loc, value, resultElemType));
+                   })
+                   .getResult(0);
+    }
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
+    return success();
+  }
+};
+} // namespace
+
+// Returns the map from the loops of a rank `rank` normalization to the
+// `numDims` leading (per-row) or trailing (per-element of the row) dims.
+static AffineMap getNormalizationMap(int64_t rank, int64_t numDims,
+                                     bool leading, MLIRContext *context) {
+  SmallVector<AffineExpr> exprs;
+  int64_t first = leading ? 0 : rank - numDims;
+  for (int64_t i = first; i < first + numDims; ++i)
+    exprs.push_back(getAffineDimExpr(i, context));
+  return AffineMap::get(rank, /*symbolCount=*/0, exprs, context);
+}
+
+// Reshapes a row statistic to the keepdim shape the ATen op returns.
+static Value expandRowStatistic(OpBuilder &b, Location loc, Value row,
+                                RankedTensorType resultType, int64_t axis) {
+  SmallVector<ReassociationIndices> reassociation;
+  for (int64_t i = 0; i < axis; ++i)
+    reassociation.push_back({i});
+  if (axis > 0) {
+    for (int64_t i = axis; i < resultType.getRank(); ++i)
+      reassociation.back().push_back(i);
+  }
+  auto expandedType = RankedTensorType::get(
+      resultType.getShape(), getElementTypeOrSelf(row.getType()));
+  Value expanded =
+      tensor::ExpandShapeOp::create(b, loc, expandedType, row, reassociation);
+  return convertTensorToElementType(b, loc, expanded,
+                                    resultType.getElementType());
+}
+
+// Returns the number of elements normalized together, in `accType`.
+static Value getNormalizedElementCount(OpBuilder &b, Location loc,
+                                       ArrayRef<Value> sizes, int64_t axis,
+                                       Type accType) {
+  Value count = arith::ConstantIndexOp::create(b, loc, 1);
+  for (Value size : sizes.drop_front(axis))
+    count = arith::MulIOp::create(b, loc, count, size);
+  count = arith::IndexCastOp::create(b, loc, b.getI64Type(), count);
+  return arith::SIToFPOp::create(b, loc, accType, count);
+}
+
+namespace {
+// Lowers aten.native_layer_norm, when the backend keeps it legal, in two
+// passes over the input. A Welford reduction computes the mean and the sum of
+// squared deviations of each row in one read, and an epilogue applies the
+// normalization together with the weight and bias.
+class ConvertAtenNativeLayerNormOp
+    : public OpConversionPattern<AtenNativeLayerNormOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenNativeLayerNormOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    MLIRContext *context = op.getContext();
+    Value input = adaptor.getInput();
+    auto inputType = cast<RankedTensorType>(input.getType());
+    SmallVector<RankedTensorType> resultTypes;
+    for (Type type : op.getResultTypes())
+      resultTypes.push_back(
+          cast<RankedTensorType>(getTypeConverter()->convertType(type)));
+    if (!isa<mlir::FloatType>(inputType.getElementType()) ||
+        !llvm::all_of(resultTypes, [](RankedTensorType type) {
+          return isa<mlir::FloatType>(type.getElementType());
+        }))
+      return rewriter.notifyMatchFailure(op, "only float types supported");
+
+    SmallVector<Value> normalizedShape;
+    if (!getListConstructElements(op.getNormalizedShape(), normalizedShape))
+      return rewriter.notifyMatchFailure(
+          op, "normalized_shape must be a list construct");
+    int64_t rank = inputType.getRank();
+    int64_t numNormalized = normalizedShape.size();
+    int64_t axis = rank - numNormalized;
+    if (numNormalized == 0 || axis < 0)
+      return rewriter.notifyMatchFailure(op, "invalid normalized_shape");
+    Value weight = adaptor.getWeight();
+    Value bias = adaptor.getBias();
+    bool hasWeight = !isa<Torch::NoneType>(op.getWeight().getType());
+    bool hasBias = !isa<Torch::NoneType>(op.getBias().getType());
+
+    Type accType =
+        getDefaultAccType(rewriter, resultTypes[0].getElementType());
+    SmallVector<Value> sizes = getTensorSizes(rewriter, loc, input);
+    SmallVector<Value> rowSizes(sizes.begin(), sizes.begin() + axis);
+    AffineMap identityMap = rewriter.getMultiDimIdentityMap(rank);
+    AffineMap rowMap =
+        getNormalizationMap(rank, axis, /*leading=*/true, context);
+    AffineMap trailingMap =
+        getNormalizationMap(rank, numNormalized, /*leading=*/false, context);
+
+    // Welford: with n the count so far, delta = x - mean,
+    // mean += delta / n and m2 += delta * (x - mean).
+    Value countInit =
+        createZeroInitTensor(rewriter, loc, rowSizes, rewriter.getI64Type());
+    Value meanInit = createZeroInitTensor(rewriter, loc, rowSizes, accType);
+    Value m2Init = createZeroInitTensor(rewriter, loc, rowSizes, accType);
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::parallel);
+    for (int64_t i = axis; i < rank; ++i)
+      iteratorTypes[i] = utils::IteratorType::reduction;
+    auto stats = linalg::GenericOp::create(
+        rewriter, loc,
+        TypeRange{countInit.getType(), meanInit.getType(), m2Init.getType()},
+        input, ValueRange{countInit, meanInit, m2Init},
+        ArrayRef<AffineMap>{identityMap, rowMap, rowMap, rowMap},
+        iteratorTypes, [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value x = convertScalarToDtype(b, loc, args[0], accType);
+          Value one =
+              arith::ConstantOp::create(b, loc, b.getI64IntegerAttr(1));
+          Value count = arith::AddIOp::create(b, loc, args[1], one);
+          Value countFloat = arith::SIToFPOp::create(b, loc, accType, count);
+          Value delta = arith::SubFOp::create(b, loc, x, args[2]);
+          Value mean = arith::AddFOp::create(
+              b, loc, args[2],
+              arith::DivFOp::create(b, loc, delta, countFloat));
+          Value m2 = arith::AddFOp::create(
+              b, loc, args[3],
+              arith::MulFOp::create(
+                  b, loc, delta, arith::SubFOp::create(b, loc, x, mean)));
+          linalg::YieldOp::create(b, loc, ValueRange{count, mean, m2});
+        });
+    Value rowMean = stats.getResult(1);
+    Value rowM2 = stats.getResult(2);
+
+    // rstd = rsqrt(m2 / N + eps), once per row.
+    Value numElements =
+        getNormalizedElementCount(rewriter, loc, sizes, axis, accType);
+    Value eps = convertScalarToDtype(rewriter, loc, adaptor.getEps(), accType);
+    Value rowEmpty = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(rowSizes), accType);
+    AffineMap rowIdentityMap = rewriter.getMultiDimIdentityMap(axis);
+    Value rowRstd =
+        linalg::GenericOp::create(
+            rewriter, loc, rowEmpty.getType(), rowM2, rowEmpty,
+            ArrayRef<AffineMap>{rowIdentityMap, rowIdentityMap},
+            SmallVector<utils::IteratorType>(axis,
+                                             utils::IteratorType::parallel),
+            [&](OpBuilder &b, Location loc, ValueRange args) {
+              Value var = arith::DivFOp::create(b, loc, args[0], numElements);
+              Value rstd = math::RsqrtOp::create(
+                  b, loc, arith::AddFOp::create(b, loc, var, eps));
+              linalg::YieldOp::create(b, loc, rstd);
+            })
+            .getResult(0);
+
+    SmallVector<Value> inputs{input, rowMean, rowRstd};
+    SmallVector<AffineMap> indexingMaps{identityMap, rowMap, rowMap};
+    if (hasWeight) {
+      inputs.push_back(weight);
+      indexingMaps.push_back(trailingMap);
+    }
+    if (hasBias) {
+      inputs.push_back(bias);
+      indexingMaps.push_back(trailingMap);
+    }
+    indexingMaps.push_back(identityMap);
+    Value outEmpty =
+        tensor::EmptyOp::create(rewriter, loc, getAsOpFoldResult(sizes),
+                                resultTypes[0].getElementType());
+    Value out =
+        linalg::GenericOp::create(
+            rewriter, loc, outEmpty.getType(), inputs, outEmpty, indexingMaps,
+            SmallVector<utils::IteratorType>(rank,
+                                             utils::IteratorType::parallel),
+            [&](OpBuilder &b, Location loc, ValueRange args) {
+              Value x = convertScalarToDtype(b, loc, args[0], accType);
+              Value value = arith::MulFOp::create(
+                  b, loc, arith::SubFOp::create(b, loc, x, args[1]), args[2]);
+              unsigned next = 3;
+              if (hasWeight)
+                value = arith::MulFOp::create(
+                    b, loc, value,
+                    convertScalarToDtype(b, loc, args[next++], accType));
+              if (hasBias)
+                value = arith::AddFOp::create(
+                    b, loc, value,
+                    convertScalarToDtype(b, loc, args[next++], accType));
+              linalg::YieldOp::create(
+                  b, loc,
+                  convertScalarToDtype(b, loc, value, args.back().getType()));
+            })
+            .getResult(0);
+
+    rewriter.replaceOp(
+        op, {tensor::CastOp::create(rewriter, loc, resultTypes[0], out),
+             expandRowStatistic(rewriter, loc, rowMean, resultTypes[1], axis),
+             expandRowStatistic(rewriter, loc, rowRstd, resultTypes[2], axis)});
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Lowers aten.rms_norm, when the backend keeps it legal, as one reduction of
+// the sum of squares per row and one epilogue applying rsqrt(mean + eps) and
+// the weight.
+class ConvertAtenRmsNormOp : public OpConversionPattern<AtenRmsNormOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenRmsNormOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
+      return failure();
+    Location loc = op.getLoc();
+    MLIRContext *context = op.getContext();
+    Value input = adaptor.getInput();
+    auto inputType = cast<RankedTensorType>(input.getType());
+    auto resultType = cast<RankedTensorType>(
+        getTypeConverter()->convertType(op.getType()));
+    if (!isa<mlir::FloatType>(inputType.getElementType()) ||
+        !isa<mlir::FloatType>(resultType.getElementType()))
+      return rewriter.notifyMatchFailure(op, "only float types supported");
+
+    SmallVector<Value> normalizedShape;
+    if (!getListConstructElements(op.getNormalizedShape(), normalizedShape))
+      return rewriter.notifyMatchFailure(
+          op, "normalized_shape must be a list construct");
+    int64_t rank = inputType.getRank();
+    int64_t numNormalized = normalizedShape.size();
+    int64_t axis = rank - numNormalized;
+    if (numNormalized == 0 || axis < 0)
+      return rewriter.notifyMatchFailure(op, "invalid normalized_shape");
+    bool hasWeight = !isa<Torch::NoneType>(op.getWeight().getType());
+    bool hasEps = !isa<Torch::NoneType>(op.getEps().getType());
+
+    Type accType = getDefaultAccType(rewriter, resultType.getElementType());
+    SmallVector<Value> sizes = getTensorSizes(rewriter, loc, input);
+    SmallVector<Value> rowSizes(sizes.begin(), sizes.begin() + axis);
+    AffineMap identityMap = rewriter.getMultiDimIdentityMap(rank);
+    AffineMap rowMap =
+        getNormalizationMap(rank, axis, /*leading=*/true, context);
+
+    Value sumInit = createZeroInitTensor(rewriter, loc, rowSizes, accType);
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::parallel);
+    for (int64_t i = axis; i < rank; ++i)
+      iteratorTypes[i] = utils::IteratorType::reduction;
+    Value rowSum =
+        linalg::GenericOp::create(
+            rewriter, loc, sumInit.getType(), input, sumInit,
+            ArrayRef<AffineMap>{identityMap, rowMap}, iteratorTypes,
+            [&](OpBuilder &b, Location loc, ValueRange args) {
+              Value x = convertScalarToDtype(b, loc, args[0], accType);
+              Value square = arith::MulFOp::create(b, loc, x, x);
+              linalg::YieldOp::create(
+                  b, loc,
+                  arith::AddFOp::create(b, loc, args[1], square).getResult());
+            })
+            .getResult(0);
+
+    Value numElements =
+        getNormalizedElementCount(rewriter, loc, sizes, axis, accType);
+    Value eps;
+    if (hasEps)
+      eps = convertScalarToDtype(rewriter, loc, adaptor.getEps(), accType);
+    SmallVector<Value> inputs{input, rowSum};
+    SmallVector<AffineMap> indexingMaps{identityMap, rowMap};
+    if (hasWeight) {
+      inputs.push_back(adaptor.getWeight());
+      indexingMaps.push_back(getNormalizationMap(rank, numNormalized,
+                                                 /*leading=*/false, context));
+    }
+    indexingMaps.push_back(identityMap);
+    Value outEmpty = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(sizes), resultType.getElementType());
+    Value out =
+        linalg::GenericOp::create(
+            rewriter, loc, outEmpty.getType(), inputs, outEmpty, indexingMaps,
+            SmallVector<utils::IteratorType>(rank,
+                                             utils::IteratorType::parallel),
+            [&](OpBuilder &b, Location loc, ValueRange args) {
+              Value x = convertScalarToDtype(b, loc, args[0], accType);
+              Value mean = arith::DivFOp::create(b, loc, args[1], numElements);
+              if (eps)
+                mean = arith::AddFOp::create(b, loc, mean, eps);
+              Value value = arith::MulFOp::create(
+                  b, loc, x, math::RsqrtOp::create(b, loc, mean));
+              if (hasWeight)
+                value = arith::MulFOp::create(
+                    b, loc, value,
+                    convertScalarToDtype(b, loc, args[2], accType));
+              linalg::YieldOp::create(
+                  b, loc,
+                  convertScalarToDtype(b, loc, value, args.back().getType()));
+            })
+            .getResult(0);
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, out);
+    return success();
+  }
+};
+} // namespace
+
 void mlir::torch::torch_to_linalg::populateReductionPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
-    ConversionTarget &target, bool allowNonFinites) {
+    ConversionTarget &target, bool allowNonFinites,
+    int64_t splitReductionFactor) {
   MLIRContext *context = patterns.getContext();
   target.addIllegalOp<AtenMaxDimOp>();
-  patterns.add<ConvertAtenMinMaxDimOp<AtenMaxDimOp>>(typeConverter, context,
-                                                     allowNonFinites);
+  patterns.add<ConvertAtenMinMaxDimOp<AtenMaxDimOp>>(
+      typeConverter, context, allowNonFinites, splitReductionFactor);
   target.addIllegalOp<AtenMinDimOp>();
-  patterns.add<ConvertAtenMinMaxDimOp<AtenMinDimOp>>(typeConverter, context,
-                                                     allowNonFinites);
+  patterns.add<ConvertAtenMinMaxDimOp<AtenMinDimOp>>(
+      typeConverter, context, allowNonFinites, splitReductionFactor);
   target.addIllegalOp<AtenSumOp>();
   target.addIllegalOp<AtenAnyOp>();
   target.addIllegalOp<AtenAnyDimOp>();
@@ -837,5 +1476,18 @@ void mlir::torch::torch_to_linalg::populateReductionPatternsAndLegality(
   target.addIllegalOp<AtenNormScalarOp>();
   target.addIllegalOp<AtenLinalgVectorNormOp>();
   target.addIllegalOp<AtenFrobeniusNormDimOp>();
-  patterns.add<ConvertReductionOp>(typeConverter, context, allowNonFinites);
+  patterns.add<ConvertReductionOp>(typeConverter, context, allowNonFinites,
+                                   splitReductionFactor);
+  // These and the normalizations below are only reached when the backend
+  // marks them legal during decomposition.
+  target.addIllegalOp<AtenSoftmaxIntOp, Aten_SoftmaxOp, AtenLogSoftmaxIntOp,
+                      Aten_LogSoftmaxOp>();
+  patterns.add<ConvertAtenSoftmaxOp<AtenSoftmaxIntOp>,
+               ConvertAtenSoftmaxOp<Aten_SoftmaxOp>,
+               ConvertAtenSoftmaxOp<AtenLogSoftmaxIntOp>,
+               ConvertAtenSoftmaxOp<Aten_LogSoftmaxOp>>(typeConverter,
+                                                         context);
+  target.addIllegalOp<AtenNativeLayerNormOp, AtenRmsNormOp>();
+  patterns.add<ConvertAtenNativeLayerNormOp, ConvertAtenRmsNormOp>(
+      typeConverter, context);
 }
@@ -0,0 +1,325 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir/Conversion/TorchToLinalg/TorchToLinalg.h"
+
+#include "PopulatePatterns.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/SparseTensor/IR/SparseTensor.h"
+#include "mlir/Dialect/SparseTensor/IR/SparseTensorType.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "torch-mlir/Conversion/Utils/Utils.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+// The kernels of this file are linalg.generic ops whose loop order follows the
+// storage order of their sparse operands, so that the sparsifier iterates the
+// stored entries directly instead of co-iterating them with a dense loop:
+// - rows outermost, as a parallel loop that the sparsifier's
+//   `parallelization-strategy` partitions;
+// - the compressed columns of a sparse operand next;
+// - the dense columns of the result innermost, contiguous in memory.
+
+// Whether `type` is a tensor of a sparse format that stores a matrix row by
+// row, such as CSR, DCSR or sorted COO, so that it is iterated best with the
+// row loop outside of the column loop.
+static bool isRowMajorSparse(Type type) {
+  auto tensorType = dyn_cast<RankedTensorType>(type);
+  if (!tensorType || tensorType.getRank() != 2 ||
+      !sparse_tensor::getSparseTensorEncoding(tensorType))
+    return false;
+  return sparse_tensor::SparseTensorType(tensorType).isIdentity();
+}
+
+static bool isSparse(Type type) {
+  return static_cast<bool>(sparse_tensor::getSparseTensorEncoding(type));
+}
+
+// Whether the kernels of this file support `elementType`, which they compute
+// in without widening.
+static bool isSupportedElementType(Type elementType) {
+  return isa<mlir::FloatType>(elementType) ||
+         (isa<mlir::IntegerType>(elementType) &&
+          elementType.getIntOrFloatBitWidth() > 1);
+}
+
+// Returns `acc + lhs * rhs` in the type of `acc`.
+static Value createMultiplyAdd(OpBuilder &b, Location loc, Value acc,
+                               Value lhs, Value rhs) {
+  if (isa<mlir::FloatType>(acc.getType()))
+    return arith::AddFOp::create(b, loc, acc,
+                                 arith::MulFOp::create(b, loc, lhs, rhs));
+  return arith::AddIOp::create(b, loc, acc,
+                               arith::MulIOp::create(b, loc, lhs, rhs));
+}
+
+// Creates the tensor that a kernel of `resultType` accumulates into: zeros
+// for a dense result, and an empty tensor, into which the sparsifier inserts
+// the computed entries, for a sparse one.
+static Value createAccumulator(OpBuilder &b, Location loc,
+                               RankedTensorType resultType,
+                               ArrayRef<Value> sizes) {
+  SmallVector<Value> dynamicSizes;
+  for (auto [dim, size] : llvm::enumerate(sizes)) {
+    if (resultType.isDynamicDim(dim))
+      dynamicSizes.push_back(size);
+  }
+  Value empty = tensor::EmptyOp::create(b, loc, resultType, dynamicSizes);
+  if (isSparse(resultType))
+    return empty;
+  Value zero = arith::ConstantOp::create(
+      b, loc, b.getZeroAttr(resultType.getElementType()));
+  return linalg::FillOp::create(b, loc, zero, empty).getResult(0);
+}
+
+// Asserts that the contracting dims of a matmul agree, unless the function
+// assumes strict symbolic shapes.
+static void assertContractingDimsEqual(OpBuilder &b, Location loc, Value lhs,
+                                       Value rhs, StringRef opName) {
+  if (isAssumingStrictSymbolicShapes(b))
+    return;
+  Value lhsDim1 = tensor::DimOp::create(b, loc, lhs, 1);
+  Value rhsDim0 = tensor::DimOp::create(b, loc, rhs, 0);
+  Value equal = arith::CmpIOp::create(b, loc, arith::CmpIPredicate::eq,
+                                      lhsDim1, rhsDim0);
+  cf::AssertOp::create(
+      b, loc, equal,
+      b.getStringAttr("mismatching contracting dimension for " + opName));
+}
+
+namespace {
+// Lowers the product of two matrices of which at least one is sparse to a
+// linalg.generic with loops (i, k, j): a CSR operand is then read row by row
+// with its stored entries in order, and each of them updates a contiguous row
+// of the result (Gustavson's algorithm). A sparse result is assembled row by
+// row in the same order.
+template <typename OpTy>
+class ConvertSparseMatmul : public OpConversionPattern<OpTy> {
+public:
+  using OpConversionPattern<OpTy>::OpConversionPattern;
+  using OpAdaptor = typename OpTy::Adaptor;
+  LogicalResult
+  matchAndRewrite(OpTy op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    Value lhs = adaptor.getOperands()[0];
+    Value rhs = adaptor.getOperands()[1];
+    auto lhsType = dyn_cast<RankedTensorType>(lhs.getType());
+    auto rhsType = dyn_cast<RankedTensorType>(rhs.getType());
+    auto resultType = dyn_cast_or_null<RankedTensorType>(
+        this->getTypeConverter()->convertType(op.getType()));
+    if (!lhsType || !rhsType || !resultType || lhsType.getRank() != 2 ||
+        rhsType.getRank() != 2 || resultType.getRank() != 2)
+      return rewriter.notifyMatchFailure(op, "not a product of matrices");
+    if (!isSparse(lhsType) && !isSparse(rhsType))
+      return rewriter.notifyMatchFailure(op, "no sparse operand");
+    // Other sparse formats, e.g. CSC, are left to the generic lowering, which
+    // lets the sparsifier pick a loop order.
+    if ((isSparse(lhsType) && !isRowMajorSparse(lhsType)) ||
+        (isSparse(rhsType) && !isRowMajorSparse(rhsType)) ||
+        (isSparse(resultType) && !isRowMajorSparse(resultType)))
+      return rewriter.notifyMatchFailure(op, "not a row-major sparse format");
+    Type elementType = resultType.getElementType();
+    if (lhsType.getElementType() != elementType ||
+        rhsType.getElementType() != elementType ||
+        !isSupportedElementType(elementType))
+      return rewriter.notifyMatchFailure(op, "unsupported element types");
+
+    assertContractingDimsEqual(rewriter, loc, lhs, rhs,
+                               op->getName().getStringRef());
+    Value lhsDim0 = tensor::DimOp::create(rewriter, loc, lhs, 0);
+    Value rhsDim1 = tensor::DimOp::create(rewriter, loc, rhs, 1);
+    Value accumulator =
+        createAccumulator(rewriter, loc, resultType, {lhsDim0, rhsDim1});
+
+    MLIRContext *context = rewriter.getContext();
+    AffineExpr i, k, j;
+    bindDims(context, i, k, j);
+    SmallVector<AffineMap> indexingMaps = {
+        AffineMap::get(3, 0, {i, k}, context),
+        AffineMap::get(3, 0, {k, j}, context),
+        AffineMap::get(3, 0, {i, j}, context)};
+    SmallVector<utils::IteratorType> iteratorTypes = {
+        utils::IteratorType::parallel, utils::IteratorType::reduction,
+        utils::IteratorType::parallel};
+    Value product =
+        linalg::GenericOp::create(
+            rewriter, loc, resultType, ValueRange{lhs, rhs}, accumulator,
+            indexingMaps, iteratorTypes,
+            [](OpBuilder &b, Location loc, ValueRange args) {
+              linalg::YieldOp::create(
+                  b, loc,
+                  createMultiplyAdd(b, loc, args[2], args[0], args[1]));
+            })
+            .getResult(0);
+    rewriter.replaceOp(op, product);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Lowers the product of a sparse matrix S and the product of two dense
+// matrices, `S * (A @ B)`, to one linalg.generic that only computes the dot
+// products at the stored entries of S (SDDMM), instead of the whole dense
+// product. The dense product is left to its own lowering, and dropped as dead
+// code unless it has other users.
+class ConvertSampledDenseDenseMatmul
+    : public OpConversionPattern<AtenMulTensorOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenMulTensorOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Value sample = adaptor.getSelf();
+    Operation *product = op.getOther().getDefiningOp();
+    if (!isRowMajorSparse(sample.getType())) {
+      sample = adaptor.getOther();
+      product = op.getSelf().getDefiningOp();
+    }
+    if (!isRowMajorSparse(sample.getType()) ||
+        !isa_and_nonnull<AtenMmOp, AtenMatmulOp>(product) ||
+        !product->hasOneUse())
+      return rewriter.notifyMatchFailure(op, "not a sampled matmul");
+    auto resultType = dyn_cast_or_null<RankedTensorType>(
+        getTypeConverter()->convertType(op.getType()));
+    if (!resultType || resultType != sample.getType())
+      return rewriter.notifyMatchFailure(op, "result is not sampled");
+
+    Value lhs = rewriter.getRemappedValue(product->getOperand(0));
+    Value rhs = rewriter.getRemappedValue(product->getOperand(1));
+    auto lhsType =
+        lhs ? dyn_cast<RankedTensorType>(lhs.getType()) : RankedTensorType();
+    auto rhsType =
+        rhs ? dyn_cast<RankedTensorType>(rhs.getType()) : RankedTensorType();
+    Type elementType = resultType.getElementType();
+    if (!lhsType || !rhsType || lhsType.getRank() != 2 ||
+        rhsType.getRank() != 2 || isSparse(lhsType) || isSparse(rhsType) ||
+        lhsType.getElementType() != elementType ||
+        rhsType.getElementType() != elementType ||
+        !isSupportedElementType(elementType))
+      return rewriter.notifyMatchFailure(op, "unsupported dense operands");
+
+    Location loc = op.getLoc();
+    assertContractingDimsEqual(rewriter, loc, lhs, rhs,
+                               product->getName().getStringRef());
+    Value sampleDim0 = tensor::DimOp::create(rewriter, loc, sample, 0);
+    Value sampleDim1 = tensor::DimOp::create(rewriter, loc, sample, 1);
+    Value accumulator = createAccumulator(rewriter, loc, resultType,
+                                          {sampleDim0, sampleDim1});
+
+    MLIRContext *context = rewriter.getContext();
+    AffineExpr i, j, k;
+    bindDims(context, i, j, k);
+    SmallVector<AffineMap> indexingMaps = {
+        AffineMap::get(3, 0, {i, j}, context),
+        AffineMap::get(3, 0, {i, k}, context),
+        AffineMap::get(3, 0, {k, j}, context),
+        AffineMap::get(3, 0, {i, j}, context)};
+    SmallVector<utils::IteratorType> iteratorTypes = {
+        utils::IteratorType::parallel, utils::IteratorType::parallel,
+        utils::IteratorType::reduction};
+    Value sampled =
+        linalg::GenericOp::create(
+            rewriter, loc, resultType, ValueRange{sample, lhs, rhs},
+            accumulator, indexingMaps, iteratorTypes,
+            [](OpBuilder &b, Location loc, ValueRange args) {
+              // s * (a * b) summed over k, which is zero wherever s is not
+              // stored.
+              Value ab = isa<mlir::FloatType>(args[0].getType())
+                             ? arith::MulFOp::create(b, loc, args[1], args[2])
+                                   .getResult()
+                             : arith::MulIOp::create(b, loc, args[1], args[2])
+                                   .getResult();
+              linalg::YieldOp::create(
+                  b, loc, createMultiplyAdd(b, loc, args[3], args[0], ab));
+            })
+            .getResult(0);
+    rewriter.replaceOp(op, sampled);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Lowers the sum of a sparse and a dense tensor of the same shape to a
+// linalg.generic that adds the stored entries of the sparse one into the
+// dense one in place, so that only those entries are visited, instead of
+// co-iterating both over the whole shape.
+class ConvertSparseDenseAdd : public OpConversionPattern<AtenAddTensorOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenAddTensorOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    double alpha;
+    int64_t intAlpha;
+    if (matchPattern(op.getAlpha(), m_TorchConstantInt(&intAlpha)))
+      alpha = intAlpha;
+    else if (!matchPattern(op.getAlpha(), m_TorchConstantFloat(&alpha)))
+      return rewriter.notifyMatchFailure(op, "non-constant alpha");
+    if (alpha != 1.0)
+      return rewriter.notifyMatchFailure(op, "alpha is not 1");
+
+    Value sparse = adaptor.getSelf();
+    Value dense = adaptor.getOther();
+    if (!isSparse(sparse.getType()))
+      std::swap(sparse, dense);
+    auto resultType = dyn_cast_or_null<RankedTensorType>(
+        getTypeConverter()->convertType(op.getType()));
+    auto sparseType = dyn_cast<RankedTensorType>(sparse.getType());
+    if (!resultType || !sparseType || !isSparse(sparseType) ||
+        isSparse(dense.getType()) || isSparse(resultType) ||
+        dense.getType() != resultType ||
+        sparseType.getShape() != resultType.getShape() ||
+        sparseType.getElementType() != resultType.getElementType() ||
+        !isSupportedElementType(resultType.getElementType()))
+      return rewriter.notifyMatchFailure(op, "not a sparse-dense add");
+
+    MLIRContext *context = rewriter.getContext();
+    int64_t rank = resultType.getRank();
+    AffineMap identity = AffineMap::getMultiDimIdentityMap(rank, context);
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::parallel);
+    Value sum =
+        linalg::GenericOp::create(
+            rewriter, op.getLoc(), resultType, sparse, dense,
+            SmallVector<AffineMap>{identity, identity}, iteratorTypes,
+            [](OpBuilder &b, Location loc, ValueRange args) {
+              Value added =
+                  isa<mlir::FloatType>(args[0].getType())
+                      ? arith::AddFOp::create(b, loc, args[1], args[0])
+                            .getResult()
+                      : arith::AddIOp::create(b, loc, args[1], args[0])
+                            .getResult();
+              linalg::YieldOp::create(b, loc, added);
+            })
+            .getResult(0);
+    rewriter.replaceOp(op, sum);
+    return success();
+  }
+};
+} // namespace
+
+void mlir::torch::torch_to_linalg::populateSparsePatternsAndLegality(
+    TypeConverter &typeConverter, RewritePatternSet &patterns,
+    ConversionTarget &target) {
+  MLIRContext *context = patterns.getContext();
+  // The ops are made illegal by the populate functions of their dense
+  // lowerings, which these patterns take precedence over.
+  patterns.add<ConvertSparseMatmul<AtenMmOp>, ConvertSparseMatmul<AtenMatmulOp>,
+               ConvertSampledDenseDenseMatmul, ConvertSparseDenseAdd>(
+      typeConverter, context, /*benefit=*/2);
+}
@@ -26,74 +26,6 @@ using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::Torch;
 
-enum sliceLoc { START = 0, END = 1 };
-
-static Value extractSlice(ConversionPatternRewriter &rewriter, Location loc,
-                          Value input, int64_t dimension, sliceLoc sliceLoc) {
-  auto inputType = llvm::cast<RankedTensorType>(input.getType());
-  int64_t inputRank = inputType.getRank();
-  SmallVector<Value> inputShape = getTensorSizes(rewriter, loc, input);
-
-  SmallVector<OpFoldResult> offsets(inputRank, rewriter.getIndexAttr(0));
-  if (sliceLoc == END) {
-    Value dimSize = inputShape[dimension];
-    Value one = arith::ConstantIndexOp::create(rewriter, loc, 1);
-    Value endIdx = arith::SubIOp::create(rewriter, loc, dimSize, one);
-    offsets[dimension] = getAsOpFoldResult(endIdx);
-  }
-
-  SmallVector<OpFoldResult> allOneStrides(inputRank, rewriter.getIndexAttr(1));
-  SmallVector<OpFoldResult> sizes(inputRank, rewriter.getIndexAttr(0));
-  for (int i = 0; i < inputRank; ++i)
-    sizes[i] = (i == dimension) ? rewriter.getIndexAttr(1)
-                                : getAsOpFoldResult(inputShape[i]);
-
-  Value extractedSlice = tensor::ExtractSliceOp::create(
-      rewriter, loc, input, offsets, sizes, allOneStrides);
-  return extractedSlice;
-}
-
-static Value createTile(ConversionPatternRewriter &rewriter, Location loc,
-                        Value slice, int64_t tileWidth, int64_t dimension) {
-  SmallVector<Value> slices(tileWidth, slice);
-  if (tileWidth == 1)
-    return slice;
-  return tensor::ConcatOp::create(rewriter, loc, dimension, slices);
-}
-
-static Value replicationPad(ConversionPatternRewriter &rewriter, Location loc,
-                            Value input, SmallVector<int64_t> &padInts,
-                            int64_t numDims) {
-  auto inputType = llvm::cast<RankedTensorType>(input.getType());
-  int64_t inputRank = inputType.getRank();
-
-  Value res = input;
-  int64_t padIdx = 0;
-  for (int64_t dim = inputRank - 1; dim >= inputRank - numDims; dim--) {
-    int64_t startTileWidth = padInts[padIdx++];
-    int64_t endTileWidth = padInts[padIdx++];
-
-    SmallVector<Value> resultParts;
-    if (startTileWidth > 0) {
-      Value slice = extractSlice(rewriter, loc, res, dim, sliceLoc::START);
-      Value tile = createTile(rewriter, loc, slice, startTileWidth, dim);
-      resultParts.push_back(tile);
-    }
-
-    resultParts.push_back(res);
-
-    if (endTileWidth > 0) {
-      Value slice = extractSlice(rewriter, loc, res, dim, sliceLoc::END);
-      Value tile = createTile(rewriter, loc, slice, endTileWidth, dim);
-      resultParts.push_back(tile);
-    }
-
-    if (resultParts.size() > 1)
-      res = tensor::ConcatOp::create(rewriter, loc, dim, resultParts);
-  }
-  return res;
-}
-
 namespace {
 class ConvertAtenConstantPadNdOp
     : public OpConversionPattern<AtenConstantPadNdOp> {
@@ -212,9 +144,9 @@ public:
       return rewriter.notifyMatchFailure(
           op, "pad range must have exactly two values");
 
-    int64_t numSpatialDims = 1;
-    Value result =
-        replicationPad(rewriter, loc, input, padInts, numSpatialDims);
+    Value result = torch_to_linalg::getIndexPaddedTensor(
+        rewriter, loc, input, padInts,
+        torch_to_linalg::IndexPaddingMode::Replicate);
     Type resultType = getTypeConverter()->convertType(op.getType());
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, result);
 
@@ -226,8 +158,8 @@ public:
 
 namespace {
 
-// Lower aten.replication_pad2d operator into a sequence of
-// tensor.extract_slice and tensor.concat operations.
+// Lower aten.replication_pad2d operator into a single linalg.generic reading
+// the input at the index clamped into it.
 
 class ConvertAtenReplicationPad2dOp
     : public OpConversionPattern<AtenReplicationPad2dOp> {
@@ -255,9 +187,9 @@ public:
     if (inputRank < 0 || padRank > (uint64_t)inputRank)
       return rewriter.notifyMatchFailure(op, "padding exceeds tensor rank");
 
-    int64_t numSpatialDims = 2;
-    Value resTensor =
-        replicationPad(rewriter, loc, input, padInts, numSpatialDims);
+    Value resTensor = torch_to_linalg::getIndexPaddedTensor(
+        rewriter, loc, input, padInts,
+        torch_to_linalg::IndexPaddingMode::Replicate);
     Type newResultType = getTypeConverter()->convertType(op.getType());
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, newResultType, resTensor);
     return success();
@@ -267,8 +199,8 @@ public:
 
 namespace {
 
-// Lower aten.replication_pad3d operator into a sequence of
-// tensor.extract_slice and tensor.concat operations.
+// Lower aten.replication_pad3d operator into a single linalg.generic reading
+// the input at the index clamped into it.
 class ConvertAtenReplicationPad3dOp
     : public OpConversionPattern<AtenReplicationPad3dOp> {
 
@@ -296,8 +228,9 @@ public:
       return rewriter.notifyMatchFailure(
           op, "pad range must have exactly six values");
 
-    int64_t numSpatialDims = 3;
-    Value res = replicationPad(rewriter, loc, input, padInts, numSpatialDims);
+    Value res = torch_to_linalg::getIndexPaddedTensor(
+        rewriter, loc, input, padInts,
+        torch_to_linalg::IndexPaddingMode::Replicate);
     Type resultType = getTypeConverter()->convertType(op.getType());
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, res);
     return success();
@@ -363,11 +296,11 @@ public:
       resultElementType = *maybeResultElementType;
     }
 
-    // Create an uninitialized tensor of `resultSize` shape and fill it with
-    // value `fillVal`.
+    // Create a tensor of `resultSize` shape with all of its elements
+    // `fillVal`.
     Value constVal = getConstant(rewriter, loc, fillVal, resultElementType);
-    Value outputTensor = createInitTensor(rewriter, loc, resultSizeIndex,
-                                          resultElementType, constVal);
+    Value outputTensor = torch_to_linalg::createSplatTensor(
+        rewriter, loc, getAsOpFoldResult(resultSizeIndex), constVal);
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, outputTensor);
     return success();
   }
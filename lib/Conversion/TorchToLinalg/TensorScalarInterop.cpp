@@ -12,6 +12,7 @@
 #include "PopulatePatterns.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "torch-mlir/Conversion/TorchToLinalg/Utils.h"
 #include "torch-mlir/Conversion/Utils/Utils.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
@@ -236,10 +237,8 @@ public:
         rewriter, loc, full, targetElementType, srcOriginalDtype,
         dstOriginalDtype, op.getFillValue());
 
-    Value outTensor = tensor::EmptyOp::create(rewriter, loc, filteredShape,
-                                              resultTy.getElementType());
-
-    rewriter.replaceOpWithNewOp<linalg::FillOp>(op, castedFull, outTensor);
+    rewriter.replaceOp(op, torch_to_linalg::createSplatTensor(
+                               rewriter, loc, filteredShape, castedFull));
     return success();
   }
 };
@@ -10,6 +10,7 @@
 #include "torch-mlir/Conversion/TorchToLinalg/TorchToLinalg.h"
 
 #include "PopulatePatterns.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Complex/IR/Complex.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlow.h"
@@ -20,6 +21,7 @@
 #include "mlir/Dialect/SparseTensor/IR/SparseTensor.h"
 #include "mlir/Pass/Pass.h"
 #include "torch-mlir/Conversion/Passes.h"
+#include "torch-mlir/Conversion/Utils/Utils.h"
 #include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
 #include "torch-mlir/Dialect/TorchConversion/Transforms/BackendTypeConversion.h"
 
@@ -54,11 +56,27 @@ public:
     registry.insert<cf::ControlFlowDialect>();
     registry.insert<scf::SCFDialect>();
     registry.insert<complex::ComplexDialect>();
+    registry.insert<affine::AffineDialect>();
     TorchConversion::getBackendTypeConversionDependentDialects(registry);
   }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
+    std::optional<torch_to_linalg::ConvolutionStrategy> strategy =
+        torch_to_linalg::parseConvolutionStrategy(convStrategy);
+    if (!strategy) {
+      emitError(getOperation().getLoc())
+          << "unknown convolution strategy '" << convStrategy << "'";
+      return signalPassFailure();
+    }
+    std::optional<torch_to_linalg::RandomAlgorithm> rngAlgorithm =
+        torch_to_linalg::parseRandomAlgorithm(rng);
+    if (!rngAlgorithm) {
+      emitError(getOperation().getLoc())
+          << "unknown random number generator '" << rng << "'";
+      return signalPassFailure();
+    }
+
     ConversionTarget target(*context);
     target.addLegalDialect<
         linalg::LinalgDialect, func::FuncDialect, cf::ControlFlowDialect,
@@ -70,29 +88,60 @@ public:
     typeConverter.addConversion([](Type type) { return type; });
     TorchConversion::setupBackendTypeConversion(target, typeConverter);
 
+    if (fuseElementwise && failed(torch_to_linalg::fuseElementwiseOps(
+                               getOperation(), typeConverter)))
+      return signalPassFailure();
+
     RewritePatternSet patterns(context);
 
     torch_to_linalg::populateTensorScalarInteropPatternsAndLegality(
         typeConverter, patterns, target);
-    torch_to_linalg::populateLinearPatternsAndLegality(typeConverter, patterns,
-                                                       target);
+    torch_to_linalg::populateLinearPatternsAndLegality(
+        typeConverter, patterns, target, this->channelsLastConv,
+        this->subPixelConvTranspose, this->convBackwardGemm,
+        this->transposedMatmulOperands);
     torch_to_linalg::populatePoolingPatternsAndLegality(
-        typeConverter, patterns, target, this->allowNonFinites);
+        typeConverter, patterns, target, this->allowNonFinites,
+        this->separablePooling);
     torch_to_linalg::populateRandomPatternsAndLegality(typeConverter, patterns,
-                                                       target);
+                                                       target, *rngAlgorithm);
     torch_to_linalg::populateUncategorizedPatternsAndLegality(typeConverter,
                                                               patterns, target);
     torch_to_linalg::populateReductionPatternsAndLegality(
-        typeConverter, patterns, target, this->allowNonFinites);
+        typeConverter, patterns, target, this->allowNonFinites,
+        this->splitReductionFactor);
     torch_to_linalg::populateDataMovementPatternsAndLegality(typeConverter,
                                                              patterns, target);
     torch_to_linalg::populateIndirectDataMovementPatternsAndLegality(
         typeConverter, patterns, target);
     torch_to_linalg::populateTensorConstructorsPatternsAndLegality(
         typeConverter, patterns, target);
+    torch_to_linalg::populateSparsePatternsAndLegality(typeConverter, patterns,
+                                                       target);
+
+    PatternStatisticsListener statisticsListener;
+    ConversionConfig config;
+    if (patternStatistics)
+      config.listener = &statisticsListener;
+    LogicalResult converted = applyPartialConversion(
+        getOperation(), target, std::move(patterns), config);
+    if (patternStatistics)
+      statisticsListener.print(llvm::errs(), getArgument(), getOperation());
+    if (failed(converted))
+      return signalPassFailure();
+
+    if (decomposeZeroPoints)
+      torch_to_linalg::decomposeQuantizedZeroPoints(getOperation());
+
+    if (failed(torch_to_linalg::applyConvolutionStrategy(getOperation(),
+                                                         *strategy)))
+      return signalPassFailure();
+
+    if (foldWindowPadding)
+      torch_to_linalg::readPaddingInWindows(getOperation());
 
-    if (failed(applyPartialConversion(getOperation(), target,
-                                      std::move(patterns))))
+    if (concatInPlace &&
+        failed(torch_to_linalg::writeConcatInputsInPlace(getOperation())))
       return signalPassFailure();
   }
 };
@@ -103,9 +152,29 @@ std::unique_ptr<OperationPass<func::FuncOp>> createConvertTorchToLinalgPass() {
 }
 
 std::unique_ptr<OperationPass<func::FuncOp>>
-createConvertTorchToLinalgPass(bool allowNonFinites) {
+createConvertTorchToLinalgPass(bool allowNonFinites, bool channelsLastConv,
+                               StringRef convStrategy, bool fuseElementwise,
+                               int64_t splitReductionFactor, StringRef rng,
+                               bool concatInPlace, bool separablePooling,
+                               bool decomposeZeroPoints,
+                               bool subPixelConvTranspose,
+                               bool convBackwardGemm,
+                               bool foldWindowPadding,
+                               bool transposedMatmulOperands) {
   ConvertTorchToLinalgOptions options;
   options.allowNonFinites = allowNonFinites;
+  options.channelsLastConv = channelsLastConv;
+  options.convStrategy = convStrategy.str();
+  options.fuseElementwise = fuseElementwise;
+  options.splitReductionFactor = splitReductionFactor;
+  options.rng = rng.str();
+  options.concatInPlace = concatInPlace;
+  options.separablePooling = separablePooling;
+  options.decomposeZeroPoints = decomposeZeroPoints;
+  options.subPixelConvTranspose = subPixelConvTranspose;
+  options.convBackwardGemm = convBackwardGemm;
+  options.foldWindowPadding = foldWindowPadding;
+  options.transposedMatmulOperands = transposedMatmulOperands;
   return std::make_unique<ConvertTorchToLinalg>(options);
 }
 
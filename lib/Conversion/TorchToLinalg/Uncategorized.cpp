@@ -18,6 +18,7 @@
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
 #include "mlir/IR/Matchers.h"
 #include "torch-mlir/Conversion/TorchToLinalg/Utils.h"
 #include "torch-mlir/Conversion/Utils/Utils.h"
@@ -1764,34 +1765,9 @@ static Value createLinalgPayloadCalculationForElementwiseOp(
   return nullptr;
 }
 
-namespace {
-// Converts an elementwise op.
-// This specifically includes:
-// - converting elementwise ops of any tensor arity
-// - converting elementwise ops with any number of scalar captures (such as a
-//   scalar alpha to torch.aten.Add)
-// - broadcasting of static size-1 dimensions
-//
-// Currently, we adopt the behavior that "size 1" broadcasting is a runtime
-// error if it happens dynamically.
-//
-// Looking forward a bit, eventually, it probably makes sense to have
-// a "linalg.generic-like" op for modeling a fused subgraph of numpy-broadcasted
-// operands. Modeling elementwise ops that way is potentially useful to allow a
-// more centralized reasoning about multiversioning. However a cost model will
-// be needed for "pre-fusing" elementwise ops that way, as it can potentially be
-// a pessimization. A mild extension of this pattern should work for such a
-// general op.
-class ConvertElementwiseOp : public ConversionPattern {
-public:
-  ConvertElementwiseOp(TypeConverter &typeConverter, MLIRContext *context)
-      : ConversionPattern(typeConverter, MatchAnyOpTypeTag(), /*benefit=*/1,
-                          context) {}
-
-  LogicalResult
-  matchAndRewrite(Operation *op, ArrayRef<Value> operands,
-                  ConversionPatternRewriter &rewriter) const override {
-    if (!isa<AtenTanOp, AtenTanhOp, AtenSinhOp, AtenCoshOp, AtenReluOp,
+// Whether `op` is lowered by `ConvertElementwiseOp`.
+static bool isElementwiseOp(Operation *op) {
+  return isa<AtenTanOp, AtenTanhOp, AtenSinhOp, AtenCoshOp, AtenReluOp,
              AtenPreluOp, AtenGeluOp, AtenGeluBackwardOp, AtenEluBackwardOp,
              AtenSigmoidBackwardOp, AtenSoftplusBackwardOp, AtenAddTensorOp,
              AtenMulTensorOp, AtenDivTensorOp, AtenDivTensorModeOp,
@@ -1821,17 +1797,130 @@ public:
              AtenImagOp, AtenDequantizeSelfOp, AtenDequantizeTensorOp,
              AtenQuantizePerTensorOp, AtenIscloseOp,
              QuantizedDecomposedDequantizePerTensorOp,
-             QuantizedDecomposedQuantizePerTensorOp>(op))
+             QuantizedDecomposedQuantizePerTensorOp>(op);
+}
+
+// Returns the input of `value` if it is the result of an `aten.broadcast_to`
+// that an elementwise op with a result of sizes `resultSizes` can express in
+// its indexing maps instead of reading the materialized broadcast. That is the
+// case when each dim the broadcast expands is statically 1 in its input, or
+// missing from it, and statically has the broadcast size in the result.
+static Value getBroadcastSource(Value value, ArrayRef<int64_t> resultSizes) {
+  auto broadcast = value.getDefiningOp<AtenBroadcastToOp>();
+  if (!broadcast)
+    return nullptr;
+  auto inputType = dyn_cast<ValueTensorType>(broadcast.getSelf().getType());
+  auto outputType = cast<ValueTensorType>(broadcast.getType());
+  SmallVector<Value> sizes;
+  if (!inputType || !inputType.hasSizes() || !outputType.hasSizes() ||
+      !getListConstructElements(broadcast.getSize(), sizes))
+    return nullptr;
+  ArrayRef<int64_t> inputSizes = inputType.getSizes();
+  ArrayRef<int64_t> outputSizes = outputType.getSizes();
+  int64_t inputOffset = outputSizes.size() - inputSizes.size();
+  int64_t resultOffset = resultSizes.size() - outputSizes.size();
+  if (inputOffset < 0 || resultOffset < 0 ||
+      sizes.size() != outputSizes.size())
+    return nullptr;
+
+  for (auto [i, outputSize] : llvm::enumerate(outputSizes)) {
+    int64_t dim = i;
+    int64_t inputSize = dim < inputOffset ? 1 : inputSizes[dim - inputOffset];
+    int64_t size;
+    bool keepsInputSize = dim >= inputOffset &&
+                          matchPattern(sizes[i], m_TorchConstantInt(&size)) &&
+                          size == -1;
+    if (keepsInputSize ||
+        (inputSize != kUnknownSize && inputSize == outputSize))
+      continue;
+    if (inputSize != 1 || outputSize == kUnknownSize ||
+        resultSizes[dim + resultOffset] != outputSize)
+      return nullptr;
+  }
+  return broadcast.getSelf();
+}
+
+static constexpr StringLiteral kInplaceDestinationAttr =
+    "torch.inplace_destination";
+
+// Makes the first input of an elementwise `generic` its destination, so that
+// One-Shot Bufferize writes the result into the buffer of that input rather
+// than into a new allocation. Only done when the input is read at the same
+// point it is written and the payload does not read the destination.
+static void reuseInputAsDestination(RewriterBase &rewriter,
+                                    linalg::GenericOp generic) {
+  if (generic.getNumDpsInputs() == 0 || generic.getNumDpsInits() != 1)
+    return;
+  OpOperand *input = generic.getDpsInputOperand(0);
+  OpOperand *init = generic.getDpsInitOperand(0);
+  if (input->get().getType() != init->get().getType() ||
+      !generic.getMatchingIndexingMap(input).isIdentity() ||
+      generic.payloadUsesValueFromOperand(init))
+    return;
+  Value empty = init->get();
+  rewriter.modifyOpInPlace(generic, [&] { init->set(input->get()); });
+  if (Operation *emptyOp = empty.getDefiningOp<tensor::EmptyOp>())
+    if (emptyOp->use_empty())
+      rewriter.eraseOp(emptyOp);
+}
+
+namespace {
+// Converts an elementwise op.
+// This specifically includes:
+// - converting elementwise ops of any tensor arity
+// - converting elementwise ops with any number of scalar captures (such as a
+//   scalar alpha to torch.aten.Add)
+// - broadcasting of static size-1 dimensions
+//
+// Currently, we adopt the behavior that "size 1" broadcasting is a runtime
+// error if it happens dynamically.
+//
+// Looking forward a bit, eventually, it probably makes sense to have
+// a "linalg.generic-like" op for modeling a fused subgraph of numpy-broadcasted
+// operands. Modeling elementwise ops that way is potentially useful to allow a
+// more centralized reasoning about multiversioning. However a cost model will
+// be needed for "pre-fusing" elementwise ops that way, as it can potentially be
+// a pessimization. A mild extension of this pattern should work for such a
+// general op.
+class ConvertElementwiseOp : public ConversionPattern {
+public:
+  ConvertElementwiseOp(TypeConverter &typeConverter, MLIRContext *context)
+      : ConversionPattern(typeConverter, MatchAnyOpTypeTag(), /*benefit=*/1,
+                          context) {}
+
+  LogicalResult
+  matchAndRewrite(Operation *op, ArrayRef<Value> operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (!isElementwiseOp(op))
       return rewriter.notifyMatchFailure(op, "not a supported elementwise op");
 
     if (failed(verifyLinalgCompatibleTypes(op, rewriter)))
       return failure();
 
     Location loc = op->getLoc();
-    auto tensorOperands = llvm::to_vector<6>(llvm::make_filter_range(
-        operands, [](Value v) { return isa<RankedTensorType>(v.getType()); }));
     auto resultType = cast<RankedTensorType>(
         getTypeConverter()->convertType(op->getResult(0).getType()));
+    // Read broadcasts through the indexing maps rather than from the
+    // tensors they materialize.
+    ArrayRef<int64_t> resultSizes =
+        cast<ValueTensorType>(op->getResult(0).getType()).getSizes();
+    SmallVector<Value> tensorOperands;
+    bool readsThroughBroadcast = false;
+    for (auto [original, converted] :
+         llvm::zip_equal(op->getOperands(), operands)) {
+      if (!isa<RankedTensorType>(converted.getType()))
+        continue;
+      Value source = getBroadcastSource(original, resultSizes);
+      if (!source) {
+        tensorOperands.push_back(converted);
+        continue;
+      }
+      SmallVector<Value> remapped;
+      if (failed(rewriter.getRemappedValues(source, remapped)))
+        return failure();
+      tensorOperands.push_back(remapped.front());
+      readsThroughBroadcast = true;
+    }
     bool hadErrorCreatingPayload = false;
     Value generic = torch_to_linalg::createElementwiseLinalgGeneric(
         rewriter, loc, tensorOperands, resultType.getElementType(),
@@ -1843,15 +1932,228 @@ public:
             return;
           }
           linalg::YieldOp::create(b, loc, result);
-        });
+        },
+        readsThroughBroadcast ? resultType.getShape() : ArrayRef<int64_t>{});
     if (hadErrorCreatingPayload)
       return failure();
+    if (op->hasAttr(kInplaceDestinationAttr))
+      reuseInputAsDestination(rewriter,
+                              generic.getDefiningOp<linalg::GenericOp>());
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, generic);
     return success();
   }
 };
 } // namespace
 
+// Whether `op` can be emitted as part of a fused elementwise generic: an
+// elementwise op on ranked value tensors of plain (non-quantized) dtypes.
+static bool isFusibleElementwiseOp(Operation *op) {
+  if (!isElementwiseOp(op) ||
+      isa<AtenDequantizeSelfOp, AtenDequantizeTensorOp,
+          AtenQuantizePerTensorOp, QuantizedDecomposedDequantizePerTensorOp,
+          QuantizedDecomposedQuantizePerTensorOp>(op) ||
+      op->getNumResults() != 1 ||
+      !isa<ValueTensorType>(op->getResult(0).getType()))
+    return false;
+  auto isFusibleType = [](Type type) {
+    if (isa<NonValueTensorType>(type))
+      return false;
+    auto tensor = dyn_cast<ValueTensorType>(type);
+    return !tensor ||
+           (tensor.hasSizes() && tensor.hasDtype() &&
+            isa<mlir::FloatType, mlir::IntegerType, mlir::ComplexType>(
+                tensor.getDtype()));
+  };
+  return llvm::all_of(op->getOperandTypes(), isFusibleType) &&
+         llvm::all_of(op->getResultTypes(), isFusibleType);
+}
+
+static bool haveSameSizes(Value lhs, Value rhs) {
+  return cast<ValueTensorType>(lhs.getType()).getSizes() ==
+         cast<ValueTensorType>(rhs.getType()).getSizes();
+}
+
+// Partitions the elementwise ops of `block` into groups of ops connected by
+// def-use edges whose results all have the same sizes. The fused op of a
+// group is emitted where its last op is, so an op only joins a group if no
+// op outside the group uses the group's results before it.
+static SmallVector<SmallVector<Operation *>>
+groupElementwiseOps(Block &block) {
+  SmallVector<SmallVector<Operation *>> groups;
+  DenseMap<Operation *, unsigned> groupOf;
+  auto canAppend = [&](unsigned group, Operation *op) {
+    for (Operation *member : groups[group]) {
+      for (Operation *user : member->getUsers()) {
+        Operation *ancestor = block.findAncestorOpInBlock(*user);
+        if (!ancestor || ancestor == op || op->isBeforeInBlock(ancestor))
+          continue;
+        auto it = groupOf.find(ancestor);
+        if (it == groupOf.end() || it->second != group)
+          return false;
+      }
+    }
+    return true;
+  };
+
+  for (Operation &op : block) {
+    if (!isFusibleElementwiseOp(&op))
+      continue;
+    Value result = op.getResult(0);
+    SmallVector<unsigned> toMerge;
+    for (Value operand : op.getOperands()) {
+      auto it = groupOf.find(operand.getDefiningOp());
+      if (it == groupOf.end() || llvm::is_contained(toMerge, it->second) ||
+          !haveSameSizes(operand, result) || !canAppend(it->second, &op))
+        continue;
+      toMerge.push_back(it->second);
+    }
+    if (toMerge.empty()) {
+      groupOf[&op] = groups.size();
+      groups.push_back({&op});
+      continue;
+    }
+    unsigned group = toMerge.front();
+    for (unsigned other : llvm::drop_begin(toMerge)) {
+      for (Operation *member : groups[other])
+        groupOf[member] = group;
+      llvm::append_range(groups[group], groups[other]);
+      groups[other].clear();
+    }
+    groups[group].push_back(&op);
+    groupOf[&op] = group;
+    llvm::sort(groups[group], [](Operation *lhs, Operation *rhs) {
+      return lhs->isBeforeInBlock(rhs);
+    });
+  }
+  llvm::erase_if(groups, [](ArrayRef<Operation *> group) {
+    return group.size() < 2;
+  });
+  return groups;
+}
+
+// Emits `group` as one linalg.generic, with an input for each tensor defined
+// outside of the group and a result for each op whose result is used outside
+// of it, and replaces the torch ops with it.
+static LogicalResult emitElementwiseGroup(ArrayRef<Operation *> group,
+                                          const TypeConverter &typeConverter) {
+  IRRewriter rewriter(group.front()->getContext());
+  rewriter.setInsertionPoint(group.back());
+  Location loc = rewriter.getFusedLoc(llvm::to_vector(
+      llvm::map_range(group, [](Operation *op) { return op->getLoc(); })));
+  DenseSet<Operation *> members(group.begin(), group.end());
+
+  // Tensors from outside the group become inputs of the generic, and each
+  // op gets its scalar operands converted as `ConvertElementwiseOp` would.
+  llvm::SetVector<Value> leaves;
+  SmallVector<SmallVector<Value>> convertedOperands;
+  for (Operation *op : group) {
+    SmallVector<Value> &converted = convertedOperands.emplace_back();
+    for (Value operand : op->getOperands()) {
+      if (isa<ValueTensorType>(operand.getType())) {
+        if (!members.contains(operand.getDefiningOp()))
+          leaves.insert(operand);
+        converted.push_back(operand);
+        continue;
+      }
+      Type type = typeConverter.convertType(operand.getType());
+      if (!type)
+        return op->emitError("unsupported operand type ") << operand.getType();
+      converted.push_back(type == operand.getType()
+                              ? operand
+                              : typeConverter.materializeTargetConversion(
+                                    rewriter, loc, type, operand));
+    }
+  }
+  // As in `ConvertElementwiseOp`, broadcasts are read through the indexing
+  // maps.
+  Value groupResult = group.back()->getResult(0);
+  ArrayRef<int64_t> groupSizes =
+      cast<ValueTensorType>(groupResult.getType()).getSizes();
+  SmallVector<Value> builtinLeaves;
+  bool readsThroughBroadcast = false;
+  for (Value leaf : leaves) {
+    Value source = getBroadcastSource(leaf, groupSizes);
+    readsThroughBroadcast |= static_cast<bool>(source);
+    if (!source)
+      source = leaf;
+    builtinLeaves.push_back(typeConverter.materializeTargetConversion(
+        rewriter, loc, typeConverter.convertType(source.getType()), source));
+  }
+  auto groupType =
+      cast<RankedTensorType>(typeConverter.convertType(groupResult.getType()));
+
+  SmallVector<Operation *> outputs;
+  SmallVector<Type> outputElementTypes;
+  for (Operation *op : group) {
+    bool usedOutside = llvm::any_of(op->getUsers(), [&](Operation *user) {
+      return !members.contains(user);
+    });
+    if (!usedOutside && op != group.back())
+      continue;
+    outputs.push_back(op);
+    outputElementTypes.push_back(
+        cast<RankedTensorType>(
+            typeConverter.convertType(op->getResult(0).getType()))
+            .getElementType());
+  }
+
+  bool hadErrorCreatingPayload = false;
+  SmallVector<Value> results = torch_to_linalg::createElementwiseLinalgGeneric(
+      rewriter, loc, builtinLeaves, outputElementTypes,
+      [&](OpBuilder &b, Location loc, ValueRange payloadArgs) {
+        IRMapping elements;
+        elements.map(leaves.getArrayRef(),
+                     payloadArgs.take_front(leaves.size()));
+        for (auto [op, converted] : llvm::zip_equal(group, convertedOperands)) {
+          SmallVector<Value> args;
+          for (Value operand : op->getOperands()) {
+            if (isa<ValueTensorType>(operand.getType()))
+              args.push_back(elements.lookup(operand));
+          }
+          Value result = createLinalgPayloadCalculationForElementwiseOp(
+              b, loc, &typeConverter, args, op, converted);
+          if (!result) {
+            hadErrorCreatingPayload = true;
+            return;
+          }
+          elements.map(op->getResult(0), result);
+        }
+        SmallVector<Value> yields;
+        for (Operation *op : outputs)
+          yields.push_back(elements.lookup(op->getResult(0)));
+        linalg::YieldOp::create(b, loc, yields);
+      },
+      readsThroughBroadcast ? groupType.getShape() : ArrayRef<int64_t>{});
+  if (hadErrorCreatingPayload)
+    return failure();
+
+  for (auto [op, result] : llvm::zip_equal(outputs, results)) {
+    Type torchType = op->getResult(0).getType();
+    Value builtinResult = tensor::CastOp::create(
+        rewriter, loc, typeConverter.convertType(torchType), result);
+    rewriter.replaceAllUsesWith(
+        op->getResult(0), typeConverter.materializeSourceConversion(
+                              rewriter, loc, torchType, builtinResult));
+  }
+  for (Operation *op : llvm::reverse(group))
+    rewriter.eraseOp(op);
+  return success();
+}
+
+LogicalResult
+torch_to_linalg::fuseElementwiseOps(Operation *root,
+                                    const TypeConverter &typeConverter) {
+  SmallVector<SmallVector<Operation *>> groups;
+  root->walk([&](Block *block) {
+    llvm::append_range(groups, groupElementwiseOps(*block));
+  });
+  for (ArrayRef<Operation *> group : groups) {
+    if (failed(emitElementwiseGroup(group, typeConverter)))
+      return failure();
+  }
+  return success();
+}
+
 // Given `input`, `target`, `nll_loss_forward` is given by:
 //   for i in range(0, len(target)):
 //     indi = target[i];
@@ -2516,6 +2818,111 @@ public:
 };
 } // namespace
 
+namespace {
+// Lowers a per-channel quantize to a single elementwise generic, in which the
+// scale and the zero point of the channel are broadcast along `axis`:
+// clamp(round(input / scale) + zp, qmin, qmax), rounding half to even.
+class ConvertQuantizePerChannel
+    : public OpConversionPattern<AtenQuantizePerChannelOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenQuantizePerChannelOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    int64_t axis;
+    if (!matchPattern(op.getAxis(), m_TorchConstantInt(&axis)))
+      return rewriter.notifyMatchFailure(op, "axis must be a constant");
+
+    auto converter = getTypeConverter();
+    Value input = adaptor.getSelf();
+    Value scale = adaptor.getScales();
+    Value zeropoint = adaptor.getZeroPoints();
+    auto inputType = cast<RankedTensorType>(input.getType());
+    auto resultType = dyn_cast_or_null<RankedTensorType>(
+        converter->convertType(op->getResult(0).getType()));
+    if (!resultType || !isa<mlir::FloatType>(inputType.getElementType()) ||
+        !isa<IntegerType>(resultType.getElementType()))
+      return rewriter.notifyMatchFailure(op, "expected a float input");
+    if (cast<RankedTensorType>(scale.getType()).getRank() != 1 ||
+        cast<RankedTensorType>(zeropoint.getType()).getRank() != 1)
+      return rewriter.notifyMatchFailure(op, "expected 1-D scales and zps");
+    axis = toPositiveDim(axis, resultType.getRank());
+    if (!isValidDim(axis, resultType.getRank()))
+      return rewriter.notifyMatchFailure(op, "invalid axis");
+
+    bool isUnsigned = torch_to_linalg::isUnsignedTorchType(op.getType());
+    bool isUnsignedZp =
+        torch_to_linalg::isUnsignedTorchType(op.getZeroPoints().getType());
+    unsigned bitwidth = resultType.getElementType().getIntOrFloatBitWidth();
+    double qmin = isUnsigned ? 0.0
+                             : static_cast<double>(
+                                   APInt::getSignedMinValue(bitwidth)
+                                       .getSExtValue());
+    double qmax =
+        isUnsigned
+            ? static_cast<double>(APInt::getMaxValue(bitwidth).getZExtValue())
+            : static_cast<double>(
+                  APInt::getSignedMaxValue(bitwidth).getSExtValue());
+
+    llvm::SmallVector<Value> dynSizes;
+    for (auto [index, dim] : llvm::enumerate(resultType.getShape())) {
+      if (ShapedType::isDynamic(dim)) {
+        dynSizes.push_back(tensor::DimOp::create(rewriter, loc, input, index));
+      }
+    }
+
+    llvm::SmallVector<utils::IteratorType> iterators(
+        resultType.getRank(), utils::IteratorType::parallel);
+    llvm::SmallVector<AffineMap> maps(
+        4, {rewriter.getMultiDimIdentityMap(resultType.getRank())});
+    auto broadcastMap = AffineMap::get(resultType.getRank(), /*symbolCount=*/0,
+                                       {rewriter.getAffineDimExpr(axis)},
+                                       rewriter.getContext());
+    maps[1] = broadcastMap;
+    maps[2] = broadcastMap;
+
+    auto empty = tensor::EmptyOp::create(rewriter, loc, resultType, dynSizes);
+    auto linalgOp = linalg::GenericOp::create(
+        rewriter, loc, resultType, ValueRange{input, scale, zeropoint},
+        ValueRange{empty}, maps, iterators,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value value = args[0];
+          Value scale = args[1];
+          Value zeropoint = args[2];
+          auto valueTy = cast<mlir::FloatType>(value.getType());
+          auto scaleTy = cast<mlir::FloatType>(scale.getType());
+          if (scaleTy.getWidth() > valueTy.getWidth())
+            scale = arith::TruncFOp::create(b, loc, valueTy, scale);
+          else if (scaleTy.getWidth() < valueTy.getWidth())
+            scale = arith::ExtFOp::create(b, loc, valueTy, scale);
+          if (isUnsignedZp)
+            zeropoint = arith::UIToFPOp::create(b, loc, valueTy, zeropoint);
+          else
+            zeropoint = arith::SIToFPOp::create(b, loc, valueTy, zeropoint);
+          Value min = arith::ConstantOp::create(
+              b, loc, b.getFloatAttr(valueTy, qmin));
+          Value max = arith::ConstantOp::create(
+              b, loc, b.getFloatAttr(valueTy, qmax));
+
+          value = arith::DivFOp::create(b, loc, value, scale);
+          value = math::RoundEvenOp::create(b, loc, value);
+          value = arith::AddFOp::create(b, loc, value, zeropoint);
+          value = arith::MaximumFOp::create(b, loc, value, min);
+          value = arith::MinimumFOp::create(b, loc, value, max);
+          Type destTy = args[3].getType();
+          if (isUnsigned)
+            value = arith::FPToUIOp::create(b, loc, destTy, value);
+          else
+            value = arith::FPToSIOp::create(b, loc, destTy, value);
+          linalg::YieldOp::create(b, loc, value);
+        });
+    rewriter.replaceOp(op, linalgOp.getResults());
+    return success();
+  }
+};
+} // namespace
+
 namespace {
 
 template <typename OpTy>
@@ -2745,94 +3152,151 @@ public:
 };
 } // namespace
 
-static Value nearestInterpolate(OpBuilder &b, Location loc,
-                                SmallVector<Value> outputSizes, Value input,
-                                SmallVector<Value> inputSizes,
-                                SmallVector<Value> scaleValues,
-                                std::string coordStr, std::string nearestMode) {
-
-  auto inputType = cast<RankedTensorType>(input.getType());
-  auto inputRank = inputType.getRank();
-
-  SmallVector<Value> indices;
-  for (unsigned i = 0; i < inputRank; i++) {
-    indices.push_back(linalg::IndexOp::create(b, loc, i));
-  }
-
-  for (unsigned i = 2; i < inputRank; i++) {
-    Value outIndex = indices[i];
-
-    Value inputSizeFP =
-        arith::SIToFPOp::create(b, loc, b.getF32Type(), inputSizes[i - 2]);
-
-    Value outputSizeFP =
-        arith::SIToFPOp::create(b, loc, b.getF32Type(), outputSizes[i - 2]);
-
-    // scale = length_resized / length_original
-    // x_original = x_resized / scale
-    Value scale;
-    if (scaleValues.empty())
-      scale = arith::DivFOp::create(b, loc, outputSizeFP, inputSizeFP);
-    else
-      scale = scaleValues[i - 2];
-
-    Value outInt = arith::IndexCastOp::create(b, loc, b.getI64Type(), outIndex);
-    Value outFP = arith::SIToFPOp::create(b, loc, b.getF32Type(), outInt);
-    Value proj;
-    if (coordStr.empty() || coordStr == "_asymmetric") {
-      proj = arith::DivFOp::create(b, loc, outFP, scale);
-    } else if (coordStr == "_half_pixel") {
-      Value cstHalf = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.5));
-      Value add = arith::AddFOp::create(b, loc, outFP, cstHalf);
-      Value div = arith::DivFOp::create(b, loc, add, scale);
-      proj = arith::SubFOp::create(b, loc, div, cstHalf);
-    } else {
-      llvm_unreachable("Unsupported coordination transformation mode");
-    }
+// Returns the input index that output index `outIndex` of a spatial dim
+// reads from under nearest interpolation, as an i64.
+static Value nearestSourceIndex(OpBuilder &b, Location loc, Value outIndex,
+                                Value inputSize, Value outputSize,
+                                Value scaleValue, StringRef coordStr,
+                                StringRef nearestMode) {
+  Value inputSizeFP =
+      arith::SIToFPOp::create(b, loc, b.getF32Type(), inputSize);
+
+  Value outputSizeFP =
+      arith::SIToFPOp::create(b, loc, b.getF32Type(), outputSize);
+
+  // scale = length_resized / length_original
+  // x_original = x_resized / scale
+  Value scale = scaleValue;
+  if (!scale)
+    scale = arith::DivFOp::create(b, loc, outputSizeFP, inputSizeFP);
+
+  Value outInt = arith::IndexCastOp::create(b, loc, b.getI64Type(), outIndex);
+  Value outFP = arith::SIToFPOp::create(b, loc, b.getF32Type(), outInt);
+  Value proj;
+  if (coordStr.empty() || coordStr == "_asymmetric") {
+    proj = arith::DivFOp::create(b, loc, outFP, scale);
+  } else if (coordStr == "_half_pixel") {
+    Value cstHalf = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.5));
+    Value add = arith::AddFOp::create(b, loc, outFP, cstHalf);
+    Value div = arith::DivFOp::create(b, loc, add, scale);
+    proj = arith::SubFOp::create(b, loc, div, cstHalf);
+  } else {
+    llvm_unreachable("Unsupported coordination transformation mode");
+  }
+
+  Value nearestFP;
+  // get nearest pixel using floor
+  if (nearestMode == "floor" || nearestMode == "") {
+    nearestFP = math::FloorOp::create(b, loc, proj);
+  } else if (nearestMode == "round_prefer_floor") {
+    Value cstHalf = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.5));
+    Value floor = math::FloorOp::create(b, loc, proj);
+    Value ceil = math::CeilOp::create(b, loc, proj);
+    Value decimal = arith::SubFOp::create(b, loc, proj, floor);
+    Value cmp = arith::CmpFOp::create(b, loc, arith::CmpFPredicate::ULE,
+                                      decimal, cstHalf);
+    nearestFP = arith::SelectOp::create(b, loc, cmp, floor, ceil);
+  } else if (nearestMode == "round_prefer_ceil") {
+    Value cstHalf = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.5));
+    Value floor = math::FloorOp::create(b, loc, proj);
+    Value ceil = math::CeilOp::create(b, loc, proj);
+    Value decimal = arith::SubFOp::create(b, loc, proj, floor);
+    Value cmp = arith::CmpFOp::create(b, loc, arith::CmpFPredicate::UGE,
+                                      decimal, cstHalf);
+    nearestFP = arith::SelectOp::create(b, loc, cmp, ceil, floor);
+  } else if (nearestMode == "ceil") {
+    nearestFP = math::CeilOp::create(b, loc, proj);
+  } else {
+    llvm_unreachable("Unsupported nearest mode");
+  }
+  // Clamp to valid input indices. ONNX half_pixel (and asymmetric) coords can
+  // lie slightly outside [0, length-1] before rounding; without clamping,
+  // tensor.extract uses out-of-range indices (garbage on some backends).
+  Value cstOne = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(1.0));
+  Value cstZero = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.0));
+  Value inputSizeMOne = arith::SubFOp::create(b, loc, inputSizeFP, cstOne);
+  nearestFP = arith::MaximumFOp::create(b, loc, nearestFP, cstZero);
+  nearestFP = arith::MinimumFOp::create(b, loc, nearestFP, inputSizeMOne);
+
+  return arith::FPToSIOp::create(b, loc, b.getI64Type(), nearestFP);
+}
 
-    Value nearestFP;
-    // get nearest pixel using floor
-    if (nearestMode == "floor" || nearestMode == "") {
-      nearestFP = math::FloorOp::create(b, loc, proj);
-    } else if (nearestMode == "round_prefer_floor") {
-      Value cstHalf = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.5));
-      Value floor = math::FloorOp::create(b, loc, proj);
-      Value ceil = math::CeilOp::create(b, loc, proj);
-      Value decimal = arith::SubFOp::create(b, loc, proj, floor);
-      Value cmp = arith::CmpFOp::create(b, loc, arith::CmpFPredicate::ULE,
-                                        decimal, cstHalf);
-      nearestFP = arith::SelectOp::create(b, loc, cmp, floor, ceil);
-    } else if (nearestMode == "round_prefer_ceil") {
-      Value cstHalf = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.5));
-      Value floor = math::FloorOp::create(b, loc, proj);
-      Value ceil = math::CeilOp::create(b, loc, proj);
-      Value decimal = arith::SubFOp::create(b, loc, proj, floor);
-      Value cmp = arith::CmpFOp::create(b, loc, arith::CmpFPredicate::UGE,
-                                        decimal, cstHalf);
-      nearestFP = arith::SelectOp::create(b, loc, cmp, ceil, floor);
-    } else if (nearestMode == "ceil") {
-      nearestFP = math::CeilOp::create(b, loc, proj);
-    } else {
-      llvm_unreachable("Unsupported nearest mode");
-    }
-    // Clamp to valid input indices. ONNX half_pixel (and asymmetric) coords can
-    // lie slightly outside [0, length-1] before rounding; without clamping,
-    // tensor.extract uses out-of-range indices (garbage on some backends).
-    Value cstOne = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(1.0));
-    Value cstZero = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.0));
-    Value inputSizeMOne = arith::SubFOp::create(b, loc, inputSizeFP, cstOne);
-    nearestFP = arith::MaximumFOp::create(b, loc, nearestFP, cstZero);
-    nearestFP = arith::MinimumFOp::create(b, loc, nearestFP, inputSizeMOne);
-
-    Value nearestInt =
-        arith::FPToSIOp::create(b, loc, b.getI64Type(), nearestFP);
-    Value nearest =
-        arith::IndexCastOp::create(b, loc, b.getIndexType(), nearestInt);
-
-    indices[i] = nearest;
-  }
-  Value retVal = tensor::ExtractOp::create(b, loc, input, indices);
-  return retVal;
+// Returns the fp position in the input that output index `outIndex` of a
+// spatial dim maps to.
+static Value coordinateTransformDim(OpBuilder &b, Location loc, Value outIndex,
+                                    Value inputSize, Value outputSize,
+                                    Value scaleValue, StringRef coordStr,
+                                    bool alignCornersBool, bool clip,
+                                    Value cstOneFloat, Value cstHalf,
+                                    Value zero) {
+  // length_original
+  Value inputFP = arith::SIToFPOp::create(b, loc, b.getF32Type(), inputSize);
+  // length_resized
+  Value outputSizeFP =
+      arith::SIToFPOp::create(b, loc, b.getF32Type(), outputSize);
+  // scale = length_resized/length_original
+  Value scale;
+  if (alignCornersBool) {
+    // x_original = x_resized * (length_original - 1) / (length_resized - 1)
+    Value inputSubOne = arith::SubFOp::create(b, loc, inputFP, cstOneFloat);
+    Value outputSizeSubOne =
+        arith::SubFOp::create(b, loc, outputSizeFP, cstOneFloat);
+    Value cmp = arith::CmpFOp::create(b, loc, arith::CmpFPredicate::UEQ,
+                                      outputSizeSubOne, zero);
+    scale = arith::DivFOp::create(b, loc, inputSubOne, outputSizeSubOne);
+    scale = arith::SelectOp::create(b, loc, cmp, zero, scale);
+    coordStr = "_align_corners";
+  } else if (!scaleValue)
+    scale = arith::DivFOp::create(b, loc, outputSizeFP, inputFP);
+  else
+    scale = scaleValue;
+  // y_resized
+  Value outInt = arith::IndexCastOp::create(b, loc, b.getI64Type(), outIndex);
+  Value outFP = arith::SIToFPOp::create(b, loc, b.getF32Type(), outInt);
+  Value preClip;
+  if (coordStr == "_align_corners") {
+    preClip = arith::MulFOp::create(b, loc, outFP, scale);
+  }
+  if (coordStr == "_asymmetric") {
+    preClip = arith::DivFOp::create(b, loc, outFP, scale);
+  }
+  if (coordStr == "_pytorch_half_pixel" || coordStr == "" ||
+      coordStr == "_half_pixel_symmetric") {
+    // half-pixel modes
+    // y_resized + 0.5
+    Value outPlusHalf = arith::AddFOp::create(b, loc, outFP, cstHalf);
+    // (y_resized + 0.5) / scale
+    Value outDivScale = arith::DivFOp::create(b, loc, outPlusHalf, scale);
+    // _ - 0.5
+    preClip = arith::SubFOp::create(b, loc, outDivScale, cstHalf);
+  }
+  // for half_pixel_symmetric, need to compute offset from raw scales
+  if (coordStr == "_half_pixel_symmetric" && scaleValue) {
+    Value outputSizeFromScale = arith::MulFOp::create(b, loc, inputFP, scale);
+    Value adjustment =
+        arith::DivFOp::create(b, loc, outputSizeFP, outputSizeFromScale);
+    Value cstTwo = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(2.0));
+    Value center = arith::DivFOp::create(b, loc, inputFP, cstTwo);
+    Value oneMAdjustment =
+        arith::SubFOp::create(b, loc, cstOneFloat, adjustment);
+    Value offset = arith::MulFOp::create(b, loc, center, oneMAdjustment);
+    preClip = arith::AddFOp::create(b, loc, offset, preClip);
+  }
+  // for pytorch half pixel , special case for length_resized == 1:
+  if (coordStr == "_pytorch_half_pixel") {
+    Value cmp = arith::CmpFOp::create(b, loc, arith::CmpFPredicate::UEQ,
+                                      outputSizeFP, cstOneFloat);
+    preClip = arith::SelectOp::create(b, loc, cmp, zero, preClip);
+  }
+  if (!clip)
+    return preClip;
+  // preClip is the fp position inside the input image to extract from.
+  // clip to [0,inf)
+  Value max = arith::MaximumFOp::create(b, loc, preClip, zero);
+  Value inputSubOne = arith::SubFOp::create(b, loc, inputFP, cstOneFloat);
+  // clip to [0,length_original - 1].
+  // proj is properly within the input image.
+  return arith::MinimumFOp::create(b, loc, max, inputSubOne);
 }
 
 static SmallVector<Value> coordinateTransform(
@@ -2851,132 +3315,112 @@ static SmallVector<Value> coordinateTransform(
 
   SmallVector<Value> proj;
   for (unsigned i = 0; i < inputRank - dimOffset; i++) {
-    // length_original
-    Value inputFP =
-        arith::SIToFPOp::create(b, loc, b.getF32Type(), inputSizes[i]);
-    // length_resized
-    Value outputSizeFP =
-        arith::SIToFPOp::create(b, loc, b.getF32Type(), outputSizes[i]);
-    // scale = length_resized/length_original
-    Value scale;
-    if (alignCornersBool) {
-      // x_original = x_resized * (length_original - 1) / (length_resized - 1)
-      Value inputSubOne = arith::SubFOp::create(b, loc, inputFP, cstOneFloat);
-      Value outputSizeSubOne =
-          arith::SubFOp::create(b, loc, outputSizeFP, cstOneFloat);
-      Value cmp = arith::CmpFOp::create(b, loc, arith::CmpFPredicate::UEQ,
-                                        outputSizeSubOne, zero);
-      scale = arith::DivFOp::create(b, loc, inputSubOne, outputSizeSubOne);
-      scale = arith::SelectOp::create(b, loc, cmp, zero, scale);
-      coordStr = "_align_corners";
-    } else if (scaleValues.empty())
-      scale = arith::DivFOp::create(b, loc, outputSizeFP, inputFP);
-    else
-      scale = scaleValues[i];
-    // y_resized
-    Value outInt = arith::IndexCastOp::create(b, loc, b.getI64Type(),
-                                              indices[i + dimOffset]);
-    Value outFP = arith::SIToFPOp::create(b, loc, b.getF32Type(), outInt);
-    Value preClip;
-    if (coordStr == "_align_corners") {
-      preClip = arith::MulFOp::create(b, loc, outFP, scale);
-    }
-    if (coordStr == "_asymmetric") {
-      preClip = arith::DivFOp::create(b, loc, outFP, scale);
-    }
-    if (coordStr == "_pytorch_half_pixel" || coordStr == "" ||
-        coordStr == "_half_pixel_symmetric") {
-      // half-pixel modes
-      // y_resized + 0.5
-      Value outPlusHalf = arith::AddFOp::create(b, loc, outFP, cstHalf);
-      // (y_resized + 0.5) / scale
-      Value outDivScale = arith::DivFOp::create(b, loc, outPlusHalf, scale);
-      // _ - 0.5
-      preClip = arith::SubFOp::create(b, loc, outDivScale, cstHalf);
-    }
-    // for half_pixel_symmetric, need to compute offset from raw scales
-    if (coordStr == "_half_pixel_symmetric" && !scaleValues.empty()) {
-      Value outputSizeFromScale = arith::MulFOp::create(b, loc, inputFP, scale);
-      Value adjustment =
-          arith::DivFOp::create(b, loc, outputSizeFP, outputSizeFromScale);
-      Value cstTwo = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(2.0));
-      Value center = arith::DivFOp::create(b, loc, inputFP, cstTwo);
-      Value oneMAdjustment =
-          arith::SubFOp::create(b, loc, cstOneFloat, adjustment);
-      Value offset = arith::MulFOp::create(b, loc, center, oneMAdjustment);
-      preClip = arith::AddFOp::create(b, loc, offset, preClip);
-    }
-    // for pytorch half pixel , special case for length_resized == 1:
-    if (coordStr == "_pytorch_half_pixel") {
-      Value cmp = arith::CmpFOp::create(b, loc, arith::CmpFPredicate::UEQ,
-                                        outputSizeFP, cstOneFloat);
-      preClip = arith::SelectOp::create(b, loc, cmp, zero, preClip);
-    }
-    if (clip) {
-      // preClip is the fp position inside the input image to extract from.
-      // clip to [0,inf)
-      Value max = arith::MaximumFOp::create(b, loc, preClip, zero);
-      Value inputSubOne = arith::SubFOp::create(b, loc, inputFP, cstOneFloat);
-      // clip to [0,length_original - 1].
-      // proj is properly within the input image.
-      proj.push_back(arith::MinimumFOp::create(b, loc, max, inputSubOne));
-    } else {
-      proj.push_back(preClip);
-    }
+    proj.push_back(coordinateTransformDim(
+        b, loc, indices[i + dimOffset], inputSizes[i], outputSizes[i],
+        scaleValues.empty() ? Value() : scaleValues[i], coordStr,
+        alignCornersBool, clip, cstOneFloat, cstHalf, zero));
   }
   return proj;
 }
 
-static Value bilinearInterpolate(OpBuilder &b,
-                                 Aten__InterpolateSizeListScaleListOp op,
-                                 Location loc, SmallVector<Value> outputSizes,
-                                 Value input, SmallVector<Value> inputSizes,
-                                 SmallVector<Value> scaleValues,
-                                 std::string coordStr) {
-  unsigned dimOffset = 2;
-  auto inputType = cast<RankedTensorType>(input.getType());
-  auto inputRank = inputType.getRank();
-
+// Returns, for output index `outIndex` of a spatial dim, the two input
+// indices that bilinear interpolation blends (as i64) and their weights.
+static SmallVector<Value>
+bilinearSourceTaps(OpBuilder &b, Location loc, Value outIndex, Value inputSize,
+                   Value outputSize, Value scaleValue, StringRef coordStr,
+                   bool alignCornersBool) {
   Value cstOneFloat = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(1.0));
+  Value cstHalf = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.5));
+  Value zero = arith::ConstantOp::create(b, loc, b.getF32FloatAttr(0.0));
+  Value proj = coordinateTransformDim(b, loc, outIndex, inputSize, outputSize,
+                                      scaleValue, coordStr, alignCornersBool,
+                                      /*clip=*/true, cstOneFloat, cstHalf,
+                                      zero);
+
+  // length_original
+  Value inputFP = arith::SIToFPOp::create(b, loc, b.getF32Type(), inputSize);
+  Value inputSubOne = arith::SubFOp::create(b, loc, inputFP, cstOneFloat);
+
+  // for bilinear interpolation, we look for the nearest indices below and
+  // above proj
+  Value lowFP = math::FloorOp::create(b, loc, proj);
+  Value projPlusOne = arith::AddFOp::create(b, loc, cstOneFloat, proj);
+  Value highFP = math::FloorOp::create(b, loc, projPlusOne);
+
+  Value low = arith::FPToSIOp::create(b, loc, b.getI64Type(), lowFP);
+
+  // highFP could be out-of-bounds, so make sure to clip it down before
+  // extracting. If highFP actually gets clipped here, then high will extract
+  // at the last pixel, but will treat it as if it were extracted from one
+  // further position when computing the interpolation weights.
+  Value high = arith::MinimumFOp::create(b, loc, projPlusOne, inputSubOne);
+  high = arith::FPToSIOp::create(b, loc, b.getI64Type(), high);
+
+  // The weight of each neighbour is the distance to the other one.
+  Value lowWeight = arith::SubFOp::create(b, loc, highFP, proj);
+  Value highWeight = arith::SubFOp::create(b, loc, proj, lowFP);
+  return {low, high, lowWeight, highWeight};
+}
 
-  bool alignCornersBool;
-  matchPattern(op.getAlignCorners(), m_TorchConstantBool(&alignCornersBool));
+// Tabulates `computeEntries` over the `outputSize` output indices of one
+// spatial dim, into one 1-D tensor per entry, of the matching `entryTypes`.
+static SmallVector<Value> tabulateOverOutputDim(
+    OpBuilder &b, Location loc, Value outputSize, TypeRange entryTypes,
+    function_ref<SmallVector<Value>(OpBuilder &, Location, Value)>
+        computeEntries) {
+  SmallVector<OpFoldResult> size = {
+      getAsOpFoldResult(castIntToIndex(b, loc, outputSize))};
+  SmallVector<Value> inits;
+  for (Type type : entryTypes)
+    inits.push_back(tensor::EmptyOp::create(b, loc, size, type));
+  SmallVector<AffineMap> indexingMaps(inits.size(),
+                                      b.getMultiDimIdentityMap(1));
+  auto table = linalg::GenericOp::create(
+      b, loc, ValueRange(inits).getTypes(), ValueRange{}, inits, indexingMaps,
+      {utils::IteratorType::parallel},
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        Value outIndex = linalg::IndexOp::create(b, loc, 0);
+        linalg::YieldOp::create(b, loc, computeEntries(b, loc, outIndex));
+      });
+  return table.getResults();
+}
+
+// `nearest` holds, per spatial dim, the source index read by the current
+// output element.
+static Value nearestInterpolate(OpBuilder &b, Location loc, Value input,
+                                ValueRange nearest) {
+  auto inputType = cast<RankedTensorType>(input.getType());
+  auto inputRank = inputType.getRank();
 
   SmallVector<Value> indices;
-  for (unsigned i = 0; i < inputRank; i++) {
+  for (unsigned i = 0; i < 2; i++) {
     indices.push_back(linalg::IndexOp::create(b, loc, i));
   }
+  for (unsigned i = 2; i < inputRank; i++) {
+    indices.push_back(arith::IndexCastOp::create(b, loc, b.getIndexType(),
+                                                 nearest[i - 2]));
+  }
+  return tensor::ExtractOp::create(b, loc, input, indices);
+}
 
-  SmallVector<Value> proj, high, low, highFP, lowFP;
-  proj = coordinateTransform(b, op, loc, outputSizes, input, inputSizes,
-                             scaleValues, coordStr, alignCornersBool, indices,
-                             true);
-  for (unsigned i = 0; i < inputRank - dimOffset; i++) {
-    // length_original
-    Value inputFP =
-        arith::SIToFPOp::create(b, loc, b.getF32Type(), inputSizes[i]);
-    Value inputSubOne = arith::SubFOp::create(b, loc, inputFP, cstOneFloat);
-
-    // for bilinear interpolation, we look for the nearest indices below and
-    // above proj
-    lowFP.push_back(math::FloorOp::create(b, loc, proj[i]));
-    Value projPlusOne = arith::AddFOp::create(b, loc, cstOneFloat, proj[i]);
-    highFP.push_back(math::FloorOp::create(b, loc, projPlusOne));
-
-    Value lowInt = arith::FPToSIOp::create(b, loc, b.getI64Type(), lowFP[i]);
-    low.push_back(arith::IndexCastOp::create(b, loc, b.getIndexType(), lowInt));
-
-    // highFP could be out-of-bounds, so make sure to clip it down before
-    // extracting. If highFP actually gets clipped here, then high[i] will
-    // extract at the last pixel, but will treat it as if it were extracted from
-    // one further position when computing the interpolation weights.
-    Value highExtract =
-        arith::MinimumFOp::create(b, loc, projPlusOne, inputSubOne);
-    highExtract = arith::FPToSIOp::create(b, loc, b.getI64Type(), highExtract);
-    high.push_back(
-        arith::IndexCastOp::create(b, loc, b.getIndexType(), highExtract));
+// `taps` holds, per spatial dim, the low index, high index, low weight and
+// high weight computed by `bilinearSourceTaps` for the current output element.
+static Value bilinearInterpolate(OpBuilder &b, Location loc, Value input,
+                                 ValueRange taps) {
+  unsigned dimOffset = 2;
+  SmallVector<Value> indices;
+  for (unsigned i = 0; i < dimOffset; i++) {
+    indices.push_back(linalg::IndexOp::create(b, loc, i));
+  }
+  SmallVector<Value> low, high;
+  for (unsigned i = 0; i < 2; i++) {
+    low.push_back(arith::IndexCastOp::create(b, loc, b.getIndexType(),
+                                             taps[4 * i]));
+    high.push_back(arith::IndexCastOp::create(b, loc, b.getIndexType(),
+                                              taps[4 * i + 1]));
   }
 
+  indices.resize(dimOffset + 2);
   indices[dimOffset] = low[0];
   indices[dimOffset + 1] = low[1];
   Value p00 = tensor::ExtractOp::create(b, loc, input, indices);
@@ -3000,10 +3444,10 @@ static Value bilinearInterpolate(OpBuilder &b,
   // Note: we do not need to divide by total rect area == 1
 
   // lengths : Aij == dyi*dxj
-  Value dy0 = arith::SubFOp::create(b, loc, highFP[0], proj[0]);
-  Value dy1 = arith::SubFOp::create(b, loc, proj[0], lowFP[0]);
-  Value dx0 = arith::SubFOp::create(b, loc, highFP[1], proj[1]);
-  Value dx1 = arith::SubFOp::create(b, loc, proj[1], lowFP[1]);
+  Value dy0 = taps[2];
+  Value dy1 = taps[3];
+  Value dx0 = taps[6];
+  Value dx1 = taps[7];
 
   // left = A00*p00 + A01*p01 = dy0(dx0p00 + dx1p01)
   Value dx0p00 = arith::MulFOp::create(b, loc, dx0, p00);
@@ -3271,30 +3715,73 @@ public:
       dims.push_back(castIntToIndex(rewriter, loc, outputSizeIntValues[i - 2]));
     }
 
+    // Nearest and bilinear interpolation are separable: where an output
+    // element reads from only depends on its own index along each spatial
+    // dim. Tabulate the source indices and weights once per dim, and have
+    // the interpolation itself look them up.
+    SmallVector<Value> tables;
+    std::string coordTfMode, nearestMode;
+    bool alignCornersBool = false;
+    if (mode.substr(0, 7) == "nearest") {
+      coordTfMode = mode.substr(7, mode.find(",") - 7);
+      nearestMode = (mode.find(",") == std::string::npos)
+                        ? ""
+                        : mode.substr(mode.find(",") + 1);
+    } else if (mode.substr(0, 8) == "bilinear") {
+      coordTfMode = mode.substr(8);
+      matchPattern(op.getAlignCorners(),
+                   m_TorchConstantBool(&alignCornersBool));
+    }
+    Type i64Type = rewriter.getI64Type();
+    Type f32Type = rewriter.getF32Type();
+    for (unsigned i = 0; i < inputRank - 2; i++) {
+      Value scale = ScaleFactorFloatValues.empty() ? Value()
+                                                   : ScaleFactorFloatValues[i];
+      auto computeEntries = [&](OpBuilder &b, Location loc,
+                                Value outIndex) -> SmallVector<Value> {
+        if (mode.substr(0, 7) == "nearest")
+          return {nearestSourceIndex(b, loc, outIndex, inputSizes[i],
+                                     outputSizeIntValues[i], scale,
+                                     coordTfMode, nearestMode)};
+        return bilinearSourceTaps(b, loc, outIndex, inputSizes[i],
+                                  outputSizeIntValues[i], scale, coordTfMode,
+                                  alignCornersBool);
+      };
+      SmallVector<Type> entryTypes;
+      if (mode.substr(0, 7) == "nearest")
+        entryTypes = {i64Type};
+      else if (mode.substr(0, 8) == "bilinear")
+        entryTypes = {i64Type, i64Type, f32Type, f32Type};
+      if (!entryTypes.empty())
+        llvm::append_range(tables, tabulateOverOutputDim(
+                                       rewriter, loc, outputSizeIntValues[i],
+                                       entryTypes, computeEntries));
+    }
+
     Value outTensor = tensor::EmptyOp::create(
         rewriter, loc, getAsOpFoldResult(dims), inputType.getElementType());
     AffineMap idMap = rewriter.getMultiDimIdentityMap(inputRank);
+    // Each table is indexed by the output index along its own dim.
+    SmallVector<AffineMap> indexingMaps;
+    unsigned tablesPerDim = tables.size() / (inputRank - 2);
+    for (unsigned i = 0, e = tables.size(); i < e; i++) {
+      indexingMaps.push_back(AffineMap::get(
+          inputRank, 0, rewriter.getAffineDimExpr(2 + i / tablesPerDim)));
+    }
+    indexingMaps.push_back(idMap);
     SmallVector<utils::IteratorType> iteratorTypes(
         inputRank, utils::IteratorType::parallel);
     Value finalRes =
         linalg::GenericOp::create(
-            rewriter, loc, outTensor.getType(), ValueRange{}, outTensor,
-            /*indexingMaps=*/idMap,
+            rewriter, loc, outTensor.getType(), tables, outTensor,
+            /*indexingMaps=*/indexingMaps,
             /*iteratorTypes=*/iteratorTypes,
             [&](OpBuilder &b, Location loc, ValueRange args) {
               Value retVal;
               if (mode.substr(0, 7) == "nearest") {
-                std::string coordTfMode = mode.substr(7, mode.find(",") - 7);
-                std::string nearestMode = (mode.find(",") == std::string::npos)
-                                              ? ""
-                                              : mode.substr(mode.find(",") + 1);
-                retVal = nearestInterpolate(b, loc, outputSizeIntValues, input,
-                                            inputSizes, ScaleFactorFloatValues,
-                                            coordTfMode, nearestMode);
+                retVal = nearestInterpolate(b, loc, input, args.drop_back());
               } else if (mode.substr(0, 8) == "bilinear") {
-                retVal = bilinearInterpolate(
-                    b, op, loc, outputSizeIntValues, input, inputSizes,
-                    ScaleFactorFloatValues, mode.substr(8));
+                retVal = bilinearInterpolate(b, loc, input, args.drop_back());
               } else if (mode.substr(0, 5) == "cubic") {
 
                 retVal = bicubicInterpolate(
@@ -4181,6 +4668,8 @@ void mlir::torch::torch_to_linalg::populateUncategorizedPatternsAndLegality(
       typeConverter, context);
   target.addIllegalOp<Aten_MakePerTensorQuantizedTensorOp>();
   patterns.add<ConvertDequantizePerChannel>(typeConverter, context);
+  target.addIllegalOp<AtenQuantizePerChannelOp>();
+  patterns.add<ConvertQuantizePerChannel>(typeConverter, context);
   target.addIllegalOp<AtenGridSamplerOp>();
   patterns.add<ConvertAtenGridSamplerOp>(typeConverter, context);
   target.addIllegalOp<Aten__InterpolateSizeListScaleListOp>();
@@ -88,6 +88,86 @@ Value torch_to_linalg::getDynamicZeroPaddedTensor(
                                /*high=*/paddingValues, pad);
 }
 
+Value torch_to_linalg::createSplatTensor(OpBuilder &b, Location loc,
+                                         ArrayRef<OpFoldResult> sizes,
+                                         Value value) {
+  Value init = tensor::EmptyOp::create(b, loc, sizes, value.getType());
+  SmallVector<AffineMap> indexingMaps{
+      AffineMap::getMultiDimIdentityMap(sizes.size(), b.getContext())};
+  SmallVector<utils::IteratorType> iteratorTypes(sizes.size(),
+                                                 utils::IteratorType::parallel);
+  return linalg::GenericOp::create(
+             b, loc, init.getType(), ValueRange{}, init, indexingMaps,
+             iteratorTypes,
+             [&](OpBuilder &b, Location loc, ValueRange args) {
+               linalg::YieldOp::create(b, loc, value);
+             })
+      .getResult(0);
+}
+
+Value torch_to_linalg::getIndexPaddedTensor(OpBuilder &b, Location loc,
+                                            Value input,
+                                            ArrayRef<int64_t> padInts,
+                                            IndexPaddingMode mode) {
+  auto inputType = cast<RankedTensorType>(input.getType());
+  int64_t rank = inputType.getRank();
+  assert(padInts.size() % 2 == 0 &&
+         static_cast<int64_t>(padInts.size() / 2) <= rank &&
+         "expected a low and high padding per padded dim");
+  SmallVector<Value> inputSizes = getTensorSizes(b, loc, input);
+  SmallVector<int64_t> lowPads(rank, 0);
+  SmallVector<Value> resultSizes(inputSizes);
+  for (size_t i = 0; i < padInts.size() / 2; ++i) {
+    int64_t dim = rank - 1 - i;
+    lowPads[dim] = padInts[2 * i];
+    Value padding = arith::ConstantIndexOp::create(
+        b, loc, padInts[2 * i] + padInts[2 * i + 1]);
+    resultSizes[dim] =
+        b.createOrFold<arith::AddIOp>(loc, inputSizes[dim], padding);
+  }
+
+  int64_t firstPadded = rank - padInts.size() / 2;
+  auto computeIndex = [&](OpBuilder &b, Location loc, int64_t dim) -> Value {
+    Value index = linalg::IndexOp::create(b, loc, dim);
+    if (dim < firstPadded)
+      return index;
+    Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+    Value last = arith::SubIOp::create(
+        b, loc, inputSizes[dim], arith::ConstantIndexOp::create(b, loc, 1));
+    index = arith::SubIOp::create(
+        b, loc, index, arith::ConstantIndexOp::create(b, loc, lowPads[dim]));
+    if (mode == IndexPaddingMode::Replicate)
+      return arith::MinSIOp::create(
+          b, loc, arith::MaxSIOp::create(b, loc, index, zero), last);
+    // last - |last - |index||, which reflects the paddings no larger than the
+    // size of the dim, as PyTorch requires.
+    index = arith::MaxSIOp::create(b, loc, index,
+                                   arith::SubIOp::create(b, loc, zero, index));
+    Value fromLast = arith::SubIOp::create(b, loc, last, index);
+    fromLast = arith::MaxSIOp::create(
+        b, loc, fromLast, arith::SubIOp::create(b, loc, zero, fromLast));
+    return arith::SubIOp::create(b, loc, last, fromLast);
+  };
+
+  Value init = tensor::EmptyOp::create(b, loc, getAsOpFoldResult(resultSizes),
+                                       inputType.getElementType());
+  SmallVector<AffineMap> indexingMaps{
+      AffineMap::getMultiDimIdentityMap(rank, b.getContext())};
+  SmallVector<utils::IteratorType> iteratorTypes(rank,
+                                                 utils::IteratorType::parallel);
+  return linalg::GenericOp::create(
+             b, loc, init.getType(), ValueRange{}, init, indexingMaps,
+             iteratorTypes,
+             [&](OpBuilder &b, Location loc, ValueRange args) {
+               SmallVector<Value> indices;
+               for (int64_t dim = 0; dim < rank; ++dim)
+                 indices.push_back(computeIndex(b, loc, dim));
+               Value value = tensor::ExtractOp::create(b, loc, input, indices);
+               linalg::YieldOp::create(b, loc, value);
+             })
+      .getResult(0);
+}
+
 Value torch_to_linalg::getOutputDimForConvOps(OpBuilder &b, Location loc,
                                               Value in, Value paddingInt,
                                               Value dilationInt,
@@ -265,7 +345,19 @@ Value torch_to_linalg::createReductionLinalgGeneric(
 Value torch_to_linalg::createElementwiseLinalgGeneric(
     OpBuilder &b, Location loc, ValueRange tensorOperands,
     Type resultElementType,
-    function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild) {
+    function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild,
+    ArrayRef<int64_t> resultShapeHint) {
+  return createElementwiseLinalgGeneric(b, loc, tensorOperands,
+                                        TypeRange{resultElementType},
+                                        bodyBuild, resultShapeHint)
+      .front();
+}
+
+SmallVector<Value> torch_to_linalg::createElementwiseLinalgGeneric(
+    OpBuilder &b, Location loc, ValueRange tensorOperands,
+    TypeRange resultElementTypes,
+    function_ref<void(OpBuilder &, Location, ValueRange)> bodyBuild,
+    ArrayRef<int64_t> resultShapeHint) {
   // The overall error handling strategy here is best viewed by thinking about
   // what happens for a single result dimension. This loop not structured that
   // way because it is hard to create the affine maps for each operand unless
@@ -295,19 +387,30 @@ Value torch_to_linalg::createElementwiseLinalgGeneric(
   auto resultRankIt =
       std::max_element(operandRanks.begin(), operandRanks.end());
   assert(resultRankIt != operandRanks.end() && "Unable to get result rank.");
-  int64_t resultRank = *resultRankIt;
+  int64_t resultRank =
+      std::max<int64_t>(*resultRankIt, resultShapeHint.size());
 
   // Initialize the resultShape to all 1's, as a fallback in case
-  // all sizes along that result dimension are statically 1.
+  // all sizes along that result dimension are statically 1. Sizes that are
+  // known from `resultShapeHint` are used as they are.
   auto c1 = arith::ConstantIndexOp::create(b, loc, /*value=*/1);
   SmallVector<Value> resultShape(resultRank, c1);
+  SmallVector<int64_t> staticResultShape(resultRank, ShapedType::kDynamic);
+  DenseSet<int64_t> nonStaticOneResultDims;
+  for (auto [i, size] : llvm::enumerate(resultShapeHint)) {
+    int64_t resultDim = i + resultRank - resultShapeHint.size();
+    if (ShapedType::isDynamic(size) || size == 1)
+      continue;
+    resultShape[resultDim] = arith::ConstantIndexOp::create(b, loc, size);
+    staticResultShape[resultDim] = size;
+    nonStaticOneResultDims.insert(resultDim);
+  }
 
   // Record whether or not all corresponding input dims are statically 1.
   // We don't want to use a constant 0 expression for the input indexing maps in
   // this case, since there is no broadcasting. Using the constant 0 expressions
   // for the inputs, when they actually do correspond to an output dim, makes
   // subsequent optimizations (e.g. fusions) more difficult.
-  DenseSet<int64_t> nonStaticOneResultDims;
   for (int64_t i = 0; i < resultRank; i++) {
     for (Value tensorOperand : tensorOperands) {
       auto type = cast<RankedTensorType>(tensorOperand.getType());
@@ -324,6 +427,7 @@ Value torch_to_linalg::createElementwiseLinalgGeneric(
 
   SmallVector<AffineMap> indexingMaps;
   bool elideDynamicBroadcastCheck = isAssumingStrictSymbolicShapes(b);
+  SmallVector<Value> sizeChecks;
 
   for (Value tensorOperand : tensorOperands) {
     SmallVector<AffineExpr> exprs;
@@ -351,6 +455,7 @@ Value torch_to_linalg::createElementwiseLinalgGeneric(
       // undefined behavior, by doing appropriate checks against the current
       // dimension size.
       auto currentDimSize = getDimOp(b, loc, tensorOperand, size.index());
+      int64_t staticSize = type.getDimSize(size.index());
 
       // If the result size of this dimension has so far only hit the
       // statically-known-to-be-1 case above (i.e., we have not yet assigned a
@@ -359,39 +464,52 @@ Value torch_to_linalg::createElementwiseLinalgGeneric(
       // dimension size.
       if (resultShape[resultDim] == c1) {
         resultShape[resultDim] = currentDimSize;
+        staticResultShape[resultDim] = staticSize;
         continue;
       }
 
+      // Sizes that are statically known to match need no check.
+      if (!ShapedType::isDynamic(staticSize) &&
+          staticSize == staticResultShape[resultDim])
+        continue;
+
       // We prohibit the size-1 dynamic broadcasting scenario, so just check
       // for exact equality with the running result size.
       // This is the check which protects against the undefined behavior of
       // the generated linalg op in the case of iterating two operands with
       // dimensions sizes that are expected to match.
-      if (!elideDynamicBroadcastCheck) {
-        auto equalToRunning =
+      if (!elideDynamicBroadcastCheck)
+        sizeChecks.push_back(
             arith::CmpIOp::create(b, loc, arith::CmpIPredicate::eq,
-                                  resultShape[resultDim], currentDimSize);
-        cf::AssertOp::create(b, loc, equalToRunning,
-                             "mismatched size for broadcast");
-      }
+                                  resultShape[resultDim], currentDimSize));
     }
     indexingMaps.push_back(AffineMap::get(
         /*dimCount=*/resultRank, /*symbolCount=*/0, exprs, b.getContext()));
   }
 
+  // A single check covers all of the operands, however many of them there
+  // are, so that a fused group of ops asserts once.
+  if (!sizeChecks.empty()) {
+    Value legalSizes = sizeChecks.front();
+    for (Value check : llvm::drop_begin(sizeChecks))
+      legalSizes = arith::AndIOp::create(b, loc, legalSizes, check);
+    cf::AssertOp::create(b, loc, legalSizes, "mismatched size for broadcast");
+  }
+
   SmallVector<utils::IteratorType> iteratorTypes(resultRank,
                                                  utils::IteratorType::parallel);
-  // Add the indexing map for the outs init tensor.
-  indexingMaps.push_back(b.getMultiDimIdentityMap(resultRank));
-
-  Value initTensor = tensor::EmptyOp::create(
-      b, loc, getAsOpFoldResult(resultShape), resultElementType);
-  return linalg::GenericOp::create(b, loc,
-                                   /*resultTensorTypes=*/initTensor.getType(),
-                                   /*inputs=*/tensorOperands,
-                                   /*outputs=*/initTensor, indexingMaps,
-                                   iteratorTypes, bodyBuild)
-      .getResult(0);
+  // Add the indexing maps for the outs init tensors.
+  SmallVector<Value> initTensors;
+  for (Type resultElementType : resultElementTypes) {
+    indexingMaps.push_back(b.getMultiDimIdentityMap(resultRank));
+    initTensors.push_back(tensor::EmptyOp::create(
+        b, loc, getAsOpFoldResult(resultShape), resultElementType));
+  }
+  auto generic = linalg::GenericOp::create(
+      b, loc, /*resultTensorTypes=*/ValueRange(initTensors).getTypes(),
+      /*inputs=*/tensorOperands,
+      /*outputs=*/initTensors, indexingMaps, iteratorTypes, bodyBuild);
+  return llvm::to_vector(generic->getResults());
 }
 
 // Broadcasts input tensor based on the broadcastToShape.
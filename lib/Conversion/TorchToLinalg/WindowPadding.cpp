@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// Rewrites the convolutions and pools produced by the TorchToLinalg patterns,
+// which read a padded copy of their input, into `linalg.generic` ops that
+// read the unpadded input directly, with the padding value at the window
+// positions that fall outside of it, so that no padded copy is materialized.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PopulatePatterns.h"
+#include "mlir/Dialect/Affine/Utils.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/IRMapping.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::torch_to_linalg;
+
+// Returns the constant low and high paddings of `pad`, or failure if any of
+// them is dynamic.
+static LogicalResult getStaticPadding(tensor::PadOp pad,
+                                      SmallVectorImpl<int64_t> &low,
+                                      SmallVectorImpl<int64_t> &high) {
+  for (auto [lowSize, highSize] :
+       llvm::zip_equal(pad.getMixedLowPad(), pad.getMixedHighPad())) {
+    std::optional<int64_t> lowInt = getConstantIntValue(lowSize);
+    std::optional<int64_t> highInt = getConstantIntValue(highSize);
+    if (!lowInt || !highInt)
+      return failure();
+    low.push_back(*lowInt);
+    high.push_back(*highInt);
+  }
+  return success();
+}
+
+// Rewrites `op`, whose first input is a constant padding of a tensor, into a
+// `linalg.generic` that reads that tensor in its body instead. The positions
+// of the window in the padding read the padding value: their indices are
+// clamped into the tensor, for the extraction to stay in bounds, and the
+// extracted value is selected away.
+static void readPaddingInWindow(RewriterBase &rewriter, linalg::LinalgOp op) {
+  auto pad = op.getDpsInputs()[0].getDefiningOp<tensor::PadOp>();
+  if (!pad)
+    return;
+  Value padValue = pad.getConstantPaddingValue();
+  SmallVector<int64_t> low, high;
+  if (!padValue || failed(getStaticPadding(pad, low, high)))
+    return;
+
+  rewriter.setInsertionPoint(op);
+  auto generic = dyn_cast<linalg::GenericOp>(op.getOperation());
+  if (!generic) {
+    FailureOr<linalg::GenericOp> generalized =
+        linalg::generalizeNamedOp(rewriter, op);
+    if (failed(generalized))
+      return;
+    generic = *generalized;
+  }
+
+  Location loc = generic.getLoc();
+  Value source = pad.getSource();
+  SmallVector<OpFoldResult> sourceSizes =
+      tensor::getMixedSizes(rewriter, loc, source);
+  SmallVector<Value> otherInputs;
+  SmallVector<AffineMap> indexingMaps;
+  SmallVector<AffineMap> allMaps = generic.getIndexingMapsArray();
+  AffineMap inputMap = allMaps[0];
+  for (int64_t i = 1, e = generic.getNumDpsInputs(); i < e; ++i) {
+    otherInputs.push_back(generic.getDpsInputs()[i]);
+    indexingMaps.push_back(allMaps[i]);
+  }
+  indexingMaps.append(allMaps.begin() + generic.getNumDpsInputs(),
+                      allMaps.end());
+
+  Block &body = generic.getRegion().front();
+  auto newOp = linalg::GenericOp::create(
+      rewriter, loc, generic.getResultTypes(), otherInputs,
+      generic.getDpsInits(), indexingMaps, generic.getIteratorTypesArray(),
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        SmallVector<Value> loops;
+        for (int64_t i = 0, e = generic.getNumLoops(); i < e; ++i)
+          loops.push_back(linalg::IndexOp::create(b, loc, i));
+        Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+        Value inBounds;
+        SmallVector<Value> indices;
+        for (auto [i, expr] : llvm::enumerate(inputMap.getResults())) {
+          Value index = affine::expandAffineExpr(b, loc, expr, loops,
+                                                 /*symbolValues=*/{});
+          if (low[i] == 0 && high[i] == 0) {
+            indices.push_back(index);
+            continue;
+          }
+          index = arith::SubIOp::create(
+              b, loc, index, arith::ConstantIndexOp::create(b, loc, low[i]));
+          Value size = getValueOrCreateConstantIndexOp(b, loc, sourceSizes[i]);
+          Value isValid = arith::AndIOp::create(
+              b, loc,
+              arith::CmpIOp::create(b, loc, arith::CmpIPredicate::sge, index,
+                                    zero),
+              arith::CmpIOp::create(b, loc, arith::CmpIPredicate::slt, index,
+                                    size));
+          inBounds = inBounds ? arith::AndIOp::create(b, loc, inBounds, isValid)
+                              : isValid;
+          indices.push_back(
+              arith::SelectOp::create(b, loc, isValid, index, zero));
+        }
+        Value value = tensor::ExtractOp::create(b, loc, source, indices);
+        if (inBounds)
+          value = arith::SelectOp::create(b, loc, inBounds, value, padValue);
+
+        IRMapping mapping;
+        mapping.map(body.getArgument(0), value);
+        for (auto [arg, newArg] :
+             llvm::zip_equal(body.getArguments().drop_front(), args))
+          mapping.map(arg, newArg);
+        for (Operation &bodyOp : body.without_terminator())
+          b.clone(bodyOp, mapping);
+        SmallVector<Value> yielded;
+        for (Value v : body.getTerminator()->getOperands())
+          yielded.push_back(mapping.lookupOrDefault(v));
+        linalg::YieldOp::create(b, loc, yielded);
+      });
+  rewriter.replaceOp(generic, newOp->getResults());
+  if (pad->use_empty())
+    rewriter.eraseOp(pad);
+}
+
+void torch_to_linalg::readPaddingInWindows(Operation *root) {
+  SmallVector<linalg::LinalgOp> ops;
+  root->walk([&](linalg::LinalgOp op) {
+    if (op.hasPureTensorSemantics() && op.getNumDpsInputs() > 0 &&
+        linalg::isaConvolutionOpInterface(op))
+      ops.push_back(op);
+  });
+  IRRewriter rewriter(root->getContext());
+  for (linalg::LinalgOp op : ops)
+    readPaddingInWindow(rewriter, op);
+}
@@ -11,13 +11,16 @@
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "torch-mlir/Conversion/Passes.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
+#include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
 #include "torch-mlir/Dialect/TorchConversion/Transforms/BackendTypeConversion.h"
 
 using namespace mlir;
@@ -225,12 +228,20 @@ public:
           op, "could not convert PrimLoopOp outputs");
 
     // Calculate the lower bound, upper bound and step indices. Currently only
-    // lower-bound = 0 and step = 1 is supported.
+    // lower-bound = 0 and step = 1 is supported. A constant trip count gives
+    // the loop static bounds, so that later passes can unroll or vectorize
+    // it.
     Location loc = op.getLoc();
     Value lowerBoundIndex = arith::ConstantIndexOp::create(rewriter, loc, 0);
     Value stepIndex = arith::ConstantIndexOp::create(rewriter, loc, 1);
-    Value upperBoundIndex = arith::IndexCastOp::create(
-        rewriter, loc, rewriter.getIndexType(), adaptor.getMaxTripCount());
+    Value upperBoundIndex;
+    int64_t tripCount;
+    if (matchPattern(op.getMaxTripCount(), m_TorchConstantInt(&tripCount)))
+      upperBoundIndex =
+          arith::ConstantIndexOp::create(rewriter, loc, tripCount);
+    else
+      upperBoundIndex = arith::IndexCastOp::create(
+          rewriter, loc, rewriter.getIndexType(), adaptor.getMaxTripCount());
     auto scfForOp =
         scf::ForOp::create(rewriter, loc, lowerBoundIndex, upperBoundIndex,
                            stepIndex, adaptor.getIterArgsInit());
@@ -317,6 +328,51 @@ public:
 };
 } // namespace
 
+// Looks through the casts between builtin tensors and `!torch.vtensor`s that
+// a loop body converted by TorchToLinalg keeps around its carried values.
+static Value stripTensorCasts(Value value) {
+  while (auto toBuiltin =
+             value.getDefiningOp<TorchConversion::ToBuiltinTensorOp>()) {
+    auto fromBuiltin =
+        toBuiltin.getOperand()
+            .getDefiningOp<TorchConversion::FromBuiltinTensorOp>();
+    if (!fromBuiltin)
+      break;
+    value = fromBuiltin.getOperand();
+  }
+  return value;
+}
+
+// Makes each elementwise `linalg.generic` of the body of `loop` that computes
+// the next value of a carried tensor from its current value write into it,
+// instead of into a `tensor.empty`. Bufferization then updates the carried
+// buffer in place rather than allocating and copying one per iteration.
+static void updateCarriedTensorsInPlace(scf::ForOp loop) {
+  for (auto [iterArg, yielded] :
+       llvm::zip_equal(loop.getRegionIterArgs(), loop.getYieldedValues())) {
+    auto generic = stripTensorCasts(yielded).getDefiningOp<linalg::GenericOp>();
+    if (!generic || generic->getBlock() != loop.getBody() ||
+        generic.getNumDpsInits() != 1 ||
+        generic.getNumParallelLoops() != generic.getNumLoops())
+      continue;
+    OpOperand *init = generic.getDpsInitOperand(0);
+    if (!init->get().getDefiningOp<tensor::EmptyOp>() ||
+        generic.payloadUsesValueFromOperand(init))
+      continue;
+    // The current value must be read at the element that is written, so
+    // that each element is read before it is overwritten.
+    AffineMap initMap = generic.getMatchingIndexingMap(init);
+    for (OpOperand *input : generic.getDpsInputOperands()) {
+      if (stripTensorCasts(input->get()) == iterArg &&
+          input->get().getType() == init->get().getType() &&
+          generic.getMatchingIndexingMap(input) == initMap) {
+        init->set(input->get());
+        break;
+      }
+    }
+  }
+}
+
 namespace {
 class ConvertTorchToSCF
     : public impl::ConvertTorchToSCFBase<ConvertTorchToSCF> {
@@ -348,6 +404,7 @@ public:
     if (failed(applyPartialConversion(getOperation(), target,
                                       std::move(patterns))))
       return signalPassFailure();
+    getOperation().walk(updateCarriedTensorsInPlace);
   }
 };
 } // namespace
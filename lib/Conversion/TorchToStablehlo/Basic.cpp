@@ -1722,13 +1722,13 @@ LogicalResult ConvertAtenOp<AtenArangeStartStepOp>::matchAndRewrite(
       rewriter, loc,
       stablehlo::ConvertOp::create(rewriter, loc, divType, subOut),
       stablehlo::ConvertOp::create(rewriter, loc, divType, step));
-  // ceil to i64
+  // ceil to the index type
+  Type intType = rewriter.getIntegerType(options.dimSizeIndexBits);
   Value resultLength = stablehlo::ConvertOp::create(
-      rewriter, loc, RankedTensorType::get({}, rewriter.getI64Type()),
+      rewriter, loc, RankedTensorType::get({}, intType),
       stablehlo::CeilOp::create(rewriter, loc, divOut));
   resultLength = stablehlo::ReshapeOp::create(
-      rewriter, loc, RankedTensorType::get({1}, rewriter.getI64Type()),
-      resultLength);
+      rewriter, loc, RankedTensorType::get({1}, intType), resultLength);
 
   Value window =
       stablehlo::DynamicIotaOp::create(rewriter, loc, outType, resultLength, 0);
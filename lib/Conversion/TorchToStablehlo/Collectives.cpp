@@ -0,0 +1,233 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir/Conversion/TorchToStablehlo/TorchToStablehlo.h"
+
+#include "./PopulatePatterns.h"
+
+#include "stablehlo/dialect/StablehloOps.h"
+#include "torch-mlir/Conversion/TorchToStablehlo/StablehloLegalizeUtils.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+using namespace mlir::torch::torch_to_stablehlo;
+
+static constexpr StringLiteral kProcessGroupsAttr = "torch.process_groups";
+
+// Returns the replica groups of the process group named by `groupName`. They
+// are read from the `torch.process_groups` dictionary of the module, which
+// maps group names to the ranks of each group, and default to a single group
+// of the first `groupSize` replicas, or of all replicas if `groupSize` is not
+// known.
+static FailureOr<DenseIntElementsAttr>
+getReplicaGroups(Operation *op, Value groupName,
+                 std::optional<int64_t> groupSize,
+                 ConversionPatternRewriter &rewriter) {
+  auto module = op->getParentOfType<ModuleOp>();
+  auto processGroups =
+      module ? module->getAttrOfType<DictionaryAttr>(kProcessGroupsAttr)
+             : DictionaryAttr();
+  if (processGroups) {
+    std::string name;
+    if (!matchPattern(groupName, m_TorchConstantStr(name)))
+      return rewriter.notifyMatchFailure(
+          op, "only constant group names are supported");
+    auto groups = processGroups.getAs<DenseIntElementsAttr>(name);
+    if (!groups || groups.getType().getRank() != 2)
+      return rewriter.notifyMatchFailure(
+          op, "the process group is missing from `torch.process_groups`");
+    if (groupSize && groups.getType().getDimSize(1) != *groupSize)
+      return rewriter.notifyMatchFailure(
+          op, "the group size does not match the process group");
+    return groups;
+  }
+
+  Type i64 = rewriter.getI64Type();
+  if (!groupSize)
+    return DenseIntElementsAttr::get(RankedTensorType::get({0, 0}, i64),
+                                     ArrayRef<int64_t>{});
+  return DenseIntElementsAttr::get(
+      RankedTensorType::get({1, *groupSize}, i64),
+      llvm::to_vector(llvm::seq<int64_t>(0, *groupSize)));
+}
+
+// Builds the computation of a collective reduction `reduceOp`, as named by
+// c10d. An average is computed as a sum, to be divided by the group size.
+static LogicalResult buildComputation(Operation *op, Region &region,
+                                      StringRef reduceOp, Type elementType,
+                                      ConversionPatternRewriter &rewriter) {
+  Location loc = op->getLoc();
+  Block &block = region.emplaceBlock();
+  auto blockArgumentTy = RankedTensorType::get({}, elementType);
+  block.addArgument(blockArgumentTy, loc);
+  block.addArgument(blockArgumentTy, loc);
+  Value lhs = block.getArgument(0);
+  Value rhs = block.getArgument(1);
+
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPointToStart(&block);
+  Value result;
+  if (reduceOp == "sum" || reduceOp == "avg") {
+    result = stablehlo::AddOp::create(rewriter, loc, lhs, rhs);
+  } else if (reduceOp == "product") {
+    result = stablehlo::MulOp::create(rewriter, loc, lhs, rhs);
+  } else if (reduceOp == "max") {
+    result = stablehlo::MaxOp::create(rewriter, loc, lhs, rhs);
+  } else if (reduceOp == "min") {
+    result = stablehlo::MinOp::create(rewriter, loc, lhs, rhs);
+  } else if (isa<IntegerType>(elementType) && reduceOp == "band") {
+    result = stablehlo::AndOp::create(rewriter, loc, lhs, rhs);
+  } else if (isa<IntegerType>(elementType) && reduceOp == "bor") {
+    result = stablehlo::OrOp::create(rewriter, loc, lhs, rhs);
+  } else if (isa<IntegerType>(elementType) && reduceOp == "bxor") {
+    result = stablehlo::XorOp::create(rewriter, loc, lhs, rhs);
+  } else {
+    return rewriter.notifyMatchFailure(op, "unsupported reduce_op");
+  }
+  stablehlo::ReturnOp::create(rewriter, loc, result);
+  return success();
+}
+
+// Divides the sum `value` over the groups of `groups` by the group size.
+static Value divideByGroupSize(Operation *op, Value value,
+                               DenseIntElementsAttr groups,
+                               ConversionPatternRewriter &rewriter) {
+  int64_t groupSize = groups.getType().getDimSize(1);
+  Type elementType = getElementTypeOrSelf(value.getType());
+  Value divisor =
+      isa<FloatType>(elementType)
+          ? hlo::getConstantLike(rewriter, op->getLoc(), (double)groupSize,
+                                 value)
+          : hlo::getConstantLike(rewriter, op->getLoc(), groupSize, value);
+  return stablehlo::DivOp::create(rewriter, op->getLoc(), value, divisor);
+}
+
+template <>
+LogicalResult ConvertAtenOp<C10dFunctionalAllReduceOp>::matchAndRewrite(
+    C10dFunctionalAllReduceOp op, OpAdaptor adaptor,
+    ConversionPatternRewriter &rewriter) const {
+  std::string reduceOp;
+  if (!matchPattern(op.getReduceOp(), m_TorchConstantStr(reduceOp)))
+    return rewriter.notifyMatchFailure(op, "reduce_op must be a constant str");
+  FailureOr<DenseIntElementsAttr> groups =
+      getReplicaGroups(op, op.getGroupName(), std::nullopt, rewriter);
+  if (failed(groups))
+    return failure();
+  if (reduceOp == "avg" && groups->empty())
+    return rewriter.notifyMatchFailure(
+        op, "averaging over all replicas requires `torch.process_groups`");
+
+  auto outTy = cast<RankedTensorType>(
+      getTypeConverter()->convertType(op.getType()));
+  auto allReduce = stablehlo::AllReduceOp::create(
+      rewriter, op.getLoc(), TypeRange{outTy}, ValueRange{adaptor.getInput()},
+      ArrayRef<NamedAttribute>{
+          rewriter.getNamedAttr("replica_groups", *groups)});
+  if (failed(buildComputation(op, allReduce.getComputation(), reduceOp,
+                              outTy.getElementType(), rewriter)))
+    return failure();
+
+  Value result = allReduce.getResult(0);
+  if (reduceOp == "avg")
+    result = divideByGroupSize(op, result, *groups, rewriter);
+  rewriter.replaceOp(op, result);
+  return success();
+}
+
+template <>
+LogicalResult
+ConvertAtenOp<C10dFunctionalAllGatherIntoTensorOp>::matchAndRewrite(
+    C10dFunctionalAllGatherIntoTensorOp op, OpAdaptor adaptor,
+    ConversionPatternRewriter &rewriter) const {
+  int64_t groupSize;
+  if (!matchPattern(op.getGroupSize(), m_TorchConstantInt(&groupSize)))
+    return rewriter.notifyMatchFailure(op,
+                                       "group_size must be a constant int");
+  FailureOr<DenseIntElementsAttr> groups =
+      getReplicaGroups(op, op.getGroupName(), groupSize, rewriter);
+  if (failed(groups))
+    return failure();
+
+  // The shards are concatenated along the leading dim.
+  auto outTy = getTypeConverter()->convertType(op.getType());
+  auto allGather = stablehlo::AllGatherOp::create(
+      rewriter, op.getLoc(), TypeRange{outTy}, ValueRange{adaptor.getInput()},
+      ArrayRef<NamedAttribute>{
+          rewriter.getNamedAttr("all_gather_dim",
+                                rewriter.getI64IntegerAttr(0)),
+          rewriter.getNamedAttr("replica_groups", *groups)});
+  rewriter.replaceOp(op, allGather.getResult(0));
+  return success();
+}
+
+template <>
+LogicalResult
+ConvertAtenOp<C10dFunctionalReduceScatterTensorOp>::matchAndRewrite(
+    C10dFunctionalReduceScatterTensorOp op, OpAdaptor adaptor,
+    ConversionPatternRewriter &rewriter) const {
+  std::string reduceOp;
+  if (!matchPattern(op.getReduceOp(), m_TorchConstantStr(reduceOp)))
+    return rewriter.notifyMatchFailure(op, "reduce_op must be a constant str");
+  int64_t groupSize;
+  if (!matchPattern(op.getGroupSize(), m_TorchConstantInt(&groupSize)))
+    return rewriter.notifyMatchFailure(op,
+                                       "group_size must be a constant int");
+  FailureOr<DenseIntElementsAttr> groups =
+      getReplicaGroups(op, op.getGroupName(), groupSize, rewriter);
+  if (failed(groups))
+    return failure();
+
+  // The result is scattered along the leading dim.
+  auto outTy = cast<RankedTensorType>(
+      getTypeConverter()->convertType(op.getType()));
+  auto reduceScatter = stablehlo::ReduceScatterOp::create(
+      rewriter, op.getLoc(), TypeRange{outTy}, ValueRange{adaptor.getInput()},
+      ArrayRef<NamedAttribute>{
+          rewriter.getNamedAttr("scatter_dimension",
+                                rewriter.getI64IntegerAttr(0)),
+          rewriter.getNamedAttr("replica_groups", *groups)});
+  if (failed(buildComputation(op, reduceScatter.getComputation(), reduceOp,
+                              outTy.getElementType(), rewriter)))
+    return failure();
+
+  Value result = reduceScatter.getResult();
+  if (reduceOp == "avg")
+    result = divideByGroupSize(op, result, *groups, rewriter);
+  rewriter.replaceOp(op, result);
+  return success();
+}
+
+// StableHLO collectives are synchronous, and backends split them into
+// asynchronous start/done pairs themselves, so the waits are dropped.
+template <>
+LogicalResult ConvertAtenOp<C10dFunctionalWaitTensorOp>::matchAndRewrite(
+    C10dFunctionalWaitTensorOp op, OpAdaptor adaptor,
+    ConversionPatternRewriter &rewriter) const {
+  rewriter.replaceOp(op, adaptor.getTensor());
+  return success();
+}
+
+void mlir::torch::torch_to_stablehlo::populateCollectiveOpPatternsAndLegality(
+    TypeConverter &typeConverter, RewritePatternSet &patterns,
+    ConversionTarget &target, const TorchToStablehloOptions &options) {
+  MLIRContext *context = patterns.getContext();
+
+#define INSERT_ATENOP_PATTERN(AtenOp)                                          \
+  target.addIllegalOp<AtenOp>();                                               \
+  patterns.add<ConvertAtenOp<AtenOp>>(typeConverter, context, options)
+
+  INSERT_ATENOP_PATTERN(C10dFunctionalAllReduceOp);
+  INSERT_ATENOP_PATTERN(C10dFunctionalAllGatherIntoTensorOp);
+  INSERT_ATENOP_PATTERN(C10dFunctionalReduceScatterTensorOp);
+  INSERT_ATENOP_PATTERN(C10dFunctionalWaitTensorOp);
+#undef INSERT_ATENOP_PATTERN
+}
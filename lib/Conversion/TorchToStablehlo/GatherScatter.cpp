@@ -87,27 +87,8 @@ Value gatherTensorAlongSingleAxis(PatternRewriter &rewriter, Operation *op,
     return stablehlo::ConstantOp::create(rewriter, loc, emptyAttr);
   }
 
-  Type intType = rewriter.getIntegerType(dimSizeIndexBits);
-  Value one = arith::ConstantOp::create(rewriter, loc,
-                                        rewriter.getIntegerAttr(intType, 1));
-
-  // sliceSizes
-  auto inputRank = inputRankTy.getRank();
-  SmallVector<Value, 4> sliceSizes;
-  sliceSizes.reserve(inputRank);
-  for (int64_t r = 0; r < inputRank; ++r) {
-    if (r == axis) {
-      sliceSizes.push_back(one);
-    } else {
-      sliceSizes.push_back(arith::IndexCastOp::create(
-          rewriter, loc, intType,
-          tensor::DimOp::create(rewriter, loc, input, r)));
-    }
-  }
-  auto sliceSizesTensor =
-      tensor::FromElementsOp::create(rewriter, loc, sliceSizes);
-
   // offsetDims
+  auto inputRank = inputRankTy.getRank();
   SmallVector<int64_t, 4> offsetDims;
   offsetDims.reserve(inputRank);
   for (int64_t r = 0; r < axis; ++r) {
@@ -133,9 +114,47 @@ Value gatherTensorAlongSingleAxis(PatternRewriter &rewriter, Operation *op,
       /*startIndexMap=*/startIndexMap,
       /*indexVecDim=*/indexVecDim);
 
+  // The slice sizes only depend on the dims of the input other than `axis`,
+  // e.g. the embedding dim of an embedding table. When those are static, a
+  // gather with constant slice sizes is emitted, even if the indices or the
+  // gathered dim are dynamic, so that no shape computation is left for the
+  // backend to fold.
+  auto inputShape = inputRankTy.getShape();
+  bool hasStaticSliceSizes = true;
+  for (int64_t r = 0; r < inputRank; ++r) {
+    if (r != axis && ShapedType::isDynamic(inputShape[r]))
+      hasStaticSliceSizes = false;
+  }
+  if (hasStaticSliceSizes) {
+    SmallVector<int64_t, 4> sliceSizes(inputShape);
+    sliceSizes[axis] = 1;
+    return stablehlo::GatherOp::create(
+               rewriter, loc, input, indices, dimsAttr,
+               rewriter.getDenseI64ArrayAttr(sliceSizes))
+        .getResult();
+  }
+
+  Type intType = rewriter.getIntegerType(dimSizeIndexBits);
+  Value one = arith::ConstantOp::create(rewriter, loc,
+                                        rewriter.getIntegerAttr(intType, 1));
+
+  // sliceSizes
+  SmallVector<Value, 4> sliceSizes;
+  sliceSizes.reserve(inputRank);
+  for (int64_t r = 0; r < inputRank; ++r) {
+    if (r == axis) {
+      sliceSizes.push_back(one);
+    } else {
+      sliceSizes.push_back(arith::IndexCastOp::create(
+          rewriter, loc, intType,
+          tensor::DimOp::create(rewriter, loc, input, r)));
+    }
+  }
+  auto sliceSizesTensor =
+      tensor::FromElementsOp::create(rewriter, loc, sliceSizes);
+
   // outputShape = input.shape[:axis] + indices.shape +
   //                input.shape[axis + 1:]
-  auto inputShape = inputRankTy.getShape();
   SmallVector<int64_t, 4> outputShape(inputShape.begin(),
                                       inputShape.begin() + axis);
   outputShape.insert(outputShape.end(), indicesShape.begin(),
@@ -272,7 +291,7 @@ FailureOr<Value> broadcastAndConcatIndices(Operation *op,
   concatShape.push_back(indexTensors.size());
 
   SmallVector<Value> broadcastedIndices;
-  Type indexElemTy = rewriter.getI64Type();
+  Type indexElemTy = rewriter.getIntegerType(dimSizeIndexBits);
   RankedTensorType bcastIndexType =
       RankedTensorType::get(indicesShape, indexElemTy);
   for (auto indexTensor : indexTensors) {
@@ -686,22 +705,27 @@ LogicalResult ConvertAtenOp<AtenSliceScatterOp>::matchAndRewrite(
   }
   end = end >= 0 ? end : dimSize + end;
 
+  // A contiguous slice is updated by a `stablehlo.dynamic_update_slice`,
+  // which backends update in place, e.g. for KV caches, rather than by a
+  // scatter of its indices.
+  if (step == 1) {
+    SmallVector<Value> startIndices;
+    for (int64_t i = 0; i < inputRank; ++i)
+      startIndices.push_back(hlo::getConstIndexTensor(
+          rewriter, op, {i == dim ? start : 0}, {}, options.dimSizeIndexBits));
+    rewriter.replaceOpWithNewOp<stablehlo::DynamicUpdateSliceOp>(
+        op, resultType, input, adaptor.getSrc(), startIndices);
+    return success();
+  }
+
   int64_t size = 0;
   std::vector<int64_t> indicesVec;
   for (int64_t i = start; i < end; i += step) {
     indicesVec.push_back(i);
     ++size;
   }
-  ArrayRef<int64_t> indices(indicesVec);
-  std::vector<int64_t> tmp_shape = {size, 1};
-  ArrayRef<int64_t> shape(tmp_shape);
-  RankedTensorType constType =
-      RankedTensorType::get(shape, rewriter.getIntegerType(64));
-  auto constAttr = DenseElementsAttr::get(
-      RankedTensorType::get(shape, rewriter.getIntegerType(64)), indices);
-  auto const_op =
-      stablehlo::ConstantOp::create(rewriter, loc, constType, constAttr);
-  Value scatterIndices = const_op.getResult();
+  Value scatterIndices = hlo::getConstIndexTensor(
+      rewriter, op, indicesVec, {size, 1}, options.dimSizeIndexBits);
 
   SmallVector<int64_t> updateWindowDims;
   for (int64_t i = 0; i < inputType.getRank(); ++i) {
@@ -1228,14 +1252,12 @@ static Value inBoundsCond(ConversionPatternRewriter &rewriter, Operation *op,
 //     )
 SmallVector<Value> clip(ConversionPatternRewriter &rewriter, Operation *op,
                         Value xs, Value ys, Value ws, int64_t N, int64_t oH,
-                        int64_t oW, int64_t iH, int64_t iW, Type elemTy) {
+                        int64_t oW, int64_t iH, int64_t iW, Type elemTy,
+                        size_t dimSizeIndexBits) {
   Location loc = op->getLoc();
-  auto indexElemTy = rewriter.getI64Type();
-  auto indexTy = RankedTensorType::get(mlir::ArrayRef<int64_t>{1}, indexElemTy);
-
-  Value zeroIntValue = stablehlo::ConstantOp::create(
-      rewriter, loc, indexTy,
-      DenseIntElementsAttr::get(indexTy, ArrayRef<int64_t>{0}));
+  auto indexElemTy = rewriter.getIntegerType(dimSizeIndexBits);
+  Value zeroIntValue =
+      hlo::getConstIndexTensor(rewriter, op, {0}, {1}, dimSizeIndexBits);
 
   APFloat zeroAPFloat =
       APFloat(cast<mlir::FloatType>(elemTy).getFloatSemantics(), 0);
@@ -1270,7 +1292,8 @@ Value getSummand(ConversionPatternRewriter &rewriter, Operation *op,
   Location loc = op->getLoc();
   auto inputTensorType = cast<RankedTensorType>(input.getType());
   SmallVector<Value> clipValues =
-      clip(rewriter, op, ix, iy, w, N, oH, oW, iH, iW, elemTy);
+      clip(rewriter, op, ix, iy, w, N, oH, oW, iH, iW, elemTy,
+           dimSizeIndexBits);
   Value idxX = clipValues[0];
   Value idxY = clipValues[1];
   Value idxW = clipValues[2];
@@ -1374,13 +1397,11 @@ LogicalResult ConvertAtenOp<AtenGridSamplerOp>::matchAndRewrite(
   int64_t oW = gridSize[2];
   // grid is a 4D tensor with shape (N, oH, oW, 2)
 
-  Type indexElemTy = rewriter.getI64Type();
-  RankedTensorType indexTy =
-      RankedTensorType::get(mlir::ArrayRef<int64_t>{1}, indexElemTy);
-  Value constN = stablehlo::ConstantOp::create(
-      rewriter, loc, indexTy, DenseIntElementsAttr::get(indexTy, {N}));
-  Value constC = stablehlo::ConstantOp::create(
-      rewriter, loc, indexTy, DenseIntElementsAttr::get(indexTy, {C}));
+  Type indexElemTy = rewriter.getIntegerType(options.dimSizeIndexBits);
+  Value constN = hlo::getConstIndexTensor(rewriter, op, {N}, {1},
+                                          options.dimSizeIndexBits);
+  Value constC = hlo::getConstIndexTensor(rewriter, op, {C}, {1},
+                                          options.dimSizeIndexBits);
   APFloat one = APFloat(cast<mlir::FloatType>(elemTy).getFloatSemantics(), 1);
   APFloat zero = APFloat(cast<mlir::FloatType>(elemTy).getFloatSemantics(), 0);
 
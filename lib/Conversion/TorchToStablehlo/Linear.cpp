@@ -123,6 +123,51 @@ RankedTensorType castContractingDim(PatternRewriter &rewriter, Operation *op,
   return RankedTensorType::get(outShape, lhsTy.getElementType());
 }
 
+// Emits a dot_general that contracts `lhsContractingDim` of `lhs` with
+// `rhsContractingDim` of `rhs` and has no batch dims, so that its result has
+// the other dims of `lhs` followed by the other dims of `rhs`.
+Value createUnbatchedDotGeneral(PatternRewriter &rewriter, Operation *op,
+                                Value lhs, Value rhs, int64_t lhsContractingDim,
+                                int64_t rhsContractingDim) {
+  auto lhsTy = cast<RankedTensorType>(lhs.getType());
+  auto rhsTy = cast<RankedTensorType>(rhs.getType());
+  SmallVector<int64_t> lhsShape(lhsTy.getShape());
+  SmallVector<int64_t> rhsShape(rhsTy.getShape());
+  int64_t &lhsSize = lhsShape[lhsContractingDim];
+  int64_t &rhsSize = rhsShape[rhsContractingDim];
+  if (ShapedType::isDynamic(lhsSize) && !ShapedType::isDynamic(rhsSize)) {
+    lhsSize = rhsSize;
+    lhs = tensor::CastOp::create(rewriter, op->getLoc(),
+                                 lhsTy.clone(lhsShape), lhs);
+  } else if (ShapedType::isDynamic(rhsSize) &&
+             !ShapedType::isDynamic(lhsSize)) {
+    rhsSize = lhsSize;
+    rhs = tensor::CastOp::create(rewriter, op->getLoc(),
+                                 rhsTy.clone(rhsShape), rhs);
+  }
+
+  SmallVector<int64_t> outShape;
+  for (auto [i, size] : llvm::enumerate(lhsShape)) {
+    if (static_cast<int64_t>(i) != lhsContractingDim)
+      outShape.push_back(size);
+  }
+  for (auto [i, size] : llvm::enumerate(rhsShape)) {
+    if (static_cast<int64_t>(i) != rhsContractingDim)
+      outShape.push_back(size);
+  }
+  stablehlo::DotDimensionNumbersAttr dotDimensionNumbers =
+      stablehlo::DotDimensionNumbersAttr::get(
+          rewriter.getContext(),
+          /*lhsBatchingDimensions=*/{},
+          /*rhsBatchingDimensions=*/{},
+          /*lhsContractingDimensions=*/{lhsContractingDim},
+          /*rhsContractingDimensions=*/{rhsContractingDim});
+  return stablehlo::DotGeneralOp::create(
+             rewriter, op->getLoc(), lhsTy.clone(outShape), lhs, rhs,
+             dotDimensionNumbers, nullptr, nullptr)
+      .getResult();
+}
+
 void getBmmBroadcast(PatternRewriter &rewriter, Operation *op, Value &inpLhs,
                      Value &inpRhs, int64_t leadingRank,
                      size_t dimSizeIndexBits) {
@@ -283,35 +328,38 @@ public:
       return success();
     }
 
-    const auto &options = ConvertAtenOp<AtenOpT>::getOptions();
-    int64_t nBatchDims;
+    // A matrix or vector operand is contracted directly against the batched
+    // one, instead of being broadcast to its batch shape, which replicates
+    // it, e.g. the weight of a [B, S, H] x [H, O] matmul.
     if (rhsRank <= 2) {
-      auto leadingRank = lhsRank - 2;
-      getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
-                      options.dimSizeIndexBits);
-      nBatchDims = leadingRank;
-    } else if (lhsRank <= 2) {
-      auto leadingRank = rhsRank - 2;
-      getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
-                      options.dimSizeIndexBits);
-      nBatchDims = leadingRank;
-    } else {
-      assert(rhsRank > 2 && lhsRank > 2);
-      auto leadingRank = std::max(lhsRank - rhsRank, rhsRank - lhsRank);
-      nBatchDims = std::max(lhsRank - 2, rhsRank - 2);
-      getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
-                      options.dimSizeIndexBits);
+      output = createUnbatchedDotGeneral(rewriter, op, lhs, rhs, lhsRank - 1,
+                                         /*rhsContractingDim=*/0);
+      return success();
+    }
+    if (lhsRank <= 2) {
+      output = createUnbatchedDotGeneral(rewriter, op, lhs, rhs, lhsRank - 1,
+                                         rhsRank - 2);
+      if (lhsRank == 2) {
+        // [M, B..., N] -> [B..., M, N]
+        auto perms = llvm::to_vector(llvm::seq<int64_t>(1, rhsRank - 1));
+        perms.push_back(0);
+        perms.push_back(rhsRank - 1);
+        output = getPermutedTensor(rewriter, op, output, perms);
+      }
+      return success();
     }
+
+    const auto &options = ConvertAtenOp<AtenOpT>::getOptions();
+    auto leadingRank = std::max(lhsRank - rhsRank, rhsRank - lhsRank);
+    int64_t nBatchDims = std::max(lhsRank - 2, rhsRank - 2);
+    getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
+                    options.dimSizeIndexBits);
     auto batchDims = llvm::to_vector<4>(llvm::seq<int64_t>(0, nBatchDims));
 
     auto lhsResultDim = nBatchDims;
     auto rhsResultDim = nBatchDims + 1;
     auto lhsContractingDim = nBatchDims + 1;
     auto rhsContractingDim = nBatchDims;
-    if (lhsRank == 1) {
-      lhsResultDim = nBatchDims + 1;
-      lhsContractingDim = nBatchDims;
-    }
 
     stablehlo::DotDimensionNumbersAttr dotDimensionNumbers =
         stablehlo::DotDimensionNumbersAttr::get(
@@ -463,39 +511,50 @@ public:
       return op.emitError("only ranked tensor types are supported in StableHLO "
                           "matmul for bias tensor");
 
-    // weight.T
-    rhs = getPermutedTensor(rewriter, op, rhs, {1, 0});
-
+    Value matmulOutput;
     auto lhsTy = cast<RankedTensorType>(lhs.getType());
-    auto rhsTy = cast<RankedTensorType>(rhs.getType());
-    auto leadingRank = std::max(lhsTy.getRank() - rhsTy.getRank(),
-                                rhsTy.getRank() - lhsTy.getRank());
-
-    const auto &options = ConvertAtenOp<AtenOpT>::getOptions();
-    getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
-                    options.dimSizeIndexBits);
-    auto resultRank = std::max(lhsTy.getRank(), rhsTy.getRank());
-    auto nBatchDims = resultRank - 2;
-    auto batchDims = llvm::to_vector<4>(llvm::seq<int64_t>(0, nBatchDims));
+    if (cast<RankedTensorType>(rhs.getType()).getRank() == 2) {
+      // input x weight.T contracts the last dim of the input with dim 1 of
+      // the weight, which needs neither the transpose of the weight nor its
+      // broadcast to the batch shape of the input.
+      matmulOutput = createUnbatchedDotGeneral(rewriter, op, lhs, rhs,
+                                               lhsTy.getRank() - 1,
+                                               /*rhsContractingDim=*/1);
+    } else {
+      // weight.T
+      rhs = getPermutedTensor(rewriter, op, rhs, {1, 0});
 
-    auto lhsResultDim = nBatchDims;
-    auto rhsResultDim = nBatchDims + 1;
-    auto lhsContractingDim = nBatchDims + 1;
-    auto rhsContractingDim = nBatchDims;
+      auto rhsTy = cast<RankedTensorType>(rhs.getType());
+      auto leadingRank = std::max(lhsTy.getRank() - rhsTy.getRank(),
+                                  rhsTy.getRank() - lhsTy.getRank());
 
-    auto outTy =
-        castContractingDim(rewriter, op, lhs, rhs, lhsResultDim, rhsResultDim,
-                           lhsContractingDim, rhsContractingDim);
-    stablehlo::DotDimensionNumbersAttr dotDimensionNumbers =
-        stablehlo::DotDimensionNumbersAttr::get(
-            rewriter.getContext(),
-            /*lhsBatchingDimensions=*/batchDims,
-            /*rhsBatchingDimensions=*/batchDims,
-            /*lhsContractingDimensions=*/{lhsContractingDim},
-            /*rhsContractingDimensions=*/{rhsContractingDim});
-    Value matmulOutput =
-        stablehlo::DotGeneralOp::create(rewriter, op->getLoc(), outTy, lhs, rhs,
-                                        dotDimensionNumbers, nullptr, nullptr);
+      const auto &options = ConvertAtenOp<AtenOpT>::getOptions();
+      getBmmBroadcast(rewriter, op, lhs, rhs, leadingRank,
+                      options.dimSizeIndexBits);
+      auto resultRank = std::max(lhsTy.getRank(), rhsTy.getRank());
+      auto nBatchDims = resultRank - 2;
+      auto batchDims = llvm::to_vector<4>(llvm::seq<int64_t>(0, nBatchDims));
+
+      auto lhsResultDim = nBatchDims;
+      auto rhsResultDim = nBatchDims + 1;
+      auto lhsContractingDim = nBatchDims + 1;
+      auto rhsContractingDim = nBatchDims;
+
+      auto dotTy = castContractingDim(rewriter, op, lhs, rhs, lhsResultDim,
+                                      rhsResultDim, lhsContractingDim,
+                                      rhsContractingDim);
+      stablehlo::DotDimensionNumbersAttr dotDimensionNumbers =
+          stablehlo::DotDimensionNumbersAttr::get(
+              rewriter.getContext(),
+              /*lhsBatchingDimensions=*/batchDims,
+              /*rhsBatchingDimensions=*/batchDims,
+              /*lhsContractingDimensions=*/{lhsContractingDim},
+              /*rhsContractingDimensions=*/{rhsContractingDim});
+      matmulOutput = stablehlo::DotGeneralOp::create(
+          rewriter, op->getLoc(), dotTy, lhs, rhs, dotDimensionNumbers, nullptr,
+          nullptr);
+    }
+    auto outTy = cast<RankedTensorType>(matmulOutput.getType());
 
     Value matmulPlusBias = matmulOutput;
     if (!isa<Torch::NoneType>(biasTy)) {
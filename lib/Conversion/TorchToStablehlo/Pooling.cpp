@@ -72,6 +72,92 @@ static Value createInitialValueForAtenPoolingOp(Operation *op, Type elementTy,
   return nullptr;
 }
 
+// Whether a pool covers the whole of the trailing `kernelSize.size()` dims
+// of `inputTy`, so that it is a plain reduction over them.
+static bool isGlobalPool(RankedTensorType inputTy, ArrayRef<int64_t> kernelSize,
+                         ArrayRef<int64_t> padding,
+                         ArrayRef<int64_t> dilation) {
+  int64_t spatialStart = inputTy.getRank() - kernelSize.size();
+  for (auto [i, size] : llvm::enumerate(kernelSize)) {
+    if (inputTy.getDimSize(spatialStart + i) != size || padding[i] != 0)
+      return false;
+  }
+  return llvm::all_of(dilation, [](int64_t d) { return d == 1; });
+}
+
+// Reduces the trailing `numDims` dims of `input` with a `stablehlo.reduce`
+// whose body is `BinaryOpT`, keeping them as the unit dims of `outTy`.
+template <typename BinaryOpT>
+static FailureOr<Value> createGlobalPool(PatternRewriter &rewriter,
+                                         Operation *op, Value input,
+                                         Value initVal, int64_t numDims,
+                                         RankedTensorType outTy) {
+  auto inputTy = cast<RankedTensorType>(input.getType());
+  int64_t rank = inputTy.getRank();
+  SmallVector<int64_t> dims =
+      llvm::to_vector(llvm::seq<int64_t>(rank - numDims, rank));
+  auto reducedTy = RankedTensorType::get(
+      inputTy.getShape().drop_back(numDims), inputTy.getElementType());
+  auto reduce =
+      stablehlo::ReduceOp::create(rewriter, op->getLoc(), reducedTy, input,
+                                  initVal, rewriter.getDenseI64ArrayAttr(dims));
+
+  Block &block = reduce.getBody().emplaceBlock();
+  auto blockArgumentTy = RankedTensorType::get({}, inputTy.getElementType());
+  block.addArgument(blockArgumentTy, op->getLoc());
+  block.addArgument(blockArgumentTy, op->getLoc());
+  {
+    OpBuilder::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPointToStart(&block);
+    Value result =
+        BinaryOpT::create(rewriter, op->getLoc(), block.getArgument(0),
+                          block.getArgument(1));
+    stablehlo::ReturnOp::create(rewriter, op->getLoc(), result);
+  }
+
+  FailureOr<Value> result =
+      hlo::unsqueezeTensor(rewriter, op, reduce.getResult(0), dims);
+  if (failed(result) || result->getType() == outTy)
+    return result;
+  return tensor::CastOp::create(rewriter, op->getLoc(), outTy, *result)
+      .getResult();
+}
+
+// The number of input elements, excluding padding, in each window of an
+// average pool, as a constant of shape [1, ..., 1, O_1, ..., O_Dim] that
+// broadcasts over the result. Fails if the spatial dims are not static.
+static FailureOr<Value>
+getAvgPoolDivisor(PatternRewriter &rewriter, Operation *op,
+                  RankedTensorType inputTy, RankedTensorType outTy,
+                  ArrayRef<int64_t> kernelSize, ArrayRef<int64_t> stride,
+                  ArrayRef<int64_t> padding) {
+  int64_t numDims = kernelSize.size();
+  int64_t spatialStart = inputTy.getRank() - numDims;
+  SmallVector<int64_t> shape(spatialStart, 1);
+  SmallVector<float> counts = {1.0f};
+  for (int64_t i = 0; i < numDims; ++i) {
+    int64_t inputSize = inputTy.getDimSize(spatialStart + i);
+    int64_t outputSize = outTy.getDimSize(spatialStart + i);
+    if (ShapedType::isDynamic(inputSize) || ShapedType::isDynamic(outputSize))
+      return failure();
+    SmallVector<float> nextCounts;
+    for (float count : counts) {
+      for (int64_t o = 0; o < outputSize; ++o) {
+        int64_t start = o * stride[i] - padding[i];
+        int64_t end = std::min(start + kernelSize[i], inputSize);
+        nextCounts.push_back(
+            count * std::max<int64_t>(end - std::max<int64_t>(start, 0), 0));
+      }
+    }
+    counts = std::move(nextCounts);
+    shape.push_back(outputSize);
+  }
+  Value divisor =
+      hlo::getConstTensor<float>(rewriter, op, counts, shape).value();
+  return hlo::promoteType(rewriter, op->getLoc(), divisor,
+                          outTy.getElementType());
+}
+
 // AtenMaxPool1dWithIndicesOp
 template <>
 LogicalResult ConvertAtenOp<AtenMaxPool1dWithIndicesOp>::matchAndRewrite(
@@ -503,6 +589,16 @@ public:
       assert(false && "Unsupported pooling dimension");
     }
 
+    if (options.globalPoolAsReduce &&
+        isGlobalPool(inputTy, kernelSize, padding, dilation)) {
+      FailureOr<Value> result = createGlobalPool<stablehlo::MaxOp>(
+          rewriter, op, input, initVal, Dim, outTy);
+      if (failed(result))
+        return rewriter.notifyMatchFailure(op, "failed to reshape the max");
+      rewriter.replaceOp(op, *result);
+      return success();
+    }
+
     const size_t spatialIdxStart = inputRank - Dim;
 
     for (int i = 0; i < Dim; i++) {
@@ -686,26 +782,40 @@ public:
             rewriter.getI64Type()),
         stablehloPadding);
 
-    auto reduceWindowSum = stablehlo::ReduceWindowOp::create(
-        rewriter, op->getLoc(), outTy, input, initVal, windowDimensions,
-        windowStrides, baseDilations, windowDilations, pad);
-
-    Block &sumBlock = reduceWindowSum.getBody().emplaceBlock();
-
-    // Add bb argument
-    auto blockArgumentType = RankedTensorType::get({}, inputElemTy);
-    sumBlock.addArgument(blockArgumentType, op->getLoc());
-    sumBlock.addArgument(blockArgumentType, op->getLoc());
-    auto firstArg = *sumBlock.args_begin();
-    auto secondArg = *sumBlock.args_rbegin();
-
-    {
-      OpBuilder::InsertionGuard guard(rewriter);
-      rewriter.setInsertionPointToStart(&sumBlock);
-
-      Value sumResult =
-          stablehlo::AddOp::create(rewriter, op->getLoc(), firstArg, secondArg);
-      stablehlo::ReturnOp::create(rewriter, op->getLoc(), sumResult);
+    // A pool over the whole of the spatial dims has no padding, so its
+    // divisor is the kernel size.
+    Value sum;
+    if (options.globalPoolAsReduce &&
+        isGlobalPool(inputTy, kernelSize, padding, /*dilation=*/{})) {
+      FailureOr<Value> result = createGlobalPool<stablehlo::AddOp>(
+          rewriter, op, input, initVal, Dim, outTy);
+      if (failed(result))
+        return rewriter.notifyMatchFailure(op, "failed to reshape the sum");
+      sum = *result;
+      countIncludePad = true;
+    } else {
+      auto reduceWindowSum = stablehlo::ReduceWindowOp::create(
+          rewriter, op->getLoc(), outTy, input, initVal, windowDimensions,
+          windowStrides, baseDilations, windowDilations, pad);
+
+      Block &sumBlock = reduceWindowSum.getBody().emplaceBlock();
+
+      // Add bb argument
+      auto blockArgumentType = RankedTensorType::get({}, inputElemTy);
+      sumBlock.addArgument(blockArgumentType, op->getLoc());
+      sumBlock.addArgument(blockArgumentType, op->getLoc());
+      auto firstArg = *sumBlock.args_begin();
+      auto secondArg = *sumBlock.args_rbegin();
+
+      {
+        OpBuilder::InsertionGuard guard(rewriter);
+        rewriter.setInsertionPointToStart(&sumBlock);
+
+        Value sumResult = stablehlo::AddOp::create(rewriter, op->getLoc(),
+                                                   firstArg, secondArg);
+        stablehlo::ReturnOp::create(rewriter, op->getLoc(), sumResult);
+      }
+      sum = reduceWindowSum.getResult(0);
     }
 
     // Use kernel size as the divisor
@@ -731,11 +841,22 @@ public:
                                  outTy.getElementType());
       DenseI64ArrayAttr bcastDimensions;
       rewriter.replaceOpWithNewOp<mlir::chlo::BroadcastDivOp>(
-          op, outTy, reduceWindowSum.getResult(0), divisor, bcastDimensions);
+          op, outTy, sum, divisor, bcastDimensions);
+      return success();
+    }
+
+    // With static spatial dims, the number of elements in each window is
+    // known, and only depends on the position of the window.
+    FailureOr<Value> divisor = getAvgPoolDivisor(
+        rewriter, op, inputTy, outTy, kernelSize, stride, padding);
+    if (succeeded(divisor)) {
+      DenseI64ArrayAttr bcastDimensions;
+      rewriter.replaceOpWithNewOp<mlir::chlo::BroadcastDivOp>(
+          op, outTy, sum, *divisor, bcastDimensions);
       return success();
     }
 
-    // Use another mhlo.ReduceWindowOp to get the divisor
+    // Otherwise, use another mhlo.ReduceWindowOp to get the divisor
     Value windowSizeConst =
         hlo::getConstTensor<float>(rewriter, op, {1.0}, {}).value();
     windowSizeConst = hlo::promoteType(rewriter, op.getLoc(), windowSizeConst,
@@ -759,11 +880,11 @@ public:
     Block &sizeBlock = reduceWindowSize.getBody().emplaceBlock();
 
     // Add bb argument
-    blockArgumentType = RankedTensorType::get({}, inputElemTy);
+    auto blockArgumentType = RankedTensorType::get({}, inputElemTy);
     sizeBlock.addArgument(blockArgumentType, op->getLoc());
     sizeBlock.addArgument(blockArgumentType, op->getLoc());
-    firstArg = *sizeBlock.args_begin();
-    secondArg = *sizeBlock.args_rbegin();
+    auto firstArg = *sizeBlock.args_begin();
+    auto secondArg = *sizeBlock.args_rbegin();
 
     {
       OpBuilder::InsertionGuard guard(rewriter);
@@ -775,7 +896,7 @@ public:
     }
 
     rewriter.replaceOpWithNewOp<stablehlo::DivOp>(
-        op, outTy, reduceWindowSum.getResult(0), reduceWindowSize.getResult(0));
+        op, outTy, sum, reduceWindowSize.getResult(0));
     return success();
   }
 };
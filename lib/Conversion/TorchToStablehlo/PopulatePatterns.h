@@ -10,6 +10,7 @@
 #ifndef TORCHMLIR_LIB_CONVERSION_TORCHTOSTABLEHLO_POPULATEPATTERNS_H
 #define TORCHMLIR_LIB_CONVERSION_TORCHTOSTABLEHLO_POPULATEPATTERNS_H
 
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Transforms/DialectConversion.h"
 
 namespace mlir {
@@ -20,6 +21,8 @@ struct TorchToStablehloOptions {
   bool enableStaticShape = false;
   size_t dimSizeIndexBits = 64;
   bool allowNonFinites = true;
+  bool globalPoolAsReduce = false;
+  bool threadRngState = false;
 };
 
 template <typename AtenOpT>
@@ -68,6 +71,21 @@ void populateRngOpPatternsAndLegality(TypeConverter &typeConverter,
                                       ConversionTarget &target,
                                       const TorchToStablehloOptions &options);
 
+void populateCollectiveOpPatternsAndLegality(
+    TypeConverter &typeConverter, RewritePatternSet &patterns,
+    ConversionTarget &target, const TorchToStablehloOptions &options);
+
+// Replaces the `stablehlo.rng` ops of `func` with `stablehlo.rng_bit_generator`
+// draws from a state that is threaded through them, taken as a new last
+// argument of `func` and returned as a new last result.
+LogicalResult threadRngState(func::FuncOp func);
+
+// Replaces the `torch.sharding` attributes of the arguments, results and ops
+// of `func` with GSPMD `mhlo.sharding` annotations over the device mesh of the
+// module. The results of sharded ops are passed through a `Sharding` custom
+// call carrying the annotation.
+LogicalResult annotateShardings(func::FuncOp func);
+
 void populateUncategorizedPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
     ConversionTarget &target, const TorchToStablehloOptions &options);
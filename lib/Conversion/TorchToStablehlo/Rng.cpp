@@ -11,10 +11,12 @@
 
 #include "./PopulatePatterns.h"
 
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "stablehlo/dialect/StablehloOps.h"
 #include "torch-mlir/Conversion/TorchToStablehlo/StablehloLegalizeUtils.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
+#include "llvm/Support/MathExtras.h"
 
 using namespace mlir;
 using namespace mlir::torch;
@@ -27,7 +29,6 @@ LogicalResult ConvertAtenOp<AtenUniformOp>::matchAndRewrite(
     ConversionPatternRewriter &rewriter) const {
   Value self = adaptor.getSelf();
   Value generator = adaptor.getGenerator();
-  Location loc = op.getLoc();
 
   if (!isa<Torch::NoneType>(generator.getType()))
     return rewriter.notifyMatchFailure(
@@ -38,8 +39,9 @@ LogicalResult ConvertAtenOp<AtenUniformOp>::matchAndRewrite(
   if (llvm::any_of(elements,
                    [](int64_t dim) { return dim == ShapedType::kDynamic; }))
     return rewriter.notifyMatchFailure(op, "Dynamic shape support TBD");
-  auto shape_tensor = stablehlo::ConstantOp::create(
-      rewriter, loc, rewriter.getI64TensorAttr(elements));
+  Value shape_tensor = hlo::getConstIndexTensor(
+      rewriter, op, elements, {static_cast<int64_t>(elements.size())},
+      options.dimSizeIndexBits);
   auto outTy = getTypeConverter()->convertType(op.getType());
   auto outElemTy = cast<RankedTensorType>(outTy).getElementType();
   Value from =
@@ -76,8 +78,9 @@ LogicalResult ConvertAtenOp<AtenRandnGeneratorOp>::matchAndRewrite(
   }
   auto scalarTy = RankedTensorType::get({}, outElemTy);
 
-  Value shapeTensor = stablehlo::ConstantOp::create(
-      rewriter, loc, rewriter.getI64TensorAttr(shape));
+  Value shapeTensor = hlo::getConstIndexTensor(
+      rewriter, op, shape, {static_cast<int64_t>(shape.size())},
+      options.dimSizeIndexBits);
   Value mean = stablehlo::ConstantOp::create(
       rewriter, loc,
       DenseElementsAttr::get(scalarTy, rewriter.getFloatAttr(outElemTy, 0.0)));
@@ -96,7 +99,6 @@ LogicalResult ConvertAtenOp<AtenNormalFunctionalOp>::matchAndRewrite(
     ConversionPatternRewriter &rewriter) const {
   Value self = adaptor.getSelf();
   Value generator = adaptor.getGenerator();
-  Location loc = op.getLoc();
 
   if (!isa<Torch::NoneType>(generator.getType()))
     return rewriter.notifyMatchFailure(
@@ -107,8 +109,9 @@ LogicalResult ConvertAtenOp<AtenNormalFunctionalOp>::matchAndRewrite(
   if (llvm::any_of(elements,
                    [](int64_t dim) { return dim == ShapedType::kDynamic; }))
     return rewriter.notifyMatchFailure(op, "Dynamic shape support TBD");
-  auto shapeTensor = stablehlo::ConstantOp::create(
-      rewriter, loc, rewriter.getI64TensorAttr(elements));
+  Value shapeTensor = hlo::getConstIndexTensor(
+      rewriter, op, elements, {static_cast<int64_t>(elements.size())},
+      options.dimSizeIndexBits);
   auto outTy = getTypeConverter()->convertType(op.getType());
   auto outElemTy = cast<RankedTensorType>(outTy).getElementType();
   Value mean =
@@ -120,6 +123,144 @@ LogicalResult ConvertAtenOp<AtenNormalFunctionalOp>::matchAndRewrite(
   return success();
 }
 
+// The state of `stablehlo.rng_bit_generator` with the THREE_FRY algorithm.
+static RankedTensorType getRngStateType(MLIRContext *context) {
+  return RankedTensorType::get(
+      {2}, IntegerType::get(context, 64, IntegerType::Unsigned));
+}
+
+static Value getSplatConstant(OpBuilder &b, Location loc, ShapedType type,
+                              Attribute value) {
+  return stablehlo::ConstantOp::create(b, loc,
+                                       DenseElementsAttr::get(type, value));
+}
+
+// Draws values of `type` uniformly in [0, 1) from the bits generated from
+// `state`, and advances `state`. The mantissa bits of a float in [1, 2) are
+// filled with random bits and 1 is subtracted; narrower floats are drawn as
+// f32 and converted.
+static Value drawUnitInterval(OpBuilder &b, Location loc, Value &state,
+                              RankedTensorType type) {
+  auto floatType = cast<mlir::FloatType>(type.getElementType());
+  mlir::FloatType drawType = floatType.getWidth() == 64
+                                 ? cast<mlir::FloatType>(b.getF64Type())
+                                 : cast<mlir::FloatType>(b.getF32Type());
+  unsigned width = drawType.getWidth();
+  unsigned mantissaBits = drawType.getFPMantissaWidth() - 1;
+  auto bitsType = RankedTensorType::get(
+      type.getShape(), IntegerType::get(b.getContext(), width,
+                                        IntegerType::Unsigned));
+  auto generator = stablehlo::RngBitGeneratorOp::create(
+      b, loc, state.getType(), bitsType, stablehlo::RngAlgorithm::THREE_FRY,
+      state);
+  state = generator.getOutputState();
+
+  Type bitsElemType = bitsType.getElementType();
+  Value mantissa = stablehlo::ShiftRightLogicalOp::create(
+      b, loc, generator.getOutput(),
+      getSplatConstant(b, loc, bitsType,
+                       IntegerAttr::get(bitsElemType, width - mantissaBits)));
+  APInt one = APFloat::getOne(drawType.getFloatSemantics()).bitcastToAPInt();
+  Value bits = stablehlo::OrOp::create(
+      b, loc, mantissa,
+      getSplatConstant(b, loc, bitsType, IntegerAttr::get(bitsElemType, one)));
+  auto drawTensorType = RankedTensorType::get(type.getShape(), drawType);
+  Value value = stablehlo::SubtractOp::create(
+      b, loc, stablehlo::BitcastConvertOp::create(b, loc, drawTensorType, bits),
+      getSplatConstant(b, loc, drawTensorType, b.getFloatAttr(drawType, 1.0)));
+  if (drawType != floatType)
+    value = stablehlo::ConvertOp::create(b, loc, type, value);
+  return value;
+}
+
+// Returns whether the draws of `op` can be made from a threaded state.
+static bool canThreadRngState(stablehlo::RngOp op, Block &entry) {
+  auto type = dyn_cast<RankedTensorType>(op.getType());
+  return op->getBlock() == &entry && type && type.hasStaticShape() &&
+         isa<mlir::FloatType>(type.getElementType());
+}
+
+LogicalResult
+mlir::torch::torch_to_stablehlo::threadRngState(func::FuncOp func) {
+  if (func.isExternal() || !func.getBody().hasOneBlock())
+    return success();
+  Block &entry = func.getBody().front();
+  SmallVector<stablehlo::RngOp> rngOps;
+  for (auto op : entry.getOps<stablehlo::RngOp>()) {
+    if (canThreadRngState(op, entry))
+      rngOps.push_back(op);
+  }
+  if (rngOps.empty())
+    return success();
+  auto returnOp = dyn_cast<func::ReturnOp>(entry.getTerminator());
+  if (!returnOp)
+    return func.emitError("expected a func.return to thread the RNG state");
+
+  MLIRContext *context = func.getContext();
+  RankedTensorType stateType = getRngStateType(context);
+  auto stateAttrs = DictionaryAttr::get(
+      context, {NamedAttribute(StringAttr::get(context, "torch_mlir.rng_state"),
+                               UnitAttr::get(context))});
+  unsigned stateIndex = func.getNumArguments();
+  (void)func.insertArgument(stateIndex, stateType, stateAttrs, func.getLoc());
+  Value state = func.getArgument(stateIndex);
+
+  OpBuilder b(context);
+  for (stablehlo::RngOp op : rngOps) {
+    b.setInsertionPoint(op);
+    Location loc = op.getLoc();
+    auto type = cast<RankedTensorType>(op.getType());
+    auto broadcast = [&](Value scalar) -> Value {
+      return stablehlo::BroadcastInDimOp::create(
+          b, loc, type, scalar,
+          b.getDenseI64ArrayAttr(llvm::to_vector(llvm::seq<int64_t>(
+              0, cast<RankedTensorType>(scalar.getType()).getRank()))));
+    };
+    Value a = broadcast(op.getA());
+    Value bValue = broadcast(op.getB());
+    Value result;
+    if (op.getRngDistribution() == stablehlo::RngDistribution::UNIFORM) {
+      // a + (b - a) * u
+      Value u = drawUnitInterval(b, loc, state, type);
+      result = stablehlo::AddOp::create(
+          b, loc, a,
+          stablehlo::MulOp::create(
+              b, loc, stablehlo::SubtractOp::create(b, loc, bValue, a), u));
+    } else {
+      // Box-Muller: mean + std * sqrt(-2 log(1 - u1)) * cos(2 pi u2), where
+      // 1 - u1 lies in (0, 1].
+      auto elemType = type.getElementType();
+      Value u1 = drawUnitInterval(b, loc, state, type);
+      Value u2 = drawUnitInterval(b, loc, state, type);
+      Value oneMinusU1 = stablehlo::SubtractOp::create(
+          b, loc, getSplatConstant(b, loc, type, b.getFloatAttr(elemType, 1.0)),
+          u1);
+      Value radius = stablehlo::SqrtOp::create(
+          b, loc,
+          stablehlo::MulOp::create(
+              b, loc,
+              getSplatConstant(b, loc, type, b.getFloatAttr(elemType, -2.0)),
+              stablehlo::LogOp::create(b, loc, oneMinusU1)));
+      Value angle = stablehlo::MulOp::create(
+          b, loc,
+          getSplatConstant(b, loc, type,
+                           b.getFloatAttr(elemType, 2.0 * llvm::numbers::pi)),
+          u2);
+      Value z = stablehlo::MulOp::create(
+          b, loc, radius, stablehlo::CosineOp::create(b, loc, angle));
+      result = stablehlo::AddOp::create(
+          b, loc, a, stablehlo::MulOp::create(b, loc, bValue, z));
+    }
+    op.replaceAllUsesWith(result);
+    op.erase();
+  }
+
+  unsigned resultIndex = func.getNumResults();
+  (void)func.insertResult(resultIndex, stateType, stateAttrs);
+  returnOp.getOperandsMutable().append(state);
+  return success();
+}
+
 void mlir::torch::torch_to_stablehlo::populateRngOpPatternsAndLegality(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
     ConversionTarget &target, const TorchToStablehloOptions &options) {
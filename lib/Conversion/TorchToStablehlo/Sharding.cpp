@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir/Conversion/TorchToStablehlo/TorchToStablehlo.h"
+
+#include "./PopulatePatterns.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
+#include "stablehlo/dialect/StablehloOps.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
+#include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
+#include "llvm/ADT/SmallBitVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+using namespace mlir::torch::torch_to_stablehlo;
+
+static constexpr StringLiteral kShardingAttr = "torch.sharding";
+static constexpr StringLiteral kDeviceMeshAttr = "torch.device_mesh";
+static constexpr StringLiteral kMhloShardingAttr = "mhlo.sharding";
+
+// Returns the GSPMD sharding of a tensor whose dims are split over the axes
+// `sharding` of `mesh` (or replicated for -1), in the text form read by XLA:
+// the tile counts of the dims, followed by the number of replicas of each
+// tile if some mesh axes split no dim, and the devices in tile order.
+static FailureOr<std::string>
+getGspmdSharding(Location loc, ArrayRef<int64_t> sharding,
+                 DenseIntElementsAttr mesh) {
+  ArrayRef<int64_t> meshShape = mesh.getType().getShape();
+  int64_t meshRank = meshShape.size();
+  llvm::SmallBitVector isUsed(meshRank);
+  SmallVector<int64_t> axes, tiles;
+  for (int64_t axis : sharding) {
+    if (axis == -1) {
+      tiles.push_back(1);
+      continue;
+    }
+    if (axis < 0 || axis >= meshRank || isUsed.test(axis))
+      return emitError(loc) << "invalid sharding of a tensor over a device "
+                               "mesh of rank "
+                            << meshRank;
+    isUsed.set(axis);
+    axes.push_back(axis);
+    tiles.push_back(meshShape[axis]);
+  }
+  if (axes.empty())
+    return std::string("{replicated}");
+
+  int64_t replicas = 1;
+  for (int64_t axis = 0; axis < meshRank; ++axis) {
+    if (!isUsed.test(axis)) {
+      axes.push_back(axis);
+      replicas *= meshShape[axis];
+    }
+  }
+  if (replicas > 1)
+    tiles.push_back(replicas);
+
+  // The tiles enumerate the mesh with its axes permuted to `axes`.
+  SmallVector<int64_t> ids;
+  for (const APInt &id : mesh.getValues<APInt>())
+    ids.push_back(id.getSExtValue());
+  SmallVector<int64_t> meshStrides = computeStrides(meshShape);
+  SmallVector<int64_t> tileStrides =
+      computeStrides(applyPermutation(meshShape, axes));
+  SmallVector<int64_t> devices;
+  for (int64_t tile = 0, e = ids.size(); tile < e; ++tile) {
+    int64_t index = 0;
+    for (auto [coord, axis] : llvm::zip_equal(delinearize(tile, tileStrides),
+                                              axes))
+      index += coord * meshStrides[axis];
+    devices.push_back(ids[index]);
+  }
+
+  std::string result;
+  llvm::raw_string_ostream os(result);
+  os << "{devices=[";
+  llvm::interleave(tiles, os, ",");
+  os << "]";
+  llvm::interleave(devices, os, ",");
+  if (replicas > 1)
+    os << " last_tile_dim_replicate";
+  os << "}";
+  return result;
+}
+
+LogicalResult
+mlir::torch::torch_to_stablehlo::annotateShardings(func::FuncOp func) {
+  SmallVector<Operation *> shardedOps;
+  func.walk([&](Operation *op) {
+    if (op->hasAttr(kShardingAttr))
+      shardedOps.push_back(op);
+  });
+  auto isSharded = [&](ArrayRef<DictionaryAttr> attrs) {
+    return llvm::any_of(attrs, [](DictionaryAttr dict) {
+      return dict && dict.contains(kShardingAttr);
+    });
+  };
+  SmallVector<DictionaryAttr> argAttrs, resultAttrs;
+  func.getAllArgAttrs(argAttrs);
+  func.getAllResultAttrs(resultAttrs);
+  if (shardedOps.empty() && !isSharded(argAttrs) && !isSharded(resultAttrs))
+    return success();
+
+  auto module = func->getParentOfType<ModuleOp>();
+  auto mesh = module
+                  ? module->getAttrOfType<DenseIntElementsAttr>(kDeviceMeshAttr)
+                  : DenseIntElementsAttr();
+  if (!mesh)
+    return func.emitError() << "sharded tensors require a `" << kDeviceMeshAttr
+                            << "` attribute on the module";
+  MLIRContext *context = func.getContext();
+  auto getAttr = [&](Location loc,
+                     DenseI64ArrayAttr sharding) -> FailureOr<StringAttr> {
+    FailureOr<std::string> gspmd =
+        getGspmdSharding(loc, sharding.asArrayRef(), mesh);
+    if (failed(gspmd))
+      return failure();
+    return StringAttr::get(context, *gspmd);
+  };
+
+  // Entry arguments and results are annotated in place.
+  for (unsigned i = 0, e = func.getNumArguments(); i < e; ++i) {
+    auto sharding = func.getArgAttrOfType<DenseI64ArrayAttr>(i, kShardingAttr);
+    if (!sharding)
+      continue;
+    FailureOr<StringAttr> attr =
+        getAttr(func.getArgument(i).getLoc(), sharding);
+    if (failed(attr))
+      return failure();
+    func.removeArgAttr(i, StringAttr::get(context, kShardingAttr));
+    func.setArgAttr(i, kMhloShardingAttr, *attr);
+  }
+  for (unsigned i = 0, e = func.getNumResults(); i < e; ++i) {
+    auto sharding =
+        func.getResultAttrOfType<DenseI64ArrayAttr>(i, kShardingAttr);
+    if (!sharding)
+      continue;
+    FailureOr<StringAttr> attr = getAttr(func.getLoc(), sharding);
+    if (failed(attr))
+      return failure();
+    func.removeResultAttr(i, StringAttr::get(context, kShardingAttr));
+    func.setResultAttr(i, kMhloShardingAttr, *attr);
+  }
+
+  // Other tensors are passed through a `Sharding` custom call, which stays
+  // in place of the op as it is converted.
+  OpBuilder b(context);
+  for (Operation *op : shardedOps) {
+    auto sharding = op->getAttrOfType<DenseI64ArrayAttr>(kShardingAttr);
+    op->removeAttr(kShardingAttr);
+    if (!sharding || op->getNumResults() != 1)
+      continue;
+    Value result = op->getResult(0);
+    auto type = dyn_cast<ValueTensorType>(result.getType());
+    if (!type || !type.hasSizes() ||
+        type.getSizes().size() != sharding.asArrayRef().size())
+      continue;
+    FailureOr<StringAttr> attr = getAttr(op->getLoc(), sharding);
+    if (failed(attr))
+      return failure();
+    Location loc = op->getLoc();
+    b.setInsertionPointAfter(op);
+    auto toBuiltin = TorchConversion::ToBuiltinTensorOp::create(
+        b, loc, type.toBuiltinTensor(), result);
+    auto customCall = stablehlo::CustomCallOp::create(
+        b, loc, TypeRange{toBuiltin.getType()}, ValueRange{toBuiltin},
+        ArrayRef<NamedAttribute>{
+            b.getNamedAttr("call_target_name", b.getStringAttr("Sharding")),
+            b.getNamedAttr(kMhloShardingAttr, *attr)});
+    auto fromBuiltin = TorchConversion::FromBuiltinTensorOp::create(
+        b, loc, type, customCall.getResult(0));
+    result.replaceAllUsesExcept(fromBuiltin, toBuiltin);
+  }
+  return success();
+}
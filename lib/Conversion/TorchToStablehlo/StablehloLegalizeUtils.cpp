@@ -133,6 +133,18 @@ template std::optional<Value> getConstTensor<int64_t>(PatternRewriter &,
                                                       ArrayRef<int64_t> vec,
                                                       ArrayRef<int64_t> shape);
 
+Value getConstIndexTensor(PatternRewriter &rewriter, Operation *op,
+                          ArrayRef<int64_t> values, ArrayRef<int64_t> shape,
+                          size_t dimSizeIndexBits) {
+  SmallVector<APInt> elements;
+  for (int64_t value : values)
+    elements.push_back(APInt(dimSizeIndexBits, value, /*isSigned=*/true));
+  auto constType =
+      RankedTensorType::get(shape, rewriter.getIntegerType(dimSizeIndexBits));
+  return stablehlo::ConstantOp::create(
+      rewriter, op->getLoc(), DenseElementsAttr::get(constType, elements));
+}
+
 template <typename T>
 static bool isInValidRange(bool isFloat, const double &doubleValue, bool isInt,
                            const int64_t &intValue) {
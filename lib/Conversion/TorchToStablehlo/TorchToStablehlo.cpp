@@ -18,6 +18,7 @@
 #include "stablehlo/dialect/ChloOps.h"
 #include "stablehlo/dialect/StablehloOps.h"
 #include "torch-mlir/Conversion/Passes.h"
+#include "torch-mlir/Conversion/Utils/Utils.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
 #include "torch-mlir/Dialect/TorchConversion/Transforms/BackendTypeConversion.h"
 
@@ -58,10 +59,14 @@ public:
     TorchConversion::setupBackendTypeConversionForStablehlo(target,
                                                             typeConverter);
 
+    if (failed(torch_to_stablehlo::annotateShardings(getOperation())))
+      return signalPassFailure();
+
     RewritePatternSet patterns(context);
 
     torch_to_stablehlo::TorchToStablehloOptions options{
-        enableStaticShape, enableI32Index ? 32u : 64u, allowNonFinites};
+        enableStaticShape, enableI32Index ? 32u : 64u, allowNonFinites,
+        globalPoolAsReduce, threadRngState};
     torch_to_stablehlo::populateBasicOpPatternsAndLegality(
         typeConverter, patterns, target, options);
     torch_to_stablehlo::populateViewLikeOpPatternsAndLegality(
@@ -76,13 +81,25 @@ public:
         typeConverter, patterns, target, options);
     torch_to_stablehlo::populateRngOpPatternsAndLegality(
         typeConverter, patterns, target, options);
+    torch_to_stablehlo::populateCollectiveOpPatternsAndLegality(
+        typeConverter, patterns, target, options);
     torch_to_stablehlo::populateUncategorizedPatternsAndLegality(
         typeConverter, patterns, target, options);
 
-    if (failed(applyPartialConversion(getOperation(), target,
-                                      std::move(patterns)))) {
+    PatternStatisticsListener statisticsListener;
+    ConversionConfig config;
+    if (patternStatistics)
+      config.listener = &statisticsListener;
+    LogicalResult converted = applyPartialConversion(
+        getOperation(), target, std::move(patterns), config);
+    if (patternStatistics)
+      statisticsListener.print(llvm::errs(), getArgument(), getOperation());
+    if (failed(converted)) {
       return signalPassFailure();
     }
+    if (threadRngState &&
+        failed(torch_to_stablehlo::threadRngState(getOperation())))
+      return signalPassFailure();
   }
 };
 
@@ -98,11 +115,15 @@ createConvertTorchToStablehloPass() {
 // parameters
 std::unique_ptr<OperationPass<func::FuncOp>>
 createConvertTorchToStablehloPass(bool enableStaticShape, bool enableI32Index,
-                                  bool allowNonFinites) {
+                                  bool allowNonFinites,
+                                  bool globalPoolAsReduce,
+                                  bool threadRngState) {
   ConvertTorchToStablehloOptions options;
   options.enableStaticShape = enableStaticShape;
   options.enableI32Index = enableI32Index;
   options.allowNonFinites = allowNonFinites;
+  options.globalPoolAsReduce = globalPoolAsReduce;
+  options.threadRngState = threadRngState;
   return std::make_unique<ConvertTorchToStablehlo>(options);
 }
 
@@ -34,7 +34,7 @@ Value getNormalizedDimSizeInternal(PatternRewriter &rewriter, Operation *op,
                                    Value index, Value dimSize) {
   auto loc = op->getLoc();
   Value zero = arith::ConstantOp::create(
-      rewriter, loc, rewriter.getIntegerAttr(rewriter.getI64Type(), 0));
+      rewriter, loc, rewriter.getIntegerAttr(index.getType(), 0));
 
   // To normalize index into range [-dimSize, dimSize]
   // index = min(max(-dimSize, index), dimSize)
@@ -115,33 +115,32 @@ FailureOr<Value> getDynamicSlice(PatternRewriter &rewriter, Operation *op,
   auto rank = inputTy.getRank();
 
   dim = (dim + rank) % rank;
+  // The torch ints are truncated first, so that the normalization of the
+  // indices is computed with `dimSizeIndexBits` bits too.
+  Type intType = rewriter.getIntegerType(dimSizeIndexBits);
+  auto toIntType = [&](Value value) -> Value {
+    if (dimSizeIndexBits == 32)
+      return arith::TruncIOp::create(rewriter, loc, intType, value);
+    return value;
+  };
   Value dimSize = arith::IndexCastOp::create(
-      rewriter, loc, rewriter.getI64Type(),
-      tensor::DimOp::create(rewriter, loc, input, dim));
+      rewriter, loc, intType, tensor::DimOp::create(rewriter, loc, input, dim));
 
   Value normStartIndex =
       startIndexOpt
-          ? getNormalizedDimSizeInternal(rewriter, op, *startIndexOpt, dimSize)
-          : arith::ConstantOp::create(
-                rewriter, loc,
-                rewriter.getIntegerAttr(rewriter.getI64Type(), 0));
+          ? getNormalizedDimSizeInternal(rewriter, op,
+                                         toIntType(*startIndexOpt), dimSize)
+          : arith::ConstantOp::create(rewriter, loc,
+                                      rewriter.getIntegerAttr(intType, 0));
   Value normEndIndex =
-      endIndexOpt
-          ? getNormalizedDimSizeInternal(rewriter, op, *endIndexOpt, dimSize)
-          : dimSize;
-  Value step = stepOpt ? *stepOpt
+      endIndexOpt ? getNormalizedDimSizeInternal(
+                        rewriter, op, toIntType(*endIndexOpt), dimSize)
+                  : dimSize;
+  Value step = stepOpt ? toIntType(*stepOpt)
                        : arith::ConstantOp::create(
                              rewriter, loc,
-                             rewriter.getIntegerAttr(rewriter.getI64Type(), 1));
-
-  if (dimSizeIndexBits == 32) {
-    Type intType = rewriter.getIntegerType(dimSizeIndexBits);
-    normStartIndex =
-        arith::TruncIOp::create(rewriter, loc, intType, normStartIndex);
-    normEndIndex =
-        arith::TruncIOp::create(rewriter, loc, intType, normEndIndex);
-    step = arith::TruncIOp::create(rewriter, loc, intType, step);
-  }
+                             rewriter.getIntegerAttr(intType, 1));
+
   FailureOr<SmallVector<Value, 4>> dimSizesInfo =
       hlo::getDimSizesOfTensor(rewriter, op, input, dimSizeIndexBits);
   if (failed(dimSizesInfo))
@@ -264,8 +263,13 @@ public:
     Value numel = shape::NumElementsOp::create(
         rewriter, loc,
         shape::ShapeOfOp::create(rewriter, loc, adaptor.getSelf()));
-    numel =
-        arith::IndexCastOp::create(rewriter, loc, rewriter.getI64Type(), numel);
+    const auto &options = ConvertAtenOp<AtenOpT>::getOptions();
+    Type intType = rewriter.getIntegerType(options.dimSizeIndexBits);
+    if (options.dimSizeIndexBits == 32) {
+      for (Value &dSize : dimSizes)
+        dSize = arith::TruncIOp::create(rewriter, loc, intType, dSize);
+    }
+    numel = arith::IndexCastOp::create(rewriter, loc, intType, numel);
 
     // note: assuming that -1 doesn't arise from dynamic value
     if (negOneIndex.size() == 1) {
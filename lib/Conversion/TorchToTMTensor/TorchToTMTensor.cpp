@@ -15,6 +15,7 @@
 #include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Pass/Pass.h"
 #include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorDialect.h"
 #include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorOps.h"
@@ -1551,6 +1552,106 @@ public:
 };
 } // namespace
 
+namespace {
+// aten::unique_consecutive groups the runs of equal consecutive elements of
+// its input, which tm_tensor.unique does in parallel loops, apart from the
+// numbering of the groups.
+class ConvertAtenUniqueConsecutiveOp
+    : public OpConversionPattern<AtenUniqueConsecutiveOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(AtenUniqueConsecutiveOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    Value input = adaptor.getSelf();
+    auto inputType = cast<RankedTensorType>(input.getType());
+    if (inputType.getRank() != 1)
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: only 1-d inputs are supported");
+    if (!isa<Torch::NoneType>(op.getDim().getType())) {
+      int64_t dim;
+      if (!matchPattern(op.getDim(), m_TorchConstantInt(&dim)))
+        return rewriter.notifyMatchFailure(
+            op, "unimplemented: only constant dim value is supported");
+      if (!isValidDim(toPositiveDim(dim, 1), 1))
+        return rewriter.notifyMatchFailure(op, "dim is statically invalid");
+    }
+
+    bool returnInverse, returnCounts;
+    if (!matchPattern(op.getReturnInverse(),
+                      m_TorchConstantBool(&returnInverse)) ||
+        !matchPattern(op.getReturnCounts(), m_TorchConstantBool(&returnCounts)))
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: only constant return_inverse and return_counts "
+              "values are supported");
+
+    SmallVector<RankedTensorType> resultTypes;
+    for (Value result : op->getResults()) {
+      auto resultType = dyn_cast_or_null<RankedTensorType>(
+          getTypeConverter()->convertType(result.getType()));
+      if (!resultType)
+        return rewriter.notifyMatchFailure(
+            op, "expected results to be ranked tensors");
+      resultTypes.push_back(resultType);
+    }
+
+    Value size = tensor::DimOp::create(rewriter, loc, input, 0);
+    Type i64Type = rewriter.getI64Type();
+    Value valuesInit = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(size), inputType.getElementType());
+    Value inverseInit = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(size), i64Type);
+    Value countsInit = tensor::EmptyOp::create(
+        rewriter, loc, getAsOpFoldResult(size), i64Type);
+    auto uniqueOp = TMTensor::UniqueOp::create(
+        rewriter, loc,
+        TypeRange{valuesInit.getType(), inverseInit.getType(),
+                  countsInit.getType()},
+        ValueRange{input}, ValueRange{valuesInit, inverseInit, countsInit});
+    Value values = uniqueOp.getResult(0);
+    Value inverse = uniqueOp.getResult(1);
+    Value counts = uniqueOp.getResult(2);
+
+    // The number of groups is one more than the group of the last element.
+    Value cstZero = arith::ConstantIndexOp::create(rewriter, loc, 0);
+    Value cstOne = arith::ConstantIndexOp::create(rewriter, loc, 1);
+    Value last = arith::SubIOp::create(
+        rewriter, loc, arith::MaxUIOp::create(rewriter, loc, size, cstOne),
+        cstOne);
+    Value lastGroup = castIntToIndex(
+        rewriter, loc,
+        tensor::ExtractOp::create(rewriter, loc, inverse, ValueRange{last}));
+    Value isEmpty = arith::CmpIOp::create(
+        rewriter, loc, arith::CmpIPredicate::eq, size, cstZero);
+    Value numGroups = arith::SelectOp::create(
+        rewriter, loc, isEmpty, cstZero,
+        arith::AddIOp::create(rewriter, loc, lastGroup, cstOne));
+
+    auto takeGroups = [&](Value v) -> Value {
+      return tensor::ExtractSliceOp::create(
+          rewriter, loc, v, ArrayRef<OpFoldResult>{rewriter.getIndexAttr(0)},
+          ArrayRef<OpFoldResult>{numGroups},
+          ArrayRef<OpFoldResult>{rewriter.getIndexAttr(1)});
+    };
+    auto emptyResult = [&](RankedTensorType resultType) -> Value {
+      return tensor::EmptyOp::create(rewriter, loc, ArrayRef<int64_t>{0},
+                                     resultType.getElementType());
+    };
+    Value results[] = {
+        takeGroups(values),
+        returnInverse ? inverse : emptyResult(resultTypes[1]),
+        returnCounts ? takeGroups(counts) : emptyResult(resultTypes[2])};
+    SmallVector<Value> castResults;
+    for (auto [result, resultType] : llvm::zip_equal(results, resultTypes))
+      castResults.push_back(
+          tensor::CastOp::create(rewriter, loc, resultType, result));
+    rewriter.replaceOp(op, castResults);
+    return success();
+  }
+};
+} // namespace
+
 namespace {
 class ConvertAtenCumprodOp : public OpConversionPattern<AtenCumprodOp> {
 public:
@@ -1713,84 +1814,84 @@ public:
 };
 } // namespace
 
-namespace {
-class ConvertAtenScaledDotProductAttentionOp
-    : public OpConversionPattern<AtenScaledDotProductAttentionOp> {
-public:
-  using OpConversionPattern::OpConversionPattern;
-
-  static LogicalResult
-  preProcessGroupQueryAttentionInput(AtenScaledDotProductAttentionOp op,
-                                     ConversionPatternRewriter &rewriter,
-                                     const TypeConverter *typeConverter,
-                                     Value query, Value &key, Value &value) {
-    auto queryTy = cast<ShapedType>(query.getType());
-    auto valueTy = cast<ShapedType>(value.getType());
-    auto keyTy = cast<ShapedType>(key.getType());
-
-    int64_t rank = queryTy.getRank();
-
-    int64_t qNumHeads = queryTy.getDimSize(rank - 3);
-    int64_t vNumHeads = valueTy.getDimSize(rank - 3);
-    int64_t kNumHeads = keyTy.getDimSize(rank - 3);
-
-    if (llvm::any_of(llvm::ArrayRef<int64_t>{qNumHeads, kNumHeads, vNumHeads},
-                     [](int64_t d) { return d == Torch::kUnknownSize; })) {
-      return llvm::failure();
-    }
+// Repeats the heads of the `key` and `value` of the attention `op`, whose
+// Torch key and value are `torchKey` and `torchValue`, to as many as the
+// `query` has, for grouped-query attention.
+static LogicalResult preProcessGroupQueryAttentionInput(
+    Operation *op, Value torchKey, Value torchValue,
+    ConversionPatternRewriter &rewriter, const TypeConverter *typeConverter,
+    Value query, Value &key, Value &value) {
+  auto queryTy = cast<ShapedType>(query.getType());
+  auto valueTy = cast<ShapedType>(value.getType());
+  auto keyTy = cast<ShapedType>(key.getType());
+
+  int64_t rank = queryTy.getRank();
+
+  int64_t qNumHeads = queryTy.getDimSize(rank - 3);
+  int64_t vNumHeads = valueTy.getDimSize(rank - 3);
+  int64_t kNumHeads = keyTy.getDimSize(rank - 3);
+
+  if (llvm::any_of(llvm::ArrayRef<int64_t>{qNumHeads, kNumHeads, vNumHeads},
+                   [](int64_t d) { return d == Torch::kUnknownSize; })) {
+    return llvm::failure();
+  }
 
-    if (llvm::all_equal(
-            llvm::ArrayRef<int64_t>{qNumHeads, kNumHeads, vNumHeads}))
-      return llvm::success();
+  if (llvm::all_equal(llvm::ArrayRef<int64_t>{qNumHeads, kNumHeads, vNumHeads}))
+    return llvm::success();
 
-    if ((qNumHeads % kNumHeads) && (qNumHeads % vNumHeads))
-      return llvm::failure();
+  if ((qNumHeads % kNumHeads) && (qNumHeads % vNumHeads))
+    return llvm::failure();
 
-    int64_t repeatKeyShape = qNumHeads / kNumHeads;
-    int64_t repeatValueShape = qNumHeads / vNumHeads;
+  int64_t repeatKeyShape = qNumHeads / kNumHeads;
+  int64_t repeatValueShape = qNumHeads / vNumHeads;
 
-    Location loc = op.getLoc();
+  Location loc = op->getLoc();
 
-    // Build result types from key/value types with the head dim changed to
-    // qNumHeads. Using the query type as resType is incorrect because the
-    // query and key/value may differ in non-head dimensions (e.g. sequence
-    // length).
-    auto keyBaseTy = cast<BaseTensorType>(op.getKey().getType());
-    SmallVector<int64_t> keyResShape(keyBaseTy.getSizes());
-    keyResShape[rank - 3] = qNumHeads;
-    Type keyResType = rewriter.getType<ValueTensorType>(
-        keyResShape, keyBaseTy.getOptionalDtype());
-
-    auto valueBaseTy = cast<BaseTensorType>(op.getValue().getType());
-    SmallVector<int64_t> valueResShape(valueBaseTy.getSizes());
-    valueResShape[rank - 3] = qNumHeads;
-    Type valueResType = rewriter.getType<ValueTensorType>(
-        valueResShape, valueBaseTy.getOptionalDtype());
-
-    FailureOr<Value> keyRepeated = repeatTensorElementsForDim(
-        op.getOperation(), rewriter, /*resType=*/keyResType, op.getKey(),
-        /*repeats=*/repeatKeyShape, /*dim=*/rank - 3);
-    if (failed(keyRepeated))
-      return rewriter.notifyMatchFailure(
-          loc, "Failed to repeat the tensor elements for key.");
+  // Build result types from key/value types with the head dim changed to
+  // qNumHeads. Using the query type as resType is incorrect because the
+  // query and key/value may differ in non-head dimensions (e.g. sequence
+  // length).
+  auto keyBaseTy = cast<BaseTensorType>(torchKey.getType());
+  SmallVector<int64_t> keyResShape(keyBaseTy.getSizes());
+  keyResShape[rank - 3] = qNumHeads;
+  Type keyResType = rewriter.getType<ValueTensorType>(
+      keyResShape, keyBaseTy.getOptionalDtype());
+
+  auto valueBaseTy = cast<BaseTensorType>(torchValue.getType());
+  SmallVector<int64_t> valueResShape(valueBaseTy.getSizes());
+  valueResShape[rank - 3] = qNumHeads;
+  Type valueResType = rewriter.getType<ValueTensorType>(
+      valueResShape, valueBaseTy.getOptionalDtype());
+
+  FailureOr<Value> keyRepeated = repeatTensorElementsForDim(
+      op, rewriter, /*resType=*/keyResType, torchKey,
+      /*repeats=*/repeatKeyShape, /*dim=*/rank - 3);
+  if (failed(keyRepeated))
+    return rewriter.notifyMatchFailure(
+        loc, "Failed to repeat the tensor elements for key.");
 
-    FailureOr<Value> valueRepeated = repeatTensorElementsForDim(
-        op.getOperation(), rewriter, /*resType=*/valueResType, op.getValue(),
-        /*repeats=*/repeatValueShape, /*dim=*/rank - 3);
-    if (failed(valueRepeated))
-      return rewriter.notifyMatchFailure(
-          loc, "Failed to repeat the tensor elements for value.");
+  FailureOr<Value> valueRepeated = repeatTensorElementsForDim(
+      op, rewriter, /*resType=*/valueResType, torchValue,
+      /*repeats=*/repeatValueShape, /*dim=*/rank - 3);
+  if (failed(valueRepeated))
+    return rewriter.notifyMatchFailure(
+        loc, "Failed to repeat the tensor elements for value.");
+
+  key = typeConverter->materializeTargetConversion(
+      rewriter, loc, typeConverter->convertType(keyRepeated.value().getType()),
+      keyRepeated.value());
+  value = typeConverter->materializeTargetConversion(
+      rewriter, loc,
+      typeConverter->convertType(valueRepeated.value().getType()),
+      valueRepeated.value());
+  return success();
+}
 
-    key = typeConverter->materializeTargetConversion(
-        rewriter, loc,
-        typeConverter->convertType(keyRepeated.value().getType()),
-        keyRepeated.value());
-    value = typeConverter->materializeTargetConversion(
-        rewriter, loc,
-        typeConverter->convertType(valueRepeated.value().getType()),
-        valueRepeated.value());
-    return success();
-  }
+namespace {
+class ConvertAtenScaledDotProductAttentionOp
+    : public OpConversionPattern<AtenScaledDotProductAttentionOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
 
   LogicalResult
   matchAndRewrite(AtenScaledDotProductAttentionOp op, OpAdaptor adaptor,
@@ -1818,13 +1919,18 @@ public:
         dropout > 0.0)
       return rewriter.notifyMatchFailure(loc, "dropout not supported");
 
+    // A constant is_causal is applied by tm_tensor.attention itself, which
+    // then skips the masked out keys instead of materializing a mask.
     bool causal;
-    if (!matchPattern(isCausal, m_TorchConstantBool(&causal)) || causal) {
+    bool isCausalConstant =
+        matchPattern(isCausal, m_TorchConstantBool(&causal));
+    if (!isCausalConstant || causal) {
       if (!isa<Torch::NoneType>(mask.getType())) {
         return rewriter.notifyMatchFailure(
             loc, "expected no attention mask when isCausal is true");
       }
-
+    }
+    if (!isCausalConstant) {
       SmallVector<int64_t> maskStatic;
       SmallVector<Value> maskDyn;
       for (int i = 0, s = queryTy.getRank() - 1; i < s; ++i) {
@@ -1962,7 +2068,8 @@ public:
     // https://github.com/pytorch/pytorch/pull/132689/files#diff-e726853e9795dfb6c74ab1e10945f5d5f24540eb7bc633e5c76f69bc258f24d6R612
     if (enableGQA) {
       if (failed(preProcessGroupQueryAttentionInput(
-              op, rewriter, getTypeConverter(), query, key, value)))
+              op, op.getKey(), op.getValue(), rewriter, getTypeConverter(),
+              query, key, value)))
         return failure();
     }
 
@@ -2020,9 +2127,13 @@ public:
     }
 
     // Overwrite with tm_tensor::attention
-    Value attention = AttentionOp::create(rewriter, loc, outType, inputs,
-                                          SmallVector<Value>{output}, scaleAttr)
-                          .getResult()[0];
+    UnitAttr causalAttr =
+        isCausalConstant && causal ? rewriter.getUnitAttr() : UnitAttr();
+    Value attention =
+        AttentionOp::create(rewriter, loc, outType, inputs,
+                            SmallVector<Value>{output}, scaleAttr, causalAttr,
+                            /*window_size=*/IntegerAttr())
+            .getResult()[0];
 
     if (opTy != outType) {
       attention = tensor::ExpandShapeOp::create(rewriter, loc, opTy, attention,
@@ -2036,6 +2147,462 @@ public:
 };
 } // namespace
 
+// The dtype of a value of a score_mod or mask_mod function of
+// hop_flex_attention, which is a 0-d tensor or a number, or a null type.
+static Type getFlexAttentionModDtype(Value v) {
+  MLIRContext *context = v.getContext();
+  Type type = v.getType();
+  if (auto tensorType = dyn_cast<ValueTensorType>(type)) {
+    if (!tensorType.hasSizes() || !tensorType.getSizes().empty() ||
+        !tensorType.hasDtype())
+      return Type();
+    return tensorType.getDtype();
+  }
+  if (isa<Torch::IntType>(type))
+    return IntegerType::get(context, 64, IntegerType::Signed);
+  if (isa<Torch::FloatType>(type))
+    return Float64Type::get(context);
+  if (isa<Torch::BoolType>(type))
+    return IntegerType::get(context, 1);
+  return Type();
+}
+
+// The builtin type of the scalars of `dtype`.
+static Type getFlexAttentionModScalarType(Type dtype) {
+  if (auto integerType = dyn_cast<mlir::IntegerType>(dtype))
+    return IntegerType::get(dtype.getContext(), integerType.getWidth());
+  return dtype;
+}
+
+// The predicates of a comparison op of a score_mod or mask_mod function.
+// Integers are compared as signed.
+static std::optional<std::pair<arith::CmpFPredicate, arith::CmpIPredicate>>
+getFlexAttentionModPredicates(Operation *op) {
+  using FP = arith::CmpFPredicate;
+  using IP = arith::CmpIPredicate;
+  if (isa<AtenGeTensorOp, AtenGeScalarOp>(op))
+    return std::make_pair(FP::OGE, IP::sge);
+  if (isa<AtenGtTensorOp, AtenGtScalarOp>(op))
+    return std::make_pair(FP::OGT, IP::sgt);
+  if (isa<AtenLeTensorOp, AtenLeScalarOp>(op))
+    return std::make_pair(FP::OLE, IP::sle);
+  if (isa<AtenLtTensorOp, AtenLtScalarOp>(op))
+    return std::make_pair(FP::OLT, IP::slt);
+  if (isa<AtenEqTensorOp, AtenEqScalarOp>(op))
+    return std::make_pair(FP::OEQ, IP::eq);
+  if (isa<AtenNeTensorOp, AtenNeScalarOp>(op))
+    return std::make_pair(FP::UNE, IP::ne);
+  return std::nullopt;
+}
+
+// Creates a `FloatOpTy` on float operands, else an `IntOpTy`.
+template <typename FloatOpTy, typename IntOpTy>
+static Value createFlexAttentionModBinaryOp(OpBuilder &b, Location loc,
+                                            Value lhs, Value rhs) {
+  if (isa<mlir::FloatType>(lhs.getType()))
+    return FloatOpTy::create(b, loc, lhs, rhs);
+  return IntOpTy::create(b, loc, lhs, rhs);
+}
+
+// Translates the body of the score_mod or mask_mod function `fn` of a
+// hop_flex_attention, whose ops compute on 0-d tensors, into scalar ops on
+// the arguments of `block` that yield a `resultType`. The index arguments of
+// `block` are cast to the dtypes of the corresponding arguments of `fn`.
+// Fails on the ops that have no scalar translation here.
+static LogicalResult buildFlexAttentionModBlock(OpBuilder &b, Location loc,
+                                                func::FuncOp fn, Block &block,
+                                                Type resultType) {
+  if (!fn || fn.isExternal() || !llvm::hasSingleElement(fn.getBody()) ||
+      fn.getNumArguments() != block.getNumArguments())
+    return failure();
+  MLIRContext *context = b.getContext();
+  OpBuilder::InsertionGuard guard(b);
+  b.setInsertionPointToStart(&block);
+
+  DenseMap<Value, Value> scalars;
+  // The scalar of `v` converted to `dtype`, or null if `v` is unknown.
+  auto lookup = [&](Value v, Type dtype) -> Value {
+    Value scalar = scalars.lookup(v);
+    Type srcDtype = getFlexAttentionModDtype(v);
+    if (!scalar || !srcDtype || !dtype)
+      return Value();
+    return convertScalarToDtype(b, loc, scalar,
+                                getFlexAttentionModScalarType(dtype), srcDtype,
+                                dtype);
+  };
+
+  for (auto [fnArg, blockArg] :
+       llvm::zip_equal(fn.getArguments(), block.getArguments())) {
+    Type dtype = getFlexAttentionModDtype(fnArg);
+    if (!dtype)
+      return failure();
+    Type scalarType = getFlexAttentionModScalarType(dtype);
+    Value scalar = blockArg;
+    if (isa<IndexType>(blockArg.getType())) {
+      if (!isa<mlir::IntegerType>(scalarType))
+        return failure();
+      scalar = arith::IndexCastOp::create(b, loc, scalarType, blockArg);
+    } else {
+      scalar = convertScalarToDtype(b, loc, blockArg, scalarType,
+                                    /*srcOriginalDtype=*/std::nullopt, dtype);
+    }
+    scalars[fnArg] = scalar;
+  }
+
+  for (Operation &op : fn.getBody().front()) {
+    if (auto returnOp = dyn_cast<func::ReturnOp>(op)) {
+      if (returnOp.getNumOperands() != 1)
+        return failure();
+      Value returned = returnOp.getOperand(0);
+      Value scalar = scalars.lookup(returned);
+      if (!scalar)
+        return failure();
+      TMTensor::YieldOp::create(
+          b, loc,
+          convertScalarToDtype(b, loc, scalar, resultType,
+                               getFlexAttentionModDtype(returned)));
+      return success();
+    }
+
+    if (op.getNumResults() != 1)
+      return failure();
+    Type dtype = getFlexAttentionModDtype(op.getResult(0));
+    if (!dtype)
+      return failure();
+    Type type = getFlexAttentionModScalarType(dtype);
+    bool isFloat = isa<mlir::FloatType>(type);
+    // The operands `indices` of `op`, converted to `operandDtype`.
+    auto getOperands = [&](ArrayRef<unsigned> indices, Type operandDtype) {
+      SmallVector<Value> operands;
+      for (unsigned index : indices) {
+        Value operand = lookup(op.getOperand(index), operandDtype);
+        if (!operand)
+          return SmallVector<Value>();
+        operands.push_back(operand);
+      }
+      return operands;
+    };
+
+    Value result;
+    int64_t intValue;
+    double floatValue;
+    bool boolValue;
+    if (matchPattern(op.getResult(0), m_TorchConstantInt(&intValue))) {
+      result = arith::ConstantOp::create(b, loc, b.getI64IntegerAttr(intValue));
+    } else if (matchPattern(op.getResult(0),
+                            m_TorchConstantFloat(&floatValue))) {
+      result = arith::ConstantOp::create(b, loc, b.getF64FloatAttr(floatValue));
+    } else if (matchPattern(op.getResult(0),
+                            m_TorchConstantBool(&boolValue))) {
+      result = arith::ConstantOp::create(
+          b, loc, b.getIntegerAttr(b.getI1Type(), boolValue));
+    } else if (auto literal = dyn_cast<ValueTensorLiteralOp>(op)) {
+      auto attr = dyn_cast<DenseElementsAttr>(literal.getValue());
+      if (!attr || !attr.isSplat())
+        return failure();
+      TypedAttr scalarAttr =
+          isFloat ? TypedAttr(
+                        b.getFloatAttr(type, attr.getSplatValue<APFloat>()))
+                  : TypedAttr(
+                        b.getIntegerAttr(type, attr.getSplatValue<APInt>()));
+      result = arith::ConstantOp::create(b, loc, scalarAttr);
+    } else if (auto predicates = getFlexAttentionModPredicates(&op)) {
+      // Compare in the first float dtype of the operands, if any.
+      Type cmpDtype = IntegerType::get(context, 64, IntegerType::Signed);
+      for (Value operand : op.getOperands()) {
+        Type operandDtype = getFlexAttentionModDtype(operand);
+        if (operandDtype && isa<mlir::FloatType>(operandDtype)) {
+          cmpDtype = operandDtype;
+          break;
+        }
+      }
+      SmallVector<Value> operands = getOperands({0, 1}, cmpDtype);
+      if (operands.empty())
+        return failure();
+      if (isa<mlir::FloatType>(cmpDtype))
+        result = arith::CmpFOp::create(b, loc, predicates->first, operands[0],
+                                       operands[1]);
+      else
+        result = arith::CmpIOp::create(b, loc, predicates->second,
+                                       operands[0], operands[1]);
+      result = convertScalarToDtype(b, loc, result, type);
+    } else if (isa<AtenAddTensorOp, AtenSubTensorOp, AtenAddScalarOp,
+                   AtenSubScalarOp>(op)) {
+      int64_t alpha;
+      SmallVector<Value> operands = getOperands({0, 1}, dtype);
+      if (operands.empty() ||
+          !matchPattern(op.getOperand(2), m_TorchConstantInt(&alpha)) ||
+          alpha != 1)
+        return failure();
+      if (isa<AtenAddTensorOp, AtenAddScalarOp>(op))
+        result = createFlexAttentionModBinaryOp<arith::AddFOp, arith::AddIOp>(
+            b, loc, operands[0], operands[1]);
+      else
+        result = createFlexAttentionModBinaryOp<arith::SubFOp, arith::SubIOp>(
+            b, loc, operands[0], operands[1]);
+    } else if (isa<AtenMulTensorOp, AtenMulScalarOp, AtenDivTensorOp,
+                   AtenDivScalarOp, AtenMaximumOp, AtenMinimumOp>(op)) {
+      SmallVector<Value> operands = getOperands({0, 1}, dtype);
+      if (operands.empty())
+        return failure();
+      Value lhs = operands[0], rhs = operands[1];
+      if (isa<AtenMulTensorOp, AtenMulScalarOp>(op))
+        result = createFlexAttentionModBinaryOp<arith::MulFOp, arith::MulIOp>(
+            b, loc, lhs, rhs);
+      else if (isa<AtenMaximumOp>(op))
+        result =
+            createFlexAttentionModBinaryOp<arith::MaximumFOp, arith::MaxSIOp>(
+                b, loc, lhs, rhs);
+      else if (isa<AtenMinimumOp>(op))
+        result =
+            createFlexAttentionModBinaryOp<arith::MinimumFOp, arith::MinSIOp>(
+                b, loc, lhs, rhs);
+      else if (isFloat)
+        result = arith::DivFOp::create(b, loc, lhs, rhs);
+      else
+        return failure();
+    } else if (isa<AtenBitwiseAndTensorOp, AtenLogicalAndOp,
+                   AtenBitwiseOrTensorOp, AtenLogicalOrOp,
+                   AtenBitwiseXorTensorOp>(op)) {
+      // The logical ops have a bool result, to which their operands are
+      // converted.
+      SmallVector<Value> operands = getOperands({0, 1}, dtype);
+      if (operands.empty() || isFloat)
+        return failure();
+      if (isa<AtenBitwiseAndTensorOp, AtenLogicalAndOp>(op))
+        result = arith::AndIOp::create(b, loc, operands[0], operands[1]);
+      else if (isa<AtenBitwiseOrTensorOp, AtenLogicalOrOp>(op))
+        result = arith::OrIOp::create(b, loc, operands[0], operands[1]);
+      else
+        result = arith::XOrIOp::create(b, loc, operands[0], operands[1]);
+    } else if (isa<AtenLogicalNotOp>(op)) {
+      SmallVector<Value> operands = getOperands({0}, dtype);
+      if (operands.empty() || !type.isSignlessInteger(1))
+        return failure();
+      Value trueValue =
+          arith::ConstantOp::create(b, loc, b.getIntegerAttr(type, 1));
+      result = arith::XOrIOp::create(b, loc, operands[0], trueValue);
+    } else if (isa<AtenWhereSelfOp, AtenWhereScalarOp, AtenWhereScalarOtherOp,
+                   AtenWhereScalarSelfOp>(op)) {
+      Value condition = lookup(op.getOperand(0), b.getI1Type());
+      SmallVector<Value> operands = getOperands({1, 2}, dtype);
+      if (!condition || operands.empty())
+        return failure();
+      result =
+          arith::SelectOp::create(b, loc, condition, operands[0], operands[1]);
+    } else if (isa<AtenNegOp, AtenAbsOp, AtenExpOp, AtenTanhOp>(op)) {
+      SmallVector<Value> operands = getOperands({0}, dtype);
+      if (operands.empty())
+        return failure();
+      Value x = operands[0];
+      if (isa<AtenNegOp>(op) && isFloat)
+        result = arith::NegFOp::create(b, loc, x);
+      else if (isa<AtenNegOp>(op))
+        result = arith::SubIOp::create(
+            b, loc,
+            arith::ConstantOp::create(b, loc, b.getIntegerAttr(type, 0)), x);
+      else if (isa<AtenAbsOp>(op) && isFloat)
+        result = math::AbsFOp::create(b, loc, x);
+      else if (isa<AtenAbsOp>(op))
+        result = math::AbsIOp::create(b, loc, x);
+      else if (!isFloat)
+        return failure();
+      else if (isa<AtenExpOp>(op))
+        result = math::ExpOp::create(b, loc, x);
+      else
+        result = math::TanhOp::create(b, loc, x);
+    } else if (isa<AtenToDtypeOp, PrimsConvertElementTypeOp>(op)) {
+      SmallVector<Value> operands = getOperands({0}, dtype);
+      if (operands.empty())
+        return failure();
+      result = operands[0];
+    } else {
+      return failure();
+    }
+    scalars[op.getResult(0)] = result;
+  }
+  return failure();
+}
+
+namespace {
+// Lowers hop_flex_attention to tm_tensor.attention, whose `score_mod` and
+// `mask_mod` regions take the translations of the score_mod and mask_mod
+// functions. The scores of the keys that `mask_mod` masks out are then
+// never computed, instead of materializing a mask of every query and key.
+class ConvertHigherOrderFlexAttentionOp
+    : public OpConversionPattern<HigherOrderFlexAttentionOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+  LogicalResult
+  matchAndRewrite(HigherOrderFlexAttentionOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    MLIRContext *context = op.getContext();
+    bool returnLse, returnMaxScores;
+    if (!matchPattern(op.getReturnLse(), m_TorchConstantBool(&returnLse)) ||
+        !matchPattern(op.getReturnMaxScores(),
+                      m_TorchConstantBool(&returnMaxScores)) ||
+        returnLse || returnMaxScores || !op.getLogsumexp().use_empty() ||
+        !op.getMaxScores().use_empty())
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: logsumexp and max_scores results");
+
+    Value query = adaptor.getQuery();
+    Value key = adaptor.getKey();
+    Value value = adaptor.getValue();
+    auto queryTy = cast<RankedTensorType>(query.getType());
+    auto keyTy = cast<RankedTensorType>(key.getType());
+    auto valueTy = cast<RankedTensorType>(value.getType());
+    if (queryTy.getRank() != 4 || keyTy.getRank() != 4 ||
+        valueTy.getRank() != 4)
+      return rewriter.notifyMatchFailure(
+          op, "expected query, key and value of rank 4");
+    Type elementType = queryTy.getElementType();
+    if (!isa<mlir::FloatType>(elementType))
+      return rewriter.notifyMatchFailure(op, "expected float operands");
+
+    FloatAttr scaleAttr;
+    if (!isa<Torch::NoneType>(op.getScale().getType())) {
+      double scale;
+      if (!matchPattern(op.getScale(), m_TorchConstantFloat(&scale)))
+        return rewriter.notifyMatchFailure(op, "scale must be a constant");
+      scaleAttr = rewriter.getF64FloatAttr(scale);
+    }
+
+    // Translate the functions before creating any op, since they may not
+    // have a translation.
+    auto buildModBlock = [&](FlatSymbolRefAttr fnName, bool takesScore,
+                             Type resultType) -> FailureOr<Block *> {
+      if (!fnName)
+        return static_cast<Block *>(nullptr);
+      auto fn =
+          SymbolTable::lookupNearestSymbolFrom<func::FuncOp>(op, fnName);
+      auto block = std::make_unique<Block>();
+      if (takesScore)
+        block->addArgument(elementType, loc);
+      for (int64_t i = 0; i < 4; ++i)
+        block->addArgument(rewriter.getIndexType(), loc);
+      OpBuilder b(context);
+      if (failed(buildFlexAttentionModBlock(b, loc, fn, *block, resultType)))
+        return failure();
+      return block.release();
+    };
+    FailureOr<Block *> scoreModBlock =
+        buildModBlock(op.getScoreModFnAttr(), /*takesScore=*/true, elementType);
+    if (failed(scoreModBlock))
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: ops of the score_mod function");
+    std::unique_ptr<Block> scoreModOwner(*scoreModBlock);
+    FailureOr<Block *> maskModBlock =
+        buildModBlock(op.getMaskModFnAttr(), /*takesScore=*/false,
+                      rewriter.getI1Type());
+    if (failed(maskModBlock))
+      return rewriter.notifyMatchFailure(
+          op, "unimplemented: ops of the mask_mod function");
+    std::unique_ptr<Block> maskModOwner(*maskModBlock);
+
+    // Repeat the heads of the key and value for grouped-query attention,
+    // unless `enable_gqa` rules it out.
+    if (queryTy.getDimSize(1) != keyTy.getDimSize(1) ||
+        queryTy.getDimSize(1) != valueTy.getDimSize(1)) {
+      if (!op.getEnableGqa().value_or(true) ||
+          failed(preProcessGroupQueryAttentionInput(
+              op, op.getKey(), op.getValue(), rewriter, getTypeConverter(),
+              query, key, value)))
+        return rewriter.notifyMatchFailure(
+            op, "unsupported numbers of key and value heads");
+    }
+
+    SmallVector<int64_t> outShape(queryTy.getShape());
+    outShape.back() = valueTy.getShape().back();
+    SmallVector<Value> outSizes = getTensorSizes(rewriter, loc, query);
+    outSizes.back() = getTensorSizes(rewriter, loc, value).back();
+    Value output = createZeroInitTensor(rewriter, loc, outSizes, elementType);
+    Type outType = RankedTensorType::get(outShape, elementType);
+
+    auto attention = AttentionOp::create(rewriter, loc, outType,
+                                         ValueRange{query, key, value},
+                                         ValueRange{output}, scaleAttr);
+    if (scoreModOwner)
+      attention.getScoreMod().push_back(scoreModOwner.release());
+    if (maskModOwner)
+      attention.getMaskMod().push_back(maskModOwner.release());
+
+    auto resultType = cast<RankedTensorType>(
+        getTypeConverter()->convertType(op.getOutput().getType()));
+    Value result = tensor::CastOp::create(rewriter, loc, resultType,
+                                          attention.getResult()[0]);
+    rewriter.replaceOp(op, {result, Value(), Value()});
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Lowers the custom op torch_mlir::paged_attention(query, key_cache,
+// value_cache, block_tables, context_lens, scale=None) to
+// tm_tensor.paged_attention. It has no registered Torch op, so it reaches
+// the backend as a torch.operator, which the backend contract keeps when its
+// name is among the backend legal ops.
+class ConvertPagedAttentionOperatorOp
+    : public OpConversionPattern<OperatorOp> {
+public:
+  using OpConversionPattern::OpConversionPattern;
+
+  static constexpr StringLiteral kName = "torch.torch_mlir.paged_attention";
+
+  LogicalResult
+  matchAndRewrite(OperatorOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (op.getName() != kName)
+      return failure();
+    Location loc = op.getLoc();
+    ValueRange operands = adaptor.getOperands();
+    if ((operands.size() != 5 && operands.size() != 6) ||
+        op->getNumResults() != 1)
+      return rewriter.notifyMatchFailure(
+          op, "expected five tensors, an optional scale and one result");
+    SmallVector<Value> inputs(operands.take_front(5));
+    if (!llvm::all_of(inputs, [](Value v) {
+          return isa<RankedTensorType>(v.getType());
+        }))
+      return rewriter.notifyMatchFailure(op, "expected ranked tensors");
+    auto queryTy = cast<RankedTensorType>(inputs[0].getType());
+    auto valueTy = cast<RankedTensorType>(inputs[2].getType());
+    if (queryTy.getRank() != 3 || valueTy.getRank() != 4)
+      return rewriter.notifyMatchFailure(
+          op, "expected query of rank 3 and value cache of rank 4");
+    Type elementType = queryTy.getElementType();
+    if (!isa<mlir::FloatType>(elementType))
+      return rewriter.notifyMatchFailure(op, "expected float operands");
+
+    FloatAttr scaleAttr;
+    if (op.getOperands().size() == 6 &&
+        !isa<Torch::NoneType>(op.getOperands()[5].getType())) {
+      double scale;
+      if (!matchPattern(op.getOperands()[5], m_TorchConstantFloat(&scale)))
+        return rewriter.notifyMatchFailure(op, "scale must be a constant");
+      scaleAttr = rewriter.getF64FloatAttr(scale);
+    }
+
+    SmallVector<int64_t> outShape(queryTy.getShape());
+    outShape.back() = valueTy.getShape().back();
+    SmallVector<Value> outSizes = getTensorSizes(rewriter, loc, inputs[0]);
+    outSizes.back() = getTensorSizes(rewriter, loc, inputs[2]).back();
+    Value output = createZeroInitTensor(rewriter, loc, outSizes, elementType);
+    Type outType = RankedTensorType::get(outShape, elementType);
+
+    auto paged = PagedAttentionOp::create(rewriter, loc, outType, inputs,
+                                          ValueRange{output}, scaleAttr);
+    auto resultType = cast<RankedTensorType>(
+        getTypeConverter()->convertType(op->getResult(0).getType()));
+    rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType,
+                                                paged.getResult()[0]);
+    return success();
+  }
+};
+} // namespace
+
 namespace {
 class ConvertAtenKthvalueOp : public OpConversionPattern<AtenKthvalueOp> {
 
@@ -2547,6 +3114,8 @@ public:
                                                 this->allowNonFinites);
     target.addIllegalOp<AtenSortOp>();
     patterns.add<ConvertAtenSortOp>(typeConverter, context);
+    target.addIllegalOp<AtenUniqueConsecutiveOp>();
+    patterns.add<ConvertAtenUniqueConsecutiveOp>(typeConverter, context);
     target.addIllegalOp<AtenCumsumOp>();
     patterns.add<ConvertAtenCumsumOp>(typeConverter, context);
     target.addIllegalOp<AtenCumprodOp>();
@@ -2554,6 +3123,12 @@ public:
     target.addIllegalOp<AtenScaledDotProductAttentionOp>();
     patterns.add<ConvertAtenScaledDotProductAttentionOp>(typeConverter,
                                                          context);
+    target.addIllegalOp<HigherOrderFlexAttentionOp>();
+    patterns.add<ConvertHigherOrderFlexAttentionOp>(typeConverter, context);
+    target.addDynamicallyLegalOp<OperatorOp>([](OperatorOp op) {
+      return op.getName() != ConvertPagedAttentionOperatorOp::kName;
+    });
+    patterns.add<ConvertPagedAttentionOperatorOp>(typeConverter, context);
 
     target.addIllegalOp<AtenScatterSrcOp>();
     patterns.add<ConvertAtenScatterOp<AtenScatterSrcOp>>(typeConverter,
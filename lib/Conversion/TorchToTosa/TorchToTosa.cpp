@@ -3461,13 +3461,8 @@ LogicalResult ConvertAtenOp<AtenConvolutionOp>::matchAndRewriteImpl(
   };
 
   int64_t groups;
-  if (!matchPattern(op.getGroups(), m_TorchConstantInt(&groups))) {
+  if (!matchPattern(op.getGroups(), m_TorchConstantInt(&groups)))
     return rewriter.notifyMatchFailure(op, "non-const group size unsupported");
-  } else if (groups != 1 && weightShape[1] != 1) {
-    return rewriter.notifyMatchFailure(
-        op, "group size must be 1 (convolution) or weight.dim(1) must be 1 "
-            "(depthwise convolution)");
-  }
 
   SmallVector<int64_t> stride;
   if (!matchPattern(adaptor.getStride(), m_TorchListOfConstantInts(stride)))
@@ -3864,7 +3859,10 @@ LogicalResult ConvertAtenOp<AtenConvolutionOp>::matchAndRewriteImpl(
     return rewriter.notifyMatchFailure(op,
                                        "unsupported convolution weight rank");
 
-  if (groups == 1) {
+  // A grouped convolution whose groups take more than one input channel each
+  // runs one full convolution per group.
+  bool isGrouped = groups != 1 && weightShape[1] != 1;
+  if (groups == 1 || (!is3D && isGrouped)) {
     // full convolution: Torch: O(I/G)spatial -> TOSA: O spatial I
     transformedWeightShape = permuteShape(weightShape, weightPermutation);
     transformedWeight =
@@ -4079,6 +4077,61 @@ LogicalResult ConvertAtenOp<AtenConvolutionOp>::matchAndRewriteImpl(
             rewriter.getDenseI64ArrayAttr(stride),
             rewriter.getDenseI64ArrayAttr(dilation), accType)
             .getResult();
+  } else if (!is3D && isGrouped) {
+    auto biasValueOr = getOrCreateBias(weightShape[0]);
+    if (failed(biasValueOr))
+      return failure();
+    bias = *biasValueOr;
+    biasElemTy = cast<RankedTensorType>(bias.getType()).getElementType();
+
+    // grouped convolution: slice the channels of the input, weight and bias
+    // of each group, convolve them and concatenate the results.
+    int64_t inChannelsPerGroup = weightShape[1];
+    int64_t outChannelsPerGroup = outputCDim / groups;
+    SmallVector<int64_t> groupInputShape = makeShapeTorchCompatible(
+        cast<RankedTensorType>(transposedInput.getType()).getShape());
+    groupInputShape[3] = inChannelsPerGroup;
+    SmallVector<int64_t> groupWeightShape(transformedWeightShape);
+    groupWeightShape[0] = outChannelsPerGroup;
+    SmallVector<int64_t> groupOutputShape(outputShape);
+    groupOutputShape[3] = outChannelsPerGroup;
+    auto groupConvOpTy = RankedTensorType::get(
+        makeShapeLLVMCompatible(groupOutputShape), biasElemTy);
+
+    auto sliceGroup = [&](Value tensor, ArrayRef<int64_t> start,
+                          ArrayRef<int64_t> size) -> Value {
+      auto elemTy = cast<RankedTensorType>(tensor.getType()).getElementType();
+      return tosa::CreateOpAndInfer<tosa::SliceOp>(
+          rewriter, op->getLoc(), UnrankedTensorType::get(elemTy), tensor,
+          tosa::getTosaConstShape(rewriter, op->getLoc(), start),
+          tosa::getTosaConstShape(rewriter, op->getLoc(), size));
+    };
+
+    SmallVector<Value> groupResults;
+    for (int64_t group = 0; group < groups; ++group) {
+      int64_t inChannelOffset = group * inChannelsPerGroup;
+      int64_t outChannelOffset = group * outChannelsPerGroup;
+      Value groupInput = sliceGroup(transposedInput, {0, 0, 0, inChannelOffset},
+                                    groupInputShape);
+      Value groupWeight = sliceGroup(
+          transformedWeight, {outChannelOffset, 0, 0, 0}, groupWeightShape);
+      Value groupBias =
+          sliceGroup(bias, {outChannelOffset}, {outChannelsPerGroup});
+      groupResults.push_back(
+          tosa::Conv2DOp::create(
+              rewriter, op->getLoc(),
+              getTypeConverter()->convertType(groupConvOpTy), groupInput,
+              groupWeight, groupBias, *inputZp, *weightZp,
+              rewriter.getDenseI64ArrayAttr(padding),
+              rewriter.getDenseI64ArrayAttr(stride),
+              rewriter.getDenseI64ArrayAttr(dilation), accType)
+              .getResult());
+    }
+    auto convOpTy =
+        RankedTensorType::get(makeShapeLLVMCompatible(outputShape), biasElemTy);
+    convOpResult = tosa::CreateOpAndInfer<tosa::ConcatOp>(
+        rewriter, op->getLoc(), getTypeConverter()->convertType(convOpTy),
+        groupResults, rewriter.getI32IntegerAttr(3));
   } else {
     return rewriter.notifyMatchFailure(
         op, is3D ? "Unimplemented: grouped or depthwise 3D convolution "
@@ -5887,7 +5940,6 @@ LogicalResult ConvertAtenOp<AtenIndexSelectOp>::matchAndRewriteImpl(
     return rewriter.notifyMatchFailure(
         op, "Only RankedTensorType indices are currently supported");
 
-  auto inputShape = inputType.getShape();
   int inputRank = inputType.getRank();
 
   // indexShape is reference. storing actual data in SmallVector to avoid
@@ -5928,70 +5980,13 @@ LogicalResult ConvertAtenOp<AtenIndexSelectOp>::matchAndRewriteImpl(
   // Get the output type
   auto outType = getTypeConverter()->convertType(op.getType());
 
-  // Reshape and expand the index tensor to have same rank and same dimensions
-  // (except for the targeted dim) as the input
-  //
-  // For example:
-  // Input shape = (4, 5, 6)
-  // Index vector shape = (2)
-  // Targeted dim = 1
-  // Reshaped and expanded index vector shape = (4, 2, 6)
-  //
-  // By reshaping and expanding the index vector, we can supply it into the
-  // gather op to mimic the functionality of aten.index_select
-  SmallVector<int64_t> indicesInputRankShape;
-  for (int64_t i = 0; i < inputRank; i++) {
-    if (i == dim) {
-      indicesInputRankShape.push_back(indexShape[0]);
-    } else {
-      indicesInputRankShape.push_back(1);
-    }
-  }
-
-  auto indicesInputRankType =
-      RankedTensorType::get(makeShapeLLVMCompatible(indicesInputRankShape),
-                            rewriter.getIntegerType(32));
-
-  auto reshapedIndices = tosa::ReshapeOp::create(
-      rewriter, op->getLoc(), indicesInputRankType, index,
-      tosa::getTosaConstShape(rewriter, op->getLoc(), indicesInputRankShape));
-
-  SmallVector<int64_t> tileShape(indicesInputRankShape);
-  SmallVector<int64_t> expandedIndicesShape(indicesInputRankShape);
-  for (int64_t i = 0; i < inputRank; i++) {
-    if (tileShape[i] == 1 && i != dim) {
-      tileShape[i] = inputShape[i];
-      expandedIndicesShape[i] = inputShape[i];
-    } else {
-      tileShape[i] = 1;
-    }
-  }
-
-  auto tileType =
-      RankedTensorType::get(makeShapeLLVMCompatible(expandedIndicesShape),
-                            rewriter.getIntegerType(32));
-
-  auto tileOpMultiples =
-      tosa::getTosaConstShape(rewriter, op->getLoc(), tileShape);
-
-  auto expandedIndices =
-      tosa::TileOp::create(rewriter, op->getLoc(), tileType,
-                           reshapedIndices.getResult(), tileOpMultiples);
-
-  // convert torch style index and dim into tf style indices
-  // tensor<[1,4,2],si64> -> tensor<[1,4,2,3],si64>
-  auto indicesTf = tosa::convertTorchIndexToTfIndices(
-      rewriter, op, input, expandedIndices.getResult(), dim);
-  if (!indicesTf)
-    return rewriter.notifyMatchFailure(
-        op, "Convert TorchIndex To TfIndices failed");
-
-  // do the tf gathernd algorithm with tf style indices as input.
-  auto result =
-      tosa::convertGatherNdOp(rewriter, op, outType, input, indicesTf.value());
+  // Gather whole slices of the input along `dim`, so that the index is never
+  // expanded to the shape of the result.
+  auto result = tosa::convertGatherAlongAxisOp(rewriter, op, outType, input,
+                                               index, dim);
 
   if (!result) {
-    return rewriter.notifyMatchFailure(op, "Convert GatherNdOp failed");
+    return rewriter.notifyMatchFailure(op, "Convert GatherAlongAxisOp failed");
   }
   rewriter.replaceOp(op, {result.value()});
   return success();
@@ -6387,16 +6382,16 @@ LogicalResult ConvertAtenOp<AtenIndexTensorHackedTwinOp>::matchAndRewriteImpl(
         wrapNegativeIndices(index, inputTensorType.getShape()[0], op, rewriter)
             .value();
 
-    // Expand last dim of index to tf indices [2,3] -> [2,3,1]
-    SmallVector<int64_t> indicesShape;
-    for (auto shape : indexShape) {
-      indicesShape.push_back(shape);
+    // A single index selects rows of the input, which is a plain gather
+    // along the leading dim.
+    auto result = tosa::convertGatherAlongAxisOp(rewriter, op, outType, input,
+                                                 index, /*axis=*/0);
+    if (!result) {
+      return rewriter.notifyMatchFailure(
+          op, "Convert GatherAlongAxisOp fail for index tensor.");
     }
-    indicesShape.push_back(1);
-    indicesTf = tosa::CreateOpAndInfer<tosa::ReshapeOp>(
-        rewriter, op->getLoc(),
-        RankedTensorType::get(indicesShape, rewriter.getIntegerType(32)), index,
-        tosa::getTosaConstShape(rewriter, op->getLoc(), indicesShape));
+    rewriter.replaceOp(op, {result.value()});
+    return success();
   }
 
   if (!indicesTf) {
@@ -11265,6 +11260,86 @@ class ConvertDequantizeOp : public TorchToTosaOpConversionPattern<AtenOpT> {
   }
 };
 
+// Matches a constant scale, or the product of constant scales that
+// FuseQuantizedOps builds for the accumulator of a quantized conv or matmul.
+static bool matchConstantScale(Value scale, double &value) {
+  if (matchPattern(scale, m_TorchConstantFloat(&value)))
+    return true;
+  auto mul = scale.getDefiningOp<AtenMulFloatOp>();
+  double lhs, rhs;
+  if (!mul || !matchConstantScale(mul.getA(), lhs) ||
+      !matchConstantScale(mul.getB(), rhs))
+    return false;
+  value = lhs * rhs;
+  return true;
+}
+
+// Folds the epilogue of a quantized conv or matmul,
+//    quantize(relu?(dequantize(make_per_tensor(acc, in_scale, in_zp))))
+// into a single tosa.rescale of the integer accumulator to the int8 result,
+// followed by a tosa.clamp at the output zero point for the relu. This
+// replaces the float round trip of the dequantize and the quantize, which
+// are each several full passes over the tensor.
+static FailureOr<Value> foldRequantize(AtenQuantizePerTensorOp op,
+                                       ConversionPatternRewriter &rewriter,
+                                       RankedTensorType resultTy,
+                                       double outScale, int64_t outZp) {
+  if (!resultTy.getElementType().isInteger(8))
+    return failure();
+
+  Value input = op.getSelf();
+  auto relu = input.getDefiningOp<AtenReluOp>();
+  if (relu)
+    input = relu.getSelf();
+  Value qtensor;
+  if (auto dequant = input.getDefiningOp<AtenDequantizeTensorOp>())
+    qtensor = dequant.getQtensor();
+  else if (auto dequant = input.getDefiningOp<AtenDequantizeSelfOp>())
+    qtensor = dequant.getSelf();
+  auto make = qtensor
+                  ? qtensor.getDefiningOp<Aten_MakePerTensorQuantizedTensorOp>()
+                  : nullptr;
+  double inScale;
+  int64_t inZp;
+  if (!make || !matchConstantScale(make.getScale(), inScale) ||
+      !matchPattern(make.getZeroPoint(), m_TorchConstantInt(&inZp)))
+    return failure();
+
+  // The integer values of the quantized input, already converted to TOSA.
+  Value acc = rewriter.getRemappedValue(make.getSelf());
+  auto accTy = acc ? dyn_cast<RankedTensorType>(acc.getType()) : nullptr;
+  if (!accTy || !isa<IntegerType>(accTy.getElementType()) ||
+      accTy.getShape() != resultTy.getShape())
+    return failure();
+  // TOSA only allows an input zero point on 8-bit and 16-bit rescales.
+  if (inZp != 0 && accTy.getElementTypeBitWidth() > 16)
+    return failure();
+
+  int32_t multiplier, shift;
+  double scale = inScale / outScale;
+  if (!tosa::computeMultiplierAndShift(scale, multiplier, shift, 32))
+    return failure();
+
+  Value result = tosa::buildRescale(rewriter, op, resultTy, acc, scale, inZp,
+                                    outZp, tosa::RoundingMode::SINGLE_ROUND,
+                                    /*scale32=*/true);
+  if (!relu)
+    return result;
+
+  // relu(x) is zero at the output zero point, which rescaling preserves.
+  IntegerAttr minAttr, maxAttr;
+  if (failed(tosa::getIntegerClampAttrs(rewriter, op, resultTy.getElementType(),
+                                        outZp, std::nullopt, minAttr,
+                                        maxAttr)))
+    return failure();
+  return tosa::ClampOp::create(
+             rewriter, op->getLoc(), resultTy, result, minAttr, maxAttr,
+             /*nan_mode=*/
+             tosa::NanPropagationModeAttr::get(
+                 rewriter.getContext(), tosa::NanPropagationMode::PROPAGATE))
+      .getResult();
+}
+
 // Legalization for aten.quantize_per_tensor
 // Implements
 //    Q = clamp(round(X / scale) + zero_point)
@@ -11286,12 +11361,20 @@ LogicalResult ConvertAtenOp<AtenQuantizePerTensorOp>::matchAndRewriteImpl(
                                        "zero point must be a Scalar constant");
 
   // Get input and result types.
-  auto inputTy = cast<RankedTensorType>(input.getType());
-  auto inputElemTy = inputTy.getElementType();
   auto resultTy = cast<RankedTensorType>(
       getTypeConverter()->convertType(op->getResult(0).getType()));
   auto resultElemTy = resultTy.getElementType();
 
+  FailureOr<Value> requantized =
+      foldRequantize(op, rewriter, resultTy, scaleConst, zpConst);
+  if (succeeded(requantized)) {
+    rewriter.replaceOp(op, *requantized);
+    return success();
+  }
+
+  auto inputTy = cast<RankedTensorType>(input.getType());
+  auto inputElemTy = inputTy.getElementType();
+
   // Rescale the input: input * (1.0 / scale)
   auto scaleReciprocal = 1.0 / scaleConst;
   auto scaleConstTensor = tosa::getConstTensor<float>(
@@ -11425,8 +11508,15 @@ public:
     auto frozenPatterns = FrozenRewritePatternSet(
         std::move(patterns), this->disabledPatterns, this->enabledPatterns);
 
-    if (failed(applyPartialConversion(getOperation(), target,
-                                      std::move(frozenPatterns))))
+    PatternStatisticsListener statisticsListener;
+    ConversionConfig config;
+    if (patternStatistics)
+      config.listener = &statisticsListener;
+    LogicalResult converted = applyPartialConversion(
+        getOperation(), target, std::move(frozenPatterns), config);
+    if (patternStatistics)
+      statisticsListener.print(llvm::errs(), getArgument(), getOperation());
+    if (failed(converted))
       return signalPassFailure();
   }
 };
@@ -437,6 +437,78 @@ std::optional<Value> convertGatherNdOp(PatternRewriter &rewriter, Operation *op,
       .getResult();
 }
 
+// Lowers a gather of whole slices of params along `axis` to a single
+// tosa.gather, without the TF-style indices that convertGatherNdOp needs.
+//
+// The dims of params before `axis` become the batch dim N of the gather, the
+// dims after it the channels C, and the flattened index the W indices of each
+// batch. Params only needs a reshape into [N, K, C], and the index is linear
+// already, so no multiply/reduce_sum chain is needed; it is only tiled across
+// the N batches, which for row indexing (axis 0) is a no-op.
+//
+// Example: index_select(!torch.vtensor<[4,5,6],f32>, dim=1, [3]-index)
+//   params [4,5,6] -> [4,5,6] (N=4, K=5, C=6)
+//   index  [3]     -> [1,3] -> tile -> [4,3]
+//   gather -> [4,3,6] -> reshape to the result shape [4,3,6]
+std::optional<Value> convertGatherAlongAxisOp(PatternRewriter &rewriter,
+                                              Operation *op, Type outType,
+                                              Value paramsValue,
+                                              Value indexValue, int32_t axis) {
+  auto resultType = dyn_cast<ShapedType>(outType);
+  auto paramsType = dyn_cast<RankedTensorType>(paramsValue.getType());
+  auto indexType = dyn_cast<RankedTensorType>(indexValue.getType());
+
+  if (!resultType || !paramsType || !indexType ||
+      !paramsType.hasStaticShape() || !indexType.hasStaticShape())
+    return std::nullopt;
+
+  ArrayRef<int64_t> paramsShape = paramsType.getShape();
+  int64_t paramsRank = paramsShape.size();
+  if (axis < 0 || axis >= paramsRank)
+    return std::nullopt;
+
+  int64_t N = 1, K = paramsShape[axis], C = 1;
+  for (int64_t i = 0; i < axis; i++)
+    N *= paramsShape[i];
+  for (int64_t i = axis + 1; i < paramsRank; i++)
+    C *= paramsShape[i];
+  int64_t W = indexType.getNumElements();
+
+  Location loc = op->getLoc();
+  SmallVector<int64_t, 3> tosaValuesShape({N, K, C});
+  auto tosaValuesReshapeOp = tosa::CreateOpAndInfer<tosa::ReshapeOp>(
+      rewriter, loc,
+      GetTypeFromTensorShape(tosaValuesShape, paramsType.getElementType()),
+      paramsValue, tosa::getTosaConstShape(rewriter, loc, tosaValuesShape));
+
+  SmallVector<int64_t, 2> indexRowShape({1, W});
+  Value tosaIndices = tosa::CreateOpAndInfer<tosa::ReshapeOp>(
+      rewriter, loc,
+      GetTypeFromTensorShape(indexRowShape, indexType.getElementType()),
+      indexValue, tosa::getTosaConstShape(rewriter, loc, indexRowShape));
+  if (N != 1) {
+    SmallVector<int64_t, 2> tosaIndicesShape({N, W});
+    SmallVector<int64_t, 2> multiples({N, 1});
+    tosaIndices = tosa::CreateOpAndInfer<tosa::TileOp>(
+        rewriter, loc,
+        GetTypeFromTensorShape(tosaIndicesShape, indexType.getElementType()),
+        tosaIndices, tosa::getTosaConstShape(rewriter, loc, multiples));
+  }
+
+  SmallVector<int64_t, 3> tosaGatherResultShape({N, W, C});
+  auto gatherTy = GetTypeFromTensorShape(tosaGatherResultShape,
+                                         resultType.getElementType());
+  auto gatherResult = tosa::createGatherOp(
+      rewriter, loc, gatherTy, tosaValuesReshapeOp.getResult(), tosaIndices);
+  if (!gatherResult)
+    return std::nullopt;
+
+  return tosa::CreateOpAndInfer<tosa::ReshapeOp>(
+             rewriter, loc, resultType, *gatherResult,
+             tosa::getTosaConstShape(rewriter, loc, resultType.getShape()))
+      .getResult();
+}
+
 // Lower indexput op to tosa::scatter op
 // Mostly take from the up function convertGatherNdOp()
 std::optional<Value> convertScatterNdOp(PatternRewriter &rewriter,
@@ -762,22 +834,66 @@ std::optional<Value> convertReduceOpCommon(
         rewriter, op->getLoc(), output_type, val);
     val = identity_op.getResult();
   } else {
-    // Reduce along each axis
+    SmallVector<int64_t> axes;
+    for (int i = 0; i < axes_elems.getNumElements(); i++) {
+      int64_t axis_val = axes_elems.getValues<IntegerAttr>()[i].getInt();
+      if (axis_val < 0)
+        axis_val += input_rank;
+      axes.push_back(axis_val);
+    }
+    llvm::sort(axes);
+    axes.erase(llvm::unique(axes), axes.end());
+
     SmallVector<int64_t> shape_vec(input_shape.begin(), input_shape.end());
+    for (int64_t axis_val : axes)
+      shape_vec[axis_val] = 1;
+
+    // TOSA reductions are single-axis, so every run of adjacent reduced axes
+    // is merged into one axis by a reshape and takes a single reduction:
+    // reducing over (H, W), or over all dims, is one reduce op. The reduced
+    // axes are not transposed together, as the transpose would copy the
+    // whole input while a chain of reductions shrinks it from the first one.
+    SmallVector<int64_t> merged_shape;
+    SmallVector<int64_t> merged_axes;
+    for (int64_t i = 0, e = input_rank; i < e;) {
+      if (!llvm::is_contained(axes, i)) {
+        merged_shape.push_back(input_shape[i++]);
+        continue;
+      }
+      int64_t merged_size = 1;
+      while (i < e && llvm::is_contained(axes, i))
+        merged_size *= input_shape[i++];
+      merged_axes.push_back(merged_shape.size());
+      merged_shape.push_back(merged_size);
+    }
+    bool merge_axes =
+        input_type.hasStaticShape() && merged_axes.size() < axes.size();
 
     if (is_quantized) {
       val = buildRescaleToInt32(rewriter, op, val, input_scale, input_zp);
     }
 
-    for (int i = 0; i < axes_elems.getNumElements(); i++) {
-      int64_t axis_val = axes_elems.getValues<IntegerAttr>()[i].getInt();
-      if (axis_val < 0)
-        axis_val += input_rank;
+    SmallVector<int64_t> reduce_shape(input_shape.begin(), input_shape.end());
+    if (merge_axes) {
+      reduce_shape = merged_shape;
+      axes = merged_axes;
+      val = CreateOpAndInfer<tosa::ReshapeOp>(
+                rewriter, op->getLoc(),
+                RankedTensorType::get(
+                    merged_shape,
+                    cast<RankedTensorType>(val.getType()).getElementType()),
+                val,
+                tosa::getTosaConstShape(rewriter, op->getLoc(), merged_shape))
+                .getResult();
+    }
+
+    // Reduce along each axis
+    for (int64_t axis_val : axes) {
       auto axis_attr = rewriter.getI32IntegerAttr(axis_val);
 
-      shape_vec[axis_val] = 1;
+      reduce_shape[axis_val] = 1;
       RankedTensorType reduce_type =
-          RankedTensorType::get(shape_vec, reduce_element_type);
+          RankedTensorType::get(reduce_shape, reduce_element_type);
 
       Value reduce_op;
       if constexpr (std::is_same<T, tosa::ReduceMinOp>() ||
@@ -799,12 +915,13 @@ std::optional<Value> convertReduceOpCommon(
 
     if (is_quantized) {
       RankedTensorType output_rescale_type =
-          RankedTensorType::get(shape_vec, output_type.getElementType());
+          RankedTensorType::get(reduce_shape, output_type.getElementType());
       val = buildRescale(rewriter, op, output_rescale_type, val, output_scale,
                          0, output_zp, tosa::RoundingMode::SINGLE_ROUND, true);
     }
 
-    // Optionally squeeze out the reduced axes.
+    // Optionally squeeze out the reduced axes, or restore them as unit dims
+    // if they were merged.
     if (!keep_dims) {
       auto squeezedType =
           RankedTensorType::get(output_shape, reduce_element_type);
@@ -812,6 +929,15 @@ std::optional<Value> convertReduceOpCommon(
           rewriter, op->getLoc(), squeezedType, val,
           tosa::getTosaConstShape(rewriter, op->getLoc(), output_shape));
       val = reshape_op.getResult();
+    } else if (merge_axes) {
+      val = CreateOpAndInfer<tosa::ReshapeOp>(
+                rewriter, op->getLoc(),
+                RankedTensorType::get(
+                    shape_vec,
+                    cast<RankedTensorType>(val.getType()).getElementType()),
+                val,
+                tosa::getTosaConstShape(rewriter, op->getLoc(), shape_vec))
+                .getResult();
     }
   }
 
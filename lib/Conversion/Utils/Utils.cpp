@@ -14,9 +14,11 @@
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/SymbolTable.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
 #include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/Format.h"
 
 namespace mlir {
 namespace torch {
@@ -628,6 +630,76 @@ APFloat getFloatInf(mlir::FloatType fpType, bool negative,
              : APFloat::getLargest(fpType.getFloatSemantics(), negative);
 }
 
+void PatternStatisticsListener::notifyPatternBegin(const Pattern &pattern,
+                                                   Operation *op) {
+  std::string name = pattern.getDebugName().str();
+  if (name.empty()) {
+    std::optional<OperationName> rootKind = pattern.getRootKind();
+    name = "<unnamed pattern of " +
+           (rootKind ? rootKind->getStringRef().str() : "any op") + ">";
+  }
+  PatternStatistics &patternStatistics = statistics[name];
+  ++patternStatistics.attempts;
+  activePatterns.push_back(
+      {&patternStatistics, Clock::now(), Clock::duration::zero()});
+}
+
+void PatternStatisticsListener::notifyPatternEnd(const Pattern &pattern,
+                                                 LogicalResult status) {
+  assert(!activePatterns.empty() && "pattern ends without beginning");
+  ActivePattern active = activePatterns.pop_back_val();
+  Clock::duration time = Clock::now() - active.start;
+  active.statistics->time += time - active.nestedTime;
+  if (succeeded(status))
+    ++active.statistics->successes;
+  if (!activePatterns.empty())
+    activePatterns.back().nestedTime += time;
+}
+
+void PatternStatisticsListener::print(raw_ostream &os, StringRef passName,
+                                      Operation *op) const {
+  SmallVector<const llvm::StringMapEntry<PatternStatistics> *> entries;
+  int64_t attempts = 0, successes = 0;
+  for (const auto &entry : statistics) {
+    entries.push_back(&entry);
+    attempts += entry.getValue().attempts;
+    successes += entry.getValue().successes;
+  }
+  llvm::sort(entries, [](const auto *lhs, const auto *rhs) {
+    if (lhs->getValue().time != rhs->getValue().time)
+      return lhs->getValue().time > rhs->getValue().time;
+    return lhs->getKey() < rhs->getKey();
+  });
+
+  // Print into a string first, so that the reports of the functions that a
+  // pass converts in parallel are not interleaved.
+  std::string report;
+  llvm::raw_string_ostream reportOs(report);
+  reportOs << "===- Pattern statistics of " << passName << " on ";
+  if (auto symbol = op->getAttrOfType<StringAttr>(
+          SymbolTable::getSymbolAttrName()))
+    reportOs << "@" << symbol.getValue();
+  else
+    reportOs << "'" << op->getName() << "'";
+  reportOs << " -===\n";
+  reportOs << llvm::format("%10s %10s %12s  %s\n", "attempts", "successes",
+                           "time (ms)", "pattern");
+  for (const auto *entry : entries) {
+    const PatternStatistics &patternStatistics = entry->getValue();
+    double ms = std::chrono::duration<double, std::milli>(
+                    patternStatistics.time)
+                    .count();
+    reportOs << llvm::format("%10lld %10lld %12.3f  ",
+                             (long long)patternStatistics.attempts,
+                             (long long)patternStatistics.successes, ms)
+             << entry->getKey() << "\n";
+  }
+  reportOs << llvm::format("%10lld %10lld %12s  ", (long long)attempts,
+                           (long long)successes, "")
+           << "total of " << entries.size() << " patterns\n";
+  os << report;
+}
+
 } // namespace Torch
 } // namespace torch
 } // namespace mlir
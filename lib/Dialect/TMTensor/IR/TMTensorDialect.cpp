@@ -14,6 +14,7 @@
 #include "mlir/IR/DialectImplementation.h"
 #include "mlir/IR/OpDefinition.h"
 #include "mlir/IR/OpImplementation.h"
+#include "mlir/Interfaces/TilingInterface.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/SourceMgr.h"
 
@@ -25,6 +26,9 @@ void TMTensorDialect::initialize() {
   addOperations<
 #include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorOps.cpp.inc"
       >();
+  declarePromisedInterfaces<TilingInterface, AttentionOp, GatherOp,
+                            PagedAttentionOp, ScanOp, ScatterOp,
+                            SegmentReduceOp, SortOp, TopkOp>();
 }
 
 #include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorDialect.cpp.inc"
@@ -17,6 +17,7 @@
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Utils/StructuredOpsUtils.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/Diagnostics.h"
@@ -85,6 +86,88 @@ OpFoldResult TMTensor::getDim(OpBuilder &builder, Location loc, Value v,
   return builder.getI64IntegerAttr(t.getDimSize(dim));
 }
 
+/// Returns whether the combiner in `block` only consists of elementwise ops
+/// on scalars and constants, so that it can be applied to vectors.
+static bool isVectorizableCombiner(Block &block) {
+  return llvm::all_of(block.without_terminator(), [](Operation &op) {
+    if (matchPattern(&op, m_Constant()))
+      return true;
+    return op.hasTrait<OpTrait::Elementwise>() && op.getNumRegions() == 0 &&
+           llvm::all_of(op.getResultTypes(),
+                        [](Type t) { return t.isIntOrIndexOrFloat(); });
+  });
+}
+
+/// Returns whether the innermost dim of the memref `v` has unit stride, so
+/// that vectors along it can be loaded and stored directly.
+static bool hasContiguousInnermostDim(Value v) {
+  auto type = dyn_cast<MemRefType>(v.getType());
+  if (!type || type.getRank() == 0)
+    return false;
+  SmallVector<int64_t> strides;
+  int64_t offset;
+  if (failed(type.getStridesAndOffset(strides, offset)))
+    return false;
+  return strides.back() == 1;
+}
+
+/// Clones the combiner in `block` on `args` and returns the yielded value.
+/// With `vectorType`, the combiner is applied to vectors of that shape:
+/// scalar operands are broadcast and the results of the elementwise ops are
+/// widened.
+static Value cloneCombiner(OpBuilder &b, Location loc, Block &block,
+                           ValueRange args, VectorType vectorType) {
+  auto lanes = [&](Value v) -> Value {
+    if (!vectorType || isa<VectorType>(v.getType()))
+      return v;
+    return vector::BroadcastOp::create(
+        b, loc, VectorType::get(vectorType.getShape(), v.getType()), v);
+  };
+  IRMapping bvm;
+  bvm.map(block.getArguments(), args);
+  for (auto &blockOp : block.without_terminator()) {
+    Operation *cloned = b.clone(blockOp, bvm);
+    if (!vectorType || matchPattern(cloned, m_Constant()))
+      continue;
+    for (OpOperand &operand : cloned->getOpOperands())
+      operand.set(lanes(operand.get()));
+    for (OpResult result : cloned->getResults())
+      result.setType(VectorType::get(vectorType.getShape(), result.getType()));
+  }
+  return lanes(bvm.lookupOrDefault(block.getTerminator()->getOperand(0)));
+}
+
+/// Loads the element of `memref` at `indices` or, with `vectorType`, the
+/// elements enabled in `mask` of the vector starting there along the
+/// innermost dim.
+static Value loadLanes(OpBuilder &b, Location loc, Value memref,
+                       ValueRange indices, VectorType vectorType, Value mask) {
+  if (!vectorType)
+    return memref::LoadOp::create(b, loc, memref, indices);
+  Value passThru = arith::ConstantOp::create(b, loc, b.getZeroAttr(vectorType));
+  return vector::MaskedLoadOp::create(b, loc, vectorType, memref, indices,
+                                      mask, passThru);
+}
+
+/// Stores what `loadLanes` loads.
+static void storeLanes(OpBuilder &b, Location loc, Value value, Value memref,
+                       ValueRange indices, Value mask) {
+  if (!mask) {
+    memref::StoreOp::create(b, loc, value, memref, indices);
+    return;
+  }
+  vector::MaskedStoreOp::create(b, loc, memref, indices, mask, value);
+}
+
+/// Returns the mask enabling the lanes of a vector of `vectorWidth` elements
+/// at `pos` that lie before `size`.
+static Value getLaneMask(OpBuilder &b, Location loc, int64_t vectorWidth,
+                         Value pos, Value size) {
+  return vector::CreateMaskOp::create(
+      b, loc, VectorType::get({vectorWidth}, b.getI1Type()),
+      ValueRange{arith::SubIOp::create(b, loc, size, pos)});
+}
+
 //===----------------------------------------------------------------------===//
 // AttentionOp
 //===----------------------------------------------------------------------===//
@@ -136,6 +219,40 @@ LogicalResult AttentionOp::verify() {
           "mask sequence lengt and key sequence length mismatch");
     }
   }
+
+  if (std::optional<int64_t> windowSize = getWindowSize()) {
+    if (*windowSize < 1)
+      return op->emitOpError("expected window_size to be positive");
+  }
+
+  // Both regions take the batch, query and key indices; `score_mod` first
+  // takes the score.
+  auto verifyModRegion = [&](Region &region, StringRef name, Type scoreType,
+                             Type yieldType) -> LogicalResult {
+    if (region.empty())
+      return success();
+    Block &block = region.front();
+    SmallVector<Type> argTypes;
+    if (scoreType)
+      argTypes.push_back(scoreType);
+    argTypes.append(queryShape.size(), IndexType::get(getContext()));
+    if (!llvm::equal(block.getArgumentTypes(), argTypes))
+      return op->emitOpError("expected ")
+             << name << " to take " << (scoreType ? "the score and " : "")
+             << "one index per dim of the query";
+    Operation *terminator = block.getTerminator();
+    if (terminator->getNumOperands() != 1 ||
+        terminator->getOperand(0).getType() != yieldType)
+      return op->emitOpError("expected ")
+             << name << " to yield a single " << yieldType;
+    return success();
+  };
+  Type elementType = queryType.getElementType();
+  if (failed(verifyModRegion(getScoreMod(), "score_mod", elementType,
+                             elementType)) ||
+      failed(verifyModRegion(getMaskMod(), "mask_mod", Type(),
+                             IntegerType::get(getContext(), 1))))
+    return failure();
   return success();
 }
 
@@ -154,52 +271,22 @@ bool AttentionOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
   return operand == getQuery() || operand == getKey() || operand == getValue();
 }
 
-// Performs a matmul between lhs and rhs
-// Note that "transposed" means the last two dims of rhs are swapped
-static void matmul(OpBuilder &b, Location loc, Value lhs, ValueRange lhsSizes,
-                   Value rhs, ValueRange rhsSizes, Value output,
-                   ValueRange outputSizes, bool transposed = false) {
-  auto elementType = cast<MemRefType>(lhs.getType()).getElementType();
-  Value one = arith::ConstantIndexOp::create(b, loc, 1);
-  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
-  auto rank = outputSizes.size();
-  Value reductionDimSize = lhsSizes[lhsSizes.size() - 1];
-
-  // Loop over output
-  scf::ParallelOp::create(
-      b, loc, SmallVector<Value>(rank, zero), outputSizes,
-      SmallVector<Value>(rank, one),
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        Value acc = arith::ConstantOp::create(b, loc, elementType,
-                                              b.getFloatAttr(elementType, 0.0));
-        Value sum =
-            scf::ForOp::create(
-                b, loc, zero, reductionDimSize, one, SmallVector<Value>{acc},
-                [&](OpBuilder &b, Location loc, Value i, ValueRange accs) {
-                  SmallVector<Value> lhsIVs(localIVs), rhsIVs(localIVs);
-                  lhsIVs[lhsIVs.size() - 1] = i;
-                  rhsIVs[rhsIVs.size() - 2] = i;
-                  if (transposed)
-                    std::swap(rhsIVs[rhsIVs.size() - 1],
-                              rhsIVs[rhsIVs.size() - 2]);
-
-                  Value acc = accs[0];
-                  Value rElem = memref::LoadOp::create(b, loc, lhs, lhsIVs);
-                  Value cElem = memref::LoadOp::create(b, loc, rhs, rhsIVs);
-                  Value x = arith::MulFOp::create(b, loc, rElem, cElem);
-                  x = arith::AddFOp::create(b, loc, x, acc);
-
-                  scf::YieldOp::create(b, loc, x);
-                })
-                ->getResult(0);
-        memref::StoreOp::create(b, loc, sum, output, localIVs);
-      });
-}
-
+// Number of keys whose scores are computed before the running softmax
+// statistics of a query row are updated.
+static constexpr int64_t kAttentionKeyTileSize = 64;
+
+// Computes attention one query row at a time with an online softmax, as in
+// FlashAttention. Keys are visited in tiles; for each tile the row's running
+// max and sum are updated and the output row, which accumulates the
+// unnormalized result, is rescaled once. Rows are independent, so the batch
+// and query dims form an `scf.parallel`, and only a tile of scores is ever
+// materialized instead of the full BxMxK2 weight matrix. The keys that
+// `mask_mod` masks out cost one evaluation of the region, and the tiles whose
+// keys are all masked out are not accumulated. The keys outside of the
+// `causal` and `window_size` bounds of a row are not visited at all.
 LogicalResult AttentionOp::generateScalarImplementation(OpBuilder &b,
                                                         Location loc,
                                                         ValueRange ivs) {
-
   Value query = getQuery();
   Value key = getKey();
   Value value = getValue();
@@ -209,195 +296,575 @@ LogicalResult AttentionOp::generateScalarImplementation(OpBuilder &b,
 
   Value output = getOutput();
   auto queryType = cast<MemRefType>(query.getType());
-  auto keyType = cast<MemRefType>(key.getType());
-  auto valueType = cast<MemRefType>(value.getType());
   auto maskType = mask ? cast<MemRefType>(mask.getType()) : MemRefType();
-  auto queryRank = queryType.getRank();
-  auto keyRank = keyType.getRank();
-  auto valueRank = valueType.getRank();
-  auto keySizes = keyType.getShape();
+  int64_t queryRank = queryType.getRank();
+  int64_t keyRank = cast<MemRefType>(key.getType()).getRank();
+  int64_t valueRank = cast<MemRefType>(value.getType()).getRank();
   Type elementType = queryType.getElementType();
 
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  Value tileSize =
+      arith::ConstantIndexOp::create(b, loc, kAttentionKeyTileSize);
   Value zeroF = arith::ConstantOp::create(b, loc, elementType,
                                           b.getFloatAttr(elementType, 0.0));
   Value negInfF = arith::ConstantOp::create(
       b, loc, elementType,
       b.getFloatAttr(elementType, -std::numeric_limits<double>::infinity()));
+  Value falseI1 =
+      arith::ConstantOp::create(b, loc, b.getIntegerAttr(b.getI1Type(), 0));
+
+  Block *scoreModBlock =
+      getScoreMod().empty() ? nullptr : &getScoreMod().front();
+  Block *maskModBlock = getMaskMod().empty() ? nullptr : &getMaskMod().front();
+
+  Value headDim = memref::DimOp::create(b, loc, query, queryRank - 1);
+  Value keyLen = memref::DimOp::create(b, loc, key, keyRank - 2);
+  Value valueDim = memref::DimOp::create(b, loc, value, valueRank - 1);
+
+  // Scores are scaled by the `scale` attribute, or by 1/sqrt(head_dim).
+  Value scale;
+  if (FloatAttr scaleAttr = getScaleAttr()) {
+    scale = arith::ConstantOp::create(
+        b, loc, elementType,
+        b.getFloatAttr(elementType, scaleAttr.getValueAsDouble()));
+  } else {
+    Value headDimF = arith::UIToFPOp::create(
+        b, loc, elementType,
+        arith::IndexCastUIOp::create(b, loc, b.getI32Type(), headDim));
+    Value oneF = arith::ConstantOp::create(b, loc, elementType,
+                                           b.getFloatAttr(elementType, 1.0));
+    scale = arith::DivFOp::create(b, loc, oneF,
+                                  math::SqrtOp::create(b, loc, headDimF));
+  }
+
+  auto forEach = [&](OpBuilder &b, Location loc, Value ub,
+                     function_ref<void(OpBuilder &, Location, Value)> body) {
+    scf::ForOp::create(b, loc, zero, ub, one, ValueRange{},
+                       [&](OpBuilder &b, Location loc, Value iv, ValueRange) {
+                         body(b, loc, iv);
+                         scf::YieldOp::create(b, loc);
+                       });
+  };
 
-  // TODO: This needs to be fixed, it assumes everything is dynamic however if
-  // any shapes are static the `memref.alloc` generated is illegal.
-  SmallVector<Value> queryDynSizes, keyDynSizes, valueDynSizes, outputDynSizes;
-  for (auto i = 0; i < queryRank; i++)
-    queryDynSizes.push_back(memref::DimOp::create(b, loc, query, i));
-  for (auto i = 0; i < keyRank; i++)
-    keyDynSizes.push_back(memref::DimOp::create(b, loc, key, i));
-  for (auto i = 0; i < valueRank; i++)
-    valueDynSizes.push_back(memref::DimOp::create(b, loc, value, i));
-  for (auto i = 0; i < queryRank; i++)
-    outputDynSizes.push_back(memref::DimOp::create(b, loc, output, i));
-
-  // weight = query @ key
-  auto weightRank = queryRank;
-  auto weightSizes = SmallVector<int64_t>(queryType.getShape());
-  weightSizes[weightRank - 1] = keySizes[keyRank - 2];
-  auto weightType = MemRefType::get(weightSizes, queryType.getElementType());
-
-  // Setup the weight dynamic sizes:
-  SmallVector<Value> weightDynSizes(queryDynSizes);
-  weightDynSizes[weightRank - 1] = keyDynSizes[keyRank - 2];
-
-  SmallVector<Value> weightFilteredDynSizes;
-  for (int i = 0; i < weightRank; ++i)
-    if (weightSizes[i] == ShapedType::kDynamic)
-      weightFilteredDynSizes.push_back(weightDynSizes[i]);
-
-  Value weight =
-      memref::AllocOp::create(b, loc, weightType, weightFilteredDynSizes);
-  matmul(b, loc, query, queryDynSizes, key, keyDynSizes, weight, weightDynSizes,
-         /*transposed=*/true);
-
-  // weight = softmax(weight)
-  Value dim = weightDynSizes[weightRank - 1];
-  Value scaleFactor = math::SqrtOp::create(
-      b, loc,
-      arith::UIToFPOp::create(
-          b, loc, elementType,
-          arith::IndexCastUIOp::create(b, loc, b.getI32Type(),
-                                       queryDynSizes[queryRank - 1])));
+  SmallVector<Value> rowUpperBounds;
+  for (int64_t i = 0; i < queryRank - 1; ++i)
+    rowUpperBounds.push_back(memref::DimOp::create(b, loc, query, i));
 
-  // weight = (weight - max(weight)) / math.sqrt(querySizes[-1])
-  Value one = arith::ConstantIndexOp::create(b, loc, 1);
-  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
   scf::ParallelOp::create(
-      b, loc, SmallVector<Value>(weightRank, zero), weightDynSizes,
-      SmallVector<Value>(weightRank, one),
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        Value x = memref::LoadOp::create(b, loc, weight, localIVs);
-        x = arith::DivFOp::create(b, loc, x, scaleFactor);
-        memref::StoreOp::create(b, loc, x, weight, localIVs);
-      });
+      b, loc, SmallVector<Value>(queryRank - 1, zero), rowUpperBounds,
+      SmallVector<Value>(queryRank - 1, one),
+      [&](OpBuilder &b, Location loc, ValueRange rowIVs) {
+        // Indices into query, mask and output rows, and into key and value
+        // rows of the same batch.
+        auto rowIndices = [&](Value col) {
+          SmallVector<Value> indices(rowIVs.begin(), rowIVs.end());
+          indices.push_back(col);
+          return indices;
+        };
+        auto keyIndices = [&](Value keyIdx, Value col) {
+          SmallVector<Value> indices(rowIVs.begin(), rowIVs.end() - 1);
+          indices.push_back(keyIdx);
+          indices.push_back(col);
+          return indices;
+        };
+
+        forEach(b, loc, valueDim, [&](OpBuilder &b, Location loc, Value n) {
+          memref::StoreOp::create(b, loc, zeroF, output, rowIndices(n));
+        });
 
-  // Apply mask to weights if mask is given
-  if (mask) {
-    scf::ParallelOp::create(
-        b, loc, SmallVector<Value>(weightRank, zero), weightDynSizes,
-        SmallVector<Value>(weightRank, one),
-        [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-          Value weightValue = memref::LoadOp::create(b, loc, weight, localIVs);
-          Value maskValue = memref::LoadOp::create(b, loc, mask, localIVs);
-          if (maskType.getElementType().isInteger(1)) {
-            maskValue =
-                arith::SelectOp::create(b, loc, maskValue, zeroF, negInfF);
+        Value scores = memref::AllocaOp::create(
+            b, loc, MemRefType::get({kAttentionKeyTileSize}, elementType));
+
+        // The row attends to the keys in [keyBegin, keyEnd): n <= m when
+        // causal, and m - n < window_size with a window.
+        Value queryIdx = rowIVs.back();
+        Value keyBegin = zero;
+        Value keyEnd = keyLen;
+        if (getCausal()) {
+          keyEnd = arith::MinUIOp::create(
+              b, loc, keyLen, arith::AddIOp::create(b, loc, queryIdx, one));
+        }
+        if (std::optional<int64_t> windowSize = getWindowSize()) {
+          Value reach = arith::ConstantIndexOp::create(b, loc, *windowSize - 1);
+          Value isClipped = arith::CmpIOp::create(
+              b, loc, arith::CmpIPredicate::ult, queryIdx, reach);
+          keyBegin = arith::SelectOp::create(
+              b, loc, isClipped, zero,
+              arith::SubIOp::create(b, loc, queryIdx, reach));
+        }
+
+        // scale * (q . k_j) + mask_j, modified by `score_mod`.
+        auto computeScore = [&](OpBuilder &b, Location loc, Value keyIdx) {
+          Value dot =
+              scf::ForOp::create(
+                  b, loc, zero, headDim, one, ValueRange{zeroF},
+                  [&](OpBuilder &b, Location loc, Value k, ValueRange accs) {
+                    Value q =
+                        memref::LoadOp::create(b, loc, query, rowIndices(k));
+                    Value kElem = memref::LoadOp::create(
+                        b, loc, key, keyIndices(keyIdx, k));
+                    Value x = arith::MulFOp::create(b, loc, q, kElem);
+                    x = arith::AddFOp::create(b, loc, x, accs[0]);
+                    scf::YieldOp::create(b, loc, x);
+                  })
+                  ->getResult(0);
+          Value score = arith::MulFOp::create(b, loc, dot, scale);
+          if (mask) {
+            Value maskValue =
+                memref::LoadOp::create(b, loc, mask, rowIndices(keyIdx));
+            if (maskType.getElementType().isInteger(1)) {
+              maskValue =
+                  arith::SelectOp::create(b, loc, maskValue, zeroF, negInfF);
+            }
+            score = arith::AddFOp::create(b, loc, score, maskValue);
+          }
+          if (scoreModBlock) {
+            SmallVector<Value> args = {score};
+            llvm::append_range(args, rowIndices(keyIdx));
+            score = cloneCombiner(b, loc, *scoreModBlock, args,
+                                  /*vectorType=*/VectorType());
           }
-          Value maskedWeight =
-              arith::AddFOp::create(b, loc, weightValue, maskValue);
-          memref::StoreOp::create(b, loc, maskedWeight, weight, localIVs);
+          return score;
+        };
+
+        auto tileLoop = scf::ForOp::create(
+            b, loc, keyBegin, keyEnd, tileSize, ValueRange{negInfF, zeroF},
+            [&](OpBuilder &b, Location loc, Value tileStart,
+                ValueRange stats) {
+              Value runningMax = stats[0];
+              Value runningSum = stats[1];
+              Value tileLen = arith::MinUIOp::create(
+                  b, loc, tileSize,
+                  arith::SubIOp::create(b, loc, keyEnd, tileStart));
+
+              // scores[j] and their max. The keys that `mask_mod` masks out
+              // get a score of -inf without computing it, and whether any
+              // key of the tile is kept is tracked.
+              SmallVector<Value> scoreInits = {runningMax};
+              if (maskModBlock)
+                scoreInits.push_back(falseI1);
+              ValueRange tileStats =
+                  scf::ForOp::create(
+                      b, loc, zero, tileLen, one, scoreInits,
+                      [&](OpBuilder &b, Location loc, Value j,
+                          ValueRange iterArgs) {
+                        Value keyIdx =
+                            arith::AddIOp::create(b, loc, tileStart, j);
+                        Value isKept, score;
+                        if (maskModBlock) {
+                          isKept = cloneCombiner(b, loc, *maskModBlock,
+                                                 rowIndices(keyIdx),
+                                                 /*vectorType=*/VectorType());
+                          score =
+                              scf::IfOp::create(
+                                  b, loc, isKept,
+                                  [&](OpBuilder &b, Location loc) {
+                                    scf::YieldOp::create(
+                                        b, loc, computeScore(b, loc, keyIdx));
+                                  },
+                                  [&](OpBuilder &b, Location loc) {
+                                    scf::YieldOp::create(b, loc, negInfF);
+                                  })
+                                  .getResult(0);
+                        } else {
+                          score = computeScore(b, loc, keyIdx);
+                        }
+                        memref::StoreOp::create(b, loc, score, scores, j);
+                        SmallVector<Value> yields = {arith::MaximumFOp::create(
+                            b, loc, iterArgs[0], score)};
+                        if (isKept)
+                          yields.push_back(arith::OrIOp::create(
+                              b, loc, iterArgs[1], isKept));
+                        scf::YieldOp::create(b, loc, yields);
+                      })
+                      ->getResults();
+              Value tileMax = tileStats[0];
+
+              // Rescales the output row and accumulates the tile into it.
+              auto accumulateTile = [&](OpBuilder &b, Location loc) {
+                // While every score so far is masked out, the max is -inf;
+                // exponentiate against 0 instead so these scores become 0.
+                Value isMaxNegInf = arith::CmpFOp::create(
+                    b, loc, arith::CmpFPredicate::OEQ, tileMax, negInfF);
+                Value safeMax = arith::SelectOp::create(b, loc, isMaxNegInf,
+                                                        zeroF, tileMax);
+                Value correction = math::ExpOp::create(
+                    b, loc,
+                    arith::SubFOp::create(b, loc, runningMax, safeMax));
+
+                forEach(b, loc, valueDim,
+                        [&](OpBuilder &b, Location loc, Value n) {
+                          Value acc = memref::LoadOp::create(b, loc, output,
+                                                             rowIndices(n));
+                          acc = arith::MulFOp::create(b, loc, acc, correction);
+                          memref::StoreOp::create(b, loc, acc, output,
+                                                  rowIndices(n));
+                        });
+
+                // output += exp(scores[j] - max) * v_j, summing the weights.
+                // The values of masked out keys are not loaded.
+                Value initSum =
+                    arith::MulFOp::create(b, loc, runningSum, correction);
+                Value tileSum =
+                    scf::ForOp::create(
+                        b, loc, zero, tileLen, one, ValueRange{initSum},
+                        [&](OpBuilder &b, Location loc, Value j,
+                            ValueRange sums) {
+                          Value keyIdx =
+                              arith::AddIOp::create(b, loc, tileStart, j);
+                          Value score =
+                              memref::LoadOp::create(b, loc, scores, j);
+                          Value p = math::ExpOp::create(
+                              b, loc,
+                              arith::SubFOp::create(b, loc, score, safeMax));
+                          auto accumulateValue = [&](OpBuilder &b,
+                                                     Location loc) {
+                            forEach(b, loc, valueDim,
+                                    [&](OpBuilder &b, Location loc, Value n) {
+                                      Value v = memref::LoadOp::create(
+                                          b, loc, value, keyIndices(keyIdx, n));
+                                      Value acc = memref::LoadOp::create(
+                                          b, loc, output, rowIndices(n));
+                                      Value x =
+                                          arith::MulFOp::create(b, loc, p, v);
+                                      x = arith::AddFOp::create(b, loc, acc, x);
+                                      memref::StoreOp::create(b, loc, x, output,
+                                                              rowIndices(n));
+                                    });
+                          };
+                          if (maskModBlock) {
+                            Value isKept = arith::CmpFOp::create(
+                                b, loc, arith::CmpFPredicate::ONE, score,
+                                negInfF);
+                            scf::IfOp::create(b, loc, isKept,
+                                              [&](OpBuilder &b, Location loc) {
+                                                accumulateValue(b, loc);
+                                                scf::YieldOp::create(b, loc);
+                                              });
+                          } else {
+                            accumulateValue(b, loc);
+                          }
+                          Value sum = arith::AddFOp::create(b, loc, sums[0], p);
+                          scf::YieldOp::create(b, loc, sum);
+                        })
+                        ->getResult(0);
+                scf::YieldOp::create(b, loc, ValueRange{tileMax, tileSum});
+              };
+
+              // A tile whose keys are all masked out leaves the output row
+              // and its statistics as they are.
+              if (!maskModBlock) {
+                accumulateTile(b, loc);
+                return;
+              }
+              ValueRange newStats =
+                  scf::IfOp::create(
+                      b, loc, tileStats[1], accumulateTile,
+                      [&](OpBuilder &b, Location loc) {
+                        scf::YieldOp::create(b, loc, stats);
+                      })
+                      ->getResults();
+              scf::YieldOp::create(b, loc, newStats);
+            });
+
+        // output = output / sum, or 0 when every key was masked out.
+        Value rowSum = tileLoop->getResult(1);
+        Value isSumZero = arith::CmpFOp::create(
+            b, loc, arith::CmpFPredicate::OEQ, rowSum, zeroF);
+        forEach(b, loc, valueDim, [&](OpBuilder &b, Location loc, Value n) {
+          Value acc = memref::LoadOp::create(b, loc, output, rowIndices(n));
+          Value div = arith::DivFOp::create(b, loc, acc, rowSum);
+          Value result =
+              arith::SelectOp::create(b, loc, isSumZero, zeroF, div);
+          memref::StoreOp::create(b, loc, result, output, rowIndices(n));
         });
+      });
+
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// PagedAttentionOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult PagedAttentionOp::verify() {
+  Operation *op = getOperation();
+  if (getNumInputs() != 5) {
+    return op->emitOpError("expected five input operands");
+  }
+  if (getNumOutputs() != 1) {
+    return op->emitOpError("expected one output operand");
+  }
+  ShapedType queryType = getQueryType();
+  ShapedType keyCacheType = getKeyCacheType();
+  ShapedType valueCacheType = getValueCacheType();
+  ShapedType blockTablesType = getBlockTablesType();
+  ShapedType contextLensType = getContextLensType();
+  ShapedType outputType = getOutputType();
+  if (queryType.getRank() != 3 || outputType.getRank() != 3) {
+    return op->emitOpError("expected query and output to be of rank 3");
+  }
+  if (keyCacheType.getRank() != 4 || valueCacheType.getRank() != 4) {
+    return op->emitOpError("expected key and value caches to be of rank 4");
+  }
+  if (blockTablesType.getRank() != 2 ||
+      !isa<IntegerType>(blockTablesType.getElementType())) {
+    return op->emitOpError(
+        "expected block tables to be of rank 2 of integer element type");
+  }
+  if (contextLensType.getRank() != 1 ||
+      !isa<IntegerType>(contextLensType.getElementType())) {
+    return op->emitOpError(
+        "expected context lengths to be of rank 1 of integer element type");
+  }
+  Type elementType = queryType.getElementType();
+  if (keyCacheType.getElementType() != elementType ||
+      valueCacheType.getElementType() != elementType ||
+      outputType.getElementType() != elementType) {
+    return op->emitOpError(
+        "expected query, caches and output to have the same element type");
   }
 
-  // calculate max(weight)
-  Value init = memref::LoadOp::create(b, loc, weight,
-                                      SmallVector<Value>(weightRank, zero));
-  Value globalMax =
-      scf::ParallelOp::create(
-          b, loc, SmallVector<Value>(weightRank, zero), weightDynSizes,
-          SmallVector<Value>(weightRank, one), init,
-          [&](OpBuilder &b, Location loc, ValueRange localIVs,
-              ValueRange accs) {
-            auto reduceOp = scf::ReduceOp::create(b, loc, init);
-            // Build reduce body.
-            Block &reductionBody = reduceOp.getReductions()[0].front();
-            auto bodyBuilder = OpBuilder::atBlockEnd(&reductionBody);
-            Value acc = reductionBody.getArgument(0);
-            Value x =
-                memref::LoadOp::create(bodyBuilder, loc, weight, localIVs);
-            Value max = arith::MaximumFOp::create(bodyBuilder, loc, x, acc);
-            scf::ReduceReturnOp::create(bodyBuilder, loc, max);
-          })
-          .getResult(0);
-  // weight = (weight - max(weight)) / math.sqrt(querySizes[-1])
-  scf::ParallelOp::create(
-      b, loc, SmallVector<Value>(weightRank, zero), weightDynSizes,
-      SmallVector<Value>(weightRank, one),
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        Value x = memref::LoadOp::create(b, loc, weight, localIVs);
-        x = arith::SubFOp::create(b, loc, x, globalMax);
-        memref::StoreOp::create(b, loc, x, weight, localIVs);
-      });
-  // calculate exp(weight)
-  SmallVector<Value> min(weightRank, zero),
-      max(weightDynSizes.begin(), weightDynSizes.end()), steps(weightRank, one);
-  scf::ParallelOp::create(
-      b, loc, min, max, steps,
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        Value x = memref::LoadOp::create(b, loc, weight, localIVs);
-        x = math::ExpOp::create(b, loc, x);
-        memref::StoreOp::create(b, loc, x, weight, localIVs);
-      });
+  auto dimsMatch = [](ShapedType t1, unsigned dim1, ShapedType t2,
+                      unsigned dim2) {
+    return t1.isDynamicDim(dim1) || t2.isDynamicDim(dim2) ||
+           t1.getDimSize(dim1) == t2.getDimSize(dim2);
+  };
+  if (!dimsMatch(queryType, 0, outputType, 0) ||
+      !dimsMatch(queryType, 0, blockTablesType, 0) ||
+      !dimsMatch(queryType, 0, contextLensType, 0)) {
+    return op->emitOpError("mismatch in number of sequences");
+  }
+  if (!dimsMatch(queryType, 1, outputType, 1)) {
+    return op->emitOpError("query and output head count mismatch");
+  }
+  if (!dimsMatch(queryType, 2, keyCacheType, 3)) {
+    return op->emitOpError("query and key head dimension mismatch");
+  }
+  for (unsigned dim = 0; dim < 3; ++dim) {
+    if (!dimsMatch(keyCacheType, dim, valueCacheType, dim)) {
+      return op->emitOpError("key and value cache mismatch at dim#") << dim;
+    }
+  }
+  if (!dimsMatch(valueCacheType, 3, outputType, 2)) {
+    return op->emitOpError("value and output head dimension mismatch");
+  }
+  if (!queryType.isDynamicDim(1) && !keyCacheType.isDynamicDim(2) &&
+      queryType.getDimSize(1) % keyCacheType.getDimSize(2) != 0) {
+    return op->emitOpError(
+        "expected number of key/value heads to divide number of query heads");
+  }
+  return success();
+}
 
-  llvm::SmallVector<Value> expWeightDynDims(weightFilteredDynSizes);
-  if (weightSizes.back() == ShapedType::kDynamic)
-    expWeightDynDims.resize(expWeightDynDims.size() - 1);
+SmallVector<Range> PagedAttentionOp::getIterationDomain(OpBuilder &builder) {
+  // The parallel loop over the sequences and heads is emitted by
+  // generateScalarImplementation.
+  return {};
+}
+
+SmallVector<utils::IteratorType> PagedAttentionOp::getLoopIteratorTypes() {
+  return {};
+}
+
+bool PagedAttentionOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
+  return opOperand->get() != getOutput();
+}
+
+// Computes the attention of each query head with the online softmax of
+// AttentionOp::generateScalarImplementation, with one block of the cache as
+// the key tile. The physical block of every tile is looked up in the block
+// table of the sequence, and the keys and values are loaded from it in
+// place. Sequences and heads form an `scf.parallel`, and only the blocks
+// that hold the context of a sequence are visited.
+LogicalResult PagedAttentionOp::generateScalarImplementation(OpBuilder &b,
+                                                             Location loc,
+                                                             ValueRange ivs) {
+  Value query = getQuery();
+  Value keyCache = getKeyCache();
+  Value valueCache = getValueCache();
+  Value blockTables = getBlockTables();
+  Value contextLens = getContextLens();
+  Value output = getOutput();
+  auto keyCacheType = cast<MemRefType>(keyCache.getType());
+  Type elementType = getQueryType().getElementType();
+
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  Value zeroF = arith::ConstantOp::create(b, loc, elementType,
+                                          b.getFloatAttr(elementType, 0.0));
+  Value negInfF = arith::ConstantOp::create(
+      b, loc, elementType,
+      b.getFloatAttr(elementType, -std::numeric_limits<double>::infinity()));
+
+  Value numSeqs = memref::DimOp::create(b, loc, query, 0);
+  Value numHeads = memref::DimOp::create(b, loc, query, 1);
+  Value headDim = memref::DimOp::create(b, loc, query, 2);
+  Value blockSize = memref::DimOp::create(b, loc, keyCache, 1);
+  Value numKvHeads = memref::DimOp::create(b, loc, keyCache, 2);
+  Value valueDim = memref::DimOp::create(b, loc, valueCache, 3);
+  Value groupSize = arith::DivUIOp::create(b, loc, numHeads, numKvHeads);
+
+  Value scale;
+  if (FloatAttr scaleAttr = getScaleAttr()) {
+    scale = arith::ConstantOp::create(
+        b, loc, elementType,
+        b.getFloatAttr(elementType, scaleAttr.getValueAsDouble()));
+  } else {
+    Value headDimF = arith::UIToFPOp::create(
+        b, loc, elementType,
+        arith::IndexCastUIOp::create(b, loc, b.getI32Type(), headDim));
+    Value oneF = arith::ConstantOp::create(b, loc, elementType,
+                                           b.getFloatAttr(elementType, 1.0));
+    scale = arith::DivFOp::create(b, loc, oneF,
+                                  math::SqrtOp::create(b, loc, headDimF));
+  }
+
+  auto forEach = [&](OpBuilder &b, Location loc, Value ub,
+                     function_ref<void(OpBuilder &, Location, Value)> body) {
+    scf::ForOp::create(b, loc, zero, ub, one, ValueRange{},
+                       [&](OpBuilder &b, Location loc, Value iv, ValueRange) {
+                         body(b, loc, iv);
+                         scf::YieldOp::create(b, loc);
+                       });
+  };
+  auto loadIndex = [&](OpBuilder &b, Location loc, Value memref,
+                       ValueRange indices) -> Value {
+    Value v = memref::LoadOp::create(b, loc, memref, indices);
+    return arith::IndexCastOp::create(b, loc, b.getIndexType(), v);
+  };
 
-  Value expWeightSum = memref::AllocOp::create(
-      b, loc,
-      MemRefType::get(
-          SmallVector<int64_t>(weightSizes.begin(), weightSizes.end() - 1),
-          elementType),
-      expWeightDynDims);
-  scf::ParallelOp::create(
-      b, loc, SmallVector<Value>(weightRank - 1, zero),
-      SmallVector<Value>{weightDynSizes.begin(), weightDynSizes.end() - 1},
-      SmallVector<Value>(weightRank - 1, one),
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        memref::StoreOp::create(b, loc, zeroF, expWeightSum, localIVs);
-      });
-  // Loop over all dims but -1
   scf::ParallelOp::create(
-      b, loc, SmallVector<Value>(weightRank - 1, zero),
-      SmallVector<Value>(weightDynSizes.begin(), weightDynSizes.end() - 1),
-      SmallVector<Value>(weightRank - 1, one),
-      [&](OpBuilder &b, Location loc, ValueRange outsideDims) {
-        // Sum over last dim
-        scf::ParallelOp::create(
-            b, loc, zero, dim, one,
-            [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-              SmallVector<Value> coords(outsideDims);
-              coords.push_back(localIVs[0]);
-              Value x =
-                  memref::LoadOp::create(b, loc, expWeightSum, outsideDims);
-              Value y = memref::LoadOp::create(b, loc, weight, coords);
-              Value sum = arith::AddFOp::create(b, loc, x, y);
-              memref::StoreOp::create(b, loc, sum, expWeightSum, outsideDims);
+      b, loc, ValueRange{zero, zero}, ValueRange{numSeqs, numHeads},
+      ValueRange{one, one},
+      [&](OpBuilder &b, Location loc, ValueRange rowIVs) {
+        Value seq = rowIVs[0];
+        Value head = rowIVs[1];
+        Value kvHead = arith::DivUIOp::create(b, loc, head, groupSize);
+        Value contextLen = loadIndex(b, loc, contextLens, seq);
+        auto rowIndices = [&](Value col) {
+          return SmallVector<Value>{seq, head, col};
+        };
+        auto cacheIndices = [&](Value block, Value slot, Value col) {
+          return SmallVector<Value>{block, slot, kvHead, col};
+        };
+
+        forEach(b, loc, valueDim, [&](OpBuilder &b, Location loc, Value n) {
+          memref::StoreOp::create(b, loc, zeroF, output, rowIndices(n));
+        });
+
+        auto scoresType =
+            MemRefType::get({keyCacheType.getDimSize(1)}, elementType);
+        SmallVector<Value> scoresSizes;
+        if (scoresType.isDynamicDim(0))
+          scoresSizes.push_back(blockSize);
+        Value scores =
+            memref::AllocaOp::create(b, loc, scoresType, scoresSizes);
+
+        Value numBlocks =
+            arith::CeilDivUIOp::create(b, loc, contextLen, blockSize);
+        auto blockLoop = scf::ForOp::create(
+            b, loc, zero, numBlocks, one, ValueRange{negInfF, zeroF},
+            [&](OpBuilder &b, Location loc, Value blockIdx,
+                ValueRange stats) {
+              Value runningMax = stats[0];
+              Value runningSum = stats[1];
+              Value block =
+                  loadIndex(b, loc, blockTables, ValueRange{seq, blockIdx});
+              Value tileStart = arith::MulIOp::create(b, loc, blockIdx,
+                                                      blockSize);
+              Value tileLen = arith::MinUIOp::create(
+                  b, loc, blockSize,
+                  arith::SubIOp::create(b, loc, contextLen, tileStart));
+
+              // scores[j] = scale * (q . k_j), and their max.
+              Value tileMax =
+                  scf::ForOp::create(
+                      b, loc, zero, tileLen, one, ValueRange{runningMax},
+                      [&](OpBuilder &b, Location loc, Value j,
+                          ValueRange maxes) {
+                        Value dot =
+                            scf::ForOp::create(
+                                b, loc, zero, headDim, one, ValueRange{zeroF},
+                                [&](OpBuilder &b, Location loc, Value k,
+                                    ValueRange accs) {
+                                  Value q = memref::LoadOp::create(
+                                      b, loc, query, rowIndices(k));
+                                  Value kElem = memref::LoadOp::create(
+                                      b, loc, keyCache,
+                                      cacheIndices(block, j, k));
+                                  Value x = arith::MulFOp::create(b, loc, q,
+                                                                  kElem);
+                                  x = arith::AddFOp::create(b, loc, x,
+                                                            accs[0]);
+                                  scf::YieldOp::create(b, loc, x);
+                                })
+                                ->getResult(0);
+                        Value score = arith::MulFOp::create(b, loc, dot, scale);
+                        memref::StoreOp::create(b, loc, score, scores, j);
+                        scf::YieldOp::create(
+                            b, loc,
+                            ValueRange{arith::MaximumFOp::create(b, loc,
+                                                                 maxes[0],
+                                                                 score)});
+                      })
+                      ->getResult(0);
+
+              // Rescales the output row and accumulates the block into it.
+              Value correction = math::ExpOp::create(
+                  b, loc, arith::SubFOp::create(b, loc, runningMax, tileMax));
+              forEach(b, loc, valueDim,
+                      [&](OpBuilder &b, Location loc, Value n) {
+                        Value acc = memref::LoadOp::create(b, loc, output,
+                                                           rowIndices(n));
+                        acc = arith::MulFOp::create(b, loc, acc, correction);
+                        memref::StoreOp::create(b, loc, acc, output,
+                                                rowIndices(n));
+                      });
+              Value initSum =
+                  arith::MulFOp::create(b, loc, runningSum, correction);
+              Value tileSum =
+                  scf::ForOp::create(
+                      b, loc, zero, tileLen, one, ValueRange{initSum},
+                      [&](OpBuilder &b, Location loc, Value j,
+                          ValueRange sums) {
+                        Value score = memref::LoadOp::create(b, loc, scores, j);
+                        Value p = math::ExpOp::create(
+                            b, loc,
+                            arith::SubFOp::create(b, loc, score, tileMax));
+                        forEach(b, loc, valueDim,
+                                [&](OpBuilder &b, Location loc, Value n) {
+                                  Value v = memref::LoadOp::create(
+                                      b, loc, valueCache,
+                                      cacheIndices(block, j, n));
+                                  Value acc = memref::LoadOp::create(
+                                      b, loc, output, rowIndices(n));
+                                  Value x = arith::MulFOp::create(b, loc, p, v);
+                                  x = arith::AddFOp::create(b, loc, acc, x);
+                                  memref::StoreOp::create(b, loc, x, output,
+                                                          rowIndices(n));
+                                });
+                        Value sum = arith::AddFOp::create(b, loc, sums[0], p);
+                        scf::YieldOp::create(b, loc, sum);
+                      })
+                      ->getResult(0);
+              scf::YieldOp::create(b, loc, ValueRange{tileMax, tileSum});
             });
-      });
-  // calculate exp(weight) / sum(exp(weight))
-  scf::ParallelOp::create(
-      b, loc, SmallVector<Value>(weightRank, zero),
-      SmallVector<Value>(weightDynSizes.begin(), weightDynSizes.end()),
-      SmallVector<Value>(weightRank, one),
-      [&](OpBuilder &b, Location loc, ValueRange localIVs) {
-        SmallVector<Value> sumIVs(localIVs);
-        sumIVs.pop_back();
-
-        Value x = memref::LoadOp::create(b, loc, weight, localIVs);
-        Value sum = memref::LoadOp::create(b, loc, expWeightSum, sumIVs);
-        Value divResult = arith::DivFOp::create(b, loc, x, sum);
-
-        // Set to 0 if sum is 0 (can occur during boolean mask / large negative
-        // QK)
-        Value isSumZero = arith::CmpFOp::create(
-            b, loc, arith::CmpFPredicate::OEQ, sum, zeroF);
-        Value result =
-            arith::SelectOp::create(b, loc, isSumZero, zeroF, divResult);
 
-        memref::StoreOp::create(b, loc, result, weight, localIVs);
+        // output = output / sum, or 0 for an empty context.
+        Value rowSum = blockLoop->getResult(1);
+        Value isSumZero = arith::CmpFOp::create(
+            b, loc, arith::CmpFPredicate::OEQ, rowSum, zeroF);
+        forEach(b, loc, valueDim, [&](OpBuilder &b, Location loc, Value n) {
+          Value acc = memref::LoadOp::create(b, loc, output, rowIndices(n));
+          Value div = arith::DivFOp::create(b, loc, acc, rowSum);
+          Value result =
+              arith::SelectOp::create(b, loc, isSumZero, zeroF, div);
+          memref::StoreOp::create(b, loc, result, output, rowIndices(n));
+        });
       });
 
-  // output = weight @ value
-  matmul(b, loc, weight, weightDynSizes, value, valueDynSizes, output,
-         outputDynSizes, /*transposed=*/false);
-
   return success();
 }
 
@@ -461,18 +928,9 @@ LogicalResult ScanOp::verify() {
 }
 
 SmallVector<Range> ScanOp::getIterationDomain(OpBuilder &builder) {
-  int64_t operandRank = getOperandRank();
-  SmallVector<Range> loopBounds(operandRank);
-  Location loc = getLoc();
-  Value zero = arith::ConstantIndexOp::create(builder, loc, 0);
-  Value one = arith::ConstantIndexOp::create(builder, loc, 1);
-  Value source = input();
-  for (auto dim : llvm::seq<int64_t>(0, operandRank)) {
-    loopBounds[dim].offset = zero;
-    loopBounds[dim].size = getDimValue(builder, loc, source, dim);
-    loopBounds[dim].stride = one;
-  }
-  return loopBounds;
+  // The scan, including the loops over the non-scanned dims, is emitted by
+  // generateScalarImplementation.
+  return {};
 }
 
 SmallVector<utils::IteratorType> ScanOp::getLoopIteratorTypes() {
@@ -495,84 +953,219 @@ bool ScanOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
   }
 }
 
-// Generates naive scalar implementation of scan for a given operator f.
+/// Number of elements along the scanned dimension that one block of the
+/// blocked tm_tensor.scan lowering handles.
+static constexpr int64_t kScanBlockSize = 1024;
+
+// Generates a blocked scan for a given associative operator f.
 // For inclusive,
 //     output[0] = input[0]
 //     output[i] = f(output[i-1], input[i])
 //
 // For exclusive,
-//     output[0] = 0
+//     output[0] = accumulator
 //     output[i] = f(output[i-1], input[i-1])
-
-LogicalResult ScanOp::generateScalarImplementation(OpBuilder &b, Location loc,
-                                                   ValueRange ivs) {
-  SmallVector<Value> indices, scanBlkArgs;
-  indices.append(ivs.begin(), ivs.end());
+//
+// and the accumulator is set to the last output. Rows longer than
+// kScanBlockSize are split into blocks that are scanned on their own in
+// parallel. A sequential scan over the block totals then gives the prefix
+// of each block, which is combined into its outputs in parallel. Rows are
+// independent, so the non-scanned dims form an `scf.parallel`.
+//
+// With a non-zero `vectorWidth`, vectors of that many rows along the
+// innermost dim are scanned at once, which requires it not to be the
+// scanned dim.
+static LogicalResult emitScan(ScanOp op, OpBuilder &b, Location loc,
+                              int64_t vectorWidth) {
+  uint64_t scanDim = op.getDimension();
+  int64_t rank = op.getOperandRank();
+  bool isInclusive = op.getInclusive();
+  Block &srcBlock = op.getRegion().front();
+  Value input = op.input(), output = op.output();
+  Value accumulator = op.accumulator();
+  VectorType vectorType;
+  if (vectorWidth > 0) {
+    if (static_cast<int64_t>(scanDim) == rank - 1 ||
+        !isVectorizableCombiner(srcBlock) ||
+        !llvm::all_of(ValueRange{input, output, accumulator},
+                      hasContiguousInnermostDim))
+      return failure();
+    vectorType = VectorType::get({vectorWidth},
+                                 op.getOperandType().getElementType());
+  }
   Value zero = arith::ConstantIndexOp::create(b, loc, 0);
   Value one = arith::ConstantIndexOp::create(b, loc, 1);
-  uint64_t scanDim = getDimension();
-  Value cond = arith::CmpIOp::create(b, loc, arith::CmpIPredicate::eq,
-                                     indices[scanDim], zero);
-  bool isInclusive = getInclusive();
-  SmallVector<Value> accIndices;
-  for (size_t i = 0; i < indices.size(); i++) {
-    if (i != scanDim)
-      accIndices.push_back(indices[i]);
-  }
-
-  auto scfIf = scf::IfOp::create(
-      b, loc, cond,
-      [&](OpBuilder &b, Location loc) {
-        if (isInclusive) {
-          auto value = memref::LoadOp::create(b, loc, input(), indices);
-          memref::StoreOp::create(b, loc, value, output(), indices);
-        } else {
-          auto value =
-              memref::LoadOp::create(b, loc, accumulator(), accIndices);
-          memref::StoreOp::create(b, loc, value, output(), indices);
-        }
-        scf::YieldOp::create(b, loc);
-      },
-      [&](OpBuilder &b, Location loc) {
-        SmallVector<Value> indices(ivs.begin(), ivs.end());
-        Value iv = indices[scanDim];
-        Value ivMinusOne = arith::SubIOp::create(b, loc, iv, one);
-        indices[scanDim] = ivMinusOne;
-        scanBlkArgs.push_back(
-            memref::LoadOp::create(b, loc, output(), indices));
-        Value i0;
-        if (!isInclusive)
-          i0 = memref::LoadOp::create(b, loc, input(), indices);
-        indices[scanDim] = iv;
-        if (isInclusive)
-          i0 = memref::LoadOp::create(b, loc, input(), indices);
-        scanBlkArgs.push_back(i0);
-      });
+  Value size = getDimValue(b, loc, input, scanDim);
+  int64_t staticSize = op.getOperandType().getDimSize(scanDim);
 
-  auto &srcBlock = getRegion().front();
-  Region &thisRegion = scfIf.getElseRegion();
-  IRMapping bvm;
-  {
-    OpBuilder::InsertionGuard guard(b);
-    auto &block = thisRegion.front();
-    b.setInsertionPointToEnd(&block);
-    for (auto it : llvm::zip(srcBlock.getArguments(), scanBlkArgs)) {
-      bvm.map(std::get<0>(it), std::get<1>(it));
+  auto combine = [&](OpBuilder &b, Value lhs, Value rhs) {
+    return cloneCombiner(b, loc, srcBlock, {lhs, rhs}, vectorType);
+  };
+
+  auto scanRow = [&](OpBuilder &b, Location loc, ValueRange outerIVs) {
+    SmallVector<Value> accIndices(outerIVs.begin(), outerIVs.end());
+    auto at = [&](Value pos) {
+      SmallVector<Value> indices(outerIVs.begin(), outerIVs.end());
+      indices.insert(indices.begin() + scanDim, pos);
+      return indices;
+    };
+    Value mask;
+    if (vectorType) {
+      mask = getLaneMask(b, loc, vectorWidth, outerIVs.back(),
+                         getDimValue(b, loc, input, rank - 1));
     }
-    for (auto &blockOp : srcBlock.without_terminator()) {
-      b.clone(blockOp, bvm);
+    auto load = [&](OpBuilder &b, Location loc, Value memref,
+                    ValueRange indices) {
+      return loadLanes(b, loc, memref, indices, vectorType, mask);
+    };
+    auto store = [&](OpBuilder &b, Location loc, Value value, Value memref,
+                     ValueRange indices) {
+      storeLanes(b, loc, value, memref, indices, mask);
+    };
+
+    // Scans the non-empty range [lb, ub) of the row on its own.
+    auto scanBlock = [&](OpBuilder &b, Location loc, Value lb, Value ub) {
+      Value first;
+      if (isInclusive) {
+        first = load(b, loc, input, at(lb));
+      } else {
+        Value prev = arith::SubIOp::create(
+            b, loc, arith::MaxUIOp::create(b, loc, lb, one), one);
+        Value value = load(b, loc, input, at(prev));
+        Value init = load(b, loc, accumulator, accIndices);
+        Value isFirst = arith::CmpIOp::create(
+            b, loc, arith::CmpIPredicate::eq, lb, zero);
+        first = arith::SelectOp::create(b, loc, isFirst, init, value);
+      }
+      store(b, loc, first, output, at(lb));
+      scf::ForOp::create(
+          b, loc, arith::AddIOp::create(b, loc, lb, one), ub, one,
+          ValueRange{first},
+          [&](OpBuilder &b, Location loc, Value iv, ValueRange iters) {
+            Value pos = iv;
+            if (!isInclusive)
+              pos = arith::SubIOp::create(b, loc, iv, one);
+            Value value = load(b, loc, input, at(pos));
+            Value result = combine(b, iters[0], value);
+            store(b, loc, result, output, at(iv));
+            scf::YieldOp::create(b, loc, result);
+          });
+    };
+
+    if (!ShapedType::isDynamic(staticSize) && staticSize <= kScanBlockSize) {
+      scanBlock(b, loc, zero, size);
+    } else {
+      Value blockSize = arith::ConstantIndexOp::create(b, loc, kScanBlockSize);
+      Value numBlocks = arith::CeilDivUIOp::create(b, loc, size, blockSize);
+      auto blockBounds = [&](OpBuilder &b, Location loc, Value block) {
+        Value lb = arith::MulIOp::create(b, loc, block, blockSize);
+        Value ub = arith::MinUIOp::create(
+            b, loc, arith::AddIOp::create(b, loc, lb, blockSize), size);
+        return std::make_pair(lb, ub);
+      };
+      scf::ParallelOp::create(
+          b, loc, ValueRange{zero}, ValueRange{numBlocks}, ValueRange{one},
+          [&](OpBuilder &b, Location loc, ValueRange blockIVs) {
+            Value lb, ub;
+            std::tie(lb, ub) = blockBounds(b, loc, blockIVs[0]);
+            scanBlock(b, loc, lb, ub);
+          });
+
+      auto propagate = [&](OpBuilder &b, Location loc) {
+        // prefixes[block] is the combined total of the blocks before it.
+        Type prefixType = vectorType ? Type(vectorType)
+                                     : op.getOperandType().getElementType();
+        Value prefixes = memref::AllocOp::create(
+            b, loc, MemRefType::get({ShapedType::kDynamic}, prefixType),
+            numBlocks);
+        Value firstTotal = load(
+            b, loc, output, at(arith::SubIOp::create(b, loc, blockSize, one)));
+        scf::ForOp::create(
+            b, loc, one, numBlocks, one, ValueRange{firstTotal},
+            [&](OpBuilder &b, Location loc, Value block, ValueRange iters) {
+              memref::StoreOp::create(b, loc, iters[0], prefixes, block);
+              Value last = arith::SubIOp::create(
+                  b, loc, blockBounds(b, loc, block).second, one);
+              Value total = load(b, loc, output, at(last));
+              scf::YieldOp::create(b, loc, combine(b, iters[0], total));
+            });
+        scf::ParallelOp::create(
+            b, loc, ValueRange{one}, ValueRange{numBlocks}, ValueRange{one},
+            [&](OpBuilder &b, Location loc, ValueRange blockIVs) {
+              Value prefix =
+                  memref::LoadOp::create(b, loc, prefixes, blockIVs[0]);
+              Value lb, ub;
+              std::tie(lb, ub) = blockBounds(b, loc, blockIVs[0]);
+              scf::ForOp::create(
+                  b, loc, lb, ub, one, ValueRange{},
+                  [&](OpBuilder &b, Location loc, Value iv, ValueRange) {
+                    Value value = load(b, loc, output, at(iv));
+                    store(b, loc, combine(b, prefix, value), output, at(iv));
+                    scf::YieldOp::create(b, loc);
+                  });
+            });
+        memref::DeallocOp::create(b, loc, prefixes);
+      };
+      if (ShapedType::isDynamic(staticSize)) {
+        Value isBlocked = arith::CmpIOp::create(
+            b, loc, arith::CmpIPredicate::ugt, numBlocks, one);
+        scf::IfOp::create(b, loc, isBlocked, [&](OpBuilder &b, Location loc) {
+          propagate(b, loc);
+          scf::YieldOp::create(b, loc);
+        });
+      } else {
+        propagate(b, loc);
+      }
     }
-    memref::StoreOp::create(
-        b, loc, bvm.lookupOrDefault(srcBlock.getTerminator()->getOperand(0)),
-        output(), indices);
-    memref::StoreOp::create(
-        b, loc, bvm.lookupOrDefault(srcBlock.getTerminator()->getOperand(0)),
-        accumulator(), accIndices);
-    scf::YieldOp::create(b, loc);
+
+    Value last = arith::SubIOp::create(b, loc, size, one);
+    Value total = load(b, loc, output, at(last));
+    store(b, loc, total, accumulator, accIndices);
+  };
+
+  auto scanRows = [&](OpBuilder &b, Location loc) {
+    if (rank == 1) {
+      scanRow(b, loc, ValueRange{});
+      return;
+    }
+    SmallVector<Value> outerUpperBounds;
+    for (int64_t dim = 0; dim < rank; ++dim) {
+      if (dim != static_cast<int64_t>(scanDim))
+        outerUpperBounds.push_back(getDimValue(b, loc, input, dim));
+    }
+    SmallVector<Value> steps(rank - 1, one);
+    if (vectorType)
+      steps.back() = arith::ConstantIndexOp::create(b, loc, vectorWidth);
+    scf::ParallelOp::create(b, loc, SmallVector<Value>(rank - 1, zero),
+                            outerUpperBounds, steps, scanRow);
+  };
+  // An empty scan leaves the accumulator untouched.
+  if (!ShapedType::isDynamic(staticSize)) {
+    if (staticSize > 0)
+      scanRows(b, loc);
+    return success();
   }
+  Value nonEmpty =
+      arith::CmpIOp::create(b, loc, arith::CmpIPredicate::ugt, size, zero);
+  scf::IfOp::create(b, loc, nonEmpty, [&](OpBuilder &b, Location loc) {
+    scanRows(b, loc);
+    scf::YieldOp::create(b, loc);
+  });
   return success();
 }
 
+
+LogicalResult ScanOp::generateScalarImplementation(OpBuilder &b, Location loc,
+                                                   ValueRange ivs) {
+  return emitScan(*this, b, loc, /*vectorWidth=*/0);
+}
+
+LogicalResult ScanOp::generateVectorizedImplementation(OpBuilder &b,
+                                                       Location loc,
+                                                       ValueRange ivs,
+                                                       int64_t vectorWidth) {
+  return emitScan(*this, b, loc, vectorWidth);
+}
 static LogicalResult foldMemRefCast(Operation *op) {
   bool folded = false;
   for (OpOperand &operand : op->getOpOperands()) {
@@ -739,12 +1332,9 @@ LogicalResult ScatterOp::verify() {
 }
 
 SmallVector<utils::IteratorType> ScatterOp::getLoopIteratorTypes() {
-  SmallVector<utils::IteratorType> iteratorTypes(getUpdateType().getRank(),
-                                                 utils::IteratorType::parallel);
-  if (!getUniqueIndices()) {
-    iteratorTypes[0] = utils::IteratorType::reduction;
-  }
-  return iteratorTypes;
+  // Like the iteration domain, empty: generateScalarImplementation emits all
+  // the loops.
+  return {};
 }
 
 bool ScatterOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
@@ -769,63 +1359,517 @@ bool ScatterOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
 }
 
 SmallVector<Range> ScatterOp::getIterationDomain(OpBuilder &builder) {
-  Location loc = getLoc();
-  Value zero = arith::ConstantIndexOp::create(builder, loc, 0);
-  Value one = arith::ConstantIndexOp::create(builder, loc, 1);
-  SmallVector<Range> ranges;
-  for (auto dim : llvm::seq<int64_t>(0, getUpdateType().getRank())) {
-    Value ub = getDimValue(builder, loc, updates(), dim);
-    ranges.emplace_back(Range{zero, ub, one});
+  // The loops over the updates, parallel where it is safe, are emitted by
+  // generateScalarImplementation.
+  return {};
+}
+
+/// Returns the atomic read-modify-write kind that computes the combiner in
+/// `block`, if it is a single commutative integer op of the two arguments
+/// that memref.atomic_rmw lowers directly. Float combiners, e.g. addf, are
+/// excluded: the order in which the atomics land would change the rounding
+/// from run to run, and the in-order loop gives deterministic results.
+static std::optional<arith::AtomicRMWKind> getScatterAtomicKind(Block &block) {
+  if (!llvm::hasSingleElement(block.without_terminator()))
+    return std::nullopt;
+  Operation &op = block.front();
+  if (op.getNumOperands() != 2 || op.getNumResults() != 1 ||
+      block.getTerminator()->getOperand(0) != op.getResult(0))
+    return std::nullopt;
+  Value lhs = op.getOperand(0), rhs = op.getOperand(1);
+  Value update = block.getArgument(0), current = block.getArgument(1);
+  if (!((lhs == update && rhs == current) ||
+        (lhs == current && rhs == update)))
+    return std::nullopt;
+  return TypeSwitch<Operation *, std::optional<arith::AtomicRMWKind>>(&op)
+      .Case([](arith::AddIOp) { return arith::AtomicRMWKind::addi; })
+      .Case([](arith::MaxSIOp) { return arith::AtomicRMWKind::maxs; })
+      .Case([](arith::MaxUIOp) { return arith::AtomicRMWKind::maxu; })
+      .Case([](arith::MinSIOp) { return arith::AtomicRMWKind::mins; })
+      .Case([](arith::MinUIOp) { return arith::AtomicRMWKind::minu; })
+      .Case([](arith::OrIOp) { return arith::AtomicRMWKind::ori; })
+      .Case([](arith::AndIOp) { return arith::AtomicRMWKind::andi; })
+      .Default([](Operation *) { return std::nullopt; });
+}
+
+// The slice of one update never writes an element twice, so the slice dims
+// are always parallel. The updates themselves are parallel when
+// `unique_indices` holds and their slices cannot overlap, i.e. no indexed
+// dim is also spanned by the slice, or when the combiner is a commutative
+// integer op that is applied with memref.atomic_rmw. Otherwise they are
+// applied in order.
+//
+// With a non-zero `vectorWidth`, vectors of that many elements of the
+// innermost slice dim are combined at once. This is not done for atomic
+// combiners.
+static LogicalResult emitScatter(ScatterOp op, OpBuilder &b, Location loc,
+                                 int64_t vectorWidth) {
+  auto indexDepth = op.getIndexDepth();
+  auto originalTy = cast<ShapedType>(op.original().getType());
+  ShapedType updateTy = op.getUpdateType();
+  int64_t updateRank = updateTy.getRank();
+  ArrayRef<int64_t> dimMap = op.getDimensionMap();
+  Block &block = op.getRegion().front();
+
+  int64_t offset = originalTy.getRank() - (updateRank - 1);
+  bool slicesMayOverlap = llvm::any_of(dimMap, [&](int64_t dim) {
+    return dim >= offset && updateTy.getDimSize(dim - offset + 1) != 1;
+  });
+  std::optional<arith::AtomicRMWKind> atomicKind;
+  if (!op.getUniqueIndices() || slicesMayOverlap)
+    atomicKind = getScatterAtomicKind(block);
+  bool updatesAreParallel =
+      (op.getUniqueIndices() && !slicesMayOverlap) || atomicKind;
+  VectorType vectorType;
+  if (vectorWidth > 0) {
+    if (updateRank < 2 || atomicKind || !isVectorizableCombiner(block) ||
+        !hasContiguousInnermostDim(op.updates()) ||
+        !hasContiguousInnermostDim(op.original()))
+      return failure();
+    vectorType = VectorType::get({vectorWidth}, originalTy.getElementType());
+  }
+
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  SmallVector<Value> ubs;
+  for (auto dim : llvm::seq<int64_t>(0, updateRank))
+    ubs.push_back(getDimValue(b, loc, op.updates(), dim));
+  SmallVector<Value> steps(updateRank, one);
+  if (vectorType)
+    steps.back() = arith::ConstantIndexOp::create(b, loc, vectorWidth);
+
+  auto scatterElement = [&](OpBuilder &b, Location loc, ValueRange ivs) {
+    Value mask;
+    if (vectorType)
+      mask = getLaneMask(b, loc, vectorWidth, ivs.back(), ubs.back());
+    Value update = loadLanes(b, loc, op.updates(), ivs, vectorType, mask);
+    SmallVector<Value> starts;
+    SmallVector<Value> loadIndices;
+    loadIndices.push_back(ivs.front());
+    loadIndices.push_back(Value());
+
+    // Populate with empty values.
+    starts.resize(originalTy.getRank(), Value());
+    auto updateIvs = ivs.drop_front(1);
+
+    for (auto it : llvm::enumerate(updateIvs)) {
+      starts[it.index() + offset] = it.value();
+    }
+
+    for (auto i : llvm::seq<unsigned>(0, indexDepth)) {
+      loadIndices.back() = arith::ConstantIndexOp::create(b, loc, i);
+      Value idx = memref::LoadOp::create(b, loc, op.indices(), loadIndices);
+      Value ret = arith::IndexCastOp::create(b, loc, b.getIndexType(), idx);
+
+      auto dim = dimMap[i];
+      if (starts[dim])
+        ret = arith::AddIOp::create(b, loc, ret, starts[dim]);
+      starts[dim] = ret;
+    }
+
+    if (atomicKind) {
+      memref::AtomicRMWOp::create(b, loc, *atomicKind, update, op.original(),
+                                  starts);
+      return;
+    }
+
+    Value init = loadLanes(b, loc, op.original(), starts, vectorType, mask);
+    Value result = cloneCombiner(b, loc, block, {update, init}, vectorType);
+    storeLanes(b, loc, result, op.original(), starts, mask);
+  };
+
+  if (updatesAreParallel) {
+    scf::ParallelOp::create(b, loc, SmallVector<Value>(updateRank, zero), ubs,
+                            steps, scatterElement);
+    return success();
   }
-  return ranges;
+  scf::ForOp::create(
+      b, loc, zero, ubs.front(), one, ValueRange{},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange) {
+        if (updateRank == 1) {
+          scatterElement(b, loc, iv);
+        } else {
+          scf::ParallelOp::create(
+              b, loc, SmallVector<Value>(updateRank - 1, zero),
+              ArrayRef<Value>(ubs).drop_front(),
+              ArrayRef<Value>(steps).drop_front(),
+              [&](OpBuilder &b, Location loc, ValueRange sliceIvs) {
+                SmallVector<Value> ivs{iv};
+                llvm::append_range(ivs, sliceIvs);
+                scatterElement(b, loc, ivs);
+              });
+        }
+        scf::YieldOp::create(b, loc);
+      });
+  return success();
 }
 
+
 LogicalResult ScatterOp::generateScalarImplementation(OpBuilder &b,
                                                       Location loc,
                                                       ValueRange ivs) {
-  auto indexDepth = getIndexDepth();
-  Value update = memref::LoadOp::create(b, loc, updates(), ivs);
-  SmallVector<Value> starts;
-  SmallVector<Value> loadIndices;
-  loadIndices.push_back(ivs.front());
-  loadIndices.push_back(Value());
+  return emitScatter(*this, b, loc, /*vectorWidth=*/0);
+}
 
-  // Populate with empty values.
-  auto originalTy = cast<ShapedType>(original().getType());
-  starts.resize(originalTy.getRank(), Value());
-  auto updateIvs = ivs.drop_front(1);
+LogicalResult ScatterOp::generateVectorizedImplementation(
+    OpBuilder &b, Location loc, ValueRange ivs, int64_t vectorWidth) {
+  return emitScatter(*this, b, loc, vectorWidth);
+}
+
+//===----------------------------------------------------------------------===//
+// GatherOp
+//===----------------------------------------------------------------------===//
 
-  int64_t offset = starts.size() - updateIvs.size();
-  for (auto it : llvm::enumerate(updateIvs)) {
-    starts[it.index() + offset] = it.value();
+LogicalResult GatherOp::verify() {
+  Operation *op = getOperation();
+  if (getInputs().size() != 2) {
+    return op->emitOpError("expected two input operands");
+  }
+  if (getOutputs().size() != 1) {
+    return op->emitOpError("expected one output operand");
+  }
+
+  auto indicesType = getIndicesType();
+  if (indicesType.getRank() != 2 ||
+      !isa<IntegerType>(indicesType.getElementType())) {
+    return emitOpError(
+        "expected indices to be of rank 2 of integer element type");
+  }
+  auto indexDepth = getIndexDepth();
+  if (ShapedType::isDynamic(indexDepth)) {
+    return emitOpError("expected index depth is static");
   }
 
   ArrayRef<int64_t> dimMap = getDimensionMap();
-  for (auto i : llvm::seq<unsigned>(0, indexDepth)) {
-    loadIndices.back() = arith::ConstantIndexOp::create(b, loc, i);
-    Value idx = memref::LoadOp::create(b, loc, indices(), loadIndices);
-    Value ret = arith::IndexCastOp::create(b, loc, b.getIndexType(), idx);
+  if (static_cast<int64_t>(dimMap.size()) != indexDepth) {
+    return op->emitOpError("invalid number of dimension map entries ");
+  }
+
+  auto sourceType = getSourceType();
+  if (isInvalid(dimMap, sourceType.getRank()))
+    return op->emitOpError("dimension map is invalid");
 
-    auto dim = dimMap[i];
-    if (starts[dim])
-      ret = arith::AddIOp::create(b, loc, ret, starts[dim]);
-    starts[dim] = ret;
+  auto outputType = getOutputType();
+  if (outputType.getRank() < 1) {
+    return emitOpError("expected result to be at least rank 1");
+  }
+  if (indicesType.getShape()[0] != outputType.getShape()[0]) {
+    return emitOpError("mismatch in shape of indices and result at dim#0");
+  }
+  if (outputType.getElementType() != sourceType.getElementType()) {
+    return emitOpError("mismatch in element type of source ")
+           << sourceType.getElementType() << " and result "
+           << outputType.getElementType();
+  }
+  int64_t sliceStart = sourceType.getRank() - getSliceRank();
+  if (sliceStart < 0) {
+    return emitOpError("result slice rank exceeds the rank of the source");
   }
 
-  Value init = memref::LoadOp::create(b, loc, original(), starts);
+  // The dims of the source before the slice dims are only addressed by the
+  // indices.
+  for (int64_t dim = 0; dim < sliceStart; ++dim) {
+    if (!llvm::is_contained(dimMap, dim)) {
+      return op->emitOpError("source dim#")
+             << dim << " is neither indexed nor a slice dim";
+    }
+  }
+  for (int64_t dim = sliceStart; dim < sourceType.getRank(); ++dim) {
+    int64_t outputDim = dim - sliceStart + 1;
+    if (!sourceType.isDynamicDim(dim) && !outputType.isDynamicDim(outputDim) &&
+        outputType.getDimSize(outputDim) > sourceType.getDimSize(dim)) {
+      return op->emitOpError("shape of result dim#")
+             << outputDim << " exceeds source at dim#" << dim;
+    }
+  }
+  return success();
+}
+
+SmallVector<utils::IteratorType> GatherOp::getLoopIteratorTypes() {
+  return SmallVector<utils::IteratorType>(getOutputType().getRank(),
+                                          utils::IteratorType::parallel);
+}
 
-  IRMapping bvm;
-  Block &block = getRegion().front();
-  bvm.map(block.getArgument(0), update);
-  bvm.map(block.getArgument(1), init);
-  for (auto &blockOp : block.without_terminator()) {
-    b.clone(blockOp, bvm);
+bool GatherOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
+  // Every element of the result is overwritten.
+  return opOperand->get() != output();
+}
+
+SmallVector<Range> GatherOp::getIterationDomain(OpBuilder &builder) {
+  // The parallel loops over the result are emitted by
+  // generateScalarImplementation.
+  return {};
+}
+
+// Every row of the result is independent. The indices of a row are loaded
+// once, outside of the parallel loop copying its slice.
+//
+// With a non-zero `vectorWidth`, vectors of that many elements of the
+// innermost slice dim are copied at once.
+static LogicalResult emitGather(GatherOp op, OpBuilder &b, Location loc,
+                                int64_t vectorWidth) {
+  int64_t indexDepth = op.getIndexDepth();
+  int64_t sliceRank = op.getSliceRank();
+  int64_t sliceStart = op.getSourceType().getRank() - sliceRank;
+  ArrayRef<int64_t> dimMap = op.getDimensionMap();
+  VectorType vectorType;
+  if (vectorWidth > 0) {
+    if (sliceRank < 1 || !hasContiguousInnermostDim(op.source()) ||
+        !hasContiguousInnermostDim(op.output()))
+      return failure();
+    vectorType =
+        VectorType::get({vectorWidth}, op.getOutputType().getElementType());
+  }
+
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  SmallVector<Value> ubs;
+  for (auto dim : llvm::seq<int64_t>(0, sliceRank + 1))
+    ubs.push_back(getDimValue(b, loc, op.output(), dim));
+  SmallVector<Value> steps(sliceRank + 1, one);
+  if (vectorType)
+    steps.back() = arith::ConstantIndexOp::create(b, loc, vectorWidth);
+
+  auto gatherRow = [&](OpBuilder &b, Location loc, ValueRange rowIvs) {
+    Value row = rowIvs.front();
+    SmallVector<Value> offsets(op.getSourceType().getRank(), Value());
+    for (auto i : llvm::seq<int64_t>(0, indexDepth)) {
+      Value idx = memref::LoadOp::create(
+          b, loc, op.indices(),
+          ValueRange{row, arith::ConstantIndexOp::create(b, loc, i)});
+      offsets[dimMap[i]] =
+          arith::IndexCastOp::create(b, loc, b.getIndexType(), idx);
+    }
+
+    auto copyElement = [&](OpBuilder &b, Location loc, ValueRange sliceIvs) {
+      SmallVector<Value> starts(offsets);
+      for (auto [i, iv] : llvm::enumerate(sliceIvs)) {
+        Value &start = starts[sliceStart + i];
+        start = start ? arith::AddIOp::create(b, loc, start, iv).getResult()
+                      : iv;
+      }
+      SmallVector<Value> outputIndices{row};
+      llvm::append_range(outputIndices, sliceIvs);
+      Value mask;
+      if (vectorType)
+        mask = getLaneMask(b, loc, vectorWidth, sliceIvs.back(), ubs.back());
+      Value value = loadLanes(b, loc, op.source(), starts, vectorType, mask);
+      storeLanes(b, loc, value, op.output(), outputIndices, mask);
+    };
+    if (sliceRank == 0) {
+      copyElement(b, loc, ValueRange{});
+      return;
+    }
+    scf::ParallelOp::create(b, loc, SmallVector<Value>(sliceRank, zero),
+                            ArrayRef<Value>(ubs).drop_front(),
+                            ArrayRef<Value>(steps).drop_front(), copyElement);
+  };
+
+  scf::ParallelOp::create(b, loc, ValueRange{zero}, ValueRange{ubs.front()},
+                          ValueRange{one}, gatherRow);
+  return success();
+}
+
+LogicalResult GatherOp::generateScalarImplementation(OpBuilder &b,
+                                                     Location loc,
+                                                     ValueRange ivs) {
+  return emitGather(*this, b, loc, /*vectorWidth=*/0);
+}
+
+LogicalResult GatherOp::generateVectorizedImplementation(
+    OpBuilder &b, Location loc, ValueRange ivs, int64_t vectorWidth) {
+  return emitGather(*this, b, loc, vectorWidth);
+}
+
+//===----------------------------------------------------------------------===//
+// SegmentReduceOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult SegmentReduceOp::verify() {
+  Operation *op = getOperation();
+  if (getInputs().size() != 2) {
+    return op->emitOpError("expected two input operands");
+  }
+  if (getOutputs().size() != 1) {
+    return op->emitOpError("expected one output operand");
+  }
+
+  auto idsType = getSegmentIdsType();
+  if (idsType.getRank() != 1 || !isa<IntegerType>(idsType.getElementType())) {
+    return emitOpError(
+        "expected segment ids to be of rank 1 of integer element type");
+  }
+  auto dataType = getDataType();
+  auto originalType = getOriginalType();
+  if (dataType.getRank() < 1) {
+    return emitOpError("expected data to be at least rank 1");
+  }
+  if (dataType.getRank() != originalType.getRank()) {
+    return emitOpError("expected data and original value to have the same "
+                       "rank");
+  }
+  if (!idsType.isDynamicDim(0) && !dataType.isDynamicDim(0) &&
+      idsType.getDimSize(0) != dataType.getDimSize(0)) {
+    return emitOpError("mismatch in shape of segment ids and data at dim#0");
+  }
+  for (int64_t dim = 1; dim < dataType.getRank(); ++dim) {
+    if (!dataType.isDynamicDim(dim) && !originalType.isDynamicDim(dim) &&
+        dataType.getDimSize(dim) != originalType.getDimSize(dim)) {
+      return op->emitOpError("mismatch in shape of data and original value "
+                             "at dim#")
+             << dim;
+    }
+  }
+  Type elementType = dataType.getElementType();
+  if (elementType != originalType.getElementType()) {
+    return emitOpError("mismatch in element type of data ")
+           << elementType << " and original value "
+           << originalType.getElementType();
+  }
+  if (!elementType.isIntOrFloat()) {
+    return emitOpError("expected data to be of integer or float element type");
+  }
+
+  Block *body = &getRegion().front();
+  if (body->getNumArguments() != 2) {
+    return op->emitOpError("expected region to have two arguments");
+  }
+  for (BlockArgument arg : body->getArguments()) {
+    if (arg.getType() != elementType) {
+      return emitOpError("mismatch in argument ")
+             << arg.getArgNumber() << " of region " << arg.getType()
+             << " and element type of data " << elementType;
+    }
+  }
+  auto yieldOp = cast<TMTensor::YieldOp>(body->getTerminator());
+  if (yieldOp->getNumOperands() != 1) {
+    return yieldOp.emitOpError("expected region to yield a single value");
+  }
+  auto yieldedType = yieldOp->getOperand(0).getType();
+  if (yieldedType != elementType) {
+    return yieldOp.emitOpError("mismatch in type of yielded value ")
+           << yieldedType << " and argument of the region " << elementType;
   }
-  // The last op is linalg_ext.yield op. Store the operand to
-  // destination.
-  memref::StoreOp::create(
-      b, loc, bvm.lookupOrDefault(block.getTerminator()->getOperand(0)),
-      original(), starts);
+  return success();
+}
+
+SmallVector<utils::IteratorType> SegmentReduceOp::getLoopIteratorTypes() {
+  return SmallVector<utils::IteratorType>(getOriginalType().getRank(),
+                                          utils::IteratorType::parallel);
+}
+
+bool SegmentReduceOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
+  // The segments are combined into the original value.
+  return true;
+}
+
+SmallVector<Range> SegmentReduceOp::getIterationDomain(OpBuilder &builder) {
+  // The parallel loops over the segments are emitted by
+  // generateScalarImplementation.
+  return {};
+}
+
+/// Returns the first position in [0, `size`) of the sorted `ids` whose id is
+/// not less than `target`, or `size` if there is none.
+static Value emitLowerBound(OpBuilder &b, Location loc, Value ids, Value size,
+                            Value target) {
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  auto whileOp = scf::WhileOp::create(
+      b, loc, TypeRange{b.getIndexType(), b.getIndexType()},
+      ValueRange{zero, size},
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        Value cond = arith::CmpIOp::create(b, loc, arith::CmpIPredicate::ult,
+                                           args[0], args[1]);
+        scf::ConditionOp::create(b, loc, cond, args);
+      },
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        Value lo = args[0];
+        Value hi = args[1];
+        Value mid = arith::ShRUIOp::create(
+            b, loc, arith::AddIOp::create(b, loc, lo, hi), one);
+        Value id = memref::LoadOp::create(b, loc, ids, mid);
+        Value isBefore = arith::CmpIOp::create(
+            b, loc, arith::CmpIPredicate::slt, id, target);
+        Value next = arith::AddIOp::create(b, loc, mid, one);
+        scf::YieldOp::create(
+            b, loc,
+            ValueRange{arith::SelectOp::create(b, loc, isBefore, next, lo),
+                       arith::SelectOp::create(b, loc, isBefore, hi, mid)});
+      });
+  return whileOp.getResult(0);
+}
+
+LogicalResult SegmentReduceOp::generateScalarImplementation(OpBuilder &b,
+                                                            Location loc,
+                                                            ValueRange ivs) {
+  int64_t rank = getOriginalType().getRank();
+  Type idType = getSegmentIdsType().getElementType();
+  Type elementType = getOriginalType().getElementType();
+  Block &combiner = getRegion().front();
+
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  Value numRows = getDimValue(b, loc, data(), 0);
+  SmallVector<Value> ubs;
+  for (auto dim : llvm::seq<int64_t>(0, rank))
+    ubs.push_back(getDimValue(b, loc, original(), dim));
+  SmallVector<Value> steps(rank, one);
+
+  // Every segment owns its rows and its row of the original value, so the
+  // segments are reduced in parallel without atomics.
+  auto reduceSegment = [&](OpBuilder &b, Location loc, ValueRange segIvs) {
+    Value segment = segIvs.front();
+    Value id = arith::IndexCastOp::create(b, loc, idType, segment);
+    Value nextId = arith::AddIOp::create(
+        b, loc, id, arith::ConstantOp::create(b, loc, b.getOneAttr(idType)));
+    Value begin = emitLowerBound(b, loc, segmentIds(), numRows, id);
+    Value end = emitLowerBound(b, loc, segmentIds(), numRows, nextId);
+
+    auto reduceElement = [&](OpBuilder &b, Location loc, ValueRange sliceIvs) {
+      SmallVector<Value> outputIndices{segment};
+      llvm::append_range(outputIndices, sliceIvs);
+      Value init = memref::LoadOp::create(b, loc, original(), outputIndices);
+      auto forOp = scf::ForOp::create(
+          b, loc, begin, end, one, ValueRange{init},
+          [&](OpBuilder &b, Location loc, Value row, ValueRange args) {
+            SmallVector<Value> dataIndices{row};
+            llvm::append_range(dataIndices, sliceIvs);
+            Value value = memref::LoadOp::create(b, loc, data(), dataIndices);
+            scf::YieldOp::create(
+                b, loc,
+                cloneCombiner(b, loc, combiner, ValueRange{value, args[0]},
+                              /*vectorType=*/nullptr));
+          });
+      Value result = forOp.getResult(0);
+      if (getMean()) {
+        // Empty segments are divided by one, which keeps them unchanged.
+        Value count = arith::MaxUIOp::create(
+            b, loc, arith::SubIOp::create(b, loc, end, begin), one);
+        if (isa<FloatType>(elementType)) {
+          count = arith::UIToFPOp::create(
+              b, loc, elementType,
+              arith::IndexCastUIOp::create(b, loc, b.getI64Type(), count));
+          result = arith::DivFOp::create(b, loc, result, count);
+        } else {
+          count = arith::IndexCastUIOp::create(b, loc, elementType, count);
+          result = arith::DivSIOp::create(b, loc, result, count);
+        }
+      }
+      memref::StoreOp::create(b, loc, result, original(), outputIndices);
+    };
+    if (rank == 1) {
+      reduceElement(b, loc, ValueRange{});
+      return;
+    }
+    scf::ParallelOp::create(b, loc, SmallVector<Value>(rank - 1, zero),
+                            ArrayRef<Value>(ubs).drop_front(),
+                            ArrayRef<Value>(steps).drop_front(),
+                            reduceElement);
+  };
+
+  scf::ParallelOp::create(b, loc, ValueRange{zero}, ValueRange{ubs.front()},
+                          ValueRange{one}, reduceSegment);
   return success();
 }
 
@@ -899,93 +1943,195 @@ SmallVector<utils::IteratorType> SortOp::getLoopIteratorTypes() {
 }
 
 SmallVector<Range> SortOp::getIterationDomain(OpBuilder &builder) {
-  int64_t operandRank = getOperandRank();
-  SmallVector<Range> loopBounds(operandRank);
-  Location loc = getLoc();
-  Value zero = arith::ConstantIndexOp::create(builder, loc, 0);
-  Value one = arith::ConstantIndexOp::create(builder, loc, 1);
-  Value source = operand(0);
-  for (auto dim : llvm::seq<int64_t>(0, operandRank)) {
-    loopBounds[dim].offset = zero;
-    loopBounds[dim].size = getDimValue(builder, loc, source, dim);
-    loopBounds[dim].stride = one;
-  }
-  return loopBounds;
+  // The whole sort, including the loops over the non-sorted dims, is emitted
+  // by generateScalarImplementation.
+  return {};
 }
 
+// Sorts each row along the sort dimension with a bottom-up merge sort. Rows
+// are copied into a pair of scratch buffers per operand, merged back and
+// forth in runs of doubling width, and copied back, for O(n log n)
+// comparisons per row. The merge is stable: an element of the right run is
+// only taken first if the comparator orders it before the left one. Rows are
+// independent, so the non-sorted dims form an `scf.parallel`.
 LogicalResult SortOp::generateScalarImplementation(OpBuilder &b, Location loc,
                                                    ValueRange ivs) {
-  auto sortDim = getDimension();
-  SmallVector<Value> indices, sortBlkArgs;
-  indices.append(ivs.begin(), ivs.end());
-  // Bubble sort innermost loop.
+  int64_t sortDim = getDimension();
+  int64_t rank = getOperandRank();
+  int64_t numOperands = getNumOutputs();
+  Block &srcBlock = getRegion().front();
+
   Value zero = arith::ConstantIndexOp::create(b, loc, 0);
   Value one = arith::ConstantIndexOp::create(b, loc, 1);
-  Value ub;
-  if (getOperandType(0).isDynamicDim(sortDim)) {
-    ub = memref::DimOp::create(b, loc, operand(0), sortDim);
-  } else {
-    ub = arith::ConstantIndexOp::create(b, loc,
-                                        getOperandType(0).getDimSize(sortDim));
-  }
-  ub = arith::SubIOp::create(b, loc, ub, one);
-  auto scfFor = scf::ForOp::create(
-      b, loc, zero, ub, one, ValueRange{},
-      [&](OpBuilder &b, Location loc, Value iv, ValueRange iters) {
-        SmallVector<Value> indices(ivs);
-        Value ivPlusOne = arith::AddIOp::create(b, loc, iv, one);
-        for (auto output : getOutputOperands()) {
-          indices[sortDim] = iv;
-          sortBlkArgs.push_back(
-              memref::LoadOp::create(b, loc, output->get(), indices));
-          indices[sortDim] = ivPlusOne;
-          sortBlkArgs.push_back(
-              memref::LoadOp::create(b, loc, output->get(), indices));
-        }
-      });
-
-  auto &srcBlock = getRegion().front();
-  Region &region = scfFor.getRegion();
-  IRMapping bvm;
-  {
-    OpBuilder::InsertionGuard guard(b);
-    auto &block = region.front();
-    b.setInsertionPointToEnd(&block);
-    for (auto it : llvm::zip(srcBlock.getArguments(), sortBlkArgs)) {
-      bvm.map(std::get<0>(it), std::get<1>(it));
+  Value two = arith::ConstantIndexOp::create(b, loc, 2);
+  Value trueValue = arith::ConstantOp::create(b, loc, b.getBoolAttr(true));
+  Value falseValue = arith::ConstantOp::create(b, loc, b.getBoolAttr(false));
+  Value sizeValue = getDimValue(b, loc, operand(0), sortDim);
+
+  // Returns whether the comparator orders the elements `lhs` before `rhs`,
+  // given one value per operand for each.
+  auto compare = [&](OpBuilder &b, ValueRange lhs, ValueRange rhs) {
+    IRMapping bvm;
+    for (int64_t i = 0; i < numOperands; ++i) {
+      bvm.map(srcBlock.getArgument(2 * i), lhs[i]);
+      bvm.map(srcBlock.getArgument(2 * i + 1), rhs[i]);
     }
-    for (auto &blockOp : srcBlock.without_terminator()) {
+    for (auto &blockOp : srcBlock.without_terminator())
       b.clone(blockOp, bvm);
+    return bvm.lookupOrDefault(srcBlock.getTerminator()->getOperand(0));
+  };
+
+  auto forEach = [&](OpBuilder &b, Location loc, Value lb, Value ub,
+                     function_ref<void(OpBuilder &, Location, Value)> body) {
+    scf::ForOp::create(b, loc, lb, ub, one, ValueRange{},
+                       [&](OpBuilder &b, Location loc, Value iv, ValueRange) {
+                         body(b, loc, iv);
+                         scf::YieldOp::create(b, loc);
+                       });
+  };
+
+  auto sortRow = [&](OpBuilder &b, Location loc, ValueRange outerIVs) {
+    auto rowIndices = [&](Value k) {
+      SmallVector<Value> indices(outerIVs.begin(), outerIVs.end());
+      indices.insert(indices.begin() + sortDim, k);
+      return indices;
+    };
+
+    SmallVector<Value> bufferA, bufferB;
+    for (int64_t i = 0; i < numOperands; ++i) {
+      auto type = MemRefType::get({ShapedType::kDynamic},
+                                  getOperandType(i).getElementType());
+      bufferA.push_back(memref::AllocOp::create(b, loc, type, sizeValue));
+      bufferB.push_back(memref::AllocOp::create(b, loc, type, sizeValue));
+    }
+    forEach(b, loc, zero, sizeValue, [&](OpBuilder &b, Location loc, Value k) {
+      for (int64_t i = 0; i < numOperands; ++i) {
+        Value x = memref::LoadOp::create(b, loc, getOutputOperand(i)->get(),
+                                         rowIndices(k));
+        memref::StoreOp::create(b, loc, x, bufferA[i], k);
+      }
+    });
+
+    // The runs are in bufferA while `inB` is false, and in bufferB otherwise.
+    auto selectBuffers = [&](OpBuilder &b, Location loc, Value inB,
+                             bool source) {
+      SmallVector<Value> buffers;
+      for (int64_t i = 0; i < numOperands; ++i) {
+        Value a = bufferA[i];
+        Value c = bufferB[i];
+        buffers.push_back(source ? arith::SelectOp::create(b, loc, inB, c, a)
+                                 : arith::SelectOp::create(b, loc, inB, a, c));
+      }
+      return buffers;
+    };
+
+    auto whileOp = scf::WhileOp::create(
+        b, loc, TypeRange{b.getIndexType(), b.getI1Type()},
+        ValueRange{one, falseValue},
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value cond = arith::CmpIOp::create(b, loc, arith::CmpIPredicate::ult,
+                                             args[0], sizeValue);
+          scf::ConditionOp::create(b, loc, cond, args);
+        },
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value width = args[0];
+          Value inB = args[1];
+          SmallVector<Value> src = selectBuffers(b, loc, inB, true);
+          SmallVector<Value> dst = selectBuffers(b, loc, inB, false);
+          Value step = arith::MulIOp::create(b, loc, width, two);
+
+          // Merge src[lo, mid) and src[mid, hi) into dst[lo, hi).
+          scf::ForOp::create(
+              b, loc, zero, sizeValue, step, ValueRange{},
+              [&](OpBuilder &b, Location loc, Value lo, ValueRange) {
+                Value mid = arith::MinUIOp::create(
+                    b, loc, arith::AddIOp::create(b, loc, lo, width),
+                    sizeValue);
+                Value hi = arith::MinUIOp::create(
+                    b, loc, arith::AddIOp::create(b, loc, lo, step),
+                    sizeValue);
+                // Loads are clamped to the runs; out of range positions are
+                // never taken.
+                Value lastLeft = arith::SubIOp::create(b, loc, mid, one);
+                Value lastRight = arith::SubIOp::create(b, loc, hi, one);
+                scf::ForOp::create(
+                    b, loc, lo, hi, one, ValueRange{lo, mid},
+                    [&](OpBuilder &b, Location loc, Value k,
+                        ValueRange cursors) {
+                      Value i = cursors[0];
+                      Value j = cursors[1];
+                      Value loadI =
+                          arith::MinUIOp::create(b, loc, i, lastLeft);
+                      Value loadJ =
+                          arith::MinUIOp::create(b, loc, j, lastRight);
+                      SmallVector<Value> left, right;
+                      for (int64_t n = 0; n < numOperands; ++n) {
+                        left.push_back(
+                            memref::LoadOp::create(b, loc, src[n], loadI));
+                        right.push_back(
+                            memref::LoadOp::create(b, loc, src[n], loadJ));
+                      }
+                      Value rightFirst = compare(b, right, left);
+                      Value leftValid = arith::CmpIOp::create(
+                          b, loc, arith::CmpIPredicate::ult, i, mid);
+                      Value rightDone = arith::CmpIOp::create(
+                          b, loc, arith::CmpIPredicate::uge, j, hi);
+                      Value notRightFirst =
+                          arith::XOrIOp::create(b, loc, rightFirst, trueValue);
+                      Value takeLeft = arith::AndIOp::create(
+                          b, loc, leftValid,
+                          arith::OrIOp::create(b, loc, rightDone,
+                                               notRightFirst));
+                      for (int64_t n = 0; n < numOperands; ++n) {
+                        Value x = arith::SelectOp::create(b, loc, takeLeft,
+                                                          left[n], right[n]);
+                        memref::StoreOp::create(b, loc, x, dst[n], k);
+                      }
+                      Value nextI = arith::SelectOp::create(
+                          b, loc, takeLeft,
+                          arith::AddIOp::create(b, loc, i, one), i);
+                      Value nextJ = arith::SelectOp::create(
+                          b, loc, takeLeft, j,
+                          arith::AddIOp::create(b, loc, j, one));
+                      scf::YieldOp::create(b, loc, ValueRange{nextI, nextJ});
+                    });
+                scf::YieldOp::create(b, loc);
+              });
+
+          Value notInB = arith::XOrIOp::create(b, loc, inB, trueValue);
+          scf::YieldOp::create(b, loc, ValueRange{step, notInB});
+        });
+
+    SmallVector<Value> sorted =
+        selectBuffers(b, loc, whileOp.getResult(1), /*source=*/true);
+    forEach(b, loc, zero, sizeValue, [&](OpBuilder &b, Location loc, Value k) {
+      for (int64_t i = 0; i < numOperands; ++i) {
+        Value x = memref::LoadOp::create(b, loc, sorted[i], k);
+        memref::StoreOp::create(b, loc, x, getOutputOperand(i)->get(),
+                                rowIndices(k));
+      }
+    });
+    for (int64_t i = 0; i < numOperands; ++i) {
+      memref::DeallocOp::create(b, loc, bufferA[i]);
+      memref::DeallocOp::create(b, loc, bufferB[i]);
     }
+  };
+
+  if (rank == 1) {
+    sortRow(b, loc, ValueRange{});
+    return success();
   }
-  Value cond = bvm.lookupOrDefault(srcBlock.getTerminator()->getOperand(0));
 
-  OpBuilder::InsertionGuard g(b);
-  b.setInsertionPointToEnd(&region.front());
-  scf::IfOp::create(
-      b, loc, cond,
-      [&](OpBuilder &b, Location loc) {
-        // Do not swap the pairs if true.
-        scf::YieldOp::create(b, loc);
-      },
-      [&](OpBuilder &b, Location loc) {
-        // Swap the pairs if false.
-        SmallVector<Value> indices(ivs.begin(), ivs.end());
-        Value ivPlusOne =
-            arith::AddIOp::create(b, loc, scfFor.getInductionVar(), one);
-        for (int i = 0, e = getNumOutputs(); i < e; ++i) {
-          Value v1 = sortBlkArgs[i * 2];
-          Value v2 = sortBlkArgs[i * 2 + 1];
-          indices[sortDim] = scfFor.getInductionVar();
-          memref::StoreOp::create(b, loc, v2, getOutputOperand(i)->get(),
-                                  indices);
-          indices[sortDim] = ivPlusOne;
-          memref::StoreOp::create(b, loc, v1, getOutputOperand(i)->get(),
-                                  indices);
-        }
-        scf::YieldOp::create(b, loc);
-      });
-  scf::YieldOp::create(b, loc);
+  SmallVector<Value> outerUpperBounds;
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    if (dim != sortDim)
+      outerUpperBounds.push_back(getDimValue(b, loc, operand(0), dim));
+  }
+  scf::ParallelOp::create(b, loc, SmallVector<Value>(rank - 1, zero),
+                          outerUpperBounds, SmallVector<Value>(rank - 1, one),
+                          [&](OpBuilder &b, Location loc, ValueRange outerIVs) {
+                            sortRow(b, loc, outerIVs);
+                          });
   return success();
 }
 
@@ -1086,115 +2232,308 @@ SmallVector<utils::IteratorType> TopkOp::getLoopIteratorTypes() {
 }
 
 SmallVector<Range> TopkOp::getIterationDomain(OpBuilder &builder) {
-  int64_t operandRank = getInputRank();
-  SmallVector<Range> loopBounds(operandRank);
-  Location loc = getLoc();
-  Value zero = arith::ConstantIndexOp::create(builder, loc, 0);
-  Value one = arith::ConstantIndexOp::create(builder, loc, 1);
-  Value source = values();
-  for (auto dim : llvm::enumerate(getInputType().getShape())) {
-    loopBounds[dim.index()].offset = zero;
-    loopBounds[dim.index()].size =
-        getDimValue(builder, loc, source, dim.index());
-    loopBounds[dim.index()].stride = one;
+  // The selection, including the loops over the non-reduced dims, is emitted
+  // by generateScalarImplementation.
+  return {};
+}
+
+/// Number of input elements along the reduced dimension that one chunk of
+/// the parallel split-merge selection of tm_tensor.topk handles.
+static constexpr int64_t kTopkChunkSize = 4096;
+
+namespace {
+/// A binary heap of (value, index) pairs kept in place in a pair of memrefs,
+/// with the element that ranks last at the root. Heap position `pos` lives at
+/// `prefix` with `pos` inserted at dimension `posDim`.
+struct TopkHeap {
+  Value values;
+  Value indices;
+  SmallVector<Value> prefix;
+  int64_t posDim;
+
+  SmallVector<Value> at(Value pos) const {
+    SmallVector<Value> ivs(prefix);
+    ivs.insert(ivs.begin() + posDim, pos);
+    return ivs;
+  }
+  std::pair<Value, Value> load(OpBuilder &b, Location loc, Value pos) const {
+    return {memref::LoadOp::create(b, loc, values, at(pos)),
+            memref::LoadOp::create(b, loc, indices, at(pos))};
+  }
+  void store(OpBuilder &b, Location loc, Value pos, Value value,
+             Value index) const {
+    memref::StoreOp::create(b, loc, value, values, at(pos));
+    memref::StoreOp::create(b, loc, index, indices, at(pos));
   }
-  return loopBounds;
+};
+} // namespace
+
+/// Returns whether (`lhsValue`, `lhsIndex`) ranks before (`rhsValue`,
+/// `rhsIndex`): the comparator in `cmpBlock` orders it first, or the two
+/// compare equal and it occurs first in the input.
+static Value rankTopkBefore(OpBuilder &b, Location loc, Block &cmpBlock,
+                            Value lhsValue, Value lhsIndex, Value rhsValue,
+                            Value rhsIndex) {
+  auto compare = [&](Value x, Value y) {
+    IRMapping bvm;
+    bvm.map(cmpBlock.getArgument(0), x);
+    bvm.map(cmpBlock.getArgument(1), y);
+    for (auto &blockOp : cmpBlock.without_terminator())
+      b.clone(blockOp, bvm);
+    return bvm.lookupOrDefault(cmpBlock.getTerminator()->getOperand(0));
+  };
+  Value forwardCmpRes = compare(lhsValue, rhsValue);
+  Value reverseCmpRes = compare(rhsValue, lhsValue);
+  Value cmpValuesEqual = arith::CmpIOp::create(
+      b, loc, arith::CmpIPredicate::eq, forwardCmpRes, reverseCmpRes);
+  Value cmpFirstIndex = arith::CmpIOp::create(
+      b, loc, arith::CmpIPredicate::slt, lhsIndex, rhsIndex);
+  return arith::OrIOp::create(
+      b, loc, forwardCmpRes,
+      arith::AndIOp::create(b, loc, cmpValuesEqual, cmpFirstIndex));
+}
+
+/// Moves (`value`, `index`) down from heap position `pos` of the first `size`
+/// elements of `heap` until both children rank before it.
+static void siftTopkHeapDown(OpBuilder &b, Location loc, Block &cmpBlock,
+                             const TopkHeap &heap, Value pos, Value size,
+                             Value value, Value index) {
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  Value two = arith::ConstantIndexOp::create(b, loc, 2);
+  Value last = arith::SubIOp::create(b, loc, size, one);
+  auto whileOp = scf::WhileOp::create(
+      b, loc,
+      TypeRange{b.getIndexType(), b.getIndexType(), value.getType(),
+                index.getType()},
+      ValueRange{pos},
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        Value cur = args[0];
+        Value left = arith::AddIOp::create(
+            b, loc, arith::MulIOp::create(b, loc, cur, two), one);
+        Value right = arith::AddIOp::create(b, loc, left, one);
+        // Loads are clamped to the heap; missing children are never taken.
+        auto [leftValue, leftIndex] =
+            heap.load(b, loc, arith::MinUIOp::create(b, loc, left, last));
+        auto [rightValue, rightIndex] =
+            heap.load(b, loc, arith::MinUIOp::create(b, loc, right, last));
+        Value hasLeft = arith::CmpIOp::create(
+            b, loc, arith::CmpIPredicate::ult, left, size);
+        Value hasRight = arith::CmpIOp::create(
+            b, loc, arith::CmpIPredicate::ult, right, size);
+        // Continue with the child that ranks last.
+        Value takeRight = arith::AndIOp::create(
+            b, loc, hasRight,
+            rankTopkBefore(b, loc, cmpBlock, leftValue, leftIndex, rightValue,
+                           rightIndex));
+        Value child = arith::SelectOp::create(b, loc, takeRight, right, left);
+        Value childValue =
+            arith::SelectOp::create(b, loc, takeRight, rightValue, leftValue);
+        Value childIndex =
+            arith::SelectOp::create(b, loc, takeRight, rightIndex, leftIndex);
+        Value cond = arith::AndIOp::create(
+            b, loc, hasLeft,
+            rankTopkBefore(b, loc, cmpBlock, value, index, childValue,
+                           childIndex));
+        scf::ConditionOp::create(
+            b, loc, cond, ValueRange{cur, child, childValue, childIndex});
+      },
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        heap.store(b, loc, args[0], args[2], args[3]);
+        scf::YieldOp::create(b, loc, args[1]);
+      });
+  heap.store(b, loc, whileOp.getResult(0), value, index);
+}
+
+/// Reorders the first `size` elements of `heap` into a heap.
+static void heapifyTopkHeap(OpBuilder &b, Location loc, Block &cmpBlock,
+                            const TopkHeap &heap, Value size) {
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  Value two = arith::ConstantIndexOp::create(b, loc, 2);
+  Value half = arith::DivUIOp::create(b, loc, size, two);
+  scf::ForOp::create(
+      b, loc, zero, half, one, ValueRange{},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange) {
+        Value pos = arith::SubIOp::create(
+            b, loc, arith::SubIOp::create(b, loc, half, one), iv);
+        auto [value, index] = heap.load(b, loc, pos);
+        siftTopkHeapDown(b, loc, cmpBlock, heap, pos, size, value, index);
+        scf::YieldOp::create(b, loc);
+      });
+}
+
+/// Offers the elements [`lb`, `ub`) produced by `loadElement` to the heap of
+/// the first `size` elements of `heap`. An element replaces the root only if
+/// it ranks before it, so most elements of a large input cost one compare.
+static void
+offerToTopkHeap(OpBuilder &b, Location loc, Block &cmpBlock,
+                const TopkHeap &heap, Value size, Value lb, Value ub,
+                function_ref<std::pair<Value, Value>(OpBuilder &, Location,
+                                                     Value)>
+                    loadElement) {
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  scf::ForOp::create(
+      b, loc, lb, ub, one, ValueRange{},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange) {
+        Value value, index;
+        std::tie(value, index) = loadElement(b, loc, iv);
+        auto [rootValue, rootIndex] = heap.load(b, loc, zero);
+        Value replace = rankTopkBefore(b, loc, cmpBlock, value, index,
+                                       rootValue, rootIndex);
+        scf::IfOp::create(b, loc, replace, [&](OpBuilder &b, Location loc) {
+          siftTopkHeapDown(b, loc, cmpBlock, heap, zero, size, value, index);
+          scf::YieldOp::create(b, loc);
+        });
+        scf::YieldOp::create(b, loc);
+      });
 }
 
+// Selects the top K of each row with a heap of the K best elements seen so
+// far, kept in place in the outputs with the worst element at the root, for
+// O(n log k) compares per row and typically close to O(n). The outputs hold
+// the initial candidates, as with the previous insertion-based lowering, and
+// are sorted best first by a final heap sort. Rows longer than
+// kTopkChunkSize are split into chunks whose top K are selected in parallel
+// into scratch heaps and then merged into the outputs. Rows are independent,
+// so the non-reduced dims form an `scf.parallel`.
 LogicalResult TopkOp::generateScalarImplementation(OpBuilder &b, Location loc,
                                                    ValueRange ivs) {
   uint64_t kDim = getDimension();
+  int64_t rank = getInputRank();
+  Block &cmpBlock = getRegion().front();
   Value zero = arith::ConstantIndexOp::create(b, loc, 0);
   Value one = arith::ConstantIndexOp::create(b, loc, 1);
-  Value initialValue = memref::LoadOp::create(b, loc, values(), ivs);
+  Value chunkSize = arith::ConstantIndexOp::create(b, loc, kTopkChunkSize);
+  Value k = getDimValue(b, loc, outputValues(), kDim);
+  Value n = getDimValue(b, loc, values(), kDim);
+
+  auto selectRow = [&](OpBuilder &b, Location loc, ValueRange outerIVs) {
+    // Loads input element `pos` of the row. If the indices tensor is not
+    // provided, the index is the position along the reduced dim.
+    auto loadInput = [&](OpBuilder &b, Location loc,
+                         Value pos) -> std::pair<Value, Value> {
+      SmallVector<Value> inputIVs(outerIVs.begin(), outerIVs.end());
+      inputIVs.insert(inputIVs.begin() + kDim, pos);
+      Value value = memref::LoadOp::create(b, loc, values(), inputIVs);
+      if (indices())
+        return {value, memref::LoadOp::create(b, loc, *indices(), inputIVs)};
+      return {value,
+              arith::IndexCastOp::create(b, loc, b.getI32Type(), pos)};
+    };
+
+    TopkHeap outputHeap{outputValues(), outputIndices(),
+                        SmallVector<Value>(outerIVs.begin(), outerIVs.end()),
+                        static_cast<int64_t>(kDim)};
+    heapifyTopkHeap(b, loc, cmpBlock, outputHeap, k);
+
+    Value numChunks = arith::CeilDivUIOp::create(b, loc, n, chunkSize);
+    Value isChunked = arith::CmpIOp::create(b, loc, arith::CmpIPredicate::ugt,
+                                            numChunks, one);
+    scf::IfOp::create(
+        b, loc, isChunked,
+        [&](OpBuilder &b, Location loc) {
+          auto scratchType = [&](Type elementType) {
+            return MemRefType::get({ShapedType::kDynamic, ShapedType::kDynamic},
+                                   elementType);
+          };
+          Value scratchValues = memref::AllocOp::create(
+              b, loc, scratchType(getInputType().getElementType()),
+              ValueRange{numChunks, k});
+          Value scratchIndices = memref::AllocOp::create(
+              b, loc, scratchType(b.getI32Type()), ValueRange{numChunks, k});
+          // The scratch heap of a chunk holds its min(k, length) best
+          // elements, seeded with its leading elements.
+          auto chunkBounds = [&](OpBuilder &b, Location loc, Value chunk) {
+            Value lb = arith::MulIOp::create(b, loc, chunk, chunkSize);
+            Value ub = arith::MinUIOp::create(
+                b, loc, arith::AddIOp::create(b, loc, lb, chunkSize), n);
+            Value size = arith::MinUIOp::create(
+                b, loc, k, arith::SubIOp::create(b, loc, ub, lb));
+            return std::make_tuple(lb, ub, size);
+          };
+          scf::ParallelOp::create(
+              b, loc, ValueRange{zero}, ValueRange{numChunks}, ValueRange{one},
+              [&](OpBuilder &b, Location loc, ValueRange chunkIVs) {
+                Value chunk = chunkIVs[0];
+                Value lb, ub, size;
+                std::tie(lb, ub, size) = chunkBounds(b, loc, chunk);
+                TopkHeap chunkHeap{scratchValues, scratchIndices, {chunk}, 1};
+                scf::ForOp::create(
+                    b, loc, zero, size, one, ValueRange{},
+                    [&](OpBuilder &b, Location loc, Value pos, ValueRange) {
+                      auto [value, index] = loadInput(
+                          b, loc, arith::AddIOp::create(b, loc, lb, pos));
+                      chunkHeap.store(b, loc, pos, value, index);
+                      scf::YieldOp::create(b, loc);
+                    });
+                heapifyTopkHeap(b, loc, cmpBlock, chunkHeap, size);
+                offerToTopkHeap(b, loc, cmpBlock, chunkHeap, size,
+                                arith::AddIOp::create(b, loc, lb, size), ub,
+                                loadInput);
+              });
+          scf::ForOp::create(
+              b, loc, zero, numChunks, one, ValueRange{},
+              [&](OpBuilder &b, Location loc, Value chunk, ValueRange) {
+                Value size = std::get<2>(chunkBounds(b, loc, chunk));
+                TopkHeap chunkHeap{scratchValues, scratchIndices, {chunk}, 1};
+                offerToTopkHeap(b, loc, cmpBlock, outputHeap, k, zero, size,
+                                [&](OpBuilder &b, Location loc, Value pos) {
+                                  return chunkHeap.load(b, loc, pos);
+                                });
+                scf::YieldOp::create(b, loc);
+              });
+          memref::DeallocOp::create(b, loc, scratchValues);
+          memref::DeallocOp::create(b, loc, scratchIndices);
+          scf::YieldOp::create(b, loc);
+        },
+        [&](OpBuilder &b, Location loc) {
+          offerToTopkHeap(b, loc, cmpBlock, outputHeap, k, zero, n, loadInput);
+          scf::YieldOp::create(b, loc);
+        });
 
-  // If the indices tensor is not provided, the value index is derived from the
-  // loop induction variables.
-  Value initialIndex;
-  if (indices()) {
-    initialIndex = memref::LoadOp::create(b, loc, *indices(), ivs);
-  } else {
-    Value rawInitialIndex = ivs[kDim];
-    initialIndex =
-        arith::IndexCastOp::create(b, loc, b.getI32Type(), rawInitialIndex);
-  }
-
-  // Compute K (ub) from the selected dim of the output
-  Value ub = memref::DimOp::create(b, loc, outputValues(), getDimension());
-
-  // Inner K loop functions:
-  //   Load current K value and index
-  //   Compare N/K using inserted block compare
-  //   Check if N == K using strict weak ordering, select which index came first
-  //   Select new K value from N/K comparison
-  //   Select new K index from N/K comparison or which index came first
-  //   Store new k value and index
-  //   Yield loop carry values after K selection
-  Value kValue, kIndex;
-  auto scfFor = scf::ForOp::create(
-      b, loc, zero, ub, one, ValueRange{initialValue, initialIndex},
-      [&](OpBuilder &b, Location loc, Value iv, ValueRange loopCarryValues) {
-        SmallVector<Value> indices(ivs);
-        indices[kDim] = iv;
-        kValue = memref::LoadOp::create(b, loc, outputValues(), indices);
-        kIndex = memref::LoadOp::create(b, loc, outputIndices(), indices);
-      });
+    // Heap sort: repeatedly move the worst remaining element to the end.
+    Value kMinusOne = arith::SubIOp::create(b, loc, k, one);
+    scf::ForOp::create(
+        b, loc, zero, kMinusOne, one, ValueRange{},
+        [&](OpBuilder &b, Location loc, Value iv, ValueRange) {
+          Value end = arith::SubIOp::create(b, loc, kMinusOne, iv);
+          auto [value, index] = outputHeap.load(b, loc, end);
+          auto [rootValue, rootIndex] = outputHeap.load(b, loc, zero);
+          outputHeap.store(b, loc, end, rootValue, rootIndex);
+          siftTopkHeapDown(b, loc, cmpBlock, outputHeap, zero, end, value,
+                           index);
+          scf::YieldOp::create(b, loc);
+        });
+  };
 
-  SmallVector<Value> indices(ivs);
-  indices[kDim] = scfFor.getInductionVar();
-  auto loopCarryValues = scfFor.getRegionIterArgs();
-
-  // Retrieve region as black box comparision function f(x,y). Plug into op.
-  auto &srcBlock = getRegion().front();
-  IRMapping bvmF; // f(x,y)
-  IRMapping bvmR; // f(y,x)
-  {
-    // Save previous insertion point. Continue within loop body.
-    OpBuilder::InsertionGuard guard(b);
-    b.setInsertionPointToEnd(&scfFor.getRegion().front());
-    SmallVector<Value> forwardValues{loopCarryValues[0], kValue};
-    SmallVector<Value> reverseValues{kValue, loopCarryValues[0]};
-    for (auto it : llvm::zip(srcBlock.getArguments(), forwardValues)) {
-      bvmF.map(std::get<0>(it), std::get<1>(it));
-    }
-    for (auto it : llvm::zip(srcBlock.getArguments(), reverseValues)) {
-      bvmR.map(std::get<0>(it), std::get<1>(it));
+  auto selectRows = [&](OpBuilder &b, Location loc) {
+    if (rank == 1) {
+      selectRow(b, loc, ValueRange{});
+      return;
     }
-    for (auto &blockOp : srcBlock.without_terminator()) {
-      b.clone(blockOp, bvmF);
-      b.clone(blockOp, bvmR);
+    SmallVector<Value> outerUpperBounds;
+    for (int64_t dim = 0; dim < rank; ++dim) {
+      if (dim != static_cast<int64_t>(kDim))
+        outerUpperBounds.push_back(getDimValue(b, loc, values(), dim));
     }
-    Value forwardCmpRes = bvmF.lookup(srcBlock.getTerminator()->getOperand(0));
-    Value reverseCmpRes = bvmR.lookup(srcBlock.getTerminator()->getOperand(0));
-
-    // Check value equality using strictly weak ordering from the region:
-    //   f(x,y) --> forwardCmpRes
-    //   f(y,x) --> reverseCmpRes
-    //   if forwardCmpRes == reverseCmpRes then select which came first
-    Value cmpValuesEqual = arith::CmpIOp::create(
-        b, loc, arith::CmpIPredicate::eq, forwardCmpRes, reverseCmpRes);
-    Value cmpFirstIndex = arith::CmpIOp::create(
-        b, loc, arith::CmpIPredicate::slt, loopCarryValues[1], kIndex);
-    Value combinedCmpEqRes =
-        arith::AndIOp::create(b, loc, cmpValuesEqual, cmpFirstIndex);
-    // True if N > K or N came before K
-    Value indexCmpRes =
-        arith::OrIOp::create(b, loc, forwardCmpRes, combinedCmpEqRes);
-    // Select results for K based on comparisons
-    Value resultKValue = arith::SelectOp::create(b, loc, forwardCmpRes,
-                                                 loopCarryValues[0], kValue);
-    Value resultKIndex = arith::SelectOp::create(b, loc, indexCmpRes,
-                                                 loopCarryValues[1], kIndex);
-    memref::StoreOp::create(b, loc, resultKValue, outputValues(), indices);
-    memref::StoreOp::create(b, loc, resultKIndex, outputIndices(), indices);
-    // Select loop carry, opposite of K results
-    Value resultCarryValue = arith::SelectOp::create(
-        b, loc, forwardCmpRes, kValue, loopCarryValues[0]);
-    Value resultCarryIndex = arith::SelectOp::create(
-        b, loc, indexCmpRes, kIndex, loopCarryValues[1]);
-    scf::YieldOp::create(b, loc,
-                         ValueRange{resultCarryValue, resultCarryIndex});
+    scf::ParallelOp::create(b, loc, SmallVector<Value>(rank - 1, zero),
+                            outerUpperBounds,
+                            SmallVector<Value>(rank - 1, one), selectRow);
+  };
+  // An empty top K has nothing to select, and the heap needs a root.
+  ShapedType outputType = cast<ShapedType>(outputValues().getType());
+  if (!outputType.isDynamicDim(kDim)) {
+    if (outputType.getDimSize(kDim) > 0)
+      selectRows(b, loc);
+    return success();
   }
+  Value nonEmpty =
+      arith::CmpIOp::create(b, loc, arith::CmpIPredicate::ugt, k, zero);
+  scf::IfOp::create(b, loc, nonEmpty, [&](OpBuilder &b, Location loc) {
+    selectRows(b, loc);
+    scf::YieldOp::create(b, loc);
+  });
   return success();
 }
 
@@ -1203,6 +2542,160 @@ bool TopkOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// UniqueOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult UniqueOp::verify() {
+  Operation *op = getOperation();
+  if (getInputs().size() != 1) {
+    return op->emitOpError("expected one input operand");
+  }
+  if (getOutputs().size() != 3) {
+    return op->emitOpError("expected three output operands");
+  }
+  auto inputType = getInputType();
+  if (inputType.getRank() != 1) {
+    return op->emitOpError("expected input to be of rank 1");
+  }
+  for (Value output : getOutputs()) {
+    auto outputType = cast<ShapedType>(output.getType());
+    if (outputType.getRank() != 1) {
+      return op->emitOpError("expected outputs to be of rank 1");
+    }
+    if (!inputType.isDynamicDim(0) && !outputType.isDynamicDim(0) &&
+        inputType.getDimSize(0) != outputType.getDimSize(0)) {
+      return op->emitOpError("mismatch in shape of input and outputs");
+    }
+  }
+  Type elementType = inputType.getElementType();
+  if (!elementType.isIntOrIndexOrFloat()) {
+    return op->emitOpError(
+        "expected input to be of integer, index or float element type");
+  }
+  if (getElementTypeOrSelf(outputValues()) != elementType) {
+    return op->emitOpError("mismatch in element type of input ")
+           << elementType << " and values "
+           << getElementTypeOrSelf(outputValues());
+  }
+  if (!isa<IntegerType>(getElementTypeOrSelf(outputInverse())) ||
+      !isa<IntegerType>(getElementTypeOrSelf(outputCounts()))) {
+    return op->emitOpError(
+        "expected inverse and counts to be of integer element type");
+  }
+  return success();
+}
+
+SmallVector<utils::IteratorType> UniqueOp::getLoopIteratorTypes() {
+  return {utils::IteratorType::reduction};
+}
+
+SmallVector<Range> UniqueOp::getIterationDomain(OpBuilder &builder) {
+  // The loops over the input are emitted by generateScalarImplementation.
+  return {};
+}
+
+bool UniqueOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
+  // Only the first values and counts are written.
+  return opOperand->get() != outputInverse();
+}
+
+// The group of every element is numbered by a sequential scan of one compare
+// per element. The values and counts of the groups are then written by two
+// parallel loops, where only the first, and then only the last, element of
+// each group writes: the first records the position of the group, from which
+// the last computes its count.
+LogicalResult UniqueOp::generateScalarImplementation(OpBuilder &b,
+                                                     Location loc,
+                                                     ValueRange ivs) {
+  Value zero = arith::ConstantIndexOp::create(b, loc, 0);
+  Value one = arith::ConstantIndexOp::create(b, loc, 1);
+  Value size = getDimValue(b, loc, input(), 0);
+  Value last = arith::SubIOp::create(b, loc, size, one);
+  auto inverseType = cast<IntegerType>(getElementTypeOrSelf(outputInverse()));
+  auto countType = cast<IntegerType>(getElementTypeOrSelf(outputCounts()));
+
+  auto isDifferent = [&](OpBuilder &b, Location loc, Value lhs, Value rhs) {
+    if (isa<FloatType>(lhs.getType()))
+      return arith::CmpFOp::create(b, loc, arith::CmpFPredicate::UNE, lhs, rhs)
+          .getResult();
+    return arith::CmpIOp::create(b, loc, arith::CmpIPredicate::ne, lhs, rhs)
+        .getResult();
+  };
+
+  // Loads are clamped to the input; the first element always starts a group.
+  Value firstGroup = arith::ConstantOp::create(
+      b, loc, inverseType, b.getIntegerAttr(inverseType, -1));
+  scf::ForOp::create(
+      b, loc, zero, size, one, ValueRange{firstGroup},
+      [&](OpBuilder &b, Location loc, Value i, ValueRange args) {
+        Value prev = arith::SubIOp::create(
+            b, loc, arith::MaxUIOp::create(b, loc, i, one), one);
+        Value value = memref::LoadOp::create(b, loc, input(), i);
+        Value prevValue = memref::LoadOp::create(b, loc, input(), prev);
+        Value isStart = arith::OrIOp::create(
+            b, loc, isDifferent(b, loc, value, prevValue),
+            arith::CmpIOp::create(b, loc, arith::CmpIPredicate::eq, i, zero));
+        Value group = arith::AddIOp::create(
+            b, loc, args[0],
+            arith::ExtUIOp::create(b, loc, inverseType, isStart));
+        memref::StoreOp::create(b, loc, group, outputInverse(), i);
+        scf::YieldOp::create(b, loc, group);
+      });
+
+  auto loadGroup = [&](OpBuilder &b, Location loc, Value i) -> Value {
+    return arith::IndexCastOp::create(
+        b, loc, b.getIndexType(),
+        memref::LoadOp::create(b, loc, outputInverse(), i));
+  };
+  auto toCount = [&](OpBuilder &b, Location loc, Value i) -> Value {
+    return arith::IndexCastOp::create(b, loc, countType, i);
+  };
+  scf::ParallelOp::create(
+      b, loc, ValueRange{zero}, ValueRange{size}, ValueRange{one},
+      [&](OpBuilder &b, Location loc, ValueRange parallelIvs) {
+        Value i = parallelIvs.front();
+        Value group = loadGroup(b, loc, i);
+        Value prev = arith::SubIOp::create(
+            b, loc, arith::MaxUIOp::create(b, loc, i, one), one);
+        Value isStart = arith::OrIOp::create(
+            b, loc,
+            arith::CmpIOp::create(b, loc, arith::CmpIPredicate::ne, group,
+                                  loadGroup(b, loc, prev)),
+            arith::CmpIOp::create(b, loc, arith::CmpIPredicate::eq, i, zero));
+        scf::IfOp::create(b, loc, isStart, [&](OpBuilder &b, Location loc) {
+          memref::StoreOp::create(
+              b, loc, memref::LoadOp::create(b, loc, input(), i),
+              outputValues(), group);
+          memref::StoreOp::create(b, loc, toCount(b, loc, i), outputCounts(),
+                                  group);
+          scf::YieldOp::create(b, loc);
+        });
+      });
+  scf::ParallelOp::create(
+      b, loc, ValueRange{zero}, ValueRange{size}, ValueRange{one},
+      [&](OpBuilder &b, Location loc, ValueRange parallelIvs) {
+        Value i = parallelIvs.front();
+        Value group = loadGroup(b, loc, i);
+        Value next = arith::MinUIOp::create(
+            b, loc, arith::AddIOp::create(b, loc, i, one), last);
+        Value isEnd = arith::OrIOp::create(
+            b, loc,
+            arith::CmpIOp::create(b, loc, arith::CmpIPredicate::ne, group,
+                                  loadGroup(b, loc, next)),
+            arith::CmpIOp::create(b, loc, arith::CmpIPredicate::eq, i, last));
+        scf::IfOp::create(b, loc, isEnd, [&](OpBuilder &b, Location loc) {
+          Value start = memref::LoadOp::create(b, loc, outputCounts(), group);
+          Value end = toCount(b, loc, arith::AddIOp::create(b, loc, i, one));
+          memref::StoreOp::create(b, loc,
+                                  arith::SubIOp::create(b, loc, end, start),
+                                  outputCounts(), group);
+          scf::YieldOp::create(b, loc);
+        });
+      });
+  return success();
+}
+
 #define DEFINE_OP_GET_EFFECTS(OP_NAME)                                         \
   void OP_NAME::getEffects(                                                    \
       SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>      \
@@ -1214,10 +2707,14 @@ bool TopkOp::payloadUsesValueFromOperand(OpOperand *opOperand) {
   }
 
 DEFINE_OP_GET_EFFECTS(AttentionOp)
+DEFINE_OP_GET_EFFECTS(GatherOp)
+DEFINE_OP_GET_EFFECTS(PagedAttentionOp)
 DEFINE_OP_GET_EFFECTS(ScanOp)
 DEFINE_OP_GET_EFFECTS(ScatterOp)
+DEFINE_OP_GET_EFFECTS(SegmentReduceOp)
 DEFINE_OP_GET_EFFECTS(SortOp)
 DEFINE_OP_GET_EFFECTS(TopkOp)
+DEFINE_OP_GET_EFFECTS(UniqueOp)
 
 namespace {
 /// This is derived from mlir/lib/Dialect/Linalg/IR/LinalgOps.cpp without any
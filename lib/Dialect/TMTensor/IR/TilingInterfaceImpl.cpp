@@ -0,0 +1,756 @@
+//===------------------------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// The TMTensor ops emit their own loops through ScalarLoopOpInterface, so
+// the iteration domain they expose there is only what ConvertToLoops has to
+// wrap around them. The upstream TilingInterface needs the full domain
+// instead, and is therefore attached as external models rather than as op
+// methods.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TilingInterfaceImpl.h"
+
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/Dialect/Utils/StructuredOpsUtils.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/Interfaces/TilingInterface.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorDialect.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorOps.h"
+#include "llvm/ADT/TypeSwitch.h"
+
+using namespace mlir;
+using namespace mlir::torch::TMTensor;
+
+/// Returns the unit-stride slice of `v` at `offsets` with `sizes`.
+static Operation *getSlice(OpBuilder &b, Location loc, Value v,
+                           ArrayRef<OpFoldResult> offsets,
+                           ArrayRef<OpFoldResult> sizes) {
+  SmallVector<OpFoldResult> strides(offsets.size(), b.getIndexAttr(1));
+  return TypeSwitch<Type, Operation *>(v.getType())
+      .Case<RankedTensorType>([&](RankedTensorType) -> Operation * {
+        return tensor::ExtractSliceOp::create(b, loc, v, offsets, sizes,
+                                              strides);
+      })
+      .Case<MemRefType>([&](MemRefType) -> Operation * {
+        return memref::SubViewOp::create(b, loc, v, offsets, sizes, strides);
+      })
+      .Default([](Type) -> Operation * { return nullptr; });
+}
+
+/// Returns the iteration domain spanning all dims of `v`.
+static SmallVector<Range> getFullDomain(OpBuilder &b, Location loc, Value v) {
+  SmallVector<Range> domain;
+  for (int64_t dim = 0, e = cast<ShapedType>(v.getType()).getRank(); dim < e;
+       ++dim)
+    domain.push_back(Range{b.getIndexAttr(0), getDim(b, loc, v, dim),
+                           b.getIndexAttr(1)});
+  return domain;
+}
+
+/// Appends to `tileOffsets` and `tileSizes` the given tile of the leading
+/// dims of `v`, followed by the full extent of its remaining dims.
+static void appendLeadingTile(OpBuilder &b, Location loc, Value v,
+                              ArrayRef<OpFoldResult> offsets,
+                              ArrayRef<OpFoldResult> sizes,
+                              SmallVectorImpl<OpFoldResult> &tileOffsets,
+                              SmallVectorImpl<OpFoldResult> &tileSizes) {
+  llvm::append_range(tileOffsets, offsets);
+  llvm::append_range(tileSizes, sizes);
+  for (int64_t dim = offsets.size(),
+               e = cast<ShapedType>(v.getType()).getRank();
+       dim < e; ++dim) {
+    tileOffsets.push_back(b.getIndexAttr(0));
+    tileSizes.push_back(getDim(b, loc, v, dim));
+  }
+}
+
+/// Returns whether the tile at `offset` with `size` covers all of dim `dim`
+/// of `v`. Ops whose loops along `dim` carry a dependence can only be tiled
+/// this way along it.
+static bool isFullTile(Value v, int64_t dim, OpFoldResult offset,
+                       OpFoldResult size) {
+  if (!isConstantIntValue(offset, 0))
+    return false;
+  auto type = cast<ShapedType>(v.getType());
+  if (!type.isDynamicDim(dim))
+    return isConstantIntValue(size, type.getDimSize(dim));
+  auto sizeValue = dyn_cast<Value>(size);
+  if (!sizeValue)
+    return false;
+  if (auto dimOp = sizeValue.getDefiningOp<tensor::DimOp>()) {
+    return dimOp.getSource() == v &&
+           getConstantIntValue(dimOp.getIndex()) == dim;
+  }
+  if (auto dimOp = sizeValue.getDefiningOp<memref::DimOp>()) {
+    return dimOp.getSource() == v &&
+           getConstantIntValue(dimOp.getIndex()) == dim;
+  }
+  return false;
+}
+
+/// Clones `op` on its tiled operands `slices`, one per operand in order. On
+/// tensors the results take the types of the tiled outputs.
+static TilingResult cloneOnSlices(OpBuilder &b, TMTensorOp op,
+                                  ArrayRef<Operation *> slices) {
+  SmallVector<Value> tiledOperands;
+  for (Operation *slice : slices)
+    tiledOperands.push_back(slice->getResult(0));
+  SmallVector<Type> resultTypes;
+  if (op->getNumResults()) {
+    for (Value v : llvm::drop_begin(tiledOperands, op.getNumInputs()))
+      resultTypes.push_back(v.getType());
+  }
+  Operation *tiledOp =
+      clone(b, op.getOperation(), resultTypes, tiledOperands);
+  return TilingResult{{tiledOp},
+                      SmallVector<Value>(tiledOp->getResults()),
+                      SmallVector<Operation *>(slices)};
+}
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// AttentionOp
+//===----------------------------------------------------------------------===//
+
+/// The domain is the batch dims and the query sequence dim, which are all
+/// parallel; every other dim is taken in full.
+struct AttentionOpTiling
+    : public TilingInterface::ExternalModel<AttentionOpTiling, AttentionOp> {
+  SmallVector<utils::IteratorType> getLoopIteratorTypes(Operation *op) const {
+    auto attentionOp = cast<AttentionOp>(op);
+    return SmallVector<utils::IteratorType>(attentionOp.getQueryRank() - 1,
+                                            utils::IteratorType::parallel);
+  }
+
+  SmallVector<Range> getIterationDomain(Operation *op, OpBuilder &b) const {
+    auto attentionOp = cast<AttentionOp>(op);
+    SmallVector<Range> domain =
+        getFullDomain(b, op->getLoc(), attentionOp.getQuery());
+    domain.pop_back();
+    return domain;
+  }
+
+  FailureOr<TilingResult>
+  getTiledImplementation(Operation *op, OpBuilder &b,
+                         ArrayRef<OpFoldResult> offsets,
+                         ArrayRef<OpFoldResult> sizes) const {
+    auto attentionOp = cast<AttentionOp>(op);
+    Location loc = op->getLoc();
+    int64_t rank = attentionOp.getQueryRank();
+    if (attentionOp.getKeyRank() != rank ||
+        attentionOp.getValueRank() != rank ||
+        attentionOp.getOutputType().getRank() != rank ||
+        attentionOp.getAttnMaskRank().value_or(rank) != rank)
+      return failure();
+    // The regions take the indices of the whole problem, not of the tile.
+    if (!attentionOp.getScoreMod().empty() ||
+        !attentionOp.getMaskMod().empty())
+      return failure();
+    // So do the causal and window bounds, unless all queries are in the tile.
+    if ((attentionOp.getCausal() || attentionOp.getWindowSize()) &&
+        !isFullTile(attentionOp.getQuery(), rank - 2, offsets.back(),
+                    sizes.back()))
+      return failure();
+    ArrayRef<OpFoldResult> batchOffsets = offsets.drop_back();
+    ArrayRef<OpFoldResult> batchSizes = sizes.drop_back();
+
+    SmallVector<Operation *> slices;
+    auto addSlice = [&](Value v, ArrayRef<OpFoldResult> leadingOffsets,
+                        ArrayRef<OpFoldResult> leadingSizes) {
+      SmallVector<OpFoldResult> tileOffsets, tileSizes;
+      appendLeadingTile(b, loc, v, leadingOffsets, leadingSizes, tileOffsets,
+                        tileSizes);
+      slices.push_back(getSlice(b, loc, v, tileOffsets, tileSizes));
+    };
+    // Query, mask and output rows follow the query sequence tile; keys and
+    // values are shared by all of them.
+    addSlice(attentionOp.getQuery(), offsets, sizes);
+    addSlice(attentionOp.getKey(), batchOffsets, batchSizes);
+    addSlice(attentionOp.getValue(), batchOffsets, batchSizes);
+    if (std::optional<Value> mask = attentionOp.getAttnMask())
+      addSlice(*mask, offsets, sizes);
+    addSlice(attentionOp.getOutput(), offsets, sizes);
+    return cloneOnSlices(b, attentionOp, slices);
+  }
+
+  LogicalResult
+  getResultTilePosition(Operation *op, OpBuilder &b, unsigned resultNumber,
+                        ArrayRef<OpFoldResult> offsets,
+                        ArrayRef<OpFoldResult> sizes,
+                        SmallVector<OpFoldResult> &resultOffsets,
+                        SmallVector<OpFoldResult> &resultSizes) const {
+    auto attentionOp = cast<AttentionOp>(op);
+    appendLeadingTile(b, op->getLoc(), attentionOp.getOutput(), offsets,
+                      sizes, resultOffsets, resultSizes);
+    return success();
+  }
+
+  LogicalResult getIterationDomainTileFromResultTile(
+      Operation *op, OpBuilder &b, unsigned resultNumber,
+      ArrayRef<OpFoldResult> resultOffsets, ArrayRef<OpFoldResult> resultSizes,
+      SmallVectorImpl<OpFoldResult> &iterDomainOffsets,
+      SmallVectorImpl<OpFoldResult> &iterDomainSizes) const {
+    auto attentionOp = cast<AttentionOp>(op);
+    if (!isFullTile(attentionOp.getOutput(), resultOffsets.size() - 1,
+                    resultOffsets.back(), resultSizes.back()))
+      return failure();
+    llvm::append_range(iterDomainOffsets, resultOffsets.drop_back());
+    llvm::append_range(iterDomainSizes, resultSizes.drop_back());
+    return success();
+  }
+
+  FailureOr<TilingResult>
+  generateResultTileValue(Operation *op, OpBuilder &b, unsigned resultNumber,
+                          ArrayRef<OpFoldResult> offsets,
+                          ArrayRef<OpFoldResult> sizes) const {
+    SmallVector<OpFoldResult> domainOffsets, domainSizes;
+    if (failed(getIterationDomainTileFromResultTile(
+            op, b, resultNumber, offsets, sizes, domainOffsets, domainSizes)))
+      return failure();
+    return getTiledImplementation(op, b, domainOffsets, domainSizes);
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// GatherOp
+//===----------------------------------------------------------------------===//
+
+/// The domain is the result. A tile of the result reads the matching tile of
+/// the slice dims of the source, and may read anywhere in its indexed dims.
+/// If a slice dim is indexed as well, the source is taken in full.
+struct GatherOpTiling
+    : public TilingInterface::ExternalModel<GatherOpTiling, GatherOp> {
+  SmallVector<utils::IteratorType> getLoopIteratorTypes(Operation *op) const {
+    return cast<GatherOp>(op).getLoopIteratorTypes();
+  }
+
+  SmallVector<Range> getIterationDomain(Operation *op, OpBuilder &b) const {
+    return getFullDomain(b, op->getLoc(), cast<GatherOp>(op).output());
+  }
+
+  FailureOr<TilingResult>
+  getTiledImplementation(Operation *op, OpBuilder &b,
+                         ArrayRef<OpFoldResult> offsets,
+                         ArrayRef<OpFoldResult> sizes) const {
+    auto gatherOp = cast<GatherOp>(op);
+    Location loc = op->getLoc();
+    int64_t sourceRank = gatherOp.getSourceType().getRank();
+    int64_t sliceStart = sourceRank - gatherOp.getSliceRank();
+    SmallVector<OpFoldResult> sourceOffsets, sourceSizes;
+    for (int64_t dim = 0; dim < sourceRank; ++dim) {
+      sourceOffsets.push_back(b.getIndexAttr(0));
+      sourceSizes.push_back(getDim(b, loc, gatherOp.source(), dim));
+    }
+    if (llvm::none_of(gatherOp.getDimensionMap(),
+                      [&](int64_t dim) { return dim >= sliceStart; })) {
+      for (int64_t dim = sliceStart; dim < sourceRank; ++dim) {
+        sourceOffsets[dim] = offsets[dim - sliceStart + 1];
+        sourceSizes[dim] = sizes[dim - sliceStart + 1];
+      }
+    }
+    SmallVector<OpFoldResult> indicesOffsets{offsets[0], b.getIndexAttr(0)};
+    SmallVector<OpFoldResult> indicesSizes{
+        sizes[0], b.getIndexAttr(gatherOp.getIndexDepth())};
+    Operation *slices[] = {
+        getSlice(b, loc, gatherOp.source(), sourceOffsets, sourceSizes),
+        getSlice(b, loc, gatherOp.indices(), indicesOffsets, indicesSizes),
+        getSlice(b, loc, gatherOp.output(), offsets, sizes)};
+    return cloneOnSlices(b, gatherOp, slices);
+  }
+
+  LogicalResult
+  getResultTilePosition(Operation *op, OpBuilder &b, unsigned resultNumber,
+                        ArrayRef<OpFoldResult> offsets,
+                        ArrayRef<OpFoldResult> sizes,
+                        SmallVector<OpFoldResult> &resultOffsets,
+                        SmallVector<OpFoldResult> &resultSizes) const {
+    resultOffsets.assign(offsets.begin(), offsets.end());
+    resultSizes.assign(sizes.begin(), sizes.end());
+    return success();
+  }
+
+  LogicalResult getIterationDomainTileFromResultTile(
+      Operation *op, OpBuilder &b, unsigned resultNumber,
+      ArrayRef<OpFoldResult> resultOffsets, ArrayRef<OpFoldResult> resultSizes,
+      SmallVectorImpl<OpFoldResult> &iterDomainOffsets,
+      SmallVectorImpl<OpFoldResult> &iterDomainSizes) const {
+    iterDomainOffsets.assign(resultOffsets.begin(), resultOffsets.end());
+    iterDomainSizes.assign(resultSizes.begin(), resultSizes.end());
+    return success();
+  }
+
+  FailureOr<TilingResult>
+  generateResultTileValue(Operation *op, OpBuilder &b, unsigned resultNumber,
+                          ArrayRef<OpFoldResult> offsets,
+                          ArrayRef<OpFoldResult> sizes) const {
+    return getTiledImplementation(op, b, offsets, sizes);
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// PagedAttentionOp
+//===----------------------------------------------------------------------===//
+
+/// The domain is the sequences and the query heads. The heads map to the
+/// key/value heads by their count, so they can only be tiled in full; the
+/// block pools are shared by all sequences.
+struct PagedAttentionOpTiling
+    : public TilingInterface::ExternalModel<PagedAttentionOpTiling,
+                                            PagedAttentionOp> {
+  SmallVector<utils::IteratorType> getLoopIteratorTypes(Operation *op) const {
+    return SmallVector<utils::IteratorType>(2, utils::IteratorType::parallel);
+  }
+
+  SmallVector<Range> getIterationDomain(Operation *op, OpBuilder &b) const {
+    auto pagedOp = cast<PagedAttentionOp>(op);
+    SmallVector<Range> domain =
+        getFullDomain(b, op->getLoc(), pagedOp.getQuery());
+    domain.pop_back();
+    return domain;
+  }
+
+  FailureOr<TilingResult>
+  getTiledImplementation(Operation *op, OpBuilder &b,
+                         ArrayRef<OpFoldResult> offsets,
+                         ArrayRef<OpFoldResult> sizes) const {
+    auto pagedOp = cast<PagedAttentionOp>(op);
+    Location loc = op->getLoc();
+    if (!isFullTile(pagedOp.getQuery(), 1, offsets[1], sizes[1]))
+      return failure();
+    SmallVector<Operation *> slices;
+    auto addSlice = [&](Value v, ArrayRef<OpFoldResult> leadingOffsets,
+                        ArrayRef<OpFoldResult> leadingSizes) {
+      SmallVector<OpFoldResult> tileOffsets, tileSizes;
+      appendLeadingTile(b, loc, v, leadingOffsets, leadingSizes, tileOffsets,
+                        tileSizes);
+      slices.push_back(getSlice(b, loc, v, tileOffsets, tileSizes));
+    };
+    addSlice(pagedOp.getQuery(), offsets, sizes);
+    addSlice(pagedOp.getKeyCache(), {}, {});
+    addSlice(pagedOp.getValueCache(), {}, {});
+    addSlice(pagedOp.getBlockTables(), offsets.take_front(),
+             sizes.take_front());
+    addSlice(pagedOp.getContextLens(), offsets.take_front(),
+             sizes.take_front());
+    addSlice(pagedOp.getOutput(), offsets, sizes);
+    return cloneOnSlices(b, pagedOp, slices);
+  }
+
+  LogicalResult
+  getResultTilePosition(Operation *op, OpBuilder &b, unsigned resultNumber,
+                        ArrayRef<OpFoldResult> offsets,
+                        ArrayRef<OpFoldResult> sizes,
+                        SmallVector<OpFoldResult> &resultOffsets,
+                        SmallVector<OpFoldResult> &resultSizes) const {
+    auto pagedOp = cast<PagedAttentionOp>(op);
+    appendLeadingTile(b, op->getLoc(), pagedOp.getOutput(), offsets, sizes,
+                      resultOffsets, resultSizes);
+    return success();
+  }
+
+  LogicalResult getIterationDomainTileFromResultTile(
+      Operation *op, OpBuilder &b, unsigned resultNumber,
+      ArrayRef<OpFoldResult> resultOffsets, ArrayRef<OpFoldResult> resultSizes,
+      SmallVectorImpl<OpFoldResult> &iterDomainOffsets,
+      SmallVectorImpl<OpFoldResult> &iterDomainSizes) const {
+    auto pagedOp = cast<PagedAttentionOp>(op);
+    if (!isFullTile(pagedOp.getOutput(), 2, resultOffsets[2], resultSizes[2]))
+      return failure();
+    llvm::append_range(iterDomainOffsets, resultOffsets.drop_back());
+    llvm::append_range(iterDomainSizes, resultSizes.drop_back());
+    return success();
+  }
+
+  FailureOr<TilingResult>
+  generateResultTileValue(Operation *op, OpBuilder &b, unsigned resultNumber,
+                          ArrayRef<OpFoldResult> offsets,
+                          ArrayRef<OpFoldResult> sizes) const {
+    SmallVector<OpFoldResult> domainOffsets, domainSizes;
+    if (failed(getIterationDomainTileFromResultTile(
+            op, b, resultNumber, offsets, sizes, domainOffsets, domainSizes)))
+      return failure();
+    return getTiledImplementation(op, b, domainOffsets, domainSizes);
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// ScanOp
+//===----------------------------------------------------------------------===//
+
+/// The domain is the input; the scanned dim can only be tiled in full.
+struct ScanOpTiling
+    : public TilingInterface::ExternalModel<ScanOpTiling, ScanOp> {
+  SmallVector<utils::IteratorType> getLoopIteratorTypes(Operation *op) const {
+    return cast<ScanOp>(op).getLoopIteratorTypes();
+  }
+
+  SmallVector<Range> getIterationDomain(Operation *op, OpBuilder &b) const {
+    return getFullDomain(b, op->getLoc(), cast<ScanOp>(op).input());
+  }
+
+  FailureOr<TilingResult>
+  getTiledImplementation(Operation *op, OpBuilder &b,
+                         ArrayRef<OpFoldResult> offsets,
+                         ArrayRef<OpFoldResult> sizes) const {
+    auto scanOp = cast<ScanOp>(op);
+    Location loc = op->getLoc();
+    int64_t scanDim = scanOp.getDimension();
+    if (!isFullTile(scanOp.input(), scanDim, offsets[scanDim], sizes[scanDim]))
+      return failure();
+    SmallVector<OpFoldResult> accOffsets(offsets), accSizes(sizes);
+    accOffsets.erase(accOffsets.begin() + scanDim);
+    accSizes.erase(accSizes.begin() + scanDim);
+    Operation *slices[] = {
+        getSlice(b, loc, scanOp.input(), offsets, sizes),
+        getSlice(b, loc, scanOp.output(), offsets, sizes),
+        getSlice(b, loc, scanOp.accumulator(), accOffsets, accSizes)};
+    return cloneOnSlices(b, scanOp, slices);
+  }
+
+  LogicalResult
+  getResultTilePosition(Operation *op, OpBuilder &b, unsigned resultNumber,
+                        ArrayRef<OpFoldResult> offsets,
+                        ArrayRef<OpFoldResult> sizes,
+                        SmallVector<OpFoldResult> &resultOffsets,
+                        SmallVector<OpFoldResult> &resultSizes) const {
+    resultOffsets.assign(offsets.begin(), offsets.end());
+    resultSizes.assign(sizes.begin(), sizes.end());
+    if (resultNumber == 1) {
+      int64_t scanDim = cast<ScanOp>(op).getDimension();
+      resultOffsets.erase(resultOffsets.begin() + scanDim);
+      resultSizes.erase(resultSizes.begin() + scanDim);
+    }
+    return success();
+  }
+
+  LogicalResult getIterationDomainTileFromResultTile(
+      Operation *op, OpBuilder &b, unsigned resultNumber,
+      ArrayRef<OpFoldResult> resultOffsets, ArrayRef<OpFoldResult> resultSizes,
+      SmallVectorImpl<OpFoldResult> &iterDomainOffsets,
+      SmallVectorImpl<OpFoldResult> &iterDomainSizes) const {
+    // A tile of the accumulator does not say which part of the scanned dim
+    // produced it, but it always needs all of it.
+    if (resultNumber == 1) {
+      auto scanOp = cast<ScanOp>(op);
+      int64_t scanDim = scanOp.getDimension();
+      iterDomainOffsets.assign(resultOffsets.begin(), resultOffsets.end());
+      iterDomainSizes.assign(resultSizes.begin(), resultSizes.end());
+      iterDomainOffsets.insert(iterDomainOffsets.begin() + scanDim,
+                               b.getIndexAttr(0));
+      iterDomainSizes.insert(iterDomainSizes.begin() + scanDim,
+                             getDim(b, op->getLoc(), scanOp.input(), scanDim));
+      return success();
+    }
+    iterDomainOffsets.assign(resultOffsets.begin(), resultOffsets.end());
+    iterDomainSizes.assign(resultSizes.begin(), resultSizes.end());
+    return success();
+  }
+
+  FailureOr<TilingResult>
+  generateResultTileValue(Operation *op, OpBuilder &b, unsigned resultNumber,
+                          ArrayRef<OpFoldResult> offsets,
+                          ArrayRef<OpFoldResult> sizes) const {
+    SmallVector<OpFoldResult> domainOffsets, domainSizes;
+    if (failed(getIterationDomainTileFromResultTile(
+            op, b, resultNumber, offsets, sizes, domainOffsets, domainSizes)))
+      return failure();
+    return getTiledImplementation(op, b, domainOffsets, domainSizes);
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// ScatterOp
+//===----------------------------------------------------------------------===//
+
+/// The domain is the updates. A tile of updates writes the matching tile of
+/// the slice dims of the original and may write anywhere in its indexed
+/// dims, so the indexed dims must not be slice dims as well. All updates land
+/// in the same result tile, and the op is not destination-passing, so a tile
+/// would not see the updates of the tiles before it: the batch dim can only
+/// be tiled in full.
+struct ScatterOpTiling
+    : public TilingInterface::ExternalModel<ScatterOpTiling, ScatterOp> {
+  SmallVector<utils::IteratorType> getLoopIteratorTypes(Operation *op) const {
+    auto scatterOp = cast<ScatterOp>(op);
+    SmallVector<utils::IteratorType> iteratorTypes(
+        scatterOp.getUpdateType().getRank(), utils::IteratorType::parallel);
+    if (!scatterOp.getUniqueIndices())
+      iteratorTypes[0] = utils::IteratorType::reduction;
+    return iteratorTypes;
+  }
+
+  SmallVector<Range> getIterationDomain(Operation *op, OpBuilder &b) const {
+    return getFullDomain(b, op->getLoc(), cast<ScatterOp>(op).updates());
+  }
+
+  FailureOr<TilingResult>
+  getTiledImplementation(Operation *op, OpBuilder &b,
+                         ArrayRef<OpFoldResult> offsets,
+                         ArrayRef<OpFoldResult> sizes) const {
+    auto scatterOp = cast<ScatterOp>(op);
+    Location loc = op->getLoc();
+    if (!isFullTile(scatterOp.updates(), 0, offsets[0], sizes[0]))
+      return failure();
+    SmallVector<OpFoldResult> originalOffsets, originalSizes;
+    if (failed(getResultTilePosition(op, b, 0, offsets, sizes,
+                                     originalOffsets, originalSizes)))
+      return failure();
+    SmallVector<OpFoldResult> indicesOffsets{offsets[0], b.getIndexAttr(0)};
+    SmallVector<OpFoldResult> indicesSizes{
+        sizes[0], b.getIndexAttr(scatterOp.getIndexDepth())};
+    Operation *slices[] = {
+        getSlice(b, loc, scatterOp.updates(), offsets, sizes),
+        getSlice(b, loc, scatterOp.indices(), indicesOffsets, indicesSizes),
+        getSlice(b, loc, scatterOp.original(), originalOffsets,
+                 originalSizes)};
+    return cloneOnSlices(b, scatterOp, slices);
+  }
+
+  LogicalResult
+  getResultTilePosition(Operation *op, OpBuilder &b, unsigned resultNumber,
+                        ArrayRef<OpFoldResult> offsets,
+                        ArrayRef<OpFoldResult> sizes,
+                        SmallVector<OpFoldResult> &resultOffsets,
+                        SmallVector<OpFoldResult> &resultSizes) const {
+    auto scatterOp = cast<ScatterOp>(op);
+    int64_t originalRank = scatterOp.getOriginalType().getRank();
+    int64_t sliceStart =
+        originalRank - (scatterOp.getUpdateType().getRank() - 1);
+    if (llvm::any_of(scatterOp.getDimensionMap(),
+                     [&](int64_t dim) { return dim >= sliceStart; }))
+      return failure();
+    resultOffsets.clear();
+    resultSizes.clear();
+    for (int64_t dim = 0; dim < sliceStart; ++dim) {
+      resultOffsets.push_back(b.getIndexAttr(0));
+      resultSizes.push_back(
+          getDim(b, op->getLoc(), scatterOp.original(), dim));
+    }
+    llvm::append_range(resultOffsets, offsets.drop_front());
+    llvm::append_range(resultSizes, sizes.drop_front());
+    return success();
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// SegmentReduceOp
+//===----------------------------------------------------------------------===//
+
+/// The domain is the original value. Its rows are numbered by the segment
+/// ids, so the segment dim can only be tiled in full; the other dims tile
+/// the data alike.
+struct SegmentReduceOpTiling
+    : public TilingInterface::ExternalModel<SegmentReduceOpTiling,
+                                            SegmentReduceOp> {
+  SmallVector<utils::IteratorType> getLoopIteratorTypes(Operation *op) const {
+    return cast<SegmentReduceOp>(op).getLoopIteratorTypes();
+  }
+
+  SmallVector<Range> getIterationDomain(Operation *op, OpBuilder &b) const {
+    return getFullDomain(b, op->getLoc(),
+                         cast<SegmentReduceOp>(op).original());
+  }
+
+  FailureOr<TilingResult>
+  getTiledImplementation(Operation *op, OpBuilder &b,
+                         ArrayRef<OpFoldResult> offsets,
+                         ArrayRef<OpFoldResult> sizes) const {
+    auto segmentOp = cast<SegmentReduceOp>(op);
+    Location loc = op->getLoc();
+    if (!isFullTile(segmentOp.original(), 0, offsets[0], sizes[0]))
+      return failure();
+    SmallVector<OpFoldResult> dataOffsets{b.getIndexAttr(0)};
+    SmallVector<OpFoldResult> dataSizes{getDim(b, loc, segmentOp.data(), 0)};
+    llvm::append_range(dataOffsets, offsets.drop_front());
+    llvm::append_range(dataSizes, sizes.drop_front());
+    Operation *slices[] = {
+        getSlice(b, loc, segmentOp.data(), dataOffsets, dataSizes),
+        getSlice(b, loc, segmentOp.segmentIds(), dataOffsets.front(),
+                 dataSizes.front()),
+        getSlice(b, loc, segmentOp.original(), offsets, sizes)};
+    return cloneOnSlices(b, segmentOp, slices);
+  }
+
+  LogicalResult
+  getResultTilePosition(Operation *op, OpBuilder &b, unsigned resultNumber,
+                        ArrayRef<OpFoldResult> offsets,
+                        ArrayRef<OpFoldResult> sizes,
+                        SmallVector<OpFoldResult> &resultOffsets,
+                        SmallVector<OpFoldResult> &resultSizes) const {
+    resultOffsets.assign(offsets.begin(), offsets.end());
+    resultSizes.assign(sizes.begin(), sizes.end());
+    return success();
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// SortOp
+//===----------------------------------------------------------------------===//
+
+/// The domain is the operands; the sorted dim can only be tiled in full.
+struct SortOpTiling
+    : public TilingInterface::ExternalModel<SortOpTiling, SortOp> {
+  SmallVector<utils::IteratorType> getLoopIteratorTypes(Operation *op) const {
+    return cast<SortOp>(op).getLoopIteratorTypes();
+  }
+
+  SmallVector<Range> getIterationDomain(Operation *op, OpBuilder &b) const {
+    return getFullDomain(b, op->getLoc(), cast<SortOp>(op).operand(0));
+  }
+
+  FailureOr<TilingResult>
+  getTiledImplementation(Operation *op, OpBuilder &b,
+                         ArrayRef<OpFoldResult> offsets,
+                         ArrayRef<OpFoldResult> sizes) const {
+    auto sortOp = cast<SortOp>(op);
+    int64_t sortDim = sortOp.getDimension();
+    if (!isFullTile(sortOp.operand(0), sortDim, offsets[sortDim],
+                    sizes[sortDim]))
+      return failure();
+    SmallVector<Operation *> slices;
+    for (Value output : sortOp.getOutputs())
+      slices.push_back(getSlice(b, op->getLoc(), output, offsets, sizes));
+    return cloneOnSlices(b, sortOp, slices);
+  }
+
+  LogicalResult
+  getResultTilePosition(Operation *op, OpBuilder &b, unsigned resultNumber,
+                        ArrayRef<OpFoldResult> offsets,
+                        ArrayRef<OpFoldResult> sizes,
+                        SmallVector<OpFoldResult> &resultOffsets,
+                        SmallVector<OpFoldResult> &resultSizes) const {
+    resultOffsets.assign(offsets.begin(), offsets.end());
+    resultSizes.assign(sizes.begin(), sizes.end());
+    return success();
+  }
+
+  LogicalResult getIterationDomainTileFromResultTile(
+      Operation *op, OpBuilder &b, unsigned resultNumber,
+      ArrayRef<OpFoldResult> resultOffsets, ArrayRef<OpFoldResult> resultSizes,
+      SmallVectorImpl<OpFoldResult> &iterDomainOffsets,
+      SmallVectorImpl<OpFoldResult> &iterDomainSizes) const {
+    iterDomainOffsets.assign(resultOffsets.begin(), resultOffsets.end());
+    iterDomainSizes.assign(resultSizes.begin(), resultSizes.end());
+    return success();
+  }
+
+  FailureOr<TilingResult>
+  generateResultTileValue(Operation *op, OpBuilder &b, unsigned resultNumber,
+                          ArrayRef<OpFoldResult> offsets,
+                          ArrayRef<OpFoldResult> sizes) const {
+    return getTiledImplementation(op, b, offsets, sizes);
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// TopkOp
+//===----------------------------------------------------------------------===//
+
+/// The domain is the input. Every tile writes all K outputs of its rows,
+/// which also hold the candidates so far, so tiles along the reduced dim
+/// merge correctly as long as the input indices are explicit.
+struct TopkOpTiling
+    : public TilingInterface::ExternalModel<TopkOpTiling, TopkOp> {
+  SmallVector<utils::IteratorType> getLoopIteratorTypes(Operation *op) const {
+    return cast<TopkOp>(op).getLoopIteratorTypes();
+  }
+
+  SmallVector<Range> getIterationDomain(Operation *op, OpBuilder &b) const {
+    return getFullDomain(b, op->getLoc(), cast<TopkOp>(op).values());
+  }
+
+  FailureOr<TilingResult>
+  getTiledImplementation(Operation *op, OpBuilder &b,
+                         ArrayRef<OpFoldResult> offsets,
+                         ArrayRef<OpFoldResult> sizes) const {
+    auto topkOp = cast<TopkOp>(op);
+    Location loc = op->getLoc();
+    int64_t kDim = topkOp.getDimension();
+    // Without input indices they are derived from the position in the tile.
+    if (!topkOp.indices() &&
+        !isFullTile(topkOp.values(), kDim, offsets[kDim], sizes[kDim]))
+      return failure();
+    SmallVector<OpFoldResult> outputOffsets, outputSizes;
+    if (failed(getResultTilePosition(op, b, 0, offsets, sizes, outputOffsets,
+                                     outputSizes)))
+      return failure();
+    SmallVector<Operation *> slices;
+    slices.push_back(getSlice(b, loc, topkOp.values(), offsets, sizes));
+    if (std::optional<Value> indices = topkOp.indices())
+      slices.push_back(getSlice(b, loc, *indices, offsets, sizes));
+    slices.push_back(
+        getSlice(b, loc, topkOp.outputValues(), outputOffsets, outputSizes));
+    slices.push_back(
+        getSlice(b, loc, topkOp.outputIndices(), outputOffsets, outputSizes));
+    return cloneOnSlices(b, topkOp, slices);
+  }
+
+  LogicalResult
+  getResultTilePosition(Operation *op, OpBuilder &b, unsigned resultNumber,
+                        ArrayRef<OpFoldResult> offsets,
+                        ArrayRef<OpFoldResult> sizes,
+                        SmallVector<OpFoldResult> &resultOffsets,
+                        SmallVector<OpFoldResult> &resultSizes) const {
+    auto topkOp = cast<TopkOp>(op);
+    int64_t kDim = topkOp.getDimension();
+    resultOffsets.assign(offsets.begin(), offsets.end());
+    resultSizes.assign(sizes.begin(), sizes.end());
+    resultOffsets[kDim] = b.getIndexAttr(0);
+    resultSizes[kDim] = getDim(b, op->getLoc(), topkOp.outputValues(), kDim);
+    return success();
+  }
+
+  LogicalResult getIterationDomainTileFromResultTile(
+      Operation *op, OpBuilder &b, unsigned resultNumber,
+      ArrayRef<OpFoldResult> resultOffsets, ArrayRef<OpFoldResult> resultSizes,
+      SmallVectorImpl<OpFoldResult> &iterDomainOffsets,
+      SmallVectorImpl<OpFoldResult> &iterDomainSizes) const {
+    auto topkOp = cast<TopkOp>(op);
+    int64_t kDim = topkOp.getDimension();
+    if (!isFullTile(topkOp.outputValues(), kDim, resultOffsets[kDim],
+                    resultSizes[kDim]))
+      return failure();
+    iterDomainOffsets.assign(resultOffsets.begin(), resultOffsets.end());
+    iterDomainSizes.assign(resultSizes.begin(), resultSizes.end());
+    iterDomainOffsets[kDim] = b.getIndexAttr(0);
+    iterDomainSizes[kDim] = getDim(b, op->getLoc(), topkOp.values(), kDim);
+    return success();
+  }
+
+  FailureOr<TilingResult>
+  generateResultTileValue(Operation *op, OpBuilder &b, unsigned resultNumber,
+                          ArrayRef<OpFoldResult> offsets,
+                          ArrayRef<OpFoldResult> sizes) const {
+    SmallVector<OpFoldResult> domainOffsets, domainSizes;
+    if (failed(getIterationDomainTileFromResultTile(
+            op, b, resultNumber, offsets, sizes, domainOffsets, domainSizes)))
+      return failure();
+    return getTiledImplementation(op, b, domainOffsets, domainSizes);
+  }
+};
+
+} // namespace
+
+void mlir::torch::TMTensor::registerTilingInterfaceExternalModels(
+    DialectRegistry &registry) {
+  registry.addExtension(+[](MLIRContext *ctx, TMTensorDialect *dialect) {
+    AttentionOp::attachInterface<AttentionOpTiling>(*ctx);
+    GatherOp::attachInterface<GatherOpTiling>(*ctx);
+    PagedAttentionOp::attachInterface<PagedAttentionOpTiling>(*ctx);
+    ScanOp::attachInterface<ScanOpTiling>(*ctx);
+    ScatterOp::attachInterface<ScatterOpTiling>(*ctx);
+    SegmentReduceOp::attachInterface<SegmentReduceOpTiling>(*ctx);
+    SortOp::attachInterface<SortOpTiling>(*ctx);
+    TopkOp::attachInterface<TopkOpTiling>(*ctx);
+  });
+}
@@ -14,6 +14,7 @@
 #include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/Pass.h"
@@ -33,14 +34,21 @@ namespace mlir::torch::TMTensor {
 #include "torch-mlir-dialects/Dialect/TMTensor/Transforms/Passes.h.inc"
 
 /// Recursive method that lowers one dimension of the `ScalarLoopOpInterface` to
-/// scalar loops at a time.
+/// scalar loops at a time. When `vectorWidth` is positive the body is first
+/// offered to the op's vectorized implementation.
 static LogicalResult lowerToLoopsImpl(OpBuilder &builder,
                                       ScalarLoopOpInterface scalarLoopOp,
                                       ArrayRef<Range> loopRanges,
                                       unsigned loopDepth,
-                                      SmallVectorImpl<Value> &ivs) {
+                                      SmallVectorImpl<Value> &ivs,
+                                      int64_t vectorWidth) {
   Location loc = scalarLoopOp.getLoc();
   if (loopDepth == loopRanges.size()) {
+    if (vectorWidth > 0 &&
+        succeeded(scalarLoopOp.generateVectorizedImplementation(
+            builder, loc, ivs, vectorWidth))) {
+      return success();
+    }
     return scalarLoopOp.generateScalarImplementation(builder, loc, ivs);
   }
   LogicalResult status = success();
@@ -54,8 +62,8 @@ static LogicalResult lowerToLoopsImpl(OpBuilder &builder,
       builder, loc, offset, size, stride, ValueRange{},
       [&](OpBuilder &b, Location loc, Value iv, ValueRange args) {
         ivs.push_back(iv);
-        status =
-            lowerToLoopsImpl(b, scalarLoopOp, loopRanges, loopDepth + 1, ivs);
+        status = lowerToLoopsImpl(b, scalarLoopOp, loopRanges, loopDepth + 1,
+                                  ivs, vectorWidth);
         scf::YieldOp::create(b, loc);
       });
   return status;
@@ -63,18 +71,22 @@ static LogicalResult lowerToLoopsImpl(OpBuilder &builder,
 
 /// Main entry point for lowering `ScalarLoopOpInterface` op to loops.
 static LogicalResult lowerToLoops(OpBuilder &builder,
-                                  ScalarLoopOpInterface scalarLoopOp) {
+                                  ScalarLoopOpInterface scalarLoopOp,
+                                  int64_t vectorWidth) {
   SmallVector<Range> loopBounds = scalarLoopOp.getIterationDomain(builder);
   SmallVector<Value> ivs;
-  return lowerToLoopsImpl(builder, scalarLoopOp, loopBounds, 0, ivs);
+  return lowerToLoopsImpl(builder, scalarLoopOp, loopBounds, 0, ivs,
+                          vectorWidth);
 }
 
 /// Pattern rewriter hook to lower a `ScalarLoopOpInterface` to loops.
 namespace {
 struct ScalarLoopOpInterfaceLowerToLoopsPattern : public RewritePattern {
   ScalarLoopOpInterfaceLowerToLoopsPattern(MLIRContext *context,
+                                           int64_t vectorWidth,
                                            PatternBenefit benefit = 1)
-      : RewritePattern(MatchAnyOpTypeTag(), benefit, context) {}
+      : RewritePattern(MatchAnyOpTypeTag(), benefit, context),
+        vectorWidth(vectorWidth) {}
 
   LogicalResult matchAndRewrite(Operation *op,
                                 PatternRewriter &rewriter) const override {
@@ -87,12 +99,15 @@ struct ScalarLoopOpInterfaceLowerToLoopsPattern : public RewritePattern {
       return rewriter.notifyMatchFailure(
           scalarLoopOp, "lower to loops needs to have tensor semantics");
     }
-    if (failed(lowerToLoops(rewriter, scalarLoopOp))) {
+    if (failed(lowerToLoops(rewriter, scalarLoopOp, vectorWidth))) {
       return failure();
     }
     rewriter.eraseOp(op);
     return success();
   }
+
+private:
+  int64_t vectorWidth;
 };
 } // namespace
 
@@ -106,14 +121,16 @@ struct TMTensorToLoopsPass
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<linalg::LinalgDialect, func::FuncDialect,
                     mlir::arith::ArithDialect, math::MathDialect,
-                    memref::MemRefDialect, scf::SCFDialect>();
+                    memref::MemRefDialect, scf::SCFDialect,
+                    vector::VectorDialect>();
   }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
 
     RewritePatternSet patterns(context);
-    patterns.insert<ScalarLoopOpInterfaceLowerToLoopsPattern>(context);
+    patterns.insert<ScalarLoopOpInterfaceLowerToLoopsPattern>(context,
+                                                              vectorWidth);
     if (failed(applyPatternsGreedily(getOperation(), std::move(patterns)))) {
       return signalPassFailure();
     }
@@ -110,6 +110,43 @@ void TorchDialect::initialize() {
   addInterfaces<TorchInlinerInterface>();
 }
 
+//===----------------------------------------------------------------------===//
+// Context-level cache.
+//===----------------------------------------------------------------------===//
+
+void *TorchDialect::getOrCreateCachedImpl(
+    TypeID typeID, StringRef key,
+    function_ref<std::shared_ptr<void>()> create) {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  llvm::StringMap<std::shared_ptr<void>> &entries = cache[typeID];
+  auto it = entries.find(key);
+  if (it != entries.end())
+    return it->second.get();
+  std::shared_ptr<void> entry = create();
+  if (!entry)
+    return nullptr;
+  return entries.try_emplace(key, std::move(entry)).first->second.get();
+}
+
+Type TorchDialect::getOrCreateDerivedType(unsigned kind, Type type, Type param,
+                                          function_ref<Type()> create) {
+  llvm::DenseMap<std::tuple<unsigned, Type, Type>, Type> &cache =
+      derivedTypes.get();
+  std::tuple<unsigned, Type, Type> key = {kind, type, param};
+  if (Type derived = cache.lookup(key))
+    return derived;
+  Type derived = create();
+  cache[key] = derived;
+  return derived;
+}
+
+IntegerAttr TorchDialect::getI64IntegerAttr(int64_t value) {
+  IntegerAttr &attr = i64IntegerAttrs.get()[value];
+  if (!attr)
+    attr = IntegerAttr::get(IntegerType::get(getContext(), 64), value);
+  return attr;
+}
+
 //===----------------------------------------------------------------------===//
 // Dialect-level verifiers.
 //===----------------------------------------------------------------------===//
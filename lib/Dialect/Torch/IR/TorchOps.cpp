@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 #include "llvm/ADT/SmallVector.h"
 #define DEBUG_TYPE "torch-mlir-torch-dialect"
+#include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
 #include "llvm/Support/Debug.h"
@@ -143,8 +144,10 @@ bool mlir::torch::Torch::potentiallyMutatesListOperands(Operation *op) {
   return true;
 }
 
+// The folders of int ops build many i64 attributes, which the dialect
+// memoizes per thread.
 static IntegerAttr getI64IntegerAttr(MLIRContext *context, int64_t value) {
-  return IntegerAttr::get(IntegerType::get(context, 64), value);
+  return context->getLoadedDialect<TorchDialect>()->getI64IntegerAttr(value);
 }
 
 static FloatAttr getF64FloatAttr(MLIRContext *context, double value) {
@@ -1288,8 +1291,7 @@ OpFoldResult PrimsViewOfOp::fold(FoldAdaptor adaptor) {
 OpFoldResult AtenDimOp::fold(FoldAdaptor adaptor) {
   if (auto tensorType = dyn_cast<BaseTensorType>(getOperand().getType())) {
     if (tensorType.hasSizes())
-      return IntegerAttr::get(IntegerType::get(getContext(), 64),
-                              tensorType.getSizes().size());
+      return getI64IntegerAttr(getContext(), tensorType.getSizes().size());
   }
   return nullptr;
 }
@@ -1319,8 +1321,7 @@ OpFoldResult AtenLenTOp::fold(FoldAdaptor adaptor) {
   if (auto listConstruct =
           getOperand().getDefiningOp<Torch::PrimListConstructOp>()) {
     if (!isListPotentiallyMutated(listConstruct)) {
-      return IntegerAttr::get(IntegerType::get(getContext(), 64),
-                              listConstruct.getNumOperands());
+      return getI64IntegerAttr(getContext(), listConstruct.getNumOperands());
     }
   }
   return nullptr;
@@ -2738,7 +2739,7 @@ OpFoldResult AtenSizeIntOp::fold(FoldAdaptor adaptor) {
   dim = toPositiveDim(dim, sizes.size());
   if (!isValidDim(dim, sizes.size()))
     return nullptr;
-  return IntegerAttr::get(IntegerType::get(getContext(), 64), sizes[dim]);
+  return getI64IntegerAttr(getContext(), sizes[dim]);
 }
 
 //===----------------------------------------------------------------------===//
@@ -3431,7 +3432,8 @@ ParseResult ConstantIntOp::parse(OpAsmParser &parser, OperationState &result) {
     return failure();
   if (parser.parseOptionalAttrDict(result.attributes))
     return failure();
-  result.addAttribute("value", builder.getI64IntegerAttr(value));
+  result.addAttribute("value",
+                      getI64IntegerAttr(result.getContext(), value));
   return success();
 }
 
@@ -114,6 +114,28 @@ bool Torch::isValidSubtype(Type subtype, Type type) {
   return false;
 }
 
+//===----------------------------------------------------------------------===//
+// Memoized types
+//===----------------------------------------------------------------------===//
+
+namespace {
+// The types that the dialect memoizes, by how they derive from another type.
+enum class DerivedTypeKind : unsigned {
+  Dtype,
+  UnknownSizes,
+  ValueSemantics,
+  NonValueSemantics,
+  List,
+};
+} // namespace
+
+static Type getOrCreateDerivedType(MLIRContext *context, DerivedTypeKind kind,
+                                   Type type, Type param,
+                                   function_ref<Type()> create) {
+  return context->getLoadedDialect<TorchDialect>()->getOrCreateDerivedType(
+      static_cast<unsigned>(kind), type, param, create);
+}
+
 //===----------------------------------------------------------------------===//
 // Helpers for TupleType and UnionType
 //===----------------------------------------------------------------------===//
@@ -175,6 +197,17 @@ void Torch::UnionType::print(AsmPrinter &printer) const {
   printMultipleContainedTypes(printer, getContainedTypes());
 }
 
+//===----------------------------------------------------------------------===//
+// ListType
+//===----------------------------------------------------------------------===//
+
+Torch::ListType Torch::ListType::getMemoized(Type containedType) {
+  MLIRContext *context = containedType.getContext();
+  return cast<ListType>(getOrCreateDerivedType(
+      context, DerivedTypeKind::List, containedType, Type(),
+      [&]() { return Base::get(context, containedType); }));
+}
+
 //===----------------------------------------------------------------------===//
 // BaseTensorType
 //===----------------------------------------------------------------------===//
@@ -249,6 +282,23 @@ Type BaseTensorType::getWithSizesAndDtypeAndSparsity(
   llvm_unreachable("not a BaseTensorType!");
 }
 
+Type BaseTensorType::getWithDtype(Type optionalDtype) const {
+  return getOrCreateDerivedType(
+      getContext(), DerivedTypeKind::Dtype, *this, optionalDtype, [&]() {
+        return getWithSizesAndDtype(getOptionalSizes(), optionalDtype);
+      });
+}
+
+Type BaseTensorType::getWithUnknownSizes() const {
+  if (!hasSizes())
+    return *this;
+  return getOrCreateDerivedType(
+      getContext(), DerivedTypeKind::UnknownSizes, *this, Type(), [&]() {
+        SmallVector<int64_t> sizes(getSizes().size(), kUnknownSize);
+        return getWithSizesAndDtype(ArrayRef(sizes), getOptionalDtype());
+      });
+}
+
 ValueTensorType BaseTensorType::getWithValueSemantics() const {
   if (auto tensor = mlir::dyn_cast<NonValueTensorType>(*this))
     return tensor.getWithValueSemantics();
@@ -403,8 +453,11 @@ static void printTensorType(AsmPrinter &printer,
 //===----------------------------------------------------------------------===//
 
 ValueTensorType NonValueTensorType::getWithValueSemantics() const {
-  return ValueTensorType::get(getContext(), getOptionalSizes(),
-                              getOptionalDtype());
+  return cast<ValueTensorType>(getOrCreateDerivedType(
+      getContext(), DerivedTypeKind::ValueSemantics, *this, Type(), [&]() {
+        return ValueTensorType::get(getContext(), getOptionalSizes(),
+                                    getOptionalDtype());
+      }));
 }
 
 NonValueTensorType
@@ -443,8 +496,11 @@ void NonValueTensorType::print(AsmPrinter &printer) const {
 //===----------------------------------------------------------------------===//
 
 NonValueTensorType ValueTensorType::getWithoutValueSemantics() const {
-  return NonValueTensorType::get(getContext(), getOptionalSizes(),
-                                 getOptionalDtype());
+  return cast<NonValueTensorType>(getOrCreateDerivedType(
+      getContext(), DerivedTypeKind::NonValueSemantics, *this, Type(), [&]() {
+        return NonValueTensorType::get(getContext(), getOptionalSizes(),
+                                       getOptionalDtype());
+      }));
 }
 
 ValueTensorType
@@ -0,0 +1,29 @@
+//===----------------------------------------------------------------------===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// Embeds the bytecode form of the abstract interpretation library, which is
+// produced at build time by `torch-mlir-abstract-interp-lib-gen` from
+// `AbstractInterpLibrary.cpp`.
+//
+//===----------------------------------------------------------------------===//
+
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+
+StringRef mlir::torch::Torch::getAbstractInterpLibraryBytecode() {
+#ifdef TORCH_MLIR_ENABLE_ABSTRACT_INTERP_LIB_BYTECODE
+  alignas(8) static const unsigned char bytecode[] = {
+#include "AbstractInterpLibrary.mlirbc.inc"
+  };
+  return StringRef(reinterpret_cast<const char *>(bytecode), sizeof(bytecode));
+#else
+  return StringRef();
+#endif
+}
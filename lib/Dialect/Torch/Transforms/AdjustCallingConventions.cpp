@@ -287,9 +287,40 @@ static LogicalResult adjustCallingConventions(func::FuncOp func,
   return success();
 }
 
+// Marks the donated arguments of the public functions writable, and their other
+// tensor arguments read-only, for One-Shot Bufferize to update the former in
+// place and to never write to the latter.
+static LogicalResult markDonatedArgs(func::FuncOp func,
+                                     ArrayRef<int64_t> donatedArgs) {
+  if (!func.isPublic())
+    return success();
+  MLIRContext *context = func.getContext();
+  auto writableIdent = StringAttr::get(context, "bufferization.writable");
+  int64_t numArgs = func.getNumArguments();
+  auto isTensorArg = [&](int64_t i) {
+    return i >= 0 && i < numArgs &&
+           isa<BaseTensorType>(func.getArgument(i).getType());
+  };
+  for (int64_t i : donatedArgs) {
+    if (!isTensorArg(i))
+      return func.emitError()
+             << "donated argument " << i << " is not a tensor argument";
+  }
+  for (int64_t i = 0; i < numArgs; ++i) {
+    if (!isTensorArg(i))
+      continue;
+    bool donated = llvm::is_contained(donatedArgs, i);
+    func.setArgAttr(i, writableIdent, BoolAttr::get(context, donated));
+  }
+  return success();
+}
+
 namespace {
 class AdjustCallingConventionsPass
     : public impl::AdjustCallingConventionsBase<AdjustCallingConventionsPass> {
+public:
+  using impl::AdjustCallingConventionsBase<
+      AdjustCallingConventionsPass>::AdjustCallingConventionsBase;
   void runOnOperation() override {
     auto module = getOperation();
     TypeBoundMap typeBoundMap;
@@ -306,6 +337,12 @@ class AdjustCallingConventionsPass
       if (failed(adjustCallingConventions(func, typeBoundMap)))
         return signalPassFailure();
     }
+    if (donatedArgs.empty())
+      return;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (failed(markDonatedArgs(func, donatedArgs)))
+        return signalPassFailure();
+    }
   }
 };
 } // namespace
@@ -314,4 +351,11 @@ std::unique_ptr<OperationPass<ModuleOp>> createAdjustCallingConventionsPass() {
   return std::make_unique<AdjustCallingConventionsPass>();
 }
 
+std::unique_ptr<OperationPass<ModuleOp>>
+createAdjustCallingConventionsPass(ArrayRef<int64_t> donatedArgs) {
+  AdjustCallingConventionsOptions options;
+  options.donatedArgs.append(donatedArgs.begin(), donatedArgs.end());
+  return std::make_unique<AdjustCallingConventionsPass>(options);
+}
+
 } // namespace mlir::torch::Torch
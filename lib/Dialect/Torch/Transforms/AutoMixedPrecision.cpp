@@ -0,0 +1,259 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FoldWeightsUtils.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/StringSet.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_AUTOMIXEDPRECISION
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+// The ops that run in the low precision dtype by default. Their accumulations
+// stay in f32 when they are lowered, e.g. by TorchToLinalg.
+static const char *kDefaultAllowedOps[] = {
+    "aten.mm",
+    "aten.bmm",
+    "aten.matmul",
+    "aten.linear",
+    "aten.addmm",
+    "aten.baddbmm",
+    "aten.convolution",
+    "aten._convolution",
+    "aten.conv1d",
+    "aten.conv2d",
+    "aten.conv3d",
+    "aten.conv_transpose1d",
+    "aten.conv_transpose2d.input",
+    "aten.conv_transpose3d.input",
+    "aten.scaled_dot_product_attention",
+};
+
+// The ops that run in the low precision dtype when all of their f32 tensor
+// operands are casts of low precision tensors, so that chains of allowed ops
+// and these stay in it. Others, e.g. softmaxes, normalizations, reductions and
+// losses, stay in f32.
+static const char *kDefaultPropagatedOps[] = {
+    "aten.relu",
+    "aten.gelu",
+    "aten.silu",
+    "aten.tanh",
+    "aten.sigmoid",
+    "aten.neg",
+    "aten.add.Tensor",
+    "aten.sub.Tensor",
+    "aten.mul.Tensor",
+    "aten.add.Scalar",
+    "aten.mul.Scalar",
+    "aten.clone",
+    "aten.contiguous",
+    "aten.transpose.int",
+    "aten.permute",
+    "aten.t",
+    "aten.view",
+    "aten.reshape",
+    "aten.unsqueeze",
+    "aten.squeeze.dim",
+    "aten.flatten.using_ints",
+};
+
+static bool isF32Tensor(Type type) {
+  auto tensorType = dyn_cast<ValueTensorType>(type);
+  return tensorType && tensorType.hasDtype() && tensorType.getDtype().isF32();
+}
+
+// Whether `value` is the f32 cast of a tensor of `dtype`.
+static bool isCastFrom(Value value, Type dtype) {
+  auto cast = value.getDefiningOp<AtenToDtypeOp>();
+  if (!cast)
+    return false;
+  auto inType = dyn_cast<ValueTensorType>(cast.getSelf().getType());
+  return inType && inType.hasDtype() && inType.getDtype() == dtype;
+}
+
+namespace {
+// Runs an allowed or propagated op on f32 tensors in the low precision dtype,
+// casting its f32 tensor operands to it and its results back. The casts back
+// are left without users when all of their users run in the low precision
+// dtype too.
+class ComputeInLowPrecision : public RewritePattern {
+public:
+  ComputeInLowPrecision(MLIRContext *context, Type dtype,
+                        const llvm::StringSet<> &allowedOps,
+                        const llvm::StringSet<> &propagatedOps)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context),
+        dtype(dtype), allowedOps(allowedOps), propagatedOps(propagatedOps) {}
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    StringRef name = op->getName().getStringRef();
+    if (!name.consume_front(kTorchOpPrefix))
+      return rewriter.notifyMatchFailure(op, "not a torch op");
+    bool isAllowed = allowedOps.contains(name);
+    if (!isAllowed && !propagatedOps.contains(name))
+      return rewriter.notifyMatchFailure(op, "op is not allowed");
+    if (op->getNumResults() == 0 ||
+        !llvm::all_of(op->getResultTypes(), isF32Tensor))
+      return rewriter.notifyMatchFailure(op, "results are not f32 tensors");
+
+    SmallVector<unsigned> castOperands;
+    for (OpOperand &operand : op->getOpOperands()) {
+      Type type = operand.get().getType();
+      auto listType = dyn_cast<Torch::ListType>(type);
+      if (isa<NonValueTensorType>(type) ||
+          (listType && isa<BaseTensorType>(listType.getContainedType())))
+        return rewriter.notifyMatchFailure(op, "unsupported operand");
+      if (!isF32Tensor(type))
+        continue;
+      if (!isAllowed && !isCastFrom(operand.get(), dtype))
+        return rewriter.notifyMatchFailure(
+            op, "operand is not a cast of a low precision tensor");
+      castOperands.push_back(operand.getOperandNumber());
+    }
+    if (castOperands.empty())
+      return rewriter.notifyMatchFailure(op, "no f32 tensor operands");
+
+    rewriter.setInsertionPoint(op);
+    SmallVector<Value> newOperands;
+    for (unsigned i : castOperands)
+      newOperands.push_back(castToLowPrecision(rewriter, op->getOperand(i)));
+    rewriter.modifyOpInPlace(op, [&]() {
+      for (auto [i, newOperand] : llvm::zip_equal(castOperands, newOperands))
+        op->setOperand(i, newOperand);
+      for (Value result : op->getResults()) {
+        auto type = cast<ValueTensorType>(result.getType());
+        result.setType(type.getWithDtype(dtype));
+      }
+    });
+
+    rewriter.setInsertionPointAfter(op);
+    for (Value result : op->getResults()) {
+      Value castBack = convertTensorToDtype(rewriter, op->getLoc(), result,
+                                            rewriter.getF32Type());
+      rewriter.replaceAllUsesExcept(result, castBack, castBack.getDefiningOp());
+    }
+    return success();
+  }
+
+private:
+  // Casts an f32 tensor to the low precision dtype, reading through a cast
+  // from it.
+  Value castToLowPrecision(PatternRewriter &rewriter, Value value) const {
+    if (isCastFrom(value, dtype))
+      return value.getDefiningOp<AtenToDtypeOp>().getSelf();
+    return convertTensorToDtype(rewriter, value.getLoc(), value, dtype);
+  }
+
+  Type dtype;
+  const llvm::StringSet<> &allowedOps;
+  const llvm::StringSet<> &propagatedOps;
+};
+} // namespace
+
+namespace {
+class AutoMixedPrecisionPass
+    : public impl::AutoMixedPrecisionBase<AutoMixedPrecisionPass> {
+public:
+  using impl::AutoMixedPrecisionBase<
+      AutoMixedPrecisionPass>::AutoMixedPrecisionBase;
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    Type dtype;
+    if (computeDtype == "bf16") {
+      dtype = BFloat16Type::get(context);
+    } else if (computeDtype == "f16") {
+      dtype = Float16Type::get(context);
+    } else {
+      getOperation().emitError() << "unsupported dtype '" << computeDtype
+                                 << "', expected 'bf16' or 'f16'";
+      return signalPassFailure();
+    }
+
+    llvm::StringSet<> allowedOps, propagatedOps;
+    for (const char *name : kDefaultAllowedOps)
+      allowedOps.insert(name);
+    for (const std::string &name : allowOps)
+      allowedOps.insert(name);
+    for (const char *name : kDefaultPropagatedOps)
+      propagatedOps.insert(name);
+    for (const std::string &name : denyOps) {
+      allowedOps.erase(name);
+      propagatedOps.erase(name);
+    }
+
+    RewritePatternSet patterns(context);
+    patterns.add<ComputeInLowPrecision>(context, dtype, allowedOps,
+                                        propagatedOps);
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns))))
+      return signalPassFailure();
+    cleanUpCasts(dtype);
+  }
+
+private:
+  // Erases the casts that are left without users, e.g. those back to f32
+  // between two ops that run in `dtype`, and evaluates the casts of f32
+  // literal weights to `dtype` at compile time, into one literal per weight.
+  void cleanUpCasts(Type dtype) {
+    SmallVector<AtenToDtypeOp> casts;
+    getOperation().walk([&](AtenToDtypeOp cast) {
+      auto type = dyn_cast<ValueTensorType>(cast.getType());
+      if (cast.use_empty())
+        cast.erase();
+      else if (type && type.hasDtype() && type.getDtype() == dtype)
+        casts.push_back(cast);
+    });
+    DenseMap<Value, Value> castWeights;
+    OpBuilder builder(&getContext());
+    Type f32 = builder.getF32Type();
+    for (AtenToDtypeOp cast : casts) {
+      Value self = cast.getSelf();
+      std::optional<Weight> weight =
+          matchWeight(self, /*requireOneUse=*/false);
+      if (!weight || !weight->getType().getElementType().isF32())
+        continue;
+      Value &folded = castWeights[self];
+      if (!folded) {
+        builder.setInsertionPointAfterValue(self);
+        auto outType =
+            RankedTensorType::get(weight->getType().getShape(), dtype);
+        const char *in = weight->data.data();
+        ElementsAttr data = createWeight(
+            &getContext(), *weight, outType, "_cast",
+            [&](char *out, int64_t begin, int64_t end) {
+              for (int64_t i = begin; i < end; ++i)
+                writeFloat(out, i, dtype, readFloat(in, i, f32));
+            });
+        folded = ValueTensorLiteralOp::create(builder, cast.getLoc(), data);
+      }
+      cast.replaceAllUsesWith(folded);
+      cast.erase();
+    }
+    for (auto [weight, folded] : castWeights) {
+      if (weight.use_empty())
+        weight.getDefiningOp()->erase();
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createAutoMixedPrecisionPass() {
+  return std::make_unique<AutoMixedPrecisionPass>();
+}
+
+} // namespace mlir::torch::Torch
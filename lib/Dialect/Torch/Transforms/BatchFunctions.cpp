@@ -0,0 +1,625 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_BATCHFUNCTIONS
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+static constexpr StringLiteral kBatchedSuffix = "$batched";
+
+// Ops whose result elements only depend on the operand elements at the same
+// position (after broadcasting), so that they apply to each batch alike.
+static bool isElementwise(Operation *op) {
+  return isa<AtenTanhOp, AtenSigmoidOp, AtenReluOp, AtenGeluOp, AtenSiluOp,
+             AtenHardswishOp, AtenHardsigmoidOp, AtenLeakyReluOp,
+             AtenSoftplusOp, AtenExpOp, AtenExpm1Op, AtenLogOp, AtenLog1pOp,
+             AtenSqrtOp, AtenRsqrtOp, AtenSquareOp, AtenNegOp, AtenAbsOp,
+             AtenErfOp, AtenSinOp, AtenCosOp, AtenReciprocalOp, AtenFloorOp,
+             AtenCeilOp, AtenRoundOp, AtenToDtypeOp, AtenClampOp,
+             AtenAddTensorOp, AtenSubTensorOp, AtenMulTensorOp,
+             AtenDivTensorOp, AtenMaximumOp, AtenMinimumOp, AtenAddScalarOp,
+             AtenSubScalarOp, AtenMulScalarOp, AtenDivScalarOp,
+             AtenRsubScalarOp, AtenRemainderScalarOp, AtenPowTensorScalarOp,
+             AtenPowTensorTensorOp, AtenPowScalarOp, AtenWhereSelfOp,
+             AtenMaskedFillScalarOp, AtenEqTensorOp, AtenNeTensorOp,
+             AtenGtTensorOp, AtenGeTensorOp, AtenLtTensorOp, AtenLeTensorOp,
+             AtenEqScalarOp, AtenNeScalarOp, AtenGtScalarOp, AtenGeScalarOp,
+             AtenLtScalarOp, AtenLeScalarOp, AtenLogicalNotOp,
+             AtenBitwiseNotOp, AtenCloneOp, AtenContiguousOp, AtenDetachOp,
+             AtenDropoutOp, TensorStaticInfoCastOp>(op);
+}
+
+// The operands of ops that only read the trailing dims of the tensor, so
+// that extra leading dims pass through to the results, or std::nullopt.
+static std::optional<SmallVector<unsigned>>
+getLeadingDimsAgnosticOperands(Operation *op) {
+  if (isa<AtenLinearOp, AtenLayerNormOp, AtenNativeLayerNormOp>(op))
+    return SmallVector<unsigned>{0};
+  // The rows of the table are read at the indices of any shape.
+  if (isa<AtenEmbeddingOp>(op))
+    return SmallVector<unsigned>{1};
+  return std::nullopt;
+}
+
+// Ops on an `[N, C, ...]` input whose batches `N` are independent, so that
+// the new batch dim can be folded into `N`.
+static bool isBatchFoldable(Operation *op) {
+  return isa<AtenConvolutionOp, Aten_ConvolutionOp, AtenConv1dOp,
+             AtenConv2dOp, AtenConv3dOp, AtenConvTranspose1dOp,
+             AtenConvTranspose2dInputOp, AtenConvTranspose3dInputOp,
+             AtenMaxPool1dOp, AtenMaxPool2dOp, AtenMaxPool3dOp,
+             AtenAvgPool1dOp, AtenAvgPool2dOp, AtenAvgPool3dOp,
+             AtenAdaptiveAvgPool1dOp, AtenAdaptiveAvgPool2dOp,
+             AtenBatchNormOp, AtenUpsampleNearest2dOp>(op);
+}
+
+// The operands of ops that are dims, or lists of dims, of their first
+// operand, or std::nullopt.
+static std::optional<SmallVector<unsigned>> getDimOperands(Operation *op) {
+  if (isa<AtenSumDimIntListOp, AtenMeanDimOp, AtenAmaxOp, AtenAminOp,
+          AtenMaxDimOp, AtenMinDimOp, AtenArgmaxOp, AtenArgminOp,
+          AtenVarDimOp, AtenStdDimOp, AtenLogsumexpOp, AtenSoftmaxIntOp,
+          AtenLogSoftmaxIntOp, Aten_SoftmaxOp, Aten_LogSoftmaxOp,
+          AtenCumsumOp, AtenSqueezeDimOp, AtenUnsqueezeOp, AtenSelectIntOp,
+          AtenSliceTensorOp, AtenSizeIntOp, AtenCatOp, AtenStackOp>(op))
+    return SmallVector<unsigned>{1};
+  if (isa<AtenTransposeIntOp, AtenFlattenUsingIntsOp>(op))
+    return SmallVector<unsigned>{1, 2};
+  return std::nullopt;
+}
+
+// The dims of a tensor that are at or after the batch dim once it has one.
+static int64_t shiftDim(int64_t dim) { return dim >= 0 ? dim + 1 : dim; }
+
+static bool hasSizes(Value value) {
+  auto type = dyn_cast<ValueTensorType>(value.getType());
+  return type && type.hasSizes();
+}
+
+static SmallVector<int64_t> getSizes(Value value) {
+  return llvm::to_vector(cast<ValueTensorType>(value.getType()).getSizes());
+}
+
+namespace {
+// Lifts the body of a function over a new leading batch dim. The values that
+// depend on the arguments are batched, i.e. get the batch dim, and those
+// that do not, e.g. the weights, are left as they are.
+class FunctionBatcher {
+public:
+  FunctionBatcher(func::FuncOp func, int64_t batchSize)
+      : func(func), batchSize(batchSize), b(func.getContext()) {}
+
+  LogicalResult run() {
+    Block &block = func.getBody().front();
+    for (BlockArgument arg : block.getArguments()) {
+      if (!isa<BaseTensorType>(arg.getType()))
+        continue;
+      Type type = getBatchedType(arg.getType());
+      if (!type)
+        return emitError(arg.getLoc())
+               << "cannot batch an argument of type " << arg.getType();
+      arg.setType(type);
+      batched.insert(arg);
+    }
+
+    for (Operation &op :
+         llvm::make_early_inc_range(block.without_terminator())) {
+      if (llvm::none_of(op.getOperands(),
+                        [&](Value value) { return batched.contains(value); }))
+        continue;
+      if (op.getNumRegions() != 0)
+        return op.emitError("cannot batch an op with regions");
+      b.setInsertionPoint(&op);
+      FailureOr<SmallVector<Value>> results = batchOp(&op);
+      if (failed(results))
+        return op.emitError("no batching rule for this op");
+      op.replaceAllUsesWith(*results);
+      op.erase();
+    }
+
+    // Tensor results that do not depend on the arguments are the same for
+    // each batch, and other results are returned once.
+    Operation *terminator = block.getTerminator();
+    b.setInsertionPoint(terminator);
+    for (OpOperand &operand : terminator->getOpOperands()) {
+      Value result = operand.get();
+      if (batched.contains(result) || !isa<BaseTensorType>(result.getType()))
+        continue;
+      Value broadcast = broadcastToBatch(result.getLoc(), result);
+      if (!broadcast)
+        return terminator->emitError("cannot batch a result of type ")
+               << result.getType();
+      operand.set(broadcast);
+    }
+    func.setFunctionType(b.getFunctionType(block.getArgumentTypes(),
+                                           terminator->getOperandTypes()));
+    return success();
+  }
+
+private:
+  // The type of the batched `type`, or null if `type` is not a value tensor
+  // of known rank.
+  Type getBatchedType(Type type) {
+    auto tensorType = dyn_cast<ValueTensorType>(type);
+    if (!tensorType || !tensorType.hasSizes())
+      return nullptr;
+    SmallVector<int64_t> sizes{batchSize};
+    llvm::append_range(sizes, tensorType.getSizes());
+    return tensorType.getWithSizesAndDtype(sizes,
+                                           tensorType.getOptionalDtype());
+  }
+
+  Value createInt(Location loc, int64_t value) {
+    return ConstantIntOp::create(b, loc, b.getI64IntegerAttr(value));
+  }
+
+  Value createList(Location loc, ArrayRef<Value> elements) {
+    Type listType = Torch::ListType::get(b.getType<Torch::IntType>());
+    return PrimListConstructOp::create(b, loc, listType, elements);
+  }
+
+  Value createIntList(Location loc, ArrayRef<int64_t> values) {
+    SmallVector<Value> elements;
+    for (int64_t value : values)
+      elements.push_back(createInt(loc, value));
+    return createList(loc, elements);
+  }
+
+  // The batch size, as read from the first batched argument when it is
+  // dynamic, or null if there is none.
+  Value getBatchSize(Location loc) {
+    if (batchSize != kUnknownSize)
+      return createInt(loc, batchSize);
+    if (batchSizeValue)
+      return batchSizeValue;
+    for (BlockArgument arg : func.getArguments()) {
+      if (!batched.contains(arg))
+        continue;
+      OpBuilder::InsertionGuard guard(b);
+      b.setInsertionPointToStart(&func.getBody().front());
+      Value zero = createInt(loc, 0);
+      batchSizeValue = AtenSizeIntOp::create(
+          b, loc, b.getType<Torch::IntType>(), arg, zero);
+      return batchSizeValue;
+    }
+    return nullptr;
+  }
+
+  // Inserts a dim of size 1 at `dim` of `value`, which keeps it batched.
+  Value createUnsqueeze(Location loc, Value value, int64_t dim) {
+    auto type = cast<ValueTensorType>(value.getType());
+    SmallVector<int64_t> sizes = getSizes(value);
+    sizes.insert(sizes.begin() + dim, 1);
+    Value result = AtenUnsqueezeOp::create(
+        b, loc, type.getWithSizesAndDtype(sizes, type.getOptionalDtype()),
+        value, createInt(loc, dim));
+    if (batched.contains(value))
+      batched.insert(result);
+    return result;
+  }
+
+  // Removes the dim of size 1 at `dim` of `value`, which keeps it batched.
+  Value createSqueeze(Location loc, Value value, int64_t dim) {
+    auto type = cast<ValueTensorType>(value.getType());
+    SmallVector<int64_t> sizes = getSizes(value);
+    sizes.erase(sizes.begin() + dim);
+    Value result = AtenSqueezeDimOp::create(
+        b, loc, type.getWithSizesAndDtype(sizes, type.getOptionalDtype()),
+        value, createInt(loc, dim));
+    if (batched.contains(value))
+      batched.insert(result);
+    return result;
+  }
+
+  // Repeats the unbatched `value` along a new batch dim, or returns null.
+  Value broadcastToBatch(Location loc, Value value) {
+    Type type = getBatchedType(value.getType());
+    Value size = getBatchSize(loc);
+    if (!type || !size)
+      return nullptr;
+    SmallVector<Value> sizes{size};
+    for (size_t i = 0, e = getSizes(value).size(); i < e; ++i)
+      sizes.push_back(createInt(loc, -1));
+    Value result = AtenExpandOp::create(
+        b, loc, type, createUnsqueeze(loc, value, 0), createList(loc, sizes),
+        ConstantBoolOp::create(b, loc, false));
+    batched.insert(result);
+    return result;
+  }
+
+  // Clones `op` with `operands`, and batches the types of its tensor
+  // results.
+  FailureOr<SmallVector<Value>> cloneBatched(Operation *op,
+                                             ArrayRef<Value> operands) {
+    SmallVector<Type> types;
+    for (Type type : op->getResultTypes()) {
+      if (!isa<BaseTensorType>(type)) {
+        types.push_back(type);
+        continue;
+      }
+      types.push_back(getBatchedType(type));
+      if (!types.back())
+        return failure();
+    }
+    Operation *newOp = b.clone(*op);
+    newOp->setOperands(operands);
+    for (auto [result, type] : llvm::zip_equal(newOp->getResults(), types)) {
+      result.setType(type);
+      if (isa<BaseTensorType>(type))
+        batched.insert(result);
+    }
+    return SmallVector<Value>(newOp->getResults());
+  }
+
+  // Whether the batched operands of `op` are all in `indices`.
+  bool onlyBatches(Operation *op, ArrayRef<unsigned> indices) {
+    for (OpOperand &operand : op->getOpOperands()) {
+      if (batched.contains(operand.get()) &&
+          !llvm::is_contained(indices, operand.getOperandNumber()))
+        return false;
+    }
+    return true;
+  }
+
+  FailureOr<SmallVector<Value>> batchOp(Operation *op) {
+    if (isElementwise(op))
+      return batchElementwise(op);
+    if (isa<AtenMmOp, AtenBmmOp, AtenMatmulOp>(op))
+      return batchMatmul(op);
+    if (std::optional<SmallVector<unsigned>> operands =
+            getLeadingDimsAgnosticOperands(op)) {
+      if (!onlyBatches(op, *operands))
+        return failure();
+      return cloneBatched(op, llvm::to_vector(op->getOperands()));
+    }
+    if (isBatchFoldable(op))
+      return batchByFolding(op);
+    if (isa<AtenSumOp, AtenMeanOp>(op))
+      return batchFullReduction(op);
+    if (std::optional<SmallVector<unsigned>> dims = getDimOperands(op))
+      return batchDims(op, *dims);
+    if (auto permute = dyn_cast<AtenPermuteOp>(op))
+      return batchPermute(permute);
+    if (isa<AtenViewOp, AtenReshapeOp>(op))
+      return batchView(op);
+    if (auto expand = dyn_cast<AtenExpandOp>(op))
+      return batchExpand(expand);
+    if (auto list = dyn_cast<PrimListConstructOp>(op))
+      return batchTensorList(list);
+    return failure();
+  }
+
+  // Batched operands of lower rank than the result would broadcast their
+  // batch dim against a dim of the others, so they get unit dims after it.
+  FailureOr<SmallVector<Value>> batchElementwise(Operation *op) {
+    auto resultType = dyn_cast<ValueTensorType>(op->getResult(0).getType());
+    if (op->getNumResults() != 1 || !resultType || !resultType.hasSizes())
+      return failure();
+    int64_t rank = resultType.getSizes().size();
+    SmallVector<Value> operands;
+    for (Value operand : op->getOperands()) {
+      if (batched.contains(operand)) {
+        for (int64_t i = getSizes(operand).size() - 1; i < rank; ++i)
+          operand = createUnsqueeze(op->getLoc(), operand, 1);
+      }
+      operands.push_back(operand);
+    }
+    return cloneBatched(op, operands);
+  }
+
+  // `aten.mm`, `aten.bmm` and `aten.matmul` all become an `aten.matmul`,
+  // which broadcasts the batch dims of its operands. A batched vector is
+  // made a matrix first, so that its batch dim is not taken for a row or a
+  // column, and the batched operands get the unit dims to broadcast along
+  // the batch dims of the other.
+  FailureOr<SmallVector<Value>> batchMatmul(Operation *op) {
+    Location loc = op->getLoc();
+    Type resultType = getBatchedType(op->getResult(0).getType());
+    Value lhs = op->getOperand(0), rhs = op->getOperand(1);
+    if (!resultType || !hasSizes(lhs) || !hasSizes(rhs))
+      return failure();
+    bool lhsBatched = batched.contains(lhs), rhsBatched = batched.contains(rhs);
+    int64_t lhsRank = getSizes(lhs).size() - lhsBatched;
+    int64_t rhsRank = getSizes(rhs).size() - rhsBatched;
+    bool lhsVector = lhsBatched && lhsRank == 1;
+    bool rhsVector = rhsBatched && rhsRank == 1;
+    if (lhsVector) {
+      lhs = createUnsqueeze(loc, lhs, 1);
+      lhsRank = 2;
+    }
+    if (rhsVector) {
+      rhs = createUnsqueeze(loc, rhs, 2);
+      rhsRank = 2;
+    }
+    int64_t rank = std::max(lhsRank, rhsRank);
+    for (; lhsBatched && lhsRank < rank; ++lhsRank)
+      lhs = createUnsqueeze(loc, lhs, 1);
+    for (; rhsBatched && rhsRank < rank; ++rhsRank)
+      rhs = createUnsqueeze(loc, rhs, 1);
+
+    // The product has the unit row of a batched lhs vector and the unit
+    // column of a batched rhs vector, which are squeezed out.
+    auto type = cast<ValueTensorType>(resultType);
+    SmallVector<int64_t> sizes(type.getSizes());
+    int64_t lhsDim = -1, rhsDim = -1;
+    if (rhsVector) {
+      rhsDim = sizes.size();
+      sizes.push_back(1);
+    }
+    if (lhsVector) {
+      lhsDim = sizes.size() - (rhsRank >= 2 ? 1 : 0);
+      sizes.insert(sizes.begin() + lhsDim, 1);
+      if (rhsVector)
+        ++rhsDim;
+    }
+    Value result = AtenMatmulOp::create(
+        b, loc, type.getWithSizesAndDtype(sizes, type.getOptionalDtype()), lhs,
+        rhs);
+    batched.insert(result);
+    if (rhsVector)
+      result = createSqueeze(loc, result, rhsDim);
+    if (lhsVector)
+      result = createSqueeze(loc, result, lhsDim);
+    return SmallVector<Value>{result};
+  }
+
+  // Folds the batch dim into the static leading dim `N` of the input, runs
+  // `op` on `[B * N, ...]`, and unfolds the result back to `[B, N, ...]`.
+  FailureOr<SmallVector<Value>> batchByFolding(Operation *op) {
+    Location loc = op->getLoc();
+    Value input = op->getOperand(0);
+    if (op->getNumResults() != 1 || !onlyBatches(op, {0}))
+      return failure();
+    auto inputType = cast<ValueTensorType>(input.getType());
+    auto resultType = dyn_cast<ValueTensorType>(op->getResult(0).getType());
+    if (!resultType || !resultType.hasSizes())
+      return failure();
+    Type batchedResultType = getBatchedType(resultType);
+    SmallVector<int64_t> inputSizes = getSizes(input);
+    ArrayRef<int64_t> resultSizes = resultType.getSizes();
+    if (inputSizes.size() < 2 || resultSizes.empty() ||
+        inputSizes[1] == kUnknownSize || resultSizes[0] != inputSizes[1])
+      return failure();
+    if (auto batchNorm = dyn_cast<AtenBatchNormOp>(op)) {
+      // The statistics of a training batch norm are over all of `N`.
+      bool training;
+      if (!matchPattern(batchNorm.getTraining(),
+                        m_TorchConstantBool(&training)) ||
+          training)
+        return failure();
+    } else if (!isa<AtenMaxPool1dOp, AtenMaxPool2dOp, AtenMaxPool3dOp,
+                    AtenAvgPool1dOp, AtenAvgPool2dOp, AtenAvgPool3dOp,
+                    AtenAdaptiveAvgPool1dOp, AtenAdaptiveAvgPool2dOp,
+                    AtenUpsampleNearest2dOp>(op)) {
+      // A convolution of an unbatched `[C, ...]` input reads all of its
+      // leading dim at once.
+      auto weightType = dyn_cast<ValueTensorType>(op->getOperand(1).getType());
+      if (!weightType || !weightType.hasSizes() ||
+          weightType.getSizes().size() != inputSizes.size() - 1)
+        return failure();
+    }
+
+    int64_t n = inputSizes[1];
+    int64_t foldedSize =
+        batchSize == kUnknownSize ? kUnknownSize : batchSize * n;
+    SmallVector<int64_t> foldedInputSizes{foldedSize};
+    llvm::append_range(foldedInputSizes, ArrayRef(inputSizes).drop_front(2));
+    Value folded = AtenFlattenUsingIntsOp::create(
+        b, loc,
+        inputType.getWithSizesAndDtype(foldedInputSizes,
+                                       inputType.getOptionalDtype()),
+        input, createInt(loc, 0), createInt(loc, 1));
+    SmallVector<int64_t> foldedResultSizes{foldedSize};
+    llvm::append_range(foldedResultSizes, resultSizes.drop_front());
+
+    Operation *newOp = b.clone(*op);
+    newOp->setOperand(0, folded);
+    newOp->getResult(0).setType(resultType.getWithSizesAndDtype(
+        foldedResultSizes, resultType.getOptionalDtype()));
+    Value result = AtenUnflattenIntOp::create(
+        b, loc, batchedResultType, newOp->getResult(0), createInt(loc, 0),
+        createIntList(loc, {batchSize == kUnknownSize ? -1 : batchSize, n}));
+    batched.insert(result);
+    return SmallVector<Value>{result};
+  }
+
+  // `aten.sum` and `aten.mean` of the whole tensor reduce all but the batch
+  // dim instead.
+  FailureOr<SmallVector<Value>> batchFullReduction(Operation *op) {
+    Location loc = op->getLoc();
+    Value self = op->getOperand(0), dtype = op->getOperand(1);
+    Type resultType = getBatchedType(op->getResult(0).getType());
+    if (!resultType)
+      return failure();
+    SmallVector<int64_t> dims = llvm::to_vector(
+        llvm::seq<int64_t>(1, static_cast<int64_t>(getSizes(self).size())));
+    Value dimList = createIntList(loc, dims);
+    Value keepDim = ConstantBoolOp::create(b, loc, false);
+    Value result;
+    if (isa<AtenSumOp>(op))
+      result = AtenSumDimIntListOp::create(b, loc, resultType, self, dimList,
+                                           keepDim, dtype);
+    else
+      result = AtenMeanDimOp::create(b, loc, resultType, self, dimList,
+                                     keepDim, dtype);
+    batched.insert(result);
+    return SmallVector<Value>{result};
+  }
+
+  // Shifts the non-negative dims of `op` past the batch dim, while negative
+  // dims already count from the end.
+  FailureOr<SmallVector<Value>> batchDims(Operation *op,
+                                          ArrayRef<unsigned> dimOperands) {
+    if (!onlyBatches(op, {0}))
+      return failure();
+    Location loc = op->getLoc();
+    SmallVector<Value> operands(op->getOperands());
+    for (unsigned index : dimOperands) {
+      int64_t dim;
+      SmallVector<int64_t> dims;
+      if (matchPattern(operands[index], m_TorchConstantInt(&dim))) {
+        operands[index] = createInt(loc, shiftDim(dim));
+      } else if (matchPattern(operands[index],
+                              m_TorchListOfConstantInts(dims))) {
+        // An empty list reduces over all dims.
+        if (dims.empty())
+          return failure();
+        for (int64_t &dim : dims)
+          dim = shiftDim(dim);
+        operands[index] = createIntList(loc, dims);
+      } else {
+        return failure();
+      }
+    }
+    return cloneBatched(op, operands);
+  }
+
+  FailureOr<SmallVector<Value>> batchPermute(AtenPermuteOp op) {
+    SmallVector<int64_t> perms;
+    if (!matchPattern(op.getDims(), m_TorchListOfConstantInts(perms)))
+      return failure();
+    int64_t rank = perms.size();
+    SmallVector<int64_t> batchedPerms{0};
+    for (int64_t dim : perms) {
+      if (!isValidDim(dim, rank))
+        return failure();
+      batchedPerms.push_back(toPositiveDim(dim, rank) + 1);
+    }
+    return cloneBatched(op, {op.getSelf(),
+                             createIntList(op.getLoc(), batchedPerms)});
+  }
+
+  // The sizes of a view only have room for one inferred dim, so the other
+  // sizes are taken from the result type when the batch size is dynamic.
+  FailureOr<SmallVector<Value>> batchView(Operation *op) {
+    if (!onlyBatches(op, {0}))
+      return failure();
+    Location loc = op->getLoc();
+    auto resultType = dyn_cast<ValueTensorType>(op->getResult(0).getType());
+    if (!resultType || !resultType.hasSizes())
+      return failure();
+    SmallVector<Value> sizes;
+    if (!getListConstructElements(op->getOperand(1), sizes))
+      return failure();
+    bool inferred = llvm::any_of(sizes, [](Value size) {
+      int64_t value;
+      return !matchPattern(size, m_TorchConstantInt(&value)) || value == -1;
+    });
+    if (inferred && batchSize == kUnknownSize) {
+      if (!resultType.areAllSizesKnown())
+        return failure();
+      sizes.clear();
+      for (int64_t size : resultType.getSizes())
+        sizes.push_back(createInt(loc, size));
+    }
+    sizes.insert(sizes.begin(),
+                 createInt(loc, batchSize == kUnknownSize ? -1 : batchSize));
+    return cloneBatched(op, {op->getOperand(0), createList(loc, sizes)});
+  }
+
+  // The new dims of the expansion go after the batch dim, and a size of -1
+  // keeps the batch dim as it is.
+  FailureOr<SmallVector<Value>> batchExpand(AtenExpandOp op) {
+    if (!onlyBatches(op, {0}))
+      return failure();
+    Location loc = op.getLoc();
+    SmallVector<Value> sizes;
+    if (!getListConstructElements(op.getSize(), sizes))
+      return failure();
+    Value self = op.getSelf();
+    for (size_t i = getSizes(self).size() - 1; i < sizes.size(); ++i)
+      self = createUnsqueeze(loc, self, 1);
+    sizes.insert(sizes.begin(), createInt(loc, -1));
+    return cloneBatched(op, {self, createList(loc, sizes), op.getImplicit()});
+  }
+
+  // The tensors of a list that is batched, as read by `aten.cat` and
+  // `aten.stack`, are all batched.
+  FailureOr<SmallVector<Value>> batchTensorList(PrimListConstructOp op) {
+    auto listType = cast<Torch::ListType>(op.getType());
+    auto elementType = dyn_cast<BaseTensorType>(listType.getContainedType());
+    if (!elementType || elementType.hasSizes())
+      return failure();
+    SmallVector<Value> elements;
+    for (Value element : op.getElements()) {
+      if (!batched.contains(element))
+        element = broadcastToBatch(op.getLoc(), element);
+      if (!element)
+        return failure();
+      elements.push_back(element);
+    }
+    Value list =
+        PrimListConstructOp::create(b, op.getLoc(), listType, elements);
+    batched.insert(list);
+    return SmallVector<Value>{list};
+  }
+
+  func::FuncOp func;
+  int64_t batchSize;
+  OpBuilder b;
+  DenseSet<Value> batched;
+  Value batchSizeValue;
+};
+} // namespace
+
+namespace {
+class BatchFunctionsPass
+    : public impl::BatchFunctionsBase<BatchFunctionsPass> {
+public:
+  using impl::BatchFunctionsBase<BatchFunctionsPass>::BatchFunctionsBase;
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    if (batchSize < 1 && batchSize != kUnknownSize) {
+      module.emitError("batch-size must be positive, or -1 for a dynamic "
+                       "batch size");
+      return signalPassFailure();
+    }
+    SmallVector<func::FuncOp> funcs;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (func.isPublic() && !func.isDeclaration() &&
+          func.getBody().hasOneBlock() &&
+          !func.getName().ends_with(kBatchedSuffix) &&
+          llvm::any_of(func.getArgumentTypes(),
+                       [](Type type) { return isa<BaseTensorType>(type); }))
+        funcs.push_back(func);
+    }
+
+    SymbolTable symbolTable(module);
+    for (func::FuncOp func : funcs) {
+      func::FuncOp batchedFunc = func.clone();
+      batchedFunc.setName((func.getName() + kBatchedSuffix).str());
+      batchedFunc.removeArgAttrsAttr();
+      batchedFunc.removeResAttrsAttr();
+      if (failed(FunctionBatcher(batchedFunc, batchSize).run())) {
+        batchedFunc->erase();
+        return signalPassFailure();
+      }
+      symbolTable.insert(batchedFunc, std::next(Block::iterator(func)));
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createBatchFunctionsPass() {
+  return std::make_unique<BatchFunctionsPass>();
+}
+
+} // namespace mlir::torch::Torch
@@ -12,6 +12,7 @@
 #include "mlir/IR/BuiltinDialect.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Rewrite/PatternApplicator.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
@@ -20,10 +21,15 @@
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Sequence.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/MathExtras.h"
 #include <cstdint>
+#include <functional>
+#include <limits>
 #include <set>
 using namespace mlir;
 using namespace mlir::torch;
@@ -589,6 +595,51 @@ static LogicalResult performMatmul(PatternRewriter &rewriter, Location loc,
   Type outputDType = lhsType.hasDtype() ? lhsType.getOptionalDtype()
                                         : rhsType.getOptionalDtype();
 
+  // parse batch, contracting, other, reduce dims of lhs and rhs
+  SmallVector<char> contractingDims;
+  SmallVector<char> lhsReduceDims;
+  SmallVector<char> rhsReduceDims;
+  SmallVector<char> lhsOtherDims;
+  SmallVector<char> rhsOtherDims;
+  SmallVector<char> batchingDims;
+  parseDimTokens(lhsTokens, rhsTokens, finalResultTokens, contractingDims,
+                 lhsReduceDims, rhsReduceDims, batchingDims, lhsOtherDims,
+                 rhsOtherDims);
+
+  // With at most one dim of each kind, the permuted operands are already
+  // [batch, other, contracting] and [batch, contracting, other], and the
+  // matmul result is in the ideal order, so no reshape is needed.
+  if (batchingDims.size() <= 1 && contractingDims.size() == 1 &&
+      lhsOtherDims.size() == 1 && rhsOtherDims.size() == 1 &&
+      lhsReduceDims.empty() && rhsReduceDims.empty()) {
+    lhs = permuteTensorForMatmul(rewriter, loc, lhs, lhsTokens, batchingDims,
+                                 contractingDims, lhsOtherDims, lhsReduceDims,
+                                 true);
+    rhs = permuteTensorForMatmul(rewriter, loc, rhs, rhsTokens, batchingDims,
+                                 contractingDims, rhsOtherDims, rhsReduceDims,
+                                 false);
+    auto lhsSizes = cast<ValueTensorType>(lhs.getType()).getSizes();
+    auto rhsSizes = cast<ValueTensorType>(rhs.getType()).getSizes();
+    SmallVector<int64_t> outShape;
+    if (!batchingDims.empty()) {
+      int64_t lhsBatch = lhsSizes.front(), rhsBatch = rhsSizes.front();
+      if (lhsBatch == 1)
+        outShape.push_back(rhsBatch);
+      else if (rhsBatch == 1 || rhsBatch == lhsBatch)
+        outShape.push_back(lhsBatch);
+      else
+        outShape.push_back(kUnknownSize);
+    }
+    outShape.push_back(lhsSizes[lhsSizes.size() - 2]);
+    outShape.push_back(rhsSizes.back());
+    result = Torch::AtenMatmulOp::create(
+        rewriter, loc, lhsType.getWithSizesAndDtype(outShape, outputDType),
+        lhs, rhs);
+    generateIdealReusltDimTokens(batchingDims, lhsOtherDims, rhsOtherDims,
+                                 lhsReduceDims, rhsReduceDims, resultTokens);
+    return success();
+  }
+
   auto materializeIntFold = [&](OpFoldResult thing) {
     if (auto attr = dyn_cast<mlir::Attribute>(thing)) {
       Value result = Torch::ConstantIntOp::create(
@@ -617,17 +668,6 @@ static LogicalResult performMatmul(PatternRewriter &rewriter, Location loc,
     rhsDimShapeMap[d] = materializeIntFold(rhsFold);
   }
 
-  // parse batch, contracting, other, reduce dims of lhs and rhs
-  SmallVector<char> contractingDims;
-  SmallVector<char> lhsReduceDims;
-  SmallVector<char> rhsReduceDims;
-  SmallVector<char> lhsOtherDims;
-  SmallVector<char> rhsOtherDims;
-  SmallVector<char> batchingDims;
-  parseDimTokens(lhsTokens, rhsTokens, finalResultTokens, contractingDims,
-                 lhsReduceDims, rhsReduceDims, batchingDims, lhsOtherDims,
-                 rhsOtherDims);
-
   llvm::SmallDenseMap<char, Value> outDimShapeMap;
   auto generateOutDimShapeMap = [&](SmallVector<char> &dims) {
     for (auto d : dims) {
@@ -769,6 +809,179 @@ static Value performLastReduceAndPermute(PatternRewriter &rewriter,
   return out;
 }
 
+// A pairwise contraction of an einsum, of the operands or earlier results
+// `lhs` and `rhs`, where the operands are numbered first and the result of
+// the i-th contraction is numbered `numOperands + i`.
+struct EinsumContraction {
+  size_t lhs;
+  size_t rhs;
+};
+
+// The largest number of operands for which all contraction orders are
+// searched. Beyond it, the cheapest contraction is picked greedily.
+static constexpr size_t kMaxOptimalEinsumOperands = 6;
+
+// The order of the pairwise contractions of the operands of an einsum with
+// the fewest multiply-adds, from the static `tokenSizes` of its dims, as an
+// opt_einsum-style path. Returns nullopt if there are too many tokens, so
+// that the operands are contracted left to right.
+static std::optional<SmallVector<EinsumContraction>>
+planEinsumContractions(ArrayRef<SmallVector<char>> inputTokens,
+                       ArrayRef<char> resultTokens,
+                       const llvm::SmallDenseMap<char, int64_t> &tokenSizes) {
+  // Tokens as bits of a mask, and their sizes as doubles to avoid overflows.
+  llvm::SmallDenseMap<char, unsigned> tokenBits;
+  SmallVector<double> bitSizes;
+  for (auto [token, size] : tokenSizes) {
+    tokenBits[token] = bitSizes.size();
+    bitSizes.push_back(size);
+  }
+  if (bitSizes.size() > 64)
+    return std::nullopt;
+  auto getMask = [&](ArrayRef<char> tokens) {
+    uint64_t mask = 0;
+    for (char token : tokens)
+      mask |= uint64_t(1) << tokenBits.lookup(token);
+    return mask;
+  };
+  auto getNumElements = [&](uint64_t mask) {
+    double numElements = 1;
+    for (unsigned bit = 0, e = bitSizes.size(); bit < e; ++bit) {
+      if (mask & (uint64_t(1) << bit))
+        numElements *= bitSizes[bit];
+    }
+    return numElements;
+  };
+
+  size_t numOperands = inputTokens.size();
+  uint64_t resultMask = getMask(resultTokens);
+  // The dims of each operand, then of each result.
+  SmallVector<uint64_t> masks;
+  for (ArrayRef<char> tokens : inputTokens)
+    masks.push_back(getMask(tokens));
+  SmallVector<EinsumContraction> path;
+
+  if (numOperands <= kMaxOptimalEinsumOperands) {
+    // The dims of the result of contracting the operands of `subset`, which
+    // are those still needed by the other operands or by the einsum.
+    size_t numSubsets = size_t(1) << numOperands;
+    SmallVector<uint64_t> subsetMasks(numSubsets, 0);
+    for (size_t subset = 1; subset < numSubsets; ++subset) {
+      uint64_t lowest = subset & -subset;
+      subsetMasks[subset] = subsetMasks[subset ^ lowest] |
+                            masks[llvm::countr_zero(lowest)];
+    }
+    auto getKeptMask = [&](size_t subset) {
+      return subsetMasks[subset] &
+             (resultMask | subsetMasks[(numSubsets - 1) ^ subset]);
+    };
+    // The fewest multiply-adds to contract each subset, and the split of
+    // the subset into the two it is contracted from.
+    SmallVector<double> costs(numSubsets, 0);
+    SmallVector<size_t> splits(numSubsets, 0);
+    for (size_t subset = 1; subset < numSubsets; ++subset) {
+      if (llvm::has_single_bit(subset))
+        continue;
+      costs[subset] = std::numeric_limits<double>::infinity();
+      // Each split {lhs, subset ^ lhs} is visited once, with lhs holding the
+      // highest operand of the subset.
+      size_t highest = llvm::bit_floor(subset);
+      for (size_t lhs = (subset - 1) & subset; lhs; lhs = (lhs - 1) & subset) {
+        if (!(lhs & highest))
+          continue;
+        size_t rhs = subset ^ lhs;
+        double cost = costs[lhs] + costs[rhs] +
+                      getNumElements(getKeptMask(lhs) | getKeptMask(rhs));
+        if (cost < costs[subset]) {
+          costs[subset] = cost;
+          splits[subset] = lhs;
+        }
+      }
+    }
+    // Emit the contractions of the best split of all operands, post-order.
+    std::function<size_t(size_t)> emit = [&](size_t subset) -> size_t {
+      if (llvm::has_single_bit(subset))
+        return llvm::countr_zero(subset);
+      size_t lhs = emit(subset ^ splits[subset]);
+      size_t rhs = emit(splits[subset]);
+      path.push_back({lhs, rhs});
+      return numOperands + path.size() - 1;
+    };
+    emit(numSubsets - 1);
+    return path;
+  }
+
+  // Greedily contract the pair whose result has the most fewer elements than
+  // its operands, breaking ties by the fewest multiply-adds.
+  SmallVector<size_t> live = llvm::to_vector(llvm::seq<size_t>(0, numOperands));
+  while (live.size() > 1) {
+    std::optional<std::tuple<double, double, size_t, size_t>> best;
+    for (size_t i = 0; i < live.size(); ++i) {
+      for (size_t j = i + 1; j < live.size(); ++j) {
+        uint64_t othersMask = resultMask;
+        for (size_t k = 0; k < live.size(); ++k) {
+          if (k != i && k != j)
+            othersMask |= masks[live[k]];
+        }
+        uint64_t lhsMask = masks[live[i]], rhsMask = masks[live[j]];
+        double growth = getNumElements((lhsMask | rhsMask) & othersMask) -
+                        getNumElements(lhsMask) - getNumElements(rhsMask);
+        double flops = getNumElements(lhsMask | rhsMask);
+        if (!best || std::make_pair(growth, flops) <
+                         std::make_pair(std::get<0>(*best), std::get<1>(*best)))
+          best = {growth, flops, i, j};
+      }
+    }
+    auto [growth, flops, i, j] = *best;
+    uint64_t othersMask = resultMask;
+    for (size_t k = 0; k < live.size(); ++k) {
+      if (k != i && k != j)
+        othersMask |= masks[live[k]];
+    }
+    path.push_back({live[i], live[j]});
+    masks.push_back((masks[live[i]] | masks[live[j]]) & othersMask);
+    live.erase(live.begin() + j);
+    live.erase(live.begin() + i);
+    live.push_back(masks.size() - 1);
+  }
+  return path;
+}
+
+// Sums out the dims of `input` whose tokens are not in `keptTokens`, so that
+// they do not grow the intermediate results of an einsum.
+static Value
+sumOutUnusedEinsumDims(PatternRewriter &rewriter, Location loc, Value input,
+                       SmallVector<char> &tokens,
+                       const llvm::SmallDenseSet<char> &keptTokens) {
+  auto inputType = cast<BaseTensorType>(input.getType());
+  SmallVector<Value> sumDims;
+  SmallVector<int64_t> resultSizes;
+  SmallVector<char> resultTokens;
+  for (auto [i, token] : llvm::enumerate(tokens)) {
+    if (keptTokens.contains(token)) {
+      resultSizes.push_back(inputType.getSizes()[i]);
+      resultTokens.push_back(token);
+      continue;
+    }
+    sumDims.push_back(Torch::ConstantIntOp::create(
+        rewriter, loc, rewriter.getI64IntegerAttr(i)));
+  }
+  if (sumDims.empty())
+    return input;
+  Value sumDimsList = Torch::PrimListConstructOp::create(
+      rewriter, loc,
+      Torch::ListType::get(Torch::IntType::get(rewriter.getContext())),
+      sumDims);
+  Value cstFalse = Torch::ConstantBoolOp::create(rewriter, loc, false);
+  Value none = Torch::ConstantNoneOp::create(rewriter, loc);
+  tokens = resultTokens;
+  return Torch::AtenSumDimIntListOp::create(
+      rewriter, loc,
+      inputType.getWithSizesAndDtype(resultSizes,
+                                     inputType.getOptionalDtype()),
+      input, sumDimsList, cstFalse, none);
+}
+
 /*
  This function calculates the number of elements in the lower triangle (below
  the main diagonal) of a tensor with dimensions [row, col]. The main diagonal
@@ -2035,24 +2248,71 @@ public:
           op, "Unexpected character in equations encountered");
     }
 
-    SmallVector<char> lhsTokens = inputTokens[0];
-    Value lhs = inputTensors[0];
-    Value result;
+    // With three operands or more and static sizes, contract them in the
+    // cheapest order. Otherwise, contract them left to right.
+    size_t numOperands = inputTensors.size();
+    std::optional<SmallVector<EinsumContraction>> path;
+    llvm::SmallDenseMap<char, int64_t> tokenSizes;
+    bool allSizesKnown = llvm::all_of(inputTensors, [](Value tensor) {
+      return cast<BaseTensorType>(tensor.getType()).areAllSizesKnown();
+    });
+    if (numOperands > 2 && allSizesKnown) {
+      for (auto [tensor, tokens] : llvm::zip_equal(inputTensors, inputTokens)) {
+        auto sizes = cast<BaseTensorType>(tensor.getType()).getSizes();
+        for (auto [token, size] : llvm::zip_equal(tokens, sizes))
+          tokenSizes[token] = std::max(tokenSizes.lookup(token), size);
+      }
+      path = planEinsumContractions(inputTokens, resultTokens, tokenSizes);
+    }
+    if (!path) {
+      path.emplace();
+      for (size_t i = 1; i < numOperands; ++i)
+        path->push_back({i == 1 ? 0 : numOperands + i - 2, i});
+    } else {
+      // Dims used by a single operand and not by the result are summed out
+      // first, rather than carried through the contractions.
+      for (size_t i = 0; i < numOperands; ++i) {
+        llvm::SmallDenseSet<char> keptTokens(resultTokens.begin(),
+                                             resultTokens.end());
+        for (size_t j = 0; j < numOperands; ++j) {
+          if (j != i)
+            keptTokens.insert(inputTokens[j].begin(), inputTokens[j].end());
+        }
+        inputTensors[i] = sumOutUnusedEinsumDims(
+            rewriter, loc, inputTensors[i], inputTokens[i], keptTokens);
+      }
+    }
 
-    for (size_t i = 1; i < inputTensors.size(); ++i) {
-      auto rhs = inputTensors[i];
-      auto rhsTokens = inputTokens[i];
+    // Each contraction keeps the dims that the result or the operands left
+    // to contract use.
+    SmallVector<Value> nodes(inputTensors);
+    SmallVector<SmallVector<char>> nodeTokens(inputTokens);
+    llvm::SmallDenseSet<size_t> live;
+    for (size_t i = 0; i < numOperands; ++i)
+      live.insert(i);
+    for (EinsumContraction contraction : *path) {
+      live.erase(contraction.lhs);
+      live.erase(contraction.rhs);
+      SmallVector<char> keptTokens(resultTokens);
+      for (size_t node : live)
+        llvm::append_range(keptTokens, nodeTokens[node]);
+      Value result;
       SmallVector<char> outTokens;
-      if (failed(performMatmul(rewriter, loc, lhs, lhsTokens, rhs, rhsTokens,
-                               result, outTokens, resultTokens))) {
+      if (failed(performMatmul(rewriter, loc, nodes[contraction.lhs],
+                               nodeTokens[contraction.lhs],
+                               nodes[contraction.rhs],
+                               nodeTokens[contraction.rhs], result, outTokens,
+                               keptTokens))) {
         return failure();
       }
-      lhs = result;
-      lhsTokens = outTokens;
+      live.insert(nodes.size());
+      nodes.push_back(result);
+      nodeTokens.push_back(outTokens);
     }
 
-    result = performLastReduceAndPermute(rewriter, loc, op.getType(), lhs,
-                                         lhsTokens, resultTokens);
+    Value result = performLastReduceAndPermute(
+        rewriter, loc, op.getType(), nodes.back(), nodeTokens.back(),
+        resultTokens);
     rewriter.replaceOp(op, result);
     return success();
   }
@@ -5595,8 +5855,7 @@ public:
                   .convertToDouble()));
     }
 
-    auto compareType = outputType.getWithSizesAndDtype(
-        outputType.getOptionalSizes(), rewriter.getI1Type());
+    auto compareType = outputType.getWithDtype(rewriter.getI1Type());
     Value isNan =
         Torch::AtenIsnanOp::create(rewriter, loc, compareType, op.getSelf());
     Value where = Torch::AtenWhereScalarSelfOp::create(
@@ -6569,8 +6828,7 @@ class DecomposeAtenNonzeroOp : public OpRewritePattern<AtenNonzeroOp> {
     // nonzero_mask = nonzero_mask.int()
     Value falseCst = ConstantBoolOp::create(rewriter, loc, false);
     Value noneCst = ConstantNoneOp::create(rewriter, loc);
-    auto intMaskType = flattenedInputType.getWithSizesAndDtype(
-        flattenedInputType.getOptionalSizes(), intType);
+    auto intMaskType = flattenedInputType.getWithDtype(intType);
     Value intMask =
         AtenToDtypeOp::create(rewriter, loc, intMaskType, boolMask,
                               intTypeValue, falseCst, falseCst, noneCst);
@@ -9816,9 +10074,7 @@ class DecomposeAtenSignbitOp : public OpRewritePattern<AtenSignbitOp> {
           operandTy.getDtype().getIntOrFloatBitWidth(), /*isSigned*/ true);
       Value dtype = getDtypeIntValueForType(rewriter, loc, intType);
       Value view = AtenViewDtypeOp::create(
-          rewriter, loc,
-          operandTy.getWithSizesAndDtype(operandTy.getOptionalSizes(), intType),
-          self, dtype);
+          rewriter, loc, operandTy.getWithDtype(intType), self, dtype);
       Value zero =
           ConstantIntOp::create(rewriter, loc, rewriter.getI64IntegerAttr(0));
       Value shift = AtenLtScalarOp::create(rewriter, loc, resultTy, view, zero);
@@ -9870,10 +10126,7 @@ class DecomposeAtenCopysignTensorOp
     auto resultTy = op.getType();
 
     Value signbit = AtenSignbitOp::create(
-        rewriter, loc,
-        otherTy.getWithSizesAndDtype(otherTy.getOptionalSizes(),
-                                     rewriter.getI1Type()),
-        other);
+        rewriter, loc, otherTy.getWithDtype(rewriter.getI1Type()), other);
     Value abs = AtenAbsOp::create(rewriter, loc, selfTy, self);
     Value neg = AtenNegOp::create(rewriter, loc, selfTy, abs);
     rewriter.replaceOpWithNewOp<AtenWhereSelfOp>(op, resultTy, signbit, neg,
@@ -10100,48 +10353,73 @@ static LogicalResult calculateVariance(OpTy op, PatternRewriter &rewriter,
         Torch::ListType::get(Torch::IntType::get(op.getContext())),
         dimListElements);
   }
-  Type meanDimResultType = inputTensorTy;
-  for (unsigned i = 0; i < dimListElements.size(); i++)
-    meanDimResultType = computeReductionType(
-        rewriter, op, cast<BaseTensorType>(meanDimResultType),
-        dimListElements[i],
-        /*keepDim=*/true);
-
   Value constantNone = ConstantNoneOp::create(rewriter, loc);
-  Value constantTrue = ConstantBoolOp::create(rewriter, loc, true);
-  Value meanAlongDims = AtenMeanDimOp::create(
-      rewriter, loc, meanDimResultType, self, dimList, /*keepDim=*/constantTrue,
-      /*dtype=*/constantNone);
-  Value subMean =
-      createTensorSub(rewriter, loc, inputTensorTy, self, meanAlongDims);
-  Value square = AtenSquareOp::create(rewriter, loc, inputTensorTy, subMean);
-
-  if (!unbiased) {
-    Value result =
-        AtenMeanDimOp::create(rewriter, loc, newOutputType, square, dimList,
-                              keepDim, /*dtype=*/constantNone);
-    result = convertTensorToDtype(rewriter, loc, result,
-                                  outputTensorType.getDtype());
-    rewriter.replaceOp(op, result);
-    return success();
-  }
-  // Divide the square sum by productDimSize - correction.
-  Value squareSum =
-      AtenSumDimIntListOp::create(rewriter, loc, newOutputType, square, dimList,
-                                  keepDim, /*dtype=*/constantNone);
-
   // `productDimSize` is product of sizes of dimensions to be reduced.
-  Value constantOne = Torch::ConstantIntOp::create(
+  Value productDimSize = Torch::ConstantIntOp::create(
       rewriter, loc, rewriter.getI64IntegerAttr(1));
-  Value productDimSize = constantOne;
   for (Value dim : dimListElements) {
     Value dimSize = AtenSizeIntOp::create(rewriter, loc, self, dim);
     productDimSize =
         AtenMulIntOp::create(rewriter, loc, productDimSize, dimSize);
   }
   productDimSize = AtenFloatScalarOp::create(rewriter, loc, productDimSize);
-  constantOne = Torch::ConstantFloatOp::create(rewriter, loc,
-                                               rewriter.getF64FloatAttr(1.0));
+
+  // Inputs narrower than f64 are accumulated in f64, where the sum of
+  // squares minus the squared sum over N keeps enough precision. Both sums
+  // then read the input directly, in one pass without the full-size
+  // `x - mean` intermediate. f64 inputs keep the two-pass form below.
+  Value squareSum;
+  if (bitwidth != 64) {
+    Value sum =
+        AtenSumDimIntListOp::create(rewriter, loc, newOutputType, self,
+                                    dimList, keepDim, /*dtype=*/constantNone);
+    Value square = AtenSquareOp::create(rewriter, loc, inputTensorTy, self);
+    Value sumOfSquares =
+        AtenSumDimIntListOp::create(rewriter, loc, newOutputType, square,
+                                    dimList, keepDim, /*dtype=*/constantNone);
+    Value squaredSumOverSize = AtenDivScalarOp::create(
+        rewriter, loc, newOutputType,
+        AtenSquareOp::create(rewriter, loc, newOutputType, sum),
+        productDimSize);
+    // Rounding can leave a slightly negative difference for constant inputs.
+    Value cstZero = Torch::ConstantFloatOp::create(
+        rewriter, loc, rewriter.getF64FloatAttr(0.0));
+    squareSum = AtenClampMinOp::create(
+        rewriter, loc, newOutputType,
+        createTensorSub(rewriter, loc, newOutputType, sumOfSquares,
+                        squaredSumOverSize),
+        cstZero);
+  } else {
+    Type meanDimResultType = inputTensorTy;
+    for (unsigned i = 0; i < dimListElements.size(); i++)
+      meanDimResultType = computeReductionType(
+          rewriter, op, cast<BaseTensorType>(meanDimResultType),
+          dimListElements[i],
+          /*keepDim=*/true);
+
+    Value constantTrue = ConstantBoolOp::create(rewriter, loc, true);
+    Value meanAlongDims = AtenMeanDimOp::create(
+        rewriter, loc, meanDimResultType, self, dimList,
+        /*keepDim=*/constantTrue, /*dtype=*/constantNone);
+    Value subMean =
+        createTensorSub(rewriter, loc, inputTensorTy, self, meanAlongDims);
+    Value square = AtenSquareOp::create(rewriter, loc, inputTensorTy, subMean);
+    squareSum =
+        AtenSumDimIntListOp::create(rewriter, loc, newOutputType, square,
+                                    dimList, keepDim, /*dtype=*/constantNone);
+  }
+
+  if (!unbiased) {
+    Value result = AtenDivScalarOp::create(rewriter, loc, newOutputType,
+                                           squareSum, productDimSize);
+    result = convertTensorToDtype(rewriter, loc, result,
+                                  outputTensorType.getDtype());
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+  // Divide the square sum by productDimSize - correction.
+  Value constantOne = Torch::ConstantFloatOp::create(
+      rewriter, loc, rewriter.getF64FloatAttr(1.0));
   Value cstCorrection = Torch::ConstantFloatOp::create(
       rewriter, loc, rewriter.getF64FloatAttr(correction));
   // The `correction` value should be less than or equal to `productDimSize +
@@ -10166,12 +10444,12 @@ static LogicalResult calculateVariance(OpTy op, PatternRewriter &rewriter,
 }
 
 // Decompose aten.var(x, dims) into:
-// sub = aten.sub(x, aten.mean(x, dims))
-// square = aten.square(sub)
+// sub = aten.sumsq(x, dims) - aten.sum(x, dims)^2 / productDimSize
+// (aten.sum(aten.square(x - aten.mean(x, dims)), dims) for f64 inputs)
 // For Unbiased case:
-// out = aten.sum(square, dims) / (productDimSize-1)
+// out = sub / (productDimSize-1)
 // For Biased case:
-// out = aten.mean(square, dims)
+// out = sub / productDimSize
 namespace {
 class DecomposeAtenVarDimOp : public OpRewritePattern<AtenVarDimOp> {
 public:
@@ -10193,9 +10471,9 @@ public:
 } // namespace
 
 // Decompose aten.var(x, dims) into:
-// sub = aten.sub(x, aten.mean(x, dims))
-// square = aten.square(sub)
-// out = aten.sum(square, dims) / (productDimSize - correction)
+// sub = aten.sumsq(x, dims) - aten.sum(x, dims)^2 / productDimSize
+// (aten.sum(aten.square(x - aten.mean(x, dims)), dims) for f64 inputs)
+// out = sub / (productDimSize - correction)
 namespace {
 class DecomposeAtenVarCorrectionOp
     : public OpRewritePattern<AtenVarCorrectionOp> {
@@ -11655,9 +11933,7 @@ public:
     auto resultTy = cast<BaseTensorType>(op.getResult().getType());
     auto scalarTy = getBuiltInTypeForTorchScalar(op.getS().getType());
     Value numToTensor = PrimNumToTensorScalarOp::create(
-        rewriter, op.getLoc(),
-        resultTy.getWithSizesAndDtype(resultTy.getOptionalSizes(), scalarTy),
-        op.getS());
+        rewriter, op.getLoc(), resultTy.getWithDtype(scalarTy), op.getS());
 
     Value cstNone = ConstantNoneOp::create(rewriter, op.getLoc());
     Value cstFalse =
@@ -11695,8 +11971,7 @@ public:
     Value self = op.getSelf();
     Value dim = op.getDim();
     auto selfType = cast<BaseTensorType>(self.getType());
-    auto sortIndicesType = selfType.getWithSizesAndDtype(
-        selfType.getOptionalSizes(),
+    auto sortIndicesType = selfType.getWithDtype(
         IntegerType::get(context, 64, IntegerType::Signed));
     auto sortOpResult = AtenSortOp::create(rewriter, loc, self.getType(),
                                            sortIndicesType, self, dim,
@@ -11733,8 +12008,7 @@ public:
     Value dim = op.getDim();
     Value descending = op.getDescending();
     auto selfType = cast<BaseTensorType>(self.getType());
-    auto sortIndicesType = selfType.getWithSizesAndDtype(
-        selfType.getOptionalSizes(),
+    auto sortIndicesType = selfType.getWithDtype(
         IntegerType::get(context, 64, IntegerType::Signed));
     auto sortOpResult = AtenSortOp::create(
         rewriter, loc, self.getType(), sortIndicesType, self, dim, descending);
@@ -12045,8 +12319,7 @@ public:
     auto minusOne =
         ConstantIntOp::create(rewriter, loc, rewriter.getI64IntegerAttr(-1));
 
-    auto compTy = outType.getWithSizesAndDtype(outType.getOptionalSizes(),
-                                               rewriter.getI1Type());
+    auto compTy = outType.getWithDtype(rewriter.getI1Type());
 
     auto greater =
         AtenGtScalarOp::create(rewriter, loc, compTy, op.getSelf(), zero);
@@ -12848,8 +13121,7 @@ public:
     // Sort scores in descending order
     // Use the sorted indices to iterate boxes
     auto scoresType = dyn_cast<BaseTensorType>(scores.getType());
-    auto intTensorType = scoresType.getWithSizesAndDtype(
-        scoresType.getOptionalSizes(),
+    auto intTensorType = scoresType.getWithDtype(
         IntegerType::get(context, 64, IntegerType::Signed));
     auto sortResult = Torch::AtenSortOp::create(
         rewriter, loc, TypeRange({scores.getType(), intTensorType}), scores,
@@ -13268,14 +13540,29 @@ public:
 
 namespace {
 
+// Records the ops erased by patterns applied outside of a rewrite driver.
+struct ErasedOpsListener : public RewriterBase::Listener {
+  void notifyOperationErased(Operation *op) override { erasedOps.insert(op); }
+
+  llvm::DenseSet<Operation *> erasedOps;
+};
+
+// A rewriter for applying patterns outside of a rewrite driver.
+class DryRunRewriter : public PatternRewriter {
+public:
+  explicit DryRunRewriter(MLIRContext *context) : PatternRewriter(context) {}
+};
+
 class DecomposeComplexOpsPass
     : public impl::DecomposeComplexOpsBase<DecomposeComplexOpsPass> {
 private:
   llvm::StringSet<> legalOpsSet;
 
+  FrozenRewritePatternSet frozenPatterns;
+
   template <typename DecomposePattern>
   void addPatternIfTargetOpIsIllegal(RewritePatternSet &patterns) {
-    MLIRContext *context = &getContext();
+    MLIRContext *context = patterns.getContext();
     std::optional<OperationName> opName =
         DecomposePattern(context).getRootKind();
     // Because the `DecomposeComplexOpsPass` uses a greedy algorithm
@@ -13289,18 +13576,7 @@ private:
       patterns.add<DecomposePattern>(context);
   }
 
-public:
-  using impl::DecomposeComplexOpsBase<
-      DecomposeComplexOpsPass>::DecomposeComplexOpsBase;
-  void runOnOperation() override {
-    MLIRContext *context = &getContext();
-    RewritePatternSet patterns(context);
-    // The strings in the `legalOps` ArrayRef don't exist during the call to the
-    // constructor `DecomposeComplexOpsPass`, so the creation of the
-    // `legalOpsSet` must be delayed to when `runOnOperation` gets called.
-    legalOpsSet.clear();
-    legalOpsSet.insert(legalOps.begin(), legalOps.end());
-
+  void populateDecompositionPatterns(RewritePatternSet &patterns) {
     addPatternIfTargetOpIsIllegal<DecomposeAtenScaledDotProductAttentionOp>(
         patterns);
 
@@ -13603,12 +13879,104 @@ public:
     addPatternIfTargetOpIsIllegal<DecomposeAten_AssertScalarOp>(patterns);
     addPatternIfTargetOpIsIllegal<DecomposeAtenRoundDecimalsOp>(patterns);
     addPatternIfTargetOpIsIllegal<DecomposeAtenAbsoluteOp>(patterns);
+  }
+
+public:
+  using impl::DecomposeComplexOpsBase<
+      DecomposeComplexOpsPass>::DecomposeComplexOpsBase;
+
+  LogicalResult initialize(MLIRContext *context) override {
+    // The strings in the `legalOps` ArrayRef don't exist during the call to the
+    // constructor `DecomposeComplexOpsPass`, so the creation of the
+    // `legalOpsSet` must be delayed to when `initialize` gets called.
+    legalOpsSet.clear();
+    legalOpsSet.insert(legalOps.begin(), legalOps.end());
+
+    // Building and freezing the several hundred patterns below is expensive,
+    // so the frozen set is cached in the context for each distinct set of
+    // legal ops and shared by all instances of this pass.
+    SmallVector<StringRef> sortedLegalOps(legalOpsSet.keys());
+    llvm::sort(sortedLegalOps);
+    std::string key =
+        (getArgument() + ":" + llvm::join(sortedLegalOps, ",")).str();
+    auto *dialect = context->getOrLoadDialect<TorchDialect>();
+    auto *cached = dialect->getOrCreateCached<FrozenRewritePatternSet>(
+        key, [&]() {
+          RewritePatternSet patterns(context);
+          populateDecompositionPatterns(patterns);
+          return std::make_unique<FrozenRewritePatternSet>(std::move(patterns));
+        });
+    // Copying a frozen pattern set only shares its underlying storage.
+    frozenPatterns = *cached;
+    return success();
+  }
+
+  // Applies the patterns once to each op of a copy of the function and reports
+  // how many times each pattern was attempted and how many times it succeeded.
+  // The function itself is left unchanged.
+  void reportMatchAttempts() {
+    func::FuncOp func = getOperation();
+    OwningOpRef<func::FuncOp> copy = func.clone();
+    SmallVector<Operation *> ops;
+    copy->walk<WalkOrder::PreOrder>([&](Operation *op) {
+      if (op != copy->getOperation())
+        ops.push_back(op);
+    });
+
+    struct PatternCounts {
+      int64_t attempts = 0;
+      int64_t successes = 0;
+    };
+    llvm::MapVector<const Pattern *, PatternCounts> counts;
+    int64_t totalAttempts = 0;
+    PatternApplicator applicator(frozenPatterns);
+    applicator.applyDefaultCostModel();
+    ErasedOpsListener listener;
+    DryRunRewriter rewriter(&getContext());
+    rewriter.setListener(&listener);
+    for (Operation *op : ops) {
+      if (listener.erasedOps.contains(op))
+        continue;
+      rewriter.setInsertionPoint(op);
+      (void)applicator.matchAndRewrite(
+          op, rewriter,
+          /*canApply=*/
+          [&](const Pattern &pattern) {
+            ++counts[&pattern].attempts;
+            ++totalAttempts;
+            return true;
+          },
+          /*onFailure=*/{},
+          /*onSuccess=*/
+          [&](const Pattern &pattern) {
+            ++counts[&pattern].successes;
+            return success();
+          });
+    }
+
+    InFlightDiagnostic remark = func.emitRemark()
+                                << "decomposition dry run: " << totalAttempts
+                                << " match attempts on " << ops.size()
+                                << " ops";
+    for (auto &[pattern, patternCounts] : counts) {
+      StringRef name = pattern->getDebugName();
+      name.consume_front("(anonymous namespace)::");
+      name.consume_front("{anonymous}::");
+      remark.attachNote() << name << ": " << patternCounts.attempts
+                          << " attempts, " << patternCounts.successes
+                          << " successes";
+    }
+  }
+
+  void runOnOperation() override {
+    if (dryRun)
+      return reportMatchAttempts();
 
     GreedyRewriteConfig config;
     config.setUseTopDownTraversal(true);
     config.setMaxIterations(GreedyRewriteConfig::kNoLimit);
 
-    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns),
+    if (failed(applyPatternsGreedily(getOperation(), frozenPatterns,
                                      config))) {
       return signalPassFailure();
     }
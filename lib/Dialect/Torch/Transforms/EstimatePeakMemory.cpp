@@ -0,0 +1,215 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/FileUtilities.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ToolOutputFile.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_ESTIMATEPEAKMEMORY
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+// The number of the largest buffers live at the peak that are reported.
+static constexpr int64_t kMaxReportedBuffers = 10;
+
+namespace {
+enum class BufferKind { Weight, Activation, Temporary };
+
+// A tensor and its aliases, live from the op at `begin` to the op at `end`
+// of the block, both included.
+struct LiveBuffer {
+  Value value;
+  BufferKind kind;
+  int64_t begin;
+  int64_t end;
+  std::optional<int64_t> bytes;
+};
+} // namespace
+
+static StringRef getKindName(BufferKind kind) {
+  switch (kind) {
+  case BufferKind::Weight:
+    return "weights";
+  case BufferKind::Activation:
+    return "activations";
+  case BufferKind::Temporary:
+    return "temporaries";
+  }
+  llvm_unreachable("unknown buffer kind");
+}
+
+static std::string printLoc(Location loc) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  loc.print(os);
+  return str;
+}
+
+// The peak live bytes of the single block of `func`.
+static llvm::json::Object estimatePeakMemory(func::FuncOp func) {
+  Block &block = func.getBody().front();
+  DenseMap<Operation *, int64_t> indices;
+  for (auto [i, op] : llvm::enumerate(block))
+    indices[&op] = i;
+  int64_t last = block.getOperations().size() - 1;
+
+  // The buffers by the value that defines them, and the buffer of each
+  // tensor.
+  llvm::MapVector<Value, LiveBuffer> buffers;
+  DenseMap<Value, Value> roots;
+  llvm::StringMap<Value> globalSlots;
+  auto addBuffer = [&](Value value, BufferKind kind, int64_t begin,
+                       int64_t end) {
+    buffers[value] = {value, kind, begin, end, getTensorStaticBytes(value)};
+    roots[value] = value;
+  };
+  for (BlockArgument arg : block.getArguments()) {
+    if (isa<BaseTensorType>(arg.getType()))
+      addBuffer(arg, BufferKind::Activation, 0, 0);
+  }
+  for (Operation &op : block) {
+    int64_t index = indices.lookup(&op);
+    for (Value result : op.getResults()) {
+      if (!isa<BaseTensorType>(result.getType()))
+        continue;
+      if (isa<ValueTensorLiteralOp, NonValueTensorLiteralOp>(op)) {
+        addBuffer(result, BufferKind::Weight, 0, last);
+      } else if (auto get = dyn_cast<GlobalSlotGetOp>(op)) {
+        auto [it, inserted] = globalSlots.try_emplace(get.getSlot(), result);
+        if (inserted)
+          addBuffer(result, BufferKind::Weight, 0, last);
+        else
+          roots[result] = roots.lookup(it->second);
+      } else if (getOpCostClass(&op) == "view" && op.getNumOperands() != 0 &&
+                 roots.contains(op.getOperand(0))) {
+        roots[result] = roots.lookup(op.getOperand(0));
+      } else {
+        addBuffer(result, BufferKind::Temporary, index, index);
+      }
+    }
+  }
+
+  // A buffer lives until the last use of any of its aliases, anywhere in the
+  // ops of the block, and is an activation if the function returns it.
+  Operation *terminator = block.getTerminator();
+  for (auto [value, root] : roots) {
+    LiveBuffer &buffer = buffers.find(root)->second;
+    for (Operation *user : value.getUsers()) {
+      Operation *ancestor = block.findAncestorOpInBlock(*user);
+      if (!ancestor)
+        continue;
+      buffer.end = std::max(buffer.end, indices.lookup(ancestor));
+      if (ancestor == terminator && buffer.kind == BufferKind::Temporary)
+        buffer.kind = BufferKind::Activation;
+    }
+  }
+
+  // The first op at which the most bytes are live.
+  SmallVector<int64_t> deltas(last + 2, 0);
+  int64_t unknownSizes = 0;
+  for (const LiveBuffer &buffer : llvm::make_second_range(buffers)) {
+    if (!buffer.bytes) {
+      ++unknownSizes;
+      continue;
+    }
+    deltas[buffer.begin] += *buffer.bytes;
+    deltas[buffer.end + 1] -= *buffer.bytes;
+  }
+  int64_t peak = 0, peakBytes = 0, liveBytes = 0;
+  for (int64_t i = 0; i <= last; ++i) {
+    liveBytes += deltas[i];
+    if (liveBytes > peakBytes) {
+      peak = i;
+      peakBytes = liveBytes;
+    }
+  }
+
+  SmallVector<const LiveBuffer *> live;
+  std::array<int64_t, 3> kindBytes = {0, 0, 0};
+  for (const LiveBuffer &buffer : llvm::make_second_range(buffers)) {
+    if (buffer.bytes && buffer.begin <= peak && peak <= buffer.end) {
+      live.push_back(&buffer);
+      kindBytes[static_cast<int>(buffer.kind)] += *buffer.bytes;
+    }
+  }
+  llvm::stable_sort(live, [](const LiveBuffer *a, const LiveBuffer *b) {
+    return *a->bytes > *b->bytes;
+  });
+  llvm::json::Array liveAtPeak;
+  for (const LiveBuffer *buffer :
+       ArrayRef(live).take_front(kMaxReportedBuffers)) {
+    Operation *def = buffer->value.getDefiningOp();
+    liveAtPeak.push_back(llvm::json::Object{
+        {"op", def ? def->getName().getStringRef() : StringRef("argument")},
+        {"loc", printLoc(buffer->value.getLoc())},
+        {"kind", getKindName(buffer->kind)},
+        {"bytes", *buffer->bytes}});
+  }
+
+  Operation *peakOp = &*std::next(block.begin(), peak);
+  llvm::json::Object record{
+      {"peak_bytes", peakBytes},
+      {"peak_op", llvm::json::Object{{"op", peakOp->getName().getStringRef()},
+                                     {"loc", printLoc(peakOp->getLoc())}}},
+      {"live_at_peak", std::move(liveAtPeak)},
+      {"unknown_sizes", unknownSizes}};
+  for (BufferKind kind : {BufferKind::Weight, BufferKind::Activation,
+                          BufferKind::Temporary})
+    record[getKindName(kind)] = kindBytes[static_cast<int>(kind)];
+  return record;
+}
+
+namespace {
+class EstimatePeakMemoryPass
+    : public impl::EstimatePeakMemoryBase<EstimatePeakMemoryPass> {
+public:
+  using impl::EstimatePeakMemoryBase<
+      EstimatePeakMemoryPass>::EstimatePeakMemoryBase;
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    llvm::json::Object functions;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (!func.isDeclaration() && func.getBody().hasOneBlock())
+        functions[func.getName()] = estimatePeakMemory(func);
+    }
+
+    std::string errorMessage;
+    std::unique_ptr<llvm::ToolOutputFile> output =
+        openOutputFile(outputFile, &errorMessage);
+    if (!output) {
+      module.emitError() << "could not open peak memory file '" << outputFile
+                         << "': " << errorMessage;
+      return signalPassFailure();
+    }
+    llvm::json::Value report =
+        llvm::json::Object{{"functions", std::move(functions)}};
+    output->os() << llvm::formatv("{0:2}", report) << "\n";
+    output->keep();
+    markAllAnalysesPreserved();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createEstimatePeakMemoryPass() {
+  return std::make_unique<EstimatePeakMemoryPass>();
+}
+
+} // namespace mlir::torch::Torch
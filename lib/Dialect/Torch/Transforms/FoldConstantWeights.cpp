@@ -0,0 +1,517 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FoldWeightsUtils.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_FOLDCONSTANTWEIGHTS
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+// Reads element `i` of `data`, of the integer type `type`, as an int64_t.
+static int64_t readInt(const char *data, int64_t i, Type type) {
+  auto intType = cast<IntegerType>(type);
+  unsigned width = intType.getWidth();
+  uint64_t bits = 0;
+  std::memcpy(&bits, data + i * (width / 8), width / 8);
+  APInt value(width, bits);
+  return intType.isUnsigned() ? value.getZExtValue() : value.getSExtValue();
+}
+
+// Writes `value` truncated to the integer type `type` to element `i` of
+// `data`.
+static void writeInt(char *data, int64_t i, Type type, int64_t value) {
+  unsigned width = cast<IntegerType>(type).getWidth();
+  uint64_t bits = APInt(64, value).trunc(width).getZExtValue();
+  std::memcpy(data + i * (width / 8), &bits, width / 8);
+}
+
+// Matches a constant `!torch.float` or `!torch.int`.
+static bool matchConstantNumber(Value value, double &number) {
+  int64_t intNumber;
+  if (matchPattern(value, m_TorchConstantFloat(&number)))
+    return true;
+  if (!matchPattern(value, m_TorchConstantInt(&intNumber)))
+    return false;
+  number = intNumber;
+  return true;
+}
+
+namespace {
+// A float or integer kernel, which maps the elements of the operands at an
+// index to the element of the result.
+struct ElementwiseKernel {
+  SmallVector<Value> operands;
+  std::function<double(ArrayRef<double>)> floatFn;
+  std::function<int64_t(ArrayRef<int64_t>)> intFn;
+};
+
+// An operand of an elementwise op being folded: either a weight with the
+// shape of the result, or a scalar that is broadcast to it.
+struct ElementwiseOperand {
+  const char *data = nullptr;
+  Type elementType;
+  double floatScalar = 0.0;
+  int64_t intScalar = 0;
+  // The number of elements that folding frees when the operand is a weight
+  // without other users.
+  int64_t numFreedElements = 0;
+
+  double getFloat(int64_t i) const {
+    return data ? readFloat(data, i, elementType) : floatScalar;
+  }
+  int64_t getInt(int64_t i) const {
+    return data ? readInt(data, i, elementType) : intScalar;
+  }
+};
+} // namespace
+
+// Matches `value` as an operand of an elementwise op with a result of type
+// `resultType`, which has a dtype that its tensor operands are expected to
+// have.
+static std::optional<ElementwiseOperand>
+matchElementwiseOperand(Value value, ValueTensorType resultType) {
+  ElementwiseOperand operand;
+  bool isFloat = isa<mlir::FloatType>(resultType.getDtype());
+  if (isFloat && matchConstantNumber(value, operand.floatScalar))
+    return operand;
+  if (!isFloat && matchPattern(value, m_TorchConstantInt(&operand.intScalar)))
+    return operand;
+
+  auto literal = value.getDefiningOp<ValueTensorLiteralOp>();
+  if (!literal || literal.getType().getDtype() != resultType.getDtype())
+    return std::nullopt;
+  if (auto dense = dyn_cast<DenseElementsAttr>(literal.getValue());
+      dense && dense.isSplat()) {
+    if (isFloat)
+      operand.floatScalar =
+          dense.getSplatValue<APFloat>().convertToDouble();
+    else
+      operand.intScalar = dense.getSplatValue<APInt>().getSExtValue();
+    return operand;
+  }
+
+  std::optional<Weight> weight =
+      matchWeight(value, /*requireOneUse=*/false);
+  if (!weight)
+    return std::nullopt;
+  operand.elementType = weight->getType().getElementType();
+  if (weight->getType().getNumElements() == 1) {
+    operand.floatScalar = isFloat ? readFloat(weight->data.data(), 0,
+                                              operand.elementType)
+                                  : 0.0;
+    operand.intScalar =
+        isFloat ? 0 : readInt(weight->data.data(), 0, operand.elementType);
+    return operand;
+  }
+  if (weight->getType().getShape() != resultType.getSizes())
+    return std::nullopt;
+  operand.data = weight->data.data();
+  if (literal->hasOneUse())
+    operand.numFreedElements = weight->getType().getNumElements();
+  return operand;
+}
+
+// The kernel of `op`, if it is an elementwise op that is folded.
+static std::optional<ElementwiseKernel> getElementwiseKernel(Operation *op) {
+  ElementwiseKernel kernel;
+  auto unary = [&](Value self, std::function<double(double)> floatFn,
+                   std::function<int64_t(int64_t)> intFn = nullptr) {
+    kernel.operands = {self};
+    kernel.floatFn = [=](ArrayRef<double> args) { return floatFn(args[0]); };
+    if (intFn)
+      kernel.intFn = [=](ArrayRef<int64_t> args) { return intFn(args[0]); };
+    return kernel;
+  };
+  auto binary = [&](Value self, Value other,
+                    std::function<double(double, double)> floatFn,
+                    std::function<int64_t(int64_t, int64_t)> intFn = nullptr) {
+    kernel.operands = {self, other};
+    kernel.floatFn = [=](ArrayRef<double> args) {
+      return floatFn(args[0], args[1]);
+    };
+    if (intFn)
+      kernel.intFn = [=](ArrayRef<int64_t> args) {
+        return intFn(args[0], args[1]);
+      };
+    return kernel;
+  };
+  // `self + alpha * other` for `add` and `self - alpha * other` for `sub`.
+  auto addOrSub = [&](Value self, Value other, Value alphaValue,
+                      double sign) -> std::optional<ElementwiseKernel> {
+    double alpha;
+    if (!matchConstantNumber(alphaValue, alpha))
+      return std::nullopt;
+    int64_t intAlpha = static_cast<int64_t>(sign * alpha);
+    if (alpha != std::trunc(alpha))
+      return binary(self, other, [=](double a, double b) {
+        return a + sign * alpha * b;
+      });
+    return binary(
+        self, other, [=](double a, double b) { return a + sign * alpha * b; },
+        [=](int64_t a, int64_t b) { return a + intAlpha * b; });
+  };
+
+  if (auto neg = dyn_cast<AtenNegOp>(op))
+    return unary(
+        neg.getSelf(), [](double a) { return -a; },
+        [](int64_t a) { return -a; });
+  if (auto abs = dyn_cast<AtenAbsOp>(op))
+    return unary(
+        abs.getSelf(), [](double a) { return std::fabs(a); },
+        [](int64_t a) { return a < 0 ? -a : a; });
+  if (auto relu = dyn_cast<AtenReluOp>(op))
+    return unary(
+        relu.getSelf(), [](double a) { return a > 0.0 ? a : 0.0; },
+        [](int64_t a) { return a > 0 ? a : 0; });
+  if (auto sqrt = dyn_cast<AtenSqrtOp>(op))
+    return unary(sqrt.getSelf(), [](double a) { return std::sqrt(a); });
+  if (auto rsqrt = dyn_cast<AtenRsqrtOp>(op))
+    return unary(rsqrt.getSelf(),
+                 [](double a) { return 1.0 / std::sqrt(a); });
+  if (auto reciprocal = dyn_cast<AtenReciprocalOp>(op))
+    return unary(reciprocal.getSelf(), [](double a) { return 1.0 / a; });
+  if (auto exp = dyn_cast<AtenExpOp>(op))
+    return unary(exp.getSelf(), [](double a) { return std::exp(a); });
+  if (auto log = dyn_cast<AtenLogOp>(op))
+    return unary(log.getSelf(), [](double a) { return std::log(a); });
+  if (auto tanh = dyn_cast<AtenTanhOp>(op))
+    return unary(tanh.getSelf(), [](double a) { return std::tanh(a); });
+  if (auto sigmoid = dyn_cast<AtenSigmoidOp>(op))
+    return unary(sigmoid.getSelf(),
+                 [](double a) { return 1.0 / (1.0 + std::exp(-a)); });
+  if (auto pow = dyn_cast<AtenPowTensorScalarOp>(op)) {
+    double exponent;
+    if (!matchConstantNumber(pow.getExponent(), exponent))
+      return std::nullopt;
+    return unary(pow.getSelf(),
+                 [=](double a) { return std::pow(a, exponent); });
+  }
+  if (auto clamp = dyn_cast<AtenClampOp>(op)) {
+    double min = -INFINITY, max = INFINITY;
+    if ((!isa<Torch::NoneType>(clamp.getMin().getType()) &&
+         !matchConstantNumber(clamp.getMin(), min)) ||
+        (!isa<Torch::NoneType>(clamp.getMax().getType()) &&
+         !matchConstantNumber(clamp.getMax(), max)))
+      return std::nullopt;
+    return unary(clamp.getSelf(), [=](double a) {
+      return std::isnan(a) ? a : std::min(std::max(a, min), max);
+    });
+  }
+
+  if (auto add = dyn_cast<AtenAddTensorOp>(op))
+    return addOrSub(add.getSelf(), add.getOther(), add.getAlpha(), 1.0);
+  if (auto add = dyn_cast<AtenAddScalarOp>(op))
+    return addOrSub(add.getSelf(), add.getOther(), add.getAlpha(), 1.0);
+  if (auto sub = dyn_cast<AtenSubTensorOp>(op))
+    return addOrSub(sub.getSelf(), sub.getOther(), sub.getAlpha(), -1.0);
+  if (auto sub = dyn_cast<AtenSubScalarOp>(op))
+    return addOrSub(sub.getSelf(), sub.getOther(), sub.getAlpha(), -1.0);
+  auto mul = [](double a, double b) { return a * b; };
+  auto intMul = [](int64_t a, int64_t b) { return a * b; };
+  if (auto mulOp = dyn_cast<AtenMulTensorOp>(op))
+    return binary(mulOp.getSelf(), mulOp.getOther(), mul, intMul);
+  if (auto mulOp = dyn_cast<AtenMulScalarOp>(op))
+    return binary(mulOp.getSelf(), mulOp.getOther(), mul, intMul);
+  auto div = [](double a, double b) { return a / b; };
+  if (auto divOp = dyn_cast<AtenDivTensorOp>(op))
+    return binary(divOp.getSelf(), divOp.getOther(), div);
+  if (auto divOp = dyn_cast<AtenDivScalarOp>(op))
+    return binary(divOp.getSelf(), divOp.getOther(), div);
+  if (auto maximum = dyn_cast<AtenMaximumOp>(op))
+    return binary(
+        maximum.getSelf(), maximum.getOther(),
+        [](double a, double b) {
+          return std::isnan(a) || std::isnan(b) ? NAN : std::max(a, b);
+        },
+        [](int64_t a, int64_t b) { return std::max(a, b); });
+  if (auto minimum = dyn_cast<AtenMinimumOp>(op))
+    return binary(
+        minimum.getSelf(), minimum.getOther(),
+        [](double a, double b) {
+          return std::isnan(a) || std::isnan(b) ? NAN : std::min(a, b);
+        },
+        [](int64_t a, int64_t b) { return std::min(a, b); });
+  return std::nullopt;
+}
+
+// Whether a fold that writes `numElements` new elements and frees
+// `numFreedElements` is within the size policy of the pass: results above
+// `maxElements` are only folded when they do not grow the module.
+static bool isWithinSizeLimit(int64_t numElements, int64_t numFreedElements,
+                              int64_t maxElements) {
+  return numElements <= maxElements || numElements <= numFreedElements;
+}
+
+namespace {
+// Evaluates an elementwise op of weights and scalars into a new weight.
+template <typename OpTy>
+class FoldElementwiseOfWeights : public OpRewritePattern<OpTy> {
+public:
+  FoldElementwiseOfWeights(MLIRContext *context, int64_t maxElements)
+      : OpRewritePattern<OpTy>(context), maxElements(maxElements) {}
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    auto resultType = dyn_cast<ValueTensorType>(op.getType());
+    if (!resultType || !resultType.hasDtype() ||
+        !resultType.areAllSizesKnown())
+      return rewriter.notifyMatchFailure(op, "unknown result type");
+    std::optional<ElementwiseKernel> kernel = getElementwiseKernel(op);
+    if (!kernel)
+      return rewriter.notifyMatchFailure(op, "no kernel");
+
+    // The result takes the element type of the first weight operand, so that
+    // integer weights keep their signedness.
+    SmallVector<ElementwiseOperand> operands;
+    const ElementwiseOperand *first = nullptr;
+    Value firstValue;
+    int64_t numFreedElements = 0;
+    for (Value value : kernel->operands) {
+      std::optional<ElementwiseOperand> operand =
+          matchElementwiseOperand(value, resultType);
+      if (!operand)
+        return rewriter.notifyMatchFailure(op, "non-constant operand");
+      operands.push_back(*operand);
+      numFreedElements += operand->numFreedElements;
+    }
+    for (auto [operand, value] : llvm::zip_equal(operands, kernel->operands)) {
+      if (operand.data) {
+        first = &operand;
+        firstValue = value;
+        break;
+      }
+    }
+    if (!first)
+      return rewriter.notifyMatchFailure(op, "no weight operand");
+
+    Type elementType = first->elementType;
+    bool isFloat = isa<mlir::FloatType>(elementType);
+    if ((isFloat && !kernel->floatFn) || (!isFloat && !kernel->intFn))
+      return rewriter.notifyMatchFailure(op, "no kernel for the dtype");
+    auto outType = RankedTensorType::get(resultType.getSizes(), elementType);
+    if (!isWithinSizeLimit(outType.getNumElements(), numFreedElements,
+                           maxElements))
+      return rewriter.notifyMatchFailure(op, "result is too large");
+
+    std::optional<Weight> source =
+        matchWeight(firstValue, /*requireOneUse=*/false);
+    ElementsAttr folded = createWeight(
+        this->getContext(), *source, outType, "_folded",
+        [&](char *out, int64_t begin, int64_t end) {
+          SmallVector<double> floatArgs(operands.size());
+          SmallVector<int64_t> intArgs(operands.size());
+          for (int64_t i = begin; i < end; ++i) {
+            if (isFloat) {
+              for (auto [arg, operand] : llvm::zip_equal(floatArgs, operands))
+                arg = operand.getFloat(i);
+              writeFloat(out, i, elementType, kernel->floatFn(floatArgs));
+              continue;
+            }
+            for (auto [arg, operand] : llvm::zip_equal(intArgs, operands))
+              arg = operand.getInt(i);
+            writeInt(out, i, elementType, kernel->intFn(intArgs));
+          }
+        });
+    rewriter.replaceOpWithNewOp<ValueTensorLiteralOp>(op, folded);
+    return success();
+  }
+
+private:
+  int64_t maxElements;
+};
+} // namespace
+
+namespace {
+// Evaluates a dtype cast of a weight into a new weight. Floats are cast to
+// integers by rounding towards zero, as in PyTorch.
+template <typename OpTy>
+class FoldCastOfWeight : public OpRewritePattern<OpTy> {
+public:
+  FoldCastOfWeight(MLIRContext *context, int64_t maxElements)
+      : OpRewritePattern<OpTy>(context), maxElements(maxElements) {}
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    Value self = op->getOperand(0);
+    std::optional<Weight> weight = matchWeight(self, /*requireOneUse=*/false);
+    auto resultType = dyn_cast<ValueTensorType>(op.getType());
+    if (!weight || !resultType || !resultType.hasDtype())
+      return rewriter.notifyMatchFailure(op, "not a cast of a weight");
+    Type inType = weight->getType().getElementType();
+    Type outElementType = resultType.getDtype();
+    if (!isa<mlir::FloatType, IntegerType>(outElementType) ||
+        outElementType.getIntOrFloatBitWidth() % 8 != 0)
+      return rewriter.notifyMatchFailure(op, "unsupported dtype");
+    auto outType =
+        RankedTensorType::get(weight->getType().getShape(), outElementType);
+    int64_t numFreedElements = self.hasOneUse() ? outType.getNumElements() : 0;
+    if (!isWithinSizeLimit(outType.getNumElements(), numFreedElements,
+                           maxElements))
+      return rewriter.notifyMatchFailure(op, "result is too large");
+
+    bool isFloatIn = isa<mlir::FloatType>(inType);
+    bool isFloatOut = isa<mlir::FloatType>(outElementType);
+    const char *in = weight->data.data();
+    ElementsAttr folded = createWeight(
+        this->getContext(), *weight, outType, "_cast",
+        [&](char *out, int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            if (isFloatIn && isFloatOut) {
+              writeFloat(out, i, outElementType, readFloat(in, i, inType));
+            } else if (isFloatIn) {
+              double value = std::trunc(readFloat(in, i, inType));
+              writeInt(out, i, outElementType,
+                       std::isnan(value) ? 0 : static_cast<int64_t>(value));
+            } else if (isFloatOut) {
+              writeFloat(out, i, outElementType,
+                         static_cast<double>(readInt(in, i, inType)));
+            } else {
+              writeInt(out, i, outElementType, readInt(in, i, inType));
+            }
+          }
+        });
+    rewriter.replaceOpWithNewOp<ValueTensorLiteralOp>(op, folded);
+    return success();
+  }
+
+private:
+  int64_t maxElements;
+};
+} // namespace
+
+namespace {
+// Evaluates `mm` of two weights into a new weight when it takes at most
+// `maxMatmulMacs` multiply-accumulates.
+class FoldMmOfWeights : public OpRewritePattern<AtenMmOp> {
+public:
+  FoldMmOfWeights(MLIRContext *context, int64_t maxElements,
+                  int64_t maxMatmulMacs)
+      : OpRewritePattern<AtenMmOp>(context), maxElements(maxElements),
+        maxMatmulMacs(maxMatmulMacs) {}
+  LogicalResult matchAndRewrite(AtenMmOp op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<Weight> lhs =
+        matchWeight(op.getSelf(), /*requireOneUse=*/false);
+    std::optional<Weight> rhs =
+        matchWeight(op.getMat2(), /*requireOneUse=*/false);
+    auto resultType = dyn_cast<ValueTensorType>(op.getType());
+    if (!lhs || !rhs || !resultType || !resultType.hasDtype() ||
+        lhs->getType().getElementType() != rhs->getType().getElementType() ||
+        lhs->getType().getRank() != 2 || rhs->getType().getRank() != 2)
+      return rewriter.notifyMatchFailure(op, "not a mm of weights");
+    Type elementType = lhs->getType().getElementType();
+    int64_t m = lhs->getType().getDimSize(0);
+    int64_t k = lhs->getType().getDimSize(1);
+    int64_t n = rhs->getType().getDimSize(1);
+    if (rhs->getType().getDimSize(0) != k)
+      return rewriter.notifyMatchFailure(op, "mismatching shapes");
+    if (m * n * k > maxMatmulMacs)
+      return rewriter.notifyMatchFailure(op, "too many multiply-accumulates");
+    int64_t numFreedElements =
+        (op.getSelf().hasOneUse() ? m * k : 0) +
+        (op.getMat2().hasOneUse() ? k * n : 0);
+    if (!isWithinSizeLimit(m * n, numFreedElements, maxElements))
+      return rewriter.notifyMatchFailure(op, "result is too large");
+
+    bool isFloat = isa<mlir::FloatType>(elementType);
+    const char *lhsData = lhs->data.data();
+    const char *rhsData = rhs->data.data();
+    auto outType = RankedTensorType::get({m, n}, elementType);
+    ElementsAttr folded = createWeight(
+        getContext(), *lhs, outType, "_folded",
+        [&](char *out, int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            int64_t row = i / n, col = i % n;
+            if (isFloat) {
+              double sum = 0.0;
+              for (int64_t j = 0; j < k; ++j)
+                sum += readFloat(lhsData, row * k + j, elementType) *
+                       readFloat(rhsData, j * n + col, elementType);
+              writeFloat(out, i, elementType, sum);
+              continue;
+            }
+            int64_t sum = 0;
+            for (int64_t j = 0; j < k; ++j)
+              sum += readInt(lhsData, row * k + j, elementType) *
+                     readInt(rhsData, j * n + col, elementType);
+            writeInt(out, i, elementType, sum);
+          }
+        });
+    rewriter.replaceOpWithNewOp<ValueTensorLiteralOp>(op, folded);
+    return success();
+  }
+
+private:
+  int64_t maxElements;
+  int64_t maxMatmulMacs;
+};
+} // namespace
+
+namespace {
+class FoldConstantWeightsPass
+    : public impl::FoldConstantWeightsBase<FoldConstantWeightsPass> {
+public:
+  using impl::FoldConstantWeightsBase<
+      FoldConstantWeightsPass>::FoldConstantWeightsBase;
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<FoldElementwiseOfWeights<AtenNegOp>,
+                 FoldElementwiseOfWeights<AtenAbsOp>,
+                 FoldElementwiseOfWeights<AtenReluOp>,
+                 FoldElementwiseOfWeights<AtenSqrtOp>,
+                 FoldElementwiseOfWeights<AtenRsqrtOp>,
+                 FoldElementwiseOfWeights<AtenReciprocalOp>,
+                 FoldElementwiseOfWeights<AtenExpOp>,
+                 FoldElementwiseOfWeights<AtenLogOp>,
+                 FoldElementwiseOfWeights<AtenTanhOp>,
+                 FoldElementwiseOfWeights<AtenSigmoidOp>,
+                 FoldElementwiseOfWeights<AtenPowTensorScalarOp>,
+                 FoldElementwiseOfWeights<AtenClampOp>,
+                 FoldElementwiseOfWeights<AtenAddTensorOp>,
+                 FoldElementwiseOfWeights<AtenAddScalarOp>,
+                 FoldElementwiseOfWeights<AtenSubTensorOp>,
+                 FoldElementwiseOfWeights<AtenSubScalarOp>,
+                 FoldElementwiseOfWeights<AtenMulTensorOp>,
+                 FoldElementwiseOfWeights<AtenMulScalarOp>,
+                 FoldElementwiseOfWeights<AtenDivTensorOp>,
+                 FoldElementwiseOfWeights<AtenDivScalarOp>,
+                 FoldElementwiseOfWeights<AtenMaximumOp>,
+                 FoldElementwiseOfWeights<AtenMinimumOp>,
+                 FoldCastOfWeight<AtenToDtypeOp>,
+                 FoldCastOfWeight<PrimsConvertElementTypeOp>>(context,
+                                                              maxElements);
+    patterns.add<FoldMmOfWeights>(context, maxElements, maxMatmulMacs);
+    populateFoldWeightLayoutPatterns(patterns, context);
+
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createFoldConstantWeightsPass() {
+  return std::make_unique<FoldConstantWeightsPass>();
+}
+
+} // namespace mlir::torch::Torch
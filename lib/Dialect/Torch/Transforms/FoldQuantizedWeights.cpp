@@ -0,0 +1,244 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FoldWeightsUtils.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_FOLDQUANTIZEDWEIGHTS
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+// The builtin integer type that holds the values of the quantized `dtype`.
+static IntegerType getQuantizedStorageType(Type dtype) {
+  MLIRContext *context = dtype.getContext();
+  if (isa<QInt8Type>(dtype))
+    return IntegerType::get(context, 8, IntegerType::Signed);
+  if (isa<QUInt8Type>(dtype))
+    return IntegerType::get(context, 8, IntegerType::Unsigned);
+  if (isa<QInt16Type>(dtype))
+    return IntegerType::get(context, 16, IntegerType::Signed);
+  if (isa<QInt32Type>(dtype))
+    return IntegerType::get(context, 32, IntegerType::Signed);
+  return nullptr;
+}
+
+// Quantizes the elements `[begin, end)` of `in`, of the float type `T`, as
+// clamp(round(x / scale) + zp, qmin, qmax) with ties rounded to even, which is
+// also how TorchToLinalg lowers the quantize ops. `getChannel(i)` is the index
+// of the scale and zero point of element `i`.
+template <typename T>
+static void quantizeElements(const char *in, char *out, int64_t outBytes,
+                             int64_t begin, int64_t end, ArrayRef<T> scales,
+                             ArrayRef<T> zeroPoints, T qmin, T qmax,
+                             function_ref<int64_t(int64_t)> getChannel) {
+  for (int64_t i = begin; i < end; ++i) {
+    T value;
+    std::memcpy(&value, in + i * sizeof(T), sizeof(T));
+    int64_t channel = getChannel(i);
+    T q = std::nearbyint(value / scales[channel]) + zeroPoints[channel];
+    if (std::isnan(q))
+      q = zeroPoints[channel];
+    q = std::min(std::max(q, qmin), qmax);
+    int64_t result = static_cast<int64_t>(q);
+    std::memcpy(out + i * outBytes, &result, outBytes);
+  }
+}
+
+// Quantizes the float weight `weight` into a weight of the storage type of
+// `qdtype`, with one scale and zero point per slice of `axis`, or a single
+// one when `axis` is std::nullopt.
+static ElementsAttr quantizeWeight(MLIRContext *context, const Weight &weight,
+                                   Type qdtype, ArrayRef<double> scales,
+                                   ArrayRef<int64_t> zeroPoints,
+                                   std::optional<int64_t> axis) {
+  IntegerType storageType = getQuantizedStorageType(qdtype);
+  ShapedType inType = weight.getType();
+  auto floatType = dyn_cast<mlir::FloatType>(inType.getElementType());
+  if (!storageType || !floatType ||
+      (!floatType.isF32() && !floatType.isF64()))
+    return nullptr;
+  unsigned width = storageType.getWidth();
+  bool isUnsigned = storageType.isUnsigned();
+  double qmin = isUnsigned ? 0.0 : -std::ldexp(1.0, width - 1);
+  double qmax = (isUnsigned ? std::ldexp(1.0, width) : -qmin) - 1.0;
+
+  // Element `i` is in slice `(i / innerSize) % numChannels` of `axis`.
+  int64_t innerSize = 1;
+  int64_t numChannels = 1;
+  if (axis) {
+    ArrayRef<int64_t> shape = inType.getShape();
+    numChannels = shape[*axis];
+    for (int64_t dim : shape.drop_front(*axis + 1))
+      innerSize *= dim;
+  }
+  auto getChannel = [&](int64_t i) { return (i / innerSize) % numChannels; };
+
+  auto outType = RankedTensorType::get(inType.getShape(), storageType);
+  int64_t outBytes = width / 8;
+  const char *in = weight.data.data();
+  auto quantize = [&](auto zero) {
+    using T = decltype(zero);
+    SmallVector<T> typedScales(scales.begin(), scales.end());
+    SmallVector<T> typedZeroPoints(zeroPoints.begin(), zeroPoints.end());
+    return createWeight(
+        context, weight, outType, "_quantized",
+        [&](char *out, int64_t begin, int64_t end) {
+          quantizeElements<T>(in, out, outBytes, begin, end, typedScales,
+                              typedZeroPoints, static_cast<T>(qmin),
+                              static_cast<T>(qmax), getChannel);
+        });
+  };
+  if (floatType.isF32())
+    return quantize(0.0f);
+  return quantize(0.0);
+}
+
+namespace {
+// quantize_per_tensor(weight, scale, zp) ->
+//   _make_per_tensor_quantized_tensor(quantized weight, scale, zp), so that
+// the weight is quantized once at compile time and `FuseQuantizedOps` can
+// fuse its users.
+class FoldQuantizePerTensorOfWeight
+    : public OpRewritePattern<AtenQuantizePerTensorOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenQuantizePerTensorOp op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<Weight> weight =
+        matchWeight(op.getSelf(), /*requireOneUse=*/true);
+    double scale;
+    int64_t zeroPoint;
+    auto resultType = cast<ValueTensorType>(op.getType());
+    if (!weight || !resultType.hasDtype() ||
+        !matchPattern(op.getScale(), m_TorchConstantFloat(&scale)) ||
+        !matchPattern(op.getZeroPoint(), m_TorchConstantInt(&zeroPoint)))
+      return rewriter.notifyMatchFailure(op, "not a quantize of a weight");
+
+    ElementsAttr quantized =
+        quantizeWeight(getContext(), *weight, resultType.getDtype(), scale,
+                       zeroPoint, /*axis=*/std::nullopt);
+    if (!quantized)
+      return rewriter.notifyMatchFailure(op, "unsupported element types");
+    Value literal =
+        ValueTensorLiteralOp::create(rewriter, op.getLoc(), quantized);
+    rewriter.replaceOpWithNewOp<Aten_MakePerTensorQuantizedTensorOp>(
+        op, resultType, literal, op.getScale(), op.getZeroPoint());
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// quantize_per_channel(weight, scales, zps, axis) ->
+//   _make_per_channel_quantized_tensor(quantized weight, scales, zps, axis).
+class FoldQuantizePerChannelOfWeight
+    : public OpRewritePattern<AtenQuantizePerChannelOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenQuantizePerChannelOp op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<Weight> weight =
+        matchWeight(op.getSelf(), /*requireOneUse=*/true);
+    DenseFPElementsAttr scalesAttr;
+    DenseIntElementsAttr zeroPointsAttr;
+    int64_t axis;
+    auto resultType = cast<ValueTensorType>(op.getType());
+    if (!weight || !resultType.hasDtype() ||
+        !matchPattern(op.getScales(), m_Constant(&scalesAttr)) ||
+        !matchPattern(op.getZeroPoints(), m_Constant(&zeroPointsAttr)) ||
+        !matchPattern(op.getAxis(), m_TorchConstantInt(&axis)))
+      return rewriter.notifyMatchFailure(op, "not a quantize of a weight");
+    int64_t rank = weight->getType().getRank();
+    axis = toPositiveDim(axis, rank);
+    if (!isValidDim(axis, rank))
+      return rewriter.notifyMatchFailure(op, "invalid axis");
+
+    int64_t numChannels = weight->getType().getDimSize(axis);
+    SmallVector<double> scales;
+    for (const APFloat &scale : scalesAttr.getValues<APFloat>())
+      scales.push_back(scale.convertToDouble());
+    SmallVector<int64_t> zeroPoints;
+    bool isUnsignedZp = zeroPointsAttr.getElementType().isUnsignedInteger();
+    for (const APInt &zeroPoint : zeroPointsAttr.getValues<APInt>())
+      zeroPoints.push_back(isUnsignedZp ? zeroPoint.getZExtValue()
+                                        : zeroPoint.getSExtValue());
+    if (static_cast<int64_t>(scales.size()) != numChannels ||
+        static_cast<int64_t>(zeroPoints.size()) != numChannels)
+      return rewriter.notifyMatchFailure(op, "expected one scale per channel");
+
+    ElementsAttr quantized = quantizeWeight(
+        getContext(), *weight, resultType.getDtype(), scales, zeroPoints, axis);
+    if (!quantized)
+      return rewriter.notifyMatchFailure(op, "unsupported element types");
+    Value literal =
+        ValueTensorLiteralOp::create(rewriter, op.getLoc(), quantized);
+    rewriter.replaceOpWithNewOp<Aten_MakePerChannelQuantizedTensorOp>(
+        op, resultType, literal, op.getScales(), op.getZeroPoints(),
+        op.getAxis());
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// int_repr(_make_per_*_quantized_tensor(x)) -> x.
+class FoldIntReprOfMakeQuantized : public OpRewritePattern<AtenIntReprOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenIntReprOp op,
+                                PatternRewriter &rewriter) const override {
+    Operation *producer = op.getSelf().getDefiningOp();
+    if (!isa_and_nonnull<Aten_MakePerTensorQuantizedTensorOp,
+                         Aten_MakePerChannelQuantizedTensorOp>(producer))
+      return rewriter.notifyMatchFailure(op, "not a made quantized tensor");
+    Value intRepr = producer->getOperand(0);
+    if (intRepr.getType() != op.getType())
+      return rewriter.notifyMatchFailure(op, "mismatching types");
+    rewriter.replaceOp(op, intRepr);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class FoldQuantizedWeightsPass
+    : public impl::FoldQuantizedWeightsBase<FoldQuantizedWeightsPass> {
+public:
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<FoldQuantizePerTensorOfWeight, FoldQuantizePerChannelOfWeight,
+                 FoldIntReprOfMakeQuantized>(context);
+    populateFoldWeightLayoutPatterns(patterns, context);
+
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createFoldQuantizedWeightsPass() {
+  return std::make_unique<FoldQuantizedWeightsPass>();
+}
+
+} // namespace mlir::torch::Torch
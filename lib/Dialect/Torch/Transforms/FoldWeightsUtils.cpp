@@ -0,0 +1,236 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FoldWeightsUtils.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
+#include "mlir/IR/Threading.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+#include <cstring>
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+
+double Torch::readFloat(const char *data, int64_t i, Type type) {
+  if (type.isF32()) {
+    float value;
+    std::memcpy(&value, data + i * sizeof(float), sizeof(float));
+    return value;
+  }
+  if (type.isF64()) {
+    double value;
+    std::memcpy(&value, data + i * sizeof(double), sizeof(double));
+    return value;
+  }
+  auto floatType = cast<mlir::FloatType>(type);
+  unsigned width = floatType.getWidth();
+  uint64_t bits = 0;
+  std::memcpy(&bits, data + i * (width / 8), width / 8);
+  return APFloat(floatType.getFloatSemantics(), APInt(width, bits))
+      .convertToDouble();
+}
+
+void Torch::writeFloat(char *data, int64_t i, Type type, double value) {
+  if (type.isF32()) {
+    float rounded = static_cast<float>(value);
+    std::memcpy(data + i * sizeof(float), &rounded, sizeof(float));
+    return;
+  }
+  if (type.isF64()) {
+    std::memcpy(data + i * sizeof(double), &value, sizeof(double));
+    return;
+  }
+  auto floatType = cast<mlir::FloatType>(type);
+  unsigned width = floatType.getWidth();
+  APFloat rounded(value);
+  bool losesInfo;
+  rounded.convert(floatType.getFloatSemantics(), APFloat::rmNearestTiesToEven,
+                  &losesInfo);
+  uint64_t bits = rounded.bitcastToAPInt().getZExtValue();
+  std::memcpy(data + i * (width / 8), &bits, width / 8);
+}
+
+std::optional<Weight> Torch::matchWeight(Value value, bool requireOneUse) {
+  auto literal = value.getDefiningOp<ValueTensorLiteralOp>();
+  if (!literal || (requireOneUse && !literal->hasOneUse()))
+    return std::nullopt;
+  Weight weight;
+  weight.attr = literal.getValue();
+  ShapedType type = weight.getType();
+  Type elementType = type.getElementType();
+  if (!type.hasStaticShape() || !elementType.isIntOrFloat() ||
+      elementType.getIntOrFloatBitWidth() % 8 != 0 ||
+      elementType.getIntOrFloatBitWidth() > 64)
+    return std::nullopt;
+  weight.elementBytes = elementType.getIntOrFloatBitWidth() / 8;
+
+  if (auto resource = dyn_cast<DenseResourceElementsAttr>(weight.attr)) {
+    AsmResourceBlob *blob = resource.getRawHandle().getBlob();
+    if (!blob)
+      return std::nullopt;
+    weight.data = blob->getData();
+  } else if (auto dense = dyn_cast<DenseElementsAttr>(weight.attr)) {
+    if (dense.isSplat())
+      return std::nullopt;
+    weight.data = dense.getRawData();
+  } else {
+    return std::nullopt;
+  }
+  if (static_cast<int64_t>(weight.data.size()) !=
+      type.getNumElements() * weight.elementBytes)
+    return std::nullopt;
+  return weight;
+}
+
+ElementsAttr Torch::createWeight(
+    MLIRContext *context, const Weight &source, ShapedType type,
+    StringRef suffix,
+    function_ref<void(char *data, int64_t begin, int64_t end)> fill) {
+  constexpr int64_t kElementsPerTask = 1 << 14;
+  int64_t numElements = type.getNumElements();
+  int64_t numBytes =
+      numElements * (type.getElementType().getIntOrFloatBitWidth() / 8);
+  auto fillInParallel = [&](char *data) {
+    int64_t numTasks = llvm::divideCeil(numElements, kElementsPerTask);
+    parallelFor(context, 0, numTasks, [&](size_t task) {
+      int64_t begin = task * kElementsPerTask;
+      fill(data, begin, std::min(begin + kElementsPerTask, numElements));
+    });
+  };
+
+  if (auto resource = dyn_cast<DenseResourceElementsAttr>(source.attr)) {
+    AsmResourceBlob blob = HeapAsmResourceBlob::allocate(
+        numBytes, resource.getRawHandle().getBlob()->getDataAlignment(),
+        /*dataIsMutable=*/true);
+    fillInParallel(blob.getMutableData().data());
+    std::string name = (resource.getRawHandle().getKey() + suffix).str();
+    return DenseResourceElementsAttr::get(type, name, std::move(blob));
+  }
+  std::vector<char> data(numBytes);
+  fillInParallel(data.data());
+  return DenseElementsAttr::getFromRawBuffer(type, data);
+}
+
+namespace {
+// Folds a transpose or permute of a weight into a new weight: dim `i` of the
+// result is dim `perms[i]` of the weight.
+template <typename OpTy>
+class FoldPermutationOfWeight : public OpRewritePattern<OpTy> {
+public:
+  using OpRewritePattern<OpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<Weight> weight =
+        matchWeight(op.getSelf(), /*requireOneUse=*/true);
+    if (!weight)
+      return rewriter.notifyMatchFailure(op, "not a permute of a weight");
+
+    ShapedType inType = weight->getType();
+    int64_t rank = inType.getRank();
+    SmallVector<int64_t> perms;
+    if constexpr (std::is_same_v<OpTy, AtenTransposeIntOp>) {
+      int64_t dim0, dim1;
+      if (!matchPattern(op.getDim0(), m_TorchConstantInt(&dim0)) ||
+          !matchPattern(op.getDim1(), m_TorchConstantInt(&dim1)))
+        return rewriter.notifyMatchFailure(op, "non-constant dims");
+      dim0 = toPositiveDim(dim0, rank);
+      dim1 = toPositiveDim(dim1, rank);
+      if (!isValidDim(dim0, rank) || !isValidDim(dim1, rank))
+        return rewriter.notifyMatchFailure(op, "invalid dims");
+      perms = llvm::to_vector(llvm::seq<int64_t>(0, rank));
+      std::swap(perms[dim0], perms[dim1]);
+    } else {
+      if (!matchPattern(op.getDims(), m_TorchListOfConstantInts(perms)))
+        return rewriter.notifyMatchFailure(op, "non-constant dims");
+      for (int64_t &perm : perms) {
+        perm = toPositiveDim(perm, rank);
+        if (!isValidDim(perm, rank))
+          return rewriter.notifyMatchFailure(op, "invalid dims");
+      }
+    }
+    if (static_cast<int64_t>(perms.size()) != rank ||
+        !isPermutationVector(perms))
+      return rewriter.notifyMatchFailure(op, "invalid permutation");
+
+    // The stride in the weight of each dim of the result.
+    ArrayRef<int64_t> inShape = inType.getShape();
+    SmallVector<int64_t> inStrides(rank, 1);
+    for (int64_t i = rank - 2; i >= 0; --i)
+      inStrides[i] = inStrides[i + 1] * inShape[i + 1];
+    SmallVector<int64_t> strides, outShape;
+    for (int64_t perm : perms) {
+      strides.push_back(inStrides[perm]);
+      outShape.push_back(inShape[perm]);
+    }
+
+    int64_t bytes = weight->elementBytes;
+    const char *in = weight->data.data();
+    auto outType = RankedTensorType::get(outShape, inType.getElementType());
+    ElementsAttr permuted = createWeight(
+        this->getContext(), *weight, outType, "_permuted",
+        [&](char *out, int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            int64_t offset = 0;
+            for (int64_t dim = rank - 1, rest = i; dim >= 0; --dim) {
+              offset += (rest % outShape[dim]) * strides[dim];
+              rest /= outShape[dim];
+            }
+            std::memcpy(out + i * bytes, in + offset * bytes, bytes);
+          }
+        });
+    rewriter.replaceOpWithNewOp<ValueTensorLiteralOp>(op, permuted);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Folds an op that only changes the shape of a weight by giving the weight
+// the shape of the result, which shares the data of a resource blob.
+template <typename OpTy>
+class FoldReshapeOfWeight : public OpRewritePattern<OpTy> {
+public:
+  using OpRewritePattern<OpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<Weight> weight =
+        matchWeight(op.getSelf(), /*requireOneUse=*/false);
+    auto resultType = cast<ValueTensorType>(op.getType());
+    if (!weight || !resultType.areAllSizesKnown() || !resultType.hasDtype())
+      return rewriter.notifyMatchFailure(op, "not a reshape of a weight");
+    ShapedType outType = weight->getType().clone(resultType.getSizes());
+    if (outType.getNumElements() != weight->getType().getNumElements())
+      return rewriter.notifyMatchFailure(op, "mismatching number of elements");
+
+    ElementsAttr reshaped;
+    if (auto resource = dyn_cast<DenseResourceElementsAttr>(weight->attr))
+      reshaped =
+          DenseResourceElementsAttr::get(outType, resource.getRawHandle());
+    else
+      reshaped = cast<DenseElementsAttr>(weight->attr).reshape(outType);
+    rewriter.replaceOpWithNewOp<ValueTensorLiteralOp>(op, reshaped);
+    return success();
+  }
+};
+} // namespace
+
+void Torch::populateFoldWeightLayoutPatterns(RewritePatternSet &patterns,
+                                             MLIRContext *context) {
+  patterns.add<FoldPermutationOfWeight<AtenTransposeIntOp>,
+               FoldPermutationOfWeight<AtenPermuteOp>,
+               FoldReshapeOfWeight<AtenReshapeOp>,
+               FoldReshapeOfWeight<AtenViewOp>,
+               FoldReshapeOfWeight<AtenUnsqueezeOp>,
+               FoldReshapeOfWeight<AtenSqueezeDimOp>,
+               FoldReshapeOfWeight<AtenFlattenUsingIntsOp>>(context);
+}
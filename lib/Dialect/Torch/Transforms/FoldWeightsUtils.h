@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TORCHMLIR_DIALECT_TORCH_TRANSFORMS_FOLD_WEIGHTS_UTILS_H
+#define TORCHMLIR_DIALECT_TORCH_TRANSFORMS_FOLD_WEIGHTS_UTILS_H
+
+#include "mlir/IR/BuiltinAttributeInterfaces.h"
+#include "mlir/IR/PatternMatch.h"
+
+#include <optional>
+
+namespace mlir {
+namespace torch {
+namespace Torch {
+
+// The data of a `torch.vtensor.literal` of a statically shaped tensor whose
+// elements are whole bytes, held in a resource blob or a non-splat dense
+// attribute.
+struct Weight {
+  ElementsAttr attr;
+  ArrayRef<char> data;
+  int64_t elementBytes;
+
+  ShapedType getType() const { return cast<ShapedType>(attr.getType()); }
+};
+
+// Matches the literal weight that defines `value`. Folds that write new data
+// require the literal to have no other users, so that the weight is not kept
+// in both forms.
+std::optional<Weight> matchWeight(Value value, bool requireOneUse);
+
+// Creates a weight of `type` from `source`, taking a new resource blob named
+// after that of `source` and `suffix` when `source` is a resource, and fills
+// its data with `fill` on the thread pool of `context`, in chunks of elements.
+ElementsAttr
+createWeight(MLIRContext *context, const Weight &source, ShapedType type,
+             StringRef suffix,
+             function_ref<void(char *data, int64_t begin, int64_t end)> fill);
+
+// Reads element `i` of `data`, of the float type `type`, as a double.
+double readFloat(const char *data, int64_t i, Type type);
+
+// Writes `value` rounded to the float type `type` to element `i` of `data`.
+void writeFloat(char *data, int64_t i, Type type, double value);
+
+// Populates the patterns that fold transposes, permutes and reshapes of
+// weights into new weights.
+void populateFoldWeightLayoutPatterns(RewritePatternSet &patterns,
+                                      MLIRContext *context);
+
+} // namespace Torch
+} // namespace torch
+} // namespace mlir
+
+#endif // TORCHMLIR_DIALECT_TORCH_TRANSFORMS_FOLD_WEIGHTS_UTILS_H
@@ -51,8 +51,51 @@ bool isQCommutingOp(mlir::Operation *op) {
 struct QuantizedChain {
   std::stack<mlir::Operation *> commutingOpStack;
   Value dequantOpd, MPTQTOpd, scale, zeroPoint;
+  // The quantized dim of a per-channel quantized operand, or null.
+  Value axis;
 };
 
+// Whether `zeroPoints` is a constant tensor of zeros. The integer accumulation
+// of a per-channel quantized weight then does not depend on its channel, and
+// its per-channel scales can be applied to the accumulator instead.
+static bool isZeroTensor(Value zeroPoints) {
+  DenseIntElementsAttr attr;
+  if (!matchPattern(zeroPoints, m_Constant(&attr)))
+    return false;
+  return llvm::all_of(attr.getValues<APInt>(),
+                      [](const APInt &value) { return value.isZero(); });
+}
+
+// The dim of the result of `op` that the channels of its per-channel quantized
+// weight, quantized along `axis`, are mapped to. This is nullopt when the
+// channels are reduced over, e.g. the K dim of a matmul.
+template <typename SrcOp>
+static std::optional<int64_t> getOutputChannelDim(SrcOp op, Value axis) {
+  int64_t axisInt;
+  if (!matchPattern(axis, m_TorchConstantInt(&axisInt)))
+    return std::nullopt;
+  auto weightType = cast<ValueTensorType>(op->getOperand(1).getType());
+  auto resultType = cast<ValueTensorType>(op->getResult(0).getType());
+  if (!weightType.hasSizes() || !resultType.hasSizes())
+    return std::nullopt;
+  int64_t weightRank = weightType.getSizes().size();
+  int64_t resultRank = resultType.getSizes().size();
+  axisInt = toPositiveDim(axisInt, weightRank);
+  if constexpr (std::is_same_v<SrcOp, AtenConvolutionOp>) {
+    // The weight of a convolution is F*C/G*H*W, and its result N*F*H*W.
+    bool transposed;
+    if (!matchPattern(op.getTransposed(), m_TorchConstantBool(&transposed)) ||
+        transposed || axisInt != 0)
+      return std::nullopt;
+    return 1;
+  } else {
+    // The last dim of the rhs of a matmul is the last dim of its result.
+    if (weightRank < 2 || axisInt != weightRank - 1)
+      return std::nullopt;
+    return resultRank - 1;
+  }
+}
+
 // The following conversion takes patterns of the form [op0 -> MPTQT -> dequant
 // -> Op1 -> Op2 -> ... Opk -> SrcOp] to [op0 -> Int(Op1) -> Int(Op2) -> ... ->
 // Int(Opk) -> MPTQT -> SrcOp] for any sequence of q commuting ops
@@ -60,10 +103,16 @@ struct QuantizedChain {
 // With depth = 0, this conversion will simply fuse any immediately quantizable
 // operands: [MPTQT -> Dequant -> SrcOp (float operands)] to [MPTQT -> SrcOp(int
 // operands)]
+//
+// With `perChannel`, the weight operand of a matmul or convolution may also be
+// per-channel quantized, without commuting ops, when its zero points are all 0
+// and its channels are those of the result. The accumulator is then
+// dequantized per channel by the patterns below.
 template <typename SrcOp, unsigned depth>
 class QuantizeOperandsPastCommutingOps : public OpRewritePattern<SrcOp> {
 public:
-  using OpRewritePattern<SrcOp>::OpRewritePattern;
+  QuantizeOperandsPastCommutingOps(MLIRContext *context, bool perChannel)
+      : OpRewritePattern<SrcOp>(context), perChannel(perChannel) {}
 
   LogicalResult matchAndRewrite(SrcOp op,
                                 PatternRewriter &rewriter) const override {
@@ -98,15 +147,23 @@ public:
         // Case 2 : currOp is a dequant op (end loop)
         if (llvm::isa<AtenDequantizeSelfOp, AtenDequantizeTensorOp>(currOp)) {
           chain.dequantOpd = currOp->getOperand(0);
-          // Bail out if any operand is per-channel quantized, which would
-          // require more complex fusion logic.
-          if (llvm::isa<Aten_MakePerChannelQuantizedTensorOp>(
-                  chain.dequantOpd.getDefiningOp()))
+          if (auto MPCQTOp =
+                  chain.dequantOpd
+                      .getDefiningOp<Aten_MakePerChannelQuantizedTensorOp>()) {
+            if (!isPerChannelFusible(op, i, chain, MPCQTOp))
+              break;
+            chain.MPTQTOpd = MPCQTOp.getSelf();
+            chain.scale = MPCQTOp.getScale();
+            chain.zeroPoint = MPCQTOp.getZeroPoint();
+            chain.axis = MPCQTOp.getAxis();
             break;
+          }
 
           auto MPTQTOp =
               chain.dequantOpd
                   .getDefiningOp<Aten_MakePerTensorQuantizedTensorOp>();
+          if (!MPTQTOp)
+            break;
           chain.MPTQTOpd = MPTQTOp.getOperand(0);
           chain.scale = MPTQTOp.getOperand(1);
           chain.zeroPoint = MPTQTOp.getOperand(2);
@@ -208,16 +265,63 @@ public:
           cast<ValueTensorType>(chain.dequantOpd.getType()).getOptionalDtype();
       auto newMPTQTType = rewriter.getType<ValueTensorType>(
           cast<ValueTensorType>(operands[i].getType()).getSizes(), qTorchType);
-      operands[i] = Aten_MakePerTensorQuantizedTensorOp::create(
-          rewriter, loc, newMPTQTType, oldOpd, MPTQTOperands[1],
-          MPTQTOperands[2]);
+      if (chain.axis)
+        operands[i] = Aten_MakePerChannelQuantizedTensorOp::create(
+            rewriter, loc, newMPTQTType, oldOpd, chain.scale, chain.zeroPoint,
+            chain.axis);
+      else
+        operands[i] = Aten_MakePerTensorQuantizedTensorOp::create(
+            rewriter, loc, newMPTQTType, oldOpd, MPTQTOperands[1],
+            MPTQTOperands[2]);
     }
 
     rewriter.replaceOpWithNewOp<SrcOp>(op, op.getType(), operands);
     return success();
   }
+
+private:
+  bool isPerChannelFusible(SrcOp op, unsigned operandIdx,
+                           const QuantizedChain &chain,
+                           Aten_MakePerChannelQuantizedTensorOp MPCQTOp) const {
+    if constexpr (std::is_same_v<SrcOp, AtenReluOp>) {
+      return false;
+    } else {
+      return perChannel && operandIdx == 1 && chain.commutingOpStack.empty() &&
+             isZeroTensor(MPCQTOp.getZeroPoint()) &&
+             getOutputChannelDim(op, MPCQTOp.getAxis());
+    }
+  }
+
+  bool perChannel;
 };
 
+// The scales of the accumulator of an op whose lhs has the per-tensor scale
+// `lhsScale` and whose rhs is `rhs`: one per output channel.
+static Value getPerChannelScales(PatternRewriter &rewriter, Location loc,
+                                 Value lhsScale,
+                                 Aten_MakePerChannelQuantizedTensorOp rhs) {
+  return AtenMulScalarOp::create(rewriter, loc, rhs.getScale().getType(),
+                                 rhs.getScale(), lhsScale);
+}
+
+// Attaches the per-channel `scales` to `accumulator`, the result of `op`,
+// along the output channels of `rhs`, its per-channel quantized weight.
+template <typename SrcOp>
+static Value makePerChannelAccumulator(PatternRewriter &rewriter, SrcOp op,
+                                       Aten_MakePerChannelQuantizedTensorOp rhs,
+                                       Value scales, Value accumulator) {
+  Location loc = op.getLoc();
+  int64_t outputDim = *getOutputChannelDim(op, rhs.getAxis());
+  Value axis = Torch::ConstantIntOp::create(
+      rewriter, loc, rewriter.getI64IntegerAttr(outputDim));
+  auto accumulatorTy = cast<ValueTensorType>(accumulator.getType());
+  auto quantTy = rewriter.getType<ValueTensorType>(
+      accumulatorTy.getOptionalSizes(), rewriter.getType<QInt32Type>());
+  // The zero points of the rhs are all 0, so they are those of the result.
+  return Aten_MakePerChannelQuantizedTensorOp::create(
+      rewriter, loc, quantTy, accumulator, scales, rhs.getZeroPoint(), axis);
+}
+
 template <typename SrcOp> class QuantizeBias : public OpRewritePattern<SrcOp> {
 public:
   using OpRewritePattern<SrcOp>::OpRewritePattern;
@@ -237,8 +341,10 @@ public:
     if (auto qRhs =
             operands[1].getDefiningOp<Aten_MakePerTensorQuantizedTensorOp>())
       rhsScale = qRhs.getScale();
+    auto qRhsPerChannel =
+        operands[1].getDefiningOp<Aten_MakePerChannelQuantizedTensorOp>();
 
-    if (!rhsScale || !lhsScale)
+    if ((!rhsScale && !qRhsPerChannel) || !lhsScale)
       return failure();
 
     auto resultTy = cast<ValueTensorType>(op.getType());
@@ -254,6 +360,41 @@ public:
         return failure();
     }
 
+    auto qi32Ty = rewriter.getType<QInt32Type>();
+    auto convTy = rewriter.getType<ValueTensorType>(
+        resultTy.getOptionalSizes(),
+        rewriter.getIntegerType(32, IntegerType::Signed));
+
+    if (qRhsPerChannel) {
+      // The accumulator is quantized per output channel, so the bias is
+      // quantized per channel with the same scales.
+      Value biasScales =
+          getPerChannelScales(rewriter, op.getLoc(), lhsScale, qRhsPerChannel);
+      if (biasTy) {
+        Value axis = Torch::ConstantIntOp::create(
+            rewriter, op.getLoc(), rewriter.getI64IntegerAttr(0));
+        Value dtype = getDtypeIntValueForType(rewriter, op.getLoc(), qi32Ty);
+        Value qBias = AtenQuantizePerChannelOp::create(
+            rewriter, op.getLoc(),
+            rewriter.getType<ValueTensorType>(biasTy.getOptionalSizes(),
+                                              qi32Ty),
+            bias, biasScales, qRhsPerChannel.getZeroPoint(), axis, dtype);
+        qBias = AtenIntReprOp::create(
+            rewriter, op.getLoc(),
+            rewriter.getType<ValueTensorType>(
+                biasTy.getOptionalSizes(),
+                rewriter.getIntegerType(32, IntegerType::Signed)),
+            qBias);
+        operands[2] = qBias;
+      }
+      Value conv = SrcOp::create(rewriter, op.getLoc(), convTy, operands);
+      Value makeOut = makePerChannelAccumulator(rewriter, op, qRhsPerChannel,
+                                                biasScales, conv);
+      rewriter.replaceOpWithNewOp<AtenDequantizeSelfOp>(op, op.getType(),
+                                                        makeOut);
+      return success();
+    }
+
     Value biasScale = AtenMulFloatOp::create(
         rewriter, op.getLoc(), lhsScale.getType(), lhsScale, rhsScale);
 
@@ -261,8 +402,6 @@ public:
         rewriter, op.getLoc(), rewriter.getType<Torch::IntType>(),
         rewriter.getIntegerAttr(rewriter.getIntegerType(64), 0));
 
-    auto qi32Ty = rewriter.getType<QInt32Type>();
-
     if (biasTy) {
       auto newBiasTy =
           rewriter.getType<ValueTensorType>(biasTy.getOptionalSizes(), qi32Ty);
@@ -278,9 +417,6 @@ public:
       operands[2] = bias;
     }
 
-    auto convTy = rewriter.getType<ValueTensorType>(
-        resultTy.getOptionalSizes(),
-        rewriter.getIntegerType(32, IntegerType::Signed));
     auto conv = SrcOp::create(rewriter, op.getLoc(), convTy, operands);
 
     auto convQTy =
@@ -323,18 +459,13 @@ public:
             rhs.template getDefiningOp<Aten_MakePerTensorQuantizedTensorOp>()) {
       rhsScale = defining.getScale();
     }
+    auto rhsPerChannel =
+        rhs.template getDefiningOp<Aten_MakePerChannelQuantizedTensorOp>();
 
-    if (!lhsScale || !rhsScale)
+    if (!lhsScale || (!rhsScale && !rhsPerChannel))
       return failure();
 
-    // Quantize the bias input to the expected result:
-    Value zero = Torch::ConstantIntOp::create(
-        rewriter, op.getLoc(), rewriter.getType<Torch::IntType>(),
-        rewriter.getIntegerAttr(rewriter.getIntegerType(64), 0));
-
     auto qi32Ty = rewriter.getType<QInt32Type>();
-    Value biasScale = AtenMulFloatOp::create(
-        rewriter, op.getLoc(), lhsScale.getType(), lhsScale, rhsScale);
 
     // Update the quantied type:
     llvm::SmallVector<Value> operands(op.getOperands());
@@ -350,6 +481,22 @@ public:
     auto intRepr =
         AtenIntReprOp::create(rewriter, op.getLoc(), intReprTy, conv);
 
+    if (rhsPerChannel) {
+      Value scales =
+          getPerChannelScales(rewriter, op.getLoc(), lhsScale, rhsPerChannel);
+      Value quant = makePerChannelAccumulator(rewriter, op, rhsPerChannel,
+                                              scales, intRepr);
+      rewriter.replaceOpWithNewOp<AtenDequantizeSelfOp>(op, resultTy, quant);
+      return success();
+    }
+
+    // Quantize the bias input to the expected result:
+    Value zero = Torch::ConstantIntOp::create(
+        rewriter, op.getLoc(), rewriter.getType<Torch::IntType>(),
+        rewriter.getIntegerAttr(rewriter.getIntegerType(64), 0));
+    Value biasScale = AtenMulFloatOp::create(
+        rewriter, op.getLoc(), lhsScale.getType(), lhsScale, rhsScale);
+
     auto quantTy =
         rewriter.getType<ValueTensorType>(resultTy.getOptionalSizes(), qi32Ty);
     auto quant = Aten_MakePerTensorQuantizedTensorOp::create(
@@ -445,6 +592,7 @@ public:
 class FuseQuantizedOpsPass
     : public impl::FuseQuantizedOpsBase<FuseQuantizedOpsPass> {
 public:
+  using impl::FuseQuantizedOpsBase<FuseQuantizedOpsPass>::FuseQuantizedOpsBase;
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     RewritePatternSet patterns(context);
@@ -457,13 +605,15 @@ public:
         RemoveUnused<AtenReshapeOp>, RemoveUnused<PrimsCollapseOp>,
         RemoveUnused<AtenViewOp>, RemoveUnused<AtenPadOp>,
         RemoveUnused<AtenConstantPadNdOp>,
-        QuantizeOperandsPastCommutingOps<AtenConvolutionOp, 5>,
-        QuantizeOperandsPastCommutingOps<AtenReluOp, 0>,
-        QuantizeOperandsPastCommutingOps<AtenMatmulOp, 2>,
-        QuantizeOperandsPastCommutingOps<AtenMmOp, 4>,
+        RemoveUnused<Aten_MakePerChannelQuantizedTensorOp>,
         QuantizeAccumulator<AtenMmOp>, QuantizeAccumulator<AtenMatmulOp>,
         QuantizeResultLikeOperand<AtenReluOp>, QuantizeBias<AtenConvolutionOp>>(
         context);
+    patterns.insert<QuantizeOperandsPastCommutingOps<AtenConvolutionOp, 5>,
+                    QuantizeOperandsPastCommutingOps<AtenReluOp, 0>,
+                    QuantizeOperandsPastCommutingOps<AtenMatmulOp, 2>,
+                    QuantizeOperandsPastCommutingOps<AtenMmOp, 4>>(context,
+                                                                   perChannel);
 
     GreedyRewriteConfig config;
     if (failed(applyPatternsGreedily(getOperation(), std::move(patterns),
@@ -475,8 +625,11 @@ public:
 
 } // namespace
 
-std::unique_ptr<OperationPass<func::FuncOp>> createFuseQuantizedOpsPass() {
-  return std::make_unique<FuseQuantizedOpsPass>();
+std::unique_ptr<OperationPass<func::FuncOp>>
+createFuseQuantizedOpsPass(bool perChannel) {
+  FuseQuantizedOpsOptions options;
+  options.perChannel = perChannel;
+  return std::make_unique<FuseQuantizedOpsPass>(options);
 }
 
 } // namespace mlir::torch::Torch
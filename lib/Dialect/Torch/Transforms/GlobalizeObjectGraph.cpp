@@ -48,6 +48,30 @@ static FailureOr<NnModuleOp> findRootNnModule(ModuleOp module) {
   return rootNnModule;
 }
 
+namespace {
+/// Maps each torch.nn_module and slot name to the slot, which the pass looks
+/// up for every attribute access. Slot names are interned, so the lookups do
+/// not compare strings or scan the slots of large modules.
+class SlotTable {
+public:
+  SlotTable(ModuleOp module) {
+    for (NnModuleOp nnModule : module.getOps<NnModuleOp>())
+      for (SlotOp slot : nnModule.getOps<SlotOp>())
+        slots.try_emplace({nnModule, slot.getNameAttr()}, slot);
+  }
+
+  SlotOp lookup(NnModuleOp nnModule, StringAttr name) const {
+    return slots.lookup({nnModule, name});
+  }
+  SlotOp lookup(Value instance, StringAttr name) const {
+    return lookup(instance.getDefiningOp<NnModuleOp>(), name);
+  }
+
+private:
+  DenseMap<std::pair<Operation *, StringAttr>, SlotOp> slots;
+};
+} // namespace
+
 //===----------------------------------------------------------------------===//
 // Object graph recursive traversal.
 //===----------------------------------------------------------------------===//
@@ -67,8 +91,8 @@ namespace {
 /// traversal, so it's useful to roll them together.
 class ObjectGraphInfo {
 public:
-  ObjectGraphInfo(ModuleOp module)
-      : globalSlotBuilder(module.getBodyRegion()), symbolTable(module) {}
+  ObjectGraphInfo(ModuleOp module, SymbolTable &symbolTable)
+      : globalSlotBuilder(module.getBodyRegion()), symbolTable(symbolTable) {}
 
   LogicalResult initialize(NnModuleOp rootNnModule) {
     if (failed(collectUsedSlots()))
@@ -97,6 +121,7 @@ public:
   llvm::MapVector<StringAttr, Value> &getGlobalSlotInitialValues() {
     return globalSlotInitialValues;
   }
+  int64_t getNumGlobalSlots() const { return slotToGlobalSlot.size(); }
 
 private:
   LogicalResult collectUsedSlots() {
@@ -153,13 +178,22 @@ private:
     return success();
   }
 
+  // Appends `name` to `path`, and returns the size to truncate `path` back
+  // to.
+  size_t pushName(StringRef name) {
+    size_t oldSize = path.size();
+    if (!path.empty())
+      path += '.';
+    path += name;
+    return oldSize;
+  }
+
   LogicalResult recursivelyTraverse(NnModuleOp nnModule) {
-    std::string pathToClassFromRoot = llvm::join(nameStack, ".");
-    if (!seenNnModules.insert({nnModule, pathToClassFromRoot}).second) {
+    auto [it, inserted] = seenNnModules.try_emplace(nnModule, path);
+    if (!inserted) {
       return nnModule.emitError()
              << "reachable by multiple paths from root object: '<root>."
-             << seenNnModules[nnModule] << "' and '<root>."
-             << pathToClassFromRoot << "'";
+             << it->second << "' and '<root>." << path << "'";
     }
 
     auto classType = symbolTable.lookup<ClassTypeOp>(
@@ -168,50 +202,50 @@ private:
          llvm::zip(nnModule.getOps<SlotOp>(), classType.getOps<AttrOp>())) {
       auto slot = std::get<0>(t);
       auto attr = std::get<1>(t);
-      nameStack.push_back(attr.getName().str());
+      size_t oldSize = pushName(attr.getName());
       if (isa<NnModuleType>(attr.getType())) {
         if (failed(recursivelyTraverse(
                 slot.getValue().getDefiningOp<NnModuleOp>())))
           return failure();
       } else if (usedSlots.find(slot) != usedSlots.end()) {
         // Only create the GlobalSlotOp if the slot is used at all.
-        std::string linkageName = llvm::join(nameStack, ".");
         auto globalSlot =
-            GlobalSlotOp::create(globalSlotBuilder, slot.getLoc(), linkageName,
+            GlobalSlotOp::create(globalSlotBuilder, slot.getLoc(), path,
                                  /*sym_visibility=*/nullptr, attr.getType());
         if (attr.getIsPrivate())
           globalSlot.setVisibility(SymbolTable::Visibility::Private);
         assert(slotToGlobalSlot.find(slot) == slotToGlobalSlot.end());
         slotToGlobalSlot[slot] = globalSlot;
-        slotLinkageInfo[slot] = LinkageInfo{linkageName, attr.getIsPrivate()};
+        slotLinkageInfo[slot] = LinkageInfo{path, attr.getIsPrivate()};
         globalSlotInitialValues[globalSlot.getSymNameAttr()] = slot.getValue();
       }
-      nameStack.pop_back();
+      path.resize(oldSize);
     }
     for (auto method : classType.getOps<MethodOp>()) {
-      nameStack.push_back(method.getName().str());
+      size_t oldSize = pushName(method.getName());
       funcLinkageInfo[{
           nnModule, symbolTable.lookup<func::FuncOp>(method.getFunction())}] =
-          LinkageInfo{llvm::join(nameStack, "."), method.getIsPrivate()};
-      nameStack.pop_back();
+          LinkageInfo{path, method.getIsPrivate()};
+      path.resize(oldSize);
     }
     return success();
   }
   // Builder for creating GlobalSlotOp's in the module.
   OpBuilder globalSlotBuilder;
   // Symbol table for the module.
-  SymbolTable symbolTable;
+  SymbolTable &symbolTable;
   // The set of NnModuleOp's that have already been processed.
   // Used for diagnostics.
   // The map value is the original path from the root that we found it at.
   DenseMap<NnModuleOp, std::string> seenNnModules;
 
-  // The stack of attribute names we have traversed during our recursive
-  // traversal of the class/object hierarchy.
+  // The dotted path of attribute names we have traversed during our recursive
+  // traversal of the class/object hierarchy. It is extended and truncated in
+  // place, so that the traversal is linear in the size of the object graph.
   //
   // Linkage names are calculated based on the set of attribute names traversed
   // from the root class/module in the program.
-  std::vector<std::string> nameStack;
+  std::string path;
   // Linkage info for each SlotOp in the program.
   DenseMap<SlotOp, LinkageInfo> slotLinkageInfo;
   // Linkage info for each method in the program. Since we are going to be
@@ -333,6 +367,7 @@ namespace mlir::torch::Torch {
 // currently only analyzes a subset of ops.
 static LogicalResult analyzeInstances(func::FuncOp func,
                                       ArrayRef<ArgInstance> argInstances,
+                                      const SlotTable &slotTable,
                                       IRMapping &mapping) {
   for (auto &argInstance : argInstances)
     mapping.map(func.getArgument(argInstance.argIndex), argInstance.instance);
@@ -341,12 +376,8 @@ static LogicalResult analyzeInstances(func::FuncOp func,
       return WalkResult::advance();
     auto instance = mapping.lookupOrNull(op.getReceiver());
     assert(instance && "verifyFuncConformsToSubset should ensure this");
-    for (auto slot : instance.getDefiningOp<NnModuleOp>().getOps<SlotOp>()) {
-      if (slot.getName() == op.getName()) {
-        mapping.map(op, slot.getValue());
-        break;
-      }
-    }
+    if (SlotOp slot = slotTable.lookup(instance, op.getNameAttr()))
+      mapping.map(op, slot.getValue());
     return WalkResult::advance();
   });
   return success(!walkResult.wasInterrupted());
@@ -372,8 +403,9 @@ createMonomorphizationForCall(func::CallOp op, IRMapping &mapping,
 namespace {
 class MonomorphizationTracker {
 public:
-  MonomorphizationTracker(ModuleOp module)
-      : module(module), symbolTable(module) {}
+  MonomorphizationTracker(ModuleOp module, SymbolTable &symbolTable,
+                          const SlotTable &slotTable)
+      : module(module), symbolTable(symbolTable), slotTable(slotTable) {}
   LogicalResult
   initialize(DenseMap<ClassTypeOp, std::vector<NnModuleOp>> &instances) {
     for (auto func : module.getOps<func::FuncOp>()) {
@@ -415,7 +447,7 @@ private:
   LogicalResult generateNewMonomorphizations(const Monomorphization &m) {
     auto func = m.func;
     IRMapping mapping;
-    if (failed(analyzeInstances(func, m.argInstances, mapping)))
+    if (failed(analyzeInstances(func, m.argInstances, slotTable, mapping)))
       return failure();
     auto walkResult = func.walk([&](func::CallOp op) {
       FailureOr<Monomorphization> maybeMonomorphization =
@@ -430,7 +462,8 @@ private:
   }
 
   ModuleOp module;
-  SymbolTable symbolTable;
+  SymbolTable &symbolTable;
+  const SlotTable &slotTable;
   SmallVector<Monomorphization> dirtyMonomorphizations;
   llvm::SetVector<Monomorphization> monomorphizations;
 };
@@ -500,18 +533,14 @@ verifyPublicMonomorphizations(ModuleOp module, SymbolTable &symbolTable,
 // `mapping` to corresponding global instances.
 static LogicalResult rewriteMonomorphizedFuncClone(
     func::FuncOp func, IRMapping mapping, SymbolTable &symbolTable,
+    const SlotTable &slotTable,
     DenseMap<Monomorphization, func::FuncOp> &newFuncs,
     ObjectGraphInfo &objectGraphInfo) {
 
   SmallVector<Operation *> toErase;
   auto handlePrimSetAttr = [&](PrimSetAttrOp op) {
-    auto instance =
-        mapping.lookup(op.getReceiver()).getDefiningOp<NnModuleOp>();
-    SlotOp affectedSlot;
-    for (auto slot : instance.getOps<SlotOp>()) {
-      if (slot.getName() == op.getName())
-        affectedSlot = slot;
-    }
+    SlotOp affectedSlot =
+        slotTable.lookup(mapping.lookup(op.getReceiver()), op.getNameAttr());
     OpBuilder builder(op);
     GlobalSlotSetOp::create(
         builder, op.getLoc(),
@@ -522,13 +551,8 @@ static LogicalResult rewriteMonomorphizedFuncClone(
   };
   auto handlePrimGetAttr = [&](PrimGetAttrOp op) {
     if (!isa<NnModuleType>(op.getType())) {
-      auto instance =
-          mapping.lookup(op.getReceiver()).getDefiningOp<NnModuleOp>();
-      SlotOp affectedSlot;
-      for (auto slot : instance.getOps<SlotOp>()) {
-        if (slot.getName() == op.getName())
-          affectedSlot = slot;
-      }
+      SlotOp affectedSlot =
+          slotTable.lookup(mapping.lookup(op.getReceiver()), op.getNameAttr());
       OpBuilder builder(op);
       auto newOp = GlobalSlotGetOp::create(
           builder, op.getLoc(), op.getType(),
@@ -581,7 +605,15 @@ static LogicalResult rewriteMonomorphizedFuncClone(
   return success(!walkResult.wasInterrupted());
 }
 
-static LogicalResult globalizeObjectGraph(ModuleOp module) {
+namespace {
+struct GlobalizeObjectGraphStats {
+  int64_t numGlobalSlots = 0;
+  int64_t numMonomorphizations = 0;
+};
+} // namespace
+
+static LogicalResult globalizeObjectGraph(ModuleOp module,
+                                          GlobalizeObjectGraphStats &stats) {
 
   // Step 1: Traverse object graph and collect information.
 
@@ -589,12 +621,16 @@ static LogicalResult globalizeObjectGraph(ModuleOp module) {
   if (failed(maybeRootNnModule))
     return failure();
   NnModuleOp rootNnModule = *maybeRootNnModule;
-  ObjectGraphInfo objectGraphInfo(module);
+  // The class types and functions looked up in this table are neither added
+  // nor removed until the cleanup at the end, so one table serves all steps.
+  SymbolTable symbolTable(module);
+  SlotTable slotTable(module);
+  ObjectGraphInfo objectGraphInfo(module, symbolTable);
   if (failed(objectGraphInfo.initialize(rootNnModule)))
     return failure();
+  stats.numGlobalSlots = objectGraphInfo.getNumGlobalSlots();
 
   DenseMap<ClassTypeOp, std::vector<NnModuleOp>> instances;
-  SymbolTable symbolTable(module);
   for (auto nnModule : module.getOps<NnModuleOp>()) {
     auto classType = nnModule.getClassType(symbolTable);
     instances[classType].push_back(nnModule);
@@ -635,9 +671,10 @@ static LogicalResult globalizeObjectGraph(ModuleOp module) {
   // calculating these monomorphizations is a fixed-point iteration that
   // discovers all needed monomorphizations. In practice this yields a
   // controllable number.
-  MonomorphizationTracker tracker(module);
+  MonomorphizationTracker tracker(module, symbolTable, slotTable);
   if (failed(tracker.initialize(instances)))
     return failure();
+  stats.numMonomorphizations = tracker.getMonomorphizations().size();
 
   if (failed(verifyPublicMonomorphizations(module, symbolTable, tracker))) {
     return failure();
@@ -675,10 +712,12 @@ static LogicalResult globalizeObjectGraph(ModuleOp module) {
 
   for (auto &kv : newFuncs) {
     IRMapping mapping;
-    if (failed(analyzeInstances(kv.second, kv.first.argInstances, mapping)))
+    if (failed(analyzeInstances(kv.second, kv.first.argInstances, slotTable,
+                                mapping)))
       return failure();
     if (failed(rewriteMonomorphizedFuncClone(kv.second, mapping, symbolTable,
-                                             newFuncs, objectGraphInfo)))
+                                             slotTable, newFuncs,
+                                             objectGraphInfo)))
       return failure();
   }
 
@@ -706,8 +745,11 @@ namespace {
 class GlobalizeObjectGraphPass
     : public impl::GlobalizeObjectGraphBase<GlobalizeObjectGraphPass> {
   void runOnOperation() override {
-    if (failed(globalizeObjectGraph(getOperation())))
+    GlobalizeObjectGraphStats stats;
+    if (failed(globalizeObjectGraph(getOperation(), stats)))
       return signalPassFailure();
+    numGlobalSlots = stats.numGlobalSlots;
+    numMonomorphizations = stats.numMonomorphizations;
   }
 };
 } // namespace
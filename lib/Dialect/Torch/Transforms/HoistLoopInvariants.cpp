@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/LoopInvariantCodeMotionUtils.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchTraits.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/ADT/SmallBitVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_HOISTLOOPINVARIANTS
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+// Whether `op` draws new random numbers on every execution, so that two
+// executions on the same operands have different results.
+static bool isNondeterministic(Operation *op) {
+  if (isa<AtenUniformOp, AtenRandOp, AtenRandLikeOp, AtenRandnOp,
+          AtenRandnGeneratorOp, AtenRandnLikeOp, AtenRandintOp,
+          AtenRandintLowOp, AtenBernoulliOp, AtenBernoulliPOp,
+          AtenBernoulliTensorOp, AtenMultinomialOp, AtenExponentialOp,
+          AtenRandomOp, AtenRandomFromOp, AtenNormalFunctionalOp,
+          AtenDropoutOp, AtenNativeDropoutOp, AtenRreluOp,
+          AtenRreluWithNoiseOp, AtenRreluWithNoiseFunctionalOp>(op))
+    return true;
+  return llvm::any_of(op->getOperandTypes(), [](Type type) {
+    return isa<Torch::GeneratorType>(type);
+  });
+}
+
+// Whether `value` may be mutated between two iterations of a loop, so that an
+// op that reads it is not invariant even when it is defined outside of it.
+static bool isMutable(Value value) {
+  Type type = value.getType();
+  if (isa<NonValueTensorType, Torch::DictType>(type))
+    return true;
+  return isa<Torch::ListType>(type) && isListPotentiallyMutated(value);
+}
+
+// Whether `op`, with operands defined outside of the loop, computes the same
+// results on every iteration and can be executed once before the loop.
+static bool canHoist(Operation *op) {
+  if (op->getNumRegions() != 0 || op->hasTrait<OpTrait::IsTerminator>())
+    return false;
+  if (!op->hasTrait<Torch::OpTrait::HasValueSemantics>() &&
+      !isMemoryEffectFree(op))
+    return false;
+  if (isNondeterministic(op))
+    return false;
+  return llvm::none_of(op->getOperands(), isMutable) &&
+         llvm::none_of(op->getResults(), isMutable);
+}
+
+// Removes the carries of `loop` that every iteration yields unchanged, which
+// the loop then reads from their initial values. That exposes the ops that
+// only depend on them, e.g. weights that the exported body passes through,
+// as invariant, and the lowered loop does not carry their buffers.
+static PrimLoopOp removePassThroughCarries(IRRewriter &rewriter,
+                                           PrimLoopOp loop) {
+  Block *body = &loop.getRegion().front();
+  auto condition = cast<PrimLoopConditionOp>(body->getTerminator());
+  unsigned numCarries = loop.getIterArgsInit().size();
+  llvm::SmallBitVector passThrough(numCarries);
+  for (unsigned i = 0; i < numCarries; ++i) {
+    Value init = loop.getIterArgsInit()[i];
+    BlockArgument arg = body->getArgument(i + 1);
+    passThrough[i] = condition.getIterArgs()[i] == arg &&
+                     init.getType() == arg.getType() &&
+                     init.getType() == loop.getResult(i).getType();
+  }
+  if (passThrough.none())
+    return loop;
+
+  SmallVector<Value> inits;
+  SmallVector<Type> resultTypes;
+  for (unsigned i = 0; i < numCarries; ++i) {
+    Value init = loop.getIterArgsInit()[i];
+    if (passThrough[i]) {
+      rewriter.replaceAllUsesWith(loop.getResult(i), init);
+      continue;
+    }
+    inits.push_back(init);
+    resultTypes.push_back(loop.getResult(i).getType());
+  }
+  // Erase the carries from the back, so that the indices of the remaining
+  // ones do not shift.
+  for (int i = numCarries - 1; i >= 0; --i) {
+    if (!passThrough[i])
+      continue;
+    condition.getIterArgsMutable().erase(i);
+    rewriter.replaceAllUsesWith(body->getArgument(i + 1),
+                                loop.getIterArgsInit()[i]);
+    body->eraseArgument(i + 1);
+  }
+
+  rewriter.setInsertionPoint(loop);
+  auto newLoop =
+      PrimLoopOp::create(rewriter, loop.getLoc(), resultTypes,
+                         loop.getMaxTripCount(), loop.getInitialCondition(),
+                         inits);
+  rewriter.inlineRegionBefore(loop.getRegion(), newLoop.getRegion(),
+                              newLoop.getRegion().end());
+  unsigned newIndex = 0;
+  for (unsigned i = 0; i < numCarries; ++i) {
+    if (!passThrough[i])
+      rewriter.replaceAllUsesWith(loop.getResult(i),
+                                  newLoop.getResult(newIndex++));
+  }
+  rewriter.eraseOp(loop);
+  return newLoop;
+}
+
+namespace {
+class HoistLoopInvariantsPass
+    : public impl::HoistLoopInvariantsBase<HoistLoopInvariantsPass> {
+public:
+  void runOnOperation() override {
+    IRRewriter rewriter(&getContext());
+    // The walk is post-order, so that the ops hoisted out of an inner loop
+    // are then considered for the enclosing loops.
+    SmallVector<PrimLoopOp> loops;
+    getOperation().walk([&](PrimLoopOp loop) { loops.push_back(loop); });
+    for (PrimLoopOp loop : loops) {
+      loop = removePassThroughCarries(rewriter, loop);
+      moveLoopInvariantCode(
+          {&loop.getRegion()},
+          [](Value value, Region *region) {
+            return !region->isAncestor(value.getParentRegion());
+          },
+          [](Operation *op, Region *) { return canHoist(op); },
+          [&](Operation *op, Region *) { op->moveBefore(loop); });
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createHoistLoopInvariantsPass() {
+  return std::make_unique<HoistLoopInvariantsPass>();
+}
+
+} // namespace mlir::torch::Torch
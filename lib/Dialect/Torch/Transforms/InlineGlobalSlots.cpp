@@ -13,7 +13,9 @@
 //
 // One thing to note is that this inlining (as with all inlining) can create
 // duplicate ops. That is usually not a problem, except for certain large
-// tensor literals. We rely on later CSE passes to deduplicate those literals.
+// tensor literals. So the data of those literals is moved to a resource blob
+// before inlining: the duplicates then only hold a handle to the same blob,
+// and later CSE passes deduplicate the ops themselves.
 //
 // For debugging this pass an effort has been made for
 // `-debug-only=dataflow` and `-debug-only=torch-inline-global-slots` to give a
@@ -25,7 +27,9 @@
 
 #include "mlir/Analysis/DataFlowFramework.h"
 #include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/IR/AsmState.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/Pass/Pass.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
@@ -278,6 +282,34 @@ static bool isInitialValueTransitivelySafeToInline(Value initialValue,
   return true;
 }
 
+// Moves the data of a tensor literal `op` to a resource blob named after
+// `name`, so that the copies of the literal share the data. Returns false if
+// the literal is kept as is: splats, which are small anyway, and literals
+// smaller than `minResourceBytes`, which folders often match on, e.g. the
+// shape tensors.
+static bool moveLiteralDataToResource(Operation *op, StringRef name,
+                                      int64_t minResourceBytes) {
+  if (!isa<ValueTensorLiteralOp, NonValueTensorLiteralOp>(op))
+    return false;
+  auto attr = op->getAttrOfType<DenseElementsAttr>("value");
+  if (!attr || attr.isSplat())
+    return false;
+  // The raw data of a dense attribute has the layout of a resource blob
+  // except for booleans, which it packs into bits.
+  Type elementType = attr.getElementType();
+  if (!isa<IntegerType, FloatType>(elementType) ||
+      elementType.getIntOrFloatBitWidth() % 8 != 0)
+    return false;
+  ArrayRef<char> data = attr.getRawData();
+  if (static_cast<int64_t>(data.size()) < minResourceBytes)
+    return false;
+  AsmResourceBlob blob =
+      HeapAsmResourceBlob::allocateAndCopyWithAlign(data, alignof(uint64_t));
+  op->setAttr("value", DenseResourceElementsAttr::get(attr.getType(), name,
+                                                      std::move(blob)));
+  return true;
+}
+
 namespace {
 class InlineGlobalSlotsPass
     : public impl::InlineGlobalSlotsBase<InlineGlobalSlotsPass> {
@@ -353,6 +385,13 @@ class InlineGlobalSlotsPass
       // initial values are just single tensor literals.
       if (isInitialValueTransitivelySafeToInline(operand, solver)) {
         safeToInline.insert(slotSymName);
+        // Each use of the slot gets a copy of the slice of its initial value,
+        // so move the data of its literals out of the slice first.
+        for (Operation *op : getBackwardSliceIncludingRoot(operand)) {
+          if (moveLiteralDataToResource(op, slotSymName.getValue(),
+                                        minResourceBytes))
+            ++numResourceLiterals;
+        }
       }
     }
 
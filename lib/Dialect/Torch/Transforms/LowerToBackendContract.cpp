@@ -11,13 +11,21 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/FileUtilities.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
 #include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ToolOutputFile.h"
+
+#include <chrono>
 
 #define DEBUG_TYPE "torch-lower-to-backend-contract"
 
@@ -29,6 +37,7 @@ namespace mlir::torch::Torch {
 #define GEN_PASS_DECL_LOWERTOBACKENDCONTRACT
 #define GEN_PASS_DEF_LOWERTOBACKENDCONTRACT
 #define GEN_PASS_DEF_VERIFYBACKENDCONTRACTNODECOMPOSITIONS
+#define GEN_PASS_DEF_OPPROFILE
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
 
 //===----------------------------------------------------------------------===//
@@ -178,6 +187,28 @@ static LogicalResult checkOpIsBackendLegal(Operation *op,
   }
 }
 
+// Checks the types of the arguments of `block` and the legality and result
+// types of the ops directly nested in it.
+static WalkResult
+checkBlockSatisfiesBackendContract(Block *block, const ConversionTarget &target,
+                                   bool actuallyEmitDiagnostics) {
+  for (BlockArgument arg : block->getArguments())
+    if (failed(checkType(block->getParentOp(), arg.getType(),
+                         actuallyEmitDiagnostics))) {
+      return WalkResult::interrupt();
+    }
+  for (Operation &op : *block) {
+    if (failed(checkOpIsBackendLegal(&op, target, actuallyEmitDiagnostics)))
+      return WalkResult::interrupt();
+
+    for (OpResult result : op.getResults())
+      if (failed(checkType(&op, result.getType(), actuallyEmitDiagnostics)))
+        return WalkResult::interrupt();
+  }
+
+  return WalkResult::advance();
+}
+
 static bool satisfiesBackendContract(ModuleOp module,
                                      const ConversionTarget &target,
                                      bool actuallyEmitDiagnostics = false) {
@@ -230,27 +261,87 @@ static bool satisfiesBackendContract(ModuleOp module,
   // TODO: Should we report more than the first error?
   // How do we avoid making it too spammy?
   auto walkResult1 = module.walk<WalkOrder::PreOrder>([&](Block *block) {
-    for (BlockArgument arg : block->getArguments())
-      if (failed(checkType(block->getParentOp(), arg.getType(),
-                           actuallyEmitDiagnostics))) {
-        return WalkResult::interrupt();
-      }
-    for (Operation &op : *block) {
-      if (failed(checkOpIsBackendLegal(&op, target, actuallyEmitDiagnostics)))
-        return WalkResult::interrupt();
-
-      for (OpResult result : op.getResults())
-        if (failed(checkType(&op, result.getType(), actuallyEmitDiagnostics)))
-          return WalkResult::interrupt();
-    }
-
-    return WalkResult::advance();
+    return checkBlockSatisfiesBackendContract(block, target,
+                                              actuallyEmitDiagnostics);
   });
   if (walkResult1.wasInterrupted())
     return false;
   return true;
 }
 
+// Returns true if the body and signature of `func` satisfy the backend
+// contract. This does not check module-level properties of the contract, such
+// as the absence of module initializers.
+static bool functionSatisfiesBackendContract(func::FuncOp func,
+                                             const ConversionTarget &target) {
+  if (failed(checkOpIsBackendLegal(func, target,
+                                   /*actuallyEmitDiagnostics=*/false)))
+    return false;
+  return !func
+              .walk<WalkOrder::PreOrder>([&](Block *block) {
+                return checkBlockSatisfiesBackendContract(
+                    block, target, /*actuallyEmitDiagnostics=*/false);
+              })
+              .wasInterrupted();
+}
+
+// Moves the functions of `module` that already satisfy the backend contract
+// into `converged`, so that the next run of the simplification pipeline only
+// revisits the functions that still need work. The names of all functions are
+// appended to `functionOrder` in module order.
+//
+// Only public functions that neither reference other symbols nor are
+// referenced are moved, since otherwise symbol-based passes in the pipeline
+// (such as SymbolDCE and InlineGlobalSlots) would see an incomplete program.
+// In particular, an unreferenced private function is dead, and must stay for
+// SymbolDCE to erase it.
+static void
+detachConvergedFunctions(ModuleOp module, ModuleOp converged,
+                         const ConversionTarget &target,
+                         SmallVectorImpl<StringAttr> &functionOrder) {
+  llvm::DenseSet<StringAttr> referencedSymbols;
+  if (auto uses = SymbolTable::getSymbolUses(&module.getBodyRegion())) {
+    for (const SymbolTable::SymbolUse &use : *uses)
+      referencedSymbols.insert(use.getSymbolRef().getRootReference());
+  }
+  for (auto func :
+       llvm::make_early_inc_range(module.getBody()->getOps<func::FuncOp>())) {
+    functionOrder.push_back(func.getSymNameAttr());
+    if (func.isExternal() || !func.isPublic() ||
+        referencedSymbols.contains(func.getSymNameAttr()))
+      continue;
+    auto uses = SymbolTable::getSymbolUses(&func.getBody());
+    if (!uses || !uses->empty())
+      continue;
+    if (!functionSatisfiesBackendContract(func, target))
+      continue;
+    func->moveBefore(converged.getBody(), converged.getBody()->end());
+  }
+}
+
+// Moves the functions detached by `detachConvergedFunctions` back into
+// `module`, restoring their original position relative to the functions that
+// are still present.
+static void reattachConvergedFunctions(ModuleOp module, ModuleOp converged,
+                                       ArrayRef<StringAttr> functionOrder) {
+  if (converged.getBody()->empty())
+    return;
+  SymbolTable convergedSymbols(converged);
+  SymbolTable moduleSymbols(module);
+  Operation *insertionPoint = nullptr;
+  for (StringAttr name : llvm::reverse(functionOrder)) {
+    if (Operation *func = convergedSymbols.lookup(name)) {
+      if (insertionPoint)
+        func->moveBefore(insertionPoint);
+      else
+        func->moveBefore(module.getBody(), module.getBody()->end());
+      insertionPoint = func;
+    } else if (Operation *func = moduleSymbols.lookup(name)) {
+      insertionPoint = func;
+    }
+  }
+}
+
 // Explicitly set ops and dialects allowed and not allowed in backend contract.
 static ConversionTarget
 getBackendContractTarget(MLIRContext *context, bool decompose,
@@ -263,6 +354,77 @@ getBackendContractTarget(MLIRContext *context, bool decompose,
 }
 
 namespace {
+// The number of ops whose results still violate the value-semantics, rank, or
+// dtype requirements of the backend contract.
+struct ContractViolationCounts {
+  int64_t nonValueSemanticOps = 0;
+  int64_t unknownShapeOps = 0;
+  int64_t unknownDtypeOps = 0;
+};
+} // namespace
+
+static ContractViolationCounts countContractViolations(ModuleOp module) {
+  ContractViolationCounts counts;
+  module.walk([&](Operation *op) {
+    bool nonValueSemantic = false, unknownShape = false, unknownDtype = false;
+    for (Type type : op->getResultTypes()) {
+      if (isa<NonValueTensorType>(type)) {
+        nonValueSemantic = true;
+      } else if (auto tensorType = dyn_cast<ValueTensorType>(type)) {
+        unknownShape |= !tensorType.hasSizes();
+        unknownDtype |= !tensorType.hasDtype();
+      }
+    }
+    counts.nonValueSemanticOps += nonValueSemantic;
+    counts.unknownShapeOps += unknownShape;
+    counts.unknownDtypeOps += unknownDtype;
+  });
+  return counts;
+}
+
+// Returns `pipeline` with all pass option lists removed, which is a more
+// readable label for a pass, e.g. `func.func(canonicalize)`.
+static std::string stripPassOptions(StringRef pipeline) {
+  std::string label;
+  int depth = 0;
+  for (char c : pipeline) {
+    if (c == '{')
+      ++depth;
+    else if (c == '}')
+      --depth;
+    else if (depth == 0)
+      label.push_back(c);
+  }
+  return label;
+}
+
+namespace {
+// A single top-level pass of the simplification pipeline, run on its own so
+// that it can be timed.
+struct PipelineStage {
+  std::string label;
+  OpPassManager pm;
+};
+} // namespace
+
+// Splits `pm` into one pipeline per top-level pass. This round-trips the
+// passes through their textual form, so it fails if a pass is not registered.
+static LogicalResult
+splitIntoStages(OpPassManager &pm, StringRef opName,
+                SmallVectorImpl<PipelineStage> &stages) {
+  for (Pass &pass : pm.getPasses()) {
+    std::string pipeline;
+    llvm::raw_string_ostream os(pipeline);
+    pass.printAsTextualPipeline(os);
+    os.flush();
+    OpPassManager stage(opName);
+    if (failed(parsePassPipeline(pipeline, stage, llvm::nulls())))
+      return failure();
+    stages.push_back({stripPassOptions(pipeline), std::move(stage)});
+  }
+  return success();
+}
+
 class LowerToBackendContractPass
     : public impl::LowerToBackendContractBase<LowerToBackendContractPass> {
 public:
@@ -285,8 +447,29 @@ public:
     options.extraLibrary = extraLibrary;
     createTorchSimplificationPipeline(pm, options);
 
+    // When statistics are dumped, run the pipeline one pass at a time so that
+    // each pass can be timed. If the pipeline cannot be split, only whole
+    // iterations are timed.
+    SmallVector<PipelineStage> stages;
+    if (!statisticsFile.empty() &&
+        failed(splitIntoStages(pm, module.getOperationName(), stages)))
+      stages.clear();
+    llvm::json::Array iterationRecords;
+
     int i = 0;
     do {
+      LLVM_DEBUG({
+        if (i > 0) {
+          auto funcs = module.getBody()->getOps<func::FuncOp>();
+          int64_t numConverged = llvm::count_if(funcs, [&](func::FuncOp func) {
+            return functionSatisfiesBackendContract(func, target);
+          });
+          llvm::dbgs() << "LowerToBackendContractPass: after iteration " << i
+                       << ", " << numConverged << " of "
+                       << llvm::range_size(funcs)
+                       << " functions satisfy the backend contract\n";
+        }
+      });
       if (i++ == maxIterations) {
         LLVM_DEBUG({
           llvm::dbgs() << "LowerToBackendContractPass: "
@@ -294,22 +477,110 @@ public:
                        << maxIterations
                        << " iterations of the simplification pipeline\n";
         });
+        recordStatistics(module, maxIterations, /*converged=*/false,
+                         std::move(iterationRecords));
         // Show the diagnostics.
         (void)satisfiesBackendContract(module, target,
                                        /*actuallyEmitDiagnostics=*/true);
         return signalPassFailure();
       }
 
-      if (failed(runPipeline(pm, module)))
+      // In incremental mode, every iteration after the first one only
+      // revisits the functions that do not yet satisfy the backend contract.
+      OwningOpRef<ModuleOp> converged = ModuleOp::create(module.getLoc());
+      SmallVector<StringAttr> functionOrder;
+      if (incremental && i > 1)
+        detachConvergedFunctions(module, *converged, target, functionOrder);
+      llvm::json::Object iterationRecord{{"iteration", i}};
+      if (incremental)
+        iterationRecord["detached_functions"] =
+            llvm::range_size(converged->getOps());
+      LogicalResult result =
+          runSimplificationPipeline(pm, stages, module, iterationRecord);
+      reattachConvergedFunctions(module, *converged, functionOrder);
+      if (failed(result))
         return signalPassFailure();
+      if (!statisticsFile.empty()) {
+        ContractViolationCounts counts = countContractViolations(module);
+        iterationRecord["non_value_semantic_ops"] = counts.nonValueSemanticOps;
+        iterationRecord["unknown_shape_ops"] = counts.unknownShapeOps;
+        iterationRecord["unknown_dtype_ops"] = counts.unknownDtypeOps;
+        iterationRecords.push_back(std::move(iterationRecord));
+      }
     } while (!satisfiesBackendContract(module, target));
     LLVM_DEBUG({
       llvm::dbgs() << "LowerToBackendContractPass: " << "succeeded after " << i
                    << " iterations of the simplification pipeline\n";
     });
+    recordStatistics(module, i, /*converged=*/true,
+                     std::move(iterationRecords));
   }
 
 private:
+  // Runs one iteration of the simplification pipeline, recording its wall
+  // time (and that of each stage, if the pipeline was split) in `record`.
+  LogicalResult runSimplificationPipeline(OpPassManager &pm,
+                                          MutableArrayRef<PipelineStage> stages,
+                                          ModuleOp module,
+                                          llvm::json::Object &record) {
+    using Clock = std::chrono::steady_clock;
+    auto secondsSince = [](Clock::time_point start) {
+      return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+    Clock::time_point iterationStart = Clock::now();
+    LogicalResult result = success();
+    if (stages.empty()) {
+      result = runPipeline(pm, module);
+    } else {
+      llvm::json::Array passRecords;
+      for (PipelineStage &stage : stages) {
+        Clock::time_point stageStart = Clock::now();
+        result = runPipeline(stage.pm, module);
+        passRecords.push_back(llvm::json::Object{
+            {"pass", stage.label}, {"seconds", secondsSince(stageStart)}});
+        if (failed(result))
+          break;
+      }
+      record["passes"] = std::move(passRecords);
+    }
+    record["seconds"] = secondsSince(iterationStart);
+    return result;
+  }
+
+  // Updates the pass statistics and, if requested, counts the contract
+  // violations and writes the JSON record of all iterations to
+  // `statisticsFile`.
+  void recordStatistics(ModuleOp module, int64_t iterations, bool converged,
+                        llvm::json::Array iterationRecords) {
+    numIterations = iterations;
+    if (!countViolations && statisticsFile.empty())
+      return;
+    ContractViolationCounts counts = countContractViolations(module);
+    numNonValueSemanticOps = counts.nonValueSemanticOps;
+    numUnknownShapeOps = counts.unknownShapeOps;
+    numUnknownDtypeOps = counts.unknownDtypeOps;
+    if (statisticsFile.empty())
+      return;
+
+    std::string errorMessage;
+    std::unique_ptr<llvm::ToolOutputFile> output =
+        openOutputFile(statisticsFile, &errorMessage);
+    if (!output) {
+      module.emitWarning() << "could not open statistics file '"
+                           << statisticsFile << "': " << errorMessage;
+      return;
+    }
+    llvm::json::Value statistics = llvm::json::Object{
+        {"iterations", iterations},
+        {"converged", converged},
+        {"non_value_semantic_ops", counts.nonValueSemanticOps},
+        {"unknown_shape_ops", counts.unknownShapeOps},
+        {"unknown_dtype_ops", counts.unknownDtypeOps},
+        {"per_iteration", std::move(iterationRecords)}};
+    output->os() << llvm::formatv("{0:2}", statistics) << "\n";
+    output->keep();
+  }
+
   llvm::StringSet<> backendLegalOpsSet;
 };
 
@@ -333,9 +604,130 @@ public:
 };
 } // namespace
 
+//===----------------------------------------------------------------------===//
+// Profiling the op mix.
+//===----------------------------------------------------------------------===//
+
+namespace {
+// The totals of the ops of one name or class.
+struct OpTotals {
+  int64_t count = 0;
+  int64_t flops = 0;
+  int64_t bytes = 0;
+  // The ops whose flops or bytes could not be estimated, because some of
+  // their tensors have unknown sizes or dtypes.
+  int64_t unknownShapes = 0;
+
+  void add(std::optional<int64_t> opFlops, std::optional<int64_t> opBytes) {
+    ++count;
+    flops += opFlops.value_or(0);
+    bytes += opBytes.value_or(0);
+    unknownShapes += !opFlops || !opBytes;
+  }
+
+  llvm::json::Object toJSON() const {
+    return llvm::json::Object{{"count", count},
+                              {"flops", flops},
+                              {"bytes", bytes},
+                              {"unknown_shapes", unknownShapes}};
+  }
+};
+
+// The totals of the ops of one name, and how the lowering handles them.
+struct OpRecord {
+  OpTotals totals;
+  StringRef opClass;
+  StringRef handling;
+};
+
+class OpProfilePass : public impl::OpProfileBase<OpProfilePass> {
+public:
+  using impl::OpProfileBase<OpProfilePass>::OpProfileBase;
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    llvm::StringSet<> backendLegalOpsSet;
+    backendLegalOpsSet.insert(backendLegalOps.begin(), backendLegalOps.end());
+    ConversionTarget target = getBackendContractTarget(
+        &getContext(), /*decompose=*/true, backendLegalOpsSet);
+
+    llvm::StringMap<OpRecord> opRecords;
+    llvm::StringMap<OpTotals> classTotals;
+    llvm::StringMap<int64_t> handlingCounts;
+    auto isTensor = [](Type type) { return isa<BaseTensorType>(type); };
+    module.walk([&](Operation *op) {
+      if (!isa_and_nonnull<TorchDialect>(op->getDialect()) ||
+          (llvm::none_of(op->getOperandTypes(), isTensor) &&
+           llvm::none_of(op->getResultTypes(), isTensor)))
+        return;
+      std::string name = op->getName().getStringRef().str();
+      StringRef handling = "backend";
+      if (auto operatorOp = dyn_cast<OperatorOp>(op)) {
+        // Name the opaque operators by the op that they stand for.
+        name = ("torch.operator:" + operatorOp.getName()).str();
+        handling = "unregistered";
+      } else if (target.isIllegal(op)) {
+        handling = "decomposed";
+      }
+      StringRef opClass = getOpCostClass(op);
+      std::optional<int64_t> flops = estimateOpFlops(op);
+      std::optional<int64_t> bytes = 0;
+      for (Value value :
+           llvm::concat<Value>(op->getOperands(), op->getResults())) {
+        if (!isTensor(value.getType()))
+          continue;
+        std::optional<int64_t> valueBytes = getTensorStaticBytes(value);
+        if (!valueBytes)
+          bytes = std::nullopt;
+        else if (bytes)
+          *bytes += *valueBytes;
+      }
+      OpRecord &record = opRecords[name];
+      record.totals.add(flops, bytes);
+      record.opClass = opClass;
+      record.handling = handling;
+      classTotals[opClass].add(flops, bytes);
+      ++handlingCounts[handling];
+    });
+
+    std::string errorMessage;
+    std::unique_ptr<llvm::ToolOutputFile> output =
+        openOutputFile(outputFile, &errorMessage);
+    if (!output) {
+      module.emitError() << "could not open profile file '" << outputFile
+                         << "': " << errorMessage;
+      return signalPassFailure();
+    }
+    llvm::json::Object ops, classes, handlings;
+    int64_t totalOps = 0;
+    for (const auto &entry : opRecords) {
+      const OpRecord &record = entry.getValue();
+      llvm::json::Object json = record.totals.toJSON();
+      json["class"] = record.opClass;
+      json["handling"] = record.handling;
+      ops[entry.getKey()] = std::move(json);
+      totalOps += record.totals.count;
+    }
+    for (const auto &entry : classTotals)
+      classes[entry.getKey()] = entry.getValue().toJSON();
+    for (const auto &entry : handlingCounts)
+      handlings[entry.getKey()] = entry.getValue();
+    llvm::json::Value profile =
+        llvm::json::Object{{"total_ops", totalOps},
+                           {"ops", std::move(ops)},
+                           {"classes", std::move(classes)},
+                           {"handlings", std::move(handlings)}};
+    output->os() << llvm::formatv("{0:2}", profile) << "\n";
+    output->keep();
+    markAllAnalysesPreserved();
+  }
+};
+} // namespace
+
 std::unique_ptr<OperationPass<ModuleOp>> createLowerToBackendContractPass(
     int maxIterations, bool decompose, bool shapeDtypeRefine,
-    ArrayRef<std::string> backendLegalOps, StringRef extraLibrary) {
+    ArrayRef<std::string> backendLegalOps, StringRef extraLibrary,
+    bool incremental) {
   LowerToBackendContractOptions options;
   options.maxIterations = maxIterations;
   options.decompose = decompose;
@@ -343,6 +735,7 @@ std::unique_ptr<OperationPass<ModuleOp>> createLowerToBackendContractPass(
   options.backendLegalOps.append(backendLegalOps.begin(),
                                  backendLegalOps.end());
   options.extraLibrary = extraLibrary.str();
+  options.incremental = incremental;
   return std::make_unique<LowerToBackendContractPass>(options);
 }
 
@@ -351,6 +744,10 @@ createVerifyBackendContractNoDecompositionsPass() {
   return std::make_unique<VerifyBackendContractNoDecompositionsPass>();
 }
 
+std::unique_ptr<OperationPass<ModuleOp>> createOpProfilePass() {
+  return std::make_unique<OpProfilePass>();
+}
+
 // The backend contract guarantees that ops with decompositions available will
 // be decomposed. The only way to have an op reach the backend contract without
 // getting decomposed is by having the user explicitly specify that op in the
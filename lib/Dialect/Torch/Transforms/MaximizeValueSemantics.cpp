@@ -61,6 +61,9 @@ public:
   // Used to represent all of the interpreted ops that have at least
   // one non-value tensor as input or output.
   struct InterpretedOps {
+    // All of the interpreted ops other than the `copy.to_tensor`, in the
+    // order of the block.
+    SmallVector<Operation *> users;
     SmallVector<Operation *> copyLikeOps;
     SmallVector<Operation *> viewLikeOps;
     SmallVector<OverwriteTensorContentsOp> overwriteTensorContentsOps;
@@ -129,6 +132,7 @@ public:
                                       "` encountered during abstract analysis");
       }
     }
+    result.users = std::move(nonValueTensorUsers);
     return result;
   }
 
@@ -147,14 +151,29 @@ public:
         originalReturnTypes[operand.index()] = type;
       }
     }
-    // The rewriting for the overwrite op involves replacing all uses of its
-    // non-value tensor operand with its value tensor operand. Since the
-    // rewriting of other ops can potentially change the non-value tensor
-    // operand to a value tensor, this rewriting MUST happen first to avoid
-    // wrongly replacing operands that were previously not a view of the
-    // overwritten tensor.
-    for (OverwriteTensorContentsOp overwrite :
-         llvm::reverse(ops.overwriteTensorContentsOps)) {
+    // The rewriting for the overwrite op involves replacing the uses of its
+    // non-value tensor operand that come after it with its value tensor
+    // operand. Since the rewriting of other ops can potentially change the
+    // non-value tensor operand to a value tensor, this rewriting MUST happen
+    // first to avoid wrongly replacing operands that were previously not a
+    // view of the overwritten tensor.
+    //
+    // This is done in a single walk over the interpreted ops in order, which
+    // renames each use of an overwritten alias to the value of the last
+    // overwrite of it so far. Replacing the uses after each overwrite
+    // instead would scan the uses of a tensor once per overwrite, which is
+    // quadratic in the length of chains of in-place updates of a tensor,
+    // such as those of KV caches.
+    DenseMap<Value, Value> overwrittenValues;
+    for (Operation *user : ops.users) {
+      auto overwrite = dyn_cast<OverwriteTensorContentsOp>(user);
+      if (!overwrite) {
+        for (OpOperand &operand : user->getOpOperands()) {
+          if (Value value = overwrittenValues.lookup(operand.get()))
+            rewriter.modifyOpInPlace(user, [&] { operand.set(value); });
+        }
+        continue;
+      }
       Value overwritten = assertNonValueTensor(overwrite.getOverwritten());
       // Cast-like aliases represent the exact same tensor at runtime as the
       // overwritten alias, since casts only encode compile time information.
@@ -162,15 +181,11 @@ public:
       // aliases of it with the overwrite value.
       DenseSet<Value> overwrittenAliases = getCastLikeAliasesOf(overwritten);
       overwrittenAliases.insert(overwritten);
-
-      for (Value alias : overwrittenAliases) {
-        alias.replaceUsesWithIf(
-            overwrite.getValue(), [&](const OpOperand &operand) {
-              return !operand.getOwner()->isBeforeInBlock(overwrite);
-            });
-      }
-      rewriter.eraseOp(overwrite);
+      for (Value alias : overwrittenAliases)
+        overwrittenValues[alias] = overwrite.getValue();
     }
+    for (OverwriteTensorContentsOp overwrite : ops.overwriteTensorContentsOps)
+      rewriter.eraseOp(overwrite);
 
     for (Operation *copyLikeOp : ops.copyLikeOps)
       rewriter.replaceOp(copyLikeOp, copyLikeOp->getOperand(0));
@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Pass/Pass.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_NAMELOCATIONS
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+namespace {
+class NameLocationsPass : public impl::NameLocationsBase<NameLocationsPass> {
+  void runOnOperation() override {
+    auto isTensor = [](Type type) { return isa<BaseTensorType>(type); };
+    getOperation().walk([&](Operation *op) {
+      if (!isa_and_nonnull<TorchDialect>(op->getDialect()) ||
+          (llvm::none_of(op->getOperandTypes(), isTensor) &&
+           llvm::none_of(op->getResultTypes(), isTensor)))
+        return;
+      StringAttr name = op->getName().getIdentifier();
+      auto nameLoc = dyn_cast<NameLoc>(op->getLoc());
+      if (nameLoc && nameLoc.getName() == name)
+        return;
+      op->setLoc(NameLoc::get(name, op->getLoc()));
+    });
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createNameLocationsPass() {
+  return std::make_unique<NameLocationsPass>();
+}
+
+} // namespace mlir::torch::Torch
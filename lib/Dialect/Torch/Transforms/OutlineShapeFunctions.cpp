@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ReifyAbstractInterpCalculationsUtils.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchTraits.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/ADT/ScopeExit.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_OUTLINESHAPEFUNCTIONS
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+static constexpr StringLiteral kShapesSuffix = "$shapes";
+
+// Whether the sizes of all the results of `op` are known, so that its shapes
+// need no calculation.
+static bool hasStaticShapes(Operation *op) {
+  return op->getNumResults() != 0 &&
+         llvm::all_of(op->getResultTypes(), [](Type type) {
+           auto tensorType = dyn_cast<BaseTensorType>(type);
+           return tensorType && tensorType.areAllSizesKnown();
+         });
+}
+
+// Returns a copy of `func` named `<name>$shapes` that returns the sizes of
+// the tensor results of `func` instead of the results.
+static func::FuncOp createShapesFunction(func::FuncOp func) {
+  func::FuncOp shapesFunc = func.clone();
+  shapesFunc.setName((func.getName() + kShapesSuffix).str());
+  shapesFunc.removeResAttrsAttr();
+  Operation *terminator = shapesFunc.getBody().front().getTerminator();
+  OpBuilder b(terminator);
+  Type listType = Torch::ListType::get(Torch::IntType::get(func.getContext()));
+  SmallVector<Value> shapes;
+  for (Value result : terminator->getOperands()) {
+    if (isa<BaseTensorType>(result.getType()))
+      shapes.push_back(
+          AtenSizeOp::create(b, terminator->getLoc(), listType, result));
+  }
+  func::ReturnOp::create(b, terminator->getLoc(), shapes);
+  terminator->erase();
+  shapesFunc.setFunctionType(b.getFunctionType(
+      shapesFunc.getArgumentTypes(), ValueRange(shapes).getTypes()));
+  return shapesFunc;
+}
+
+// Replaces the sizes of the results of the `torch.shape.calculate` ops of
+// `func` with the shapes that they calculate, and erases the ops that are
+// then only needed for their results.
+static void projectOntoShapes(func::FuncOp func) {
+  SmallVector<ShapeCalculateOp> calculateOps;
+  func.walk([&](ShapeCalculateOp op) { calculateOps.push_back(op); });
+  for (ShapeCalculateOp op : calculateOps) {
+    // The calculation only reads values defined before `op`, and may assert
+    // on them, so it is kept in place of `op`.
+    Block &calculation = op.getCalculation().front();
+    Operation *yieldShapes = calculation.getTerminator();
+    SmallVector<Value> shapes(yieldShapes->getOperands());
+    yieldShapes->erase();
+    op->getBlock()->getOperations().splice(Block::iterator(op),
+                                           calculation.getOperations());
+    for (auto [result, shape] : llvm::zip_equal(op.getResults(), shapes)) {
+      for (Operation *user : llvm::make_early_inc_range(result.getUsers())) {
+        if (auto size = dyn_cast<AtenSizeOp>(user)) {
+          size.replaceAllUsesWith(shape);
+          size.erase();
+        }
+      }
+    }
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    func.walk<WalkOrder::PostOrder, ReverseIterator>([&](Operation *op) {
+      if (!op->use_empty() || op->hasTrait<OpTrait::IsTerminator>())
+        return;
+      if (!isa<ShapeCalculateOp>(op) &&
+          !op->hasTrait<Torch::OpTrait::HasValueSemantics>() &&
+          !isOpTriviallyDead(op))
+        return;
+      op->erase();
+      changed = true;
+    });
+  }
+}
+
+namespace {
+class OutlineShapeFunctionsPass
+    : public impl::OutlineShapeFunctionsBase<OutlineShapeFunctionsPass> {
+public:
+  using impl::OutlineShapeFunctionsBase<
+      OutlineShapeFunctionsPass>::OutlineShapeFunctionsBase;
+
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    ModuleOp module = getOperation();
+    SmallVector<func::FuncOp> funcs;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (func.isPublic() && !func.isDeclaration() &&
+          func.getBody().hasOneBlock() &&
+          !func.getName().ends_with(kShapesSuffix) &&
+          llvm::any_of(func.getResultTypes(),
+                       [](Type type) { return isa<BaseTensorType>(type); }))
+        funcs.push_back(func);
+    }
+    if (funcs.empty())
+      return;
+
+    CachedLibrary *library =
+        getCachedAbstractInterpLibrary(context, extraLibrary);
+    if (!library) {
+      if (extraLibrary.empty())
+        emitError(module->getLoc(),
+                  "Failed to load the abstract interpretation library");
+      else
+        emitError(module->getLoc(),
+                  "Failed to load extra-library file at " + extraLibrary);
+      return signalPassFailure();
+    }
+
+    // The shape functions are built in a nested module, so that the library
+    // calculations are only reified in them.
+    auto scratch = ModuleOp::create(module.getLoc());
+    module.getBody()->push_back(scratch);
+    auto eraseScratch = llvm::make_scope_exit([&] { scratch->erase(); });
+    for (func::FuncOp func : funcs)
+      scratch.push_back(createShapesFunction(func));
+
+    // Every op of dynamic shape gets its shape function, including those that
+    // the shape refinement infers natively, as the shape functions relate
+    // the sizes of the results to those of the operands.
+    if (failed(reifyLibraryCalculations(scratch, *library,
+                                        LibraryFunctionKind::ShapeFunction,
+                                        shapeFunctionArgsBuilder,
+                                        hasStaticShapes)))
+      return signalPassFailure();
+    OpPassManager inlinePm(ModuleOp::getOperationName());
+    inlinePm.addPass(createInlinerPass());
+    if (failed(runPipeline(inlinePm, scratch)))
+      return signalPassFailure();
+
+    for (auto shapesFunc : scratch.getOps<func::FuncOp>())
+      projectOntoShapes(shapesFunc);
+
+    OpPassManager simplifyPm(ModuleOp::getOperationName());
+    simplifyPm.addNestedPass<func::FuncOp>(
+        createSimplifyShapeCalculationsPass());
+    simplifyPm.addNestedPass<func::FuncOp>(createCSEPass());
+    simplifyPm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+    simplifyPm.addPass(createSymbolDCEPass());
+    if (failed(runPipeline(simplifyPm, scratch)))
+      return signalPassFailure();
+
+    SymbolTable symbolTable(module);
+    for (func::FuncOp func : funcs) {
+      auto shapesFunc = scratch.lookupSymbol<func::FuncOp>(
+          (func.getName() + kShapesSuffix).str());
+      shapesFunc->remove();
+      symbolTable.insert(shapesFunc, std::next(Block::iterator(func)));
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createOutlineShapeFunctionsPass() {
+  return std::make_unique<OutlineShapeFunctionsPass>();
+}
+
+} // namespace mlir::torch::Torch
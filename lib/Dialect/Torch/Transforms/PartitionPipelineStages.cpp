@@ -0,0 +1,240 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/SetVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_PARTITIONPIPELINESTAGES
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+static constexpr StringLiteral kPipelineStageAttr = "torch.pipeline_stage";
+
+// Whether `op` is cloned into each stage that uses it rather than placed in
+// a stage of its own: constants, including the literal weights, and the
+// reads of global slots.
+static bool isRematerializable(Operation *op) {
+  return op->getNumOperands() == 0 && op->getNumRegions() == 0 &&
+         (op->hasTrait<OpTrait::ConstantLike>() || isa<GlobalSlotGetOp>(op));
+}
+
+// Assigns the ops of `block` that are not rematerializable to `numStages`
+// contiguous stages of about equal cost. The cost of an op is the sum of its
+// share of the estimated flops of the block and its share of the bytes of
+// the parameters of the block, which count at their first use.
+static DenseMap<Operation *, int64_t> assignStages(Block &block,
+                                                   int64_t numStages) {
+  SmallVector<Operation *> ops;
+  SmallVector<int64_t> flops, bytes;
+  DenseMap<Operation *, int64_t> indices;
+  for (Operation &op : block.without_terminator()) {
+    if (isRematerializable(&op))
+      continue;
+    int64_t opFlops = 0;
+    op.walk([&](Operation *nested) {
+      opFlops += estimateOpFlops(nested).value_or(0);
+    });
+    indices[&op] = ops.size();
+    ops.push_back(&op);
+    flops.push_back(opFlops);
+    bytes.push_back(0);
+  }
+  for (Operation &op : block.without_terminator()) {
+    if (!isRematerializable(&op) || op.getNumResults() != 1)
+      continue;
+    std::optional<int64_t> opBytes = getTensorStaticBytes(op.getResult(0));
+    if (!opBytes)
+      continue;
+    std::optional<int64_t> firstUse;
+    for (Operation *user : op.getUsers()) {
+      auto it = indices.find(block.findAncestorOpInBlock(*user));
+      if (it != indices.end())
+        firstUse = std::min(firstUse.value_or(it->second), it->second);
+    }
+    if (firstUse)
+      bytes[*firstUse] += *opBytes;
+  }
+
+  int64_t totalFlops = 0, totalBytes = 0;
+  for (auto [opFlops, opBytes] : llvm::zip_equal(flops, bytes)) {
+    totalFlops += opFlops;
+    totalBytes += opBytes;
+  }
+  SmallVector<double> costs;
+  double totalCost = 0;
+  for (auto [opFlops, opBytes] : llvm::zip_equal(flops, bytes)) {
+    double cost = 0;
+    if (totalFlops > 0)
+      cost += (double)opFlops / totalFlops;
+    if (totalBytes > 0)
+      cost += (double)opBytes / totalBytes;
+    costs.push_back(cost);
+    totalCost += cost;
+  }
+
+  // Each op goes to the stage that the middle of its cost falls into, or to
+  // stages in proportion to their count if nothing has a known cost.
+  DenseMap<Operation *, int64_t> stages;
+  double before = 0;
+  for (auto [index, op] : llvm::enumerate(ops)) {
+    double position = totalCost > 0
+                          ? (before + costs[index] / 2) / totalCost
+                          : (index + 0.5) / ops.size();
+    stages[op] = std::min<int64_t>(numStages - 1, position * numStages);
+    before += costs[index];
+  }
+  return stages;
+}
+
+// Splits the body of `func` into stage functions, which `func` then calls in
+// order.
+static void partition(func::FuncOp func, int64_t numStages,
+                      SymbolTable &symbolTable) {
+  Block &block = func.getBody().front();
+  DenseMap<Operation *, int64_t> stages = assignStages(block, numStages);
+  if (stages.empty())
+    return;
+
+  // The op of `block` that holds the definition of `value`, or null for the
+  // arguments of `block`.
+  auto getOwner = [&](Value value) -> Operation * {
+    Operation *parent = isa<BlockArgument>(value)
+                            ? value.getParentBlock()->getParentOp()
+                            : value.getDefiningOp();
+    return parent == func ? nullptr : block.findAncestorOpInBlock(*parent);
+  };
+
+  SmallVector<SmallVector<Operation *>> stageOps(numStages);
+  SmallVector<Operation *> originalOps;
+  for (Operation &op : block.without_terminator()) {
+    originalOps.push_back(&op);
+    auto it = stages.find(&op);
+    if (it != stages.end())
+      stageOps[it->second].push_back(&op);
+  }
+
+  Operation *terminator = block.getTerminator();
+  OpBuilder driverBuilder(terminator);
+  IRMapping driverMapping;
+  Operation *insertionPoint = func;
+  for (auto [stage, ops] : llvm::enumerate(stageOps)) {
+    if (ops.empty())
+      continue;
+    // The stage receives the values of other stages and the arguments that
+    // its ops use, and sends the values that later stages or the results of
+    // `func` use.
+    llvm::SetVector<Value> inputs, outputs;
+    llvm::SetVector<Operation *> rematerialized;
+    for (Operation *op : ops) {
+      op->walk([&](Operation *nested) {
+        for (Value operand : nested->getOperands()) {
+          Operation *owner = getOwner(operand);
+          if (owner == op)
+            continue;
+          if (owner && isRematerializable(owner))
+            rematerialized.insert(owner);
+          else if (!owner || stages.lookup(owner) != (int64_t)stage)
+            inputs.insert(operand);
+        }
+      });
+      for (Value result : op->getResults()) {
+        if (llvm::any_of(result.getUsers(), [&](Operation *user) {
+              Operation *owner = block.findAncestorOpInBlock(*user);
+              return owner == terminator ||
+                     stages.lookup(owner) > (int64_t)stage;
+            }))
+          outputs.insert(result);
+      }
+    }
+
+    std::string name = (func.getName() + "_stage" + Twine(stage)).str();
+    FunctionType type = driverBuilder.getFunctionType(
+        ValueRange(inputs.getArrayRef()).getTypes(),
+        ValueRange(outputs.getArrayRef()).getTypes());
+    auto stageFunc = func::FuncOp::create(func.getLoc(), name, type);
+    stageFunc->setAttr(kPipelineStageAttr,
+                       driverBuilder.getI64IntegerAttr(stage));
+    symbolTable.insert(stageFunc, std::next(Block::iterator(insertionPoint)));
+    insertionPoint = stageFunc;
+
+    Block *body = stageFunc.addEntryBlock();
+    auto bodyBuilder = OpBuilder::atBlockBegin(body);
+    IRMapping mapping;
+    mapping.map(inputs.getArrayRef(), body->getArguments());
+    for (Operation &op : block.without_terminator()) {
+      if (rematerialized.contains(&op))
+        bodyBuilder.clone(op, mapping);
+    }
+    for (Operation *op : ops)
+      bodyBuilder.clone(*op, mapping);
+    SmallVector<Value> results = llvm::map_to_vector(
+        outputs, [&](Value output) { return mapping.lookup(output); });
+    func::ReturnOp::create(bodyBuilder, func.getLoc(), results);
+
+    SmallVector<Value> operands =
+        llvm::map_to_vector(inputs, [&](Value input) {
+          return driverMapping.lookupOrDefault(input);
+        });
+    auto call =
+        func::CallOp::create(driverBuilder, func.getLoc(), stageFunc, operands);
+    driverMapping.map(outputs.getArrayRef(), call.getResults());
+  }
+
+  // The results of `func` that are constants are cloned into it.
+  for (OpOperand &operand : terminator->getOpOperands()) {
+    Operation *owner = getOwner(operand.get());
+    if (owner && isRematerializable(owner) &&
+        !driverMapping.contains(operand.get()))
+      driverBuilder.clone(*owner, driverMapping);
+    operand.set(driverMapping.lookupOrDefault(operand.get()));
+  }
+  for (Operation *op : llvm::reverse(originalOps))
+    op->erase();
+}
+
+namespace {
+class PartitionPipelineStagesPass
+    : public impl::PartitionPipelineStagesBase<PartitionPipelineStagesPass> {
+public:
+  using impl::PartitionPipelineStagesBase<
+      PartitionPipelineStagesPass>::PartitionPipelineStagesBase;
+
+  void runOnOperation() override {
+    if (numStages < 2)
+      return;
+    ModuleOp module = getOperation();
+    SymbolTable symbolTable(module);
+    SmallVector<func::FuncOp> funcs;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (func.isPublic() && !func.isDeclaration() &&
+          func.getBody().hasOneBlock() && !func->hasAttr(kPipelineStageAttr))
+        funcs.push_back(func);
+    }
+    for (func::FuncOp func : funcs)
+      partition(func, numStages, symbolTable);
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createPartitionPipelineStagesPass() {
+  return std::make_unique<PartitionPipelineStagesPass>();
+}
+
+} // namespace mlir::torch::Torch
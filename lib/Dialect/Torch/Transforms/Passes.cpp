@@ -74,9 +74,16 @@ void mlir::torch::Torch::createTorchDynamoExportToTorchBackendPipeline(
   // to conform to the linalg-on-tensors backend contract.
   pm.addPass(createInlinerPass());
   pm.addNestedPass<func::FuncOp>(
-      createReduceOpVariantsPass(options.extraLibrary));
+      createReduceOpVariantsPass(options.extraLibrary,
+                                 options.inplaceDestinations));
+  // The inlined bodies of while_loop recompute values that do not depend on
+  // the loop on every iteration.
+  pm.addNestedPass<func::FuncOp>(createHoistLoopInvariantsPass());
   pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
   if (options.decompose) {
+    // Batch norms and bias adds are folded into the convolutions that they
+    // follow before they are decomposed into elementwise ops.
+    pm.addNestedPass<func::FuncOp>(createRecomposeConvolutionEpiloguesPass());
     pm.addNestedPass<func::FuncOp>(
         Torch::createDecomposeComplexOpsPass(options.backendLegalOps));
     pm.addNestedPass<func::FuncOp>(Torch::createRecomposeComplexOpsPass());
@@ -87,12 +94,13 @@ void mlir::torch::Torch::createTorchDynamoExportToTorchBackendPipeline(
 void mlir::torch::Torch::createTorchFunctionToTorchBackendPipeline(
     OpPassManager &pm, const TorchLoweringPipelineOptions &options) {
   // Incorporate user annotations and remove signature Python-isms.
-  pm.addPass(createAdjustCallingConventionsPass());
+  pm.addPass(createAdjustCallingConventionsPass(options.donatedArgs));
   // Perform the bulk of lowering to the backend contract.
   // See the pass documentation for more information.
   pm.addPass(createLowerToBackendContractPass(
       options.maxIterations, options.decompose, options.shapeDtypeRefine,
-      options.backendLegalOps, options.extraLibrary));
+      options.backendLegalOps, options.extraLibrary,
+      options.incrementalBackendContract));
 }
 
 void mlir::torch::Torch::createTorchOnnxToTorchBackendPipeline(
@@ -167,7 +175,8 @@ void mlir::torch::Torch::createTorchSimplificationPipeline(
   pm.addNestedPass<func::FuncOp>(createRecomposeComplexOpsPass());
   // Reduce variants of ops to a smaller set of primitives.
   pm.addNestedPass<func::FuncOp>(
-      createReduceOpVariantsPass(options.extraLibrary));
+      createReduceOpVariantsPass(options.extraLibrary,
+                                 options.inplaceDestinations));
   pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
   // Remove dead global slots.
   pm.addPass(createSymbolDCEPass());
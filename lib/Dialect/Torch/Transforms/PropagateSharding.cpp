@@ -0,0 +1,234 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Pass/Pass.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/SmallBitVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_PROPAGATESHARDING
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+static constexpr StringLiteral kShardingAttr = "torch.sharding";
+
+// The mesh axis that each dim of a tensor is split over, or -1 for the dims
+// that are replicated.
+using Sharding = SmallVector<int64_t>;
+
+static bool isElementwise(Operation *op) {
+  return isa<AtenTanhOp, AtenSigmoidOp, AtenReluOp, AtenGeluOp, AtenSiluOp,
+             AtenExpOp, AtenExpm1Op, AtenLogOp, AtenLog1pOp, AtenSqrtOp,
+             AtenRsqrtOp, AtenNegOp, AtenAbsOp, AtenErfOp, AtenSinOp,
+             AtenCosOp, AtenReciprocalOp, AtenFloorOp, AtenCeilOp,
+             AtenRoundOp, AtenToDtypeOp, AtenClampOp, AtenAddTensorOp,
+             AtenSubTensorOp, AtenMulTensorOp, AtenDivTensorOp, AtenMaximumOp,
+             AtenMinimumOp, AtenAddScalarOp, AtenSubScalarOp, AtenMulScalarOp,
+             AtenDivScalarOp, AtenRsubScalarOp, AtenPowTensorScalarOp,
+             AtenPowTensorTensorOp, AtenWhereSelfOp, AtenEqTensorOp,
+             AtenNeTensorOp, AtenGtTensorOp, AtenGeTensorOp, AtenLtTensorOp,
+             AtenLeTensorOp, AtenEqScalarOp, AtenNeScalarOp, AtenGtScalarOp,
+             AtenGeScalarOp, AtenLtScalarOp, AtenLeScalarOp,
+             AtenLogicalNotOp, AtenBitwiseNotOp, AtenCloneOp>(op);
+}
+
+// Returns the sharding of `value`, from the argument attributes of its
+// function or the attributes of the op defining it.
+static std::optional<Sharding> getSharding(Value value) {
+  auto type = dyn_cast<ValueTensorType>(value.getType());
+  if (!type || !type.hasSizes())
+    return std::nullopt;
+  DenseI64ArrayAttr attr;
+  if (auto arg = dyn_cast<BlockArgument>(value)) {
+    auto func = dyn_cast<func::FuncOp>(arg.getOwner()->getParentOp());
+    if (func && arg.getOwner()->isEntryBlock())
+      attr = func.getArgAttrOfType<DenseI64ArrayAttr>(arg.getArgNumber(),
+                                                      kShardingAttr);
+  } else if (value.getDefiningOp()->getNumResults() == 1) {
+    attr = value.getDefiningOp()->getAttrOfType<DenseI64ArrayAttr>(
+        kShardingAttr);
+  }
+  if (!attr || attr.size() != (int64_t)type.getSizes().size())
+    return std::nullopt;
+  return Sharding(attr.asArrayRef());
+}
+
+// Sets `dims` of `result` to the sharding of dims `operandDims` of `operand`,
+// for the dims of `result` that are not sharded yet.
+static void shardLike(Sharding &result, ArrayRef<int64_t> dims, Value operand,
+                      ArrayRef<int64_t> operandDims) {
+  std::optional<Sharding> sharding = getSharding(operand);
+  if (!sharding)
+    return;
+  for (auto [dim, operandDim] : llvm::zip_equal(dims, operandDims)) {
+    if (result[dim] == -1)
+      result[dim] = (*sharding)[operandDim];
+  }
+}
+
+// The sharding of the result of an elementwise op: each dim is split like
+// the matching dim of the first operand sharded along it, where operands are
+// aligned to the trailing dims of the result and broadcast dims are skipped.
+static void shardElementwise(Operation *op, Sharding &result) {
+  int64_t rank = result.size();
+  for (Value operand : op->getOperands()) {
+    auto type = dyn_cast<ValueTensorType>(operand.getType());
+    if (!type || !type.hasSizes())
+      continue;
+    ArrayRef<int64_t> sizes = type.getSizes();
+    int64_t operandRank = sizes.size();
+    if (operandRank > rank)
+      continue;
+    SmallVector<int64_t> dims, operandDims;
+    for (int64_t operandDim = 0; operandDim < operandRank; ++operandDim) {
+      if (sizes[operandDim] == 1)
+        continue;
+      dims.push_back(rank - operandRank + operandDim);
+      operandDims.push_back(operandDim);
+    }
+    shardLike(result, dims, operand, operandDims);
+  }
+}
+
+// The sharding of the result of a matmul of `lhs` and `rhs` whose batch dims
+// broadcast, with the rows of `lhs` and the columns of `rhs`. `rhsColumnsDim`
+// is the dim of `rhs` holding its columns.
+static void shardMatmul(Value lhs, Value rhs, int64_t rhsColumnsDim,
+                        Sharding &result) {
+  auto lhsType = dyn_cast<ValueTensorType>(lhs.getType());
+  auto rhsType = dyn_cast<ValueTensorType>(rhs.getType());
+  if (!lhsType || !lhsType.hasSizes() || !rhsType || !rhsType.hasSizes())
+    return;
+  int64_t rank = result.size();
+  int64_t lhsRank = lhsType.getSizes().size();
+  int64_t rhsRank = rhsType.getSizes().size();
+  if (lhsRank < 2 || rhsRank < 2 || rank < 2)
+    return;
+  shardLike(result, {rank - 2}, lhs, {lhsRank - 2});
+  shardLike(result, {rank - 1}, rhs, {rhsColumnsDim});
+  for (auto [operand, operandRank] :
+       {std::make_pair(lhs, lhsRank), std::make_pair(rhs, rhsRank)}) {
+    SmallVector<int64_t> dims, operandDims;
+    for (int64_t operandDim = 0; operandDim < operandRank - 2; ++operandDim) {
+      dims.push_back(rank - operandRank + operandDim);
+      operandDims.push_back(operandDim);
+    }
+    shardLike(result, dims, operand, operandDims);
+  }
+}
+
+// The sharding of the result of a reduction of `self` over `dimList`: the
+// reduced dims are dropped, or replicated if `keepdim` holds.
+static void shardReduction(Value self, Value dimList, Value keepdimValue,
+                           Sharding &result) {
+  std::optional<Sharding> sharding = getSharding(self);
+  SmallVector<int64_t> reduced;
+  bool keepdim;
+  if (!sharding ||
+      !matchPattern(dimList, m_TorchListOfConstantInts(reduced)) ||
+      !matchPattern(keepdimValue, m_TorchConstantBool(&keepdim)))
+    return;
+  int64_t rank = sharding->size();
+  llvm::SmallBitVector isReduced(rank, reduced.empty());
+  for (int64_t dim : reduced) {
+    if (!isValidDim(dim, rank))
+      return;
+    isReduced.set(toPositiveDim(dim, rank));
+  }
+  Sharding kept;
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    if (!isReduced[dim])
+      kept.push_back((*sharding)[dim]);
+    else if (keepdim)
+      kept.push_back(-1);
+  }
+  if (kept.size() == result.size())
+    result = kept;
+}
+
+// Returns the sharding of the single result of `op` implied by the shardings
+// of its operands, if any.
+static std::optional<Sharding> inferSharding(Operation *op) {
+  if (op->getNumResults() != 1)
+    return std::nullopt;
+  auto type = dyn_cast<ValueTensorType>(op->getResult(0).getType());
+  if (!type || !type.hasSizes() || type.getSizes().empty())
+    return std::nullopt;
+  Sharding result(type.getSizes().size(), -1);
+  if (isElementwise(op)) {
+    shardElementwise(op, result);
+  } else if (auto mm = dyn_cast<AtenMmOp>(op)) {
+    shardMatmul(mm.getSelf(), mm.getMat2(), 1, result);
+  } else if (auto bmm = dyn_cast<AtenBmmOp>(op)) {
+    shardMatmul(bmm.getSelf(), bmm.getMat2(), 2, result);
+  } else if (auto matmul = dyn_cast<AtenMatmulOp>(op)) {
+    auto otherType = dyn_cast<ValueTensorType>(matmul.getOther().getType());
+    if (otherType && otherType.hasSizes())
+      shardMatmul(matmul.getSelf(), matmul.getOther(),
+                  otherType.getSizes().size() - 1, result);
+  } else if (auto linear = dyn_cast<AtenLinearOp>(op)) {
+    // The weight holds the output features in its rows, and the leading dims
+    // of the input are batch dims.
+    auto inputType = dyn_cast<ValueTensorType>(linear.getInput().getType());
+    if (inputType && inputType.hasSizes() &&
+        inputType.getSizes().size() == result.size()) {
+      SmallVector<int64_t> batchDims =
+          llvm::to_vector(llvm::seq<int64_t>(0, result.size() - 1));
+      shardLike(result, batchDims, linear.getInput(), batchDims);
+      shardLike(result, {(int64_t)result.size() - 1}, linear.getWeight(), {0});
+    }
+  } else if (auto sum = dyn_cast<AtenSumDimIntListOp>(op)) {
+    shardReduction(sum.getSelf(), sum.getDim(), sum.getKeepdim(), result);
+  } else if (auto mean = dyn_cast<AtenMeanDimOp>(op)) {
+    shardReduction(mean.getSelf(), mean.getDim(), mean.getKeepdim(), result);
+  } else if (auto amax = dyn_cast<AtenAmaxOp>(op)) {
+    shardReduction(amax.getSelf(), amax.getDim(), amax.getKeepdim(), result);
+  } else if (auto amin = dyn_cast<AtenAminOp>(op)) {
+    shardReduction(amin.getSelf(), amin.getDim(), amin.getKeepdim(), result);
+  } else {
+    return std::nullopt;
+  }
+
+  // A mesh axis splits at most one dim; later uses are replicated instead.
+  llvm::SmallDenseSet<int64_t> usedAxes;
+  for (int64_t &axis : result) {
+    if (axis != -1 && !usedAxes.insert(axis).second)
+      axis = -1;
+  }
+  if (usedAxes.empty())
+    return std::nullopt;
+  return result;
+}
+
+namespace {
+class PropagateShardingPass
+    : public impl::PropagateShardingBase<PropagateShardingPass> {
+  void runOnOperation() override {
+    getOperation().walk<WalkOrder::PreOrder>([](Operation *op) {
+      if (op->hasAttr(kShardingAttr))
+        return;
+      if (std::optional<Sharding> sharding = inferSharding(op))
+        op->setAttr(kShardingAttr,
+                    DenseI64ArrayAttr::get(op->getContext(), *sharding));
+    });
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createPropagateShardingPass() {
+  return std::make_unique<PropagateShardingPass>();
+}
+
+} // namespace mlir::torch::Torch
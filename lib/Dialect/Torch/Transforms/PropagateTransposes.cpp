@@ -0,0 +1,353 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "llvm/ADT/SmallBitVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_PROPAGATETRANSPOSES
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+namespace {
+// A permute or transpose of a value tensor: dim `i` of the result is dim
+// `perms[i]` of `input`.
+struct Permutation {
+  Value input;
+  SmallVector<int64_t> perms;
+};
+} // namespace
+
+static std::optional<Permutation> matchPermutation(Value value) {
+  auto type = dyn_cast<ValueTensorType>(value.getType());
+  if (!type || !type.hasSizes())
+    return std::nullopt;
+  int64_t rank = type.getSizes().size();
+  if (auto permute = value.getDefiningOp<AtenPermuteOp>()) {
+    SmallVector<int64_t> perms;
+    if (!matchPattern(permute.getDims(), m_TorchListOfConstantInts(perms)) ||
+        (int64_t)perms.size() != rank)
+      return std::nullopt;
+    for (int64_t &dim : perms) {
+      if (!isValidDim(dim, rank))
+        return std::nullopt;
+      dim = toPositiveDim(dim, rank);
+    }
+    if (!isPermutationVector(perms))
+      return std::nullopt;
+    return Permutation{permute.getSelf(), perms};
+  }
+  if (auto transpose = value.getDefiningOp<AtenTransposeIntOp>()) {
+    int64_t dim0, dim1;
+    if (!matchPattern(transpose.getDim0(), m_TorchConstantInt(&dim0)) ||
+        !matchPattern(transpose.getDim1(), m_TorchConstantInt(&dim1)) ||
+        !isValidDim(dim0, rank) || !isValidDim(dim1, rank))
+      return std::nullopt;
+    SmallVector<int64_t> perms = llvm::to_vector(llvm::seq<int64_t>(0, rank));
+    std::swap(perms[toPositiveDim(dim0, rank)],
+              perms[toPositiveDim(dim1, rank)]);
+    return Permutation{transpose.getSelf(), perms};
+  }
+  return std::nullopt;
+}
+
+// Whether the permutation producing `value` is only there for `user`, so
+// that moving it past `user` does not leave a copy behind.
+static bool isOnlyUsedBy(Value value, Operation *user) {
+  return llvm::all_of(value.getUsers(),
+                      [&](Operation *other) { return other == user; });
+}
+
+static Value createIntList(PatternRewriter &rewriter, Location loc,
+                           ArrayRef<int64_t> values) {
+  SmallVector<Value> elements;
+  for (int64_t value : values)
+    elements.push_back(Torch::ConstantIntOp::create(
+        rewriter, loc, rewriter.getI64IntegerAttr(value)));
+  Type listType = Torch::ListType::get(rewriter.getType<Torch::IntType>());
+  return PrimListConstructOp::create(rewriter, loc, listType, elements);
+}
+
+// Returns `input` permuted by `perms`, with the result type `resultType`.
+static Value createPermute(PatternRewriter &rewriter, Location loc,
+                           Type resultType, Value input,
+                           ArrayRef<int64_t> perms) {
+  if (isIdentityPermutation(perms)) {
+    if (input.getType() == resultType)
+      return input;
+    return TensorStaticInfoCastOp::create(rewriter, loc, resultType, input);
+  }
+  return AtenPermuteOp::create(rewriter, loc, resultType, input,
+                               createIntList(rewriter, loc, perms));
+}
+
+// Returns the type of `value`'s result before it gets permuted by `perms`.
+static FailureOr<Type> getUnpermutedType(Value value, ArrayRef<int64_t> perms) {
+  Type unpermutedType;
+  if (failed(getPermutedType(cast<BaseTensorType>(value.getType()),
+                             invertPermutationVector(perms), unpermutedType)))
+    return failure();
+  return unpermutedType;
+}
+
+// Ops whose result elements only depend on the operand elements at the same
+// position (after broadcasting), so that they commute with permutations.
+static bool isElementwise(Operation *op) {
+  return isa<AtenTanhOp, AtenSigmoidOp, AtenReluOp, AtenGeluOp, AtenExpOp,
+             AtenExpm1Op, AtenLogOp, AtenLog1pOp, AtenSqrtOp, AtenRsqrtOp,
+             AtenNegOp, AtenAbsOp, AtenErfOp, AtenSinOp, AtenCosOp,
+             AtenReciprocalOp, AtenFloorOp, AtenCeilOp, AtenRoundOp,
+             AtenToDtypeOp, AtenClampOp, AtenAddTensorOp, AtenSubTensorOp,
+             AtenMulTensorOp, AtenDivTensorOp, AtenMaximumOp, AtenMinimumOp,
+             AtenAddScalarOp, AtenSubScalarOp, AtenMulScalarOp,
+             AtenDivScalarOp, AtenRsubScalarOp, AtenPowTensorScalarOp,
+             AtenPowTensorTensorOp, AtenWhereSelfOp, AtenEqTensorOp,
+             AtenNeTensorOp, AtenGtTensorOp, AtenGeTensorOp, AtenLtTensorOp,
+             AtenLeTensorOp, AtenEqScalarOp, AtenNeScalarOp, AtenGtScalarOp,
+             AtenGeScalarOp, AtenLtScalarOp, AtenLeScalarOp,
+             AtenLogicalNotOp, AtenBitwiseNotOp, AtenCloneOp>(op);
+}
+
+namespace {
+// permute(permute(x)) -> permute(x), or x when the two cancel.
+template <typename OpTy>
+class ComposePermutations : public OpRewritePattern<OpTy> {
+public:
+  using OpRewritePattern<OpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<Permutation> outer = matchPermutation(op.getResult());
+    if (!outer)
+      return failure();
+    std::optional<Permutation> inner = matchPermutation(outer->input);
+    if (!inner)
+      return failure();
+    SmallVector<int64_t> perms = applyPermutation(inner->perms, outer->perms);
+    rewriter.replaceOp(op, createPermute(rewriter, op.getLoc(), op.getType(),
+                                         inner->input, perms));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// elementwise(permute(x), permute(y), scalar) ->
+//   permute(elementwise(x, y, scalar))
+//
+// All the operands of the rank of the result have to be permuted the same
+// way. Rank-0 tensors are left alone, and anything else that broadcasts is
+// not handled.
+class SinkPermutationThroughElementwise : public RewritePattern {
+public:
+  SinkPermutationThroughElementwise(MLIRContext *context)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context) {}
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    if (!isElementwise(op) || op->getNumResults() != 1)
+      return failure();
+    auto resultType = dyn_cast<ValueTensorType>(op->getResult(0).getType());
+    if (!resultType || !resultType.hasSizes())
+      return failure();
+    size_t rank = resultType.getSizes().size();
+
+    std::optional<SmallVector<int64_t>> perms;
+    IRMapping mapping;
+    for (Value operand : op->getOperands()) {
+      auto operandType = dyn_cast<BaseTensorType>(operand.getType());
+      if (!operandType)
+        continue;
+      if (!operandType.hasSizes())
+        return failure();
+      if (operandType.getSizes().empty())
+        continue;
+      std::optional<Permutation> permutation = matchPermutation(operand);
+      if (!permutation || permutation->perms.size() != rank ||
+          (perms && *perms != permutation->perms) ||
+          !isOnlyUsedBy(operand, op))
+        return failure();
+      perms = permutation->perms;
+      mapping.map(operand, permutation->input);
+    }
+    if (!perms)
+      return failure();
+
+    FailureOr<Type> newResultType = getUnpermutedType(op->getResult(0), *perms);
+    if (failed(newResultType))
+      return failure();
+    Operation *newOp = rewriter.clone(*op, mapping);
+    newOp->getResult(0).setType(*newResultType);
+    rewriter.replaceOp(op, createPermute(rewriter, op->getLoc(), resultType,
+                                         newOp->getResult(0), *perms));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// reduce(permute(x), dims) -> permute(reduce(x, perms[dims]))
+//
+// Without `keepdim`, the permutation that is left afterwards only orders the
+// dims that are not reduced, and disappears when they keep their order.
+template <typename OpTy>
+class SinkPermutationThroughReduction : public OpRewritePattern<OpTy> {
+public:
+  using OpRewritePattern<OpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    std::optional<Permutation> permutation = matchPermutation(op.getSelf());
+    if (!permutation || !isOnlyUsedBy(op.getSelf(), op))
+      return failure();
+    ArrayRef<int64_t> perms = permutation->perms;
+    int64_t rank = perms.size();
+    bool keepDim;
+    if (!matchPattern(op.getKeepdim(), m_TorchConstantBool(&keepDim)))
+      return failure();
+    auto resultType = dyn_cast<ValueTensorType>(op.getType());
+    if (!resultType || !resultType.hasSizes())
+      return failure();
+
+    SmallVector<int64_t> dims;
+    bool reducesAllDims = isa<Torch::NoneType>(op.getDim().getType());
+    if (!reducesAllDims) {
+      if (!matchPattern(op.getDim(), m_TorchListOfConstantInts(dims)))
+        return failure();
+      reducesAllDims = dims.empty();
+    }
+    Location loc = op.getLoc();
+    if (reducesAllDims) {
+      rewriter.modifyOpInPlace(
+          op, [&]() { op.getSelfMutable().set(permutation->input); });
+      return success();
+    }
+
+    llvm::SmallBitVector reduced(rank);
+    SmallVector<int64_t> newDims;
+    for (int64_t dim : dims) {
+      if (!isValidDim(dim, rank))
+        return failure();
+      dim = toPositiveDim(dim, rank);
+      reduced.set(dim);
+      newDims.push_back(perms[dim]);
+    }
+    llvm::sort(newDims);
+
+    // Dim `i` of the result is dim `resultPerms[i]` of the new reduction.
+    SmallVector<int64_t> resultPerms;
+    if (keepDim) {
+      resultPerms.assign(perms.begin(), perms.end());
+    } else {
+      SmallVector<int64_t> keptDims;
+      for (int64_t dim = 0; dim < rank; ++dim) {
+        if (!reduced.test(dim))
+          keptDims.push_back(perms[dim]);
+      }
+      SmallVector<int64_t> sortedKeptDims(keptDims);
+      llvm::sort(sortedKeptDims);
+      for (int64_t dim : keptDims)
+        resultPerms.push_back(llvm::find(sortedKeptDims, dim) -
+                              sortedKeptDims.begin());
+    }
+    FailureOr<Type> newResultType =
+        getUnpermutedType(op.getResult(), resultPerms);
+    if (failed(newResultType))
+      return failure();
+
+    IRMapping mapping;
+    mapping.map(op.getSelf(), permutation->input);
+    mapping.map(op.getDim(), createIntList(rewriter, loc, newDims));
+    Operation *newOp = rewriter.clone(*op, mapping);
+    newOp->getResult(0).setType(*newResultType);
+    rewriter.replaceOp(op, createPermute(rewriter, loc, resultType,
+                                         newOp->getResult(0), resultPerms));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// matmul(transpose(a), transpose(b)) -> transpose(matmul(b, a)), where the
+// transposes swap the two matrix dims, which trades two transposes for one.
+template <typename OpTy>
+class SwapTransposedMatmulOperands : public OpRewritePattern<OpTy> {
+public:
+  using OpRewritePattern<OpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    Value lhs = op->getOperand(0);
+    Value rhs = op->getOperand(1);
+    std::optional<Permutation> lhsPermutation = matchPermutation(lhs);
+    std::optional<Permutation> rhsPermutation = matchPermutation(rhs);
+    if (!lhsPermutation || !rhsPermutation || lhs == rhs ||
+        !isOnlyUsedBy(lhs, op) || !isOnlyUsedBy(rhs, op))
+      return failure();
+    int64_t rank = lhsPermutation->perms.size();
+    if (rank < 2 || (int64_t)rhsPermutation->perms.size() != rank)
+      return failure();
+    SmallVector<int64_t> perms = llvm::to_vector(llvm::seq<int64_t>(0, rank));
+    std::swap(perms[rank - 2], perms[rank - 1]);
+    if (lhsPermutation->perms != perms || rhsPermutation->perms != perms)
+      return failure();
+    auto resultType = dyn_cast<ValueTensorType>(op.getType());
+    if (!resultType || !resultType.hasSizes() ||
+        (int64_t)resultType.getSizes().size() != rank)
+      return failure();
+
+    FailureOr<Type> newResultType = getUnpermutedType(op.getResult(), perms);
+    if (failed(newResultType))
+      return failure();
+    Location loc = op.getLoc();
+    Value matmul = OpTy::create(rewriter, loc, *newResultType,
+                                rhsPermutation->input, lhsPermutation->input);
+    rewriter.replaceOp(op,
+                       createPermute(rewriter, loc, resultType, matmul, perms));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class PropagateTransposesPass
+    : public impl::PropagateTransposesBase<PropagateTransposesPass> {
+public:
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<ComposePermutations<AtenPermuteOp>,
+                 ComposePermutations<AtenTransposeIntOp>,
+                 SinkPermutationThroughElementwise,
+                 SinkPermutationThroughReduction<AtenSumDimIntListOp>,
+                 SinkPermutationThroughReduction<AtenMeanDimOp>,
+                 SinkPermutationThroughReduction<AtenAmaxOp>,
+                 SinkPermutationThroughReduction<AtenAminOp>,
+                 SwapTransposedMatmulOperands<AtenMmOp>,
+                 SwapTransposedMatmulOperands<AtenBmmOp>,
+                 SwapTransposedMatmulOperands<AtenMatmulOp>>(context);
+
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createPropagateTransposesPass() {
+  return std::make_unique<PropagateTransposesPass>();
+}
+
+} // namespace mlir::torch::Torch
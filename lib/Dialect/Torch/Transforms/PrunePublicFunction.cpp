@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/RegionUtils.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/ADT/BitVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_PRUNEPUBLICFUNCTION
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+namespace {
+class PrunePublicFunctionPass
+    : public impl::PrunePublicFunctionBase<PrunePublicFunctionPass> {
+public:
+  using impl::PrunePublicFunctionBase<
+      PrunePublicFunctionPass>::PrunePublicFunctionBase;
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable moduleTable(module);
+    auto func = moduleTable.lookup<func::FuncOp>(funcName);
+    if (!func || func.isExternal() || !func.isPublic()) {
+      module.emitError() << "no public function named '" << funcName
+                         << "' to prune";
+      return signalPassFailure();
+    }
+    // The callers in the module would need to be rewritten too.
+    auto uses = SymbolTable::getSymbolUses(func, module);
+    if (!uses || !uses->empty()) {
+      func.emitError() << "unimplemented: pruning a function with uses";
+      return signalPassFailure();
+    }
+
+    unsigned numResults = func.getNumResults();
+    llvm::BitVector deadResults(numResults, true);
+    for (int64_t index : keptResults) {
+      if (index < 0 || index >= numResults) {
+        func.emitError() << "kept result " << index << " is out of range for "
+                         << numResults << " results";
+        return signalPassFailure();
+      }
+      deadResults.reset(index);
+    }
+
+    // Stop returning the dead results, and erase the ops that only computed
+    // them. Ops with side effects, e.g. the overwrites of mutated arguments,
+    // are kept.
+    func.walk([&](func::ReturnOp op) { op->eraseOperands(deadResults); });
+    if (failed(func.eraseResults(deadResults)))
+      return signalPassFailure();
+    IRRewriter rewriter(func.getContext());
+    (void)runRegionDCE(rewriter, func.getBody());
+
+    if (!pruneArguments)
+      return;
+    llvm::BitVector deadArguments(func.getNumArguments());
+    for (BlockArgument arg : func.getArguments())
+      if (arg.use_empty())
+        deadArguments.set(arg.getArgNumber());
+    if (failed(func.eraseArguments(deadArguments)))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createPrunePublicFunctionPass() {
+  return std::make_unique<PrunePublicFunctionPass>();
+}
+
+} // namespace mlir::torch::Torch
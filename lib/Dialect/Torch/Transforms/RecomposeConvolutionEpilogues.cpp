@@ -0,0 +1,266 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FoldWeightsUtils.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+#include <cmath>
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_RECOMPOSECONVOLUTIONEPILOGUES
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+// Matches the convolution that defines `value`, if `value` is its only use,
+// so that the convolution can be replaced by one with its epilogue folded in.
+static AtenConvolutionOp matchSingleUseConvolution(Value value) {
+  auto convolution = value.getDefiningOp<AtenConvolutionOp>();
+  if (!convolution || !convolution->hasOneUse())
+    return nullptr;
+  return convolution;
+}
+
+// Reads the `numChannels` values of `value`, a float literal of shape
+// [numChannels], or `defaultValue` for each channel when it is None.
+static std::optional<SmallVector<double>>
+matchChannelValues(Value value, int64_t numChannels, double defaultValue) {
+  if (isa<Torch::NoneType>(value.getType()))
+    return SmallVector<double>(numChannels, defaultValue);
+  auto literal = value.getDefiningOp<ValueTensorLiteralOp>();
+  if (!literal)
+    return std::nullopt;
+  auto type = dyn_cast<ShapedType>(literal.getValue().getType());
+  if (!type || type.getRank() != 1 || type.getDimSize(0) != numChannels ||
+      !isa<mlir::FloatType>(type.getElementType()))
+    return std::nullopt;
+  if (auto dense = dyn_cast<DenseElementsAttr>(literal.getValue());
+      dense && dense.isSplat())
+    return SmallVector<double>(
+        numChannels, dense.getSplatValue<APFloat>().convertToDouble());
+  std::optional<Weight> weight = matchWeight(value, /*requireOneUse=*/false);
+  if (!weight)
+    return std::nullopt;
+  SmallVector<double> values;
+  for (int64_t i = 0; i < numChannels; ++i)
+    values.push_back(readFloat(weight->data.data(), i, type.getElementType()));
+  return values;
+}
+
+// Creates a convolution like `convolution`, of type `resultType`, with
+// `weight` and `bias`.
+static Value createConvolution(PatternRewriter &rewriter,
+                               AtenConvolutionOp convolution, Type resultType,
+                               Value weight, Value bias) {
+  return AtenConvolutionOp::create(
+      rewriter, convolution.getLoc(), resultType, convolution.getInput(),
+      weight, bias, convolution.getStride(), convolution.getPadding(),
+      convolution.getDilation(), convolution.getTransposed(),
+      convolution.getOutputPadding(), convolution.getGroups());
+}
+
+namespace {
+// Folds an inference batch norm of the result of a convolution with literal
+// weights into the weights and bias of the convolution:
+//
+//   scale = gamma / sqrt(running_var + eps)
+//   weight' = weight * scale (per output channel)
+//   bias' = (bias - running_mean) * scale + beta
+//
+// Only non-transposed convolutions are folded, where the output channels are
+// the first dim of the weight.
+template <typename OpTy>
+class FoldBatchNormIntoConvolution : public OpRewritePattern<OpTy> {
+public:
+  using OpRewritePattern<OpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    bool training, transposed;
+    double eps;
+    if (!matchPattern(op.getTraining(), m_TorchConstantBool(&training)) ||
+        training || !matchPattern(op.getEps(), m_TorchConstantFloat(&eps)))
+      return rewriter.notifyMatchFailure(op, "not an inference batch norm");
+    // The other results of `native_batch_norm` are empty in inference.
+    if (llvm::any_of(op->getResults().drop_front(),
+                     [](Value result) { return !result.use_empty(); }))
+      return rewriter.notifyMatchFailure(op, "saved statistics are used");
+    AtenConvolutionOp convolution = matchSingleUseConvolution(op.getInput());
+    if (!convolution ||
+        !matchPattern(convolution.getTransposed(),
+                      m_TorchConstantBool(&transposed)) ||
+        transposed)
+      return rewriter.notifyMatchFailure(op, "not a convolution");
+    std::optional<Weight> weight =
+        matchWeight(convolution.getWeight(), /*requireOneUse=*/true);
+    if (!weight || weight->getType().getRank() < 1 ||
+        weight->getType().getDimSize(0) == 0 ||
+        !isa<mlir::FloatType>(weight->getType().getElementType()))
+      return rewriter.notifyMatchFailure(op, "weight is not a float literal");
+    if (isa<Torch::NoneType>(op.getRunningMean().getType()) ||
+        isa<Torch::NoneType>(op.getRunningVar().getType()))
+      return rewriter.notifyMatchFailure(op, "no running statistics");
+
+    ShapedType weightType = weight->getType();
+    int64_t numChannels = weightType.getDimSize(0);
+    std::optional<SmallVector<double>> gamma =
+        matchChannelValues(op.getWeight(), numChannels, 1.0);
+    std::optional<SmallVector<double>> beta =
+        matchChannelValues(op.getBias(), numChannels, 0.0);
+    std::optional<SmallVector<double>> mean =
+        matchChannelValues(op.getRunningMean(), numChannels, 0.0);
+    std::optional<SmallVector<double>> var =
+        matchChannelValues(op.getRunningVar(), numChannels, 1.0);
+    std::optional<SmallVector<double>> bias =
+        matchChannelValues(convolution.getBias(), numChannels, 0.0);
+    if (!gamma || !beta || !mean || !var || !bias)
+      return rewriter.notifyMatchFailure(op, "non-literal parameters");
+
+    SmallVector<double> scale, shift;
+    for (int64_t c = 0; c < numChannels; ++c) {
+      scale.push_back((*gamma)[c] / std::sqrt((*var)[c] + eps));
+      shift.push_back(((*bias)[c] - (*mean)[c]) * scale.back() + (*beta)[c]);
+    }
+    Type elementType = weightType.getElementType();
+    int64_t channelSize = weightType.getNumElements() / numChannels;
+    const char *in = weight->data.data();
+    ElementsAttr newWeight = createWeight(
+        op.getContext(), *weight, weightType, "_bn_folded",
+        [&](char *out, int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i)
+            writeFloat(out, i, elementType,
+                       readFloat(in, i, elementType) * scale[i / channelSize]);
+        });
+    ElementsAttr newBias = createWeight(
+        op.getContext(), *weight,
+        RankedTensorType::get({numChannels}, elementType), "_bn_bias",
+        [&](char *out, int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i)
+            writeFloat(out, i, elementType, shift[i]);
+        });
+
+    Location loc = op.getLoc();
+    Value weightLiteral =
+        ValueTensorLiteralOp::create(rewriter, loc, newWeight);
+    Value biasLiteral = ValueTensorLiteralOp::create(rewriter, loc, newBias);
+    Value folded =
+        createConvolution(rewriter, convolution, op->getResult(0).getType(),
+                          weightLiteral, biasLiteral);
+    rewriter.replaceAllUsesWith(op->getResult(0), folded);
+    rewriter.eraseOp(op);
+    rewriter.eraseOp(convolution);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Recomposes the add of a per-channel bias to the result of a convolution,
+// e.g. of a bias of shape [C, 1, 1] to an [N, C, H, W] result, into the bias
+// of the convolution, so that the activation that follows, e.g. a `relu` or
+// `clamp`, directly consumes the convolution as its epilogue.
+class RecomposeConvolutionBiasAdd : public OpRewritePattern<AtenAddTensorOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(AtenAddTensorOp op,
+                                PatternRewriter &rewriter) const override {
+    double alpha;
+    if (!matchPattern(op.getAlpha(), m_TorchConstantFloat(&alpha))) {
+      int64_t intAlpha;
+      if (!matchPattern(op.getAlpha(), m_TorchConstantInt(&intAlpha)))
+        return rewriter.notifyMatchFailure(op, "non-constant alpha");
+      alpha = intAlpha;
+    }
+    if (alpha != 1.0)
+      return rewriter.notifyMatchFailure(op, "alpha is not 1");
+    Value other = op.getOther();
+    AtenConvolutionOp convolution = matchSingleUseConvolution(op.getSelf());
+    if (!convolution) {
+      other = op.getSelf();
+      convolution = matchSingleUseConvolution(op.getOther());
+    }
+    if (!convolution)
+      return rewriter.notifyMatchFailure(op, "not an add to a convolution");
+
+    auto resultType = dyn_cast<ValueTensorType>(convolution.getType());
+    auto otherType = dyn_cast<ValueTensorType>(other.getType());
+    if (!resultType || !otherType || !resultType.hasSizes() ||
+        !resultType.hasDtype() || !otherType.areAllSizesKnown() ||
+        otherType.getOptionalDtype() != resultType.getDtype() ||
+        op.getType() != resultType)
+      return rewriter.notifyMatchFailure(op, "unsupported types");
+    ArrayRef<int64_t> resultSizes = resultType.getSizes();
+    ArrayRef<int64_t> otherSizes = otherType.getSizes();
+    int64_t rank = resultSizes.size();
+    // The channel dim of `other` once it is broadcast to the result.
+    int64_t channelDim = 1 - (rank - static_cast<int64_t>(otherSizes.size()));
+    if (rank < 2 || resultSizes[1] == kUnknownSize || channelDim < 0 ||
+        channelDim >= static_cast<int64_t>(otherSizes.size()))
+      return rewriter.notifyMatchFailure(op, "not a per-channel bias");
+    int64_t numChannels = resultSizes[1];
+    for (auto [dim, size] : llvm::enumerate(otherSizes)) {
+      if (size != (static_cast<int64_t>(dim) == channelDim ? numChannels : 1))
+        return rewriter.notifyMatchFailure(op, "not a per-channel bias");
+    }
+
+    Location loc = op.getLoc();
+    Type biasType =
+        resultType.getWithSizesAndDtype({numChannels}, resultType.getDtype());
+    Value numChannelsValue = ConstantIntOp::create(
+        rewriter, loc, rewriter.getI64IntegerAttr(numChannels));
+    Value biasSizes = PrimListConstructOp::create(
+        rewriter, loc, Torch::ListType::get(numChannelsValue.getType()),
+        numChannelsValue);
+    Value bias = AtenViewOp::create(rewriter, loc, biasType, other, biasSizes);
+    if (!isa<Torch::NoneType>(convolution.getBias().getType())) {
+      Value one = ConstantIntOp::create(rewriter, loc,
+                                        rewriter.getI64IntegerAttr(1));
+      bias = AtenAddTensorOp::create(rewriter, loc, biasType,
+                                     convolution.getBias(), bias, one);
+    }
+    rewriter.replaceOp(op, createConvolution(rewriter, convolution,
+                                             op.getType(),
+                                             convolution.getWeight(), bias));
+    rewriter.eraseOp(convolution);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class RecomposeConvolutionEpiloguesPass
+    : public impl::RecomposeConvolutionEpiloguesBase<
+          RecomposeConvolutionEpiloguesPass> {
+public:
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<FoldBatchNormIntoConvolution<AtenNativeBatchNormOp>,
+                 FoldBatchNormIntoConvolution<AtenBatchNormOp>,
+                 RecomposeConvolutionBiasAdd>(context);
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createRecomposeConvolutionEpiloguesPass() {
+  return std::make_unique<RecomposeConvolutionEpiloguesPass>();
+}
+
+} // namespace mlir::torch::Torch
@@ -24,6 +24,9 @@ namespace mlir::torch::Torch {
 #define GEN_PASS_DEF_REDUCEOPVARIANTS
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
 
+static constexpr StringLiteral kInplaceDestinationAttr =
+    "torch.inplace_destination";
+
 // Create an overwrite in a manner that preserves the
 // `OverwriteTensorContentsOp` invariant that both arguments
 // must have the same shape and dtype.
@@ -346,8 +349,10 @@ namespace {
 // variant + an overwrite of the original "self" argument.
 class ReduceTrailingUnderscoreInplaceVariant : public RewritePattern {
 public:
-  ReduceTrailingUnderscoreInplaceVariant(MLIRContext *context)
-      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context) {}
+  ReduceTrailingUnderscoreInplaceVariant(MLIRContext *context,
+                                         bool markInplaceDestinations)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context),
+        markInplaceDestinations(markInplaceDestinations) {}
   LogicalResult matchAndRewrite(Operation *op,
                                 PatternRewriter &rewriter) const override {
     if (!op->hasTrait<Torch::OpTrait::IsTrailingUnderscoreInplaceVariant>())
@@ -369,6 +374,10 @@ public:
            "Torch JIT operators shouldn't have regions or successors");
 
     Operation *newOp = rewriter.create(state);
+    // The result of the in-place op was its first operand, whose buffer the
+    // backends may reuse for the result.
+    if (markInplaceDestinations)
+      newOp->setAttr(kInplaceDestinationAttr, rewriter.getUnitAttr());
     // Note: need to convert result to first input's dtype because mix precision
     // compute would result in different behaviors.
     // For example:
@@ -392,6 +401,9 @@ public:
 
     return success();
   }
+
+private:
+  bool markInplaceDestinations;
 };
 } // namespace
 
@@ -428,7 +440,8 @@ struct ReduceOpVariantsPass
     }
     patterns.add<ConvertHasValueSemanticsOpsToValueTensors>(
         context, extraLibraryModuleSymTable);
-    patterns.add<ReduceTrailingUnderscoreInplaceVariant>(context);
+    patterns.add<ReduceTrailingUnderscoreInplaceVariant>(
+        context, markInplaceDestinations);
     patterns.add(reduceNonValueTensorLiteralOpToValueTensorLiteralOp);
     patterns.add<ReduceNonValueSemanticOps>(context);
 
@@ -483,9 +496,11 @@ struct ReduceOpVariantsPass
 } // namespace
 
 std::unique_ptr<OperationPass<func::FuncOp>>
-createReduceOpVariantsPass(StringRef extraLibrary) {
+createReduceOpVariantsPass(StringRef extraLibrary,
+                           bool markInplaceDestinations) {
   ReduceOpVariantsOptions options;
   options.extraLibrary = extraLibrary.str();
+  options.markInplaceDestinations = markInplaceDestinations;
   return std::make_unique<ReduceOpVariantsPass>(options);
 }
 
@@ -8,8 +8,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "ReifyAbstractInterpCalculationsUtils.h"
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Parser/Parser.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -19,6 +23,29 @@ using namespace mlir;
 using namespace mlir::torch;
 using namespace mlir::torch::Torch;
 
+CachedLibrary::CachedLibrary(OwningOpRef<ModuleOp> module,
+                             std::unique_ptr<ParserConfig> lazyReaderConfig,
+                             std::unique_ptr<BytecodeReader> lazyReader)
+    : module(std::move(module)), symbolTable(*this->module),
+      lazyReaderConfig(std::move(lazyReaderConfig)),
+      lazyReader(std::move(lazyReader)) {}
+
+CachedLibrary::~CachedLibrary() {
+  // Drop the functions that were never materialized before tearing down the
+  // reader that tracks them.
+  if (lazyReader)
+    (void)lazyReader->finalize([](Operation *) { return false; });
+}
+
+LogicalResult CachedLibrary::materialize(Operation *op) {
+  if (!lazyReader)
+    return success();
+  std::lock_guard<std::mutex> lock(materializeMutex);
+  if (!lazyReader->isMaterializable(op))
+    return success();
+  return lazyReader->materialize(op, [](Operation *) { return false; });
+}
+
 std::string
 mlir::torch::Torch::getLibraryFunctionPrefix(LibraryFunctionKind libFuncKind) {
   if (libFuncKind == LibraryFunctionKind::ShapeFunction)
@@ -66,7 +93,7 @@ createCalculateYieldCalculationOp(OpBuilder &b, Location loc,
 }
 
 LogicalResult Torch::wrapWithCalculateOpIfLibraryFunctionAvailable(
-    Operation *op, ModuleOp library, LibraryFunctionKind libFuncKind,
+    Operation *op, const SymbolTable &library, LibraryFunctionKind libFuncKind,
     SmallVector<std::string> &libFuncNamesUsed,
     function_ref<FailureOr<SmallVector<Value>>(OpBuilder &, Location,
                                                ValueRange, func::FuncOp)>
@@ -84,7 +111,7 @@ LogicalResult Torch::wrapWithCalculateOpIfLibraryFunctionAvailable(
     name = cast<StringAttr>(cast<OperatorOp>(op)->getAttr("name")).getValue();
   std::string libFuncName =
       (getLibraryFunctionPrefix(libFuncKind) + Twine(name)).str();
-  auto libFunc = library.lookupSymbol<func::FuncOp>(libFuncName);
+  auto libFunc = library.lookup<func::FuncOp>(libFuncName);
   if (!libFunc)
     return success();
   libFuncNamesUsed.push_back(libFuncName);
@@ -132,8 +159,77 @@ LogicalResult Torch::wrapWithCalculateOpIfLibraryFunctionAvailable(
   return success();
 }
 
-void Torch::importLibraryFunctions(ModuleOp module, ModuleOp library,
-                                   SmallVector<std::string> functionsNeeded) {
+LogicalResult Torch::reifyLibraryCalculations(
+    ModuleOp module, CachedLibrary &library, LibraryFunctionKind funcKind,
+    function_ref<FailureOr<SmallVector<Value>>(OpBuilder &, Location,
+                                               ValueRange, func::FuncOp)>
+        libFuncArgsBuilder,
+    function_ref<bool(Operation *)> resolveNatively) {
+  auto wrapAll = [&](Operation *root,
+                     SmallVector<std::string> &functionsNeeded) {
+    WalkResult walkResult = root->walk([&](Operation *op) -> WalkResult {
+      if (resolveNatively && resolveNatively(op))
+        return WalkResult::advance();
+      return wrapWithCalculateOpIfLibraryFunctionAvailable(
+          op, library.symbolTable, funcKind, functionsNeeded,
+          libFuncArgsBuilder);
+    });
+    return failure(walkResult.wasInterrupted());
+  };
+
+  // Functions are independent of each other, so they are sharded across
+  // threads, each collecting the library functions it needs separately. Any
+  // other top-level ops (such as module initializers) are handled
+  // sequentially afterwards.
+  SmallVector<Operation *> topLevelOps;
+  SmallVector<size_t> funcIndices;
+  for (Operation &op : module.getOps()) {
+    if (isa<func::FuncOp>(op))
+      funcIndices.push_back(topLevelOps.size());
+    topLevelOps.push_back(&op);
+  }
+
+  SmallVector<SmallVector<std::string>> functionsNeededPerOp(
+      topLevelOps.size());
+  if (failed(failableParallelForEach(
+          module.getContext(), funcIndices, [&](size_t i) {
+            return wrapAll(topLevelOps[i], functionsNeededPerOp[i]);
+          })))
+    return failure();
+  for (auto [op, functionsNeeded] :
+       llvm::zip_equal(topLevelOps, functionsNeededPerOp)) {
+    if (!isa<func::FuncOp>(op) && failed(wrapAll(op, functionsNeeded)))
+      return failure();
+  }
+
+  // Concatenate in module order to keep the import order deterministic.
+  SmallVector<std::string> functionsNeeded;
+  for (SmallVector<std::string> &names : functionsNeededPerOp)
+    llvm::append_range(functionsNeeded, names);
+  return importLibraryFunctions(module, library, std::move(functionsNeeded));
+}
+
+void Torch::refineResultTypeInPlace(Operation *op, BaseTensorType newType) {
+  Value result = op->getResult(0);
+  Type originalType = result.getType();
+  Value originalTypedValue;
+  for (OpOperand &use : llvm::make_early_inc_range(result.getUses())) {
+    if (use.getOwner()->hasTrait<Torch::OpTrait::AllowsTypeRefinement>())
+      continue;
+    if (!originalTypedValue) {
+      OpBuilder b(op->getContext());
+      b.setInsertionPointAfter(op);
+      originalTypedValue = TensorStaticInfoCastOp::create(
+          b, op->getLoc(), originalType, result);
+    }
+    use.set(originalTypedValue);
+  }
+  result.setType(newType);
+}
+
+LogicalResult
+Torch::importLibraryFunctions(ModuleOp module, CachedLibrary &library,
+                              SmallVector<std::string> functionsNeeded) {
   // Import just the functions we need. This includes transitive callees,
   // so we use a worklist algorithm.
   llvm::StringSet<> importedFunctions;
@@ -141,12 +237,15 @@ void Torch::importLibraryFunctions(ModuleOp module, ModuleOp library,
     std::string symName = functionsNeeded.pop_back_val();
     if (importedFunctions.contains(symName))
       continue;
-    auto func = library.lookupSymbol<func::FuncOp>(symName);
-    assert(func && "broken library");
-    // Move the function from the library to the module this pass
-    // is running on. (this mutates the library, but we re-parse it each time
-    // so this is safe to do).
-    func->moveBefore(&module.getBody()->front());
+    auto libFunc = library.symbolTable.lookup<func::FuncOp>(symName);
+    assert(libFunc && "broken library");
+    if (failed(library.materialize(libFunc)))
+      return libFunc->emitError("failed to materialize library function");
+    // Clone the function from the library into the module this pass is
+    // running on. The library is shared across passes, so it must not be
+    // mutated.
+    auto func = cast<func::FuncOp>(libFunc->clone());
+    module.getBody()->push_front(func);
     // Set the visibility to private so that the functions go away
     // nicely after we are done with them.
     func.setVisibility(SymbolTable::Visibility::Private);
@@ -156,6 +255,7 @@ void Torch::importLibraryFunctions(ModuleOp module, ModuleOp library,
       functionsNeeded.push_back(op.getCallee().str());
     });
   }
+  return success();
 }
 
 FailureOr<Value>
@@ -320,6 +420,42 @@ Torch::adjustFunctionArg(OpBuilder &b, Location loc, Value operand,
   return operand;
 }
 
+FailureOr<SmallVector<Value>>
+Torch::shapeFunctionArgsBuilder(OpBuilder &b, Location loc,
+                                ValueRange originalOperands,
+                                func::FuncOp shapeFunc) {
+  // Massage the op operands to match the shape function signature.
+  // The shape function generally takes the same operands as the op, with a few
+  // systematic modifications, such as replacing tensors with their shapes.
+  SmallVector<Value> shapeFuncArgs;
+  for (auto operandAndDesiredType :
+       llvm::zip(originalOperands, shapeFunc.getArgumentTypes())) {
+    Value operand;
+    Type desiredType;
+    std::tie(operand, desiredType) = operandAndDesiredType;
+    FailureOr<Value> shapeFuncArg = adjustFunctionArg(
+        b, loc, operand, desiredType,
+        [](OpBuilder &b, Location loc, Value operand,
+           Type desiredType) -> Value {
+          // The shape library functions have tensor operands replaced with
+          // `!torch.list<int>` types for the shape. Get the sizes.
+          auto desiredListType = dyn_cast<Torch::ListType>(desiredType);
+          if (!desiredListType)
+            return operand;
+          if (isa<Torch::BaseTensorType>(operand.getType()) &&
+              isa<Torch::IntType>(desiredListType.getContainedType())) {
+            return AtenSizeOp::create(b, loc, desiredType, operand);
+          }
+          return operand;
+        });
+    if (failed(shapeFuncArg))
+      return failure();
+    shapeFuncArgs.push_back(*shapeFuncArg);
+  }
+
+  return shapeFuncArgs;
+}
+
 LogicalResult
 mlir::torch::Torch::loadExtraLibrary(const std::string &filename,
                                      OwningOpRef<ModuleOp> &moduleToAppendTo) {
@@ -355,3 +491,47 @@ mlir::torch::Torch::loadExtraLibrary(const std::string &filename,
 
   return success();
 }
+
+// Reads the bytecode form of the abstract interpretation library, leaving the
+// bodies of its functions to be materialized on demand.
+static std::unique_ptr<CachedLibrary>
+readLazyAbstractInterpLibrary(MLIRContext *context, StringRef extraLibrary) {
+  auto config = std::make_unique<ParserConfig>(context);
+  auto reader = std::make_unique<BytecodeReader>(
+      llvm::MemoryBufferRef(getAbstractInterpLibraryBytecode(),
+                            "abstract-interp-library"),
+      *config, /*lazyLoad=*/true);
+  Block block;
+  if (failed(reader->readTopLevel(
+          &block, [](Operation *op) { return isa<func::FuncOp>(op); })))
+    return nullptr;
+  if (!llvm::hasSingleElement(block) || !isa<ModuleOp>(block.front()))
+    return nullptr;
+  auto moduleOp = cast<ModuleOp>(block.front());
+  moduleOp->remove();
+  OwningOpRef<ModuleOp> library(moduleOp);
+  if (!extraLibrary.empty() &&
+      failed(loadExtraLibrary(extraLibrary.str(), library)))
+    return nullptr;
+  return std::make_unique<CachedLibrary>(std::move(library), std::move(config),
+                                         std::move(reader));
+}
+
+CachedLibrary *
+mlir::torch::Torch::getCachedAbstractInterpLibrary(MLIRContext *context,
+                                                   StringRef extraLibrary) {
+  auto *dialect = context->getOrLoadDialect<TorchDialect>();
+  return dialect->getOrCreateCached<CachedLibrary>(
+      extraLibrary, [&]() -> std::unique_ptr<CachedLibrary> {
+        if (!getAbstractInterpLibraryBytecode().empty())
+          return readLazyAbstractInterpLibrary(context, extraLibrary);
+        OwningOpRef<ModuleOp> library =
+            parseSourceString<ModuleOp>(getAbstractInterpLibrary(), context);
+        if (!library)
+          return nullptr;
+        if (!extraLibrary.empty() &&
+            failed(loadExtraLibrary(extraLibrary.str(), library)))
+          return nullptr;
+        return std::make_unique<CachedLibrary>(std::move(library));
+      });
+}
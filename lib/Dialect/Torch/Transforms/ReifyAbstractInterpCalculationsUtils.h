@@ -15,13 +15,46 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Support/LogicalResult.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 
+#include <mutex>
+
 namespace mlir {
+class BytecodeReader;
+class ParserConfig;
+
 namespace torch {
 namespace Torch {
 
+/// A parsed library module (such as the abstract interpretation library)
+/// together with a symbol index over its top-level functions.
+///
+/// The library may have been read lazily from bytecode, in which case the
+/// bodies of its functions are only materialized on request through
+/// `materialize`.
+struct CachedLibrary {
+  explicit CachedLibrary(OwningOpRef<ModuleOp> module,
+                         std::unique_ptr<ParserConfig> lazyReaderConfig = {},
+                         std::unique_ptr<BytecodeReader> lazyReader = {});
+  ~CachedLibrary();
+
+  /// Materializes the body of `op` if it was lazily loaded. This is a no-op
+  /// for ops that are already materialized. Thread-safe.
+  LogicalResult materialize(Operation *op);
+
+  OwningOpRef<ModuleOp> module;
+  SymbolTable symbolTable;
+
+private:
+  std::unique_ptr<ParserConfig> lazyReaderConfig;
+  std::unique_ptr<BytecodeReader> lazyReader;
+  std::mutex materializeMutex;
+};
+
 enum class LibraryFunctionKind {
   ShapeFunction,
   DtypeFunction,
@@ -41,18 +74,43 @@ enum class LibraryFunctionKind {
 // Note: This function does *not* import the abstract interpretation function
 // from the library into the IR.
 LogicalResult wrapWithCalculateOpIfLibraryFunctionAvailable(
-    Operation *op, ModuleOp library, LibraryFunctionKind funcKind,
+    Operation *op, const SymbolTable &library, LibraryFunctionKind funcKind,
     SmallVector<std::string> &libFuncNamesUsed,
     function_ref<FailureOr<SmallVector<Value>>(OpBuilder &, Location,
                                                ValueRange, func::FuncOp)>
         libFuncArgsBuilder);
 
+// Wraps every op in `module` that has a library function of kind `funcKind`
+// with a `CalculateOp` (see `wrapWithCalculateOpIfLibraryFunctionAvailable`),
+// then imports the library functions used into the module.
+//
+// Ops for which `resolveNatively`, if given, returns true are not wrapped. It
+// is called on each op before it would be, and may refine the op in place,
+// but must not touch other functions.
+//
+// The `func.func`s of the module are processed in parallel (when threading is
+// enabled on the context) since wrapping only touches the function being
+// walked and reads the shared library; only the import is sequential.
+LogicalResult reifyLibraryCalculations(
+    ModuleOp module, CachedLibrary &library, LibraryFunctionKind funcKind,
+    function_ref<FailureOr<SmallVector<Value>>(OpBuilder &, Location,
+                                               ValueRange, func::FuncOp)>
+        libFuncArgsBuilder,
+    function_ref<bool(Operation *)> resolveNatively = nullptr);
+
+// Refines the type of the single result of `op`, which must allow type
+// refinement, to `newType`. The users that do not allow type refinement read
+// the result through a `torch.tensor_static_info_cast` to its old type.
+void refineResultTypeInPlace(Operation *op, BaseTensorType newType);
+
 // Imports the functions in `functionsNeeded` from the library into the module.
 // This function assumes that all functions needed exist in the library.
 //
-// Note: This function modifies the library.
-void importLibraryFunctions(ModuleOp module, ModuleOp library,
-                            SmallVector<std::string> functionsNeeded);
+// Note: The functions are cloned, so the library is left unmodified (apart
+// from materializing lazily loaded functions) and can be shared between
+// passes.
+LogicalResult importLibraryFunctions(ModuleOp module, CachedLibrary &library,
+                                     SmallVector<std::string> functionsNeeded);
 
 // Recursively adjust `operand` to match `desiredType`.
 //
@@ -66,6 +124,12 @@ FailureOr<Value> adjustFunctionArg(
     function_ref<Value(OpBuilder &, Location, Value, Type)> baseTransformation =
         [](OpBuilder &, Location, Value operand, Type) { return operand; });
 
+// Builds the arguments of the shape function `shapeFunc` from the operands of
+// the op whose shapes it computes, passing the sizes of the tensor operands.
+FailureOr<SmallVector<Value>>
+shapeFunctionArgsBuilder(OpBuilder &b, Location loc,
+                         ValueRange originalOperands, func::FuncOp shapeFunc);
+
 std::string getLibraryFunctionPrefix(LibraryFunctionKind libFuncKind);
 
 // Parse MLIR module at `filename` into a ModuleOp that will then
@@ -75,6 +139,17 @@ std::string getLibraryFunctionPrefix(LibraryFunctionKind libFuncKind);
 LogicalResult loadExtraLibrary(const std::string &filename,
                                OwningOpRef<ModuleOp> &moduleToAppendTo);
 
+// Returns the abstract interpretation library from `getAbstractInterpLibrary`
+// with the functions of `extraLibrary` (if non-empty) appended to it.
+//
+// The library is parsed once per MLIRContext and extra library, cached on the
+// TorchDialect, and is then shared by all passes in that context, so it must
+// not be mutated. When the build embeds the library as bytecode, function
+// bodies are only materialized once they are imported. Returns nullptr if the
+// library could not be loaded.
+CachedLibrary *getCachedAbstractInterpLibrary(MLIRContext *context,
+                                              StringRef extraLibrary);
+
 } // namespace Torch
 } // namespace torch
 } // namespace mlir
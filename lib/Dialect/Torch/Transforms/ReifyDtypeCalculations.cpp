@@ -13,7 +13,10 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchTraits.h"
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/TorchUpstream.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
 
 using namespace mlir;
 using namespace mlir::torch;
@@ -65,6 +68,106 @@ dtypeFunctionArgsBuilder(OpBuilder &b, Location loc,
   return dtypeFuncArgs;
 }
 
+// The dtype of `value`, if it is a tensor of known dtype.
+static Type getKnownDtype(Value value) {
+  auto type = dyn_cast<BaseTensorType>(value.getType());
+  return type && type.hasDtype() ? type.getDtype() : Type();
+}
+
+// The dtype of the result of the common ops whose dtype follows directly from
+// that of their operands, so that they need no dtype function. Ops whose
+// dtype depends on promotion across categories, e.g. `tanh` of an int tensor,
+// are left to the library, which returns a null type.
+static Type inferDtypeNatively(Operation *op) {
+  if (op->getNumResults() != 1 || op->getNumOperands() == 0)
+    return Type();
+  MLIRContext *context = op->getContext();
+
+  // Comparisons are bool whatever the dtypes of their operands.
+  if (isa<AtenEqTensorOp, AtenNeTensorOp, AtenLtTensorOp, AtenLeTensorOp,
+          AtenGtTensorOp, AtenGeTensorOp, AtenEqScalarOp, AtenNeScalarOp,
+          AtenLtScalarOp, AtenLeScalarOp, AtenGtScalarOp, AtenGeScalarOp>(op))
+    return IntegerType::get(context, 1);
+
+  // Casts to a constant dtype.
+  if (isa<AtenToDtypeOp, PrimsConvertElementTypeOp>(op)) {
+    int64_t dtypeInt;
+    if (!matchPattern(op->getOperand(1), m_TorchConstantInt(&dtypeInt)))
+      return Type();
+    FailureOr<Type> dtype = getTypeForScalarType(
+        context, static_cast<torch_upstream::ScalarType>(dtypeInt));
+    return succeeded(dtype) ? *dtype : Type();
+  }
+
+  Type self = getKnownDtype(op->getOperand(0));
+  if (!self || isa<mlir::ComplexType>(self) || self.isInteger(1))
+    return Type();
+  bool isFloat = isa<mlir::FloatType>(self);
+
+  // Data movement and ops that keep the dtype of `self`.
+  if (isa<AtenReluOp, AtenNegOp, AtenAbsOp, AtenCloneOp, AtenContiguousOp,
+          AtenDetachOp, AtenViewOp, AtenReshapeOp, Aten_UnsafeViewOp,
+          AtenTransposeIntOp, AtenPermuteOp, AtenTOp, AtenUnsqueezeOp,
+          AtenSqueezeOp, AtenSqueezeDimOp, AtenFlattenUsingIntsOp,
+          AtenExpandOp, AtenSliceTensorOp, AtenSelectIntOp, AtenFlipOp,
+          AtenAmaxOp, AtenAminOp>(op))
+    return self;
+
+  // Ops that keep float dtypes, and give ints the default dtype.
+  if (isa<AtenTanhOp, AtenSigmoidOp, AtenExpOp, AtenLogOp, AtenSqrtOp,
+          AtenRsqrtOp, AtenSinOp, AtenCosOp, AtenErfOp, AtenGeluOp, AtenSiluOp,
+          AtenReciprocalOp>(op))
+    return isFloat ? self : Type();
+
+  // Binary ops of two tensors of the same dtype.
+  if (isa<AtenAddTensorOp, AtenSubTensorOp, AtenMulTensorOp, AtenMaximumOp,
+          AtenMinimumOp, AtenMmOp, AtenBmmOp, AtenMatmulOp>(op))
+    return getKnownDtype(op->getOperand(1)) == self ? self : Type();
+  if (isa<AtenDivTensorOp>(op))
+    return isFloat && getKnownDtype(op->getOperand(1)) == self ? self
+                                                                : Type();
+
+  // Ops of a tensor and a scalar, where the scalar only promotes ints to
+  // floats.
+  if (isa<AtenAddScalarOp, AtenSubScalarOp, AtenMulScalarOp>(op))
+    return isFloat || isa<Torch::IntType>(op->getOperand(1).getType())
+               ? self
+               : Type();
+  if (isa<AtenDivScalarOp>(op))
+    return isFloat ? self : Type();
+
+  // Reductions and softmaxes of floats without a `dtype` argument.
+  if (isa<AtenSumDimIntListOp, AtenMeanDimOp, AtenSoftmaxIntOp,
+          AtenLogSoftmaxIntOp>(op))
+    return isFloat && isa<Torch::NoneType>(op->getOperands().back().getType())
+               ? self
+               : Type();
+  return Type();
+}
+
+// Whether the dtypes of the tensor results of `op` are known, either already
+// or because `inferDtypeNatively` refines the result in place, so that `op`
+// needs no dtype function.
+static bool resolveDtypeNatively(Operation *op) {
+  auto hasDtype = [](Type type) {
+    auto tensorType = dyn_cast<BaseTensorType>(type);
+    return tensorType && tensorType.hasDtype();
+  };
+  if (op->getNumResults() == 0)
+    return false;
+  if (llvm::all_of(op->getResultTypes(), hasDtype))
+    return true;
+  if (!op->hasTrait<Torch::OpTrait::AllowsTypeRefinement>())
+    return false;
+  Type dtype = inferDtypeNatively(op);
+  auto originalType = dyn_cast<BaseTensorType>(op->getResult(0).getType());
+  if (!dtype || !originalType)
+    return false;
+  refineResultTypeInPlace(
+      op, cast<BaseTensorType>(originalType.getWithDtype(dtype)));
+  return true;
+}
+
 namespace {
 struct ReifyDtypeCalculationsPass
     : public impl::ReifyDtypeCalculationsBase<ReifyDtypeCalculationsPass> {
@@ -74,27 +177,31 @@ struct ReifyDtypeCalculationsPass
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp module = getOperation();
-    OwningOpRef<ModuleOp> library =
-        parseSourceString<ModuleOp>(getAbstractInterpLibrary(), context);
-    if (!extraLibrary.empty())
-      if (failed(mlir::torch::Torch::loadExtraLibrary(extraLibrary, library))) {
+
+    // The library is O(#ops we know about), and this pass should be
+    // O(#ops in the program) ideally, so it is parsed once per context and
+    // shared.
+    CachedLibrary *library =
+        getCachedAbstractInterpLibrary(context, extraLibrary);
+    if (!library) {
+      if (extraLibrary.empty())
+        emitError(module->getLoc(),
+                  "Failed to load the abstract interpretation library");
+      else
         emitError(module->getLoc(),
                   "Failed to load extra-library file at " + extraLibrary);
-        return signalPassFailure();
-      }
-
-    // Walk all the operations, and if we have a dtype function, wrap the op
-    // in a `torch.dtype.calculate` op.
-    SmallVector<std::string> functionsNeeded;
-    WalkResult walkResult = module.walk([&](Operation *op) -> WalkResult {
-      return wrapWithCalculateOpIfLibraryFunctionAvailable(
-          op, *library, LibraryFunctionKind::DtypeFunction, functionsNeeded,
-          dtypeFunctionArgsBuilder);
-    });
-
-    if (walkResult.wasInterrupted())
       return signalPassFailure();
-    importLibraryFunctions(module, *library, std::move(functionsNeeded));
+    }
+
+    // Wrap every op that has a dtype function in a `torch.dtype.calculate` op
+    // and import the dtype functions used. Ops whose dtypes are known, or are
+    // inferred natively, are left alone, so that each iteration of the
+    // backend contract lowering only goes through the library for the ops
+    // that still need it.
+    if (failed(reifyLibraryCalculations(
+            module, *library, LibraryFunctionKind::DtypeFunction,
+            dtypeFunctionArgsBuilder, resolveDtypeNatively)))
+      return signalPassFailure();
   }
 };
 } // namespace
@@ -14,6 +14,7 @@
 #include "mlir/Transforms/DialectConversion.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 using namespace mlir;
@@ -25,39 +26,445 @@ namespace mlir::torch::Torch {
 #define GEN_PASS_DEF_REIFYSHAPECALCULATIONS
 #include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
 
-static FailureOr<SmallVector<Value>>
-shapeFunctionArgsBuilder(OpBuilder &b, Location loc,
-                         ValueRange originalOperands, func::FuncOp shapeFunc) {
-  // Massage the op operands to match the shape function signature.
-  // The shape function generally takes the same operands as the op, with a few
-  // systematic modifications, such as replacing tensors with their shapes.
-  SmallVector<Value> shapeFuncArgs;
-  for (auto operandAndDesiredType :
-       llvm::zip(originalOperands, shapeFunc.getArgumentTypes())) {
-    Value operand;
-    Type desiredType;
-    std::tie(operand, desiredType) = operandAndDesiredType;
-    FailureOr<Value> shapeFuncArg = adjustFunctionArg(
-        b, loc, operand, desiredType,
-        [](OpBuilder &b, Location loc, Value operand,
-           Type desiredType) -> Value {
-          // The shape library functions have tensor operands replaced with
-          // `!torch.list<int>` types for the shape. Get the sizes.
-          auto desiredListType = dyn_cast<Torch::ListType>(desiredType);
-          if (!desiredListType)
-            return operand;
-          if (isa<Torch::BaseTensorType>(operand.getType()) &&
-              isa<Torch::IntType>(desiredListType.getContainedType())) {
-            return AtenSizeOp::create(b, loc, desiredType, operand);
-          }
-          return operand;
-        });
-    if (failed(shapeFuncArg))
-      return failure();
-    shapeFuncArgs.push_back(*shapeFuncArg);
-  }
-
-  return shapeFuncArgs;
+// The sizes of `value`, if it is a tensor of known rank.
+static std::optional<SmallVector<int64_t>> getSizes(Value value) {
+  auto type = dyn_cast<BaseTensorType>(value.getType());
+  if (!type || !type.hasSizes())
+    return std::nullopt;
+  return llvm::to_vector(type.getSizes());
+}
+
+// The elements of a list of constant ints.
+static std::optional<SmallVector<int64_t>> getIntList(Value list) {
+  SmallVector<int64_t> values;
+  if (!matchPattern(list, m_TorchListOfConstantInts(values)))
+    return std::nullopt;
+  return values;
+}
+
+// The non-negative dim of a constant `dim` operand into a tensor of `rank`.
+static std::optional<int64_t> getDim(Value dim, int64_t rank) {
+  int64_t value;
+  if (!matchPattern(dim, m_TorchConstantInt(&value)))
+    return std::nullopt;
+  value = toPositiveDim(value, rank);
+  if (!isValidDim(value, rank))
+    return std::nullopt;
+  return value;
+}
+
+// The size that two sizes broadcast to, or nullopt if they cannot.
+static std::optional<int64_t> broadcastSize(int64_t lhs, int64_t rhs) {
+  if (lhs == 1)
+    return rhs;
+  if (rhs == 1 || lhs == rhs)
+    return lhs;
+  if (lhs == kUnknownSize)
+    return rhs;
+  if (rhs == kUnknownSize)
+    return lhs;
+  return std::nullopt;
+}
+
+static std::optional<SmallVector<int64_t>>
+broadcastSizes(ArrayRef<int64_t> lhs, ArrayRef<int64_t> rhs) {
+  SmallVector<int64_t> sizes(std::max(lhs.size(), rhs.size()));
+  for (int64_t i = 0, e = sizes.size(); i < e; ++i) {
+    int64_t lhsIndex = lhs.size() - e + i;
+    int64_t rhsIndex = rhs.size() - e + i;
+    std::optional<int64_t> size =
+        broadcastSize(lhsIndex >= 0 ? lhs[lhsIndex] : 1,
+                      rhsIndex >= 0 ? rhs[rhsIndex] : 1);
+    if (!size)
+      return std::nullopt;
+    sizes[i] = *size;
+  }
+  return sizes;
+}
+
+// Whether two sizes may be equal.
+static bool isCompatible(int64_t lhs, int64_t rhs) {
+  return lhs == rhs || lhs == kUnknownSize || rhs == kUnknownSize;
+}
+
+// The more static of two compatible sizes.
+static int64_t meetSize(int64_t lhs, int64_t rhs) {
+  return lhs == kUnknownSize ? rhs : lhs;
+}
+
+static std::optional<SmallVector<int64_t>>
+inferMatmulSizes(ArrayRef<int64_t> lhs, ArrayRef<int64_t> rhs) {
+  if (lhs.empty() || rhs.empty())
+    return std::nullopt;
+  int64_t lhsK = lhs.back();
+  int64_t rhsK = rhs.size() == 1 ? rhs[0] : rhs[rhs.size() - 2];
+  if (!isCompatible(lhsK, rhsK))
+    return std::nullopt;
+  ArrayRef<int64_t> lhsBatch = lhs.drop_back(lhs.size() == 1 ? 1 : 2);
+  ArrayRef<int64_t> rhsBatch = rhs.drop_back(rhs.size() == 1 ? 1 : 2);
+  std::optional<SmallVector<int64_t>> sizes =
+      broadcastSizes(lhsBatch, rhsBatch);
+  if (!sizes)
+    return std::nullopt;
+  if (lhs.size() > 1)
+    sizes->push_back(lhs[lhs.size() - 2]);
+  if (rhs.size() > 1)
+    sizes->push_back(rhs.back());
+  return sizes;
+}
+
+// The sizes of the result of a reduction of `dims` of a tensor of `sizes`,
+// where no dims means all of them.
+static std::optional<SmallVector<int64_t>>
+inferReductionSizes(ArrayRef<int64_t> sizes, Value dimList, Value keepDim) {
+  bool keep;
+  if (!matchPattern(keepDim, m_TorchConstantBool(&keep)))
+    return std::nullopt;
+  int64_t rank = sizes.size();
+  SmallVector<bool> reduced(rank, false);
+  if (isa<Torch::NoneType>(dimList.getType())) {
+    reduced.assign(rank, true);
+  } else {
+    std::optional<SmallVector<int64_t>> dims = getIntList(dimList);
+    if (!dims)
+      return std::nullopt;
+    if (dims->empty())
+      reduced.assign(rank, true);
+    for (int64_t dim : *dims) {
+      dim = toPositiveDim(dim, rank);
+      if (!isValidDim(dim, rank))
+        return std::nullopt;
+      reduced[dim] = true;
+    }
+  }
+  SmallVector<int64_t> result;
+  for (int64_t i = 0; i < rank; ++i) {
+    if (!reduced[i])
+      result.push_back(sizes[i]);
+    else if (keep)
+      result.push_back(1);
+  }
+  return result;
+}
+
+// The sizes of the result of a view of a tensor of `sizes` as `shape`, where
+// one size may be -1.
+static std::optional<SmallVector<int64_t>>
+inferViewSizes(ArrayRef<int64_t> sizes, Value shapeList) {
+  std::optional<SmallVector<int64_t>> shape = getIntList(shapeList);
+  if (!shape)
+    return std::nullopt;
+  std::optional<int64_t> inferredIndex;
+  int64_t knownNumel = 1;
+  for (auto [i, size] : llvm::enumerate(*shape)) {
+    if (size == -1) {
+      if (inferredIndex)
+        return std::nullopt;
+      inferredIndex = i;
+    } else if (size < 0) {
+      return std::nullopt;
+    } else {
+      knownNumel *= size;
+    }
+  }
+  if (!inferredIndex)
+    return shape;
+  // The size of -1 stays unknown if the number of elements is.
+  if (llvm::is_contained(sizes, kUnknownSize) || knownNumel == 0)
+    return shape;
+  int64_t numel = 1;
+  for (int64_t size : sizes)
+    numel *= size;
+  if (numel % knownNumel == 0)
+    (*shape)[*inferredIndex] = numel / knownNumel;
+  else
+    return std::nullopt;
+  return shape;
+}
+
+// The sizes of the result of a non-transposed convolution.
+static std::optional<SmallVector<int64_t>>
+inferConvolutionSizes(ArrayRef<int64_t> input, ArrayRef<int64_t> weight,
+                      Value strideList, Value paddingList, Value dilationList) {
+  if (input.size() < 3 || weight.size() != input.size())
+    return std::nullopt;
+  int64_t numSpatialDims = input.size() - 2;
+  std::optional<SmallVector<int64_t>> strides = getIntList(strideList);
+  std::optional<SmallVector<int64_t>> paddings = getIntList(paddingList);
+  std::optional<SmallVector<int64_t>> dilations = getIntList(dilationList);
+  if (!strides || !paddings || !dilations)
+    return std::nullopt;
+  // A single value applies to all spatial dims.
+  auto getParam = [&](ArrayRef<int64_t> values,
+                      int64_t i) -> std::optional<int64_t> {
+    if (values.size() == 1)
+      return values[0];
+    if (static_cast<int64_t>(values.size()) != numSpatialDims)
+      return std::nullopt;
+    return values[i];
+  };
+  SmallVector<int64_t> sizes = {input[0], weight[0]};
+  for (int64_t i = 0; i < numSpatialDims; ++i) {
+    std::optional<int64_t> stride = getParam(*strides, i);
+    std::optional<int64_t> padding = getParam(*paddings, i);
+    std::optional<int64_t> dilation = getParam(*dilations, i);
+    if (!stride || !padding || !dilation || *stride <= 0)
+      return std::nullopt;
+    int64_t in = input[i + 2];
+    int64_t kernel = weight[i + 2];
+    if (in == kUnknownSize || kernel == kUnknownSize) {
+      sizes.push_back(kUnknownSize);
+      continue;
+    }
+    int64_t span = in + 2 * *padding - *dilation * (kernel - 1) - 1;
+    if (span < 0)
+      return std::nullopt;
+    sizes.push_back(span / *stride + 1);
+  }
+  return sizes;
+}
+
+// The sizes of the single result of the hot ops of models, e.g. elementwise
+// ops, matmuls, convolutions, views, permutes and reductions, whose shape
+// functions would otherwise be imported, wrapped around them and simplified
+// away. Returns nullopt when the library has to handle `op`, including for
+// invalid shapes, so that it reports them.
+static std::optional<SmallVector<int64_t>> inferSizesNatively(Operation *op) {
+  if (op->getNumResults() != 1 || op->getNumOperands() == 0)
+    return std::nullopt;
+  std::optional<SmallVector<int64_t>> self = getSizes(op->getOperand(0));
+  if (!self)
+    return std::nullopt;
+  int64_t rank = self->size();
+
+  // Ops whose result has the shape of their first operand.
+  if (isa<AtenReluOp, AtenNegOp, AtenAbsOp, AtenCloneOp, AtenContiguousOp,
+          AtenDetachOp, AtenTanhOp, AtenSigmoidOp, AtenExpOp, AtenLogOp,
+          AtenSqrtOp, AtenRsqrtOp, AtenSinOp, AtenCosOp, AtenErfOp, AtenGeluOp,
+          AtenSiluOp, AtenReciprocalOp, AtenFloorOp, AtenCeilOp, AtenRoundOp,
+          AtenSignOp, AtenLogicalNotOp, AtenBitwiseNotOp, AtenClampOp,
+          AtenHardtanhOp, AtenLeakyReluOp, AtenPowTensorScalarOp,
+          AtenAddScalarOp, AtenSubScalarOp, AtenMulScalarOp, AtenDivScalarOp,
+          AtenRsubScalarOp, AtenEqScalarOp, AtenNeScalarOp, AtenLtScalarOp,
+          AtenLeScalarOp, AtenGtScalarOp, AtenGeScalarOp, AtenToDtypeOp,
+          PrimsConvertElementTypeOp, AtenSoftmaxIntOp, AtenLogSoftmaxIntOp,
+          Aten_SoftmaxOp, Aten_LogSoftmaxOp>(op))
+    return self;
+
+  // Elementwise ops that broadcast their tensor operands.
+  if (isa<AtenAddTensorOp, AtenSubTensorOp, AtenMulTensorOp, AtenDivTensorOp,
+          AtenMaximumOp, AtenMinimumOp, AtenPowTensorTensorOp, AtenEqTensorOp,
+          AtenNeTensorOp, AtenLtTensorOp, AtenLeTensorOp, AtenGtTensorOp,
+          AtenGeTensorOp, AtenLogicalAndOp, AtenLogicalOrOp, AtenWhereSelfOp>(
+          op)) {
+    std::optional<SmallVector<int64_t>> sizes = self;
+    for (Value operand : op->getOperands().drop_front()) {
+      if (!isa<BaseTensorType>(operand.getType()))
+        continue;
+      std::optional<SmallVector<int64_t>> other = getSizes(operand);
+      if (!other || !(sizes = broadcastSizes(*sizes, *other)))
+        return std::nullopt;
+    }
+    return sizes;
+  }
+
+  if (isa<AtenMmOp, AtenBmmOp, AtenMatmulOp>(op)) {
+    std::optional<SmallVector<int64_t>> other = getSizes(op->getOperand(1));
+    if (!other)
+      return std::nullopt;
+    int64_t expectedRank = isa<AtenMmOp>(op) ? 2 : 3;
+    if (!isa<AtenMatmulOp>(op) &&
+        (rank != expectedRank || (int64_t)other->size() != expectedRank))
+      return std::nullopt;
+    if (isa<AtenBmmOp>(op)) {
+      if (!isCompatible((*self)[0], (*other)[0]))
+        return std::nullopt;
+      (*self)[0] = (*other)[0] = meetSize((*self)[0], (*other)[0]);
+    }
+    return inferMatmulSizes(*self, *other);
+  }
+  if (auto linear = dyn_cast<AtenLinearOp>(op)) {
+    std::optional<SmallVector<int64_t>> weight = getSizes(linear.getWeight());
+    if (!weight || weight->size() != 2 || rank == 0 ||
+        !isCompatible(self->back(), (*weight)[1]))
+      return std::nullopt;
+    self->back() = (*weight)[0];
+    return self;
+  }
+  if (auto conv = dyn_cast<AtenConvolutionOp>(op)) {
+    bool transposed;
+    std::optional<SmallVector<int64_t>> weight = getSizes(conv.getWeight());
+    if (!weight ||
+        !matchPattern(conv.getTransposed(), m_TorchConstantBool(&transposed)) ||
+        transposed)
+      return std::nullopt;
+    return inferConvolutionSizes(*self, *weight, conv.getStride(),
+                                 conv.getPadding(), conv.getDilation());
+  }
+  if (auto conv = dyn_cast<AtenConv2dOp>(op)) {
+    std::optional<SmallVector<int64_t>> weight = getSizes(conv.getWeight());
+    if (!weight || rank != 4)
+      return std::nullopt;
+    return inferConvolutionSizes(*self, *weight, conv.getStride(),
+                                 conv.getPadding(), conv.getDilation());
+  }
+
+  // Views and permutations.
+  if (isa<AtenViewOp, AtenReshapeOp, Aten_UnsafeViewOp>(op))
+    return inferViewSizes(*self, op->getOperand(1));
+  if (auto permute = dyn_cast<AtenPermuteOp>(op)) {
+    std::optional<SmallVector<int64_t>> perms = getIntList(permute.getDims());
+    if (!perms || static_cast<int64_t>(perms->size()) != rank)
+      return std::nullopt;
+    SmallVector<int64_t> sizes;
+    SmallVector<bool> seen(rank, false);
+    for (int64_t perm : *perms) {
+      perm = toPositiveDim(perm, rank);
+      if (!isValidDim(perm, rank) || seen[perm])
+        return std::nullopt;
+      seen[perm] = true;
+      sizes.push_back((*self)[perm]);
+    }
+    return sizes;
+  }
+  if (auto transpose = dyn_cast<AtenTransposeIntOp>(op)) {
+    std::optional<int64_t> dim0 = getDim(transpose.getDim0(), rank);
+    std::optional<int64_t> dim1 = getDim(transpose.getDim1(), rank);
+    if (!dim0 || !dim1)
+      return std::nullopt;
+    std::swap((*self)[*dim0], (*self)[*dim1]);
+    return self;
+  }
+  if (isa<AtenTOp>(op)) {
+    if (rank > 2)
+      return std::nullopt;
+    std::reverse(self->begin(), self->end());
+    return self;
+  }
+  if (auto unsqueeze = dyn_cast<AtenUnsqueezeOp>(op)) {
+    std::optional<int64_t> dim = getDim(unsqueeze.getDim(), rank + 1);
+    if (!dim)
+      return std::nullopt;
+    self->insert(self->begin() + *dim, 1);
+    return self;
+  }
+  if (auto squeeze = dyn_cast<AtenSqueezeDimOp>(op)) {
+    if (rank == 0)
+      return self;
+    std::optional<int64_t> dim = getDim(squeeze.getDim(), rank);
+    if (!dim || (*self)[*dim] == kUnknownSize)
+      return std::nullopt;
+    if ((*self)[*dim] == 1)
+      self->erase(self->begin() + *dim);
+    return self;
+  }
+  if (auto flatten = dyn_cast<AtenFlattenUsingIntsOp>(op)) {
+    if (rank == 0)
+      return std::nullopt;
+    std::optional<int64_t> start = getDim(flatten.getStartDim(), rank);
+    std::optional<int64_t> end = getDim(flatten.getEndDim(), rank);
+    if (!start || !end || *start > *end)
+      return std::nullopt;
+    int64_t size = 1;
+    for (int64_t i = *start; i <= *end; ++i)
+      size = (*self)[i] == kUnknownSize || size == kUnknownSize
+                 ? kUnknownSize
+                 : size * (*self)[i];
+    self->erase(self->begin() + *start + 1, self->begin() + *end + 1);
+    (*self)[*start] = size;
+    return self;
+  }
+  if (auto expand = dyn_cast<AtenExpandOp>(op)) {
+    std::optional<SmallVector<int64_t>> sizes = getIntList(expand.getSize());
+    if (!sizes || static_cast<int64_t>(sizes->size()) < rank)
+      return std::nullopt;
+    int64_t offset = sizes->size() - rank;
+    for (int64_t i = 0; i < rank; ++i) {
+      int64_t &size = (*sizes)[offset + i];
+      if (size == -1)
+        size = (*self)[i];
+      else if ((*self)[i] != 1 && !isCompatible(size, (*self)[i]))
+        return std::nullopt;
+    }
+    if (llvm::is_contained(ArrayRef(*sizes).take_front(offset), -1))
+      return std::nullopt;
+    return sizes;
+  }
+  if (auto select = dyn_cast<AtenSelectIntOp>(op)) {
+    std::optional<int64_t> dim = getDim(select.getDim(), rank);
+    if (!dim)
+      return std::nullopt;
+    self->erase(self->begin() + *dim);
+    return self;
+  }
+  if (auto slice = dyn_cast<AtenSliceTensorOp>(op)) {
+    std::optional<int64_t> dim = getDim(slice.getDim(), rank);
+    int64_t step;
+    if (!dim || !matchPattern(slice.getStep(), m_TorchConstantInt(&step)) ||
+        step <= 0)
+      return std::nullopt;
+    int64_t size = (*self)[*dim];
+    auto getBound = [&](Value bound, int64_t defaultValue) {
+      int64_t value;
+      if (isa<Torch::NoneType>(bound.getType()))
+        return defaultValue;
+      if (!matchPattern(bound, m_TorchConstantInt(&value)))
+        return kUnknownSize;
+      if (value < 0)
+        value += size;
+      return std::clamp<int64_t>(value, 0, size);
+    };
+    if (size == kUnknownSize) {
+      (*self)[*dim] = kUnknownSize;
+      return self;
+    }
+    int64_t start = getBound(slice.getStart(), 0);
+    int64_t end = getBound(slice.getEnd(), size);
+    (*self)[*dim] = start == kUnknownSize || end == kUnknownSize
+                        ? kUnknownSize
+                        : (std::max<int64_t>(end - start, 0) + step - 1) / step;
+    return self;
+  }
+
+  // Reductions.
+  if (auto sum = dyn_cast<AtenSumDimIntListOp>(op))
+    return inferReductionSizes(*self, sum.getDim(), sum.getKeepdim());
+  if (auto mean = dyn_cast<AtenMeanDimOp>(op))
+    return inferReductionSizes(*self, mean.getDim(), mean.getKeepdim());
+  if (auto amax = dyn_cast<AtenAmaxOp>(op))
+    return inferReductionSizes(*self, amax.getDim(), amax.getKeepdim());
+  if (auto amin = dyn_cast<AtenAminOp>(op))
+    return inferReductionSizes(*self, amin.getDim(), amin.getKeepdim());
+  return std::nullopt;
+}
+
+// Whether the shapes of the tensor results of `op` are static, either already
+// or because `inferSizesNatively` refines the result in place, so that `op`
+// needs no shape function.
+static bool resolveShapeNatively(Operation *op) {
+  auto hasStaticSizes = [](Type type) {
+    auto tensorType = dyn_cast<BaseTensorType>(type);
+    return tensorType && tensorType.areAllSizesKnown();
+  };
+  if (op->getNumResults() == 0)
+    return false;
+  if (llvm::all_of(op->getResultTypes(), hasStaticSizes))
+    return true;
+  if (!op->hasTrait<Torch::OpTrait::AllowsTypeRefinement>())
+    return false;
+  std::optional<SmallVector<int64_t>> sizes = inferSizesNatively(op);
+  auto originalType = dyn_cast<BaseTensorType>(op->getResult(0).getType());
+  if (!sizes || !originalType)
+    return false;
+  auto refinedType = dyn_cast_or_null<BaseTensorType>(meetTensorTypes(
+      originalType,
+      cast<BaseTensorType>(originalType.getWithSizesAndDtype(
+          *sizes, originalType.getOptionalDtype()))));
+  if (!refinedType)
+    return false;
+  if (refinedType != originalType)
+    refineResultTypeInPlace(op, refinedType);
+  return true;
 }
 
 namespace {
@@ -69,30 +476,29 @@ struct ReifyShapeCalculationsPass
     MLIRContext *context = &getContext();
     ModuleOp module = getOperation();
 
-    // TODO: Find a way to not have to parse this every time.
     // The library is O(#ops we know about), and this pass should be
-    // O(#ops in the program) ideally.
-    OwningOpRef<ModuleOp> library =
-        parseSourceString<ModuleOp>(getAbstractInterpLibrary(), context);
-    if (!extraLibrary.empty())
-      if (failed(mlir::torch::Torch::loadExtraLibrary(extraLibrary, library))) {
+    // O(#ops in the program) ideally, so it is parsed once per context and
+    // shared.
+    CachedLibrary *library =
+        getCachedAbstractInterpLibrary(context, extraLibrary);
+    if (!library) {
+      if (extraLibrary.empty())
+        emitError(module->getLoc(),
+                  "Failed to load the abstract interpretation library");
+      else
         emitError(module->getLoc(),
                   "Failed to load extra-library file at " + extraLibrary);
-        return signalPassFailure();
-      }
-
-    // Walk all the operations, and if we have a shape function, wrap the op
-    // in a `torch.shape.calculate` op.
-    SmallVector<std::string> functionsNeeded;
-    WalkResult walkResult = module.walk([&](Operation *op) -> WalkResult {
-      return wrapWithCalculateOpIfLibraryFunctionAvailable(
-          op, *library, LibraryFunctionKind::ShapeFunction, functionsNeeded,
-          shapeFunctionArgsBuilder);
-    });
-
-    if (walkResult.wasInterrupted())
       return signalPassFailure();
-    importLibraryFunctions(module, *library, std::move(functionsNeeded));
+    }
+
+    // Wrap every op that has a shape function in a `torch.shape.calculate` op
+    // and import the shape functions used. Ops whose shapes are static, or are
+    // inferred natively, are left alone, so that the library and its
+    // simplification only run on the ops that need them.
+    if (failed(reifyLibraryCalculations(
+            module, *library, LibraryFunctionKind::ShapeFunction,
+            shapeFunctionArgsBuilder, resolveShapeNatively)))
+      return signalPassFailure();
   }
 };
 } // namespace
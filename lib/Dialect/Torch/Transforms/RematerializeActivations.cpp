@@ -0,0 +1,210 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchTraits.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_REMATERIALIZEACTIVATIONS
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+// Whether `op` reads each element of its operands a bounded number of times,
+// so that recomputing it costs about as much as reading its result back.
+// Random ops, e.g. dropout, are left out, as a recomputation would differ.
+static bool isCheapToRecompute(Operation *op) {
+  if (isa<AtenTanhOp, AtenSigmoidOp, AtenReluOp, AtenGeluOp, AtenSiluOp,
+          AtenLeakyReluOp, AtenHardtanhOp, AtenExpOp, AtenExpm1Op, AtenLogOp,
+          AtenLog1pOp, AtenSqrtOp, AtenRsqrtOp, AtenNegOp, AtenAbsOp,
+          AtenErfOp, AtenSinOp, AtenCosOp, AtenReciprocalOp, AtenToDtypeOp,
+          AtenClampOp, AtenAddTensorOp, AtenSubTensorOp, AtenMulTensorOp,
+          AtenDivTensorOp, AtenMaximumOp, AtenMinimumOp, AtenAddScalarOp,
+          AtenSubScalarOp, AtenMulScalarOp, AtenDivScalarOp, AtenRsubScalarOp,
+          AtenPowTensorScalarOp, AtenWhereSelfOp, AtenEqTensorOp,
+          AtenNeTensorOp, AtenGtTensorOp, AtenGeTensorOp, AtenLtTensorOp,
+          AtenLeTensorOp, AtenEqScalarOp, AtenNeScalarOp, AtenGtScalarOp,
+          AtenGeScalarOp, AtenLtScalarOp, AtenLeScalarOp, AtenLogicalNotOp>(
+          op))
+    return true;
+  return isa<AtenNativeLayerNormOp, AtenLayerNormOp, AtenRmsNormOp,
+             AtenNativeBatchNormOp, AtenBatchNormOp, AtenNativeGroupNormOp,
+             AtenGroupNormOp, AtenSoftmaxIntOp, Aten_SoftmaxOp,
+             AtenLogSoftmaxIntOp, Aten_LogSoftmaxOp>(op);
+}
+
+namespace {
+// The lifetimes of the tensors defined in a block. A tensor is live from the
+// op that defines it to its last use, both included, where a use in a nested
+// region counts at the op of the block that holds it.
+class BlockLiveness {
+public:
+  explicit BlockLiveness(Block &block) : block(block) {
+    for (Operation &op : block) {
+      indices[&op] = ops.size();
+      ops.push_back(&op);
+    }
+  }
+
+  int64_t getIndex(OpOperand &use) const {
+    return indices.lookup(block.findAncestorOpInBlock(*use.getOwner()));
+  }
+
+  // The index of the last op of the block that uses `value`, or of the op
+  // defining it if it has no uses.
+  int64_t getLastUse(Value value) const {
+    int64_t last = value.getDefiningOp() ? indices.lookup(value.getDefiningOp())
+                                         : -1;
+    for (OpOperand &use : value.getUses())
+      last = std::max(last, getIndex(use));
+    return last;
+  }
+
+  // The index of the op at which the most bytes are live, and those bytes.
+  std::pair<int64_t, int64_t> getPeak() const {
+    SmallVector<int64_t> deltas(ops.size() + 1, 0);
+    for (Operation *op : ops) {
+      for (Value result : op->getResults()) {
+        std::optional<int64_t> bytes = getTensorStaticBytes(result);
+        if (!bytes)
+          continue;
+        deltas[indices.lookup(op)] += *bytes;
+        deltas[getLastUse(result) + 1] -= *bytes;
+      }
+    }
+    int64_t peak = 0, peakBytes = 0, liveBytes = 0;
+    for (int64_t i = 0, e = ops.size(); i < e; ++i) {
+      liveBytes += deltas[i];
+      if (liveBytes > peakBytes) {
+        peak = i;
+        peakBytes = liveBytes;
+      }
+    }
+    return {peak, peakBytes};
+  }
+
+  Block &block;
+  SmallVector<Operation *> ops;
+  DenseMap<Operation *, int64_t> indices;
+};
+
+// Recomputing the op at `def` before the op at `clonePoint`, for the uses of
+// its results from there on, frees `bytes` at the peak.
+struct Rematerialization {
+  int64_t def;
+  int64_t clonePoint;
+  int64_t bytes;
+};
+} // namespace
+
+// How `op` would be recomputed to free its results at `peak`: once before
+// their first use after the peak, provided that none of them is used at the
+// peak and that the operands of `op` are live there anyway.
+static std::optional<Rematerialization>
+matchRematerialization(const BlockLiveness &liveness, Operation *op,
+                       int64_t peak) {
+  int64_t def = liveness.indices.lookup(op);
+  if (def >= peak || !isCheapToRecompute(op) ||
+      !op->hasTrait<Torch::OpTrait::HasValueSemantics>())
+    return std::nullopt;
+
+  int64_t clonePoint = liveness.ops.size();
+  int64_t bytes = 0;
+  for (Value result : op->getResults()) {
+    bool liveAtPeak = false;
+    for (OpOperand &use : result.getUses()) {
+      int64_t index = liveness.getIndex(use);
+      if (index == peak)
+        return std::nullopt;
+      if (index > peak) {
+        clonePoint = std::min(clonePoint, index);
+        liveAtPeak = true;
+      }
+    }
+    if (!liveAtPeak)
+      continue;
+    std::optional<int64_t> resultBytes = getTensorStaticBytes(result);
+    if (!resultBytes)
+      return std::nullopt;
+    bytes += *resultBytes;
+  }
+  if (bytes == 0)
+    return std::nullopt;
+
+  // Tensors defined in the block, other than literals, must already be live
+  // at the clone, or recomputing `op` would only move them to the peak.
+  for (Value operand : op->getOperands()) {
+    Operation *producer = operand.getDefiningOp();
+    if (!isa<BaseTensorType>(operand.getType()) || !producer ||
+        isa<ValueTensorLiteralOp>(producer))
+      continue;
+    if (liveness.getLastUse(operand) < clonePoint)
+      return std::nullopt;
+  }
+  return Rematerialization{def, clonePoint, bytes};
+}
+
+namespace {
+class RematerializeActivationsPass
+    : public impl::RematerializeActivationsBase<RematerializeActivationsPass> {
+public:
+  using impl::RematerializeActivationsBase<
+      RematerializeActivationsPass>::RematerializeActivationsBase;
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    if (func.isExternal())
+      return;
+    Block &block = func.getBody().front();
+    OpBuilder builder(&getContext());
+    // Each rematerialization ends the lifetime of some results at their
+    // last use before the peak, so that the sum of all lifetimes decreases
+    // and the loop terminates.
+    while (true) {
+      BlockLiveness liveness(block);
+      auto [peak, peakBytes] = liveness.getPeak();
+      if (memoryBudget > 0 && peakBytes <= memoryBudget)
+        return;
+
+      std::optional<Rematerialization> best;
+      for (Operation *op : ArrayRef(liveness.ops).take_front(peak)) {
+        std::optional<Rematerialization> candidate =
+            matchRematerialization(liveness, op, peak);
+        if (candidate && (!best || candidate->bytes > best->bytes))
+          best = candidate;
+      }
+      if (!best)
+        return;
+
+      Operation *op = liveness.ops[best->def];
+      builder.setInsertionPoint(liveness.ops[best->clonePoint]);
+      Operation *clone = builder.clone(*op);
+      for (auto [result, recomputed] :
+           llvm::zip_equal(op->getResults(), clone->getResults())) {
+        result.replaceUsesWithIf(recomputed, [&](OpOperand &use) {
+          return liveness.getIndex(use) >= best->clonePoint;
+        });
+      }
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createRematerializeActivationsPass() {
+  return std::make_unique<RematerializeActivationsPass>();
+}
+
+} // namespace mlir::torch::Torch
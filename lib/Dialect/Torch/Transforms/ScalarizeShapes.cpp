@@ -1628,9 +1628,19 @@ void populateScalarizationRemovePatterns(RewritePatternSet &patterns) {
 
 } // namespace
 namespace {
+// Counts the ops that the scalarization patterns modify or erase, where a
+// replaced op counts as erased.
+struct TouchedOpsListener : public RewriterBase::Listener {
+  void notifyOperationModified(Operation *op) override { ++numTouchedOps; }
+  void notifyOperationErased(Operation *op) override { ++numTouchedOps; }
+
+  int64_t numTouchedOps = 0;
+};
+
 class ScalarizeShapesPass
     : public impl::ScalarizeShapesBase<ScalarizeShapesPass> {
 public:
+  using impl::ScalarizeShapesBase<ScalarizeShapesPass>::ScalarizeShapesBase;
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<arith::ArithDialect>();
   }
@@ -1653,20 +1663,25 @@ public:
     // When we pass this SetVector to the pattern rewrite driver, it will
     // process the operations top-down, thereby propagating scalarization
     // starting from sources.
+    // Each op collected is at some depth, the number of producer hops from
+    // the anchor or view that it feeds, which `max-propagation-depth` bounds.
     auto funcOp = getOperation();
     llvm::SetVector<Operation *> shapeCalculationOps;
+    DenseMap<Operation *, int64_t> depths;
     funcOp.walk<WalkOrder::PostOrder, mlir::ReverseIterator>(
         [&](Operation *op) {
           // Walking bottom-up, start adding ops when we reach an anchor point
           // (a prim list of ints)
           if (isAnchorOp(op)) {
             shapeCalculationOps.insert(op);
+            depths[op] = 0;
             return;
           }
           // add view ops for now until the decompositions for flatten and
           // unflatten are removed.
           if (isa<AtenViewOp>(op)) {
             shapeCalculationOps.insert(op);
+            depths[op] = 0;
             return;
           }
           // Insert the op if any of it's consumers have already been identified
@@ -1684,26 +1699,36 @@ public:
           // calculation op, but the size.int op is an elementary unit of shape
           // computation. No futher gathering of producers is necessary to
           // reduce this. Similarly, don't always add the `self` of a view op.
+          std::optional<int64_t> depth;
           for (OpOperand &use : op->getUses()) {
             Operation *userOp = use.getOwner();
             if (shapeCalculationOps.contains(userOp) &&
                 !isSourceOpForShapeScalarization(userOp) &&
                 !isInvalidValidViewConsumer(userOp, shapeCalculationOps)) {
-              shapeCalculationOps.insert(op);
-              return;
+              int64_t userDepth = depths.lookup(userOp) + 1;
+              depth = depth ? std::min(*depth, userDepth) : userDepth;
             }
           }
+          if (!depth || (maxPropagationDepth > 0 &&
+                         *depth > static_cast<int64_t>(maxPropagationDepth)))
+            return;
+          shapeCalculationOps.insert(op);
+          depths[op] = *depth;
         });
+    numWorklistOps += shapeCalculationOps.size();
 
     GreedyRewriteConfig config;
     // When propagating, we need to go back and clean up aten.Tensor ops that
     // have been futher propagated. It is also necessary to add newly created
     // ops for custom folding after scalarizing a where.self op.
     config.setStrictness(GreedyRewriteStrictness::ExistingAndNewOps);
-    if (failed(applyOpPatternsGreedily(shapeCalculationOps.getArrayRef(),
-                                       std::move(patterns), config))) {
+    TouchedOpsListener listener;
+    config.setListener(&listener);
+    LogicalResult converged = applyOpPatternsGreedily(
+        shapeCalculationOps.getArrayRef(), std::move(patterns), config);
+    numTouchedOps += listener.numTouchedOps;
+    if (failed(converged))
       return signalPassFailure();
-    }
 
     // TODO: Warn when failing to process operations in the worklist.
   }
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Pass/Pass.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_SCHEDULECOLLECTIVES
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+static bool isCollective(Operation *op) {
+  return isa<C10dFunctionalAllReduceOp, C10dFunctionalAllGatherIntoTensorOp,
+             C10dFunctionalReduceScatterTensorOp>(op);
+}
+
+// Moves `op` up to just after the last op of its block that defines one of
+// its operands or is `barrier`, if any, or to the start of the block.
+static void hoist(Operation *op, Operation *barrier) {
+  Block *block = op->getBlock();
+  Operation *last = barrier;
+  for (Value operand : op->getOperands()) {
+    Operation *def = operand.getDefiningOp();
+    if (!def)
+      continue;
+    Operation *ancestor = block->findAncestorOpInBlock(*def);
+    if (ancestor && (!last || last->isBeforeInBlock(ancestor)))
+      last = ancestor;
+  }
+  if (last)
+    op->moveAfter(last);
+  else
+    op->moveBefore(&block->front());
+}
+
+// Moves `wait` down to just before the first op of its block that uses it.
+static void sink(C10dFunctionalWaitTensorOp wait) {
+  Block *block = wait->getBlock();
+  Operation *first = nullptr;
+  for (Operation *user : wait->getUsers()) {
+    Operation *ancestor = block->findAncestorOpInBlock(*user);
+    if (ancestor && (!first || ancestor->isBeforeInBlock(first)))
+      first = ancestor;
+  }
+  if (first)
+    wait->moveBefore(first);
+}
+
+namespace {
+class ScheduleCollectivesPass
+    : public impl::ScheduleCollectivesBase<ScheduleCollectivesPass> {
+  void runOnOperation() override {
+    SmallVector<Operation *> collectives;
+    SmallVector<C10dFunctionalWaitTensorOp> waits;
+    getOperation().walk([&](Operation *op) {
+      if (isCollective(op) && isa<ValueTensorType>(op->getOperand(0).getType()))
+        collectives.push_back(op);
+      else if (auto wait = dyn_cast<C10dFunctionalWaitTensorOp>(op))
+        waits.push_back(wait);
+    });
+
+    // Collectives keep their relative order, which all ranks must agree on.
+    DenseMap<Block *, Operation *> lastCollective;
+    for (Operation *op : collectives) {
+      Operation *&barrier = lastCollective[op->getBlock()];
+      hoist(op, barrier);
+      barrier = op;
+    }
+    for (C10dFunctionalWaitTensorOp wait : waits)
+      sink(wait);
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createScheduleCollectivesPass() {
+  return std::make_unique<ScheduleCollectivesPass>();
+}
+
+} // namespace mlir::torch::Torch
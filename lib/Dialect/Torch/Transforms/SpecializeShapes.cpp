@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+namespace mlir::torch::Torch {
+
+#define GEN_PASS_DEF_SPECIALIZESHAPES
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h.inc"
+
+// Parses a shape like `2x?x8`, or returns std::nullopt if it is malformed.
+static std::optional<SmallVector<int64_t>> parseShape(StringRef spec) {
+  SmallVector<int64_t> shape;
+  if (spec.empty())
+    return shape;
+  SmallVector<StringRef> dims;
+  spec.split(dims, 'x');
+  for (StringRef dim : dims) {
+    if (dim == "?") {
+      shape.push_back(kUnknownSize);
+      continue;
+    }
+    int64_t size;
+    if (dim.getAsInteger(10, size) || size < 0)
+      return std::nullopt;
+    shape.push_back(size);
+  }
+  return shape;
+}
+
+// Gives argument `index` of `func` the shape `spec`, and casts it back to
+// its old type for its existing uses. The casts are folded into the users,
+// and the new shape is propagated from there, by the refinement passes.
+static LogicalResult specializeArgument(func::FuncOp func, unsigned index,
+                                        StringRef spec) {
+  if (spec == "*")
+    return success();
+  BlockArgument arg = func.getArgument(index);
+  auto type = dyn_cast<BaseTensorType>(arg.getType());
+  if (!type)
+    return func.emitError() << "cannot give a shape to argument " << index
+                            << " of type " << arg.getType();
+  std::optional<SmallVector<int64_t>> shape = parseShape(spec);
+  if (!shape)
+    return func.emitError() << "malformed shape '" << spec << "' for argument "
+                            << index;
+  auto newType = cast<BaseTensorType>(
+      type.getWithSizesAndDtype(*shape, type.getOptionalDtype()));
+  if (!isValidSubtype(newType, type))
+    return func.emitError() << "shape '" << spec << "' is not compatible with "
+                            << "argument " << index << " of type " << type;
+  if (newType == type)
+    return success();
+
+  OpBuilder builder(func.getBody());
+  arg.setType(newType);
+  auto castBack =
+      TensorStaticInfoCastOp::create(builder, arg.getLoc(), type, arg);
+  arg.replaceAllUsesExcept(castBack, castBack);
+  return success();
+}
+
+// Clones into `scratchTable` the symbols of `module` that `op` references,
+// and transitively the symbols that those reference.
+static void cloneReferencedSymbols(Operation *op, SymbolTable &moduleTable,
+                                   SymbolTable &scratchTable) {
+  SmallVector<Operation *> worklist = {op};
+  while (!worklist.empty()) {
+    std::optional<SymbolTable::UseRange> uses =
+        SymbolTable::getSymbolUses(worklist.pop_back_val());
+    if (!uses)
+      continue;
+    for (const SymbolTable::SymbolUse &use : *uses) {
+      StringAttr name = use.getSymbolRef().getRootReference();
+      Operation *symbol = moduleTable.lookup(name);
+      if (!symbol || scratchTable.lookup(name))
+        continue;
+      Operation *clone = symbol->clone();
+      scratchTable.insert(clone);
+      worklist.push_back(clone);
+    }
+  }
+}
+
+namespace {
+class SpecializeShapesPass
+    : public impl::SpecializeShapesBase<SpecializeShapesPass> {
+public:
+  using impl::SpecializeShapesBase<SpecializeShapesPass>::SpecializeShapesBase;
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable moduleTable(module);
+    auto func = moduleTable.lookup<func::FuncOp>(funcName);
+    if (!func || func.isExternal() || !func.isPublic()) {
+      module.emitError() << "no public function named '" << funcName
+                         << "' to specialize";
+      return signalPassFailure();
+    }
+    if (argShapes.size() != func.getNumArguments()) {
+      func.emitError() << "expected " << func.getNumArguments()
+                       << " arg shapes, but got " << argShapes.size();
+      return signalPassFailure();
+    }
+    std::string name = specializedName.empty()
+                           ? funcName + "_specialized"
+                           : static_cast<std::string>(specializedName);
+    if (moduleTable.lookup(name)) {
+      module.emitError() << "the module already has a symbol named '" << name
+                         << "'";
+      return signalPassFailure();
+    }
+
+    // Refine the clone in a scratch module, so that the refinement passes
+    // neither revisit the rest of the module nor leave the library functions
+    // that they splice in behind.
+    OpBuilder builder(module.getBodyRegion());
+    builder.setInsertionPointToEnd(module.getBody());
+    auto scratch = ModuleOp::create(builder, module.getLoc());
+    SymbolTable scratchTable(scratch);
+    auto specialized = cast<func::FuncOp>(func->clone());
+    specialized.setName(name);
+    scratchTable.insert(specialized);
+    cloneReferencedSymbols(specialized, moduleTable, scratchTable);
+
+    for (auto [index, spec] : llvm::enumerate(argShapes)) {
+      if (failed(specializeArgument(specialized, index, spec))) {
+        scratch.erase();
+        return signalPassFailure();
+      }
+    }
+    specialized.setType(FunctionType::get(
+        &getContext(), specialized.getBody().getArgumentTypes(),
+        specialized.getResultTypes()));
+
+    OpPassManager pm(ModuleOp::getOperationName());
+    TorchLoweringPipelineOptions options;
+    options.extraLibrary = extraLibrary;
+    pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+    createTorchShapeRefinementPipeline(pm, options);
+    pm.addNestedPass<func::FuncOp>(createScalarizeShapesPass());
+    createTorchShapeRefinementPipeline(pm, options);
+    pm.addPass(createRefinePublicReturnPass());
+    pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+    if (failed(runPipeline(pm, scratch))) {
+      scratch.erase();
+      return signalPassFailure();
+    }
+
+    // The symbols that the specialized function references resolve to the
+    // originals again once it is back in `module`.
+    specialized->moveAfter(func);
+    scratch.erase();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createSpecializeShapesPass() {
+  return std::make_unique<SpecializeShapesPass>();
+}
+
+} // namespace mlir::torch::Torch
@@ -321,6 +321,33 @@ std::optional<int64_t> Torch::getTensorNumel(Value tensor) {
   return numel;
 }
 
+std::optional<int64_t> Torch::getTensorStaticBytes(Value tensor) {
+  auto type = dyn_cast<BaseTensorType>(tensor.getType());
+  if (!type || !type.hasSizes() || !type.hasDtype())
+    return std::nullopt;
+  int64_t numel = 1;
+  for (int64_t dim : type.getSizes()) {
+    if (dim == kUnknownSize)
+      return std::nullopt;
+    numel *= dim;
+  }
+  Type dtype = type.getDtype();
+  int64_t bits;
+  if (auto complexType = dyn_cast<mlir::ComplexType>(dtype))
+    bits = 2 * complexType.getElementType().getIntOrFloatBitWidth();
+  else if (dtype.isIntOrFloat())
+    bits = dtype.getIntOrFloatBitWidth();
+  else if (isa<QInt8Type, QUInt8Type>(dtype))
+    bits = 8;
+  else if (isa<QInt16Type>(dtype))
+    bits = 16;
+  else if (isa<QInt32Type>(dtype))
+    bits = 32;
+  else
+    return std::nullopt;
+  return numel * llvm::divideCeil(bits, 8);
+}
+
 bool Torch::isViewLikeOp(Operation *op) {
   // AtenContiguousOp might return a view, so this is conservatively
   // correct. We could potentially be more precise and identify the cases
@@ -340,6 +367,106 @@ bool Torch::isViewLikeOp(Operation *op) {
       op);
 }
 
+// The number of elements of `value`, if it is a tensor of static shape.
+static std::optional<int64_t> getStaticNumel(Value value) {
+  auto type = dyn_cast<BaseTensorType>(value.getType());
+  if (!type || !type.hasSizes())
+    return std::nullopt;
+  int64_t numel = 1;
+  for (int64_t dim : type.getSizes()) {
+    if (dim == kUnknownSize)
+      return std::nullopt;
+    numel *= dim;
+  }
+  return numel;
+}
+
+// The size of dim `dim` of `value`, if it is static.
+static std::optional<int64_t> getStaticDim(Value value, int64_t dim) {
+  auto type = dyn_cast<BaseTensorType>(value.getType());
+  if (!type || !type.hasSizes())
+    return std::nullopt;
+  ArrayRef<int64_t> sizes = type.getSizes();
+  dim = toPositiveDim(dim, sizes.size());
+  if (!isValidDim(dim, sizes.size()) || sizes[dim] == kUnknownSize)
+    return std::nullopt;
+  return sizes[dim];
+}
+
+StringRef Torch::getOpCostClass(Operation *op) {
+  if (isa<AtenMmOp, AtenBmmOp, AtenMatmulOp, AtenLinearOp, AtenAddmmOp,
+          AtenBaddbmmOp, AtenMvOp, AtenDotOp>(op))
+    return "matmul";
+  if (isa<AtenConvolutionOp, Aten_ConvolutionOp, AtenConv1dOp, AtenConv2dOp,
+          AtenConv3dOp, AtenConvTranspose1dOp, AtenConvTranspose2dInputOp,
+          AtenConvTranspose3dInputOp>(op))
+    return "convolution";
+  if (isa<AtenScaledDotProductAttentionOp>(op))
+    return "attention";
+  if (isViewLikeOp(op) &&
+      !isa<AtenToDtypeOp, AtenToDtypeLayoutOp, AtenToDeviceOp>(op))
+    return "view";
+  return "other";
+}
+
+std::optional<int64_t> Torch::estimateOpFlops(Operation *op) {
+  StringRef opClass = getOpCostClass(op);
+  if (opClass == "view")
+    return 0;
+  if (opClass == "matmul") {
+    Value lhs = isa<AtenAddmmOp, AtenBaddbmmOp>(op) ? op->getOperand(1)
+                                                    : op->getOperand(0);
+    std::optional<int64_t> numel = getStaticNumel(op->getResult(0));
+    std::optional<int64_t> k = getStaticDim(lhs, -1);
+    if (!numel || !k)
+      return std::nullopt;
+    return 2 * *numel * *k;
+  }
+  if (opClass == "convolution") {
+    bool transposed = isa<AtenConvTranspose1dOp, AtenConvTranspose2dInputOp,
+                          AtenConvTranspose3dInputOp>(op);
+    if (auto convolution = dyn_cast<AtenConvolutionOp>(op)) {
+      if (!matchPattern(convolution.getTransposed(),
+                        m_TorchConstantBool(&transposed)))
+        return std::nullopt;
+    }
+    if (auto convolution = dyn_cast<Aten_ConvolutionOp>(op)) {
+      if (!matchPattern(convolution.getTransposed(),
+                        m_TorchConstantBool(&transposed)))
+        return std::nullopt;
+    }
+    // The weight is [out, in / groups, kernel...], or [in, out / groups,
+    // kernel...] when transposed, so that each element of the result, or of
+    // the input when transposed, takes the product of its other dims.
+    std::optional<int64_t> numel =
+        getStaticNumel(transposed ? op->getOperand(0) : op->getResult(0));
+    std::optional<int64_t> weightNumel = getStaticNumel(op->getOperand(1));
+    std::optional<int64_t> weightDim = getStaticDim(op->getOperand(1), 0);
+    if (!numel || !weightNumel || !weightDim || *weightDim == 0)
+      return std::nullopt;
+    return 2 * *numel * (*weightNumel / *weightDim);
+  }
+  if (opClass == "attention") {
+    std::optional<int64_t> queryNumel = getStaticNumel(op->getOperand(0));
+    std::optional<int64_t> e = getStaticDim(op->getOperand(0), -1);
+    std::optional<int64_t> s = getStaticDim(op->getOperand(1), -2);
+    std::optional<int64_t> ev = getStaticDim(op->getOperand(2), -1);
+    if (!queryNumel || !e || !s || !ev || *e == 0)
+      return std::nullopt;
+    return 2 * (*queryNumel / *e) * *s * (*e + *ev);
+  }
+  int64_t flops = 0;
+  for (Value value : llvm::concat<Value>(op->getOperands(), op->getResults())) {
+    if (!isa<BaseTensorType>(value.getType()))
+      continue;
+    std::optional<int64_t> numel = getStaticNumel(value);
+    if (!numel)
+      return std::nullopt;
+    flops = std::max(flops, *numel);
+  }
+  return flops;
+}
+
 Value Torch::getConstantWithGivenDtypeAndValue(PatternRewriter &rewriter,
                                                Location loc, float value,
                                                Type dtype) {
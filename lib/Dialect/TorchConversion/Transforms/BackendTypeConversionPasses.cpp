@@ -151,39 +151,46 @@ createFuncBackendTypeConversionForStablehloPass() {
 // FinalizingBackendTypeConversionPass
 //===----------------------------------------------------------------------===//
 
-namespace {
-// In a finalizing conversion, we know that all of the source types have been
-// converted to the destination types, so the materialization becomes an
-// identity.
-template <typename OpTy>
-class FinalizeMaterialization : public OpConversionPattern<OpTy> {
-public:
-  using OpConversionPattern<OpTy>::OpConversionPattern;
-  using OpAdaptor = typename OpTy::Adaptor;
-  LogicalResult
-  matchAndRewrite(OpTy op, OpAdaptor adaptor,
-                  ConversionPatternRewriter &rewriter) const override {
-    rewriter.replaceOp(op, adaptor.getOperands()[0]);
-    return success();
-  }
-};
-} // namespace
-
-template <typename OpTy>
-static void setupFinalization(ConversionTarget &target,
-                              RewritePatternSet &patterns,
-                              TypeConverter &typeConverter) {
-  target.addIllegalOp<OpTy>();
-  patterns.add<FinalizeMaterialization<OpTy>>(typeConverter,
-                                              patterns.getContext());
+// Whether `op` only has operands, results and block arguments of the types
+// of the backend contract.
+static bool isLegalAfterFinalization(Operation *op,
+                                     const TypeConverter &typeConverter) {
+  if (!typeConverter.isLegal(op))
+    return false;
+  for (Region &region : op->getRegions())
+    for (Block &block : region)
+      if (!typeConverter.isLegal(block.getArgumentTypes()))
+        return false;
+  return true;
 }
 
-template <typename OpTy, typename OpTy2, typename... OpTys>
-static void setupFinalization(ConversionTarget &target,
-                              RewritePatternSet &patterns,
-                              TypeConverter &typeConverter) {
-  setupFinalization<OpTy>(target, patterns, typeConverter);
-  setupFinalization<OpTy2, OpTys...>(target, patterns, typeConverter);
+// In a finalizing conversion, we know that all of the source types have been
+// converted to the destination types, so the materializations become
+// identities. Rather than running a dialect conversion, which tracks a
+// rewrite for every op of the function, this forwards the operand of every
+// materialization to its users in a single walk. A materialization is
+// visited after the one defining its operand, so chains of them, like the
+// `to_builtin_tensor` of a `from_builtin_tensor`, fold to their source.
+template <typename... OpTys>
+static LogicalResult
+finalizeMaterializations(Operation *root, const TypeConverter &typeConverter) {
+  WalkResult check = root->walk([&](Operation *op) {
+    if (isa<OpTys...>(op) || isLegalAfterFinalization(op, typeConverter))
+      return WalkResult::advance();
+    op->emitError() << "failed to legalize operation '" << op->getName()
+                    << "'";
+    return WalkResult::interrupt();
+  });
+  if (check.wasInterrupted())
+    return failure();
+
+  root->walk([](Operation *op) {
+    if (!isa<OpTys...>(op))
+      return;
+    op->getResult(0).replaceAllUsesWith(op->getOperand(0));
+    op->erase();
+  });
+  return success();
 }
 
 static void stripTorchAttrs(FunctionOpInterface func) {
@@ -213,35 +220,25 @@ struct FinalizingBackendTypeConversionPass
     auto *context = &getContext();
 
     TypeConverter typeConverter;
-    RewritePatternSet patterns(context);
     ConversionTarget target(*context);
 
     typeConverter.addConversion([](Type type) { return type; });
     TorchConversion::setupBackendTypeConversion(target, typeConverter);
 
-    // Mark materializations as illegal in this pass (since we are finalizing)
-    // and add patterns that eliminate them.
-    setupFinalization<ToBuiltinTensorOp, FromBuiltinTensorOp, FromI1Op, ToI1Op,
-                      FromI64Op, ToI64Op, FromF64Op, ToF64Op, I64ToGeneratorOp,
-                      GeneratorToI64Op>(target, patterns, typeConverter);
-
     // If all result types are legal, and all block arguments are legal, then
-    // all types in the program are legal.
-    //
-    // We also check that the operand types are legal to avoid creating invalid
-    // IR. For example, this prevents the patterns from updating
-    // the types of the operands to a return op without updating the enclosing
-    // function.
-    target.markUnknownOpDynamicallyLegal(
-        [&](Operation *op) { return typeConverter.isLegal(op); });
-
-    if (failed(applyFullConversion(func, target, std::move(patterns))))
-      signalPassFailure();
+    // all types in the program are legal. We also check the operand types, so
+    // that no op is left reading a value of a source type, and only then
+    // erase the materializations.
+    if (failed(finalizeMaterializations<
+               ToBuiltinTensorOp, FromBuiltinTensorOp, FromI1Op, ToI1Op,
+               FromI64Op, ToI64Op, FromF64Op, ToF64Op, I64ToGeneratorOp,
+               GeneratorToI64Op>(func, typeConverter)))
+      return signalPassFailure();
 
     RewritePatternSet greedyPatterns(context);
     greedyPatterns.insert<ExtFTruncFPattern>(context);
     if (failed(applyPatternsGreedily(func, std::move(greedyPatterns))))
-      signalPassFailure();
+      return signalPassFailure();
 
     // Drop attributes that are no longer used after conversion out of Torch.
     stripTorchAttrs(func);
@@ -261,31 +258,21 @@ struct FinalizingBackendTypeConversionForStablehloPass
     auto *context = &getContext();
 
     TypeConverter typeConverter;
-    RewritePatternSet patterns(context);
     ConversionTarget target(*context);
 
     typeConverter.addConversion([](Type type) { return type; });
     TorchConversion::setupBackendTypeConversionForStablehlo(target,
                                                             typeConverter);
 
-    // Mark materializations as illegal in this pass (since we are finalizing)
-    // and add patterns that eliminate them.
-    setupFinalization<ToBuiltinTensorOp, FromBuiltinTensorOp, FromI1Op, ToI1Op,
-                      FromI64Op, ToI64Op, FromF64Op, ToF64Op, I64ToGeneratorOp,
-                      GeneratorToI64Op>(target, patterns, typeConverter);
-
     // If all result types are legal, and all block arguments are legal, then
-    // all types in the program are legal.
-    //
-    // We also check that the operand types are legal to avoid creating invalid
-    // IR. For example, this prevents the patterns from updating
-    // the types of the operands to a return op without updating the enclosing
-    // function.
-    target.markUnknownOpDynamicallyLegal(
-        [&](Operation *op) { return typeConverter.isLegal(op); });
-
-    if (failed(applyFullConversion(func, target, std::move(patterns))))
-      signalPassFailure();
+    // all types in the program are legal. We also check the operand types, so
+    // that no op is left reading a value of a source type, and only then
+    // erase the materializations.
+    if (failed(finalizeMaterializations<
+               ToBuiltinTensorOp, FromBuiltinTensorOp, FromI1Op, ToI1Op,
+               FromI64Op, ToI64Op, FromF64Op, ToF64Op, I64ToGeneratorOp,
+               GeneratorToI64Op>(func, typeConverter)))
+      return signalPassFailure();
 
     // Drop attributes that are no longer used after conversion out of Torch.
     stripTorchAttrs(func);
@@ -124,8 +124,6 @@ public:
     Value cst0 = arith::ConstantOp::create(rewriter, loc,
                                            FloatAttr::get(elementType, 0.0));
 
-    Value emptyDequant =
-        tensor::EmptyOp::create(rewriter, loc, rhsExpandedShape, elementType);
     SmallVector<Value> dynDims;
     for (int i = 0; i < lhsType.getRank(); i++) {
       if (lhsType.isDynamicDim(i)) {
@@ -137,56 +135,47 @@ public:
     Value output =
         linalg::FillOp::create(rewriter, loc, cst0, empty).getResult(0);
 
+    // Dequantize each weight in the inner loop of the contraction rather
+    // than into a full-precision copy of the weights up front, so that the
+    // matmul, which is bandwidth bound for small batches, only reads the
+    // packed weights. The d3 loop runs over the groups of the reduction dim
+    // and d4 within a group, which selects the scale and zero point.
     AffineExpr d0, d1, d2, d3, d4;
     bindDims(getContext(), d0, d1, d2, d3, d4);
     auto c0 = rewriter.getAffineConstantExpr(0);
-    auto map = AffineMap::get(3, 0, {d0, d1, d2}, rewriter.getContext());
-    auto map1 = AffineMap::get(3, 0, {d0, d1, c0}, rewriter.getContext());
-    auto map2 = AffineMap::get(5, 0, {d0, d1, d3, d4}, rewriter.getContext());
-    auto map3 = AffineMap::get(5, 0, {d2, d3, d4}, rewriter.getContext());
-    auto map4 = AffineMap::get(5, 0, {d0, d1, d2}, rewriter.getContext());
-    SmallVector<AffineMap, 4> dqIndexingMaps = {map, map1, map1, map};
-    SmallVector<AffineMap, 4> matIndexingMaps = {map2, map3, map4};
-
-    SmallVector<utils::IteratorType> dequantIteratorTypes(
-        3, utils::IteratorType::parallel);
-    SmallVector<utils::IteratorType> matmulIteratorTypes = {
+    auto lhsMap = AffineMap::get(5, 0, {d0, d1, d3, d4}, rewriter.getContext());
+    auto rhsMap = AffineMap::get(5, 0, {d2, d3, d4}, rewriter.getContext());
+    auto groupMap = AffineMap::get(5, 0, {d2, d3, c0}, rewriter.getContext());
+    auto outMap = AffineMap::get(5, 0, {d0, d1, d2}, rewriter.getContext());
+    SmallVector<AffineMap, 4> indexingMaps = {lhsMap, rhsMap, groupMap,
+                                              groupMap, outMap};
+
+    SmallVector<utils::IteratorType> iteratorTypes = {
         utils::IteratorType::parallel, utils::IteratorType::parallel,
         utils::IteratorType::parallel, utils::IteratorType::reduction,
         utils::IteratorType::reduction};
 
-    Value rhsDequant =
+    Value matmulDequant =
         linalg::GenericOp::create(
-            rewriter, loc, emptyDequant.getType(),
-            ValueRange{rhsExpanded, scales, zps}, emptyDequant,
-            /*indexingMaps=*/dqIndexingMaps,
-            /*iteratorTypes=*/dequantIteratorTypes,
+            rewriter, loc, output.getType(),
+            ValueRange{lhsExpanded, rhsExpanded, scales, zps}, output,
+            /*indexingMaps=*/indexingMaps,
+            /*iteratorTypes=*/iteratorTypes,
             [&](OpBuilder &b, Location loc, ValueRange args) {
-              Value w = args[0], scale = args[1], zeroPoint = args[2];
+              Value l = args[0], w = args[1], scale = args[2],
+                    zeroPoint = args[3], out = args[4];
               Value extw =
                   arith::ExtUIOp::create(b, loc, rewriter.getI32Type(), w);
               Value fp_extw =
-                  arith::UIToFPOp::create(b, loc, rewriter.getF16Type(), extw);
+                  arith::UIToFPOp::create(b, loc, elementType, extw);
               Value shifted = arith::SubFOp::create(b, loc, fp_extw, zeroPoint);
               Value dqw = arith::MulFOp::create(b, loc, shifted, scale);
-              linalg::YieldOp::create(b, loc, dqw);
+              Value pd = arith::MulFOp::create(b, loc, l, dqw);
+              Value ac = arith::AddFOp::create(b, loc, pd, out);
+              linalg::YieldOp::create(b, loc, ac);
             })
             .getResult(0);
 
-    Value matmulDequant = linalg::GenericOp::create(
-                              rewriter, loc, output.getType(),
-                              ValueRange{lhsExpanded, rhsDequant}, output,
-                              /*indexingMaps=*/matIndexingMaps,
-                              /*iteratorTypes=*/matmulIteratorTypes,
-                              [&](OpBuilder &b, Location loc, ValueRange args) {
-                                Value l = args[0], r = args[1], out = args[2];
-                                Value pd = arith::MulFOp::create(b, loc, l, r);
-                                Value ac =
-                                    arith::AddFOp::create(b, loc, pd, out);
-                                linalg::YieldOp::create(b, loc, ac);
-                              })
-                              .getResult(0);
-
     rewriter.replaceOpWithNewOp<tensor::CastOp>(op, resultType, matmulDequant);
     return success();
   }
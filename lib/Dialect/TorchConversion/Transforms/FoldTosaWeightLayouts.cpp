@@ -0,0 +1,255 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+#ifdef TORCH_MLIR_ENABLE_TOSA
+#include "mlir/Dialect/Tosa/IR/TosaOps.h"
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+#include "llvm/ADT/APFloat.h"
+
+#include <cstring>
+
+using namespace mlir;
+using namespace mlir::torch;
+namespace mlir::torch::TorchConversion {
+
+#define GEN_PASS_DEF_FOLDTOSAWEIGHTLAYOUTS
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h.inc"
+
+// The number of elements that each task of the parallel loops below handles.
+static constexpr int64_t kElementsPerTask = 1 << 14;
+
+// Runs `fn(begin, end)` over `[0, numElements)` in chunks, on the context's
+// thread pool.
+static void parallelForChunks(MLIRContext *context, int64_t numElements,
+                              function_ref<void(int64_t, int64_t)> fn) {
+  int64_t numTasks = llvm::divideCeil(numElements, kElementsPerTask);
+  parallelFor(context, 0, numTasks, [&](size_t task) {
+    int64_t begin = task * kElementsPerTask;
+    fn(begin, std::min(begin + kElementsPerTask, numElements));
+  });
+}
+
+// The size in bytes of one element of `type` in a resource blob, or
+// std::nullopt if its elements are not whole bytes of at most 64 bits.
+static std::optional<int64_t> getElementBytes(Type type) {
+  if (!type.isIntOrFloat())
+    return std::nullopt;
+  unsigned bitWidth = type.getIntOrFloatBitWidth();
+  if (bitWidth % 8 != 0 || bitWidth > 64)
+    return std::nullopt;
+  return bitWidth / 8;
+}
+
+// Matches a constant holding a dense resource whose blob has the data of
+// every element of its statically shaped type. Folds that write a new blob
+// require the constant to have no other users, so that the weight is not
+// kept in both layouts.
+static FailureOr<ArrayRef<char>>
+matchResourceConstant(Value value, DenseResourceElementsAttr &attr,
+                      bool requireOneUse) {
+  auto constOp = value.getDefiningOp<tosa::ConstOp>();
+  if (!constOp || (requireOneUse && !constOp->hasOneUse()))
+    return failure();
+  attr = dyn_cast<DenseResourceElementsAttr>(constOp.getValues());
+  if (!attr)
+    return failure();
+  auto type = cast<ShapedType>(attr.getType());
+  std::optional<int64_t> elementBytes = getElementBytes(type.getElementType());
+  AsmResourceBlob *blob = attr.getRawHandle().getBlob();
+  if (!type.hasStaticShape() || !elementBytes || !blob)
+    return failure();
+  ArrayRef<char> data = blob->getData();
+  int64_t numBytes = type.getNumElements() * *elementBytes;
+  if (static_cast<int64_t>(data.size()) != numBytes)
+    return failure();
+  return data;
+}
+
+// Allocates a blob for `numBytes` of data with the alignment of `source`.
+static AsmResourceBlob allocateBlobLike(DenseResourceElementsAttr source,
+                                        size_t numBytes) {
+  return HeapAsmResourceBlob::allocate(
+      numBytes, source.getRawHandle().getBlob()->getDataAlignment(),
+      /*dataIsMutable=*/true);
+}
+
+static uint64_t readElement(const char *data, int64_t bytes) {
+  uint64_t value = 0;
+  std::memcpy(&value, data, bytes);
+  return value;
+}
+
+static void writeElement(char *data, int64_t bytes, uint64_t value) {
+  std::memcpy(data, &value, bytes);
+}
+
+namespace {
+// Folds a tosa.transpose of a weight into a new resource blob.
+class FoldTransposeOfResource : public OpRewritePattern<tosa::TransposeOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tosa::TransposeOp op,
+                                PatternRewriter &rewriter) const override {
+    DenseResourceElementsAttr attr;
+    FailureOr<ArrayRef<char>> data = matchResourceConstant(
+        op.getInput1(), attr, /*requireOneUse=*/true);
+    auto resultType = dyn_cast<RankedTensorType>(op.getType());
+    if (failed(data) || !resultType || !resultType.hasStaticShape())
+      return rewriter.notifyMatchFailure(op, "not a transpose of a weight");
+
+    auto inputType = cast<ShapedType>(attr.getType());
+    ArrayRef<int64_t> inputShape = inputType.getShape();
+    ArrayRef<int64_t> resultShape = resultType.getShape();
+    ArrayRef<int32_t> perms = op.getPerms();
+    int64_t rank = inputShape.size();
+    int64_t elementBytes = *getElementBytes(inputType.getElementType());
+
+    // The stride in the input of each dim of the result.
+    SmallVector<int64_t> inputStrides(rank, 1);
+    for (int64_t i = rank - 2; i >= 0; --i)
+      inputStrides[i] = inputStrides[i + 1] * inputShape[i + 1];
+    SmallVector<int64_t> strides;
+    for (int32_t perm : perms)
+      strides.push_back(inputStrides[perm]);
+
+    int64_t numElements = resultType.getNumElements();
+    AsmResourceBlob blob = allocateBlobLike(attr, numElements * elementBytes);
+    char *out = blob.getMutableData().data();
+    const char *in = data->data();
+    parallelForChunks(getContext(), numElements, [&](int64_t begin,
+                                                     int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        int64_t offset = 0;
+        for (int64_t dim = rank - 1, rest = i; dim >= 0; --dim) {
+          offset += (rest % resultShape[dim]) * strides[dim];
+          rest /= resultShape[dim];
+        }
+        std::memcpy(out + i * elementBytes, in + offset * elementBytes,
+                    elementBytes);
+      }
+    });
+
+    std::string name = (attr.getRawHandle().getKey() + "_transposed").str();
+    rewriter.replaceOpWithNewOp<tosa::ConstOp>(
+        op, resultType,
+        DenseResourceElementsAttr::get(resultType, name, std::move(blob)));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Folds a tosa.reshape of a weight by giving the weight's blob the new shape.
+class FoldReshapeOfResource : public OpRewritePattern<tosa::ReshapeOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tosa::ReshapeOp op,
+                                PatternRewriter &rewriter) const override {
+    DenseResourceElementsAttr attr;
+    FailureOr<ArrayRef<char>> data = matchResourceConstant(
+        op.getInput1(), attr, /*requireOneUse=*/false);
+    auto resultType = dyn_cast<RankedTensorType>(op.getType());
+    if (failed(data) || !resultType || !resultType.hasStaticShape())
+      return rewriter.notifyMatchFailure(op, "not a reshape of a weight");
+
+    rewriter.replaceOpWithNewOp<tosa::ConstOp>(
+        op, resultType,
+        DenseResourceElementsAttr::get(resultType, attr.getRawHandle()));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Folds a tosa.cast of a weight between float types or between integer types
+// into a new resource blob. Floats are rounded to nearest even and integers
+// are sign extended or truncated, as TOSA specifies.
+class FoldCastOfResource : public OpRewritePattern<tosa::CastOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tosa::CastOp op,
+                                PatternRewriter &rewriter) const override {
+    DenseResourceElementsAttr attr;
+    FailureOr<ArrayRef<char>> data = matchResourceConstant(
+        op.getInput(), attr, /*requireOneUse=*/true);
+    auto resultType = dyn_cast<RankedTensorType>(op.getType());
+    if (failed(data) || !resultType)
+      return rewriter.notifyMatchFailure(op, "not a cast of a weight");
+
+    Type inElementType = cast<ShapedType>(attr.getType()).getElementType();
+    Type outElementType = resultType.getElementType();
+    std::optional<int64_t> outBytes = getElementBytes(outElementType);
+    if (!outBytes)
+      return rewriter.notifyMatchFailure(op, "unsupported result type");
+    auto inFloat = dyn_cast<FloatType>(inElementType);
+    auto outFloat = dyn_cast<FloatType>(outElementType);
+    if (static_cast<bool>(inFloat) != static_cast<bool>(outFloat))
+      return rewriter.notifyMatchFailure(
+          op, "only casts between floats or between integers are folded");
+
+    int64_t inBytes = *getElementBytes(inElementType);
+    unsigned inBits = inElementType.getIntOrFloatBitWidth();
+    unsigned outBits = outElementType.getIntOrFloatBitWidth();
+    int64_t numElements = resultType.getNumElements();
+    AsmResourceBlob blob = allocateBlobLike(attr, numElements * *outBytes);
+    char *out = blob.getMutableData().data();
+    const char *in = data->data();
+    parallelForChunks(getContext(), numElements, [&](int64_t begin,
+                                                     int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        APInt value(inBits, readElement(in + i * inBytes, inBytes));
+        if (inFloat) {
+          APFloat f(inFloat.getFloatSemantics(), value);
+          bool losesInfo;
+          f.convert(outFloat.getFloatSemantics(),
+                    APFloat::rmNearestTiesToEven, &losesInfo);
+          value = f.bitcastToAPInt();
+        } else {
+          value = value.sextOrTrunc(outBits);
+        }
+        writeElement(out + i * *outBytes, *outBytes, value.getZExtValue());
+      }
+    });
+
+    std::string name = (attr.getRawHandle().getKey() + "_cast").str();
+    rewriter.replaceOpWithNewOp<tosa::ConstOp>(
+        op, resultType,
+        DenseResourceElementsAttr::get(resultType, name, std::move(blob)));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class FoldTosaWeightLayoutsPass
+    : public impl::FoldTosaWeightLayoutsBase<FoldTosaWeightLayoutsPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<FoldTransposeOfResource, FoldReshapeOfResource,
+                 FoldCastOfResource>(context);
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createFoldTosaWeightLayoutsPass() {
+  return std::make_unique<FoldTosaWeightLayoutsPass>();
+}
+
+} // namespace mlir::torch::TorchConversion
+#endif // TORCH_MLIR_ENABLE_TOSA
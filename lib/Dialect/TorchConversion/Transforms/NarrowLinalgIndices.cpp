@@ -0,0 +1,417 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Analysis/DataFlow/ConstantPropagationAnalysis.h"
+#include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Analysis/DataFlow/IntegerRangeAnalysis.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Arith/Transforms/Passes.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/Utils/InferIntRangeCommon.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using mlir::dataflow::IntegerValueRangeLattice;
+namespace mlir::torch::TorchConversion {
+
+#define GEN_PASS_DEF_NARROWLINALGINDICES
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h.inc"
+
+// The range of the symbolic size `expr`, given the ranges of its symbols.
+static std::optional<ConstantIntRanges>
+getExprRange(AffineExpr expr, ArrayRef<ConstantIntRanges> symbols) {
+  if (auto symbol = dyn_cast<AffineSymbolExpr>(expr))
+    return symbols[symbol.getPosition()];
+  if (auto constant = dyn_cast<AffineConstantExpr>(expr))
+    return ConstantIntRanges::constant(
+        APInt(64, constant.getValue(), /*isSigned=*/true));
+  auto binary = dyn_cast<AffineBinaryOpExpr>(expr);
+  if (!binary)
+    return std::nullopt;
+  std::optional<ConstantIntRanges> lhs = getExprRange(binary.getLHS(), symbols);
+  std::optional<ConstantIntRanges> rhs = getExprRange(binary.getRHS(), symbols);
+  if (!lhs || !rhs)
+    return std::nullopt;
+  switch (expr.getKind()) {
+  case AffineExprKind::Add:
+    return intrange::inferAdd({*lhs, *rhs});
+  case AffineExprKind::Mul:
+    return intrange::inferMul({*lhs, *rhs});
+  case AffineExprKind::FloorDiv:
+    return intrange::inferFloorDivS({*lhs, *rhs});
+  case AffineExprKind::CeilDiv:
+    return intrange::inferCeilDivS({*lhs, *rhs});
+  case AffineExprKind::Mod:
+    return intrange::inferRemS({*lhs, *rhs});
+  default:
+    return std::nullopt;
+  }
+}
+
+namespace {
+// The ranges of the dims of the builtin tensors of a function: the static
+// dims, and the dynamic dims that `torch.bind_symbolic_shape` gives a size
+// in terms of `torch.symbolic_int`s, whose ranges are the guards of the
+// exported program.
+class DimRanges {
+public:
+  DimRanges(FunctionOpInterface func) {
+    func.walk([&](Torch::BindSymbolicShapeOp bind) { addBinding(bind); });
+  }
+
+  std::optional<ConstantIntRanges> lookup(Value tensor, int64_t dim) const {
+    auto type = dyn_cast<RankedTensorType>(tensor.getType());
+    if (!type)
+      return std::nullopt;
+    if (!type.isDynamicDim(dim))
+      return ConstantIntRanges::constant(APInt(64, type.getDimSize(dim)));
+    auto it = ranges.find({tensor, dim});
+    if (it == ranges.end())
+      return std::nullopt;
+    return it->second;
+  }
+
+private:
+  void addBinding(Torch::BindSymbolicShapeOp bind) {
+    Value tensor = bind.getOperand();
+    auto type = cast<Torch::ValueTensorType>(tensor.getType());
+    AffineMap map = bind.getShapeExpressions().getValue();
+    if (!type.hasSizes() || map.getNumResults() != type.getSizes().size())
+      return;
+
+    SmallVector<ConstantIntRanges> symbols;
+    for (Value symbol : bind.getShapeSymbols()) {
+      auto symbolicInt = symbol.getDefiningOp<Torch::SymbolicIntOp>();
+      if (!symbolicInt) {
+        symbols.push_back(ConstantIntRanges::maxRange(64));
+        continue;
+      }
+      symbols.push_back(ConstantIntRanges::fromSigned(
+          APInt(64, symbolicInt.getMinVal(), /*isSigned=*/true),
+          APInt(64, symbolicInt.getMaxVal(), /*isSigned=*/true)));
+    }
+
+    // The builtin tensors that the bound tensor is converted from and to.
+    SmallVector<Value> builtins;
+    if (auto from = tensor.getDefiningOp<FromBuiltinTensorOp>())
+      builtins.push_back(from.getOperand());
+    for (Operation *user : tensor.getUsers()) {
+      if (auto to = dyn_cast<ToBuiltinTensorOp>(user))
+        builtins.push_back(to.getResult());
+    }
+
+    for (auto [dim, size] : llvm::enumerate(type.getSizes())) {
+      if (size != Torch::kUnknownSize)
+        continue;
+      std::optional<ConstantIntRanges> range =
+          getExprRange(map.getResult(dim), symbols);
+      if (!range)
+        continue;
+      for (Value builtin : builtins)
+        ranges.insert({{builtin, dim}, *range});
+    }
+  }
+
+  DenseMap<std::pair<Value, int64_t>, ConstantIntRanges> ranges;
+};
+} // namespace
+
+// The range of the elements of `attr`.
+static ConstantIntRanges getElementsRange(DenseIntElementsAttr attr) {
+  if (attr.isSplat())
+    return ConstantIntRanges::constant(attr.getSplatValue<APInt>());
+  APInt smin = *attr.value_begin<APInt>(), smax = smin;
+  for (const APInt &value : attr.getValues<APInt>()) {
+    if (value.slt(smin))
+      smin = value;
+    if (value.sgt(smax))
+      smax = value;
+  }
+  return ConstantIntRanges::fromSigned(smin, smax);
+}
+
+namespace {
+// An integer range analysis that also bounds the dims in `DimRanges`, the
+// loop indices of linalg ops, and the elements that `linalg.generic` ops read
+// from constants and from the results of other `linalg.generic` ops.
+class IndexRangeAnalysis : public dataflow::IntegerRangeAnalysis {
+public:
+  IndexRangeAnalysis(DataFlowSolver &solver, const DimRanges &dimRanges)
+      : IntegerRangeAnalysis(solver), dimRanges(dimRanges) {}
+
+  LogicalResult
+  visitOperation(Operation *op,
+                 ArrayRef<const IntegerValueRangeLattice *> operands,
+                 ArrayRef<IntegerValueRangeLattice *> results) override {
+    std::optional<ConstantIntRanges> range;
+    if (auto dimOp = dyn_cast<tensor::DimOp>(op)) {
+      if (std::optional<int64_t> dim = dimOp.getConstantIndex())
+        range = dimRanges.lookup(dimOp.getSource(), *dim);
+    } else if (auto indexOp = dyn_cast<linalg::IndexOp>(op)) {
+      range = getLoopIndexRange(indexOp);
+    }
+    if (!range)
+      return IntegerRangeAnalysis::visitOperation(op, operands, results);
+    propagateIfChanged(results[0],
+                       results[0]->join(IntegerValueRange(*range)));
+    return success();
+  }
+
+  void visitNonControlFlowArguments(
+      Operation *op, const RegionSuccessor &successor,
+      ArrayRef<IntegerValueRangeLattice *> argLattices,
+      unsigned firstIndex) override {
+    auto generic = dyn_cast<linalg::GenericOp>(op);
+    if (!generic || !generic.hasPureTensorSemantics())
+      return IntegerRangeAnalysis::visitNonControlFlowArguments(
+          op, successor, argLattices, firstIndex);
+    ProgramPoint *point = getProgramPointBefore(generic.getBody());
+    for (OpOperand &operand : generic->getOpOperands()) {
+      BlockArgument arg = generic.getMatchingBlockArgument(&operand);
+      IntegerValueRangeLattice *lattice = argLattices[arg.getArgNumber()];
+      std::optional<IntegerValueRange> range;
+      if (generic.isDpsInput(&operand))
+        range = getElementRange(operand.get(), point);
+      if (range)
+        propagateIfChanged(lattice, lattice->join(*range));
+      else
+        setToEntryState(lattice);
+    }
+  }
+
+private:
+  // The range of dim `dim` of `tensor`, as used by the op at `point`. The
+  // dynamic sizes of a `tensor.empty` are bounded by the analysis itself.
+  std::optional<ConstantIntRanges> getDimRange(Value tensor, int64_t dim,
+                                               ProgramPoint *point) {
+    if (std::optional<ConstantIntRanges> range = dimRanges.lookup(tensor, dim))
+      return range;
+    auto empty = tensor.getDefiningOp<tensor::EmptyOp>();
+    if (!empty)
+      return std::nullopt;
+    const IntegerValueRange &size =
+        getLatticeElementFor(point, empty.getDynamicSize(dim))->getValue();
+    if (size.isUninitialized())
+      return std::nullopt;
+    return size.getValue();
+  }
+
+  // The range of a loop index is bounded by the size of any operand dim that
+  // the loop iterates over.
+  std::optional<ConstantIntRanges> getLoopIndexRange(linalg::IndexOp op) {
+    auto linalgOp = op->getParentOfType<linalg::LinalgOp>();
+    if (!linalgOp)
+      return std::nullopt;
+    ProgramPoint *point = getProgramPointAfter(op);
+    AffineExpr loop = getAffineDimExpr(op.getDim(), op.getContext());
+    for (OpOperand &operand : linalgOp->getOpOperands()) {
+      AffineMap map = linalgOp.getMatchingIndexingMap(&operand);
+      for (auto [dim, expr] : llvm::enumerate(map.getResults())) {
+        if (expr != loop)
+          continue;
+        std::optional<ConstantIntRanges> size =
+            getDimRange(operand.get(), dim, point);
+        if (!size || size->smax().isNonPositive())
+          continue;
+        return ConstantIntRanges::fromSigned(APInt::getZero(64),
+                                             size->smax() - 1);
+      }
+    }
+    return std::nullopt;
+  }
+
+  // The range of the elements of `tensor`, as read by the block at `point`.
+  std::optional<IntegerValueRange> getElementRange(Value tensor,
+                                                   ProgramPoint *point) {
+    if (!getElementTypeOrSelf(tensor.getType()).isSignlessIntOrIndex())
+      return std::nullopt;
+    DenseIntElementsAttr attr;
+    if (matchPattern(tensor, m_Constant(&attr)))
+      return IntegerValueRange(getElementsRange(attr));
+    auto result = dyn_cast<OpResult>(tensor);
+    auto producer =
+        result ? dyn_cast<linalg::GenericOp>(result.getOwner()) : nullptr;
+    if (!producer || !producer.hasPureTensorSemantics())
+      return std::nullopt;
+    Value yielded = producer.getBody()->getTerminator()->getOperand(
+        result.getResultNumber());
+    return getLatticeElementFor(point, yielded)->getValue();
+  }
+
+  const DimRanges &dimRanges;
+};
+} // namespace
+
+namespace {
+// Drops the analysis state of the ops that rewrites erase, which would
+// otherwise be found for the ops later allocated in their place.
+class SolverListener : public RewriterBase::Listener {
+public:
+  SolverListener(DataFlowSolver &solver) : solver(solver) {}
+
+  void notifyOperationErased(Operation *op) override {
+    solver.eraseState(solver.getProgramPointAfter(op));
+    for (Value result : op->getResults())
+      solver.eraseState(result);
+  }
+
+private:
+  DataFlowSolver &solver;
+};
+} // namespace
+
+static LogicalResult runIndexRangeAnalysis(DataFlowSolver &solver,
+                                           FunctionOpInterface func,
+                                           const DimRanges &dimRanges) {
+  solver.load<dataflow::DeadCodeAnalysis>();
+  solver.load<dataflow::SparseConstantPropagation>();
+  solver.load<IndexRangeAnalysis>(dimRanges);
+  return solver.initializeAndRun(func);
+}
+
+static bool fitsInI32(const IntegerValueRange &range) {
+  if (range.isUninitialized())
+    return false;
+  const ConstantIntRanges &value = range.getValue();
+  return value.smin().getSExtValue() >= std::numeric_limits<int32_t>::min() &&
+         value.smax().getSExtValue() <= std::numeric_limits<int32_t>::max();
+}
+
+// Whether `tensor` is an i64 tensor that is only read elementwise, as an
+// input of `linalg.generic` ops, so that they can read it as i32 instead.
+static bool isOnlyReadByGenerics(Value tensor) {
+  auto type = dyn_cast<RankedTensorType>(tensor.getType());
+  if (!type || !type.getElementType().isSignlessInteger(64) ||
+      tensor.use_empty())
+    return false;
+  return llvm::all_of(tensor.getUses(), [](OpOperand &use) {
+    auto user = dyn_cast<linalg::GenericOp>(use.getOwner());
+    return user && user.hasPureTensorSemantics() && user.isDpsInput(&use);
+  });
+}
+
+// Makes the `linalg.generic` ops that read `tensor` read it as i32 and sign
+// extend each element back to i64.
+static void extendReadsOfNarrowedTensor(OpBuilder &b, Value tensor) {
+  for (OpOperand &use : tensor.getUses()) {
+    auto user = cast<linalg::GenericOp>(use.getOwner());
+    BlockArgument arg = user.getMatchingBlockArgument(&use);
+    arg.setType(b.getI32Type());
+    b.setInsertionPointToStart(user.getBody());
+    Value extended =
+        arith::ExtSIOp::create(b, arg.getLoc(), b.getI64Type(), arg);
+    arg.replaceAllUsesExcept(extended, extended.getDefiningOp());
+  }
+}
+
+namespace {
+class NarrowLinalgIndicesPass
+    : public impl::NarrowLinalgIndicesBase<NarrowLinalgIndicesPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    FunctionOpInterface func = getOperation();
+    if (func.isExternal())
+      return;
+    DimRanges dimRanges(func);
+
+    // Narrow the i64 tensors whose elements fit in i32: constants, and the
+    // results of `linalg.generic` ops that do not read their init.
+    {
+      DataFlowSolver solver;
+      if (failed(runIndexRangeAnalysis(solver, func, dimRanges)))
+        return signalPassFailure();
+      SmallVector<arith::ConstantOp> constants;
+      SmallVector<OpResult> results;
+      func.walk([&](Operation *op) {
+        if (auto constant = dyn_cast<arith::ConstantOp>(op)) {
+          auto attr = dyn_cast<DenseIntElementsAttr>(constant.getValue());
+          if (attr && isOnlyReadByGenerics(constant) &&
+              fitsInI32(IntegerValueRange(getElementsRange(attr))))
+            constants.push_back(constant);
+          return;
+        }
+        auto generic = dyn_cast<linalg::GenericOp>(op);
+        if (!generic || !generic.hasPureTensorSemantics())
+          return;
+        Operation *yield = generic.getBody()->getTerminator();
+        for (OpResult result : generic->getResults()) {
+          auto *lattice = solver.lookupState<IntegerValueRangeLattice>(
+              yield->getOperand(result.getResultNumber()));
+          if (isOnlyReadByGenerics(result) && lattice &&
+              fitsInI32(lattice->getValue()) &&
+              !generic.payloadUsesValueFromOperand(
+                  generic.getDpsInitOperand(result.getResultNumber())))
+            results.push_back(result);
+        }
+      });
+
+      OpBuilder b(context);
+      Type i32 = b.getI32Type();
+      for (arith::ConstantOp constant : constants) {
+        auto attr = cast<DenseIntElementsAttr>(constant.getValue());
+        b.setInsertionPoint(constant);
+        Value narrowed = arith::ConstantOp::create(
+            b, constant.getLoc(),
+            attr.mapValues(i32, [](const APInt &value) {
+              return value.trunc(32);
+            }));
+        constant.replaceAllUsesWith(narrowed);
+        constant.erase();
+        extendReadsOfNarrowedTensor(b, narrowed);
+      }
+      for (OpResult result : results) {
+        auto generic = cast<linalg::GenericOp>(result.getOwner());
+        Location loc = generic.getLoc();
+        OpOperand *init = generic.getDpsInitOperand(result.getResultNumber());
+        b.setInsertionPoint(generic);
+        auto empty = init->get().getDefiningOp<tensor::EmptyOp>();
+        SmallVector<OpFoldResult> sizes =
+            empty ? empty.getMixedSizes()
+                  : tensor::getMixedSizes(b, loc, init->get());
+        init->set(tensor::EmptyOp::create(b, loc, sizes, i32));
+        generic.getMatchingBlockArgument(init).setType(i32);
+        result.setType(cast<RankedTensorType>(result.getType()).clone(i32));
+        Operation *yield = generic.getBody()->getTerminator();
+        b.setInsertionPoint(yield);
+        OpOperand &yielded = yield->getOpOperand(result.getResultNumber());
+        yielded.set(arith::TruncIOp::create(b, loc, i32, yielded.get()));
+        extendReadsOfNarrowedTensor(b, result);
+      }
+    }
+
+    // Narrow the scalar arithmetic, including the sign extensions above and
+    // the index computations that they feed.
+    DataFlowSolver solver;
+    if (failed(runIndexRangeAnalysis(solver, func, dimRanges)))
+      return signalPassFailure();
+    RewritePatternSet patterns(context);
+    arith::populateIntRangeNarrowingPatterns(patterns, solver,
+                                             /*bitwidthsSupported=*/{32});
+    SolverListener listener(solver);
+    GreedyRewriteConfig config;
+    config.setListener(&listener);
+    if (failed(applyPatternsGreedily(func, std::move(patterns), config)))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createNarrowLinalgIndicesPass() {
+  return std::make_unique<NarrowLinalgIndicesPass>();
+}
+
+} // namespace mlir::torch::TorchConversion
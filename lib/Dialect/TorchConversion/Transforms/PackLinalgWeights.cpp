@@ -0,0 +1,248 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+#include <cstring>
+
+using namespace mlir;
+using namespace mlir::torch;
+namespace mlir::torch::TorchConversion {
+
+#define GEN_PASS_DEF_PACKLINALGWEIGHTS
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h.inc"
+
+// The number of outer tiles of the weight that each task of the packing
+// handles.
+static constexpr int64_t kTilesPerTask = 64;
+
+// The data of each element of a non-splat constant of whole-byte elements,
+// in row-major order.
+static std::optional<ArrayRef<char>> getWeightData(ElementsAttr attr) {
+  auto type = cast<ShapedType>(attr.getType());
+  Type elementType = type.getElementType();
+  if (!type.hasStaticShape() || !elementType.isIntOrFloat() ||
+      elementType.getIntOrFloatBitWidth() % 8 != 0)
+    return std::nullopt;
+  int64_t numBytes =
+      type.getNumElements() * (elementType.getIntOrFloatBitWidth() / 8);
+  ArrayRef<char> data;
+  if (auto dense = dyn_cast<DenseElementsAttr>(attr)) {
+    if (dense.isSplat())
+      return std::nullopt;
+    data = dense.getRawData();
+  } else if (auto resource = dyn_cast<DenseResourceElementsAttr>(attr)) {
+    AsmResourceBlob *blob = resource.getRawHandle().getBlob();
+    if (!blob)
+      return std::nullopt;
+    data = blob->getData();
+  } else {
+    return std::nullopt;
+  }
+  if (static_cast<int64_t>(data.size()) != numBytes)
+    return std::nullopt;
+  return data;
+}
+
+// Matches the maps of a `linalg.matmul` that reads its lhs as `[M, K]` and
+// its rhs as `[K, N]`, or as `[N, K]` when `rhsTransposed` is set.
+static bool matchMatmulMaps(linalg::MatmulOp op, bool &rhsTransposed) {
+  MLIRContext *context = op.getContext();
+  AffineExpr m, n, k;
+  bindDims(context, m, n, k);
+  auto getMap = [&](ArrayRef<AffineExpr> results) {
+    return AffineMap::get(3, 0, results, context);
+  };
+  SmallVector<AffineMap> maps = op.getIndexingMapsArray();
+  if (maps[0] != getMap({m, k}) || maps[2] != getMap({m, n}))
+    return false;
+  rhsTransposed = maps[1] == getMap({n, k});
+  return rhsTransposed || maps[1] == getMap({k, n});
+}
+
+static Value createZero(OpBuilder &b, Location loc, Type elementType) {
+  return arith::ConstantOp::create(b, loc, b.getZeroAttr(elementType));
+}
+
+// Packs the `[M, N]` `value` into `[M1, N1, M0, N0]` tiles, padded with
+// zeros unless `M0` and `N0` divide its dims.
+static Value createPack(OpBuilder &b, Location loc, Value value,
+                        ArrayRef<int64_t> tiles) {
+  auto type = cast<RankedTensorType>(value.getType());
+  SmallVector<int64_t> innerDimsPos{0, 1};
+  SmallVector<OpFoldResult> innerTiles =
+      getAsIndexOpFoldResult(b.getContext(), tiles);
+  Value dest = linalg::PackOp::createDestinationTensor(
+      b, loc, value, innerTiles, innerDimsPos, /*outerDimsPerm=*/{});
+  std::optional<Value> paddingValue;
+  if (llvm::any_of(llvm::zip_equal(type.getShape(), tiles), [](auto dim) {
+        auto [size, tile] = dim;
+        return ShapedType::isDynamic(size) || size % tile != 0;
+      }))
+    paddingValue = createZero(b, loc, type.getElementType());
+  return linalg::PackOp::create(b, loc, value, dest, innerDimsPos, innerTiles,
+                                paddingValue)
+      .getResult();
+}
+
+namespace {
+// Rewrites a `linalg.matmul` whose rhs is a constant weight into a
+// `linalg.mmt4d` of its packed operands. The weight is packed into
+// `[N1, K1, N0, K0]` tiles here, the lhs and the accumulator are packed by
+// `linalg.pack` ops and the result is unpacked by a `linalg.unpack`.
+class PackMatmulWeight : public OpRewritePattern<linalg::MatmulOp> {
+public:
+  PackMatmulWeight(MLIRContext *context, int64_t blockSize)
+      : OpRewritePattern(context), blockSize(blockSize) {}
+
+  LogicalResult matchAndRewrite(linalg::MatmulOp op,
+                                PatternRewriter &rewriter) const override {
+    bool rhsTransposed;
+    if (!op.hasPureTensorSemantics() || !matchMatmulMaps(op, rhsTransposed))
+      return rewriter.notifyMatchFailure(op, "not a plain matmul");
+    Value lhs = op.getInputs()[0], rhs = op.getInputs()[1];
+    Value acc = op.getOutputs()[0];
+    // The casts of mixed precision matmuls are left to the matmul.
+    Type elementType = getElementTypeOrSelf(acc.getType());
+    if (getElementTypeOrSelf(lhs.getType()) != elementType ||
+        getElementTypeOrSelf(rhs.getType()) != elementType)
+      return rewriter.notifyMatchFailure(op, "mixed element types");
+
+    // Do not duplicate a weight that is still needed as is.
+    ElementsAttr attr;
+    if (!rhs.hasOneUse() || !matchPattern(rhs, m_Constant(&attr)))
+      return rewriter.notifyMatchFailure(op, "rhs is not a weight");
+    std::optional<ArrayRef<char>> data = getWeightData(attr);
+    if (!data)
+      return rewriter.notifyMatchFailure(op, "unsupported weight data");
+
+    ArrayRef<int64_t> rhsShape = cast<ShapedType>(attr.getType()).getShape();
+    int64_t k = rhsShape[rhsTransposed ? 1 : 0];
+    int64_t n = rhsShape[rhsTransposed ? 0 : 1];
+    int64_t m = cast<RankedTensorType>(lhs.getType()).getDimSize(0);
+    // Rows of a matrix with fewer rows than a block are not padded, which
+    // keeps matrix-vector products from doing a block of work per row.
+    int64_t m0 =
+        ShapedType::isDynamic(m) ? blockSize : std::min(blockSize, m);
+    int64_t n0 = std::min(blockSize, n), k0 = std::min(blockSize, k);
+    if (m0 == 0 || n0 == 0 || k0 == 0)
+      return rewriter.notifyMatchFailure(op, "empty matmul");
+
+    Location loc = op.getLoc();
+    auto packedRhsType = RankedTensorType::get(
+        {llvm::divideCeil(n, n0), llvm::divideCeil(k, k0), n0, k0},
+        elementType);
+    Value packedRhs = arith::ConstantOp::create(
+        rewriter, loc, packWeight(attr, *data, packedRhsType, rhsTransposed));
+    Value packedLhs = createPack(rewriter, loc, lhs, {m0, k0});
+    Value packedAcc = createPack(rewriter, loc, acc, {m0, n0});
+    Value product =
+        linalg::Mmt4DOp::create(rewriter, loc, packedAcc.getType(),
+                                ValueRange{packedLhs, packedRhs}, packedAcc)
+            .getResult(0);
+    rewriter.replaceOpWithNewOp<linalg::UnPackOp>(
+        op, product, acc, ArrayRef<int64_t>{0, 1},
+        getAsIndexOpFoldResult(rewriter.getContext(), {m0, n0}));
+    return success();
+  }
+
+private:
+  // Lays out the `[K, N]` weight, or its `[N, K]` transpose, as `type`,
+  // which holds its `[N1, K1, N0, K0]` tiles with zeros past its edges.
+  TypedAttr packWeight(ElementsAttr attr, ArrayRef<char> data,
+                       RankedTensorType type, bool transposed) const {
+    ArrayRef<int64_t> shape = cast<ShapedType>(attr.getType()).getShape();
+    int64_t k = shape[transposed ? 1 : 0], n = shape[transposed ? 0 : 1];
+    int64_t n1 = type.getDimSize(0), k1 = type.getDimSize(1);
+    int64_t n0 = type.getDimSize(2), k0 = type.getDimSize(3);
+    int64_t kStride = transposed ? 1 : n, nStride = transposed ? k : 1;
+    int64_t elementBytes = type.getElementTypeBitWidth() / 8;
+    int64_t tileBytes = n0 * k0 * elementBytes;
+
+    auto resource = dyn_cast<DenseResourceElementsAttr>(attr);
+    int64_t numBytes = type.getNumElements() * elementBytes;
+    AsmResourceBlob blob = HeapAsmResourceBlob::allocate(
+        numBytes,
+        resource ? resource.getRawHandle().getBlob()->getDataAlignment()
+                 : alignof(uint64_t),
+        /*dataIsMutable=*/true);
+    char *out = blob.getMutableData().data();
+    std::memset(out, 0, numBytes);
+    int64_t numTiles = n1 * k1;
+    parallelFor(
+        getContext(), 0, llvm::divideCeil(numTiles, kTilesPerTask),
+        [&](size_t task) {
+          int64_t begin = task * kTilesPerTask;
+          int64_t end = std::min<int64_t>(begin + kTilesPerTask, numTiles);
+          for (int64_t tile = begin; tile < end; ++tile) {
+            int64_t nBase = (tile / k1) * n0, kBase = (tile % k1) * k0;
+            char *tileOut = out + tile * tileBytes;
+            for (int64_t i = 0; i < n0 && nBase + i < n; ++i) {
+              for (int64_t j = 0; j < k0 && kBase + j < k; ++j) {
+                int64_t offset = (nBase + i) * nStride + (kBase + j) * kStride;
+                std::memcpy(tileOut + (i * k0 + j) * elementBytes,
+                            data.data() + offset * elementBytes,
+                            elementBytes);
+              }
+            }
+          }
+        });
+
+    if (!resource)
+      return DenseElementsAttr::getFromRawBuffer(type, blob.getData());
+    std::string name = (resource.getRawHandle().getKey() + "_packed").str();
+    return DenseResourceElementsAttr::get(type, name, std::move(blob));
+  }
+
+  int64_t blockSize;
+};
+} // namespace
+
+namespace {
+class PackLinalgWeightsPass
+    : public impl::PackLinalgWeightsBase<PackLinalgWeightsPass> {
+public:
+  using impl::PackLinalgWeightsBase<
+      PackLinalgWeightsPass>::PackLinalgWeightsBase;
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, linalg::LinalgDialect,
+                    tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    if (blockSize < 1) {
+      getOperation()->emitError("block-size must be positive");
+      return signalPassFailure();
+    }
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<PackMatmulWeight>(context, blockSize);
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createPackLinalgWeightsPass(int64_t blockSize) {
+  PackLinalgWeightsOptions options;
+  options.blockSize = blockSize;
+  return std::make_unique<PackLinalgWeightsPass>(options);
+}
+
+} // namespace mlir::torch::TorchConversion
@@ -64,18 +64,38 @@ void mlir::torch::registerTorchConversionPasses() {
       "Pipeline lowering torch backend contract to StableHLO backend "
       "contract.",
       TorchConversion::createTorchBackendToStablehloBackendPipeline);
+  mlir::PassPipelineRegistration<
+      TorchConversion::StablehloBackendPipelineOptions>(
+      "torch-stablehlo-refine-shapes-pipeline",
+      "Pipeline refining the shapes of a StableHLO backend module, which is "
+      "lowered by `torch-backend-to-stablehlo-backend-pipeline` with "
+      "`refine-shapes=false`.",
+      TorchConversion::createStablehloRefineShapesPipeline);
 #endif
 }
 
 void TorchConversion::createTorchBackendToLinalgOnTensorsBackendPipeline(
     OpPassManager &pm,
     const TorchConversion::LinalgOnTensorsBackendPipelineOptions &options) {
+  if (options.nameLocations)
+    pm.addNestedPass<func::FuncOp>(Torch::createNameLocationsPass());
   // Fix non constant dims passed to reduction ops
   pm.addNestedPass<func::FuncOp>(
       torch::Torch::createRestructureNonConstantAxesPass());
+  if (options.propagateTransposes)
+    pm.addNestedPass<func::FuncOp>(Torch::createPropagateTransposesPass());
 
+  // Evaluate the preprocessing of weights, e.g. scaling, casting and
+  // transposing them, once at compile time.
+  pm.addNestedPass<func::FuncOp>(Torch::createFoldConstantWeightsPass());
+  // Quantize and lay out the weights once at compile time, so that their
+  // users can be fused into integer ops, and fold the layout changes of the
+  // integer weights that fusing leaves.
+  pm.addNestedPass<func::FuncOp>(Torch::createFoldQuantizedWeightsPass());
   // We want to fuse quantized operations together before lowering to linalg.
-  pm.addNestedPass<func::FuncOp>(Torch::createFuseQuantizedOpsPass());
+  pm.addNestedPass<func::FuncOp>(
+      Torch::createFuseQuantizedOpsPass(/*perChannel=*/true));
+  pm.addNestedPass<func::FuncOp>(Torch::createFoldQuantizedWeightsPass());
 
   // Lower to linalg + guards which is the input to codegen backends.
   // We do this first as it tends to involve pattern-matching against constants,
@@ -85,7 +105,22 @@ void TorchConversion::createTorchBackendToLinalgOnTensorsBackendPipeline(
       createConvertTorchToTMTensorPass(options.allowNonFinites));
   pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
   pm.addNestedPass<func::FuncOp>(
-      createConvertTorchToLinalgPass(options.allowNonFinites));
+      createConvertTorchToLinalgPass(options.allowNonFinites,
+                                     options.channelsLastConv,
+                                     options.convStrategy,
+                                     options.fuseElementwise,
+                                     options.splitReductionFactor,
+                                     options.rng, options.concatInPlace,
+                                     options.separablePooling,
+                                     options.decomposeZeroPoints,
+                                     options.subPixelConvTranspose,
+                                     options.convBackwardGemm,
+                                     options.foldWindowPadding,
+                                     options.propagateTransposes));
+  // Make the dims that share a symbolic size the same value, so that the
+  // canonicalizer and CSE fold the broadcast checks between them away.
+  pm.addNestedPass<func::FuncOp>(
+      TorchConversion::createUnifySymbolicDimsPass());
   pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
   pm.addNestedPass<func::FuncOp>(createConvertTorchToSCFPass());
   pm.addNestedPass<func::FuncOp>(createConvertTorchToArithPass());
@@ -95,6 +130,20 @@ void TorchConversion::createTorchBackendToLinalgOnTensorsBackendPipeline(
 
   // Clean up any non-canonical code introduced above..
   pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+  // Cancel the layout transposes of channels-last convolutions. This needs
+  // constants to be `arith.constant`s, so it runs after TorchToArith.
+  if (options.channelsLastConv)
+    pm.addNestedPass<func::FuncOp>(
+        TorchConversion::createPropagateLinalgTransposesPass());
+  // Lay out the constant weights of matmuls in tiles once at compile time.
+  // This also needs constants to be `arith.constant`s.
+  if (options.packWeightsBlockSize > 0)
+    pm.addNestedPass<func::FuncOp>(TorchConversion::createPackLinalgWeightsPass(
+        options.packWeightsBlockSize));
+  // Narrow index arithmetic while the shape guards are still bound.
+  if (options.narrowIndices)
+    pm.addNestedPass<func::FuncOp>(
+        TorchConversion::createNarrowLinalgIndicesPass());
   // Resolve `dim` ops on tensors (which currently live in the `memref`
   // dialect for some reason -- we don't have memrefs at this level).
   pm.addNestedPass<func::FuncOp>(
@@ -104,8 +153,9 @@ void TorchConversion::createTorchBackendToLinalgOnTensorsBackendPipeline(
 
   // Finish the type conversion from `torch` types to the types of the
   // linalg-on-tensors backend contract.
+  // The finalizing conversion folds the materializations left at the function
+  // boundaries itself, so there is no need to canonicalize in between.
   pm.addPass(TorchConversion::createFuncBackendTypeConversionPass());
-  pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
   pm.addNestedPass<func::FuncOp>(
       TorchConversion::createFinalizingBackendTypeConversionPass());
 
@@ -120,15 +170,25 @@ void TorchConversion::createTorchBackendToTosaBackendPipeline(
     OpPassManager &pm,
     const TorchConversion::TosaBackendPipelineOptions &options) {
 
+  pm.addNestedPass<func::FuncOp>(Torch::createFoldConstantWeightsPass());
   // We want to fuse quantized operations together before lowering to tosa.
   pm.addNestedPass<func::FuncOp>(Torch::createFuseQuantizedOpsPass());
 
   pm.addNestedPass<func::FuncOp>(createConvertTorchToTosaPass(
       options.requireFullTosaConversion, options.disabledPatterns,
       options.enabledPatterns));
+  // Cancel the layout transposes between NHWC ops. This runs before constant
+  // folding, which folds the inverse transposes it puts on constants.
+  if (options.nhwcLayout)
+    pm.addNestedPass<func::FuncOp>(
+        TorchConversion::createPropagateTosaTransposesPass());
 
   // Fold full-layer operations on TOSA constants
   pm.addNestedPass<func::FuncOp>(createTosaLayerwiseConstantFoldPass());
+  // Fold the layout changes of weights held in resource blobs, which the
+  // layerwise folding leaves alone.
+  pm.addNestedPass<func::FuncOp>(
+      TorchConversion::createFoldTosaWeightLayoutsPass());
 
   // Perform transpose reductions for avoidable data movements
   pm.addNestedPass<func::FuncOp>(createTosaReduceTransposes());
@@ -143,8 +203,9 @@ void TorchConversion::createTorchBackendToTosaBackendPipeline(
 
   // Finish the type conversion from `torch` types to the types of the
   // TOSA backend contract.
+  // The finalizing conversion folds the materializations left at the function
+  // boundaries itself, so there is no need to canonicalize in between.
   pm.addPass(TorchConversion::createFuncBackendTypeConversionPass());
-  pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
   pm.addNestedPass<func::FuncOp>(
       TorchConversion::createFinalizingBackendTypeConversionPass());
 
@@ -159,10 +220,22 @@ void TorchConversion::createTorchBackendToTosaBackendPipeline(
 void TorchConversion::createTorchBackendToStablehloBackendPipeline(
     OpPassManager &pm,
     const TorchConversion::StablehloBackendPipelineOptions &options) {
+  if (options.composites)
+    pm.addPass(TorchConversion::createOutlineStablehloCompositesPass());
+  if (options.propagateTransposes)
+    pm.addNestedPass<func::FuncOp>(Torch::createPropagateTransposesPass());
+  pm.addNestedPass<func::FuncOp>(Torch::createFoldConstantWeightsPass());
+  // Annotate the ops on the way from sharded arguments, so that the
+  // shardings survive the conversion.
+  pm.addNestedPass<func::FuncOp>(Torch::createPropagateShardingPass());
+  // Issue collectives early, so that the backend can overlap them with the
+  // compute that does not depend on them.
+  pm.addNestedPass<func::FuncOp>(Torch::createScheduleCollectivesPass());
   // Generate Stablehlo & Chlo ops.
   pm.addNestedPass<func::FuncOp>(createConvertTorchToStablehloPass(
       options.enableStaticShape, options.enableI32Index,
-      options.allowNonFinites));
+      options.allowNonFinites, options.globalPoolAsReduce,
+      options.threadRngState));
   // Lowering Chlo ops to Stablehlo
   pm.addNestedPass<func::FuncOp>(
       stablehlo::createChloLegalizeToStablehloPass());
@@ -178,13 +251,21 @@ void TorchConversion::createTorchBackendToStablehloBackendPipeline(
   // StableHLO backend contract.
   pm.addPass(
       TorchConversion::createFuncBackendTypeConversionForStablehloPass());
-  pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
   pm.addNestedPass<func::FuncOp>(
       TorchConversion::createFinalizingBackendTypeConversionForStablehloPass());
+  if (options.composites)
+    pm.addPass(TorchConversion::createConvertCallsToStablehloCompositesPass());
 
   // Verify that we have lowered to Stablehlo ops.
   pm.addPass(TorchConversion::createVerifyStablehloBackendContractPass());
 
+  if (options.refineShapes)
+    createStablehloRefineShapesPipeline(pm, options);
+}
+
+void TorchConversion::createStablehloRefineShapesPipeline(
+    OpPassManager &pm,
+    const TorchConversion::StablehloBackendPipelineOptions &options) {
   // Canonicalize Stablehlo dynamic ops to static ops
   pm.addNestedPass<func::FuncOp>(
       stablehlo::createStablehloCanonicalizeDynamismPass());
@@ -201,5 +282,10 @@ void TorchConversion::createTorchBackendToStablehloBackendPipeline(
   pm.addNestedPass<func::FuncOp>(
       stablehlo::createStablehloLegalizeDeprecatedOpsPass(stablehloOptions));
   pm.addPass(createCanonicalizerPass());
+
+  // Check that the shape computations that are left after shape refinement
+  // are all 32-bit.
+  if (options.enableI32Index)
+    pm.addPass(TorchConversion::createVerifyStablehloI32IndexPass());
 }
 #endif
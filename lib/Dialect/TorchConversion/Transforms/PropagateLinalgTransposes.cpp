@@ -0,0 +1,271 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+#include <cstring>
+
+using namespace mlir;
+using namespace mlir::torch;
+namespace mlir::torch::TorchConversion {
+
+#define GEN_PASS_DEF_PROPAGATELINALGTRANSPOSES
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h.inc"
+
+// Result dim `i` of a `linalg.transpose` is dim `perms[i]` of its input.
+static Value createTranspose(OpBuilder &b, Location loc, Value value,
+                             ArrayRef<int64_t> perms) {
+  SmallVector<OpFoldResult> sizes =
+      applyPermutation(tensor::getMixedSizes(b, loc, value), perms);
+  Value empty = tensor::EmptyOp::create(b, loc, sizes,
+                                        getElementTypeOrSelf(value.getType()));
+  return linalg::TransposeOp::create(b, loc, value, empty, perms)
+      ->getResult(0);
+}
+
+static Value castIfNeeded(OpBuilder &b, Location loc, Value value, Type type) {
+  if (value.getType() == type)
+    return value;
+  return tensor::CastOp::create(b, loc, type, value);
+}
+
+static bool isTensorTranspose(linalg::TransposeOp op) {
+  return op && op.hasPureTensorSemantics();
+}
+
+// An elementwise op whose loops can be reordered freely and whose payload
+// does not depend on the loop order.
+static bool isElementwise(linalg::GenericOp op) {
+  if (!op.hasPureTensorSemantics() || op.getNumDpsInits() != 1 ||
+      op.getNumParallelLoops() != op.getNumLoops() || op.hasIndexSemantics())
+    return false;
+  OpOperand *init = op.getDpsInitOperand(0);
+  return op.getMatchingIndexingMap(init).isIdentity() &&
+         !op.payloadUsesValueFromOperand(init);
+}
+
+// Sinking a transpose only pays off once all of its users have absorbed it,
+// so it is only done when every user is one the patterns below handle.
+static bool canSinkPastAllUsers(linalg::TransposeOp op) {
+  return llvm::all_of(op->getResult(0).getUsers(), [](Operation *user) {
+    if (isa<linalg::TransposeOp, tensor::PadOp>(user))
+      return true;
+    auto generic = dyn_cast<linalg::GenericOp>(user);
+    return generic && isElementwise(generic);
+  });
+}
+
+namespace {
+// transpose(transpose(x)) -> transpose(x), or x when the two cancel.
+class ComposeTransposes : public OpRewritePattern<linalg::TransposeOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::TransposeOp op,
+                                PatternRewriter &rewriter) const override {
+    auto producer = op.getInput().getDefiningOp<linalg::TransposeOp>();
+    if (!isTensorTranspose(op) || !isTensorTranspose(producer))
+      return failure();
+    SmallVector<int64_t> perms =
+        applyPermutation(producer.getPermutation(), op.getPermutation());
+    Type resultType = op->getResult(0).getType();
+    if (isIdentityPermutation(perms)) {
+      rewriter.replaceOp(op, castIfNeeded(rewriter, op.getLoc(),
+                                          producer.getInput(), resultType));
+      return success();
+    }
+    rewriter.replaceOpWithNewOp<linalg::TransposeOp>(
+        op, producer.getInput(), op.getInit(), perms);
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// Folds the transpose of a constant, which is how the weights of
+// channels-last convolutions end up pre-transposed.
+class FoldTransposeOfConstant : public OpRewritePattern<linalg::TransposeOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::TransposeOp op,
+                                PatternRewriter &rewriter) const override {
+    DenseElementsAttr attr;
+    if (!isTensorTranspose(op) ||
+        !matchPattern(op.getInput(), m_Constant(&attr)))
+      return failure();
+    auto resultType = cast<RankedTensorType>(op->getResult(0).getType());
+    if (!resultType.hasStaticShape())
+      return failure();
+    if (attr.isSplat()) {
+      rewriter.replaceOpWithNewOp<arith::ConstantOp>(
+          op, attr.resizeSplat(resultType));
+      return success();
+    }
+    // Do not duplicate a constant that is still needed as is.
+    Type elementType = resultType.getElementType();
+    if (!op.getInput().hasOneUse() || !elementType.isIntOrFloat() ||
+        elementType.getIntOrFloatBitWidth() % 8 != 0)
+      return failure();
+
+    int64_t elementBytes = elementType.getIntOrFloatBitWidth() / 8;
+    ArrayRef<int64_t> perms = op.getPermutation();
+    ArrayRef<int64_t> shape = resultType.getShape();
+    SmallVector<int64_t> strides =
+        applyPermutation(computeStrides(attr.getType().getShape()), perms);
+    ArrayRef<char> data = attr.getRawData();
+    SmallVector<char> newData(data.size());
+    SmallVector<int64_t> index(shape.size(), 0);
+    for (int64_t i = 0, e = resultType.getNumElements(); i < e; ++i) {
+      int64_t offset = 0;
+      for (auto [idx, stride] : llvm::zip_equal(index, strides))
+        offset += idx * stride;
+      std::memcpy(newData.data() + i * elementBytes,
+                  data.data() + offset * elementBytes, elementBytes);
+      for (int64_t dim = shape.size() - 1; dim >= 0; --dim) {
+        if (++index[dim] < shape[dim])
+          break;
+        index[dim] = 0;
+      }
+    }
+    rewriter.replaceOpWithNewOp<arith::ConstantOp>(
+        op, DenseElementsAttr::getFromRawBuffer(resultType, newData));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// elementwise(transpose(x), ...) -> transpose(elementwise(x, ...)), with the
+// other operands read through permuted indexing maps.
+class SinkTransposeThroughElementwise
+    : public OpRewritePattern<linalg::GenericOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::GenericOp op,
+                                PatternRewriter &rewriter) const override {
+    if (!isElementwise(op))
+      return failure();
+    auto isSinkable = [&](OpOperand *operand) {
+      auto producer = operand->get().getDefiningOp<linalg::TransposeOp>();
+      return isTensorTranspose(producer) &&
+             op.getMatchingIndexingMap(operand).isIdentity() &&
+             canSinkPastAllUsers(producer);
+    };
+    SmallVector<OpOperand *> operands = op.getDpsInputOperands();
+    auto it = llvm::find_if(operands, isSinkable);
+    if (it == operands.end())
+      return failure();
+    SmallVector<int64_t> perms(
+        (*it)->get().getDefiningOp<linalg::TransposeOp>().getPermutation());
+
+    // Loop `i` of `op` is loop `perms[i]` of the new op.
+    Location loc = op.getLoc();
+    AffineMap toOldLoops =
+        AffineMap::getPermutationMap(perms, rewriter.getContext());
+    SmallVector<Value> inputs;
+    SmallVector<AffineMap> indexingMaps;
+    for (OpOperand *operand : operands) {
+      auto producer = operand->get().getDefiningOp<linalg::TransposeOp>();
+      if (isSinkable(operand) &&
+          llvm::equal(producer.getPermutation(), perms)) {
+        inputs.push_back(producer.getInput());
+        indexingMaps.push_back(op.getMatchingIndexingMap(operand));
+        continue;
+      }
+      inputs.push_back(operand->get());
+      indexingMaps.push_back(
+          op.getMatchingIndexingMap(operand).compose(toOldLoops));
+    }
+    indexingMaps.push_back(rewriter.getMultiDimIdentityMap(op.getNumLoops()));
+
+    Value init = op.getDpsInitOperand(0)->get();
+    SmallVector<OpFoldResult> sizes =
+        applyPermutation(tensor::getMixedSizes(rewriter, loc, init),
+                         invertPermutationVector(perms));
+    Value newInit = tensor::EmptyOp::create(
+        rewriter, loc, sizes, getElementTypeOrSelf(init.getType()));
+    auto newOp = linalg::GenericOp::create(
+        rewriter, loc, newInit.getType(), inputs, newInit, indexingMaps,
+        op.getIteratorTypesArray());
+    rewriter.cloneRegionBefore(op.getRegion(), newOp.getRegion(),
+                               newOp.getRegion().begin());
+    Value result = createTranspose(rewriter, loc, newOp->getResult(0), perms);
+    rewriter.replaceOp(op, castIfNeeded(rewriter, loc, result,
+                                        op->getResult(0).getType()));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// pad(transpose(x)) -> transpose(pad(x)), so that the transposes around a
+// padded convolution input can meet and cancel.
+class SinkTransposeThroughPad : public OpRewritePattern<tensor::PadOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tensor::PadOp op,
+                                PatternRewriter &rewriter) const override {
+    auto producer = op.getSource().getDefiningOp<linalg::TransposeOp>();
+    if (op.getNofold() || !isTensorTranspose(producer) ||
+        !canSinkPastAllUsers(producer))
+      return failure();
+    Value padValue = op.getConstantPaddingValue();
+    if (!padValue || padValue.getParentRegion() == &op.getRegion())
+      return failure();
+
+    // Dim `i` of the source is dim `perms[i]` of the transpose input.
+    ArrayRef<int64_t> perms = producer.getPermutation();
+    SmallVector<int64_t> inversePerms = invertPermutationVector(perms);
+    Location loc = op.getLoc();
+    Value newPad = tensor::PadOp::create(
+        rewriter, loc, Type(), producer.getInput(),
+        applyPermutation(op.getMixedLowPad(), inversePerms),
+        applyPermutation(op.getMixedHighPad(), inversePerms), padValue);
+    Value result = createTranspose(rewriter, loc, newPad, perms);
+    rewriter.replaceOp(
+        op, castIfNeeded(rewriter, loc, result, op.getResultType()));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class PropagateLinalgTransposesPass
+    : public impl::PropagateLinalgTransposesBase<
+          PropagateLinalgTransposesPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, linalg::LinalgDialect,
+                    tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<ComposeTransposes, FoldTransposeOfConstant,
+                 SinkTransposeThroughElementwise, SinkTransposeThroughPad>(
+        context);
+    tensor::CastOp::getCanonicalizationPatterns(patterns, context);
+
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns))))
+      signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createPropagateLinalgTransposesPass() {
+  return std::make_unique<PropagateLinalgTransposesPass>();
+}
+
+} // namespace mlir::torch::TorchConversion
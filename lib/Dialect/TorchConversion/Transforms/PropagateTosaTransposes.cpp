@@ -0,0 +1,232 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+#ifdef TORCH_MLIR_ENABLE_TOSA
+#include "mlir/Dialect/Tosa/IR/TosaOps.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+namespace mlir::torch::TorchConversion {
+
+#define GEN_PASS_DEF_PROPAGATETOSATRANSPOSES
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h.inc"
+
+// Result dim `i` of a `tosa.transpose` is dim `perms[i]` of its input.
+static Value createTranspose(OpBuilder &b, Location loc, Value value,
+                             ArrayRef<int32_t> perms) {
+  auto type = cast<RankedTensorType>(value.getType());
+  SmallVector<int64_t> shape = applyPermutation(
+      type.getShape(), SmallVector<int64_t>(perms.begin(), perms.end()));
+  return tosa::TransposeOp::create(b, loc, type.clone(shape), value,
+                                   b.getDenseI32ArrayAttr(perms));
+}
+
+// The type that `type`, a result of an op on transposed operands, has when
+// the op is applied to the operands before the transpose by `perms`.
+static RankedTensorType getUntransposedType(Type type,
+                                            ArrayRef<int32_t> perms) {
+  auto rankedType = cast<RankedTensorType>(type);
+  SmallVector<int64_t> inversePerms = invertPermutationVector(
+      SmallVector<int64_t>(perms.begin(), perms.end()));
+  return rankedType.clone(
+      applyPermutation(rankedType.getShape(), inversePerms));
+}
+
+// An elementwise op whose operands all have the rank of its result, except
+// for the shift of tosa.mul, so that its operands can be transposed alike.
+// tosa.rescale is excluded: its per-channel parameters are tied to a dim.
+static bool isTransposableElementwise(Operation *op) {
+  if (!op->hasTrait<OpTrait::tosa::TosaElementwiseOperator>() ||
+      isa<tosa::RescaleOp>(op) || op->getNumResults() != 1)
+    return false;
+  auto resultType = dyn_cast<RankedTensorType>(op->getResult(0).getType());
+  if (!resultType)
+    return false;
+  for (OpOperand &operand : op->getOpOperands()) {
+    if (isa<tosa::MulOp>(op) && operand.getOperandNumber() == 2)
+      continue;
+    auto type = dyn_cast<RankedTensorType>(operand.get().getType());
+    if (!type || type.getRank() != resultType.getRank())
+      return false;
+  }
+  return true;
+}
+
+static bool isReduction(Operation *op) {
+  return isa<tosa::ReduceAllOp, tosa::ReduceAnyOp, tosa::ReduceMaxOp,
+             tosa::ReduceMinOp, tosa::ReduceProductOp, tosa::ReduceSumOp>(op);
+}
+
+// The perms of `value` if it is a transpose, or an empty list.
+static ArrayRef<int32_t> getTransposePerms(Value value) {
+  auto transpose = value.getDefiningOp<tosa::TransposeOp>();
+  return transpose ? transpose.getPerms() : ArrayRef<int32_t>();
+}
+
+// Whether every operand of `concat` is a transpose by the same perms.
+static bool concatsAlikeTransposes(tosa::ConcatOp concat) {
+  ArrayRef<int32_t> perms = getTransposePerms(concat->getOperand(0));
+  return !perms.empty() &&
+         llvm::all_of(concat->getOperands(), [&](Value operand) {
+           return getTransposePerms(operand) == perms;
+         });
+}
+
+// Sinking a transpose only pays off once all of its users have absorbed it,
+// so it is only done when every user is one the patterns below handle.
+static bool canSinkPastAllUsers(tosa::TransposeOp op) {
+  return llvm::all_of(op->getUsers(), [](Operation *user) {
+    if (isa<tosa::TransposeOp>(user) || isReduction(user) ||
+        isTransposableElementwise(user))
+      return true;
+    auto concat = dyn_cast<tosa::ConcatOp>(user);
+    return concat && concatsAlikeTransposes(concat);
+  });
+}
+
+// Creates a copy of `op` on `operands`, with a result of `resultType`.
+static Value cloneWithOperands(PatternRewriter &rewriter, Operation *op,
+                               ValueRange operands, Type resultType,
+                               NamedAttrList attrs) {
+  OperationState state(op->getLoc(), op->getName(), operands, resultType,
+                       attrs.getAttrs());
+  return rewriter.create(state)->getResult(0);
+}
+
+namespace {
+// elementwise(transpose(x), y) -> transpose(elementwise(x, transpose'(y))),
+// where transpose' undoes the transpose; constants fold it away and other
+// transposes compose with it.
+class SinkTransposeThroughElementwise : public RewritePattern {
+public:
+  SinkTransposeThroughElementwise(MLIRContext *context)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context) {}
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    if (!isTransposableElementwise(op))
+      return failure();
+    int64_t rank = cast<RankedTensorType>(op->getResult(0).getType()).getRank();
+    auto isSinkable = [&](Value operand) {
+      auto producer = operand.getDefiningOp<tosa::TransposeOp>();
+      return producer && canSinkPastAllUsers(producer);
+    };
+    auto it = llvm::find_if(op->getOperands(), isSinkable);
+    if (it == op->getOperands().end())
+      return failure();
+    SmallVector<int32_t> perms(getTransposePerms(*it));
+    SmallVector<int32_t> inversePerms(rank);
+    for (auto [i, perm] : llvm::enumerate(perms))
+      inversePerms[perm] = i;
+
+    Location loc = op->getLoc();
+    SmallVector<Value> operands;
+    for (Value operand : op->getOperands()) {
+      auto type = cast<RankedTensorType>(operand.getType());
+      if (type.getRank() != rank)
+        operands.push_back(operand);
+      else if (isSinkable(operand) && getTransposePerms(operand) == perms)
+        operands.push_back(
+            operand.getDefiningOp<tosa::TransposeOp>().getInput1());
+      else
+        operands.push_back(
+            createTranspose(rewriter, loc, operand, inversePerms));
+    }
+    Value result = cloneWithOperands(
+        rewriter, op, operands,
+        getUntransposedType(op->getResult(0).getType(), perms),
+        op->getAttrs());
+    rewriter.replaceOp(op, createTranspose(rewriter, loc, result, perms));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// concat(transpose(x0), transpose(x1), axis) ->
+//   transpose(concat(x0, x1, perms[axis])).
+class SinkTransposeThroughConcat : public OpRewritePattern<tosa::ConcatOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tosa::ConcatOp op,
+                                PatternRewriter &rewriter) const override {
+    if (!concatsAlikeTransposes(op) ||
+        !llvm::all_of(op->getOperands(), [](Value operand) {
+          return canSinkPastAllUsers(
+              operand.getDefiningOp<tosa::TransposeOp>());
+        }))
+      return failure();
+    SmallVector<int32_t> perms(getTransposePerms(op->getOperand(0)));
+    SmallVector<Value> inputs;
+    for (Value operand : op->getOperands())
+      inputs.push_back(operand.getDefiningOp<tosa::TransposeOp>().getInput1());
+    Location loc = op.getLoc();
+    auto concat = tosa::ConcatOp::create(
+        rewriter, loc, getUntransposedType(op.getType(), perms), inputs,
+        rewriter.getI32IntegerAttr(perms[op.getAxis()]));
+    rewriter.replaceOp(op, createTranspose(rewriter, loc, concat, perms));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+// reduce(transpose(x), axis) -> transpose(reduce(x, perms[axis])), which
+// TOSA reductions allow as they keep the reduced dim.
+class SinkTransposeThroughReduction : public RewritePattern {
+public:
+  SinkTransposeThroughReduction(MLIRContext *context)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context) {}
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    if (!isReduction(op))
+      return failure();
+    auto producer = op->getOperand(0).getDefiningOp<tosa::TransposeOp>();
+    if (!producer || !canSinkPastAllUsers(producer))
+      return failure();
+    SmallVector<int32_t> perms(producer.getPerms());
+    auto axis = op->getAttrOfType<IntegerAttr>("axis");
+    NamedAttrList attrs(op->getAttrs());
+    attrs.set("axis", rewriter.getI32IntegerAttr(perms[axis.getInt()]));
+    Value result = cloneWithOperands(
+        rewriter, op, producer.getInput1(),
+        getUntransposedType(op->getResult(0).getType(), perms), attrs);
+    rewriter.replaceOp(op, createTranspose(rewriter, op->getLoc(), result,
+                                           perms));
+    return success();
+  }
+};
+} // namespace
+
+namespace {
+class PropagateTosaTransposesPass
+    : public impl::PropagateTosaTransposesBase<PropagateTosaTransposesPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.add<SinkTransposeThroughElementwise, SinkTransposeThroughConcat,
+                 SinkTransposeThroughReduction>(context);
+    tosa::TransposeOp::getCanonicalizationPatterns(patterns, context);
+
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns))))
+      signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createPropagateTosaTransposesPass() {
+  return std::make_unique<PropagateTosaTransposesPass>();
+}
+
+} // namespace mlir::torch::TorchConversion
+#endif // TORCH_MLIR_ENABLE_TOSA
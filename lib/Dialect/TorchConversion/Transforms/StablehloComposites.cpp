@@ -0,0 +1,223 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+#ifdef TORCH_MLIR_ENABLE_STABLEHLO
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Transforms/Passes.h"
+#include "stablehlo/dialect/StablehloOps.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "torch-mlir/Dialect/Torch/Utils/Utils.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+#include "llvm/ADT/TypeSwitch.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+using namespace mlir::torch::Torch;
+using namespace mlir::torch::TorchConversion;
+namespace mlir::torch::TorchConversion {
+
+#define GEN_PASS_DEF_OUTLINESTABLEHLOCOMPOSITES
+#define GEN_PASS_DEF_CONVERTCALLSTOSTABLEHLOCOMPOSITES
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h.inc"
+
+static constexpr StringLiteral kCompositeNameAttr =
+    "torch_mlir.composite_name";
+static constexpr StringLiteral kCompositeAttributesAttr =
+    "torch_mlir.composite_attributes";
+
+// The names of the operands of the ops that are kept as composites, which
+// name their composite attributes, or std::nullopt for other ops.
+static std::optional<SmallVector<StringRef>>
+getCompositeOperandNames(Operation *op) {
+  using Names = std::optional<SmallVector<StringRef>>;
+  return TypeSwitch<Operation *, Names>(op)
+      .Case<AtenScaledDotProductAttentionOp>([](auto) -> Names {
+        return SmallVector<StringRef>{"query",     "key",       "value",
+                                      "attn_mask", "dropout_p", "is_causal",
+                                      "scale",     "enable_gqa"};
+      })
+      .Case<AtenLayerNormOp>([](auto) -> Names {
+        return SmallVector<StringRef>{"input", "normalized_shape", "weight",
+                                      "bias", "eps", "cudnn_enable"};
+      })
+      .Case<AtenNativeLayerNormOp>([](auto) -> Names {
+        return SmallVector<StringRef>{"input", "normalized_shape", "weight",
+                                      "bias", "eps"};
+      })
+      .Case<AtenRmsNormOp>([](auto) -> Names {
+        return SmallVector<StringRef>{"input", "normalized_shape", "weight",
+                                      "eps"};
+      })
+      .Case<AtenGeluOp>([](auto) -> Names {
+        return SmallVector<StringRef>{"self", "approximate"};
+      })
+      .Default([](Operation *) -> Names { return std::nullopt; });
+}
+
+// Returns whether `value` is computed from constants only, so that it can be
+// cloned into the decomposition.
+static bool isConstantOperand(Value value) {
+  Operation *def = value.getDefiningOp();
+  if (!def)
+    return false;
+  if (def->hasTrait<OpTrait::ConstantLike>())
+    return true;
+  if (auto list = dyn_cast<PrimListConstructOp>(def))
+    return llvm::all_of(list.getElements(), isConstantOperand);
+  return false;
+}
+
+// Returns the composite attribute for the constant operand `value`, or a null
+// attribute for a `none` operand.
+static Attribute getCompositeAttribute(Builder &b, Value value) {
+  int64_t intValue;
+  double floatValue;
+  bool boolValue;
+  std::string strValue;
+  SmallVector<int64_t> intList;
+  if (matchPattern(value, m_TorchConstantInt(&intValue)))
+    return b.getI64IntegerAttr(intValue);
+  if (matchPattern(value, m_TorchConstantFloat(&floatValue)))
+    return b.getF64FloatAttr(floatValue);
+  if (matchPattern(value, m_TorchConstantBool(&boolValue)))
+    return b.getBoolAttr(boolValue);
+  if (matchPattern(value, m_TorchConstantStr(strValue)))
+    return b.getStringAttr(strValue);
+  if (matchPattern(value, m_TorchListOfConstantInts(intList)))
+    return b.getDenseI64ArrayAttr(intList);
+  return {};
+}
+
+namespace {
+class OutlineStablehloCompositesPass
+    : public impl::OutlineStablehloCompositesBase<
+          OutlineStablehloCompositesPass> {
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SymbolTable symbolTable(module);
+
+    SmallVector<Operation *> candidates;
+    module.walk([&](Operation *op) {
+      if (getCompositeOperandNames(op))
+        candidates.push_back(op);
+    });
+
+    SmallVector<func::FuncOp> decompositions;
+    for (Operation *op : candidates) {
+      SmallVector<StringRef> operandNames = *getCompositeOperandNames(op);
+      OpBuilder b(op);
+
+      // Tensor operands become the operands of the composite, and the other
+      // operands its attributes.
+      SmallVector<Value> inputs;
+      SmallVector<NamedAttribute> attributes;
+      bool outlinable = llvm::all_of(op->getResultTypes(), [](Type type) {
+        return isa<ValueTensorType>(type);
+      });
+      for (auto [operand, name] : llvm::zip(op->getOperands(), operandNames)) {
+        if (isa<ValueTensorType>(operand.getType())) {
+          inputs.push_back(operand);
+          continue;
+        }
+        if (!isConstantOperand(operand)) {
+          outlinable = false;
+          break;
+        }
+        if (Attribute attr = getCompositeAttribute(b, operand))
+          attributes.push_back(b.getNamedAttr(name, attr));
+      }
+      if (!outlinable)
+        continue;
+
+      std::string compositeName = op->getName().getStringRef().str();
+      auto decomposition = func::FuncOp::create(
+          op->getLoc(), compositeName + ".impl",
+          b.getFunctionType(ValueRange(inputs).getTypes(),
+                            op->getResultTypes()));
+      decomposition.setPrivate();
+      auto parent = op->getParentOfType<func::FuncOp>();
+      symbolTable.insert(decomposition, Block::iterator(parent));
+
+      Block *body = decomposition.addEntryBlock();
+      auto bodyBuilder = OpBuilder::atBlockBegin(body);
+      IRMapping mapping;
+      mapping.map(inputs, body->getArguments());
+      std::function<void(Value)> cloneConstant = [&](Value value) {
+        if (mapping.contains(value))
+          return;
+        Operation *def = value.getDefiningOp();
+        for (Value element : def->getOperands())
+          cloneConstant(element);
+        bodyBuilder.clone(*def, mapping);
+      };
+      for (Value operand : op->getOperands())
+        cloneConstant(operand);
+      Operation *clone = bodyBuilder.clone(*op, mapping);
+      func::ReturnOp::create(bodyBuilder, op->getLoc(), clone->getResults());
+
+      auto call = func::CallOp::create(b, op->getLoc(), decomposition, inputs);
+      call->setAttr(kCompositeNameAttr, b.getStringAttr(compositeName));
+      call->setAttr(kCompositeAttributesAttr,
+                    b.getDictionaryAttr(attributes));
+      op->replaceAllUsesWith(call.getResults());
+      op->erase();
+      decompositions.push_back(decomposition);
+    }
+
+    // The decompositions are lowered as the ops would have been had they not
+    // been kept: decomposed by torch, except for the ops that are legal for
+    // the StableHLO backend by default and lowered by TorchToStablehlo.
+    OpPassManager pm(func::FuncOp::getOperationName());
+    pm.addPass(createDecomposeComplexOpsPass({"aten.native_layer_norm"}));
+    pm.addPass(createCanonicalizerPass());
+    for (func::FuncOp decomposition : decompositions) {
+      if (failed(runPipeline(pm, decomposition)))
+        return signalPassFailure();
+    }
+  }
+};
+
+class ConvertCallsToStablehloCompositesPass
+    : public impl::ConvertCallsToStablehloCompositesBase<
+          ConvertCallsToStablehloCompositesPass> {
+  void runOnOperation() override {
+    getOperation().walk([&](func::CallOp call) {
+      auto name = call->getAttrOfType<StringAttr>(kCompositeNameAttr);
+      if (!name)
+        return;
+      auto attributes =
+          call->getAttrOfType<DictionaryAttr>(kCompositeAttributesAttr);
+      OpBuilder b(call);
+      auto composite = stablehlo::CompositeOp::create(
+          b, call.getLoc(), call.getResultTypes(), call.getOperands(), name,
+          attributes ? attributes : b.getDictionaryAttr({}),
+          call.getCalleeAttr(), b.getI32IntegerAttr(0));
+      call.replaceAllUsesWith(composite.getResults());
+      call.erase();
+    });
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createOutlineStablehloCompositesPass() {
+  return std::make_unique<OutlineStablehloCompositesPass>();
+}
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createConvertCallsToStablehloCompositesPass() {
+  return std::make_unique<ConvertCallsToStablehloCompositesPass>();
+}
+
+} // namespace mlir::torch::TorchConversion
+#endif // TORCH_MLIR_ENABLE_STABLEHLO
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Affine/Utils.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Pass/Pass.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+#include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+
+using namespace mlir;
+using namespace mlir::torch;
+namespace mlir::torch::TorchConversion {
+
+#define GEN_PASS_DEF_UNIFYSYMBOLICDIMS
+#include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h.inc"
+
+namespace {
+// The symbolic sizes of the dynamic dims of the builtin tensors in a
+// function, in terms of the shape symbols that `torch.bind_symbolic_shape`
+// binds, numbered across the whole function.
+class SymbolicDimTable {
+public:
+  SymbolicDimTable(FunctionOpInterface func)
+      : func(func),
+        builder(OpBuilder::atBlockBegin(&func.getFunctionBody().front())) {
+    func.walk([&](Torch::BindSymbolicShapeOp bind) { addBinding(bind); });
+  }
+
+  // Returns the symbolic size of dim `dim` of `tensor`, or a null expression
+  // if it is not known.
+  AffineExpr lookup(Value tensor, int64_t dim) const {
+    return dimExprs.lookup({tensor, dim});
+  }
+
+  // Returns a value of `expr`, computed at the start of the function from the
+  // dims of the arguments, or a null value if some of its symbols are not the
+  // size of any argument dim.
+  Value materialize(AffineExpr expr) {
+    auto it = exprValues.find(expr);
+    if (it != exprValues.end())
+      return it->second;
+
+    llvm::SmallSetVector<unsigned, 4> used;
+    expr.walk([&](AffineExpr e) {
+      if (auto symbol = dyn_cast<AffineSymbolExpr>(e))
+        used.insert(symbol.getPosition());
+    });
+    Value value;
+    if (llvm::all_of(used, [&](unsigned i) { return roots.contains(i); })) {
+      SmallVector<Value> operands(symbolIndices.size());
+      for (unsigned i : used)
+        operands[i] = getSymbolValue(i);
+      value = affine::expandAffineExpr(builder, func.getLoc(), expr,
+                                       /*dimValues=*/{}, operands);
+    }
+    exprValues[expr] = value;
+    return value;
+  }
+
+private:
+  void addBinding(Torch::BindSymbolicShapeOp bind) {
+    Value tensor = bind.getOperand();
+    auto type = cast<Torch::ValueTensorType>(tensor.getType());
+    AffineMap map = bind.getShapeExpressions().getValue();
+    if (!type.hasSizes() || map.getNumResults() != type.getSizes().size())
+      return;
+
+    SmallVector<AffineExpr> symbols;
+    for (Value symbol : bind.getShapeSymbols()) {
+      auto [it, inserted] =
+          symbolIndices.try_emplace(symbol, symbolIndices.size());
+      symbols.push_back(getAffineSymbolExpr(it->second, func.getContext()));
+    }
+
+    // The builtin tensors that the bound tensor is converted from and to.
+    SmallVector<Value> builtins;
+    if (auto from = tensor.getDefiningOp<FromBuiltinTensorOp>())
+      builtins.push_back(from.getOperand());
+    for (Operation *user : tensor.getUsers()) {
+      if (auto to = dyn_cast<ToBuiltinTensorOp>(user))
+        builtins.push_back(to.getResult());
+    }
+
+    auto arg = dyn_cast<BlockArgument>(tensor);
+    bool isArgument = arg && arg.getOwner()->isEntryBlock() &&
+                      arg.getOwner()->getParentOp() == func.getOperation();
+    for (auto [dim, size] : llvm::enumerate(type.getSizes())) {
+      if (size != Torch::kUnknownSize)
+        continue;
+      AffineExpr expr = map.getResult(dim).replaceSymbols(symbols);
+      for (Value builtin : builtins)
+        dimExprs[{builtin, dim}] = expr;
+      if (auto symbol = dyn_cast<AffineSymbolExpr>(expr); symbol && isArgument)
+        roots.try_emplace(symbol.getPosition(), arg, dim);
+    }
+  }
+
+  // The size of the argument dim that symbol `index` is bound to.
+  Value getSymbolValue(unsigned index) {
+    auto it = symbolValues.find(index);
+    if (it != symbolValues.end())
+      return it->second;
+    auto [arg, dim] = roots.lookup(index);
+    Location loc = arg.getLoc();
+    auto type = cast<Torch::ValueTensorType>(arg.getType());
+    Value builtin =
+        ToBuiltinTensorOp::create(builder, loc, type.toBuiltinTensor(), arg);
+    Value size = tensor::DimOp::create(builder, loc, builtin, dim);
+    return symbolValues[index] = size;
+  }
+
+  FunctionOpInterface func;
+  // Inserts at the start of the function, so that the sizes dominate all of
+  // the dims that they replace.
+  OpBuilder builder;
+  DenseMap<Value, unsigned> symbolIndices;
+  DenseMap<std::pair<Value, int64_t>, AffineExpr> dimExprs;
+  // The argument dim that each symbol is bound to, if any.
+  DenseMap<unsigned, std::pair<Value, int64_t>> roots;
+  DenseMap<unsigned, Value> symbolValues;
+  DenseMap<AffineExpr, Value> exprValues;
+};
+} // namespace
+
+namespace {
+class UnifySymbolicDimsPass
+    : public impl::UnifySymbolicDimsBase<UnifySymbolicDimsPass> {
+  void runOnOperation() override {
+    FunctionOpInterface func = getOperation();
+    if (func.isExternal())
+      return;
+    SymbolicDimTable table(func);
+
+    SmallVector<std::pair<tensor::DimOp, AffineExpr>> dimOps;
+    func.walk([&](tensor::DimOp op) {
+      std::optional<int64_t> dim = op.getConstantIndex();
+      if (!dim)
+        return;
+      if (AffineExpr expr = table.lookup(op.getSource(), *dim))
+        dimOps.push_back({op, expr});
+    });
+    for (auto [op, expr] : dimOps) {
+      if (Value size = table.materialize(expr)) {
+        op.replaceAllUsesWith(size);
+        op.erase();
+      }
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<InterfacePass<FunctionOpInterface>>
+createUnifySymbolicDimsPass() {
+  return std::make_unique<UnifySymbolicDimsPass>();
+}
+
+} // namespace mlir::torch::TorchConversion
@@ -17,6 +17,7 @@
 #include "stablehlo/dialect/ChloOps.h"
 #include "stablehlo/dialect/StablehloOps.h"
 #include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h"
+#include "llvm/ADT/TypeSwitch.h"
 
 using namespace mlir;
 using namespace mlir::torch;
@@ -24,6 +25,7 @@ using namespace mlir::torch::TorchConversion;
 namespace mlir::torch::TorchConversion {
 
 #define GEN_PASS_DEF_VERIFYSTABLEHLOBACKENDCONTRACT
+#define GEN_PASS_DEF_VERIFYSTABLEHLOI32INDEX
 #include "torch-mlir/Dialect/TorchConversion/Transforms/Passes.h.inc"
 
 namespace {
@@ -73,6 +75,59 @@ createVerifyStablehloBackendContractPass() {
   return std::make_unique<VerifyStablehloBackendContractPass>();
 }
 
+// The operands of `op` that hold dimension sizes or indices computed by the
+// lowering, as opposed to the indices of gathers and scatters, which come
+// from the program.
+static SmallVector<Value> getShapeOperands(Operation *op) {
+  return TypeSwitch<Operation *, SmallVector<Value>>(op)
+      .Case<stablehlo::DynamicBroadcastInDimOp>(
+          [](auto op) { return SmallVector<Value>{op.getOutputDimensions()}; })
+      .Case<stablehlo::DynamicReshapeOp, stablehlo::DynamicIotaOp>(
+          [](auto op) { return SmallVector<Value>{op.getOutputShape()}; })
+      .Case<stablehlo::DynamicGatherOp>(
+          [](auto op) { return SmallVector<Value>{op.getSliceSizes()}; })
+      .Case<stablehlo::RealDynamicSliceOp>([](auto op) {
+        return SmallVector<Value>{op.getStartIndices(), op.getLimitIndices(),
+                                  op.getStrides()};
+      })
+      .Case<stablehlo::DynamicPadOp>([](auto op) {
+        return SmallVector<Value>{op.getEdgePaddingLow(),
+                                  op.getEdgePaddingHigh(),
+                                  op.getInteriorPadding()};
+      })
+      .Case<stablehlo::DynamicSliceOp>(
+          [](auto op) { return llvm::to_vector(op.getStartIndices()); })
+      .Case<stablehlo::RngOp>(
+          [](auto op) { return SmallVector<Value>{op.getShape()}; })
+      .Default([](Operation *) { return SmallVector<Value>(); });
+}
+
+namespace {
+class VerifyStablehloI32IndexPass
+    : public impl::VerifyStablehloI32IndexBase<VerifyStablehloI32IndexPass> {
+  void runOnOperation() override {
+    bool hasI64Index = false;
+    getOperation().walk([&](Operation *op) {
+      if (llvm::any_of(getShapeOperands(op), [](Value operand) {
+            return cast<ShapedType>(operand.getType())
+                .getElementType()
+                .isInteger(64);
+          })) {
+        op->emitError("has a shape operand with 64-bit elements, which the "
+                      "i32 index mode does not allow");
+        hasI64Index = true;
+      }
+    });
+    if (hasI64Index)
+      return signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createVerifyStablehloI32IndexPass() {
+  return std::make_unique<VerifyStablehloI32IndexPass>();
+}
+
 } // namespace mlir::torch::TorchConversion
 
 #endif // TORCH_MLIR_ENABLE_STABLEHLO
@@ -21,6 +21,7 @@
 #include "mlir/Dialect/Tensor/IR/TensorInferTypeOpInterfaceImpl.h"
 #include "mlir/IR/Dialect.h"
 #include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorDialect.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TilingInterfaceImpl.h"
 #include "torch-mlir-dialects/Dialect/TMTensor/Transforms/Passes.h"
 #include "torch-mlir/Conversion/Passes.h"
 #include "torch-mlir/Conversion/TorchOnnxToTorch/Passes.h"
@@ -50,6 +51,7 @@ void mlir::torch::registerAllDialects(mlir::DialectRegistry &registry) {
 void mlir::torch::registerAllExtensions(mlir::DialectRegistry &registry) {
   mlir::func::registerInlinerExtension(registry);
   tensor::registerInferTypeOpInterfaceExternalModels(registry);
+  mlir::torch::TMTensor::registerTilingInterfaceExternalModels(registry);
 }
 
 // TODO: Break this up when backends are separated.
@@ -74,6 +76,7 @@ void mlir::torch::registerAllPasses() {
 #ifdef TORCH_MLIR_ENABLE_STABLEHLO
   mlir::stablehlo::registerStablehloLegalizeToLinalgPass();
   mlir::stablehlo::registerStablehloAggressiveSimplificationPass();
+  mlir::stablehlo::registerStablehloRefineArgumentsPass();
   mlir::stablehlo::registerStablehloRefineShapesPass();
   mlir::stablehlo::registerStablehloConvertToSignlessPass();
   mlir::stablehlo::registerShapeLegalizeToStablehloPass();
@@ -15,6 +15,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Async/IR/Async.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
@@ -23,13 +24,25 @@
 #include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/Math/Transforms/Approximation.h"
 #include "mlir/Dialect/Math/Transforms/Passes.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Tensor/Transforms/Transforms.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
+#include "mlir/Support/FileUtilities.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "torch-mlir-dialects/Dialect/TMTensor/IR/TMTensorOps.h"
 #include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
 #include "torch-mlir/Dialect/TorchConversion/Transforms/BackendTypeConversion.h"
 #include "torch-mlir/RefBackend/Passes.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ToolOutputFile.h"
 #include <numeric>
 #include <set>
 
@@ -46,20 +59,32 @@ namespace mlir::torch::RefBackend {
 #define GEN_PASS_DEF_MUNGECALLINGCONVENTIONS
 #define GEN_PASS_DEF_MLPROGRAMBUFFERIZE
 #define GEN_PASS_DEF_EXPANDOPSFORLLVM
+#define GEN_PASS_DEF_APPROXIMATEMATH
 #define GEN_PASS_DEF_MUNGEMEMREFCOPY
 #define GEN_PASS_DEF_GENERALIZETENSORCONCAT
 #define GEN_PASS_DEF_GENERALIZETENSORPAD
+#define GEN_PASS_DEF_LOWERLINALGPACK
+#define GEN_PASS_DEF_PLANSTATICMEMORY
+#define GEN_PASS_DEF_ESTIMATEPEAKMEMORY
+#define GEN_PASS_DEF_INSERTPROFILING
+#define GEN_PASS_DEF_ASYNCINDEPENDENTOPS
 #include "torch-mlir/RefBackend/Passes.h.inc"
 
 } // namespace mlir::torch::RefBackend
 
 // Bring Base classes into scope for anonymous namespace passes.
+using mlir::torch::RefBackend::impl::ApproximateMathBase;
+using mlir::torch::RefBackend::impl::AsyncIndependentOpsBase;
+using mlir::torch::RefBackend::impl::EstimatePeakMemoryBase;
 using mlir::torch::RefBackend::impl::ExpandOpsForLLVMBase;
 using mlir::torch::RefBackend::impl::GeneralizeTensorConcatBase;
 using mlir::torch::RefBackend::impl::GeneralizeTensorPadBase;
+using mlir::torch::RefBackend::impl::InsertProfilingBase;
+using mlir::torch::RefBackend::impl::LowerLinalgPackBase;
 using mlir::torch::RefBackend::impl::MLProgramBufferizeBase;
 using mlir::torch::RefBackend::impl::MungeCallingConventionsBase;
 using mlir::torch::RefBackend::impl::MungeMemrefCopyBase;
+using mlir::torch::RefBackend::impl::PlanStaticMemoryBase;
 
 namespace {
 #define GEN_PASS_REGISTRATION
@@ -388,6 +413,59 @@ class ExpandOpsForLLVM : public ExpandOpsForLLVMBase<ExpandOpsForLLVM> {
 };
 } // namespace
 
+//===----------------------------------------------------------------------===//
+// ApproximateMath
+//===----------------------------------------------------------------------===//
+
+// The math ops whose approximations are accurate over their whole range.
+static constexpr StringLiteral kAccurateApproximations[] = {
+    "atan", "atan2", "erf", "exp", "expm1", "log", "log1p", "log2", "tanh"};
+// The other math ops that have approximations.
+static constexpr StringLiteral kOtherApproximations[] = {"acos", "asin",
+                                                         "cbrt", "cos", "sin"};
+
+namespace {
+class ApproximateMath : public ApproximateMathBase<ApproximateMath> {
+public:
+  using ApproximateMathBase<ApproximateMath>::ApproximateMathBase;
+
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    llvm::StringSet<> names;
+    if (ops.empty()) {
+      for (StringRef name : kAccurateApproximations)
+        names.insert(name);
+    }
+    for (const std::string &name : ops) {
+      if (!llvm::is_contained(kAccurateApproximations, name) &&
+          !llvm::is_contained(kOtherApproximations, name)) {
+        func.emitError() << "no approximation of math." << name;
+        return signalPassFailure();
+      }
+      names.insert(name);
+    }
+
+    SmallVector<Operation *> mathOps;
+    func.walk([&](Operation *op) {
+      if (isa<math::MathDialect>(op->getDialect()) &&
+          names.contains(op->getName().stripDialect()))
+        mathOps.push_back(op);
+    });
+    if (mathOps.empty())
+      return;
+
+    // The approximations of some ops use other math ops, e.g. `atan2` uses
+    // `atan`, which are approximated too.
+    RewritePatternSet patterns(&getContext());
+    math::populateMathPolynomialApproximationPatterns(patterns);
+    GreedyRewriteConfig config;
+    config.setStrictness(GreedyRewriteStrictness::ExistingAndNewOps);
+    if (failed(applyOpPatternsGreedily(mathOps, std::move(patterns), config)))
+      return signalPassFailure();
+  }
+};
+} // namespace
+
 //===----------------------------------------------------------------------===//
 // MungeMemrefCopy
 //===----------------------------------------------------------------------===//
@@ -473,3 +551,561 @@ class GeneralizeTensorPad
   }
 };
 } // namespace
+
+namespace {
+class LowerPackOp : public OpRewritePattern<linalg::PackOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::PackOp op,
+                                PatternRewriter &rewriter) const override {
+    return linalg::lowerPack(rewriter, op);
+  }
+};
+
+class LowerUnPackOp : public OpRewritePattern<linalg::UnPackOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::UnPackOp op,
+                                PatternRewriter &rewriter) const override {
+    return linalg::lowerUnPack(rewriter, op);
+  }
+};
+
+class LowerLinalgPack : public LowerLinalgPackBase<LowerLinalgPack> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<linalg::LinalgDialect, tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.insert<LowerPackOp, LowerUnPackOp>(context);
+    if (failed(applyPatternsGreedily(getOperation(), std::move(patterns)))) {
+      return signalPassFailure();
+    }
+  }
+};
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// PlanStaticMemory
+//===----------------------------------------------------------------------===//
+
+// The alignment in bytes of the arena and of the buffers in it.
+static constexpr int64_t kArenaAlignment = 64;
+
+namespace {
+// A buffer placed in the arena. It is live from the position of its
+// allocation to that of its deallocation in the body of the function.
+struct PlannedBuffer {
+  memref::AllocOp alloc;
+  memref::DeallocOp dealloc;
+  int64_t begin;
+  int64_t end;
+  int64_t size;
+  int64_t offset = 0;
+};
+} // namespace
+
+// The size in bytes of a buffer of `type`, or std::nullopt if it cannot be a
+// view of an arena of bytes.
+static std::optional<int64_t> getStaticBufferSize(MemRefType type) {
+  if (!type.hasStaticShape() || !type.getLayout().isIdentity() ||
+      type.getMemorySpace() || !type.getElementType().isIntOrFloat())
+    return std::nullopt;
+  unsigned bitWidth = type.getElementTypeBitWidth();
+  if (bitWidth % 8 != 0)
+    return std::nullopt;
+  return type.getNumElements() * (bitWidth / 8);
+}
+
+// The deallocation of `alloc` if it is its only one and it is unconditional,
+// i.e. in the body of the function.
+static memref::DeallocOp getUniqueDealloc(memref::AllocOp alloc, Block &body) {
+  memref::DeallocOp dealloc;
+  for (Operation *user : alloc->getUsers()) {
+    auto userDealloc = dyn_cast<memref::DeallocOp>(user);
+    if (!userDealloc)
+      continue;
+    if (dealloc || userDealloc->getBlock() != &body)
+      return nullptr;
+    dealloc = userDealloc;
+  }
+  return dealloc;
+}
+
+namespace {
+class PlanStaticMemory : public PlanStaticMemoryBase<PlanStaticMemory> {
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    if (!func.getBody().hasOneBlock())
+      return;
+    Block &body = func.getBody().front();
+
+    DenseMap<Operation *, int64_t> positions;
+    for (auto [i, op] : llvm::enumerate(body))
+      positions[&op] = i;
+
+    SmallVector<PlannedBuffer> buffers;
+    for (memref::AllocOp alloc : body.getOps<memref::AllocOp>()) {
+      std::optional<int64_t> size = getStaticBufferSize(alloc.getType());
+      if (!size ||
+          alloc.getAlignment().value_or(0) > uint64_t(kArenaAlignment))
+        continue;
+      memref::DeallocOp dealloc = getUniqueDealloc(alloc, body);
+      if (!dealloc)
+        continue;
+      buffers.push_back({alloc, dealloc, positions[alloc.getOperation()],
+                         positions[dealloc.getOperation()], *size});
+    }
+    // A single buffer is allocated once either way.
+    if (buffers.size() < 2)
+      return;
+
+    // Place the largest buffers first, each at the lowest offset that does
+    // not overlap the buffers placed before it that are live at the same
+    // time.
+    SmallVector<PlannedBuffer *> order;
+    for (PlannedBuffer &buffer : buffers)
+      order.push_back(&buffer);
+    llvm::stable_sort(order, [](PlannedBuffer *a, PlannedBuffer *b) {
+      return a->size > b->size;
+    });
+    int64_t arenaSize = 0;
+    for (auto [i, buffer] : llvm::enumerate(order)) {
+      SmallVector<std::pair<int64_t, int64_t>> taken;
+      for (PlannedBuffer *other : ArrayRef(order).take_front(i)) {
+        if (buffer->begin < other->end && other->begin < buffer->end)
+          taken.push_back({other->offset, other->offset + other->size});
+      }
+      llvm::sort(taken);
+      int64_t offset = 0;
+      for (auto [begin, end] : taken) {
+        if (offset + buffer->size <= begin)
+          break;
+        offset = std::max<int64_t>(offset, llvm::alignTo(end, kArenaAlignment));
+      }
+      buffer->offset = offset;
+      arenaSize = std::max(arenaSize, offset + buffer->size);
+    }
+
+    OpBuilder b(&body, body.begin());
+    Location loc = func.getLoc();
+    Value arena = memref::AllocOp::create(
+        b, loc, MemRefType::get({arenaSize}, b.getI8Type()),
+        b.getI64IntegerAttr(kArenaAlignment));
+    for (PlannedBuffer &buffer : buffers) {
+      b.setInsertionPoint(buffer.alloc);
+      Location allocLoc = buffer.alloc.getLoc();
+      Value offset = arith::ConstantIndexOp::create(b, allocLoc, buffer.offset);
+      Value view = memref::ViewOp::create(b, allocLoc, buffer.alloc.getType(),
+                                          arena, offset, ValueRange());
+      buffer.dealloc.erase();
+      buffer.alloc.replaceAllUsesWith(view);
+      buffer.alloc.erase();
+    }
+    b.setInsertionPoint(body.getTerminator());
+    memref::DeallocOp::create(b, loc, arena);
+  }
+};
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// EstimatePeakMemory
+//===----------------------------------------------------------------------===//
+
+// The number of the largest buffers live at the peak that are reported.
+static constexpr int64_t kMaxReportedBuffers = 10;
+
+namespace {
+enum class BufferKind { Weight, Activation, Temporary };
+
+// A buffer and its views, live from the op at `begin` to the op at `end` of
+// the body of the function, both included.
+struct LiveBuffer {
+  Value value;
+  BufferKind kind;
+  int64_t begin;
+  int64_t end;
+  std::optional<int64_t> bytes;
+};
+} // namespace
+
+static StringRef getKindName(BufferKind kind) {
+  switch (kind) {
+  case BufferKind::Weight:
+    return "weights";
+  case BufferKind::Activation:
+    return "activations";
+  case BufferKind::Temporary:
+    return "temporaries";
+  }
+  llvm_unreachable("unknown buffer kind");
+}
+
+static std::string printLoc(Location loc) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  loc.print(os);
+  return str;
+}
+
+// The peak live bytes of the body of `func`, which has a single block.
+static llvm::json::Object estimatePeakMemory(func::FuncOp func) {
+  Block &body = func.getBody().front();
+  DenseMap<Operation *, int64_t> positions;
+  for (auto [i, op] : llvm::enumerate(body))
+    positions[&op] = i;
+  int64_t last = body.getOperations().size() - 1;
+
+  // The buffers by the value that defines them, and the buffer of each view.
+  llvm::MapVector<Value, LiveBuffer> buffers;
+  DenseMap<Value, Value> roots;
+  llvm::StringMap<Value> globals;
+  auto addBuffer = [&](Value value, BufferKind kind, int64_t begin,
+                       int64_t end) {
+    std::optional<int64_t> bytes =
+        getStaticBufferSize(cast<MemRefType>(value.getType()));
+    buffers[value] = {value, kind, begin, end, bytes};
+    roots[value] = value;
+  };
+  for (BlockArgument arg : body.getArguments()) {
+    if (isa<MemRefType>(arg.getType()))
+      addBuffer(arg, BufferKind::Activation, 0, 0);
+  }
+  for (Operation &op : body) {
+    int64_t position = positions.lookup(&op);
+    for (Value result : op.getResults()) {
+      if (!isa<MemRefType>(result.getType()))
+        continue;
+      auto view = dyn_cast<ViewLikeOpInterface>(op);
+      if (auto getGlobal = dyn_cast<memref::GetGlobalOp>(op)) {
+        auto [it, inserted] = globals.try_emplace(getGlobal.getName(), result);
+        if (inserted)
+          addBuffer(result, BufferKind::Weight, 0, last);
+        else
+          roots[result] = roots.lookup(it->second);
+      } else if (view && roots.contains(view.getViewSource())) {
+        roots[result] = roots.lookup(view.getViewSource());
+      } else {
+        addBuffer(result, BufferKind::Temporary, position, position);
+      }
+    }
+  }
+
+  // A buffer lives until the last use of any of its views, anywhere in the
+  // ops of the body, and is an activation if the function returns it.
+  Operation *terminator = body.getTerminator();
+  for (auto [value, root] : roots) {
+    LiveBuffer &buffer = buffers.find(root)->second;
+    for (Operation *user : value.getUsers()) {
+      Operation *ancestor = body.findAncestorOpInBlock(*user);
+      if (!ancestor)
+        continue;
+      buffer.end = std::max(buffer.end, positions.lookup(ancestor));
+      if (ancestor == terminator && buffer.kind == BufferKind::Temporary)
+        buffer.kind = BufferKind::Activation;
+    }
+  }
+
+  // The first op at which the most bytes are live.
+  SmallVector<int64_t> deltas(last + 2, 0);
+  int64_t unknownSizes = 0;
+  for (const LiveBuffer &buffer : llvm::make_second_range(buffers)) {
+    if (!buffer.bytes) {
+      ++unknownSizes;
+      continue;
+    }
+    deltas[buffer.begin] += *buffer.bytes;
+    deltas[buffer.end + 1] -= *buffer.bytes;
+  }
+  int64_t peak = 0, peakBytes = 0, liveBytes = 0;
+  for (int64_t i = 0; i <= last; ++i) {
+    liveBytes += deltas[i];
+    if (liveBytes > peakBytes) {
+      peak = i;
+      peakBytes = liveBytes;
+    }
+  }
+
+  SmallVector<const LiveBuffer *> live;
+  std::array<int64_t, 3> kindBytes = {0, 0, 0};
+  for (const LiveBuffer &buffer : llvm::make_second_range(buffers)) {
+    if (buffer.bytes && buffer.begin <= peak && peak <= buffer.end) {
+      live.push_back(&buffer);
+      kindBytes[static_cast<int>(buffer.kind)] += *buffer.bytes;
+    }
+  }
+  llvm::stable_sort(live, [](const LiveBuffer *a, const LiveBuffer *b) {
+    return *a->bytes > *b->bytes;
+  });
+  llvm::json::Array liveAtPeak;
+  for (const LiveBuffer *buffer :
+       ArrayRef(live).take_front(kMaxReportedBuffers)) {
+    Operation *def = buffer->value.getDefiningOp();
+    liveAtPeak.push_back(llvm::json::Object{
+        {"op", def ? def->getName().getStringRef() : StringRef("argument")},
+        {"loc", printLoc(buffer->value.getLoc())},
+        {"kind", getKindName(buffer->kind)},
+        {"bytes", *buffer->bytes}});
+  }
+
+  Operation *peakOp = &*std::next(body.begin(), peak);
+  llvm::json::Object record{
+      {"peak_bytes", peakBytes},
+      {"peak_op", llvm::json::Object{{"op", peakOp->getName().getStringRef()},
+                                     {"loc", printLoc(peakOp->getLoc())}}},
+      {"live_at_peak", std::move(liveAtPeak)},
+      {"unknown_sizes", unknownSizes}};
+  for (BufferKind kind : {BufferKind::Weight, BufferKind::Activation,
+                          BufferKind::Temporary})
+    record[getKindName(kind)] = kindBytes[static_cast<int>(kind)];
+  return record;
+}
+
+namespace {
+class EstimatePeakMemory : public EstimatePeakMemoryBase<EstimatePeakMemory> {
+public:
+  using EstimatePeakMemoryBase<EstimatePeakMemory>::EstimatePeakMemoryBase;
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    llvm::json::Object functions;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (!func.isDeclaration() && func.getBody().hasOneBlock())
+        functions[func.getName()] = estimatePeakMemory(func);
+    }
+
+    std::string errorMessage;
+    std::unique_ptr<llvm::ToolOutputFile> output =
+        openOutputFile(outputFile, &errorMessage);
+    if (!output) {
+      module.emitError() << "could not open peak memory file '" << outputFile
+                         << "': " << errorMessage;
+      return signalPassFailure();
+    }
+    llvm::json::Value report =
+        llvm::json::Object{{"functions", std::move(functions)}};
+    output->os() << llvm::formatv("{0:2}", report) << "\n";
+    output->keep();
+    markAllAnalysesPreserved();
+  }
+};
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// InsertProfiling
+//===----------------------------------------------------------------------===//
+
+static constexpr StringLiteral kProfileNamesAttr = "refback.profile_names";
+static constexpr StringLiteral kProfileBeginFunc = "refbackend_profile_begin";
+static constexpr StringLiteral kProfileEndFunc = "refbackend_profile_end";
+
+// The name of the torch ops that `op` was lowered from, as named in its
+// location by `torch-name-locations`, or else the name of `op`.
+static std::string getProfileName(Operation *op) {
+  SmallVector<StringRef> names;
+  op->getLoc()->walk([&](Location loc) {
+    if (auto nameLoc = dyn_cast<NameLoc>(loc)) {
+      StringRef name = nameLoc.getName().getValue();
+      if (name.starts_with("torch.") && !llvm::is_contained(names, name))
+        names.push_back(name);
+    }
+    return WalkResult::advance();
+  });
+  if (names.empty())
+    return op->getName().getStringRef().str();
+  return llvm::join(names, "+");
+}
+
+namespace {
+class InsertProfiling : public InsertProfilingBase<InsertProfiling> {
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    if (module->hasAttr(kProfileNamesAttr))
+      return;
+    SmallVector<Operation *> ops;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      func.walk<WalkOrder::PreOrder>([&](Operation *op) {
+        if (!isa<linalg::LinalgOp, TMTensor::TMTensorOp, memref::CopyOp>(op))
+          return WalkResult::advance();
+        ops.push_back(op);
+        return WalkResult::skip();
+      });
+    }
+    if (ops.empty())
+      return;
+
+    OpBuilder b(module.getBodyRegion());
+    FunctionType type = b.getFunctionType({b.getI64Type()}, {});
+    for (StringRef name : {kProfileBeginFunc, kProfileEndFunc}) {
+      auto decl = func::FuncOp::create(b, module.getLoc(), name, type);
+      decl.setPrivate();
+      addEmitCInterfaceAttr(decl);
+    }
+
+    llvm::StringMap<int64_t> ids;
+    SmallVector<Attribute> names;
+    for (Operation *op : ops) {
+      std::string name = getProfileName(op);
+      auto [it, inserted] = ids.try_emplace(name, names.size());
+      if (inserted)
+        names.push_back(b.getStringAttr(name));
+      Location loc = op->getLoc();
+      b.setInsertionPoint(op);
+      Value id =
+          arith::ConstantOp::create(b, loc, b.getI64IntegerAttr(it->second));
+      func::CallOp::create(b, loc, kProfileBeginFunc, TypeRange(), id);
+      b.setInsertionPointAfter(op);
+      func::CallOp::create(b, loc, kProfileEndFunc, TypeRange(), id);
+    }
+    module->setAttr(kProfileNamesAttr, b.getArrayAttr(names));
+  }
+};
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// AsyncIndependentOps
+//===----------------------------------------------------------------------===//
+
+namespace {
+// The memory that an op reads or writes: the allocation of a buffer, or null
+// for all the memory not allocated in the function, and the bytes of it, if
+// known.
+struct BufferAccess {
+  Value root;
+  std::optional<std::pair<int64_t, int64_t>> range;
+  bool write;
+
+  bool conflictsWith(const BufferAccess &other) const {
+    if (root != other.root || (!write && !other.write))
+      return false;
+    return !range || !other.range ||
+           (range->first < other.range->second &&
+            other.range->first < range->second);
+  }
+};
+
+// An op of the function running in an `async.execute`.
+struct AsyncTask {
+  Value token;
+  SmallVector<BufferAccess> accesses;
+};
+} // namespace
+
+// The memory of `buffer`, a view of a view... of an allocation of the
+// function, if it is one.
+static BufferAccess getBufferAccess(Value buffer, bool write) {
+  BufferAccess access{Value(), std::nullopt, write};
+  bool viewed = false;
+  while (Operation *def = buffer.getDefiningOp()) {
+    if (isa<memref::AllocOp, memref::AllocaOp>(def)) {
+      access.root = buffer;
+      return access;
+    }
+    auto view = dyn_cast<ViewLikeOpInterface>(def);
+    if (!view)
+      break;
+    // The innermost views are within the bytes of the `memref.view` of the
+    // allocation.
+    if (auto byteView = dyn_cast<memref::ViewOp>(def)) {
+      std::optional<int64_t> shift =
+          getConstantIntValue(byteView.getByteShift());
+      std::optional<int64_t> size = getStaticBufferSize(byteView.getType());
+      access.range = std::nullopt;
+      if (shift && size && !viewed)
+        access.range = std::make_pair(*shift, *shift + *size);
+      viewed = true;
+    }
+    buffer = view.getViewSource();
+  }
+  access.range = std::nullopt;
+  return access;
+}
+
+// The memory that `op` accesses, or std::nullopt if it is not known.
+static std::optional<SmallVector<BufferAccess>>
+getBufferAccesses(Operation *op) {
+  std::optional<SmallVector<MemoryEffects::EffectInstance>> effects =
+      getEffectsRecursively(op);
+  if (!effects)
+    return std::nullopt;
+  SmallVector<BufferAccess> accesses;
+  for (const MemoryEffects::EffectInstance &effect : *effects) {
+    if (isa<MemoryEffects::Allocate>(effect.getEffect()))
+      continue;
+    Value value = effect.getValue();
+    if (!value || !isa<BaseMemRefType>(value.getType()))
+      return std::nullopt;
+    // Buffers allocated in `op` are not accessed by other ops.
+    Operation *def = value.getDefiningOp();
+    if (def && op->isProperAncestor(def))
+      continue;
+    accesses.push_back(
+        getBufferAccess(value, !isa<MemoryEffects::Read>(effect.getEffect())));
+  }
+  return accesses;
+}
+
+namespace {
+class AsyncIndependentOps
+    : public AsyncIndependentOpsBase<AsyncIndependentOps> {
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    if (!func.getBody().hasOneBlock())
+      return;
+    Block &body = func.getBody().front();
+
+    SmallVector<AsyncTask> tasks;
+    OpBuilder b(func.getContext());
+    // Waits for the tasks that `isWaitedFor` selects and forgets them.
+    auto waitFor = [&](Operation *op, auto isWaitedFor) {
+      b.setInsertionPoint(op);
+      llvm::erase_if(tasks, [&](const AsyncTask &task) {
+        if (!isWaitedFor(task))
+          return false;
+        async::AwaitOp::create(b, op->getLoc(), task.token);
+        return true;
+      });
+    };
+    auto conflicts = [](const AsyncTask &task,
+                        ArrayRef<BufferAccess> accesses) {
+      return llvm::any_of(task.accesses, [&](const BufferAccess &access) {
+        return llvm::any_of(accesses, [&](const BufferAccess &other) {
+          return access.conflictsWith(other);
+        });
+      });
+    };
+
+    for (Operation &op : llvm::make_early_inc_range(body)) {
+      std::optional<SmallVector<BufferAccess>> accesses =
+          getBufferAccesses(&op);
+      if (!accesses || op.hasTrait<OpTrait::IsTerminator>()) {
+        waitFor(&op, [](const AsyncTask &) { return true; });
+        continue;
+      }
+      if (!isa<linalg::LinalgOp, TMTensor::TMTensorOp, memref::CopyOp>(op) ||
+          op.getNumResults() != 0) {
+        waitFor(&op, [&](const AsyncTask &task) {
+          return conflicts(task, *accesses);
+        });
+        continue;
+      }
+
+      SmallVector<Value> dependencies;
+      for (const AsyncTask &task : tasks) {
+        if (conflicts(task, *accesses))
+          dependencies.push_back(task.token);
+      }
+      b.setInsertionPoint(&op);
+      auto execute = async::ExecuteOp::create(
+          b, op.getLoc(), TypeRange(), dependencies, ValueRange(),
+          [](OpBuilder &nested, Location loc, ValueRange) {
+            async::YieldOp::create(nested, loc);
+          });
+      op.moveBefore(execute.getBodyRegion().front().getTerminator());
+      tasks.push_back({execute.getToken(), std::move(*accesses)});
+    }
+  }
+};
+} // namespace
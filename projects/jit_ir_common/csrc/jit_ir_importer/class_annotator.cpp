@@ -11,6 +11,7 @@
 
 #include <sstream>
 #include <stdexcept>
+#include <unordered_set>
 
 using namespace torch_mlir;
 
@@ -36,8 +37,19 @@ static std::string indentString(const std::string &linePrefix,
 
 ClassAnnotation::ClassAnnotation(c10::ClassTypePtr classType)
     : classType(classType) {
-  attributeAnnotations.resize(classType->getAttributes().size());
-  methodAnnotations.resize(classType->methods().size());
+  const std::vector<c10::ClassAttribute> &classAttributes =
+      classType->getAttributes();
+  const std::vector<torch::jit::Function *> &methods = classType->methods();
+  attributeAnnotations.resize(classAttributes.size());
+  methodAnnotations.resize(methods.size());
+  attributeIndices.reserve(classAttributes.size());
+  for (int i = 0, e = classAttributes.size(); i != e; i++) {
+    attributeIndices.emplace(classAttributes[i].getName(), i);
+  }
+  methodIndices.reserve(methods.size());
+  for (int i = 0, e = methods.size(); i != e; i++) {
+    methodIndices.emplace(methods[i]->name(), i);
+  }
 }
 
 std::vector<AttributeAnnotation> &ClassAnnotation::getAttributeAnnotations() {
@@ -64,12 +76,36 @@ std::vector<MethodAnnotation> &ClassAnnotation::getMethodAnnotations() {
   return methodAnnotations;
 }
 
+AttributeAnnotation *
+ClassAnnotation::getAttributeAnnotation(const std::string &name) {
+  auto it = attributeIndices.find(name);
+  if (it == attributeIndices.end()) {
+    return nullptr;
+  }
+  return &getAttributeAnnotations()[it->second];
+}
+
+MethodAnnotation *
+ClassAnnotation::getMethodAnnotation(const std::string &name) {
+  auto it = methodIndices.find(name);
+  if (it == methodIndices.end()) {
+    return nullptr;
+  }
+  return &getMethodAnnotations()[it->second];
+}
+
 //===----------------------------------------------------------------------===//
 // ClassAnnotator
 //===----------------------------------------------------------------------===//
 
-static void exportNoneRecurse(ClassAnnotator &classAnnotator,
-                              c10::ClassType *classType) {
+static void
+exportNoneRecurse(ClassAnnotator &classAnnotator, c10::ClassType *classType,
+                  std::unordered_set<c10::ClassType *> &visited) {
+  // Submodules of the same class share their annotations, so each class is
+  // only visited once.
+  if (!visited.insert(classType).second) {
+    return;
+  }
   ClassAnnotation &classAnnotation =
       classAnnotator.getOrCreateClassAnnotation(classType);
   for (auto &attributeAnnotation : classAnnotation.getAttributeAnnotations()) {
@@ -81,13 +117,14 @@ static void exportNoneRecurse(ClassAnnotator &classAnnotator,
   for (auto &classAttribute : classType->getAttributes()) {
     if (auto childClassType =
             classAttribute.getType()->cast<c10::ClassType>()) {
-      exportNoneRecurse(classAnnotator, childClassType.get());
+      exportNoneRecurse(classAnnotator, childClassType.get(), visited);
     }
   }
 }
 
 void ClassAnnotator::exportNone(c10::ClassType &rootClassType) {
-  exportNoneRecurse(*this, &rootClassType);
+  std::unordered_set<c10::ClassType *> visited;
+  exportNoneRecurse(*this, &rootClassType, visited);
 }
 
 void ClassAnnotator::exportPath(c10::ClassType &rootClassType,
@@ -101,32 +138,23 @@ void ClassAnnotator::exportPath(c10::ClassType &rootClassType,
                                          .slice(0, exportedPath.size() - 1)
                                          .vec());
 
-  if (!classType->findAttribute(exportedPath.back()) &&
-      !classType->findMethod(exportedPath.back())) {
+  ClassAnnotation &classAnnotation = getOrCreateClassAnnotation(classType);
+  AttributeAnnotation *attributeAnnotation =
+      classAnnotation.getAttributeAnnotation(exportedPath.back());
+  MethodAnnotation *methodAnnotation =
+      classAnnotation.getMethodAnnotation(exportedPath.back());
+  if (!attributeAnnotation && !methodAnnotation) {
     std::stringstream ss;
     ss << "class '" << classType->name()->qualifiedName()
        << "' does not have a method or attribute called '"
        << exportedPath.back() << "'";
     throw std::invalid_argument(ss.str());
   }
-  ClassAnnotation &classAnnotation = getOrCreateClassAnnotation(classType);
-  std::vector<AttributeAnnotation> &attributeAnnotations =
-      classAnnotation.getAttributeAnnotations();
-  const std::vector<c10::ClassAttribute> &classAttributes =
-      classType->getAttributes();
-  for (int i = 0, e = classAttributes.size(); i != e; i++) {
-    if (classAttributes[i].getName() == exportedPath.back()) {
-      attributeAnnotations[i].isExported = true;
-    }
+  if (attributeAnnotation) {
+    attributeAnnotation->isExported = true;
   }
-
-  std::vector<MethodAnnotation> &methodAnnotations =
-      classAnnotation.getMethodAnnotations();
-  const std::vector<torch::jit::Function *> &methods = classType->methods();
-  for (int i = 0, e = methods.size(); i != e; i++) {
-    if (methods[i]->name() == exportedPath.back()) {
-      methodAnnotations[i].isExported = true;
-    }
+  if (methodAnnotation) {
+    methodAnnotation->isExported = true;
   }
 }
 
@@ -136,6 +164,10 @@ const ClassAnnotationMap &ClassAnnotator::getAnnotationMap() {
 
 ClassAnnotation &
 ClassAnnotator::getOrCreateClassAnnotation(c10::ClassType *classType) {
+  auto cached = classTypeAnnotations.find(classType);
+  if (cached != classTypeAnnotations.end()) {
+    return *cached->second;
+  }
   auto className = classType->name()->qualifiedName();
   auto it = classAnnotations.find(className);
   if (it == classAnnotations.end()) {
@@ -147,6 +179,7 @@ ClassAnnotator::getOrCreateClassAnnotation(c10::ClassType *classType) {
           &it->second->getMethodAnnotations()[i];
     }
   }
+  classTypeAnnotations.emplace(classType, it->second.get());
   return *it->second;
 }
 
@@ -195,14 +228,8 @@ void ClassAnnotator::annotateArgs(c10::ClassType &rootClassType,
   torch::jit::Function *function = &classType->getMethod(path.back());
 
   ClassAnnotation &classAnnotation = getOrCreateClassAnnotation(classType);
-  std::vector<MethodAnnotation> &methodAnnotations =
-      classAnnotation.getMethodAnnotations();
-  const std::vector<torch::jit::Function *> &methods = classType->methods();
-  for (int i = 0, e = methods.size(); i != e; i++) {
-    if (methods[i]->name() == path.back()) {
-      fillArgAnnotations(methodAnnotations[i], argAnnotations, function);
-    }
-  }
+  fillArgAnnotations(*classAnnotation.getMethodAnnotation(path.back()),
+                     argAnnotations, function);
 
   return;
 }
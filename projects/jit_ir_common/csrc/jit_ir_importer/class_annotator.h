@@ -23,6 +23,8 @@
 #ifndef TORCHMLIRJITIRIMPORTER_CSRC_CLASS_ANNOTATOR_H
 #define TORCHMLIRJITIRIMPORTER_CSRC_CLASS_ANNOTATOR_H
 
+#include <unordered_map>
+
 #include <torch/csrc/jit/ir/ir.h>
 
 namespace torch_mlir {
@@ -112,6 +114,11 @@ public:
   // The length and order is the same as `classType->methods()`.
   std::vector<MethodAnnotation> &getMethodAnnotations();
 
+  // Get the annotation of the attribute or method called `name`, or null if
+  // the class has no such attribute or method.
+  AttributeAnnotation *getAttributeAnnotation(const std::string &name);
+  MethodAnnotation *getMethodAnnotation(const std::string &name);
+
   std::string toString();
 
 private:
@@ -122,6 +129,10 @@ private:
   c10::ClassTypePtr classType;
   std::vector<AttributeAnnotation> attributeAnnotations;
   std::vector<MethodAnnotation> methodAnnotations;
+  // Indices into the annotations by attribute and method name, so that
+  // looking up an annotation does not scan the class.
+  std::unordered_map<std::string, size_t> attributeIndices;
+  std::unordered_map<std::string, size_t> methodIndices;
 };
 
 // A map of annotations on `c10::ClassType` names
@@ -186,6 +197,9 @@ private:
   c10::ClassType *getClassAtPath(c10::ClassType *rootClassType,
                                  std::vector<std::string> path);
   ClassAnnotationMap classAnnotations;
+  // The annotations in `classAnnotations`, by class type, so that looking
+  // one up does not build the qualified name of the class.
+  std::unordered_map<c10::ClassType *, ClassAnnotation *> classTypeAnnotations;
   // Reverse mapping used to service getMethodAnnotationForFunction.
   std::unordered_map<torch::jit::Function *, MethodAnnotation *>
       functionToMethodMap;
@@ -9,6 +9,7 @@
 
 #include "function_importer.h"
 
+#include <sstream>
 #include <unordered_map>
 
 #include "mlir_utils.h"
@@ -74,3 +75,46 @@ MlirOperation torch_mlir::importJitFunctionAsFuncOp(
   mlirRegionAppendOwnedBlock(bodyRegion, block);
   return func;
 }
+
+/// Returns the functions referenced by `block` and its nested blocks, which
+/// are the `prim::Constant`s of function type feeding `prim::CallFunction`s.
+static void collectCallees(torch::jit::Block *block,
+                           std::vector<torch::jit::Function *> &callees) {
+  for (torch::jit::Node *node : block->nodes()) {
+    for (torch::jit::Block *nested : node->blocks()) {
+      collectCallees(nested, callees);
+    }
+    if (node->kind() != c10::prim::Constant || node->outputs().size() != 1) {
+      continue;
+    }
+    if (auto functionType = node->output()->type()->cast<c10::FunctionType>()) {
+      callees.push_back(functionType->function());
+    }
+  }
+}
+
+MlirOperation FunctionImportCache::importFunction(
+    torch::jit::Function *function,
+    std::function<MlirAttribute(int)> getArgAttribute,
+    const ImportOptions &importOptions) {
+  std::stringstream key;
+  key << function->qualname().qualifiedName() << ":" << function->getSchema();
+  auto it = importedFunctions.find(key.str());
+  if (it != importedFunctions.end()) {
+    return it->second;
+  }
+
+  MlirOperation func = importJitFunctionAsFuncOp(
+      context, function, std::move(getArgAttribute), importOptions);
+  importedFunctions.emplace(key.str(), func);
+  insertFunction(func);
+
+  std::vector<torch::jit::Function *> callees;
+  collectCallees(torch::jit::toGraphFunction(*function).graph()->block(),
+                 callees);
+  for (torch::jit::Function *callee : callees) {
+    importFunction(
+        callee, [](int) -> MlirAttribute { return {nullptr}; }, importOptions);
+  }
+  return func;
+}
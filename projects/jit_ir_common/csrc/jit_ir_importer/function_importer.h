@@ -11,6 +11,8 @@
 #define TORCHMLIRJITIRIMPORTER_CSRC_FUNCTION_IMPORTER_H
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 #include "import_options.h"
 #include "node_importer.h"
@@ -45,6 +47,34 @@ MlirOperation importJitFunctionAsFuncOp(
         [](int) -> MlirAttribute { return {nullptr}; },
     const ImportOptions &importOptions = {});
 
+/// Imports torch::jit::Function instances along with the functions that they
+/// reference, importing each of them only once.
+///
+/// Functions are keyed by their qualified name and schema, so that a function
+/// referenced from many call sites, or imported again, is imported once and
+/// then referenced by its symbol. Newly imported func ops are handed to
+/// `insertFunction`, callers before their callees.
+class FunctionImportCache {
+public:
+  FunctionImportCache(MlirContext context,
+                      std::function<void(MlirOperation)> insertFunction)
+      : context(context), insertFunction(std::move(insertFunction)) {}
+
+  /// Returns the func op of `function`, importing it and the functions it
+  /// references if they have not been imported yet. `getArgAttribute` is only
+  /// used for `function` itself, as in importJitFunctionAsFuncOp.
+  MlirOperation importFunction(
+      torch::jit::Function *function,
+      std::function<MlirAttribute(int)> getArgAttribute =
+          [](int) -> MlirAttribute { return {nullptr}; },
+      const ImportOptions &importOptions = {});
+
+private:
+  MlirContext context;
+  std::function<void(MlirOperation)> insertFunction;
+  std::unordered_map<std::string, MlirOperation> importedFunctions;
+};
+
 } // namespace torch_mlir
 
 #endif // TORCHMLIRJITIRIMPORTER_CSRC_FUNCTION_IMPORTER_H
@@ -10,6 +10,8 @@
 #ifndef TORCHMLIRJITIRIMPORTER_CSRC_IMPORT_OPTIONS_H
 #define TORCHMLIRJITIRIMPORTER_CSRC_IMPORT_OPTIONS_H
 
+#include <cstddef>
+
 namespace torch_mlir {
 // Common import options across importers. We define this as a struct to avoid
 // an unstructured proliferation of different kinds of ways to control different
@@ -33,6 +35,13 @@ struct ImportOptions {
   // In that case, the appropriate shape information is provided via the type
   // bound annotations on the function arguments instead.
   bool ignoreExistingTensorShapesAndDtypes = false;
+
+  // Tensors with at least this many bytes of data are imported as a
+  // DenseResourceElementsAttr that borrows the tensor's storage (keeping it
+  // alive for as long as the context holds the attribute) instead of being
+  // copied into a DenseElementsAttr. Smaller tensors stay inline, where they
+  // are readable and can be folded as splats.
+  size_t minResourceTensorNumBytes = 4096;
 };
 } // namespace torch_mlir
 
@@ -292,8 +292,15 @@ torch_mlir::getFunctionTypeFromSchema(MlirContext context,
                              outputTypes.size(), outputTypes.data());
 }
 
-MlirAttribute torch_mlir::convertTensorToMlirElementsAttr(at::Tensor tensor,
-                                                          MlirLocation loc) {
+// Holds the tensor whose storage backs a DenseResourceElementsAttr until the
+// context releases the blob.
+static void releaseTensorStorage(void *userData, const void *data, size_t size,
+                                 size_t align) {
+  delete static_cast<at::Tensor *>(userData);
+}
+
+MlirAttribute torch_mlir::convertTensorToMlirElementsAttr(
+    at::Tensor tensor, MlirLocation loc, const ImportOptions &importOptions) {
   using at::ScalarType;
 
   auto throwUnsupportedTensorError = [&]() {
@@ -326,11 +333,49 @@ MlirAttribute torch_mlir::convertTensorToMlirElementsAttr(at::Tensor tensor,
     throwUnsupportedTensorError();
   }
 
-  // Import DenseElementsAttr data.
-  // TODO: More import formats in C-API.
   auto numElements = tensor.numel();
   auto tensor_cpu = tensor.cpu().contiguous();
   auto tensorData = tensor_cpu.data_ptr();
+
+  // Borrow the storage of large tensors. Resources have no splat form, so
+  // single elements always stay inline. The layout of every scalar type
+  // imported below (including bool, which is one byte per element) matches
+  // what MLIR expects of dense resource data.
+  auto isSupportedScalarType = [](ScalarType type) {
+    switch (type) {
+    case ScalarType::Int:
+    case ScalarType::Long:
+    case ScalarType::Float:
+    case ScalarType::Double:
+    case ScalarType::Bool:
+    case ScalarType::QInt8:
+    case ScalarType::QUInt8:
+    case ScalarType::BFloat16:
+    case ScalarType::Half:
+    case ScalarType::Byte:
+    case ScalarType::Char:
+      return true;
+    default:
+      return false;
+    }
+  };
+  size_t numBytes = tensor_cpu.nbytes();
+  if (numElements > 1 && numBytes >= importOptions.minResourceTensorNumBytes &&
+      isSupportedScalarType(tensor.scalar_type())) {
+    std::stringstream blobName;
+    blobName << "torch_tensor";
+    for (int64_t dim : shape)
+      blobName << "_" << dim;
+    blobName << "_" << c10::toString(tensor.scalar_type());
+    std::string name = blobName.str();
+    return mlirUnmanagedDenseResourceElementsAttrGet(
+        shapedType, toMlirStringRef(name), tensorData, numBytes,
+        tensor_cpu.element_size(), /*dataIsMutable=*/false,
+        releaseTensorStorage, new at::Tensor(tensor_cpu));
+  }
+
+  // Import DenseElementsAttr data.
+  // TODO: More import formats in C-API.
   switch (tensor.scalar_type()) {
   case ScalarType::Int:
     return mlirDenseElementsAttrInt32Get(
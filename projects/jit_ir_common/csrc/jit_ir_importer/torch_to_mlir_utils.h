@@ -56,8 +56,12 @@ MlirType getFunctionTypeFromSchema(MlirContext context,
                                    const ImportOptions &importOptions = {});
 
 /// Creates an appropriate MlirAttribute that holds the same values as `tensor`.
-MlirAttribute convertTensorToMlirElementsAttr(at::Tensor tensor,
-                                              MlirLocation loc);
+/// Tensors of at least `importOptions.minResourceTensorNumBytes` bytes are
+/// imported without copying, as a DenseResourceElementsAttr that keeps the
+/// tensor's storage alive.
+MlirAttribute
+convertTensorToMlirElementsAttr(at::Tensor tensor, MlirLocation loc,
+                                const ImportOptions &importOptions = {});
 
 MlirAttribute importAttribute(MlirLocation loc, torch::jit::Node *node,
                               c10::Symbol symbol);
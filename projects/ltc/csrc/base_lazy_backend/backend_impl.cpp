@@ -10,42 +10,87 @@
 // https://github.com/pytorch/pytorch/blob/master/torch/csrc/lazy/ts_backend/ts_backend_impl.cpp
 //===----------------------------------------------------------------------===//
 
+#include <mutex>
+#include <unordered_map>
+
+#include <ATen/Context.h>
 #include <torch/csrc/lazy/backend/backend_data.h>
 #include <torch/csrc/lazy/backend/backend_device.h>
 #include <torch/csrc/lazy/backend/lowering_context.h>
+#include <torch/csrc/lazy/core/metrics.h>
 #include <torch/csrc/lazy/core/shape.h>
 
 #include "backend_impl.h"
 #include "ir_builder.h"
 #include "mlir_lowering_context.h"
 #include "ops/device_data.h"
+#include "shape_cache.h"
 #include "utils/debug.h"
 #include "utils/exception.h"
+#include "utils/sys_utils.h"
 
 namespace torch {
 namespace lazy {
 
+namespace {
+std::atomic<int64_t> num_live_data{0};
+std::atomic<int64_t> live_data_bytes{0};
+
+int64_t ShapeBytes(const Shape &shape) {
+  if (shape.scalar_type() == c10::ScalarType::Undefined)
+    return 0;
+  return shape.numel() * c10::elementSize(shape.scalar_type());
+}
+
+void TrackLiveData(const Shape &shape, int64_t delta) {
+  num_live_data += delta;
+  live_data_bytes += delta * ShapeBytes(shape);
+}
+
+using StreamMap =
+    std::unordered_map<std::string, std::unique_ptr<TorchMlirDeviceStream>>;
+
+// Returns the stream of `device` in `streams`, creating it if needed.
+TorchMlirDeviceStream *GetOrCreateStream(StreamMap &streams,
+                                         const BackendDevice &device) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<TorchMlirDeviceStream> &stream = streams[device.toString()];
+  if (!stream)
+    stream = std::make_unique<TorchMlirDeviceStream>();
+  return stream.get();
+}
+} // namespace
+
 TorchMlirBackendData::TorchMlirBackendData(BackendDevice device, Shape shape)
     : BackendData(device, shape),
       info_(std::make_shared<TorchMlirBackendData::Info>()) {
   PRINT_FUNCTION();
+  TrackLiveData(this->shape(), 1);
 }
 TorchMlirBackendData::TorchMlirBackendData(
     BackendDevice device, Shape shape, std::shared_ptr<BackendData::Info> info)
     : BackendData(device, shape), info_(info) {
   PRINT_FUNCTION();
+  TrackLiveData(this->shape(), 1);
 }
 TorchMlirBackendData::TorchMlirBackendData(const at::Scalar &scalar,
                                            BackendDevice device)
     : BackendData(device, Shape(scalar.type(), {})),
       info_(std::make_shared<TorchMlirBackendData::Info>(scalar)) {
   PRINT_FUNCTION();
+  TrackLiveData(this->shape(), 1);
 }
 TorchMlirBackendData::TorchMlirBackendData(const at::Tensor &tensor,
                                            BackendDevice device, Shape shape)
     : BackendData(device, shape),
       info_(std::make_shared<TorchMlirBackendData::Info>(tensor)) {
   PRINT_FUNCTION();
+  TrackLiveData(this->shape(), 1);
+}
+
+TorchMlirBackendData::~TorchMlirBackendData() {
+  TrackLiveData(this->shape(), -1);
 }
 
 BackendData::Handle TorchMlirBackendData::GetHandle() {
@@ -59,6 +104,7 @@ void TorchMlirBackendData::Assign(const BackendData &data) {
               "Invalid Backend Data Pointer. Expected TorchMlirBackendData.");
 
   info_ = torch_mlir_data->info_;
+  ready_ = torch_mlir_data->ready_;
 }
 
 bool TorchMlirBackendData::HasValue() const { return bool(info_); }
@@ -67,10 +113,31 @@ BackendData::Info *TorchMlirBackendData::mlir_info() const {
   return info_.get();
 }
 
+void TorchMlirBackendData::SetPending(std::shared_future<void> ready) {
+  ready_ = std::move(ready);
+}
+
+bool TorchMlirBackendData::IsReady() const {
+  return !ready_.valid() ||
+         ready_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void TorchMlirBackendData::Wait() const {
+  if (ready_.valid())
+    ready_.get();
+}
+
+void TorchMlirBackendData::Donate() { donated_ = true; }
+
+bool TorchMlirBackendData::IsDonated() const { return donated_; }
+
 /**
  * Initialization/Teardown
  * */
-void TorchMlirBackendImpl::PrepareToExit() const {}
+void TorchMlirBackendImpl::PrepareToExit() const {
+  for (const BackendDevice &device : GetBackendDevices())
+    SynchronizeDevice(device);
+}
 
 /**
  * IR Tracing
@@ -124,6 +191,7 @@ at::Tensor TorchMlirBackendImpl::MakeTensorFromComputationData(
       dynamic_cast<TorchMlirBackendData *>(data.get());
   TORCH_CHECK(torch_mlir_data,
               "Invalid Backend Data Pointer. Expected TorchMlirBackendData.");
+  torch_mlir_data->Wait();
 
   TorchMlirBackendData::Info *info =
       dynamic_cast<TorchMlirBackendData::Info *>(torch_mlir_data->mlir_info());
@@ -134,6 +202,97 @@ at::Tensor TorchMlirBackendImpl::MakeTensorFromComputationData(
   return info->tensor;
 }
 
+BackendDataPtr
+TorchMlirBackendImpl::TransferToDeviceAsync(const at::Tensor &tensor,
+                                            const BackendDevice &device) const {
+  PRINT_FUNCTION();
+  Shape shape(tensor.scalar_type(), tensor.sizes().vec());
+  TorchMlirHostBufferPool *pool = GetHostBufferPool();
+  at::Tensor staging;
+  if (pool) {
+    staging = pool->Acquire(shape);
+    staging.copy_(tensor);
+  } else {
+    staging = tensor.to(at::kCPU, tensor.scalar_type(), /*non_blocking=*/false,
+                        /*copy=*/true, at::MemoryFormat::Contiguous);
+  }
+
+  auto data = std::make_shared<TorchMlirBackendData>(device, shape);
+  auto *info = dynamic_cast<TorchMlirBackendData::Info *>(data->mlir_info());
+  info->requires_grad = tensor.requires_grad();
+  auto copy = [this, staging, data, pool]() {
+    CopyToDevice(staging, *data);
+    if (pool)
+      pool->Release(staging);
+  };
+
+  TorchMlirDeviceStream *stream = GetTransferStream(device);
+  if (!stream) {
+    copy();
+    return data;
+  }
+  auto done = std::make_shared<std::promise<void>>();
+  data->SetPending(done->get_future().share());
+  stream->Schedule([copy, done]() {
+    try {
+      copy();
+      done->set_value();
+    } catch (...) {
+      done->set_exception(std::current_exception());
+    }
+  });
+  return data;
+}
+
+std::shared_future<at::Tensor> TorchMlirBackendImpl::TransferFromDeviceAsync(
+    const BackendDataPtr &data) const {
+  PRINT_FUNCTION();
+  TORCH_CHECK(dynamic_cast<TorchMlirBackendData *>(data.get()),
+              "Invalid Backend Data Pointer. Expected TorchMlirBackendData.");
+  auto done = std::make_shared<std::promise<at::Tensor>>();
+  std::shared_future<at::Tensor> result = done->get_future().share();
+  auto copy = [this, data, done]() {
+    try {
+      auto &torch_mlir_data = static_cast<TorchMlirBackendData &>(*data);
+      torch_mlir_data.Wait();
+      done->set_value(CopyFromDevice(torch_mlir_data));
+    } catch (...) {
+      done->set_exception(std::current_exception());
+    }
+  };
+
+  if (TorchMlirDeviceStream *stream = GetTransferStream(data->device()))
+    stream->Schedule(copy);
+  else
+    copy();
+  return result;
+}
+
+void TorchMlirBackendImpl::CopyToDevice(const at::Tensor &staging,
+                                        TorchMlirBackendData &data) const {
+  auto *info = dynamic_cast<TorchMlirBackendData::Info *>(data.mlir_info());
+  TORCH_CHECK(info, "Expected TorchMlirBackendData::Info");
+  info->tensor = staging.clone();
+}
+
+at::Tensor
+TorchMlirBackendImpl::CopyFromDevice(const TorchMlirBackendData &data) const {
+  auto *info = dynamic_cast<TorchMlirBackendData::Info *>(data.mlir_info());
+  TORCH_CHECK(info, "Expected TorchMlirBackendData::Info");
+  return info->tensor;
+}
+
+TorchMlirHostBufferPool *TorchMlirBackendImpl::GetHostBufferPool() const {
+  static TorchMlirHostBufferPool *pool = []() {
+    int64_t bytes =
+        sys_util::GetEnv<int64_t>("LTC_HOST_BUFFER_POOL_BYTES", 256 << 20);
+    if (bytes <= 0)
+      return static_cast<TorchMlirHostBufferPool *>(nullptr);
+    return new TorchMlirHostBufferPool(bytes, at::hasCUDA());
+  }();
+  return pool;
+}
+
 /**
  * Lowering, Compilation, Execution
  * */
@@ -157,6 +316,166 @@ TorchMlirBackendImpl::CreateLoweringContext(const std::string &name,
       name, std::forward<BackendDevice>(device));
 }
 
+TorchMlirComputationCache *TorchMlirBackendImpl::GetComputationCache() const {
+  static TorchMlirComputationCache *cache = []() {
+    int size = sys_util::GetEnv<int>("LTC_COMPUTATION_CACHE_SIZE", 0);
+    std::string dir = sys_util::GetEnvString("LTC_COMPUTATION_CACHE_DIR", "");
+    if (size <= 0 && dir.empty())
+      return static_cast<TorchMlirComputationCache *>(nullptr);
+    return new TorchMlirComputationCache(size > 0 ? size : 1024, dir);
+  }();
+  return cache;
+}
+
+bool TorchMlirBackendImpl::CaptureEagerFallback(
+    const c10::OperatorHandle &op) const {
+  static const bool capture =
+      sys_util::GetEnvBool("LTC_CAPTURE_FALLBACKS", false);
+  return capture;
+}
+
+std::vector<BackendDataPtr> TorchMlirBackendImpl::ExecuteComputation(
+    ComputationPtr computation, c10::ArrayRef<BackendDataPtr> arguments,
+    const BackendDevice &device) const {
+  PRINT_FUNCTION();
+
+  TorchMlirDeviceStream *stream = GetDeviceStream(device);
+  auto *mlir_computation =
+      dynamic_cast<TorchMlirComputation *>(computation.get());
+  // Pending results need their shapes up front.
+  if (!stream || !mlir_computation ||
+      mlir_computation->result_shapes().size() !=
+          mlir_computation->graph()->outputs().size()) {
+    for (const BackendDataPtr &argument : arguments)
+      static_cast<TorchMlirBackendData &>(*argument).Wait();
+    return ExecuteComputationSync(computation, arguments, device);
+  }
+
+  auto done = std::make_shared<std::promise<void>>();
+  std::shared_future<void> ready = done->get_future().share();
+  std::vector<BackendDataPtr> results;
+  results.reserve(mlir_computation->result_shapes().size());
+  for (const Shape &shape : mlir_computation->result_shapes()) {
+    auto result = std::make_shared<TorchMlirBackendData>(device, shape);
+    result->SetPending(ready);
+    results.push_back(std::move(result));
+  }
+
+  // The task only fills in the tensors of the pending results' infos, which
+  // are shared with any data they are assigned to, so tracing can keep using
+  // their names and shapes in the meantime.
+  std::vector<BackendDataPtr> args(arguments.begin(), arguments.end());
+  stream->Schedule([this, computation, args, results, device, done]() {
+    try {
+      for (const BackendDataPtr &argument : args)
+        static_cast<TorchMlirBackendData &>(*argument).Wait();
+      std::vector<BackendDataPtr> values =
+          ExecuteComputationSync(computation, args, device);
+      TORCH_CHECK(values.size() == results.size(), "Expected ",
+                  results.size(), " results from the computation, got ",
+                  values.size());
+      for (size_t i = 0; i < results.size(); ++i) {
+        auto &value = static_cast<TorchMlirBackendData &>(*values[i]);
+        auto *value_info =
+            dynamic_cast<TorchMlirBackendData::Info *>(value.mlir_info());
+        auto *result_info = dynamic_cast<TorchMlirBackendData::Info *>(
+            static_cast<TorchMlirBackendData &>(*results[i]).mlir_info());
+        TORCH_CHECK(value_info && result_info,
+                    "Expected TorchMlirBackendData::Info");
+        result_info->tensor = value_info->tensor;
+        result_info->requires_grad = value_info->requires_grad;
+      }
+      done->set_value();
+    } catch (...) {
+      done->set_exception(std::current_exception());
+    }
+  });
+  return results;
+}
+
+TorchMlirDeviceStream *
+TorchMlirBackendImpl::GetDeviceStream(const BackendDevice &device) const {
+  static const bool enabled =
+      sys_util::GetEnvBool("LTC_ASYNC_EXECUTION", false);
+  if (!enabled)
+    return nullptr;
+
+  static auto *streams = new StreamMap();
+  return GetOrCreateStream(*streams, device);
+}
+
+TorchMlirDeviceStream *
+TorchMlirBackendImpl::GetTransferStream(const BackendDevice &device) const {
+  static const bool enabled =
+      sys_util::GetEnvBool("LTC_ASYNC_EXECUTION", false);
+  if (!enabled)
+    return nullptr;
+
+  static auto *streams = new StreamMap();
+  return GetOrCreateStream(*streams, device);
+}
+
+void TorchMlirBackendImpl::SynchronizeDevice(
+    const BackendDevice &device) const {
+  if (TorchMlirDeviceStream *stream = GetTransferStream(device))
+    stream->Synchronize();
+  if (TorchMlirDeviceStream *stream = GetDeviceStream(device))
+    stream->Synchronize();
+}
+
+/**
+ * Debug/Metrics
+ * */
+
+std::map<std::string, double> TorchMlirBackendImpl::GetMetrics() const {
+  std::map<std::string, double> metrics;
+  for (const char *name :
+       {"TorchMlirLowerNodes", "TorchMlirBuild", "TorchMlirLoweredNodes",
+        "TorchMlirModuleOperations"}) {
+    if (MetricData *data = GetMetric(name)) {
+      metrics[std::string(name) + ".Samples"] = data->TotalSamples();
+      metrics[std::string(name) + ".Sum"] = data->Accumulator();
+    }
+  }
+
+  if (TorchMlirComputationCache *cache = GetComputationCache()) {
+    TorchMlirComputationCache::Metrics cache_metrics = cache->GetMetrics();
+    metrics["ComputationCacheHits"] = cache_metrics.hits;
+    metrics["ComputationCacheDiskHits"] = cache_metrics.disk_hits;
+    metrics["ComputationCacheMisses"] = cache_metrics.misses;
+  }
+
+  if (TorchMlirHostBufferPool *pool = GetHostBufferPool()) {
+    TorchMlirHostBufferPool::Stats stats = pool->GetStats();
+    metrics["HostBufferPoolHits"] = stats.hits;
+    metrics["HostBufferPoolMisses"] = stats.misses;
+    metrics["HostBufferPoolCachedBytes"] = stats.cached_bytes;
+  }
+
+  if (ShapeCache *shape_cache = GetShapeCache()) {
+    ShapeCache::Stats stats = shape_cache->GetStats();
+    metrics["ShapeCacheHits"] = stats.hits;
+    metrics["ShapeCacheMisses"] = stats.misses;
+  }
+
+  MemoryInfo memory = GetMemoryInfo();
+  metrics["LiveData"] = memory.num_live_data;
+  metrics["LiveDataBytes"] = memory.live_data_bytes;
+  return metrics;
+}
+
+TorchMlirBackendImpl::MemoryInfo TorchMlirBackendImpl::GetMemoryInfo() const {
+  MemoryInfo memory;
+  memory.num_live_data = num_live_data;
+  memory.live_data_bytes = live_data_bytes;
+  return memory;
+}
+
+std::string TorchMlirBackendImpl::GetComputationBackendText(
+    const ComputationPtr computation) const {
+  return computation->to_string();
+}
+
 /**
  * Device Configuration
  * */
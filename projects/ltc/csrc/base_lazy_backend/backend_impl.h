@@ -15,14 +15,22 @@
 
 #pragma once
 
+#include <atomic>
+#include <future>
+#include <map>
 #include <memory>
 #include <sstream>
 
+#include <ATen/core/dispatch/Dispatcher.h>
 #include <torch/csrc/lazy/backend/backend_data.h>
 #include <torch/csrc/lazy/backend/backend_device.h>
 #include <torch/csrc/lazy/backend/backend_interface.h>
 #include <torch/csrc/lazy/core/shape.h>
 
+#include "computation_cache.h"
+#include "device_stream.h"
+#include "host_buffer_pool.h"
+
 namespace torch {
 namespace lazy {
 
@@ -35,11 +43,11 @@ public:
     std::string name;
 
     Info() {
-      static int i = 0;
+      // Results of asynchronous executions are created on device streams.
+      static std::atomic<int> i{0};
       std::stringstream ss;
-      ss << "placeholder" << i;
+      ss << "placeholder" << i++;
       name = ss.str();
-      ++i;
     }
     Info(const Info &other)
         : tensor{other.tensor}, scalar{other.scalar},
@@ -55,6 +63,7 @@ public:
   TorchMlirBackendData(const at::Scalar &scalar, BackendDevice device);
   TorchMlirBackendData(const at::Tensor &tensor, BackendDevice device,
                        Shape shape);
+  virtual ~TorchMlirBackendData();
 
   virtual BackendData::Handle GetHandle() override;
 
@@ -62,10 +71,33 @@ public:
 
   virtual bool HasValue() const override;
 
+  // The name and scalar of the info are always available. When the data is
+  // the pending result of an asynchronous execution, its tensor is only
+  // valid after Wait() returns.
   BackendData::Info *mlir_info() const;
 
+  // Marks this data as the result of an execution that completes when `ready`
+  // becomes ready.
+  void SetPending(std::shared_future<void> ready);
+
+  // Returns true if the tensor is available without blocking.
+  bool IsReady() const;
+
+  // Blocks until the execution producing this data has finished, rethrowing
+  // any error it raised.
+  void Wait() const;
+
+  // Donates the buffer of this data to the next execution that takes it as an
+  // argument: ExecuteComputationSync may write a result into it rather than
+  // allocate one. The data must not be read once it is donated.
+  void Donate();
+
+  bool IsDonated() const;
+
 protected:
   std::shared_ptr<BackendData::Info> info_;
+  std::shared_future<void> ready_;
+  bool donated_ = false;
 };
 
 class TORCH_API TorchMlirBackendImpl : public BackendImplInterface {
@@ -92,6 +124,8 @@ public:
    * Data Transfer
    * */
 
+  // Makes data that aliases `tensor`, without copying it, so `tensor` must
+  // not be modified while the data is alive.
   virtual BackendDataPtr
   MakeComputationDataFromTensor(const at::Tensor &tensor, const Shape &shape,
                                 const BackendDevice &device) const override;
@@ -113,6 +147,36 @@ public:
       const BackendDataPtr data,
       std::optional<at::ScalarType> logical_scalar_type) const override;
 
+  // Copies `tensor` to `device`. The tensor is copied into a staging buffer
+  // from GetHostBufferPool before this returns, so it may be modified
+  // afterwards, and CopyToDevice runs on the transfer stream of `device`, if
+  // any, so that feeding the next step overlaps with executing this one. The
+  // returned data is pending until the copy has finished.
+  BackendDataPtr TransferToDeviceAsync(const at::Tensor &tensor,
+                                       const BackendDevice &device) const;
+
+  // Copies `data` to the host once it is ready, through CopyFromDevice on the
+  // transfer stream of its device, if any.
+  std::shared_future<at::Tensor>
+  TransferFromDeviceAsync(const BackendDataPtr &data) const;
+
+  // Copies the host tensor `staging` into `data`, which it is the value of.
+  // `staging` goes back to the host buffer pool once this returns. By
+  // default, the data holds a copy of `staging`, as device data lives on the
+  // host for the reference backend.
+  virtual void CopyToDevice(const at::Tensor &staging,
+                            TorchMlirBackendData &data) const;
+
+  // Returns the value of the ready `data` as a host tensor. By default, this
+  // is the tensor that the data holds.
+  virtual at::Tensor CopyFromDevice(const TorchMlirBackendData &data) const;
+
+  // Returns the pool of host buffers that stage transfers, or nullptr to
+  // stage them in fresh tensors. By default, a pool of
+  // LTC_HOST_BUFFER_POOL_BYTES (256 MiB if unset, 0 disables it) is used,
+  // whose buffers are pinned if CUDA is available.
+  virtual TorchMlirHostBufferPool *GetHostBufferPool() const;
+
   /**
    * Lowering, Compilation, Execution
    * */
@@ -126,6 +190,22 @@ public:
   CreateLoweringContext(const std::string &name,
                         BackendDevice device) const override;
 
+  // Returns the cache that `Compile` should consult before compiling a
+  // computation, or nullptr if computations are not cached. Vendor backends
+  // may override this to plug in their own cache. By default, a process-wide
+  // cache is enabled with the LTC_COMPUTATION_CACHE_SIZE (in-memory entries)
+  // and LTC_COMPUTATION_CACHE_DIR (persistent artifacts) environment
+  // variables.
+  virtual TorchMlirComputationCache *GetComputationCache() const;
+
+  // Returns whether calls to `op`, which has no lazy kernel, are captured in
+  // the traced graph instead of breaking it to run eagerly (see
+  // mlir_eager_fallback.h). Captured calls are lowered to their torch op, or
+  // to a `torch.operator` for ops unknown to torch-mlir, which the backend
+  // executes as a host callback with RunHostCallback. By default, all calls
+  // that can be captured are when LTC_CAPTURE_FALLBACKS is set.
+  virtual bool CaptureEagerFallback(const c10::OperatorHandle &op) const;
+
   // TODO(whc) need to keep this?
   // virtual std::vector<std::string> GetCompilationDevices(
   //     const std::string& device, c10::ArrayRef<std::string> devices
@@ -135,11 +215,40 @@ public:
   //     std::vector<ComputationPtr> instances
   // ) const = 0;
 
-  // virtual std::vector<BackendDataPtr> ExecuteComputation(
-  //     Computation& computation,
-  //     c10::ArrayRef<BackendDataPtr> arguments,
-  //     const BackendDevice& device
-  // ) const = 0;
+  // Runs `computation` through ExecuteComputationSync. If `device` has a
+  // stream (see GetDeviceStream), the execution is queued on it and pending
+  // results are returned immediately, so that the next step can be traced and
+  // compiled while this one executes. MakeTensorFromComputationData waits for
+  // pending results.
+  virtual std::vector<BackendDataPtr>
+  ExecuteComputation(ComputationPtr computation,
+                     c10::ArrayRef<BackendDataPtr> arguments,
+                     const BackendDevice &device) const override;
+
+  // Executes `computation` on the calling thread and returns its results.
+  // Vendor backends implement this rather than ExecuteComputation to get
+  // asynchronous execution. Arguments are ready when this is called.
+  virtual std::vector<BackendDataPtr>
+  ExecuteComputationSync(ComputationPtr computation,
+                         c10::ArrayRef<BackendDataPtr> arguments,
+                         const BackendDevice &device) const = 0;
+
+  // Returns the stream that executions on `device` are queued on, or nullptr
+  // to execute synchronously. By default, each device gets a stream when the
+  // LTC_ASYNC_EXECUTION environment variable is set.
+  virtual TorchMlirDeviceStream *
+  GetDeviceStream(const BackendDevice &device) const;
+
+  // Returns the stream that transfers to and from `device` are queued on,
+  // which is separate from its execution stream, or nullptr to transfer
+  // synchronously. By default, each device gets one when the
+  // LTC_ASYNC_EXECUTION environment variable is set.
+  virtual TorchMlirDeviceStream *
+  GetTransferStream(const BackendDevice &device) const;
+
+  // Blocks until all executions and transfers queued on `device` have
+  // finished.
+  void SynchronizeDevice(const BackendDevice &device) const;
 
   /**
    * Device Configuration
@@ -177,13 +286,24 @@ public:
    * Debug/Metrics
    * */
 
-  // virtual std::map<std::string, Metric> GetMetrics() const = 0;
+  // Returns a snapshot of the backend's metrics, keyed by name, including
+  // the computation and shape cache statistics. Timings are in nanoseconds.
+  // Lowering metrics report the number of samples (graphs) and their sum, as
+  // `<name>.Samples` and `<name>.Sum`.
+  virtual std::map<std::string, double> GetMetrics() const;
+
+  struct MemoryInfo {
+    // Number of live TorchMlirBackendData, including placeholders.
+    int64_t num_live_data = 0;
+    // Bytes described by the shapes of the live TorchMlirBackendData.
+    int64_t live_data_bytes = 0;
+  };
 
-  // virtual MemoryInfo GetMemoryInfo(const std::string& device) = 0;
+  // Returns the device data held by the backend, summed over all devices.
+  virtual MemoryInfo GetMemoryInfo() const;
 
-  // virtual std::string GetComputationBackendText(
-  //     const ComputationPtr computation
-  // ) const = 0;
+  virtual std::string
+  GetComputationBackendText(const ComputationPtr computation) const override;
 
 protected:
   int64_t default_device_ordinal = 0;
@@ -0,0 +1,106 @@
+//===- computation_cache.cpp ----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include "computation_cache.h"
+
+namespace fs = std::filesystem;
+
+namespace torch {
+namespace lazy {
+
+TorchMlirComputationCache::TorchMlirComputationCache(size_t max_size,
+                                                     std::string cache_dir)
+    : computations_(max_size), cache_dir_(std::move(cache_dir)) {
+  if (!cache_dir_.empty()) {
+    std::error_code ec;
+    fs::create_directories(cache_dir_, ec);
+  }
+}
+
+ComputationPtr TorchMlirComputationCache::Get(const hash_t &key) {
+  ComputationPtr computation = computations_.Get(key);
+  if (computation) {
+    ++hits_;
+    TORCH_LAZY_COUNTER("TorchMlirComputationCacheHit", 1);
+  }
+  return computation;
+}
+
+void TorchMlirComputationCache::Add(const hash_t &key,
+                                    ComputationPtr computation) {
+  computations_.Add(key, std::move(computation));
+}
+
+std::optional<std::string>
+TorchMlirComputationCache::LoadArtifact(const hash_t &key) {
+  if (!cache_dir_.empty()) {
+    std::ifstream stream(ArtifactPath(key), std::ios::in | std::ios::binary);
+    if (stream) {
+      std::stringstream artifact;
+      artifact << stream.rdbuf();
+      if (stream.good() || stream.eof()) {
+        ++disk_hits_;
+        TORCH_LAZY_COUNTER("TorchMlirComputationCacheDiskHit", 1);
+        return artifact.str();
+      }
+    }
+  }
+  ++misses_;
+  TORCH_LAZY_COUNTER("TorchMlirComputationCacheMiss", 1);
+  return std::nullopt;
+}
+
+void TorchMlirComputationCache::StoreArtifact(const hash_t &key,
+                                              const std::string &artifact) {
+  if (cache_dir_.empty())
+    return;
+  // Write to a unique temporary file and rename it into place, so that
+  // concurrent processes never observe a partially written artifact.
+  std::string path = ArtifactPath(key);
+  std::stringstream temp_path;
+  temp_path << path << ".tmp." << getpid() << "."
+            << std::this_thread::get_id();
+  {
+    std::ofstream stream(temp_path.str(), std::ios::out | std::ios::binary);
+    if (!stream)
+      return;
+    stream.write(artifact.data(), artifact.size());
+    if (!stream)
+      return;
+  }
+  std::error_code ec;
+  fs::rename(temp_path.str(), path, ec);
+  if (ec)
+    fs::remove(temp_path.str(), ec);
+}
+
+TorchMlirComputationCache::Metrics
+TorchMlirComputationCache::GetMetrics() const {
+  Metrics metrics;
+  metrics.hits = hits_;
+  metrics.disk_hits = disk_hits_;
+  metrics.misses = misses_;
+  return metrics;
+}
+
+std::string TorchMlirComputationCache::ArtifactPath(const hash_t &key) const {
+  return (fs::path(cache_dir_) / (HashToString(key) + ".bin")).string();
+}
+
+} // namespace lazy
+} // namespace torch
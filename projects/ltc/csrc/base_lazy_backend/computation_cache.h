@@ -0,0 +1,70 @@
+//===- computation_cache.h ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+// A cache of compiled computations, keyed by the hash of the lowered node DAG
+// (including shapes and results), for backends to skip recompilation.
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <string>
+
+#include <torch/csrc/lazy/backend/lowering_context.h>
+#include <torch/csrc/lazy/core/cache.h>
+#include <torch/csrc/lazy/core/hash.h>
+
+namespace torch {
+namespace lazy {
+
+class TORCH_API TorchMlirComputationCache {
+public:
+  struct Metrics {
+    // Lookups served by a computation compiled in this process.
+    int64_t hits = 0;
+    // Lookups served by an artifact stored on disk.
+    int64_t disk_hits = 0;
+    // Lookups that required compilation.
+    int64_t misses = 0;
+  };
+
+  // Keeps up to `max_size` computations in memory. If `cache_dir` is not
+  // empty, compiled artifacts are also stored there so that they outlive the
+  // process.
+  TorchMlirComputationCache(size_t max_size, std::string cache_dir);
+
+  // Returns the computation added for `key` in this process, or nullptr.
+  ComputationPtr Get(const hash_t &key);
+
+  void Add(const hash_t &key, ComputationPtr computation);
+
+  // Returns the artifact stored for `key` by this or an earlier process.
+  // Backends should call this after a `Get` miss, before compiling.
+  std::optional<std::string> LoadArtifact(const hash_t &key);
+
+  // Stores the compiled artifact for `key`. Failures to write are ignored,
+  // as the cache is only an optimization.
+  void StoreArtifact(const hash_t &key, const std::string &artifact);
+
+  Metrics GetMetrics() const;
+
+  const std::string &cache_dir() const { return cache_dir_; }
+
+private:
+  std::string ArtifactPath(const hash_t &key) const;
+
+  Cache<hash_t, Computation, HashReducer> computations_;
+  std::string cache_dir_;
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> disk_hits_{0};
+  std::atomic<int64_t> misses_{0};
+};
+
+} // namespace lazy
+} // namespace torch
@@ -0,0 +1,63 @@
+//===- device_stream.cpp --------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "device_stream.h"
+
+namespace torch {
+namespace lazy {
+
+TorchMlirDeviceStream::TorchMlirDeviceStream()
+    : thread_([this]() { Run(); }) {}
+
+TorchMlirDeviceStream::~TorchMlirDeviceStream() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_cv_.notify_one();
+  thread_.join();
+}
+
+void TorchMlirDeviceStream::Schedule(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(task));
+    ++num_pending_;
+  }
+  work_cv_.notify_one();
+}
+
+void TorchMlirDeviceStream::Synchronize() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this]() { return num_pending_ == 0; });
+}
+
+void TorchMlirDeviceStream::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+    if (queue_.empty())
+      return;
+    std::function<void()> task = std::move(queue_.front());
+    queue_.pop_front();
+
+    lock.unlock();
+    try {
+      task();
+    } catch (...) {
+    }
+    lock.lock();
+
+    if (--num_pending_ == 0)
+      idle_cv_.notify_all();
+  }
+}
+
+} // namespace lazy
+} // namespace torch
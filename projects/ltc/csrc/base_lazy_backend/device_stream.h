@@ -0,0 +1,57 @@
+//===- device_stream.h ----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+// An in-order queue of work for a single backend device, executed on a
+// dedicated thread so that tracing can run ahead of execution.
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <c10/macros/Export.h>
+
+namespace torch {
+namespace lazy {
+
+class TORCH_API TorchMlirDeviceStream {
+public:
+  TorchMlirDeviceStream();
+  // Runs all scheduled work before returning.
+  ~TorchMlirDeviceStream();
+
+  TorchMlirDeviceStream(const TorchMlirDeviceStream &) = delete;
+  TorchMlirDeviceStream &operator=(const TorchMlirDeviceStream &) = delete;
+
+  // Enqueues `task`. Tasks run one at a time, in the order they were
+  // scheduled. Tasks are expected to report their own errors (e.g. through a
+  // promise); exceptions escaping a task are dropped.
+  void Schedule(std::function<void()> task);
+
+  // Blocks until every task scheduled so far has run.
+  void Synchronize();
+
+private:
+  void Run();
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable idle_cv_;
+  std::deque<std::function<void()>> queue_;
+  // Number of tasks that are queued or running.
+  size_t num_pending_ = 0;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+} // namespace lazy
+} // namespace torch
@@ -10,7 +10,11 @@
 // https://github.com/pytorch/pytorch/blob/master/torch/csrc/lazy/ts_backend/dynamic_ir.cpp
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <sstream>
+
 #include "dynamic_ir.h"
+#include "utils/sys_utils.h"
 
 namespace torch {
 namespace lazy {
@@ -71,5 +75,90 @@ int64_t SizeDiv::getStaticValue() const {
 
 std::string SizeDiv::ToString() const { return "SizeDiv"; }
 
+DynamicShapePolicy::DynamicShapePolicy(std::set<size_t> dynamic_dims,
+                                       std::vector<int64_t> bucket_bounds)
+    : dynamic_dims_(std::move(dynamic_dims)),
+      bucket_bounds_(std::move(bucket_bounds)) {
+  TORCH_CHECK(std::is_sorted(bucket_bounds_.begin(), bucket_bounds_.end()),
+              "Dynamic dim bucket bounds must be ascending");
+}
+
+bool DynamicShapePolicy::IsDynamicDim(const Shape &shape, size_t dim) const {
+  if (!enableDynamicShape())
+    return false;
+  if (shape.is_symbolic() && shape.is_symbolic()->at(dim))
+    return true;
+  return dynamic_dims_.count(dim);
+}
+
+int64_t DynamicShapePolicy::GetBucket(int64_t size) const {
+  auto bound =
+      std::lower_bound(bucket_bounds_.begin(), bucket_bounds_.end(), size);
+  if (bound != bucket_bounds_.end())
+    return *bound;
+  int64_t bucket = 1;
+  while (bucket < size)
+    bucket <<= 1;
+  return bucket;
+}
+
+c10::VaryingShape<int64_t>
+DynamicShapePolicy::GetLoweredSizes(const Shape &shape) const {
+  std::vector<std::optional<int64_t>> sizes;
+  sizes.reserve(shape.dim());
+  for (size_t i = 0, e = shape.dim(); i < e; ++i) {
+    if (IsDynamicDim(shape, i))
+      sizes.push_back(std::nullopt);
+    else
+      sizes.push_back(shape.size(i));
+  }
+  return c10::VaryingShape<int64_t>(sizes);
+}
+
+hash_t DynamicShapePolicy::ShapeHash(const Shape &shape) const {
+  hash_t hash = HashCombine(Hash(shape.scalar_type()), Hash(shape.dim()));
+  for (size_t i = 0, e = shape.dim(); i < e; ++i) {
+    int64_t size = shape.size(i);
+    hash_t dim_hash = IsDynamicDim(shape, i)
+                          ? HashCombine(Hash(true), Hash(GetBucket(size)))
+                          : Hash(size);
+    hash = HashCombine(hash, dim_hash);
+  }
+  return hash;
+}
+
+namespace {
+template <typename T> std::vector<T> ParseList(const std::string &list) {
+  std::vector<T> values;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    if (!item.empty())
+      values.push_back(static_cast<T>(std::stoll(item)));
+  return values;
+}
+
+std::unique_ptr<DynamicShapePolicy> &DynamicShapePolicyInstance() {
+  static std::unique_ptr<DynamicShapePolicy> policy = []() {
+    std::vector<size_t> dims =
+        ParseList<size_t>(sys_util::GetEnvString("LTC_DYNAMIC_DIMS", ""));
+    return std::make_unique<DynamicShapePolicy>(
+        std::set<size_t>(dims.begin(), dims.end()),
+        ParseList<int64_t>(
+            sys_util::GetEnvString("LTC_DYNAMIC_DIM_BUCKETS", "")));
+  }();
+  return policy;
+}
+} // namespace
+
+const DynamicShapePolicy &GetDynamicShapePolicy() {
+  return *DynamicShapePolicyInstance();
+}
+
+void SetDynamicShapePolicy(std::unique_ptr<DynamicShapePolicy> policy) {
+  TORCH_CHECK(policy, "Expected a dynamic shape policy");
+  DynamicShapePolicyInstance() = std::move(policy);
+}
+
 } // namespace lazy
 } // namespace torch
@@ -95,5 +95,48 @@ public:
   std::string ToString() const override;
 };
 
+/**
+ * When dynamic shapes are enabled (--ltc_enable_dynamic_shapes), the
+ * DynamicShapePolicy decides which dims are lowered as `?` in the emitted
+ * `!torch.vtensor` types. Node hashes then only include the bucket of those
+ * dims rather than their size, so one computation serves every shape whose
+ * dynamic dims fall into the same buckets.
+ *
+ * A dim is dynamic if it is marked symbolic in its Shape, or if its index is
+ * one of `dynamic_dims`. The default policy is configured with the
+ * LTC_DYNAMIC_DIMS (e.g. "0,1") and LTC_DYNAMIC_DIM_BUCKETS (ascending
+ * upper bounds, e.g. "128,512,2048") environment variables.
+ */
+class TORCH_API DynamicShapePolicy {
+public:
+  // Sizes are mapped to the first of `bucket_bounds` they do not exceed.
+  // Sizes above the last bound, or all sizes if there are no bounds, are
+  // rounded up to the next power of two.
+  DynamicShapePolicy(std::set<size_t> dynamic_dims,
+                     std::vector<int64_t> bucket_bounds);
+  virtual ~DynamicShapePolicy() = default;
+
+  virtual bool IsDynamicDim(const Shape &shape, size_t dim) const;
+
+  virtual int64_t GetBucket(int64_t size) const;
+
+  // Returns the sizes to emit for `shape`, with dynamic dims left unknown.
+  c10::VaryingShape<int64_t> GetLoweredSizes(const Shape &shape) const;
+
+  // Returns the hash of `shape` with dynamic dims replaced by their buckets.
+  hash_t ShapeHash(const Shape &shape) const;
+
+protected:
+  std::set<size_t> dynamic_dims_;
+  std::vector<int64_t> bucket_bounds_;
+};
+
+TORCH_API const DynamicShapePolicy &GetDynamicShapePolicy();
+
+// Replaces the policy used for lowering. Must be called before any tensor is
+// traced.
+TORCH_API void
+SetDynamicShapePolicy(std::unique_ptr<DynamicShapePolicy> policy);
+
 } // namespace lazy
 } // namespace torch
@@ -0,0 +1,58 @@
+//===- host_buffer_pool.cpp -----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <ATen/ATen.h>
+
+#include "host_buffer_pool.h"
+
+namespace torch {
+namespace lazy {
+
+TorchMlirHostBufferPool::TorchMlirHostBufferPool(int64_t max_cached_bytes,
+                                                 bool pinned)
+    : max_cached_bytes_(max_cached_bytes), pinned_(pinned) {}
+
+at::Tensor TorchMlirHostBufferPool::Acquire(const Shape &shape) {
+  int64_t bytes = shape.numel() * c10::elementSize(shape.scalar_type());
+  at::Tensor buffer;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = free_buffers_.find(bytes);
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      buffer = std::move(it->second.back());
+      it->second.pop_back();
+      stats_.cached_bytes -= bytes;
+      ++stats_.hits;
+    } else {
+      ++stats_.misses;
+    }
+  }
+  if (!buffer.defined())
+    buffer = at::empty(
+        {bytes}, at::TensorOptions().dtype(at::kByte).pinned_memory(pinned_));
+  return buffer.view(shape.scalar_type()).view(shape.sizes());
+}
+
+void TorchMlirHostBufferPool::Release(const at::Tensor &tensor) {
+  at::Tensor buffer = tensor.reshape({-1}).view(at::kByte);
+  int64_t bytes = buffer.numel();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stats_.cached_bytes + bytes > max_cached_bytes_)
+    return;
+  free_buffers_[bytes].push_back(std::move(buffer));
+  stats_.cached_bytes += bytes;
+}
+
+TorchMlirHostBufferPool::Stats TorchMlirHostBufferPool::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+} // namespace lazy
+} // namespace torch
@@ -0,0 +1,59 @@
+//===- host_buffer_pool.h -------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+// A pool of host buffers that stage transfers between host tensors and device
+// data, reused by size so that steady-state steps do not allocate.
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <ATen/Tensor.h>
+#include <torch/csrc/lazy/core/shape.h>
+
+namespace torch {
+namespace lazy {
+
+class TORCH_API TorchMlirHostBufferPool {
+public:
+  struct Stats {
+    // Acquires served by a released buffer.
+    int64_t hits = 0;
+    // Acquires that allocated a buffer.
+    int64_t misses = 0;
+    // Bytes of the released buffers held for reuse.
+    int64_t cached_bytes = 0;
+  };
+
+  // Holds up to `max_cached_bytes` of released buffers. Buffers are pinned
+  // when `pinned` is true, so that vendor backends can copy them to and from
+  // their devices asynchronously.
+  TorchMlirHostBufferPool(int64_t max_cached_bytes, bool pinned);
+
+  // Returns a contiguous host tensor of `shape`, whose contents are undefined.
+  at::Tensor Acquire(const Shape &shape);
+
+  // Returns a tensor from Acquire to the pool. It must not be used afterwards.
+  void Release(const at::Tensor &tensor);
+
+  Stats GetStats() const;
+
+private:
+  const int64_t max_cached_bytes_;
+  const bool pinned_;
+  mutable std::mutex mutex_;
+  // Released byte buffers, by size.
+  std::unordered_map<int64_t, std::vector<at::Tensor>> free_buffers_;
+  Stats stats_;
+};
+
+} // namespace lazy
+} // namespace torch
@@ -0,0 +1,168 @@
+//===- mlir_eager_fallback.cpp --------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <ATen/core/enum_tag.h>
+#include <ATen/native/CPUFallback.h>
+#include <ATen/ops/empty.h>
+#include <torch/csrc/lazy/core/ir_builder.h>
+#include <torch/csrc/lazy/core/metrics.h>
+#include <torch/csrc/lazy/core/tensor.h>
+#include <torch/library.h>
+
+#include "backend_impl.h"
+#include "mlir_eager_fallback.h"
+#include "ops/host_callback.h"
+
+namespace torch {
+namespace lazy {
+
+namespace {
+
+at::Tensor ToMeta(const at::Tensor &tensor) {
+  auto out = at::empty(tensor.sizes(), tensor.options().device(c10::kMeta));
+  // needs to handle wrapped numbers, so dtype promotion works properly.
+  if (tensor.unsafeGetTensorImpl()->is_wrapped_number()) {
+    out.unsafeGetTensorImpl()->set_wrapped_number(true);
+  }
+  return out;
+}
+
+// Returns whether calls to `op` can be captured: its results must be new
+// tensors, since captured calls cannot update or alias lazy tensors.
+bool IsCapturable(const c10::OperatorHandle &op) {
+  const c10::FunctionSchema &schema = op.schema();
+  if (schema.is_mutable() || schema.returns().empty()) {
+    return false;
+  }
+  for (const c10::Argument &argument : schema.arguments()) {
+    if (argument.alias_info()) {
+      return false;
+    }
+  }
+  for (const c10::Argument &ret : schema.returns()) {
+    if (ret.alias_info() || ret.type()->kind() != c10::TypeKind::TensorType) {
+      return false;
+    }
+  }
+  // Seeded random ops stay eager, so that they draw from the eager generator
+  // in program order.
+  if (op.hasTag(at::Tag::nondeterministic_seeded)) {
+    return false;
+  }
+  auto backend =
+      dynamic_cast<const TorchMlirBackendImpl *>(torch::lazy::getBackend());
+  return backend && backend->CaptureEagerFallback(op);
+}
+
+// Adds the call of `op` on `stack` to the traced graph, and replaces its
+// arguments on `stack` by lazy results. Returns false, leaving `stack` as is,
+// if the call cannot be captured.
+bool TryCaptureFallback(const c10::OperatorHandle &op,
+                        torch::jit::Stack *stack) {
+  if (!IsCapturable(op)) {
+    return false;
+  }
+  const size_t num_arguments = op.schema().arguments().size();
+  std::vector<torch::lazy::Value> operands;
+  std::vector<c10::IValue> arguments;
+  std::vector<std::optional<size_t>> operand_indices;
+  torch::jit::Stack meta_stack;
+  std::optional<BackendDevice> device;
+  for (const c10::IValue &argument : torch::jit::last(*stack, num_arguments)) {
+    if (argument.isTensor() && argument.toTensor().defined()) {
+      LazyTensorPtr lazy_tensor = TryGetLtcTensor(argument.toTensor());
+      if (!lazy_tensor || (device && *device != lazy_tensor->GetDevice())) {
+        return false;
+      }
+      device = lazy_tensor->GetDevice();
+      operand_indices.push_back(operands.size());
+      operands.push_back(lazy_tensor->GetIrValue());
+      arguments.emplace_back();
+      meta_stack.emplace_back(ToMeta(argument.toTensor()));
+      continue;
+    }
+    // Tensors in lists and generators cannot be lowered as constants.
+    if (argument.isTensorList() || argument.isOptionalTensorList() ||
+        argument.isGenerator()) {
+      return false;
+    }
+    operand_indices.push_back(std::nullopt);
+    arguments.push_back(argument);
+    meta_stack.push_back(argument);
+  }
+  // Calls without lazy tensors have no device to be traced on.
+  if (!device) {
+    return false;
+  }
+
+  // The result shapes come from the op's meta kernel. Ops without one run
+  // eagerly.
+  try {
+    op.callBoxed(&meta_stack);
+  } catch (const c10::Error &) {
+    return false;
+  }
+  std::vector<Shape> shapes;
+  shapes.reserve(meta_stack.size());
+  for (const c10::IValue &result : meta_stack) {
+    const at::Tensor &tensor = result.toTensor();
+    shapes.emplace_back(tensor.scalar_type(), tensor.sizes().vec());
+  }
+
+  TORCH_LAZY_COUNTER("TorchMlirCapturedFallback", 1);
+  const size_t num_results = shapes.size();
+  NodePtr node = torch::lazy::MakeNode<HostCallback>(
+      op, operands, std::move(arguments), std::move(operand_indices),
+      std::move(shapes));
+  torch::jit::drop(*stack, num_arguments);
+  for (size_t i = 0; i < num_results; ++i) {
+    torch::jit::push(*stack,
+                     CreateAtenFromLtcTensor(LazyTensor::Create(
+                         torch::lazy::Value(node, i), *device)));
+  }
+  return true;
+}
+
+} // namespace
+
+void torch_mlir_eager_fallback(const c10::OperatorHandle &op,
+                               torch::jit::Stack *stack) {
+  if (TryCaptureFallback(op, stack)) {
+    return;
+  }
+  TORCH_LAZY_COUNTER("TorchMlirEagerFallback", 1);
+  at::native::cpu_fallback(op, stack);
+}
+
+void RegisterTorchMlirEagerFallback() {
+  static auto m = MAKE_TORCH_LIBRARY_IMPL(_, Lazy);
+  m.fallback(torch::CppFunction::makeFromBoxedFunction<
+             &torch_mlir_eager_fallback>());
+}
+
+void RunHostCallback(const std::string &name, torch::jit::Stack *stack) {
+  size_t op_begin = name.find('.');
+  TORCH_CHECK(op_begin != std::string::npos,
+              "Expected a qualified op name, got: ", name);
+  size_t overload_begin = name.find('.', op_begin + 1);
+  std::string op_name =
+      name.substr(0, op_begin) + "::" +
+      name.substr(op_begin + 1, overload_begin == std::string::npos
+                                    ? std::string::npos
+                                    : overload_begin - op_begin - 1);
+  std::string overload_name = overload_begin == std::string::npos
+                                  ? ""
+                                  : name.substr(overload_begin + 1);
+  c10::Dispatcher::singleton()
+      .findSchemaOrThrow(op_name.c_str(), overload_name.c_str())
+      .callBoxed(stack);
+}
+
+} // namespace lazy
+} // namespace torch
@@ -0,0 +1,40 @@
+//===- mlir_eager_fallback.h ----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+// The fallback for ops without a lazy kernel, which either captures them in
+// the traced graph or runs them eagerly.
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <ATen/core/stack.h>
+
+namespace torch {
+namespace lazy {
+
+// Runs `op`, which has no lazy kernel, on the arguments in `stack`. When the
+// backend's CaptureEagerFallback accepts it and all its tensors are lazy, the
+// call is added to the traced graph as a HostCallback node, so that the
+// surrounding lazy ops keep accumulating in the same graph. Otherwise, the
+// lazy arguments are synced and the op is run on the CPU.
+TORCH_API void torch_mlir_eager_fallback(const c10::OperatorHandle &op,
+                                         torch::jit::Stack *stack);
+
+// Registers torch_mlir_eager_fallback as the fallback for the Lazy dispatch
+// key. Backends call this once, after registering the lazy native functions.
+TORCH_API void RegisterTorchMlirEagerFallback();
+
+// Runs the op of a captured call, named as in its `torch.operator` (e.g.
+// "aten.foo" or "aten.foo.overload"), on the host tensors in `stack`. Vendor
+// backends use this to execute the host callbacks of a computation.
+TORCH_API void RunHostCallback(const std::string &name,
+                               torch::jit::Stack *stack);
+
+} // namespace lazy
+} // namespace torch
@@ -11,6 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <unordered_set>
 
 #include "mlir-c/IR.h"
 #include "mlir-c/Pass.h"
@@ -20,8 +23,10 @@
 #include <torch/csrc/jit/passes/refine_tuple_types.h>
 #include <torch/csrc/lazy/core/config.h>
 #include <torch/csrc/lazy/core/lazy_graph_executor.h>
+#include <torch/csrc/lazy/core/metrics.h>
 
 #include "backend_impl.h"
+#include "dynamic_ir.h"
 #include "jit_ir_importer/function_importer.h"
 #include "mlir_lowering_context.h"
 #include "mlir_node.h"
@@ -34,6 +39,56 @@
 namespace torch {
 namespace lazy {
 
+namespace {
+// Every lowering on a thread shares one context, so that dialects are only
+// registered once. Contexts are never destroyed since the computations built
+// in them may outlive the thread.
+MlirContext GetThreadMlirContext() {
+  thread_local MlirContext context = []() {
+    MlirContext context = mlirContextCreate();
+    // https://reviews.llvm.org/D88162
+    torchMlirRegisterAllDialects(context);
+    return context;
+  }();
+  return context;
+}
+
+// Verifies that `module_op` satisfies the backend contract. Modules lowered
+// from the same graph (identified by `hash`) are identical, so each graph is
+// only verified once. Verification can be disabled entirely with
+// LTC_VERIFY_MLIR=0.
+void VerifyModule(MlirContext context, MlirModule module_op,
+                  const hash_t &hash) {
+  static const bool enabled = sys_util::GetEnvBool("LTC_VERIFY_MLIR", true);
+  if (!enabled)
+    return;
+
+  static std::mutex mutex;
+  static std::unordered_set<hash_t, HashReducer> verified;
+  if (hash != kNullHash) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (verified.count(hash))
+      return;
+  }
+
+  MlirPassManager pass_manager = mlirPassManagerCreate(context);
+  mlirPassManagerAddOwnedPass(
+      pass_manager, mlirCreateVerifyBackendContractNoDecompositions());
+  MlirLogicalResult result =
+      mlirPassManagerRunOnOp(pass_manager, mlirModuleGetOperation(module_op));
+  mlirPassManagerDestroy(pass_manager);
+
+  if (mlirLogicalResultIsFailure(result)) {
+    throw std::runtime_error("MLIR verification has failed.");
+  }
+
+  if (hash != kNullHash) {
+    std::lock_guard<std::mutex> lock(mutex);
+    verified.insert(hash);
+  }
+}
+} // namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // TorchMlir Lowering Context
 ///////////////////////////////////////////////////////////////////////////////
@@ -44,9 +99,7 @@ TorchMlirLoweringContext::TorchMlirLoweringContext(const std::string &name,
       graph_(std::make_shared<torch::jit::Graph>()),
       function_(
           std::make_shared<torch::jit::GraphFunction>(name, graph_, nullptr)),
-      mlir_context_(mlirContextCreate()) {
-  RegisterMlirDialects();
-}
+      mlir_context_(GetThreadMlirContext()) {}
 
 TorchMlirLoweringContext::TorchMlirLoweringContext(
     const std::string &name, BackendDevice device,
@@ -59,10 +112,13 @@ TorchMlirLoweringContext::TorchMlirLoweringContext(
       graph_(std::make_shared<torch::jit::Graph>()),
       function_(
           std::make_shared<torch::jit::GraphFunction>(name, graph_, nullptr)),
-      mlir_context_(mlirContextCreate()) {
-  RegisterMlirDialects();
-
+      mlir_context_(GetThreadMlirContext()) {
+  TORCH_LAZY_TIMED("TorchMlirLowerNodes");
+  TORCH_LAZY_VALUE_METRIC("TorchMlirLoweredNodes", post_order.size());
   for (auto node : post_order) {
+    // With dynamic shapes, node hashes only include the buckets of dynamic
+    // dims, so graphs in the same buckets share a computation.
+    hash_ = HashCombine(hash_, node->hash());
     Lower(node);
   }
 }
@@ -115,6 +171,9 @@ bool TorchMlirLoweringContext::CheckResultShape(
 size_t TorchMlirLoweringContext::AddResult(const Output &output) {
   PRINT_FUNCTION();
 
+  if (hash_ != kNullHash)
+    hash_ = HashCombine(hash_, output.hash());
+  result_shapes_.push_back(output.shape());
   return AddResult(GetOutputOp(output));
 }
 
@@ -132,6 +191,7 @@ void TorchMlirLoweringContext::AddParameter(const torch::lazy::Output &output,
 // embedded builder (returned by the builder() API).
 ComputationPtr TorchMlirLoweringContext::Build() {
   PRINT_FUNCTION();
+  TORCH_LAZY_TIMED("TorchMlirBuild");
 
   // Since we mutated the types of some nodes to insert shape information, we
   // must perform this pass to ensure tuples have up to date output types.
@@ -160,26 +220,34 @@ ComputationPtr TorchMlirLoweringContext::Build() {
   MlirBlock block = mlirModuleGetBody(module_op);
   mlirBlockAppendOwnedOperation(block, func_op);
 
-  // Apply passes to verify generated MLIR.
-  auto pass_manager = mlirPassManagerCreate(mlir_context_);
-  mlirPassManagerAddOwnedPass(
-      pass_manager, mlirCreateVerifyBackendContractNoDecompositions());
-
-  MlirLogicalResult result =
-      mlirPassManagerRunOnOp(pass_manager, mlirModuleGetOperation(module_op));
+  VerifyModule(mlir_context_, module_op, hash_);
 
-  if (mlirLogicalResultIsFailure(result)) {
-    throw std::runtime_error("MLIR verification has failed.");
-  }
+  // The lowered function has a single block, so its size is the number of
+  // operations in that block.
+  size_t num_ops = 0;
+  MlirBlock body = mlirRegionGetFirstBlock(mlirOperationGetRegion(func_op, 0));
+  for (MlirOperation op = mlirBlockGetFirstOperation(body);
+       !mlirOperationIsNull(op); op = mlirOperationGetNextInBlock(op))
+    ++num_ops;
+  TORCH_LAZY_VALUE_METRIC("TorchMlirModuleOperations", num_ops);
 
   return CreateComputation(module_op);
 }
 
 ComputationPtr
 TorchMlirLoweringContext::CreateComputation(MlirModule module_op) {
-  return std::make_shared<TorchMlirComputation>(module_op, mlir_context_,
-                                                graph_, parameter_names_,
-                                                input_output_aliases_);
+  // Parameter names end up in the generated MLIR, so they are part of the
+  // identity of the computation.
+  hash_t hash = hash_;
+  if (hash != kNullHash) {
+    std::map<int, std::string> sorted_names(parameter_names_.begin(),
+                                            parameter_names_.end());
+    for (const auto &kv : sorted_names)
+      hash = HashCombine(hash, HashCombine(Hash(kv.first), Hash(kv.second)));
+  }
+  return std::make_shared<TorchMlirComputation>(
+      module_op, mlir_context_, graph_, parameter_names_,
+      input_output_aliases_, hash, result_shapes_);
 }
 
 torch::jit::Value *TorchMlirLoweringContext::GetOutputOp(const Output &output) {
@@ -278,7 +346,7 @@ torch::jit::Value *TorchMlirLoweringContext::GetParameter(BackendDataPtr data) {
       param->setType(torch::jit::TensorType::create(
           /*scalar_type=*/data->shape().scalar_type(),
           /*device=*/c10::nullopt,
-          /*sizes=*/c10::VaryingShape<int64_t>(data->shape().sizes()),
+          /*sizes=*/GetDynamicShapePolicy().GetLoweredSizes(data->shape()),
           /*strides=*/c10::VaryingShape<int64_t>(),
           /*requires_grad=*/c10::nullopt));
 
@@ -346,11 +414,6 @@ TorchMlirLoweringContext::generate_jit_fn() const {
   return fn;
 }
 
-void TorchMlirLoweringContext::RegisterMlirDialects() {
-  // https://reviews.llvm.org/D88162
-  torchMlirRegisterAllDialects(mlir_context_);
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 // TorchMlir Computation
 ///////////////////////////////////////////////////////////////////////////////
@@ -359,10 +422,12 @@ TorchMlirComputation::TorchMlirComputation(
     MlirModule module_op, MlirContext mlir_context,
     const std::shared_ptr<torch::jit::Graph> &graph,
     std::unordered_map<int, std::string> parameters_map,
-    InputOutputAliases input_output_aliases)
+    InputOutputAliases input_output_aliases, hash_t hash,
+    std::vector<Shape> result_shapes)
     : module_op_(std::move(module_op)), mlir_context_(std::move(mlir_context)),
       graph_(graph), input_output_aliases_(input_output_aliases),
-      parameters_map_(parameters_map) {
+      parameters_map_(parameters_map),
+      result_shapes_(std::move(result_shapes)), hash_(hash) {
 
   num_parameters_ = graph_->inputs().size();
 
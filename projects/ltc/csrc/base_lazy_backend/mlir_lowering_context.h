@@ -91,6 +91,10 @@ public:
 
   std::shared_ptr<torch::jit::Graph> graph() const;
 
+  // Hash of the lowered nodes, their shapes and the results, which identifies
+  // the computation for caching. Null if no post order was given.
+  const hash_t &hash() const { return hash_; }
+
 protected:
   struct Parameter {
     torch::jit::Value *param;
@@ -103,8 +107,6 @@ protected:
   // type information is patched to include shape.
   std::unique_ptr<torch::jit::Function> generate_jit_fn() const;
 
-  void RegisterMlirDialects();
-
   // Holds the input/output alias information populated by the SetUpAlias() API.
   InputOutputAliases input_output_aliases_;
   std::shared_ptr<torch::jit::Graph> graph_;
@@ -113,7 +115,10 @@ protected:
   std::unordered_map<BackendData::Handle, Parameter> parameters_map_;
   std::unordered_map<int, std::string> parameter_names_;
   std::vector<torch::jit::Value *> root_tuple_;
+  // Shapes of the results added through AddResult(const Output &).
+  std::vector<Shape> result_shapes_;
   OutputMap<torch::jit::Value *> emitted_outputs_;
+  hash_t hash_ = kNullHash;
 };
 
 class TORCH_API TorchMlirComputation : public torch::lazy::Computation {
@@ -124,7 +129,9 @@ public:
   TorchMlirComputation(MlirModule module_op, MlirContext mlir_context,
                        const std::shared_ptr<torch::jit::Graph> &graph,
                        std::unordered_map<int, std::string> parameters_map,
-                       InputOutputAliases input_output_aliases);
+                       InputOutputAliases input_output_aliases,
+                       hash_t hash = kNullHash,
+                       std::vector<Shape> result_shapes = {});
 
   int parameters_size() const override;
 
@@ -136,6 +143,10 @@ public:
 
   const torch::lazy::Shape &result_shape() const override;
 
+  // Shapes of the computation's results, in order. Empty if the results were
+  // not added from lazy IR outputs.
+  const std::vector<Shape> &result_shapes() const { return result_shapes_; }
+
   std::shared_ptr<torch::jit::Graph> graph() const;
 
   MlirOperation func_op() const;
@@ -144,6 +155,9 @@ public:
 
   MlirContext mlir_context() const;
 
+  // See TorchMlirLoweringContext::hash().
+  const hash_t &hash() const { return hash_; }
+
   virtual const std::string debug_string() const;
 
   virtual const std::string to_string() const override;
@@ -158,6 +172,8 @@ protected:
   std::vector<std::string> parameter_names_;
   std::vector<Shape> parameter_shapes_;
   Shape result_shape_;
+  std::vector<Shape> result_shapes_;
+  hash_t hash_;
 };
 
 } // namespace lazy
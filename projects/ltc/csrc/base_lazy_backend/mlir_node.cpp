@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "mlir_node.h"
+#include "dynamic_ir.h"
 #include "utils/exception.h"
 
 namespace torch {
@@ -18,21 +19,48 @@ namespace lazy {
 
 namespace {
 
-hash_t OperandHashes(const OpList &operands, const c10::ArrayRef<Shape> &shapes,
-                     const hash_t &seed, bool bakeInSizes) {
-  hash_t hash = seed;
+struct NodeHashes {
+  hash_t shape_hash;
+  hash_t dag_hash;
+};
+
+// Computes the hash with sizes and, if dynamic shapes are enabled, the one
+// without in a single walk over the operands and shapes, from the hashes
+// cached on the operand nodes.
+NodeHashes ComputeNodeHashes(const OpList &operands,
+                             const c10::ArrayRef<Shape> &shapes,
+                             const hash_t &seed) {
+  const bool dynamic = enableDynamicShape();
+  hash_t shape_hash = seed;
+  hash_t dag_hash = seed;
   for (auto &operand : operands) {
     if (!operand) {
-      hash = HashCombine(hash, static_cast<uint64_t>(kNullOpt));
+      shape_hash = HashCombine(shape_hash, static_cast<uint64_t>(kNullOpt));
+      if (dynamic)
+        dag_hash = HashCombine(dag_hash, static_cast<uint64_t>(kNullOpt));
       continue;
     }
-    auto operand_hash = bakeInSizes ? operand.shapeHash() : operand.hash();
-    hash = HashCombine(hash, operand_hash);
+    shape_hash = HashCombine(shape_hash, operand.shapeHash());
+    if (dynamic)
+      dag_hash = HashCombine(dag_hash, operand.hash());
   }
+  // Without sizes, dynamic dims are hashed by bucket and the others by size.
+  const DynamicShapePolicy *policy =
+      dynamic && !shapes.empty() ? &GetDynamicShapePolicy() : nullptr;
   for (auto &shape : shapes) {
-    hash = HashCombine(hash, shape.hash(bakeInSizes));
+    shape_hash = HashCombine(shape_hash, shape.hash(/*bakeInSizes=*/true));
+    if (dynamic)
+      dag_hash = HashCombine(dag_hash, policy->ShapeHash(shape));
   }
-  return hash;
+  return {shape_hash, dynamic ? dag_hash : shape_hash};
+}
+
+std::vector<Shape> SingleShape(Shape &&shape) {
+  // Unlike a braced list, which is copied from, this moves the sizes.
+  std::vector<Shape> shapes;
+  shapes.reserve(1);
+  shapes.push_back(std::move(shape));
+  return shapes;
 }
 
 } // namespace
@@ -48,11 +76,10 @@ TorchMlirNode::TorchMlirNode(OpKind op, OpList operands,
                              std::vector<Shape> &&shapes, size_t num_outputs,
                              hash_t hash_seed)
     : Node(op, operands, std::move(shapes), num_outputs) {
-  hash_seed = HashCombine(op.hash(), hash_seed);
-  shape_hash_ = OperandHashes(operands, this->shapes(), hash_seed, true);
-  dag_hash_ = (enableDynamicShape()
-                   ? OperandHashes(operands, this->shapes(), hash_seed, false)
-                   : shape_hash_);
+  NodeHashes hashes = ComputeNodeHashes(operands, this->shapes(),
+                                        HashCombine(op.hash(), hash_seed));
+  shape_hash_ = hashes.shape_hash;
+  dag_hash_ = hashes.dag_hash;
 
   for (std::function<void(TorchMlirNode *)> &f : constructor_hooks) {
     f(this);
@@ -72,9 +99,14 @@ TorchMlirNode::TorchMlirNode(OpKind op, OpList operands, size_t num_outputs,
     : TorchMlirNode(op, operands, std::vector<Shape>{}, num_outputs,
                     hash_seed) {}
 
+TorchMlirNode::TorchMlirNode(OpKind op, OpList operands, Shape shape,
+                             size_t num_outputs, hash_t hash_seed)
+    : TorchMlirNode(op, operands, SingleShape(std::move(shape)), num_outputs,
+                    hash_seed) {}
+
 TorchMlirNode::TorchMlirNode(OpKind op, Shape shape, size_t num_outputs,
                              hash_t hash_seed)
-    : TorchMlirNode(op, {}, {std::move(shape)}, num_outputs, hash_seed) {}
+    : TorchMlirNode(op, {}, std::move(shape), num_outputs, hash_seed) {}
 
 hash_t TorchMlirNode::hash() const { return dag_hash_; }
 
@@ -37,6 +37,9 @@ public:
   TorchMlirNode(OpKind op, OpList operands, size_t num_outputs,
                 hash_t hash_seed = kHashSeed);
 
+  TorchMlirNode(OpKind op, OpList operands, Shape shape, size_t num_outputs,
+                hash_t hash_seed = kHashSeed);
+
   TorchMlirNode(OpKind op, Shape shape, size_t num_outputs,
                 hash_t hash_seed = kHashSeed);
 
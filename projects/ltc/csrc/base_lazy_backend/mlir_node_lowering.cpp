@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "mlir_node_lowering.h"
+#include "dynamic_ir.h"
 #include "generated/LazyNonNativeIr.h"
 #include "mlir_lowering_context.h"
 #include "mlir_node.h"
@@ -115,12 +116,13 @@ LowerTorchMlirBuiltin(TorchMlirFunction function, c10::Symbol sym,
                       const std::vector<torch::jit::NamedValue> &kwarguments) {
   std::vector<c10::TypePtr> tensor_types;
 
-  // Generate types with fixed tensor shape information.
+  // Generate types with tensor shape information. Dims that the dynamic
+  // shape policy considers dynamic are left unknown.
   for (const Shape &shape : result_shapes) {
     tensor_types.push_back(torch::jit::TensorType::create(
         /*scalar_type=*/shape.scalar_type(),
         /*device=*/c10::nullopt,
-        /*sizes=*/c10::VaryingShape<int64_t>(shape.sizes()),
+        /*sizes=*/GetDynamicShapePolicy().GetLoweredSizes(shape),
         /*strides=*/c10::VaryingShape<int64_t>(),
         /*requires_grad=*/c10::nullopt));
   }
@@ -0,0 +1,75 @@
+//===- host_callback.cpp --------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "host_callback.h"
+
+#include <sstream>
+
+namespace torch {
+namespace lazy {
+
+namespace {
+
+std::string ConstantArgumentsString(
+    const std::vector<c10::IValue> &arguments,
+    const std::vector<std::optional<size_t>> &operand_indices) {
+  std::stringstream ss;
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    if (operand_indices[i])
+      ss << "%" << *operand_indices[i];
+    else
+      ss << arguments[i];
+    ss << ";";
+  }
+  return ss.str();
+}
+
+} // namespace
+
+HostCallback::HostCallback(const c10::OperatorHandle &op, OpList operands,
+                           std::vector<c10::IValue> arguments,
+                           std::vector<std::optional<size_t>> operand_indices,
+                           std::vector<Shape> &&shapes)
+    : torch::lazy::TorchMlirNode(
+          OpKind(c10::Symbol::fromQualString(op.schema().name())), operands,
+          std::move(shapes), op.schema().returns().size(),
+          torch::lazy::MHash(
+              op.schema().overload_name(),
+              ConstantArgumentsString(arguments, operand_indices))),
+      schema(op.schema()), arguments(std::move(arguments)),
+      operand_indices(std::move(operand_indices)) {}
+
+std::string HostCallback::ToString() const {
+  std::stringstream ss;
+  ss << torch::lazy::TorchMlirNode::ToString();
+  ss << ", overload=" << schema.overload_name();
+  ss << ", arguments=" << ConstantArgumentsString(arguments, operand_indices);
+  return ss.str();
+}
+
+TorchMlirOpVector HostCallback::Lower(TorchMlirFunction function,
+                                      TorchMlirLoweringContext *loctx) const {
+  PRINT_FUNCTION();
+  std::vector<torch::jit::NamedValue> named_arguments;
+  std::vector<torch::jit::NamedValue> kwarguments;
+  named_arguments.reserve(arguments.size());
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    if (operand_indices[i]) {
+      named_arguments.emplace_back(
+          loctx->GetOutputOp(operand(*operand_indices[i])));
+    } else {
+      named_arguments.emplace_back(schema.arguments()[i].name(), arguments[i]);
+    }
+  }
+  return torch::lazy::LowerTorchMlirBuiltin(function, op().op, shapes(),
+                                            named_arguments, kwarguments);
+}
+
+} // namespace lazy
+} // namespace torch
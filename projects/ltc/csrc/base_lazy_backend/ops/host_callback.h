@@ -0,0 +1,43 @@
+//===- host_callback.h ----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <ATen/core/dispatch/Dispatcher.h>
+
+#include "../mlir_node.h"
+
+namespace torch {
+namespace lazy {
+
+// HostCallback IR Node represents a call to an op without a lazy kernel that
+// was captured in the graph instead of being run eagerly. It is lowered to
+// the op's torch dialect op or, for ops unknown to torch-mlir, to an opaque
+// `torch.operator` that the backend executes on the host.
+class HostCallback : public torch::lazy::TorchMlirNode {
+public:
+  // `arguments` holds the op's arguments, with the tensor arguments replaced
+  // by the index of the corresponding value in `operands`.
+  HostCallback(const c10::OperatorHandle &op, OpList operands,
+               std::vector<c10::IValue> arguments,
+               std::vector<std::optional<size_t>> operand_indices,
+               std::vector<Shape> &&shapes);
+
+  std::string ToString() const override;
+
+  TorchMlirOpVector Lower(TorchMlirFunction function,
+                          TorchMlirLoweringContext *loctx) const override;
+
+  c10::FunctionSchema schema;
+  std::vector<c10::IValue> arguments;
+  std::vector<std::optional<size_t>> operand_indices;
+};
+
+} // namespace lazy
+} // namespace torch
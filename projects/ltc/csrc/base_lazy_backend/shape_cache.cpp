@@ -0,0 +1,48 @@
+//===- shape_cache.cpp ----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include "shape_cache.h"
+#include "utils/sys_utils.h"
+
+namespace torch {
+namespace lazy {
+
+ShapeCache::ShapeCache(size_t max_size) : shapes_(max_size) {}
+
+ShapeCache::Stats ShapeCache::GetStats() const {
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  return stats;
+}
+
+void ShapeCache::Clear() { shapes_.Clear(); }
+
+void ShapeCache::RecordHit() {
+  ++hits_;
+  TORCH_LAZY_COUNTER("TorchMlirShapeCacheHit", 1);
+}
+
+void ShapeCache::RecordMiss() {
+  ++misses_;
+  TORCH_LAZY_COUNTER("TorchMlirShapeCacheMiss", 1);
+}
+
+ShapeCache *GetShapeCache() {
+  static ShapeCache *cache = []() {
+    int size = sys_util::GetEnv<int>("LTC_SHAPE_CACHE_SIZE", 4096);
+    return size > 0 ? new ShapeCache(size) : nullptr;
+  }();
+  return cache;
+}
+
+} // namespace lazy
+} // namespace torch
@@ -0,0 +1,167 @@
+//===- shape_cache.h ------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+// A cache of the output shapes computed for traced ops, keyed by the op and
+// the shapes and values of its arguments. The generated LazyNativeFunctions
+// consult it before running shape inference.
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include <ATen/Tensor.h>
+#include <ATen/core/ITensorListRef.h>
+#include <c10/core/SymInt.h>
+#include <torch/csrc/lazy/core/cache.h>
+#include <torch/csrc/lazy/core/hash.h>
+#include <torch/csrc/lazy/core/shape.h>
+
+namespace torch {
+namespace lazy {
+
+class TORCH_API ShapeCache {
+public:
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+  };
+
+  explicit ShapeCache(size_t max_size);
+
+  // Returns the shapes cached for `key`, computing and caching them with
+  // `compute` on a miss.
+  template <typename F>
+  std::vector<Shape> GetOrCompute(const hash_t &key, F &&compute) {
+    if (std::shared_ptr<std::vector<Shape>> shapes = shapes_.Get(key)) {
+      RecordHit();
+      return *shapes;
+    }
+    RecordMiss();
+    std::vector<Shape> shapes = compute();
+    shapes_.Add(key, std::make_shared<std::vector<Shape>>(shapes));
+    return shapes;
+  }
+
+  Stats GetStats() const;
+
+  void Clear();
+
+private:
+  void RecordHit();
+  void RecordMiss();
+
+  Cache<hash_t, std::vector<Shape>, HashReducer> shapes_;
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+};
+
+// Returns the process-wide shape cache, or nullptr if it is disabled. The
+// cache holds LTC_SHAPE_CACHE_SIZE entries (default 4096); 0 disables it.
+TORCH_API ShapeCache *GetShapeCache();
+
+namespace shape_cache_detail {
+
+// Each overload folds one argument into the key and returns false if the
+// argument can't be part of a key. Tensors contribute their type and sizes,
+// everything else its value.
+inline bool HashArg(hash_t &hash, const at::Tensor &tensor, int) {
+  if (!tensor.defined()) {
+    hash = HashCombine(hash, static_cast<uint64_t>(kNullOpt));
+    return true;
+  }
+  for (const c10::SymInt &size : tensor.sym_sizes())
+    if (size.is_heap_allocated())
+      return false;
+  hash = HashCombine(hash, HashCombine(Hash(tensor.scalar_type()),
+                                       Hash(tensor.sizes())));
+  return true;
+}
+
+inline bool HashArg(hash_t &hash, const std::optional<at::Tensor> &tensor,
+                    int) {
+  if (!tensor)
+    return HashArg(hash, at::Tensor(), 0);
+  return HashArg(hash, *tensor, 0);
+}
+
+inline bool HashArg(hash_t &hash, at::TensorList tensors, int) {
+  hash = HashCombine(hash, Hash(tensors.size()));
+  for (const at::Tensor &tensor : tensors)
+    if (!HashArg(hash, tensor, 0))
+      return false;
+  return true;
+}
+
+inline bool HashArg(hash_t &hash, const at::ITensorListRef &tensors, int) {
+  hash = HashCombine(hash, Hash(tensors.size()));
+  for (const at::Tensor &tensor : tensors)
+    if (!HashArg(hash, tensor, 0))
+      return false;
+  return true;
+}
+
+inline bool HashArg(hash_t &hash, const c10::SymInt &value, int) {
+  std::optional<int64_t> int_value = value.maybe_as_int();
+  if (!int_value)
+    return false;
+  hash = HashCombine(hash, Hash(*int_value));
+  return true;
+}
+
+inline bool HashArg(hash_t &hash, c10::SymIntArrayRef values, int) {
+  hash = HashCombine(hash, Hash(values.size()));
+  for (const c10::SymInt &value : values)
+    if (!HashArg(hash, value, 0))
+      return false;
+  return true;
+}
+
+inline bool HashArg(hash_t &hash, const std::optional<c10::SymInt> &value,
+                    int) {
+  if (!value) {
+    hash = HashCombine(hash, static_cast<uint64_t>(kNullOpt));
+    return true;
+  }
+  return HashArg(hash, *value, 0);
+}
+
+// Generators don't affect shapes.
+inline bool HashArg(hash_t &, const std::optional<at::Generator> &, int) {
+  return true;
+}
+
+template <typename T>
+auto HashArg(hash_t &hash, const T &value, int) -> decltype(Hash(value), true) {
+  hash = HashCombine(hash, Hash(value));
+  return true;
+}
+
+template <typename T> bool HashArg(hash_t &, const T &, long) { return false; }
+
+} // namespace shape_cache_detail
+
+// Returns the shapes of `op` applied to `args`, from the shape cache if
+// possible. Falls back to `compute` when the cache is disabled, when
+// symbolic shapes are enabled, or when an argument can't be hashed.
+template <typename F, typename... Args>
+std::vector<Shape> ComputeShapesCached(const char *op, F &&compute,
+                                       const Args &...args) {
+  ShapeCache *cache = GetShapeCache();
+  if (!cache || symbolicShapeEnabled())
+    return compute();
+  hash_t key = Hash(std::string(op));
+  if (!(shape_cache_detail::HashArg(key, args, 0) && ...))
+    return compute();
+  return cache->GetOrCompute(key, std::forward<F>(compute));
+}
+
+} // namespace lazy
+} // namespace torch
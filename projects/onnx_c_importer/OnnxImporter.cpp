@@ -10,20 +10,37 @@
 #include "OnnxImporter.h"
 
 #include "google/protobuf/text_format.h"
+#include "mlir-c/AffineExpr.h"
+#include "mlir-c/AffineMap.h"
 #include "mlir-c/BuiltinAttributes.h"
 #include "mlir-c/BuiltinTypes.h"
+#include "onnx/common/version.h"
 #include "onnx/defs/schema.h"
 #include "onnx/shape_inference/attribute_binder.h"
 #include "onnx/shape_inference/implementation.h"
 #include "torch-mlir-c/Registration.h"
+#include "torch-mlir-c/TorchTypes.h"
 #ifndef NDEBUG
 #include "onnx/checker.h"
 #endif
 
+#include <algorithm>
 #include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <numeric>
+#include <random>
+#include <thread>
 #include <type_traits>
+#include <unordered_set>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
 
 namespace std {
 template <> struct hash<MlirType> {
@@ -80,6 +97,100 @@ inline MlirStringRef toMlirStringRef(const char *s) {
   return mlirStringRefCreate(s, std::strlen(s));
 }
 
+/// Copies `data` converted to `TOut` into a new buffer, which must be freed
+/// with `DeleteArray<TOut>`.
+template <typename TOut, typename TIn,
+          typename = std::enable_if_t<std::is_convertible<TIn, TOut>::value>>
+std::span<const char> ConvertToNewBuffer(std::span<const TIn> data) {
+  TOut *buffer = new TOut[data.size()];
+  std::copy(data.begin(), data.end(), buffer);
+  return std::span<const char>(reinterpret_cast<const char *>(buffer),
+                               data.size() * sizeof(TOut));
+}
+
+template <typename T>
+void DeleteArray(void * /*userData*/, const void *data, size_t /*size*/,
+                 size_t /*align*/) {
+  delete[] static_cast<const T *>(data);
+}
+
+// Tensors stored in typed fields with up to this many elements are imported
+// as DenseElementsAttr rather than as resources.
+constexpr int64_t kMaxDenseTypedFieldElements = 16;
+
+/// Returns a DenseElementsAttr of `tensorType` holding the typed field of
+/// `tp` that matches its data type, or null for unsupported data types.
+MlirAttribute ConvertTypedFieldToDenseAttr(MlirType tensorType,
+                                           const onnx::TensorProto &tp) {
+  switch (tp.data_type()) {
+  case onnx::TensorProto::DataType::TensorProto_DataType_FLOAT:
+    return mlirDenseElementsAttrFloatGet(tensorType, tp.float_data_size(),
+                                         tp.float_data().data());
+  case onnx::TensorProto::DataType::TensorProto_DataType_BOOL:
+    // NOTE: At the time of writing there are no passing e2e tests that use
+    // this. onnx-ml.proto documentation is not clear about how bools are
+    // organized in an int32 buffer.
+    return mlirDenseElementsAttrBoolGet(tensorType, tp.int32_data_size(),
+                                        tp.int32_data().data());
+  case onnx::TensorProto::DataType::TensorProto_DataType_UINT8: {
+    // Special case. See proto.
+    auto data = elementwiseCast<uint8_t>(
+        std::span(tp.int32_data().data(), tp.int32_data_size()));
+    return mlirDenseElementsAttrUInt8Get(tensorType, data.size(), data.data());
+  }
+  case onnx::TensorProto::DataType::TensorProto_DataType_INT8: {
+    // Special case. See proto.
+    auto data = elementwiseCast<int8_t>(
+        std::span(tp.int32_data().data(), tp.int32_data_size()));
+    return mlirDenseElementsAttrInt8Get(tensorType, data.size(), data.data());
+  }
+  case onnx::TensorProto::DataType::TensorProto_DataType_INT16: {
+    // Special case. See proto.
+    auto data = elementwiseCast<int16_t>(
+        std::span(tp.int32_data().data(), tp.int32_data_size()));
+    return mlirDenseElementsAttrInt16Get(tensorType, data.size(), data.data());
+  }
+  case onnx::TensorProto::DataType::TensorProto_DataType_INT32:
+    return mlirDenseElementsAttrInt32Get(tensorType, tp.int32_data_size(),
+                                         tp.int32_data().data());
+  case onnx::TensorProto::DataType::TensorProto_DataType_INT64:
+    return mlirDenseElementsAttrInt64Get(tensorType, tp.int64_data_size(),
+                                         tp.int64_data().data());
+  case onnx::TensorProto::DataType::TensorProto_DataType_DOUBLE:
+    return mlirDenseElementsAttrDoubleGet(tensorType, tp.double_data_size(),
+                                          tp.double_data().data());
+  case onnx::TensorProto::DataType::TensorProto_DataType_UINT32: {
+    // Special case. See proto.
+    auto data = elementwiseCast<uint32_t>(
+        std::span(tp.uint64_data().data(), tp.uint64_data_size()));
+    return mlirDenseElementsAttrUInt32Get(tensorType, data.size(),
+                                          data.data());
+  }
+  case onnx::TensorProto::DataType::TensorProto_DataType_UINT64:
+    return mlirDenseElementsAttrUInt64Get(tensorType, tp.uint64_data_size(),
+                                          tp.uint64_data().data());
+
+    // Intentionally unsupported: STRING
+  }
+  return {nullptr};
+}
+
+/// Returns the bytes of a repeated protobuf field.
+template <typename FieldT> std::span<const char> AsBytes(const FieldT &field) {
+  return std::span<const char>(reinterpret_cast<const char *>(field.data()),
+                               field.size() * sizeof(*field.data()));
+}
+
+uint64_t HashBytes(std::span<const char> data) {
+  // FNV-1a.
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
 inline MlirNamedAttribute toMlirNamedAttribute(const char *s,
                                                MlirAttribute attr) {
   MlirContext context = mlirAttributeGetContext(attr);
@@ -87,18 +198,6 @@ inline MlirNamedAttribute toMlirNamedAttribute(const char *s,
   return mlirNamedAttributeGet(ident, attr);
 }
 
-std::string getMlirAsm(MlirType t) {
-  std::string result;
-  mlirTypePrint(
-      t,
-      +[](MlirStringRef sr, void *userData) {
-        std::string *s = static_cast<std::string *>(userData);
-        s->append(sr.data, sr.length);
-      },
-      static_cast<void *>(&result));
-  return result;
-}
-
 // C++ helpers to create operations.
 void addToMlirOperationState(MlirOperationState &state,
                              MlirNamedAttribute namedAttr) {
@@ -336,6 +435,91 @@ onnx::ModelProto SpecializeFunctionAndCreateModel(
 
 } // namespace
 
+// ---------------------------------------------------------------------------//
+// ImportStats
+// ---------------------------------------------------------------------------//
+
+ImportStats::Phase::Phase(ImportStats *stats, std::string name)
+    : stats_(stats), index_(0), start_(std::chrono::steady_clock::now()) {
+  if (!stats_)
+    return;
+  index_ = stats_->phases.size();
+  stats_->phases.push_back({std::move(name), stats_->current_depth++, 0.0});
+}
+
+ImportStats::Phase::~Phase() {
+  if (!stats_)
+    return;
+  --stats_->current_depth;
+  stats_->phases[index_].seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_)
+          .count();
+}
+
+void ImportStats::Print(std::ostream &os) const {
+  char buffer[128];
+  auto printBanner = [&](const std::string &title) {
+    std::string rule = "===" + std::string(73, '-') + "===\n";
+    std::string line = "... " + title + " ...";
+    os << rule << std::string((80 - line.size()) / 2, ' ') << line << "\n"
+       << rule;
+  };
+
+  double total = 0.0;
+  for (const PhaseTime &phase : phases)
+    if (phase.depth == 0)
+      total += phase.seconds;
+  printBanner("Execution time report");
+  std::snprintf(buffer, sizeof(buffer),
+                "  Total Execution Time: %.4f seconds\n\n", total);
+  os << buffer << "  ----Wall Time----  ----Name----\n";
+  auto printRow = [&](double seconds, unsigned depth, const std::string &name) {
+    std::snprintf(buffer, sizeof(buffer), "  %7.4f (%5.1f%%)  ", seconds,
+                  total > 0.0 ? 100.0 * seconds / total : 0.0);
+    os << buffer << std::string(2 * depth, ' ') << name << "\n";
+  };
+  for (const PhaseTime &phase : phases)
+    printRow(phase.seconds, phase.depth, phase.name);
+  printRow(total, 0, "Total");
+  os << "\n";
+
+  printBanner("Import statistics report");
+  auto printStat = [&](uint64_t value, const char *name, const char *desc) {
+    os << "    (S) " << value << " " << name << " - " << desc << "\n";
+  };
+#if !defined(_WIN32)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+    uint64_t peakRssKb = usage.ru_maxrss / 1024;
+#else
+    uint64_t peakRssKb = usage.ru_maxrss;
+#endif
+    printStat(peakRssKb, "peak-rss-kb", "Peak resident set size in KiB");
+  }
+#endif
+  printStat(num_nodes, "num-nodes", "Number of ONNX nodes imported");
+  printStat(num_initializers, "num-initializers",
+            "Number of initializers and constants imported");
+  printStat(num_expanded_functions, "num-expanded-functions",
+            "Number of ONNX functions expanded");
+  printStat(num_cached_functions, "num-cached-functions",
+            "Number of ONNX functions loaded from the function cache");
+  printStat(function_expansion_nanoseconds / 1000000,
+            "function-expansion-ms",
+            "Time spent specializing ONNX functions, summed over threads");
+  printStat(bytes_borrowed, "bytes-borrowed",
+            "Tensor bytes referenced in place by resources");
+  printStat(bytes_copied, "bytes-copied",
+            "Tensor bytes converted into resources owned by the module");
+  printStat(bytes_deduplicated, "bytes-deduplicated",
+            "Tensor bytes that reused an identical resource");
+  printStat(vtensor_type_hits, "vtensor-type-hits",
+            "Number of !torch.vtensor type lookups served by the cache");
+  printStat(vtensor_type_misses, "vtensor-type-misses",
+            "Number of !torch.vtensor types constructed");
+}
+
 // ---------------------------------------------------------------------------//
 // ModelInfo
 // ---------------------------------------------------------------------------//
@@ -472,6 +656,7 @@ void GraphInfo::InitializerMapEmplace(const std::string_view &name,
 // ---------------------------------------------------------------------------//
 
 MlirType ContextCache::ConvertTensorElementType(int elemType) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   auto it = elem_type_map_.find(elemType);
   if (it != elem_type_map_.end()) {
     return it->second;
@@ -542,12 +727,9 @@ MlirType ContextCache::ConvertTensorElementType(int elemType) {
   case onnx::TensorProto::FLOAT8E5M2FNUZ:
     t = mlirFloat8E5M2FNUZTypeGet(context_);
     break;
-  case onnx::TensorProto::STRING: {
-    const std::string typeAsm = "!torch.str";
-    t = mlirTypeParseGet(context_, toMlirStringRef(typeAsm));
-    assert(!mlirTypeIsNull(t));
+  case onnx::TensorProto::STRING:
+    t = torchMlirTorchStringTypeGet(context_);
     break;
-  }
   default: {
     std::string msg = "Unknown ONNX tensor element type: ";
     msg.append(std::to_string(elemType));
@@ -562,144 +744,120 @@ MlirType ContextCache::ConvertTensorElementType(int elemType) {
 }
 
 MlirType ContextCache::GetNoneType() {
-  std::string typeAsm = "!torch.none";
-  return mlirTypeParseGet(context_, toMlirStringRef(typeAsm));
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return torchMlirTorchNoneTypeGet(context_);
 }
 
-MlirType ContextCache::GetListType(const std::string &elementTypeAsm) {
-  auto it = list_type_map_.find(elementTypeAsm);
+MlirType ContextCache::GetListType(MlirType elementType) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto it = list_type_map_.find(elementType.ptr);
   if (it != list_type_map_.end()) {
     return it->second;
   }
 
-  std::string typeAsm = "!torch.list<" + elementTypeAsm + ">";
-  MlirType t = mlirTypeParseGet(context_, toMlirStringRef(typeAsm));
-  if (mlirTypeIsNull(t)) {
-    std::string msg =
-        "Unparseable torch type (MLIR asm format bug?): " + typeAsm;
-    model_info_.SetError(std::move(msg));
-    return {nullptr};
-  }
-  list_type_map_[elementTypeAsm] = t;
+  MlirType t = torchMlirTorchListTypeGet(elementType);
+  list_type_map_[elementType.ptr] = t;
   return t;
 }
 
-MlirType ContextCache::GetOptionalType(const std::string &elementTypeAsm) {
-  auto it = optional_type_map_.find(elementTypeAsm);
+MlirType ContextCache::GetOptionalType(MlirType elementType) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto it = optional_type_map_.find(elementType.ptr);
   if (it != optional_type_map_.end()) {
     return it->second;
   }
 
-  std::string typeAsm = "!torch.optional<" + elementTypeAsm + ">";
-  MlirType t = mlirTypeParseGet(context_, toMlirStringRef(typeAsm));
-  if (mlirTypeIsNull(t)) {
-    std::string msg =
-        "Unparseable torch type (MLIR asm format bug?): " + typeAsm;
-    model_info_.SetError(std::move(msg));
-    return {nullptr};
-  }
-  optional_type_map_[elementTypeAsm] = t;
+  MlirType t = torchMlirTorchOptionalTypeGet(elementType);
+  optional_type_map_[elementType.ptr] = t;
   return t;
 }
 
-FailureOr<std::string>
-ContextCache::GetListElementTypeAsm(const onnx::TypeProto &tp) {
+namespace {
+// Returns the dims of `shape`, with -1 for dynamic dims.
+std::vector<int64_t> getDims(const onnx::TensorShapeProto &shape) {
+  std::vector<int64_t> dims;
+  dims.reserve(shape.dim_size());
+  for (const onnx::TensorShapeProto::Dimension &dim : shape.dim()) {
+    if (dim.has_dim_value()) {
+      dims.push_back(dim.dim_value());
+    } else {
+      dims.push_back(-1);
+    }
+  }
+  return dims;
+}
+} // namespace
+
+MlirType ContextCache::ConvertListElementType(const onnx::TypeProto &tp) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (tp.has_tensor_type()) {
     const onnx::TypeProto_Tensor &tt = tp.tensor_type();
     if (tt.has_elem_type() && tt.elem_type()) {
       MlirType elementType = ConvertTensorElementType(tt.elem_type());
       assert(!mlirTypeIsNull(elementType));
-      std::vector<std::string> dims;
-      if (tt.has_shape()) {
-        dims.reserve(tt.shape().dim_size());
-        for (const onnx::TensorShapeProto::Dimension &dim : tt.shape().dim()) {
-          if (dim.has_dim_value()) {
-            dims.push_back(std::to_string(dim.dim_value()));
-          } else {
-            dims.push_back("?");
-          }
-        }
-      }
-      return "vtensor<[" + StringJoin(dims, ",") + "]," +
-             getMlirAsm(elementType) + ">";
+      std::vector<int64_t> dims;
+      if (tt.has_shape())
+        dims = getDims(tt.shape());
+      return GetVtensorType(dims, elementType);
     }
   }
 
   std::string msg = "Unsupported list element type.";
   model_info_.SetError(std::move(msg));
-  return failure;
+  return {nullptr};
 }
 
-FailureOr<std::string>
-ContextCache::GetOptionalElementTypeAsm(const onnx::TypeProto &tp) {
+MlirType ContextCache::ConvertOptionalElementType(const onnx::TypeProto &tp) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (tp.has_tensor_type()) {
     const onnx::TypeProto_Tensor &tt = tp.tensor_type();
     if (tt.has_elem_type()) {
       MlirType elementType = ConvertTensorElementType(tt.elem_type());
       assert(!mlirTypeIsNull(elementType));
-      std::vector<std::string> dims;
       assert(tt.has_shape());
-      dims.reserve(tt.shape().dim_size());
-      for (const onnx::TensorShapeProto::Dimension &dim : tt.shape().dim()) {
-        if (dim.has_dim_value()) {
-          dims.push_back(std::to_string(dim.dim_value()));
-        } else {
-          dims.push_back("?");
-        }
-      }
-      return "vtensor<[" + StringJoin(dims, ",") + "]," +
-             getMlirAsm(elementType) + ">";
+      return GetVtensorType(getDims(tt.shape()), elementType);
     }
   } else if (tp.has_sequence_type()) {
     const onnx::TypeProto_Sequence &st = tp.sequence_type();
     if (st.has_elem_type()) {
-      auto elementTypeAsm = GetListElementTypeAsm(st.elem_type());
-      if (failed(elementTypeAsm))
-        return failure;
-      return "list<" + *elementTypeAsm + ">";
+      MlirType elementType = ConvertListElementType(st.elem_type());
+      if (mlirTypeIsNull(elementType))
+        return {nullptr};
+      return GetListType(elementType);
     }
   }
 
   std::string msg = "Unsupported optional element type.";
   model_info_.SetError(std::move(msg));
-  return failure;
+  return {nullptr};
 }
 
 MlirType ContextCache::GetVtensorType(const std::vector<int64_t> &dims,
                                       MlirType elementType) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
 
   VTensorSign key = {dims, elementType};
 
+  ImportStats *stats = model_info_.GetConfig().stats;
   auto it = vtensor_type_map_.find(key);
   if (it != vtensor_type_map_.end()) {
+    if (stats)
+      ++stats->vtensor_type_hits;
     return it->second;
   }
+  if (stats)
+    ++stats->vtensor_type_misses;
 
-  std::vector<std::string> strDims;
-  strDims.reserve(dims.size());
-  for (const int64_t &dim : dims) {
-    if (dim == -1) {
-      strDims.push_back("?");
-    } else {
-      strDims.push_back(std::to_string(dim));
-    }
-  }
-
-  std::string typeAsm = "!torch.vtensor<[" + StringJoin(strDims, ",") + "]," +
-                        getMlirAsm(elementType) + ">";
-  MlirType t = mlirTypeParseGet(context_, toMlirStringRef(typeAsm));
-  if (mlirTypeIsNull(t)) {
-    std::string msg =
-        "Unparseable torch type (MLIR asm format bug?): " + typeAsm;
-    model_info_.SetError(std::move(msg));
-    return {nullptr};
-  }
+  // Dynamic dims are -1 in both ONNX and the torch dialect.
+  MlirType t = torchMlirTorchValueTensorTypeGet(context_, dims.size(),
+                                                dims.data(), elementType);
   vtensor_type_map_[key] = t;
   return t;
 }
 
 MlirType
 ContextCache::ConvertTensorProtoToVtensorType(const onnx::TensorProto &tp) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   assert(tp.has_data_type());
   MlirType elementType = ConvertTensorElementType(tp.data_type());
   if (mlirTypeIsNull(elementType))
@@ -716,6 +874,7 @@ ContextCache::ConvertTensorProtoToVtensorType(const onnx::TensorProto &tp) {
 
 MlirType
 ContextCache::ConvertTensorProtoToBuiltinType(const onnx::TensorProto &tp) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   assert(tp.has_data_type());
   MlirType elementType = ConvertTensorElementType(tp.data_type());
   if (mlirTypeIsNull(elementType))
@@ -732,6 +891,7 @@ ContextCache::ConvertTensorProtoToBuiltinType(const onnx::TensorProto &tp) {
 }
 
 MlirType ContextCache::ConvertTypeProto(const onnx::TypeProto *ptrTp) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (ptrTp == nullptr) {
     std::cerr << "WARNING: Found a node without a valid type proto. Consider "
                  "updating the opset_version of"
@@ -779,18 +939,18 @@ MlirType ContextCache::ConvertTypeProto(const onnx::TypeProto *ptrTp) {
   } else if (tp.has_sequence_type()) {
     const onnx::TypeProto_Sequence &st = tp.sequence_type();
     if (st.has_elem_type()) {
-      auto elementTypeAsm = GetListElementTypeAsm(st.elem_type());
-      if (failed(elementTypeAsm))
+      MlirType elementType = ConvertListElementType(st.elem_type());
+      if (mlirTypeIsNull(elementType))
         return {nullptr};
-      return GetListType(*elementTypeAsm);
+      return GetListType(elementType);
     }
   } else if (tp.has_optional_type()) {
     const onnx::TypeProto_Optional &ot = tp.optional_type();
     if (ot.has_elem_type()) {
-      auto elementTypeAsm = GetOptionalElementTypeAsm(ot.elem_type());
-      if (failed(elementTypeAsm))
+      MlirType elementType = ConvertOptionalElementType(ot.elem_type());
+      if (mlirTypeIsNull(elementType))
         return {nullptr};
-      return GetOptionalType(*elementTypeAsm);
+      return GetOptionalType(elementType);
     }
   } else if (tp.value_case() == onnx::TypeProto::ValueCase::VALUE_NOT_SET) {
     // (sometime happens for unused function arguments)
@@ -804,69 +964,93 @@ MlirType ContextCache::ConvertTypeProto(const onnx::TypeProto *ptrTp) {
 
 MlirAttribute
 ContextCache::ConvertTensorProtoToAttr(const onnx::TensorProto &tp) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   MlirType tensorType = ConvertTensorProtoToBuiltinType(tp);
-  if (tp.has_raw_data()) {
-    std::string sanitizedName = SanitizeNameAsIdentifier(tp.name());
-    // Conveniently, DenseResourceElementsAttr shares the raw data
-    // format. We just give it maximum numeric alignment.
-    return mlirUnmanagedDenseResourceElementsAttrGet(
-        tensorType, toMlirStringRef(sanitizedName),
-        const_cast<void *>(static_cast<const void *>(tp.raw_data().data())),
-        tp.raw_data().size(), /*dataAlignment=*/8, /*dataIsMutable=*/false,
-        /*deleter=*/nullptr, /*userData=*/nullptr);
-  } else {
-    switch (tp.data_type()) {
-    case onnx::TensorProto::DataType::TensorProto_DataType_FLOAT:
-      return mlirDenseElementsAttrFloatGet(tensorType, tp.float_data_size(),
-                                           tp.float_data().data());
-    case onnx::TensorProto::DataType::TensorProto_DataType_BOOL:
-      // NOTE: At the time of writing there are no passing e2e tests that use
-      // this. onnx-ml.proto documentation is not clear about how bools are
-      // organized in an int32 buffer.
-      return mlirDenseElementsAttrBoolGet(tensorType, tp.int32_data_size(),
-                                          tp.int32_data().data());
-    case onnx::TensorProto::DataType::TensorProto_DataType_UINT8: {
-      // Special case. See proto.
-      auto data = elementwiseCast<uint8_t>(
-          std::span(tp.int32_data().data(), tp.int32_data_size()));
-      return mlirDenseElementsAttrUInt8Get(tensorType, data.size(),
-                                           data.data());
-    }
-    case onnx::TensorProto::DataType::TensorProto_DataType_INT8: {
-      // Special case. See proto.
-      auto data = elementwiseCast<int8_t>(
-          std::span(tp.int32_data().data(), tp.int32_data_size()));
-      return mlirDenseElementsAttrInt8Get(tensorType, data.size(), data.data());
-    }
-    case onnx::TensorProto::DataType::TensorProto_DataType_INT16: {
-      // Special case. See proto.
-      auto data = elementwiseCast<int16_t>(
-          std::span(tp.int32_data().data(), tp.int32_data_size()));
-      return mlirDenseElementsAttrInt16Get(tensorType, data.size(),
-                                           data.data());
-    }
-    case onnx::TensorProto::DataType::TensorProto_DataType_INT32:
-      return mlirDenseElementsAttrInt32Get(tensorType, tp.int32_data_size(),
-                                           tp.int32_data().data());
-    case onnx::TensorProto::DataType::TensorProto_DataType_INT64:
-      return mlirDenseElementsAttrInt64Get(tensorType, tp.int64_data_size(),
-                                           tp.int64_data().data());
-    case onnx::TensorProto::DataType::TensorProto_DataType_DOUBLE:
-      return mlirDenseElementsAttrDoubleGet(tensorType, tp.double_data_size(),
-                                            tp.double_data().data());
-    case onnx::TensorProto::DataType::TensorProto_DataType_UINT32: {
-      // Special case. See proto.
-      auto data = elementwiseCast<uint32_t>(
-          std::span(tp.uint64_data().data(), tp.uint64_data_size()));
-      return mlirDenseElementsAttrUInt32Get(tensorType, data.size(),
-                                            data.data());
+  std::optional<std::span<const char>> rawData;
+  if (tp.has_data_location() &&
+      tp.data_location() == onnx::TensorProto::EXTERNAL) {
+    // External data takes precedence over anything stored in the proto.
+    const auto &resolver = model_info_.GetConfig().external_data_resolver;
+    if (resolver)
+      rawData = resolver(tp);
+    if (!rawData) {
+      std::string message =
+          "Unable to resolve external data of ONNX TensorProto: ";
+      message.append(tp.name());
+      model_info_.SetError(std::move(message));
+      return {nullptr};
     }
-    case onnx::TensorProto::DataType::TensorProto_DataType_UINT64:
-      return mlirDenseElementsAttrUInt64Get(tensorType, tp.uint64_data_size(),
-                                            tp.uint64_data().data());
+  } else if (tp.has_raw_data()) {
+    rawData = std::span<const char>(tp.raw_data().data(), tp.raw_data().size());
+  }
 
-      // Intentionally unsupported: STRING
-    }
+  std::string sanitizedName = SanitizeNameAsIdentifier(tp.name());
+  if (rawData) {
+    // Conveniently, DenseResourceElementsAttr shares the raw data
+    // format. We just give it maximum numeric alignment.
+    return GetResourceAttr(tensorType, sanitizedName, *rawData,
+                           /*alignment=*/8);
+  }
+
+  // Tensors with few elements, e.g. the shapes and axes that ops take as
+  // constant operands, stay dense elements so that they are easy to match
+  // and fold.
+  int64_t numElements = std::accumulate(tp.dims().begin(), tp.dims().end(),
+                                        int64_t{1}, std::multiplies<>());
+  if (numElements <= kMaxDenseTypedFieldElements) {
+    MlirAttribute attr = ConvertTypedFieldToDenseAttr(tensorType, tp);
+    if (!mlirAttributeIsNull(attr))
+      return attr;
+  }
+
+  // The typed fields of larger tensors hold the elements in host layout. When
+  // their storage type matches the element type, the field is referenced in
+  // place (like `raw_data` above). Narrower element types (see proto) are
+  // converted once into a blob owned by the attribute.
+  auto span = [](const auto &field) {
+    return std::span(field.data(), static_cast<size_t>(field.size()));
+  };
+  switch (tp.data_type()) {
+  case onnx::TensorProto::DataType::TensorProto_DataType_FLOAT:
+    return GetResourceAttr(tensorType, sanitizedName, AsBytes(tp.float_data()),
+                           alignof(float));
+  case onnx::TensorProto::DataType::TensorProto_DataType_BOOL:
+    // NOTE: At the time of writing there are no passing e2e tests that use
+    // this. onnx-ml.proto documentation is not clear about how bools are
+    // organized in an int32 buffer.
+    return mlirDenseElementsAttrBoolGet(tensorType, tp.int32_data_size(),
+                                        tp.int32_data().data());
+  case onnx::TensorProto::DataType::TensorProto_DataType_UINT8:
+    return GetResourceAttr(tensorType, sanitizedName,
+                           ConvertToNewBuffer<uint8_t>(span(tp.int32_data())),
+                           alignof(uint8_t), DeleteArray<uint8_t>);
+  case onnx::TensorProto::DataType::TensorProto_DataType_INT8:
+    return GetResourceAttr(tensorType, sanitizedName,
+                           ConvertToNewBuffer<int8_t>(span(tp.int32_data())),
+                           alignof(int8_t), DeleteArray<int8_t>);
+  case onnx::TensorProto::DataType::TensorProto_DataType_INT16:
+    return GetResourceAttr(tensorType, sanitizedName,
+                           ConvertToNewBuffer<int16_t>(span(tp.int32_data())),
+                           alignof(int16_t), DeleteArray<int16_t>);
+  case onnx::TensorProto::DataType::TensorProto_DataType_INT32:
+    return GetResourceAttr(tensorType, sanitizedName, AsBytes(tp.int32_data()),
+                           alignof(int32_t));
+  case onnx::TensorProto::DataType::TensorProto_DataType_INT64:
+    return GetResourceAttr(tensorType, sanitizedName, AsBytes(tp.int64_data()),
+                           alignof(int64_t));
+  case onnx::TensorProto::DataType::TensorProto_DataType_DOUBLE:
+    return GetResourceAttr(tensorType, sanitizedName,
+                           AsBytes(tp.double_data()), alignof(double));
+  case onnx::TensorProto::DataType::TensorProto_DataType_UINT32:
+    return GetResourceAttr(
+        tensorType, sanitizedName,
+        ConvertToNewBuffer<uint32_t>(span(tp.uint64_data())),
+        alignof(uint32_t), DeleteArray<uint32_t>);
+  case onnx::TensorProto::DataType::TensorProto_DataType_UINT64:
+    return GetResourceAttr(tensorType, sanitizedName,
+                           AsBytes(tp.uint64_data()), alignof(uint64_t));
+
+    // Intentionally unsupported: STRING
   }
 
   std::string message =
@@ -876,6 +1060,46 @@ ContextCache::ConvertTensorProtoToAttr(const onnx::TensorProto &tp) {
   return {nullptr};
 }
 
+MlirAttribute
+ContextCache::GetResourceAttr(MlirType type, std::string_view name,
+                              std::span<const char> data, size_t alignment,
+                              ResourceDeleterFn deleter) {
+  const Config &config = model_info_.GetConfig();
+  ImportStats *stats = config.stats;
+  std::vector<ResourceEntry> *entries = nullptr;
+  std::optional<uint64_t> hash;
+  if (config.deduplicate_constants &&
+      data.size() <= config.max_deduplicated_constant_bytes) {
+    // Only tensors that share a type (and thus a size) with an earlier one are
+    // hashed, so unique tensors are never read here.
+    entries = &resource_map_[{type.ptr, data.size()}];
+    if (!entries->empty())
+      hash = HashBytes(data);
+    for (ResourceEntry &entry : *entries) {
+      if (!entry.hash)
+        entry.hash = HashBytes(entry.data);
+      if (*entry.hash != *hash ||
+          !std::equal(data.begin(), data.end(), entry.data.begin()))
+        continue;
+      if (deleter)
+        deleter(/*userData=*/nullptr, data.data(), data.size(), alignment);
+      if (stats)
+        stats->bytes_deduplicated += data.size();
+      return entry.attr;
+    }
+  }
+
+  MlirAttribute attr = mlirUnmanagedDenseResourceElementsAttrGet(
+      type, toMlirStringRef(name),
+      const_cast<void *>(static_cast<const void *>(data.data())), data.size(),
+      alignment, /*dataIsMutable=*/false, deleter, /*userData=*/nullptr);
+  if (entries)
+    entries->push_back({data, attr, hash});
+  if (stats)
+    (deleter ? stats->bytes_copied : stats->bytes_borrowed) += data.size();
+  return attr;
+}
+
 bool ContextCache::VTensorSign::operator==(const VTensorSign &rhs) const {
   return dims == rhs.dims && element_type.ptr == rhs.element_type.ptr;
 }
@@ -890,6 +1114,49 @@ std::size_t ContextCache::VTensorSignHash::operator()(
 // ---------------------------------------------------------------------------//
 // ModuleCache
 // ---------------------------------------------------------------------------//
+namespace {
+
+// The key of the function whose body is being imported on this thread.
+thread_local const std::string *currentFunctionKey = nullptr;
+
+// Bump this whenever the IR imported for ONNX functions changes, to
+// invalidate existing function cache entries.
+constexpr int kFunctionCacheVersion = 2;
+constexpr const char *kFunctionCacheKeyAttr = "torch.onnx_function_cache.key";
+
+std::string GetFunctionCacheKey(const std::string &key, int irVersion) {
+  return std::to_string(kFunctionCacheVersion) + "\n" +
+         onnx::LAST_RELEASE_VERSION + "\n" + std::to_string(irVersion) + "\n" +
+         key;
+}
+
+std::filesystem::path GetFunctionCachePath(const std::string &cacheDir,
+                                           const std::string &cacheKey) {
+  // FNV-1a, which unlike std::hash is stable across runs and platforms.
+  // Collisions are caught by the key stored in the entry.
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : cacheKey) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  char fileName[32];
+  std::snprintf(fileName, sizeof(fileName), "%016llx.mlirbc",
+                static_cast<unsigned long long>(hash));
+  return std::filesystem::path(cacheDir) / fileName;
+}
+
+std::string_view toStringView(MlirStringRef s) {
+  return std::string_view(s.data, s.length);
+}
+
+} // namespace
+
+ModuleCache::ModuleCache(MlirOperation moduleOp, ContextCache &cc,
+                         bool deferFunctionBodies)
+    : cc_(cc), m_(moduleOp), defer_function_bodies_(deferFunctionBodies) {}
+
+ModuleCache::~ModuleCache() = default;
+
 FailureOr<std::optional<MlirOperation>> ModuleCache::GetOperatorFunction(
     std::string_view opName, std::string_view opDomain, int opsetVersion,
     int irVersion, std::span<const onnx::TypeProto *const> inputTypeProtos,
@@ -1002,10 +1269,26 @@ FailureOr<std::optional<MlirOperation>> ModuleCache::GetOperatorFunction(
     key = keyBuffer.str();
   }
 
+  // Specialization and function definition (which inserts into the module
+  // body) are serialized; only the function bodies are imported concurrently.
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto recordCall = [&]() {
+    if (config.function_cache_dir)
+      RecordCall(key);
+  };
   auto it = operator_function_map_.find(key);
   if (it != operator_function_map_.end()) {
+    recordCall();
     return std::optional<MlirOperation>(it->second);
   }
+  if (std::optional<MlirOperation> cachedOp =
+          LoadCachedFunction(key, irVersion, config)) {
+    if (config.stats)
+      ++config.stats->num_cached_functions;
+    recordCall();
+    return cachedOp;
+  }
+  auto expansionStart = std::chrono::steady_clock::now();
 
   onnx::ModelProto tmpModelProto;
   if (isContextDependent) {
@@ -1028,7 +1311,8 @@ FailureOr<std::optional<MlirOperation>> ModuleCache::GetOperatorFunction(
         inputTypeProtos, outputTypeProtos, callerNode);
   }
 
-  ModelInfo tmpModelInfo(std::move(tmpModelProto), config);
+  ModelInfo &tmpModelInfo = *function_model_infos_.emplace_back(
+      std::make_unique<ModelInfo>(std::move(tmpModelProto), config));
   Status initS = tmpModelInfo.Initialize();
   if (failed(initS))
     return failure;
@@ -1040,15 +1324,211 @@ FailureOr<std::optional<MlirOperation>> ModuleCache::GetOperatorFunction(
   if (failed(imp))
     return failure;
 
-  Status importS = imp->ImportAll();
+  MlirOperation funcOp = imp->GetParentOp();
+  operator_function_map_[key] = funcOp;
+  if (config.stats) {
+    ++config.stats->num_expanded_functions;
+    config.stats->function_expansion_nanoseconds +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - expansionStart)
+            .count();
+  }
+  recordCall();
+  if (config.function_cache_dir)
+    expanded_functions_.emplace_back(key, irVersion);
+  if (defer_function_bodies_) {
+    deferred_functions_.push_back(
+        {key, &tmpModelInfo, std::make_unique<NodeImporter>(std::move(*imp))});
+    deferred_functions_cv_.notify_one();
+    return std::optional<MlirOperation>(funcOp);
+  }
+
+  // The body may define further functions.
+  lock.unlock();
+  Status importS = ImportFunctionBody(key, *imp);
   if (failed(importS))
     return failure;
-
-  MlirOperation &funcOp = imp->GetParentOp();
-  operator_function_map_[key] = funcOp;
   return std::optional<MlirOperation>(funcOp);
 }
 
+Status ModuleCache::ImportFunctionBody(const std::string &key,
+                                       NodeImporter &importer) {
+  const std::string *enclosingKey = currentFunctionKey;
+  currentFunctionKey = &key;
+  Status importS = importer.ImportAll();
+  currentFunctionKey = enclosingKey;
+  return importS;
+}
+
+void ModuleCache::RecordCall(const std::string &calleeKey) {
+  if (currentFunctionKey)
+    callees_[*currentFunctionKey].push_back(calleeKey);
+}
+
+std::optional<MlirOperation>
+ModuleCache::LoadCachedFunction(const std::string &key, int irVersion,
+                                const Config &config) {
+  if (!config.function_cache_dir)
+    return std::nullopt;
+  std::string cacheKey = GetFunctionCacheKey(key, irVersion);
+  std::filesystem::path path =
+      GetFunctionCachePath(*config.function_cache_dir, cacheKey);
+  std::ifstream stream(path, std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    return std::nullopt;
+  // Resources of the parsed IR may reference the buffer, so it is kept alive
+  // along with the module.
+  const std::string &contents =
+      *cached_function_buffers_.emplace_back(std::make_unique<std::string>(
+          std::istreambuf_iterator<char>(stream),
+          std::istreambuf_iterator<char>()));
+
+  MlirContext context = mlirOperationGetContext(m_);
+  MlirOperation cachedModule = mlirOperationCreateParse(
+      context, toMlirStringRef(contents), toMlirStringRef(path.string()));
+  if (mlirOperationIsNull(cachedModule))
+    return std::nullopt;
+  MlirAttribute keyAttr = mlirOperationGetDiscardableAttributeByName(
+      cachedModule, toMlirStringRef(kFunctionCacheKeyAttr));
+  if (mlirAttributeIsNull(keyAttr) || !mlirAttributeIsAString(keyAttr) ||
+      toStringView(mlirStringAttrGetValue(keyAttr)) != cacheKey) {
+    mlirOperationDestroy(cachedModule);
+    return std::nullopt;
+  }
+
+  // The entry holds the function and all of its transitive callees. Move the
+  // ones that are not defined yet into the module.
+  MlirBlock cachedBody =
+      mlirRegionGetFirstBlock(mlirOperationGetRegion(cachedModule, 0));
+  MlirBlock moduleBody = mlirRegionGetFirstBlock(mlirOperationGetRegion(m_, 0));
+  std::vector<MlirOperation> cachedFuncs;
+  for (MlirOperation op = mlirBlockGetFirstOperation(cachedBody);
+       !mlirOperationIsNull(op); op = mlirOperationGetNextInBlock(op))
+    cachedFuncs.push_back(op);
+  std::optional<MlirOperation> funcOp;
+  for (MlirOperation op : cachedFuncs) {
+    std::string name(toStringView(mlirStringAttrGetValue(
+        mlirOperationGetAttributeByName(op, toMlirStringRef("sym_name")))));
+    if (name != key)
+      callees_[key].push_back(name);
+    if (operator_function_map_.count(name))
+      continue;
+    mlirOperationRemoveFromParent(op);
+    mlirBlockAppendOwnedOperation(moduleBody, op);
+    operator_function_map_[name] = op;
+    if (name == key)
+      funcOp = op;
+  }
+  mlirOperationDestroy(cachedModule);
+  return funcOp;
+}
+
+void ModuleCache::SaveFunctionsToCache(const Config &config) {
+  if (!config.function_cache_dir)
+    return;
+  // The cache is best effort: failing to write an entry only means that it
+  // will be expanded again next time.
+  std::error_code ec;
+  std::filesystem::create_directories(*config.function_cache_dir, ec);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  MlirContext context = mlirOperationGetContext(m_);
+  for (const auto &[key, irVersion] : expanded_functions_) {
+    std::string cacheKey = GetFunctionCacheKey(key, irVersion);
+    std::filesystem::path path =
+        GetFunctionCachePath(*config.function_cache_dir, cacheKey);
+    if (std::filesystem::exists(path, ec))
+      continue;
+
+    MlirModule cachedModule =
+        mlirModuleCreateEmpty(mlirLocationUnknownGet(context));
+    MlirBlock cachedBody = mlirModuleGetBody(cachedModule);
+    std::vector<std::string> worklist = {key};
+    std::unordered_set<std::string> visited;
+    while (!worklist.empty()) {
+      std::string name = std::move(worklist.back());
+      worklist.pop_back();
+      if (!visited.insert(name).second)
+        continue;
+      auto funcIt = operator_function_map_.find(name);
+      if (funcIt == operator_function_map_.end())
+        continue;
+      mlirBlockAppendOwnedOperation(cachedBody,
+                                    mlirOperationClone(funcIt->second));
+      auto calleesIt = callees_.find(name);
+      if (calleesIt != callees_.end())
+        worklist.insert(worklist.end(), calleesIt->second.begin(),
+                        calleesIt->second.end());
+    }
+    MlirOperation cachedModuleOp = mlirModuleGetOperation(cachedModule);
+    mlirOperationSetDiscardableAttributeByName(
+        cachedModuleOp, toMlirStringRef(kFunctionCacheKeyAttr),
+        mlirStringAttrGet(context, toMlirStringRef(cacheKey)));
+
+    // Write to a temporary file first, so that importers running
+    // concurrently never read partial entries.
+    std::filesystem::path tempPath = path;
+    tempPath += "." + std::to_string(std::random_device{}()) + ".tmp";
+    bool written;
+    {
+      std::ofstream stream(tempPath, std::ios::out | std::ios::binary);
+      mlirOperationWriteBytecode(
+          cachedModuleOp,
+          [](MlirStringRef chunk, void *userData) {
+            static_cast<std::ofstream *>(userData)->write(chunk.data,
+                                                          chunk.length);
+          },
+          &stream);
+      written = stream.good();
+    }
+    if (written)
+      std::filesystem::rename(tempPath, path, ec);
+    if (!written || ec)
+      std::filesystem::remove(tempPath, ec);
+    mlirModuleDestroy(cachedModule);
+  }
+}
+
+Status ModuleCache::ImportDeferredFunctions(unsigned numThreads) {
+  size_t numActive = 0;
+  bool anyFailed = false;
+  auto worker = [&]() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      // Wait until there is work, or until no running import can produce any.
+      deferred_functions_cv_.wait(lock, [&]() {
+        return !deferred_functions_.empty() || numActive == 0;
+      });
+      if (deferred_functions_.empty())
+        return;
+      DeferredFunction function = std::move(deferred_functions_.front());
+      deferred_functions_.pop_front();
+      ++numActive;
+
+      lock.unlock();
+      Status importS = ImportFunctionBody(function.key, *function.importer);
+      lock.lock();
+
+      --numActive;
+      if (failed(importS) && !anyFailed) {
+        anyFailed = true;
+        error_message_ = function.model_info->GetErrorMessage();
+        // Stop handing out work; the module is incomplete anyway.
+        deferred_functions_.clear();
+      }
+      deferred_functions_cv_.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < numThreads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread &thread : threads)
+    thread.join();
+  return Status::success(!anyFailed);
+}
+
 // ---------------------------------------------------------------------------//
 // NodeImporter
 // ---------------------------------------------------------------------------//
@@ -1140,6 +1620,16 @@ FailureOr<NodeImporter> NodeImporter::DefineFunction(GraphInfo &graphInfo,
     }
   }
 
+  if (graphInfo.GetModelInfo().GetConfig().bind_symbolic_dims) {
+    imp.ImportDimSymbols(defaultLoc);
+    size_t index = 0;
+    for (const auto &input : graphInfo.GetInputMap()) {
+      imp.BindSymbolicDims(mlirBlockGetArgument(bodyBlock, index),
+                           &input.second.type(), defaultLoc);
+      ++index;
+    }
+  }
+
   imp.PopulateGraphAttrs(funcOp);
   return std::move(imp);
 }
@@ -1252,7 +1742,76 @@ MlirValue NodeImporter::GetNone() {
   return none;
 }
 
+void NodeImporter::ImportDimSymbols(MlirLocation loc) {
+  dim_symbols_ = std::make_shared<std::unordered_map<std::string, MlirValue>>();
+  MlirType i64Type = mlirIntegerTypeGet(context_, 64);
+  auto importDims = [&](const onnx::ValueInfoProto &vi) {
+    for (const onnx::TensorShapeProto_Dimension &dim :
+         vi.type().tensor_type().shape().dim()) {
+      if (!dim.has_dim_param() || dim_symbols_->contains(dim.dim_param()))
+        continue;
+      MlirOperation symbolOp = createMlirOperationAtEnd(
+          body_block_, "torch.symbolic_int", loc,
+          torchMlirTorchIntTypeGet(context_),
+          toMlirNamedAttribute(
+              "symbol_name",
+              mlirStringAttrGet(context_, toMlirStringRef(dim.dim_param()))),
+          toMlirNamedAttribute("min_val", mlirIntegerAttrGet(i64Type, 0)),
+          toMlirNamedAttribute(
+              "max_val", mlirIntegerAttrGet(
+                             i64Type, std::numeric_limits<int64_t>::max())));
+      (*dim_symbols_)[dim.dim_param()] = mlirOperationGetResult(symbolOp, 0);
+    }
+  };
+  for (const auto &input : graph_info_.GetInputMap())
+    importDims(input.second);
+  for (const onnx::ValueInfoProto &vi :
+       graph_info_.GetGraphProto().value_info())
+    importDims(vi);
+  for (const onnx::ValueInfoProto &vi : graph_info_.GetGraphProto().output())
+    importDims(vi);
+}
+
+void NodeImporter::BindSymbolicDims(MlirValue value, const onnx::TypeProto *tp,
+                                    MlirLocation loc) {
+  if (!tp || !tp->has_tensor_type() || !tp->tensor_type().has_shape())
+    return;
+  // Operands are the value followed by the symbols of its distinct named dims,
+  // which the shape expressions refer to by position.
+  std::vector<MlirValue> operands = {value};
+  std::unordered_map<std::string_view, MlirAffineExpr> symbolExprs;
+  std::vector<MlirAffineExpr> exprs;
+  for (const onnx::TensorShapeProto_Dimension &dim :
+       tp->tensor_type().shape().dim()) {
+    if (dim.has_dim_value()) {
+      exprs.push_back(mlirAffineConstantExprGet(context_, dim.dim_value()));
+      continue;
+    }
+    if (!dim.has_dim_param())
+      return;
+    auto foundIt = dim_symbols_->find(dim.dim_param());
+    if (foundIt == dim_symbols_->end())
+      return;
+    auto [exprIt, inserted] = symbolExprs.try_emplace(dim.dim_param());
+    if (inserted) {
+      exprIt->second = mlirAffineSymbolExprGet(context_, operands.size() - 1);
+      operands.push_back(foundIt->second);
+    }
+    exprs.push_back(exprIt->second);
+  }
+  if (operands.size() == 1)
+    return;
+  MlirAffineMap map = mlirAffineMapGet(context_, /*dimCount=*/0,
+                                       operands.size() - 1, exprs.size(),
+                                       exprs.data());
+  createMlirOperationAtEnd(
+      body_block_, "torch.bind_symbolic_shape", loc, operands,
+      toMlirNamedAttribute("shape_expressions", mlirAffineMapAttrGet(map)));
+}
+
 Status NodeImporter::ImportNode(const onnx::NodeProto &node) {
+  if (ImportStats *stats = graph_info_.GetModelInfo().GetConfig().stats)
+    ++stats->num_nodes;
   std::string_view opType = node.op_type();
   // Handle special-form op types that do not go down the generic path.
   if (opType == "Constant") {
@@ -1360,6 +1919,8 @@ Status NodeImporter::ImportGeneralNode(const onnx::NodeProto &node) {
     MlirValue result = mlirOperationGetResult(customOp, index);
     std::string_view name = node.output()[index];
     nv_map_[name] = result;
+    if (dim_symbols_)
+      BindSymbolicDims(result, outputTypeProtos[index], loc);
   }
 
   return success;
@@ -1538,6 +2099,7 @@ Status NodeImporter::ImportRegions(
         return SetError(std::move(msg));
       }
     }
+    importer.dim_symbols_ = dim_symbols_;
 
     if (failed(importer.ImportAll(/*func=*/false)))
       return failure;
@@ -1554,18 +2116,36 @@ NodeImporter::ImportInitializer(const onnx::TensorProto &initializer,
   MlirLocation loc = mlirLocationNameGet(context_, toMlirStringRef(name),
                                          /*childLoc=*/{nullptr});
 
+  if (ImportStats *stats = graph_info_.GetModelInfo().GetConfig().stats)
+    ++stats->num_initializers;
   MlirAttribute valueAttr = cc_.ConvertTensorProtoToAttr(initializer);
   MlirType vtensorType = cc_.ConvertTensorProtoToVtensorType(initializer);
   if (mlirAttributeIsNull(valueAttr) || mlirTypeIsNull(vtensorType))
     return failure;
 
-  MlirOperation op = createMlirOperationAtEnd(
-      body_block_, "torch.operator", loc, vtensorType,
-      toMlirNamedAttribute(
-          "name",
-          mlirStringAttrGet(context_, toMlirStringRef("onnx.Constant"))),
-      toMlirNamedAttribute("torch.onnx.value", valueAttr));
-  MlirValue result = mlirOperationGetResult(op, 0);
+  // Identical constants share their attribute (see
+  // `Config::deduplicate_constants`), and then also their op.
+  MlirValue result = {nullptr};
+  bool deduplicate =
+      graph_info_.GetModelInfo().GetConfig().deduplicate_constants;
+  std::pair<const void *, const void *> constantKey = {valueAttr.ptr,
+                                                       vtensorType.ptr};
+  if (deduplicate) {
+    auto foundIt = constant_map_.find(constantKey);
+    if (foundIt != constant_map_.end())
+      result = foundIt->second;
+  }
+  if (mlirValueIsNull(result)) {
+    MlirOperation op = createMlirOperationAtEnd(
+        body_block_, "torch.operator", loc, vtensorType,
+        toMlirNamedAttribute(
+            "name",
+            mlirStringAttrGet(context_, toMlirStringRef("onnx.Constant"))),
+        toMlirNamedAttribute("torch.onnx.value", valueAttr));
+    result = mlirOperationGetResult(op, 0);
+    if (deduplicate)
+      constant_map_[constantKey] = result;
+  }
 
   auto inserted = nv_map_.insert(std::make_pair(name, result));
   if (!inserted.second) {
@@ -1579,15 +2159,22 @@ NodeImporter::ImportInitializer(const onnx::TensorProto &initializer,
   return success;
 }
 
-void NodeImporter::WriteModule(std::ostream *stream, bool assumeVerified) {
-  MlirOpPrintingFlags flags = mlirOpPrintingFlagsCreate();
-  if (assumeVerified) {
-    mlirOpPrintingFlagsAssumeVerified(flags);
-  }
+void NodeImporter::WriteModule(std::ostream *stream, bool assumeVerified,
+                               bool emitBytecode) {
   auto callback = +[](MlirStringRef sr, void *s) {
     std::ostream *stream = static_cast<std::ostream *>(s);
     stream->write(sr.data, sr.length);
   };
+  if (emitBytecode) {
+    mlirOperationWriteBytecode(module_op_, callback,
+                               static_cast<void *>(stream));
+    return;
+  }
+
+  MlirOpPrintingFlags flags = mlirOpPrintingFlagsCreate();
+  if (assumeVerified) {
+    mlirOpPrintingFlagsAssumeVerified(flags);
+  }
   mlirOperationPrintWithFlags(module_op_, flags, callback,
                               static_cast<void *>(stream));
   mlirOpPrintingFlagsDestroy(flags);
@@ -1619,8 +2206,8 @@ Status NodeImporter::ImportConstantNodeValueAttr(const onnx::NodeProto &node) {
   return success;
 }
 
-OnnxImporter::MlirState::MlirState() {
-  context_ = mlirContextCreateWithThreading(false);
+OnnxImporter::MlirState::MlirState(bool enableThreading) {
+  context_ = mlirContextCreateWithThreading(enableThreading);
   torchMlirRegisterAllDialects(context_);
   module_ = mlirModuleCreateEmpty(mlirLocationUnknownGet(context_));
 }
@@ -1643,11 +2230,16 @@ Status OnnxImporter::Import(onnx::ModelProto &&modelProto,
     return failure;
   }
 
-  MlirState s;
+  // Importing function bodies concurrently requires the context to guard its
+  // uniquing tables.
+  bool parallelImport = config.num_import_threads > 1;
+  MlirState s(/*enableThreading=*/parallelImport);
   MlirOperation mOp = mlirModuleGetOperation(s.module_);
 
   ContextCache cc(modelInfo, mlirOperationGetContext(mOp));
-  ModuleCache mc(mOp, cc);
+  ModuleCache mc(mOp, cc, /*deferFunctionBodies=*/parallelImport);
+  std::optional<ImportStats::Phase> graphPhase;
+  graphPhase.emplace(config.stats, "Import graph");
   auto importer =
       NodeImporter::DefineFunction(modelInfo.GetMainGraph(), mOp, cc, mc);
 
@@ -1661,14 +2253,30 @@ Status OnnxImporter::Import(onnx::ModelProto &&modelProto,
               << modelInfo.GetErrorMessage() << "\n";
     return failure;
   }
+  if (config.stats && config.stats->num_expanded_functions > 0)
+    config.stats->AddPhase("Function expansion (summed over threads)",
+                           config.stats->function_expansion_nanoseconds / 1e9);
+  graphPhase.reset();
+
+  if (parallelImport) {
+    ImportStats::Phase phase(config.stats, "Import function bodies");
+    if (failed(mc.ImportDeferredFunctions(config.num_import_threads))) {
+      std::cerr << "error: Could not import one or more ONNX functions: "
+                << mc.GetErrorMessage() << "\n";
+      return failure;
+    }
+  }
 
   if (!config.no_verify) {
+    ImportStats::Phase phase(config.stats, "Verify");
     if (!mlirOperationVerify(mOp)) {
       std::cerr << "error: Module op doesn't verify.\n";
       return failure;
     }
   }
+  mc.SaveFunctionsToCache(config);
 
-  importer->WriteModule(outputStream, !config.no_verify);
+  ImportStats::Phase phase(config.stats, "Output");
+  importer->WriteModule(outputStream, !config.no_verify, config.emit_bytecode);
   return success;
 }
@@ -23,10 +23,20 @@
 #include "Dict.hpp"
 #include "Status.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <ostream>
 #include <span>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace onnx {
 using AttrList = google::protobuf::RepeatedPtrField<AttributeProto>;
@@ -37,13 +47,73 @@ namespace torch_mlir_onnx {
 template <typename T> using opt_ref = std::optional<std::reference_wrapper<T>>;
 
 struct Config;
+struct ImportStats;
 class GraphInfo;
 class ModelInfo;
+class NodeImporter;
+
+/// Opt-in instrumentation of an import: wall times of its phases and
+/// counters, reported in the format of MLIR's `-mlir-timing` and
+/// `-mlir-pass-statistics` output.
+struct ImportStats {
+  /// Times a phase from construction to destruction. Phases started while
+  /// another one is running are nested under it. Not thread-safe; phases are
+  /// only timed on the importing thread.
+  class Phase {
+  public:
+    Phase(ImportStats *stats, std::string name);
+    Phase(const Phase &) = delete;
+    Phase &operator=(const Phase &) = delete;
+    ~Phase();
+
+  private:
+    ImportStats *stats_;
+    size_t index_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  struct PhaseTime {
+    std::string name;
+    unsigned depth;
+    double seconds;
+  };
+  std::vector<PhaseTime> phases;
+  unsigned current_depth = 0;
+
+  /// Adds a phase that was timed separately (e.g. summed over threads),
+  /// nested under the running phase.
+  void AddPhase(std::string name, double seconds) {
+    phases.push_back({std::move(name), current_depth, seconds});
+  }
+
+  // Counters, which may be updated from concurrent importers.
+  std::atomic<uint64_t> num_nodes = 0;
+  std::atomic<uint64_t> num_initializers = 0;
+  std::atomic<uint64_t> num_expanded_functions = 0;
+  std::atomic<uint64_t> num_cached_functions = 0;
+  std::atomic<uint64_t> function_expansion_nanoseconds = 0;
+  std::atomic<uint64_t> bytes_borrowed = 0;
+  std::atomic<uint64_t> bytes_copied = 0;
+  std::atomic<uint64_t> bytes_deduplicated = 0;
+  std::atomic<uint64_t> vtensor_type_hits = 0;
+  std::atomic<uint64_t> vtensor_type_misses = 0;
+
+  void Print(std::ostream &os) const;
+};
 
 struct Config {
+  // If set, the import records timings and counters here.
+  ImportStats *stats = nullptr;
+
   // Disable verification prior to printing
   bool no_verify = false;
 
+  // Write the module as MLIR bytecode instead of text. Resources are stored
+  // as aligned, uncompressed sections of the bytecode, which tools reading
+  // the file through a memory-mapped buffer (such as torch-mlir-opt) use in
+  // place instead of parsing hex blobs.
+  bool emit_bytecode = false;
+
   // Ancient ONNX exporters would often add a model input for anything that
   // might be mutable, providing an initializer for it as well. More modern
   // tools tools realized this is a really bad idea for a lot of reasons.
@@ -54,6 +124,12 @@ struct Config {
   // making an assumption.
   bool elide_initialized_inputs = true;
 
+  // Import the named dims (`dim_param`s) of the function's tensors as
+  // `torch.symbolic_int` ops, one per name, and bind the shapes of the
+  // tensors to them with `torch.bind_symbolic_shape`, so that dynamic dims
+  // which ONNX declares equal are known to be equal downstream.
+  bool bind_symbolic_dims = false;
+
   // Some ONNX operators are defined by ONNX functions and will be
   // automatically expanded (see get_operator_function() below) to MLIR
   // functions by the importer. This option allows allowlisting functions that
@@ -86,6 +162,38 @@ struct Config {
             // within this function: "[ShapeInferenceError] Inferred shape
             // and existing shape differ in rank: (1) vs (0)"
             "Range"}}};
+
+  // Resolves the bytes of tensors whose data is stored as ONNX external data.
+  // The returned memory is referenced from the imported module without being
+  // copied, so it must stay valid until the module has been printed. If this
+  // is not set (or returns nullopt), such tensors cannot be imported, and
+  // their external data must be loaded into `raw_data` beforehand.
+  std::function<std::optional<std::span<const char>>(
+      const onnx::TensorProto &)>
+      external_data_resolver;
+
+  // Number of threads used to import the bodies of expanded ONNX functions.
+  // With more than one, the functions are declared while importing the graph
+  // and their bodies are imported concurrently afterwards (each into its own
+  // func.func), in which case the order of the function definitions in the
+  // module is not deterministic.
+  unsigned num_import_threads = 1;
+
+  // If set, a directory in which expanded ONNX functions are cached as MLIR
+  // bytecode across runs, keyed by the function specialization and the ONNX
+  // version. Hits skip ONNX function specialization, shape inference and
+  // import altogether.
+  std::optional<std::string> function_cache_dir;
+
+  // Import tensors with identical type and contents (such as repeated scales
+  // and zero points, or tied weights) as a single resource, and initializers
+  // of a graph with identical values as a single constant op.
+  bool deduplicate_constants = true;
+
+  // Tensors larger than this are never deduplicated. Finding a duplicate
+  // reads the whole tensor, which for memory-mapped external data would page
+  // in every large weight of the model.
+  size_t max_deduplicated_constant_bytes = 64 * 1024;
 };
 
 // Accounting for a GraphProto.
@@ -172,6 +280,9 @@ private:
 };
 
 /// Caches per-context lookups of various things.
+///
+/// All methods are thread-safe, so that the cache can be shared by importers
+/// running concurrently.
 class ContextCache {
 public:
   ContextCache(ModelInfo &modelInfo, MlirContext context)
@@ -183,11 +294,13 @@ public:
 
   MlirType GetNoneType();
 
-  MlirType GetListType(const std::string &elemTypeAsm);
-  MlirType GetOptionalType(const std::string &elemTypeAsm);
+  MlirType GetListType(MlirType elemType);
+  MlirType GetOptionalType(MlirType elemType);
 
-  FailureOr<std::string> GetListElementTypeAsm(const onnx::TypeProto &tp);
-  FailureOr<std::string> GetOptionalElementTypeAsm(const onnx::TypeProto &tp);
+  /// Convert the element type of an ONNX sequence or optional to an MlirType,
+  /// returning a null type and setting an error if not supported.
+  MlirType ConvertListElementType(const onnx::TypeProto &tp);
+  MlirType ConvertOptionalElementType(const onnx::TypeProto &tp);
 
   /// Gets a !torch.vtensor type for the given dims and element type.
   /// Dynamic dims are represented as -1.
@@ -210,12 +323,26 @@ public:
   MlirAttribute ConvertTensorProtoToAttr(const onnx::TensorProto &tp);
 
 private:
+  using ResourceDeleterFn = void (*)(void *userData, const void *data,
+                                     size_t size, size_t align);
+
+  /// Returns a DenseResourceElementsAttr of `type` over `data`, reusing an
+  /// earlier one with the same type and contents if constants are being
+  /// deduplicated. Without a `deleter`, `data` is borrowed and must outlive
+  /// the context. Otherwise it is owned by the attribute, or freed right away
+  /// if an earlier attribute is reused.
+  MlirAttribute GetResourceAttr(MlirType type, std::string_view name,
+                                std::span<const char> data, size_t alignment,
+                                ResourceDeleterFn deleter = nullptr);
+
   ModelInfo &model_info_;
   MlirContext context_;
 
+  // Methods call each other, hence the recursive mutex.
+  std::recursive_mutex mutex_;
   std::unordered_map<int, MlirType> elem_type_map_;
-  std::unordered_map<std::string, MlirType> list_type_map_;
-  std::unordered_map<std::string, MlirType> optional_type_map_;
+  std::unordered_map<const void *, MlirType> list_type_map_;
+  std::unordered_map<const void *, MlirType> optional_type_map_;
 
   struct VTensorSign {
     std::vector<int64_t> dims;
@@ -227,15 +354,28 @@ private:
     std::size_t operator()(const VTensorSign &val) const;
   };
   std::unordered_map<VTensorSign, MlirType, VTensorSignHash> vtensor_type_map_;
+
+  // Resource attributes by type and size in bytes. Hashes of the contents are
+  // computed lazily, once another resource of the same type shows up.
+  struct ResourceEntry {
+    std::span<const char> data;
+    MlirAttribute attr;
+    std::optional<uint64_t> hash;
+  };
+  std::map<std::pair<const void *, size_t>, std::vector<ResourceEntry>>
+      resource_map_;
 };
 
 class ModuleCache {
 public:
-  ModuleCache(MlirOperation moduleOp, ContextCache &cc)
-      : cc_(cc), m_(moduleOp) {};
+  /// If `deferFunctionBodies` is set, the bodies of the functions created by
+  /// `GetOperatorFunction` are only imported by `ImportDeferredFunctions`.
+  ModuleCache(MlirOperation moduleOp, ContextCache &cc,
+              bool deferFunctionBodies = false);
+  ~ModuleCache();
 
   /// Get or create the MLIR function corresponding to an ONNX operator.
-  /// Returns failure for ONNX operators that aren't functions.
+  /// Returns failure for ONNX operators that aren't functions. Thread-safe.
   FailureOr<std::optional<MlirOperation>>
   GetOperatorFunction(std::string_view opName, std::string_view opDomain,
                       int opsetVersion, int irVersion,
@@ -243,10 +383,61 @@ public:
                       std::span<const onnx::TypeProto *const> outputTypeProtos,
                       const onnx::NodeProto &callerNode, const Config &config);
 
+  /// Imports the deferred function bodies on `numThreads` threads, including
+  /// the bodies of functions that they in turn call. Must be called once all
+  /// graphs that may call functions have been imported.
+  [[nodiscard]] Status ImportDeferredFunctions(unsigned numThreads);
+
+  /// Writes the functions expanded in this run, together with the functions
+  /// they call, to `Config::function_cache_dir` (if set). Must be called once
+  /// all function bodies have been imported.
+  void SaveFunctionsToCache(const Config &config);
+
+  const std::string &GetErrorMessage() { return error_message_; }
+
 private:
+  // An expanded function whose body has not been imported yet.
+  struct DeferredFunction {
+    std::string key;
+    ModelInfo *model_info;
+    std::unique_ptr<NodeImporter> importer;
+  };
+
+  // Imports the body of the function `key`, keeping track of the functions
+  // that it calls.
+  [[nodiscard]] Status ImportFunctionBody(const std::string &key,
+                                          NodeImporter &importer);
+
+  // Records a call to `calleeKey` from the function whose body is being
+  // imported on this thread, if any. Requires `mutex_` to be held.
+  void RecordCall(const std::string &calleeKey);
+
+  // Looks up the function `key` in the on-disk cache and, on a hit, moves it
+  // and its callees into the module. Requires `mutex_` to be held.
+  std::optional<MlirOperation> LoadCachedFunction(const std::string &key,
+                                                  int irVersion,
+                                                  const Config &config);
+
   ContextCache &cc_;
   MlirOperation m_;
+  bool defer_function_bodies_;
+
+  // Guards everything below.
+  std::mutex mutex_;
   std::unordered_map<std::string, MlirOperation> operator_function_map_;
+  // The specialized function models; their protos are referenced by the
+  // imported IR, so they are kept alive as long as the module.
+  std::vector<std::unique_ptr<ModelInfo>> function_model_infos_;
+  std::deque<DeferredFunction> deferred_functions_;
+  std::condition_variable deferred_functions_cv_;
+  std::string error_message_;
+
+  // Function cache bookkeeping: the functions expanded in this run (in
+  // creation order, with the IR version they were expanded for) and the
+  // functions called by each function.
+  std::vector<std::pair<std::string, int>> expanded_functions_;
+  std::unordered_map<std::string, std::vector<std::string>> callees_;
+  std::vector<std::unique_ptr<std::string>> cached_function_buffers_;
 };
 
 /// Imports graph nodes into MLIR.
@@ -275,7 +466,9 @@ public:
   /// Imports all nodes topologically.
   [[nodiscard]] Status ImportAll(bool func = true);
 
-  void WriteModule(std::ostream *stream, bool assumeVerified);
+  /// Writes the module as text, or as MLIR bytecode if `emitBytecode` is set.
+  void WriteModule(std::ostream *stream, bool assumeVerified,
+                   bool emitBytecode = false);
 
 private:
   void PopulateGraphAttrs(MlirOperation containerOp);
@@ -296,6 +489,13 @@ private:
 
   [[nodiscard]] MlirValue GetNone();
 
+  /// Creates a `torch.symbolic_int` for each named dim of the graph.
+  void ImportDimSymbols(MlirLocation loc);
+  /// Binds the shape of `value` to the symbols of its named dims, if all of
+  /// its dims are static or named.
+  void BindSymbolicDims(MlirValue value, const onnx::TypeProto *tp,
+                        MlirLocation loc);
+
   Status SetError(std::string msg) {
     return graph_info_.GetModelInfo().SetError(std::move(msg));
   }
@@ -312,6 +512,11 @@ private:
   MlirOperation parent_op_;
   MlirBlock body_block_;
   Dict<std::string_view, MlirValue> nv_map_;
+  // Constants materialized in this block, by attribute and type.
+  std::map<std::pair<const void *, const void *>, MlirValue> constant_map_;
+  // The `torch.symbolic_int` values of the named dims, shared with the
+  // importers of subgraphs, or null if symbolic dims are not bound.
+  std::shared_ptr<std::unordered_map<std::string, MlirValue>> dim_symbols_;
   std::unique_ptr<const onnx::TypeProto> empty_type_proto_;
 };
 
@@ -323,7 +528,7 @@ public:
 
 protected:
   struct MlirState {
-    MlirState();
+    explicit MlirState(bool enableThreading = false);
     ~MlirState();
 
     MlirContext context_;
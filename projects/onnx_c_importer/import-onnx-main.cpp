@@ -65,8 +65,71 @@ static arg<optional_tag, bool> disableFunctionExpansionAllowlistArg(
     " allowing non-allowlisted functions to be expanded.",
     "--disable-function-expansion-allowlist", false);
 
+static arg<optional_tag, bool> noMmapExternalDataArg(
+    "Copy all external data into the model instead of memory-mapping the"
+    " external data files of large tensors.",
+    "--no-mmap-external-data", false);
+
+static arg<optional_tag, std::optional<int>> importThreadsArg(
+    "Number of threads used to import the bodies of expanded ONNX functions."
+    " Defaults to 1, which imports everything on the main thread.",
+    "--import-threads");
+
+static arg<optional_tag, bool> streamInitializersArg(
+    "Parse the model without reading the payloads of large initializers,"
+    " which are then memory-mapped from the model file during import. This"
+    " is always done for model files larger than 2 GB.",
+    "--stream-initializers", false);
+
+static arg<optional_tag, std::string> functionCacheDirArg(
+    "Directory in which expanded ONNX functions are cached across runs."
+    " Created if it does not exist. Disabled by default.",
+    "--function-cache-dir", "", "directory");
+
+static arg<optional_tag, bool> noDeduplicateConstantsArg(
+    "Import every initializer as its own resource and constant, even if its"
+    " contents are identical to another one.",
+    "--no-deduplicate-constants", false);
+
+static arg<optional_tag, std::optional<int>> maxDeduplicatedConstantBytesArg(
+    "Size in bytes above which tensors are imported as their own resource"
+    " without looking for an identical one, which would read them. Defaults"
+    " to 65536.",
+    "--max-deduplicated-constant-bytes");
+
+static arg<optional_tag, bool> bindSymbolicDimsArg(
+    "Bind the named (dim_param) dims of tensors to shared symbolic ints with"
+    " torch.bind_symbolic_shape, so that equal dynamic dims are known to be"
+    " equal.",
+    "--bind-symbolic-dims", false);
+
+static arg<optional_tag, bool> emitBytecodeArg(
+    "Emit MLIR bytecode instead of textual MLIR.", "--emit-bytecode", false);
+
+static arg<optional_tag, bool> timingArg(
+    "Print the time spent in each import phase and import statistics to "
+    "stderr.",
+    "--timing", false);
+
 // NOTE: onnx_importer.py -data-dir argument is not used in tests
 
+// External tensors smaller than this are still copied into the model: ONNX
+// shape inference cannot look through external data, and small tensors are
+// where shape-relevant constants (e.g. reshape targets) live.
+static constexpr unsigned long kMinExternalDataSizeToMap = 64 * 1024;
+
+std::optional<unsigned long> minExternalDataSizeToKeep() {
+  if (noMmapExternalDataArg)
+    return std::nullopt;
+  return kMinExternalDataSizeToMap;
+}
+
+static ImportStats importStats;
+
+ImportStats *getImportStats() { return timingArg ? &importStats : nullptr; }
+
+fs::path getInputDir() { return fs::path(*inputFilenameArg).parent_path(); }
+
 FailureOr<onnx::ModelProto> loadOnnxModel() {
 
   // Do shape inference two ways.  First, attempt in-memory to avoid redundant
@@ -88,14 +151,27 @@ FailureOr<onnx::ModelProto> loadOnnxModel() {
     std::cerr << "Invalid input file path: " << *inputFilenameArg << "\n";
     return failure;
   }
-  fs::path inputDir = inputFile.parent_path();
+  fs::path inputDir = getInputDir();
   fs::path tempDir = *tempDirArg == "-" ? inputDir : fs::path(*tempDirArg);
   tempDir /= "onnx-importer-temp";
   fs::remove_all(tempDir);
 
+  const size_t MAXIMUM_PROTOBUF = 2000000000;
+
   onnx::ModelProto mp;
   // Load model (and external data)
-  {
+  std::optional<ImportStats::Phase> parsePhase;
+  parsePhase.emplace(getImportStats(), "Parse");
+  if (streamInitializersArg || fs::file_size(inputFile) > MAXIMUM_PROTOBUF) {
+    if (failed(loadModelWithInPlaceInitializers(
+            inputFile, kMinExternalDataSizeToMap, mp)))
+      return failure;
+    if (failed(loadExternalDataForModel(mp, inputDir,
+                                        minExternalDataSizeToKeep()))) {
+      std::cerr << "Failed to load external data \n";
+      return failure;
+    }
+  } else {
     std::ifstream inputStream(inputFilenameArg,
                               std::ios::in | std::ios::binary);
     if (!inputStream.is_open()) {
@@ -106,13 +182,17 @@ FailureOr<onnx::ModelProto> loadOnnxModel() {
       std::cerr << "Failed to parse ONNX ModelProto \n";
       return failure;
     }
-    if (failed(loadExternalDataForModel(mp, inputDir))) {
+    if (failed(loadExternalDataForModel(mp, inputDir,
+                                        minExternalDataSizeToKeep()))) {
       std::cerr << "Failed to load external data \n";
       return failure;
     }
   }
 
+  parsePhase.reset();
+
   if ((*opsetVersionArg).has_value()) {
+    ImportStats::Phase phase(getImportStats(), "Version conversion");
     // see `convert_version` in onnx/cpp2py_export.cc
     try {
       onnx::shape_inference::InferShapes(mp);
@@ -133,9 +213,9 @@ FailureOr<onnx::ModelProto> loadOnnxModel() {
   opts.check_type = false;
   opts.enable_data_propagation = dataPropArg;
 
-  const size_t MAXIMUM_PROTOBUF = 2000000000;
   // Check whether serialized size is within threshold for in-memory shape
   // inference
+  ImportStats::Phase shapeInferencePhase(getImportStats(), "Shape inference");
   if (mp.ByteSizeLong() <= MAXIMUM_PROTOBUF) {
     try {
       onnx::shape_inference::InferShapes(mp, onnx::OpSchemaRegistry::Instance(),
@@ -165,7 +245,8 @@ FailureOr<onnx::ModelProto> loadOnnxModel() {
         std::cerr << "Failed to parse ONNX ModelProto \n";
         return failure;
       }
-      if (failed(loadExternalDataForModel(mp, inputDir))) {
+      if (failed(loadExternalDataForModel(mp, inputDir,
+                                          minExternalDataSizeToKeep()))) {
         std::cerr << "Failed to load external data \n";
         return failure;
       }
@@ -198,7 +279,8 @@ int main(int argc, char **argv) {
     outputStream = &std::cout;
   } else {
     allocatedOutputStream =
-        std::make_unique<std::ofstream>(*outputFilenameArg, std::ios::out);
+        std::make_unique<std::ofstream>(*outputFilenameArg,
+                                        std::ios::out | std::ios::binary);
     if (!*allocatedOutputStream) {
       std::cerr << "error: could not open output file " << *outputFilenameArg
                 << "\n";
@@ -207,8 +289,37 @@ int main(int argc, char **argv) {
     outputStream = allocatedOutputStream.get();
   }
 
+  // Large external tensors were left in their files by `loadOnnxModel`; map
+  // them for the duration of the import so that they are never copied.
+  ExternalDataStore externalData(getInputDir());
+
   Config config;
+  config.stats = getImportStats();
   config.no_verify = noVerifyArg;
+  config.emit_bytecode = emitBytecodeArg;
+  config.bind_symbolic_dims = bindSymbolicDimsArg;
+  config.deduplicate_constants = !noDeduplicateConstantsArg;
+  config.external_data_resolver = [&externalData](const onnx::TensorProto &tp) {
+    return externalData.Get(tp);
+  };
+  if ((*importThreadsArg).has_value()) {
+    if (**importThreadsArg < 1) {
+      std::cerr << "error: --import-threads must be at least 1\n";
+      return 1;
+    }
+    config.num_import_threads = **importThreadsArg;
+  }
+  if ((*maxDeduplicatedConstantBytesArg).has_value()) {
+    if (**maxDeduplicatedConstantBytesArg < 0) {
+      std::cerr << "error: --max-deduplicated-constant-bytes must not be "
+                   "negative\n";
+      return 1;
+    }
+    config.max_deduplicated_constant_bytes =
+        **maxDeduplicatedConstantBytesArg;
+  }
+  if (!(*functionCacheDirArg).empty())
+    config.function_cache_dir = *functionCacheDirArg;
   if (disableFunctionExpansionAllowlistArg) {
     config.function_expansion_allowlists_by_domain = std::nullopt;
   }
@@ -217,6 +328,10 @@ int main(int argc, char **argv) {
       OnnxImporter::Import(std::move(model).value(), outputStream, config);
   if (failed(status))
     return 1;
+  if (config.stats) {
+    outputStream->flush();
+    config.stats->Print(std::cerr);
+  }
 
   return 0;
 }
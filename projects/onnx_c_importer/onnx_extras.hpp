@@ -14,7 +14,23 @@
 
 #include "Status.hpp"
 
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
 #include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -58,6 +74,310 @@ struct ExternalDataInfo {
   }
 };
 
+/// A read-only view of a whole file. On POSIX systems the file is memory
+/// mapped, so its pages are only read from disk when touched and are shared
+/// with the page cache; elsewhere, the file is read into memory.
+class MappedFile {
+public:
+  static std::unique_ptr<MappedFile> Open(const std::string &path) {
+    std::unique_ptr<MappedFile> file(new MappedFile());
+#if defined(_WIN32)
+    std::ifstream inputStream(path, std::ios::in | std::ios::binary);
+    if (!inputStream.is_open())
+      return nullptr;
+    inputStream.seekg(0, inputStream.end);
+    file->buffer_.resize(inputStream.tellg());
+    inputStream.seekg(0, inputStream.beg);
+    inputStream.read(file->buffer_.data(), file->buffer_.size());
+    file->data_ = file->buffer_;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return nullptr;
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+      void *addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        ::close(fd);
+        return nullptr;
+      }
+      file->data_ =
+          std::span<const char>(static_cast<const char *>(addr), size);
+    }
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+#endif
+    return file;
+  }
+
+  ~MappedFile() {
+#if !defined(_WIN32)
+    if (!data_.empty())
+      ::munmap(const_cast<char *>(data_.data()), data_.size());
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  std::span<const char> data() const { return data_; }
+
+private:
+  MappedFile() = default;
+
+  std::span<const char> data_;
+#if defined(_WIN32)
+  std::vector<char> buffer_;
+#endif
+};
+
+/// Resolves tensors stored as ONNX external data to their bytes without
+/// copying them into the ModelProto. Each external data file is mapped once
+/// and stays mapped for the lifetime of the store, so the returned spans can
+/// be referenced by the imported module (see
+/// `Config::external_data_resolver`).
+class ExternalDataStore {
+public:
+  explicit ExternalDataStore(fs::path baseDir) : baseDir_(std::move(baseDir)) {}
+
+  /// Returns the bytes of the external data of `tp`, or nullopt if they cannot
+  /// be read.
+  std::optional<std::span<const char>> Get(const onnx::TensorProto &tp) {
+    ExternalDataInfo edi = ExternalDataInfo::FromTensorProto(tp);
+    std::string path = onnx::checker::resolve_external_data_location(
+        baseDir_.generic_string(), edi.location, tp.name());
+    std::unique_ptr<MappedFile> &file = files_[path];
+    if (!file) {
+      file = MappedFile::Open(path);
+      if (!file) {
+        std::cerr << "Cannot open external data file: " << path << "\n";
+        return std::nullopt;
+      }
+    }
+
+    std::span<const char> data = file->data();
+    size_t offset = edi.offset.value_or(0);
+    if (offset > data.size()) {
+      std::cerr << "External data offset of tensor '" << tp.name()
+                << "' is past the end of " << path << "\n";
+      return std::nullopt;
+    }
+    data = data.subspan(offset);
+    if (edi.length) {
+      if (*edi.length > data.size()) {
+        std::cerr << "External data of tensor '" << tp.name()
+                  << "' extends past the end of " << path << "\n";
+        return std::nullopt;
+      }
+      data = data.first(*edi.length);
+    }
+
+    // Tensors are imported with maximum numeric alignment. Mapped pages are
+    // page aligned, but the offset within the file may not be, in which case
+    // an aligned copy is made.
+    if (reinterpret_cast<uintptr_t>(data.data()) % alignof(uint64_t) != 0) {
+      size_t numWords = (data.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+      auto &copy = copies_.emplace_back(new uint64_t[numWords]);
+      std::memcpy(copy.get(), data.data(), data.size());
+      data = std::span<const char>(reinterpret_cast<const char *>(copy.get()),
+                                   data.size());
+    }
+    return data;
+  }
+
+private:
+  fs::path baseDir_;
+  std::unordered_map<std::string, std::unique_ptr<MappedFile>> files_;
+  std::vector<std::unique_ptr<uint64_t[]>> copies_;
+};
+
+/// A field of a serialized protobuf message.
+struct WireField {
+  uint64_t number = 0;
+  int wireType = 0;
+  /// The whole field, including its tag.
+  std::span<const char> bytes;
+  /// The value of the field, without the length of length-delimited fields.
+  std::span<const char> payload;
+};
+
+/// Minimal reader of the protobuf wire format. Unlike
+/// google::protobuf::io::CodedInputStream, it works on 64 bit offsets, so it
+/// can walk messages larger than 2 GB.
+class WireReader {
+public:
+  explicit WireReader(std::span<const char> data)
+      : pos_(data.data()), end_(data.data() + data.size()) {}
+
+  bool AtEnd() const { return pos_ == end_; }
+
+  /// Reads the next field. Returns false on malformed input.
+  bool Next(WireField &field) {
+    const char *start = pos_;
+    uint64_t tag;
+    if (!ReadVarint(tag))
+      return false;
+    field.number = tag >> 3;
+    field.wireType = static_cast<int>(tag & 7);
+    const char *payload = pos_;
+    uint64_t size;
+    switch (field.wireType) {
+    case 0: { // varint
+      uint64_t value;
+      if (!ReadVarint(value))
+        return false;
+      size = pos_ - payload;
+      break;
+    }
+    case 1: // fixed64
+      size = 8;
+      break;
+    case 2: // length-delimited
+      if (!ReadVarint(size))
+        return false;
+      payload = pos_;
+      break;
+    case 5: // fixed32
+      size = 4;
+      break;
+    default: // groups are not used by ONNX
+      return false;
+    }
+    if (size > static_cast<uint64_t>(end_ - payload))
+      return false;
+    pos_ = payload + size;
+    field.bytes = std::span<const char>(start, pos_);
+    field.payload = std::span<const char>(payload, size);
+    return true;
+  }
+
+private:
+  bool ReadVarint(uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos_ != end_; shift += 7) {
+      uint8_t byte = static_cast<uint8_t>(*pos_++);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  const char *pos_;
+  const char *end_;
+};
+
+/// Parses the model at `modelPath` without copying the `raw_data` of
+/// initializers of at least `minRawDataSize` bytes into the proto. Those
+/// initializers are instead turned into external data referring to their
+/// bytes within the model file itself, so that they can be mapped later on
+/// (see `ExternalDataStore`). This bounds the memory used by the ModelProto
+/// by the size of the graph rather than of the weights, and also handles
+/// model files beyond protobuf's 2 GB limit.
+Status loadModelWithInPlaceInitializers(const fs::path &modelPath,
+                                        unsigned long minRawDataSize,
+                                        onnx::ModelProto &mp) {
+  constexpr uint64_t kModelGraph = 7;
+  constexpr uint64_t kGraphInitializer = 5;
+  constexpr uint64_t kTensorRawData = 9;
+  constexpr int kLengthDelimited = 2;
+
+  std::unique_ptr<MappedFile> file = MappedFile::Open(modelPath.string());
+  if (!file) {
+    std::cerr << "Cannot open input file: " << modelPath << "\n";
+    return failure;
+  }
+  const char *fileStart = file->data().data();
+  std::string location = modelPath.filename().string();
+
+  auto parseTensor = [&](std::span<const char> bytes,
+                         onnx::TensorProto &tp) {
+    std::string rest;
+    std::optional<std::span<const char>> rawData;
+    WireReader reader(bytes);
+    WireField field;
+    while (!reader.AtEnd()) {
+      if (!reader.Next(field))
+        return false;
+      if (field.number == kTensorRawData &&
+          field.wireType == kLengthDelimited &&
+          field.payload.size() >= minRawDataSize)
+        rawData = field.payload;
+      else
+        rest.append(field.bytes.data(), field.bytes.size());
+    }
+    if (!tp.ParseFromString(rest))
+      return false;
+    if (rawData) {
+      auto addEntry = [&tp](const std::string &key, const std::string &value) {
+        onnx::StringStringEntryProto *entry = tp.add_external_data();
+        entry->set_key(key);
+        entry->set_value(value);
+      };
+      tp.set_data_location(onnx::TensorProto::EXTERNAL);
+      addEntry("location", location);
+      addEntry("offset", std::to_string(rawData->data() - fileStart));
+      addEntry("length", std::to_string(rawData->size()));
+    }
+    return true;
+  };
+
+  auto parseGraph = [&](std::span<const char> bytes, onnx::GraphProto &gp) {
+    std::string rest;
+    std::vector<onnx::TensorProto> initializers;
+    WireReader reader(bytes);
+    WireField field;
+    while (!reader.AtEnd()) {
+      if (!reader.Next(field))
+        return false;
+      if (field.number == kGraphInitializer &&
+          field.wireType == kLengthDelimited) {
+        if (!parseTensor(field.payload, initializers.emplace_back()))
+          return false;
+      } else {
+        rest.append(field.bytes.data(), field.bytes.size());
+      }
+    }
+    if (!gp.ParseFromString(rest))
+      return false;
+    for (onnx::TensorProto &tp : initializers)
+      *gp.add_initializer() = std::move(tp);
+    return true;
+  };
+
+  std::string rest;
+  onnx::GraphProto graph;
+  bool hasGraph = false;
+  WireReader reader(file->data());
+  WireField field;
+  while (!reader.AtEnd()) {
+    bool ok = reader.Next(field);
+    if (ok && field.number == kModelGraph &&
+        field.wireType == kLengthDelimited) {
+      ok = parseGraph(field.payload, graph);
+      hasGraph = true;
+    } else if (ok) {
+      rest.append(field.bytes.data(), field.bytes.size());
+    }
+    if (!ok) {
+      std::cerr << "Failed to parse ONNX ModelProto \n";
+      return failure;
+    }
+  }
+  if (!mp.ParseFromString(rest)) {
+    std::cerr << "Failed to parse ONNX ModelProto \n";
+    return failure;
+  }
+  if (hasGraph)
+    *mp.mutable_graph() = std::move(graph);
+  return success;
+}
+
 /// From onnx python API:
 /// Loads data from an external file for tensor. Ideally TensorProto should
 /// not hold any raw data but if it does it will be ignored.
@@ -126,15 +446,45 @@ bool usesExternalData(const onnx::TensorProto &tp) {
          tp.data_location() == onnx::TensorProto::EXTERNAL;
 }
 
+/// Returns the size in bytes of the external data of `tp`, or nullopt if it
+/// cannot be determined.
+std::optional<unsigned long>
+getExternalDataSize(const onnx::TensorProto &tp, const fs::path &baseDir) {
+  ExternalDataInfo edi = ExternalDataInfo::FromTensorProto(tp);
+  if (edi.length)
+    return edi.length;
+  std::string externalDataFilePath =
+      onnx::checker::resolve_external_data_location(baseDir.generic_string(),
+                                                    edi.location, tp.name());
+  std::error_code ec;
+  unsigned long fileSize = fs::file_size(externalDataFilePath, ec);
+  if (ec || edi.offset.value_or(0) > fileSize)
+    return std::nullopt;
+  return fileSize - edi.offset.value_or(0);
+}
+
 /// From onnx python API:
 /// Loads external tensors into the model
 ///     Arguments:
 ///        model: ModelProto to load external data to
 ///         baseDir: directory that contains external data
-Status loadExternalDataForModel(onnx::ModelProto &mp, const fs::path &baseDir) {
+///
+/// If `minSizeToKeepExternal` is set, tensors with at least that many bytes
+/// of external data are left external so that they can be resolved lazily
+/// through an `ExternalDataStore` instead of being copied into the model.
+Status loadExternalDataForModel(
+    onnx::ModelProto &mp, const fs::path &baseDir,
+    std::optional<unsigned long> minSizeToKeepExternal = std::nullopt) {
   Status s = success;
-  forEachTensor(mp, [&baseDir, &s](onnx::TensorProto &tp) {
+  forEachTensor(mp, [&](onnx::TensorProto &tp) {
+    if (failed(s))
+      return;
     if (usesExternalData(tp)) {
+      if (minSizeToKeepExternal) {
+        std::optional<unsigned long> size = getExternalDataSize(tp, baseDir);
+        if (size && *size >= *minSizeToKeepExternal)
+          return;
+      }
       if (failed(loadExternalDataForTensor(tp, baseDir))) {
         s = failure;
         return;
@@ -4,6 +4,7 @@
 # Also available under a BSD-style license. See LICENSE.
 
 import argparse
+import os
 import re
 import sys
 
@@ -11,8 +12,9 @@ import torch
 
 torch.device("cpu")
 
-from torch_mlir_e2e_test.framework import run_tests
-from torch_mlir_e2e_test.reporting import report_results
+from torch_mlir_e2e_test.compile_cache import CachingBackend
+from torch_mlir_e2e_test.framework import run_benchmarks, run_tests
+from torch_mlir_e2e_test.reporting import report_benchmarks, report_results
 from torch_mlir_e2e_test.registry import GLOBAL_TEST_REGISTRY
 
 
@@ -126,6 +128,14 @@ Regular expression specifying which tests to include in this run.
         help="""Run tests sequentially rather than in parallel.
 This can be useful for debugging, since it runs the tests in the same process,
 which make it easier to attach a debugger or get a stack trace.""",
+    )
+    parser.add_argument(
+        "--threads",
+        default=False,
+        action="store_true",
+        help="""Run tests in parallel on threads of this process rather than in a
+pool of processes. This avoids starting a process per worker, but a crash of
+one test ends the run and tests have no timeout.""",
     )
     parser.add_argument(
         "--crashing_tests_to_not_attempt_to_run_and_a_bug_is_filed",
@@ -140,25 +150,74 @@ which make it easier to attach a debugger or get a stack trace.""",
         action="store_true",
         help="return exit code 0 even if the test fails to unblock pipeline",
     )
+    parser.add_argument(
+        "--compile_cache_dir",
+        default="",
+        help="""A directory in which the compiled artifacts of the tests are kept,
+so that later runs reuse them instead of compiling the tests again. It must be
+cleared when the compiler changes.""",
+    )
+    parser.add_argument(
+        "--golden_trace_cache_dir",
+        default="",
+        help="""A directory in which the golden traces of the tests are kept, so
+that later runs, with any config, reuse them instead of running the tests in
+PyTorch again. A trace is generated again when the source file of its test, the
+torch version or the seed of the tests change.""",
+    )
+    parser.add_argument(
+        "--benchmark",
+        default=False,
+        action="store_true",
+        help="""Instead of checking the results of the tests, time repeated runs of
+the tests that are expected to pass, with this config and with native_torch.""",
+    )
+    parser.add_argument(
+        "--benchmark_iterations",
+        default=100,
+        type=int,
+        help="The number of timed runs of each test in --benchmark mode.",
+    )
+    parser.add_argument(
+        "--benchmark_warmup_iterations",
+        default=10,
+        type=int,
+        help="The number of untimed runs before the timed ones in --benchmark mode.",
+    )
+    parser.add_argument(
+        "--benchmark_output",
+        default="",
+        help="A file to which --benchmark mode writes its results as JSON.",
+    )
     return parser
 
 
 def main():
     args = _get_argparse().parse_args()
+    # The env var reaches the worker processes that generate the traces.
+    if args.golden_trace_cache_dir:
+        os.environ["TORCH_MLIR_GOLDEN_TRACE_CACHE_DIR"] = args.golden_trace_cache_dir
+
+    def cached(backend):
+        if not args.compile_cache_dir:
+            return backend
+        return CachingBackend(backend, args.compile_cache_dir, args.config)
 
     all_test_unique_names = set(test.unique_name for test in GLOBAL_TEST_REGISTRY)
 
     # Find the selected config.
     if args.config == "linalg":
-        config = JITImporterTestConfig(RefBackendLinalgOnTensorsBackend())
+        config = JITImporterTestConfig(cached(RefBackendLinalgOnTensorsBackend()))
         xfail_set = LINALG_XFAIL_SET
         crashing_set = LINALG_CRASHING_SET
     elif args.config == "stablehlo":
-        config = JITImporterTestConfig(LinalgOnTensorsStablehloBackend(), "stablehlo")
+        config = JITImporterTestConfig(
+            cached(LinalgOnTensorsStablehloBackend()), "stablehlo"
+        )
         xfail_set = all_test_unique_names - STABLEHLO_PASS_SET
         crashing_set = STABLEHLO_CRASHING_SET
     elif args.config == "tosa":
-        config = JITImporterTestConfig(LinalgOnTensorsTosaBackend(), "tosa")
+        config = JITImporterTestConfig(cached(LinalgOnTensorsTosaBackend()), "tosa")
         xfail_set = all_test_unique_names - TOSA_PASS_SET
         crashing_set = TOSA_CRASHING_SET
     elif args.config == "native_torch":
@@ -174,30 +233,36 @@ def main():
         xfail_set = LTC_XFAIL_SET
         crashing_set = LTC_CRASHING_SET
     elif args.config == "fx_importer":
-        config = FxImporterTestConfig(RefBackendLinalgOnTensorsBackend())
+        config = FxImporterTestConfig(cached(RefBackendLinalgOnTensorsBackend()))
         xfail_set = FX_IMPORTER_XFAIL_SET
         crashing_set = FX_IMPORTER_CRASHING_SET
     elif args.config == "fx_importer_stablehlo":
-        config = FxImporterTestConfig(LinalgOnTensorsStablehloBackend(), "stablehlo")
+        config = FxImporterTestConfig(
+            cached(LinalgOnTensorsStablehloBackend()), "stablehlo"
+        )
         xfail_set = FX_IMPORTER_STABLEHLO_XFAIL_SET
         crashing_set = FX_IMPORTER_STABLEHLO_CRASHING_SET
     elif args.config == "fx_importer_tosa":
-        config = FxImporterTestConfig(LinalgOnTensorsTosaBackend(), "tosa")
+        config = FxImporterTestConfig(cached(LinalgOnTensorsTosaBackend()), "tosa")
         xfail_set = FX_IMPORTER_TOSA_XFAIL_SET
         crashing_set = FX_IMPORTER_TOSA_CRASHING_SET
     elif args.config == "torchdynamo":
         # TODO: Enanble runtime verification and extend crashing set.
         config = TorchDynamoTestConfig(
-            RefBackendLinalgOnTensorsBackend(generate_runtime_verification=False)
+            cached(
+                RefBackendLinalgOnTensorsBackend(generate_runtime_verification=False)
+            )
         )
         xfail_set = TORCHDYNAMO_XFAIL_SET
         crashing_set = TORCHDYNAMO_CRASHING_SET
     elif args.config == "onnx":
-        config = OnnxBackendTestConfig(RefBackendLinalgOnTensorsBackend())
+        config = OnnxBackendTestConfig(cached(RefBackendLinalgOnTensorsBackend()))
         xfail_set = ONNX_XFAIL_SET
         crashing_set = ONNX_CRASHING_SET
     elif args.config == "onnx_tosa":
-        config = OnnxBackendTestConfig(LinalgOnTensorsTosaBackend(), output_type="tosa")
+        config = OnnxBackendTestConfig(
+            cached(LinalgOnTensorsTosaBackend()), output_type="tosa"
+        )
         xfail_set = ONNX_TOSA_XFAIL_SET
         crashing_set = ONNX_TOSA_CRASHING_SET
 
@@ -226,8 +291,27 @@ def main():
             print(test.unique_name)
         sys.exit(1)
 
+    if args.benchmark:
+        benchmark_configs = {args.config: config}
+        if args.config != "native_torch":
+            benchmark_configs["native_torch"] = NativeTorchTestConfig()
+        tests = [test for test in tests if test.unique_name not in xfail_set]
+        results_by_config = {
+            name: run_benchmarks(
+                tests,
+                benchmark_config,
+                args.benchmark_warmup_iterations,
+                args.benchmark_iterations,
+            )
+            for name, benchmark_config in benchmark_configs.items()
+        }
+        report_benchmarks(results_by_config, args.benchmark_output)
+        sys.exit(0)
+
     # Run the tests.
-    results = run_tests(tests, config, args.sequential, args.verbose)
+    results = run_tests(
+        tests, config, args.sequential, args.verbose, threads=args.threads
+    )
 
     # Report the test results.
     failed = report_results(results, xfail_set, args.verbose, args.config)
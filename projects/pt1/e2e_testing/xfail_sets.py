@@ -2267,6 +2267,8 @@ TOSA_PASS_SET = {
     "Conv2dWithPaddingDilationStrideStaticModule_basic",
     "Conv2dWithPaddingDilationStrideStaticModule_depthwise",
     "Conv2dWithPaddingDilationStrideStaticModule_depthwise_multiplier",
+    "Conv2dWithPaddingDilationStrideStaticModule_grouped",
+    "Conv2dWithPaddingDilationStrideStaticModule_grouped_multiplier",
     "Conv2dWithPaddingModule_basic",
     "Conv2dWithValidPaddingModule_basic",
     "Conv2dWithSamePaddingModule_basic",
@@ -3923,8 +3925,6 @@ FX_IMPORTER_TOSA_XFAIL_SET = {
     "Conv2dQInt8PerChannelModule_basic",
     "Conv2dQInt8PerChannelModule_depthwise",
     "Conv2dQInt8PerChannelModule_grouped",
-    "Conv2dWithPaddingDilationStrideStaticModule_grouped",
-    "Conv2dWithPaddingDilationStrideStaticModule_grouped_multiplier",
     "ConvTranspose2DQInt8_basic",
     "ConvTbcModule_basic",
     "ConvolutionBackwardModule2DDilated_basic",
@@ -4580,8 +4580,6 @@ ONNX_TOSA_XFAIL_SET = {
     "Conv2dQInt8PerChannelModule_depthwise",
     "Conv2dQInt8PerChannelModule_grouped",
     "Conv2dWithPaddingDilationStrideModule_basic",
-    "Conv2dWithPaddingDilationStrideStaticModule_grouped",
-    "Conv2dWithPaddingDilationStrideStaticModule_grouped_multiplier",
     "Conv2dWithPaddingModule_basic",
     "Conv2dWithSamePaddingModule_basic",
     "Conv2dWithValidPaddingModule_basic",
@@ -0,0 +1,76 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s torch-mlir-opt | FileCheck %s
+
+import os
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "..", "tools"))
+import compile_perf
+
+TORCH_MLIR_OPT = sys.argv[1]
+
+
+def run(f):
+    print(f"{f.__name__}")
+    print("-" * len(f.__name__))
+    f()
+    print()
+
+
+@run
+# CHECK-LABEL: test_parse_timing
+# CHECK:       total: 0.5
+# CHECK-NEXT:  Canonicalizer: 0.3
+# CHECK-NEXT:  CSE: 0.1
+def test_parse_timing():
+    report = """
+===-------------------------------------------------------------------------===
+                         ... Execution time report ...
+===-------------------------------------------------------------------------===
+  Total Execution Time: 0.5000 seconds
+
+  ----User Time----  ----Wall Time----  ----Name----
+    0.1000 ( 20.0%)    0.1000 ( 20.0%)  Canonicalizer
+    0.1000 ( 20.0%)    0.1000 ( 20.0%)  CSE
+    0.2000 ( 40.0%)    0.2000 ( 40.0%)  Canonicalizer
+    0.5000 (100.0%)    0.5000 (100.0%)  Total
+"""
+    total, pass_times = compile_perf._parse_timing(report)
+    print("total:", round(total, 3))
+    # The instances of a pass are summed.
+    for name, seconds in sorted(pass_times.items()):
+        print(f"{name}: {round(seconds, 3)}")
+
+
+_MODULE = """
+func.func @forward(%arg0: !torch.vtensor<[2],f32>) -> !torch.vtensor<[2],f32> {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[2],f32> -> !torch.vtensor<[2],f32>
+  return %0 : !torch.vtensor<[2],f32>
+}
+"""
+
+
+@run
+# CHECK-LABEL: test_time_pipeline
+# CHECK:       keys: ['passes_s', 'peak_memory_bytes', 'total_s']
+# CHECK-NEXT:  timed canonicalize: True
+# CHECK-NEXT:  peak memory: True
+# CHECK-NEXT:  error reported: True
+def test_time_pipeline():
+    with tempfile.TemporaryDirectory() as corpus_dir:
+        path = os.path.join(corpus_dir, "forward.mlir")
+        with open(path, "w") as f:
+            f.write(_MODULE)
+        result = compile_perf._time_pipeline(
+            TORCH_MLIR_OPT, path, "func.func(canonicalize)"
+        )
+        print("keys:", sorted(result))
+        print("timed canonicalize:", "Canonicalizer" in result["passes_s"])
+        print("peak memory:", result["peak_memory_bytes"] > 0)
+        failed = compile_perf._time_pipeline(TORCH_MLIR_OPT, path, "no-such-pass")
+        print("error reported:", "error" in failed)
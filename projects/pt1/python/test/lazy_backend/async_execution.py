@@ -0,0 +1,51 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import os
+
+# Read by the backend the first time it executes a computation.
+os.environ["LTC_ASYNC_EXECUTION"] = "1"
+
+import torch
+import torch._lazy
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+
+device = "lazy"
+
+
+# CHECK: matches: True
+# -----
+# CHECK: PASS - test_dependent_steps
+@run_test
+def test_dependent_steps():
+    # Each step is traced while the previous one may still be executing, and
+    # reads its pending results.
+    x = torch.randn(4, 4)
+    expected = x
+    lazy_x = x.to(device)
+    for _ in range(4):
+        expected = torch.tanh(expected) + expected
+        lazy_x = torch.tanh(lazy_x) + lazy_x
+        torch._lazy.mark_step()
+    print("matches:", torch.allclose(lazy_x.cpu(), expected))
+
+
+# CHECK: matches: True
+# -----
+# CHECK: PASS - test_wait_device_ops
+@run_test
+def test_wait_device_ops():
+    x = torch.randn(3)
+    lazy_y = x.to(device) * 3
+    torch._lazy.mark_step()
+    torch._lazy.wait_device_ops()
+    print("matches:", torch.allclose(lazy_y.cpu(), x * 3))
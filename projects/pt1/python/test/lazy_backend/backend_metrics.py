@@ -0,0 +1,50 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import torch
+import torch._lazy
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+
+device = "lazy"
+
+
+# CHECK: lowered graphs: 1
+# CHECK-NEXT: lowered nodes: True
+# CHECK-NEXT: module operations: True
+# -----
+# CHECK: PASS - test_lowering_metrics
+@run_test
+def test_lowering_metrics():
+    x = torch.ones(2, 3).to(device)
+    y = torch.tanh(x) * 2
+    torch._lazy.mark_step()
+    metrics = lazy_backend.get_backend_metrics()
+    print("lowered graphs:", int(metrics["TorchMlirLowerNodes.Samples"]))
+    print("lowered nodes:", metrics["TorchMlirLoweredNodes.Sum"] > 0)
+    print("module operations:", metrics["TorchMlirModuleOperations.Sum"] > 0)
+
+
+# CHECK: grew: True
+# CHECK-NEXT: released: True
+# -----
+# CHECK: PASS - test_live_data
+@run_test
+def test_live_data():
+    before = lazy_backend.get_backend_metrics()["LiveDataBytes"]
+    x = torch.ones(32, 32).to(device) * 2
+    torch._lazy.mark_step()
+    during = lazy_backend.get_backend_metrics()["LiveDataBytes"]
+    # The result alone holds 32 * 32 floats.
+    print("grew:", during - before >= 4096)
+    del x
+    after = lazy_backend.get_backend_metrics()["LiveDataBytes"]
+    print("released:", during - after >= 4096)
@@ -0,0 +1,66 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+# The cache is configured once per process, so every run of the graph below
+# happens in a child process that shares the cache directory.
+
+import os
+import subprocess
+import sys
+import tempfile
+
+from run_test import run_test
+
+
+def run_graph():
+    import torch
+    import torch._lazy
+
+    import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+    lazy_backend._initialize()
+    x = torch.ones(2, 3).to("lazy")
+    y = torch.tanh(x) * 2
+    torch._lazy.mark_step()
+    metrics = lazy_backend.get_computation_cache_metrics()
+    print(f"metrics: {metrics['hits']} {metrics['disk_hits']} {metrics['misses']}")
+
+
+if sys.argv[1:] == ["--child"]:
+    run_graph()
+    sys.exit(0)
+
+
+def run_child(cache_dir):
+    env = dict(os.environ, LTC_COMPUTATION_CACHE_DIR=cache_dir)
+    output = subprocess.run(
+        [sys.executable, __file__, "--child"],
+        env=env,
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    hits, disk_hits, misses = next(
+        line for line in output.splitlines() if line.startswith("metrics:")
+    ).split()[1:]
+    print(f"hits={hits} disk_hits={disk_hits} misses={misses}")
+
+
+# CHECK:      hits=0 disk_hits=0 misses=1
+# CHECK-NEXT: artifacts: 1
+# CHECK-NEXT: hits=0 disk_hits=1 misses=0
+# CHECK-NEXT: artifacts: 1
+# -----
+# CHECK: PASS - test_disk_cache
+@run_test
+def test_disk_cache():
+    with tempfile.TemporaryDirectory() as cache_dir:
+        run_child(cache_dir)
+        print("artifacts:", len(os.listdir(cache_dir)))
+        # A new process finds the artifact stored by the first one.
+        run_child(cache_dir)
+        print("artifacts:", len(os.listdir(cache_dir)))
@@ -0,0 +1,60 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import os
+
+# Read the first time a tensor is traced. Dim 0 is dynamic, and its sizes up
+# to 8 share one bucket.
+os.environ["LTC_ENABLE_DYNAMIC_SHAPES"] = "1"
+os.environ["LTC_DYNAMIC_DIMS"] = "0"
+os.environ["LTC_DYNAMIC_DIM_BUCKETS"] = "8,64"
+
+import torch
+import torch._lazy
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+
+device = "lazy"
+
+
+def step(rows):
+    x = torch.ones(rows, 4).to(device)
+    y = torch.tanh(x) * 2
+    torch._lazy.mark_step()
+    return y
+
+
+# CHECK: func.func @graph(%{{.*}}: !torch.vtensor<[?,4],f32>
+# CHECK: lowered graphs: 1
+# CHECK-NEXT: matches: True
+# -----
+# CHECK: PASS - test_same_bucket
+@run_test
+def test_same_bucket():
+    step(3)
+    print(lazy_backend.get_latest_computation().to_string())
+    # Same bucket as 3 rows, so the graph is not lowered again.
+    y = step(5)
+    metrics = lazy_backend.get_backend_metrics()
+    print("lowered graphs:", int(metrics["TorchMlirLowerNodes.Samples"]))
+    print("matches:", torch.allclose(y.cpu(), torch.tanh(torch.ones(5, 4)) * 2))
+
+
+# CHECK: lowered graphs: 2
+# CHECK-NEXT: matches: True
+# -----
+# CHECK: PASS - test_other_bucket
+@run_test
+def test_other_bucket():
+    y = step(20)
+    metrics = lazy_backend.get_backend_metrics()
+    print("lowered graphs:", int(metrics["TorchMlirLowerNodes.Samples"]))
+    print("matches:", torch.allclose(y.cpu(), torch.tanh(torch.ones(20, 4)) * 2))
@@ -0,0 +1,77 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+# LTC_CAPTURE_FALLBACKS is read once per process, so the calls that are
+# captured are traced in a child process that sets it.
+
+import os
+import subprocess
+import sys
+
+import torch
+import torch._lazy
+import torch._lazy.metrics
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+
+device = "lazy"
+
+
+def trace_lgamma():
+    # torch-mlir has no lgamma, so it has no lazy kernel either.
+    x = torch.rand(2, 3).to(device) + 1
+    y = torch.lgamma(x) * 2
+    return x, y
+
+
+if sys.argv[1:] == ["--capture"]:
+    x, y = trace_lgamma()
+    counter_value = torch._lazy.metrics.counter_value
+    print("captured:", counter_value("TorchMlirCapturedFallback"))
+    print("eager:", counter_value("TorchMlirEagerFallback"))
+    print("shape:", list(y.shape))
+    # The call is a node of the graph, between the ops around it, rather
+    # than data that was computed eagerly.
+    print(torch._C._lazy._get_tensors_text([y]))
+    sys.exit(0)
+
+
+# CHECK: eager: True
+# CHECK-NEXT: matches: True
+# -----
+# CHECK: PASS - test_eager_fallback
+@run_test
+def test_eager_fallback():
+    x, y = trace_lgamma()
+    eager = torch._lazy.metrics.counter_value("TorchMlirEagerFallback")
+    print("eager:", eager is not None and eager > 0)
+    torch._lazy.mark_step()
+    print("matches:", torch.allclose(y.cpu(), torch.lgamma(x.cpu()) * 2))
+
+
+# CHECK: captured: 1
+# CHECK-NEXT: eager: None
+# CHECK-NEXT: shape: [2, 3]
+# CHECK: aten::lgamma
+# CHECK: aten::mul
+# -----
+# CHECK: PASS - test_captured_fallback
+@run_test
+def test_captured_fallback():
+    env = dict(os.environ, LTC_CAPTURE_FALLBACKS="1")
+    output = subprocess.run(
+        [sys.executable, __file__, "--capture"],
+        env=env,
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    print(output)
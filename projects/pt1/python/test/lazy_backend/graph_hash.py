@@ -0,0 +1,40 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import torch
+import torch._lazy
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+
+device = "lazy"
+
+
+def graph_hash(rows, scale=2):
+    x = torch.ones(rows, 4).to(device)
+    y = torch.tanh(x) * scale
+    graph = torch._C._lazy._get_graph_hash([y])
+    torch._lazy.mark_step()
+    return graph
+
+
+# CHECK: same graph: True
+# CHECK-NEXT: other sizes: False
+# CHECK-NEXT: other constant: False
+# -----
+# CHECK: PASS - test_graph_hash
+@run_test
+def test_graph_hash():
+    # Nodes hash their op, operands and the sizes of their shapes, which
+    # decide whether a graph is compiled again.
+    first = graph_hash(3)
+    print("same graph:", graph_hash(3) == first)
+    print("other sizes:", graph_hash(5) == first)
+    print("other constant:", graph_hash(3, scale=3) == first)
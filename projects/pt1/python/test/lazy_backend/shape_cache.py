@@ -0,0 +1,53 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import torch
+import torch._lazy
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+
+device = "lazy"
+
+
+def trace(rows):
+    x = torch.ones(rows, 4).to(device)
+    w = torch.ones(4, 4).to(device)
+    y = torch.mm(x, w)
+    torch._lazy.mark_step()
+    return y
+
+
+def shape_cache_counts():
+    metrics = lazy_backend.get_backend_metrics()
+    return metrics["ShapeCacheHits"], metrics["ShapeCacheMisses"]
+
+
+# CHECK: first step misses: True
+# CHECK-NEXT: second step hits: True
+# CHECK-NEXT: second step misses: False
+# CHECK-NEXT: new shapes miss: True
+# CHECK-NEXT: matches: True
+# -----
+# CHECK: PASS - test_steady_state_hits
+@run_test
+def test_steady_state_hits():
+    hits, misses = shape_cache_counts()
+    trace(2)
+    first_hits, first_misses = shape_cache_counts()
+    print("first step misses:", first_misses > misses)
+    # The same ops on the same shapes reuse the inferred shapes.
+    trace(2)
+    second_hits, second_misses = shape_cache_counts()
+    print("second step hits:", second_hits > first_hits)
+    print("second step misses:", second_misses > first_misses)
+    y = trace(3)
+    print("new shapes miss:", shape_cache_counts()[1] > second_misses)
+    print("matches:", torch.allclose(y.cpu(), torch.full((3, 4), 4.0)))
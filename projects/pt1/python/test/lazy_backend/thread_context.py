@@ -0,0 +1,56 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import threading
+
+import torch
+import torch._lazy
+
+import torch_mlir._mlir_libs._REFERENCE_LAZY_BACKEND as lazy_backend
+
+from run_test import run_test
+
+lazy_backend._initialize()
+
+device = "lazy"
+
+
+def step(size):
+    x = torch.ones(size).to(device)
+    y = torch.tanh(x) * 2
+    torch._lazy.mark_step()
+    return y
+
+
+# CHECK: func.func @graph(%{{.*}}: !torch.vtensor<[2],f32>
+# CHECK: func.func @graph(%{{.*}}: !torch.vtensor<[3],f32>
+# CHECK: matches: True
+# -----
+# CHECK: PASS - test_graphs_share_context
+@run_test
+def test_graphs_share_context():
+    # Both graphs are lowered into the context of this thread.
+    first = step(2)
+    print(lazy_backend.get_latest_computation().to_string())
+    second = step(3)
+    print(lazy_backend.get_latest_computation().to_string())
+    print("matches:", torch.allclose(second.cpu(), torch.tanh(torch.ones(3)) * 2))
+
+
+# CHECK: func.func @graph(%{{.*}}: !torch.vtensor<[5],f32>
+# CHECK: matches: True
+# -----
+# CHECK: PASS - test_computation_outlives_thread
+@run_test
+def test_computation_outlives_thread():
+    results = []
+    thread = threading.Thread(target=lambda: results.append(step(5)))
+    thread.start()
+    thread.join()
+    # The context of the thread is kept for the computations built in it.
+    print(lazy_backend.get_latest_computation().to_string())
+    print("matches:", torch.allclose(results[0].cpu(), torch.tanh(torch.ones(5)) * 2))
@@ -9,7 +9,6 @@
 
 #include "module_builder.h"
 
-#include "jit_ir_importer/function_importer.h"
 #include "jit_ir_importer/ivalue_importer.h"
 #include "jit_ir_importer/mlir_utils.h"
 
@@ -112,7 +111,10 @@ ModuleBuilder::ModuleBuilder(pybind11::object contextObj)
       context(castPythonObjectToMlirContext(this->contextObj)),
       module(createEmptyModule(this->context)),
       moduleObj(castMlirModuleToPythonObject(module)),
-      unknownLoc(mlirLocationUnknownGet(context)) {
+      unknownLoc(mlirLocationUnknownGet(context)),
+      functionImportCache(context, [this](MlirOperation func) {
+        mlirBlockInsertOwnedOperationBefore(getBodyBlock(), terminator, func);
+      }) {
   // TODO: Rework this once dialect registration C-APIs are in place.
   // https://reviews.llvm.org/D88162
   torchMlirRegisterAllDialects(context);
@@ -129,12 +131,12 @@ torch::jit::StrongFunctionPtr ModuleBuilder::importFunction(
   if (!maybeImportOptions.is_none()) {
     importOptions = py::cast<ImportOptions>(maybeImportOptions);
   }
-  MlirBlock block = getBodyBlock();
-  MlirOperation terminator = this->terminator;
-  MlirOperation func = importJitFunctionAsFuncOp(
-      context, function.function_,
-      [](int) -> MlirAttribute { return {nullptr}; }, importOptions);
-  mlirBlockInsertOwnedOperationBefore(block, terminator, func);
+  // Functions called by `function` are imported along with it, and functions
+  // that were already imported (e.g. as the callee of an earlier function)
+  // are not imported again.
+  functionImportCache.importFunction(
+      function.function_, [](int) -> MlirAttribute { return {nullptr}; },
+      importOptions);
   return function;
 }
 
@@ -11,6 +11,7 @@
 #define TORCHMLIRJITIRIMPORTER_CSRC_BUILDER_H
 
 #include "jit_ir_importer/class_annotator.h"
+#include "jit_ir_importer/function_importer.h"
 
 #include "mlir-c/IR.h"
 
@@ -60,6 +61,8 @@ private:
   pybind11::object moduleObj;
   MlirOperation terminator;
   MlirLocation unknownLoc;
+  // The functions imported by importFunction, along with their callees.
+  FunctionImportCache functionImportCache;
 };
 
 } // namespace torch_mlir
@@ -15,12 +15,17 @@
 #include <torch/csrc/lazy/core/shape.h>
 
 #include <base_lazy_backend/backend_impl.h>
+#include <base_lazy_backend/computation_cache.h>
 #include <base_lazy_backend/generated/LazyNativeFunctions.h>
+#include <base_lazy_backend/mlir_eager_fallback.h>
 #include <base_lazy_backend/mlir_lowering_context.h>
 #include <base_lazy_backend/utils/debug.h>
 #include <base_lazy_backend/utils/exception.h>
 #include <base_lazy_backend/utils/string_utils.h>
 
+#include "mlir-c/BuiltinOps.h"
+#include "mlir-c/IR.h"
+
 #include "backend_impl.h"
 
 using namespace torch::lazy;
@@ -33,6 +38,19 @@ inline bool beginswith(const std::string& s, const std::string& t) {
   return s.size() >= t.size() && s.compare(0, t.size(), t) == 0;
 }
 
+/// Serializes the lowered module, which stands in for the compiled binary
+/// that a vendor backend would store in the computation cache.
+static std::string SerializeComputation(TorchMlirComputation* computation) {
+  std::string bytecode;
+  mlirOperationWriteBytecode(
+      mlirModuleGetOperation(computation->module_op()),
+      [](MlirStringRef part, void* user_data) {
+        static_cast<std::string*>(user_data)->append(part.data, part.length);
+      },
+      &bytecode);
+  return bytecode;
+}
+
 struct ReferenceLazyBackendDeviceType : public BackendDeviceType {
   ReferenceLazyBackendDeviceType(c10::DeviceType device_type)
       : device_type_(device_type) {}
@@ -70,22 +88,44 @@ public:
   Compile(std::vector<ComputationPtr> instances) const override {
     PRINT_FUNCTION();
 
+    TorchMlirComputationCache* cache = GetComputationCache();
+    std::vector<ComputationPtr> compiled;
+    compiled.reserve(instances.size());
+
     // Vendor backend specific lowering can be exec here before returning.
     for (const auto& instance : instances) {
       TORCH_CHECK(
           instance->in_mark_step, "Compile outside of mark step:\n",
           GetComputationBackendText(instance));
+      ComputationPtr computation = instance;
+      auto mlir_computation =
+          std::static_pointer_cast<TorchMlirComputation>(instance);
+      const hash_t& hash = mlir_computation->hash();
+      if (cache && hash != kNullHash) {
+        if (ComputationPtr cached = cache->Get(hash)) {
+          computation = cached;
+        } else {
+          // A vendor backend would load its compiled binary from the stored
+          // artifact here and only compile when there is none.
+          if (!cache->LoadArtifact(hash)) {
+            cache->StoreArtifact(
+                hash, SerializeComputation(mlir_computation.get()));
+          }
+          cache->Add(hash, instance);
+        }
+      }
       // Store computation instance for external access after compilation.
-      GetLatestComputation() = instance;
+      GetLatestComputation() = computation;
+      compiled.push_back(computation);
     }
 
     std::cout << "Received " << instances.size()
               << " computation instances at Compile!" << std::endl;
 
-    return instances;
+    return compiled;
   }
 
-  std::vector<BackendDataPtr> ExecuteComputation(
+  std::vector<BackendDataPtr> ExecuteComputationSync(
       torch::lazy::ComputationPtr computation,
       c10::ArrayRef<BackendDataPtr> arguments,
       const BackendDevice& device) const override {
@@ -208,6 +248,7 @@ BackendImplInterface* GetReferenceLazyBackendImpl() {
 
 void InitReferenceLazyBackend() {
   at::RegisterTorchMlirLazyNativeFunctions();
+  RegisterTorchMlirEagerFallback();
   static std::unique_ptr<BackendRegistrar> g_registrar;
   g_registrar.reset(new BackendRegistrar(GetReferenceLazyBackendImpl()));
 
@@ -11,6 +11,7 @@
 #include "torch/csrc/lazy/backend/backend_interface.h"
 #include "torch/csrc/lazy/core/config.h"
 
+#include <base_lazy_backend/backend_impl.h>
 #include <base_lazy_backend/mlir_lowering_context.h>
 #include <base_lazy_backend/utils/string_utils.h>
 #include <base_lazy_backend/utils/sys_utils.h>
@@ -93,6 +94,31 @@ PYBIND11_MODULE(_REFERENCE_LAZY_BACKEND, m) {
         }
         return false;
       });
+  m.def("get_backend_metrics", []() {
+    auto* backend = static_cast<torch::lazy::TorchMlirBackendImpl*>(
+        torch::lazy::GetReferenceLazyBackendImpl());
+    py::dict result;
+    for (const auto& metric : backend->GetMetrics()) {
+      result[py::str(metric.first)] = metric.second;
+    }
+    return result;
+  });
+  m.def("get_computation_cache_metrics", []() -> py::object {
+    auto* backend = static_cast<torch::lazy::TorchMlirBackendImpl*>(
+        torch::lazy::GetReferenceLazyBackendImpl());
+    torch::lazy::TorchMlirComputationCache* cache =
+        backend->GetComputationCache();
+    if (!cache) {
+      return py::none();
+    }
+    torch::lazy::TorchMlirComputationCache::Metrics metrics =
+        cache->GetMetrics();
+    py::dict result;
+    result["hits"] = metrics.hits;
+    result["disk_hits"] = metrics.disk_hits;
+    result["misses"] = metrics.misses;
+    return result;
+  });
   m.def("_initialize", []() {
     NoGilSection gil;
     Initialize();
@@ -1360,6 +1360,19 @@ def emit_ops(emitter_td: TextEmitter, registry: Registry):
     )
     emit("torchvision::nms : (Tensor, Tensor, float) -> (Tensor)")
 
+    # ==========================================================================
+    # `_c10d_functional::` namespace.
+    # ==========================================================================
+
+    emit("_c10d_functional::all_reduce : (Tensor, str, str) -> (Tensor)")
+    emit(
+        "_c10d_functional::all_gather_into_tensor : (Tensor, int, str) -> (Tensor)"
+    )
+    emit(
+        "_c10d_functional::reduce_scatter_tensor : (Tensor, str, int, str) -> (Tensor)"
+    )
+    emit("_c10d_functional::wait_tensor : (Tensor) -> (Tensor)")
+
 
 def dump_registered_ops(outfile: TextIO, registry: Registry):
     for _, v in sorted(registry.by_unique_key.items()):
@@ -0,0 +1,59 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+import hashlib
+import os
+
+from torch_mlir.ir import Module
+
+__all__ = [
+    "CachingBackend",
+]
+
+
+class CachingBackend:
+    """A backend that keeps the artifacts that another backend compiles.
+
+    The artifacts are written as MLIR bytecode to a directory, under a hash
+    of the imported module, of the config that imported it and of the
+    `compile_cache_key()` of the wrapped backend, which describes how it
+    compiles, e.g. its pipelines. Compiling a module that is already in the
+    directory then only parses the artifact, so that reruns of the e2e tests
+    in any worker process skip the lowering of the tests that did not change.
+
+    The key does not cover the passes themselves: the directory must be
+    cleared when the compiler is rebuilt with changes to them.
+    """
+
+    def __init__(self, backend, cache_dir: str, config_name: str = ""):
+        self.backend = backend
+        self.cache_dir = cache_dir
+        self.config_name = config_name
+        os.makedirs(cache_dir, exist_ok=True)
+
+    def _get_path(self, module: Module) -> str:
+        key = hashlib.sha256()
+        key.update(module.operation.get_asm(binary=True, enable_debug_info=False))
+        key.update(self.config_name.encode())
+        key.update(type(self.backend).__qualname__.encode())
+        key.update(self.backend.compile_cache_key().encode())
+        return os.path.join(self.cache_dir, key.hexdigest() + ".mlirbc")
+
+    def compile(self, module: Module):
+        path = self._get_path(module)
+        if os.path.exists(path):
+            with open(path, "rb") as f:
+                return Module.parse(f.read(), context=module.context)
+        artifact = self.backend.compile(module)
+        # Write to a file of this process first, so that the workers that
+        # compile the same module never read a partially written artifact.
+        tmp_path = f"{path}.{os.getpid()}.tmp"
+        with open(tmp_path, "wb") as f:
+            artifact.operation.write_bytecode(f)
+        os.replace(tmp_path, path)
+        return artifact
+
+    def load(self, artifact):
+        return self.backend.load(artifact)
@@ -131,8 +131,18 @@ class FxImporterTestConfig(TestConfig):
             )
         return result
 
+    def prepare_run(self, artifact: torch.nn.Module, trace: Trace):
+        if self._torch_compile:
+            return super().prepare_run(artifact, trace)
+        return self._prepare_export_run(artifact, trace)
+
     def _export_run(self, artifact: torch.nn.Module, trace: Trace) -> Trace:
-        result: Trace = []
+        return self._prepare_export_run(artifact, trace)()
+
+    def _prepare_export_run(self, artifact: torch.nn.Module, trace: Trace):
+        # Export and compile the program for each item of the trace up front,
+        # so that the returned callable only runs the compiled programs.
+        loaded_items = []
         for item in trace:
             prog: ExportedProgram = torch.export.export(
                 artifact, tuple(item.inputs), strict=True
@@ -158,20 +168,31 @@ class FxImporterTestConfig(TestConfig):
             }
             params_flat, params_spec = pytree.tree_flatten(params)
             params_flat = list(params_flat)
-            with torch.no_grad():
-                numpy_inputs = recursively_convert_to_numpy(params_flat + item.inputs)
-            outputs = getattr(backend_module, artifact.__class__.__name__)(
-                *numpy_inputs
-            )
-            output = refine_result_type(outputs)
-            if isinstance(output, (tuple, list)):
-                user_output = []
-                out_spec: OutputSpec
-                for val, out_spec in zip(output, prog.graph_signature.output_specs):
-                    if out_spec.kind == OutputKind.USER_OUTPUT:
-                        user_output.append(val)
-                output = tuple(user_output)
-            result.append(
-                TraceItem(symbol=item.symbol, inputs=item.inputs, output=output)
-            )
-        return result
+            loaded_items.append((item, prog, backend_module, params_flat))
+
+        def run_trace() -> Trace:
+            result: Trace = []
+            for item, prog, backend_module, params_flat in loaded_items:
+                with torch.no_grad():
+                    numpy_inputs = recursively_convert_to_numpy(
+                        params_flat + item.inputs
+                    )
+                outputs = getattr(backend_module, artifact.__class__.__name__)(
+                    *numpy_inputs
+                )
+                output = refine_result_type(outputs)
+                if isinstance(output, (tuple, list)):
+                    user_output = []
+                    out_spec: OutputSpec
+                    for val, out_spec in zip(
+                        output, prog.graph_signature.output_specs
+                    ):
+                        if out_spec.kind == OutputKind.USER_OUTPUT:
+                            user_output.append(val)
+                    output = tuple(user_output)
+                result.append(
+                    TraceItem(symbol=item.symbol, inputs=item.inputs, output=output)
+                )
+            return result
+
+        return run_trace
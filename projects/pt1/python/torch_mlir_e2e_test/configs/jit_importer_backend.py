@@ -70,13 +70,20 @@ class JITImporterTestConfig(TestConfig):
         return self.backend.compile(module)
 
     def run(self, artifact: Any, trace: Trace) -> Trace:
+        return self.prepare_run(artifact, trace)()
+
+    def prepare_run(self, artifact: Any, trace: Trace):
         backend_module = self.backend.load(artifact)
-        result: Trace = []
-        for item in trace:
-            numpy_inputs = recursively_convert_to_numpy(item.inputs)
-            outputs = getattr(backend_module, item.symbol)(*numpy_inputs)
-            output = recursively_convert_from_numpy(outputs)
-            result.append(
-                TraceItem(symbol=item.symbol, inputs=item.inputs, output=output)
-            )
-        return result
+
+        def run_trace() -> Trace:
+            result: Trace = []
+            for item in trace:
+                numpy_inputs = recursively_convert_to_numpy(item.inputs)
+                outputs = getattr(backend_module, item.symbol)(*numpy_inputs)
+                output = recursively_convert_from_numpy(outputs)
+                result.append(
+                    TraceItem(symbol=item.symbol, inputs=item.inputs, output=output)
+                )
+            return result
+
+        return run_trace
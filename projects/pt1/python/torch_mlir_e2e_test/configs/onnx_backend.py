@@ -149,13 +149,20 @@ class OnnxBackendTestConfig(TestConfig):
         return compiled_module
 
     def run(self, artifact: Any, trace: Trace) -> Trace:
+        return self.prepare_run(artifact, trace)()
+
+    def prepare_run(self, artifact: Any, trace: Trace):
         backend_module = self.backend.load(artifact)
-        result: Trace = []
-        for item in trace:
-            numpy_inputs = recursively_convert_to_numpy(item.inputs)
-            outputs = getattr(backend_module, "main_graph")(*numpy_inputs)
-            output = recursively_convert_from_numpy(outputs)
-            result.append(
-                TraceItem(symbol=item.symbol, inputs=item.inputs, output=output)
-            )
-        return result
+
+        def run_trace() -> Trace:
+            result: Trace = []
+            for item in trace:
+                numpy_inputs = recursively_convert_to_numpy(item.inputs)
+                outputs = getattr(backend_module, "main_graph")(*numpy_inputs)
+                output = recursively_convert_from_numpy(outputs)
+                result.append(
+                    TraceItem(symbol=item.symbol, inputs=item.inputs, output=output)
+                )
+            return result
+
+        return run_trace
@@ -24,8 +24,14 @@ import abc
 from typing import Any, Callable, List, NamedTuple, Optional, TypeVar, Union, Dict
 from itertools import repeat
 
+import concurrent.futures
+import hashlib
+import inspect
 import os
+import resource
 import sys
+import threading
+import time
 import traceback
 import signal
 
@@ -180,6 +186,22 @@ class TestConfig(abc.ABC):
         """
         pass
 
+    def prepare_run(
+        self, artifact: CompiledArtifact, trace: Trace
+    ) -> Callable[[], Trace]:
+        """Prepare to run `trace` on `artifact` repeatedly.
+
+        Returns a callable that behaves like `run(artifact, trace)`. It is
+        used to benchmark the artifact, so configs that do work in `run`
+        which does not depend on the inputs, such as loading the artifact,
+        should do it here instead of in the callable.
+        """
+        return lambda: self.run(artifact, trace)
+
+
+# The seed that `TestUtils` resets the random number generator to.
+_TEST_UTILS_SEED = 0
+
 
 # Utilities for common testing trace generation.
 # Also, resets the random seed for reproducibility.
@@ -196,7 +218,7 @@ class TestUtils:
     """
 
     def __init__(self):
-        torch.manual_seed(0)
+        torch.manual_seed(_TEST_UTILS_SEED)
 
     # TODO: Add zeros/ones/etc. as convenient.
     def rand(self, *sizes, low=0.0, high=1.0):
@@ -295,15 +317,86 @@ class _Tracer:
         )
 
 
+_golden_trace_lock = threading.Lock()
+
+
+def _get_golden_trace_cache_path(test: Test, cache_dir: str) -> Optional[str]:
+    """The file of `cache_dir` that keeps the golden trace of `test`.
+
+    The file is named by a hash of the name of the test, of the source files
+    that define its module and its invoker, of the torch version and of the
+    seed of `TestUtils`, so that a change to any of them makes a new trace.
+    Returns None if the source of the test cannot be found.
+    """
+    key = hashlib.sha256()
+    key.update(test.unique_name.encode())
+    for obj in (test.program_factory, test.program_invoker):
+        try:
+            source_file = inspect.getsourcefile(obj)
+        except TypeError:
+            return None
+        if source_file is None or not os.path.isfile(source_file):
+            return None
+        with open(source_file, "rb") as f:
+            key.update(f.read())
+    key.update(torch.__version__.encode())
+    key.update(str(_TEST_UTILS_SEED).encode())
+    return os.path.join(cache_dir, key.hexdigest() + ".pt")
+
+
+def _load_golden_trace(path: str) -> Optional[Trace]:
+    try:
+        items = torch.load(path, weights_only=False)
+    except Exception:
+        # A trace that cannot be read is generated again.
+        return None
+    return [
+        TraceItem(symbol=symbol, inputs=inputs, output=output)
+        for symbol, inputs, output in items
+    ]
+
+
+def _save_golden_trace(trace: Trace, path: str):
+    # Write to a file of this process first, so that the workers that run
+    # the same test never read a partially written trace.
+    tmp_path = f"{path}.{os.getpid()}.{threading.get_ident()}.tmp"
+    try:
+        torch.save(
+            [(item.symbol, item.inputs, item.output) for item in trace], tmp_path
+        )
+        os.replace(tmp_path, path)
+    except Exception:
+        # Traces of values that torch cannot serialize are not cached.
+        if os.path.exists(tmp_path):
+            os.remove(tmp_path)
+
+
 def generate_golden_trace(test: Test) -> Trace:
     """Generate a trace with the original program.
 
     If the original program is deterministic, then this the produced trace is
     suitable as a golden trace to compare against.
+
+    If the `TORCH_MLIR_GOLDEN_TRACE_CACHE_DIR` env var names a directory, the
+    traces are kept there, so that later runs, with any config, reuse them
+    instead of running the original program again.
     """
+    cache_dir = os.getenv("TORCH_MLIR_GOLDEN_TRACE_CACHE_DIR", "")
+    path = _get_golden_trace_cache_path(test, cache_dir) if cache_dir else None
+    if path is not None and os.path.exists(path):
+        trace = _load_golden_trace(path)
+        if trace is not None:
+            return trace
+
     trace = []
-    tracer = _Tracer(test.program_factory(), [], trace)
-    test.program_invoker(tracer, TestUtils())
+    # The seed that TestUtils sets is global, so tests that run in threads
+    # generate their traces one at a time.
+    with _golden_trace_lock:
+        tracer = _Tracer(test.program_factory(), [], trace)
+        test.program_invoker(tracer, TestUtils())
+    if path is not None:
+        os.makedirs(cache_dir, exist_ok=True)
+        _save_golden_trace(trace, path)
     return trace
 
 
@@ -316,11 +409,16 @@ class timeout:
         raise TimeoutError(self.error_message)
 
     def __enter__(self):
-        signal.signal(signal.SIGALRM, self.handle_timeout)
-        signal.alarm(self.seconds)
+        # Signal handlers can only be set on the main thread, so tests that
+        # run in other threads have no timeout.
+        self.enabled = threading.current_thread() is threading.main_thread()
+        if self.enabled:
+            signal.signal(signal.SIGALRM, self.handle_timeout)
+            signal.alarm(self.seconds)
 
     def __exit__(self, type, value, traceback):
-        signal.alarm(0)
+        if self.enabled:
+            signal.alarm(0)
 
 
 def compile_and_run_test(test: Test, config: TestConfig, verbose=False) -> Any:
@@ -354,7 +452,8 @@ def compile_and_run_test(test: Test, config: TestConfig, verbose=False) -> Any:
             trace = config.run(compiled, golden_trace)
 
             # Disable the alarm
-            signal.alarm(0)
+            if threading.current_thread() is threading.main_thread():
+                signal.alarm(0)
         except TimeoutError:
             return TestResult(
                 unique_name=test.unique_name,
@@ -382,10 +481,38 @@ def compile_and_run_test(test: Test, config: TestConfig, verbose=False) -> Any:
         )
 
 
+def _run_tests_in_threads(
+    tests: List[Test], config: TestConfig, num_threads: int, verbose: bool
+) -> List[TestResult]:
+    """Invoke the given `Test`'s on a pool of threads of this process.
+
+    Unlike the process pool of `run_tests`, the threads share the imported
+    modules of this process, so there is no per-worker startup cost, and
+    they run concurrently wherever the GIL is released. A crash of a test
+    ends the whole run, and tests have no timeout.
+    """
+    with concurrent.futures.ThreadPoolExecutor(num_threads) as executor:
+        results = list(
+            executor.map(
+                lambda test: compile_and_run_test(test, config, verbose), tests
+            )
+        )
+    results.sort(key=lambda result: result.unique_name)
+    return results
+
+
 def run_tests(
-    tests: List[Test], config: TestConfig, sequential=False, verbose=False
+    tests: List[Test],
+    config: TestConfig,
+    sequential=False,
+    verbose=False,
+    threads=False,
 ) -> List[TestResult]:
-    """Invoke the given `Test`'s with the provided `TestConfig`."""
+    """Invoke the given `Test`'s with the provided `TestConfig`.
+
+    With `threads`, the tests run on threads of this process instead of
+    in a pool of processes.
+    """
     num_processes = min(int(mp.cpu_count() * 0.8) + 1, len(tests))
     try:
         env_concurrency = int(os.getenv("TORCH_MLIR_TEST_CONCURRENCY", "0"))
@@ -405,6 +532,10 @@ def run_tests(
             "Bad value for TORCH_MLIR_TEST_VERBOSE env var: " "Expected integer."
         ) from e
 
+    # The threads do not have the slowdown described below.
+    if threads and not sequential:
+        return _run_tests_in_threads(tests, config, num_processes, verbose)
+
     # TODO: We've noticed that on certain 2 core machine parallelizing the tests
     # makes the llvm backend legacy pass manager 20x slower than using a
     # single process. Need to investigate the root cause eventually. This is a
@@ -464,3 +595,97 @@ def run_tests(
     results.extend(aborted_tests_results)
     results.sort(key=lambda result: result.unique_name)
     return results
+
+
+class BenchmarkResult(NamedTuple):
+    # Should match Test.unique_name for corresponding test.
+    unique_name: str
+    # If compiling or running the test failed, a string describing the
+    # failure. If this is not None, the other fields are empty.
+    error: Optional[str]
+    # The wall-clock time in seconds of each timed run of the trace.
+    latencies: List[float]
+    # The number of calls in the trace of the test.
+    num_calls: int
+    # The peak resident memory in bytes of the process that compiled and ran
+    # the test.
+    peak_memory: int
+
+
+def _get_peak_memory() -> int:
+    peak_memory = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # `ru_maxrss` is in bytes on macOS and in kilobytes elsewhere.
+    return peak_memory if sys.platform == "darwin" else peak_memory * 1024
+
+
+def benchmark_test(
+    test: Test, config: TestConfig, warmup_iterations: int, iterations: int
+) -> BenchmarkResult:
+    """Compile `test` once and time `iterations` runs of its trace.
+
+    The runs are timed after `warmup_iterations` untimed ones, so that
+    one-time costs such as lazy initialization are not counted.
+    """
+    try:
+        golden_trace = generate_golden_trace(test)
+        compiled = config.compile(test.program_factory(), verbose=False)
+        run_trace = config.prepare_run(compiled, golden_trace)
+        for _ in range(warmup_iterations):
+            run_trace()
+        latencies = []
+        for _ in range(iterations):
+            start = time.perf_counter()
+            run_trace()
+            latencies.append(time.perf_counter() - start)
+    except Exception as e:
+        return BenchmarkResult(
+            unique_name=test.unique_name,
+            error="".join(traceback.format_exception(type(e), e, e.__traceback__)),
+            latencies=[],
+            num_calls=0,
+            peak_memory=0,
+        )
+    return BenchmarkResult(
+        unique_name=test.unique_name,
+        error=None,
+        latencies=latencies,
+        num_calls=len(golden_trace),
+        peak_memory=_get_peak_memory(),
+    )
+
+
+def run_benchmarks(
+    tests: List[Test],
+    config: TestConfig,
+    warmup_iterations: int = 10,
+    iterations: int = 100,
+) -> List[BenchmarkResult]:
+    """Benchmark the given `Test`'s with the provided `TestConfig`.
+
+    Unlike `run_tests`, the tests run one at a time, so that they do not
+    compete for the cores, and each in a new process, so that the peak memory
+    of the process is that of the test.
+    """
+    torch.autograd.set_grad_enabled(False)
+    results = []
+    for test in sorted(tests, key=lambda t: t.unique_name):
+        print(f"*** BENCHMARKING TEST: {test.unique_name} ***")
+        # Give each run its own timeout, plus one for compilation.
+        timeout_seconds = test.timeout_seconds * (warmup_iterations + iterations + 1)
+        with mp.Pool(1) as pool:
+            handle = pool.apply_async(
+                benchmark_test, (test, config, warmup_iterations, iterations)
+            )
+            try:
+                results.append(handle.get(timeout=timeout_seconds))
+            except mp.TimeoutError:
+                results.append(
+                    BenchmarkResult(
+                        unique_name=test.unique_name,
+                        error="Benchmark timed out or its process crashed.\n",
+                        latencies=[],
+                        num_calls=0,
+                        peak_memory=0,
+                    )
+                )
+    return results
@@ -3,7 +3,12 @@
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 # Also available under a BSD-style license. See LICENSE.
 
+import collections
 import ctypes
+import hashlib
+import time
+from typing import Optional, Sequence, Union
+
 import numpy as np
 
 from torch_mlir.ir import *
@@ -60,6 +65,17 @@ elemental_type_to_ctype = {
 }
 
 CONSUME_RETURN_FUNC_PREFIX = "refbackend_consume_func_return_"
+PROFILE_NAMES_ATTR = "refback.profile_names"
+
+
+def get_profile_names(module):
+    """Returns the names of the ops timed by `refback-insert-profiling`, by
+    their index, or None if the module is not instrumented."""
+    with module.context:
+        attributes = module.operation.attributes
+        if PROFILE_NAMES_ATTR not in attributes:
+            return None
+        return [StringAttr(name).value for name in attributes[PROFILE_NAMES_ATTR]]
 
 
 def get_return_funcs(module):
@@ -90,24 +106,103 @@ def get_ctype_func(func_name):
     return ctypes.CFUNCTYPE(*ctypes_arg), ret_types
 
 
+_libc = ctypes.CDLL(None)
+_libc.free.argtypes = [ctypes.c_void_p]
+_libc.free.restype = None
+
+
+class _MemRefAllocation:
+    """The allocation of a memref returned by a compiled function.
+
+    The buffer deallocation pipeline makes functions return memrefs that the
+    caller owns, so the allocation is freed once no array refers to it.
+    """
+
+    def __init__(self, ptr: int):
+        self.ptr = ptr
+
+    def __del__(self):
+        _libc.free(self.ptr)
+
+
+class _MemRefView:
+    """A numpy array interface to a memref in a `_MemRefAllocation`."""
+
+    def __init__(self, allocation, data: int, shape, strides, dtype):
+        self.allocation = allocation
+        self.__array_interface__ = {
+            "version": 3,
+            "data": (data, False),
+            "shape": tuple(shape),
+            "strides": tuple(strides),
+            "typestr": np.dtype(dtype).str,
+        }
+
+
+def unranked_memref_to_owned_numpy(unranked_memref, np_dtype, allocations):
+    """Converts a returned unranked memref to a numpy array without a copy.
+
+    The array takes ownership of the allocation of the memref. `allocations`
+    maps the allocated pointers of the other memrefs returned by the same
+    call to their `_MemRefAllocation`, so that results that share a buffer
+    free it once.
+    """
+    rank = unranked_memref[0].rank
+    if rank == 0:
+        descriptor_type = make_zero_d_memref_descriptor(ctypes.c_byte)
+    else:
+        descriptor_type = make_nd_memref_descriptor(rank, ctypes.c_byte)
+    descriptor = ctypes.cast(
+        unranked_memref[0].descriptor, ctypes.POINTER(descriptor_type)
+    )[0]
+    allocated = ctypes.cast(descriptor.allocated, ctypes.c_void_p).value
+    aligned = ctypes.cast(descriptor.aligned, ctypes.c_void_p).value
+    itemsize = np.dtype(np_dtype).itemsize
+    shape = list(descriptor.shape) if rank else []
+    strides = [s * itemsize for s in descriptor.strides] if rank else []
+    if allocated not in allocations:
+        allocations[allocated] = _MemRefAllocation(allocated)
+    view = _MemRefView(
+        allocations[allocated],
+        aligned + descriptor.offset * itemsize,
+        shape,
+        strides,
+        np_dtype,
+    )
+    return np.asarray(view)
+
+
 class RefBackendInvoker:
-    def __init__(self, module):
-        self.ee = ExecutionEngine(module)
+    def __init__(self, module, opt_level: int = 2, shared_libs=()):
+        self.ee = ExecutionEngine(
+            module, opt_level=opt_level, shared_libs=list(shared_libs)
+        )
         self.result = None
+        # The time spent in each profiled op by the last call, if the module
+        # was compiled with `profile`.
+        self.profile = None
+
+        profile_names = get_profile_names(module)
+        self._profiled = profile_names is not None
+        if self._profiled:
+            self._register_profiling(profile_names)
 
         return_funcs = get_return_funcs(module)
 
         for ret_func in return_funcs:
             ctype_wrapper, ret_types = get_ctype_func(ret_func)
 
-            def consume_return_funcs(*args):
+            def consume_return_funcs(*args, ret_types=ret_types):
+                # The results are returned as views of the memrefs, which
+                # they then own, rather than as copies.
+                allocations = {}
                 self.result = tuple(
                     [
                         (
                             arg
                             if type in elemental_type_to_ctype
-                            else unranked_memref_to_numpy(
-                                arg, memref_type_to_np_dtype[type]
+                            else unranked_memref_to_owned_numpy(
+                                arg, memref_type_to_np_dtype[type], allocations
                             )
                         )
                         for arg, type in zip(args, ret_types)
@@ -118,6 +213,38 @@ class RefBackendInvoker:
 
             self.ee.register_runtime(ret_func, ctype_wrapper(consume_return_funcs))
 
+    def _register_profiling(self, names):
+        profile_func = ctypes.CFUNCTYPE(None, ctypes.c_int64)
+        starts = {}
+        self._profile_counts = collections.Counter()
+        self._profile_seconds = collections.Counter()
+
+        def begin(index):
+            starts[index] = time.perf_counter()
+
+        def end(index):
+            seconds = time.perf_counter() - starts.pop(index)
+            self._profile_counts[names[index]] += 1
+            self._profile_seconds[names[index]] += seconds
+
+        # The callbacks must outlive the compiled code that calls them.
+        self._profile_callbacks = {
+            "refbackend_profile_begin": profile_func(begin),
+            "refbackend_profile_end": profile_func(end),
+        }
+        for name, callback in self._profile_callbacks.items():
+            self.ee.register_runtime(name, callback)
+
+    def _collect_profile(self):
+        """Sets `profile` to the calls and seconds of each op name in the last
+        call, slowest first, and starts counting anew."""
+        self.profile = {
+            name: {"calls": self._profile_counts[name], "seconds": seconds}
+            for name, seconds in self._profile_seconds.most_common()
+        }
+        self._profile_counts.clear()
+        self._profile_seconds.clear()
+
     def __getattr__(self, function_name: str):
         def invoke(*args):
             ffi_args = []
@@ -128,6 +255,8 @@ class RefBackendInvoker:
                 )
 
             self.ee.invoke(function_name, *ffi_args)
+            if self._profiled:
+                self._collect_profile()
             result = self.result
             assert result is not None, "Invocation didn't produce a result"
             self.result = None
@@ -136,7 +265,43 @@ class RefBackendInvoker:
         return invoke
 
 
-def lowering_pipeline(generate_runtime_verification: bool):
+class _InvokerCache:
+    """A bounded cache of invokers, keyed by a hash of the compiled module.
+
+    JIT compilation of a module is much slower than running it, so loading
+    the same compiled module again reuses the invoker, and the machine code,
+    of the previous load. The loads of a module then share its ml_program
+    globals, such as the state of the random number generator.
+    """
+
+    def __init__(self, capacity: int, shared_libs):
+        self.capacity = capacity
+        self.shared_libs = shared_libs
+        self.invokers = collections.OrderedDict()
+
+    def get_or_create(self, module, opt_level: int) -> RefBackendInvoker:
+        asm = module.operation.get_asm(binary=True, enable_debug_info=False)
+        key = (hashlib.sha256(asm).hexdigest(), opt_level)
+        if key in self.invokers:
+            self.invokers.move_to_end(key)
+            return self.invokers[key]
+        invoker = RefBackendInvoker(
+            module, opt_level=opt_level, shared_libs=self.shared_libs
+        )
+        self.invokers[key] = invoker
+        if len(self.invokers) > self.capacity:
+            self.invokers.popitem(last=False)
+        return invoker
+
+
+def lowering_pipeline(
+    generate_runtime_verification: bool,
+    vectorize: bool = False,
+    parallel: bool = False,
+    profile: bool = False,
+    inter_op: bool = False,
+    approximate_math: Optional[Sequence[str]] = None,
+):
     passes = [
         # Apply some optimizations. It would be great if MLIR had more useful
         # optimizations that worked out of the box here.
@@ -155,6 +320,8 @@ def lowering_pipeline(generate_runtime_verification: bool):
         "sparse-storage-specifier-to-llvm",
         # Buffer deallocation pass does not know how to handle realloc.
         "func.func(expand-realloc)",
+        # Lower the packing of matmul operands, which leaves pads to generalize.
+        "func.func(refback-lower-linalg-pack)",
         # Generalize pad and concat after sparse compiler, as they are handled
         # differently when the operations involve sparse operand.
         "func.func(refback-generalize-tensor-pad)",
@@ -165,6 +332,8 @@ def lowering_pipeline(generate_runtime_verification: bool):
         "refback-mlprogram-bufferize",
         # "func.func(finalizing-bufferize)",
         "func.func(buffer-deallocation-pipeline)",
+        # Pack the statically shaped temporaries into one allocation.
+        "func.func(refback-plan-static-memory)",
         # Buffer-deallocation does not work with the inlined code generated
         # by sparse tensor dialect.
         "inline",  # inline sparse helper methods where useful
@@ -175,15 +344,57 @@ def lowering_pipeline(generate_runtime_verification: bool):
         # returns void at the C level -- we get the return value by providing the
         # callback).
         "refback-munge-calling-conventions",
+    ]
+    if inter_op:
+        # Run the linalg and TMTensor ops that do not depend on each other
+        # as concurrent async tasks.
+        passes += ["func.func(refback-async-independent-ops)"]
+    if profile:
+        # Time the linalg and TMTensor ops before they become loops.
+        passes += ["refback-insert-profiling"]
+    if approximate_math is not None:
+        # Replace the transcendental math ops by arithmetic, which vectorizes,
+        # before they are lowered to calls to libm.
+        options = ""
+        if approximate_math:
+            options = "{ops=" + ",".join(approximate_math) + "}"
+        passes += [f"func.func(refback-approximate-math{options})"]
+    passes += [
         # Insert global variable and instruction sequence for getting the next
         # global seed used in stateful rng.
         # Lower to LLVM
         "func.func(tm-tensor-to-loops)",
         "func.func(refback-munge-memref-copy)",
-        "func.func(convert-linalg-to-loops)",
-        "func.func(lower-affine)",
-        "convert-scf-to-cf",
     ]
+    if vectorize:
+        # Lower linalg ops through affine loops, which are tiled for the cache
+        # and whose innermost loops are turned into vector ops, instead of
+        # scalar loops.
+        passes += [
+            "func.func(convert-linalg-to-affine-loops)",
+            "func.func(affine-loop-tile)",
+            "func.func(affine-super-vectorize{virtual-vector-size=8 vectorize-reductions=true})",
+            "func.func(canonicalize)",
+            "func.func(convert-vector-to-scf)",
+        ]
+        if parallel:
+            passes += ["func.func(affine-parallelize)"]
+    elif parallel:
+        passes += ["func.func(convert-linalg-to-parallel-loops)"]
+    else:
+        passes += ["func.func(convert-linalg-to-loops)"]
+    passes += ["func.func(lower-affine)"]
+    if parallel:
+        # Split the scf.parallel loops into blocks that are run as async tasks
+        # on the thread pool of the MLIR async runtime.
+        passes += ["async-parallel-for"]
+    if parallel or inter_op:
+        passes += [
+            "async-to-async-runtime",
+            "async-runtime-ref-counting",
+            "async-runtime-ref-counting-opt",
+        ]
+    passes += ["convert-scf-to-cf"]
     if generate_runtime_verification:
         passes += ["generate-runtime-verification"]
     passes += [
@@ -200,6 +411,10 @@ def lowering_pipeline(generate_runtime_verification: bool):
         "finalize-memref-to-llvm",
         "func.func(convert-arith-to-llvm)",
         "convert-vector-to-llvm",
+    ]
+    if parallel or inter_op:
+        passes += ["convert-async-to-llvm"]
+    passes += [
         "convert-func-to-llvm",
         "convert-cf-to-llvm",
         "convert-complex-to-llvm",
@@ -212,9 +427,66 @@ def lowering_pipeline(generate_runtime_verification: bool):
 class RefBackendLinalgOnTensorsBackend(LinalgOnTensorsBackend):
     """Main entry-point for the reference backend."""
 
-    def __init__(self, generate_runtime_verification: bool = True):
+    def __init__(
+        self,
+        generate_runtime_verification: bool = True,
+        opt_level: int = 2,
+        invoker_cache_size: int = 0,
+        vectorize: bool = False,
+        async_runtime_lib: str = "",
+        profile: bool = False,
+        inter_op: bool = False,
+        approximate_math: Union[bool, Sequence[str]] = False,
+    ):
+        """
+        Args:
+          generate_runtime_verification: Whether the compiled code checks,
+            e.g., the bounds of memref accesses at runtime.
+          opt_level: The LLVM optimization level (0-3) of JIT compilation.
+          invoker_cache_size: When positive, the number of loaded modules
+            whose invokers are kept, so that loading one of them again does
+            not compile it again.
+          vectorize: Whether linalg ops are tiled and vectorized instead of
+            being lowered to scalar loops.
+          async_runtime_lib: When set, the path of the MLIR async runtime
+            library (`libmlir_async_runtime.so`). The parallel dims of linalg
+            ops are then run on the threads of that runtime.
+          profile: Whether each linalg and TMTensor op is timed at runtime.
+            The invoker then holds the time spent in each op by its last
+            call in `profile`, by the name of the torch op it was lowered
+            from if the module was lowered with `name_locations`.
+          inter_op: Whether the linalg and TMTensor ops that do not depend on
+            each other, e.g. those of the branches of a multi-branch block,
+            run concurrently on the threads of the async runtime, which
+            `async_runtime_lib` must then give.
+          approximate_math: Whether transcendental math ops, e.g. `exp` and
+            `tanh`, are computed by polynomial approximations rather than by
+            libm, so that they vectorize. True approximates the ops whose
+            approximations are accurate over their whole range, and a list
+            of math op names, e.g. `["exp", "sin"]`, approximates those. See
+            `refback-approximate-math`.
+        """
         super().__init__()
+        if inter_op and not async_runtime_lib:
+            raise ValueError("inter_op requires async_runtime_lib")
         self.generate_runtime_verification = generate_runtime_verification
+        self.opt_level = opt_level
+        self.vectorize = vectorize
+        self.parallel = bool(async_runtime_lib)
+        self.profile = profile
+        self.inter_op = inter_op
+        if approximate_math is True:
+            self.approximate_math = ()
+        elif approximate_math is False:
+            self.approximate_math = None
+        else:
+            self.approximate_math = tuple(approximate_math)
+        self.shared_libs = [async_runtime_lib] if async_runtime_lib else []
+        self.invoker_cache = (
+            _InvokerCache(invoker_cache_size, self.shared_libs)
+            if invoker_cache_size > 0
+            else None
+        )
 
     def compile(self, imported_module: Module):
         """Compiles an imported module, with a flat list of functions.
@@ -231,12 +503,34 @@ class RefBackendLinalgOnTensorsBackend(LinalgOnTensorsBackend):
         """
         run_pipeline_with_repro_report(
             imported_module,
-            lowering_pipeline(self.generate_runtime_verification),
+            lowering_pipeline(
+                self.generate_runtime_verification,
+                self.vectorize,
+                self.parallel,
+                self.profile,
+                self.inter_op,
+                self.approximate_math,
+            ),
             "Lowering Linalg-on-Tensors IR to LLVM with RefBackend",
             enable_ir_printing=False,
         )
         return imported_module
 
+    def compile_cache_key(self) -> str:
+        """A description of how `compile` lowers modules, for compile caches."""
+        return lowering_pipeline(
+            self.generate_runtime_verification,
+            self.vectorize,
+            self.parallel,
+            self.profile,
+            self.inter_op,
+            self.approximate_math,
+        )
+
     def load(self, module) -> RefBackendInvoker:
         """Loads a compiled artifact into the runtime."""
-        return RefBackendInvoker(module)
+        if self.invoker_cache is not None:
+            return self.invoker_cache.get_or_create(module, self.opt_level)
+        return RefBackendInvoker(
+            module, opt_level=self.opt_level, shared_libs=self.shared_libs
+        )
@@ -6,15 +6,17 @@
 Utilities for reporting the results of the test framework.
 """
 
-from typing import Any, List, Optional, Set
+from typing import Any, Dict, List, Optional, Set
 
 import collections
 import io
+import json
+import math
 import textwrap
 
 import torch
 
-from .framework import TestResult, TraceItem
+from .framework import BenchmarkResult, TestResult, TraceItem
 
 
 class TensorSummary:
@@ -358,3 +360,57 @@ def report_results(
         if results_by_outcome[key]:
             print(f"    {OUTCOME_MEANINGS[key]}: {len(results_by_outcome[key])}")
     return had_unexpected_results
+
+
+def _percentile(sorted_values: List[float], percent: float) -> float:
+    """The nearest-rank percentile of a non-empty sorted list."""
+    rank = math.ceil(percent / 100 * len(sorted_values))
+    return sorted_values[max(rank, 1) - 1]
+
+
+def summarize_benchmark(result: BenchmarkResult) -> Dict[str, Any]:
+    """A JSON-serializable summary of a BenchmarkResult."""
+    if result.error is not None:
+        return {"error": result.error}
+    latencies = sorted(result.latencies)
+    mean_latency = sum(latencies) / len(latencies)
+    return {
+        "p50_latency_ms": _percentile(latencies, 50) * 1e3,
+        "p99_latency_ms": _percentile(latencies, 99) * 1e3,
+        # The calls of the trace that run per second.
+        "throughput_calls_per_s": result.num_calls / mean_latency,
+        "peak_memory_bytes": result.peak_memory,
+    }
+
+
+def report_benchmarks(
+    results_by_config: Dict[str, List[BenchmarkResult]],
+    output_path: Optional[str] = None,
+):
+    """Print a table of the BenchmarkResult's of the given configs.
+
+    If `output_path` is given, the summaries are also written there as JSON,
+    keyed by the test and then by the config, so that runs on different
+    commits can be compared.
+    """
+    summaries = collections.defaultdict(dict)
+    for config, results in results_by_config.items():
+        for result in results:
+            summaries[result.unique_name][config] = summarize_benchmark(result)
+
+    for unique_name, by_config in sorted(summaries.items()):
+        print(f'"{unique_name}"')
+        for config, summary in by_config.items():
+            if "error" in summary:
+                print(f"    {config}: error")
+                continue
+            print(
+                f"    {config}: p50={summary['p50_latency_ms']:.3f}ms "
+                f"p99={summary['p99_latency_ms']:.3f}ms "
+                f"throughput={summary['throughput_calls_per_s']:.1f}calls/s "
+                f"peak_memory={summary['peak_memory_bytes'] / 2**20:.1f}MiB"
+            )
+
+    if output_path:
+        with open(output_path, "w") as f:
+            json.dump(summaries, f, indent=2, sort_keys=True)
@@ -60,6 +60,10 @@ class LinalgOnTensorsStablehloBackend(StablehloBackend):
 
         return self.refbackend.compile(imported_module)
 
+    def compile_cache_key(self) -> str:
+        """A description of how `compile` lowers modules, for compile caches."""
+        return STABLEHLO_TO_LINALG_FUNC_PIPELINE + ";" + self.refbackend.compile_cache_key()
+
     def load(self, module):
         """Loads a compiled artifact into the runtime."""
         return self.refbackend.load(module)
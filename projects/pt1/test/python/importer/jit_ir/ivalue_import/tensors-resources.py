@@ -0,0 +1,45 @@
+# -*- Python -*-
+# This file is licensed under a pytorch-style license
+# See LICENSE.pytorch for license information.
+
+import typing
+
+import torch
+from torch_mlir.jit_ir_importer import ClassAnnotator, ImportOptions, ModuleBuilder
+
+# RUN: %PYTHON %s | torch-mlir-opt | FileCheck %s
+
+mb = ModuleBuilder()
+
+
+class TestModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.arange = torch.nn.Parameter(torch.arange(3.0))
+        self.mask = torch.tensor([True, False])
+        self.ones_i32 = torch.ones(1, dtype=torch.int32)
+
+
+# CHECK: %[[ARANGE:.*]] = torch.tensor.literal(dense_resource<torch_tensor_3_Float> : tensor<3xf32>) : !torch.tensor<[3],f32>
+# CHECK: %[[MASK:.*]] = torch.tensor.literal(dense_resource<torch_tensor_2_Bool> : tensor<2xi1>) : !torch.tensor<[2],i1>
+# Single elements are kept inline.
+# CHECK: %[[ONES_I32:.*]] = torch.tensor.literal(dense<1> : tensor<1xsi32>) : !torch.tensor<[1],si32>
+# CHECK: torch.slot "arange", %[[ARANGE]] : !torch.tensor<[3],f32>
+# CHECK: torch.slot "mask", %[[MASK]] : !torch.tensor<[2],i1>
+# CHECK: torch.slot "ones_i32", %[[ONES_I32]] : !torch.tensor<[1],si32>
+# CHECK: {-#
+# CHECK:   dialect_resources: {
+# CHECK:     builtin: {
+# CHECK-DAG:   torch_tensor_3_Float: "0x04000000000000000000803F00000040"
+# CHECK-DAG:   torch_tensor_2_Bool: "0x010000000100"
+test_module = TestModule()
+recursivescriptmodule = torch.jit.script(test_module)
+
+import_options = ImportOptions()
+import_options.minResourceTensorNumBytes = 0
+
+class_annotator = ClassAnnotator()
+
+# TODO: Automatically handle unpacking Python class RecursiveScriptModule into the underlying ScriptModule.
+mb.import_module(recursivescriptmodule._c, class_annotator, import_options)
+mb.module.operation.print()
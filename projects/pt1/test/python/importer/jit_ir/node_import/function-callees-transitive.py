@@ -0,0 +1,38 @@
+# -*- Python -*-
+# This file is licensed under a pytorch-style license
+# See LICENSE.pytorch for license information.
+
+import torch
+from torch_mlir.jit_ir_importer import ModuleBuilder
+
+# RUN: %PYTHON %s | torch-mlir-opt | FileCheck %s
+
+mb = ModuleBuilder()
+
+
+@torch.jit.script
+def double(i: int) -> int:
+    return i * 2
+
+
+@torch.jit.script
+def double_plus_one(i: int) -> int:
+    return double(i) + 1
+
+
+# The callees of a callee are imported along with it, each once, even when
+# the caller also calls them directly.
+# CHECK-LABEL:   func.func @__torch__.caller(
+# CHECK:           constant @__torch__.double_plus_one : (!torch.int) -> !torch.int
+# CHECK:           constant @__torch__.double : (!torch.int) -> !torch.int
+# CHECK-DAG:     func.func @__torch__.double_plus_one(
+# CHECK-DAG:     func.func @__torch__.double(
+# CHECK-NOT:     func.func @__torch__.double
+@mb.import_function
+@torch.jit.script
+def caller(i: int) -> int:
+    return double_plus_one(i) + double(i)
+
+
+mb.module.operation.print()
+print()
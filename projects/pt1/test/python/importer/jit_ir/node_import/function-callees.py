@@ -0,0 +1,42 @@
+# -*- Python -*-
+# This file is licensed under a pytorch-style license
+# See LICENSE.pytorch for license information.
+
+import torch
+from torch_mlir.jit_ir_importer import ModuleBuilder
+
+# RUN: %PYTHON %s | torch-mlir-opt | FileCheck %s
+
+mb = ModuleBuilder()
+
+
+@torch.jit.script
+def add_one(i: int) -> int:
+    return i + 1
+
+
+# The callee is imported along with its first caller, once.
+# CHECK-LABEL:   func.func @__torch__.calls_add_one_twice(
+# CHECK-SAME:                                            %[[ARG:.*]]: !torch.int) -> !torch.int {
+# CHECK:           constant @__torch__.add_one : (!torch.int) -> !torch.int
+# CHECK:           constant @__torch__.add_one : (!torch.int) -> !torch.int
+# CHECK-LABEL:   func.func @__torch__.add_one(
+# CHECK-NOT:     func.func @__torch__.add_one(
+# CHECK-LABEL:   func.func @__torch__.also_calls_add_one(
+# CHECK-NOT:     func.func @__torch__.add_one(
+@mb.import_function
+@torch.jit.script
+def calls_add_one_twice(i: int) -> int:
+    return add_one(add_one(i))
+
+
+@mb.import_function
+@torch.jit.script
+def also_calls_add_one(i: int) -> int:
+    return add_one(i)
+
+
+mb.import_function(add_one)
+
+mb.module.operation.print()
+print()
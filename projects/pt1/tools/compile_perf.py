@@ -0,0 +1,278 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+"""Times the Torch lowering pipelines of torch-mlir-opt on a model corpus.
+
+Each model of the corpus is imported with the FX importer, without any
+lowering, and written as bytecode to the corpus directory. Importing takes
+a while, so those modules are kept and reused by later runs. Then
+torch-mlir-opt lowers each module to each backend contract with
+`-mlir-timing`, and this script reports:
+
+- the total wall time;
+- the wall time of each pass, e.g. `DecomposeComplexOps` and
+  `ScalarizeShapes`;
+- the peak resident memory of the process.
+
+Modules imported in other ways, e.g. from the ONNX model zoo with
+`torch-mlir-import-onnx`, can be added to the corpus directory as
+`<name>.mlir` or `<name>.mlirbc` files in the torch dialect. Those from ONNX
+then need `--onnx`, so that they are converted to the torch backend contract
+first.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+# The pipelines that lower the module that the FX importer produces to the
+# torch backend contract, and the ones that lower it to each backend
+# contract from there.
+TORCH_BACKEND_PIPELINE = "torchdynamo-export-to-torch-backend-pipeline"
+ONNX_TO_TORCH_BACKEND_PIPELINE = "torch-onnx-to-torch-backend-pipeline"
+BACKEND_PIPELINES = {
+    "linalg": "torch-backend-to-linalg-on-tensors-backend-pipeline",
+    "tosa": "torch-backend-to-tosa-backend-pipeline",
+    "stablehlo": "torch-backend-to-stablehlo-backend-pipeline",
+}
+
+# A line of the `-mlir-timing-display=list` report, such as
+# `    0.0123 ( 10.0%)    0.0041 ( 30.5%)  Canonicalizer`, where the last time
+# is the wall time.
+_TIMING_LINE = re.compile(r"^\s*(?:\d+\.\d+\s+\(\s*[\d.]+%\)\s+)+(\S.*)$")
+_WALL_TIME = re.compile(r"(\d+\.\d+)\s+\(\s*[\d.]+%\)")
+
+
+def _get_models():
+    """The models of the corpus, as `name -> (module, example inputs)`."""
+    import torch
+    import torch.nn.functional as F
+
+    class BertLayer(torch.nn.Module):
+        def __init__(self, hidden=768, heads=12, intermediate=3072):
+            super().__init__()
+            self.heads = heads
+            self.qkv = torch.nn.Linear(hidden, 3 * hidden)
+            self.out = torch.nn.Linear(hidden, hidden)
+            self.norm1 = torch.nn.LayerNorm(hidden)
+            self.up = torch.nn.Linear(hidden, intermediate)
+            self.down = torch.nn.Linear(intermediate, hidden)
+            self.norm2 = torch.nn.LayerNorm(hidden)
+
+        def forward(self, x):
+            b, s, h = x.shape
+            q, k, v = self.qkv(x).chunk(3, dim=-1)
+            q, k, v = (
+                t.reshape(b, s, self.heads, h // self.heads).transpose(1, 2)
+                for t in (q, k, v)
+            )
+            scores = q @ k.transpose(-1, -2) / (h // self.heads) ** 0.5
+            attn = (scores.softmax(dim=-1) @ v).transpose(1, 2).reshape(b, s, h)
+            x = self.norm1(x + self.out(attn))
+            return self.norm2(x + self.down(F.gelu(self.up(x))))
+
+    class Bert(torch.nn.Module):
+        def __init__(self, layers=4):
+            super().__init__()
+            self.layers = torch.nn.Sequential(*[BertLayer() for _ in range(layers)])
+
+        def forward(self, x):
+            return self.layers(x)
+
+    class LlamaBlock(torch.nn.Module):
+        def __init__(self, dim=1024, heads=16, hidden=2816, seq=128):
+            super().__init__()
+            self.heads = heads
+            self.wqkv = torch.nn.Linear(dim, 3 * dim, bias=False)
+            self.wo = torch.nn.Linear(dim, dim, bias=False)
+            self.w1 = torch.nn.Linear(dim, hidden, bias=False)
+            self.w2 = torch.nn.Linear(hidden, dim, bias=False)
+            self.w3 = torch.nn.Linear(dim, hidden, bias=False)
+            self.norm1 = torch.nn.Parameter(torch.ones(dim))
+            self.norm2 = torch.nn.Parameter(torch.ones(dim))
+            head_dim = dim // heads
+            freqs = 1.0 / (10000 ** (torch.arange(0, head_dim, 2) / head_dim))
+            angles = torch.outer(torch.arange(seq), freqs)
+            self.register_buffer("cos", angles.cos())
+            self.register_buffer("sin", angles.sin())
+            self.register_buffer("mask", torch.full((seq, seq), -1e9).triu(1))
+
+        def rms_norm(self, x, weight):
+            return x * torch.rsqrt(x.pow(2).mean(-1, keepdim=True) + 1e-6) * weight
+
+        def rotate(self, x):
+            x1, x2 = x[..., 0::2], x[..., 1::2]
+            return torch.cat(
+                [x1 * self.cos - x2 * self.sin, x1 * self.sin + x2 * self.cos],
+                dim=-1,
+            )
+
+        def forward(self, x):
+            b, s, d = x.shape
+            q, k, v = self.wqkv(self.rms_norm(x, self.norm1)).chunk(3, dim=-1)
+            q, k, v = (
+                t.reshape(b, s, self.heads, d // self.heads).transpose(1, 2)
+                for t in (q, k, v)
+            )
+            q, k = self.rotate(q), self.rotate(k)
+            scores = q @ k.transpose(-1, -2) / (d // self.heads) ** 0.5
+            attn = ((scores + self.mask).softmax(dim=-1) @ v).transpose(1, 2)
+            x = x + self.wo(attn.reshape(b, s, d))
+            h = self.rms_norm(x, self.norm2)
+            return x + self.w2(F.silu(self.w1(h)) * self.w3(h))
+
+    models = {
+        "bert_encoder": (Bert(), (torch.randn(1, 128, 768),)),
+        "llama_block": (LlamaBlock(), (torch.randn(1, 128, 1024),)),
+    }
+    try:
+        import torchvision
+
+        models["resnet18"] = (
+            torchvision.models.resnet18(),
+            (torch.randn(1, 3, 224, 224),),
+        )
+    except ImportError:
+        print("torchvision is not installed, skipping resnet18", file=sys.stderr)
+    return models
+
+
+def _import_corpus(corpus_dir):
+    """Imports the models that are not yet in `corpus_dir`."""
+    from torch_mlir import fx
+
+    os.makedirs(corpus_dir, exist_ok=True)
+    for name, (model, inputs) in _get_models().items():
+        path = os.path.join(corpus_dir, name + ".mlirbc")
+        if os.path.exists(path):
+            continue
+        print(f"Importing {name}...", file=sys.stderr)
+        module = fx.export_and_import(model.eval(), *inputs, func_name=name)
+        with open(path, "wb") as f:
+            module.operation.write_bytecode(f)
+
+
+def _parse_timing(report):
+    """The wall time in seconds of each pass in a timing report, summed over
+    the instances of the pass, and the total wall time."""
+    pass_times = {}
+    total = 0.0
+    for line in report.splitlines():
+        match = _TIMING_LINE.match(line)
+        if not match:
+            continue
+        name = match.group(1).strip()
+        wall_time = float(_WALL_TIME.findall(line)[-1])
+        if name == "Total":
+            total = wall_time
+        else:
+            pass_times[name] = pass_times.get(name, 0.0) + wall_time
+    return total, pass_times
+
+
+def _time_pipeline(torch_mlir_opt, path, pipeline):
+    """Runs `pipeline` on the module at `path`, and returns its timing and
+    peak memory, or its error."""
+    with tempfile.TemporaryFile("w+") as stderr:
+        proc = subprocess.Popen(
+            [
+                torch_mlir_opt,
+                path,
+                f"--pass-pipeline=builtin.module({pipeline})",
+                "--mlir-timing",
+                "--mlir-timing-display=list",
+                "-o",
+                os.devnull,
+            ],
+            stderr=stderr,
+        )
+        _, status, rusage = os.wait4(proc.pid, 0)
+        stderr.seek(0)
+        report = stderr.read()
+    if status != 0:
+        return {"error": report}
+    total, pass_times = _parse_timing(report)
+    # `ru_maxrss` is in bytes on macOS and in kilobytes elsewhere.
+    peak_memory = rusage.ru_maxrss * (1 if sys.platform == "darwin" else 1024)
+    return {
+        "total_s": total,
+        "passes_s": pass_times,
+        "peak_memory_bytes": peak_memory,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument(
+        "--torch-mlir-opt", default="torch-mlir-opt", help="The tool to time."
+    )
+    parser.add_argument(
+        "--corpus-dir",
+        required=True,
+        help="The directory of the imported modules, which are added to it "
+        "if missing.",
+    )
+    parser.add_argument(
+        "--backends",
+        default=",".join(BACKEND_PIPELINES),
+        help="A comma-separated list of the backend contracts to lower to.",
+    )
+    parser.add_argument(
+        "--onnx",
+        default=False,
+        action="store_true",
+        help="Whether the modules in the corpus directory that are not imported "
+        "by this script are in the ONNX form of the torch dialect.",
+    )
+    parser.add_argument(
+        "--num-passes",
+        default=10,
+        type=int,
+        help="The number of the slowest passes that are printed per run.",
+    )
+    parser.add_argument(
+        "--output", default="", help="A file to write the results to as JSON."
+    )
+    args = parser.parse_args()
+
+    _import_corpus(args.corpus_dir)
+    imported = set(_get_models())
+
+    results = {}
+    for file_name in sorted(os.listdir(args.corpus_dir)):
+        name, ext = os.path.splitext(file_name)
+        if ext not in (".mlir", ".mlirbc"):
+            continue
+        path = os.path.join(args.corpus_dir, file_name)
+        frontend = TORCH_BACKEND_PIPELINE
+        if args.onnx and name not in imported:
+            frontend = ONNX_TO_TORCH_BACKEND_PIPELINE
+        for backend in args.backends.split(","):
+            pipeline = f"{frontend},{BACKEND_PIPELINES[backend]}"
+            result = _time_pipeline(args.torch_mlir_opt, path, pipeline)
+            results.setdefault(name, {})[backend] = result
+            if "error" in result:
+                print(f"{name} -> {backend}: error\n{result['error']}")
+                continue
+            print(
+                f"{name} -> {backend}: {result['total_s']:.3f}s, "
+                f"peak memory {result['peak_memory_bytes'] / 2**20:.1f}MiB"
+            )
+            slowest = sorted(
+                result["passes_s"].items(), key=lambda item: item[1], reverse=True
+            )
+            for pass_name, seconds in slowest[: args.num_passes]:
+                print(f"    {seconds:8.3f}s  {pass_name}")
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+
+
+if __name__ == "__main__":
+    main()
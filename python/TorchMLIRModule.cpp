@@ -8,13 +8,71 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
+#include "mlir-c/BuiltinAttributes.h"
 #include "mlir/Bindings/Python/NanobindAdaptors.h"
+#include "torch-mlir-c/Compile.h"
 #include "torch-mlir-c/Dialects.h"
 #include "torch-mlir-c/Registration.h"
+#include "torch-mlir-c/TorchOps.h"
 
 namespace nb = nanobind;
 
+namespace {
+// Owns a `TorchMlirCompilerPool` for Python.
+class PyCompilerPool {
+public:
+  explicit PyCompilerPool(intptr_t numThreads)
+      : pool(torchMlirCompilerPoolCreate(numThreads)) {}
+  ~PyCompilerPool() { torchMlirCompilerPoolDestroy(pool); }
+  PyCompilerPool(const PyCompilerPool &) = delete;
+  PyCompilerPool &operator=(const PyCompilerPool &) = delete;
+
+  nb::list compile(nb::list modules, const std::string &pipeline) {
+    // The bytes objects are kept alive by `modules`, so their data can be
+    // read without the GIL.
+    std::vector<MlirStringRef> sources;
+    for (nb::handle module : modules) {
+      nb::bytes data = nb::cast<nb::bytes>(module);
+      sources.push_back(mlirStringRefCreate(data.c_str(), data.size()));
+    }
+    struct Results {
+      std::vector<std::string> outputs;
+      std::string errors;
+    } results;
+    MlirLogicalResult result;
+    {
+      nb::gil_scoped_release release;
+      result = torchMlirCompileBatch(
+          pool, mlirStringRefCreate(pipeline.data(), pipeline.size()),
+          sources.size(), sources.data(),
+          [](intptr_t index, MlirLogicalResult result, MlirStringRef output,
+             void *userData) {
+            auto *results = static_cast<Results *>(userData);
+            std::string text(output.data, output.length);
+            if (mlirLogicalResultIsFailure(result))
+              results->errors +=
+                  "module " + std::to_string(index) + ":\n" + text;
+            results->outputs.push_back(std::move(text));
+          },
+          &results);
+    }
+    if (mlirLogicalResultIsFailure(result))
+      throw std::runtime_error("compilation failed:\n" + results.errors);
+    nb::list bytecode;
+    for (const std::string &output : results.outputs)
+      bytecode.append(nb::bytes(output.data(), output.size()));
+    return bytecode;
+  }
+
+private:
+  TorchMlirCompilerPool pool;
+};
+} // namespace
+
 NB_MODULE(_torchMlir, m) {
   torchMlirRegisterAllPasses();
 
@@ -31,6 +89,79 @@ NB_MODULE(_torchMlir, m) {
       },
       nb::arg("context"), nb::arg("load") = true);
 
+  m.def(
+      "append_operations",
+      [](MlirBlock block, nb::list values, nb::list operations) {
+        // Convert the whole table up front: the specs hold pointers into
+        // these, so they must not be reallocated once the specs are built.
+        size_t numOperations = nb::len(operations);
+        std::vector<MlirValue> valueTable;
+        for (nb::handle value : values)
+          valueTable.push_back(nb::cast<MlirValue>(value));
+        std::vector<std::string> names(numOperations);
+        std::vector<std::vector<intptr_t>> operandIndices(numOperations);
+        std::vector<std::vector<MlirType>> resultTypes(numOperations);
+        std::vector<std::vector<MlirNamedAttribute>> attributes(numOperations);
+        std::vector<TorchMlirOperationSpec> specs(numOperations);
+        size_t numResults = 0;
+        for (size_t i = 0; i < numOperations; ++i) {
+          nb::tuple operation = nb::cast<nb::tuple>(operations[i]);
+          if (nb::len(operation) != 5)
+            throw nb::value_error("expected (name, operand_indices, "
+                                  "result_types, attributes, location)");
+          names[i] = nb::cast<std::string>(operation[0]);
+          for (nb::handle index : nb::cast<nb::list>(operation[1]))
+            operandIndices[i].push_back(nb::cast<intptr_t>(index));
+          for (nb::handle type : nb::cast<nb::list>(operation[2]))
+            resultTypes[i].push_back(nb::cast<MlirType>(type));
+          if (!operation[3].is_none()) {
+            MlirAttribute dict = nb::cast<MlirAttribute>(operation[3]);
+            if (!mlirAttributeIsADictionary(dict))
+              throw nb::value_error("expected a DictAttr of attributes");
+            intptr_t numAttributes = mlirDictionaryAttrGetNumElements(dict);
+            for (intptr_t j = 0; j < numAttributes; ++j)
+              attributes[i].push_back(mlirDictionaryAttrGetElement(dict, j));
+          }
+          numResults += resultTypes[i].size();
+          specs[i] = {mlirStringRefCreate(names[i].data(), names[i].size()),
+                      nb::cast<MlirLocation>(operation[4]),
+                      static_cast<intptr_t>(operandIndices[i].size()),
+                      operandIndices[i].data(),
+                      static_cast<intptr_t>(resultTypes[i].size()),
+                      resultTypes[i].data(),
+                      static_cast<intptr_t>(attributes[i].size()),
+                      attributes[i].data()};
+        }
+
+        std::vector<MlirValue> results(numResults);
+        if (mlirLogicalResultIsFailure(torchMlirBlockAppendOperations(
+                block, valueTable.size(), valueTable.data(), specs.size(),
+                specs.data(), results.data())))
+          throw nb::value_error("could not build operations");
+        nb::list pyResults;
+        for (MlirValue result : results)
+          pyResults.append(nb::cast(result));
+        return pyResults;
+      },
+      nb::arg("block"), nb::arg("values"), nb::arg("operations"),
+      "Appends operations described by (name, operand_indices, result_types, "
+      "attributes, location) tuples to `block` in a single call. Operand "
+      "indices refer to `values` followed by the results of the preceding "
+      "operations. Returns the results of all operations in order.");
+
+  nb::class_<PyCompilerPool>(m, "CompilerPool")
+      .def(nb::init<intptr_t>(), nb::arg("num_threads") = 0,
+           "Creates a pool of `num_threads` threads, one per hardware thread "
+           "if 0, each with a context in which the torch-mlir dialects are "
+           "loaded.")
+      .def("compile", &PyCompilerPool::compile, nb::arg("modules"),
+           nb::arg("pipeline"),
+           "Runs the textual `pipeline` on each of `modules`, given as MLIR "
+           "bytecode or text in bytes objects, concurrently on the threads "
+           "of the pool and without the GIL. Returns the bytecode of the "
+           "compiled modules in order, or raises a RuntimeError with the "
+           "diagnostics of the modules that failed.");
+
   m.def("get_int64_max", []() { return INT64_MAX; });
 
   m.def("get_int64_min", []() { return INT64_MIN; });
@@ -2,8 +2,12 @@
 # See https://llvm.org/LICENSE.txt for license information.
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 # Also available under a BSD-style license. See LICENSE.
+from collections import Counter, OrderedDict
 from enum import Enum
-from io import StringIO
+from io import BytesIO, StringIO
+import hashlib
+import importlib.metadata
+import json
 import os
 import sys
 import tempfile
@@ -12,7 +16,8 @@ from dataclasses import dataclass, field
 
 import torch
 from .passmanager import PassManager
-from .ir import StringAttr
+from .ir import Module, StringAttr
+from ._mlir_libs._torchMlir import CompilerPool
 
 
 class TensorPlaceholder:
@@ -84,18 +89,155 @@ class BackendLoweringOptions:
     """Whether to support non-finite floating point values (inf, nan)."""
     allow_non_finites: bool = True
 
+    """Whether the StableHLO lowering refines shapes. Disable it to get a
+    module for `StablehloShapeSpecializer`."""
+    stablehlo_refine_shapes: bool = True
+
+    """Whether the StableHLO lowering keeps the ops of
+    `STABLEHLO_COMPOSITE_OPS` that reach it as `stablehlo.composite`s."""
+    stablehlo_composites: bool = False
+
+    """Whether the locations of the torch ops are named after the ops before
+    the Linalg lowering, so that the lowered ops can be traced back to them,
+    e.g. by the profile of the RefBackend."""
+    name_locations: bool = False
+
+    """When positive, the constant weights of matmuls are packed into tiles of
+    this size at compile time by the Linalg lowering. The RefBackend lowers
+    the packing of the other operands with `refback-lower-linalg-pack`."""
+    pack_weights_block_size: int = 0
+
+    """Whether the Linalg lowering narrows index tensors and index arithmetic
+    that are proven to fit in i32 to i32."""
+    narrow_indices: bool = False
+
+
+def write_bytecode(module, path: str):
+    """Writes `module`, a module or a detached operation, to the file `path`
+    as MLIR bytecode, which is streamed to the file rather than built up in
+    memory first.
+
+    The data is written to a file of this process first, so that processes
+    that read `path` never see a partially written module.
+    """
+    operation = getattr(module, "operation", module)
+    tmp_path = f"{path}.{os.getpid()}.tmp"
+    with open(tmp_path, "wb") as f:
+        operation.write_bytecode(f)
+    os.replace(tmp_path, path)
+
+
+def _get_compiler_version() -> str:
+    """The version of torch-mlir, or for a build that is not installed as a
+    package, the times at which its native libraries were built."""
+    try:
+        return importlib.metadata.version("torch-mlir")
+    except importlib.metadata.PackageNotFoundError:
+        libs_dir = os.path.join(os.path.dirname(__file__), "_mlir_libs")
+        return ",".join(
+            f"{name}:{os.stat(os.path.join(libs_dir, name)).st_mtime_ns}"
+            for name in sorted(os.listdir(libs_dir))
+            if name.endswith((".so", ".pyd", ".dylib"))
+        )
+
+
+class CompilationCache:
+    """A directory of lowered modules, written as MLIR bytecode under a hash
+    of everything that they are lowered from, and of the torch-mlir version.
+
+    Entries are never evicted: the directory can be cleared at any time.
+    """
+
+    def __init__(self, cache_dir: str):
+        self.cache_dir = cache_dir
+        os.makedirs(cache_dir, exist_ok=True)
+
+    def get_path(self, *key_parts: Union[str, bytes]) -> str:
+        key = hashlib.sha256(_get_compiler_version().encode())
+        for part in key_parts:
+            key.update(part.encode() if isinstance(part, str) else part)
+            # Separate the parts, so that moving bytes between them changes
+            # the key.
+            key.update(b"\0")
+        return os.path.join(self.cache_dir, key.hexdigest() + ".mlirbc")
+
+    def load(self, path: str, context) -> Optional[Module]:
+        if not os.path.exists(path):
+            return None
+        with open(path, "rb") as f:
+            return Module.parse(f.read(), context=context)
+
+    def store(self, path: str, module: Module):
+        write_bytecode(module, path)
+
+
+class StablehloShapeSpecializer:
+    """Specializes a StableHLO module with dynamic shapes for concrete
+    argument types, e.g. once per batch size that a server sees.
+
+    `module` is lowered with `stablehlo_refine_shapes=False` (see
+    `BackendLoweringOptions`), so that only the refinement stages
+    (`torch-stablehlo-refine-shapes-pipeline`) run per variant, on a clone of
+    it. The arguments of the function `main`, or of the only function of the
+    module, are refined. `module` is not modified.
+
+    Variants are kept under their argument types, so that asking for the same
+    types again returns the same module. With `max_variants`, the least
+    recently used variant is dropped once there are more.
+    """
+
+    def __init__(
+        self,
+        module: Module,
+        enable_i32_index: bool = False,
+        max_variants: Optional[int] = None,
+    ):
+        self.module = module
+        self.enable_i32_index = enable_i32_index
+        self.max_variants = max_variants
+        self._variants = OrderedDict()
+
+    def specialize(self, arg_types: List[str]):
+        """Returns a `builtin.module` operation in which the arguments of the
+        refined function have the types `arg_types`, e.g.
+        `["tensor<8x128xf32>"]`, and every shape that follows from them is
+        static."""
+        key = tuple(arg_types)
+        variant = self._variants.get(key)
+        if variant is not None:
+            self._variants.move_to_end(key)
+            return variant
+        variant = self.module.operation.clone()
+        types = ",".join(arg_types)
+        run_pipeline_with_repro_report(
+            variant,
+            f"builtin.module(stablehlo-refine-arguments{{types='{types}'}}, "
+            f"torch-stablehlo-refine-shapes-pipeline{{"
+            f"enable-i32-index={self.enable_i32_index}}})",
+            f"Refining StableHLO Backend IR for {types}",
+        )
+        self._variants[key] = variant
+        if self.max_variants is not None and len(self._variants) > self.max_variants:
+            self._variants.popitem(last=False)
+        return variant
+
 
 def run_pipeline_with_repro_report(
     module, pipeline: str, description: str, enable_ir_printing: bool = False
 ):
-    """Runs `pipeline` on `module`, with a nice repro report if it fails."""
+    """Runs `pipeline` on `module`, with a nice repro report if it fails.
+
+    The module is cloned before the pipeline runs, for the report. The clone
+    shares the attributes and resource blobs of the module, which hold its
+    weights, so it is cheap, and it is only written out, as bytecode, if the
+    pipeline fails.
+    """
     module_name = get_module_name_for_debug_dump(module)
     original_stderr = sys.stderr
+    module_for_error_report = None
     try:
         sys.stderr = StringIO()
-        asm_for_error_report = module.operation.get_asm(
-            large_elements_limit=10, enable_debug_info=True
-        )
+        module_for_error_report = module.operation.clone()
         # Lower module in place to make it ready for compiler backends.
         with module.context as ctx:
             # TODO(#3506): Passes can emit errors but not signal failure,
@@ -105,6 +247,10 @@ def run_pipeline_with_repro_report(
             if enable_ir_printing:
                 ctx.enable_multithreading(False)
                 pm.enable_ir_printing()
+            else:
+                # Function passes run on the functions of the module in
+                # parallel.
+                ctx.enable_multithreading(True)
             pm.run(module.operation)
     except Exception as e:
         # TODO: More robust.
@@ -115,9 +261,9 @@ def run_pipeline_with_repro_report(
         #   up /tmp)
         # - if we do have have colliding filenames, writes should at least
         #   avoid being racy.
-        filename = os.path.join(tempfile.gettempdir(), module_name + ".mlir")
-        with open(filename, "w") as f:
-            f.write(asm_for_error_report)
+        filename = os.path.join(tempfile.gettempdir(), module_name + ".mlirbc")
+        if module_for_error_report is not None:
+            write_bytecode(module_for_error_report, filename)
         debug_options = "-mlir-print-ir-after-all -mlir-disable-threading"
         # Put something descriptive here even if description is empty.
         description = description or f"{module_name} compile"
@@ -136,6 +282,220 @@ def run_pipeline_with_repro_report(
         raise TorchMlirCompilerError(trimmed_message) from None
     finally:
         sys.stderr = original_stderr
+        if module_for_error_report is not None:
+            module_for_error_report.erase()
+
+
+def _body(module):
+    return module.operation.regions[0].blocks[0]
+
+
+def _symbol_name(operation) -> Optional[str]:
+    if "sym_name" not in operation.attributes:
+        return None
+    return StringAttr(operation.attributes["sym_name"]).value
+
+
+def _is_public_function(operation) -> bool:
+    return (
+        operation.name == "func.func"
+        and "sym_visibility" not in operation.attributes
+    )
+
+
+def _hash_operation(operation) -> bytes:
+    """A hash of the bytecode of `operation`, which includes the resource
+    blobs, e.g. the weights, that it references."""
+    f = BytesIO()
+    operation.write_bytecode(f)
+    return hashlib.sha256(f.getvalue()).digest()
+
+
+def _hash_unit(unit, hash_symbol) -> bytes:
+    """A hash of `unit`, a module extracted from another one, in which the
+    ops with a symbol are hashed by `hash_symbol`."""
+    key = hashlib.sha256()
+    for attr in unit.operation.attributes:
+        key.update(str(attr).encode())
+    for op in _body(unit).operations:
+        name = _symbol_name(op)
+        key.update(_hash_operation(op) if name is None else hash_symbol(name))
+    return key.digest()
+
+
+def run_pipeline_per_function(
+    module,
+    pipeline: str,
+    description: str,
+    cache: CompilationCache,
+    enable_ir_printing: bool = False,
+):
+    """Runs `pipeline` on `module` like `run_pipeline_with_repro_report`, but
+    separately for each public function, together with the private functions
+    and globals that it references, and reuses the lowering that `cache`
+    holds for a function whose content is unchanged.
+
+    The content of a public function is hashed with the bodies of its callees
+    and of the globals it references, so editing a function only runs the
+    pipeline again for it and the public functions that call it. The lowered
+    functions are merged back into `module`. If they define a private symbol
+    differently, e.g. because the pipeline specialized a shared callee for
+    each caller, the pipeline is run on the whole module instead.
+
+    Each op of `module` is serialized once, whatever the number of units
+    that reference it, and only the lowered ops that several units define
+    are compared, so the weights are not read again for every unit.
+    """
+    symbols = {}
+    names = []
+    for op in _body(module).operations:
+        name = _symbol_name(op)
+        if name is not None:
+            symbols[name] = op
+        if _is_public_function(op):
+            names.append(name)
+    if not names:
+        run_pipeline_with_repro_report(
+            module, pipeline, description, enable_ir_printing=enable_ir_printing
+        )
+        return
+    symbol_hashes = {}
+
+    def hash_symbol(name):
+        if name not in symbol_hashes:
+            symbol_hashes[name] = _hash_operation(symbols[name])
+        return symbol_hashes[name]
+
+    units = []
+    for name in names:
+        unit = module.operation.clone()
+        for op in list(_body(unit).operations):
+            if _is_public_function(op) and _symbol_name(op) != name:
+                op.erase()
+        run_pipeline_with_repro_report(
+            unit,
+            "builtin.module(symbol-dce)",
+            f"Extracting function {name}",
+        )
+        path = cache.get_path(_hash_unit(unit, hash_symbol), pipeline)
+        lowered = cache.load(path, module.context)
+        if lowered is None:
+            run_pipeline_with_repro_report(
+                unit,
+                pipeline,
+                f"{description} (function {name})",
+                enable_ir_printing=enable_ir_printing,
+            )
+            cache.store(path, unit)
+            units.append(unit)
+        else:
+            unit.erase()
+            units.append(lowered)
+
+    definitions = Counter(
+        _symbol_name(op) for unit in units for op in _body(unit).operations
+    )
+    merged = {}
+    for unit in units:
+        for op in _body(unit).operations:
+            name = _symbol_name(op)
+            if name is None:
+                merged = None
+                break
+            # A symbol that only one unit defines cannot conflict.
+            op_hash = _hash_operation(op) if definitions[name] > 1 else None
+            if merged.setdefault(name, (op, op_hash))[1] != op_hash:
+                merged = None
+                break
+        if merged is None:
+            break
+    if merged is not None:
+        for op in list(_body(module).operations):
+            op.erase()
+        for op, _ in merged.values():
+            _body(module).append(op)
+    else:
+        run_pipeline_with_repro_report(
+            module, pipeline, description, enable_ir_printing=enable_ir_printing
+        )
+    for unit in units:
+        if not isinstance(unit, Module):
+            unit.erase()
+
+
+_compiler_pool = None
+
+
+def compile_modules_concurrently(modules, pipeline: str) -> List[bytes]:
+    """Runs the textual `pipeline`, e.g.
+    `builtin.module(torch-backend-to-linalg-on-tensors-backend-pipeline)`, on
+    each of `modules`, which are modules or MLIR bytecode or text, and
+    returns their bytecode in order.
+
+    The modules are compiled concurrently, without the GIL, in a
+    `CompilerPool` that the process shares. Its contexts are created once,
+    and keep the passes of the pipelines that they ran initialized, so that
+    later calls do not pay for either again.
+    """
+    global _compiler_pool
+    if _compiler_pool is None:
+        _compiler_pool = CompilerPool()
+    sources = []
+    for module in modules:
+        if isinstance(module, (bytes, str)):
+            sources.append(module.encode() if isinstance(module, str) else module)
+            continue
+        f = BytesIO()
+        module.operation.write_bytecode(f)
+        sources.append(f.getvalue())
+    try:
+        return _compiler_pool.compile(sources, pipeline)
+    except RuntimeError as e:
+        raise TorchMlirCompilerError(str(e)) from None
+
+
+def get_op_profile(module, backend_legal_ops: Optional[List[str]] = None) -> dict:
+    """Returns the op mix of the torch dialect `module` (see
+    `torch-op-profile`): the count, estimated flops and tensor bytes of each
+    op name and class of ops, and whether the lowering to the backend
+    contract with `backend_legal_ops` decomposes each op or leaves it to the
+    backend. The module is not changed.
+    """
+    options = ""
+    if backend_legal_ops:
+        options = " backend-legal-ops=" + ",".join(backend_legal_ops)
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        path = os.path.join(tmp_dir, "profile.json")
+        run_pipeline_with_repro_report(
+            module,
+            f"builtin.module(torch-op-profile{{output-file={path}{options}}})",
+            "Profiling the ops of the module",
+        )
+        with open(path) as f:
+            return json.load(f)
+
+
+def get_peak_memory(module, bufferized: bool = False) -> dict:
+    """Returns the peak live bytes of each function of `module`, broken down
+    into weights, activations and temporaries, with the op at the peak and
+    the largest buffers live there (see `torch-estimate-peak-memory`). With
+    `bufferized`, `module` is a bufferized program, e.g. after
+    `buffer-deallocation-pipeline` in the linalg pipeline, and its buffers are
+    measured instead of its tensors (see `refback-estimate-peak-memory`). The
+    module is not changed.
+    """
+    pass_name = (
+        "refback-estimate-peak-memory" if bufferized else "torch-estimate-peak-memory"
+    )
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        path = os.path.join(tmp_dir, "peak_memory.json")
+        run_pipeline_with_repro_report(
+            module,
+            f"builtin.module({pass_name}{{output-file={path}}})",
+            "Estimating the peak memory of the module",
+        )
+        with open(path) as f:
+            return json.load(f)
 
 
 class OutputType(Enum):
@@ -188,11 +548,21 @@ class OutputType(Enum):
         return OutputType[spec]
 
 
-def lower_mlir_module(verbose, output_type, module, backend_options=None):
+def lower_mlir_module(verbose, output_type, module, backend_options=None, cache=None):
+    """Lowers the Torch Backend IR `module` in place to `output_type`. With a
+    `CompilationCache` `cache`, the functions of the module are lowered
+    separately, and unchanged ones are read from it (see
+    `run_pipeline_per_function`)."""
 
     if backend_options is None:
         backend_options = BackendLoweringOptions()
 
+    def run_pipeline(pipeline: str, description: str):
+        if cache is None:
+            run_pipeline_with_repro_report(module, pipeline, description)
+        else:
+            run_pipeline_per_function(module, pipeline, description, cache)
+
     if verbose:
         print("\n====================")
         print("Torch Backend IR")
@@ -202,8 +572,7 @@ def lower_mlir_module(verbose, output_type, module, backend_options=None):
         return module
 
     if output_type == OutputType.TOSA:
-        run_pipeline_with_repro_report(
-            module,
+        run_pipeline(
             "builtin.module(torch-backend-to-tosa-backend-pipeline)",
             "Lowering Torch Backend IR -> TOSA Backend IR",
         )
@@ -214,9 +583,14 @@ def lower_mlir_module(verbose, output_type, module, backend_options=None):
         return module
 
     if output_type == OutputType.LINALG_ON_TENSORS:
-        pipeline = f"builtin.module(torch-backend-to-linalg-on-tensors-backend-pipeline{{allow-non-finites={backend_options.allow_non_finites}}})"
-        run_pipeline_with_repro_report(
-            module,
+        pipeline = (
+            f"builtin.module(torch-backend-to-linalg-on-tensors-backend-pipeline{{"
+            f"allow-non-finites={backend_options.allow_non_finites} "
+            f"name-locations={backend_options.name_locations} "
+            f"pack-weights-block-size={backend_options.pack_weights_block_size} "
+            f"narrow-indices={backend_options.narrow_indices}}})"
+        )
+        run_pipeline(
             pipeline,
             "Lowering Torch Backend IR -> Linalg-on-Tensors Backend IR",
         )
@@ -227,9 +601,13 @@ def lower_mlir_module(verbose, output_type, module, backend_options=None):
         return module
 
     elif output_type == OutputType.STABLEHLO:
-        pipeline = f"builtin.module(torch-backend-to-stablehlo-backend-pipeline{{allow-non-finites={backend_options.allow_non_finites}}})"
-        run_pipeline_with_repro_report(
-            module,
+        pipeline = (
+            f"builtin.module(torch-backend-to-stablehlo-backend-pipeline{{"
+            f"allow-non-finites={backend_options.allow_non_finites} "
+            f"refine-shapes={backend_options.stablehlo_refine_shapes} "
+            f"composites={backend_options.stablehlo_composites}}})"
+        )
+        run_pipeline(
             pipeline,
             "Lowering Torch Backend IR -> StableHLO Backend IR",
         )
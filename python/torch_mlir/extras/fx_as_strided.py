@@ -7,9 +7,15 @@ from typing import Any
 
 import torch
 import torch.fx as fx
+from torch.fx.passes.shape_prop import _extract_tensor_metadata
 
 _AS_STRIDED = torch.ops.aten.as_strided.default
 _INDEX = torch.ops.aten.index.Tensor
+_VIEW = torch.ops.aten.view.default
+_SLICE = torch.ops.aten.slice.Tensor
+_UNFOLD = torch.ops.aten.unfold.default
+_PERMUTE = torch.ops.aten.permute.default
+_EXPAND = torch.ops.aten.expand.default
 _LIST = (list, tuple, fx.immutable_collections.immutable_list)
 _MISSING = object()
 
@@ -19,9 +25,13 @@ def rewrite_as_strided(g: fx.Graph) -> bool:
 
     Torch IR does not carry storage identity, physical strides, or storage
     offsets, so this pass runs while FakeTensor metadata is still available. It
-    replaces each supported ``as_strided`` read with ``aten.index.Tensor`` on a
-    base tensor that still has the needed storage layout. The rewrite preserves
-    result values for supported static cases; it does not preserve view aliasing.
+    replaces each supported ``as_strided`` read with view ops of a contiguous
+    base tensor when its strides allow it, e.g. for permutes and reshapes of
+    views, diagonals and sliding windows, and otherwise with
+    ``aten.index.Tensor`` on a base tensor that still has the needed storage
+    layout. The view ops lower to subviews of the base, while the index is a
+    gather of each element. The rewrite preserves result values for supported
+    static cases; it does not preserve view aliasing.
 
     The graph must have an owning ``GraphModule`` because generated index
     tensors are attached as synthetic buffers and read back through ``get_attr``
@@ -75,14 +85,13 @@ def _rewrite(g: fx.Graph, node: fx.Node) -> fx.Node:
 
     base = _base(source)
     base_value = _tensor(base, "base")
-    indices = _indices(
-        _ints(base_value.shape, "base.shape", meta=True),
-        _ints(base_value.stride(), "base.stride", meta=True),
-        _int(base_value.storage_offset(), "base.storage_offset"),
-        size,
-        stride,
-        offset,
-    )
+    base_shape = _ints(base_value.shape, "base.shape", meta=True)
+    base_stride = _ints(base_value.stride(), "base.stride", meta=True)
+    base_offset = _int(base_value.storage_offset(), "base.storage_offset")
+    steps = _view_steps(base_value, base_offset, size, stride, offset)
+    if steps is not None:
+        return _emit_view_steps(g, node, base, steps)
+    indices = _indices(base_shape, base_stride, base_offset, size, stride, offset)
     index_nodes = [_constant(g, node, i, v) for i, v in enumerate(indices)]
     with g.inserting_before(node):
         replacement = g.call_function(_INDEX, args=(base, index_nodes))
@@ -93,6 +102,130 @@ def _rewrite(g: fx.Graph, node: fx.Node) -> fx.Node:
     return replacement
 
 
+def _view_steps(
+    base_value: torch.Tensor,
+    base_offset: int,
+    size: tuple[int, ...],
+    stride: tuple[int, ...],
+    offset: int,
+) -> list[tuple[Any, tuple[Any, ...], torch.Tensor]] | None:
+    """Plan view ops of ``base_value`` that read the same storage elements as
+    ``as_strided(size, stride, offset)``, or return ``None``.
+
+    Each step is ``(target, args, value)``, where ``target`` applies to the
+    result of the previous step and ``args``, and ``value`` is its result. The
+    base must be contiguous, and the strides of the result dims of size > 1
+    must each divide the next larger one. The base is flattened and sliced
+    with the smallest stride, which leaves the smallest dim as the only one.
+    Then the dims are split off from it in the order of their strides: a dim
+    that does not overlap the next larger one with a view and a slice, and one
+    that does, i.e. a sliding window, with ``aten.unfold``. Diagonals are
+    slices with a step. The plan is run on the FakeTensor metadata, and only
+    accepted when every step is a valid view and the result has the requested
+    sizes, strides and storage offset.
+    """
+    relative_offset = offset - base_offset
+    if relative_offset < 0 or 0 in size or not base_value.is_contiguous():
+        return None
+    dims = sorted(
+        (d for d in range(len(size)) if size[d] > 1 and stride[d]),
+        key=lambda d: (stride[d], size[d]),
+    )
+    if any(stride[outer] % stride[inner] for inner, outer in zip(dims, dims[1:])):
+        return None
+
+    steps = []
+    value = base_value
+
+    def apply(target, *args):
+        nonlocal value
+        # A view of a view is a single view of the first one's operand.
+        if target is _VIEW and steps and steps[-1][0] is _VIEW:
+            steps.pop()
+            value = steps[-1][2] if steps else base_value
+        value = target(value, *args)
+        steps.append((target, args, value))
+
+    try:
+        if value.dim() != 1:
+            apply(_VIEW, [-1])
+        # Slice at least up to the end of the outermost dim, so that the
+        # dims that do not overlap can be split off with views.
+        step = stride[dims[0]] if dims else 1
+        extent = 1 + sum((size[d] - 1) * stride[d] for d in dims)
+        if dims:
+            extent = max(extent, size[dims[-1]] * stride[dims[-1]])
+        end = relative_offset + extent
+        if relative_offset or step != 1 or end < value.shape[0]:
+            apply(_SLICE, 0, relative_offset, end, step)
+
+        # Dim 0 of `value` holds the dims still to split off, and `order` is
+        # the result dims of the others.
+        order = []
+        for inner, outer in zip(dims, dims[1:]):
+            window = size[inner]
+            ratio = stride[outer] // stride[inner]
+            length = value.shape[0]
+            if length < window:
+                return None
+            count = (length - window) // ratio + 1
+            if window <= ratio and count * ratio <= length:
+                if count * ratio < length:
+                    apply(_SLICE, 0, 0, count * ratio, 1)
+                apply(_VIEW, [count, ratio, *value.shape[1:]])
+                if window < ratio:
+                    apply(_SLICE, 1, 0, window, 1)
+                order.insert(0, inner)
+            else:
+                apply(_UNFOLD, 0, window, ratio)
+                order.append(inner)
+        if dims:
+            outer = dims[-1]
+            if value.shape[0] < size[outer]:
+                return None
+            if value.shape[0] > size[outer]:
+                apply(_SLICE, 0, 0, size[outer], 1)
+            order.insert(0, outer)
+
+        permutation = [order.index(d) for d in sorted(dims)]
+        if permutation != sorted(permutation):
+            apply(_PERMUTE, permutation)
+        if len(dims) != len(size):
+            apply(_VIEW, [size[d] if d in dims else 1 for d in range(len(size))])
+        if any(size[d] > 1 and not stride[d] for d in range(len(size))):
+            apply(_EXPAND, list(size))
+        # The replacement must be a new node, even when the base itself has
+        # the requested layout.
+        if not steps:
+            apply(_VIEW, list(size))
+    except RuntimeError:
+        return None
+
+    if (
+        tuple(value.shape) != size
+        or value.storage_offset() != offset
+        or any(value.stride(d) != stride[d] for d in range(len(size)) if size[d] > 1)
+    ):
+        return None
+    return steps
+
+
+def _emit_view_steps(
+    g: fx.Graph,
+    node: fx.Node,
+    base: fx.Node,
+    steps: list[tuple[Any, tuple[Any, ...], torch.Tensor]],
+) -> fx.Node:
+    replacement = base
+    for target, args, value in steps:
+        with g.inserting_before(node):
+            replacement = g.call_function(target, args=(replacement, *args))
+        replacement.meta.update(node.meta)
+        replacement.meta["val"] = value
+        replacement.meta["tensor_meta"] = _extract_tensor_metadata(value)
+    return replacement
+
+
 def _constant(g: fx.Graph, node: fx.Node, index: int, tensor: torch.Tensor) -> fx.Node:
     # aten.index needs tensor index operands. Attach each generated tensor as a
     # synthetic GraphModule buffer and reference it with get_attr so the existing
@@ -1,6 +1,10 @@
+from typing import Optional, Union
+
 import torch
 from torch._decomp import get_decompositions
 
+from ..compiler_utils import OutputType
+
 # default decompositions pulled from SHARK / torch._decomp
 DEFAULT_DECOMPOSITIONS = [
     torch.ops.aten.embedding_dense_backward,
@@ -17,7 +21,6 @@ DEFAULT_DECOMPOSITIONS = [
     torch.ops.aten.addmm,
     # decompositions that aid us in handling nn.BatchNorm2d
     torch.ops.aten._native_batch_norm_legit_functional,
-    torch.ops.aten._native_batch_norm_legit_no_training,
     torch.ops.aten._native_batch_norm_legit,
     torch.ops.aten._native_batch_norm_legit.no_stats,
     torch.ops.aten.squeeze.dims,
@@ -55,6 +58,83 @@ if hasattr(torch.ops.aten, "_scaled_dot_product_flash_attention_for_cpu"):
 if hasattr(torch.ops.aten, "scaled_dot_product_attention"):
     DEFAULT_DECOMPOSITIONS.append(torch.ops.aten.scaled_dot_product_attention)
 
+# The composite ops that each backend lowers directly. Unless the caller
+# lists its own, they are passed as `backend-legal-ops` to the lowering to the
+# backend contract, so that `torch-decompose-complex-ops` keeps them, and they
+# are left out of the decompositions that run before import, so that they
+# reach the backend intact.
+BACKEND_LEGAL_OPS = {
+    OutputType.LINALG_ON_TENSORS: [
+        "aten.native_layer_norm",
+    ],
+    OutputType.TOSA: [
+        "aten.native_layer_norm",
+        "aten.masked_fill.Tensor",
+        "aten.masked_fill.Scalar",
+        "aten.upsample_bilinear2d.vec",
+    ],
+    OutputType.STABLEHLO: [
+        "aten.native_layer_norm",
+    ],
+}
+
+# The ops that the StableHLO lowering can keep as `stablehlo.composite`s, which
+# have to be backend legal to reach it.
+STABLEHLO_COMPOSITE_OPS = [
+    "aten.scaled_dot_product_attention",
+    "aten.layer_norm",
+    "aten.native_layer_norm",
+    "aten.rms_norm",
+    "aten.gelu",
+]
+
+
+def _native_batch_norm_legit_no_training(
+    input, weight, bias, running_mean, running_var, momentum, eps
+):
+    # Kept as one op rather than decomposed into elementwise ops, so that
+    # `torch-recompose-convolution-epilogues` can fold it into the convolution
+    # that it follows. torch-mlir decomposes the ones that it does not fold.
+    return torch.ops.aten.native_batch_norm.default(
+        input, weight, bias, running_mean, running_var, False, momentum, eps
+    )
 
-def get_decomposition_table():
-    return get_decompositions(DEFAULT_DECOMPOSITIONS)
+
+def get_backend_legal_ops(
+    output_type: Union[str, OutputType] = OutputType.RAW,
+    backend_legal_ops: Optional[list[str]] = None,
+) -> list[str]:
+    """The ops that are legal for the backend of `output_type`, which are
+    `backend_legal_ops` if given and the entry of `BACKEND_LEGAL_OPS`
+    otherwise."""
+    if backend_legal_ops is not None:
+        return list(backend_legal_ops)
+    return list(BACKEND_LEGAL_OPS.get(OutputType.get(output_type), []))
+
+
+def _get_op_name(op) -> str:
+    # The name of the op in the torch dialect, e.g. `aten.masked_fill.Tensor`,
+    # which has no `.default` suffix, as in `backend-legal-ops`.
+    if isinstance(op, torch._ops.OpOverload):
+        name = op.name()
+    else:
+        name = op._qualified_op_name
+    return name.replace("::", ".")
+
+
+def get_decomposition_table(
+    output_type: Union[str, OutputType] = OutputType.RAW,
+    backend_legal_ops: Optional[list[str]] = None,
+):
+    """The decompositions to run before importing a program that is lowered to
+    `output_type`, which are `DEFAULT_DECOMPOSITIONS` without the ops that
+    `get_backend_legal_ops` returns. Inference batch norms are rewritten to
+    `native_batch_norm`, which torch-mlir folds into convolutions."""
+    legal_ops = set(get_backend_legal_ops(output_type, backend_legal_ops))
+    table = get_decompositions(
+        [op for op in DEFAULT_DECOMPOSITIONS if _get_op_name(op) not in legal_ops]
+    )
+    batch_norm = torch.ops.aten._native_batch_norm_legit_no_training
+    if _get_op_name(batch_norm) not in legal_ops:
+        table[batch_norm.default] = _native_batch_norm_legit_no_training
+    return table
@@ -11,6 +11,7 @@ except ImportError:
     # python less than 3.10 doesn't have NoneType
     NoneType = type(None)
 
+import json
 import logging
 import operator
 import re
@@ -103,10 +104,13 @@ from ..ir import (
     AffineModExpr,
     AffineMulExpr,
     AffineSymbolExpr,
+    ArrayAttr,
     Attribute,
     Block,
     Context,
+    DictAttr,
     DenseElementsAttr,
+    DenseI64ArrayAttr,
     DenseResourceElementsAttr,
     FlatSymbolRefAttr,
     FloatAttr,
@@ -132,6 +136,7 @@ from ..ir import (
     StringAttr,
     SymbolTable,
     Type as IrType,
+    TypeAttr,
     UnitAttr,
     Value,
 )
@@ -461,6 +466,29 @@ def is_symbolic(obj: Any) -> bool:
     return isinstance(obj, (torch.SymInt, torch.SymFloat, torch.SymBool))
 
 
+def dtensor_sharding(val: Any) -> Optional[Tuple[List[int], List]]:
+    """Returns the mesh dim that each dim of a DTensor is sharded over (or -1
+    where it is replicated) and the device ids of its mesh, or None if `val`
+    is not a DTensor or its placements cannot be expressed that way (partial
+    placements, or a tensor dim sharded over several mesh dims)."""
+    placements = getattr(val, "placements", None)
+    device_mesh = getattr(val, "device_mesh", None)
+    if placements is None or device_mesh is None:
+        return None
+    rank = val.dim()
+    dims = [-1] * rank
+    for mesh_dim, placement in enumerate(placements):
+        if placement.is_replicate():
+            continue
+        if not placement.is_shard():
+            return None
+        dim = placement.dim % rank
+        if dims[dim] != -1:
+            return None
+        dims[dim] = mesh_dim
+    return dims, device_mesh.mesh.tolist()
+
+
 def is_builtin_function_or_method(obj: Any) -> bool:
     return isinstance(obj, (BuiltinMethodType, BuiltinFunctionType))
 
@@ -531,6 +559,91 @@ class FxImporterHooks:
         )
 
 
+class ExternalParameterHooks(FxImporterHooks):
+    """Imports parameters and buffers as references to external globals.
+
+    Each state_dict entry that the program reads becomes a private
+    `ml_program.global` with an `#ml_program.extern` value, named after its
+    state_dict key, and is read with `ml_program.global_load_const`. The tensor
+    data itself is never accessed, so import time only depends on the size of
+    the graph and the weights can be bound later by the runtime (e.g. to the
+    original `torch.nn.Parameter` storage).
+
+    If `safetensors_file` is given, globals whose key is in its header also
+    get a `torch.external_data = {file, offset, length}` attribute locating
+    their bytes in that file. Only the header is read.
+
+    Mutated buffers are not supported and fail in `store_produced_value`.
+    """
+
+    def __init__(self, safetensors_file: Optional[str] = None):
+        self._globals: Dict[str, str] = {}
+        self._safetensors_file = safetensors_file
+        self._safetensors_index: Dict[str, Tuple[int, int]] = {}
+        if safetensors_file is not None:
+            self._safetensors_index = _read_safetensors_index(safetensors_file)
+
+    def resolve_input(
+        self, gni: "GraphNodeImporter", value: Any, info: InputInfo
+    ) -> Optional[Value]:
+        if info.mutable_producer_node_name is not None:
+            return None
+        key = info.input_spec.target
+        symbol_name = self._globals.get(key)
+        if symbol_name is None:
+            symbol_name = self._create_global(gni, key, info.ir_type)
+            self._globals[key] = symbol_name
+        return Operation.create(
+            name="ml_program.global_load_const",
+            results=[info.ir_type],
+            attributes={"global": FlatSymbolRefAttr.get(symbol_name)},
+        ).result
+
+    def _create_global(
+        self, gni: "GraphNodeImporter", key: str, ir_type: IrType
+    ) -> str:
+        attributes = {
+            "sym_name": StringAttr.get(key),
+            "sym_visibility": StringAttr.get("private"),
+            "type": TypeAttr.get(ir_type),
+            "value": Attribute.parse(f"#ml_program.extern : {ir_type}"),
+        }
+        location = self._safetensors_index.get(key)
+        if location is not None:
+            offset, length = location
+            i64 = IntegerType.get_signless(64)
+            attributes["torch.external_data"] = DictAttr.get(
+                {
+                    "file": StringAttr.get(self._safetensors_file),
+                    "offset": IntegerAttr.get(i64, offset),
+                    "length": IntegerAttr.get(i64, length),
+                }
+            )
+        importer = gni.fx_importer
+        with Location.unknown(gni._c):
+            global_op = Operation.create(
+                name="ml_program.global", attributes=attributes, ip=importer._m_ip
+            )
+        # The symbol table renames the global if the key is already in use.
+        return StringAttr(importer.symbol_table.insert(global_op)).value
+
+
+def _read_safetensors_index(path: str) -> Dict[str, Tuple[int, int]]:
+    """Maps each tensor of a safetensors file to its (offset, length) in bytes,
+    reading only the header."""
+    with open(path, "rb") as f:
+        header_size = int.from_bytes(f.read(8), "little")
+        header = json.loads(f.read(header_size))
+    data_start = 8 + header_size
+    index = {}
+    for key, entry in header.items():
+        if key == "__metadata__":
+            continue
+        begin, end = entry["data_offsets"]
+        index[key] = (data_start + begin, end - begin)
+    return index
+
+
 class FxImporter:
     """Main entry-point for importing an fx.GraphModule.
 
@@ -818,6 +931,7 @@ class FxImporter:
             # causes various lowerings to be able to emit more efficient code or
             # handle more cases. See isAssumingStrictSymbolicShapes().
             func_op.attributes["torch.assume_strict_symbolic_shapes"] = UnitAttr.get()
+            self._annotate_shardings(func_op, user_inputs, user_outputs)
             entry_block = Block.create_at_start(func_op.body, ftype.inputs)
 
         node_importer = GraphNodeImporter(
@@ -877,6 +991,48 @@ class FxImporter:
 
         return func_op
 
+    def _annotate_shardings(
+        self,
+        func_op: Operation,
+        inputs: List[Node],
+        outputs: List[Optional[Node]],
+    ):
+        """Annotates the arguments and results of `func_op` that are DTensors
+        with their `torch.sharding`, and the module with the device ids of
+        their mesh as `torch.device_mesh`."""
+        input_shardings = [dtensor_sharding(n.meta.get("val")) for n in inputs]
+        output_shardings = [
+            dtensor_sharding(n.meta.get("val")) if n is not None else None
+            for n in outputs
+        ]
+        meshes = [
+            mesh for _, mesh in filter(None, input_shardings + output_shardings)
+        ]
+        if not meshes:
+            return
+        if any(mesh != meshes[0] for mesh in meshes):
+            raise NotImplementedError("DTensors on different device meshes")
+        module_op = self._m.operation
+        if "torch.device_mesh" not in module_op.attributes:
+            module_op.attributes["torch.device_mesh"] = DenseElementsAttr.get(
+                np.array(meshes[0], dtype=np.int64)
+            )
+
+        def get_attrs(shardings) -> ArrayAttr:
+            return ArrayAttr.get(
+                [
+                    DictAttr.get(
+                        {"torch.sharding": DenseI64ArrayAttr.get(sharding[0])}
+                        if sharding is not None
+                        else {}
+                    )
+                    for sharding in shardings
+                ]
+            )
+
+        func_op.attributes["arg_attrs"] = get_attrs(input_shardings)
+        func_op.attributes["res_attrs"] = get_attrs(output_shardings)
+
     def _import_all_child_modules(
         self,
         module: GraphModule,
@@ -1121,18 +1277,15 @@ class FxImporter:
 
                 for result_node in result_nodes:
                     if result_node is None:
-                        result_types.append(
-                            IrType.parse("!torch.none", context=self._c)
-                        )
+                        result_types.append(self._cc.torch_none_type)
                     elif isinstance(result_node, torch.Tensor):
                         result_types.append(
                             self._cc.tensor_to_vtensor_type(result_node)
                         )
                     elif type(result_node) in SCALAR_TYPE_TO_TORCH_MLIR_TYPE:
                         result_types.append(
-                            IrType.parse(
-                                SCALAR_TYPE_TO_TORCH_MLIR_TYPE[type(result_node)],
-                                self._c,
+                            self._cc.parse_type(
+                                SCALAR_TYPE_TO_TORCH_MLIR_TYPE[type(result_node)]
                             )
                         )
                     else:
@@ -1150,6 +1303,9 @@ class ContextCache:
         "_c",
         "_dtype_to_type",
         "_tensor_metadata_cache",
+        "_type_asm_cache",
+        "_location_cache",
+        "_op_overload_cache",
         "_symbolic_guards",
         "_py_attr_tracker",
         # Types.
@@ -1169,6 +1325,11 @@ class ContextCache:
         self._tensor_metadata_cache: Dict[
             Tuple[torch.Size, torch.dtype, Optional[SparsityMeta], bool], IrType
         ] = {}
+        self._type_asm_cache: Dict[str, IrType] = {}
+        self._location_cache: Dict[str, Location] = {}
+        self._op_overload_cache: Dict[
+            Tuple[TorchOpOverload, bool], "OpOverloadInfo"
+        ] = {}
         self._symbolic_guards: Dict = {}
         self._py_attr_tracker = py_attr_tracker or RefTracker()
 
@@ -1185,6 +1346,46 @@ class ContextCache:
         c = self._c
         return IntegerAttr.get(IntegerType.get_signless(bits, c), value)
 
+    def parse_type(self, asm: str) -> IrType:
+        """Returns the type for `asm`, parsing each distinct type only once.
+
+        Type parsing is far slower than a dict lookup, and importers request
+        the same handful of types for most nodes.
+        """
+        t = self._type_asm_cache.get(asm)
+        if t is None:
+            t = IrType.parse(asm, context=self._c)
+            self._type_asm_cache[asm] = t
+        return t
+
+    def get_op_overload_info(
+        self, target: TorchOpOverload, scalar_variant: bool = False
+    ) -> "OpOverloadInfo":
+        """Returns what importing a call of `target` needs from its schema, or
+        that of its `.Scalar` variant (see `TENSOR_SCALAR_OP_CONVERTER`).
+
+        Models call the same few overloads for most of their nodes, so this is
+        looked up once per overload rather than once per node.
+        """
+        key = (target, scalar_variant)
+        info = self._op_overload_cache.get(key)
+        if info is None:
+            schema = target._schema
+            assert isinstance(schema, FunctionSchema)
+            mlir_op_name = _get_mlir_op_name_for_schema(schema)
+            if scalar_variant:
+                mlir_op_name = TENSOR_SCALAR_OP_CONVERTER[mlir_op_name]
+                # i.e. `schema = torch.ops.aten.my_op.Scalar._schema`
+                op_overload = torch.ops
+                for attr in mlir_op_name.split(".")[1:]:
+                    op_overload = getattr(op_overload, attr)
+                schema = op_overload._schema
+            info = OpOverloadInfo(
+                mlir_op_name, schema, self._c.is_registered_operation(mlir_op_name)
+            )
+            self._op_overload_cache[key] = info
+        return info
+
     def format_asm_shape(self, shape: torch.Size) -> str:
         """Strips symbolic elements from a torch.Size object and returns shape asm"""
         return ",".join("?" if is_symbolic(d) else str(d) for d in list(shape))
@@ -1210,14 +1411,11 @@ class ContextCache:
         ]:
             # This is a sparse tensor.
             encoding = sparsity_encoding(val)
-            return IrType.parse(
-                f"!{stem}<[{shape_asm}],{str(mlir_dtype)},{encoding}>",
-                context=self._c,
+            return self.parse_type(
+                f"!{stem}<[{shape_asm}],{str(mlir_dtype)},{encoding}>"
             )
         # This is a dense tensor.
-        return IrType.parse(
-            f"!{stem}<[{shape_asm}],{str(mlir_dtype)}>", context=self._c
-        )
+        return self.parse_type(f"!{stem}<[{shape_asm}],{str(mlir_dtype)}>")
 
     def node_val_to_type(self, node: torch_fx.Node, *, mutable: bool = False) -> IrType:
         try:
@@ -1241,7 +1439,7 @@ class ContextCache:
             if isinstance(val, list) and all(
                 isinstance(x, TorchFakeTensor) for x in val
             ):
-                return IrType.parse("!torch.list<vtensor>", context=self._c)
+                return self.parse_type("!torch.list<vtensor>")
             assert isinstance(tensor_meta, TensorMetadata)
             # Quantized tensor meta data is not preserved in our lowering,
             # so throw error instead of silently doing wrong thing.
@@ -1263,13 +1461,13 @@ class ContextCache:
             elif isinstance(val, list) and all(
                 isinstance(x, TorchFakeTensor) for x in val
             ):
-                return IrType.parse("!torch.list<vtensor>", context=self._c)
+                return self.parse_type("!torch.list<vtensor>")
 
         # Note that None is a valid scalar here, so it is important that this
         # is always checked as the last fallback.
         t = SCALAR_TYPE_TO_TORCH_MLIR_TYPE.get(type(val))
         if t is not None:
-            return IrType.parse(t, self._c)
+            return self.parse_type(t)
 
         raise NotImplementedError(
             f"Could not deduce type from value info: "
@@ -1287,6 +1485,10 @@ class ContextCache:
             item.node if is_symbolic(item) else item for item in list(tm.shape)
         )
 
+        # The value only matters for the encoding of sparse tensors, and keying
+        # on every other value would never hit.
+        if val is not None and val.layout == torch.strided:
+            val = None
         key = (tm_shape, tm.dtype, val, mutable)
         t = self._tensor_metadata_cache.get(key)
         if t is None:
@@ -1307,9 +1509,7 @@ class ContextCache:
 
     def create_vtensor_type(self, dtype: torch.dtype, size: torch.Size) -> IrType:
         dtype_asm = str(self.dtype_to_type(dtype))
-        return IrType.parse(
-            f"!torch.vtensor<{list(size)},{dtype_asm}>", context=self._c
-        )
+        return self.parse_type(f"!torch.vtensor<{list(size)},{dtype_asm}>")
 
     def tensor_to_vtensor_type(self, tensor: torch.Tensor) -> IrType:
         return self.create_vtensor_type(tensor.dtype, tensor.size())
@@ -1322,18 +1522,25 @@ class ContextCache:
         # TODO: Avoid needing to regex match this.
         # https://github.com/pytorch/pytorch/issues/91000
         stack_trace = node.stack_trace
-        if stack_trace:
-            matches = re.findall(r"""File "([^"]+)", line ([0-9]+),""", stack_trace)
-            locations = [
-                Location.file(m[0], int(m[1]), col=0, context=self._c) for m in matches
-            ]
-            if len(locations) > 1:
-                return Location.callsite(
-                    locations[-1], locations[-2::-1], context=self._c
-                )
-            elif len(locations) == 1:
-                return locations[0]
-        return Location.unknown(context=self._c)
+        if not stack_trace:
+            return Location.unknown(context=self._c)
+        # The nodes of the layers of a model that are built in a loop share
+        # their stack traces, so each distinct one is only parsed once.
+        loc = self._location_cache.get(stack_trace)
+        if loc is not None:
+            return loc
+        matches = re.findall(r"""File "([^"]+)", line ([0-9]+),""", stack_trace)
+        locations = [
+            Location.file(m[0], int(m[1]), col=0, context=self._c) for m in matches
+        ]
+        if len(locations) > 1:
+            loc = Location.callsite(locations[-1], locations[-2::-1], context=self._c)
+        elif len(locations) == 1:
+            loc = locations[0]
+        else:
+            loc = Location.unknown(context=self._c)
+        self._location_cache[stack_trace] = loc
+        return loc
 
     def set_symbolic_guards(
         self, prog: torch.export.ExportedProgram
@@ -1847,7 +2054,7 @@ class GraphNodeImporter:
             cond_result_loop = Operation.create(
                 name="func.call",
                 attributes={"callee": FlatSymbolRefAttr.get(cond_fn_name)},
-                results=[IrType.parse("!torch.vtensor<[],i1>", context=self._c)],
+                results=[self._cc.parse_type("!torch.vtensor<[],i1>")],
                 operands=body_results,
                 loc=loc,
             ).result
@@ -2096,52 +2303,44 @@ class GraphNodeImporter:
                 "aten.as_strided.default must be rewritten before Torch IR import"
             )
 
-        schema = target._schema
-        assert isinstance(schema, FunctionSchema)
-        mlir_op_name = _get_mlir_op_name_for_schema(schema)
+        info = self._cc.get_op_overload_info(target)
 
         # Intervening to use Scalar ops due to incorrect ops from AOT-autograd with scalar arguments.
-        if mlir_op_name in TENSOR_SCALAR_OP_CONVERTER and is_scalar_arg(node.args[1]):
-            mlir_op_name = TENSOR_SCALAR_OP_CONVERTER[mlir_op_name]
+        if info.mlir_op_name in TENSOR_SCALAR_OP_CONVERTER and is_scalar_arg(
+            node.args[1]
+        ):
             # we are dynamically changing which op is emitted here due to an issue in
             # torch dynamo where it emits the Tensor variant of ops even when processing
             # scalar arguments, therefore we retrieve the schema as well so that we
             # consume the correct typing information when subsequently importing the
             # function arguments and result types.
-            # i.e. the code below is basically doing `schema = torch.ops.aten.my_op.Scalar._schema`
-            op_attrs = mlir_op_name.split(".")
-            op_overload = getattr(torch, "ops")
-            for i in range(1, len(op_attrs)):
-                op_overload = getattr(op_overload, op_attrs[i])
-            schema = op_overload._schema
+            info = self._cc.get_op_overload_info(target, scalar_variant=True)
 
         # Convert result types.
-        result_types = self._unpack_node_result_types(node, schema)
+        result_types = self._unpack_node_result_types(node, info.num_returns)
         if len(result_types) > 1:
             self._multi_result_nodes.add(node)
 
         # Unroll operands from formal parameters, args and kwargs.
         operands = []
-        for i, parameter in enumerate(schema.arguments):
-            if i < len(node.args):
-                operands.append(
-                    self._import_argument(loc, node.args[i], parameter.type)
-                )
-            elif parameter.name in node.kwargs:
-                operands.append(
-                    self._import_argument(
-                        loc, node.kwargs[parameter.name], parameter.type
-                    )
-                )
+        args = node.args
+        kwargs = node.kwargs
+        for i, (name, jit_type, default_value) in enumerate(info.arguments):
+            if i < len(args):
+                operands.append(self._import_argument(loc, args[i], jit_type))
+            elif name in kwargs:
+                operands.append(self._import_argument(loc, kwargs[name], jit_type))
             else:
                 operands.append(
-                    self._import_default_value(
-                        loc, parameter.default_value, parameter.type
-                    )
+                    self._import_default_value(loc, default_value, jit_type)
                 )
 
         operation = _emit_operation(
-            mlir_op_name, result_types=result_types, operands=operands, loc=loc
+            info.mlir_op_name,
+            result_types=result_types,
+            operands=operands,
+            loc=loc,
+            is_registered=info.is_registered,
         )
 
         # Record value mapping.
@@ -2420,7 +2619,7 @@ class GraphNodeImporter:
         else:
             list_type = PY_TYPE_TO_TORCH_LIST_TYPE[element_type]
 
-        result_type = IrType.parse(list_type, context=self._c)
+        result_type = self._cc.parse_type(list_type)
         operation = Operation.create(
             "torch.prim.ListConstruct",
             results=[result_type],
@@ -2491,9 +2690,8 @@ class GraphNodeImporter:
                 )
 
     def _unpack_node_result_types(
-        self, node: torch.fx.Node, schema: FunctionSchema
+        self, node: torch.fx.Node, return_count: int
     ) -> List[IrType]:
-        return_count = len(schema.returns)
         if return_count == 1:
             # Unary return directly maps a single meta["val"] and cannot be subscripted.
             # if "tensor_meta" is None, this will throw unsupported placeholder node error
@@ -2647,14 +2845,48 @@ def _get_mlir_op_name_for_schema(schema: FunctionSchema) -> str:
     return mlir_op_name
 
 
+class OpOverloadInfo:
+    """What importing a call of an op overload needs from its schema.
+
+    The attributes of a `FunctionSchema` build new Python objects on every
+    access, so its arguments are unpacked here once.
+    """
+
+    __slots__ = [
+        "mlir_op_name",
+        "schema",
+        "is_registered",
+        "arguments",
+        "num_returns",
+    ]
+
+    def __init__(self, mlir_op_name: str, schema: FunctionSchema, is_registered: bool):
+        self.mlir_op_name = mlir_op_name
+        self.schema = schema
+        # Whether `mlir_op_name` is an op of the torch dialect, rather than one
+        # that is emitted as a `torch.operator`.
+        self.is_registered = is_registered
+        # The (name, type, default value) of each argument.
+        self.arguments: List[Tuple[str, Any, Any]] = [
+            (argument.name, argument.type, argument.default_value)
+            for argument in schema.arguments
+        ]
+        self.num_returns = len(schema.returns)
+
+
 def _emit_operation(
-    mlir_op_name: str, result_types: List[IrType], operands: List[Value], loc: Location
+    mlir_op_name: str,
+    result_types: List[IrType],
+    operands: List[Value],
+    loc: Location,
+    is_registered: Optional[bool] = None,
 ) -> Operation:
     # Support unregistered torch ops using torch.operator.
     # torch.operator is used to represent ops from registry
     # which haven't been generated by torch_ods_gen.py.
-    context = loc.context
-    if not context.is_registered_operation(mlir_op_name):
+    if is_registered is None:
+        is_registered = loc.context.is_registered_operation(mlir_op_name)
+    if not is_registered:
         operation = Operation.create(
             "torch.operator",
             attributes={"name": StringAttr.get(mlir_op_name)},
@@ -38,10 +38,16 @@ import warnings
 
 from dataclasses import dataclass, field
 
+import mmap
 import numpy as np
+import os
 import re
 
 from ..ir import (
+    AffineConstantExpr,
+    AffineMap,
+    AffineMapAttr,
+    AffineSymbolExpr,
     ArrayAttr,
     Attribute,
     Block,
@@ -92,6 +98,12 @@ class Config:
     # making an assumption.
     elide_initialized_inputs: bool = True
 
+    # Import the named dims (`dim_param`s) of the function's tensors as
+    # `torch.symbolic_int` ops, one per name, and bind the shapes of the
+    # tensors to them with `torch.bind_symbolic_shape`, so that dynamic dims
+    # which ONNX declares equal are known to be equal downstream.
+    bind_symbolic_dims: bool = False
+
     # Some ONNX operators are defined by ONNX functions and will be
     # automatically expanded (see get_operator_function() below) to MLIR
     # functions by the importer. This option allows allowlisting functions that
@@ -132,12 +144,55 @@ class Config:
     )
 
 
+class ExternalData:
+    """Memory-maps the files holding the external data of a model.
+
+    Initializers stored in external data files are imported as resources that
+    reference the mapped files directly, so the importer never reads them into
+    memory and the model does not need `onnx.load_external_data_for_model`.
+    """
+
+    def __init__(self, base_dir: str):
+        self.base_dir = base_dir
+        self._mapped_files: Dict[str, memoryview] = {}
+
+    def get_buffer(self, tp: onnx.TensorProto) -> memoryview:
+        info = {entry.key: entry.value for entry in tp.external_data}
+        if "location" not in info:
+            raise OnnxImportError(
+                f"External data of tensor '{tp.name}' has no location"
+            )
+        path = os.path.join(self.base_dir, info["location"])
+        mapped = self._mapped_files.get(path)
+        if mapped is None:
+            with open(path, "rb") as f:
+                mapped = memoryview(mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ))
+            self._mapped_files[path] = mapped
+        offset = int(info.get("offset", 0))
+        length = int(info["length"]) if "length" in info else len(mapped) - offset
+        return mapped[offset : offset + length]
+
+
 class ModelInfo:
-    """Top-level accounting and accessors for an ONNX model."""
+    """Top-level accounting and accessors for an ONNX model.
+
+    If the model was loaded without its external data (i.e. with
+    `load_external_data=False`), `external_data_dir` is the directory that the
+    external data locations are relative to.
+    """
 
-    def __init__(self, model_proto: onnx.ModelProto, *, config: Config = Config()):
+    def __init__(
+        self,
+        model_proto: onnx.ModelProto,
+        *,
+        config: Config = Config(),
+        external_data_dir: Optional[str] = None,
+    ):
         self.config = config
         self.model_proto = model_proto
+        self.external_data = (
+            ExternalData(external_data_dir) if external_data_dir is not None else None
+        )
         assert model_proto.graph, "Model must contain a main Graph"
         self.main_graph = GraphInfo(self, model_proto.graph)
 
@@ -240,6 +295,7 @@ class NodeImporter:
         "_b",
         "_nv_map",
         "_none_value",
+        "_dim_symbols",
     ]
 
     def __init__(
@@ -261,6 +317,9 @@ class NodeImporter:
         self._b = block
         self._nv_map: Dict[str, Value] = {}
         self._none_value: Optional[Value] = None
+        # The `torch.symbolic_int` values of the named dims, shared with the
+        # importers of subgraphs, or None if symbolic dims are not bound.
+        self._dim_symbols: Optional[Dict[str, Value]] = None
 
     @classmethod
     def define_function(
@@ -306,9 +365,78 @@ class NodeImporter:
         )
         for node_name, input_value in zip(graph_info.input_map.keys(), block.arguments):
             imp._nv_map[node_name] = input_value
+        if graph_info.model_info.config.bind_symbolic_dims:
+            with module_op.context, Location.name(
+                f"graph:{graph_info.graph_proto.name}"
+            ):
+                imp._import_dim_symbols()
+                for input_info, input_value in zip(
+                    graph_info.input_map.values(), block.arguments
+                ):
+                    imp._bind_symbolic_dims(input_value, input_info.type)
         imp._populate_graph_attrs(func_op)
         return imp
 
+    def _import_dim_symbols(self):
+        """Creates a `torch.symbolic_int` for each named dim of the graph."""
+        self._dim_symbols = {}
+        value_infos = (
+            list(self._gi.input_map.values())
+            + list(self._gi.graph_proto.value_info)
+            + list(self._gi.graph_proto.output)
+        )
+        with InsertionPoint(self._b):
+            for value_info in value_infos:
+                for d in value_info.type.tensor_type.shape.dim:
+                    if not d.HasField("dim_param") or d.dim_param in self._dim_symbols:
+                        continue
+                    self._dim_symbols[d.dim_param] = Operation.create(
+                        name="torch.symbolic_int",
+                        results=[self._cc.get_int_type()],
+                        attributes={
+                            "symbol_name": StringAttr.get(d.dim_param),
+                            "min_val": self._cc.get_i64_attr(0),
+                            "max_val": self._cc.get_i64_attr(2**63 - 1),
+                        },
+                    ).result
+
+    def _bind_symbolic_dims(self, value: Value, tp: onnx.TypeProto):
+        """Binds the shape of `value` to the symbols of its named dims.
+
+        Only tensors whose dims are all static or named are bound, since the
+        shape expressions cannot refer to anonymous dynamic dims.
+        """
+        if not tp or not tp.HasField("tensor_type"):
+            return
+        tt = tp.tensor_type
+        if not tt.HasField("shape"):
+            return
+        symbols: List[Value] = []
+        symbol_exprs: Dict[str, AffineSymbolExpr] = {}
+        exprs = []
+        for d in tt.shape.dim:
+            if d.HasField("dim_value"):
+                exprs.append(AffineConstantExpr.get(d.dim_value))
+                continue
+            symbol = self._dim_symbols.get(d.dim_param) if d.dim_param else None
+            if symbol is None:
+                return
+            if d.dim_param not in symbol_exprs:
+                symbol_exprs[d.dim_param] = AffineSymbolExpr.get(len(symbols))
+                symbols.append(symbol)
+            exprs.append(symbol_exprs[d.dim_param])
+        if not symbols:
+            return
+        Operation.create(
+            name="torch.bind_symbolic_shape",
+            operands=[value] + symbols,
+            attributes={
+                "shape_expressions": AffineMapAttr.get(
+                    AffineMap.get(0, len(symbols), exprs)
+                )
+            },
+        )
+
     def _populate_graph_attrs(self, container_op: Operation):
         """Populates graph level meta attributes on the given container op."""
         m = self._gi.model_info.model_proto
@@ -457,6 +585,12 @@ class NodeImporter:
                 if output_name != "":
                     self._nv_map[output_name] = output_value
 
+            if self._dim_symbols is not None:
+                for output_value, type_proto in zip(
+                    custom_op.results, output_type_protos
+                ):
+                    self._bind_symbolic_dims(output_value, type_proto)
+
     def import_attributes(self, onnx_attrs: List[onnx.AttributeProto]):
         attrs = {}
         for onnx_attr in onnx_attrs:
@@ -525,6 +659,7 @@ class NodeImporter:
                 imp._nv_map[node_name] = input_value
             for k in self._nv_map:
                 imp._nv_map[k] = self._nv_map[k]
+            imp._dim_symbols = self._dim_symbols
 
             imp.import_all(False)
 
@@ -535,7 +670,9 @@ class NodeImporter:
         # up the name from the tensor proto itself
         iname = extern_name if extern_name else initializer.name
         with InsertionPoint(self._b), Location.name(iname):
-            value_attr = self._cc.tensor_proto_to_attr(initializer)
+            value_attr = self._cc.tensor_proto_to_attr(
+                initializer, self._gi.model_info.external_data
+            )
             vtensor_type = self._cc.tensor_proto_to_type(initializer)
             attrs = {
                 "name": StringAttr.get(f"onnx.Constant"),
@@ -562,7 +699,12 @@ class NodeImporter:
             raise OnnxImportError(
                 f"Unknown ONNX tensor element type to numpy dtype mapping: {initializer.data_type}"
             )
-        raw_data = initializer.raw_data
+        if initializer.data_location == onnx.TensorProto.EXTERNAL:
+            raw_data = _get_external_buffer(
+                initializer, self._gi.model_info.external_data
+            )
+        else:
+            raw_data = initializer.raw_data
         if raw_data:
             return np.frombuffer(raw_data, dtype=dtype).reshape(tuple(initializer.dims))
         else:
@@ -587,12 +729,23 @@ class NodeImporter:
         return True
 
 
+def _contained_type_asm(t: IrType) -> str:
+    """Torch container types spell their torch element types without the
+    dialect prefix (e.g. `!torch.list<vtensor<[2],f32>>`)."""
+    asm = str(t)
+    if asm.startswith("!torch."):
+        asm = asm[len("!torch.") :]
+    return asm
+
+
 class ContextCache:
     """Caches per-context lookups of various things."""
 
     __slots__ = [
         "_c",
         "_elem_type_map",
+        "_none_type",
+        "_int_type",
         "_list_type_map",
         "_optional_type_map",
         "_vtensor_type_map",
@@ -601,8 +754,10 @@ class ContextCache:
     def __init__(self, context: Context):
         self._c = context
         self._elem_type_map: Dict[int, IrType] = {}
-        self._list_type_map: Dict[str, IrType] = {}
-        self._optional_type_map: Dict[str, IrType] = {}
+        self._none_type: Optional[IrType] = None
+        self._int_type: Optional[IrType] = None
+        self._list_type_map: Dict[IrType, IrType] = {}
+        self._optional_type_map: Dict[IrType, IrType] = {}
         self._vtensor_type_map: Dict[Tuple[Tuple[Optional[int]], IrType], IrType] = {}
 
     def tensor_element_type(self, elem_type: int) -> IrType:
@@ -617,13 +772,23 @@ class ContextCache:
         return t
 
     def get_none_type(self):
-        return IrType.parse("!torch.none", context=self._c)
+        if self._none_type is None:
+            self._none_type = IrType.parse("!torch.none", context=self._c)
+        return self._none_type
+
+    def get_int_type(self):
+        if self._int_type is None:
+            self._int_type = IrType.parse("!torch.int", context=self._c)
+        return self._int_type
+
+    def get_i64_attr(self, value: int) -> IntegerAttr:
+        return IntegerAttr.get(IntegerType.get_signless(64, context=self._c), value)
 
     def get_list_type(self, element_type: IrType) -> IrType:
-        key = str(element_type)
+        key = element_type
         t = self._list_type_map.get(key)
         if t is None:
-            asm = f"!torch.list<{str(element_type)}>"
+            asm = f"!torch.list<{_contained_type_asm(element_type)}>"
             try:
                 t = IrType.parse(asm, context=self._c)
             except MLIRError as e:
@@ -634,10 +799,10 @@ class ContextCache:
         return t
 
     def get_optional_type(self, element_type: IrType) -> IrType:
-        key = str(element_type)
+        key = element_type
         t = self._optional_type_map.get(key)
         if t is None:
-            asm = f"!torch.optional<{str(element_type)}>"
+            asm = f"!torch.optional<{_contained_type_asm(element_type)}>"
             try:
                 t = IrType.parse(asm, context=self._c)
             except MLIRError as e:
@@ -654,8 +819,7 @@ class ContextCache:
             dims = tuple(
                 (d.dim_value if d.HasField("dim_value") else None) for d in tt.shape.dim
             )
-            shape_asm = ",".join("?" if d is None else str(d) for d in dims)
-            return f"vtensor<[{shape_asm}],{element_type}>"
+            return self.get_vtensor_type(dims, element_type)
 
         raise OnnxImportError(f"Unsupport list element type")
 
@@ -667,12 +831,11 @@ class ContextCache:
             dims = tuple(
                 (d.dim_value if d.HasField("dim_value") else None) for d in tt.shape.dim
             )
-            shape_asm = ",".join("?" if d is None else str(d) for d in dims)
-            return f"vtensor<[{shape_asm}],{element_type}>"
+            return self.get_vtensor_type(dims, element_type)
 
         if st.elem_type:
             element_type = self.get_list_element_type(st.elem_type)
-            return f"list<{element_type}>"
+            return self.get_list_type(element_type)
 
         raise OnnxImportError(f"Unsupport optional element type")
 
@@ -755,8 +918,18 @@ class ContextCache:
         # https://mlir.llvm.org/docs/LangRef/#identifiers-and-keywords
         return re.sub(r"[^\w\.]", "_", name)
 
-    def tensor_proto_to_attr(self, tp: onnx.TensorProto) -> Attribute:
+    def tensor_proto_to_attr(
+        self, tp: onnx.TensorProto, external_data: Optional[ExternalData] = None
+    ) -> Attribute:
         tensor_type = self.tensor_proto_to_builtin_type(tp)
+        if tp.data_location == onnx.TensorProto.EXTERNAL:
+            # The resource references the memory-mapped file without copying.
+            return DenseResourceElementsAttr.get_from_buffer(
+                _get_external_buffer(tp, external_data),
+                self._sanitize_name(tp.name),
+                tensor_type,
+                alignment=8,
+            )
         if tp.HasField("raw_data"):
             # Conveniently, DenseResourceElementsAttr shares the raw data
             # format. We just give it maximum numeric alignment.
@@ -774,6 +947,17 @@ class ContextCache:
             return handler(tp)
 
 
+def _get_external_buffer(
+    tp: onnx.TensorProto, external_data: Optional[ExternalData]
+) -> memoryview:
+    if external_data is None:
+        raise OnnxImportError(
+            f"Tensor '{tp.name}' is stored in external data, but the model was "
+            f"imported without an external data directory"
+        )
+    return external_data.get_buffer(tp)
+
+
 def _shallow_copy_and_clear_protobuf_list(protobuf_list) -> list:
     """
     Workaround for .clear() not being available on protobuf lists for some
@@ -7,6 +7,7 @@ from typing import Optional, Union, Dict, Tuple, Any, Callable
 from packaging import version
 from dataclasses import dataclass
 
+import hashlib
 import warnings
 
 import torch
@@ -14,15 +15,25 @@ import torch.export
 import torch.nn as nn
 from torch.export import ExportedProgram
 
-from .extras.fx_importer import FxImporter, FxImporterHooks
+from .extras.fx_importer import (
+    ExternalParameterHooks,
+    FxImporter,
+    FxImporterHooks,
+)
 from . import ir
 from .dialects import torch as torch_d
-from .extras.fx_decomp_util import get_decomposition_table
+from .extras.fx_decomp_util import (
+    STABLEHLO_COMPOSITE_OPS,
+    get_backend_legal_ops,
+    get_decomposition_table,
+)
 from .compiler_utils import (
     OutputType,
     run_pipeline_with_repro_report,
+    run_pipeline_per_function,
     lower_mlir_module,
     BackendLoweringOptions,
+    CompilationCache,
 )
 
 
@@ -32,6 +43,43 @@ class FxImportOptions:
 
     extra_library_file_name: Optional[str] = None
     backend_legal_ops: Optional[list[str]] = None
+    # Each entry gives one shape per argument of `func_name`, or None to
+    # leave that argument alone; -1 keeps a dim dynamic.
+    static_shape_variants: Optional[list[list[Optional[list[int]]]]] = None
+    func_name: str = "main"
+    # The indices of the results of `func_name` that are kept; the others,
+    # and the compute and arguments that only they need, are dropped.
+    kept_outputs: Optional[list[int]] = None
+
+
+def _format_arg_shapes(arg_shapes: list[Optional[list[int]]]) -> str:
+    def format_shape(shape):
+        if shape is None:
+            return "*"
+        return "x".join("?" if dim < 0 else str(dim) for dim in shape)
+
+    return ",".join(format_shape(shape) for shape in arg_shapes)
+
+
+def _hash_exported_program(prog: ExportedProgram) -> bytes:
+    """A hash of the graph of `prog`, of the metadata of its nodes, e.g. the
+    shapes and dtypes of its inputs, and of its parameters, buffers and
+    constants."""
+    key = hashlib.sha256()
+    key.update(prog.graph_module.code.encode())
+    for node in prog.graph.nodes:
+        key.update(f"{node.name}:{node.meta.get('val')}".encode())
+    key.update(str(prog.graph_signature).encode())
+    key.update(str(prog.range_constraints).encode())
+    for name, value in sorted({**prog.state_dict, **prog.constants}.items()):
+        key.update(name.encode())
+        if not isinstance(value, torch.Tensor):
+            key.update(repr(value).encode())
+            continue
+        key.update(f"{value.dtype}{list(value.shape)}".encode())
+        data = value.detach().cpu().contiguous().reshape(-1)
+        key.update(data.view(torch.uint8).numpy().tobytes())
+    return key.digest()
 
 
 def _module_lowering(
@@ -41,6 +89,7 @@ def _module_lowering(
     torch_mod,
     fx_import_options: Optional[FxImportOptions] = None,
     backend_options: Optional[BackendLoweringOptions] = None,
+    cache: Optional[CompilationCache] = None,
 ):
 
     if fx_import_options is None:
@@ -77,13 +126,46 @@ def _module_lowering(
         + "}"
     )
 
-    run_pipeline_with_repro_report(
-        torch_mod,
-        f"builtin.module(func.func(torch-match-quantized-custom-ops), torchdynamo-export-to-torch-backend-pipeline{option_string})",
-        "Lowering TorchFX IR -> Torch Backend IR",
-        enable_ir_printing=enable_ir_printing,
-    )
-    return lower_mlir_module(verbose, output_type, torch_mod, backend_options)
+    if fx_import_options.kept_outputs is not None:
+        kept_results = ",".join(str(i) for i in fx_import_options.kept_outputs)
+        if kept_results:
+            kept_results = f" kept-results={kept_results}"
+        run_pipeline_with_repro_report(
+            torch_mod,
+            f"builtin.module(torch-prune-public-function{{"
+            f"func-name={fx_import_options.func_name}{kept_results}}})",
+            "Pruning the unused outputs of TorchFX IR",
+            enable_ir_printing=enable_ir_printing,
+        )
+    pipeline = f"builtin.module(func.func(torch-match-quantized-custom-ops), torchdynamo-export-to-torch-backend-pipeline{option_string})"
+    description = "Lowering TorchFX IR -> Torch Backend IR"
+    if cache is None:
+        run_pipeline_with_repro_report(
+            torch_mod,
+            pipeline,
+            description,
+            enable_ir_printing=enable_ir_printing,
+        )
+    else:
+        run_pipeline_per_function(
+            torch_mod,
+            pipeline,
+            description,
+            cache,
+            enable_ir_printing=enable_ir_printing,
+        )
+    func_name = fx_import_options.func_name
+    for i, arg_shapes in enumerate(fx_import_options.static_shape_variants or []):
+        run_pipeline_with_repro_report(
+            torch_mod,
+            f"builtin.module(torch-specialize-shapes{{func-name={func_name} "
+            f"arg-shapes={_format_arg_shapes(arg_shapes)} "
+            f"specialized-name={func_name}_static{i} "
+            f"extra-library={extra_library_file_name}}})",
+            f"Specializing Torch Backend IR for static shape variant {i}",
+            enable_ir_printing=enable_ir_printing,
+        )
+    return lower_mlir_module(verbose, output_type, torch_mod, backend_options, cache=cache)
 
 
 def export_and_import(
@@ -103,11 +185,69 @@ def export_and_import(
     enable_ir_printing: bool = False,
     backend_legal_ops: Optional[list[str]] = None,
     allow_non_finites: bool = True,
+    stablehlo_composites: bool = False,
+    external_parameters: bool = False,
+    external_parameters_file: Optional[str] = None,
+    static_shape_variants: Optional[list[list[Optional[list[int]]]]] = None,
+    compile_cache_dir: Optional[str] = None,
+    kept_outputs: Optional[list[int]] = None,
     **kwargs,
 ):
+    """Exports `f` and imports it into a torch-mlir module.
+
+    With `external_parameters`, parameters and buffers are imported as
+    `ml_program.global`s that are declared external instead of as literals,
+    so weight data is never read (see `ExternalParameterHooks`). If
+    `external_parameters_file` names a safetensors file, the globals also
+    record where their data lives in it. This requires PyTorch 2.3+ and
+    cannot be combined with custom `hooks`.
+
+    The ops of `backend_legal_ops`, or of `BACKEND_LEGAL_OPS` of
+    `output_type` if it is None, are neither decomposed before import, unless
+    a `decomposition_table` is given, nor by the lowering to the backend
+    contract.
+
+    Each entry of `static_shape_variants` lists a concrete shape for every
+    argument of the imported function (None leaves an argument alone, and -1
+    keeps a dim dynamic). For entry `i`, a clone `<func_name>_static<i>` of
+    the function refined for those shapes is added next to it, so that
+    backends can compile static variants of a dynamically exported model.
+
+    With `kept_outputs`, only the outputs of the imported function at those
+    indices are kept. The compute that only the other outputs need, e.g.
+    auxiliary losses or the running stats that batch norms update, is
+    dropped, and so are the arguments that nothing reads any more (see
+    `torch-prune-public-function`).
+
+    With `stablehlo_composites`, scaled dot product attention, layer and RMS
+    norms and GELUs are neither decomposed nor lowered to their decomposition
+    in place, but kept as `stablehlo.composite`s whose decomposition is that
+    lowering, so that StableHLO backends can match them to fused kernels. This
+    requires the STABLEHLO `output_type`.
+
+    With `compile_cache_dir`, the module is written to that directory once
+    it is lowered, under a hash of the exported program, of the import and
+    lowering options and of the torch-mlir version (see `CompilationCache`).
+    Later calls that export the same program then read it back instead of
+    importing and lowering it again. When the program changed, each public
+    function of the imported module is lowered on its own, and functions
+    whose content, including their callees and the globals they reference,
+    is unchanged reuse their earlier lowering (see
+    `run_pipeline_per_function`). This cannot be combined with a custom
+    `fx_importer` or `hooks`, which the hash does not cover.
+    """
     context = ir.Context()
     torch_d.register_dialect(context)
 
+    if compile_cache_dir is not None and (fx_importer is not None or hooks is not None):
+        raise ValueError("compile_cache_dir cannot be used with fx_importer or hooks")
+    if external_parameters:
+        if hooks is not None:
+            raise ValueError("external_parameters cannot be used with hooks")
+        hooks = ExternalParameterHooks(safetensors_file=external_parameters_file)
+    elif external_parameters_file is not None:
+        raise ValueError("external_parameters_file requires external_parameters")
+
     if fx_importer is None:
         fx_importer = FxImporter(context=context, hooks=hooks)
     if isinstance(f, ExportedProgram):
@@ -120,13 +260,49 @@ def export_and_import(
             )
         else:
             prog = torch.export.export(f, args, kwargs)
+    output_type = OutputType.get(output_type)
+    backend_legal_ops = get_backend_legal_ops(output_type, backend_legal_ops)
+    if stablehlo_composites:
+        if output_type != OutputType.STABLEHLO:
+            raise ValueError("stablehlo_composites requires the STABLEHLO output type")
+        backend_legal_ops += [
+            op for op in STABLEHLO_COMPOSITE_OPS if op not in backend_legal_ops
+        ]
     if decomposition_table is None:
-        decomposition_table = get_decomposition_table()
+        decomposition_table = get_decomposition_table(output_type, backend_legal_ops)
     if decomposition_table:
         prog = prog.run_decompositions(decomposition_table)
     if enable_graph_printing:
         prog.graph_module.print_readable()
-    if experimental_support_mutation:
+
+    fx_import_options = FxImportOptions(
+        backend_legal_ops=backend_legal_ops,
+        static_shape_variants=static_shape_variants,
+        func_name=func_name,
+        kept_outputs=kept_outputs,
+    )
+    backend_options = BackendLoweringOptions(
+        allow_non_finites=allow_non_finites,
+        stablehlo_composites=stablehlo_composites,
+    )
+    if compile_cache_dir is not None:
+        cache = CompilationCache(compile_cache_dir)
+        cache_path = cache.get_path(
+            _hash_exported_program(prog),
+            output_type.value,
+            repr(fx_import_options),
+            repr(backend_options),
+            f"mutation={experimental_support_mutation} "
+            f"symbolic_shapes={import_symbolic_shape_expressions} "
+            f"external_parameters={external_parameters}:"
+            f"{external_parameters_file}",
+        )
+        module = cache.load(cache_path, context)
+        if module is not None:
+            return module
+
+    if experimental_support_mutation or external_parameters:
+        # Only `import_program` routes parameters through the input hooks.
         if torch.__version__ < "2.3.0.dev20240207":
             warnings.warn("Mutable program import only supported on PyTorch 2.3+")
         fx_importer.import_program(
@@ -141,17 +317,18 @@ def export_and_import(
             import_symbolic_shape_expressions=import_symbolic_shape_expressions,
         )
 
-    fx_import_options = FxImportOptions(backend_legal_ops=backend_legal_ops)
-    backend_options = BackendLoweringOptions(allow_non_finites=allow_non_finites)
-
-    return _module_lowering(
+    module = _module_lowering(
         verbose,
         enable_ir_printing,
-        OutputType.get(output_type),
+        output_type,
         fx_importer.module,
         fx_import_options=fx_import_options,
         backend_options=backend_options,
+        cache=cache if compile_cache_dir is not None else None,
     )
+    if compile_cache_dir is not None:
+        cache.store(cache_path, module)
+    return module
 
 
 def stateless_fx_import(
@@ -174,13 +351,16 @@ def stateless_fx_import(
         fx_importer = FxImporter(context=context, hooks=hooks)
     fx_importer.import_stateless_graph(gm.graph, func_name=model_name)
 
-    fx_import_options = FxImportOptions(backend_legal_ops=backend_legal_ops)
+    output_type = OutputType.get(output_type)
+    fx_import_options = FxImportOptions(
+        backend_legal_ops=get_backend_legal_ops(output_type, backend_legal_ops)
+    )
     backend_options = BackendLoweringOptions(allow_non_finites=allow_non_finites)
 
     return _module_lowering(
         verbose,
         enable_ir_printing,
-        OutputType.get(output_type),
+        output_type,
         fx_importer.module,
         fx_import_options=fx_import_options,
         backend_options=backend_options,
@@ -18,6 +18,7 @@ import os
 from pathlib import Path
 import shutil
 import sys
+from typing import Optional, Tuple
 
 import onnx
 import onnx.version
@@ -34,11 +35,14 @@ def main(args: argparse.Namespace):
     config = onnx_importer.Config()
     if args.disable_function_expansion_allowlist:
         config.function_expansion_allowlists_by_domain = None
+    config.bind_symbolic_dims = args.bind_symbolic_dims
 
-    model_proto = load_onnx_model(args)
+    model_proto, external_data_dir = load_onnx_model(args)
     context = Context()
     torch_d.register_dialect(context)
-    model_info = onnx_importer.ModelInfo(model_proto, config=config)
+    model_info = onnx_importer.ModelInfo(
+        model_proto, config=config, external_data_dir=external_data_dir
+    )
     m = model_info.create_module(context=context).operation
     imp = onnx_importer.NodeImporter.define_function(model_info.main_graph, m)
     imp.import_all()
@@ -55,7 +59,13 @@ def main(args: argparse.Namespace):
         print(m.get_asm(assume_verified=not args.no_verify))
 
 
-def load_onnx_model(args: argparse.Namespace) -> onnx.ModelProto:
+def load_onnx_model(args: argparse.Namespace) -> Tuple[onnx.ModelProto, Optional[str]]:
+    """Loads and shape infers the model.
+
+    Returns the model and the directory of the external data that is left in
+    its files for the importer to memory-map, or None if the data had to be
+    loaded into the model.
+    """
     # Do shape inference two ways.  First, attempt in-memory to avoid redundant
     # loading and the need for writing a temporary file somewhere.  If that
     # fails, typically because of the 2 GB protobuf size limit, try again via
@@ -75,16 +85,23 @@ def load_onnx_model(args: argparse.Namespace) -> onnx.ModelProto:
     shutil.rmtree(temp_dir, ignore_errors=True)
     temp_dir.mkdir(exist_ok=True)
 
-    # Load the model, with possible external data coming from the default
-    # location, or the location specified on the conmand line.
-    if args.data_dir is None:
-        raw_model = onnx.load(args.input_file)
-    else:
-        raw_model = onnx.load(args.input_file, load_external_data=False)
-        onnx.load_external_data_for_model(raw_model, str(args.data_dir))
+    # Load the model without its external data, which comes from the default
+    # location, or the location specified on the command line. The importer
+    # memory-maps it, unless the model is rewritten below.
+    data_dir = Path(args.data_dir or input_dir)
+    raw_model = onnx.load(args.input_file, load_external_data=False)
+    uses_external_data = any(
+        onnx.external_data_helper.uses_external_data(t)
+        for t in raw_model.graph.initializer
+    )
 
     raw_model_modified = False
 
+    # Rewriting the model needs the data of its initializers.
+    if uses_external_data and (args.opset_version or args.clear_domain):
+        onnx.load_external_data_for_model(raw_model, str(data_dir))
+        uses_external_data = False
+
     if args.opset_version:
         raw_model = onnx.version_converter.convert_version(
             raw_model, args.opset_version
@@ -99,12 +116,14 @@ def load_onnx_model(args: argparse.Namespace) -> onnx.ModelProto:
 
     # Run the checker to test whether the file is above the threshold for
     # in-memory shape inference.  If not, go ahead and do the shape inference.
+    # Without its external data, the model is checked when it is imported.
     try:
-        onnx.checker.check_model(raw_model)
+        if not uses_external_data:
+            onnx.checker.check_model(raw_model)
         inferred_model = onnx.shape_inference.infer_shapes(
             raw_model, data_prop=args.data_prop
         )
-        return inferred_model
+        return inferred_model, str(data_dir)
     except ValueError:
         pass
 
@@ -118,8 +137,6 @@ def load_onnx_model(args: argparse.Namespace) -> onnx.ModelProto:
     # onnx.shape_inference.infer_shapes_path(temp_raw_file, temp_inferred_file)
     # inferred_model = onnx.load(temp_inferred_file)
 
-    data_dir = Path(args.data_dir or input_dir)
-
     # Model is too big for in-memory inference: do file-based shape inference
     # to a temp file.
     # First need to save as model when it has been changed (e.g. version conversion).
@@ -144,15 +161,17 @@ def load_onnx_model(args: argparse.Namespace) -> onnx.ModelProto:
     #
     # onnx.checker.check_model(temp_inferred_file)
 
-    # Load the temp file and the external data.
+    # Load the temp file. The external data is loaded when it lives in the temp
+    # dir, which is removed below, and memory-mapped by the importer otherwise.
     inferred_model = onnx.load(temp_inferred_file, load_external_data=False)
-    onnx.load_external_data_for_model(inferred_model, str(data_dir))
+    if raw_model_modified:
+        onnx.load_external_data_for_model(inferred_model, str(data_dir))
 
     # Remove the inferred shape file unless asked to keep it
     if not args.keep_temps:
         shutil.rmtree(temp_dir)
 
-    return inferred_model
+    return inferred_model, None if raw_model_modified else str(data_dir)
 
 
 def parse_arguments(argv=None) -> argparse.Namespace:
@@ -214,6 +233,13 @@ def parse_arguments(argv=None) -> argparse.Namespace:
         help="Disable the allowlist for ONNX function expansion,"
         " allowing non-allowlisted functions to be expanded.",
     )
+    parser.add_argument(
+        "--bind-symbolic-dims",
+        action="store_true",
+        help="Bind the named (dim_param) dims of tensors to shared symbolic"
+        " ints with torch.bind_symbolic_shape, so that equal dynamic dims are"
+        " known to be equal.",
+    )
     args = parser.parse_args(argv)
     return args
 
@@ -9,13 +9,17 @@
 
 // RUN: torch-mlir-capi-torch-test 2>&1 | FileCheck %s
 
+#include "mlir-c/BuiltinAttributes.h"
 #include "mlir-c/BuiltinTypes.h"
+#include "torch-mlir-c/Compile.h"
 #include "torch-mlir-c/Registration.h"
+#include "torch-mlir-c/TorchOps.h"
 #include "torch-mlir-c/TorchTypes.h"
 
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 static void printToStderr(MlirStringRef str, void *userData) {
   (void)userData;
@@ -181,10 +185,111 @@ static void testTypeMetaDataAccessors(MlirContext ctx) {
   // CHECK: dict valueType: !torch.str
 }
 
+// CHECK-LABEL: testBlockAppendOperations
+static void testBlockAppendOperations(MlirContext ctx) {
+  fprintf(stderr, "testBlockAppendOperations\n");
+  mlirContextGetOrLoadDialect(ctx, mlirStringRefCreateFromCString("torch"));
+
+  MlirLocation loc = mlirLocationUnknownGet(ctx);
+  MlirModule module = mlirModuleCreateEmpty(loc);
+  MlirBlock block = mlirModuleGetBody(module);
+  MlirType intType = torchMlirTorchIntTypeGet(ctx);
+  MlirNamedAttribute one = mlirNamedAttributeGet(
+      mlirIdentifierGet(ctx, mlirStringRefCreateFromCString("value")),
+      mlirIntegerAttrGet(mlirIntegerTypeGet(ctx, 64), 1));
+  TorchMlirOperationSpec constantSpec = {
+      mlirStringRefCreateFromCString("torch.constant.int"), loc, 0, NULL, 1,
+      &intType, 1, &one};
+  MlirValue constant;
+  torchMlirBlockAppendOperations(block, 0, NULL, 1, &constantSpec, &constant);
+
+  // Value #0 is the given constant and #1 the new one; the second add uses
+  // the result of the first.
+  intptr_t firstAddOperands[2] = {0, 1};
+  intptr_t secondAddOperands[2] = {2, 1};
+  MlirStringRef addName = mlirStringRefCreateFromCString("torch.aten.add.int");
+  TorchMlirOperationSpec specs[3] = {
+      constantSpec,
+      {addName, loc, 2, firstAddOperands, 1, &intType, 0, NULL},
+      {addName, loc, 2, secondAddOperands, 1, &intType, 0, NULL},
+  };
+  MlirValue results[3];
+  MlirLogicalResult result =
+      torchMlirBlockAppendOperations(block, 1, &constant, 3, specs, results);
+  fprintf(stderr, "succeeded: %d\n", mlirLogicalResultIsSuccess(result));
+  // CHECK: succeeded: 1
+  mlirOperationPrint(mlirModuleGetOperation(module), printToStderr, NULL);
+  fprintf(stderr, "\n");
+  // CHECK: %[[C0:.*]] = torch.constant.int 1
+  // CHECK: %[[C1:.*]] = torch.constant.int 1
+  // CHECK: %[[ADD:.*]] = torch.aten.add.int %[[C0]], %[[C1]] : !torch.int, !torch.int -> !torch.int
+  // CHECK: torch.aten.add.int %[[ADD]], %[[C1]] : !torch.int, !torch.int -> !torch.int
+
+  // A forward reference fails and leaves the block as it was.
+  intptr_t badOperands[2] = {0, 5};
+  TorchMlirOperationSpec badSpecs[2] = {
+      constantSpec,
+      {addName, loc, 2, badOperands, 1, &intType, 0, NULL},
+  };
+  result =
+      torchMlirBlockAppendOperations(block, 1, &constant, 2, badSpecs, results);
+  // CHECK: error: operand #1 of 'torch.aten.add.int' refers to value #5 but only 2 values are defined
+  fprintf(stderr, "succeeded: %d\n", mlirLogicalResultIsSuccess(result));
+  // CHECK: succeeded: 0
+  int numOps = 0;
+  for (MlirOperation op = mlirBlockGetFirstOperation(block);
+       !mlirOperationIsNull(op); op = mlirOperationGetNextInBlock(op))
+    ++numOps;
+  fprintf(stderr, "num ops: %d\n", numOps);
+  // CHECK: num ops: 4
+
+  mlirModuleDestroy(module);
+}
+
+static void printCompileResult(intptr_t index, MlirLogicalResult result,
+                               MlirStringRef output, void *userData) {
+  (void)userData;
+  if (mlirLogicalResultIsFailure(result)) {
+    fprintf(stderr, "module %" PRIdPTR " failed: ", index);
+    fwrite(output.data, 1, output.length, stderr);
+    return;
+  }
+  fprintf(stderr, "module %" PRIdPTR " bytecode: %d\n", index,
+          output.length >= 4 && memcmp(output.data, "ML\xefR", 4) == 0);
+}
+
+// CHECK-LABEL: testCompileBatch
+static void testCompileBatch(void) {
+  fprintf(stderr, "testCompileBatch\n");
+  torchMlirRegisterAllPasses();
+  TorchMlirCompilerPool pool = torchMlirCompilerPoolCreate(2);
+  MlirStringRef modules[3] = {
+      mlirStringRefCreateFromCString(
+          "func.func @f(%arg0: !torch.int) -> !torch.int {\n"
+          "  return %arg0 : !torch.int\n"
+          "}\n"),
+      mlirStringRefCreateFromCString("func.func @g("),
+      mlirStringRefCreateFromCString("func.func @h() { return }\n"),
+  };
+  MlirLogicalResult result = torchMlirCompileBatch(
+      pool,
+      mlirStringRefCreateFromCString(
+          "builtin.module(func.func(torch-reduce-op-variants))"),
+      3, modules, printCompileResult, NULL);
+  // CHECK: module 0 bytecode: 1
+  // CHECK: module 1 failed: {{.*}}error:
+  // CHECK: module 2 bytecode: 1
+  fprintf(stderr, "succeeded: %d\n", mlirLogicalResultIsSuccess(result));
+  // CHECK: succeeded: 0
+  torchMlirCompilerPoolDestroy(pool);
+}
+
 int main(void) {
   MlirContext ctx = mlirContextCreate();
   torchMlirRegisterAllDialects(ctx);
   testTypeMetaDataAccessors(ctx);
+  testBlockAppendOperations(ctx);
   mlirContextDestroy(ctx);
+  testCompileBatch();
   return EXIT_SUCCESS;
 }
@@ -7,9 +7,10 @@
 // CHECK-SAME:                               %[[W:.*]]: !torch.vtensor<[1,12,4],f32>,
 // CHECK-SAME:                               %[[R:.*]]: !torch.vtensor<[1,12,3],f32>,
 // CHECK-SAME:                               %[[B:.*]]: !torch.vtensor<[1,24],f32>)
+// CHECK:           %[[XW:.*]] = torch.aten.linear %[[X]], {{.*}} -> !torch.vtensor<[15,2,12],f32>
 // CHECK:           %[[LOOP_RESULT:.*]]:3 = torch.prim.Loop %[[MAX_TRIPS:.*]], %[[ENTER_LOOP:.*]], init(%[[Y:.*]], %[[INITIAL_H:.*]], %[[INITIAL_C:.*]]) {
 // CHECK:           ^bb0(%[[LOOP_INDEX:.*]]: !torch.int, %[[Y_PREV:.*]]: !torch.vtensor<[15,2,3],f32>, %[[H_PREV:.*]]: !torch.vtensor<[2,3],f32>, %[[C_PREV:.*]]: !torch.vtensor<[2,3],f32>):
-// CHECK-DAG:             torch.aten.select.int
+// CHECK-DAG:             torch.aten.select.int %[[XW]], {{.*}}, %[[LOOP_INDEX]] : !torch.vtensor<[15,2,12],f32>, !torch.int, !torch.int -> !torch.vtensor<[2,12],f32>
 // CHECK-DAG:             torch.aten.linear
 // CHECK-DAG:             torch.aten.sigmoid
 // CHECK-DAG:             torch.aten.tanh
@@ -564,6 +564,39 @@ func.func @test_matmul_4d(%arg0: !torch.vtensor<[1,2,3,4],f32>, %arg1: !torch.vt
 
 // -----
 
+// CHECK-LABEL: func.func @test_matmulnbits
+func.func @test_matmulnbits(%arg0: !torch.vtensor<[1,1,8],f32>, %arg1: !torch.vtensor<[2],f32>) -> !torch.vtensor<[1,1,2],f32> attributes {torch.onnx_meta.ir_version = 10 : si64, torch.onnx_meta.opset_version = 21 : si64} {
+  // CHECK: %[[WEIGHTS:.+]] = torch.vtensor.literal(dense<{{\[\[}}1, 2, 3, 4], [5, 6, 7, 8]]> : tensor<2x4xui8>) : !torch.vtensor<[2,4],ui8>
+  // CHECK: %[[SCALES:.+]] = torch.aten.reshape %arg1, {{.*}} -> !torch.vtensor<[2,1,1],f32>
+  // CHECK: %[[ZPS:.+]] = torch.vtensor.literal(dense<8.000000e+00> : tensor<2x1x1xf32>) : !torch.vtensor<[2,1,1],f32>
+  // CHECK: %[[BITS:.+]] = torch.constant.int 4
+  // CHECK: %[[BLOCK_SIZE:.+]] = torch.constant.int 8
+  // CHECK: %[[RESULT:.+]] = torch.operator "quant.matmul_rhs_group_quant"(%arg0, %[[WEIGHTS]], %[[SCALES]], %[[ZPS]], %[[BITS]], %[[BLOCK_SIZE]]) : (!torch.vtensor<[1,1,8],f32>, !torch.vtensor<[2,4],ui8>, !torch.vtensor<[2,1,1],f32>, !torch.vtensor<[2,1,1],f32>, !torch.int, !torch.int) -> !torch.vtensor<[1,1,2],f32>
+  // CHECK: return %[[RESULT]]
+  %0 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<[[[1, 2, 3, 4]], [[5, 6, 7, 8]]]> : tensor<2x1x4xui8>} : () -> !torch.vtensor<[2,1,4],ui8>
+  %1 = torch.operator "onnx.MatMulNBits"(%arg0, %0, %arg1) {torch.onnx.K = 8 : si64, torch.onnx.N = 2 : si64, torch.onnx.bits = 4 : si64, torch.onnx.block_size = 8 : si64} : (!torch.vtensor<[1,1,8],f32>, !torch.vtensor<[2,1,4],ui8>, !torch.vtensor<[2],f32>) -> !torch.vtensor<[1,1,2],f32>
+  return %1 : !torch.vtensor<[1,1,2],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @test_matmulnbits_packed_zero_points_bias
+func.func @test_matmulnbits_packed_zero_points_bias(%arg0: !torch.vtensor<[1,3,16],f16>, %arg1: !torch.vtensor<[2,2],f16>, %arg2: !torch.vtensor<[2],f16>) -> !torch.vtensor<[1,3,2],f16> attributes {torch.onnx_meta.ir_version = 10 : si64, torch.onnx_meta.opset_version = 21 : si64} {
+  // CHECK: %[[WEIGHTS:.+]] = torch.vtensor.literal(dense<{{\[\[}}1, 2, 3, 4, 5, 6, 7, 8], [9, 10, 11, 12, 13, 14, 15, 16]]> : tensor<2x8xui8>) : !torch.vtensor<[2,8],ui8>
+  // CHECK: %[[SCALES:.+]] = torch.aten.reshape %arg1, {{.*}} -> !torch.vtensor<[2,2,1],f16>
+  // CHECK: %[[ZPS:.+]] = torch.vtensor.literal(dense<{{.*}}3.000000e+00{{.*}}5.000000e+00{{.*}}1.000000e+00{{.*}}2.000000e+00{{.*}}> : tensor<2x2x1xf16>) : !torch.vtensor<[2,2,1],f16>
+  // CHECK: %[[RESULT:.+]] = torch.operator "quant.matmul_rhs_group_quant"(%arg0, %[[WEIGHTS]], %[[SCALES]], %[[ZPS]], {{.*}}) : {{.*}} -> !torch.vtensor<[1,3,2],f16>
+  // CHECK: %[[BIAS:.+]] = torch.aten.add.Tensor %[[RESULT]], %arg2, {{.*}} -> !torch.vtensor<[1,3,2],f16>
+  // CHECK: return %[[BIAS]]
+  %none = torch.constant.none
+  %0 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<[[[1, 2, 3, 4], [5, 6, 7, 8]], [[9, 10, 11, 12], [13, 14, 15, 16]]]> : tensor<2x2x4xui8>} : () -> !torch.vtensor<[2,2,4],ui8>
+  %1 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<[83, 33]> : tensor<2xui8>} : () -> !torch.vtensor<[2],ui8>
+  %2 = torch.operator "onnx.MatMulNBits"(%arg0, %0, %arg1, %1, %none, %arg2) {torch.onnx.K = 16 : si64, torch.onnx.N = 2 : si64, torch.onnx.bits = 4 : si64, torch.onnx.block_size = 8 : si64} : (!torch.vtensor<[1,3,16],f16>, !torch.vtensor<[2,2,4],ui8>, !torch.vtensor<[2,2],f16>, !torch.vtensor<[2],ui8>, !torch.none, !torch.vtensor<[2],f16>) -> !torch.vtensor<[1,3,2],f16>
+  return %2 : !torch.vtensor<[1,3,2],f16>
+}
+
+// -----
+
 // CHECK-LABEL: @test_matmulinteger
 func.func @test_matmulinteger(%arg0: !torch.vtensor<[4,3],ui8>, %arg1: !torch.vtensor<[3,2],ui8>, %arg2: !torch.vtensor<[1],ui8>, %arg3: !torch.vtensor<[1],ui8>) -> !torch.vtensor<[4,2],si32> attributes {torch.onnx_meta.ir_version = 5 : si64, torch.onnx_meta.opset_version = 10 : si64, torch.onnx_meta.producer_name = "backend-test", torch.onnx_meta.producer_version = ""} {
   %0 = torch.operator "onnx.MatMulInteger"(%arg0, %arg1, %arg2, %arg3) : (!torch.vtensor<[4,3],ui8>, !torch.vtensor<[3,2],ui8>, !torch.vtensor<[1],ui8>, !torch.vtensor<[1],ui8>) -> !torch.vtensor<[4,2],si32>
@@ -2536,8 +2569,8 @@ func.func @test_group_query_attention(%arg0: !torch.vtensor<[1,1,16],f32>, %arg1
   // CHECK: %[[V_TRANSPOSE:.+]] = torch.aten.transpose.int %[[V_RESHAPE]], {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]], {{.*}}, %[[K_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]], %[[K_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[MASK:.+]] = torch.aten.le.Tensor {{.*}} -> !torch.vtensor<[1,1,1],i1>
   // CHECK: %[[MASK_RESHAPE:.+]] = torch.aten.unsqueeze %[[MASK]], {{.*}} -> !torch.vtensor<[1,1,1,1],i1>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_TRANSPOSE]], %[[K_SCATTER]], %[[V_SCATTER]], %[[MASK_RESHAPE]], {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
@@ -2567,8 +2600,8 @@ func.func @test_group_query_attention_dynamic_seq(%arg0: !torch.vtensor<[1,?,16]
   // CHECK: %[[V_TRANSPOSE:.+]] = torch.aten.transpose.int %[[V_RESHAPE]], {{.*}} -> !torch.vtensor<[1,2,?,8],f32>
   // CHECK: %[[PAD_KEY:.+]] = torch.aten.constant_pad_nd %[[PAST_KEY]], {{.*}} -> !torch.vtensor<[1,2,?,8],f32>
   // CHECK: %[[PAD_VALUE:.+]] = torch.aten.constant_pad_nd %[[PAST_VALUE]], {{.*}} -> !torch.vtensor<[1,2,?,8],f32>
-  // CHECK: %[[PRESENT_KEY:.+]] = torch.aten.scatter.src %[[PAD_KEY]], {{.*}}, %[[K_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,?,8],f32>
-  // CHECK: %[[PRESENT_VALUE:.+]] = torch.aten.scatter.src %[[PAD_VALUE]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,?,8],f32>
+  // CHECK: %[[PRESENT_KEY:.+]] = torch.aten.slice_scatter %[[PAD_KEY]], %[[K_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,?,8],f32>
+  // CHECK: %[[PRESENT_VALUE:.+]] = torch.aten.slice_scatter %[[PAD_VALUE]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,?,8],f32>
   // CHECK: %[[MASK:.+]] = torch.aten.unsqueeze {{.*}} -> !torch.vtensor<[1,1,?,?],i1>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_TRANSPOSE]], %[[PRESENT_KEY]], %[[PRESENT_VALUE]], %[[MASK]], {{.*}} -> !torch.vtensor<[1,2,?,8],f32>
   // CHECK: %[[OUT_TRANSPOSE:.+]] = torch.aten.transpose.int %[[OUTPUT]], {{.*}} -> !torch.vtensor<[1,?,2,8],f32>
@@ -2617,8 +2650,8 @@ func.func @test_group_query_attention_with_rotary_embedding(%query: !torch.vtens
   // CHECK: %[[K_ROTARY:.+]] = torch.onnx.rotary_embedding %[[K_TRANSPOSE]], {{.*}} %arg3, %arg4, {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]], {{.*}}, %[[K_ROTARY]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]], %[[K_ROTARY]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[MASK:.+]] = torch.aten.le.Tensor {{.*}} -> !torch.vtensor<[1,1,1],i1>
   // CHECK: %[[MASK_RESHAPE:.+]] = torch.aten.unsqueeze %[[MASK]], {{.*}} -> !torch.vtensor<[1,1,1,1],i1>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_ROTARY]], %[[K_SCATTER]], %[[V_SCATTER]], %[[MASK_RESHAPE]], {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
@@ -2654,8 +2687,8 @@ func.func @test_group_query_attention_packed_qkv_rotary(%packed_qkv: !torch.vten
   // CHECK: %[[K_ROTARY:.+]] = torch.onnx.rotary_embedding %[[K_TRANSPOSE]], {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd %arg1, {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd %arg2, {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]], {{.*}}, %[[K_ROTARY]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]], %[[K_ROTARY]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_ROTARY]], %[[K_SCATTER]], %[[V_SCATTER]], {{.*}} -> !torch.vtensor<[1,4,1,8],f32>
   %0 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<0> : tensor<1xsi32>} : () -> !torch.vtensor<[1],si32>
   %1 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<1> : tensor<1xsi32>} : () -> !torch.vtensor<[1],si32>
@@ -2706,8 +2739,8 @@ func.func @test_group_query_attention_packed_qkv_no_rotary(%packed_qkv: !torch.v
   // CHECK-NOT: torch.onnx.rotary_embedding
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd %arg1, {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd %arg2, {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]], {{.*}}, %[[K_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]], %[[K_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_TRANSPOSE]], %[[K_SCATTER]], %[[V_SCATTER]], {{.*}} -> !torch.vtensor<[1,4,1,8],f32>
   %0 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<0> : tensor<1xsi32>} : () -> !torch.vtensor<[1],si32>
   %1 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<1> : tensor<1xsi32>} : () -> !torch.vtensor<[1],si32>
@@ -2727,8 +2760,8 @@ func.func @test_group_query_attention_gqa_rotary(%query: !torch.vtensor<[1,1,32]
   // CHECK: %[[K_ROTARY:.+]] = torch.onnx.rotary_embedding %[[K_TRANSPOSE]], {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]], {{.*}}, %[[K_ROTARY]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]], %[[K_ROTARY]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f32>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_ROTARY]], %[[K_SCATTER]], %[[V_SCATTER]], {{.*}} -> !torch.vtensor<[1,4,1,8],f32>
   // CHECK: %[[OUT_TRANSPOSE:.+]] = torch.aten.transpose.int %[[OUTPUT]], {{.*}} -> !torch.vtensor<[1,1,4,8],f32>
   // CHECK: %[[OUT_RESHAPE:.+]] = torch.aten.flatten.using_ints %[[OUT_TRANSPOSE]], {{.*}} -> !torch.vtensor<[1,1,32],f32>
@@ -2752,15 +2785,14 @@ func.func @test_group_query_attention_kv_cache(%query: !torch.vtensor<[1,1,16],f
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd %arg3, {{.*}} -> !torch.vtensor<[1,2,5,8],f32>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd %arg4, {{.*}} -> !torch.vtensor<[1,2,5,8],f32>
   // CHECK: %[[Q_RANGE:.+]] = torch.aten.arange {{.*}} -> !torch.vtensor<[1],si64>
-  // CHECK: %[[PAST_VIEW:.+]] = torch.aten.unsqueeze {{.*}} -> !torch.vtensor<[1,1,1,1],si64>
-  // CHECK: %[[Q_RANGE_4D:.+]] = torch.aten.unsqueeze {{.*}} -> !torch.vtensor<[1,1,1,1],si64>
-  // CHECK: %[[IDX_BASE:.+]] = torch.aten.add.Tensor %[[PAST_VIEW]], %[[Q_RANGE_4D]], {{.*}} -> !torch.vtensor<[1,1,1,1],si64>
-  // CHECK: %[[SCATTER_IDX:.+]] = torch.aten.expand %[[IDX_BASE]], {{.*}} -> !torch.vtensor<[1,2,1,8],si64>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]],
-  // CHECK-SAME: %[[SCATTER_IDX]], %[[K_TRANSPOSE]] :
+  // CHECK: %[[PAST_LEN:.+]] = torch.aten.item {{.*}} -> !torch.int
+  // CHECK: %[[PAST_END:.+]] = torch.aten.add.int %[[PAST_LEN]], {{.*}} -> !torch.int
+  // CHECK-NOT: torch.aten.scatter.src
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]],
+  // CHECK-SAME: %[[K_TRANSPOSE]], %{{.+}}, %[[PAST_LEN]], %[[PAST_END]], %{{.+}} :
   // CHECK-SAME: -> !torch.vtensor<[1,2,5,8],f32>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]],
-  // CHECK-SAME: %[[SCATTER_IDX]], %[[V_TRANSPOSE]] :
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]],
+  // CHECK-SAME: %[[V_TRANSPOSE]], %{{.+}}, %[[PAST_LEN]], %[[PAST_END]], %{{.+}} :
   // CHECK-SAME: -> !torch.vtensor<[1,2,5,8],f32>
   // CHECK: %[[MASK:.+]] = torch.aten.le.Tensor {{.*}} -> !torch.vtensor<[1,1,5],i1>
   // CHECK: %[[MASK_RESHAPE:.+]] = torch.aten.unsqueeze %[[MASK]], {{.*}} -> !torch.vtensor<[1,1,1,5],i1>
@@ -2782,8 +2814,8 @@ func.func @test_group_query_attention_seqlens_k_mask(%query: !torch.vtensor<[1,4
   // CHECK: %[[V_TRANSPOSE:.+]] = torch.aten.transpose.int {{.*}} -> !torch.vtensor<[1,2,4,8],f32>
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd %arg3, {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd %arg4, {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]], {{.*}}, %[[K_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]], %[[K_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
   // CHECK: %[[MASK:.+]] = torch.aten.le.Tensor {{.*}} -> !torch.vtensor<[1,4,7],i1>
   // CHECK: %[[MASK_RESHAPE:.+]] = torch.aten.unsqueeze %[[MASK]], {{.*}} -> !torch.vtensor<[1,1,4,7],i1>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_TRANSPOSE]], %[[K_SCATTER]], %[[V_SCATTER]], %[[MASK_RESHAPE]], {{.*}} -> !torch.vtensor<[1,2,4,8],f32>
@@ -2795,6 +2827,29 @@ func.func @test_group_query_attention_seqlens_k_mask(%query: !torch.vtensor<[1,4
 
 // -----
 
+// Test that the keys and values of a single batch are written as one slice
+// [pastLen, pastLen + seqLen) of the padded cache
+// CHECK-LABEL: func.func @test_group_query_attention_kv_cache_slice
+func.func @test_group_query_attention_kv_cache_slice(%query: !torch.vtensor<[1,4,16],f32>, %key: !torch.vtensor<[1,4,16],f32>, %value: !torch.vtensor<[1,4,16],f32>, %past_key: !torch.vtensor<[1,2,3,8],f32>, %past_value: !torch.vtensor<[1,2,3,8],f32>) -> (!torch.vtensor<[1,4,16],f32>, !torch.vtensor<[1,2,7,8],f32>, !torch.vtensor<[1,2,7,8],f32>) attributes {torch.onnx_meta.ir_version = 10 : si64, torch.onnx_meta.opset_version = 22 : si64, torch.onnx_meta.producer_name = "", torch.onnx_meta.producer_version = ""} {
+  // CHECK: %[[K_TRANSPOSE:.+]] = torch.aten.transpose.int {{.*}} -> !torch.vtensor<[1,2,4,8],f32>
+  // CHECK: %[[V_TRANSPOSE:.+]] = torch.aten.transpose.int {{.*}} -> !torch.vtensor<[1,2,4,8],f32>
+  // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd %arg3, {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
+  // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd %arg4, {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
+  // CHECK: %[[PAST:.+]] = torch.aten.sub.Scalar %{{.+}}, %[[SEQ_LEN:.+]], %{{.+}} :
+  // CHECK: %[[PAST_LEN:.+]] = torch.aten.item %[[PAST]] : !torch.vtensor<[1],si64> -> !torch.int
+  // CHECK: %[[PAST_END:.+]] = torch.aten.add.int %[[PAST_LEN]], %[[SEQ_LEN]] : !torch.int, !torch.int -> !torch.int
+  // CHECK-NOT: torch.aten.expand
+  // CHECK: torch.aten.slice_scatter %[[K_PAD]], %[[K_TRANSPOSE]], %{{.+}}, %[[PAST_LEN]], %[[PAST_END]], %{{.+}} : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
+  // CHECK: torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], %{{.+}}, %[[PAST_LEN]], %[[PAST_END]], %{{.+}} : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
+  // CHECK-NOT: torch.aten.scatter.src
+  %seqlens_k = torch.operator "onnx.Constant"() {torch.onnx.value = dense<6> : tensor<1xsi32>} : () -> !torch.vtensor<[1],si32>
+  %total_seq_len = torch.operator "onnx.Constant"() {torch.onnx.value = dense<7> : tensor<1xsi32>} : () -> !torch.vtensor<[1],si32>
+  %0:3 = torch.operator "onnx.GroupQueryAttention"(%query, %key, %value, %past_key, %past_value, %seqlens_k, %total_seq_len) {torch.onnx.kv_num_heads = 2 : si64, torch.onnx.num_heads = 2 : si64} : (!torch.vtensor<[1,4,16],f32>, !torch.vtensor<[1,4,16],f32>, !torch.vtensor<[1,4,16],f32>, !torch.vtensor<[1,2,3,8],f32>, !torch.vtensor<[1,2,3,8],f32>, !torch.vtensor<[1],si32>, !torch.vtensor<[1],si32>) -> (!torch.vtensor<[1,4,16],f32>, !torch.vtensor<[1,2,7,8],f32>, !torch.vtensor<[1,2,7,8],f32>)
+  return %0#0, %0#1, %0#2 : !torch.vtensor<[1,4,16],f32>, !torch.vtensor<[1,2,7,8],f32>, !torch.vtensor<[1,2,7,8],f32>
+}
+
+// -----
+
 // Test GQA with multi-token prefill (seqLen=2)
 // CHECK-LABEL: func.func @test_group_query_attention_prefill_mask_shape
 func.func @test_group_query_attention_prefill_mask_shape(%query: !torch.vtensor<[1,2,16],f32>, %key: !torch.vtensor<[1,2,16],f32>, %value: !torch.vtensor<[1,2,16],f32>, %past_key: !torch.vtensor<[1,2,3,8],f32>, %past_value: !torch.vtensor<[1,2,3,8],f32>) -> (!torch.vtensor<[1,2,16],f32>, !torch.vtensor<[1,2,5,8],f32>, !torch.vtensor<[1,2,5,8],f32>) attributes {torch.onnx_meta.ir_version = 10 : si64, torch.onnx_meta.opset_version = 22 : si64, torch.onnx_meta.producer_name = "", torch.onnx_meta.producer_version = ""} {
@@ -2803,8 +2858,8 @@ func.func @test_group_query_attention_prefill_mask_shape(%query: !torch.vtensor<
   // CHECK: %[[V_TRANSPOSE:.+]] = torch.aten.transpose.int {{.*}} -> !torch.vtensor<[1,2,2,8],f32>
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd %arg3, {{.*}} -> !torch.vtensor<[1,2,5,8],f32>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd %arg4, {{.*}} -> !torch.vtensor<[1,2,5,8],f32>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]], {{.*}}, %[[K_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,5,8],f32>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,5,8],f32>
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]], %[[K_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,5,8],f32>
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,5,8],f32>
   // CHECK: %[[MASK:.+]] = torch.aten.le.Tensor {{.*}} -> !torch.vtensor<[1,2,5],i1>
   // CHECK: %[[MASK_RESHAPE:.+]] = torch.aten.unsqueeze %[[MASK]], {{.*}} -> !torch.vtensor<[1,1,2,5],i1>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_TRANSPOSE]], %[[K_SCATTER]], %[[V_SCATTER]], %[[MASK_RESHAPE]], {{.*}} -> !torch.vtensor<[1,2,2,8],f32>
@@ -2828,8 +2883,8 @@ func.func @test_group_query_attention_position_ids(%query: !torch.vtensor<[1,4,1
   // CHECK: %[[K_ROTARY:.+]] = torch.onnx.rotary_embedding %[[K_TRANSPOSE]], %[[POS_IDS]], {{.*}} -> !torch.vtensor<[1,2,4,8],f32>
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd %arg3, {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd %arg4, {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]], {{.*}}, %[[K_ROTARY]] : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]], %[[K_ROTARY]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,7,8],f32>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_ROTARY]], %[[K_SCATTER]], %[[V_SCATTER]], {{.*}} -> !torch.vtensor<[1,2,4,8],f32>
   // CHECK: %[[OUT_RESHAPE:.+]] = torch.aten.flatten.using_ints {{.*}} -> !torch.vtensor<[1,4,16],f32>
   %seqlens_k = torch.operator "onnx.Constant"() {torch.onnx.value = dense<6> : tensor<1xsi32>} : () -> !torch.vtensor<[1],si32>
@@ -2848,8 +2903,8 @@ func.func @test_group_query_attention_f16(%arg0: !torch.vtensor<[1,1,16],f16>, %
   // CHECK: %[[V_TRANSPOSE:.+]] = torch.aten.transpose.int {{.*}} -> !torch.vtensor<[1,2,1,8],f16>
   // CHECK: %[[K_PAD:.+]] = torch.aten.constant_pad_nd {{.*}} -> !torch.vtensor<[1,2,1,8],f16>
   // CHECK: %[[V_PAD:.+]] = torch.aten.constant_pad_nd {{.*}} -> !torch.vtensor<[1,2,1,8],f16>
-  // CHECK: %[[K_SCATTER:.+]] = torch.aten.scatter.src %[[K_PAD]], {{.*}}, %[[K_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f16>
-  // CHECK: %[[V_SCATTER:.+]] = torch.aten.scatter.src %[[V_PAD]], {{.*}}, %[[V_TRANSPOSE]] : {{.*}} -> !torch.vtensor<[1,2,1,8],f16>
+  // CHECK: %[[K_SCATTER:.+]] = torch.aten.slice_scatter %[[K_PAD]], %[[K_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f16>
+  // CHECK: %[[V_SCATTER:.+]] = torch.aten.slice_scatter %[[V_PAD]], %[[V_TRANSPOSE]], {{.*}} : {{.*}} -> !torch.vtensor<[1,2,1,8],f16>
   // CHECK: %[[MASK:.+]] = torch.aten.le.Tensor {{.*}} -> !torch.vtensor<[1,1,1],i1>
   // CHECK: %[[MASK_RESHAPE:.+]] = torch.aten.unsqueeze %[[MASK]], {{.*}} -> !torch.vtensor<[1,1,1,1],i1>
   // CHECK: %[[OUTPUT:.+]] = torch.aten.scaled_dot_product_attention %[[Q_TRANSPOSE]], %[[K_SCATTER]], %[[V_SCATTER]], %[[MASK_RESHAPE]], {{.*}} -> !torch.vtensor<[1,2,1,8],f16>
@@ -3020,19 +3020,51 @@ func.func @test_sequence_map_extract_shapes(%arg0: !torch.list<vtensor<[?,?,?],f
 // -----
 
 // CHECK-LABEL: func.func @test_shape_start_1_end_negative_1
-func.func @test_shape_start_1_end_negative_1(%arg0: !torch.vtensor<[3,4,5],f32>) -> !torch.vtensor<[1],si64> attributes {torch.onnx_meta.ir_version = 10 : si64, torch.onnx_meta.opset_version = 21 : si64} {
+func.func @test_shape_start_1_end_negative_1(%arg0: !torch.vtensor<[?,4,5],f32>) -> !torch.vtensor<[1],si64> attributes {torch.onnx_meta.ir_version = 10 : si64, torch.onnx_meta.opset_version = 21 : si64} {
   // CHECK: %[[SHAPE:.+]] = torch.aten._shape_as_tensor %arg0
   // CHECK: %[[INT1_0:.+]] = torch.constant.int 1
   // CHECK: %[[INT2_0:.+]] = torch.constant.int -1
   // CHECK: %[[INT1_1:.+]] = torch.constant.int 1
   // CHECK: %[[INT0_0:.+]] = torch.constant.int 0
   // CHECK: %[[SLICE:.+]] = torch.aten.slice.Tensor %[[SHAPE]], %[[INT0_0]], %[[INT1_0]], %[[INT2_0]], %[[INT1_1]]
-  %0 = torch.operator "onnx.Shape"(%arg0) {torch.onnx.end = -1 : si64, torch.onnx.start = 1 : si64} : (!torch.vtensor<[3,4,5],f32>) -> !torch.vtensor<[1],si64>
+  %0 = torch.operator "onnx.Shape"(%arg0) {torch.onnx.end = -1 : si64, torch.onnx.start = 1 : si64} : (!torch.vtensor<[?,4,5],f32>) -> !torch.vtensor<[1],si64>
   return %0 : !torch.vtensor<[1],si64>
 }
 
 // -----
 
+// CHECK-LABEL: func.func @test_shape_static
+func.func @test_shape_static(%arg0: !torch.vtensor<[3,4,5],f32>) -> !torch.vtensor<[2],si64> attributes {torch.onnx_meta.ir_version = 10 : si64, torch.onnx_meta.opset_version = 21 : si64} {
+  // CHECK: %[[SHAPE:.+]] = torch.vtensor.literal(dense<[4, 5]> : tensor<2xsi64>) : !torch.vtensor<[2],si64>
+  // CHECK-NOT: torch.aten._shape_as_tensor
+  // CHECK: return %[[SHAPE]]
+  %0 = torch.operator "onnx.Shape"(%arg0) {torch.onnx.start = 1 : si64} : (!torch.vtensor<[3,4,5],f32>) -> !torch.vtensor<[2],si64>
+  return %0 : !torch.vtensor<[2],si64>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @test_reshape_static_shape_computation
+func.func @test_reshape_static_shape_computation(%arg0: !torch.vtensor<[2,3,4],f32>) -> !torch.vtensor<[?,?],f32> attributes {torch.onnx_meta.ir_version = 10 : si64, torch.onnx_meta.opset_version = 21 : si64} {
+  // CHECK-NOT: torch.aten._shape_as_tensor
+  // CHECK-NOT: torch.aten.cat
+  // CHECK-DAG: %[[INT2:.+]] = torch.constant.int 2
+  // CHECK-DAG: %[[INT_NEG1:.+]] = torch.constant.int -1
+  // CHECK: %[[SIZES:.+]] = torch.prim.ListConstruct %[[INT2]], %[[INT_NEG1]] : (!torch.int, !torch.int) -> !torch.list<int>
+  // CHECK: torch.aten.reshape %arg0, %[[SIZES]] : !torch.vtensor<[2,3,4],f32>, !torch.list<int> -> !torch.vtensor<[?,?],f32>
+  %0 = torch.operator "onnx.Shape"(%arg0) : (!torch.vtensor<[2,3,4],f32>) -> !torch.vtensor<[3],si64>
+  %1 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<0> : tensor<si64>} : () -> !torch.vtensor<[],si64>
+  %2 = torch.operator "onnx.Gather"(%0, %1) {torch.onnx.axis = 0 : si64} : (!torch.vtensor<[3],si64>, !torch.vtensor<[],si64>) -> !torch.vtensor<[],si64>
+  %3 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<0> : tensor<1xsi64>} : () -> !torch.vtensor<[1],si64>
+  %4 = torch.operator "onnx.Unsqueeze"(%2, %3) : (!torch.vtensor<[],si64>, !torch.vtensor<[1],si64>) -> !torch.vtensor<[1],si64>
+  %5 = torch.operator "onnx.Constant"() {torch.onnx.value = dense<-1> : tensor<1xsi64>} : () -> !torch.vtensor<[1],si64>
+  %6 = torch.operator "onnx.Concat"(%4, %5) {torch.onnx.axis = 0 : si64} : (!torch.vtensor<[1],si64>, !torch.vtensor<[1],si64>) -> !torch.vtensor<[2],si64>
+  %7 = torch.operator "onnx.Reshape"(%arg0, %6) : (!torch.vtensor<[2,3,4],f32>, !torch.vtensor<[2],si64>) -> !torch.vtensor<[?,?],f32>
+  return %7 : !torch.vtensor<[?,?],f32>
+}
+
+// -----
+
 // CHECK-LABEL: func.func @test_shape_scalar
 func.func @test_shape_scalar(%arg0: !torch.vtensor<[],si64> ) -> !torch.vtensor<[?],si64>  attributes {torch.onnx_meta.ir_version = 8 : si64, torch.onnx_meta.opset_version = 17 : si64, torch.onnx_meta.producer_name = "pytorch", torch.onnx_meta.producer_version = "2.1.0"} {
   // CHECK: %[[SHAPE:.+]] = torch.aten._shape_as_tensor %arg0 : !torch.vtensor<[],si64> -> !torch.vtensor<[0],si64>
@@ -1,5 +1,6 @@
 // RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -verify-diagnostics | FileCheck %s
 // RUN: torch-mlir-opt <%s -convert-torch-to-linalg=allow-non-finites=false -split-input-file -verify-diagnostics | FileCheck %s -check-prefix=UNSUPPORTED-NON-FINITES
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg=transposed-matmul-operands=true -split-input-file -verify-diagnostics | FileCheck %s -check-prefix=TRANSPOSED-OPERANDS
 
 
 // CHECK-LABEL:   func.func @torch.aten.mm$basic(
@@ -61,6 +62,74 @@ func.func @torch.aten.matmul.4d(%arg0: !torch.vtensor<[1,2,32,400],f32>, %arg1:
 
 // -----
 
+// CHECK-LABEL: func.func @torch.aten.matmul$t_weight
+// CHECK-DAG:  %[[LHS:.+]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[4,8],f32> -> tensor<4x8xf32>
+// CHECK-DAG:  %[[RHS:.+]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[16,8],f32> -> tensor<16x8xf32>
+// CHECK-NOT:  linalg.transpose
+// CHECK:      linalg.matmul
+// CHECK-SAME:   indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d2)>, affine_map<(d0, d1, d2) -> (d1, d2)>, affine_map<(d0, d1, d2) -> (d0, d1)>]
+// CHECK-SAME:   ins(%[[LHS]], %[[RHS]] : tensor<4x8xf32>, tensor<16x8xf32>) outs(%{{.*}} : tensor<4x16xf32>)
+func.func @torch.aten.matmul$t_weight(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[16,8],f32>) -> !torch.vtensor<[4,16],f32> {
+  %0 = torch.aten.t %arg1 : !torch.vtensor<[16,8],f32> -> !torch.vtensor<[8,16],f32>
+  %1 = torch.aten.matmul %arg0, %0 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,16],f32> -> !torch.vtensor<[4,16],f32>
+  return %1 : !torch.vtensor<[4,16],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.matmul$batched_t_weight
+// CHECK-DAG:  %[[LHS:.+]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[?,4,8],f32> -> tensor<?x4x8xf32>
+// CHECK-DAG:  %[[RHS:.+]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[16,8],f32> -> tensor<16x8xf32>
+// CHECK:      %[[ROWS:.+]] = tensor.collapse_shape %[[LHS]] {{\[\[}}0, 1], [2]] : tensor<?x4x8xf32> into tensor<?x8xf32>
+// CHECK-NOT:  linalg.transpose
+// CHECK:      %[[MATMUL:.+]] = linalg.matmul
+// CHECK-SAME:   indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d2)>, affine_map<(d0, d1, d2) -> (d1, d2)>, affine_map<(d0, d1, d2) -> (d0, d1)>]
+// CHECK-SAME:   ins(%[[ROWS]], %[[RHS]] : tensor<?x8xf32>, tensor<16x8xf32>) outs(%{{.*}} : tensor<?x16xf32>)
+// CHECK:      tensor.expand_shape %[[MATMUL]] {{\[\[}}0, 1], [2]] output_shape [%{{.*}}, 4, 16] : tensor<?x16xf32> into tensor<?x4x16xf32>
+func.func @torch.aten.matmul$batched_t_weight(%arg0: !torch.vtensor<[?,4,8],f32>, %arg1: !torch.vtensor<[16,8],f32>) -> !torch.vtensor<[?,4,16],f32> {
+  %0 = torch.aten.t %arg1 : !torch.vtensor<[16,8],f32> -> !torch.vtensor<[8,16],f32>
+  %1 = torch.aten.matmul %arg0, %0 : !torch.vtensor<[?,4,8],f32>, !torch.vtensor<[8,16],f32> -> !torch.vtensor<[?,4,16],f32>
+  return %1 : !torch.vtensor<[?,4,16],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.matmul$batched_weight
+// CHECK-DAG:  %[[LHS:.+]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[2,4,8],f32> -> tensor<2x4x8xf32>
+// CHECK-DAG:  %[[RHS:.+]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[8,16],f32> -> tensor<8x16xf32>
+// CHECK:      %[[ROWS:.+]] = tensor.collapse_shape %[[LHS]] {{\[\[}}0, 1], [2]] : tensor<2x4x8xf32> into tensor<8x8xf32>
+// CHECK-NOT:  linalg.broadcast
+// CHECK:      %[[MATMUL:.+]] = linalg.matmul ins(%[[ROWS]], %[[RHS]] : tensor<8x8xf32>, tensor<8x16xf32>) outs(%{{.*}} : tensor<8x16xf32>)
+// CHECK:      tensor.expand_shape %[[MATMUL]] {{\[\[}}0, 1], [2]] output_shape [2, 4, 16] : tensor<8x16xf32> into tensor<2x4x16xf32>
+func.func @torch.aten.matmul$batched_weight(%arg0: !torch.vtensor<[2,4,8],f32>, %arg1: !torch.vtensor<[8,16],f32>) -> !torch.vtensor<[2,4,16],f32> {
+  %0 = torch.aten.matmul %arg0, %arg1 : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[8,16],f32> -> !torch.vtensor<[2,4,16],f32>
+  return %0 : !torch.vtensor<[2,4,16],f32>
+}
+
+// -----
+
+// CHECK-DAG:  #[[$LHS_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4) -> (0, d2, d3)>
+// CHECK-DAG:  #[[$RHS_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d3, d4)>
+// CHECK-DAG:  #[[$OUT_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2, d4)>
+// CHECK-LABEL: func.func @torch.aten.matmul$broadcast_batch
+// CHECK-DAG:  %[[LHS:.+]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[1,4,8],si8> -> tensor<1x4x8xi8>
+// CHECK-DAG:  %[[RHS:.+]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[?,3,8,16],si8> -> tensor<?x3x8x16xi8>
+// CHECK-NOT:  linalg.broadcast
+// CHECK:      linalg.generic
+// CHECK-SAME:   indexing_maps = [#[[$LHS_MAP]], #[[$RHS_MAP]], #[[$OUT_MAP]]]
+// CHECK-SAME:   iterator_types = ["parallel", "parallel", "parallel", "reduction", "parallel"]
+// CHECK-SAME:   ins(%[[LHS]], %[[RHS]] : tensor<1x4x8xi8>, tensor<?x3x8x16xi8>) outs(%{{.*}} : tensor<?x3x4x16xi32>)
+// CHECK:        arith.extsi
+// CHECK:        arith.extsi
+// CHECK:        arith.muli
+// CHECK:        arith.addi
+func.func @torch.aten.matmul$broadcast_batch(%arg0: !torch.vtensor<[1,4,8],si8>, %arg1: !torch.vtensor<[?,3,8,16],si8>) -> !torch.vtensor<[?,3,4,16],si32> {
+  %0 = torch.aten.matmul %arg0, %arg1 : !torch.vtensor<[1,4,8],si8>, !torch.vtensor<[?,3,8,16],si8> -> !torch.vtensor<[?,3,4,16],si32>
+  return %0 : !torch.vtensor<[?,3,4,16],si32>
+}
+
+// -----
+
 // CHECK-LABEL: func.func @torch.aten.matmul$dot_f16
 // CHECK:      %[[ZERO:.+]] = arith.constant 0.000000e+00 : f32
 // CHECK:      linalg.dot ins(%{{.*}}, %{{.*}} : tensor<4xf16>, tensor<4xf16>) outs(%{{.*}} : tensor<f32>) -> tensor<f32>
@@ -190,6 +259,29 @@ func.func @torch.aten.mm$basic_strict(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !
 
 // -----
 
+// CHECK-LABEL: func.func @torch.aten.mm$transposed_rhs(
+// CHECK:         %[[TRANSPOSED:.*]] = linalg.transpose
+// CHECK:         linalg.matmul ins(%{{.*}}, %[[TRANSPOSED]] : tensor<4x8xf32>, tensor<8x16xf32>)
+// CHECK-NOT:       indexing_maps
+// TRANSPOSED-OPERANDS-LABEL: func.func @torch.aten.mm$transposed_rhs(
+// TRANSPOSED-OPERANDS-SAME:      %[[LHS_VTENSOR:.*]]: !torch.vtensor<[4,8],f32>, %[[RHS_VTENSOR:.*]]: !torch.vtensor<[16,8],f32>)
+// TRANSPOSED-OPERANDS-DAG:     %[[LHS:.*]] = torch_c.to_builtin_tensor %[[LHS_VTENSOR]] : !torch.vtensor<[4,8],f32> -> tensor<4x8xf32>
+// TRANSPOSED-OPERANDS-DAG:     %[[RHS:.*]] = torch_c.to_builtin_tensor %[[RHS_VTENSOR]] : !torch.vtensor<[16,8],f32> -> tensor<16x8xf32>
+// TRANSPOSED-OPERANDS:         linalg.matmul
+// TRANSPOSED-OPERANDS-SAME:      indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d2)>, affine_map<(d0, d1, d2) -> (d1, d2)>, affine_map<(d0, d1, d2) -> (d0, d1)>]
+// TRANSPOSED-OPERANDS-SAME:      ins(%[[LHS]], %[[RHS]] : tensor<4x8xf32>, tensor<16x8xf32>) outs(%{{.*}} : tensor<4x16xf32>)
+func.func @torch.aten.mm$transposed_rhs(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[16,8],f32>) -> !torch.vtensor<[4,16],f32>
+  attributes {torch.assume_strict_symbolic_shapes}
+{
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.transpose.int %arg1, %int0, %int1 : !torch.vtensor<[16,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[8,16],f32>
+  %1 = torch.aten.mm %arg0, %0 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,16],f32> -> !torch.vtensor<[4,16],f32>
+  return %1 : !torch.vtensor<[4,16],f32>
+}
+
+// -----
+
 // CHECK-LABEL: func.func @torch.aten.mm$basic_unsigned(
 // CHECK: linalg.matmul {cast = #linalg.type_fn<cast_unsigned>}
 func.func @torch.aten.mm$basic_unsigned(%arg0: !torch.vtensor<[?,?],ui32>, %arg1: !torch.vtensor<[?,?],ui32>) -> !torch.vtensor<[?,2],ui32>
@@ -392,7 +484,9 @@ func.func @torch.prim.NumToTensor.Scalar$basic(%arg0: !torch.int) -> !torch.vten
 // CHECK:       %[[F64:.*]] = torch_c.to_f64 %{{.*}}
 // CHECK:       %[[TRUNC:.*]] = arith.truncf %[[F64]] : f64 to bf16
 // CHECK:       %[[EMPTY:.*]] = tensor.empty(%{{.*}}, %{{.*}}) : tensor<?x?xbf16>
-// CHECK:       %[[FILLED:.*]] = linalg.fill ins(%[[TRUNC]] : bf16) outs(%[[EMPTY]] : tensor<?x?xbf16>) -> tensor<?x?xbf16>
+// CHECK:       %[[FILLED:.*]] = linalg.generic {{.*}} outs(%[[EMPTY]] : tensor<?x?xbf16>) {
+// CHECK-NEXT:  ^bb0(%{{.*}}: bf16):
+// CHECK-NEXT:    linalg.yield %[[TRUNC]] : bf16
 func.func @torch.aten.full$bf16$f_to_f(%dim0: !torch.int, %dim1: !torch.int, %fill: !torch.float) -> !torch.vtensor<[?,?],bf16> {
   %none = torch.constant.none
   %0 = torch.prim.ListConstruct %dim0, %dim1 : (!torch.int, !torch.int) -> !torch.list<int>
@@ -405,7 +499,9 @@ func.func @torch.aten.full$bf16$f_to_f(%dim0: !torch.int, %dim1: !torch.int, %fi
 // CHECK-LABEL: func.func @torch.aten.full$bf16$si_to_f
 // CHECK:       %[[SITOFP:.*]] = arith.sitofp %{{.*}} : i64 to bf16
 // CHECK:       %[[EMPTY:.*]] = tensor.empty(%{{.*}}, %{{.*}}) : tensor<?x?xbf16>
-// CHECK:       %[[FILLED:.*]] = linalg.fill ins(%[[SITOFP]] : bf16) outs(%[[EMPTY]] : tensor<?x?xbf16>) -> tensor<?x?xbf16>
+// CHECK:       %[[FILLED:.*]] = linalg.generic {{.*}} outs(%[[EMPTY]] : tensor<?x?xbf16>) {
+// CHECK-NEXT:  ^bb0(%{{.*}}: bf16):
+// CHECK-NEXT:    linalg.yield %[[SITOFP]] : bf16
 func.func @torch.aten.full$bf16$si_to_f(%dim0: !torch.int, %dim1: !torch.int, %fill: !torch.int) -> !torch.vtensor<[?,?],bf16> {
   %none = torch.constant.none
   %0 = torch.prim.ListConstruct %dim0, %dim1 : (!torch.int, !torch.int) -> !torch.list<int>
@@ -419,7 +515,9 @@ func.func @torch.aten.full$bf16$si_to_f(%dim0: !torch.int, %dim1: !torch.int, %f
 // CHECK:       %[[F64:.*]] = torch_c.to_f64 %{{.*}}
 // CHECK:       %[[FPTOSI:.*]] = arith.fptosi %[[F64]] : f64 to i32
 // CHECK:       %[[EMPTY:.*]] = tensor.empty(%{{.*}}, %{{.*}}) : tensor<?x?xi32>
-// CHECK:       %[[FILLED:.*]] = linalg.fill ins(%[[FPTOSI]] : i32) outs(%[[EMPTY]] : tensor<?x?xi32>) -> tensor<?x?xi32>
+// CHECK:       %[[FILLED:.*]] = linalg.generic {{.*}} outs(%[[EMPTY]] : tensor<?x?xi32>) {
+// CHECK-NEXT:  ^bb0(%{{.*}}: i32):
+// CHECK-NEXT:    linalg.yield %[[FPTOSI]] : i32
 func.func @torch.aten.full$si32$f_to_si(%dim0: !torch.int, %dim1: !torch.int, %fill: !torch.float) -> !torch.vtensor<[?,?],si32> {
   %none = torch.constant.none
   %0 = torch.prim.ListConstruct %dim0, %dim1 : (!torch.int, !torch.int) -> !torch.list<int>
@@ -433,7 +531,9 @@ func.func @torch.aten.full$si32$f_to_si(%dim0: !torch.int, %dim1: !torch.int, %f
 // CHECK:       %[[F64:.*]] = torch_c.to_f64 %{{.*}}
 // CHECK:       %[[TRUNC:.*]] = arith.truncf %[[F64]] : f64 to f32
 // CHECK:       %[[EMPTY:.*]] = tensor.empty() : tensor<2048x7168xf32>
-// CHECK:       %[[FILLED:.*]] = linalg.fill ins(%[[TRUNC]] : f32) outs(%[[EMPTY]] : tensor<2048x7168xf32>) -> tensor<2048x7168xf32>
+// CHECK:       %[[FILLED:.*]] = linalg.generic {{.*}} outs(%[[EMPTY]] : tensor<2048x7168xf32>) {
+// CHECK-NEXT:  ^bb0(%{{.*}}: f32):
+// CHECK-NEXT:    linalg.yield %[[TRUNC]] : f32
 func.func @torch.aten.full$f32$truncf() -> !torch.vtensor<[2048,7168],f32> {
   %float0.000000e00 = torch.constant.float 0.000000e+00
   %none = torch.constant.none
@@ -446,6 +546,26 @@ func.func @torch.aten.full$f32$truncf() -> !torch.vtensor<[2048,7168],f32> {
 
 // -----
 
+// CHECK-LABEL: func.func @torch.aten.zeros$fused_into_consumers
+// CHECK-NOT:   linalg.fill
+// CHECK:       %[[ZERO:.*]] = arith.constant 0.000000e+00 : f32
+// CHECK:       %[[EMPTY:.*]] = tensor.empty({{.*}}) : tensor<[[TYPE:.*]]>
+// CHECK:       %[[ZEROS:.*]] = linalg.generic {indexing_maps = [#{{.*}}], iterator_types = ["parallel", "parallel"]} outs(%[[EMPTY]] : tensor<[[TYPE]]>) {
+// CHECK-NEXT:  ^bb0(%{{.*}}: f32):
+// CHECK-NEXT:    linalg.yield %[[ZERO]] : f32
+// CHECK-NEXT:  } -> tensor<[[TYPE]]>
+// CHECK-NOT:   linalg.fill
+func.func @torch.aten.zeros$fused_into_consumers() -> !torch.vtensor<[3,4],f32> {
+  %none = torch.constant.none
+  %int3 = torch.constant.int 3
+  %int4 = torch.constant.int 4
+  %0 = torch.prim.ListConstruct %int3, %int4 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.zeros %0, %none, %none, %none, %none : !torch.list<int>, !torch.none, !torch.none, !torch.none, !torch.none -> !torch.vtensor<[3,4],f32>
+  return %1 : !torch.vtensor<[3,4],f32>
+}
+
+// -----
+
 // CHECK-LABEL:   func.func @torch.tensor_static_info_cast$basic(
 // CHECK-SAME:                                              %[[VALUE_T:.*]]: !torch.vtensor<[?],f32>) -> !torch.vtensor<[4],f32> {
 // CHECK:           %[[T:.*]] = torch_c.to_builtin_tensor %[[VALUE_T]] : !torch.vtensor<[?],f32> -> tensor<?xf32>
@@ -941,26 +1061,16 @@ func.func @test_rotary_embedding_rank3_with_scale(%arg0: !torch.vtensor<[1,2,6],
 // -----
 
 // CHECK-LABEL: func.func @torch.ops.aten.replication_pad3d$basic(
-// CHECK-SAME: %[[ARG_0:.*]]: !torch.vtensor<[4,3,5],f32>) -> !torch.vtensor<[7,7,6],f32>
+// CHECK-SAME: %[[ARG0:.*]]: !torch.vtensor<[4,3,5],f32>) -> !torch.vtensor<[7,7,6],f32>
 // CHECK: %[[T0:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[4,3,5],f32> -> tensor<4x3x5xf32>
-// CHECK-DAG: %[[INT0:.*]] = torch.constant.int 0
-// CHECK-DAG: %[[INT1:.*]] = torch.constant.int 1
-// CHECK-DAG: %[[INT3:.*]] = torch.constant.int 3
-// CHECK: %[[IDX5:.*]] = arith.constant 5 : index
-// CHECK: %[[IDX1:.*]] = arith.constant 1 : index
-// CHECK: %[[SUB2:.*]] = arith.subi %[[IDX5]], %[[IDX1]] : index
-// CHECK: %[[SLICE1:.*]] = tensor.extract_slice %[[T0]][0, 0, %[[SUB2]]] [4, 3, 1] [1, 1, 1] : tensor<4x3x5xf32> to tensor<4x3x1xf32>
-// CHECK: %[[CONCAT1:.*]] = tensor.concat dim(2) %[[T0]], %[[SLICE1]] : (tensor<4x3x5xf32>, tensor<4x3x1xf32>) -> tensor<4x3x6xf32>
-// CHECK: %[[SLICE2:.*]] = tensor.extract_slice %[[CONCAT1]][0, 0, 0] [4, 1, 6] [1, 1, 1] : tensor<4x3x6xf32> to tensor<4x1x6xf32>
-// CHECK: %[[CONCAT2:.*]] = tensor.concat dim(1) %[[SLICE2]], %[[SLICE2]], %[[SLICE2]] : (tensor<4x1x6xf32>, tensor<4x1x6xf32>, tensor<4x1x6xf32>) -> tensor<4x3x6xf32>
-// CHECK: %[[SUB3:.*]] = arith.subi {{.*}}, {{.*}} : index
-// CHECK: %[[SLICE3:.*]] = tensor.extract_slice %[[CONCAT1]][0, %[[SUB3]], 0] [4, 1, 6] [1, 1, 1] : tensor<4x3x6xf32> to tensor<4x1x6xf32>
-// CHECK: %[[CONCAT3:.*]] = tensor.concat dim(1) %[[CONCAT2]], %[[CONCAT1]], %[[SLICE3]] : (tensor<4x3x6xf32>, tensor<4x3x6xf32>, tensor<4x1x6xf32>) -> tensor<4x7x6xf32>
-// CHECK: %[[SUB4:.*]] = arith.subi {{.*}}, {{.*}} : index
-// CHECK: %[[SLICE4:.*]] = tensor.extract_slice %[[CONCAT3]][%[[SUB4]], 0, 0] [1, 7, 6] [1, 1, 1] : tensor<4x7x6xf32> to tensor<1x7x6xf32>
-// CHECK: %[[CONCAT4:.*]] = tensor.concat dim(0) %[[SLICE4]], %[[SLICE4]], %[[SLICE4]] : (tensor<1x7x6xf32>, tensor<1x7x6xf32>, tensor<1x7x6xf32>) -> tensor<3x7x6xf32>
-// CHECK: %[[CONCAT5:.*]] = tensor.concat dim(0) %[[CONCAT3]], %[[CONCAT4]] : (tensor<4x7x6xf32>, tensor<3x7x6xf32>) -> tensor<7x7x6xf32>
-// CHECK: %[[CAST:.*]] = tensor.cast %[[CONCAT5]] : tensor<7x7x6xf32> to tensor<7x7x6xf32>
+// CHECK-NOT: tensor.concat
+// CHECK: %[[EMPTY:.*]] = tensor.empty() : tensor<7x7x6xf32>
+// CHECK: %[[PADDED:.*]] = linalg.generic {{.*}} outs(%[[EMPTY]] : tensor<7x7x6xf32>)
+// CHECK-COUNT-3: arith.minsi
+// CHECK: tensor.extract %[[T0]]
+// CHECK: } -> tensor<7x7x6xf32>
+// CHECK-NOT: tensor.concat
+// CHECK: %[[CAST:.*]] = tensor.cast %[[PADDED]] : tensor<7x7x6xf32> to tensor<7x7x6xf32>
 // CHECK: %[[OUT:.*]] = torch_c.from_builtin_tensor %[[CAST]] : tensor<7x7x6xf32> -> !torch.vtensor<[7,7,6],f32>
 // CHECK: return %[[OUT]] : !torch.vtensor<[7,7,6],f32>
 func.func @torch.ops.aten.replication_pad3d$basic(%arg0: !torch.vtensor<[4,3,5],f32>) -> !torch.vtensor<[7,7,6],f32> {
@@ -976,20 +1086,18 @@ func.func @torch.ops.aten.replication_pad3d$basic(%arg0: !torch.vtensor<[4,3,5],
 
 // CHECK-LABEL: func.func @torch.ops.aten.replication_pad2d$basic
 // CHECK: [[TENSOR:%.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[4,3,5],f32> -> tensor<4x3x5xf32>
-// CHECK: [[INT1:%.*]] = torch.constant.int 1
-// CHECK: [[INT3:%.*]] = torch.constant.int 3
-// CHECK: [[PAD_LIST:%.*]] = torch.prim.ListConstruct [[INT1]], [[INT3]], [[INT1]], [[INT3]] : (!torch.int, !torch.int, !torch.int, !torch.int) -> !torch.list<int>
-// CHECK: [[SLICE_LEFT:%.*]] = tensor.extract_slice [[TENSOR]][0, 0, 0] [4, 3, 1] [1, 1, 1] : tensor<4x3x5xf32> to tensor<4x3x1xf32>
-// CHECK: [[IDX_RIGHT:%.*]] = arith.subi %c5_5, %c1_6 : index
-// CHECK: [[SLICE_RIGHT:%.*]] = tensor.extract_slice [[TENSOR]][0, 0, [[IDX_RIGHT]]] [4, 3, 1] [1, 1, 1] : tensor<4x3x5xf32> to tensor<4x3x1xf32>
-// CHECK: [[RIGHT_PAD:%.*]] = tensor.concat dim(2) [[SLICE_RIGHT]], [[SLICE_RIGHT]], [[SLICE_RIGHT]] : (tensor<4x3x1xf32>, tensor<4x3x1xf32>, tensor<4x3x1xf32>) -> tensor<4x3x3xf32>
-// CHECK: [[PADDED_W:%.*]] = tensor.concat dim(2) [[SLICE_LEFT]], [[TENSOR]], [[RIGHT_PAD]] : (tensor<4x3x1xf32>, tensor<4x3x5xf32>, tensor<4x3x3xf32>) -> tensor<4x3x9xf32>
-// CHECK: [[SLICE_TOP:%.*]] = tensor.extract_slice [[PADDED_W]][0, 0, 0] [4, 1, 9] [1, 1, 1] : tensor<4x3x9xf32> to tensor<4x1x9xf32>
-// CHECK: [[IDX_BOTTOM:%.*]] = arith.subi %c3_18, %c1_21 : index
-// CHECK: [[SLICE_BOTTOM:%.*]] = tensor.extract_slice [[PADDED_W]][0, [[IDX_BOTTOM]], 0] [4, 1, 9] [1, 1, 1] : tensor<4x3x9xf32> to tensor<4x1x9xf32>
-// CHECK: [[BOTTOM_PAD:%.*]] = tensor.concat dim(1) [[SLICE_BOTTOM]], [[SLICE_BOTTOM]], [[SLICE_BOTTOM]] : (tensor<4x1x9xf32>, tensor<4x1x9xf32>, tensor<4x1x9xf32>) -> tensor<4x3x9xf32>
-// CHECK: [[PADDED_HW:%.*]] = tensor.concat dim(1) [[SLICE_TOP]], [[PADDED_W]], [[BOTTOM_PAD]] : (tensor<4x1x9xf32>, tensor<4x3x9xf32>, tensor<4x3x9xf32>) -> tensor<4x7x9xf32>
-// CHECK: [[CAST:%.*]] = tensor.cast [[PADDED_HW]] : tensor<4x7x9xf32> to tensor<4x7x9xf32>
+// CHECK-NOT: tensor.concat
+// CHECK: [[EMPTY:%.*]] = tensor.empty() : tensor<4x7x9xf32>
+// CHECK: [[PADDED:%.*]] = linalg.generic {{.*}} outs([[EMPTY]] : tensor<4x7x9xf32>)
+// CHECK: [[IDX0:%.*]] = linalg.index 0 : index
+// CHECK: [[IDX1:%.*]] = linalg.index 1 : index
+// CHECK: [[ROW:%.*]] = arith.minsi
+// CHECK: [[IDX2:%.*]] = linalg.index 2 : index
+// CHECK: [[COL:%.*]] = arith.minsi
+// CHECK: [[VALUE:%.*]] = tensor.extract [[TENSOR]]{{\[}}[[IDX0]], [[ROW]], [[COL]]] : tensor<4x3x5xf32>
+// CHECK: linalg.yield [[VALUE]] : f32
+// CHECK: } -> tensor<4x7x9xf32>
+// CHECK: [[CAST:%.*]] = tensor.cast [[PADDED]] : tensor<4x7x9xf32> to tensor<4x7x9xf32>
 // CHECK: [[TORCH_TENSOR:%.*]] = torch_c.from_builtin_tensor [[CAST]] : tensor<4x7x9xf32> -> !torch.vtensor<[4,7,9],f32>
 // CHECK: return [[TORCH_TENSOR]] : !torch.vtensor<[4,7,9],f32>
 func.func @torch.ops.aten.replication_pad2d$basic(%arg0: !torch.vtensor<[4,3,5],f32>) -> !torch.vtensor<[4,7,9],f32> {
@@ -1005,23 +1113,23 @@ func.func @torch.ops.aten.replication_pad2d$basic(%arg0: !torch.vtensor<[4,3,5],
 
 // CHECK-LABEL: func.func @torch.ops.aten.replication_pad1d$basic
 // CHECK: [[TENSOR:%.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[3,5],f32> -> tensor<3x5xf32>
-// CHECK: [[INT1:%.*]] = torch.constant.int 1
-// CHECK: [[INT2:%.*]] = torch.constant.int 2
-// CHECK: [[PAD_LIST:%.*]] = torch.prim.ListConstruct [[INT1]], [[INT2]] : (!torch.int, !torch.int) -> !torch.list<int>
-// CHECK: [[C0:%.*]] = arith.constant 0 : index
-// CHECK: [[C3:%.*]] = arith.constant 3 : index
-// CHECK: [[C1:%.*]] = arith.constant 1 : index
 // CHECK: [[C5:%.*]] = arith.constant 5 : index
-// CHECK: [[SLICE_LEFT:%.*]] = tensor.extract_slice [[TENSOR]][0, 0] [3, 1] [1, 1] : tensor<3x5xf32> to tensor<3x1xf32>
-// CHECK: [[C0_0:%.*]] = arith.constant 0 : index
-// CHECK: [[C3_1:%.*]] = arith.constant 3 : index
-// CHECK: [[C1_2:%.*]] = arith.constant 1 : index
-// CHECK: [[C5_3:%.*]] = arith.constant 5 : index
-// CHECK: [[C1_4:%.*]] = arith.constant 1 : index
-// CHECK: [[IDX_RIGHT:%.*]] = arith.subi [[C5_3]], [[C1_4]] : index
-// CHECK: [[SLICE_RIGHT:%.*]] = tensor.extract_slice [[TENSOR]][0, [[IDX_RIGHT]]] [3, 1] [1, 1] : tensor<3x5xf32> to tensor<3x1xf32>
-// CHECK: [[RIGHT_PAD:%.*]] = tensor.concat dim(1) [[SLICE_RIGHT]], [[SLICE_RIGHT]] : (tensor<3x1xf32>, tensor<3x1xf32>) -> tensor<3x2xf32>
-// CHECK: [[PADDED:%.*]] = tensor.concat dim(1) [[SLICE_LEFT]], [[TENSOR]], [[RIGHT_PAD]] : (tensor<3x1xf32>, tensor<3x5xf32>, tensor<3x2xf32>) -> tensor<3x8xf32>
+// CHECK: [[EMPTY:%.*]] = tensor.empty() : tensor<3x8xf32>
+// CHECK: [[PADDED:%.*]] = linalg.generic {indexing_maps = [#{{.*}}], iterator_types = ["parallel", "parallel"]} outs([[EMPTY]] : tensor<3x8xf32>) {
+// CHECK: ^bb0([[OUT:%.*]]: f32):
+// CHECK:   [[IDX0:%.*]] = linalg.index 0 : index
+// CHECK:   [[IDX1:%.*]] = linalg.index 1 : index
+// CHECK:   [[ZERO:%.*]] = arith.constant 0 : index
+// CHECK:   [[ONE:%.*]] = arith.constant 1 : index
+// CHECK:   [[LAST:%.*]] = arith.subi [[C5]], [[ONE]] : index
+// CHECK:   [[LOW:%.*]] = arith.constant 1 : index
+// CHECK:   [[SHIFTED:%.*]] = arith.subi [[IDX1]], [[LOW]] : index
+// CHECK:   [[ABOVE:%.*]] = arith.maxsi [[SHIFTED]], [[ZERO]] : index
+// CHECK:   [[CLAMPED:%.*]] = arith.minsi [[ABOVE]], [[LAST]] : index
+// CHECK:   [[VALUE:%.*]] = tensor.extract [[TENSOR]]{{\[}}[[IDX0]], [[CLAMPED]]] : tensor<3x5xf32>
+// CHECK:   linalg.yield [[VALUE]] : f32
+// CHECK: } -> tensor<3x8xf32>
+// CHECK-NOT: tensor.concat
 // CHECK: [[CAST:%.*]] = tensor.cast [[PADDED]] : tensor<3x8xf32> to tensor<3x8xf32>
 // CHECK: [[TORCH_TENSOR:%.*]] = torch_c.from_builtin_tensor [[CAST]] : tensor<3x8xf32> -> !torch.vtensor<[3,8],f32>
 // CHECK: return [[TORCH_TENSOR]] : !torch.vtensor<[3,8],f32>
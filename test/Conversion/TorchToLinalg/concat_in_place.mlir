@@ -0,0 +1,32 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="concat-in-place" -split-input-file -canonicalize | FileCheck %s
+
+// CHECK-LABEL: func.func @cat_produced
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[2,4],f32>, %[[ARG1:.*]]: !torch.vtensor<[2,4],f32>, %[[ARG2:.*]]: !torch.vtensor<[3,4],f32>
+// CHECK-DAG:     %[[CACHE:.*]] = torch_c.to_builtin_tensor %[[ARG2]]
+// CHECK:         %[[EMPTY:.*]] = tensor.empty() : tensor<5x4xf32>
+// CHECK:         %[[SLICE:.*]] = tensor.extract_slice %[[EMPTY]][0, 0] [2, 4] [1, 1] : tensor<5x4xf32> to tensor<2x4xf32>
+// CHECK:         %[[ADD:.*]] = linalg.generic {{.*}} outs(%[[SLICE]] : tensor<2x4xf32>)
+// CHECK:           arith.addf
+// CHECK:         %[[INSERT:.*]] = tensor.insert_slice %[[ADD]] into %[[EMPTY]][0, 0] [2, 4] [1, 1] : tensor<2x4xf32> into tensor<5x4xf32>
+// CHECK:         tensor.insert_slice %[[CACHE]] into %[[INSERT]][2, 0] [3, 4] [1, 1] : tensor<3x4xf32> into tensor<5x4xf32>
+// CHECK-NOT:     tensor.concat
+func.func @cat_produced(%arg0: !torch.vtensor<[2,4],f32>, %arg1: !torch.vtensor<[2,4],f32>, %arg2: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[5,4],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.add.Tensor %arg0, %arg1, %int1 : !torch.vtensor<[2,4],f32>, !torch.vtensor<[2,4],f32>, !torch.int -> !torch.vtensor<[2,4],f32>
+  %1 = torch.prim.ListConstruct %0, %arg2 : (!torch.vtensor<[2,4],f32>, !torch.vtensor<[3,4],f32>) -> !torch.list<vtensor>
+  %2 = torch.aten.cat %1, %int0 : !torch.list<vtensor>, !torch.int -> !torch.vtensor<[5,4],f32>
+  return %2 : !torch.vtensor<[5,4],f32>
+}
+
+// -----
+
+// Without a producer to write in place, the concat is kept.
+// CHECK-LABEL: func.func @cat_arguments
+// CHECK:         tensor.concat dim(1)
+func.func @cat_arguments(%arg0: !torch.vtensor<[2,4],f32>, %arg1: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,7],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.prim.ListConstruct %arg0, %arg1 : (!torch.vtensor<[2,4],f32>, !torch.vtensor<[2,3],f32>) -> !torch.list<vtensor>
+  %1 = torch.aten.cat %0, %int1 : !torch.list<vtensor>, !torch.int -> !torch.vtensor<[2,7],f32>
+  return %1 : !torch.vtensor<[2,7],f32>
+}
@@ -53,6 +53,34 @@ func.func @q_conv_test(%arg0: !torch.vtensor<[?,?,?,?],si8>, %arg1: !torch.vtens
 
 // -----
 
+// CHECK-LABEL: func.func @q_conv_per_channel_weight
+// CHECK-DAG: %[[c0:.*]] = arith.constant 0 : i32
+// CHECK-DAG: %[[c7:.*]] = arith.constant 7 : i32
+// CHECK: %[[conv:.*]] = linalg.conv_2d_nchw_fchw_q
+// CHECK-SAME: ins(%{{.*}}, %{{.*}}, %[[c7]], %[[c0]] : tensor<1x3x8x8xi8>, tensor<4x3x2x2xi8>, i32, i32)
+// CHECK: linalg.generic
+// CHECK-SAME: ins(%{{.*}}, %{{.*}}, %{{.*}} : tensor<1x4x7x7xi32>, tensor<4xf32>, tensor<4xi8>)
+func.func @q_conv_per_channel_weight(%arg0: !torch.vtensor<[1,3,8,8],si8>, %arg1: !torch.vtensor<[4,3,2,2],si8>, %arg2: !torch.vtensor<[4],f32>) -> !torch.vtensor<[1,4,7,7],f32> {
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int7 = torch.constant.int 7
+  %float1.000000e-02 = torch.constant.float 1.000000e-02
+  %zps = torch.vtensor.literal(dense<0> : tensor<4xsi8>) : !torch.vtensor<[4],si8>
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten._make_per_tensor_quantized_tensor %arg0, %float1.000000e-02, %int7 : !torch.vtensor<[1,3,8,8],si8>, !torch.float, !torch.int -> !torch.vtensor<[1,3,8,8],!torch.qint8>
+  %3 = torch.aten._make_per_channel_quantized_tensor %arg1, %arg2, %zps, %int0 : !torch.vtensor<[4,3,2,2],si8>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],si8>, !torch.int -> !torch.vtensor<[4,3,2,2],!torch.qint8>
+  %4 = torch.aten.convolution %2, %3, %none, %0, %1, %0, %false, %1, %int1 : !torch.vtensor<[1,3,8,8],!torch.qint8>, !torch.vtensor<[4,3,2,2],!torch.qint8>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,7,7],si32>
+  %5 = torch.aten.mul.Scalar %arg2, %float1.000000e-02 : !torch.vtensor<[4],f32>, !torch.float -> !torch.vtensor<[4],f32>
+  %6 = torch.aten._make_per_channel_quantized_tensor %4, %5, %zps, %int1 : !torch.vtensor<[1,4,7,7],si32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],si8>, !torch.int -> !torch.vtensor<[1,4,7,7],!torch.qint32>
+  %7 = torch.aten.dequantize.self %6 : !torch.vtensor<[1,4,7,7],!torch.qint32> -> !torch.vtensor<[1,4,7,7],f32>
+  return %7 : !torch.vtensor<[1,4,7,7],f32>
+}
+
+// -----
+
 // CHECK-LABEL:   func.func @conv_broadcast(
 // CHECK-SAME:                              %[[arg0:.*]]: !torch.vtensor<[1,80,3000],f32>,
 // CHECK-SAME:                              %[[arg1:.*]]: !torch.vtensor<[1024,80,3],f32>,
@@ -0,0 +1,51 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="conv-backward-gemm=true" -canonicalize -split-input-file -mlir-print-local-scope | FileCheck %s
+
+// CHECK-LABEL:   func.func @convolution_backward_weights_2x2s_3x3k(
+// CHECK-DAG:       %[[GO:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[2,16,31,31],f32> -> tensor<2x16x31x31xf32>
+// CHECK-DAG:       %[[IN:.*]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[2,8,64,64],f32> -> tensor<2x8x64x64xf32>
+// CHECK:           %[[COL:.*]] = linalg.generic {indexing_maps = [affine_map<(d0, d1, d2, d3, d4, d5) -> (d3, d0, d1 + d4 * 2, d2 + d5 * 2)>, affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d2, d3, d4, d5)>]
+// CHECK-SAME:      ins(%[[IN]] : tensor<2x8x64x64xf32>) outs(%{{.*}} : tensor<8x3x3x2x31x31xf32>)
+// CHECK:           %[[RHS:.*]] = tensor.collapse_shape %[[COL]] {{\[\[}}0, 1, 2], [3, 4, 5]] : tensor<8x3x3x2x31x31xf32> into tensor<72x1922xf32>
+// CHECK:           %[[GO_T:.*]] = linalg.transpose ins(%[[GO]] : tensor<2x16x31x31xf32>) outs(%{{.*}} : tensor<16x2x31x31xf32>) permutation = [1, 0, 2, 3]
+// CHECK:           %[[LHS:.*]] = tensor.collapse_shape %[[GO_T]] {{\[\[}}0], [1, 2, 3]] : tensor<16x2x31x31xf32> into tensor<16x1922xf32>
+// CHECK:           %[[MM:.*]] = linalg.matmul indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d2)>, affine_map<(d0, d1, d2) -> (d1, d2)>, affine_map<(d0, d1, d2) -> (d0, d1)>]
+// CHECK-SAME:      ins(%[[LHS]], %[[RHS]] : tensor<16x1922xf32>, tensor<72x1922xf32>) outs(%{{.*}} : tensor<16x72xf32>)
+// CHECK:           tensor.expand_shape %[[MM]] {{\[\[}}0], [1, 2, 3]] output_shape [16, 8, 3, 3] : tensor<16x72xf32> into tensor<16x8x3x3xf32>
+func.func @convolution_backward_weights_2x2s_3x3k(%arg0: !torch.vtensor<[2,16,31,31],f32>, %arg1: !torch.vtensor<[2,8,64,64],f32>, %arg2: !torch.vtensor<[16,8,3,3],f32>) -> !torch.vtensor<[16,8,3,3],f32> {
+  %true = torch.constant.bool true
+  %int0 = torch.constant.int 0
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %4 = torch.prim.ListConstruct %false, %true, %false : (!torch.bool, !torch.bool, !torch.bool) -> !torch.list<bool>
+  %result0, %result1, %result2 = torch.aten.convolution_backward %arg0, %arg1, %arg2, %3, %0, %1, %2, %false, %1, %int1, %4 : !torch.vtensor<[2,16,31,31],f32>, !torch.vtensor<[2,8,64,64],f32>, !torch.vtensor<[16,8,3,3],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int, !torch.list<bool> -> !torch.none, !torch.vtensor<[16,8,3,3],f32>, !torch.none
+  return %result1 : !torch.vtensor<[16,8,3,3],f32>
+}
+
+// -----
+
+// The input gradient of a strided convolution is computed one phase of the
+// input at a time, without scattering `grad_output` into zeros.
+// CHECK-LABEL:   func.func @convolution_backward_input_2x2s_3x3k(
+// CHECK-NOT:       tensor.insert_slice
+// CHECK:           linalg.transpose ins(%{{.*}} : tensor<16x8x3x3xf32>) outs(%{{.*}} : tensor<8x16x3x3xf32>) permutation = [1, 0, 2, 3]
+// CHECK-COUNT-4:   linalg.conv_2d_nchw_fchw {{.*}} outs(%{{.*}} : tensor<2x8x32x32xf32>)
+// CHECK-NOT:       linalg.conv_2d_nchw_fchw
+func.func @convolution_backward_input_2x2s_3x3k(%arg0: !torch.vtensor<[2,16,31,31],f32>, %arg1: !torch.vtensor<[2,8,64,64],f32>, %arg2: !torch.vtensor<[16,8,3,3],f32>) -> !torch.vtensor<[2,8,64,64],f32> {
+  %true = torch.constant.bool true
+  %int0 = torch.constant.int 0
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %4 = torch.prim.ListConstruct %true, %false, %false : (!torch.bool, !torch.bool, !torch.bool) -> !torch.list<bool>
+  %result0, %result1, %result2 = torch.aten.convolution_backward %arg0, %arg1, %arg2, %3, %0, %1, %2, %false, %1, %int1, %4 : !torch.vtensor<[2,16,31,31],f32>, !torch.vtensor<[2,8,64,64],f32>, !torch.vtensor<[16,8,3,3],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int, !torch.list<bool> -> !torch.vtensor<[2,8,64,64],f32>, !torch.none, !torch.none
+  return %result0 : !torch.vtensor<[2,8,64,64],f32>
+}
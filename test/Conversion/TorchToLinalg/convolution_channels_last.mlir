@@ -0,0 +1,41 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="channels-last-conv=true" -canonicalize -split-input-file -mlir-print-local-scope | FileCheck %s
+
+// CHECK-LABEL:   func.func @conv2d_bias(
+// CHECK-DAG:       %[[input:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[1,3,32,32],f32> -> tensor<1x3x32x32xf32>
+// CHECK-DAG:       %[[weight:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[8,3,3,3],f32> -> tensor<8x3x3x3xf32>
+// CHECK-DAG:       %[[bias:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[8],f32> -> tensor<8xf32>
+// CHECK:           %[[padInput:.*]] = tensor.pad %[[input]] low[0, 0, 1, 1] high[0, 0, 1, 1]
+// CHECK:           %[[broadcastBias:.*]] = linalg.broadcast ins(%[[bias]] : tensor<8xf32>) outs(%{{.*}} : tensor<1x32x32x8xf32>) dimensions = [0, 1, 2]
+// CHECK:           %[[nhwcInput:.*]] = linalg.transpose ins(%[[padInput]] : tensor<1x3x34x34xf32>) outs(%{{.*}} : tensor<1x34x34x3xf32>) permutation = [0, 2, 3, 1]
+// CHECK:           %[[hwcfWeight:.*]] = linalg.transpose ins(%[[weight]] : tensor<8x3x3x3xf32>) outs(%{{.*}} : tensor<3x3x3x8xf32>) permutation = [2, 3, 1, 0]
+// CHECK:           %[[conv:.*]] = linalg.conv_2d_nhwc_hwcf {dilations = dense<1> : vector<2xi64>, strides = dense<1> : vector<2xi64>}
+// CHECK-SAME:      ins(%[[nhwcInput]], %[[hwcfWeight]] : tensor<1x34x34x3xf32>, tensor<3x3x3x8xf32>)
+// CHECK-SAME:      outs(%[[broadcastBias]] : tensor<1x32x32x8xf32>) -> tensor<1x32x32x8xf32>
+// CHECK:           linalg.transpose ins(%[[conv]] : tensor<1x32x32x8xf32>) outs(%{{.*}} : tensor<1x8x32x32xf32>) permutation = [0, 3, 1, 2]
+func.func @conv2d_bias(%arg0: !torch.vtensor<[1,3,32,32],f32>, %arg1: !torch.vtensor<[8,3,3,3],f32>, %arg2: !torch.vtensor<[8],f32>) -> !torch.vtensor<[1,8,32,32],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.convolution %arg0, %arg1, %arg2, %0, %0, %0, %false, %1, %int1 : !torch.vtensor<[1,3,32,32],f32>, !torch.vtensor<[8,3,3,3],f32>, !torch.vtensor<[8],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,8,32,32],f32>
+  return %2 : !torch.vtensor<[1,8,32,32],f32>
+}
+
+// -----
+
+// Grouped convolutions keep the PyTorch layout.
+// CHECK-LABEL:   func.func @conv2d_grouped(
+// CHECK-NOT:       linalg.transpose
+// CHECK:           linalg.conv_2d_ngchw_gfchw
+func.func @conv2d_grouped(%arg0: !torch.vtensor<[1,4,16,16],f32>, %arg1: !torch.vtensor<[4,2,3,3],f32>) -> !torch.vtensor<[1,4,14,14],f32> {
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %false = torch.constant.bool false
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %0, %false, %1, %int2 : !torch.vtensor<[1,4,16,16],f32>, !torch.vtensor<[4,2,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,14,14],f32>
+  return %2 : !torch.vtensor<[1,4,14,14],f32>
+}
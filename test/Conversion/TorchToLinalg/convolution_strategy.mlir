@@ -0,0 +1,68 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="conv-strategy=im2col" -canonicalize -split-input-file | FileCheck %s --check-prefix=IM2COL
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="conv-strategy=winograd" -canonicalize -split-input-file | FileCheck %s --check-prefix=WINOGRAD
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="conv-strategy=auto" -canonicalize -split-input-file | FileCheck %s --check-prefix=AUTO
+
+// IM2COL-LABEL:   func.func @conv2d_3x3
+// IM2COL:           tensor.pad
+// IM2COL:           linalg.generic {{.*}} iterator_types = ["parallel", "parallel", "parallel"]
+// IM2COL-SAME:        outs(%{{.*}} : tensor<1x27x1024xf32>)
+// IM2COL:           linalg.generic {{.*}} iterator_types = ["parallel", "parallel", "parallel", "reduction"]
+// IM2COL-NOT:       linalg.conv_2d
+
+// WINOGRAD-LABEL:   func.func @conv2d_3x3
+// WINOGRAD:           linalg.batch_matmul
+// WINOGRAD-NOT:       linalg.conv_2d
+// WINOGRAD-NOT:       linalg.winograd
+
+// Too few input channels for Winograd to pay off.
+// AUTO-LABEL:       func.func @conv2d_3x3
+// AUTO-NOT:           linalg.batch_matmul
+// AUTO-NOT:           linalg.conv_2d
+func.func @conv2d_3x3(%arg0: !torch.vtensor<[1,3,32,32],f32>, %arg1: !torch.vtensor<[8,3,3,3],f32>) -> !torch.vtensor<[1,8,32,32],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.convolution %arg0, %arg1, %none, %0, %0, %0, %false, %1, %int1 : !torch.vtensor<[1,3,32,32],f32>, !torch.vtensor<[8,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,8,32,32],f32>
+  return %2 : !torch.vtensor<[1,8,32,32],f32>
+}
+
+// -----
+
+// IM2COL-LABEL:     func.func @conv2d_3x3_wide
+// IM2COL-NOT:         linalg.conv_2d
+
+// AUTO-LABEL:       func.func @conv2d_3x3_wide
+// AUTO:               linalg.batch_matmul
+// AUTO-NOT:           linalg.conv_2d
+// AUTO-NOT:           linalg.winograd
+func.func @conv2d_3x3_wide(%arg0: !torch.vtensor<[1,16,16,16],f32>, %arg1: !torch.vtensor<[16,16,3,3],f32>) -> !torch.vtensor<[1,16,16,16],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.convolution %arg0, %arg1, %none, %0, %0, %0, %false, %1, %int1 : !torch.vtensor<[1,16,16,16],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,16,16,16],f32>
+  return %2 : !torch.vtensor<[1,16,16,16],f32>
+}
+
+// -----
+
+// Strided convolutions are not eligible for Winograd.
+// WINOGRAD-LABEL:   func.func @conv2d_strided
+// WINOGRAD:           linalg.conv_2d_nchw_fchw
+func.func @conv2d_strided(%arg0: !torch.vtensor<[1,16,16,16],f32>, %arg1: !torch.vtensor<[16,16,3,3],f32>) -> !torch.vtensor<[1,16,7,7],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %2, %false, %1, %int1 : !torch.vtensor<[1,16,16,16],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,16,7,7],f32>
+  return %3 : !torch.vtensor<[1,16,7,7],f32>
+}
@@ -0,0 +1,54 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="subpixel-conv-transpose=true" -canonicalize -split-input-file -mlir-print-local-scope | FileCheck %s
+
+// CHECK-LABEL:   func.func @conv_transpose2d_stride2(
+// CHECK-DAG:       %[[input:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[1,2,4,4],f32> -> tensor<1x2x4x4xf32>
+// CHECK-DAG:       %[[bias:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[3],f32> -> tensor<3xf32>
+// CHECK-NOT:       tensor.insert_slice %[[input]]
+// CHECK:           %[[flipped:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<3x2x3x3xf32>)
+// CHECK:           %[[out0:.*]] = linalg.broadcast ins(%[[bias]] : tensor<3xf32>) outs(%{{.*}} : tensor<1x3x8x8xf32>) dimensions = [0, 2, 3]
+// CHECK:           %[[pad0:.*]] = tensor.pad %[[input]] low[0, 0, 0, 0] high[0, 0, 1, 1]
+// CHECK:           %[[taps0:.*]] = tensor.extract_slice %[[flipped]][0, 0, 0, 0] [3, 2, 2, 2] [1, 1, 2, 2] : tensor<3x2x3x3xf32> to tensor<3x2x2x2xf32>
+// CHECK:           %[[init0:.*]] = tensor.extract_slice %[[out0]][0, 0, 1, 1] [1, 3, 4, 4] [1, 1, 2, 2] : tensor<1x3x8x8xf32> to tensor<1x3x4x4xf32>
+// CHECK:           %[[conv0:.*]] = linalg.conv_2d_nchw_fchw {dilations = dense<1> : vector<2xi64>, strides = dense<1> : vector<2xi64>}
+// CHECK-SAME:      ins(%[[pad0]], %[[taps0]] : tensor<1x2x5x5xf32>, tensor<3x2x2x2xf32>) outs(%[[init0]] : tensor<1x3x4x4xf32>)
+// CHECK:           %[[out1:.*]] = tensor.insert_slice %[[conv0]] into %[[out0]][0, 0, 1, 1] [1, 3, 4, 4] [1, 1, 2, 2]
+// CHECK:           %[[pad1:.*]] = tensor.pad %[[input]] low[0, 0, 0, 0] high[0, 0, 0, 1]
+// CHECK:           %[[taps1:.*]] = tensor.extract_slice %[[flipped]][0, 0, 1, 0] [3, 2, 1, 2] [1, 1, 2, 2] : tensor<3x2x3x3xf32> to tensor<3x2x1x2xf32>
+// CHECK:           %[[init1:.*]] = tensor.extract_slice %[[out1]][0, 0, 0, 1] [1, 3, 4, 4] [1, 1, 2, 2]
+// CHECK:           %[[conv1:.*]] = linalg.conv_2d_nchw_fchw
+// CHECK-SAME:      ins(%[[pad1]], %[[taps1]] : tensor<1x2x4x5xf32>, tensor<3x2x1x2xf32>) outs(%[[init1]] : tensor<1x3x4x4xf32>)
+// CHECK:           %[[out2:.*]] = tensor.insert_slice %[[conv1]] into %[[out1]][0, 0, 0, 1] [1, 3, 4, 4] [1, 1, 2, 2]
+// CHECK:           linalg.conv_2d_nchw_fchw
+// CHECK-SAME:      tensor<3x2x2x1xf32>
+// CHECK:           tensor.insert_slice %{{.*}}[0, 0, 1, 0] [1, 3, 4, 4] [1, 1, 2, 2]
+// CHECK:           linalg.conv_2d_nchw_fchw
+// CHECK-SAME:      ins(%[[input]], %{{.*}} : tensor<1x2x4x4xf32>, tensor<3x2x1x1xf32>)
+// CHECK:           tensor.insert_slice %{{.*}}[0, 0, 0, 0] [1, 3, 4, 4] [1, 1, 2, 2]
+// CHECK-NOT:       linalg.conv_2d_nchw_fchw
+func.func @conv_transpose2d_stride2(%arg0: !torch.vtensor<[1,2,4,4],f32>, %arg1: !torch.vtensor<[2,3,3,3],f32>, %arg2: !torch.vtensor<[3],f32>) -> !torch.vtensor<[1,3,8,8],f32> {
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %true = torch.constant.bool true
+  %0 = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.convolution %arg0, %arg1, %arg2, %0, %1, %1, %true, %1, %int1 : !torch.vtensor<[1,2,4,4],f32>, !torch.vtensor<[2,3,3,3],f32>, !torch.vtensor<[3],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,3,8,8],f32>
+  return %2 : !torch.vtensor<[1,3,8,8],f32>
+}
+
+// -----
+
+// Transposed convolutions of stride 1 read no zeros between the inputs and
+// keep a single convolution.
+// CHECK-LABEL:   func.func @conv_transpose2d_stride1(
+// CHECK:           linalg.conv_2d_nchw_fchw
+// CHECK-NOT:       linalg.conv_2d_nchw_fchw
+func.func @conv_transpose2d_stride1(%arg0: !torch.vtensor<[1,2,4,4],f32>, %arg1: !torch.vtensor<[2,3,3,3],f32>) -> !torch.vtensor<[1,3,6,6],f32> {
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %true = torch.constant.bool true
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.convolution %arg0, %arg1, %none, %0, %1, %0, %true, %1, %int1 : !torch.vtensor<[1,2,4,4],f32>, !torch.vtensor<[2,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,3,6,6],f32>
+  return %2 : !torch.vtensor<[1,3,6,6],f32>
+}
@@ -35,33 +35,30 @@ func.func @torch.aten.permute$rank0(%arg0: !torch.vtensor<[],f32>) -> !torch.vte
 
 // -----
 
-// CHECK: #[[$INPUT_MAP:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
 // CHECK-LABEL:   func.func @torch.aten.reflection_pad2d(
 // CHECK-SAME:                                           %[[VAL_0:.*]]: !torch.vtensor<[1,1,4,4],f32>) -> !torch.vtensor<[1,1,8,9],f32> {
-// CHECK:           %[[CST0:.*]] = arith.constant 0 : index
-// CHECK:           %[[VAL_1:.*]] = arith.constant 0.000000e+00 : f32
-// CHECK:           %[[VAL_2:.*]] = arith.constant 2 : index
-// CHECK:           %[[VAL_3:.*]] = arith.constant 1 : index
-// CHECK:           %[[VAL_4:.*]] = torch_c.to_builtin_tensor %[[VAL_0]] : !torch.vtensor<[1,1,4,4],f32> -> tensor<1x1x4x4xf32>
-// CHECK:           %[[VAL_5:.*]] = tensor.empty() : tensor<1x1x8x9xf32>
-// CHECK:           %[[VAL_6:.*]] = linalg.fill ins(%[[VAL_1]] : f32) outs(%[[VAL_5]] : tensor<1x1x8x9xf32>) -> tensor<1x1x8x9xf32>
-// CHECK:           %[[VAL_7:.*]] = tensor.extract_slice %[[VAL_4]][0, 0, 1, 1] [1, 1, 2, 2] [1, 1, 1, 1] : tensor<1x1x4x4xf32> to tensor<1x1x2x2xf32>
-// CHECK:           %[[VAL_8:.*]] = tensor.extract_slice %[[VAL_4]][0, 0, 1, 1] [1, 1, 2, 2] [1, 1, 1, 1] : tensor<1x1x4x4xf32> to tensor<1x1x2x2xf32>
-// CHECK:           %[[VAL_9:.*]] = tensor.extract_slice %[[VAL_4]][0, 0, 1, 1] [1, 1, 2, 2] [1, 1, 1, 1] : tensor<1x1x4x4xf32> to tensor<1x1x2x2xf32>
-// CHECK:           %[[VAL_10:.*]] = linalg.generic {indexing_maps = [#[[$INPUT_MAP]], #[[$INPUT_MAP]]], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%[[VAL_9]] : tensor<1x1x2x2xf32>) outs(%[[VAL_8]] : tensor<1x1x2x2xf32>) {
-// CHECK:           ^bb0(%[[VAL_11:.*]]: f32, %[[VAL_12:.*]]: f32):
-// CHECK:             %[[VAL_15:.*]] = linalg.index 2 : index
-// CHECK:             %[[VAL_16:.*]] = linalg.index 3 : index
-// CHECK:             %[[VAL_17:.*]] = arith.subi %[[VAL_3]], %[[VAL_16]] : index
-// CHECK:             %[[VAL_18:.*]] = arith.subi %[[VAL_3]], %[[VAL_15]] : index
-// CHECK:             %[[VAL_19:.*]] = tensor.extract %[[VAL_7]]{{\[}}%[[CST0]], %[[CST0]], %[[VAL_18]], %[[VAL_17]]] : tensor<1x1x2x2xf32>
-// CHECK:             linalg.yield %[[VAL_19]] : f32
-// CHECK:           } -> tensor<1x1x2x2xf32>
-// CHECK:           %[[VAL_20:.*]] = tensor.insert_slice %[[VAL_10]] into %[[VAL_6]][0, 0, 0, 0] [1, 1, 2, 2] [1, 1, 1, 1] : tensor<1x1x2x2xf32> into tensor<1x1x8x9xf32>
-// CHECK-COUNT-8:   linalg.generic
-// CHECK:           %[[VAL_123:.*]] = tensor.insert_slice
-// CHECK:           %[[VAL_124:.*]] = torch_c.from_builtin_tensor %[[VAL_123]] : tensor<1x1x8x9xf32> -> !torch.vtensor<[1,1,8,9],f32>
-// CHECK:           return %[[VAL_124]] : !torch.vtensor<[1,1,8,9],f32>
+// CHECK-DAG:       %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:       %[[C3:.*]] = arith.constant 3 : index
+// CHECK:           %[[VAL_1:.*]] = torch_c.to_builtin_tensor %[[VAL_0]] : !torch.vtensor<[1,1,4,4],f32> -> tensor<1x1x4x4xf32>
+// CHECK-NOT:       tensor.insert_slice
+// CHECK:           %[[VAL_2:.*]] = tensor.empty() : tensor<1x1x8x9xf32>
+// CHECK:           %[[VAL_3:.*]] = linalg.generic {{.*}} outs(%[[VAL_2]] : tensor<1x1x8x9xf32>) {
+// CHECK:             %[[IDX0:.*]] = linalg.index 0 : index
+// CHECK:             %[[IDX1:.*]] = linalg.index 1 : index
+// CHECK:             %[[IDX2:.*]] = linalg.index 2 : index
+// CHECK:             %[[ROW_ABS:.*]] = arith.maxsi
+// CHECK:             %[[ROW_FROM_LAST:.*]] = arith.subi %[[C3]], %[[ROW_ABS]] : index
+// CHECK:             %[[ROW_FROM_LAST_NEG:.*]] = arith.subi %[[C0]], %[[ROW_FROM_LAST]] : index
+// CHECK:             %[[ROW_FROM_LAST_ABS:.*]] = arith.maxsi %[[ROW_FROM_LAST]], %[[ROW_FROM_LAST_NEG]] : index
+// CHECK:             %[[ROW:.*]] = arith.subi %[[C3]], %[[ROW_FROM_LAST_ABS]] : index
+// CHECK:             %[[IDX3:.*]] = linalg.index 3 : index
+// CHECK:             %[[COL:.*]] = arith.subi %[[C3]], %{{.*}} : index
+// CHECK:             %[[VAL_4:.*]] = tensor.extract %[[VAL_1]]{{\[}}%[[IDX0]], %[[IDX1]], %[[ROW]], %[[COL]]] : tensor<1x1x4x4xf32>
+// CHECK:             linalg.yield %[[VAL_4]] : f32
+// CHECK:           } -> tensor<1x1x8x9xf32>
+// CHECK-NOT:       tensor.insert_slice
+// CHECK:           %[[VAL_5:.*]] = torch_c.from_builtin_tensor %[[VAL_3]] : tensor<1x1x8x9xf32> -> !torch.vtensor<[1,1,8,9],f32>
+// CHECK:           return %[[VAL_5]] : !torch.vtensor<[1,1,8,9],f32>
 // CHECK:         }
 
 func.func @torch.aten.reflection_pad2d(%arg0: !torch.vtensor<[1,1,4,4],f32>) -> !torch.vtensor<[1,1,8,9],f32>  {
@@ -0,0 +1,80 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg=decompose-zero-points -canonicalize -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-LABEL: func.func @q_mm
+// CHECK-DAG:   %[[C3:.*]] = arith.constant 3 : i32
+// CHECK-DAG:   %[[C7:.*]] = arith.constant 7 : i32
+// CHECK-DAG:   %[[C168:.*]] = arith.constant 168 : i32
+// CHECK-DAG:   %[[LHS:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[4,8],si8> -> tensor<4x8xi8>
+// CHECK-DAG:   %[[RHS:.*]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[8,16],si8> -> tensor<8x16xi8>
+// CHECK-NOT:   linalg.quantized_matmul
+// CHECK:       %[[MM:.*]] = linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<4x8xi8>, tensor<8x16xi8>) outs(%{{.*}} : tensor<4x16xi32>)
+// CHECK:       %[[ROWS:.*]] = linalg.generic {{.*}} ins(%[[LHS]] : tensor<4x8xi8>) outs(%{{.*}} : tensor<4xi32>)
+// CHECK:       %[[COLS:.*]] = linalg.generic {{.*}} ins(%[[RHS]] : tensor<8x16xi8>) outs(%{{.*}} : tensor<16xi32>)
+// CHECK:       linalg.generic {{.*}} ins(%[[ROWS]], %[[COLS]] : tensor<4xi32>, tensor<16xi32>) outs(%[[MM]] : tensor<4x16xi32>)
+// CHECK-NEXT:  ^bb0(%[[ROW:.*]]: i32, %[[COL:.*]]: i32, %[[OUT:.*]]: i32):
+// CHECK-NEXT:    %[[ROW_TERM:.*]] = arith.muli %[[ROW]], %[[C3]] : i32
+// CHECK-NEXT:    %[[SUB0:.*]] = arith.subi %[[OUT]], %[[ROW_TERM]] : i32
+// CHECK-NEXT:    %[[COL_TERM:.*]] = arith.muli %[[COL]], %[[C7]] : i32
+// CHECK-NEXT:    %[[SUB1:.*]] = arith.subi %[[SUB0]], %[[COL_TERM]] : i32
+// CHECK-NEXT:    %[[ADD:.*]] = arith.addi %[[SUB1]], %[[C168]] : i32
+// CHECK-NEXT:    linalg.yield %[[ADD]] : i32
+func.func @q_mm(%arg0: !torch.vtensor<[4,8],si8>, %arg1: !torch.vtensor<[8,16],si8>) -> !torch.vtensor<[4,16],si32> {
+  %int3 = torch.constant.int 3
+  %int7 = torch.constant.int 7
+  %float1.000000e-02 = torch.constant.float 1.000000e-02
+  %0 = torch.aten._make_per_tensor_quantized_tensor %arg0, %float1.000000e-02, %int7 : !torch.vtensor<[4,8],si8>, !torch.float, !torch.int -> !torch.vtensor<[4,8],!torch.qint8>
+  %1 = torch.aten._make_per_tensor_quantized_tensor %arg1, %float1.000000e-02, %int3 : !torch.vtensor<[8,16],si8>, !torch.float, !torch.int -> !torch.vtensor<[8,16],!torch.qint8>
+  %2 = torch.aten.mm %0, %1 : !torch.vtensor<[4,8],!torch.qint8>, !torch.vtensor<[8,16],!torch.qint8> -> !torch.vtensor<[4,16],si32>
+  return %2 : !torch.vtensor<[4,16],si32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @q_conv
+// CHECK-NOT:   linalg.conv_2d_nchw_fchw_q
+// CHECK:       %[[CONV:.*]] = linalg.conv_2d_nchw_fchw {{.*}} ins(%[[INPUT:.*]], %[[WEIGHT:.*]] : tensor<1x3x8x8xi8>, tensor<4x3x2x2xi8>) outs(%{{.*}} : tensor<1x4x7x7xi32>)
+// CHECK:       %[[CHANNELS:.*]] = linalg.generic {{.*}} ins(%[[INPUT]] : tensor<1x3x8x8xi8>) outs(%{{.*}} : tensor<1x8x8xi32>)
+// CHECK:       %[[EXPANDED:.*]] = tensor.expand_shape %[[CHANNELS]] {{\[\[}}0, 1], [2], [3]] output_shape [1, 1, 8, 8] : tensor<1x8x8xi32> into tensor<1x1x8x8xi32>
+// CHECK:       %[[WINDOWS:.*]] = linalg.pooling_nchw_sum {{.*}} ins(%[[EXPANDED]], %{{.*}} : tensor<1x1x8x8xi32>, tensor<2x2xi32>) outs(%{{.*}} : tensor<1x1x7x7xi32>)
+// CHECK:       %[[FILTERS:.*]] = linalg.generic {{.*}} ins(%[[WEIGHT]] : tensor<4x3x2x2xi8>) outs(%{{.*}} : tensor<4xi32>)
+// CHECK:       linalg.generic {{.*}} ins(%[[WINDOWS]], %[[FILTERS]] : tensor<1x1x7x7xi32>, tensor<4xi32>) outs(%[[CONV]] : tensor<1x4x7x7xi32>)
+func.func @q_conv(%arg0: !torch.vtensor<[1,3,8,8],si8>, %arg1: !torch.vtensor<[4,3,2,2],si8>) -> !torch.vtensor<[1,4,7,7],si32> {
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int3 = torch.constant.int 3
+  %int7 = torch.constant.int 7
+  %float1.000000e-02 = torch.constant.float 1.000000e-02
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten._make_per_tensor_quantized_tensor %arg0, %float1.000000e-02, %int7 : !torch.vtensor<[1,3,8,8],si8>, !torch.float, !torch.int -> !torch.vtensor<[1,3,8,8],!torch.qint8>
+  %3 = torch.aten._make_per_tensor_quantized_tensor %arg1, %float1.000000e-02, %int3 : !torch.vtensor<[4,3,2,2],si8>, !torch.float, !torch.int -> !torch.vtensor<[4,3,2,2],!torch.qint8>
+  %4 = torch.aten.convolution %2, %3, %none, %0, %1, %0, %false, %1, %int1 : !torch.vtensor<[1,3,8,8],!torch.qint8>, !torch.vtensor<[4,3,2,2],!torch.qint8>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,7,7],si32>
+  return %4 : !torch.vtensor<[1,4,7,7],si32>
+}
+
+// -----
+
+// A weight zero point of 0 leaves only the correction by the weight sums.
+
+// CHECK-LABEL: func.func @q_conv_per_channel_weight
+// CHECK:       %[[CONV:.*]] = linalg.conv_2d_nchw_fchw {{.*}} ins(%{{.*}}, %[[WEIGHT:.*]] : tensor<1x3x8x8xi8>, tensor<4x3x2x2xi8>)
+// CHECK-NOT:   linalg.pooling_nchw_sum
+// CHECK:       %[[FILTERS:.*]] = linalg.generic {{.*}} ins(%[[WEIGHT]] : tensor<4x3x2x2xi8>) outs(%{{.*}} : tensor<4xi32>)
+// CHECK:       linalg.generic {{.*}} ins(%[[FILTERS]] : tensor<4xi32>) outs(%[[CONV]] : tensor<1x4x7x7xi32>)
+func.func @q_conv_per_channel_weight(%arg0: !torch.vtensor<[1,3,8,8],si8>, %arg1: !torch.vtensor<[4,3,2,2],si8>, %arg2: !torch.vtensor<[4],f32>) -> !torch.vtensor<[1,4,7,7],si32> {
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int7 = torch.constant.int 7
+  %float1.000000e-02 = torch.constant.float 1.000000e-02
+  %zps = torch.vtensor.literal(dense<0> : tensor<4xsi8>) : !torch.vtensor<[4],si8>
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten._make_per_tensor_quantized_tensor %arg0, %float1.000000e-02, %int7 : !torch.vtensor<[1,3,8,8],si8>, !torch.float, !torch.int -> !torch.vtensor<[1,3,8,8],!torch.qint8>
+  %3 = torch.aten._make_per_channel_quantized_tensor %arg1, %arg2, %zps, %int0 : !torch.vtensor<[4,3,2,2],si8>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],si8>, !torch.int -> !torch.vtensor<[4,3,2,2],!torch.qint8>
+  %4 = torch.aten.convolution %2, %3, %none, %0, %1, %0, %false, %1, %int1 : !torch.vtensor<[1,3,8,8],!torch.qint8>, !torch.vtensor<[4,3,2,2],!torch.qint8>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,7,7],si32>
+  return %4 : !torch.vtensor<[1,4,7,7],si32>
+}
@@ -50,6 +50,21 @@ func.func @elementwise$binary(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.vt
 
 // -----
 
+// The result of an op that was in-place before ReduceOpVariants is written
+// into its first input.
+// CHECK-LABEL:   func.func @elementwise$inplace_destination(
+// CHECK:           %[[SELF:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[4],f32> -> tensor<4xf32>
+// CHECK-NOT:       tensor.empty
+// CHECK:           linalg.generic
+// CHECK-SAME:          outs(%[[SELF]] : tensor<4xf32>)
+func.func @elementwise$inplace_destination(%arg0: !torch.vtensor<[4],f32>, %arg1: !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.add.Tensor %arg0, %arg1, %int1 {torch.inplace_destination} : !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.int -> !torch.vtensor<[4],f32>
+  return %0 : !torch.vtensor<[4],f32>
+}
+
+// -----
+
 // CHECK-LABEL:   func.func @elementwise$ternary(
 // CHECK:       linalg.generic {indexing_maps = [
 // CHECK-SAME:    affine_map<(d0, d1, d2) -> (d0, d1, d2)>,
@@ -159,3 +174,38 @@ func.func @elementwise_add_unsigned_extend(%arg0: !torch.vtensor<[?],si32>, %arg
   %0 = torch.aten.add.Tensor %arg0, %arg1, %int1 : !torch.vtensor<[?],si32>, !torch.vtensor<[?],ui8>, !torch.int -> !torch.vtensor<[?],si32>
   return %0 : !torch.vtensor<[?],si32>
 }
+
+// -----
+
+// The broadcast is read through the indexing map of the add rather than
+// materialized.
+// CHECK-LABEL:   func.func @elementwise$broadcast_to_operand(
+// CHECK-SAME:                             %[[ARG0:.*]]: !torch.vtensor<[4,8],f32>,
+// CHECK-SAME:                             %[[ARG1:.*]]: !torch.vtensor<[1,8],f32>) -> !torch.vtensor<[4,8],f32> {
+// CHECK-DAG:       %[[BUILTIN_ARG0:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[4,8],f32> -> tensor<4x8xf32>
+// CHECK-DAG:       %[[BUILTIN_ARG1:.*]] = torch_c.to_builtin_tensor %[[ARG1]] : !torch.vtensor<[1,8],f32> -> tensor<1x8xf32>
+// CHECK:           %[[GENERIC:.*]] = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (0, d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%[[BUILTIN_ARG0]], %[[BUILTIN_ARG1]] : tensor<4x8xf32>, tensor<1x8xf32>) outs(%{{.*}} : tensor<4x8xf32>)
+// CHECK-NOT:       linalg.generic
+func.func @elementwise$broadcast_to_operand(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[1,8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %int1 = torch.constant.int 1
+  %int4 = torch.constant.int 4
+  %int8 = torch.constant.int 8
+  %0 = torch.prim.ListConstruct %int4, %int8 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.broadcast_to %arg1, %0 : !torch.vtensor<[1,8],f32>, !torch.list<int> -> !torch.vtensor<[4,8],f32>
+  %2 = torch.aten.add.Tensor %arg0, %1, %int1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[4,8],f32>, !torch.int -> !torch.vtensor<[4,8],f32>
+  return %2 : !torch.vtensor<[4,8],f32>
+}
+
+// -----
+
+// A single assert covers all of the dynamic sizes of the operands.
+// CHECK-LABEL:   func.func @elementwise$single_assert(
+// CHECK:           %[[EQ0:.*]] = arith.cmpi eq
+// CHECK:           %[[EQ1:.*]] = arith.cmpi eq
+// CHECK:           %[[LEGAL_SIZES:.*]] = arith.andi %[[EQ0]], %[[EQ1]] : i1
+// CHECK:           assert %[[LEGAL_SIZES]], "mismatched size for broadcast"
+// CHECK-NOT:       assert
+func.func @elementwise$single_assert(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+  %0 = torch.aten.mul.Tensor %arg0, %arg1 : !torch.vtensor<[?,?],f32>, !torch.vtensor<[?,?],f32> -> !torch.vtensor<[?,?],f32>
+  return %0 : !torch.vtensor<[?,?],f32>
+}
@@ -0,0 +1,56 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="fuse-elementwise=true" -canonicalize -split-input-file -mlir-print-local-scope | FileCheck %s
+
+// A bias add with a broadcasted bias followed by SiLU is a single generic.
+// CHECK-LABEL:   func.func @bias_add_silu(
+// CHECK-DAG:       %[[X:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[4,8],f32> -> tensor<4x8xf32>
+// CHECK-DAG:       %[[BIAS:.*]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[8],f32> -> tensor<8xf32>
+// CHECK:           %[[FUSED:.*]] = linalg.generic
+// CHECK-SAME:        indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>]
+// CHECK-SAME:        ins(%[[X]], %[[BIAS]] : tensor<4x8xf32>, tensor<8xf32>) outs(%{{.*}} : tensor<4x8xf32>)
+// CHECK:             arith.addf
+// CHECK:             math.exp
+// CHECK:             arith.mulf
+// CHECK:             linalg.yield %{{.*}} : f32
+// CHECK-NOT:       linalg.generic
+// CHECK:           torch_c.from_builtin_tensor %[[FUSED]]
+func.func @bias_add_silu(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.add.Tensor %arg0, %arg1, %int1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8],f32>, !torch.int -> !torch.vtensor<[4,8],f32>
+  %1 = torch.aten.sigmoid %0 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  %2 = torch.aten.mul.Tensor %0, %1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  return %2 : !torch.vtensor<[4,8],f32>
+}
+
+// -----
+
+// Values used outside of the group become extra results, and dtype
+// conversions are fused like any other elementwise op.
+// CHECK-LABEL:   func.func @multi_result(
+// CHECK:           %[[FUSED:.*]]:2 = linalg.generic
+// CHECK-SAME:        outs(%{{.*}}, %{{.*}} : tensor<?x8xf32>, tensor<?x8xf16>)
+// CHECK:             math.tanh
+// CHECK:             arith.truncf
+// CHECK:             linalg.yield %{{.*}}, %{{.*}} : f32, f16
+// CHECK-NOT:       linalg.generic
+// CHECK-DAG:       torch_c.from_builtin_tensor %[[FUSED]]#0
+// CHECK-DAG:       torch_c.from_builtin_tensor %[[FUSED]]#1
+func.func @multi_result(%arg0: !torch.vtensor<[?,8],f32>) -> (!torch.vtensor<[?,8],f32>, !torch.vtensor<[?,8],f16>) {
+  %int5 = torch.constant.int 5
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[?,8],f32> -> !torch.vtensor<[?,8],f32>
+  %1 = torch.aten.to.dtype %0, %int5, %false, %false, %none : !torch.vtensor<[?,8],f32>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[?,8],f16>
+  return %0, %1 : !torch.vtensor<[?,8],f32>, !torch.vtensor<[?,8],f16>
+}
+
+// -----
+
+// An op whose result is broadcasted by its consumer stays separate.
+// CHECK-LABEL:   func.func @broadcasted_producer(
+// CHECK:           linalg.generic {{.*}} outs(%{{.*}} : tensor<8xf32>)
+// CHECK:           linalg.generic {{.*}} outs(%{{.*}} : tensor<4x8xf32>)
+func.func @broadcasted_producer(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %0 = torch.aten.exp %arg1 : !torch.vtensor<[8],f32> -> !torch.vtensor<[8],f32>
+  %1 = torch.aten.mul.Tensor %arg0, %0 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8],f32> -> !torch.vtensor<[4,8],f32>
+  return %1 : !torch.vtensor<[4,8],f32>
+}
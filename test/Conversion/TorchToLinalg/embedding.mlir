@@ -0,0 +1,51 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -canonicalize | FileCheck %s
+
+// CHECK-LABEL: func.func @embedding
+// CHECK-SAME:      %[[WEIGHT:.*]]: !torch.vtensor<[32000,4096],f16>
+// CHECK:         %[[W:.*]] = torch_c.to_builtin_tensor %[[WEIGHT]]
+// CHECK:         %[[FLAT:.*]] = tensor.collapse_shape %{{.*}} {{\[\[}}0, 1]] : tensor<2x8xi64> into tensor<16xi64>
+// CHECK:         %[[ROWS:.*]] = scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC:.*]] = %{{.*}}) -> (tensor<16x4096xf16>)
+// CHECK:           %[[INDEX:.*]] = tensor.extract %[[FLAT]][%[[IV]]] : tensor<16xi64>
+// CHECK:           cf.assert
+// CHECK:           cf.assert
+// CHECK:           %[[ROW:.*]] = arith.index_cast %[[INDEX]] : i64 to index
+// CHECK:           %[[SLICE:.*]] = tensor.extract_slice %[[W]][%[[ROW]], 0] [1, 4096] [1, 1] : tensor<32000x4096xf16> to tensor<1x4096xf16>
+// CHECK:           %[[INSERT:.*]] = tensor.insert_slice %[[SLICE]] into %[[ACC]][%[[IV]], 0] [1, 4096] [1, 1] : tensor<1x4096xf16> into tensor<16x4096xf16>
+// CHECK:           scf.yield %[[INSERT]]
+// CHECK:         tensor.expand_shape %[[ROWS]] {{\[\[}}0, 1], [2]] output_shape [2, 8, 4096] : tensor<16x4096xf16> into tensor<2x8x4096xf16>
+// CHECK-NOT:     linalg.generic
+func.func @embedding(%weight: !torch.vtensor<[32000,4096],f16>, %indices: !torch.vtensor<[2,8],si64>) -> !torch.vtensor<[2,8,4096],f16> {
+  %int-1 = torch.constant.int -1
+  %false = torch.constant.bool false
+  %0 = torch.aten.embedding %weight, %indices, %int-1, %false, %false : !torch.vtensor<[32000,4096],f16>, !torch.vtensor<[2,8],si64>, !torch.int, !torch.bool, !torch.bool -> !torch.vtensor<[2,8,4096],f16>
+  return %0 : !torch.vtensor<[2,8,4096],f16>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @index_select_dim1
+// CHECK:         scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC:.*]] = %{{.*}}) -> (tensor<4x2x6xf32>)
+// CHECK:           %[[SLICE:.*]] = tensor.extract_slice %{{.*}}[0, %{{.*}}, 0] [4, 1, 6] [1, 1, 1] : tensor<4x5x6xf32> to tensor<4x1x6xf32>
+// CHECK:           tensor.insert_slice %[[SLICE]] into %[[ACC]][0, %[[IV]], 0] [4, 1, 6] [1, 1, 1] : tensor<4x1x6xf32> into tensor<4x2x6xf32>
+func.func @index_select_dim1(%arg0: !torch.vtensor<[4,5,6],f32>, %arg1: !torch.vtensor<[2],si64>) -> !torch.vtensor<[4,2,6],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.index_select %arg0, %int1, %arg1 : !torch.vtensor<[4,5,6],f32>, !torch.int, !torch.vtensor<[2],si64> -> !torch.vtensor<[4,2,6],f32>
+  return %0 : !torch.vtensor<[4,2,6],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @index_tensor_leading_dims
+// CHECK:         %[[LINEAR:.*]] = linalg.generic {{.*}} ins(%{{.*}}, %{{.*}} : tensor<2x3xi64>, tensor<2x3xi64>) outs(%{{.*}} : tensor<2x3xi64>)
+// CHECK:         %[[INDICES:.*]] = tensor.collapse_shape %[[LINEAR]] {{\[\[}}0, 1]] : tensor<2x3xi64> into tensor<6xi64>
+// CHECK:         %[[INPUT:.*]] = tensor.collapse_shape %{{.*}} {{\[\[}}0, 1], [2]] : tensor<4x5x8xf32> into tensor<20x8xf32>
+// CHECK:         %[[GATHER:.*]] = scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[ACC:.*]] = %{{.*}}) -> (tensor<6x8xf32>)
+// CHECK:           tensor.extract %[[INDICES]][%[[IV]]] : tensor<6xi64>
+// CHECK:           %[[SLICE:.*]] = tensor.extract_slice %[[INPUT]][%{{.*}}, 0] [1, 8] [1, 1] : tensor<20x8xf32> to tensor<1x8xf32>
+// CHECK:           tensor.insert_slice %[[SLICE]] into %[[ACC]][%[[IV]], 0] [1, 8] [1, 1] : tensor<1x8xf32> into tensor<6x8xf32>
+// CHECK:         tensor.expand_shape %[[GATHER]] {{\[\[}}0, 1], [2]] output_shape [2, 3, 8] : tensor<6x8xf32> into tensor<2x3x8xf32>
+func.func @index_tensor_leading_dims(%arg0: !torch.vtensor<[4,5,8],f32>, %arg1: !torch.vtensor<[2,3],si64>, %arg2: !torch.vtensor<[2,3],si64>) -> !torch.vtensor<[2,3,8],f32> {
+  %0 = torch.prim.ListConstruct %arg1, %arg2 : (!torch.vtensor<[2,3],si64>, !torch.vtensor<[2,3],si64>) -> !torch.list<vtensor>
+  %1 = torch.aten.index.Tensor_hacked_twin %arg0, %0 : !torch.vtensor<[4,5,8],f32>, !torch.list<vtensor> -> !torch.vtensor<[2,3,8],f32>
+  return %1 : !torch.vtensor<[2,3,8],f32>
+}
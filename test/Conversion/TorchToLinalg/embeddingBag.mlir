@@ -1,8 +1,6 @@
 // RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -verify-diagnostics | FileCheck %s
 
-// CHECK: #[[$ATTR_0:.+]] = affine_map<(d0, d1, d2) -> (d1)>
-// CHECK: #[[$ATTR_1:.+]] = affine_map<(d0, d1, d2) -> (d0)>
-// CHECK: #[[$ATTR_2:.+]] = affine_map<(d0, d1, d2) -> (d0, d2)>
+// CHECK: #[[$MAP:.+]] = affine_map<(d0, d1) -> (d0, d1)>
 // CHECK-LABEL:   func.func @torchAtenEmbeddingBagPaddingIdx
 // CHECK:         %[[VAL_0:.*]]: !torch.vtensor<[1000000,64],f32>
 // CHECK:         %[[VAL_1:.*]]: !torch.vtensor<[204790],si64>
@@ -13,6 +11,31 @@
 // CHECK-DAG:     %[[VAL_6:.*]] = torch.constant.bool true
 // CHECK-DAG:     %[[VAL_7:.*]] = torch.constant.int 0
 // CHECK-DAG:     %[[VAL_8:.*]] = torch.constant.bool true
+// CHECK:         linalg.generic {indexing_maps = [#[[$MAP]]], iterator_types = ["parallel", "parallel"]} outs(%{{.*}} : tensor<2048x64xf32>)
+// CHECK:           %[[BAG:.*]] = linalg.index 0 : index
+// CHECK:           %[[COL:.*]] = linalg.index 1 : index
+// CHECK:           %[[START_RAW:.*]] = tensor.extract %[[VAL_3]][%[[BAG]]] : tensor<2048xi64>
+// CHECK:           %[[START:.*]] = arith.index_cast %[[START_RAW]] : i64 to index
+// CHECK:           %[[CHECK_LAST:.*]] = arith.cmpi eq, {{.*}}, {{.*}} : index
+// CHECK:           %[[SAFE_IDX:.*]] = arith.select %[[CHECK_LAST]], {{.*}}, {{.*}} : index
+// CHECK:           %[[NEXT_OFFSET_RAW:.*]] = tensor.extract %[[VAL_3]][%[[SAFE_IDX]]] : tensor<2048xi64>
+// CHECK:           %[[NEXT_OFFSET:.*]] = arith.index_cast %[[NEXT_OFFSET_RAW]] : i64 to index
+// CHECK:           %[[END:.*]] = arith.select %[[CHECK_LAST]], {{.*}}, %[[NEXT_OFFSET]] : index
+// CHECK:           scf.for %[[J:.*]] = %[[START]] to %[[END]] step %{{.*}} iter_args(%[[ACC:.*]] = %{{.*}}, %[[COUNT:.*]] = %{{.*}}) -> (f32, index)
+// CHECK:             %[[INDEX:.*]] = tensor.extract %[[VAL_4]][%[[J]]] : tensor<204790xi64>
+// CHECK:             %[[ROW:.*]] = arith.index_cast %[[INDEX]] : i64 to index
+// CHECK:             %[[ELEM:.*]] = tensor.extract %[[VAL_5]][%[[ROW]], %[[COL]]] : tensor<1000000x64xf32>
+// CHECK:             arith.addf %[[ACC]], %[[ELEM]] : f32
+func.func @torchAtenEmbeddingBagPaddingIdx
+// CHECK:         %[[VAL_0:.*]]: !torch.vtensor<[1000000,64],f32>
+// CHECK:         %[[VAL_1:.*]]: !torch.vtensor<[204790],si64>
+// CHECK:         %[[VAL_2:.*]]: !torch.vtensor<[2048],si64>
+// CHECK:         %[[VAL_3:.*]] = torch_c.to_builtin_tensor %[[VAL_2]] : !torch.vtensor<[2048],si64> -> tensor<2048xi64>
+// CHECK:         %[[VAL_4:.*]] = torch_c.to_builtin_tensor %[[VAL_1]] : !torch.vtensor<[204790],si64> -> tensor<204790xi64>
+// CHECK:         %[[VAL_5:.*]] = torch_c.to_builtin_tensor %[[VAL_0]] : !torch.vtensor<[1000000,64],f32> -> tensor<1000000x64xf32>
+// CHECK-DAG:     %[[VAL_6:.*]] = torch.constant.bool true
+// CHECK-DAG:     %[[VAL_7:.*]] = torch.constant.int 0
+// CHECK-DAG:     %[[VAL_8:.*]] = torch.constant.bool true
 // CHECK:         %[[CHECK_LAST:.*]] = arith.cmpi eq, {{.*}}, {{.*}} : i64
 // CHECK:         %[[ZERO_IDX:.*]] = arith.constant 0 : index
 // CHECK:         %[[SAFE_IDX:.*]] = arith.select %[[CHECK_LAST]], %[[ZERO_IDX]], {{.*}} : index
@@ -55,3 +78,47 @@ func.func @torchAtenEmbeddingBagPaddingIdx(%weight: !torch.vtensor<[1000000,64],
 
     return %result0, %result1, %result2, %result3 : !torch.vtensor<[2048,64],f32>, !torch.vtensor<[0],si64>, !torch.vtensor<[2048],si64>, !torch.vtensor<[2048],si64>
 }
+
+// -----
+
+// CHECK-LABEL:   func.func @embeddingBagMeanPerSampleWeights
+// CHECK:         linalg.generic {{.*}} iterator_types = ["parallel", "parallel"]} outs(%{{.*}} : tensor<4x8xf32>)
+// CHECK:           scf.for
+// CHECK:             %[[SAMPLE_WEIGHT:.*]] = tensor.extract %{{.*}}[%{{.*}}] : tensor<10xf32>
+// CHECK:             arith.mulf %{{.*}}, %[[SAMPLE_WEIGHT]] : f32
+// CHECK:             arith.addf
+// CHECK:           arith.sitofp
+// CHECK:           arith.divf
+// CHECK:           arith.select
+func.func @embeddingBagMeanPerSampleWeights(%weight: !torch.vtensor<[100,8],f32>, %indices: !torch.vtensor<[10],si64>, %offsets: !torch.vtensor<[4],si64>, %per_sample_weights: !torch.vtensor<[10],f32>) -> !torch.vtensor<[4,8],f32> {
+  %false = torch.constant.bool false
+  %mode = torch.constant.int 1
+  %none = torch.constant.none
+  %result0, %result1, %result2, %result3 = torch.aten.embedding_bag.padding_idx %weight, %indices, %offsets, %false, %mode, %false, %per_sample_weights, %false, %none : !torch.vtensor<[100,8],f32>, !torch.vtensor<[10],si64>, !torch.vtensor<[4],si64>, !torch.bool, !torch.int, !torch.bool, !torch.vtensor<[10],f32>, !torch.bool, !torch.none -> !torch.vtensor<[4,8],f32>, !torch.vtensor<[0],si64>, !torch.vtensor<[4],si64>, !torch.vtensor<[4],si64>
+  return %result0 : !torch.vtensor<[4,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @embeddingBagMaxPaddingIdx
+// CHECK:         %[[RESULTS:.*]]:2 = linalg.generic {{.*}} iterator_types = ["parallel", "parallel"]} outs(%{{.*}}, %{{.*}} : tensor<4x8xf32>, tensor<4x8xi64>)
+// CHECK:           scf.for {{.*}} -> (f32, index, i64)
+// CHECK:             arith.cmpf ugt
+// CHECK:             arith.ori
+// CHECK:             %[[PADDING:.*]] = arith.constant 3 : i64
+// CHECK:             %[[NOT_PADDING:.*]] = arith.cmpi ne, %{{.*}}, %[[PADDING]] : i64
+// CHECK:             arith.select %[[NOT_PADDING]]
+// CHECK:         scf.for {{.*}} -> (tensor<10xi64>)
+// CHECK:           tensor.extract_slice
+// CHECK:           linalg.fill
+// CHECK:           tensor.insert_slice
+// CHECK:         linalg.generic {{.*}} iterator_types = ["parallel"]} outs(%{{.*}} : tensor<4xi64>)
+// CHECK:         tensor.cast %[[RESULTS]]#1 : tensor<4x8xi64> to tensor<4x8xi64>
+func.func @embeddingBagMaxPaddingIdx(%weight: !torch.vtensor<[100,8],f32>, %indices: !torch.vtensor<[10],si64>, %offsets: !torch.vtensor<[4],si64>) -> (!torch.vtensor<[4,8],f32>, !torch.vtensor<[10],si64>, !torch.vtensor<[4],si64>, !torch.vtensor<[4,8],si64>) {
+  %false = torch.constant.bool false
+  %mode = torch.constant.int 2
+  %none = torch.constant.none
+  %int3 = torch.constant.int 3
+  %result0, %result1, %result2, %result3 = torch.aten.embedding_bag.padding_idx %weight, %indices, %offsets, %false, %mode, %false, %none, %false, %int3 : !torch.vtensor<[100,8],f32>, !torch.vtensor<[10],si64>, !torch.vtensor<[4],si64>, !torch.bool, !torch.int, !torch.bool, !torch.none, !torch.bool, !torch.int -> !torch.vtensor<[4,8],f32>, !torch.vtensor<[10],si64>, !torch.vtensor<[4],si64>, !torch.vtensor<[4,8],si64>
+  return %result0, %result1, %result2, %result3 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[10],si64>, !torch.vtensor<[4],si64>, !torch.vtensor<[4,8],si64>
+}
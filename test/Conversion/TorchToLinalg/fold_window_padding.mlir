@@ -0,0 +1,43 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="fold-window-padding=true" -canonicalize -split-input-file -mlir-print-local-scope | FileCheck %s
+
+// CHECK-LABEL:   func.func @conv2d_pad1(
+// CHECK-DAG:       %[[INPUT:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[1,3,8,8],f32> -> tensor<1x3x8x8xf32>
+// CHECK-DAG:       %[[WEIGHT:.*]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[4,3,3,3],f32> -> tensor<4x3x3x3xf32>
+// CHECK-NOT:       tensor.pad
+// CHECK:           linalg.generic {indexing_maps = [affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d1, d4, d5, d6)>, affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d1, d2, d3)>]
+// CHECK-SAME:      ins(%[[WEIGHT]] : tensor<4x3x3x3xf32>) outs(%{{.*}} : tensor<1x4x8x8xf32>)
+// CHECK:             %[[VALUE:.*]] = tensor.extract %[[INPUT]]
+// CHECK:             %[[PADDED:.*]] = arith.select %{{.*}}, %[[VALUE]], %{{.*}} : f32
+// CHECK:             arith.mulf %[[PADDED]]
+func.func @conv2d_pad1(%arg0: !torch.vtensor<[1,3,8,8],f32>, %arg1: !torch.vtensor<[4,3,3,3],f32>) -> !torch.vtensor<[1,4,8,8],f32> {
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.convolution %arg0, %arg1, %none, %0, %0, %0, %false, %1, %int1 : !torch.vtensor<[1,3,8,8],f32>, !torch.vtensor<[4,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,8,8],f32>
+  return %2 : !torch.vtensor<[1,4,8,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @max_pool2d_pad1(
+// CHECK-DAG:       %[[NEUTRAL:.*]] = arith.constant 0xFF800000 : f32
+// CHECK-DAG:       %[[INPUT:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[1,3,8,8],f32> -> tensor<1x3x8x8xf32>
+// CHECK-NOT:       tensor.pad
+// CHECK:           linalg.generic
+// CHECK-SAME:      ins(%{{.*}} : tensor<3x3xf32>) outs(%{{.*}} : tensor<1x3x8x8xf32>)
+// CHECK:             %[[VALUE:.*]] = tensor.extract %[[INPUT]]
+// CHECK:             %[[PADDED:.*]] = arith.select %{{.*}}, %[[VALUE]], %[[NEUTRAL]] : f32
+// CHECK:             arith.maximumf %{{.*}}, %[[PADDED]]
+func.func @max_pool2d_pad1(%arg0: !torch.vtensor<[1,3,8,8],f32>) -> !torch.vtensor<[1,3,8,8],f32> {
+  %int1 = torch.constant.int 1
+  %int3 = torch.constant.int 3
+  %false = torch.constant.bool false
+  %kernel_size = torch.prim.ListConstruct %int3, %int3 : (!torch.int, !torch.int) -> !torch.list<int>
+  %stride = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.max_pool2d %arg0, %kernel_size, %stride, %padding, %stride, %false : !torch.vtensor<[1,3,8,8],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool -> !torch.vtensor<[1,3,8,8],f32>
+  return %0 : !torch.vtensor<[1,3,8,8],f32>
+}
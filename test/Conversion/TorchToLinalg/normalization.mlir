@@ -0,0 +1,54 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -canonicalize | FileCheck %s
+
+// CHECK-DAG:   #[[ID:.*]] = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+// CHECK-DAG:   #[[ROW:.*]] = affine_map<(d0, d1, d2) -> (d0, d1)>
+// CHECK-DAG:   #[[TRAILING:.*]] = affine_map<(d0, d1, d2) -> (d2)>
+// CHECK-LABEL: func.func @native_layer_norm
+// CHECK:         %[[STATS:.*]]:3 = linalg.generic {indexing_maps = [#[[ID]], #[[ROW]], #[[ROW]], #[[ROW]]], iterator_types = ["parallel", "parallel", "reduction"]}
+// CHECK-SAME:      outs(%{{.*}}, %{{.*}}, %{{.*}} : tensor<2x4xi64>, tensor<2x4xf32>, tensor<2x4xf32>)
+// CHECK:           arith.addi
+// CHECK:           arith.sitofp
+// CHECK:           arith.divf
+// CHECK:           arith.mulf
+// CHECK:         %[[RSTD:.*]] = linalg.generic
+// CHECK-SAME:      ins(%[[STATS]]#2 : tensor<2x4xf32>)
+// CHECK:           math.rsqrt
+// CHECK:         linalg.generic {indexing_maps = [#[[ID]], #[[ROW]], #[[ROW]], #[[TRAILING]], #[[TRAILING]], #[[ID]]], iterator_types = ["parallel", "parallel", "parallel"]}
+// CHECK-SAME:      ins(%{{.*}}, %[[STATS]]#1, %[[RSTD]], %{{.*}}, %{{.*}} : tensor<2x4x8xf32>, tensor<2x4xf32>, tensor<2x4xf32>, tensor<8xf32>, tensor<8xf32>)
+// CHECK-NOT:     linalg.generic
+// CHECK:         tensor.expand_shape %[[STATS]]#1 {{\[\[}}0], [1, 2]] output_shape [2, 4, 1]
+// CHECK:         tensor.expand_shape %[[RSTD]] {{\[\[}}0], [1, 2]] output_shape [2, 4, 1]
+func.func @native_layer_norm(%arg0: !torch.vtensor<[2,4,8],f32>, %arg1: !torch.vtensor<[8],f32>, %arg2: !torch.vtensor<[8],f32>) -> (!torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,4,1],f32>, !torch.vtensor<[2,4,1],f32>) {
+  %int8 = torch.constant.int 8
+  %float1e-05 = torch.constant.float 1.000000e-05
+  %0 = torch.prim.ListConstruct %int8 : (!torch.int) -> !torch.list<int>
+  %result0, %result1, %result2 = torch.aten.native_layer_norm %arg0, %0, %arg1, %arg2, %float1e-05 : !torch.vtensor<[2,4,8],f32>, !torch.list<int>, !torch.vtensor<[8],f32>, !torch.vtensor<[8],f32>, !torch.float -> !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,4,1],f32>, !torch.vtensor<[2,4,1],f32>
+  return %result0, %result1, %result2 : !torch.vtensor<[2,4,8],f32>, !torch.vtensor<[2,4,1],f32>, !torch.vtensor<[2,4,1],f32>
+}
+
+// -----
+
+// CHECK-DAG:   #[[ID:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG:   #[[ROW:.*]] = affine_map<(d0, d1) -> (d0)>
+// CHECK-DAG:   #[[TRAILING:.*]] = affine_map<(d0, d1) -> (d1)>
+// CHECK-LABEL: func.func @rms_norm
+// CHECK:         %[[SUM:.*]] = linalg.generic {indexing_maps = [#[[ID]], #[[ROW]]], iterator_types = ["parallel", "reduction"]}
+// CHECK-SAME:      ins(%{{.*}} : tensor<4x?xf16>) outs(%{{.*}} : tensor<4xf32>)
+// CHECK:           arith.extf
+// CHECK:           arith.mulf
+// CHECK:           arith.addf
+// CHECK:         linalg.generic {indexing_maps = [#[[ID]], #[[ROW]], #[[TRAILING]], #[[ID]]], iterator_types = ["parallel", "parallel"]}
+// CHECK-SAME:      ins(%{{.*}}, %[[SUM]], %{{.*}} : tensor<4x?xf16>, tensor<4xf32>, tensor<?xf16>)
+// CHECK:           arith.divf
+// CHECK:           arith.addf
+// CHECK:           math.rsqrt
+// CHECK:           arith.truncf
+// CHECK-NOT:     linalg.generic
+func.func @rms_norm(%arg0: !torch.vtensor<[4,?],f16>, %arg1: !torch.vtensor<[?],f16>) -> !torch.vtensor<[4,?],f16> {
+  %int-1 = torch.constant.int -1
+  %float1e-06 = torch.constant.float 1.000000e-06
+  %dim = torch.aten.size.int %arg0, %int-1 : !torch.vtensor<[4,?],f16>, !torch.int -> !torch.int
+  %0 = torch.prim.ListConstruct %dim : (!torch.int) -> !torch.list<int>
+  %1 = torch.aten.rms_norm %arg0, %0, %arg1, %float1e-06 : !torch.vtensor<[4,?],f16>, !torch.list<int>, !torch.vtensor<[?],f16>, !torch.float -> !torch.vtensor<[4,?],f16>
+  return %1 : !torch.vtensor<[4,?],f16>
+}
@@ -0,0 +1,16 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg=pattern-statistics -o /dev/null 2>&1 | FileCheck %s
+// RUN: torch-mlir-opt <%s -pass-pipeline='builtin.module(func.func(convert-torch-to-linalg{pattern-statistics=true}))' -o /dev/null 2>&1 | FileCheck %s
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -o /dev/null 2>&1 | FileCheck %s --check-prefix=DISABLED
+
+// CHECK:      ===- Pattern statistics of convert-torch-to-linalg on @forward -===
+// CHECK-NEXT:   attempts  successes    time (ms)  pattern
+// CHECK-DAG:           1          1 {{.*}}ConvertAtenMmOp
+// CHECK-DAG:  {{[0-9]+}}          1 {{.*}}ConvertElementwiseOp
+// CHECK:      total of {{[0-9]+}} patterns
+
+// DISABLED-NOT: Pattern statistics
+func.func @forward(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[8,2],f32>) -> !torch.vtensor<[4,2],f32> {
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,2],f32> -> !torch.vtensor<[4,2],f32>
+  %1 = torch.aten.tanh %0 : !torch.vtensor<[4,2],f32> -> !torch.vtensor<[4,2],f32>
+  return %1 : !torch.vtensor<[4,2],f32>
+}
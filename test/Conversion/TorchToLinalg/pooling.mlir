@@ -49,6 +49,35 @@ func.func @forward_max_pool2d(%arg0: !torch.vtensor<[?,?,?,?],f32>) -> !torch.vt
 
 // -----
 
+// CHECK-DAG: #[[IN:.*]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d2 * 2 + d4, d3 * 2 + d5)>
+// CHECK-DAG: #[[KERNEL:.*]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d4, d5)>
+// CHECK-DAG: #[[OUT:.*]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d2, d3)>
+// CHECK-LABEL: func @forward_max_pool2d_with_indices
+func.func @forward_max_pool2d_with_indices(%arg0: !torch.vtensor<[1,3,8,8],f32>) -> (!torch.vtensor<[1,3,4,4],f32>, !torch.vtensor<[1,3,4,4],si64>) {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %false = torch.constant.bool false
+  // CHECK: %[[NEUTRAL:.*]] = arith.constant 0xFF800000 : f32
+  // CHECK: %[[VALUES:.*]] = linalg.fill ins(%[[NEUTRAL]] : f32) outs(%{{.*}} : tensor<1x3x4x4xf32>) -> tensor<1x3x4x4xf32>
+  // CHECK: %[[MINUS_ONE:.*]] = arith.constant -1 : i64
+  // CHECK: %[[INDICES:.*]] = linalg.fill ins(%[[MINUS_ONE]] : i64) outs(%{{.*}} : tensor<1x3x4x4xi64>) -> tensor<1x3x4x4xi64>
+  // CHECK: %[[POOL:.*]]:2 = linalg.generic {indexing_maps = [#[[IN]], #[[KERNEL]], #[[OUT]], #[[OUT]]], iterator_types = ["parallel", "parallel", "parallel", "parallel", "reduction", "reduction"]}
+  // CHECK-SAME: outs(%[[VALUES]], %[[INDICES]] : tensor<1x3x4x4xf32>, tensor<1x3x4x4xi64>)
+  // CHECK:   arith.cmpf ogt
+  // CHECK:   arith.cmpf oeq
+  // CHECK:   linalg.yield %{{.*}}, %{{.*}} : f32, i64
+  // CHECK-NOT: linalg.generic
+  %kernel_size = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %stride = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %dilation = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %result0, %result1 = torch.aten.max_pool2d_with_indices %arg0, %kernel_size, %stride, %padding, %dilation, %false : !torch.vtensor<[1,3,8,8],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool -> !torch.vtensor<[1,3,4,4],f32>, !torch.vtensor<[1,3,4,4],si64>
+  return %result0, %result1 : !torch.vtensor<[1,3,4,4],f32>, !torch.vtensor<[1,3,4,4],si64>
+}
+
+// -----
+
 // CHECK: #map = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 floordiv 2, d3 floordiv 2)>
 // CHECK: #map1 = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
 // CHECK-LABEL: func @forward_max_unpool2d
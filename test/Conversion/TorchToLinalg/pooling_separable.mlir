@@ -0,0 +1,86 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg=separable-pooling -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-LABEL: func @forward_max_pool2d
+func.func @forward_max_pool2d(%arg0: !torch.vtensor<[1,3,64,56],f32>) -> !torch.vtensor<[1,3,32,28],f32> {
+  // CHECK: %[[PADDED:.*]] = tensor.pad
+  // CHECK: %[[ROWS:.*]] = linalg.pooling_nchw_max {dilations = dense<1> : vector<2xi64>, strides = dense<[1, 2]> : vector<2xi64>} ins(%[[PADDED]], %{{.*}} : tensor<1x3x66x58xf32>, tensor<1x3xf32>) outs(%{{.*}} : tensor<1x3x66x28xf32>) -> tensor<1x3x66x28xf32>
+  // CHECK: linalg.pooling_nchw_max {dilations = dense<1> : vector<2xi64>, strides = dense<[2, 1]> : vector<2xi64>} ins(%[[ROWS]], %{{.*}} : tensor<1x3x66x28xf32>, tensor<3x1xf32>) outs(%{{.*}} : tensor<1x3x32x28xf32>) -> tensor<1x3x32x28xf32>
+  // CHECK-NOT: linalg.pooling_nchw_max
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %int3 = torch.constant.int 3
+  %false = torch.constant.bool false
+  %kernel_size = torch.prim.ListConstruct %int3, %int3 : (!torch.int, !torch.int) -> !torch.list<int>
+  %stride = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %dilation = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.max_pool2d %arg0, %kernel_size, %stride, %padding, %dilation, %false : !torch.vtensor<[1,3,64,56],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool -> !torch.vtensor<[1,3,32,28],f32>
+  return %0 : !torch.vtensor<[1,3,32,28],f32>
+}
+
+// -----
+
+// A dilated window is not separable.
+
+// CHECK-LABEL: func @forward_max_pool2d_dilated
+func.func @forward_max_pool2d_dilated(%arg0: !torch.vtensor<[1,3,64,56],f32>) -> !torch.vtensor<[1,3,31,27],f32> {
+  // CHECK: linalg.pooling_nchw_max {dilations = dense<2> : vector<2xi64>, strides = dense<2> : vector<2xi64>} ins(%{{.*}}, %{{.*}} : tensor<1x3x66x58xf32>, tensor<3x3xf32>)
+  // CHECK-NOT: linalg.pooling_nchw_max
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %int3 = torch.constant.int 3
+  %false = torch.constant.bool false
+  %kernel_size = torch.prim.ListConstruct %int3, %int3 : (!torch.int, !torch.int) -> !torch.list<int>
+  %stride = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %padding = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %dilation = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.max_pool2d %arg0, %kernel_size, %stride, %padding, %dilation, %false : !torch.vtensor<[1,3,64,56],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool -> !torch.vtensor<[1,3,31,27],f32>
+  return %0 : !torch.vtensor<[1,3,31,27],f32>
+}
+
+// -----
+
+// The depth dim, with a unit window and stride, is not pooled at all.
+
+// CHECK-LABEL: func @forward_avg_pool3d
+func.func @forward_avg_pool3d(%arg0: !torch.vtensor<[1,3,7,64,56],f32>) -> !torch.vtensor<[1,3,7,31,54],f32> {
+  // CHECK: %[[ROWS:.*]] = linalg.pooling_ndhwc_sum {dilations = dense<1> : vector<3xi64>, strides = dense<1> : vector<3xi64>} ins(%{{.*}}, %{{.*}} : tensor<1x7x66x58x3xf32>, tensor<1x1x5xf32>) outs(%{{.*}} : tensor<1x7x66x54x3xf32>) -> tensor<1x7x66x54x3xf32>
+  // CHECK: linalg.pooling_ndhwc_sum {dilations = dense<1> : vector<3xi64>, strides = dense<[1, 2, 1]> : vector<3xi64>} ins(%[[ROWS]], %{{.*}} : tensor<1x7x66x54x3xf32>, tensor<1x5x1xf32>) outs(%{{.*}} : tensor<1x7x31x54x3xf32>) -> tensor<1x7x31x54x3xf32>
+  // CHECK-NOT: linalg.pooling_ndhwc_sum
+  // CHECK: arith.divf
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %true = torch.constant.bool true
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %int5 = torch.constant.int 5
+  %0 = torch.prim.ListConstruct %int1, %int5, %int5 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int1, %int2, %int1 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct %int0, %int1, %int1 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.aten.avg_pool3d %arg0, %0, %1, %2, %false, %true, %none : !torch.vtensor<[1,3,7,64,56],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[1,3,7,31,54],f32>
+  return %3 : !torch.vtensor<[1,3,7,31,54],f32>
+}
+
+// -----
+
+// CHECK-DAG: #[[TAP:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d4)>
+// CHECK-DAG: #[[OUT:.*]] = affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2, d3)>
+// CHECK-LABEL: func @forward_adaptive_avg_pool2d
+func.func @forward_adaptive_avg_pool2d(%arg0: !torch.vtensor<[1,3,7,10],f32>) -> !torch.vtensor<[1,3,3,4],f32> {
+  // CHECK: linalg.generic {indexing_maps = [#[[TAP]], #[[OUT]]], iterator_types = ["parallel", "parallel", "parallel", "parallel", "reduction"]}
+  // CHECK:   tensor.extract %{{.*}} : tensor<1x3x7x10xf32>
+  // CHECK:   arith.addf
+  // CHECK: linalg.generic {indexing_maps = [#[[TAP]], #[[OUT]]], iterator_types = ["parallel", "parallel", "parallel", "parallel", "reduction"]}
+  // CHECK:   tensor.extract
+  // CHECK:   arith.addf
+  // CHECK: linalg.generic
+  // CHECK:   arith.sitofp
+  // CHECK:   arith.divf
+  // CHECK-NOT: linalg.generic
+  %int3 = torch.constant.int 3
+  %int4 = torch.constant.int 4
+  %output_size = torch.prim.ListConstruct %int3, %int4 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.adaptive_avg_pool2d %arg0, %output_size : !torch.vtensor<[1,3,7,10],f32>, !torch.list<int> -> !torch.vtensor<[1,3,3,4],f32>
+  return %0 : !torch.vtensor<[1,3,3,4],f32>
+}
@@ -83,3 +83,37 @@ func.func @standalone_quantize_si8(
       -> !torch.vtensor<[4,8],si8>
   return %out : !torch.vtensor<[4,8],si8>
 }
+
+// -----
+
+// Per-channel quantize — the scale and zero point of each channel are read
+// through a broadcast map on the channel dim, in the same generic.
+//
+// CHECK-DAG: #[[$ID:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG: #[[$CHANNEL:.*]] = affine_map<(d0, d1) -> (d1)>
+// CHECK-LABEL: func.func @quantize_per_channel_ui8(
+// CHECK:       %[[GEN:.*]] = linalg.generic
+// CHECK-SAME:    indexing_maps = [#[[$ID]], #[[$CHANNEL]], #[[$CHANNEL]], #[[$ID]]]
+// CHECK-SAME:    ins(%{{.*}}, %{{.*}}, %{{.*}} : tensor<4x8xf32>, tensor<8xf32>, tensor<8xi8>) outs(%{{.*}} : tensor<4x8xi8>)
+// CHECK:       ^bb0(%[[IN:.*]]: f32, %[[SCALE:.*]]: f32, %[[ZP:.*]]: i8, %{{.*}}: i8):
+// CHECK:         %[[ZP_F:.*]] = arith.uitofp %[[ZP]] : i8 to f32
+// CHECK:         %[[QMIN:.*]] = arith.constant 0.000000e+00 : f32
+// CHECK:         %[[QMAX:.*]] = arith.constant 2.550000e+02 : f32
+// CHECK:         %[[DIV:.*]] = arith.divf %[[IN]], %[[SCALE]] : f32
+// CHECK:         %[[RND:.*]] = math.roundeven %[[DIV]] : f32
+// CHECK:         %[[ADD:.*]] = arith.addf %[[RND]], %[[ZP_F]] : f32
+// CHECK:         %[[CLAMP_LO:.*]] = arith.maximumf %[[ADD]], %[[QMIN]] : f32
+// CHECK:         %[[CLAMP_HI:.*]] = arith.minimumf %[[CLAMP_LO]], %[[QMAX]] : f32
+// CHECK:         %[[Q:.*]] = arith.fptoui %[[CLAMP_HI]] : f32 to i8
+// CHECK:         linalg.yield %[[Q]] : i8
+func.func @quantize_per_channel_ui8(
+    %input: !torch.vtensor<[4,8],f32>, %scales: !torch.vtensor<[8],f32>,
+    %zps: !torch.vtensor<[8],ui8>) -> !torch.vtensor<[4,8],ui8> {
+  %axis  = torch.constant.int 1
+  %dtype = torch.constant.int 13
+  %q = torch.aten.quantize_per_channel %input, %scales, %zps, %axis, %dtype
+      : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8],f32>, !torch.vtensor<[8],ui8>, !torch.int, !torch.int
+      -> !torch.vtensor<[4,8],!torch.quint8>
+  %out = torch.aten.int_repr %q : !torch.vtensor<[4,8],!torch.quint8> -> !torch.vtensor<[4,8],ui8>
+  return %out : !torch.vtensor<[4,8],ui8>
+}
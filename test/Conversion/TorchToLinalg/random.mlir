@@ -0,0 +1,52 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="rng=philox" -split-input-file -canonicalize | FileCheck %s
+
+// CHECK-LABEL: func.func @uniform_philox
+// CHECK:         %[[SEED:.*]] = torch_c.get_next_seed : () -> i64
+// CHECK:         %[[LANES:.*]]:4 = linalg.generic {{.*}} iterator_types = ["parallel"]} outs(%{{.*}}, %{{.*}}, %{{.*}}, %{{.*}} : tensor<6xf32>, tensor<6xf32>, tensor<6xf32>, tensor<6xf32>)
+// CHECK-COUNT-20:  arith.mului_extended {{.*}} : i32
+// CHECK-NOT:       arith.muli {{.*}} : i64
+// CHECK:           arith.uitofp {{.*}} : i32 to f64
+// CHECK:           linalg.yield {{.*}} : f32, f32, f32, f32
+// CHECK:         %[[FLAT:.*]] = tensor.concat dim(0) %[[LANES]]#0, %[[LANES]]#1, %[[LANES]]#2, %[[LANES]]#3
+// CHECK:         tensor.expand_shape %[[FLAT]] {{\[\[}}0, 1]] output_shape [4, 6] : tensor<24xf32> into tensor<4x6xf32>
+func.func @uniform_philox(%arg0: !torch.vtensor<[4,6],f32>) -> !torch.vtensor<[4,6],f32> {
+  %float0 = torch.constant.float 0.000000e+00
+  %float1 = torch.constant.float 1.000000e+00
+  %none = torch.constant.none
+  %0 = torch.aten.uniform %arg0, %float0, %float1, %none : !torch.vtensor<[4,6],f32>, !torch.float, !torch.float, !torch.none -> !torch.vtensor<[4,6],f32>
+  return %0 : !torch.vtensor<[4,6],f32>
+}
+
+// -----
+
+// f64 samples need more than 32 random bits, so they keep using Squares64.
+// CHECK-LABEL: func.func @uniform_f64
+// CHECK-NOT:     arith.mului_extended
+// CHECK:         arith.muli {{.*}} : i64
+func.func @uniform_f64(%arg0: !torch.vtensor<[4,6],f64>) -> !torch.vtensor<[4,6],f64> {
+  %float0 = torch.constant.float 0.000000e+00
+  %float1 = torch.constant.float 1.000000e+00
+  %none = torch.constant.none
+  %0 = torch.aten.uniform %arg0, %float0, %float1, %none : !torch.vtensor<[4,6],f64>, !torch.float, !torch.float, !torch.none -> !torch.vtensor<[4,6],f64>
+  return %0 : !torch.vtensor<[4,6],f64>
+}
+
+// -----
+
+// The CDFs are computed once per distribution, in parallel, and the samples
+// are drawn in parallel, each by a binary search in the CDF of its row.
+// CHECK-LABEL: func.func @multinomial
+// CHECK:         %[[CDF:.*]] = scf.forall (%[[ROW:.*]]) in (4) shared_outs(%[[OUT:.*]] = %{{.*}}) -> (tensor<4x128xf64>) {
+// CHECK:           %[[CUM:.*]]:2 = scf.for
+// CHECK:           scf.forall.in_parallel {
+// CHECK:             tensor.parallel_insert_slice %[[CUM]]#1 into %[[OUT]][%[[ROW]], 0] [1, 128] [1, 1] : tensor<128xf64> into tensor<4x128xf64>
+// CHECK:         %[[SEED:.*]] = torch_c.get_next_seed : () -> i64
+// CHECK:         linalg.generic {{.*}} iterator_types = ["parallel", "parallel"]} outs(%{{.*}} : tensor<4x?xi64>)
+// CHECK:           scf.while
+// CHECK:             tensor.extract %[[CDF]]
+func.func @multinomial(%arg0: !torch.vtensor<[4,128],f32>, %arg1: !torch.int) -> !torch.vtensor<[4,?],si64> {
+  %true = torch.constant.bool true
+  %none = torch.constant.none
+  %0 = torch.aten.multinomial %arg0, %arg1, %true, %none : !torch.vtensor<[4,128],f32>, !torch.int, !torch.bool, !torch.none -> !torch.vtensor<[4,?],si64>
+  return %0 : !torch.vtensor<[4,?],si64>
+}
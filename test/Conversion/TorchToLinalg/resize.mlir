@@ -4,14 +4,11 @@
 func.func @test_resize_sizes_linear(%arg0: !torch.vtensor<[1,1,2,4],f32>, %arg1: !torch.vtensor<[4]
 ,si64>) -> !torch.vtensor<[?,?,?,?],f32> attributes {torch.onnx_meta.ir_version = 7 : si64, torch.onnx_meta.opset_version = 19 : si64, torch.onnx_meta.producer_name = "backend-test", torch.onnx_meta.producer_version = ""} {
     // CHECK: %[[x0:.*]] = torch_c.to_builtin_tensor %arg0
-    // CHECK: %[[generic:.*]] = linalg.generic
+    // CHECK: %[[TAPS_H:.*]]:4 = linalg.generic {{.*}} outs(%{{.*}}, %{{.*}}, %{{.*}}, %{{.*}} : tensor<?xi64>, tensor<?xi64>, tensor<?xf32>, tensor<?xf32>)
+    // CHECK-DAG: %[[x17:.*]] = linalg.index 0 : index
     // CHECK-DAG: %[[cst:.*]] = arith.constant 1.000000e+00 : f32
     // CHECK-DAG: %[[cst_4:.*]] = arith.constant 5.000000e-01 : f32
     // CHECK-DAG: %[[cst_5:.*]] = arith.constant 0.000000e+00 : f32
-    // CHECK-DAG: %[[x15:.*]] = linalg.index 0 : index
-    // CHECK-DAG: %[[x16:.*]] = linalg.index 1 : index
-    // CHECK-DAG: %[[x17:.*]] = linalg.index 2 : index
-    // CHECK-DAG: %[[x18:.*]] = linalg.index 3 : index
     // CHECK: %[[x19:.*]] = arith.sitofp %[[x6:.*]] : i64 to f32
     // CHECK: %[[x20:.*]] = arith.sitofp %[[x8:.*]] : i64 to f32
     // CHECK-DAG: %[[x21:.*]] = arith.divf %[[x20]], %[[x19]] : f32
@@ -21,28 +18,41 @@ func.func @test_resize_sizes_linear(%arg0: !torch.vtensor<[1,1,2,4],f32>, %arg1:
     // CHECK-DAG: %[[x25:.*]] = arith.divf %[[x24]], %[[x21]] : f32
     // CHECK-DAG: %[[x26:.*]] = arith.subf %[[x25]], %[[cst_4]] : f32
     // CHECK-DAG: %[[x27:.*]] = arith.maximumf %[[x26]], %[[cst_5]] : f32
-    // CHECK-DAG: %[[x28:.*]] = arith.subf %[[x19]], %cst_4 : f32
+    // CHECK-DAG: %[[x28:.*]] = arith.subf %[[x19]], %[[cst]] : f32
     // CHECK-DAG: %[[x29:.*]] = arith.minimumf %[[x27]], %[[x28]] : f32
-    // CHECK-DAG: %[[x30:.*]] = math.floor %[[x29]] : f32
-    // CHECK-DAG: %[[x31:.*]] = arith.addf %[[cst]], %[[x29]] : f32
-    // CHECK-DAG: %[[x32:.*]] = math.floor %[[x31]] : f32
-    // CHECK-DAG: %[[x33:.*]] = arith.fptosi %[[x30]] : f32 to i64
-    // CHECK-DAG: %[[x34:.*]] = arith.index_cast %[[x33]] : i64 to index
-    // CHECK-DAG: %[[x35:.*]] = arith.minimumf %44, %42 : f32
-    // CHECK-DAG: %[[x36:.*]] = arith.fptosi %[[x35]] : f32 to i64
-    // CHECK-DAG: %[[x37:.*]] = arith.index_cast %[[x36]] : i64 to index
-    // CHECK: %[[extracted:.*]] = tensor.extract %[[x0]][%[[x15]], %[[x16]], %[[x34]], %[[low:.*]]] : tensor<1x1x2x4xf32>
-    // CHECK: %[[extracted_7:.*]] = tensor.extract %[[x0]][%[[x15]], %[[x16]], %[[x34]], %[[high:.*]]] : tensor<1x1x2x4xf32>
+    // CHECK: %[[inputFP:.*]] = arith.sitofp %[[x6]] : i64 to f32
+    // CHECK: %[[inputSubOne:.*]] = arith.subf %[[inputFP]], %[[cst]] : f32
+    // CHECK: %[[x30:.*]] = math.floor %[[x29]] : f32
+    // CHECK: %[[x31:.*]] = arith.addf %[[cst]], %[[x29]] : f32
+    // CHECK: %[[x32:.*]] = math.floor %[[x31]] : f32
+    // CHECK: %[[x33:.*]] = arith.fptosi %[[x30]] : f32 to i64
+    // CHECK: %[[x35:.*]] = arith.minimumf %[[x31]], %[[inputSubOne]] : f32
+    // CHECK: %[[x36:.*]] = arith.fptosi %[[x35]] : f32 to i64
+    // CHECK: %[[dy0:.*]] = arith.subf %[[x32]], %[[x29]] : f32
+    // CHECK: %[[dy1:.*]] = arith.subf %[[x29]], %[[x30]] : f32
+    // CHECK: linalg.yield %[[x33]], %[[x36]], %[[dy0]], %[[dy1]] : i64, i64, f32, f32
+    // CHECK: %[[TAPS_W:.*]]:4 = linalg.generic {{.*}} outs(%{{.*}}, %{{.*}}, %{{.*}}, %{{.*}} : tensor<?xi64>, tensor<?xi64>, tensor<?xf32>, tensor<?xf32>)
+    // CHECK: linalg.yield %{{.*}}, %{{.*}}, %{{.*}}, %{{.*}} : i64, i64, f32, f32
+    // CHECK: linalg.generic {{.*}} ins(%[[TAPS_H]]#0, %[[TAPS_H]]#1, %[[TAPS_H]]#2, %[[TAPS_H]]#3, %[[TAPS_W]]#0, %[[TAPS_W]]#1, %[[TAPS_W]]#2, %[[TAPS_W]]#3 : tensor<?xi64>, tensor<?xi64>, tensor<?xf32>, tensor<?xf32>, tensor<?xi64>, tensor<?xi64>, tensor<?xf32>, tensor<?xf32>)
+    // CHECK: ^bb0(%[[LOW_H:[^:]*]]: i64, %[[HIGH_H:[^:]*]]: i64, %[[dy0:[^:]*]]: f32, %[[dy1:[^:]*]]: f32, %[[LOW_W:[^:]*]]: i64, %[[HIGH_W:[^:]*]]: i64, %[[dx0:[^:]*]]: f32, %[[dx1:[^:]*]]: f32, %{{.*}}: f32):
+    // CHECK: %[[x15:.*]] = linalg.index 0 : index
+    // CHECK: %[[x16:.*]] = linalg.index 1 : index
+    // CHECK: %[[x34:.*]] = arith.index_cast %[[LOW_H]] : i64 to index
+    // CHECK: %[[x37:.*]] = arith.index_cast %[[HIGH_H]] : i64 to index
+    // CHECK: %[[low:.*]] = arith.index_cast %[[LOW_W]] : i64 to index
+    // CHECK: %[[high:.*]] = arith.index_cast %[[HIGH_W]] : i64 to index
+    // CHECK: %[[extracted:.*]] = tensor.extract %[[x0]][%[[x15]], %[[x16]], %[[x34]], %[[low]]] : tensor<1x1x2x4xf32>
+    // CHECK: %[[extracted_7:.*]] = tensor.extract %[[x0]][%[[x15]], %[[x16]], %[[x34]], %[[high]]] : tensor<1x1x2x4xf32>
     // CHECK: %[[extracted_8:.*]] = tensor.extract %[[x0]][%[[x15]], %[[x16]], %[[x37]], %[[low]]] : tensor<1x1x2x4xf32>
     // CHECK: %[[extracted_9:.*]] = tensor.extract %[[x0]][%[[x15]], %[[x16]], %[[x37]], %[[high]]] : tensor<1x1x2x4xf32>
-    // CHECK: %[[dx0p00:.*]] = arith.mulf %[[dx0:.*]], %[[extracted]]
-    // CHECK: %[[dx1p01:.*]] = arith.mulf %[[dx1:.*]], %[[extracted_7]]
+    // CHECK: %[[dx0p00:.*]] = arith.mulf %[[dx0]], %[[extracted]]
+    // CHECK: %[[dx1p01:.*]] = arith.mulf %[[dx1]], %[[extracted_7]]
     // CHECK: %[[sum:.*]] = arith.addf %[[dx0p00]], %[[dx1p01]]
-    // CHECK: %[[left:.*]] = arith.mulf %[[dy0:.*]], %[[sum]]
+    // CHECK: %[[left:.*]] = arith.mulf %[[dy0]], %[[sum]]
     // CHECK: %[[dx0p10:.*]] = arith.mulf %[[dx0]], %[[extracted_8]]
     // CHECK: %[[dx1p11:.*]] = arith.mulf %[[dx1]], %[[extracted_9]]
     // CHECK: %[[sum2:.*]] = arith.addf %[[dx0p10]], %[[dx1p11]]
-    // CHECK: %[[right:.*]] = arith.mulf %[[dy1:.*]], %[[sum2]]
+    // CHECK: %[[right:.*]] = arith.mulf %[[dy1]], %[[sum2]]
     // CHECK: %[[retval:.*]] = arith.addf %[[left]], %[[right]]
     %none = torch.constant.none
     %none_0 = torch.constant.none
@@ -65,11 +75,8 @@ func.func @test_resize_sizes_linear(%arg0: !torch.vtensor<[1,1,2,4],f32>, %arg1:
 
 // CHECK-LABEL: func.func @test_resize_sizes_nearest
 func.func @test_resize_sizes_nearest(%arg0: !torch.vtensor<[1,1,2,4],f32>, %arg1: !torch.vtensor<[4],si64>) -> !torch.vtensor<[?,?,?,?],f32> attributes {torch.onnx_meta.ir_version = 7 : si64, torch.onnx_meta.opset_version = 19 : si64, torch.onnx_meta.producer_name = "backend-test", torch.onnx_meta.producer_version = ""} {
-    // CHECK: %[[GENERIC:.*]] = linalg.generic
-    // CHECK: %[[x11:.*]] = linalg.index 0 : index
-    // CHECK: %[[x12:.*]] = linalg.index 1 : index
-    // CHECK: %[[x13:.*]] = linalg.index 2 : index
-    // CHECK: %[[x14:.*]] = linalg.index 3 : index
+    // CHECK: %[[NEAREST_0:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<?xi64>)
+    // CHECK: %[[x13:.*]] = linalg.index 0 : index
     // CHECK: %[[x15:.*]] = arith.sitofp %[[c2_i64:.*]] : i64 to f32
     // CHECK: %[[x19:.*]] = arith.sitofp %[[x6:.*]] : i64 to f32
     // CHECK: %[[x21:.*]] = arith.divf %[[x19]], %[[x15]] : f32
@@ -83,7 +90,9 @@ func.func @test_resize_sizes_nearest(%arg0: !torch.vtensor<[1,1,2,4],f32>, %arg1
     // CHECK: %[[clH1:.*]] = arith.maximumf %[[floorH]], %[[c0H]] : f32
     // CHECK: %[[clH2:.*]] = arith.minimumf %[[clH1]], %[[inLm1H]] : f32
     // CHECK: %[[x31:.*]] = arith.fptosi %[[clH2]] : f32 to i64
-    // CHECK: %[[x32:.*]] = arith.index_cast %[[x31]] : i64 to index
+    // CHECK: linalg.yield %[[x31]] : i64
+    // CHECK: %[[NEAREST_1:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<?xi64>)
+    // CHECK: %[[x14:.*]] = linalg.index 0 : index
     // CHECK: %[[x16:.*]] = arith.sitofp %[[c4_i64:.*]] : i64 to f32
     // CHECK: %[[x20:.*]] = arith.sitofp %[[x7:.*]] : i64 to f32
     // CHECK: %[[x22:.*]] = arith.divf %[[x20]], %[[x16]] : f32
@@ -97,7 +106,13 @@ func.func @test_resize_sizes_nearest(%arg0: !torch.vtensor<[1,1,2,4],f32>, %arg1
     // CHECK: %[[clW1:.*]] = arith.maximumf %[[floorW]], %[[c0W]] : f32
     // CHECK: %[[clW2:.*]] = arith.minimumf %[[clW1]], %[[inLm1W]] : f32
     // CHECK: %[[x33:.*]] = arith.fptosi %[[clW2]] : f32 to i64
-    // CHECK: %[[x34:.*]] = arith.index_cast %[[x33]] : i64 to index
+    // CHECK: linalg.yield %[[x33]] : i64
+    // CHECK: linalg.generic {{.*}} ins(%[[NEAREST_0]], %[[NEAREST_1]] : tensor<?xi64>, tensor<?xi64>)
+    // CHECK: ^bb0(%[[SRC_0:[^:]*]]: i64, %[[SRC_1:[^:]*]]: i64, %{{.*}}: f32):
+    // CHECK: %[[x11:.*]] = linalg.index 0 : index
+    // CHECK: %[[x12:.*]] = linalg.index 1 : index
+    // CHECK: %[[x32:.*]] = arith.index_cast %[[SRC_0]] : i64 to index
+    // CHECK: %[[x34:.*]] = arith.index_cast %[[SRC_1]] : i64 to index
     // CHECK: %[[extracted:.*]] = tensor.extract %[[x0:.*]][%[[x11]], %[[x12]], %[[x32]], %[[x34]]] : tensor<1x1x2x4xf32>
     // CHECK: linalg.yield %[[extracted]] : f32
     %none = torch.constant.none
@@ -121,10 +136,8 @@ func.func @test_resize_sizes_nearest(%arg0: !torch.vtensor<[1,1,2,4],f32>, %arg1
 
 // CHECK-LABEL: func.func @test_resize_nearest_1d
 func.func @test_resize_nearest_1d(%arg0: !torch.vtensor<[?,?,?],f32>, %arg1: !torch.vtensor<[3],si64>) -> !torch.vtensor<[?,?,?],f32> {
-    // CHECK: %[[GENERIC:.*]] = linalg.generic
-    // CHECK: %[[x11:.*]] = linalg.index 0 : index
-    // CHECK: %[[x12:.*]] = linalg.index 1 : index
-    // CHECK: %[[x13:.*]] = linalg.index 2 : index
+    // CHECK: %[[NEAREST_0:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<?xi64>)
+    // CHECK: %[[x13:.*]] = linalg.index 0 : index
     // CHECK: %[[x15:.*]] = arith.sitofp %[[c2_i64:.*]] : i64 to f32
     // CHECK: %[[x19:.*]] = arith.sitofp %[[x6:.*]] : i64 to f32
     // CHECK: %[[x21:.*]] = arith.divf %[[x19]], %[[x15]] : f32
@@ -138,7 +151,12 @@ func.func @test_resize_nearest_1d(%arg0: !torch.vtensor<[?,?,?],f32>, %arg1: !to
     // CHECK: %[[cl1d1:.*]] = arith.maximumf %[[flo1d]], %[[c0_1d]] : f32
     // CHECK: %[[cl1d2:.*]] = arith.minimumf %[[cl1d1]], %[[inLm1_1d]] : f32
     // CHECK: %[[x31:.*]] = arith.fptosi %[[cl1d2]] : f32 to i64
-    // CHECK: %[[x32:.*]] = arith.index_cast %[[x31]] : i64 to index
+    // CHECK: linalg.yield %[[x31]] : i64
+    // CHECK: linalg.generic {{.*}} ins(%[[NEAREST_0]] : tensor<?xi64>)
+    // CHECK: ^bb0(%[[SRC_0:[^:]*]]: i64, %{{.*}}: f32):
+    // CHECK: %[[x11:.*]] = linalg.index 0 : index
+    // CHECK: %[[x12:.*]] = linalg.index 1 : index
+    // CHECK: %[[x32:.*]] = arith.index_cast %[[SRC_0]] : i64 to index
     // CHECK: %[[extracted:.*]] = tensor.extract %[[x0:.*]][%[[x11]], %[[x12]], %[[x32]]] : tensor<?x?x?xf32>
     // CHECK: linalg.yield %[[extracted]] : f32
     %none = torch.constant.none
@@ -159,12 +177,8 @@ func.func @test_resize_nearest_1d(%arg0: !torch.vtensor<[?,?,?],f32>, %arg1: !to
 
 // CHECK-LABEL: func.func @test_resize_nearest_3d
 func.func @test_resize_nearest_3d(%arg0: !torch.vtensor<[?,?,?,?,?],f32>, %arg1: !torch.vtensor<[5],si64>) -> !torch.vtensor<[?,?,?,?,?],f32> {
-    // CHECK: %[[GENERIC:.*]] = linalg.generic
-    // CHECK: %[[x11:.*]] = linalg.index 0 : index
-    // CHECK: %[[x12:.*]] = linalg.index 1 : index
-    // CHECK: %[[x13:.*]] = linalg.index 2 : index
-    // CHECK: %[[x14:.*]] = linalg.index 3 : index
-    // CHECK: %[[index4:.*]] = linalg.index 4 : index
+    // CHECK: %[[NEAREST_0:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<?xi64>)
+    // CHECK: %[[x13:.*]] = linalg.index 0 : index
     // CHECK: %[[x15:.*]] = arith.sitofp %[[c2_i64:.*]] : i64 to f32
     // CHECK: %[[x19:.*]] = arith.sitofp %[[x6:.*]] : i64 to f32
     // CHECK: %[[x21:.*]] = arith.divf %[[x19]], %[[x15]] : f32
@@ -178,7 +192,9 @@ func.func @test_resize_nearest_3d(%arg0: !torch.vtensor<[?,?,?,?,?],f32>, %arg1:
     // CHECK: %[[cl3da1:.*]] = arith.maximumf %[[floor]], %[[c0_3da]] : f32
     // CHECK: %[[cl3da2:.*]] = arith.minimumf %[[cl3da1]], %[[inLm1_3da]] : f32
     // CHECK: %[[x31:.*]] = arith.fptosi %[[cl3da2]] : f32 to i64
-    // CHECK: %[[x32:.*]] = arith.index_cast %[[x31]] : i64 to index
+    // CHECK: linalg.yield %[[x31]] : i64
+    // CHECK: %[[NEAREST_1:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<?xi64>)
+    // CHECK: %[[x14:.*]] = linalg.index 0 : index
     // CHECK: %[[x16w:.*]] = arith.sitofp %[[c3_i64:.*]] : i64 to f32
     // CHECK: %[[x20w:.*]] = arith.sitofp %[[x7:.*]] : i64 to f32
     // CHECK: %[[x22w:.*]] = arith.divf %[[x20w]], %[[x16w]] : f32
@@ -192,7 +208,9 @@ func.func @test_resize_nearest_3d(%arg0: !torch.vtensor<[?,?,?,?,?],f32>, %arg1:
     // CHECK: %[[clW2a:.*]] = arith.maximumf %[[floorW2]], %[[c0W2]] : f32
     // CHECK: %[[clW2b:.*]] = arith.minimumf %[[clW2a]], %[[inLm1W2]] : f32
     // CHECK: %[[Wfptosi:.*]] = arith.fptosi %[[clW2b]] : f32 to i64
-    // CHECK: %[[x34:.*]] = arith.index_cast %[[Wfptosi]] : i64 to index
+    // CHECK: linalg.yield %[[Wfptosi]] : i64
+    // CHECK: %[[NEAREST_2:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<?xi64>)
+    // CHECK: %[[index4:.*]] = linalg.index 0 : index
     // CHECK: %[[x16d:.*]] = arith.sitofp %[[c4_i64:.*]] : i64 to f32
     // CHECK: %[[x20d:.*]] = arith.sitofp %[[x8:.*]] : i64 to f32
     // CHECK: %[[x22d:.*]] = arith.divf %[[x20d]], %[[x16d]] : f32
@@ -206,7 +224,14 @@ func.func @test_resize_nearest_3d(%arg0: !torch.vtensor<[?,?,?,?,?],f32>, %arg1:
     // CHECK: %[[clD2a:.*]] = arith.maximumf %[[floorD2]], %[[c0D2]] : f32
     // CHECK: %[[clD2b:.*]] = arith.minimumf %[[clD2a]], %[[inLm1D2]] : f32
     // CHECK: %[[Dfptosi:.*]] = arith.fptosi %[[clD2b]] : f32 to i64
-    // CHECK: %[[x35:.*]] = arith.index_cast %[[Dfptosi]] : i64 to index
+    // CHECK: linalg.yield %[[Dfptosi]] : i64
+    // CHECK: linalg.generic {{.*}} ins(%[[NEAREST_0]], %[[NEAREST_1]], %[[NEAREST_2]] : tensor<?xi64>, tensor<?xi64>, tensor<?xi64>)
+    // CHECK: ^bb0(%[[SRC_0:[^:]*]]: i64, %[[SRC_1:[^:]*]]: i64, %[[SRC_2:[^:]*]]: i64, %{{.*}}: f32):
+    // CHECK: %[[x11:.*]] = linalg.index 0 : index
+    // CHECK: %[[x12:.*]] = linalg.index 1 : index
+    // CHECK: %[[x32:.*]] = arith.index_cast %[[SRC_0]] : i64 to index
+    // CHECK: %[[x34:.*]] = arith.index_cast %[[SRC_1]] : i64 to index
+    // CHECK: %[[x35:.*]] = arith.index_cast %[[SRC_2]] : i64 to index
     // CHECK: %[[extracted:.*]] = tensor.extract %[[x0:.*]][%[[x11]], %[[x12]], %[[x32]], %[[x34]], %[[x35]]] : tensor<?x?x?x?x?xf32>
     // CHECK: linalg.yield %[[extracted]] : f32
     %none = torch.constant.none
@@ -233,10 +258,8 @@ func.func @test_resize_nearest_3d(%arg0: !torch.vtensor<[?,?,?,?,?],f32>, %arg1:
 
 // CHECK-LABEL: func.func @test_resize_nearest_ceil
 func.func @test_resize_nearest_ceil(%arg0: !torch.vtensor<[?,?,?],f32>, %arg1: !torch.vtensor<[3],si64>) -> !torch.vtensor<[?,?,?],f32> {
-    // CHECK: %[[GENERIC:.*]] = linalg.generic
-    // CHECK: %[[x11:.*]] = linalg.index 0 : index
-    // CHECK: %[[x12:.*]] = linalg.index 1 : index
-    // CHECK: %[[x13:.*]] = linalg.index 2 : index
+    // CHECK: %[[NEAREST_0:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<?xi64>)
+    // CHECK: %[[x13:.*]] = linalg.index 0 : index
     // CHECK: %[[x15:.*]] = arith.sitofp %[[c2_i64:.*]] : i64 to f32
     // CHECK: %[[x19:.*]] = arith.sitofp %[[x6:.*]] : i64 to f32
     // CHECK: %[[x21:.*]] = arith.divf %[[x19]], %[[x15]] : f32
@@ -253,7 +276,12 @@ func.func @test_resize_nearest_ceil(%arg0: !torch.vtensor<[?,?,?],f32>, %arg1: !
     // CHECK: %[[minCl1:.*]] = arith.maximumf %[[ceil]], %[[c0ceil]] : f32
     // CHECK: %[[minCl2:.*]] = arith.minimumf %[[minCl1]], %[[inLm1ceil]] : f32
     // CHECK: %[[x31:.*]] = arith.fptosi %[[minCl2]] : f32 to i64
-    // CHECK: %[[x32:.*]] = arith.index_cast %[[x31]] : i64 to index
+    // CHECK: linalg.yield %[[x31]] : i64
+    // CHECK: linalg.generic {{.*}} ins(%[[NEAREST_0]] : tensor<?xi64>)
+    // CHECK: ^bb0(%[[SRC_0:[^:]*]]: i64, %{{.*}}: f32):
+    // CHECK: %[[x11:.*]] = linalg.index 0 : index
+    // CHECK: %[[x12:.*]] = linalg.index 1 : index
+    // CHECK: %[[x32:.*]] = arith.index_cast %[[SRC_0]] : i64 to index
     // CHECK: %[[extracted:.*]] = tensor.extract %[[x0:.*]][%[[x11]], %[[x12]], %[[x32]]] : tensor<?x?x?xf32>
     // CHECK: linalg.yield %[[extracted]] : f32
     %none = torch.constant.none
@@ -275,12 +303,14 @@ func.func @test_resize_nearest_ceil(%arg0: !torch.vtensor<[?,?,?],f32>, %arg1: !
 // CHECK-LABEL: func.func @test_resize_scales_linear_half_pixel_symmetric
 func.func @test_resize_scales_linear_half_pixel_symmetric(%arg0: !torch.vtensor<[1,1,2,4],f32>, %arg1: !torch.vtensor<[4]
 ,f64>) -> !torch.vtensor<[?,?,?,?],f32> attributes {torch.onnx_meta.ir_version = 7 : si64, torch.onnx_meta.opset_version = 19 : si64, torch.onnx_meta.producer_name = "backend-test", torch.onnx_meta.producer_version = ""} {
-    // CHECK: %[[generic:.*]] = linalg.generic
+    // CHECK: %[[TAPS_H:.*]]:4 = linalg.generic
     // CHECK: %[[cst7:.*]] = arith.constant 2.0
     // CHECK: %[[halfsize:.*]] = arith.divf %[[sizefp:.*]], %[[cst7]]
     // CHECK: %[[modifier:.*]] = arith.subf %[[cstOne:.*]], %[[adjustment:.*]]
     // CHECK: %[[offset:.*]] = arith.mulf %[[halfsize]], %[[modifier]]
     // CHECK: %[[preClip:.*]] = arith.addf %[[offset]], %[[halfpixelbase:.*]]
+    // CHECK: %[[TAPS_W:.*]]:4 = linalg.generic
+    // CHECK: linalg.generic {{.*}} ins(%[[TAPS_H]]#0, %[[TAPS_H]]#1, %[[TAPS_H]]#2, %[[TAPS_H]]#3, %[[TAPS_W]]#0, %[[TAPS_W]]#1, %[[TAPS_W]]#2, %[[TAPS_W]]#3 :
     // CHECK: %[[extracted:.*]] = tensor.extract %[[x0:.*]][%[[x1:.*]], %[[x2:.*]], %[[x3:.*]], %[[x4:.*]]] : tensor<1x1x2x4xf32>
     // CHECK: %[[extracted_7:.*]] = tensor.extract %[[x0]][%[[x1]], %[[x2]]
     // CHECK: %[[extracted_8:.*]] = tensor.extract %[[x0]][%[[x1]], %[[x2]]
@@ -315,10 +345,8 @@ func.func @test_resize_scales_linear_half_pixel_symmetric(%arg0: !torch.vtensor<
 
 // CHECK-LABEL: func.func @test_resize_nearest_half_pixel_round_prefer_floor
 func.func @test_resize_nearest_half_pixel_round_prefer_floor(%arg0: !torch.vtensor<[?,?,?],f32>, %arg1: !torch.vtensor<[3],si64>) -> !torch.vtensor<[?,?,?],f32> {
-    // CHECK: %[[GENERIC:.*]] = linalg.generic
-    // CHECK: %[[x11:.*]] = linalg.index 0 : index
-    // CHECK: %[[x12:.*]] = linalg.index 1 : index
-    // CHECK: %[[x13:.*]] = linalg.index 2 : index
+    // CHECK: %[[NEAREST_0:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<?xi64>)
+    // CHECK: %[[x13:.*]] = linalg.index 0 : index
     // CHECK: %[[x15:.*]] = arith.sitofp %[[c2_i64:.*]] : i64 to f32
     // CHECK: %[[x19:.*]] = arith.sitofp %[[x6:.*]] : i64 to f32
     // CHECK: %[[x21:.*]] = arith.divf %[[x19]], %[[x15]] : f32
@@ -340,7 +368,12 @@ func.func @test_resize_nearest_half_pixel_round_prefer_floor(%arg0: !torch.vtens
     // CHECK: %[[selMax0:.*]] = arith.maximumf %[[select]], %[[c0_clamp]] : f32
     // CHECK: %[[selClamped:.*]] = arith.minimumf %[[selMax0]], %[[inLm1]] : f32
     // CHECK: %[[x31:.*]] = arith.fptosi %[[selClamped]] : f32 to i64
-    // CHECK: %[[x32:.*]] = arith.index_cast %[[x31]] : i64 to index
+    // CHECK: linalg.yield %[[x31]] : i64
+    // CHECK: linalg.generic {{.*}} ins(%[[NEAREST_0]] : tensor<?xi64>)
+    // CHECK: ^bb0(%[[SRC_0:[^:]*]]: i64, %{{.*}}: f32):
+    // CHECK: %[[x11:.*]] = linalg.index 0 : index
+    // CHECK: %[[x12:.*]] = linalg.index 1 : index
+    // CHECK: %[[x32:.*]] = arith.index_cast %[[SRC_0]] : i64 to index
     // CHECK: %[[extracted:.*]] = tensor.extract %[[x0:.*]][%[[x11]], %[[x12]], %[[x32]]] : tensor<?x?x?xf32>
     // CHECK: linalg.yield %[[extracted]] : f32
     %none = torch.constant.none
@@ -0,0 +1,50 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg -split-input-file -canonicalize | FileCheck %s
+
+// CHECK-DAG:   #[[ID:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG:   #[[ROW:.*]] = affine_map<(d0, d1) -> (d0)>
+// CHECK-LABEL: func.func @softmax
+// CHECK-SAME:    %[[ARG0:.*]]: !torch.vtensor<[4,?],f32>
+// CHECK-DAG:     %[[LOWEST:.*]] = arith.constant -3.40282347E+38 : f32
+// CHECK-DAG:     %[[INPUT:.*]] = torch_c.to_builtin_tensor %[[ARG0]]
+// CHECK:         %[[MAXINIT:.*]] = linalg.fill ins(%[[LOWEST]] : f32) outs(%{{.*}} : tensor<4xf32>)
+// CHECK:         %[[SUMINIT:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%{{.*}} : tensor<4xf32>)
+// CHECK:         %[[STATS:.*]]:2 = linalg.generic {indexing_maps = [#[[ID]], #[[ROW]], #[[ROW]]], iterator_types = ["parallel", "reduction"]}
+// CHECK-SAME:      ins(%[[INPUT]] : tensor<4x?xf32>) outs(%[[MAXINIT]], %[[SUMINIT]] : tensor<4xf32>, tensor<4xf32>)
+// CHECK:           math.exp
+// CHECK:           arith.select
+// CHECK:           arith.maximumf
+// CHECK:         linalg.generic {indexing_maps = [#[[ID]], #[[ROW]], #[[ROW]], #[[ID]]], iterator_types = ["parallel", "parallel"]}
+// CHECK-SAME:      ins(%[[INPUT]], %[[STATS]]#0, %[[STATS]]#1 : tensor<4x?xf32>, tensor<4xf32>, tensor<4xf32>)
+// CHECK:           arith.subf
+// CHECK:           math.exp
+// CHECK:           arith.divf
+// CHECK-NOT:     linalg.generic
+func.func @softmax(%arg0: !torch.vtensor<[4,?],f32>) -> !torch.vtensor<[4,?],f32> {
+  %int1 = torch.constant.int 1
+  %none = torch.constant.none
+  %0 = torch.aten.softmax.int %arg0, %int1, %none : !torch.vtensor<[4,?],f32>, !torch.int, !torch.none -> !torch.vtensor<[4,?],f32>
+  return %0 : !torch.vtensor<[4,?],f32>
+}
+
+// -----
+
+// The statistics of half-precision inputs are kept in f32.
+// CHECK-LABEL: func.func @log_softmax_f16
+// CHECK:         %[[STATS:.*]]:2 = linalg.generic
+// CHECK-SAME:      outs(%{{.*}}, %{{.*}} : tensor<3xf32>, tensor<3xf32>)
+// CHECK:           arith.extf
+// CHECK:         %[[OFFSET:.*]] = linalg.generic
+// CHECK-SAME:      ins(%[[STATS]]#0, %[[STATS]]#1 : tensor<3xf32>, tensor<3xf32>)
+// CHECK:           math.log
+// CHECK:           arith.addf
+// CHECK:         linalg.generic
+// CHECK-SAME:      ins(%{{.*}}, %[[OFFSET]] : tensor<3x8xf16>, tensor<3xf32>)
+// CHECK:           arith.extf
+// CHECK:           arith.subf
+// CHECK:           arith.truncf
+func.func @log_softmax_f16(%arg0: !torch.vtensor<[3,8],f16>) -> !torch.vtensor<[3,8],f16> {
+  %int-1 = torch.constant.int -1
+  %false = torch.constant.bool false
+  %0 = torch.aten._log_softmax %arg0, %int-1, %false : !torch.vtensor<[3,8],f16>, !torch.int, !torch.bool -> !torch.vtensor<[3,8],f16>
+  return %0 : !torch.vtensor<[3,8],f16>
+}
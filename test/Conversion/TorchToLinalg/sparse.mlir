@@ -26,7 +26,11 @@ func.func @sum(%arg0: !torch.vtensor<[64,64],f32,#CSR>) -> !torch.vtensor<[],f32
 // CHECK-SAME:  %[[B:.*]]: !torch.vtensor<[16,8],f32>) -> !torch.vtensor<[8,8],f32>
 // CHECK-DAG:   %[[S:.*]] = torch_c.to_builtin_tensor %[[A]] : !torch.vtensor<[8,16],f32,#[[$CSR]]> -> tensor<8x16xf32, #[[$CSR]]>
 // CHECK-DAG:   %[[T:.*]] = torch_c.to_builtin_tensor %[[B]] : !torch.vtensor<[16,8],f32> -> tensor<16x8xf32>
-// CHECK:       linalg.matmul ins(%[[S]], %[[T]] : tensor<8x16xf32, #[[$CSR]]>, tensor<16x8xf32>)
+// CHECK:       %[[FILL:.*]] = linalg.fill
+// CHECK:       linalg.generic {{{.*}}iterator_types = ["parallel", "reduction", "parallel"]}
+// CHECK-SAME:    ins(%[[S]], %[[T]] : tensor<8x16xf32, #[[$CSR]]>, tensor<16x8xf32>) outs(%[[FILL]] : tensor<8x8xf32>)
+// CHECK:         arith.mulf
+// CHECK:         arith.addf
 func.func @SpMM(%arg0: !torch.vtensor<[8,16],f32,#CSR>,
                 %arg1: !torch.vtensor<[16,8],f32>) -> !torch.vtensor<[8,8],f32> {
   %0 = torch.aten.matmul %arg0, %arg1
@@ -98,3 +102,44 @@ func.func @deactivate(%arg0: !torch.vtensor<[128,64,30,30,6],f32,#sparse>)
     -> !torch.vtensor<[128,64,30,30,6],f32>
   return %result : !torch.vtensor<[128,64,30,30,6],f32>
 }
+
+// -----
+
+#CSR = #sparse_tensor.encoding<{ map = (d0, d1) -> (d0 : dense, d1 : compressed) }>
+
+// CHECK: #[[$CSR:.*]] = #sparse_tensor.encoding<{ map = (d0, d1) -> (d0 : dense, d1 : compressed) }>
+// CHECK-LABEL: func.func @SDDMM(
+// CHECK-DAG:   %[[S:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[8,8],f32,#[[$CSR]]> -> tensor<8x8xf32, #[[$CSR]]>
+// CHECK-DAG:   %[[A:.*]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[8,4],f32> -> tensor<8x4xf32>
+// CHECK-DAG:   %[[B:.*]] = torch_c.to_builtin_tensor %arg2 : !torch.vtensor<[4,8],f32> -> tensor<4x8xf32>
+// CHECK:       %[[EMPTY:.*]] = tensor.empty() : tensor<8x8xf32, #[[$CSR]]>
+// CHECK:       linalg.generic {{{.*}}iterator_types = ["parallel", "parallel", "reduction"]}
+// CHECK-SAME:    ins(%[[S]], %[[A]], %[[B]] : tensor<8x8xf32, #[[$CSR]]>, tensor<8x4xf32>, tensor<4x8xf32>) outs(%[[EMPTY]] : tensor<8x8xf32, #[[$CSR]]>)
+func.func @SDDMM(%arg0: !torch.vtensor<[8,8],f32,#CSR>,
+                 %arg1: !torch.vtensor<[8,4],f32>,
+                 %arg2: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[8,8],f32,#CSR> {
+  %0 = torch.aten.mm %arg1, %arg2
+     : !torch.vtensor<[8,4],f32>, !torch.vtensor<[4,8],f32> -> !torch.vtensor<[8,8],f32>
+  %1 = torch.aten.mul.Tensor %arg0, %0
+     : !torch.vtensor<[8,8],f32,#CSR>, !torch.vtensor<[8,8],f32> -> !torch.vtensor<[8,8],f32,#CSR>
+  return %1 : !torch.vtensor<[8,8],f32,#CSR>
+}
+
+// -----
+
+#CSR = #sparse_tensor.encoding<{ map = (d0, d1) -> (d0 : dense, d1 : compressed) }>
+
+// CHECK: #[[$CSR:.*]] = #sparse_tensor.encoding<{ map = (d0, d1) -> (d0 : dense, d1 : compressed) }>
+// CHECK-LABEL: func.func @sparse_dense_add(
+// CHECK-DAG:   %[[S:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[8,8],f32,#[[$CSR]]> -> tensor<8x8xf32, #[[$CSR]]>
+// CHECK-DAG:   %[[D:.*]] = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[8,8],f32> -> tensor<8x8xf32>
+// CHECK:       linalg.generic {{{.*}}iterator_types = ["parallel", "parallel"]}
+// CHECK-SAME:    ins(%[[S]] : tensor<8x8xf32, #[[$CSR]]>) outs(%[[D]] : tensor<8x8xf32>)
+// CHECK:         arith.addf
+func.func @sparse_dense_add(%arg0: !torch.vtensor<[8,8],f32,#CSR>,
+                            %arg1: !torch.vtensor<[8,8],f32>) -> !torch.vtensor<[8,8],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.add.Tensor %arg0, %arg1, %int1
+     : !torch.vtensor<[8,8],f32,#CSR>, !torch.vtensor<[8,8],f32>, !torch.int -> !torch.vtensor<[8,8],f32>
+  return %0 : !torch.vtensor<[8,8],f32>
+}
@@ -0,0 +1,97 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-linalg="split-reduction-factor=8" -split-input-file -canonicalize | FileCheck %s
+
+// CHECK-DAG:   #[[SPLIT:.*]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG:   #[[CHUNK:.*]] = affine_map<(d0, d1) -> (d0)>
+// CHECK-DAG:   #[[PARTIAL:.*]] = affine_map<(d0) -> (d0)>
+// CHECK-DAG:   #[[SCALAR:.*]] = affine_map<(d0) -> ()>
+// CHECK-LABEL: func.func @sum_to_scalar
+// CHECK:         %[[FLAT:.*]] = tensor.collapse_shape %{{.*}} {{\[\[}}0, 1]] : tensor<64x1024xf32> into tensor<65536xf32>
+// CHECK:         %[[CHUNKS:.*]] = tensor.expand_shape %[[FLAT]] {{\[\[}}0, 1]] output_shape [8, 8192] : tensor<65536xf32> into tensor<8x8192xf32>
+// CHECK:         %[[PARTIALS:.*]] = linalg.generic {indexing_maps = [#[[SPLIT]], #[[CHUNK]]], iterator_types = ["parallel", "reduction"]}
+// CHECK-SAME:      ins(%[[CHUNKS]] : tensor<8x8192xf32>) outs(%{{.*}} : tensor<8xf32>)
+// CHECK:           arith.addf
+// CHECK:         linalg.generic {indexing_maps = [#[[PARTIAL]], #[[SCALAR]]], iterator_types = ["reduction"]}
+// CHECK-SAME:      ins(%[[PARTIALS]] : tensor<8xf32>) outs(%{{.*}} : tensor<f32>)
+// CHECK:           arith.addf
+func.func @sum_to_scalar(%arg0: !torch.vtensor<[64,1024],f32>) -> !torch.vtensor<[],f32> {
+  %none = torch.constant.none
+  %0 = torch.aten.sum %arg0, %none : !torch.vtensor<[64,1024],f32>, !torch.none -> !torch.vtensor<[],f32>
+  return %0 : !torch.vtensor<[],f32>
+}
+
+// -----
+
+// The partial results of a norm are sums of powers, so they are added up
+// before the root is taken.
+// CHECK-LABEL: func.func @vector_norm_keepdim
+// CHECK:         %[[CHUNKS:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0], [1, 2]] output_shape [2, 8, 512] : tensor<2x4096xf32> into tensor<2x8x512xf32>
+// CHECK:         %[[PARTIALS:.*]] = linalg.generic {{.*}} iterator_types = ["parallel", "parallel", "reduction"]}
+// CHECK-SAME:      ins(%[[CHUNKS]] : tensor<2x8x512xf32>) outs(%{{.*}} : tensor<2x8xf32>)
+// CHECK:           math.absf
+// CHECK:           math.powf
+// CHECK:           arith.addf
+// CHECK:         %[[SUMS:.*]] = linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]}
+// CHECK-SAME:      ins(%[[PARTIALS]] : tensor<2x8xf32>) outs(%{{.*}} : tensor<2xf32>)
+// CHECK-NOT:       math.powf
+// CHECK:           arith.addf
+// CHECK:         %[[KEEPDIM:.*]] = tensor.expand_shape %[[SUMS]] {{\[\[}}0, 1]] output_shape [2, 1] : tensor<2xf32> into tensor<2x1xf32>
+// CHECK:         linalg.generic
+// CHECK-SAME:      ins(%[[KEEPDIM]] : tensor<2x1xf32>)
+// CHECK:           math.powf
+func.func @vector_norm_keepdim(%arg0: !torch.vtensor<[2,4096],f32>) -> !torch.vtensor<[2,1],f32> {
+  %float3 = torch.constant.float 3.000000e+00
+  %int1 = torch.constant.int 1
+  %true = torch.constant.bool true
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %1 = torch.aten.linalg_vector_norm %arg0, %float3, %0, %true, %none : !torch.vtensor<[2,4096],f32>, !torch.float, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[2,1],f32>
+  return %1 : !torch.vtensor<[2,1],f32>
+}
+
+// -----
+
+// Reductions that already produce enough values to run in parallel are left
+// in one stage.
+// CHECK-LABEL: func.func @sum_rows
+// CHECK-NOT:     tensor.expand_shape
+// CHECK:         linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]}
+// CHECK-SAME:      ins(%{{.*}} : tensor<16x4096xf32>) outs(%{{.*}} : tensor<16xf32>)
+// CHECK-NOT:     linalg.generic
+func.func @sum_rows(%arg0: !torch.vtensor<[16,4096],f32>) -> !torch.vtensor<[16],f32> {
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %1 = torch.aten.sum.dim_IntList %arg0, %0, %false, %none : !torch.vtensor<[16,4096],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[16],f32>
+  return %1 : !torch.vtensor<[16],f32>
+}
+
+// -----
+
+// The chunks of a vocabulary-sized row are reduced in parallel, computing
+// global indices, and their values and indices are reduced by a second pass
+// with the same tie-breaking and NaN handling.
+// CHECK-LABEL: func.func @max_dim_row
+// CHECK:         %[[CHUNKS:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0], [1, 2]] output_shape [1, 8, 4000] : tensor<1x32000xf32> into tensor<1x8x4000xf32>
+// CHECK:         %[[PARTIAL:.*]]:2 = linalg.generic {{.*}} iterator_types = ["parallel", "parallel", "reduction"]}
+// CHECK-SAME:      ins(%[[CHUNKS]] : tensor<1x8x4000xf32>) outs(%{{.*}}, %{{.*}} : tensor<1x8xf32>, tensor<1x8xi64>)
+// CHECK:           %[[POS:.*]] = linalg.index 2 : index
+// CHECK:           %[[CHUNK:.*]] = linalg.index 1 : index
+// CHECK:           %[[OFFSET:.*]] = arith.muli %[[CHUNK]], %{{.*}} : index
+// CHECK:           arith.addi %[[OFFSET]], %[[POS]] : index
+// CHECK:           arith.maximumf
+// CHECK:           arith.cmpf ugt
+// CHECK:           arith.cmpf ord
+// CHECK:           arith.andi
+// CHECK:           arith.select
+// CHECK:         linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]}
+// CHECK-SAME:      ins(%[[PARTIAL]]#0, %[[PARTIAL]]#1 : tensor<1x8xf32>, tensor<1x8xi64>) outs(%{{.*}}, %{{.*}} : tensor<1xf32>, tensor<1xi64>)
+// CHECK-NOT:       linalg.index
+// CHECK:           arith.maximumf
+// CHECK:           arith.select
+func.func @max_dim_row(%arg0: !torch.vtensor<[1,32000],f32>) -> (!torch.vtensor<[1],f32>, !torch.vtensor<[1],si64>) {
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %values, %indices = torch.aten.max.dim %arg0, %int1, %false : !torch.vtensor<[1,32000],f32>, !torch.int, !torch.bool -> !torch.vtensor<[1],f32>, !torch.vtensor<[1],si64>
+  return %values, %indices : !torch.vtensor<[1],f32>, !torch.vtensor<[1],si64>
+}
@@ -45,7 +45,7 @@ func.func @torch.aten.view$dynamictest(%arg0: !torch.vtensor<[?,?],f32>) -> !tor
 // CHECK-LABEL: func.func @torch.aten.view$dynamictest2(
 // CHECK-SAME:      %[[ARG:.*]]: !torch.vtensor<[?,6,?],f32>) -> !torch.vtensor<[?,2,3,?],f32>
 // CHECK:        %[[BUILTIN_TENSOR:.*]] = torch_c.to_builtin_tensor %[[ARG]] : !torch.vtensor<[?,6,?],f32> -> tensor<?x6x?xf32>
-// CHECK:        %[[EXPAND:.*]] = tensor.reshape %[[BUILTIN_TENSOR]]
+// CHECK:        %[[EXPAND:.*]] = tensor.expand_shape %[[BUILTIN_TENSOR]] {{\[\[}}0], [1, 2], [3]] output_shape [%{{.*}}, 2, 3, %{{.*}}] : tensor<?x6x?xf32> into tensor<?x2x3x?xf32>
 // CHECK:        %[[BUILTIN_TENSOR_CAST:.*]] = torch_c.from_builtin_tensor %[[EXPAND]] : tensor<?x2x3x?xf32> -> !torch.vtensor<[?,2,3,?],f32>
 // CHECK:        return %[[BUILTIN_TENSOR_CAST]] : !torch.vtensor<[?,2,3,?],f32>
 
@@ -192,8 +192,9 @@ func.func @torch.aten.view$singleUnknownMatches0(%arg0: !torch.vtensor<[10,3,?,2
 // CHECK: func.func @torch.aten.view$combineConcepts(
 // CHECK-SAME:    %[[ARG:.*]]: !torch.vtensor<[8,?,?,?,2,1,3],f32>) -> !torch.vtensor<[2,2,2,?,?,?,6],f32>
 // CHECK:     %[[BUILTIN_TENSOR:.*]] = torch_c.to_builtin_tensor %[[ARG]] : !torch.vtensor<[8,?,?,?,2,1,3],f32> -> tensor<8x?x?x?x2x1x3xf32>
-// CHECK: %[[RESHAPE:.*]] = tensor.reshape %[[BUILTIN_TENSOR]]
-// CHECK: %[[BUILTIN_TENSOR_CAST:.*]] = torch_c.from_builtin_tensor %[[RESHAPE]] : tensor<2x2x2x?x?x?x6xf32> -> !torch.vtensor<[2,2,2,?,?,?,6],f32>
+// CHECK: %[[COLLAPSED:.*]] = tensor.collapse_shape %[[BUILTIN_TENSOR]] {{\[\[}}0], [1], [2], [3], [4, 5, 6]] : tensor<8x?x?x?x2x1x3xf32> into tensor<8x?x?x?x6xf32>
+// CHECK: %[[EXPANDED:.*]] = tensor.expand_shape %[[COLLAPSED]] {{\[\[}}0, 1, 2], [3], [4], [5], [6]] output_shape [2, 2, 2, %{{.*}}, %{{.*}}, %{{.*}}, 6] : tensor<8x?x?x?x6xf32> into tensor<2x2x2x?x?x?x6xf32>
+// CHECK: %[[BUILTIN_TENSOR_CAST:.*]] = torch_c.from_builtin_tensor %[[EXPANDED]] : tensor<2x2x2x?x?x?x6xf32> -> !torch.vtensor<[2,2,2,?,?,?,6],f32>
 // CHECK: return %[[BUILTIN_TENSOR_CAST]] : !torch.vtensor<[2,2,2,?,?,?,6],f32>
 
 func.func @torch.aten.view$combineConcepts(%arg0 : !torch.vtensor<[8,?,?,?,2,1,3], f32>) -> !torch.vtensor<[2,2,2,?,?,?,6], f32>
@@ -308,3 +309,37 @@ func.func @gather_graph(%arg0: !torch.vtensor<[5,3],f32>, %arg1: !torch.vtensor<
   %9 = torch.aten.unflatten.int %8, %int0, %5 : !torch.vtensor<[?,3],f32>, !torch.int, !torch.list<int> -> !torch.vtensor<[?,?,3],f32>
   return %9 : !torch.vtensor<[?,?,3],f32>
 }
+
+// -----
+
+// The sizes of the views come from a different tensor than the one being
+// viewed, and are only known to match through the symbolic shape bindings.
+// CHECK-LABEL: func.func @torch.aten.view$splitAndMergeHeads(
+// CHECK:         %[[INPUT:.*]] = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[?,?,768],f32> -> tensor<?x?x768xf32>
+// CHECK:         %[[SPLIT:.*]] = tensor.expand_shape %[[INPUT]] {{\[\[}}0], [1], [2, 3]] output_shape [%{{.*}}, %{{.*}}, 12, 64] : tensor<?x?x768xf32> into tensor<?x?x12x64xf32>
+// CHECK:         linalg.transpose
+// CHECK:         %[[TRANSPOSED:.*]] = linalg.transpose
+// CHECK:         %[[MERGED:.*]] = tensor.collapse_shape %[[TRANSPOSED]] {{\[\[}}0], [1], [2, 3]] : tensor<?x?x12x64xf32> into tensor<?x?x768xf32>
+// CHECK-NOT:     tensor.reshape
+// CHECK:         torch_c.from_builtin_tensor %[[MERGED]] : tensor<?x?x768xf32> -> !torch.vtensor<[?,?,768],f32>
+func.func @torch.aten.view$splitAndMergeHeads(%arg0: !torch.vtensor<[?,?,768],f32>, %arg1: !torch.vtensor<[?,?],si64>) -> !torch.vtensor<[?,?,768],f32> {
+  %s0 = torch.symbolic_int "s0" {min_val = 1, max_val = 64} : !torch.int
+  %s1 = torch.symbolic_int "s1" {min_val = 1, max_val = 4096} : !torch.int
+  torch.bind_symbolic_shape %arg0, [%s0, %s1], affine_map<()[s0, s1] -> (s0, s1, 768)> : !torch.vtensor<[?,?,768],f32>
+  torch.bind_symbolic_shape %arg1, [%s0, %s1], affine_map<()[s0, s1] -> (s0, s1)> : !torch.vtensor<[?,?],si64>
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %int12 = torch.constant.int 12
+  %int64 = torch.constant.int 64
+  %int768 = torch.constant.int 768
+  %0 = torch.aten.size.int %arg1, %int0 : !torch.vtensor<[?,?],si64>, !torch.int -> !torch.int
+  %1 = torch.aten.size.int %arg1, %int1 : !torch.vtensor<[?,?],si64>, !torch.int -> !torch.int
+  %2 = torch.prim.ListConstruct %0, %1, %int12, %int64 : (!torch.int, !torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.aten.view %arg0, %2 : !torch.vtensor<[?,?,768],f32>, !torch.list<int> -> !torch.vtensor<[?,?,12,64],f32>
+  %4 = torch.aten.transpose.int %3, %int1, %int2 : !torch.vtensor<[?,?,12,64],f32>, !torch.int, !torch.int -> !torch.vtensor<[?,12,?,64],f32>
+  %5 = torch.aten.transpose.int %4, %int1, %int2 : !torch.vtensor<[?,12,?,64],f32>, !torch.int, !torch.int -> !torch.vtensor<[?,?,12,64],f32>
+  %6 = torch.prim.ListConstruct %0, %1, %int768 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %7 = torch.aten.view %5, %6 : !torch.vtensor<[?,?,12,64],f32>, !torch.list<int> -> !torch.vtensor<[?,?,768],f32>
+  return %7 : !torch.vtensor<[?,?,768],f32>
+}
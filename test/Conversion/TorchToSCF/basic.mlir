@@ -242,3 +242,31 @@ func.func @torch.prim.Loop$for_with_tensor_arg() -> (!torch.vtensor<[2,3],f32>)
     } : (!torch.int, !torch.bool, !torch.vtensor<[2,3],f32>) -> (!torch.vtensor<[2,3],f32>)
     return %3#0 : !torch.vtensor<[2,3],f32>
 }
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-LABEL:   func.func @torch.prim.Loop$for_in_place_update(
+// CHECK:           %[[UPPER_BOUND:.*]] = arith.constant 5 : index
+// CHECK:           scf.for %{{.*}} = %{{.*}} to %[[UPPER_BOUND]] step %{{.*}} iter_args(%[[ACC:.*]] = %{{.*}}) -> (tensor<2x3xf32>) {
+// CHECK:             %[[TORCH_ACC:.*]] = torch_c.from_builtin_tensor %[[ACC]]
+// CHECK:             %[[IN:.*]] = torch_c.to_builtin_tensor %[[TORCH_ACC]]
+// CHECK:             linalg.generic
+// CHECK-SAME:          ins(%[[IN]], %{{.*}} : tensor<2x3xf32>, tensor<2x3xf32>) outs(%[[IN]] : tensor<2x3xf32>)
+func.func @torch.prim.Loop$for_in_place_update(%arg0: !torch.vtensor<[2,3],f32>, %arg1: tensor<2x3xf32>) -> !torch.vtensor<[2,3],f32> {
+  %true = torch.constant.bool true
+  %int5 = torch.constant.int 5
+  %0 = torch.prim.Loop %int5, %true, init(%arg0) {
+  ^bb0(%arg2: !torch.int, %arg3: !torch.vtensor<[2,3],f32>):
+    %1 = torch_c.to_builtin_tensor %arg3 : !torch.vtensor<[2,3],f32> -> tensor<2x3xf32>
+    %2 = tensor.empty() : tensor<2x3xf32>
+    %3 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins(%1, %arg1 : tensor<2x3xf32>, tensor<2x3xf32>) outs(%2 : tensor<2x3xf32>) {
+    ^bb0(%in: f32, %in_0: f32, %out: f32):
+      %5 = arith.addf %in, %in_0 : f32
+      linalg.yield %5 : f32
+    } -> tensor<2x3xf32>
+    %4 = torch_c.from_builtin_tensor %3 : tensor<2x3xf32> -> !torch.vtensor<[2,3],f32>
+    torch.prim.Loop.condition %true, iter(%4 : !torch.vtensor<[2,3],f32>)
+  } : (!torch.int, !torch.bool, !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,3],f32>
+  return %0 : !torch.vtensor<[2,3],f32>
+}
@@ -0,0 +1,63 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-stablehlo -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-LABEL:   func.func @all_reduce(
+// CHECK:           %[[T0:.*]] = torch_c.to_builtin_tensor %{{.*}} : !torch.vtensor<[4,8],f32> -> tensor<4x8xf32>
+// CHECK:           %[[T1:.*]] = "stablehlo.all_reduce"(%[[T0]]) <{replica_groups = dense<> : tensor<0x0xi64>}> ({
+// CHECK:           ^bb0(%[[LHS:.*]]: tensor<f32>, %[[RHS:.*]]: tensor<f32>):
+// CHECK:             %[[SUM:.*]] = stablehlo.add %[[LHS]], %[[RHS]] : tensor<f32>
+// CHECK:             stablehlo.return %[[SUM]] : tensor<f32>
+// CHECK:           }) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+// CHECK-NOT:       torch._c10d_functional.wait_tensor
+// CHECK:           torch_c.from_builtin_tensor %[[T1]] : tensor<4x8xf32> -> !torch.vtensor<[4,8],f32>
+func.func @all_reduce(%arg0: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %str = torch.constant.str "sum"
+  %group = torch.constant.str "0"
+  %0 = torch._c10d_functional.all_reduce %arg0, %str, %group : !torch.vtensor<[4,8],f32>, !torch.str, !torch.str -> !torch.vtensor<[4,8],f32>
+  %1 = torch._c10d_functional.wait_tensor %0 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  return %1 : !torch.vtensor<[4,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @all_gather(
+// CHECK:           "stablehlo.all_gather"(%{{.*}}) <{all_gather_dim = 0 : i64, replica_groups = dense<{{\[\[}}0, 1, 2, 3]]> : tensor<1x4xi64>}> : (tensor<2x8xf32>) -> tensor<8x8xf32>
+func.func @all_gather(%arg0: !torch.vtensor<[2,8],f32>) -> !torch.vtensor<[8,8],f32> {
+  %int4 = torch.constant.int 4
+  %group = torch.constant.str "0"
+  %0 = torch._c10d_functional.all_gather_into_tensor %arg0, %int4, %group : !torch.vtensor<[2,8],f32>, !torch.int, !torch.str -> !torch.vtensor<[8,8],f32>
+  %1 = torch._c10d_functional.wait_tensor %0 : !torch.vtensor<[8,8],f32> -> !torch.vtensor<[8,8],f32>
+  return %1 : !torch.vtensor<[8,8],f32>
+}
+
+// -----
+
+// Replica groups are read from the process groups of the module, and averages
+// are divided by the group size.
+// CHECK-LABEL:   func.func @reduce_scatter_avg(
+// CHECK:           %[[T1:.*]] = "stablehlo.reduce_scatter"(%{{.*}}) <{replica_groups = dense<{{\[\[}}0, 2], [1, 3]]> : tensor<2x2xi64>, scatter_dimension = 0 : i64}> ({
+// CHECK:             stablehlo.add
+// CHECK:           }) : (tensor<8x8xf32>) -> tensor<4x8xf32>
+// CHECK:           %[[SIZE:.*]] = chlo.constant_like 2.000000e+00 : f32, %[[T1]]
+// CHECK:           stablehlo.divide %[[T1]], %[[SIZE]] : tensor<4x8xf32>
+module attributes {torch.process_groups = {tp = dense<[[0, 2], [1, 3]]> : tensor<2x2xi64>}} {
+  func.func @reduce_scatter_avg(%arg0: !torch.vtensor<[8,8],f32>) -> !torch.vtensor<[4,8],f32> {
+    %str = torch.constant.str "avg"
+    %int2 = torch.constant.int 2
+    %group = torch.constant.str "tp"
+    %0 = torch._c10d_functional.reduce_scatter_tensor %arg0, %str, %int2, %group : !torch.vtensor<[8,8],f32>, !torch.str, !torch.int, !torch.str -> !torch.vtensor<[4,8],f32>
+    %1 = torch._c10d_functional.wait_tensor %0 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+    return %1 : !torch.vtensor<[4,8],f32>
+  }
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @all_reduce_max_i32(
+// CHECK:           "stablehlo.all_reduce"
+// CHECK:             stablehlo.maximum %{{.*}}, %{{.*}} : tensor<i32>
+func.func @all_reduce_max_i32(%arg0: !torch.vtensor<[4],si32>) -> !torch.vtensor<[4],si32> {
+  %str = torch.constant.str "max"
+  %group = torch.constant.str "0"
+  %0 = torch._c10d_functional.all_reduce %arg0, %str, %group : !torch.vtensor<[4],si32>, !torch.str, !torch.str -> !torch.vtensor<[4],si32>
+  return %0 : !torch.vtensor<[4],si32>
+}
@@ -0,0 +1,45 @@
+// RUN: torch-mlir-opt <%s -torch-outline-stablehlo-composites -split-input-file | FileCheck %s
+// RUN: torch-mlir-opt <%s -torch-backend-to-stablehlo-backend-pipeline=composites=true -split-input-file | FileCheck %s --check-prefix=PIPELINE
+
+// CHECK-LABEL:   func.func private @torch.aten.gelu.impl(
+// CHECK-SAME:        %[[ARG:.*]]: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+// CHECK:           %[[APPROXIMATE:.*]] = torch.constant.str "tanh"
+// CHECK:           %[[GELU:.*]] = torch.aten.gelu %[[ARG]], %[[APPROXIMATE]]
+// CHECK:           return %[[GELU]] : !torch.vtensor<[4,8],f32>
+// CHECK-LABEL:   func.func @gelu(
+// CHECK-SAME:        %[[ARG:.*]]: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+// CHECK:           %[[CALL:.*]] = call @torch.aten.gelu.impl(%[[ARG]]) {torch_mlir.composite_attributes = {approximate = "tanh"}, torch_mlir.composite_name = "torch.aten.gelu"}
+// CHECK:           return %[[CALL]]
+
+// PIPELINE-LABEL:   func.func private @torch.aten.gelu.impl(
+// PIPELINE-SAME:        %{{.*}}: tensor<4x8xf32>) -> tensor<4x8xf32> {
+// PIPELINE:           stablehlo.tanh
+// PIPELINE-LABEL:   func.func @gelu(
+// PIPELINE-SAME:        %[[ARG:.*]]: tensor<4x8xf32>) -> tensor<4x8xf32> {
+// PIPELINE:           %[[COMPOSITE:.*]] = stablehlo.composite "torch.aten.gelu" %[[ARG]] {composite_attributes = {approximate = "tanh"}, decomposition = @torch.aten.gelu.impl} : (tensor<4x8xf32>) -> tensor<4x8xf32>
+// PIPELINE:           return %[[COMPOSITE]]
+func.func @gelu(%arg0: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %str = torch.constant.str "tanh"
+  %0 = torch.aten.gelu %arg0, %str : !torch.vtensor<[4,8],f32>, !torch.str -> !torch.vtensor<[4,8],f32>
+  return %0 : !torch.vtensor<[4,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func private @torch.aten.scaled_dot_product_attention.impl(
+// CHECK-SAME:        %{{.*}}: !torch.vtensor<[2,4,16,8],f32>, %{{.*}}: !torch.vtensor<[2,4,16,8],f32>, %{{.*}}: !torch.vtensor<[2,4,16,8],f32>) -> !torch.vtensor<[2,4,16,8],f32> {
+// CHECK-NOT:       torch.aten.scaled_dot_product_attention
+// CHECK:           return
+// CHECK-LABEL:   func.func @sdpa(
+// CHECK:           call @torch.aten.scaled_dot_product_attention.impl(%arg0, %arg1, %arg2) {torch_mlir.composite_attributes = {dropout_p = 0.000000e+00 : f64, enable_gqa = false, is_causal = true}, torch_mlir.composite_name = "torch.aten.scaled_dot_product_attention"}
+
+// PIPELINE-LABEL:   func.func @sdpa(
+// PIPELINE:           stablehlo.composite "torch.aten.scaled_dot_product_attention" %arg0, %arg1, %arg2 {composite_attributes = {dropout_p = 0.000000e+00 : f64, enable_gqa = false, is_causal = true}, decomposition = @torch.aten.scaled_dot_product_attention.impl}
+func.func @sdpa(%arg0: !torch.vtensor<[2,4,16,8],f32>, %arg1: !torch.vtensor<[2,4,16,8],f32>, %arg2: !torch.vtensor<[2,4,16,8],f32>) -> !torch.vtensor<[2,4,16,8],f32> {
+  %none = torch.constant.none
+  %float0 = torch.constant.float 0.000000e+00
+  %true = torch.constant.bool true
+  %false = torch.constant.bool false
+  %0 = torch.aten.scaled_dot_product_attention %arg0, %arg1, %arg2, %none, %float0, %true, %none, %false : !torch.vtensor<[2,4,16,8],f32>, !torch.vtensor<[2,4,16,8],f32>, !torch.vtensor<[2,4,16,8],f32>, !torch.none, !torch.float, !torch.bool, !torch.none, !torch.bool -> !torch.vtensor<[2,4,16,8],f32>
+  return %0 : !torch.vtensor<[2,4,16,8],f32>
+}
@@ -5,15 +5,11 @@
 // CHECK-DAG:     %[[T0:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[?,4],f32> -> tensor<?x4xf32>
 // CHECK-DAG:     %[[T1:.*]] = torch_c.to_builtin_tensor %[[ARG1]] : !torch.vtensor<[2],si64> -> tensor<2xi64>
 // CHECK:         %[[INT0:.*]] = torch.constant.int 0
-// CHECK:         %[[C1_I64:.*]] = arith.constant 1 : i64
-// CHECK:         %[[C1:.*]] = arith.constant 1 : index
-// CHECK:         %[[T2:.*]] = tensor.dim %[[T0]], %[[C1]] : tensor<?x4xf32>
-// CHECK:         %[[T3:.*]] = arith.index_cast %[[T2]] : index to i64
-// CHECK:         %[[T4:.*]] = tensor.from_elements %[[C1_I64]], %[[T3]] : tensor<2xi64>
-// CHECK:         %[[T5:.*]] = "stablehlo.dynamic_gather"(%[[T0]], %[[T1]], %[[T4]]) <{dimension_numbers = #stablehlo.gather<offset_dims = [1], collapsed_slice_dims = [0], start_index_map = [0], index_vector_dim = 1>, indices_are_sorted = false}> : (tensor<?x4xf32>, tensor<2xi64>, tensor<2xi64>) -> tensor<2x4xf32>
-// CHECK:         %[[T6:.*]] = stablehlo.convert %[[T5]] : tensor<2x4xf32>
-// CHECK:         %[[T7:.*]] = torch_c.from_builtin_tensor %[[T6]] : tensor<2x4xf32> -> !torch.vtensor<[2,4],f32>
-// CHECK:         return %[[T7]] : !torch.vtensor<[2,4],f32>
+// CHECK-NOT:     tensor.from_elements
+// CHECK:         %[[T2:.*]] = "stablehlo.gather"(%[[T0]], %[[T1]]) <{dimension_numbers = #stablehlo.gather<offset_dims = [1], collapsed_slice_dims = [0], start_index_map = [0], index_vector_dim = 1>, indices_are_sorted = false, slice_sizes = array<i64: 1, 4>}> : (tensor<?x4xf32>, tensor<2xi64>) -> tensor<2x4xf32>
+// CHECK:         %[[T3:.*]] = stablehlo.convert %[[T2]] : tensor<2x4xf32>
+// CHECK:         %[[T4:.*]] = torch_c.from_builtin_tensor %[[T3]] : tensor<2x4xf32> -> !torch.vtensor<[2,4],f32>
+// CHECK:         return %[[T4]] : !torch.vtensor<[2,4],f32>
 func.func @torch.aten.index_select$basic(%arg0: !torch.vtensor<[?,4],f32>, %arg1: !torch.vtensor<[2],si64>) -> !torch.vtensor<[2,4],f32> {
   %int0 = torch.constant.int 0
   %0 = torch.aten.index_select %arg0, %int0, %arg1 : !torch.vtensor<[?,4],f32>, !torch.int, !torch.vtensor<[2],si64> -> !torch.vtensor<[2,4],f32>
@@ -42,6 +38,22 @@ func.func @torch.aten.embedding$basic(%weight: !torch.vtensor<[?,?],f32>, %indic
   return %ret: !torch.vtensor<[?,?],f32>
 }
 
+// CHECK-LABEL:  func.func @torch.aten.embedding$static_embedding_dim(
+// CHECK-SAME:         %[[ARG0:.*]]: !torch.vtensor<[?,64],f32>, %[[ARG1:.*]]: !torch.vtensor<[?,?],si64>) -> !torch.vtensor<[?,?,64],f32> {
+// CHECK-DAG:     %[[T0:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[?,64],f32> -> tensor<?x64xf32>
+// CHECK-DAG:     %[[T1:.*]] = torch_c.to_builtin_tensor %[[ARG1]] : !torch.vtensor<[?,?],si64> -> tensor<?x?xi64>
+// CHECK-NOT:     tensor.dim
+// CHECK:         %[[T2:.*]] = "stablehlo.gather"(%[[T0]], %[[T1]]) <{dimension_numbers = #stablehlo.gather<offset_dims = [2], collapsed_slice_dims = [0], start_index_map = [0], index_vector_dim = 2>, indices_are_sorted = false, slice_sizes = array<i64: 1, 64>}> : (tensor<?x64xf32>, tensor<?x?xi64>) -> tensor<?x?x64xf32>
+// CHECK:         %[[T3:.*]] = stablehlo.convert %[[T2]] : tensor<?x?x64xf32>
+// CHECK:         %[[T4:.*]] = torch_c.from_builtin_tensor %[[T3]] : tensor<?x?x64xf32> -> !torch.vtensor<[?,?,64],f32>
+// CHECK:         return %[[T4]] : !torch.vtensor<[?,?,64],f32>
+func.func @torch.aten.embedding$static_embedding_dim(%weight: !torch.vtensor<[?,64],f32>, %indices: !torch.vtensor<[?,?], si64>) -> !torch.vtensor<[?,?,64],f32> {
+  %false = torch.constant.bool false
+  %int-1 = torch.constant.int -1
+  %ret = torch.aten.embedding %weight, %indices, %int-1, %false, %false : !torch.vtensor<[?,64],f32>, !torch.vtensor<[?,?], si64>, !torch.int, !torch.bool, !torch.bool -> !torch.vtensor<[?,?,64],f32>
+  return %ret: !torch.vtensor<[?,?,64],f32>
+}
+
 // CHECK-LABEL:  func.func @torch.aten.embedding$rank_two_indices(
 // CHECK-SAME:         %[[ARG0:.*]]: !torch.vtensor<[?,?],f32>, %[[ARG1:.*]]: !torch.vtensor<[?,1],si64>) -> !torch.vtensor<[?,1,?],f32> {
 // CHECK-DAG:     %[[T0:.*]] = torch_c.to_builtin_tensor %[[ARG0]] : !torch.vtensor<[?,?],f32> -> tensor<?x?xf32>
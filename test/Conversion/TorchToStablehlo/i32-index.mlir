@@ -0,0 +1,47 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-stablehlo="enable-i32-index=true" -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-LABEL:  func.func @torch.aten.view$basic(
+// CHECK:         %[[T2:.*]] = torch_c.to_i64 %{{.*}}
+// CHECK:         %[[T3:.*]] = torch_c.to_i64 %{{.*}}
+// CHECK:         %[[T4:.*]] = shape.shape_of %{{.*}} : tensor<?x?x?x?xf32> -> tensor<4xindex>
+// CHECK:         %[[T5:.*]] = shape.num_elements %[[T4]] : tensor<4xindex> -> index
+// CHECK:         %[[T6:.*]] = arith.trunci %[[T2]] : i64 to i32
+// CHECK:         %[[T7:.*]] = arith.trunci %[[T3]] : i64 to i32
+// CHECK:         %[[T8:.*]] = arith.index_cast %[[T5]] : index to i32
+// CHECK:         %[[T9:.*]] = arith.divui %[[T8]], %[[T7]] : i32
+// CHECK:         %[[FROM_ELEMENTS:.*]] = tensor.from_elements %[[T9]], %[[T7]] : tensor<2xi32>
+// CHECK:         stablehlo.dynamic_reshape %{{.*}}, %[[FROM_ELEMENTS]] : (tensor<?x?x?x?xf32>, tensor<2xi32>) -> tensor<?x224xf32>
+func.func @torch.aten.view$basic(%arg0: !torch.vtensor<[?,?,?,?],f32>) -> !torch.vtensor<[?,224],f32> {
+  %int-1 = torch.constant.int -1
+  %int224 = torch.constant.int 224
+  %0 = torch.prim.ListConstruct %int-1, %int224 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.view %arg0, %0 : !torch.vtensor<[?,?,?,?],f32>, !torch.list<int> -> !torch.vtensor<[?,224],f32>
+  return %1 : !torch.vtensor<[?,224],f32>
+}
+
+// -----
+
+// The start, end and step are normalized in i32.
+// CHECK-LABEL:  func.func @torch.aten.slice.strided$slice_like(
+// CHECK-NOT:     arith.subi {{.*}} : i64
+// CHECK-NOT:     arith.select {{.*}} : i64
+// CHECK:         stablehlo.real_dynamic_slice {{.*}} : (tensor<?x?x?xf32>, tensor<3xi32>, tensor<3xi32>, tensor<3xi32>) -> tensor<?x?x?xf32>
+func.func @torch.aten.slice.strided$slice_like(%arg0: !torch.vtensor<[?,?,?],f32>) -> !torch.vtensor<[?,?,?],f32> {
+  %int0 = torch.constant.int 0
+  %int2 = torch.constant.int 2
+  %int10 = torch.constant.int 10
+  %0 = torch.aten.slice.Tensor %arg0, %int0, %int0, %int10, %int2 : !torch.vtensor<[?,?,?],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.vtensor<[?,?,?],f32>
+  return %0 : !torch.vtensor<[?,?,?],f32>
+}
+
+// -----
+
+// CHECK-LABEL:  func.func @torch.aten.embedding$dynamic(
+// CHECK:         %[[SIZES:.*]] = tensor.from_elements %{{.*}}, %{{.*}} : tensor<2xi32>
+// CHECK:         "stablehlo.dynamic_gather"(%{{.*}}, %{{.*}}, %[[SIZES]])
+func.func @torch.aten.embedding$dynamic(%weight: !torch.vtensor<[?,?],f32>, %indices: !torch.vtensor<[?], si64>) -> !torch.vtensor<[?,?],f32> {
+  %false = torch.constant.bool false
+  %int-1 = torch.constant.int -1
+  %ret = torch.aten.embedding %weight, %indices, %int-1, %false, %false : !torch.vtensor<[?,?],f32>, !torch.vtensor<[?], si64>, !torch.int, !torch.bool, !torch.bool -> !torch.vtensor<[?,?],f32>
+  return %ret: !torch.vtensor<[?,?],f32>
+}
@@ -1,4 +1,5 @@
 // RUN: torch-mlir-opt <%s -convert-torch-to-stablehlo -split-input-file -verify-diagnostics | FileCheck %s
+// RUN: torch-mlir-opt <%s -convert-torch-to-stablehlo="global-pool-as-reduce=true" -split-input-file | FileCheck %s --check-prefix=GLOBAL
 
 // -----
 
@@ -290,3 +291,46 @@ func.func @torch.aten.avg_pool2d$count_include_pad(%arg0: !torch.vtensor<[?,?,?,
   %3 = torch.aten.avg_pool2d %arg0, %0, %1, %2, %false, %true, %none : !torch.vtensor<[?,?,?,?],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[?,?,?,?],f32>
   return %3 : !torch.vtensor<[?,?,?,?],f32>
 }
+
+// -----
+
+// With static spatial dims, the divisors of count_include_pad=False are a
+// constant instead of a second reduce_window.
+// CHECK-LABEL:  func.func @torch.aten.avg_pool2d$static(
+// CHECK:           %[[SUM:.*]] = "stablehlo.reduce_window"
+// CHECK:           }) : (tensor<1x3x4x4xf32>, tensor<f32>) -> tensor<1x3x2x2xf32>
+// CHECK:           %[[DIVISOR:.*]] = stablehlo.constant dense<{{.*}}4.000000e+00, 6.000000e+00], [6.000000e+00, 9.000000e+00{{.*}}> : tensor<1x1x2x2xf32>
+// CHECK-NOT:       stablehlo.reduce_window
+// CHECK:           chlo.broadcast_divide %[[SUM]], %[[DIVISOR]] : (tensor<1x3x2x2xf32>, tensor<1x1x2x2xf32>) -> tensor<1x3x2x2xf32>
+func.func @torch.aten.avg_pool2d$static(%arg0: !torch.vtensor<[1,3,4,4],f32>) -> !torch.vtensor<[1,3,2,2],f32> {
+  %int3 = torch.constant.int 3
+  %int2 = torch.constant.int 2
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int3, %int3 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.aten.avg_pool2d %arg0, %0, %1, %2, %false, %false, %none : !torch.vtensor<[1,3,4,4],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[1,3,2,2],f32>
+  return %3 : !torch.vtensor<[1,3,2,2],f32>
+}
+
+// -----
+
+// GLOBAL-LABEL:  func.func @torch.aten.avg_pool2d$global(
+// GLOBAL:          %[[SUM:.*]] = stablehlo.reduce(%{{.*}} init: %{{.*}}) applies stablehlo.add across dimensions = [2, 3] : (tensor<?x8x7x7xf32>, tensor<f32>) -> tensor<?x8xf32>
+// GLOBAL-NOT:      reduce_window
+// GLOBAL:          %[[DIVISOR:.*]] = stablehlo.convert
+// GLOBAL:          chlo.broadcast_divide %{{.*}}, %[[DIVISOR]] : (tensor<?x8x1x1xf32>, tensor<f32>) -> tensor<?x8x1x1xf32>
+func.func @torch.aten.avg_pool2d$global(%arg0: !torch.vtensor<[?,8,7,7],f32>) -> !torch.vtensor<[?,8,1,1],f32> {
+  %int7 = torch.constant.int 7
+  %int1 = torch.constant.int 1
+  %int0 = torch.constant.int 0
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int7, %int7 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.aten.avg_pool2d %arg0, %0, %1, %2, %false, %false, %none : !torch.vtensor<[?,8,7,7],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[?,8,1,1],f32>
+  return %3 : !torch.vtensor<[?,8,1,1],f32>
+}
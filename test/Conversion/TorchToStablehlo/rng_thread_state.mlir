@@ -0,0 +1,52 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-stablehlo=thread-rng-state=true -split-input-file -verify-diagnostics | FileCheck %s
+
+// COM: the tests in this file lock down the behavior for thread-rng-state=true that draws random values from a state threaded through the function.
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.uniform$f32(
+// CHECK-SAME:        %[[ARG_0:.*]]: !torch.vtensor<[32,64],f32>,
+// CHECK-SAME:        %[[STATE:.*]]: tensor<2xui64> {torch_mlir.rng_state})
+// CHECK-SAME:        -> (!torch.vtensor<[32,64],f32>, tensor<2xui64> {torch_mlir.rng_state}) {
+// CHECK-NOT:       stablehlo.rng %
+// CHECK:           %[[A:.*]] = stablehlo.broadcast_in_dim %{{.*}}, dims = [] : (tensor<f32>) -> tensor<32x64xf32>
+// CHECK:           %[[B:.*]] = stablehlo.broadcast_in_dim %{{.*}}, dims = [] : (tensor<f32>) -> tensor<32x64xf32>
+// CHECK:           %[[NEW_STATE:.*]], %[[BITS:.*]] = stablehlo.rng_bit_generator %[[STATE]], algorithm =  THREE_FRY : (tensor<2xui64>) -> (tensor<2xui64>, tensor<32x64xui32>)
+// CHECK:           %[[SHIFT:.*]] = stablehlo.constant dense<9> : tensor<32x64xui32>
+// CHECK:           %[[MANTISSA:.*]] = stablehlo.shift_right_logical %[[BITS]], %[[SHIFT]]
+// CHECK:           %[[ONE_BITS:.*]] = stablehlo.constant dense<1065353216> : tensor<32x64xui32>
+// CHECK:           %[[OR:.*]] = stablehlo.or %[[MANTISSA]], %[[ONE_BITS]]
+// CHECK:           %[[CAST:.*]] = stablehlo.bitcast_convert %[[OR]] : (tensor<32x64xui32>) -> tensor<32x64xf32>
+// CHECK:           %[[ONE:.*]] = stablehlo.constant dense<1.000000e+00> : tensor<32x64xf32>
+// CHECK:           %[[U:.*]] = stablehlo.subtract %[[CAST]], %[[ONE]]
+// CHECK:           %[[RANGE:.*]] = stablehlo.subtract %[[B]], %[[A]]
+// CHECK:           %[[SCALED:.*]] = stablehlo.multiply %[[RANGE]], %[[U]]
+// CHECK:           %[[RESULT:.*]] = stablehlo.add %[[A]], %[[SCALED]]
+// CHECK:           %[[RET:.*]] = torch_c.from_builtin_tensor %[[RESULT]]
+// CHECK:           return %[[RET]], %[[NEW_STATE]] : !torch.vtensor<[32,64],f32>, tensor<2xui64>
+func.func @torch.aten.uniform$f32(%arg0: !torch.vtensor<[32, 64],f32>) -> !torch.vtensor<[32, 64],f32> {
+  %none = torch.constant.none
+  %float0 = torch.constant.float 0.0
+  %float1 = torch.constant.float 1.0
+  %0 = torch.aten.uniform %arg0, %float0, %float1, %none : !torch.vtensor<[32, 64],f32>, !torch.float, !torch.float, !torch.none -> !torch.vtensor<[32, 64],f32>
+  return %0 : !torch.vtensor<[32, 64],f32>
+}
+
+// -----
+
+// CHECK-LABEL:   func.func @torch.aten.randn.generator(
+// CHECK-SAME:        %[[STATE:.*]]: tensor<2xui64> {torch_mlir.rng_state})
+// CHECK:           %[[STATE_1:.*]], %{{.*}} = stablehlo.rng_bit_generator %[[STATE]], algorithm =  THREE_FRY : (tensor<2xui64>) -> (tensor<2xui64>, tensor<32x64xui64>)
+// CHECK:           %[[STATE_2:.*]], %{{.*}} = stablehlo.rng_bit_generator %[[STATE_1]], algorithm =  THREE_FRY : (tensor<2xui64>) -> (tensor<2xui64>, tensor<32x64xui64>)
+// CHECK:           stablehlo.log
+// CHECK:           stablehlo.sqrt
+// CHECK:           stablehlo.cosine
+// CHECK:           return %{{.*}}, %[[STATE_2]] : !torch.vtensor<[32,64],f64>, tensor<2xui64>
+func.func @torch.aten.randn.generator() -> !torch.vtensor<[32, 64],f64> {
+  %none = torch.constant.none
+  %int32 = torch.constant.int 32
+  %int64 = torch.constant.int 64
+  %size = torch.prim.ListConstruct %int32, %int64 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.randn.generator %size, %none, %none, %none, %none, %none : !torch.list<int>, !torch.none, !torch.none, !torch.none, !torch.none, !torch.none -> !torch.vtensor<[32, 64], f64>
+  return %0 : !torch.vtensor<[32, 64],f64>
+}
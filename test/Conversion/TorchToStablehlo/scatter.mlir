@@ -31,3 +31,22 @@ func.func @forward(%arg0: !torch.vtensor<[?,?],si64>, %arg1: !torch.vtensor<[?,?
   %0 = torch.aten.scatter.src %arg0, %int0, %arg1, %arg2 : !torch.vtensor<[?,?],si64>, !torch.int, !torch.vtensor<[?,?],si64>, !torch.vtensor<[?,?],si64> -> !torch.vtensor<[?,?],si64>
   return %0 : !torch.vtensor<[?,?],si64>
 }
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.slice_scatter$contiguous(
+// CHECK-SAME:      %[[ARG_0:.*]]: !torch.vtensor<[1,8,64,16],f32>, %[[ARG_1:.*]]: !torch.vtensor<[1,8,1,16],f32>) -> !torch.vtensor<[1,8,64,16],f32> {
+// CHECK-DAG:     %[[CACHE:.*]] = torch_c.to_builtin_tensor %[[ARG_0]] : !torch.vtensor<[1,8,64,16],f32> -> tensor<1x8x64x16xf32>
+// CHECK-DAG:     %[[NEW:.*]] = torch_c.to_builtin_tensor %[[ARG_1]] : !torch.vtensor<[1,8,1,16],f32> -> tensor<1x8x1x16xf32>
+// CHECK-DAG:     %[[ZERO:.*]] = stablehlo.constant dense<0> : tensor<i64>
+// CHECK-DAG:     %[[START:.*]] = stablehlo.constant dense<5> : tensor<i64>
+// CHECK-NOT:     stablehlo.scatter
+// CHECK:         %[[UPDATED:.*]] = stablehlo.dynamic_update_slice %[[CACHE]], %[[NEW]], %{{.*}}, %{{.*}}, %[[START]], %{{.*}} : (tensor<1x8x64x16xf32>, tensor<1x8x1x16xf32>, tensor<i64>, tensor<i64>, tensor<i64>, tensor<i64>) -> tensor<1x8x64x16xf32>
+func.func @torch.aten.slice_scatter$contiguous(%arg0: !torch.vtensor<[1,8,64,16],f32>, %arg1: !torch.vtensor<[1,8,1,16],f32>) -> !torch.vtensor<[1,8,64,16],f32> {
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %int5 = torch.constant.int 5
+  %int6 = torch.constant.int 6
+  %0 = torch.aten.slice_scatter %arg0, %arg1, %int2, %int5, %int6, %int1 : !torch.vtensor<[1,8,64,16],f32>, !torch.vtensor<[1,8,1,16],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.vtensor<[1,8,64,16],f32>
+  return %0 : !torch.vtensor<[1,8,64,16],f32>
+}
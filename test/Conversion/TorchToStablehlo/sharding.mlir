@@ -0,0 +1,34 @@
+// RUN: torch-mlir-opt <%s -convert-torch-to-stablehlo -split-input-file -verify-diagnostics | FileCheck %s
+
+// CHECK-LABEL:   func.func @sharded(
+// CHECK-SAME:        %{{.*}}: !torch.vtensor<[8,4],f32> {mhlo.sharding = "{devices=[2,1,2]0,1,2,3 last_tile_dim_replicate}"})
+// CHECK-SAME:        -> (!torch.vtensor<[8,4],f32> {mhlo.sharding = "{devices=[2,2]0,2,1,3}"})
+// CHECK:           stablehlo.maximum
+// CHECK:           stablehlo.custom_call @Sharding(%{{.*}}) {mhlo.sharding = "{devices=[1,2,2]0,2,1,3 last_tile_dim_replicate}"} : (tensor<8x4xf32>) -> tensor<8x4xf32>
+// CHECK-NOT:       torch.sharding
+module attributes {torch.device_mesh = dense<[[0, 1], [2, 3]]> : tensor<2x2xi64>} {
+  func.func @sharded(%arg0: !torch.vtensor<[8,4],f32> {torch.sharding = array<i64: 0, -1>}) -> (!torch.vtensor<[8,4],f32> {torch.sharding = array<i64: 1, 0>}) {
+    %0 = torch.aten.relu %arg0 {torch.sharding = array<i64: -1, 1>} : !torch.vtensor<[8,4],f32> -> !torch.vtensor<[8,4],f32>
+    return %0 : !torch.vtensor<[8,4],f32>
+  }
+}
+
+// -----
+
+// A tensor sharded over no mesh axis is replicated.
+// CHECK-LABEL:   func.func @replicated(
+// CHECK-SAME:        {mhlo.sharding = "{replicated}"}
+module attributes {torch.device_mesh = dense<[0, 1]> : tensor<2xi64>} {
+  func.func @replicated(%arg0: !torch.vtensor<[8],f32> {torch.sharding = array<i64: -1>}) -> !torch.vtensor<[8],f32> {
+    return %arg0 : !torch.vtensor<[8],f32>
+  }
+}
+
+// -----
+
+module {
+  // expected-error @+1 {{sharded tensors require a `torch.device_mesh` attribute on the module}}
+  func.func @no_mesh(%arg0: !torch.vtensor<[8],f32> {torch.sharding = array<i64: 0>}) -> !torch.vtensor<[8],f32> {
+    return %arg0 : !torch.vtensor<[8],f32>
+  }
+}
@@ -0,0 +1,10 @@
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(stablehlo-refine-arguments{types=tensor<4x8xf32>}, torch-stablehlo-refine-shapes-pipeline)' -split-input-file | FileCheck %s
+
+// CHECK-LABEL:   func.func @main(
+// CHECK-SAME:        %[[ARG:.*]]: tensor<4x8xf32>) -> tensor<4x8xf32> {
+// CHECK:           %[[ABS:.*]] = stablehlo.abs %[[ARG]] : tensor<4x8xf32>
+// CHECK:           return %[[ABS]] : tensor<4x8xf32>
+func.func @main(%arg0: tensor<?x8xf32>) -> tensor<?x8xf32> {
+  %0 = stablehlo.abs %arg0 : tensor<?x8xf32>
+  return %0 : tensor<?x8xf32>
+}
@@ -0,0 +1,24 @@
+// RUN: torch-mlir-opt -torch-verify-stablehlo-i32-index -split-input-file -verify-diagnostics %s | FileCheck %s
+
+// CHECK-LABEL: func.func @i32_shape
+func.func @i32_shape(%arg0: tensor<?xf32>, %arg1: tensor<2xi32>) -> tensor<?x?xf32> {
+  %0 = stablehlo.dynamic_reshape %arg0, %arg1 : (tensor<?xf32>, tensor<2xi32>) -> tensor<?x?xf32>
+  return %0 : tensor<?x?xf32>
+}
+
+// -----
+
+// The indices of a gather come from the program and may be i64.
+// CHECK-LABEL: func.func @i64_gather_indices
+func.func @i64_gather_indices(%arg0: tensor<?x4xf32>, %arg1: tensor<?xi64>, %arg2: tensor<2xi32>) -> tensor<?x4xf32> {
+  %0 = "stablehlo.dynamic_gather"(%arg0, %arg1, %arg2) <{dimension_numbers = #stablehlo.gather<offset_dims = [1], collapsed_slice_dims = [0], start_index_map = [0], index_vector_dim = 1>, indices_are_sorted = false}> : (tensor<?x4xf32>, tensor<?xi64>, tensor<2xi32>) -> tensor<?x4xf32>
+  return %0 : tensor<?x4xf32>
+}
+
+// -----
+
+func.func @i64_shape(%arg0: tensor<?xf32>, %arg1: tensor<2xi64>) -> tensor<?x?xf32> {
+  // expected-error@+1 {{has a shape operand with 64-bit elements, which the i32 index mode does not allow}}
+  %0 = stablehlo.dynamic_reshape %arg0, %arg1 : (tensor<?xf32>, tensor<2xi64>) -> tensor<?x?xf32>
+  return %0 : tensor<?x?xf32>
+}
@@ -44,6 +44,22 @@ func.func @sdpa_scale_rsqrt_head_dim_128(%query: !torch.vtensor<[1,4,8,128],f32>
 
 // -----
 
+// A constant is_causal is an attribute of the attention, not a mask.
+// CHECK-LABEL: @sdpa_causal
+// CHECK-NOT:   linalg.generic
+// CHECK:       tm_tensor.attention {causal}
+// CHECK-SAME:  ins({{.*}} : tensor<4x8x64xf32>, tensor<4x8x64xf32>, tensor<4x8x64xf32>)
+func.func @sdpa_causal(%query: !torch.vtensor<[1,4,8,64],f32>, %key: !torch.vtensor<[1,4,8,64],f32>, %value: !torch.vtensor<[1,4,8,64],f32>) -> !torch.vtensor<[1,4,8,64],f32> {
+  %float0 = torch.constant.float 0.000000e+00
+  %false = torch.constant.bool false
+  %true = torch.constant.bool true
+  %none = torch.constant.none
+  %0 = torch.aten.scaled_dot_product_attention %query, %key, %value, %none, %float0, %true, %none, %false : !torch.vtensor<[1,4,8,64],f32>, !torch.vtensor<[1,4,8,64],f32>, !torch.vtensor<[1,4,8,64],f32>, !torch.none, !torch.float, !torch.bool, !torch.none, !torch.bool -> !torch.vtensor<[1,4,8,64],f32>
+  return %0 : !torch.vtensor<[1,4,8,64],f32>
+}
+
+// -----
+
 // Test GQA with different sequence lengths between query and key/value.
 // Query has 32 heads with seq_len=10, key/value have 8 heads with seq_len=20.
 // The repeated key/value should keep seq_len=20, not inherit seq_len=10 from query.
@@ -134,3 +150,76 @@ func.func @scatter_src_dim2(%arg0: !torch.vtensor<[2,2,5,8],f32>, %arg1: !torch.
   %0 = torch.aten.scatter.src %arg0, %int2, %arg1, %arg2 : !torch.vtensor<[2,2,5,8],f32>, !torch.int, !torch.vtensor<[2,2,1,8],si64>, !torch.vtensor<[2,2,1,8],f32> -> !torch.vtensor<[2,2,5,8],f32>
   return %0 : !torch.vtensor<[2,2,5,8],f32>
 }
+
+// -----
+
+func.func private @flex_score(%score: !torch.vtensor<[],f32>, %b: !torch.vtensor<[],si32>, %h: !torch.vtensor<[],si32>, %q_idx: !torch.vtensor<[],si32>, %kv_idx: !torch.vtensor<[],si32>) -> !torch.vtensor<[],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.sub.Tensor %q_idx, %kv_idx, %int1 : !torch.vtensor<[],si32>, !torch.vtensor<[],si32>, !torch.int -> !torch.vtensor<[],si32>
+  %1 = torch.aten.add.Tensor %score, %0, %int1 : !torch.vtensor<[],f32>, !torch.vtensor<[],si32>, !torch.int -> !torch.vtensor<[],f32>
+  return %1 : !torch.vtensor<[],f32>
+}
+
+func.func private @flex_sliding_window(%b: !torch.vtensor<[],si32>, %h: !torch.vtensor<[],si32>, %q_idx: !torch.vtensor<[],si32>, %kv_idx: !torch.vtensor<[],si32>) -> !torch.vtensor<[],i1> {
+  %int1 = torch.constant.int 1
+  %int16 = torch.constant.int 16
+  %0 = torch.aten.ge.Tensor %q_idx, %kv_idx : !torch.vtensor<[],si32>, !torch.vtensor<[],si32> -> !torch.vtensor<[],i1>
+  %1 = torch.aten.sub.Tensor %q_idx, %kv_idx, %int1 : !torch.vtensor<[],si32>, !torch.vtensor<[],si32>, !torch.int -> !torch.vtensor<[],si32>
+  %2 = torch.aten.lt.Scalar %1, %int16 : !torch.vtensor<[],si32>, !torch.int -> !torch.vtensor<[],i1>
+  %3 = torch.aten.bitwise_and.Tensor %0, %2 : !torch.vtensor<[],i1>, !torch.vtensor<[],i1> -> !torch.vtensor<[],i1>
+  return %3 : !torch.vtensor<[],i1>
+}
+
+// CHECK-LABEL: func.func @flex_attention
+// CHECK:         tm_tensor.attention {scale = 1.250000e-01 : f64}
+// CHECK-SAME:      ins({{.+}} : tensor<2x4x128x64xf32>, tensor<2x4x128x64xf32>, tensor<2x4x128x64xf32>)
+// CHECK-SAME:      outs({{.+}} : tensor<2x4x128x64xf32>)
+// CHECK:         score_mod {
+// CHECK:         ^bb0(%[[SCORE:[a-zA-Z0-9]+]]: f32, %{{[a-zA-Z0-9]+}}: index, %{{[a-zA-Z0-9]+}}: index, %[[Q:[a-zA-Z0-9]+]]: index, %[[KV:[a-zA-Z0-9]+]]: index):
+// CHECK-DAG:       %[[Q_I32:.+]] = arith.index_cast %[[Q]] : index to i32
+// CHECK-DAG:       %[[KV_I32:.+]] = arith.index_cast %[[KV]] : index to i32
+// CHECK:           %[[DIST:.+]] = arith.subi %[[Q_I32]], %[[KV_I32]] : i32
+// CHECK:           %[[DIST_F:.+]] = arith.sitofp %[[DIST]] : i32 to f32
+// CHECK:           %[[RESULT:.+]] = arith.addf %[[SCORE]], %[[DIST_F]] : f32
+// CHECK:           tm_tensor.yield %[[RESULT]] : f32
+// CHECK:         } mask_mod {
+// CHECK:         ^bb0(%{{[a-zA-Z0-9]+}}: index, %{{[a-zA-Z0-9]+}}: index, %{{[a-zA-Z0-9]+}}: index, %{{[a-zA-Z0-9]+}}: index):
+// CHECK:           arith.cmpi sge
+// CHECK:           arith.cmpi slt
+// CHECK:           %[[KEPT:.+]] = arith.andi
+// CHECK:           tm_tensor.yield %[[KEPT]] : i1
+// CHECK:         } -> tensor<2x4x128x64xf32>
+func.func @flex_attention(%query: !torch.vtensor<[2,4,128,64],f32>, %key: !torch.vtensor<[2,4,128,64],f32>, %value: !torch.vtensor<[2,4,128,64],f32>) -> !torch.vtensor<[2,4,128,64],f32> {
+  %scale = torch.constant.float 1.250000e-01
+  %false = torch.constant.bool false
+  %output, %logsumexp, %max_scores = torch.hop_flex_attention %query, %key, %value, %scale, %false, %false {mask_mod_fn = @flex_sliding_window, score_mod_fn = @flex_score} : !torch.vtensor<[2,4,128,64],f32>, !torch.vtensor<[2,4,128,64],f32>, !torch.vtensor<[2,4,128,64],f32>, !torch.float, !torch.bool, !torch.bool -> !torch.vtensor<[2,4,128,64],f32>, !torch.none, !torch.none
+  return %output : !torch.vtensor<[2,4,128,64],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @paged_attention
+// CHECK:         tm_tensor.paged_attention {scale = 2.500000e-01 : f64}
+// CHECK-SAME:      ins({{.*}} : tensor<4x8x16xf32>, tensor<64x16x2x16xf32>, tensor<64x16x2x32xf32>, tensor<4x8xi32>, tensor<4xi32>)
+// CHECK-SAME:      outs({{.*}} : tensor<4x8x32xf32>)
+func.func @paged_attention(%query: !torch.vtensor<[4,8,16],f32>, %key_cache: !torch.vtensor<[64,16,2,16],f32>, %value_cache: !torch.vtensor<[64,16,2,32],f32>, %block_tables: !torch.vtensor<[4,8],si32>, %context_lens: !torch.vtensor<[4],si32>) -> !torch.vtensor<[4,8,32],f32> {
+  %scale = torch.constant.float 2.500000e-01
+  %0 = torch.operator "torch.torch_mlir.paged_attention"(%query, %key_cache, %value_cache, %block_tables, %context_lens, %scale) : (!torch.vtensor<[4,8,16],f32>, !torch.vtensor<[64,16,2,16],f32>, !torch.vtensor<[64,16,2,32],f32>, !torch.vtensor<[4,8],si32>, !torch.vtensor<[4],si32>, !torch.float) -> !torch.vtensor<[4,8,32],f32>
+  return %0 : !torch.vtensor<[4,8,32],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @unique_consecutive
+// CHECK:         %[[UNIQUE:.+]]:3 = tm_tensor.unique
+// CHECK-SAME:      ins({{.*}} : tensor<?xi64>)
+// CHECK-SAME:      outs({{.*}} : tensor<?xi64>, tensor<?xi64>, tensor<?xi64>)
+// CHECK:         tensor.extract %[[UNIQUE]]#1
+// CHECK:         tensor.extract_slice %[[UNIQUE]]#0
+// CHECK:         tensor.extract_slice %[[UNIQUE]]#2
+func.func @unique_consecutive(%arg0: !torch.vtensor<[?],si64>) -> (!torch.vtensor<[?],si64>, !torch.vtensor<[?],si64>, !torch.vtensor<[?],si64>) {
+  %true = torch.constant.bool true
+  %none = torch.constant.none
+  %0:3 = torch.aten.unique_consecutive %arg0, %true, %true, %none : !torch.vtensor<[?],si64>, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[?],si64>, !torch.vtensor<[?],si64>, !torch.vtensor<[?],si64>
+  return %0#0, %0#1, %0#2 : !torch.vtensor<[?],si64>, !torch.vtensor<[?],si64>, !torch.vtensor<[?],si64>
+}
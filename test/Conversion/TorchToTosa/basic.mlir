@@ -412,11 +412,12 @@ func.func @test_reduce_sum_scalar_negative_dim$basic(%arg0: !torch.vtensor<[],f3
 // CHECK:           %[[INPUT_F32_TENSOR:.*]] = torch_c.to_builtin_tensor %[[INPUT_F32]] : !torch.vtensor<[2,3,4],f32> -> tensor<2x3x4xf32>
 // CHECK:           %[[NONE:.*]] = torch.constant.none
 // CHECK:           %[[EMPTY_DIMS:.*]] = torch.prim.ListConstruct  : () -> !torch.list<int>
-// CHECK:           %[[SUM_DIM0:.*]] = tosa.reduce_sum %[[INPUT_F32_TENSOR]] {axis = 0 : i32} : (tensor<2x3x4xf32>) -> tensor<1x3x4xf32>
-// CHECK:           %[[SUM_DIM1:.*]] = tosa.reduce_sum %[[SUM_DIM0]] {axis = 1 : i32} : (tensor<1x3x4xf32>) -> tensor<1x1x4xf32>
-// CHECK:           %[[SUM_DIM2:.*]] = tosa.reduce_sum %[[SUM_DIM1]] {axis = 2 : i32} : (tensor<1x1x4xf32>) -> tensor<1x1x1xf32>
+// CHECK:           %[[MERGED_SHAPE:.*]] = tosa.const_shape  {values = dense<24> : tensor<1xindex>} : () -> !tosa.shape<1>
+// CHECK:           %[[MERGED:.*]] = tosa.reshape %[[INPUT_F32_TENSOR]], %[[MERGED_SHAPE]] : (tensor<2x3x4xf32>, !tosa.shape<1>) -> tensor<24xf32>
+// CHECK:           %[[SUM:.*]] = tosa.reduce_sum %[[MERGED]] {axis = 0 : i32} : (tensor<24xf32>) -> tensor<1xf32>
+// CHECK-NOT:       tosa.reduce_sum
 // CHECK:           %[[SCALAR_SHAPE:.*]] = tosa.const_shape
-// CHECK:           %[[RESHAPED_SCALAR:.*]] = tosa.reshape %[[SUM_DIM2]], %[[SCALAR_SHAPE]] : (tensor<1x1x1xf32>, !tosa.shape<0>) -> tensor<f32>
+// CHECK:           %[[RESHAPED_SCALAR:.*]] = tosa.reshape %[[SUM]], %[[SCALAR_SHAPE]] : (tensor<1xf32>, !tosa.shape<0>) -> tensor<f32>
 // CHECK:           %[[RESULT_F32:.*]] = torch_c.from_builtin_tensor %[[RESHAPED_SCALAR]] : tensor<f32> -> !torch.vtensor<[],f32>
 // CHECK:           return %[[RESULT_F32]] : !torch.vtensor<[],f32>
 // CHECK:         }
@@ -436,11 +437,12 @@ func.func @test_reduce_sum_empty_dims$basic(%arg0: !torch.vtensor<[2,3,4],f32>)
 // CHECK:           %[[DTYPE_I32:.*]] = torch.constant.int 3
 // CHECK:           %[[EMPTY_DIMS:.*]] = torch.prim.ListConstruct  : () -> !torch.list<int>
 // CHECK:           %[[CAST_INPUT_TO_I32:.*]] = tosa.cast %[[INPUT_I8_TENSOR]] : (tensor<2x3x4xi8>) -> tensor<2x3x4xi32>
-// CHECK:           %[[SUM_DIM0:.*]] = tosa.reduce_sum %[[CAST_INPUT_TO_I32]] {axis = 0 : i32} : (tensor<2x3x4xi32>) -> tensor<1x3x4xi32>
-// CHECK:           %[[SUM_DIM1:.*]] = tosa.reduce_sum %[[SUM_DIM0]] {axis = 1 : i32} : (tensor<1x3x4xi32>) -> tensor<1x1x4xi32>
-// CHECK:           %[[SUM_DIM2:.*]] = tosa.reduce_sum %[[SUM_DIM1]] {axis = 2 : i32} : (tensor<1x1x4xi32>) -> tensor<1x1x1xi32>
+// CHECK:           %[[MERGED_SHAPE:.*]] = tosa.const_shape  {values = dense<24> : tensor<1xindex>} : () -> !tosa.shape<1>
+// CHECK:           %[[MERGED:.*]] = tosa.reshape %[[CAST_INPUT_TO_I32]], %[[MERGED_SHAPE]] : (tensor<2x3x4xi32>, !tosa.shape<1>) -> tensor<24xi32>
+// CHECK:           %[[SUM:.*]] = tosa.reduce_sum %[[MERGED]] {axis = 0 : i32} : (tensor<24xi32>) -> tensor<1xi32>
+// CHECK-NOT:       tosa.reduce_sum
 // CHECK:           %[[SCALAR_SHAPE:.*]] = tosa.const_shape
-// CHECK:           %[[RESHAPED_SCALAR:.*]] = tosa.reshape %[[SUM_DIM2]], %[[SCALAR_SHAPE]] : (tensor<1x1x1xi32>, !tosa.shape<0>) -> tensor<i32>
+// CHECK:           %[[RESHAPED_SCALAR:.*]] = tosa.reshape %[[SUM]], %[[SCALAR_SHAPE]] : (tensor<1xi32>, !tosa.shape<0>) -> tensor<i32>
 // CHECK:           %[[RESULT_I32:.*]] = torch_c.from_builtin_tensor %[[RESHAPED_SCALAR]] : tensor<i32> -> !torch.vtensor<[],si32>
 // CHECK:           return %[[RESULT_I32]] : !torch.vtensor<[],si32>
 // CHECK:         }
@@ -2254,11 +2256,11 @@ func.func @torch.aten.min.dim$basic(%arg0: tensor<3x2x3xf32>) -> tensor<3x2x1xf3
 // CHECK-LABEL:   func.func @torch.aten.min$basic(
 // CHECK-SAME:                                    %[[VAL_0:.*]]: !torch.vtensor<[3,2,3],f32>) -> !torch.vtensor<[1],f32> {
 // CHECK:           %[[VAL_1:.*]] = torch_c.to_builtin_tensor %[[VAL_0]] : !torch.vtensor<[3,2,3],f32> -> tensor<3x2x3xf32>
-// CHECK:           %[[VAL_2:.*]] = tosa.reduce_min %[[VAL_1]] {axis = 0 : i32} : (tensor<3x2x3xf32>) -> tensor<1x2x3xf32>
-// CHECK:           %[[VAL_3:.*]] = tosa.reduce_min %[[VAL_2]] {axis = 1 : i32} : (tensor<1x2x3xf32>) -> tensor<1x1x3xf32>
-// CHECK:           %[[VAL_4:.*]] = tosa.reduce_min %[[VAL_3]] {axis = 2 : i32} : (tensor<1x1x3xf32>) -> tensor<1x1x1xf32>
+// CHECK:           %[[VAL_2:.*]] = tosa.const_shape  {values = dense<18> : tensor<1xindex>} : () -> !tosa.shape<1>
+// CHECK:           %[[VAL_3:.*]] = tosa.reshape %[[VAL_1]], %[[VAL_2]] : (tensor<3x2x3xf32>, !tosa.shape<1>) -> tensor<18xf32>
+// CHECK:           %[[VAL_4:.*]] = tosa.reduce_min %[[VAL_3]] {axis = 0 : i32} : (tensor<18xf32>) -> tensor<1xf32>
 // CHECK:           %[[VAL_5:.*]] = tosa.const_shape  {values = dense<1> : tensor<1xindex>} : () -> !tosa.shape<1>
-// CHECK:           %[[VAL_6:.*]] = tosa.reshape %[[VAL_4]], %[[VAL_5]] : (tensor<1x1x1xf32>, !tosa.shape<1>) -> tensor<1xf32>
+// CHECK:           %[[VAL_6:.*]] = tosa.reshape %[[VAL_4]], %[[VAL_5]] : (tensor<1xf32>, !tosa.shape<1>) -> tensor<1xf32>
 // CHECK:           %[[VAL_7:.*]] = torch_c.from_builtin_tensor %[[VAL_6]] : tensor<1xf32> -> !torch.vtensor<[1],f32>
 // CHECK:           return %[[VAL_7]] : !torch.vtensor<[1],f32>
 // CHECK:         }
@@ -2272,11 +2274,11 @@ func.func @torch.aten.min$basic(%arg0: !torch.vtensor<[3,2,3],f32>) -> !torch.vt
 // CHECK-LABEL:   func.func @torch.aten.max$basic(
 // CHECK-SAME:                                    %[[VAL_0:.*]]: !torch.vtensor<[3,2,3],f32>) -> !torch.vtensor<[1],f32> {
 // CHECK:           %[[VAL_1:.*]] = torch_c.to_builtin_tensor %[[VAL_0]] : !torch.vtensor<[3,2,3],f32> -> tensor<3x2x3xf32>
-// CHECK:           %[[VAL_2:.*]] = tosa.reduce_max %[[VAL_1]] {axis = 0 : i32} : (tensor<3x2x3xf32>) -> tensor<1x2x3xf32>
-// CHECK:           %[[VAL_3:.*]] = tosa.reduce_max %[[VAL_2]] {axis = 1 : i32} : (tensor<1x2x3xf32>) -> tensor<1x1x3xf32>
-// CHECK:           %[[VAL_4:.*]] = tosa.reduce_max %[[VAL_3]] {axis = 2 : i32} : (tensor<1x1x3xf32>) -> tensor<1x1x1xf32>
+// CHECK:           %[[VAL_2:.*]] = tosa.const_shape  {values = dense<18> : tensor<1xindex>} : () -> !tosa.shape<1>
+// CHECK:           %[[VAL_3:.*]] = tosa.reshape %[[VAL_1]], %[[VAL_2]] : (tensor<3x2x3xf32>, !tosa.shape<1>) -> tensor<18xf32>
+// CHECK:           %[[VAL_4:.*]] = tosa.reduce_max %[[VAL_3]] {axis = 0 : i32} : (tensor<18xf32>) -> tensor<1xf32>
 // CHECK:           %[[VAL_5:.*]] = tosa.const_shape  {values = dense<1> : tensor<1xindex>} : () -> !tosa.shape<1>
-// CHECK:           %[[VAL_6:.*]] = tosa.reshape %[[VAL_4]], %[[VAL_5]] : (tensor<1x1x1xf32>, !tosa.shape<1>) -> tensor<1xf32>
+// CHECK:           %[[VAL_6:.*]] = tosa.reshape %[[VAL_4]], %[[VAL_5]] : (tensor<1xf32>, !tosa.shape<1>) -> tensor<1xf32>
 // CHECK:           %[[VAL_7:.*]] = torch_c.from_builtin_tensor %[[VAL_6]] : tensor<1xf32> -> !torch.vtensor<[1],f32>
 // CHECK:           return %[[VAL_7]] : !torch.vtensor<[1],f32>
 // CHECK:         }
@@ -2785,32 +2787,17 @@ func.func @torch.aten.diagonal$basic(%arg0: !torch.vtensor<[3,4,5,6], si32>) ->
 // CHECK:           %[[VAL_3:.*]] = torch_c.to_builtin_tensor %[[VAL_0]] : !torch.vtensor<[4,5,6],f32> -> tensor<4x5x6xf32>
 // CHECK:           %[[VAL_4:.*]] = torch.constant.int 2
 // CHECK:           %[[VAL_5:.*]] = tosa.cast %[[VAL_2]] : (tensor<2xi64>) -> tensor<2xi32>
-// CHECK:           %[[VAL_6:.*]] = tosa.const_shape  {values = dense<[1, 1, 2]> : tensor<3xindex>} : () -> !tosa.shape<3>
-// CHECK:           %[[VAL_7:.*]] = tosa.reshape %[[VAL_5]], %[[VAL_6]] : (tensor<2xi32>, !tosa.shape<3>) -> tensor<1x1x2xi32>
-// CHECK:           %[[VAL_8:.*]] = tosa.const_shape  {values = dense<[4, 5, 1]> : tensor<3xindex>} : () -> !tosa.shape<3>
-// CHECK:           %[[VAL_9:.*]] = tosa.tile %[[VAL_7]], %[[VAL_8]] : (tensor<1x1x2xi32>, !tosa.shape<3>) -> tensor<4x5x2xi32>
-// CHECK:           %[[VAL_10:.*]] = tosa.const_shape  {values = dense<[4, 5, 2, 1]> : tensor<4xindex>} : () -> !tosa.shape<4>
-// CHECK:           %[[VAL_11:.*]] = tosa.reshape %[[VAL_9]], %[[VAL_10]] : (tensor<4x5x2xi32>, !tosa.shape<4>) -> tensor<4x5x2x1xi32>
-// CHECK:           %[[VAL_12:.*]] = "tosa.const"() <{values = dense<{{\[\[}}{{\[\[}}0], [0]], {{\[\[}}0], [0]], {{\[\[}}0], [0]], {{\[\[}}0], [0]], {{\[\[}}0], [0]]], {{\[\[}}[1], [1]], {{\[\[}}1], [1]], {{\[\[}}1], [1]], {{\[\[}}1], [1]], {{\[\[}}1], [1]]], {{\[\[}}[2], [2]], {{\[\[}}2], [2]], {{\[\[}}2], [2]], {{\[\[}}2], [2]], {{\[\[}}2], [2]]], {{\[\[}}[3], [3]], {{\[\[}}3], [3]], {{\[\[}}3], [3]], {{\[\[}}3], [3]], {{\[\[}}3], [3]]]]> : tensor<4x5x2x1xi32>}> : () -> tensor<4x5x2x1xi32>
-// CHECK:           %[[VAL_13:.*]] = "tosa.const"() <{values = dense<{{\[\[}}{{\[\[}}0], [0]], {{\[\[}}1], [1]], {{\[\[}}2], [2]], {{\[\[}}3], [3]], {{\[\[}}4], [4]]], {{\[\[}}[0], [0]], {{\[\[}}1], [1]], {{\[\[}}2], [2]], {{\[\[}}3], [3]], {{\[\[}}4], [4]]], {{\[\[}}[0], [0]], {{\[\[}}1], [1]], {{\[\[}}2], [2]], {{\[\[}}3], [3]], {{\[\[}}4], [4]]], {{\[\[}}[0], [0]], {{\[\[}}1], [1]], {{\[\[}}2], [2]], {{\[\[}}3], [3]], {{\[\[}}4], [4]]]]> : tensor<4x5x2x1xi32>}> : () -> tensor<4x5x2x1xi32>
-// CHECK:           %[[VAL_14:.*]] = tosa.concat %[[VAL_12]], %[[VAL_13]], %[[VAL_11]] {axis = 3 : i32} : (tensor<4x5x2x1xi32>, tensor<4x5x2x1xi32>, tensor<4x5x2x1xi32>) -> tensor<4x5x2x3xi32>
-// CHECK:           %[[VAL_15:.*]] = tosa.const_shape  {values = dense<[1, 120, 1]> : tensor<3xindex>} : () -> !tosa.shape<3>
-// CHECK:           %[[VAL_16:.*]] = tosa.reshape %[[VAL_3]], %[[VAL_15]] : (tensor<4x5x6xf32>, !tosa.shape<3>) -> tensor<1x120x1xf32>
-// CHECK:           %[[VAL_17:.*]] = tosa.const_shape  {values = dense<[40, 3]> : tensor<2xindex>} : () -> !tosa.shape<2>
-// CHECK:           %[[VAL_18:.*]] = tosa.reshape %[[VAL_14]], %[[VAL_17]] : (tensor<4x5x2x3xi32>, !tosa.shape<2>) -> tensor<40x3xi32>
-// CHECK:           %[[VAL_19:.*]] = "tosa.const"() <{values = dense<[30, 6, 1]> : tensor<3xi32>}> : () -> tensor<3xi32>
-// CHECK:           %[[VAL_20:.*]] = tosa.const_shape  {values = dense<[1, 3]> : tensor<2xindex>} : () -> !tosa.shape<2>
-// CHECK:           %[[VAL_21:.*]] = tosa.reshape %[[VAL_19]], %[[VAL_20]] : (tensor<3xi32>, !tosa.shape<2>) -> tensor<1x3xi32>
-// CHECK:           %[[VAL_22:.*]] = "tosa.const"() <{values = dense<0> : tensor<1xi8>}> : () -> tensor<1xi8>
-// CHECK:           %[[VAL_23:.*]] = tosa.mul %[[VAL_18]], %[[VAL_21]], %[[VAL_22]] : (tensor<40x3xi32>, tensor<1x3xi32>, tensor<1xi8>) -> tensor<40x3xi32>
-// CHECK:           %[[VAL_24:.*]] = tosa.reduce_sum %[[VAL_23]] {axis = 1 : i32} : (tensor<40x3xi32>) -> tensor<40x1xi32>
-// CHECK:           %[[VAL_25:.*]] = tosa.const_shape  {values = dense<[1, 40]> : tensor<2xindex>} : () -> !tosa.shape<2>
-// CHECK:           %[[VAL_26:.*]] = tosa.reshape %[[VAL_24]], %[[VAL_25]] : (tensor<40x1xi32>, !tosa.shape<2>) -> tensor<1x40xi32>
-// CHECK:           %[[VAL_27:.*]] = tosa.gather %[[VAL_16]], %[[VAL_26]] : (tensor<1x120x1xf32>, tensor<1x40xi32>) -> tensor<1x40x1xf32>
-// CHECK:           %[[VAL_28:.*]] = tosa.const_shape  {values = dense<[4, 5, 2]> : tensor<3xindex>} : () -> !tosa.shape<3>
-// CHECK:           %[[VAL_29:.*]] = tosa.reshape %[[VAL_27]], %[[VAL_28]] : (tensor<1x40x1xf32>, !tosa.shape<3>) -> tensor<4x5x2xf32>
-// CHECK:           %[[VAL_30:.*]] = torch_c.from_builtin_tensor %[[VAL_29]] : tensor<4x5x2xf32> -> !torch.vtensor<[4,5,2],f32>
-// CHECK:           return %[[VAL_30]] : !torch.vtensor<[4,5,2],f32>
+// CHECK:           %[[VAL_6:.*]] = tosa.const_shape  {values = dense<[20, 6, 1]> : tensor<3xindex>} : () -> !tosa.shape<3>
+// CHECK:           %[[VAL_7:.*]] = tosa.reshape %[[VAL_3]], %[[VAL_6]] : (tensor<4x5x6xf32>, !tosa.shape<3>) -> tensor<20x6x1xf32>
+// CHECK:           %[[VAL_8:.*]] = tosa.const_shape  {values = dense<[1, 2]> : tensor<2xindex>} : () -> !tosa.shape<2>
+// CHECK:           %[[VAL_9:.*]] = tosa.reshape %[[VAL_5]], %[[VAL_8]] : (tensor<2xi32>, !tosa.shape<2>) -> tensor<1x2xi32>
+// CHECK:           %[[VAL_10:.*]] = tosa.const_shape  {values = dense<[20, 1]> : tensor<2xindex>} : () -> !tosa.shape<2>
+// CHECK:           %[[VAL_11:.*]] = tosa.tile %[[VAL_9]], %[[VAL_10]] : (tensor<1x2xi32>, !tosa.shape<2>) -> tensor<20x2xi32>
+// CHECK:           %[[VAL_12:.*]] = tosa.gather %[[VAL_7]], %[[VAL_11]] : (tensor<20x6x1xf32>, tensor<20x2xi32>) -> tensor<20x2x1xf32>
+// CHECK:           %[[VAL_13:.*]] = tosa.const_shape  {values = dense<[4, 5, 2]> : tensor<3xindex>} : () -> !tosa.shape<3>
+// CHECK:           %[[VAL_14:.*]] = tosa.reshape %[[VAL_12]], %[[VAL_13]] : (tensor<20x2x1xf32>, !tosa.shape<3>) -> tensor<4x5x2xf32>
+// CHECK:           %[[VAL_15:.*]] = torch_c.from_builtin_tensor %[[VAL_14]] : tensor<4x5x2xf32> -> !torch.vtensor<[4,5,2],f32>
+// CHECK:           return %[[VAL_15]] : !torch.vtensor<[4,5,2],f32>
 // CHECK:         }
 func.func @torch.aten.index_select(%arg0: !torch.vtensor<[4,5,6],f32>, %arg1: !torch.vtensor<[2],si64>) -> !torch.vtensor<[4,5,2],f32> {
   %int2 = torch.constant.int 2
@@ -3177,25 +3164,16 @@ func.func @torch.aten.index_put_hacked_twin_flattened_updates(
 // CHECK:           %[[VAL_8:.*]] = tosa.add %[[VAL_7]], %[[VAL_5]] : (tensor<i32>, tensor<i32>) -> tensor<i32>
 // CHECK:           %[[VAL_9:.*]] = tosa.greater %[[VAL_6]], %[[VAL_5]] : (tensor<i32>, tensor<i32>) -> tensor<i1>
 // CHECK:           %[[VAL_10:.*]] = tosa.select %[[VAL_9]], %[[VAL_8]], %[[VAL_5]] : (tensor<i1>, tensor<i32>, tensor<i32>) -> tensor<i32>
-// CHECK:           %[[VAL_11:.*]] = tosa.const_shape  {values = dense<1> : tensor<1xindex>} : () -> !tosa.shape<1>
-// CHECK:           %[[VAL_12:.*]] = tosa.reshape %[[VAL_10]], %[[VAL_11]] : (tensor<i32>, !tosa.shape<1>) -> tensor<1xi32>
-// CHECK:           %[[VAL_13:.*]] = tosa.const_shape  {values = dense<[1, 2, 8]> : tensor<3xindex>} : () -> !tosa.shape<3>
-// CHECK:           %[[VAL_14:.*]] = tosa.reshape %[[VAL_2]], %[[VAL_13]] : (tensor<2x4x2xi64>, !tosa.shape<3>) -> tensor<1x2x8xi64>
-// CHECK:           %[[VAL_15:.*]] = tosa.const_shape  {values = dense<1> : tensor<2xindex>} : () -> !tosa.shape<2>
-// CHECK:           %[[VAL_16:.*]] = tosa.reshape %[[VAL_12]], %[[VAL_15]] : (tensor<1xi32>, !tosa.shape<2>) -> tensor<1x1xi32>
-// CHECK:           %[[VAL_17:.*]] = "tosa.const"() <{values = dense<1> : tensor<1xi32>}> : () -> tensor<1xi32>
-// CHECK:           %[[VAL_18:.*]] = tosa.const_shape  {values = dense<1> : tensor<2xindex>} : () -> !tosa.shape<2>
-// CHECK:           %[[VAL_19:.*]] = tosa.reshape %[[VAL_17]], %[[VAL_18]] : (tensor<1xi32>, !tosa.shape<2>) -> tensor<1x1xi32>
-// CHECK:           %[[VAL_20:.*]] = "tosa.const"() <{values = dense<0> : tensor<1xi8>}> : () -> tensor<1xi8>
-// CHECK:           %[[VAL_21:.*]] = tosa.mul %[[VAL_16]], %[[VAL_19]], %[[VAL_20]] : (tensor<1x1xi32>, tensor<1x1xi32>, tensor<1xi8>) -> tensor<1x1xi32>
-// CHECK:           %[[VAL_22:.*]] = tosa.reduce_sum %[[VAL_21]] {axis = 1 : i32} : (tensor<1x1xi32>) -> tensor<1x1xi32>
-// CHECK:           %[[VAL_23:.*]] = tosa.const_shape  {values = dense<1> : tensor<2xindex>} : () -> !tosa.shape<2>
-// CHECK:           %[[VAL_24:.*]] = tosa.reshape %[[VAL_22]], %[[VAL_23]] : (tensor<1x1xi32>, !tosa.shape<2>) -> tensor<1x1xi32>
-// CHECK:           %[[VAL_25:.*]] = tosa.gather %[[VAL_14]], %[[VAL_24]] : (tensor<1x2x8xi64>, tensor<1x1xi32>) -> tensor<1x1x8xi64>
-// CHECK:           %[[VAL_26:.*]] = tosa.const_shape  {values = dense<[4, 2]> : tensor<2xindex>} : () -> !tosa.shape<2>
-// CHECK:           %[[VAL_27:.*]] = tosa.reshape %[[VAL_25]], %[[VAL_26]] : (tensor<1x1x8xi64>, !tosa.shape<2>) -> tensor<4x2xi64>
-// CHECK:           %[[VAL_28:.*]] = torch_c.from_builtin_tensor %[[VAL_27]] : tensor<4x2xi64> -> !torch.vtensor<[4,2],si64>
-// CHECK:           return %[[VAL_28]] : !torch.vtensor<[4,2],si64>
+// CHECK:           %[[VAL_11:.*]] = tosa.const_shape  {values = dense<[1, 2, 8]> : tensor<3xindex>} : () -> !tosa.shape<3>
+// CHECK:           %[[VAL_12:.*]] = tosa.reshape %[[VAL_2]], %[[VAL_11]] : (tensor<2x4x2xi64>, !tosa.shape<3>) -> tensor<1x2x8xi64>
+// CHECK:           %[[VAL_13:.*]] = tosa.const_shape  {values = dense<1> : tensor<2xindex>} : () -> !tosa.shape<2>
+// CHECK:           %[[VAL_14:.*]] = tosa.reshape %[[VAL_10]], %[[VAL_13]] : (tensor<i32>, !tosa.shape<2>) -> tensor<1x1xi32>
+// CHECK-NOT:       tosa.mul
+// CHECK:           %[[VAL_15:.*]] = tosa.gather %[[VAL_12]], %[[VAL_14]] : (tensor<1x2x8xi64>, tensor<1x1xi32>) -> tensor<1x1x8xi64>
+// CHECK:           %[[VAL_16:.*]] = tosa.const_shape  {values = dense<[4, 2]> : tensor<2xindex>} : () -> !tosa.shape<2>
+// CHECK:           %[[VAL_17:.*]] = tosa.reshape %[[VAL_15]], %[[VAL_16]] : (tensor<1x1x8xi64>, !tosa.shape<2>) -> tensor<4x2xi64>
+// CHECK:           %[[VAL_18:.*]] = torch_c.from_builtin_tensor %[[VAL_17]] : tensor<4x2xi64> -> !torch.vtensor<[4,2],si64>
+// CHECK:           return %[[VAL_18]] : !torch.vtensor<[4,2],si64>
 // CHECK:         }
 func.func @torch.aten.index.Tensor_hacked_twin(%arg0: !torch.vtensor<[2,4,2],si64>, %arg1: !torch.vtensor<[],si64>) -> !torch.vtensor<[4,2],si64> {
   %0 = torch.prim.ListConstruct %arg1 : (!torch.vtensor<[],si64>) -> !torch.list<vtensor>
@@ -4552,6 +4530,37 @@ func.func @torch.aten.convolution$depthwise_conv2d(%arg0: !torch.vtensor<[5,4,10
 
 // -----
 
+// CHECK-LABEL:   func.func @torch.aten.convolution$grouped_conv2d(
+// CHECK-SAME:                                                %[[ARG:.*]]: !torch.vtensor<[5,4,10,20],f32>) -> !torch.vtensor<[5,6,10,20],f32> {
+// CHECK:           %[[NHWC_INPUT:.*]] = tosa.transpose %{{.*}} {perms = array<i32: 0, 2, 3, 1>} : (tensor<5x4x10x20xf32>) -> tensor<5x10x20x4xf32>
+// CHECK:           %[[OHWI_WEIGHT:.*]] = tosa.transpose %{{.*}} {perms = array<i32: 0, 2, 3, 1>} : (tensor<6x2x3x3xf32>) -> tensor<6x3x3x2xf32>
+// CHECK:           %[[BIAS:.*]] = "tosa.const"() <{values = dense<0.000000e+00> : tensor<6xf32>}> : () -> tensor<6xf32>
+// CHECK:           %[[INPUT_0:.*]] = tosa.slice %[[NHWC_INPUT]], %{{.*}}, %{{.*}} : (tensor<5x10x20x4xf32>, !tosa.shape<4>, !tosa.shape<4>) -> tensor<5x10x20x2xf32>
+// CHECK:           %[[WEIGHT_0:.*]] = tosa.slice %[[OHWI_WEIGHT]], %{{.*}}, %{{.*}} : (tensor<6x3x3x2xf32>, !tosa.shape<4>, !tosa.shape<4>) -> tensor<3x3x3x2xf32>
+// CHECK:           %[[BIAS_0:.*]] = tosa.slice %[[BIAS]], %{{.*}}, %{{.*}} : (tensor<6xf32>, !tosa.shape<1>, !tosa.shape<1>) -> tensor<3xf32>
+// CHECK:           %[[CONV_0:.*]] = tosa.conv2d %[[INPUT_0]], %[[WEIGHT_0]], %[[BIAS_0]], %{{.*}}, %{{.*}} {acc_type = f32, dilation = array<i64: 1, 1>, pad = array<i64: 1, 1, 1, 1>, stride = array<i64: 1, 1>} : (tensor<5x10x20x2xf32>, tensor<3x3x3x2xf32>, tensor<3xf32>, tensor<1xf32>, tensor<1xf32>) -> tensor<5x10x20x3xf32>
+// CHECK:           %[[INPUT_1:.*]] = tosa.slice %[[NHWC_INPUT]], %{{.*}}, %{{.*}} : (tensor<5x10x20x4xf32>, !tosa.shape<4>, !tosa.shape<4>) -> tensor<5x10x20x2xf32>
+// CHECK:           %[[WEIGHT_1:.*]] = tosa.slice %[[OHWI_WEIGHT]], %{{.*}}, %{{.*}} : (tensor<6x3x3x2xf32>, !tosa.shape<4>, !tosa.shape<4>) -> tensor<3x3x3x2xf32>
+// CHECK:           %[[BIAS_1:.*]] = tosa.slice %[[BIAS]], %{{.*}}, %{{.*}} : (tensor<6xf32>, !tosa.shape<1>, !tosa.shape<1>) -> tensor<3xf32>
+// CHECK:           %[[CONV_1:.*]] = tosa.conv2d %[[INPUT_1]], %[[WEIGHT_1]], %[[BIAS_1]], %{{.*}}, %{{.*}} {{.*}} -> tensor<5x10x20x3xf32>
+// CHECK:           %[[CONCAT:.*]] = tosa.concat %[[CONV_0]], %[[CONV_1]] {axis = 3 : i32} : (tensor<5x10x20x3xf32>, tensor<5x10x20x3xf32>) -> tensor<5x10x20x6xf32>
+// CHECK:           %[[RESULT_NCHW:.*]] = tosa.transpose %[[CONCAT]] {perms = array<i32: 0, 3, 1, 2>} : (tensor<5x10x20x6xf32>) -> tensor<5x6x10x20xf32>
+// CHECK:           %[[RESULT:.*]] = torch_c.from_builtin_tensor %[[RESULT_NCHW]] : tensor<5x6x10x20xf32> -> !torch.vtensor<[5,6,10,20],f32>
+// CHECK:           return %[[RESULT]] : !torch.vtensor<[5,6,10,20],f32>
+func.func @torch.aten.convolution$grouped_conv2d(%arg0: !torch.vtensor<[5,4,10,20],f32>) -> !torch.vtensor<[5,6,10,20],f32> {
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.vtensor.literal(dense_resource<torch_tensor_6_2_3_3_torch.float32> : tensor<6x2x3x3xf32>) : !torch.vtensor<[6,2,3,3],f32>
+  %none = torch.constant.none
+  %1 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.prim.ListConstruct  : () -> !torch.list<int>
+  %3 = torch.aten.convolution %arg0, %0, %none, %1, %1, %1, %false, %2, %int2 : !torch.vtensor<[5,4,10,20],f32>, !torch.vtensor<[6,2,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[5,6,10,20],f32>
+  return %3 : !torch.vtensor<[5,6,10,20],f32>
+}
+
+// -----
+
 // CHECK-LABEL:   func.func @torch.aten.convolution$depthwise_conv1d(
 // CHECK-SAME:                                                %[[ARG:.*]]: !torch.vtensor<[2,3,9],f32>) -> !torch.vtensor<[2,6,5],f32> {
 // CHECK:           %[[INPUT:.*]] = torch_c.to_builtin_tensor %[[ARG]] : !torch.vtensor<[2,3,9],f32> -> tensor<2x3x9xf32>
@@ -6224,3 +6233,22 @@ func.func @torch.aten.avg_pool2d$encoded_stride_with_non_unit_dilation(%arg0: !t
   %0 = torch.aten.avg_pool2d %arg0, %kernel, %stride, %padding, %false, %false, %none : !torch.vtensor<[1,64,16,16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[1,64,7,7],f32>
   return %0 : !torch.vtensor<[1,64,7,7],f32>
 }
+
+// -----
+
+// CHECK-LABEL:   func.func @test_reduce_mean_hw_keepdim$basic(
+// CHECK:           %[[SHAPE:.*]] = tosa.const_shape  {values = dense<[2, 3, 20]> : tensor<3xindex>} : () -> !tosa.shape<3>
+// CHECK:           %[[MERGED:.*]] = tosa.reshape %{{.*}}, %[[SHAPE]] : (tensor<2x3x4x5xf32>, !tosa.shape<3>) -> tensor<2x3x20xf32>
+// CHECK:           %[[SUM:.*]] = tosa.reduce_sum %[[MERGED]] {axis = 2 : i32} : (tensor<2x3x20xf32>) -> tensor<2x3x1xf32>
+// CHECK-NOT:       tosa.reduce_sum
+// CHECK:           %[[KEEP_SHAPE:.*]] = tosa.const_shape  {values = dense<[2, 3, 1, 1]> : tensor<4xindex>} : () -> !tosa.shape<4>
+// CHECK:           tosa.reshape %[[SUM]], %[[KEEP_SHAPE]] : (tensor<2x3x1xf32>, !tosa.shape<4>) -> tensor<2x3x1x1xf32>
+func.func @test_reduce_mean_hw_keepdim$basic(%arg0: !torch.vtensor<[2,3,4,5],f32>) -> !torch.vtensor<[2,3,1,1],f32> {
+  %int2 = torch.constant.int 2
+  %int3 = torch.constant.int 3
+  %true = torch.constant.bool true
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int2, %int3 : (!torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.mean.dim %arg0, %0, %true, %none : !torch.vtensor<[2,3,4,5],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[2,3,1,1],f32>
+  return %1 : !torch.vtensor<[2,3,1,1],f32>
+}
@@ -43,6 +43,40 @@ func.func @AtenMmQint8(%arg0: !torch.vtensor<[3,4],si8>, %arg1: !torch.vtensor<[
   return %7 : !torch.vtensor<[3,3],f32>
 }
 
+// -----
+
+// The requantization of the accumulator is a single rescale, and the relu a
+// clamp at the output zero point.
+// CHECK-LABEL:   func.func @AtenMmQint8Requantize(
+// CHECK:           %[[MATMUL:.*]] = tosa.matmul
+// CHECK:           %[[ACC:.*]] = tosa.reshape %[[MATMUL]]
+// CHECK:           %[[RESCALE:.*]] = tosa.rescale %[[ACC]]
+// CHECK-SAME:        -> tensor<3x3xi8>
+// CHECK:           %[[CLAMP:.*]] = tosa.clamp %[[RESCALE]] {max_val = 127 : i8, min_val = 5 : i8} : (tensor<3x3xi8>) -> tensor<3x3xi8>
+// CHECK-NOT:       tosa.mul
+// CHECK:           torch_c.from_builtin_tensor %[[CLAMP]]
+func.func @AtenMmQint8Requantize(%arg0: !torch.vtensor<[3,4],si8>, %arg1: !torch.vtensor<[4,3],si8>) -> !torch.vtensor<[3,3],!torch.qint8>
+{
+  %float3.784000e-04 = torch.constant.float 3.784000e-04
+  %float5.000000e-02 = torch.constant.float 5.000000e-02
+  %int0 = torch.constant.int 0
+  %int5 = torch.constant.int 5
+  %int12 = torch.constant.int 12
+  %int18 = torch.constant.int 18
+  %float1.760000e-02 = torch.constant.float 1.760000e-02
+  %float2.150000e-02 = torch.constant.float 2.150000e-02
+  %int-25 = torch.constant.int -25
+  %0 = torch.aten._make_per_tensor_quantized_tensor %arg0, %float2.150000e-02, %int-25 : !torch.vtensor<[3,4],si8>, !torch.float, !torch.int -> !torch.vtensor<[3,4],!torch.qint8>
+  %1 = torch.aten._make_per_tensor_quantized_tensor %arg1, %float1.760000e-02, %int18 : !torch.vtensor<[4,3],si8>, !torch.float, !torch.int -> !torch.vtensor<[4,3],!torch.qint8>
+  %2 = torch.aten.mm %0, %1 : !torch.vtensor<[3,4],!torch.qint8>, !torch.vtensor<[4,3],!torch.qint8> -> !torch.vtensor<[3,3],!torch.qint32>
+  %3 = torch.aten.int_repr %2 : !torch.vtensor<[3,3],!torch.qint32> -> !torch.vtensor<[3,3],si32>
+  %4 = torch.aten._make_per_tensor_quantized_tensor %3, %float3.784000e-04, %int0 : !torch.vtensor<[3,3],si32>, !torch.float, !torch.int -> !torch.vtensor<[3,3],!torch.qint32>
+  %5 = torch.aten.dequantize.tensor %4 : !torch.vtensor<[3,3],!torch.qint32> -> !torch.vtensor<[3,3],f32>
+  %6 = torch.aten.relu %5 : !torch.vtensor<[3,3],f32> -> !torch.vtensor<[3,3],f32>
+  %7 = torch.aten.quantize_per_tensor %6, %float5.000000e-02, %int5, %int12 : !torch.vtensor<[3,3],f32>, !torch.float, !torch.int, !torch.int -> !torch.vtensor<[3,3],!torch.qint8>
+  return %7 : !torch.vtensor<[3,3],!torch.qint8>
+}
+
 // -----
 // CHECK-LABEL:   func.func @quantization_per_tensor(
 // CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[2,4,4],f32>) -> !torch.vtensor<[2,4,4],!torch.qint8> {
@@ -114,3 +114,26 @@ func.func @scatter_add_scalar_1D(
   } -> tensor<8xi32>
   return %0 : tensor<8xi32>
 }
+
+// -----
+
+// The result of a gather is not read, so its buffer is not initialized.
+// CHECK-LABEL:   func.func @gather_slice_2D(
+// CHECK-SAME:            %[[SOURCE_TENSOR:.*]]: tensor<4x3xf32>,
+// CHECK-SAME:            %[[INDICES_TENSOR:.*]]: tensor<2x1xi32>) -> tensor<2x3xf32> {
+// CHECK-DAG:       %[[SOURCE_MEMREF:.*]] = bufferization.to_buffer %[[SOURCE_TENSOR]] : tensor<4x3xf32> to memref<4x3xf32>
+// CHECK-DAG:       %[[INDICES_MEMREF:.*]] = bufferization.to_buffer %[[INDICES_TENSOR]] : tensor<2x1xi32> to memref<2x1xi32>
+// CHECK-DAG:       %[[RESULT_MEMREF:.*]] = memref.alloc() : memref<2x3xf32>
+// CHECK-DAG:       %[[RESULT_TENSOR:.*]] = bufferization.to_tensor %[[RESULT_MEMREF]] : memref<2x3xf32> to tensor<2x3xf32>
+// CHECK-NOT:       memref.copy
+// CHECK:           tm_tensor.gather {dimension_map = array<i64: 0>} ins(%[[SOURCE_MEMREF]], %[[INDICES_MEMREF]]
+// CHECK-SAME:        : memref<4x3xf32>, memref<2x1xi32>) outs(%[[RESULT_MEMREF]] : memref<2x3xf32>)
+// CHECK:           return %[[RESULT_TENSOR]] : tensor<2x3xf32>
+func.func @gather_slice_2D(
+    %source: tensor<4x3xf32>, %indices: tensor<2x1xi32>) -> tensor<2x3xf32> {
+  %init = tensor.empty() : tensor<2x3xf32>
+  %0 = tm_tensor.gather {dimension_map = array<i64: 0>}
+    ins(%source, %indices : tensor<4x3xf32>, tensor<2x1xi32>)
+    outs(%init : tensor<2x3xf32>) -> tensor<2x3xf32>
+  return %0 : tensor<2x3xf32>
+}
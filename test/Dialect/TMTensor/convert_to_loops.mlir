@@ -17,19 +17,16 @@ func.func @scan_1d_inclusive(%0: memref<128xi32>, %1: memref<128xi32>) {
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[ACC:.+]] = memref.alloc() : memref<i32>
-// CHECK:         scf.for %[[ARG1:.+]] = %[[C0]] to %[[C128]] step %[[C1]]
-// CHECK:           %[[COND:.+]] = arith.cmpi eq, %[[ARG1]], %[[C0]] : index
-// CHECK:           scf.if %[[COND]] {
-// CHECK:             %[[V1:.+]] = memref.load %[[BUFI]][%[[ARG1]]]
-// CHECK:             memref.store %[[V1]], %[[BUFO]][%[[ARG1]]]
-// CHECK:           } else {
-// CHECK:             %[[T1:.+]] = arith.subi %[[ARG1]], %[[C1]] : index
-// CHECK:             %[[V2:.+]] = memref.load %[[BUFO]][%[[T1]]]
-// CHECK:             %[[V3:.+]] = memref.load %[[BUFI]][%[[ARG1]]]
-// CHECK:             %[[V4:.+]] = arith.addi %[[V2]], %[[V3]] : i32
-// CHECK:             memref.store %[[V4]], %[[BUFO]][%[[ARG1]]]
-// CHECK:             memref.store %[[V4]], %[[ACC]][]
-// CHECK:           }
+// CHECK:         %[[V0:.+]] = memref.load %[[BUFI]][%[[C0]]]
+// CHECK:         memref.store %[[V0]], %[[BUFO]][%[[C0]]]
+// CHECK:         scf.for %[[ARG1:.+]] = %[[C1]] to %[[C128]] step %[[C1]] iter_args(%[[PREV:.+]] = %[[V0]]) -> (i32) {
+// CHECK:           %[[V1:.+]] = memref.load %[[BUFI]][%[[ARG1]]]
+// CHECK:           %[[V2:.+]] = arith.addi %[[PREV]], %[[V1]] : i32
+// CHECK:           memref.store %[[V2]], %[[BUFO]][%[[ARG1]]]
+// CHECK:           scf.yield %[[V2]] : i32
+// CHECK:         }
+// CHECK:         %[[TOTAL:.+]] = memref.load %[[BUFO]][%{{.+}}]
+// CHECK:         memref.store %[[TOTAL]], %[[ACC]][]
 
 // -----
 
@@ -50,19 +47,17 @@ func.func @scan_1d_exclusive(%0: memref<128xi32>, %1: memref<128xi32>) {
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[ACC:.+]] = memref.alloc() : memref<i32>
-// CHECK:         scf.for %[[ARG1:.+]] = %[[C0]] to %[[C128]] step %[[C1]]
-// CHECK:           %[[COND:.+]] = arith.cmpi eq, %[[ARG1]], %[[C0]] : index
-// CHECK:           scf.if %[[COND]] {
-// CHECK:             %[[V0:.+]] = memref.load %[[ACC]][] : memref<i32>
-// CHECK:             memref.store %[[V0]], %[[BUFO]][%[[ARG1]]]
-// CHECK:           } else {
-// CHECK:             %[[T1:.+]] = arith.subi %[[ARG1]], %[[C1]] : index
-// CHECK:             %[[V2:.+]] = memref.load %[[BUFO]][%[[T1]]]
-// CHECK:             %[[V3:.+]] = memref.load %[[BUFI]][%[[T1]]]
-// CHECK:             %[[V4:.+]] = arith.addi %[[V2]], %[[V3]] : i32
-// CHECK:             memref.store %[[V4]], %[[BUFO]][%[[ARG1]]]
-// CHECK:             memref.store %[[V4]], %[[ACC]][]
-// CHECK:           }
+// CHECK:         %[[V0:.+]] = memref.load %[[ACC]][] : memref<i32>
+// CHECK:         memref.store %[[V0]], %[[BUFO]][%[[C0]]]
+// CHECK:         scf.for %[[ARG1:.+]] = %[[C1]] to %[[C128]] step %[[C1]] iter_args(%[[PREV:.+]] = %[[V0]]) -> (i32) {
+// CHECK:           %[[T1:.+]] = arith.subi %[[ARG1]], %[[C1]] : index
+// CHECK:           %[[V1:.+]] = memref.load %[[BUFI]][%[[T1]]]
+// CHECK:           %[[V2:.+]] = arith.addi %[[PREV]], %[[V1]] : i32
+// CHECK:           memref.store %[[V2]], %[[BUFO]][%[[ARG1]]]
+// CHECK:           scf.yield %[[V2]] : i32
+// CHECK:         }
+// CHECK:         %[[TOTAL:.+]] = memref.load %[[BUFO]][%{{.+}}]
+// CHECK:         memref.store %[[TOTAL]], %[[ACC]][]
 
 // -----
 
@@ -84,21 +79,53 @@ func.func @scan_2d(%0: memref<16x32xi32>, %1: memref<16x32xi32>) {
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[ACC:.+]] = memref.alloc() : memref<32xi32>
-// CHECK:         scf.for %[[ARG1:.+]] = %[[C0]] to %[[C16]] step %[[C1]]
-// CHECK:           scf.for %[[ARG2:.+]] = %[[C0]] to %[[C32]] step %[[C1]]
-// CHECK:             %[[COND:.+]] = arith.cmpi eq, %[[ARG1]], %[[C0]] : index
-// CHECK:             scf.if %[[COND]] {
-// CHECK:               %[[V1:.+]] = memref.load %[[BUFI]][%[[ARG1]], %[[ARG2]]]
-// CHECK:               memref.store %[[V1]], %[[BUFO]][%[[ARG1]], %[[ARG2]]]
-// CHECK:             } else {
-// CHECK:               %[[T1:.+]] = arith.subi %[[ARG1]], %[[C1]] : index
-// CHECK:               %[[V2:.+]] = memref.load %[[BUFO]][%[[T1]], %[[ARG2]]]
-// CHECK:               %[[V3:.+]] = memref.load %[[BUFI]][%[[ARG1]], %[[ARG2]]]
-// CHECK:               %[[V4:.+]] = arith.addi %[[V2]], %[[V3]] : i32
-// CHECK:               memref.store %[[V4]], %[[BUFO]][%[[ARG1]], %[[ARG2]]]
-// CHECK:               memref.store %[[V4]], %[[ACC]][%[[ARG2]]]
-// CHECK:             }
+// CHECK:         scf.parallel (%[[ARG2:.+]]) = (%[[C0]]) to (%[[C32]]) step (%[[C1]]) {
+// CHECK:           %[[V0:.+]] = memref.load %[[BUFI]][%[[C0]], %[[ARG2]]]
+// CHECK:           memref.store %[[V0]], %[[BUFO]][%[[C0]], %[[ARG2]]]
+// CHECK:           scf.for %[[ARG1:.+]] = %[[C1]] to %[[C16]] step %[[C1]] iter_args(%[[PREV:.+]] = %[[V0]]) -> (i32) {
+// CHECK:             %[[V1:.+]] = memref.load %[[BUFI]][%[[ARG1]], %[[ARG2]]]
+// CHECK:             %[[V2:.+]] = arith.addi %[[PREV]], %[[V1]] : i32
+// CHECK:             memref.store %[[V2]], %[[BUFO]][%[[ARG1]], %[[ARG2]]]
+// CHECK:             scf.yield %[[V2]] : i32
+// CHECK:           }
+// CHECK:           %[[TOTAL:.+]] = memref.load %[[BUFO]][%{{.+}}, %[[ARG2]]]
+// CHECK:           memref.store %[[TOTAL]], %[[ACC]][%[[ARG2]]]
 
+// -----
+
+func.func @scan_1d_blocked(%0: memref<?xi32>, %1: memref<?xi32>, %2: memref<i32>) {
+  tm_tensor.scan dimension(0) inclusive(true)
+    ins(%0 : memref<?xi32>) outs(%1, %2 : memref<?xi32>, memref<i32>) {
+    ^bb0(%arg0 : i32, %arg1 : i32):
+      %sum = arith.addi %arg0, %arg1 : i32
+      tm_tensor.yield %sum : i32
+  }
+  return
+}
+// CHECK-LABEL: func.func @scan_1d_blocked
+// CHECK-SAME:    %[[BUFI:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[BUFO:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[ACC:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C1024:.+]] = arith.constant 1024 : index
+// CHECK:         %[[SIZE:.+]] = memref.dim %[[BUFI]], %{{.+}} : memref<?xi32>
+// CHECK:         scf.if
+// CHECK:           %[[NUM_BLOCKS:.+]] = arith.ceildivui %[[SIZE]], %[[C1024]]
+// CHECK:           scf.parallel (%[[BLOCK:.+]]) = (%{{.+}}) to (%[[NUM_BLOCKS]])
+// CHECK:             scf.for {{.+}} iter_args
+// CHECK:               arith.addi
+// CHECK:           %[[IS_BLOCKED:.+]] = arith.cmpi ugt, %[[NUM_BLOCKS]]
+// CHECK:           scf.if %[[IS_BLOCKED]] {
+// CHECK:             %[[PREFIXES:.+]] = memref.alloc(%[[NUM_BLOCKS]]) : memref<?xi32>
+// CHECK:             scf.for {{.+}} iter_args
+// CHECK:               memref.store {{.+}}, %[[PREFIXES]]
+// CHECK:               arith.addi
+// CHECK:             scf.parallel
+// CHECK:               %[[PREFIX:.+]] = memref.load %[[PREFIXES]]
+// CHECK:               scf.for
+// CHECK:                 arith.addi %[[PREFIX]]
+// CHECK:             memref.dealloc %[[PREFIXES]]
+// CHECK:           }
+// CHECK:           memref.store {{.+}}, %[[ACC]][]
 
 // -----
 
@@ -120,7 +147,7 @@ func.func @scatter_update_scalar_1D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[C3]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<3xi32>
 // CHECK:           %[[T2:.+]] =  memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<3x1xi32>
 // CHECK:           %[[IDX:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -147,7 +174,7 @@ func.func @scatter_add_scalar_2D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[C3]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<3xi32>
 // CHECK:           %[[T2:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<3x2xi32>
 // CHECK:           %[[IDX1:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -178,13 +205,11 @@ func.func @scatter_update_slice_2D(
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
 // CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C2]] step %[[C1]] {
-// CHECK:           scf.for %[[J:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]], %[[J:.+]]) = (%[[C0]], %[[C0]]) to (%[[C2]], %[[C3]]) step (%[[C1]], %[[C1]]) {
 // CHECK:             %[[UPDATE:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
 // CHECK:             %[[INDEX:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
 // CHECK:             %[[LOC:.+]] = arith.index_cast %[[INDEX]] : i32 to index
 // CHECK:             memref.store %[[UPDATE]], %[[ORIGINAL]][%[[LOC]], %[[J]]]
-// CHECK:           }
 // CHECK:         }
 
 // -----
@@ -208,7 +233,7 @@ func.func @scatter_add_scalar_1D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[C3]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<3xi32>
 // CHECK:           %[[T2:.+]] =  memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<3x1xi32>
 // CHECK:           %[[IDX:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -237,8 +262,7 @@ func.func @scatter_add_slice_2D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C2]] step %[[C1]] {
-// CHECK:           scf.for %[[J:.+]] = %[[C0]] to %[[C3]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]], %[[J:.+]]) = (%[[C0]], %[[C0]]) to (%[[C2]], %[[C3]]) step (%[[C1]], %[[C1]]) {
 // CHECK:             %[[UPDATEVAL:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
 // CHECK:             %[[INDEXVAL:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
 // CHECK:             %[[INDEX:.+]] = arith.index_cast %[[INDEXVAL]] : i32 to index
@@ -266,7 +290,7 @@ func.func @scatter_update_scalar_dynamic_1D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[UB:.+]] = memref.dim %[[UPDATES]], %[[C0]] : memref<?xi32>
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[UB]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[UB]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<?xi32>
 // CHECK:           %[[T2:.+]] =  memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<?x1xi32>
 // CHECK:           %[[IDX:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -293,7 +317,7 @@ func.func @scatter_add_scalar_dynamic_2D(
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[UB:.+]] = memref.dim %[[UPDATES]], %[[C0]] : memref<?xi32>
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[UB]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[UB]]) step (%[[C1]]) {
 // CHECK:           %[[T1:.+]] = memref.load %[[UPDATES]][%[[I]]] : memref<?xi32>
 // CHECK:           %[[T2:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]] : memref<?x2xi32>
 // CHECK:           %[[IDX1:.+]] = arith.index_cast %[[T2]] : i32 to index
@@ -324,8 +348,7 @@ func.func @scatter_update_slice_dynamic_2D(
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[UB1:.+]] = memref.dim %[[UPDATES]], %[[C0]] : memref<?x?xi32>
 // CHECK-DAG:     %[[UB2:.+]] = memref.dim %[[UPDATES]], %[[C1]] : memref<?x?xi32>
-// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[UB1]] step %[[C1]] {
-// CHECK:           scf.for %[[J:.+]] = %[[C0]] to %[[UB2]] step %[[C1]] {
+// CHECK:         scf.parallel (%[[I:.+]], %[[J:.+]]) = (%[[C0]], %[[C0]]) to (%[[UB1]], %[[UB2]]) step (%[[C1]], %[[C1]]) {
 // CHECK:             %[[UPDATEVAL:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
 // CHECK:             %[[INDEXVAL:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
 // CHECK:             %[[INDEX:.+]] = arith.index_cast %[[INDEXVAL]] : i32 to index
@@ -354,8 +377,7 @@ func.func @scatter_partial_slices(%arg0: memref<2x64x12xf32>, %arg1: memref<2x3x
 // CHECK-DAG:     %[[C2:.+]] = arith.constant
 // CHECK-DAG:     %[[C12:.+]] = arith.constant
 // CHECK:         scf.for %[[ARG3:.+]] = %[[C0]] to %[[C2]] step %[[C1]] {
-// CHECK-NEXT:       scf.for %[[ARG4:.+]] = %[[C0]] to %[[C1]] step %[[C1]] {
-// CHECK-NEXT:         scf.for %[[ARG5:.+]] = %[[C0]] to %[[C12]] step %[[C1]] {
+// CHECK-NEXT:       scf.parallel (%[[ARG4:.+]], %[[ARG5:.+]]) = (%[[C0]], %[[C0]]) to (%[[C1]], %[[C12]]) step (%[[C1]], %[[C1]]) {
 // CHECK-NEXT:           %[[LOAD0:.+]] = memref.load %[[ARG1]][%[[ARG3]], %[[C0]]] : memref<2x3xi32>
 // CHECK-NEXT:           %[[CAST0:.+]] = arith.index_cast %[[LOAD0]] : i32 to index
 // CHECK-NEXT:           %[[LOAD1:.+]] = memref.load %[[ARG1]][%[[ARG3]], %[[C1]]] : memref<2x3xi32>
@@ -366,3 +388,425 @@ func.func @scatter_partial_slices(%arg0: memref<2x64x12xf32>, %arg1: memref<2x3x
 // CHECK-NEXT:           %[[ADD2:.+]] = arith.addi %[[CAST2]], %[[ARG5]] : index
 // CHECK-NEXT:           %[[LOAD3:.+]] = memref.load %[[ARG0]][%[[CAST0]], %[[ADD1]], %[[ADD2]]] : memref<2x64x12xf32>
 // CHECK-NEXT:           memref.store %[[LOAD3]], %[[ARG0]][%[[CAST0]], %[[ADD1]], %[[ADD2]]] : memref<2x64x12xf32>
+
+// -----
+
+func.func @scatter_add_non_unique_f32(
+    %original: memref<8x4xf32>, %indices: memref<?x1xi32>,
+    %updates: memref<?x4xf32>) {
+  tm_tensor.scatter {dimension_map= array<i64: 0>} unique_indices(false)
+    ins(%updates, %indices : memref<?x4xf32>, memref<?x1xi32>)
+    outs(%original : memref<8x4xf32>)  {
+  ^bb0(%arg0: f32, %arg1: f32):
+    %0 = arith.addf %arg1, %arg0 : f32
+    tm_tensor.yield %0 : f32
+  }
+  return
+}
+// Float additions are applied in order, so that the rounding does not depend
+// on the order in which parallel updates land.
+// CHECK-LABEL: func.func @scatter_add_non_unique_f32
+// CHECK-SAME:    %[[ORIGINAL:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[UPDATES:[a-zA-Z0-9]+]]
+// CHECK:         scf.for %[[I:.+]] =
+// CHECK:           scf.parallel (%[[J:.+]]) =
+// CHECK:             %[[UPDATE:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
+// CHECK:             %[[INDEX:.+]] = memref.load %[[INDICES]][%[[I]], %{{.+}}]
+// CHECK:             %[[LOC:.+]] = arith.index_cast %[[INDEX]] : i32 to index
+// CHECK:             %[[INIT:.+]] = memref.load %[[ORIGINAL]][%[[LOC]], %[[J]]]
+// CHECK:             %[[ADD:.+]] = arith.addf %[[INIT]], %[[UPDATE]] : f32
+// CHECK:             memref.store %[[ADD]], %[[ORIGINAL]][%[[LOC]], %[[J]]]
+// CHECK-NOT:     memref.atomic_rmw
+
+// -----
+
+func.func @scatter_add_non_unique_i32(
+    %original: memref<8x4xi32>, %indices: memref<?x1xi32>,
+    %updates: memref<?x4xi32>) {
+  tm_tensor.scatter {dimension_map= array<i64: 0>} unique_indices(false)
+    ins(%updates, %indices : memref<?x4xi32>, memref<?x1xi32>)
+    outs(%original : memref<8x4xi32>)  {
+  ^bb0(%arg0: i32, %arg1: i32):
+    %0 = arith.addi %arg1, %arg0 : i32
+    tm_tensor.yield %0 : i32
+  }
+  return
+}
+// CHECK-LABEL: func.func @scatter_add_non_unique_i32
+// CHECK-SAME:    %[[ORIGINAL:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[UPDATES:[a-zA-Z0-9]+]]
+// CHECK:         scf.parallel (%[[I:.+]], %[[J:.+]]) =
+// CHECK:           %[[UPDATE:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
+// CHECK:           %[[INDEX:.+]] = memref.load %[[INDICES]][%[[I]], %{{.+}}]
+// CHECK:           %[[LOC:.+]] = arith.index_cast %[[INDEX]] : i32 to index
+// CHECK:           memref.atomic_rmw addi %[[UPDATE]], %[[ORIGINAL]][%[[LOC]], %[[J]]]
+
+// -----
+
+func.func @scatter_update_non_unique(
+    %original: memref<8x4xf32>, %indices: memref<?x1xi32>,
+    %updates: memref<?x4xf32>) {
+  tm_tensor.scatter {dimension_map= array<i64: 0>} unique_indices(false)
+    ins(%updates, %indices : memref<?x4xf32>, memref<?x1xi32>)
+    outs(%original : memref<8x4xf32>)  {
+  ^bb0(%arg0: f32, %arg1: f32):
+    tm_tensor.yield %arg0 : f32
+  }
+  return
+}
+// CHECK-LABEL: func.func @scatter_update_non_unique
+// CHECK-SAME:    %[[ORIGINAL:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[UPDATES:[a-zA-Z0-9]+]]
+// CHECK:         scf.for %[[I:.+]] =
+// CHECK:           scf.parallel (%[[J:.+]]) =
+// CHECK:             %[[UPDATE:.+]] = memref.load %[[UPDATES]][%[[I]], %[[J]]]
+// CHECK:             memref.store %[[UPDATE]], %[[ORIGINAL]][%{{.+}}, %[[J]]]
+
+// -----
+
+func.func @attention(%q: memref<2x128x16xf32>, %k: memref<2x256x16xf32>,
+                     %v: memref<2x256x32xf32>, %out: memref<2x128x32xf32>) {
+  tm_tensor.attention {scale = 2.500000e-01 : f64}
+    ins(%q, %k, %v : memref<2x128x16xf32>, memref<2x256x16xf32>, memref<2x256x32xf32>)
+    outs(%out : memref<2x128x32xf32>)
+  return
+}
+// CHECK-LABEL: func.func @attention
+// CHECK-SAME:    %[[Q:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[K:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[V:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[OUT:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C64:.+]] = arith.constant 64 : index
+// CHECK-DAG:     %[[NEG_INF:.+]] = arith.constant 0xFF800000 : f32
+// CHECK-DAG:     %[[SCALE:.+]] = arith.constant 2.500000e-01 : f32
+// CHECK:         scf.parallel (%[[B:.+]], %[[M:.+]]) =
+// CHECK:           %[[SCORES:.+]] = memref.alloca() : memref<64xf32>
+// CHECK:           %[[STATS:.+]]:2 = scf.for %[[TILE:.+]] = {{.+}} step %[[C64]] iter_args(%[[MAX:.+]] = %[[NEG_INF]], %[[SUM:.+]] = {{.+}})
+// CHECK:             arith.minui
+// CHECK:             memref.load %[[Q]][%[[B]], %[[M]], {{.+}}]
+// CHECK:             memref.load %[[K]][%[[B]], {{.+}}, {{.+}}]
+// CHECK:             arith.mulf {{.+}}, %[[SCALE]]
+// CHECK:             memref.store {{.+}}, %[[SCORES]]
+// CHECK:             arith.maximumf
+// CHECK:             math.exp
+// CHECK:             memref.load %[[SCORES]]
+// CHECK:             math.exp
+// CHECK:             memref.load %[[V]][%[[B]], {{.+}}, {{.+}}]
+// CHECK:             scf.yield
+// CHECK:           arith.divf {{.+}}, %[[STATS]]#1
+// CHECK:           memref.store {{.+}}, %[[OUT]][%[[B]], %[[M]], {{.+}}]
+
+// -----
+
+func.func @attention_mods(%q: memref<2x128x16xf32>, %k: memref<2x256x16xf32>,
+                          %v: memref<2x256x32xf32>, %out: memref<2x128x32xf32>) {
+  tm_tensor.attention
+    ins(%q, %k, %v : memref<2x128x16xf32>, memref<2x256x16xf32>, memref<2x256x32xf32>)
+    outs(%out : memref<2x128x32xf32>)
+    score_mod {
+    ^bb0(%score: f32, %b: index, %m: index, %n: index):
+      %0 = math.tanh %score : f32
+      tm_tensor.yield %0 : f32
+    }
+    mask_mod {
+    ^bb0(%b: index, %m: index, %n: index):
+      %0 = arith.cmpi sge, %m, %n : index
+      tm_tensor.yield %0 : i1
+    }
+  return
+}
+// CHECK-LABEL: func.func @attention_mods
+// CHECK-SAME:    %[[Q:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[K:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[V:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[NEG_INF:.+]] = arith.constant 0xFF800000 : f32
+// CHECK-DAG:     %[[FALSE:.+]] = arith.constant false
+// CHECK:         scf.parallel (%[[B:.+]], %[[M:.+]]) =
+// CHECK:           scf.for %[[TILE:.+]] = {{.+}} iter_args(%[[MAX:.+]] = %[[NEG_INF]], %[[SUM:.+]] = {{.+}})
+// CHECK:             %[[TILE_STATS:.+]]:2 = scf.for %[[J:.+]] = {{.+}} iter_args({{.+}} = %[[MAX]], %[[ANY:.+]] = %[[FALSE]])
+// CHECK:               %[[N:.+]] = arith.addi %[[TILE]], %[[J]]
+// CHECK:               %[[KEPT:.+]] = arith.cmpi sge, %[[M]], %[[N]]
+// CHECK:               scf.if %[[KEPT]] -> (f32)
+// CHECK:                 memref.load %[[K]][%[[B]], %[[N]], {{.+}}]
+// CHECK:                 math.tanh
+// CHECK:               } else {
+// CHECK:                 scf.yield %[[NEG_INF]]
+// CHECK:               arith.ori %[[ANY]], %[[KEPT]]
+// CHECK:             scf.if %[[TILE_STATS]]#1 -> (f32, f32)
+// CHECK:               math.exp
+// CHECK:               arith.cmpf one, {{.+}}, %[[NEG_INF]]
+// CHECK:               scf.if
+// CHECK:                 memref.load %[[V]][%[[B]], {{.+}}, {{.+}}]
+// CHECK:             } else {
+// CHECK:               scf.yield %[[MAX]], %[[SUM]]
+
+// -----
+
+func.func @attention_causal_window(%q: memref<2x128x16xf32>, %k: memref<2x128x16xf32>,
+                                   %v: memref<2x128x32xf32>, %out: memref<2x128x32xf32>) {
+  tm_tensor.attention {causal, window_size = 32 : i64}
+    ins(%q, %k, %v : memref<2x128x16xf32>, memref<2x128x16xf32>, memref<2x128x32xf32>)
+    outs(%out : memref<2x128x32xf32>)
+  return
+}
+// CHECK-LABEL: func.func @attention_causal_window
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C31:.+]] = arith.constant 31 : index
+// CHECK-DAG:     %[[C64:.+]] = arith.constant 64 : index
+// CHECK-DAG:     %[[C128:.+]] = arith.constant 128 : index
+// CHECK:         scf.parallel (%[[B:.+]], %[[M:.+]]) =
+// CHECK:           %[[NEXT:.+]] = arith.addi %[[M]], %[[C1]]
+// CHECK:           %[[END:.+]] = arith.minui %[[NEXT]], %[[C128]]
+// CHECK:           %[[CLIPPED:.+]] = arith.cmpi ult, %[[M]], %[[C31]]
+// CHECK:           %[[FIRST:.+]] = arith.subi %[[M]], %[[C31]]
+// CHECK:           %[[BEGIN:.+]] = arith.select %[[CLIPPED]], %[[C0]], %[[FIRST]]
+// CHECK:           scf.for %[[TILE:.+]] = %[[BEGIN]] to %[[END]] step %[[C64]]
+// CHECK:             %[[REST:.+]] = arith.subi %[[END]], %[[TILE]]
+// CHECK:             arith.minui %[[REST]], %[[C64]]
+
+// -----
+
+func.func @paged_attention(%q: memref<4x8x16xf32>, %kc: memref<64x16x2x16xf32>,
+                           %vc: memref<64x16x2x32xf32>, %tables: memref<4x8xi32>,
+                           %lens: memref<4xi32>, %out: memref<4x8x32xf32>) {
+  tm_tensor.paged_attention
+    ins(%q, %kc, %vc, %tables, %lens : memref<4x8x16xf32>, memref<64x16x2x16xf32>, memref<64x16x2x32xf32>, memref<4x8xi32>, memref<4xi32>)
+    outs(%out : memref<4x8x32xf32>)
+  return
+}
+// CHECK-LABEL: func.func @paged_attention
+// CHECK-SAME:    %[[Q:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[KC:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[VC:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[TABLES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[LENS:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[OUT:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C4:.+]] = arith.constant 4 : index
+// CHECK-DAG:     %[[C8:.+]] = arith.constant 8 : index
+// CHECK-DAG:     %[[C16:.+]] = arith.constant 16 : index
+// CHECK:         scf.parallel (%[[SEQ:.+]], %[[HEAD:.+]]) = (%[[C0]], %[[C0]]) to (%[[C4]], %[[C8]]) step (%[[C1]], %[[C1]]) {
+// CHECK:           %[[KV_HEAD:.+]] = arith.divui %[[HEAD]], %[[C4]]
+// CHECK:           %[[LEN_I32:.+]] = memref.load %[[LENS]][%[[SEQ]]]
+// CHECK:           %[[LEN:.+]] = arith.index_cast %[[LEN_I32]] : i32 to index
+// CHECK:           %[[SCORES:.+]] = memref.alloca() : memref<16xf32>
+// CHECK:           %[[NUM_BLOCKS:.+]] = arith.ceildivui %[[LEN]], %[[C16]]
+// CHECK:           %[[STATS:.+]]:2 = scf.for %[[I:.+]] = %[[C0]] to %[[NUM_BLOCKS]] step %[[C1]]
+// CHECK:             %[[BLOCK_I32:.+]] = memref.load %[[TABLES]][%[[SEQ]], %[[I]]]
+// CHECK:             %[[BLOCK:.+]] = arith.index_cast %[[BLOCK_I32]] : i32 to index
+// CHECK:             memref.load %[[Q]][%[[SEQ]], %[[HEAD]], {{.+}}]
+// CHECK:             memref.load %[[KC]][%[[BLOCK]], {{.+}}, %[[KV_HEAD]], {{.+}}]
+// CHECK:             memref.store {{.+}}, %[[SCORES]]
+// CHECK:             math.exp
+// CHECK:             memref.load %[[VC]][%[[BLOCK]], {{.+}}, %[[KV_HEAD]], {{.+}}]
+// CHECK:           arith.divf {{.+}}, %[[STATS]]#1
+// CHECK:           memref.store {{.+}}, %[[OUT]][%[[SEQ]], %[[HEAD]], {{.+}}]
+
+// -----
+
+func.func @sort(%arg0: memref<4x?xi32>) {
+  tm_tensor.sort dimension(1) outs(%arg0 : memref<4x?xi32>) {
+  ^bb0(%lhs: i32, %rhs: i32):
+    %0 = arith.cmpi slt, %lhs, %rhs : i32
+    tm_tensor.yield %0 : i1
+  }
+  return
+}
+// CHECK-LABEL: func.func @sort
+// CHECK-SAME:    %[[ARG0:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
+// CHECK-DAG:     %[[FALSE:.+]] = arith.constant false
+// CHECK:         %[[SIZE:.+]] = memref.dim %[[ARG0]], %{{.+}} : memref<4x?xi32>
+// CHECK:         scf.parallel (%[[ROW:.+]]) =
+// CHECK:           %[[BUF_A:.+]] = memref.alloc(%[[SIZE]]) : memref<?xi32>
+// CHECK:           %[[BUF_B:.+]] = memref.alloc(%[[SIZE]]) : memref<?xi32>
+// CHECK:           scf.for
+// CHECK:             memref.load %[[ARG0]][%[[ROW]], {{.+}}]
+// CHECK:             memref.store {{.+}}, %[[BUF_A]]
+// CHECK:           %[[WHILE:.+]]:2 = scf.while (%[[WIDTH:.+]] = %{{.+}}, %[[IN_B:.+]] = %[[FALSE]])
+// CHECK:             arith.cmpi ult, %[[WIDTH]], %[[SIZE]]
+// CHECK:             %[[STEP:.+]] = arith.muli {{.+}}, %[[C2]]
+// CHECK:             scf.for %{{.+}} = {{.+}} to %[[SIZE]] step %[[STEP]]
+// CHECK:               scf.for {{.+}} iter_args
+// CHECK:                 arith.cmpi slt
+// CHECK:                 scf.yield
+// CHECK:           arith.select %[[WHILE]]#1
+// CHECK:           memref.store {{.+}}, %[[ARG0]][%[[ROW]], {{.+}}]
+// CHECK:           memref.dealloc %[[BUF_A]]
+// CHECK:           memref.dealloc %[[BUF_B]]
+
+// -----
+
+func.func @topk(%values: memref<2x?xf32>, %out_values: memref<2x3xf32>,
+                %out_indices: memref<2x3xi32>) {
+  tm_tensor.topk dimension(1)
+    ins(%values : memref<2x?xf32>)
+    outs(%out_values, %out_indices : memref<2x3xf32>, memref<2x3xi32>) {
+  ^bb0(%lhs: f32, %rhs: f32):
+    %0 = arith.cmpf ogt, %lhs, %rhs : f32
+    tm_tensor.yield %0 : i1
+  }
+  return
+}
+// CHECK-LABEL: func.func @topk
+// CHECK-SAME:    %[[VALUES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[OUT_VALUES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[OUT_INDICES:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[CHUNK:.+]] = arith.constant 4096 : index
+// CHECK:         %[[N:.+]] = memref.dim %[[VALUES]], %{{.+}} : memref<2x?xf32>
+// CHECK:         scf.parallel (%[[ROW:.+]]) =
+// CHECK:           scf.for
+// CHECK:             scf.while
+// CHECK:           %[[NUM_CHUNKS:.+]] = arith.ceildivui %[[N]], %[[CHUNK]]
+// CHECK:           %[[IS_CHUNKED:.+]] = arith.cmpi ugt, %[[NUM_CHUNKS]]
+// CHECK:           scf.if %[[IS_CHUNKED]] {
+// CHECK:             %[[SCRATCH_VALUES:.+]] = memref.alloc(%[[NUM_CHUNKS]], {{.+}}) : memref<?x?xf32>
+// CHECK:             %[[SCRATCH_INDICES:.+]] = memref.alloc(%[[NUM_CHUNKS]], {{.+}}) : memref<?x?xi32>
+// CHECK:             scf.parallel (%[[C:.+]]) =
+// CHECK:               memref.load %[[VALUES]][%[[ROW]], {{.+}}]
+// CHECK:               memref.store {{.+}}, %[[SCRATCH_VALUES]][%[[C]], {{.+}}]
+// CHECK:             scf.for
+// CHECK:               memref.load %[[SCRATCH_VALUES]]
+// CHECK:               memref.load %[[OUT_VALUES]][%[[ROW]], %{{.+}}]
+// CHECK:               arith.cmpf ogt
+// CHECK:               scf.if
+// CHECK:             memref.dealloc %[[SCRATCH_VALUES]]
+// CHECK:             memref.dealloc %[[SCRATCH_INDICES]]
+// CHECK:           } else {
+// CHECK:             scf.for %{{.+}} = %{{.+}} to %[[N]]
+// CHECK:               memref.load %[[VALUES]][%[[ROW]], {{.+}}]
+// CHECK:               arith.index_cast {{.+}} : index to i32
+// CHECK:               arith.cmpf ogt
+// CHECK:               scf.if
+// CHECK:                 scf.while
+// CHECK:           scf.for
+// CHECK:             memref.store {{.+}}, %[[OUT_VALUES]][%[[ROW]], {{.+}}]
+// CHECK:             scf.while
+
+// -----
+
+func.func @gather_slice_2D(
+    %source: memref<4x3xi32>, %indices: memref<2x1xi32>,
+    %result: memref<2x3xi32>) {
+  tm_tensor.gather {dimension_map = array<i64: 0>}
+    ins(%source, %indices : memref<4x3xi32>, memref<2x1xi32>)
+    outs(%result : memref<2x3xi32>)
+  return
+}
+// CHECK-LABEL: func.func @gather_slice_2D
+// CHECK-SAME:    %[[SOURCE:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[RESULT:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
+// CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[C2]]) step (%[[C1]]) {
+// CHECK:           %[[INDEXVAL:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
+// CHECK:           %[[INDEX:.+]] = arith.index_cast %[[INDEXVAL]] : i32 to index
+// CHECK:           scf.parallel (%[[J:.+]]) = (%[[C0]]) to (%[[C3]]) step (%[[C1]]) {
+// CHECK:             %[[VAL:.+]] = memref.load %[[SOURCE]][%[[INDEX]], %[[J]]]
+// CHECK:             memref.store %[[VAL]], %[[RESULT]][%[[I]], %[[J]]]
+
+// -----
+
+func.func @gather_scalar_2D(
+    %source: memref<4x3xf32>, %indices: memref<5x2xi64>,
+    %result: memref<5xf32>) {
+  tm_tensor.gather {dimension_map = array<i64: 1, 0>}
+    ins(%source, %indices : memref<4x3xf32>, memref<5x2xi64>)
+    outs(%result : memref<5xf32>)
+  return
+}
+// CHECK-LABEL: func.func @gather_scalar_2D
+// CHECK-SAME:    %[[SOURCE:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[RESULT:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C5:.+]] = arith.constant 5 : index
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[C5]]) step (%[[C1]]) {
+// CHECK:           %[[T0:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
+// CHECK:           %[[IDX1:.+]] = arith.index_cast %[[T0]] : i64 to index
+// CHECK:           %[[T1:.+]] = memref.load %[[INDICES]][%[[I]], %[[C1]]]
+// CHECK:           %[[IDX0:.+]] = arith.index_cast %[[T1]] : i64 to index
+// CHECK:           %[[VAL:.+]] = memref.load %[[SOURCE]][%[[IDX0]], %[[IDX1]]]
+// CHECK:           memref.store %[[VAL]], %[[RESULT]][%[[I]]]
+
+// -----
+
+func.func @segment_reduce_mean(
+    %data: memref<6x4xf32>, %segment_ids: memref<6xi64>,
+    %original: memref<3x4xf32>) {
+  tm_tensor.segment_reduce {mean}
+    ins(%data, %segment_ids : memref<6x4xf32>, memref<6xi64>)
+    outs(%original : memref<3x4xf32>) {
+  ^bb0(%arg0: f32, %arg1: f32):
+    %0 = arith.addf %arg0, %arg1 : f32
+    tm_tensor.yield %0 : f32
+  }
+  return
+}
+// CHECK-LABEL: func.func @segment_reduce_mean
+// CHECK-SAME:    %[[DATA:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[IDS:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[ORIGINAL:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
+// CHECK-DAG:     %[[C4:.+]] = arith.constant 4 : index
+// CHECK:         scf.parallel (%[[S:.+]]) = (%[[C0]]) to (%[[C3]]) step (%[[C1]]) {
+// CHECK:           %[[ID:.+]] = arith.index_cast %[[S]] : index to i64
+// CHECK:           %[[NEXT_ID:.+]] = arith.addi %[[ID]]
+// CHECK:           %[[BEGIN:.+]]:2 = scf.while
+// CHECK:             memref.load %[[IDS]]
+// CHECK:           %[[END:.+]]:2 = scf.while
+// CHECK:           scf.parallel (%[[J:.+]]) = (%[[C0]]) to (%[[C4]]) step (%[[C1]]) {
+// CHECK:             %[[INIT:.+]] = memref.load %[[ORIGINAL]][%[[S]], %[[J]]]
+// CHECK:             %[[SUM:.+]] = scf.for %[[R:.+]] = %[[BEGIN]]#0 to %[[END]]#0 step %[[C1]] iter_args(%[[ACC:.+]] = %[[INIT]]) -> (f32) {
+// CHECK:               %[[V:.+]] = memref.load %[[DATA]][%[[R]], %[[J]]]
+// CHECK:               %[[ADD:.+]] = arith.addf %[[V]], %[[ACC]] : f32
+// CHECK:               scf.yield %[[ADD]] : f32
+// CHECK:             %[[LEN:.+]] = arith.subi %[[END]]#0, %[[BEGIN]]#0
+// CHECK:             %[[COUNT:.+]] = arith.maxui %[[LEN]], %[[C1]]
+// CHECK:             %[[COUNT_F:.+]] = arith.uitofp
+// CHECK:             %[[MEAN:.+]] = arith.divf %[[SUM]], %[[COUNT_F]] : f32
+// CHECK:             memref.store %[[MEAN]], %[[ORIGINAL]][%[[S]], %[[J]]]
+
+// -----
+
+func.func @unique(
+    %input: memref<8xi64>, %values: memref<8xi64>, %inverse: memref<8xi64>,
+    %counts: memref<8xi64>) {
+  tm_tensor.unique
+    ins(%input : memref<8xi64>)
+    outs(%values, %inverse, %counts : memref<8xi64>, memref<8xi64>, memref<8xi64>)
+  return
+}
+// CHECK-LABEL: func.func @unique
+// CHECK-SAME:    %[[INPUT:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[VALUES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INVERSE:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[COUNTS:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C8:.+]] = arith.constant 8 : index
+// CHECK-DAG:     %[[CM1:.+]] = arith.constant -1 : i64
+// CHECK:         scf.for %[[I:.+]] = %[[C0]] to %[[C8]] step %[[C1]] iter_args(%[[G:.+]] = %[[CM1]]) -> (i64) {
+// CHECK:           arith.cmpi ne
+// CHECK:           %[[NEXT:.+]] = arith.addi %[[G]]
+// CHECK:           memref.store %[[NEXT]], %[[INVERSE]][%[[I]]]
+// CHECK:         scf.parallel
+// CHECK:           scf.if
+// CHECK:             memref.store %{{.+}}, %[[VALUES]]
+// CHECK:             memref.store %{{.+}}, %[[COUNTS]]
+// CHECK:         scf.parallel
+// CHECK:           scf.if
+// CHECK:             %[[START:.+]] = memref.load %[[COUNTS]]
+// CHECK:             %[[COUNT:.+]] = arith.subi %{{.+}}, %[[START]] : i64
+// CHECK:             memref.store %[[COUNT]], %[[COUNTS]]
@@ -0,0 +1,104 @@
+// RUN: torch-mlir-opt -split-input-file -tm-tensor-to-loops="vector-width=8" %s | FileCheck %s
+
+func.func @scan_2d(%0: memref<16x32xi32>, %1: memref<16x32xi32>) {
+  %t0 = memref.alloc() : memref<32xi32>
+  tm_tensor.scan dimension(0) inclusive(true)
+    ins(%0 : memref<16x32xi32>) outs(%1, %t0 : memref<16x32xi32>, memref<32xi32>) {
+    ^bb0(%arg0 : i32, %arg1 : i32):
+      %sum = arith.addi %arg0, %arg1 : i32
+      tm_tensor.yield %sum : i32
+  }
+  return
+}
+// CHECK-LABEL: func.func @scan_2d
+// CHECK-SAME:    %[[BUFI:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[BUFO:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C8:.+]] = arith.constant 8 : index
+// CHECK-DAG:     %[[C32:.+]] = arith.constant 32 : index
+// CHECK:         scf.parallel (%[[J:.+]]) = (%[[C0]]) to (%[[C32]]) step (%[[C8]]) {
+// CHECK:           %[[MASK:.+]] = vector.create_mask %{{.+}} : vector<8xi1>
+// CHECK:           %[[V0:.+]] = vector.maskedload %[[BUFI]][%[[C0]], %[[J]]], %[[MASK]]
+// CHECK:           vector.maskedstore %[[BUFO]][%[[C0]], %[[J]]], %[[MASK]], %[[V0]]
+// CHECK:           scf.for %[[I:.+]] = {{.+}} iter_args(%[[PREV:.+]] = %[[V0]]) -> (vector<8xi32>) {
+// CHECK:             %[[V1:.+]] = vector.maskedload %[[BUFI]][%[[I]], %[[J]]], %[[MASK]]
+// CHECK:             %[[V2:.+]] = arith.addi %[[PREV]], %[[V1]] : vector<8xi32>
+// CHECK:             vector.maskedstore %[[BUFO]][%[[I]], %[[J]]], %[[MASK]], %[[V2]]
+// CHECK:             scf.yield %[[V2]] : vector<8xi32>
+
+// -----
+
+// Scanning along the innermost dim is left scalar.
+func.func @scan_1d(%0: memref<128xi32>, %1: memref<128xi32>) {
+  %acc = memref.alloc() : memref<i32>
+  tm_tensor.scan dimension(0) inclusive(true)
+    ins(%0 : memref<128xi32>) outs(%1, %acc : memref<128xi32>, memref<i32>) {
+    ^bb0(%arg0 : i32, %arg1 : i32):
+      %sum = arith.addi %arg0, %arg1 : i32
+      tm_tensor.yield %sum : i32
+  }
+  return
+}
+// CHECK-LABEL: func.func @scan_1d
+// CHECK-NOT:     vector.
+// CHECK:         arith.addi %{{.+}}, %{{.+}} : i32
+// CHECK-NOT:     vector.
+
+// -----
+
+func.func @scatter_add_slice_2D(
+    %original: memref<4x20xf32>, %indices: memref<2x1xi32>,
+    %updates: memref<2x20xf32>) {
+  tm_tensor.scatter {dimension_map= array<i64: 0>} unique_indices(true)
+    ins(%updates, %indices : memref<2x20xf32>, memref<2x1xi32>)
+    outs(%original : memref<4x20xf32>)  {
+  ^bb0(%arg0: f32, %arg1: f32):
+    %0 = arith.addf %arg1, %arg0 : f32
+    tm_tensor.yield %0 : f32
+  }
+  return
+}
+// CHECK-LABEL: func.func @scatter_add_slice_2D
+// CHECK-SAME:    %[[ORIGINAL:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[UPDATES:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
+// CHECK-DAG:     %[[C8:.+]] = arith.constant 8 : index
+// CHECK-DAG:     %[[C20:.+]] = arith.constant 20 : index
+// CHECK:         scf.parallel (%[[I:.+]], %[[J:.+]]) = (%[[C0]], %[[C0]]) to (%[[C2]], %[[C20]]) step (%[[C1]], %[[C8]]) {
+// CHECK:           %[[MASK:.+]] = vector.create_mask %{{.+}} : vector<8xi1>
+// CHECK:           %[[UPDATE:.+]] = vector.maskedload %[[UPDATES]][%[[I]], %[[J]]], %[[MASK]]
+// CHECK:           %[[INDEXVAL:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
+// CHECK:           %[[INDEX:.+]] = arith.index_cast %[[INDEXVAL]] : i32 to index
+// CHECK:           %[[INIT:.+]] = vector.maskedload %[[ORIGINAL]][%[[INDEX]], %[[J]]], %[[MASK]]
+// CHECK:           %[[SUM:.+]] = arith.addf %[[INIT]], %[[UPDATE]] : vector<8xf32>
+// CHECK:           vector.maskedstore %[[ORIGINAL]][%[[INDEX]], %[[J]]], %[[MASK]], %[[SUM]]
+
+// -----
+
+func.func @gather_slice_2D(
+    %source: memref<4x20xf32>, %indices: memref<2x1xi32>,
+    %result: memref<2x20xf32>) {
+  tm_tensor.gather {dimension_map = array<i64: 0>}
+    ins(%source, %indices : memref<4x20xf32>, memref<2x1xi32>)
+    outs(%result : memref<2x20xf32>)
+  return
+}
+// CHECK-LABEL: func.func @gather_slice_2D
+// CHECK-SAME:    %[[SOURCE:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[RESULT:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
+// CHECK-DAG:     %[[C8:.+]] = arith.constant 8 : index
+// CHECK-DAG:     %[[C20:.+]] = arith.constant 20 : index
+// CHECK:         scf.parallel (%[[I:.+]]) = (%[[C0]]) to (%[[C2]]) step (%[[C1]]) {
+// CHECK:           %[[INDEXVAL:.+]] = memref.load %[[INDICES]][%[[I]], %[[C0]]]
+// CHECK:           %[[INDEX:.+]] = arith.index_cast %[[INDEXVAL]] : i32 to index
+// CHECK:           scf.parallel (%[[J:.+]]) = (%[[C0]]) to (%[[C20]]) step (%[[C8]]) {
+// CHECK:             %[[MASK:.+]] = vector.create_mask %{{.+}} : vector<8xi1>
+// CHECK:             %[[ROW:.+]] = vector.maskedload %[[SOURCE]][%[[INDEX]], %[[J]]], %[[MASK]]
+// CHECK:             vector.maskedstore %[[RESULT]][%[[I]], %[[J]]], %[[MASK]], %[[ROW]]
@@ -326,3 +326,115 @@ func.func @scatter_original_rank_mismatch(
     } -> tensor<?x?xi64>
   return %0 : tensor<?x?xi64>
 }
+
+// -----
+
+func.func @attention_mask_mod_yield_type(
+    %q : tensor<2x8x16xf32>, %k : tensor<2x8x16xf32>, %v : tensor<2x8x16xf32>,
+    %out : tensor<2x8x16xf32>) -> tensor<2x8x16xf32> {
+  // expected-error @+1 {{expected mask_mod to yield a single 'i1'}}
+  %0 = tm_tensor.attention
+    ins(%q, %k, %v : tensor<2x8x16xf32>, tensor<2x8x16xf32>, tensor<2x8x16xf32>)
+    outs(%out : tensor<2x8x16xf32>)
+    mask_mod {
+    ^bb0(%b: index, %m: index, %n: index):
+      %1 = arith.index_cast %m : index to i32
+      %2 = arith.sitofp %1 : i32 to f32
+      tm_tensor.yield %2 : f32
+    } -> tensor<2x8x16xf32>
+  return %0 : tensor<2x8x16xf32>
+}
+
+// -----
+
+func.func @attention_score_mod_arguments(
+    %q : tensor<2x8x16xf32>, %k : tensor<2x8x16xf32>, %v : tensor<2x8x16xf32>,
+    %out : tensor<2x8x16xf32>) -> tensor<2x8x16xf32> {
+  // expected-error @+1 {{expected score_mod to take the score and one index per dim of the query}}
+  %0 = tm_tensor.attention
+    ins(%q, %k, %v : tensor<2x8x16xf32>, tensor<2x8x16xf32>, tensor<2x8x16xf32>)
+    outs(%out : tensor<2x8x16xf32>)
+    score_mod {
+    ^bb0(%score: f32, %m: index, %n: index):
+      tm_tensor.yield %score : f32
+    } -> tensor<2x8x16xf32>
+  return %0 : tensor<2x8x16xf32>
+}
+
+// -----
+
+func.func @attention_window_size(
+    %q : tensor<2x8x16xf32>, %k : tensor<2x8x16xf32>, %v : tensor<2x8x16xf32>,
+    %out : tensor<2x8x16xf32>) -> tensor<2x8x16xf32> {
+  // expected-error @+1 {{expected window_size to be positive}}
+  %0 = tm_tensor.attention {causal, window_size = 0 : i64}
+    ins(%q, %k, %v : tensor<2x8x16xf32>, tensor<2x8x16xf32>, tensor<2x8x16xf32>)
+    outs(%out : tensor<2x8x16xf32>) -> tensor<2x8x16xf32>
+  return %0 : tensor<2x8x16xf32>
+}
+
+// -----
+
+func.func @paged_attention_head_groups(
+    %q : tensor<4x8x16xf32>, %kc : tensor<64x16x3x16xf32>,
+    %vc : tensor<64x16x3x16xf32>, %tables : tensor<4x8xi32>,
+    %lens : tensor<4xi32>, %out : tensor<4x8x16xf32>) -> tensor<4x8x16xf32> {
+  // expected-error @+1 {{expected number of key/value heads to divide number of query heads}}
+  %0 = tm_tensor.paged_attention
+    ins(%q, %kc, %vc, %tables, %lens : tensor<4x8x16xf32>, tensor<64x16x3x16xf32>, tensor<64x16x3x16xf32>, tensor<4x8xi32>, tensor<4xi32>)
+    outs(%out : tensor<4x8x16xf32>) -> tensor<4x8x16xf32>
+  return %0 : tensor<4x8x16xf32>
+}
+
+// -----
+
+func.func @gather_unindexed_leading_dim(
+    %source : tensor<4x5x3xf32>, %indices : tensor<2x1xi32>,
+    %init : tensor<2x3xf32>) -> tensor<2x3xf32> {
+  // expected-error @+1 {{source dim#1 is neither indexed nor a slice dim}}
+  %0 = tm_tensor.gather {dimension_map = array<i64: 0>}
+      ins(%source, %indices : tensor<4x5x3xf32>, tensor<2x1xi32>)
+      outs(%init : tensor<2x3xf32>) -> tensor<2x3xf32>
+  return %0 : tensor<2x3xf32>
+}
+
+// -----
+
+func.func @gather_element_type_mismatch(
+    %source : tensor<4x3xf32>, %indices : tensor<2x1xi32>,
+    %init : tensor<2x3xi32>) -> tensor<2x3xi32> {
+  // expected-error @+1 {{mismatch in element type of source f32 and result i32}}
+  %0 = tm_tensor.gather {dimension_map = array<i64: 0>}
+      ins(%source, %indices : tensor<4x3xf32>, tensor<2x1xi32>)
+      outs(%init : tensor<2x3xi32>) -> tensor<2x3xi32>
+  return %0 : tensor<2x3xi32>
+}
+
+// -----
+
+func.func @segment_reduce_ids_shape_mismatch(
+    %data : tensor<6x4xf32>, %segment_ids : tensor<5xi64>,
+    %init : tensor<3x4xf32>) -> tensor<3x4xf32> {
+  // expected-error @+1 {{mismatch in shape of segment ids and data at dim#0}}
+  %0 = tm_tensor.segment_reduce
+      ins(%data, %segment_ids : tensor<6x4xf32>, tensor<5xi64>)
+      outs(%init : tensor<3x4xf32>) {
+    ^bb0(%arg0: f32, %arg1: f32):
+      %1 = arith.addf %arg0, %arg1 : f32
+      tm_tensor.yield %1 : f32
+  } -> tensor<3x4xf32>
+  return %0 : tensor<3x4xf32>
+}
+
+// -----
+
+func.func @unique_inverse_element_type(
+    %input : tensor<8xf32>, %values : tensor<8xf32>, %inverse : tensor<8xf32>,
+    %counts : tensor<8xi64>) -> tensor<8xf32> {
+  // expected-error @+1 {{expected inverse and counts to be of integer element type}}
+  %0:3 = tm_tensor.unique
+      ins(%input : tensor<8xf32>)
+      outs(%values, %inverse, %counts : tensor<8xf32>, tensor<8xf32>, tensor<8xi64>)
+      -> tensor<8xf32>, tensor<8xf32>, tensor<8xi64>
+  return %0#0 : tensor<8xf32>
+}
@@ -0,0 +1,113 @@
+// RUN: torch-mlir-opt -split-input-file -transform-interpreter %s | FileCheck %s
+
+module attributes {transform.with_named_sequence} {
+  func.func @scan(%in: tensor<4x128xi32>, %out: tensor<4x128xi32>, %acc: tensor<4xi32>) -> (tensor<4x128xi32>, tensor<4xi32>) {
+    %0:2 = tm_tensor.scan dimension(1) inclusive(true)
+      ins(%in : tensor<4x128xi32>) outs(%out, %acc : tensor<4x128xi32>, tensor<4xi32>) {
+    ^bb0(%arg0 : i32, %arg1 : i32):
+      %sum = arith.addi %arg0, %arg1 : i32
+      tm_tensor.yield %sum : i32
+    } -> tensor<4x128xi32>, tensor<4xi32>
+    return %0#0, %0#1 : tensor<4x128xi32>, tensor<4xi32>
+  }
+
+  transform.named_sequence @__transform_main(%root: !transform.any_op {transform.readonly}) {
+    %0 = transform.structured.match ops{["tm_tensor.scan"]} in %root : (!transform.any_op) -> !transform.any_op
+    %1, %loop = transform.structured.tile_using_for %0 tile_sizes [2, 0] : (!transform.any_op) -> (!transform.any_op, !transform.any_op)
+    transform.yield
+  }
+}
+// The rows are scanned independently; the scanned dim stays whole.
+// CHECK-LABEL: func.func @scan(
+// CHECK-SAME:    %[[IN:[a-zA-Z0-9]+]]: tensor<4x128xi32>, %[[OUT:[a-zA-Z0-9]+]]: tensor<4x128xi32>, %[[ACC:[a-zA-Z0-9]+]]: tensor<4xi32>
+// CHECK:         scf.for %[[I:.+]] = %{{.+}} to %{{.+}} step %{{.+}} iter_args(%[[OUT_ARG:.+]] = %{{.+}}, %[[ACC_ARG:.+]] = %{{.+}})
+// CHECK-DAG:       %[[IN_TILE:.+]] = tensor.extract_slice %[[IN]][%[[I]], 0] [2, 128] [1, 1]
+// CHECK-DAG:       %[[OUT_TILE:.+]] = tensor.extract_slice %[[OUT]][%[[I]], 0] [2, 128] [1, 1]
+// CHECK-DAG:       %[[ACC_TILE:.+]] = tensor.extract_slice %[[ACC]][%[[I]]] [2] [1]
+// CHECK:           %[[TILED:.+]]:2 = tm_tensor.scan dimension(1) inclusive(true) ins(%[[IN_TILE]] : tensor<2x128xi32>) outs(%[[OUT_TILE]], %[[ACC_TILE]] : tensor<2x128xi32>, tensor<2xi32>)
+// CHECK:           tensor.insert_slice %[[TILED]]#0 into %[[OUT_ARG]][%[[I]], 0] [2, 128] [1, 1]
+// CHECK:           tensor.insert_slice %[[TILED]]#1 into %[[ACC_ARG]][%[[I]]] [2] [1]
+
+// -----
+
+module attributes {transform.with_named_sequence} {
+  func.func @sort(%arg0: tensor<4x128xi32>) -> tensor<4x128xi32> {
+    %0 = tm_tensor.sort dimension(1) outs(%arg0 : tensor<4x128xi32>) {
+    ^bb0(%lhs: i32, %rhs: i32):
+      %1 = arith.cmpi slt, %lhs, %rhs : i32
+      tm_tensor.yield %1 : i1
+    } -> tensor<4x128xi32>
+    return %0 : tensor<4x128xi32>
+  }
+
+  transform.named_sequence @__transform_main(%root: !transform.any_op {transform.readonly}) {
+    %0 = transform.structured.match ops{["tm_tensor.sort"]} in %root : (!transform.any_op) -> !transform.any_op
+    %1, %loop = transform.structured.tile_using_for %0 tile_sizes [2, 0] : (!transform.any_op) -> (!transform.any_op, !transform.any_op)
+    transform.yield
+  }
+}
+// CHECK-LABEL: func.func @sort(
+// CHECK-SAME:    %[[ARG0:[a-zA-Z0-9]+]]: tensor<4x128xi32>
+// CHECK:         scf.for %[[I:.+]] = %{{.+}} to %{{.+}} step %{{.+}} iter_args(%[[ARG:.+]] = %{{.+}})
+// CHECK:           %[[TILE:.+]] = tensor.extract_slice %[[ARG0]][%[[I]], 0] [2, 128] [1, 1]
+// CHECK:           %[[SORTED:.+]] = tm_tensor.sort dimension(1) outs(%[[TILE]] : tensor<2x128xi32>)
+// CHECK:           tensor.insert_slice %[[SORTED]] into %[[ARG]][%[[I]], 0] [2, 128] [1, 1]
+
+// -----
+
+module attributes {transform.with_named_sequence} {
+  func.func @scatter(%original: tensor<8x16xf32>, %indices: tensor<3x1xi32>, %updates: tensor<3x16xf32>) -> tensor<8x16xf32> {
+    %0 = tm_tensor.scatter {dimension_map = array<i64: 0>} unique_indices(true)
+      ins(%updates, %indices : tensor<3x16xf32>, tensor<3x1xi32>)
+      outs(%original : tensor<8x16xf32>) {
+    ^bb0(%update: f32, %orig: f32):
+      %1 = arith.addf %update, %orig : f32
+      tm_tensor.yield %1 : f32
+    } -> tensor<8x16xf32>
+    return %0 : tensor<8x16xf32>
+  }
+
+  transform.named_sequence @__transform_main(%root: !transform.any_op {transform.readonly}) {
+    %0 = transform.structured.match ops{["tm_tensor.scatter"]} in %root : (!transform.any_op) -> !transform.any_op
+    %1, %loop = transform.structured.tile_using_for %0 tile_sizes [0, 4] : (!transform.any_op) -> (!transform.any_op, !transform.any_op)
+    transform.yield
+  }
+}
+// Every update is applied to each tile of the slice dim, and the indexed dim
+// of the original stays whole.
+// CHECK-LABEL: func.func @scatter(
+// CHECK-SAME:    %[[ORIGINAL:[a-zA-Z0-9]+]]: tensor<8x16xf32>, %[[INDICES:[a-zA-Z0-9]+]]: tensor<3x1xi32>, %[[UPDATES:[a-zA-Z0-9]+]]: tensor<3x16xf32>
+// CHECK:         scf.for %[[J:.+]] = %{{.+}} to %{{.+}} step %{{.+}} iter_args(%[[ARG:.+]] = %{{.+}})
+// CHECK-DAG:       %[[UPDATES_TILE:.+]] = tensor.extract_slice %[[UPDATES]][0, %[[J]]] [3, 4] [1, 1]
+// CHECK-DAG:       %[[INDICES_TILE:.+]] = tensor.extract_slice %[[INDICES]][0, 0] [3, 1] [1, 1]
+// CHECK-DAG:       %[[ORIGINAL_TILE:.+]] = tensor.extract_slice %[[ORIGINAL]][0, %[[J]]] [8, 4] [1, 1]
+// CHECK:           %[[TILED:.+]] = tm_tensor.scatter {dimension_map = array<i64: 0>} unique_indices(true) ins(%[[UPDATES_TILE]], %[[INDICES_TILE]] : tensor<3x4xf32>, tensor<3x1xi32>) outs(%[[ORIGINAL_TILE]] : tensor<8x4xf32>)
+// CHECK:           tensor.insert_slice %[[TILED]] into %[[ARG]][0, %[[J]]] [8, 4] [1, 1]
+
+// -----
+
+module attributes {transform.with_named_sequence} {
+  func.func @attention(%q: tensor<2x128x16xf32>, %k: tensor<2x256x16xf32>, %v: tensor<2x256x32xf32>, %out: tensor<2x128x32xf32>) -> tensor<2x128x32xf32> {
+    %0 = tm_tensor.attention {scale = 2.500000e-01 : f64}
+      ins(%q, %k, %v : tensor<2x128x16xf32>, tensor<2x256x16xf32>, tensor<2x256x32xf32>)
+      outs(%out : tensor<2x128x32xf32>) -> tensor<2x128x32xf32>
+    return %0 : tensor<2x128x32xf32>
+  }
+
+  transform.named_sequence @__transform_main(%root: !transform.any_op {transform.readonly}) {
+    %0 = transform.structured.match ops{["tm_tensor.attention"]} in %root : (!transform.any_op) -> !transform.any_op
+    %1, %loops:2 = transform.structured.tile_using_for %0 tile_sizes [1, 32] : (!transform.any_op) -> (!transform.any_op, !transform.any_op, !transform.any_op)
+    transform.yield
+  }
+}
+// Each tile of queries attends to all the keys and values of its batch.
+// CHECK-LABEL: func.func @attention(
+// CHECK-SAME:    %[[Q:[a-zA-Z0-9]+]]: tensor<2x128x16xf32>, %[[K:[a-zA-Z0-9]+]]: tensor<2x256x16xf32>, %[[V:[a-zA-Z0-9]+]]: tensor<2x256x32xf32>, %[[OUT:[a-zA-Z0-9]+]]: tensor<2x128x32xf32>
+// CHECK:         scf.for %[[B:.+]] = %{{.+}} to %{{.+}} step %{{.+}} iter_args(%[[ARG_B:.+]] = %{{.+}})
+// CHECK:           scf.for %[[M:.+]] = %{{.+}} to %{{.+}} step %{{.+}} iter_args(%[[ARG_M:.+]] = %[[ARG_B]])
+// CHECK-DAG:         %[[Q_TILE:.+]] = tensor.extract_slice %[[Q]][%[[B]], %[[M]], 0] [1, 32, 16] [1, 1, 1]
+// CHECK-DAG:         %[[K_TILE:.+]] = tensor.extract_slice %[[K]][%[[B]], 0, 0] [1, 256, 16] [1, 1, 1]
+// CHECK-DAG:         %[[V_TILE:.+]] = tensor.extract_slice %[[V]][%[[B]], 0, 0] [1, 256, 32] [1, 1, 1]
+// CHECK-DAG:         %[[OUT_TILE:.+]] = tensor.extract_slice %[[OUT]][%[[B]], %[[M]], 0] [1, 32, 32] [1, 1, 1]
+// CHECK:             %[[TILED:.+]] = tm_tensor.attention {scale = 2.500000e-01 : f64} ins(%[[Q_TILE]], %[[K_TILE]], %[[V_TILE]] : tensor<1x32x16xf32>, tensor<1x256x16xf32>, tensor<1x256x32xf32>) outs(%[[OUT_TILE]] : tensor<1x32x32xf32>) -> tensor<1x32x32xf32>
+// CHECK:             tensor.insert_slice %[[TILED]] into %[[ARG_M]][%[[B]], %[[M]], 0] [1, 32, 32] [1, 1, 1]
@@ -1,4 +1,9 @@
 // RUN: torch-mlir-opt -torch-globalize-object-graph -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-globalize-object-graph -mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+// STATS: GlobalizeObjectGraph
+// STATS-DAG: (S) 2 num-global-slots
+// STATS-DAG: (S) 3 num-monomorphizations
 
 torch.class_type @__torch__.TestModule  {
   torch.attr private "s1" : !torch.nn.Module<"__torch__.Submodule">
@@ -30,3 +30,66 @@ func.func private @ensure_all_slots_are_used(%arg0: !torch.nn.Module<"child">) {
   %0 = torch.prim.GetAttr %arg0["float"] : !torch.nn.Module<"child"> -> !torch.float
   return
 }
+
+// -----
+
+// Check that the path of a slot only includes its own ancestors, not those
+// of the subtrees visited before it.
+
+// CHECK-DAG:     torch.global_slot @a.float : !torch.float
+// CHECK-DAG:     torch.global_slot @a.inner.x : !torch.float
+// CHECK-DAG:     torch.global_slot @b.x : !torch.float
+// CHECK-DAG:     torch.global_slot @y : !torch.float
+
+torch.class_type @leaf1 {
+  torch.attr "x" : !torch.float
+}
+torch.class_type @leaf2 {
+  torch.attr "x" : !torch.float
+}
+torch.class_type @child {
+  torch.attr "float" : !torch.float
+  torch.attr "inner" : !torch.nn.Module<"leaf1">
+}
+torch.class_type @parent {
+  torch.attr "a" : !torch.nn.Module<"child">
+  torch.attr "b" : !torch.nn.Module<"leaf2">
+  torch.attr "y" : !torch.float
+}
+
+%c1 = torch.constant.float 1.0
+%c2 = torch.constant.float 2.0
+%c3 = torch.constant.float 3.0
+%c4 = torch.constant.float 4.0
+%leaf1 = torch.nn_module {
+  torch.slot "x", %c1 : !torch.float
+} : !torch.nn.Module<"leaf1">
+%leaf2 = torch.nn_module {
+  torch.slot "x", %c2 : !torch.float
+} : !torch.nn.Module<"leaf2">
+%child = torch.nn_module {
+  torch.slot "float", %c3 : !torch.float
+  torch.slot "inner", %leaf1 : !torch.nn.Module<"leaf1">
+} : !torch.nn.Module<"child">
+%parent = torch.nn_module {
+  torch.slot "a", %child : !torch.nn.Module<"child">
+  torch.slot "b", %leaf2 : !torch.nn.Module<"leaf2">
+  torch.slot "y", %c4 : !torch.float
+} : !torch.nn.Module<"parent">
+
+func.func private @use_leaf1(%arg0: !torch.nn.Module<"leaf1">) {
+  %0 = torch.prim.GetAttr %arg0["x"] : !torch.nn.Module<"leaf1"> -> !torch.float
+  return
+}
+func.func private @use_leaf2(%arg0: !torch.nn.Module<"leaf2">) {
+  %0 = torch.prim.GetAttr %arg0["x"] : !torch.nn.Module<"leaf2"> -> !torch.float
+  return
+}
+func.func private @use_child(%arg0: !torch.nn.Module<"child">) {
+  %0 = torch.prim.GetAttr %arg0["float"] : !torch.nn.Module<"child"> -> !torch.float
+  return
+}
+func.func private @use_parent(%arg0: !torch.nn.Module<"parent">) {
+  %0 = torch.prim.GetAttr %arg0["y"] : !torch.nn.Module<"parent"> -> !torch.float
+  return
+}
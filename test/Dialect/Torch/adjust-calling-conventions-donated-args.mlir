@@ -0,0 +1,30 @@
+// RUN: torch-mlir-opt -torch-adjust-calling-conventions="donated-args=0" -split-input-file -verify-diagnostics %s | FileCheck %s
+
+// CHECK-LABEL:   func.func @decode_step(
+// CHECK-SAME:        %{{.*}}: !torch.vtensor<[1,8,64,16],f32> {bufferization.writable = true},
+// CHECK-SAME:        %{{.*}}: !torch.vtensor<[1,8,1,16],f32> {bufferization.writable = false},
+// CHECK-SAME:        %{{.*}}: !torch.int)
+func.func @decode_step(%arg0: !torch.vtensor<[1,8,64,16],f32>, %arg1: !torch.vtensor<[1,8,1,16],f32>, %arg2: !torch.int) -> !torch.vtensor<[1,8,64,16],f32> {
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.aten.add.int %arg2, %int1 : !torch.int, !torch.int -> !torch.int
+  %1 = torch.aten.slice_scatter %arg0, %arg1, %int2, %arg2, %0, %int1 : !torch.vtensor<[1,8,64,16],f32>, !torch.vtensor<[1,8,1,16],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.vtensor<[1,8,64,16],f32>
+  return %1 : !torch.vtensor<[1,8,64,16],f32>
+}
+
+// -----
+
+// Private functions are not called by the caller that donates the buffers.
+
+// CHECK-LABEL:   func.func private @helper(
+// CHECK-NOT:       bufferization.writable
+func.func private @helper(%arg0: !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],f32> {
+  return %arg0 : !torch.vtensor<[4],f32>
+}
+
+// -----
+
+// expected-error @+1 {{donated argument 0 is not a tensor argument}}
+func.func @not_a_tensor(%arg0: !torch.int) -> !torch.int {
+  return %arg0 : !torch.int
+}
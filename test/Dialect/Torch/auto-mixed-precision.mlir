@@ -0,0 +1,41 @@
+// RUN: torch-mlir-opt -torch-auto-mixed-precision -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-auto-mixed-precision="dtype=f16 deny-ops=aten.mm" -split-input-file %s | FileCheck %s --check-prefix=DENY
+
+// CHECK-LABEL: func.func @mm_relu_mm(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[2,2],f32>)
+// CHECK-DAG:     %[[W:.*]] = torch.vtensor.literal(dense<{{.*}}> : tensor<2x2xbf16>) : !torch.vtensor<[2,2],bf16>
+// CHECK-DAG:     %[[X_BF16:.*]] = torch.aten.to.dtype %[[X]], {{.*}} -> !torch.vtensor<[2,2],bf16>
+// CHECK:         %[[MM0:.*]] = torch.aten.mm %[[X_BF16]], %[[W]] : !torch.vtensor<[2,2],bf16>, !torch.vtensor<[2,2],bf16> -> !torch.vtensor<[2,2],bf16>
+// CHECK:         %[[RELU:.*]] = torch.aten.relu %[[MM0]] : !torch.vtensor<[2,2],bf16> -> !torch.vtensor<[2,2],bf16>
+// CHECK:         %[[MM1:.*]] = torch.aten.mm %[[RELU]], %[[W]] : !torch.vtensor<[2,2],bf16>, !torch.vtensor<[2,2],bf16> -> !torch.vtensor<[2,2],bf16>
+// CHECK:         %[[OUT:.*]] = torch.aten.to.dtype %[[MM1]], {{.*}} -> !torch.vtensor<[2,2],f32>
+// CHECK:         %[[SOFTMAX:.*]] = torch.aten._softmax %[[OUT]], {{.*}} -> !torch.vtensor<[2,2],f32>
+// CHECK:         return %[[SOFTMAX]]
+func.func @mm_relu_mm(%arg0: !torch.vtensor<[2,2],f32>) -> !torch.vtensor<[2,2],f32> {
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %0 = torch.vtensor.literal(dense<[[1.0, 2.0], [3.0, 4.0]]> : tensor<2x2xf32>) : !torch.vtensor<[2,2],f32>
+  %1 = torch.aten.mm %arg0, %0 : !torch.vtensor<[2,2],f32>, !torch.vtensor<[2,2],f32> -> !torch.vtensor<[2,2],f32>
+  %2 = torch.aten.relu %1 : !torch.vtensor<[2,2],f32> -> !torch.vtensor<[2,2],f32>
+  %3 = torch.aten.mm %2, %0 : !torch.vtensor<[2,2],f32>, !torch.vtensor<[2,2],f32> -> !torch.vtensor<[2,2],f32>
+  %4 = torch.aten._softmax %3, %int1, %false : !torch.vtensor<[2,2],f32>, !torch.int, !torch.bool -> !torch.vtensor<[2,2],f32>
+  return %4 : !torch.vtensor<[2,2],f32>
+}
+
+// -----
+
+// The add reads an f32 argument, so it stays in f32.
+// CHECK-LABEL: func.func @keep_add_of_f32(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[2,2],f32>, %[[ARG1:.*]]: !torch.vtensor<[2,2],f32>)
+// CHECK:         %[[MM:.*]] = torch.aten.mm {{.*}} -> !torch.vtensor<[2,2],bf16>
+// CHECK:         %[[CAST:.*]] = torch.aten.to.dtype %[[MM]], {{.*}} -> !torch.vtensor<[2,2],f32>
+// CHECK:         torch.aten.add.Tensor %[[CAST]], %[[ARG0]], {{.*}} -> !torch.vtensor<[2,2],f32>
+
+// DENY-LABEL: func.func @keep_add_of_f32(
+// DENY-NOT:     f16
+func.func @keep_add_of_f32(%arg0: !torch.vtensor<[2,2],f32>, %arg1: !torch.vtensor<[2,2],f32>) -> !torch.vtensor<[2,2],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[2,2],f32>, !torch.vtensor<[2,2],f32> -> !torch.vtensor<[2,2],f32>
+  %1 = torch.aten.add.Tensor %0, %arg0, %int1 : !torch.vtensor<[2,2],f32>, !torch.vtensor<[2,2],f32>, !torch.int -> !torch.vtensor<[2,2],f32>
+  return %1 : !torch.vtensor<[2,2],f32>
+}
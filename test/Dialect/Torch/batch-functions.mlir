@@ -0,0 +1,96 @@
+// RUN: torch-mlir-opt -torch-batch-functions -split-input-file -verify-diagnostics %s | FileCheck %s
+// RUN: torch-mlir-opt '-torch-batch-functions{batch-size=4}' -split-input-file -verify-diagnostics %s | FileCheck %s --check-prefix=STATIC
+
+// The weights stay unbatched, and broadcast against the batched activations.
+// CHECK-LABEL: func.func @linear(
+// CHECK-LABEL: func.func @linear$batched(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[?,3,4],f32>) -> !torch.vtensor<[?,3,8],f32> {
+// CHECK:         %[[MM:.*]] = torch.aten.matmul %[[ARG0]], %{{.*}} : !torch.vtensor<[?,3,4],f32>, !torch.vtensor<[4,8],f32> -> !torch.vtensor<[?,3,8],f32>
+// CHECK:         %[[ADD:.*]] = torch.aten.add.Tensor %[[MM]], %{{.*}}, %{{.*}} : !torch.vtensor<[?,3,8],f32>, !torch.vtensor<[8],f32>, !torch.int -> !torch.vtensor<[?,3,8],f32>
+// CHECK:         %[[RELU:.*]] = torch.aten.relu %[[ADD]] : !torch.vtensor<[?,3,8],f32> -> !torch.vtensor<[?,3,8],f32>
+// CHECK:         return %[[RELU]] : !torch.vtensor<[?,3,8],f32>
+// STATIC-LABEL: func.func @linear$batched(
+// STATIC-SAME:      %{{.*}}: !torch.vtensor<[4,3,4],f32>) -> !torch.vtensor<[4,3,8],f32> {
+func.func @linear(%arg0: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[3,8],f32> {
+  %w = torch.vtensor.literal(dense<1.0> : tensor<4x8xf32>) : !torch.vtensor<[4,8],f32>
+  %b = torch.vtensor.literal(dense<1.0> : tensor<8xf32>) : !torch.vtensor<[8],f32>
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.mm %arg0, %w : !torch.vtensor<[3,4],f32>, !torch.vtensor<[4,8],f32> -> !torch.vtensor<[3,8],f32>
+  %1 = torch.aten.add.Tensor %0, %b, %int1 : !torch.vtensor<[3,8],f32>, !torch.vtensor<[8],f32>, !torch.int -> !torch.vtensor<[3,8],f32>
+  %2 = torch.aten.relu %1 : !torch.vtensor<[3,8],f32> -> !torch.vtensor<[3,8],f32>
+  return %2 : !torch.vtensor<[3,8],f32>
+}
+
+// -----
+
+// A batched operand of lower rank than the result gets a unit dim after its
+// batch dim, and a result that does not depend on the arguments is
+// broadcast over the batch.
+// CHECK-LABEL: func.func @broadcast$batched(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[?,4],f32>, %[[ARG1:.*]]: !torch.vtensor<[?,3,4],f32>)
+// CHECK:         %[[SIZE:.*]] = torch.aten.size.int %[[ARG0]], %{{.*}} : !torch.vtensor<[?,4],f32>, !torch.int -> !torch.int
+// CHECK:         %[[LHS:.*]] = torch.aten.unsqueeze %[[ARG0]], %{{.*}} : !torch.vtensor<[?,4],f32>, !torch.int -> !torch.vtensor<[?,1,4],f32>
+// CHECK:         %[[MUL:.*]] = torch.aten.mul.Tensor %[[LHS]], %[[ARG1]] : !torch.vtensor<[?,1,4],f32>, !torch.vtensor<[?,3,4],f32> -> !torch.vtensor<[?,3,4],f32>
+// CHECK:         %[[UNSQUEEZED:.*]] = torch.aten.unsqueeze %{{.*}}, %{{.*}} : !torch.vtensor<[2],f32>, !torch.int -> !torch.vtensor<[1,2],f32>
+// CHECK:         %[[SIZES:.*]] = torch.prim.ListConstruct %[[SIZE]], %{{.*}} : (!torch.int, !torch.int) -> !torch.list<int>
+// CHECK:         %[[CONST:.*]] = torch.aten.expand %[[UNSQUEEZED]], %[[SIZES]], %{{.*}} : !torch.vtensor<[1,2],f32>, !torch.list<int>, !torch.bool -> !torch.vtensor<[?,2],f32>
+// CHECK:         return %[[MUL]], %[[CONST]] : !torch.vtensor<[?,3,4],f32>, !torch.vtensor<[?,2],f32>
+func.func @broadcast(%arg0: !torch.vtensor<[4],f32>, %arg1: !torch.vtensor<[3,4],f32>) -> (!torch.vtensor<[3,4],f32>, !torch.vtensor<[2],f32>) {
+  %c = torch.vtensor.literal(dense<1.0> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %0 = torch.aten.mul.Tensor %arg0, %arg1 : !torch.vtensor<[4],f32>, !torch.vtensor<[3,4],f32> -> !torch.vtensor<[3,4],f32>
+  return %0, %c : !torch.vtensor<[3,4],f32>, !torch.vtensor<[2],f32>
+}
+
+// -----
+
+// The batch dim is folded into the batch dim of a convolution.
+// STATIC-LABEL: func.func @conv$batched(
+// STATIC-SAME:      %[[ARG0:.*]]: !torch.vtensor<[4,1,3,8,8],f32>) -> !torch.vtensor<[4,1,2,6,6],f32> {
+// STATIC:         %[[FOLDED:.*]] = torch.aten.flatten.using_ints %[[ARG0]], %{{.*}}, %{{.*}} : !torch.vtensor<[4,1,3,8,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[4,3,8,8],f32>
+// STATIC:         %[[CONV:.*]] = torch.aten.conv2d %[[FOLDED]], {{.*}} -> !torch.vtensor<[4,2,6,6],f32>
+// STATIC:         %[[SIZES:.*]] = torch.prim.ListConstruct %{{.*}}, %{{.*}} : (!torch.int, !torch.int) -> !torch.list<int>
+// STATIC:         %[[RESULT:.*]] = torch.aten.unflatten.int %[[CONV]], %{{.*}}, %[[SIZES]] : !torch.vtensor<[4,2,6,6],f32>, !torch.int, !torch.list<int> -> !torch.vtensor<[4,1,2,6,6],f32>
+// STATIC:         return %[[RESULT]]
+func.func @conv(%arg0: !torch.vtensor<[1,3,8,8],f32>) -> !torch.vtensor<[1,2,6,6],f32> {
+  %w = torch.vtensor.literal(dense<1.0> : tensor<2x3x3x3xf32>) : !torch.vtensor<[2,3,3,3],f32>
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %ones = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %zeros = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.conv2d %arg0, %w, %none, %ones, %zeros, %ones, %int1 : !torch.vtensor<[1,3,8,8],f32>, !torch.vtensor<[2,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int -> !torch.vtensor<[1,2,6,6],f32>
+  return %0 : !torch.vtensor<[1,2,6,6],f32>
+}
+
+// -----
+
+// Non-negative dims are shifted past the batch dim, and a full reduction
+// keeps the batch dim.
+// CHECK-LABEL: func.func @reductions$batched(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[?,3,4],f32>)
+// CHECK:         %[[INT2:.*]] = torch.constant.int 2
+// CHECK:         %[[DIMS:.*]] = torch.prim.ListConstruct %[[INT2]] : (!torch.int) -> !torch.list<int>
+// CHECK:         %[[SUM:.*]] = torch.aten.sum.dim_IntList %[[ARG0]], %[[DIMS]], %{{.*}}, %{{.*}} : !torch.vtensor<[?,3,4],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[?,3],f32>
+// CHECK:         %[[SOFTMAX:.*]] = torch.aten.softmax.int %[[ARG0]], %{{.*}}, %{{.*}} : !torch.vtensor<[?,3,4],f32>, !torch.int, !torch.none -> !torch.vtensor<[?,3,4],f32>
+// CHECK:         %[[ALL:.*]] = torch.prim.ListConstruct %{{.*}}, %{{.*}} : (!torch.int, !torch.int) -> !torch.list<int>
+// CHECK:         %[[TOTAL:.*]] = torch.aten.sum.dim_IntList %[[SOFTMAX]], %[[ALL]], %{{.*}}, %{{.*}} : !torch.vtensor<[?,3,4],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[?],f32>
+// CHECK:         return %[[SUM]], %[[TOTAL]]
+func.func @reductions(%arg0: !torch.vtensor<[3,4],f32>) -> (!torch.vtensor<[3],f32>, !torch.vtensor<[],f32>) {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %int1 = torch.constant.int 1
+  %int-1 = torch.constant.int -1
+  %dims = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %0 = torch.aten.sum.dim_IntList %arg0, %dims, %false, %none : !torch.vtensor<[3,4],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[3],f32>
+  %1 = torch.aten.softmax.int %arg0, %int-1, %none : !torch.vtensor<[3,4],f32>, !torch.int, !torch.none -> !torch.vtensor<[3,4],f32>
+  %2 = torch.aten.sum %1, %none : !torch.vtensor<[3,4],f32>, !torch.none -> !torch.vtensor<[],f32>
+  return %0, %2 : !torch.vtensor<[3],f32>, !torch.vtensor<[],f32>
+}
+
+// -----
+
+func.func @no_rule(%arg0: !torch.vtensor<[],f32>) -> !torch.float {
+  // expected-error @+1 {{no batching rule for this op}}
+  %0 = torch.aten.item %arg0 : !torch.vtensor<[],f32> -> !torch.float
+  return %0 : !torch.float
+}
@@ -0,0 +1,42 @@
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(func.func(canonicalize))' | FileCheck %s
+
+// The functions are canonicalized on several threads, which each build their
+// own memo of list types and i64 attributes. The folded constants and lists
+// of every function must still be the same as the types and attributes
+// uniqued by the context.
+
+// CHECK-LABEL:   func.func @a(
+// CHECK-DAG:       %[[INT2:.*]] = torch.constant.int 2
+// CHECK-DAG:       %[[INT3:.*]] = torch.constant.int 3
+// CHECK:           %[[LIST:.*]] = torch.prim.ListConstruct %[[INT3]], %[[INT2]] : (!torch.int, !torch.int) -> !torch.list<int>
+// CHECK:           return %[[INT3]], %[[INT2]], %[[LIST]] : !torch.int, !torch.int, !torch.list<int>
+func.func @a(%arg0: !torch.vtensor<[2,3],f32>) -> (!torch.int, !torch.int, !torch.list<int>) {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.size.int %arg0, %int1 : !torch.vtensor<[2,3],f32>, !torch.int -> !torch.int
+  %1 = torch.aten.dim %arg0 : !torch.vtensor<[2,3],f32> -> !torch.int
+  %2 = torch.prim.ListConstruct %0, %1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.aten.len.t %2 : !torch.list<int> -> !torch.int
+  return %0, %3, %2 : !torch.int, !torch.int, !torch.list<int>
+}
+
+// CHECK-LABEL:   func.func @b(
+// CHECK-DAG:       %[[INT2:.*]] = torch.constant.int 2
+// CHECK-DAG:       %[[INT3:.*]] = torch.constant.int 3
+// CHECK:           %[[LIST:.*]] = torch.prim.ListConstruct %[[INT3]], %[[INT2]] : (!torch.int, !torch.int) -> !torch.list<int>
+// CHECK:           return %[[INT3]], %[[INT2]], %[[LIST]] : !torch.int, !torch.int, !torch.list<int>
+func.func @b(%arg0: !torch.vtensor<[2,3],f32>) -> (!torch.int, !torch.int, !torch.list<int>) {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.size.int %arg0, %int1 : !torch.vtensor<[2,3],f32>, !torch.int -> !torch.int
+  %1 = torch.aten.dim %arg0 : !torch.vtensor<[2,3],f32> -> !torch.int
+  %2 = torch.prim.ListConstruct %0, %1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.aten.len.t %2 : !torch.list<int> -> !torch.int
+  return %0, %3, %2 : !torch.int, !torch.int, !torch.list<int>
+}
+
+// CHECK-LABEL:   func.func @c(
+// CHECK:           %[[LIST:.*]] = torch.prim.ListConstruct %arg0, %arg0 : (!torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>) -> !torch.list<vtensor<[2,3],f32>>
+// CHECK:           return %[[LIST]] : !torch.list<vtensor<[2,3],f32>>
+func.func @c(%arg0: !torch.vtensor<[2,3],f32>) -> !torch.list<vtensor<[2,3],f32>> {
+  %0 = torch.prim.ListConstruct %arg0, %arg0 : (!torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>) -> !torch.list<vtensor<[2,3],f32>>
+  return %0 : !torch.list<vtensor<[2,3],f32>>
+}
@@ -0,0 +1,19 @@
+// RUN: torch-mlir-opt -torch-decompose-complex-ops="dry-run=true" -split-input-file -verify-diagnostics %s | FileCheck %s
+
+// CHECK-LABEL: func.func @absolute
+// CHECK: torch.aten.absolute
+// expected-remark @+2 {{decomposition dry run: 1 match attempts on 2 ops}}
+// expected-note @+1 {{DecomposeAtenAbsoluteOp: 1 attempts, 1 successes}}
+func.func @absolute(%arg0: !torch.vtensor<[3],f32>) -> !torch.vtensor<[3],f32> {
+  %0 = torch.aten.absolute %arg0 : !torch.vtensor<[3],f32> -> !torch.vtensor<[3],f32>
+  return %0 : !torch.vtensor<[3],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @no_decompositions
+// expected-remark @+1 {{decomposition dry run: 0 match attempts on 2 ops}}
+func.func @no_decompositions(%arg0: !torch.vtensor<[3],f32>) -> !torch.vtensor<[3],f32> {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[3],f32> -> !torch.vtensor<[3],f32>
+  return %0 : !torch.vtensor<[3],f32>
+}
@@ -160,6 +160,27 @@ func.func @test_einsum_inner_prod(%arg0: !torch.vtensor<[5],f64>, %arg1: !torch.
 
 // -----
 
+// Contracting `jk,kl` first takes 100x fewer multiply-adds than `ij,jk`.
+// CHECK-LABEL: test_einsum_contraction_order
+// CHECK-SAME:    %[[A:.*]]: !torch.vtensor<[100,100],f32>, %[[B:.*]]: !torch.vtensor<[100,100],f32>, %[[C:.*]]: !torch.vtensor<[100,2],f32>
+// CHECK:  %[[B_PERM:.+]] = torch.aten.permute %[[B]]
+// CHECK:  %[[C_PERM:.+]] = torch.aten.permute %[[C]]
+// CHECK:  %[[BC:.+]] = torch.aten.mm %[[B_PERM]], %[[C_PERM]] : !torch.vtensor<[100,100],f32>, !torch.vtensor<[100,2],f32> -> !torch.vtensor<[100,2],f32>
+// CHECK:  %[[A_PERM:.+]] = torch.aten.permute %[[A]]
+// CHECK:  %[[BC_PERM:.+]] = torch.aten.permute %[[BC]]
+// CHECK:  %[[ABC:.+]] = torch.aten.mm %[[A_PERM]], %[[BC_PERM]] : !torch.vtensor<[100,100],f32>, !torch.vtensor<[100,2],f32> -> !torch.vtensor<[100,2],f32>
+// CHECK:  %[[OUT:.+]] = torch.aten.permute %[[ABC]]
+// CHECK:  return %[[OUT]]
+func.func @test_einsum_contraction_order(%arg0: !torch.vtensor<[100,100],f32>, %arg1: !torch.vtensor<[100,100],f32>, %arg2: !torch.vtensor<[100,2],f32>) -> !torch.vtensor<[100,2],f32> {
+  %0 = torch.prim.ListConstruct %arg0, %arg1, %arg2 : (!torch.vtensor<[100,100],f32>, !torch.vtensor<[100,100],f32>, !torch.vtensor<[100,2],f32>) -> !torch.list<vtensor>
+  %str = torch.constant.str "ij,jk,kl->il"
+  %none = torch.constant.none
+  %1 = torch.aten.einsum %str, %0, %none : !torch.str, !torch.list<vtensor>, !torch.none -> !torch.vtensor<[100,2],f32>
+  return %1 : !torch.vtensor<[100,2],f32>
+}
+
+// -----
+
 // CHECK-LABEL: test_aten_bilinear_decompose
 func.func @test_aten_bilinear_decompose(%arg0: !torch.vtensor<[6,2],f32>, %arg1: !torch.vtensor<[6,3],f32>, %arg2: !torch.vtensor<[4,2,3],f32>, %arg3: !torch.vtensor<[4],f32>) -> !torch.vtensor<[6,4],f32> {
   // CHECK-DAG:  %[[NONE:.+]] = torch.constant.none
@@ -1256,3 +1277,44 @@ func.func @torch.aten.diag_2d(%arg0: !torch.vtensor<[3,4],f32>) -> !torch.vtenso
   %0 = torch.aten.diag %arg0, %int0 : !torch.vtensor<[3,4],f32>, !torch.int -> !torch.vtensor<[3],f32>
   return %0 : !torch.vtensor<[3],f32>
 }
+
+// -----
+
+// CHECK-LABEL: func.func @torch.aten.var.correction
+// CHECK-SAME:    %[[ARG:.*]]: !torch.vtensor<[4,8],f32>
+// CHECK:         %[[X:.*]] = torch.aten.to.dtype %[[ARG]]
+// CHECK-NOT:     torch.aten.mean.dim
+// CHECK:         %[[SUM:.*]] = torch.aten.sum.dim_IntList %[[X]]
+// CHECK:         %[[SQUARE:.*]] = torch.aten.square %[[X]]
+// CHECK:         %[[SUMSQ:.*]] = torch.aten.sum.dim_IntList %[[SQUARE]]
+// CHECK:         torch.aten.square %[[SUM]]
+// CHECK:         torch.aten.clamp_min
+// CHECK-NOT:     torch.aten.mean.dim
+func.func @torch.aten.var.correction(%arg0: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4],f32> {
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %0 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %1 = torch.aten.var.correction %arg0, %0, %int1, %false : !torch.vtensor<[4,8],f32>, !torch.list<int>, !torch.int, !torch.bool -> !torch.vtensor<[4],f32>
+  return %1 : !torch.vtensor<[4],f32>
+}
+
+// -----
+
+// The indices keep the kind and sizes of the input, whatever they are, and
+// inputs of the same type get the same indices type.
+// CHECK-LABEL:   func.func @argsort
+// CHECK:           %{{.+}}, %[[IDX0:.+]] = torch.aten.sort %arg0, {{.+}} : !torch.vtensor<[3,4],f32>, !torch.int, !torch.bool -> !torch.vtensor<[3,4],f32>, !torch.vtensor<[3,4],si64>
+// CHECK:           %{{.+}}, %[[IDX1:.+]] = torch.aten.sort %arg0, {{.+}} : !torch.vtensor<[3,4],f32>, !torch.int, !torch.bool -> !torch.vtensor<[3,4],f32>, !torch.vtensor<[3,4],si64>
+// CHECK:           %{{.+}}, %[[IDX2:.+]] = torch.aten.sort %arg1, {{.+}} : !torch.vtensor<*,f32>, !torch.int, !torch.bool -> !torch.vtensor<*,f32>, !torch.vtensor<*,si64>
+// CHECK:           %{{.+}}, %[[IDX3:.+]] = torch.aten.sort %arg2, {{.+}} : !torch.tensor<[?,4],f32>, !torch.int, !torch.bool -> !torch.tensor<[?,4],f32>, !torch.tensor<[?,4],si64>
+// CHECK:           return %[[IDX0]], %[[IDX1]], %[[IDX2]], %[[IDX3]]
+func.func @argsort(%arg0: !torch.vtensor<[3,4],f32>, %arg1: !torch.vtensor<*,f32>, %arg2: !torch.tensor<[?,4],f32>) -> (!torch.vtensor<[3,4],si64>, !torch.vtensor<[3,4],si64>, !torch.vtensor<*,si64>, !torch.tensor<[?,4],si64>) {
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %true = torch.constant.bool true
+  %0 = torch.aten.argsort %arg0, %int1, %false : !torch.vtensor<[3,4],f32>, !torch.int, !torch.bool -> !torch.vtensor<[3,4],si64>
+  %1 = torch.aten.argsort %arg0, %int1, %true : !torch.vtensor<[3,4],f32>, !torch.int, !torch.bool -> !torch.vtensor<[3,4],si64>
+  %2 = torch.aten.argsort %arg1, %int1, %false : !torch.vtensor<*,f32>, !torch.int, !torch.bool -> !torch.vtensor<*,si64>
+  %3 = torch.aten.argsort %arg2, %int1, %false : !torch.tensor<[?,4],f32>, !torch.int, !torch.bool -> !torch.tensor<[?,4],si64>
+  return %0, %1, %2, %3 : !torch.vtensor<[3,4],si64>, !torch.vtensor<[3,4],si64>, !torch.vtensor<*,si64>, !torch.tensor<[?,4],si64>
+}
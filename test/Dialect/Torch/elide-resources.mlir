@@ -0,0 +1,27 @@
+// RUN: torch-mlir-opt %s --mlir-elide-resource-strings-if-larger=64 --mlir-elide-elementsattrs-if-larger=16 | torch-mlir-opt | FileCheck %s
+
+// The view copy that docs/development.md suggests for large modules drops the
+// weight payloads and still parses, with all of its ops. Splats are kept, so
+// the dense literal below holds distinct values.
+
+// CHECK-LABEL: func.func @weights
+// CHECK:         %[[RESOURCE:.*]] = torch.vtensor.literal(dense_resource<weight> : tensor<4x8xf32>) : !torch.vtensor<[4,8],f32>
+// CHECK:         %[[DENSE:.*]] = torch.vtensor.literal(dense_resource<__elided__> : tensor<4x8xf32>) : !torch.vtensor<[4,8],f32>
+// CHECK:         %[[SUM:.*]] = torch.aten.add.Tensor %[[RESOURCE]], %[[DENSE]], %{{.*}}
+// CHECK:         return %[[SUM]]
+// CHECK-NOT:   0x04000000
+func.func @weights() -> !torch.vtensor<[4,8],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.vtensor.literal(dense_resource<weight> : tensor<4x8xf32>) : !torch.vtensor<[4,8],f32>
+  %1 = torch.vtensor.literal(dense<[[0.000000e+00, 1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00, 5.000000e+00, 6.000000e+00, 7.000000e+00], [8.000000e+00, 9.000000e+00, 1.000000e+01, 1.100000e+01, 1.200000e+01, 1.300000e+01, 1.400000e+01, 1.500000e+01], [1.600000e+01, 1.700000e+01, 1.800000e+01, 1.900000e+01, 2.000000e+01, 2.100000e+01, 2.200000e+01, 2.300000e+01], [2.400000e+01, 2.500000e+01, 2.600000e+01, 2.700000e+01, 2.800000e+01, 2.900000e+01, 3.000000e+01, 3.100000e+01]]> : tensor<4x8xf32>) : !torch.vtensor<[4,8],f32>
+  %2 = torch.aten.add.Tensor %0, %1, %int1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[4,8],f32>, !torch.int -> !torch.vtensor<[4,8],f32>
+  return %2 : !torch.vtensor<[4,8],f32>
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      weight: "0x040000000000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F0000803F"
+    }
+  }
+#-}
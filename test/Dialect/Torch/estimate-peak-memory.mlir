@@ -0,0 +1,52 @@
+// RUN: torch-mlir-opt -torch-estimate-peak-memory %s -o /dev/null | FileCheck %s
+
+// CHECK:      "functions": {
+// CHECK-NEXT:   "dynamic": {
+// CHECK-NEXT:     "activations": 0,
+// CHECK-NEXT:     "live_at_peak": [],
+// CHECK-NEXT:     "peak_bytes": 0,
+// CHECK:          "temporaries": 0,
+// CHECK-NEXT:     "unknown_sizes": 2,
+// CHECK-NEXT:     "weights": 0
+func.func @dynamic(%arg0: !torch.vtensor<[?],f32>) -> !torch.vtensor<[?],f32> {
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  return %0 : !torch.vtensor<[?],f32>
+}
+
+// The transpose aliases %1, which stays live until the second matmul, where
+// the weight, %0, %1 and the result are all live. The argument is dead by
+// then.
+// CHECK:        "forward": {
+// CHECK-NEXT:     "activations": 64,
+// CHECK-NEXT:     "live_at_peak": [
+// CHECK-NEXT:       {
+// CHECK-NEXT:         "bytes": 64,
+// CHECK-NEXT:         "kind": "weights",
+// CHECK-NEXT:         "loc": "{{.*}}",
+// CHECK-NEXT:         "op": "torch.vtensor.literal"
+// CHECK:              "kind": "temporaries",
+// CHECK-NEXT:         "loc": "{{.*}}",
+// CHECK-NEXT:         "op": "torch.aten.mm"
+// CHECK:              "kind": "temporaries",
+// CHECK-NEXT:         "loc": "{{.*}}",
+// CHECK-NEXT:         "op": "torch.aten.relu"
+// CHECK:              "kind": "activations",
+// CHECK-NEXT:         "loc": "{{.*}}",
+// CHECK-NEXT:         "op": "torch.aten.mm"
+// CHECK:          ],
+// CHECK-NEXT:     "peak_bytes": 256,
+// CHECK-NEXT:     "peak_op": {
+// CHECK-NEXT:       "loc": "{{.*}}",
+// CHECK-NEXT:       "op": "torch.aten.mm"
+// CHECK-NEXT:     },
+// CHECK-NEXT:     "temporaries": 128,
+// CHECK-NEXT:     "unknown_sizes": 0,
+// CHECK-NEXT:     "weights": 64
+func.func @forward(%arg0: !torch.vtensor<[4,4],f32>) -> !torch.vtensor<[4,4],f32> {
+  %weight = torch.vtensor.literal(dense<1.0> : tensor<4x4xf32>) : !torch.vtensor<[4,4],f32>
+  %0 = torch.aten.mm %arg0, %weight : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %1 = torch.aten.relu %0 : !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %2 = torch.aten.t %1 : !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %3 = torch.aten.mm %2, %0 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  return %3 : !torch.vtensor<[4,4],f32>
+}
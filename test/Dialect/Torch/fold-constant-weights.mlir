@@ -0,0 +1,69 @@
+// RUN: torch-mlir-opt -torch-fold-constant-weights -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-fold-constant-weights="max-elements=2 max-matmul-macs=4" -split-input-file %s | FileCheck %s --check-prefix=LIMIT
+
+// CHECK-LABEL: func.func @add_weights(
+// CHECK:         %[[WEIGHT:.*]] = torch.vtensor.literal(dense<[3, 3, 15, 8]> : tensor<4xsi64>) : !torch.vtensor<[4],si64>
+// CHECK-NOT:     torch.aten.add.Tensor
+// CHECK:         return %[[WEIGHT]]
+func.func @add_weights() -> !torch.vtensor<[4],si64> {
+  %0 = torch.vtensor.literal(dense<[1, 2, 3, 4]> : tensor<4xsi64>) : !torch.vtensor<[4],si64>
+  %1 = torch.vtensor.literal(dense<[1, -1, 9, 0]> : tensor<4xsi64>) : !torch.vtensor<[4],si64>
+  %int2 = torch.constant.int 2
+  %2 = torch.aten.add.Tensor %1, %0, %int2 : !torch.vtensor<[4],si64>, !torch.vtensor<[4],si64>, !torch.int -> !torch.vtensor<[4],si64>
+  return %2 : !torch.vtensor<[4],si64>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @mul_by_splat(
+// CHECK:         %[[WEIGHT:.*]] = torch.vtensor.literal(dense<[2.000000e+00, -1.000000e+00, 5.000000e-01]> : tensor<3xf32>) : !torch.vtensor<[3],f32>
+// CHECK:         return %[[WEIGHT]]
+func.func @mul_by_splat() -> !torch.vtensor<[3],f32> {
+  %0 = torch.vtensor.literal(dense<[4.0, -2.0, 1.0]> : tensor<3xf32>) : !torch.vtensor<[3],f32>
+  %1 = torch.vtensor.literal(dense<0.5> : tensor<3xf32>) : !torch.vtensor<[3],f32>
+  %2 = torch.aten.mul.Tensor %0, %1 : !torch.vtensor<[3],f32>, !torch.vtensor<[3],f32> -> !torch.vtensor<[3],f32>
+  return %2 : !torch.vtensor<[3],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @cast_to_int(
+// CHECK:         %[[WEIGHT:.*]] = torch.vtensor.literal(dense<[1, -2, 3]> : tensor<3xsi32>) : !torch.vtensor<[3],si32>
+// CHECK:         return %[[WEIGHT]]
+func.func @cast_to_int() -> !torch.vtensor<[3],si32> {
+  %0 = torch.vtensor.literal(dense<[1.5, -2.5, 3.0]> : tensor<3xf32>) : !torch.vtensor<[3],f32>
+  %int3 = torch.constant.int 3
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %1 = torch.aten.to.dtype %0, %int3, %false, %false, %none : !torch.vtensor<[3],f32>, !torch.int, !torch.bool, !torch.bool, !torch.none -> !torch.vtensor<[3],si32>
+  return %1 : !torch.vtensor<[3],si32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @mm_weights(
+// CHECK:         %[[WEIGHT:.*]] = torch.vtensor.literal(dense<{{\[}}[19, 22], [43, 50]]> : tensor<2x2xsi64>) : !torch.vtensor<[2,2],si64>
+// CHECK:         return %[[WEIGHT]]
+// LIMIT-LABEL: func.func @mm_weights(
+// LIMIT:         torch.aten.mm
+func.func @mm_weights() -> !torch.vtensor<[2,2],si64> {
+  %0 = torch.vtensor.literal(dense<[[1, 2], [3, 4]]> : tensor<2x2xsi64>) : !torch.vtensor<[2,2],si64>
+  %1 = torch.vtensor.literal(dense<[[5, 6], [7, 8]]> : tensor<2x2xsi64>) : !torch.vtensor<[2,2],si64>
+  %2 = torch.aten.mm %0, %1 : !torch.vtensor<[2,2],si64>, !torch.vtensor<[2,2],si64> -> !torch.vtensor<[2,2],si64>
+  return %2 : !torch.vtensor<[2,2],si64>
+}
+
+// -----
+
+// The weight is also returned, so folding the negation adds a weight, which
+// LIMIT does not allow for 3 elements.
+// CHECK-LABEL: func.func @neg_shared_weight(
+// CHECK:         torch.vtensor.literal(dense<[-1.000000e+00, -2.000000e+00, -3.000000e+00]> : tensor<3xf32>)
+// CHECK-NOT:     torch.aten.neg
+// LIMIT-LABEL: func.func @neg_shared_weight(
+// LIMIT:         torch.aten.neg
+func.func @neg_shared_weight() -> (!torch.vtensor<[3],f32>, !torch.vtensor<[3],f32>) {
+  %0 = torch.vtensor.literal(dense<[1.0, 2.0, 3.0]> : tensor<3xf32>) : !torch.vtensor<[3],f32>
+  %1 = torch.aten.neg %0 : !torch.vtensor<[3],f32> -> !torch.vtensor<[3],f32>
+  return %1, %0 : !torch.vtensor<[3],f32>, !torch.vtensor<[3],f32>
+}
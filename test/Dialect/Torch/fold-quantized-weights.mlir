@@ -0,0 +1,89 @@
+// RUN: torch-mlir-opt -torch-fold-quantized-weights -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @quantize_per_tensor(
+// CHECK:         %[[WEIGHT:.*]] = torch.vtensor.literal(dense<[2, -1, 5, 127]> : tensor<4xsi8>) : !torch.vtensor<[4],si8>
+// CHECK:         %[[QUANT:.*]] = torch.aten._make_per_tensor_quantized_tensor %[[WEIGHT]]
+// CHECK-NOT:     torch.aten.quantize_per_tensor
+// CHECK:         return %[[QUANT]]
+func.func @quantize_per_tensor() -> !torch.vtensor<[4],!torch.qint8> {
+  %weight = torch.vtensor.literal(dense<[0.5, -1.0, 2.0, 300.0]> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+  %scale = torch.constant.float 5.000000e-01
+  %zp = torch.constant.int 1
+  %dtype = torch.constant.int 12
+  %0 = torch.aten.quantize_per_tensor %weight, %scale, %zp, %dtype : !torch.vtensor<[4],f32>, !torch.float, !torch.int, !torch.int -> !torch.vtensor<[4],!torch.qint8>
+  return %0 : !torch.vtensor<[4],!torch.qint8>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @int_repr_of_quantize(
+// CHECK:         %[[WEIGHT:.*]] = torch.vtensor.literal(dense<[2, -1, 5, 127]> : tensor<4xsi8>) : !torch.vtensor<[4],si8>
+// CHECK:         return %[[WEIGHT]]
+func.func @int_repr_of_quantize() -> !torch.vtensor<[4],si8> {
+  %weight = torch.vtensor.literal(dense<[0.5, -1.0, 2.0, 300.0]> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+  %scale = torch.constant.float 5.000000e-01
+  %zp = torch.constant.int 1
+  %dtype = torch.constant.int 12
+  %0 = torch.aten.quantize_per_tensor %weight, %scale, %zp, %dtype : !torch.vtensor<[4],f32>, !torch.float, !torch.int, !torch.int -> !torch.vtensor<[4],!torch.qint8>
+  %1 = torch.aten.int_repr %0 : !torch.vtensor<[4],!torch.qint8> -> !torch.vtensor<[4],si8>
+  return %1 : !torch.vtensor<[4],si8>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @quantize_per_channel(
+// CHECK:         %[[WEIGHT:.*]] = torch.vtensor.literal(dense<{{\[}}[1, 2], [12, 12]]> : tensor<2x2xui8>) : !torch.vtensor<[2,2],ui8>
+// CHECK:         %[[QUANT:.*]] = torch.aten._make_per_channel_quantized_tensor %[[WEIGHT]]
+// CHECK-NOT:     torch.aten.quantize_per_channel
+// CHECK:         return %[[QUANT]]
+func.func @quantize_per_channel() -> !torch.vtensor<[2,2],!torch.quint8> {
+  %weight = torch.vtensor.literal(dense<[[1.0, 2.0], [3.0, 4.0]]> : tensor<2x2xf32>) : !torch.vtensor<[2,2],f32>
+  %scales = torch.vtensor.literal(dense<[1.0, 2.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %zps = torch.vtensor.literal(dense<[0, 10]> : tensor<2xsi64>) : !torch.vtensor<[2],si64>
+  %axis = torch.constant.int 0
+  %dtype = torch.constant.int 13
+  %0 = torch.aten.quantize_per_channel %weight, %scales, %zps, %axis, %dtype : !torch.vtensor<[2,2],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],si64>, !torch.int, !torch.int -> !torch.vtensor<[2,2],!torch.quint8>
+  return %0 : !torch.vtensor<[2,2],!torch.quint8>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @transpose(
+// CHECK:         %[[WEIGHT:.*]] = torch.vtensor.literal(dense<{{\[}}[1, 4], [2, 5], [3, 6]]> : tensor<3x2xsi64>) : !torch.vtensor<[3,2],si64>
+// CHECK-NOT:     torch.aten.transpose.int
+// CHECK:         return %[[WEIGHT]]
+func.func @transpose() -> !torch.vtensor<[3,2],si64> {
+  %weight = torch.vtensor.literal(dense<[[1, 2, 3], [4, 5, 6]]> : tensor<2x3xsi64>) : !torch.vtensor<[2,3],si64>
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.transpose.int %weight, %int0, %int1 : !torch.vtensor<[2,3],si64>, !torch.int, !torch.int -> !torch.vtensor<[3,2],si64>
+  return %0 : !torch.vtensor<[3,2],si64>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @reshape(
+// CHECK:         %[[WEIGHT:.*]] = torch.vtensor.literal(dense<[1, 2, 3, 4, 5, 6]> : tensor<6xsi64>) : !torch.vtensor<[6],si64>
+// CHECK-NOT:     torch.aten.reshape
+// CHECK:         return %[[WEIGHT]]
+func.func @reshape() -> !torch.vtensor<[6],si64> {
+  %weight = torch.vtensor.literal(dense<[[1, 2, 3], [4, 5, 6]]> : tensor<2x3xsi64>) : !torch.vtensor<[2,3],si64>
+  %int6 = torch.constant.int 6
+  %0 = torch.prim.ListConstruct %int6 : (!torch.int) -> !torch.list<int>
+  %1 = torch.aten.reshape %weight, %0 : !torch.vtensor<[2,3],si64>, !torch.list<int> -> !torch.vtensor<[6],si64>
+  return %1 : !torch.vtensor<[6],si64>
+}
+
+// -----
+
+// The weight has another user, so it is not quantized.
+// CHECK-LABEL: func.func @quantize_shared_weight(
+// CHECK:         torch.aten.quantize_per_tensor
+func.func @quantize_shared_weight() -> (!torch.vtensor<[4],!torch.qint8>, !torch.vtensor<[4],f32>) {
+  %weight = torch.vtensor.literal(dense<[0.5, -1.0, 2.0, 300.0]> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+  %scale = torch.constant.float 5.000000e-01
+  %zp = torch.constant.int 1
+  %dtype = torch.constant.int 12
+  %0 = torch.aten.quantize_per_tensor %weight, %scale, %zp, %dtype : !torch.vtensor<[4],f32>, !torch.float, !torch.int, !torch.int -> !torch.vtensor<[4],!torch.qint8>
+  return %0, %weight : !torch.vtensor<[4],!torch.qint8>, !torch.vtensor<[4],f32>
+}
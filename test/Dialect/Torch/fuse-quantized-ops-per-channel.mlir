@@ -0,0 +1,76 @@
+// RUN: torch-mlir-opt %s --split-input-file --torch-fuse-quantized-ops="per-channel=true" | FileCheck %s
+
+// CHECK-LABEL: @convolution_per_channel_bias
+func.func @convolution_per_channel_bias(%arg0: !torch.vtensor<[1,3,8,8],si8>, %arg1: !torch.vtensor<[4,3,2,2],si8>, %arg2: !torch.vtensor<[4],f32>, %arg3: !torch.vtensor<[4],f32>) -> !torch.vtensor<[1,4,7,7],f32> {
+  %scale = torch.constant.float 0.5
+  %false = torch.constant.bool false
+  %zero = torch.constant.int 0
+  %one = torch.constant.int 1
+  %zps = torch.vtensor.literal(dense<0> : tensor<4xsi8>) : !torch.vtensor<[4],si8>
+  %6 = torch.aten._make_per_tensor_quantized_tensor %arg0, %scale, %one : !torch.vtensor<[1,3,8,8],si8>, !torch.float, !torch.int -> !torch.vtensor<[1,3,8,8],!torch.qint8>
+  %7 = torch.aten.dequantize.tensor %6 : !torch.vtensor<[1,3,8,8],!torch.qint8> -> !torch.vtensor<[1,3,8,8],f32>
+  %12 = torch.aten._make_per_channel_quantized_tensor %arg1, %arg2, %zps, %zero : !torch.vtensor<[4,3,2,2],si8>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],si8>, !torch.int -> !torch.vtensor<[4,3,2,2],!torch.qint8>
+  %13 = torch.aten.dequantize.self %12 : !torch.vtensor<[4,3,2,2],!torch.qint8> -> !torch.vtensor<[4,3,2,2],f32>
+  %14 = torch.prim.ListConstruct %one, %one : (!torch.int, !torch.int) -> !torch.list<int>
+  %15 = torch.prim.ListConstruct %zero, %zero : (!torch.int, !torch.int) -> !torch.list<int>
+  %16 = torch.aten.convolution %7, %13, %arg3, %14, %15, %14, %false, %15, %one : !torch.vtensor<[1,3,8,8],f32>, !torch.vtensor<[4,3,2,2],f32>, !torch.vtensor<[4],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,7,7],f32>
+
+  // CHECK-DAG: %[[HALF:.+]] = torch.constant.float 5.000000e-01
+  // CHECK-DAG: %[[ZERO:.+]] = torch.constant.int 0
+  // CHECK-DAG: %[[ONE:.+]] = torch.constant.int 1
+  // CHECK-DAG: %[[DTYPE:.+]] = torch.constant.int 14
+  // CHECK-DAG: %[[ZPS:.+]] = torch.vtensor.literal(dense<0> : tensor<4xsi8>) : !torch.vtensor<[4],si8>
+  // CHECK-DAG: %[[QLHS:.+]] = torch.aten._make_per_tensor_quantized_tensor %arg0, %[[HALF]], %[[ONE]]
+  // CHECK-DAG: %[[QRHS:.+]] = torch.aten._make_per_channel_quantized_tensor %arg1, %arg2, %[[ZPS]], %[[ZERO]] : !torch.vtensor<[4,3,2,2],si8>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],si8>, !torch.int -> !torch.vtensor<[4,3,2,2],!torch.qint8>
+  // CHECK-DAG: %[[SCALES:.+]] = torch.aten.mul.Scalar %arg2, %[[HALF]] : !torch.vtensor<[4],f32>, !torch.float -> !torch.vtensor<[4],f32>
+  // CHECK-DAG: %[[QBIAS:.+]] = torch.aten.quantize_per_channel %arg3, %[[SCALES]], %[[ZPS]], %[[ZERO]], %[[DTYPE]] : !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],si8>, !torch.int, !torch.int -> !torch.vtensor<[4],!torch.qint32>
+  // CHECK-DAG: %[[INT:.+]] = torch.aten.int_repr %[[QBIAS]] : !torch.vtensor<[4],!torch.qint32> -> !torch.vtensor<[4],si32>
+  // CHECK-DAG: %[[CONV:.+]] = torch.aten.convolution %[[QLHS]], %[[QRHS]], %[[INT]], {{.*}} -> !torch.vtensor<[1,4,7,7],si32>
+  // CHECK-DAG: %[[QOUT:.+]] = torch.aten._make_per_channel_quantized_tensor %[[CONV]], %[[SCALES]], %[[ZPS]], %[[ONE]] : !torch.vtensor<[1,4,7,7],si32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],si8>, !torch.int -> !torch.vtensor<[1,4,7,7],!torch.qint32>
+  // CHECK: %[[FOUT:.+]] = torch.aten.dequantize.self %[[QOUT]] : !torch.vtensor<[1,4,7,7],!torch.qint32> -> !torch.vtensor<[1,4,7,7],f32>
+  return %16 : !torch.vtensor<[1,4,7,7],f32>
+}
+
+// -----
+
+// CHECK-LABEL: @mm_per_channel
+func.func @mm_per_channel(%arg0: !torch.vtensor<[4,8],si8>, %arg1: !torch.vtensor<[8,6],si8>, %arg2: !torch.vtensor<[6],f32>) -> !torch.vtensor<[4,6],f32> {
+  %scale = torch.constant.float 0.5
+  %one = torch.constant.int 1
+  %zps = torch.vtensor.literal(dense<0> : tensor<6xsi8>) : !torch.vtensor<[6],si8>
+  %0 = torch.aten._make_per_tensor_quantized_tensor %arg0, %scale, %one : !torch.vtensor<[4,8],si8>, !torch.float, !torch.int -> !torch.vtensor<[4,8],!torch.qint8>
+  %1 = torch.aten.dequantize.tensor %0 : !torch.vtensor<[4,8],!torch.qint8> -> !torch.vtensor<[4,8],f32>
+  %2 = torch.aten._make_per_channel_quantized_tensor %arg1, %arg2, %zps, %one : !torch.vtensor<[8,6],si8>, !torch.vtensor<[6],f32>, !torch.vtensor<[6],si8>, !torch.int -> !torch.vtensor<[8,6],!torch.qint8>
+  %3 = torch.aten.dequantize.self %2 : !torch.vtensor<[8,6],!torch.qint8> -> !torch.vtensor<[8,6],f32>
+  %4 = torch.aten.mm %1, %3 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,6],f32> -> !torch.vtensor<[4,6],f32>
+
+  // CHECK-DAG: %[[ONE:.+]] = torch.constant.int 1
+  // CHECK-DAG: %[[HALF:.+]] = torch.constant.float 5.000000e-01
+  // CHECK-DAG: %[[ZPS:.+]] = torch.vtensor.literal
+  // CHECK-DAG: %[[QLHS:.+]] = torch.aten._make_per_tensor_quantized_tensor %arg0, %[[HALF]], %[[ONE]]
+  // CHECK-DAG: %[[QRHS:.+]] = torch.aten._make_per_channel_quantized_tensor %arg1, %arg2, %[[ZPS]], %[[ONE]]
+  // CHECK-DAG: %[[MM:.+]] = torch.aten.mm %[[QLHS]], %[[QRHS]] : !torch.vtensor<[4,8],!torch.qint8>, !torch.vtensor<[8,6],!torch.qint8> -> !torch.vtensor<[4,6],!torch.qint32>
+  // CHECK-DAG: %[[INT:.+]] = torch.aten.int_repr %[[MM]]
+  // CHECK-DAG: %[[SCALES:.+]] = torch.aten.mul.Scalar %arg2, %[[HALF]]
+  // CHECK-DAG: %[[QOUT:.+]] = torch.aten._make_per_channel_quantized_tensor %[[INT]], %[[SCALES]], %[[ZPS]], %[[ONE]] : !torch.vtensor<[4,6],si32>, !torch.vtensor<[6],f32>, !torch.vtensor<[6],si8>, !torch.int -> !torch.vtensor<[4,6],!torch.qint32>
+  // CHECK: torch.aten.dequantize.self %[[QOUT]] : !torch.vtensor<[4,6],!torch.qint32> -> !torch.vtensor<[4,6],f32>
+  return %4 : !torch.vtensor<[4,6],f32>
+}
+
+// -----
+
+// The zero points of the weight are not all 0, so the matmul stays in float.
+
+// CHECK-LABEL: @mm_per_channel_nonzero_zp
+func.func @mm_per_channel_nonzero_zp(%arg0: !torch.vtensor<[4,8],si8>, %arg1: !torch.vtensor<[8,2],si8>, %arg2: !torch.vtensor<[2],f32>) -> !torch.vtensor<[4,2],f32> {
+  %scale = torch.constant.float 0.5
+  %one = torch.constant.int 1
+  %zps = torch.vtensor.literal(dense<[0, 3]> : tensor<2xsi8>) : !torch.vtensor<[2],si8>
+  %0 = torch.aten._make_per_tensor_quantized_tensor %arg0, %scale, %one : !torch.vtensor<[4,8],si8>, !torch.float, !torch.int -> !torch.vtensor<[4,8],!torch.qint8>
+  %1 = torch.aten.dequantize.tensor %0 : !torch.vtensor<[4,8],!torch.qint8> -> !torch.vtensor<[4,8],f32>
+  %2 = torch.aten._make_per_channel_quantized_tensor %arg1, %arg2, %zps, %one : !torch.vtensor<[8,2],si8>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],si8>, !torch.int -> !torch.vtensor<[8,2],!torch.qint8>
+  %3 = torch.aten.dequantize.self %2 : !torch.vtensor<[8,2],!torch.qint8> -> !torch.vtensor<[8,2],f32>
+  // CHECK: torch.aten.mm %{{.*}}, %{{.*}} : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,2],f32> -> !torch.vtensor<[4,2],f32>
+  %4 = torch.aten.mm %1, %3 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,2],f32> -> !torch.vtensor<[4,2],f32>
+  return %4 : !torch.vtensor<[4,2],f32>
+}
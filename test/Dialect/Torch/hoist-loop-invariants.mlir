@@ -0,0 +1,62 @@
+// RUN: torch-mlir-opt -torch-hoist-loop-invariants -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @hoist_weight_transpose(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[4,8],f32>, %[[W:.*]]: !torch.vtensor<[8,8],f32>, %[[N:.*]]: !torch.int)
+// CHECK:         %[[WT:.*]] = torch.aten.transpose.int %[[W]]
+// CHECK:         %[[LOOP:.*]] = torch.prim.Loop %[[N]], %{{.*}}, init(%[[X]]) {
+// CHECK-NEXT:    ^bb0(%{{.*}}: !torch.int, %[[ACC:.*]]: !torch.vtensor<[4,8],f32>):
+// CHECK-NEXT:      %[[MM:.*]] = torch.aten.mm %[[ACC]], %[[WT]]
+// CHECK-NEXT:      torch.prim.Loop.condition %{{.*}}, iter(%[[MM]] : !torch.vtensor<[4,8],f32>)
+// CHECK-NEXT:    } : (!torch.int, !torch.bool, !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32>
+// CHECK:         return %[[LOOP]], %[[W]]
+func.func @hoist_weight_transpose(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[8,8],f32>, %arg2: !torch.int) -> (!torch.vtensor<[4,8],f32>, !torch.vtensor<[8,8],f32>) {
+  %true = torch.constant.bool true
+  %0:2 = torch.prim.Loop %arg2, %true, init(%arg0, %arg1) {
+  ^bb0(%arg3: !torch.int, %arg4: !torch.vtensor<[4,8],f32>, %arg5: !torch.vtensor<[8,8],f32>):
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %1 = torch.aten.transpose.int %arg5, %int0, %int1 : !torch.vtensor<[8,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[8,8],f32>
+    %2 = torch.aten.mm %arg4, %1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,8],f32> -> !torch.vtensor<[4,8],f32>
+    torch.prim.Loop.condition %true, iter(%2, %arg5 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,8],f32>)
+  } : (!torch.int, !torch.bool, !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,8],f32>) -> (!torch.vtensor<[4,8],f32>, !torch.vtensor<[8,8],f32>)
+  return %0#0, %0#1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,8],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @keep_random_ops(
+// CHECK:         torch.prim.Loop
+// CHECK:           torch.aten.rand_like
+// CHECK:           torch.prim.Loop.condition
+func.func @keep_random_ops(%arg0: !torch.vtensor<[4],f32>, %arg1: !torch.int) -> !torch.vtensor<[4],f32> {
+  %true = torch.constant.bool true
+  %none = torch.constant.none
+  %0 = torch.prim.Loop %arg1, %true, init(%arg0) {
+  ^bb0(%arg2: !torch.int, %arg3: !torch.vtensor<[4],f32>):
+    %1 = torch.aten.rand_like %arg0, %none, %none, %none, %none, %none : !torch.vtensor<[4],f32>, !torch.none, !torch.none, !torch.none, !torch.none, !torch.none -> !torch.vtensor<[4],f32>
+    %int1 = torch.constant.int 1
+    %2 = torch.aten.add.Tensor %arg3, %1, %int1 : !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.int -> !torch.vtensor<[4],f32>
+    torch.prim.Loop.condition %true, iter(%2 : !torch.vtensor<[4],f32>)
+  } : (!torch.int, !torch.bool, !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],f32>
+  return %0 : !torch.vtensor<[4],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @keep_reads_of_mutated_lists(
+// CHECK:         torch.prim.Loop
+// CHECK:           torch.aten.len.t
+// CHECK:           torch.aten.append.t
+// CHECK:           torch.prim.Loop.condition
+func.func @keep_reads_of_mutated_lists(%arg0: !torch.int) -> !torch.int {
+  %true = torch.constant.bool true
+  %int0 = torch.constant.int 0
+  %0 = torch.prim.ListConstruct : () -> !torch.list<int>
+  %1 = torch.prim.Loop %arg0, %true, init(%int0) {
+  ^bb0(%arg1: !torch.int, %arg2: !torch.int):
+    %2 = torch.aten.len.t %0 : !torch.list<int> -> !torch.int
+    %3 = torch.aten.append.t %0, %arg1 : !torch.list<int>, !torch.int -> !torch.list<int>
+    torch.prim.Loop.condition %true, iter(%2 : !torch.int)
+  } : (!torch.int, !torch.bool, !torch.int) -> !torch.int
+  return %1 : !torch.int
+}
@@ -0,0 +1,69 @@
+// RUN: torch-mlir-opt -torch-inline-global-slots='min-resource-bytes=16' -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-inline-global-slots='min-resource-bytes=16' -mlir-pass-statistics -split-input-file %s 2>&1 | FileCheck %s --check-prefix=STATS
+
+// The literal of @weight is moved once, not once per use.
+// STATS:      InlineGlobalSlots
+// STATS-NEXT:   (S) 1 num-resource-literals
+// STATS:      InlineGlobalSlots
+// STATS-NEXT:   (S) 0 num-resource-literals
+
+// The data of the literal is moved to a single resource blob, which the
+// copies of the literal at each use share.
+
+torch.global_slot "private" @weight : !torch.vtensor<[4],f32>
+
+torch.global_slot.module_initializer {
+  %0 = torch.vtensor.literal(dense<[1.0, 2.0, 3.0, 4.0]> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+  torch.initialize.global_slots [
+    @weight(%0 : !torch.vtensor<[4],f32>)
+  ]
+}
+
+// CHECK-LABEL:   func.func @forward() -> !torch.vtensor<[4],f32> {
+// CHECK:           %[[T:.*]] = torch.vtensor.literal(dense_resource<weight> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+// CHECK:           return %[[T]]
+func.func @forward() -> !torch.vtensor<[4],f32> {
+  %0 = torch.global_slot.get @weight : !torch.vtensor<[4],f32>
+  return %0 : !torch.vtensor<[4],f32>
+}
+
+// CHECK-LABEL:   func.func @backward() -> !torch.vtensor<[4],f32> {
+// CHECK:           %[[T:.*]] = torch.vtensor.literal(dense_resource<weight> : tensor<4xf32>) : !torch.vtensor<[4],f32>
+// CHECK:           return %[[T]]
+func.func @backward() -> !torch.vtensor<[4],f32> {
+  %0 = torch.global_slot.get @weight : !torch.vtensor<[4],f32>
+  return %0 : !torch.vtensor<[4],f32>
+}
+
+// CHECK:         {-#
+// CHECK-NEXT:      dialect_resources: {
+// CHECK-NEXT:        builtin: {
+// CHECK-NEXT:          weight: "0x08000000{{.*}}"
+// CHECK-NEXT:        }
+// CHECK-NEXT:      }
+// CHECK-NEXT:    #-}
+
+// -----
+
+// Splats and literals smaller than the threshold are copied as they are.
+
+torch.global_slot "private" @splat : !torch.vtensor<[8],f32>
+torch.global_slot "private" @small : !torch.vtensor<[2],si32>
+
+torch.global_slot.module_initializer {
+  %0 = torch.vtensor.literal(dense<1.0> : tensor<8xf32>) : !torch.vtensor<[8],f32>
+  %1 = torch.vtensor.literal(dense<[1, 2]> : tensor<2xsi32>) : !torch.vtensor<[2],si32>
+  torch.initialize.global_slots [
+    @splat(%0 : !torch.vtensor<[8],f32>)
+    @small(%1 : !torch.vtensor<[2],si32>)
+  ]
+}
+
+// CHECK-LABEL:   func.func @forward() -> (!torch.vtensor<[8],f32>, !torch.vtensor<[2],si32>) {
+// CHECK:           torch.vtensor.literal(dense<1.000000e+00> : tensor<8xf32>)
+// CHECK:           torch.vtensor.literal(dense<[1, 2]> : tensor<2xsi32>)
+func.func @forward() -> (!torch.vtensor<[8],f32>, !torch.vtensor<[2],si32>) {
+  %0 = torch.global_slot.get @splat : !torch.vtensor<[8],f32>
+  %1 = torch.global_slot.get @small : !torch.vtensor<[2],si32>
+  return %0, %1 : !torch.vtensor<[8],f32>, !torch.vtensor<[2],si32>
+}
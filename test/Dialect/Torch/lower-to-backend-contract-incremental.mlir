@@ -0,0 +1,35 @@
+// RUN: torch-mlir-opt -torch-lower-to-backend-contract="incremental=true max-iterations=3 statistics-file=-" -mlir-print-ir-after-failure -verify-diagnostics %s 2>&1 | FileCheck %s
+
+// @stuck never satisfies the backend contract, so every iteration runs. From
+// the second one on, the converged @converged is set aside, but the dead
+// private @dead is not, so that SymbolDCE still erases it.
+
+// CHECK:      "per_iteration": [
+// CHECK:        "detached_functions": 0
+// CHECK-NEXT:   "iteration": 1
+// CHECK:        "detached_functions": 1
+// CHECK-NEXT:   "iteration": 2
+// CHECK:        "detached_functions": 1
+// CHECK-NEXT:   "iteration": 3
+
+// CHECK:      IR Dump After LowerToBackendContract Failed
+// CHECK:      func.func @converged(
+// CHECK-NEXT:   torch.aten.tanh
+// CHECK-NOT:  @dead
+// CHECK:      func.func @stuck(
+
+func.func @converged(%arg0: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,3],f32> {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+  return %0 : !torch.vtensor<[2,3],f32>
+}
+
+func.func private @dead(%arg0: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,3],f32> {
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+  return %0 : !torch.vtensor<[2,3],f32>
+}
+
+// expected-error @+2 {{unsupported by backend contract: non-value tensor type}}
+// expected-note @+1 {{this is likely due to}}
+func.func @stuck(%arg0: !torch.tensor) {
+  return
+}
@@ -0,0 +1,25 @@
+// RUN: torch-mlir-opt -torch-lower-to-backend-contract -mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=ITERS
+// RUN: torch-mlir-opt -torch-lower-to-backend-contract="count-violations=true" -mlir-pass-statistics %s 2>&1 | FileCheck %s --check-prefix=STATS
+// RUN: torch-mlir-opt -torch-lower-to-backend-contract="statistics-file=-" %s | FileCheck %s --check-prefix=JSON
+
+// ITERS: LowerToBackendContract
+// ITERS: (S) 1 num-iterations
+
+// STATS: LowerToBackendContract
+// STATS-DAG: (S) 1 num-iterations
+// STATS-DAG: (S) 0 num-non-value-semantic-ops
+// STATS-DAG: (S) 0 num-unknown-dtype-ops
+// STATS-DAG: (S) 0 num-unknown-shape-ops
+
+// JSON: "converged": true
+// JSON: "iterations": 1
+// JSON: "per_iteration": [
+// JSON: "iteration": 1
+// JSON: "passes": [
+// JSON: "pass": "func.func(canonicalize)"
+// JSON: "unknown_shape_ops": 0
+
+func.func @f(%arg0: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,3],f32> {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+  return %0 : !torch.vtensor<[2,3],f32>
+}
@@ -59,6 +59,24 @@ func.func @mutation_followed_by_view_like_ops(%value_t: !torch.vtensor, %overwri
   return %value_result : !torch.vtensor
 }
 
+// CHECK-LABEL:   func.func @mutations_interleaved_with_views(
+// CHECK-SAME:                                            %[[ARG0:.*]]: !torch.vtensor, %[[ARG1:.*]]: !torch.vtensor, %[[ARG2:.*]]: !torch.vtensor,
+// CHECK-SAME:                                            %[[INT_LIST:.*]]: !torch.list<int>) -> (!torch.vtensor, !torch.vtensor, !torch.vtensor) {
+// CHECK:           %[[VIEW1:.*]] = torch.aten.view %[[ARG1]], %[[INT_LIST]] : !torch.vtensor, !torch.list<int> -> !torch.vtensor
+// CHECK:           %[[VIEW2:.*]] = torch.aten.view %[[ARG2]], %[[INT_LIST]] : !torch.vtensor, !torch.list<int> -> !torch.vtensor
+// CHECK:           return %[[VIEW1]], %[[VIEW2]], %[[ARG2]] : !torch.vtensor, !torch.vtensor, !torch.vtensor
+func.func @mutations_interleaved_with_views(%arg0: !torch.vtensor, %arg1: !torch.vtensor, %arg2: !torch.vtensor, %int_list: !torch.list<int>) -> (!torch.vtensor, !torch.vtensor, !torch.vtensor) {
+  %t = torch.copy.to_tensor %arg0 : !torch.tensor
+  torch.overwrite.tensor.contents %arg1 overwrites %t : !torch.vtensor, !torch.tensor
+  %view1 = torch.aten.view %t, %int_list : !torch.tensor, !torch.list<int> -> !torch.tensor
+  %value1 = torch.copy.to_vtensor %view1 : !torch.vtensor
+  torch.overwrite.tensor.contents %arg2 overwrites %t : !torch.vtensor, !torch.tensor
+  %view2 = torch.aten.view %t, %int_list : !torch.tensor, !torch.list<int> -> !torch.tensor
+  %value2 = torch.copy.to_vtensor %view2 : !torch.vtensor
+  %value3 = torch.copy.to_vtensor %t : !torch.vtensor
+  return %value1, %value2, %value3 : !torch.vtensor, !torch.vtensor, !torch.vtensor
+}
+
 // CHECK-LABEL:   func.func @mutation_of_view_like_op_result(
 // CHECK-SAME:                                             %[[VALUE_T:.*]]: !torch.vtensor, %[[OVERWRITER:.*]]: !torch.vtensor, %[[INT_LIST:.*]]: !torch.list<int>) -> !torch.vtensor {
 // CHECK:           return %[[OVERWRITER]] : !torch.vtensor
@@ -0,0 +1,18 @@
+// RUN: torch-mlir-opt -torch-name-locations -mlir-print-debuginfo %s | FileCheck %s
+
+// CHECK-LABEL: func.func @forward(
+// CHECK:         torch.constant.int 1 loc(#[[LOC:.*]])
+// CHECK:         torch.aten.add.Tensor {{.*}} loc(#[[ADD:.*]])
+// CHECK:         torch.aten.relu {{.*}} loc(#[[RELU:.*]])
+// CHECK-DAG:   #[[LOC]] = loc("model.py":1:0)
+// CHECK-DAG:   #[[ADD]] = loc("torch.aten.add.Tensor"(#[[LOC]]))
+// CHECK-DAG:   #[[RELU]] = loc("torch.aten.relu"(#[[LOC2:.*]]))
+// CHECK-DAG:   #[[LOC2]] = loc("model.py":2:0)
+func.func @forward(%arg0: !torch.vtensor<[4],f32>) -> !torch.vtensor<[4],f32> {
+  %int1 = torch.constant.int 1 loc(#loc)
+  %0 = torch.aten.add.Tensor %arg0, %arg0, %int1 : !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.int -> !torch.vtensor<[4],f32> loc(#loc)
+  %1 = torch.aten.relu %0 : !torch.vtensor<[4],f32> -> !torch.vtensor<[4],f32> loc(#loc2)
+  return %1 : !torch.vtensor<[4],f32>
+}
+#loc = loc("model.py":1:0)
+#loc2 = loc("model.py":2:0)
@@ -0,0 +1,45 @@
+// RUN: torch-mlir-opt -torch-op-profile %s -o /dev/null | FileCheck %s
+// RUN: torch-mlir-opt -torch-op-profile="backend-legal-ops=aten.softmax.int" %s -o /dev/null | FileCheck %s --check-prefix=LEGAL
+
+// CHECK:      "classes": {
+// CHECK:        "matmul": {
+// CHECK-NEXT:     "bytes": 896,
+// CHECK-NEXT:     "count": 1,
+// CHECK-NEXT:     "flops": 1024,
+// CHECK:        "view": {
+// CHECK-NEXT:     "bytes": 512,
+// CHECK-NEXT:     "count": 1,
+// CHECK-NEXT:     "flops": 0,
+// CHECK:      "handlings": {
+// CHECK-NEXT:   "backend": 2,
+// CHECK-NEXT:   "decomposed": 1,
+// CHECK-NEXT:   "unregistered": 1
+// CHECK:      "ops": {
+// CHECK:        "torch.aten.mm": {
+// CHECK:          "class": "matmul",
+// CHECK:          "handling": "backend",
+// CHECK:        "torch.aten.softmax.int": {
+// CHECK:          "class": "other",
+// CHECK:          "handling": "decomposed",
+// CHECK:        "torch.aten.view": {
+// CHECK:          "class": "view",
+// CHECK:        "torch.operator:foo.bar": {
+// CHECK:          "handling": "unregistered",
+// CHECK-NEXT:     "unknown_shapes": 1
+// CHECK:      "total_ops": 4
+
+// LEGAL:      "handlings": {
+// LEGAL-NEXT:   "backend": 3,
+// LEGAL-NEXT:   "unregistered": 1
+
+func.func @f(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[8,16],f32>, %arg2: !torch.vtensor) -> (!torch.vtensor<[64],f32>, !torch.vtensor<[4,16],f32>, !torch.vtensor) {
+  %int-1 = torch.constant.int -1
+  %int64 = torch.constant.int 64
+  %none = torch.constant.none
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,16],f32> -> !torch.vtensor<[4,16],f32>
+  %1 = torch.prim.ListConstruct %int64 : (!torch.int) -> !torch.list<int>
+  %2 = torch.aten.view %0, %1 : !torch.vtensor<[4,16],f32>, !torch.list<int> -> !torch.vtensor<[64],f32>
+  %3 = torch.aten.softmax.int %0, %int-1, %none : !torch.vtensor<[4,16],f32>, !torch.int, !torch.none -> !torch.vtensor<[4,16],f32>
+  %4 = torch.operator "foo.bar"(%arg2) : (!torch.vtensor) -> !torch.vtensor
+  return %2, %3, %4 : !torch.vtensor<[64],f32>, !torch.vtensor<[4,16],f32>, !torch.vtensor
+}
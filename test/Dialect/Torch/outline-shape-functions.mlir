@@ -0,0 +1,31 @@
+// RUN: torch-mlir-opt -torch-outline-shape-functions -split-input-file %s | FileCheck %s
+
+// The sizes of the result only depend on the sizes of the arguments.
+// CHECK-LABEL: func.func @forward(
+// CHECK:         torch.aten.relu
+// CHECK:         torch.aten.mm
+// CHECK-LABEL: func.func @forward$shapes(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[?,4],f32>) -> !torch.list<int> {
+// CHECK-NOT:     torch.aten.relu
+// CHECK-NOT:     torch.aten.mm
+// CHECK:         %[[DIM:.*]] = torch.aten.size.int %[[ARG0]], %{{.*}} : !torch.vtensor<[?,4],f32>, !torch.int -> !torch.int
+// CHECK:         %[[SHAPE:.*]] = torch.prim.ListConstruct %[[DIM]], %{{.*}} : (!torch.int, !torch.int) -> !torch.list<int>
+// CHECK:         return %[[SHAPE]] : !torch.list<int>
+func.func @forward(%arg0: !torch.vtensor<[?,4],f32>) -> !torch.vtensor<[?,8],f32> {
+  %w = torch.vtensor.literal(dense<1.0> : tensor<4x8xf32>) : !torch.vtensor<[4,8],f32>
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[?,4],f32> -> !torch.vtensor<[?,4],f32>
+  %1 = torch.aten.mm %0, %w : !torch.vtensor<[?,4],f32>, !torch.vtensor<[4,8],f32> -> !torch.vtensor<[?,8],f32>
+  return %1 : !torch.vtensor<[?,8],f32>
+}
+
+// -----
+
+// Private functions and functions without tensor results get no shape
+// function.
+// CHECK-NOT: $shapes
+func.func private @private(%arg0: !torch.vtensor<[?],f32>) -> !torch.vtensor<[?],f32> {
+  return %arg0 : !torch.vtensor<[?],f32>
+}
+func.func @no_tensor_results(%arg0: !torch.int) -> !torch.int {
+  return %arg0 : !torch.int
+}
@@ -0,0 +1,58 @@
+// RUN: torch-mlir-opt -torch-partition-pipeline-stages="num-stages=2" -split-input-file %s | FileCheck %s
+
+// Each layer costs half of the flops and of the weight bytes. The weights are
+// cloned into the stage that uses them.
+// CHECK-LABEL: func.func @forward(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+// CHECK:         %[[SEND:.*]] = call @forward_stage0(%[[ARG0]]) : (!torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32>
+// CHECK:         %[[RESULT:.*]] = call @forward_stage1(%[[SEND]]) : (!torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32>
+// CHECK:         return %[[RESULT]]
+// CHECK-LABEL: func.func @forward_stage0(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> attributes {torch.pipeline_stage = 0 : i64} {
+// CHECK:         %[[W0:.*]] = torch.vtensor.literal(dense<1.000000e+00> : tensor<8x8xf32>)
+// CHECK:         %[[MM:.*]] = torch.aten.mm %[[X]], %[[W0]]
+// CHECK:         %[[RELU:.*]] = torch.aten.relu %[[MM]]
+// CHECK:         return %[[RELU]]
+// CHECK-LABEL: func.func @forward_stage1(
+// CHECK-SAME:      %[[Y:.*]]: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> attributes {torch.pipeline_stage = 1 : i64} {
+// CHECK:         %[[W1:.*]] = torch.vtensor.literal(dense<2.000000e+00> : tensor<8x8xf32>)
+// CHECK:         %[[MM:.*]] = torch.aten.mm %[[Y]], %[[W1]]
+// CHECK:         %[[RELU:.*]] = torch.aten.relu %[[MM]]
+// CHECK:         return %[[RELU]]
+func.func @forward(%arg0: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %w0 = torch.vtensor.literal(dense<1.0> : tensor<8x8xf32>) : !torch.vtensor<[8,8],f32>
+  %w1 = torch.vtensor.literal(dense<2.0> : tensor<8x8xf32>) : !torch.vtensor<[8,8],f32>
+  %0 = torch.aten.mm %arg0, %w0 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,8],f32> -> !torch.vtensor<[4,8],f32>
+  %1 = torch.aten.relu %0 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  %2 = torch.aten.mm %1, %w1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,8],f32> -> !torch.vtensor<[4,8],f32>
+  %3 = torch.aten.relu %2 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  return %3 : !torch.vtensor<[4,8],f32>
+}
+
+// -----
+
+// Without static shapes, the ops are split by count. A value used by a later
+// stage and by the results is sent from the stage that defines it.
+// CHECK-LABEL: func.func @dynamic(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[?],f32>)
+// CHECK:         %[[SEND:.*]]:2 = call @dynamic_stage0(%[[ARG0]]) : (!torch.vtensor<[?],f32>) -> (!torch.vtensor<[?],f32>, !torch.vtensor<[?],f32>)
+// CHECK:         %[[RESULT:.*]] = call @dynamic_stage1(%[[SEND]]#1, %[[ARG0]]) : (!torch.vtensor<[?],f32>, !torch.vtensor<[?],f32>) -> !torch.vtensor<[?],f32>
+// CHECK:         return %[[RESULT]], %[[SEND]]#0
+// CHECK-LABEL: func.func @dynamic_stage0(
+// CHECK:         torch.aten.relu
+// CHECK:         torch.aten.tanh
+// CHECK-NOT:     torch.aten
+// CHECK:         return
+// CHECK-LABEL: func.func @dynamic_stage1(
+// CHECK-SAME:      %[[T:.*]]: !torch.vtensor<[?],f32>, %[[X:.*]]: !torch.vtensor<[?],f32>)
+// CHECK:         %[[INT1:.*]] = torch.constant.int 1
+// CHECK:         %[[SIG:.*]] = torch.aten.sigmoid %[[T]]
+// CHECK:         torch.aten.add.Tensor %[[SIG]], %[[X]], %[[INT1]]
+func.func @dynamic(%arg0: !torch.vtensor<[?],f32>) -> (!torch.vtensor<[?],f32>, !torch.vtensor<[?],f32>) {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  %1 = torch.aten.tanh %0 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  %2 = torch.aten.sigmoid %1 : !torch.vtensor<[?],f32> -> !torch.vtensor<[?],f32>
+  %3 = torch.aten.add.Tensor %2, %arg0, %int1 : !torch.vtensor<[?],f32>, !torch.vtensor<[?],f32>, !torch.int -> !torch.vtensor<[?],f32>
+  return %3, %0 : !torch.vtensor<[?],f32>, !torch.vtensor<[?],f32>
+}
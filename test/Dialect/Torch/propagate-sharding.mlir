@@ -0,0 +1,66 @@
+// RUN: torch-mlir-opt -torch-propagate-sharding -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @elementwise(
+// CHECK:         %[[RELU:.*]] = torch.aten.relu %{{.*}} {torch.sharding = array<i64: 0, -1>}
+// CHECK:         torch.aten.add.Tensor %[[RELU]], %{{.*}}, %{{.*}} {torch.sharding = array<i64: 0, 1>}
+func.func @elementwise(%arg0: !torch.vtensor<[8,4],f32> {torch.sharding = array<i64: 0, -1>}, %arg1: !torch.vtensor<[4],f32> {torch.sharding = array<i64: 1>}) -> !torch.vtensor<[8,4],f32> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[8,4],f32> -> !torch.vtensor<[8,4],f32>
+  %1 = torch.aten.add.Tensor %0, %arg1, %int1 : !torch.vtensor<[8,4],f32>, !torch.vtensor<[4],f32>, !torch.int -> !torch.vtensor<[8,4],f32>
+  return %1 : !torch.vtensor<[8,4],f32>
+}
+
+// -----
+
+// A mesh axis splits at most one dim of the result.
+// CHECK-LABEL: func.func @elementwise_axis_conflict(
+// CHECK:         torch.aten.mul.Tensor %{{.*}}, %{{.*}} {torch.sharding = array<i64: 0, -1>}
+func.func @elementwise_axis_conflict(%arg0: !torch.vtensor<[8,4],f32> {torch.sharding = array<i64: 0, -1>}, %arg1: !torch.vtensor<[8,4],f32> {torch.sharding = array<i64: -1, 0>}) -> !torch.vtensor<[8,4],f32> {
+  %0 = torch.aten.mul.Tensor %arg0, %arg1 : !torch.vtensor<[8,4],f32>, !torch.vtensor<[8,4],f32> -> !torch.vtensor<[8,4],f32>
+  return %0 : !torch.vtensor<[8,4],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @mm(
+// CHECK:         torch.aten.mm %{{.*}}, %{{.*}} {torch.sharding = array<i64: 0, 1>}
+func.func @mm(%arg0: !torch.vtensor<[8,16],f32> {torch.sharding = array<i64: 0, -1>}, %arg1: !torch.vtensor<[16,32],f32> {torch.sharding = array<i64: -1, 1>}) -> !torch.vtensor<[8,32],f32> {
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[8,16],f32>, !torch.vtensor<[16,32],f32> -> !torch.vtensor<[8,32],f32>
+  return %0 : !torch.vtensor<[8,32],f32>
+}
+
+// -----
+
+// The output features of a linear are split like the rows of its weight.
+// CHECK-LABEL: func.func @linear(
+// CHECK:         torch.aten.linear %{{.*}}, %{{.*}}, %{{.*}} {torch.sharding = array<i64: 0, -1, 1>}
+func.func @linear(%arg0: !torch.vtensor<[2,8,16],f32> {torch.sharding = array<i64: 0, -1, -1>}, %arg1: !torch.vtensor<[32,16],f32> {torch.sharding = array<i64: 1, -1>}) -> !torch.vtensor<[2,8,32],f32> {
+  %none = torch.constant.none
+  %0 = torch.aten.linear %arg0, %arg1, %none : !torch.vtensor<[2,8,16],f32>, !torch.vtensor<[32,16],f32>, !torch.none -> !torch.vtensor<[2,8,32],f32>
+  return %0 : !torch.vtensor<[2,8,32],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @reductions(
+// CHECK:         torch.aten.sum.dim_IntList %{{.*}}, %{{.*}}, %false, %{{.*}} {torch.sharding = array<i64: 0>}
+// CHECK:         torch.aten.amax %{{.*}}, %{{.*}}, %true {torch.sharding = array<i64: 0, -1>}
+func.func @reductions(%arg0: !torch.vtensor<[8,16],f32> {torch.sharding = array<i64: 0, 1>}) -> (!torch.vtensor<[8],f32>, !torch.vtensor<[8,1],f32>) {
+  %none = torch.constant.none
+  %false = torch.constant.bool false
+  %true = torch.constant.bool true
+  %int1 = torch.constant.int 1
+  %dims = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %0 = torch.aten.sum.dim_IntList %arg0, %dims, %false, %none : !torch.vtensor<[8,16],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[8],f32>
+  %1 = torch.aten.amax %arg0, %dims, %true : !torch.vtensor<[8,16],f32>, !torch.list<int>, !torch.bool -> !torch.vtensor<[8,1],f32>
+  return %0, %1 : !torch.vtensor<[8],f32>, !torch.vtensor<[8,1],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @unsharded(
+// CHECK-NOT:     torch.sharding
+func.func @unsharded(%arg0: !torch.vtensor<[8,4],f32>) -> !torch.vtensor<[8,4],f32> {
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[8,4],f32> -> !torch.vtensor<[8,4],f32>
+  return %0 : !torch.vtensor<[8,4],f32>
+}
@@ -0,0 +1,124 @@
+// RUN: torch-mlir-opt -torch-propagate-transposes -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @cancel_inverse_permutes(
+// CHECK-SAME:      %[[ARG:.*]]: !torch.vtensor<[2,3,4],f32>)
+// CHECK-NOT:     torch.aten.permute
+// CHECK:         return %[[ARG]]
+func.func @cancel_inverse_permutes(%arg0: !torch.vtensor<[2,3,4],f32>) -> !torch.vtensor<[2,3,4],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.prim.ListConstruct %int2, %int0, %int1 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.permute %arg0, %0 : !torch.vtensor<[2,3,4],f32>, !torch.list<int> -> !torch.vtensor<[4,2,3],f32>
+  %2 = torch.prim.ListConstruct %int1, %int2, %int0 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %3 = torch.aten.permute %1, %2 : !torch.vtensor<[4,2,3],f32>, !torch.list<int> -> !torch.vtensor<[2,3,4],f32>
+  return %3 : !torch.vtensor<[2,3,4],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @compose_transposes(
+// CHECK-SAME:      %[[ARG:.*]]: !torch.vtensor<[2,3,4],f32>)
+// CHECK-DAG:     %[[INT0:.*]] = torch.constant.int 0
+// CHECK-DAG:     %[[INT1:.*]] = torch.constant.int 1
+// CHECK-DAG:     %[[INT2:.*]] = torch.constant.int 2
+// CHECK:         %[[PERMS:.*]] = torch.prim.ListConstruct %[[INT1]], %[[INT2]], %[[INT0]]
+// CHECK:         %[[PERMUTE:.*]] = torch.aten.permute %[[ARG]], %[[PERMS]] : !torch.vtensor<[2,3,4],f32>, !torch.list<int> -> !torch.vtensor<[3,4,2],f32>
+// CHECK:         return %[[PERMUTE]]
+func.func @compose_transposes(%arg0: !torch.vtensor<[2,3,4],f32>) -> !torch.vtensor<[3,4,2],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %0 = torch.aten.transpose.int %arg0, %int0, %int1 : !torch.vtensor<[2,3,4],f32>, !torch.int, !torch.int -> !torch.vtensor<[3,2,4],f32>
+  %1 = torch.aten.transpose.int %0, %int1, %int2 : !torch.vtensor<[3,2,4],f32>, !torch.int, !torch.int -> !torch.vtensor<[3,4,2],f32>
+  return %1 : !torch.vtensor<[3,4,2],f32>
+}
+
+// -----
+
+// The transpose is sunk past the add and the relu, where it cancels with the
+// one after them.
+// CHECK-LABEL: func.func @sink_through_elementwise(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[2,3],f32>, %[[ARG1:.*]]: !torch.vtensor<[2,3],f32>)
+// CHECK:         %[[ADD:.*]] = torch.aten.add.Tensor %[[ARG0]], %[[ARG1]], %{{.*}} : !torch.vtensor<[2,3],f32>, !torch.vtensor<[2,3],f32>, !torch.int -> !torch.vtensor<[2,3],f32>
+// CHECK:         %[[RELU:.*]] = torch.aten.relu %[[ADD]] : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK-NOT:     torch.aten.transpose.int
+// CHECK:         return %[[RELU]]
+func.func @sink_through_elementwise(%arg0: !torch.vtensor<[2,3],f32>, %arg1: !torch.vtensor<[2,3],f32>) -> !torch.vtensor<[2,3],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.transpose.int %arg0, %int0, %int1 : !torch.vtensor<[2,3],f32>, !torch.int, !torch.int -> !torch.vtensor<[3,2],f32>
+  %1 = torch.aten.transpose.int %arg1, %int0, %int1 : !torch.vtensor<[2,3],f32>, !torch.int, !torch.int -> !torch.vtensor<[3,2],f32>
+  %2 = torch.aten.add.Tensor %0, %1, %int1 : !torch.vtensor<[3,2],f32>, !torch.vtensor<[3,2],f32>, !torch.int -> !torch.vtensor<[3,2],f32>
+  %3 = torch.aten.relu %2 : !torch.vtensor<[3,2],f32> -> !torch.vtensor<[3,2],f32>
+  %4 = torch.aten.transpose.int %3, %int0, %int1 : !torch.vtensor<[3,2],f32>, !torch.int, !torch.int -> !torch.vtensor<[2,3],f32>
+  return %4 : !torch.vtensor<[2,3],f32>
+}
+
+// -----
+
+// A permute with other users stays where it is.
+// CHECK-LABEL: func.func @keep_shared_permute(
+// CHECK:         %[[T:.*]] = torch.aten.transpose.int
+// CHECK:         torch.aten.relu %[[T]]
+func.func @keep_shared_permute(%arg0: !torch.vtensor<[2,3],f32>) -> (!torch.vtensor<[3,2],f32>, !torch.vtensor<[3,2],f32>) {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.transpose.int %arg0, %int0, %int1 : !torch.vtensor<[2,3],f32>, !torch.int, !torch.int -> !torch.vtensor<[3,2],f32>
+  %1 = torch.aten.relu %0 : !torch.vtensor<[3,2],f32> -> !torch.vtensor<[3,2],f32>
+  return %0, %1 : !torch.vtensor<[3,2],f32>, !torch.vtensor<[3,2],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @sink_through_reduction(
+// CHECK-SAME:      %[[ARG:.*]]: !torch.vtensor<[2,3,4],f32>)
+// CHECK:         %[[SUM:.*]] = torch.aten.sum.dim_IntList %[[ARG]], %{{.*}}, %{{.*}}, %{{.*}} : !torch.vtensor<[2,3,4],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[2,4],f32>
+// CHECK:         %[[PERMUTE:.*]] = torch.aten.permute %[[SUM]], %{{.*}} : !torch.vtensor<[2,4],f32>, !torch.list<int> -> !torch.vtensor<[4,2],f32>
+// CHECK:         return %[[PERMUTE]]
+func.func @sink_through_reduction(%arg0: !torch.vtensor<[2,3,4],f32>) -> !torch.vtensor<[4,2],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %int2 = torch.constant.int 2
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %0 = torch.prim.ListConstruct %int2, %int1, %int0 : (!torch.int, !torch.int, !torch.int) -> !torch.list<int>
+  %1 = torch.aten.permute %arg0, %0 : !torch.vtensor<[2,3,4],f32>, !torch.list<int> -> !torch.vtensor<[4,3,2],f32>
+  %2 = torch.prim.ListConstruct %int1 : (!torch.int) -> !torch.list<int>
+  %3 = torch.aten.sum.dim_IntList %1, %2, %false, %none : !torch.vtensor<[4,3,2],f32>, !torch.list<int>, !torch.bool, !torch.none -> !torch.vtensor<[4,2],f32>
+  return %3 : !torch.vtensor<[4,2],f32>
+}
+
+// -----
+
+// The permute disappears when the dims that are left keep their order.
+// CHECK-LABEL: func.func @reduce_permuted_dims(
+// CHECK-SAME:      %[[ARG:.*]]: !torch.vtensor<[2,3,4],f32>)
+// CHECK-NOT:     torch.aten.transpose.int
+// CHECK:         %[[AMAX:.*]] = torch.aten.amax %[[ARG]], %{{.*}}, %{{.*}} : !torch.vtensor<[2,3,4],f32>, !torch.list<int>, !torch.bool -> !torch.vtensor<[4],f32>
+// CHECK:         return %[[AMAX]]
+func.func @reduce_permuted_dims(%arg0: !torch.vtensor<[2,3,4],f32>) -> !torch.vtensor<[4],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %false = torch.constant.bool false
+  %0 = torch.aten.transpose.int %arg0, %int0, %int1 : !torch.vtensor<[2,3,4],f32>, !torch.int, !torch.int -> !torch.vtensor<[3,2,4],f32>
+  %1 = torch.prim.ListConstruct %int0, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %2 = torch.aten.amax %0, %1, %false : !torch.vtensor<[3,2,4],f32>, !torch.list<int>, !torch.bool -> !torch.vtensor<[4],f32>
+  return %2 : !torch.vtensor<[4],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @mm_of_transposes(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[8,4],f32>, %[[ARG1:.*]]: !torch.vtensor<[16,8],f32>)
+// CHECK:         %[[MM:.*]] = torch.aten.mm %[[ARG1]], %[[ARG0]] : !torch.vtensor<[16,8],f32>, !torch.vtensor<[8,4],f32> -> !torch.vtensor<[16,4],f32>
+// CHECK:         %[[PERMUTE:.*]] = torch.aten.permute %[[MM]], %{{.*}} : !torch.vtensor<[16,4],f32>, !torch.list<int> -> !torch.vtensor<[4,16],f32>
+// CHECK:         return %[[PERMUTE]]
+func.func @mm_of_transposes(%arg0: !torch.vtensor<[8,4],f32>, %arg1: !torch.vtensor<[16,8],f32>) -> !torch.vtensor<[4,16],f32> {
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.transpose.int %arg0, %int0, %int1 : !torch.vtensor<[8,4],f32>, !torch.int, !torch.int -> !torch.vtensor<[4,8],f32>
+  %1 = torch.aten.transpose.int %arg1, %int0, %int1 : !torch.vtensor<[16,8],f32>, !torch.int, !torch.int -> !torch.vtensor<[8,16],f32>
+  %2 = torch.aten.mm %0, %1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[8,16],f32> -> !torch.vtensor<[4,16],f32>
+  return %2 : !torch.vtensor<[4,16],f32>
+}
@@ -0,0 +1,35 @@
+// RUN: torch-mlir-opt '-torch-prune-public-function{kept-results=0}' -split-input-file -verify-diagnostics %s | FileCheck %s
+
+// The auxiliary result, and the argument that only it read, are dropped
+// along with the ops that computed it.
+// CHECK-LABEL: func.func @main(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[3],f32>) -> !torch.vtensor<[3],f32> {
+// CHECK-NEXT:    %[[RELU:.*]] = torch.aten.relu %[[ARG0]] : !torch.vtensor<[3],f32> -> !torch.vtensor<[3],f32>
+// CHECK-NEXT:    return %[[RELU]] : !torch.vtensor<[3],f32>
+func.func @main(%arg0: !torch.vtensor<[3],f32>, %arg1: !torch.vtensor<[3],f32>) -> (!torch.vtensor<[3],f32>, !torch.vtensor<[],f32>) {
+  %none = torch.constant.none
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[3],f32> -> !torch.vtensor<[3],f32>
+  %1 = torch.aten.mul.Tensor %0, %arg1 : !torch.vtensor<[3],f32>, !torch.vtensor<[3],f32> -> !torch.vtensor<[3],f32>
+  %2 = torch.aten.sum %1, %none : !torch.vtensor<[3],f32>, !torch.none -> !torch.vtensor<[],f32>
+  return %0, %2 : !torch.vtensor<[3],f32>, !torch.vtensor<[],f32>
+}
+
+// -----
+
+// expected-error @+1 {{kept result 0 is out of range for 0 results}}
+func.func @main(%arg0: !torch.vtensor<[3],f32>) {
+  return
+}
+
+// -----
+
+// expected-error @+1 {{unimplemented: pruning a function with uses}}
+func.func @main() -> !torch.int {
+  %int0 = torch.constant.int 0
+  return %int0 : !torch.int
+}
+
+func.func @caller() -> !torch.int {
+  %0 = call @main() : () -> !torch.int
+  return %0 : !torch.int
+}
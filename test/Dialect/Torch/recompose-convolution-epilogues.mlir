@@ -0,0 +1,77 @@
+// RUN: torch-mlir-opt -torch-recompose-convolution-epilogues -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @fold_batch_norm(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[1,1,4,4],f32>)
+// CHECK-DAG:     %[[W:.*]] = torch.vtensor.literal(dense<{{\[\[\[\[}}2.000000e+00]]], {{\[\[\[}}6.000000e+00]]]]> : tensor<2x1x1x1xf32>) : !torch.vtensor<[2,1,1,1],f32>
+// CHECK-DAG:     %[[B:.*]] = torch.vtensor.literal(dense<[0.000000e+00, -4.000000e+00]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+// CHECK:         %[[CONV:.*]] = torch.aten.convolution %[[X]], %[[W]], %[[B]]
+// CHECK-NOT:     torch.aten.native_batch_norm
+// CHECK:         %[[RELU:.*]] = torch.aten.relu %[[CONV]]
+// CHECK:         return %[[RELU]]
+func.func @fold_batch_norm(%arg0: !torch.vtensor<[1,1,4,4],f32>) -> !torch.vtensor<[1,2,4,4],f32> {
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %float0.1 = torch.constant.float 1.000000e-01
+  %float1 = torch.constant.float 1.000000e+00
+  %w = torch.vtensor.literal(dense<[[[[1.0]]], [[[2.0]]]]> : tensor<2x1x1x1xf32>) : !torch.vtensor<[2,1,1,1],f32>
+  %gamma = torch.vtensor.literal(dense<[4.0, 3.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %beta = torch.vtensor.literal(dense<[1.0, -1.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %mean = torch.vtensor.literal(dense<[0.5, 1.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %var = torch.vtensor.literal(dense<[3.0, 0.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %ones = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %zeros = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.convolution %arg0, %w, %none, %ones, %zeros, %ones, %false, %zeros, %int1 : !torch.vtensor<[1,1,4,4],f32>, !torch.vtensor<[2,1,1,1],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,2,4,4],f32>
+  %1:3 = torch.aten.native_batch_norm %0, %gamma, %beta, %mean, %var, %false, %float0.1, %float1 : !torch.vtensor<[1,2,4,4],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.bool, !torch.float, !torch.float -> !torch.vtensor<[1,2,4,4],f32>, !torch.vtensor<[0],f32>, !torch.vtensor<[0],f32>
+  %2 = torch.aten.relu %1#0 : !torch.vtensor<[1,2,4,4],f32> -> !torch.vtensor<[1,2,4,4],f32>
+  return %2 : !torch.vtensor<[1,2,4,4],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @recompose_bias_add(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[1,3,8,8],f32>, %[[W:.*]]: !torch.vtensor<[4,3,3,3],f32>, %[[BIAS:.*]]: !torch.vtensor<[4,1,1],f32>)
+// CHECK:         %[[SIZES:.*]] = torch.prim.ListConstruct %{{.*}} : (!torch.int) -> !torch.list<int>
+// CHECK:         %[[VIEW:.*]] = torch.aten.view %[[BIAS]], %[[SIZES]] : !torch.vtensor<[4,1,1],f32>, !torch.list<int> -> !torch.vtensor<[4],f32>
+// CHECK:         %[[CONV:.*]] = torch.aten.convolution %[[X]], %[[W]], %[[VIEW]]
+// CHECK-NOT:     torch.aten.add.Tensor
+// CHECK:         %[[CLAMP:.*]] = torch.aten.clamp %[[CONV]]
+// CHECK:         return %[[CLAMP]]
+func.func @recompose_bias_add(%arg0: !torch.vtensor<[1,3,8,8],f32>, %arg1: !torch.vtensor<[4,3,3,3],f32>, %arg2: !torch.vtensor<[4,1,1],f32>) -> !torch.vtensor<[1,4,6,6],f32> {
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %float0 = torch.constant.float 0.000000e+00
+  %float6 = torch.constant.float 6.000000e+00
+  %ones = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %zeros = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.convolution %arg0, %arg1, %none, %ones, %zeros, %ones, %false, %zeros, %int1 : !torch.vtensor<[1,3,8,8],f32>, !torch.vtensor<[4,3,3,3],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,6,6],f32>
+  %1 = torch.aten.add.Tensor %0, %arg2, %int1 : !torch.vtensor<[1,4,6,6],f32>, !torch.vtensor<[4,1,1],f32>, !torch.int -> !torch.vtensor<[1,4,6,6],f32>
+  %2 = torch.aten.clamp %1, %float0, %float6 : !torch.vtensor<[1,4,6,6],f32>, !torch.float, !torch.float -> !torch.vtensor<[1,4,6,6],f32>
+  return %2 : !torch.vtensor<[1,4,6,6],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @keep_training_batch_norm(
+// CHECK:         torch.aten.convolution
+// CHECK:         torch.aten.native_batch_norm
+func.func @keep_training_batch_norm(%arg0: !torch.vtensor<[1,1,4,4],f32>) -> !torch.vtensor<[1,2,4,4],f32> {
+  %true = torch.constant.bool true
+  %false = torch.constant.bool false
+  %none = torch.constant.none
+  %int0 = torch.constant.int 0
+  %int1 = torch.constant.int 1
+  %float0.1 = torch.constant.float 1.000000e-01
+  %float1 = torch.constant.float 1.000000e+00
+  %w = torch.vtensor.literal(dense<[[[[1.0]]], [[[2.0]]]]> : tensor<2x1x1x1xf32>) : !torch.vtensor<[2,1,1,1],f32>
+  %mean = torch.vtensor.literal(dense<[0.5, 1.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %var = torch.vtensor.literal(dense<[3.0, 0.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+  %ones = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+  %zeros = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+  %0 = torch.aten.convolution %arg0, %w, %none, %ones, %zeros, %ones, %false, %zeros, %int1 : !torch.vtensor<[1,1,4,4],f32>, !torch.vtensor<[2,1,1,1],f32>, !torch.none, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool, !torch.list<int>, !torch.int -> !torch.vtensor<[1,2,4,4],f32>
+  %1:3 = torch.aten.native_batch_norm %0, %none, %none, %mean, %var, %true, %float0.1, %float1 : !torch.vtensor<[1,2,4,4],f32>, !torch.none, !torch.none, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.bool, !torch.float, !torch.float -> !torch.vtensor<[1,2,4,4],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>
+  return %1#0 : !torch.vtensor<[1,2,4,4],f32>
+}
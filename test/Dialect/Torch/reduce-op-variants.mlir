@@ -1,4 +1,5 @@
 // RUN: torch-mlir-opt -torch-reduce-op-variants --split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt '-torch-reduce-op-variants{mark-inplace-destinations=true}' --split-input-file %s | FileCheck %s --check-prefix=INPLACE
 
 // CHECK-LABEL:   func.func @convert_to_value_semantic_tensors(
 // CHECK-SAME:                                       %[[ARG:.*]]: !torch.tensor<[],f32>) -> !torch.tensor<[],f32> {
@@ -107,6 +108,8 @@ func.func @convert_to_value_semantic_tensors_optional(%t: !torch.tensor,
 // CHECK:           %[[TENSOR_AGAIN:.*]] = torch.copy.to_vtensor %[[DTYPE_RESULT]] : !torch.vtensor<[2,2],f32>
 // CHECK:           torch.overwrite.tensor.contents %[[TENSOR_AGAIN]] overwrites %[[ARG0]] : !torch.vtensor<[2,2],f32>, !torch.tensor<[2,2],f32>
 // CHECK:           return %[[ARG0]], %[[ARG0]] : !torch.tensor<[2,2],f32>, !torch.tensor<[2,2],f32>
+// INPLACE-LABEL:   func.func @reduce_trailing_underscore_inplace_variant(
+// INPLACE:           torch.aten.add.Tensor %{{.*}}, %{{.*}}, %{{.*}} {torch.inplace_destination} : !torch.vtensor<[2,2],f32>, !torch.vtensor<[2,2],f32>, !torch.int -> !torch.vtensor<[2,2],f32>
 func.func @reduce_trailing_underscore_inplace_variant(%arg0: !torch.tensor<[2,2],f32>, %arg1: !torch.tensor<[2,2],f32>) -> (!torch.tensor<[2,2],f32>, !torch.tensor<[2,2],f32>) {
   %c1 = torch.constant.int 1
   %0 = torch.aten.add_.Tensor %arg0, %arg1, %c1 : !torch.tensor<[2,2],f32>, !torch.tensor<[2,2],f32>, !torch.int -> !torch.tensor<[2,2],f32>
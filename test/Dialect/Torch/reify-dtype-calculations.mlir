@@ -100,3 +100,33 @@ func.func @custom_onnx_rotary_embedding(%arg0: !torch.vtensor<[1,3,2,6],f32>, %a
   %4 = torch.onnx.rotary_embedding %arg0, %arg1, %arg2, %arg3, %int0, %int0, %int0, %int0, %float1.000000e00 : !torch.vtensor<[1,3,2,6],f32>, !torch.vtensor, !torch.vtensor, !torch.vtensor, !torch.int, !torch.int, !torch.int, !torch.int, !torch.float -> !torch.vtensor
   return %4 : !torch.vtensor
 }
+
+// -----
+
+// CHECK-LABEL:   func.func @native_dtype_inference(
+// CHECK-SAME:                %[[ARG0:.*]]: !torch.vtensor<[2],f32>, %[[ARG1:.*]]: !torch.vtensor<[2],f32>) -> !torch.vtensor<[2],unk> {
+// CHECK-NOT:       torch.dtype.calculate
+// CHECK:           %[[ADD:.*]] = torch.aten.add.Tensor %[[ARG0]], %[[ARG1]], %{{.*}} : !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.int -> !torch.vtensor<[2],f32>
+// CHECK:           %[[RELU:.*]] = torch.aten.relu %[[ADD]] : !torch.vtensor<[2],f32> -> !torch.vtensor<[2],f32>
+// CHECK:           %[[CAST:.*]] = torch.tensor_static_info_cast %[[RELU]] : !torch.vtensor<[2],f32> to !torch.vtensor<[2],unk>
+// CHECK:           return %[[CAST]] : !torch.vtensor<[2],unk>
+func.func @native_dtype_inference(%arg0: !torch.vtensor<[2],f32>, %arg1: !torch.vtensor<[2],f32>) -> !torch.vtensor<[2],unk> {
+  %int1 = torch.constant.int 1
+  %0 = torch.aten.add.Tensor %arg0, %arg1, %int1 : !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.int -> !torch.vtensor<[2],unk>
+  %1 = torch.aten.relu %0 : !torch.vtensor<[2],unk> -> !torch.vtensor<[2],unk>
+  return %1 : !torch.vtensor<[2],unk>
+}
+
+// -----
+
+// The dtype of `tanh` of an int tensor is the default dtype, which is left to
+// the library.
+// CHECK-LABEL:   func.func private @__torch_mlir_dtype_fn.aten.tanh(
+
+// CHECK-LABEL:   func.func @library_dtype_inference(
+// CHECK:           torch.dtype.calculate
+// CHECK:             func.call @__torch_mlir_dtype_fn.aten.tanh
+func.func @library_dtype_inference(%arg0: !torch.vtensor<[2],si64>) -> !torch.vtensor<[2],unk> {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor<[2],si64> -> !torch.vtensor<[2],unk>
+  return %0 : !torch.vtensor<[2],unk>
+}
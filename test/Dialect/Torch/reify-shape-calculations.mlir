@@ -267,3 +267,51 @@ func.func @custom_onnx_rotary_embedding(%arg0: !torch.vtensor, %arg1: !torch.vte
   %4 = torch.onnx.rotary_embedding %arg0, %arg1, %arg2, %arg3, %int0, %int0, %int0, %int0, %float1.000000e00 : !torch.vtensor, !torch.vtensor, !torch.vtensor, !torch.vtensor, !torch.int, !torch.int, !torch.int, !torch.int, !torch.float -> !torch.vtensor
   return %4 : !torch.vtensor
 }
+
+// -----
+
+// Functions are reified independently of each other; shape functions they
+// share are only imported once.
+
+// CHECK: module {
+// CHECK: func.func private @__torch_mlir_shape_fn.aten.tanh(
+// CHECK-NOT: func.func private @__torch_mlir_shape_fn.aten.tanh(
+// CHECK-LABEL:   func.func @multiple_funcs_0(
+// CHECK:           torch.shape.calculate
+// CHECK:             func.call @__torch_mlir_shape_fn.aten.tanh(
+// CHECK-LABEL:   func.func @multiple_funcs_1(
+// CHECK:           torch.shape.calculate
+// CHECK:             func.call @__torch_mlir_shape_fn.aten.tanh(
+func.func @multiple_funcs_0(%arg0: !torch.vtensor) -> !torch.vtensor {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor -> !torch.vtensor
+  return %0 : !torch.vtensor
+}
+func.func @multiple_funcs_1(%arg0: !torch.vtensor) -> !torch.vtensor {
+  %0 = torch.aten.tanh %arg0 : !torch.vtensor -> !torch.vtensor
+  return %0 : !torch.vtensor
+}
+
+// -----
+
+// CHECK-NOT: func.func private @__torch_mlir_shape_fn.aten.mm(
+// CHECK-NOT: func.func private @__torch_mlir_shape_fn.aten.view(
+// CHECK: func.func private @__torch_mlir_shape_fn.aten.cumsum(
+
+// CHECK-LABEL:   func.func @native_shape_inference(
+// CHECK-SAME:                %[[LHS:.*]]: !torch.vtensor<[2,3],f32>,
+// CHECK-SAME:                %[[RHS:.*]]: !torch.vtensor<[3,4],f32>) -> !torch.vtensor {
+// CHECK:           %[[MM:.*]] = torch.aten.mm %[[LHS]], %[[RHS]] : !torch.vtensor<[2,3],f32>, !torch.vtensor<[3,4],f32> -> !torch.vtensor<[2,4],unk>
+// CHECK:           %[[VIEW:.*]] = torch.aten.view %[[MM]], %{{.*}} : !torch.vtensor<[2,4],unk>, !torch.list<int> -> !torch.vtensor<[8],unk>
+// CHECK:           %[[RESULT:.*]] = torch.shape.calculate {
+// CHECK:             torch.aten.cumsum %[[VIEW]]
+// CHECK:           return %[[RESULT]] : !torch.vtensor
+func.func @native_shape_inference(%arg0: !torch.vtensor<[2,3],f32>, %arg1: !torch.vtensor<[3,4],f32>) -> !torch.vtensor {
+  %int-1 = torch.constant.int -1
+  %int0 = torch.constant.int 0
+  %none = torch.constant.none
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[2,3],f32>, !torch.vtensor<[3,4],f32> -> !torch.vtensor
+  %1 = torch.prim.ListConstruct %int-1 : (!torch.int) -> !torch.list<int>
+  %2 = torch.aten.view %0, %1 : !torch.vtensor, !torch.list<int> -> !torch.vtensor
+  %3 = torch.aten.cumsum %2, %int0, %none : !torch.vtensor, !torch.int, !torch.none -> !torch.vtensor
+  return %3 : !torch.vtensor
+}
@@ -0,0 +1,53 @@
+// RUN: torch-mlir-opt -torch-rematerialize-activations -split-input-file %s | FileCheck %s
+// RUN: torch-mlir-opt -torch-rematerialize-activations="memory-budget=192" -split-input-file %s | FileCheck %s --check-prefix=BUDGET
+
+// CHECK-LABEL: func.func @recompute_relu(
+// CHECK-SAME:      %[[X:.*]]: !torch.vtensor<[4,4],f32>, %[[W:.*]]: !torch.vtensor<[4,4],f32>)
+// CHECK:         %[[RELU:.*]] = torch.aten.relu %[[X]]
+// CHECK:         %[[MM0:.*]] = torch.aten.mm %[[RELU]], %[[W]]
+// CHECK:         %[[MM1:.*]] = torch.aten.mm %[[MM0]], %[[W]]
+// CHECK:         %[[RECOMPUTED:.*]] = torch.aten.relu %[[X]]
+// CHECK:         %[[MM2:.*]] = torch.aten.mm %[[MM1]], %[[RECOMPUTED]]
+// CHECK:         return %[[MM2]]
+
+// BUDGET-LABEL: func.func @recompute_relu(
+// BUDGET:         torch.aten.relu
+// BUDGET-NOT:     torch.aten.relu
+func.func @recompute_relu(%arg0: !torch.vtensor<[4,4],f32>, %arg1: !torch.vtensor<[4,4],f32>) -> !torch.vtensor<[4,4],f32> {
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %1 = torch.aten.mm %0, %arg1 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %2 = torch.aten.mm %1, %arg1 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %3 = torch.aten.mm %2, %0 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  return %3 : !torch.vtensor<[4,4],f32>
+}
+
+// -----
+
+// The input of the relu is dead at the last mm, so recomputing the relu there
+// would keep it alive across the peak instead.
+// CHECK-LABEL: func.func @keep_relu_of_dead_input(
+// CHECK:         torch.aten.relu
+// CHECK-NOT:     torch.aten.relu
+func.func @keep_relu_of_dead_input(%arg0: !torch.vtensor<[4,4],f32>, %arg1: !torch.vtensor<[4,4],f32>) -> !torch.vtensor<[4,4],f32> {
+  %0 = torch.aten.mm %arg0, %arg1 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %1 = torch.aten.relu %0 : !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %2 = torch.aten.mm %1, %arg1 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %3 = torch.aten.mm %2, %arg1 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %4 = torch.aten.mm %3, %1 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  return %4 : !torch.vtensor<[4,4],f32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @keep_dropout(
+// CHECK:         torch.aten.dropout
+// CHECK-NOT:     torch.aten.dropout
+func.func @keep_dropout(%arg0: !torch.vtensor<[4,4],f32>, %arg1: !torch.vtensor<[4,4],f32>) -> !torch.vtensor<[4,4],f32> {
+  %float5 = torch.constant.float 5.000000e-01
+  %true = torch.constant.bool true
+  %0 = torch.aten.dropout %arg0, %float5, %true : !torch.vtensor<[4,4],f32>, !torch.float, !torch.bool -> !torch.vtensor<[4,4],f32>
+  %1 = torch.aten.mm %0, %arg1 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %2 = torch.aten.mm %1, %arg1 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  %3 = torch.aten.mm %2, %0 : !torch.vtensor<[4,4],f32>, !torch.vtensor<[4,4],f32> -> !torch.vtensor<[4,4],f32>
+  return %3 : !torch.vtensor<[4,4],f32>
+}
@@ -1,4 +1,5 @@
 // RUN: torch-mlir-opt <%s --torch-scalarize-shapes -split-input-file -verify-diagnostics | FileCheck %s
+// RUN: torch-mlir-opt <%s --torch-scalarize-shapes="max-propagation-depth=1" -split-input-file | FileCheck %s --check-prefix=DEPTH
 
 // CHECK-LABEL: @shape_as_tensor
 func.func @shape_as_tensor(%arg0 : !torch.vtensor<[5,?,?],f32>) -> !torch.vtensor<[3],si32> {
@@ -787,3 +788,29 @@ func.func @select_int_multi_element_subtensor() -> !torch.list<int> {
     %shape = torch.prim.ListConstruct %result : (!torch.int) -> !torch.list<int>
     return %shape : !torch.list<int>
 }
+
+// -----
+
+// The index_select is two producers away from the list, so it is only
+// scalarized without a depth limit.
+// CHECK-LABEL: @max_propagation_depth
+// DEPTH-LABEL: @max_propagation_depth
+func.func @max_propagation_depth(%arg0: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+    // CHECK-NOT: torch.aten.index_select
+    // CHECK: %[[SIZE:.*]] = torch.aten.size.int %arg0
+    // CHECK-NOT: torch.aten.index_select
+    // CHECK: torch.prim.ListConstruct %[[SIZE]]
+    // DEPTH: %[[SHAPE:.*]] = torch.aten._shape_as_tensor %arg0
+    // DEPTH: %[[SELECT:.*]] = torch.aten.index_select %[[SHAPE]]
+    // DEPTH: %[[ITEM:.*]] = torch.aten.item %[[SELECT]]
+    // DEPTH: torch.prim.ListConstruct %[[ITEM]]
+    %int0 = torch.constant.int 0
+    %float0 = torch.constant.float 0.000000e+00
+    %0 = torch.vtensor.literal(dense<1> : tensor<si64>) : !torch.vtensor<[],si64>
+    %1 = torch.aten._shape_as_tensor %arg0 : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[2],si64>
+    %2 = torch.aten.index_select %1, %int0, %0 : !torch.vtensor<[2],si64>, !torch.int, !torch.vtensor<[],si64> -> !torch.vtensor<[],si64>
+    %3 = torch.aten.item %2 : !torch.vtensor<[],si64> -> !torch.int
+    %4 = torch.prim.ListConstruct %3, %3 : (!torch.int, !torch.int) -> !torch.list<int>
+    %5 = torch.aten.constant_pad_nd %arg0, %4, %float0 : !torch.vtensor<[?,?],f32>, !torch.list<int>, !torch.float -> !torch.vtensor<[?,?],f32>
+    return %5 : !torch.vtensor<[?,?],f32>
+}
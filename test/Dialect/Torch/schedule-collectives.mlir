@@ -0,0 +1,41 @@
+// RUN: torch-mlir-opt -torch-schedule-collectives -split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func.func @overlap(
+// CHECK-SAME:      %[[ARG0:.*]]: !torch.vtensor<[4,8],f32>, %[[ARG1:.*]]: !torch.vtensor<[4,8],f32>)
+// CHECK:         %[[SUM:.*]] = torch.constant.str "sum"
+// CHECK:         %[[GROUP:.*]] = torch.constant.str "0"
+// CHECK:         %[[REDUCED:.*]] = torch._c10d_functional.all_reduce %[[ARG0]], %[[SUM]], %[[GROUP]]
+// CHECK:         %[[RELU:.*]] = torch.aten.relu %[[ARG1]]
+// CHECK:         %[[TANH:.*]] = torch.aten.tanh %[[RELU]]
+// CHECK:         %[[WAITED:.*]] = torch._c10d_functional.wait_tensor %[[REDUCED]]
+// CHECK:         torch.aten.add.Tensor %[[WAITED]], %[[TANH]]
+func.func @overlap(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[4,8],f32>) -> !torch.vtensor<[4,8],f32> {
+  %int1 = torch.constant.int 1
+  %str = torch.constant.str "sum"
+  %group = torch.constant.str "0"
+  %0 = torch.aten.relu %arg1 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  %1 = torch._c10d_functional.all_reduce %arg0, %str, %group : !torch.vtensor<[4,8],f32>, !torch.str, !torch.str -> !torch.vtensor<[4,8],f32>
+  %2 = torch._c10d_functional.wait_tensor %1 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  %3 = torch.aten.tanh %0 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  %4 = torch.aten.add.Tensor %2, %3, %int1 : !torch.vtensor<[4,8],f32>, !torch.vtensor<[4,8],f32>, !torch.int -> !torch.vtensor<[4,8],f32>
+  return %4 : !torch.vtensor<[4,8],f32>
+}
+
+// -----
+
+// Collectives are not reordered with each other.
+// CHECK-LABEL: func.func @ordered(
+// CHECK:         torch.aten.relu
+// CHECK:         torch._c10d_functional.all_gather_into_tensor
+// CHECK:         torch._c10d_functional.all_reduce
+func.func @ordered(%arg0: !torch.vtensor<[4,8],f32>, %arg1: !torch.vtensor<[4,8],f32>) -> (!torch.vtensor<[16,8],f32>, !torch.vtensor<[4,8],f32>) {
+  %int4 = torch.constant.int 4
+  %str = torch.constant.str "sum"
+  %group = torch.constant.str "0"
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  %1 = torch._c10d_functional.all_gather_into_tensor %0, %int4, %group : !torch.vtensor<[4,8],f32>, !torch.int, !torch.str -> !torch.vtensor<[16,8],f32>
+  %2 = torch._c10d_functional.all_reduce %arg1, %str, %group : !torch.vtensor<[4,8],f32>, !torch.str, !torch.str -> !torch.vtensor<[4,8],f32>
+  %3 = torch._c10d_functional.wait_tensor %1 : !torch.vtensor<[16,8],f32> -> !torch.vtensor<[16,8],f32>
+  %4 = torch._c10d_functional.wait_tensor %2 : !torch.vtensor<[4,8],f32> -> !torch.vtensor<[4,8],f32>
+  return %3, %4 : !torch.vtensor<[16,8],f32>, !torch.vtensor<[4,8],f32>
+}
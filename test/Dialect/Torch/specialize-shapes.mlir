@@ -0,0 +1,36 @@
+// RUN: torch-mlir-opt -split-input-file -verify-diagnostics %s -torch-specialize-shapes="func-name=forward arg-shapes=2x3,*" | FileCheck %s
+
+// CHECK-LABEL:   func.func @forward(
+// CHECK-SAME:                       %{{.*}}: !torch.vtensor<[?,?],f32>, %{{.*}}: !torch.int) -> !torch.vtensor<[?,?],f32> {
+// CHECK:           torch.aten.relu %{{.*}} : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[?,?],f32>
+// CHECK-LABEL:   func.func @forward_specialized(
+// CHECK-SAME:                                   %[[ARG0:.*]]: !torch.vtensor<[2,3],f32>, %{{.*}}: !torch.int) -> !torch.vtensor<[2,3],f32> {
+// CHECK:           %[[RELU:.*]] = torch.aten.relu %[[ARG0]] : !torch.vtensor<[2,3],f32> -> !torch.vtensor<[2,3],f32>
+// CHECK:           return %[[RELU]] : !torch.vtensor<[2,3],f32>
+func.func @forward(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.int) -> !torch.vtensor<[?,?],f32> {
+  %0 = torch.aten.relu %arg0 : !torch.vtensor<[?,?],f32> -> !torch.vtensor<[?,?],f32>
+  return %0 : !torch.vtensor<[?,?],f32>
+}
+
+// -----
+
+// expected-error @+1 {{no public function named 'forward' to specialize}}
+module {
+  func.func @other(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.int) -> !torch.vtensor<[?,?],f32> {
+    return %arg0 : !torch.vtensor<[?,?],f32>
+  }
+}
+
+// -----
+
+// expected-error @+1 {{expected 1 arg shapes, but got 2}}
+func.func @forward(%arg0: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+  return %arg0 : !torch.vtensor<[?,?],f32>
+}
+
+// -----
+
+// expected-error @+1 {{shape '2x3' is not compatible with argument 0}}
+func.func @forward(%arg0: !torch.vtensor<[4,?],f32>, %arg1: !torch.int) -> !torch.vtensor<[4,?],f32> {
+  return %arg0 : !torch.vtensor<[4,?],f32>
+}
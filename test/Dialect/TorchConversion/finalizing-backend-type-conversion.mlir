@@ -54,6 +54,33 @@ func.func @eliminate_materializations$torch.Generator(%arg0: i64) -> i64 {
 
 // -----
 
+// Chains of materializations left by separate conversions fold to their
+// source, also across regions.
+// CHECK-LABEL:   func.func @eliminate_materialization_chains(
+// CHECK-SAME:                                     %[[ARG:.*]]: tensor<f32>, %[[COND:.*]]: i1) -> tensor<f32> {
+// CHECK-NOT:       torch_c
+// CHECK:           %[[IF:.*]] = scf.if %[[COND]] -> (tensor<f32>) {
+// CHECK:             scf.yield %[[ARG]] : tensor<f32>
+// CHECK:           } else {
+// CHECK:             scf.yield %[[ARG]] : tensor<f32>
+// CHECK:           }
+// CHECK:           return %[[IF]] : tensor<f32>
+func.func @eliminate_materialization_chains(%arg0: tensor<f32>, %arg1: i1) -> tensor<f32> {
+  %0 = torch_c.from_builtin_tensor %arg0 : tensor<f32> -> !torch.vtensor<[],f32>
+  %1 = torch_c.to_builtin_tensor %0 : !torch.vtensor<[],f32> -> tensor<f32>
+  %2 = torch_c.from_builtin_tensor %1 : tensor<f32> -> !torch.vtensor<[],f32>
+  %3 = scf.if %arg1 -> (tensor<f32>) {
+    %4 = torch_c.to_builtin_tensor %2 : !torch.vtensor<[],f32> -> tensor<f32>
+    scf.yield %4 : tensor<f32>
+  } else {
+    %4 = torch_c.to_builtin_tensor %0 : !torch.vtensor<[],f32> -> tensor<f32>
+    scf.yield %4 : tensor<f32>
+  }
+  return %3 : tensor<f32>
+}
+
+// -----
+
 // CHECK-LABEL:   func.func @eliminate_attributes()
 // CHECK-NOT: attributes
 // CHECK-NOT: torch.onnx_meta
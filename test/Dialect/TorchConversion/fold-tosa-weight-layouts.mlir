@@ -0,0 +1,82 @@
+// RUN: torch-mlir-opt %s '-pass-pipeline=builtin.module(func.func(torch-fold-tosa-weight-layouts))' -split-input-file | FileCheck %s
+
+// CHECK-LABEL: func.func @transpose
+// CHECK:         %[[W:.*]] = "tosa.const"() <{values = dense_resource<weight_transposed> : tensor<3x2xi32>}> : () -> tensor<3x2xi32>
+// CHECK-NOT:     tosa.transpose
+// CHECK:         return %[[W]]
+// CHECK:         weight_transposed: "0x04000000010000000400000002000000050000000300000006000000"
+func.func @transpose() -> tensor<3x2xi32> {
+  %0 = "tosa.const"() <{values = dense_resource<weight> : tensor<2x3xi32>}> : () -> tensor<2x3xi32>
+  %1 = tosa.transpose %0 {perms = array<i32: 1, 0>} : (tensor<2x3xi32>) -> tensor<3x2xi32>
+  return %1 : tensor<3x2xi32>
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      weight: "0x04000000010000000200000003000000040000000500000006000000"
+    }
+  }
+#-}
+
+// -----
+
+// The reshaped weight shares the blob of the original one.
+// CHECK-LABEL: func.func @reshape
+// CHECK:         %[[W:.*]] = "tosa.const"() <{values = dense_resource<weight> : tensor<3x2xi32>}> : () -> tensor<3x2xi32>
+// CHECK-NOT:     tosa.reshape
+// CHECK:         return %[[W]]
+func.func @reshape() -> tensor<3x2xi32> {
+  %0 = "tosa.const"() <{values = dense_resource<weight> : tensor<2x3xi32>}> : () -> tensor<2x3xi32>
+  %shape = tosa.const_shape {values = dense<[3, 2]> : tensor<2xindex>} : () -> !tosa.shape<2>
+  %1 = tosa.reshape %0, %shape : (tensor<2x3xi32>, !tosa.shape<2>) -> tensor<3x2xi32>
+  return %1 : tensor<3x2xi32>
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      weight: "0x04000000010000000200000003000000040000000500000006000000"
+    }
+  }
+#-}
+
+// -----
+
+// CHECK-LABEL: func.func @cast
+// CHECK:         %[[W:.*]] = "tosa.const"() <{values = dense_resource<weight_cast> : tensor<2x3xi16>}> : () -> tensor<2x3xi16>
+// CHECK-NOT:     tosa.cast
+// CHECK:         return %[[W]]
+// CHECK:         weight_cast: "0x04000000010002000300040005000600"
+func.func @cast() -> tensor<2x3xi16> {
+  %0 = "tosa.const"() <{values = dense_resource<weight> : tensor<2x3xi32>}> : () -> tensor<2x3xi32>
+  %1 = tosa.cast %0 : (tensor<2x3xi32>) -> tensor<2x3xi16>
+  return %1 : tensor<2x3xi16>
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      weight: "0x04000000010000000200000003000000040000000500000006000000"
+    }
+  }
+#-}
+
+// -----
+
+// A weight with other users is not duplicated.
+// CHECK-LABEL: func.func @transpose_shared
+// CHECK:         tosa.transpose
+func.func @transpose_shared() -> (tensor<2x3xi32>, tensor<3x2xi32>) {
+  %0 = "tosa.const"() <{values = dense_resource<weight> : tensor<2x3xi32>}> : () -> tensor<2x3xi32>
+  %1 = tosa.transpose %0 {perms = array<i32: 1, 0>} : (tensor<2x3xi32>) -> tensor<3x2xi32>
+  return %0, %1 : tensor<2x3xi32>, tensor<3x2xi32>
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      weight: "0x04000000010000000200000003000000040000000500000006000000"
+    }
+  }
+#-}
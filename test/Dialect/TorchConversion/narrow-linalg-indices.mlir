@@ -0,0 +1,77 @@
+// RUN: torch-mlir-opt %s '-pass-pipeline=builtin.module(func.func(torch-narrow-linalg-indices))' -split-input-file | FileCheck %s
+
+// A constant index tensor that fits in i32 is stored as i32, and sign
+// extended where the gather reads it.
+// CHECK-LABEL: func.func @constant_indices
+// CHECK:         %[[INDICES:.*]] = arith.constant dense<[0, 4, 9]> : tensor<3xi32>
+// CHECK:         linalg.generic
+// CHECK-SAME:      ins(%[[INDICES]] : tensor<3xi32>)
+// CHECK:         ^bb0(%{{.*}}: i32, %{{.*}}: f32):
+// CHECK:           tensor.extract
+func.func @constant_indices(%arg0: tensor<10xf32>) -> tensor<3xf32> {
+  %indices = arith.constant dense<[0, 4, 9]> : tensor<3xi64>
+  %empty = tensor.empty() : tensor<3xf32>
+  %0 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%indices : tensor<3xi64>) outs(%empty : tensor<3xf32>) {
+  ^bb0(%in: i64, %out: f32):
+    %1 = arith.index_cast %in : i64 to index
+    %2 = tensor.extract %arg0[%1] : tensor<10xf32>
+    linalg.yield %2 : f32
+  } -> tensor<3xf32>
+  return %0 : tensor<3xf32>
+}
+
+// -----
+
+// Indices that may not fit in i32, and those of arguments, are kept as is.
+// CHECK-LABEL: func.func @unbounded_indices
+// CHECK:         arith.constant dense<[0, 5000000000]> : tensor<2xi64>
+// CHECK:         ^bb0(%{{.*}}: i64, %{{.*}}: i64, %{{.*}}: f32):
+func.func @unbounded_indices(%arg0: tensor<10xf32>, %arg1: tensor<2xi64>) -> tensor<2xf32> {
+  %indices = arith.constant dense<[0, 5000000000]> : tensor<2xi64>
+  %empty = tensor.empty() : tensor<2xf32>
+  %0 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%indices, %arg1 : tensor<2xi64>, tensor<2xi64>) outs(%empty : tensor<2xf32>) {
+  ^bb0(%in: i64, %in_0: i64, %out: f32):
+    %1 = arith.addi %in, %in_0 : i64
+    %2 = arith.index_cast %1 : i64 to index
+    %3 = tensor.extract %arg0[%2] : tensor<10xf32>
+    linalg.yield %3 : f32
+  } -> tensor<2xf32>
+  return %0 : tensor<2xf32>
+}
+
+// -----
+
+// The indices computed from the loop index of a dim bounded by the guard of
+// its symbol are computed as i32.
+// CHECK-LABEL: func.func @guarded_arange
+// CHECK:         %[[EMPTY:.*]] = tensor.empty(%{{.*}}) : tensor<?xi32>
+// CHECK:         %[[INDICES:.*]] = linalg.generic
+// CHECK-SAME:      outs(%[[EMPTY]] : tensor<?xi32>)
+// CHECK:           linalg.yield %{{.*}} : i32
+// CHECK:         } -> tensor<?xi32>
+// CHECK:         linalg.generic
+// CHECK-SAME:      ins(%[[INDICES]] : tensor<?xi32>)
+func.func @guarded_arange(%arg0: !torch.vtensor<[?],f32>) -> tensor<?xf32> {
+  %s0 = torch.symbolic_int "s0" {min_val = 2, max_val = 1024} : !torch.int
+  torch.bind_symbolic_shape %arg0, [%s0], affine_map<()[s0] -> (s0)> : !torch.vtensor<[?],f32>
+  %input = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[?],f32> -> tensor<?xf32>
+  %c0 = arith.constant 0 : index
+  %c2 = arith.constant 2 : i64
+  %dim = tensor.dim %input, %c0 : tensor<?xf32>
+  %e0 = tensor.empty(%dim) : tensor<?xi64>
+  %indices = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} outs(%e0 : tensor<?xi64>) {
+  ^bb0(%out: i64):
+    %i = linalg.index 0 : index
+    %0 = arith.index_cast %i : index to i64
+    %1 = arith.divsi %0, %c2 : i64
+    linalg.yield %1 : i64
+  } -> tensor<?xi64>
+  %e1 = tensor.empty(%dim) : tensor<?xf32>
+  %gather = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%indices : tensor<?xi64>) outs(%e1 : tensor<?xf32>) {
+  ^bb0(%in: i64, %out: f32):
+    %0 = arith.index_cast %in : i64 to index
+    %1 = tensor.extract %input[%0] : tensor<?xf32>
+    linalg.yield %1 : f32
+  } -> tensor<?xf32>
+  return %gather : tensor<?xf32>
+}
@@ -0,0 +1,49 @@
+// RUN: torch-mlir-opt %s '-pass-pipeline=builtin.module(func.func(torch-pack-linalg-weights{block-size=2}))' -split-input-file | FileCheck %s
+
+// The [K, N] weight is laid out as [N1, K1, N0, K0] tiles, with zeros past
+// its last column, and the operands that are not divisible are padded.
+// CHECK-LABEL: func.func @matmul
+// CHECK-SAME:    %[[LHS:.*]]: tensor<3x4xi32>, %[[ACC:.*]]: tensor<3x3xi32>
+// CHECK-DAG:     %[[WEIGHT:.*]] = arith.constant dense<{{\[\[\[\[}}1, 4], [2, 5]], {{\[\[}}7, 10], [8, 11]]], {{\[\[\[}}3, 6], [0, 0]], {{\[\[}}9, 12], [0, 0]]]]> : tensor<2x2x2x2xi32>
+// CHECK-DAG:     %[[ZERO:.*]] = arith.constant 0 : i32
+// CHECK:         %[[PACKED_LHS:.*]] = linalg.pack %[[LHS]] padding_value(%[[ZERO]] : i32) inner_dims_pos = [0, 1] inner_tiles = [2, 2] into %{{.*}} : tensor<3x4xi32> -> tensor<2x2x2x2xi32>
+// CHECK:         %[[PACKED_ACC:.*]] = linalg.pack %[[ACC]] padding_value(%{{.*}} : i32) inner_dims_pos = [0, 1] inner_tiles = [2, 2] into %{{.*}} : tensor<3x3xi32> -> tensor<2x2x2x2xi32>
+// CHECK:         %[[PRODUCT:.*]] = linalg.mmt4d ins(%[[PACKED_LHS]], %[[WEIGHT]] : tensor<2x2x2x2xi32>, tensor<2x2x2x2xi32>) outs(%[[PACKED_ACC]] : tensor<2x2x2x2xi32>)
+// CHECK:         %[[RESULT:.*]] = linalg.unpack %[[PRODUCT]] inner_dims_pos = [0, 1] inner_tiles = [2, 2] into %[[ACC]] : tensor<2x2x2x2xi32> -> tensor<3x3xi32>
+// CHECK:         return %[[RESULT]]
+func.func @matmul(%lhs: tensor<3x4xi32>, %acc: tensor<3x3xi32>) -> tensor<3x3xi32> {
+  %weight = arith.constant dense<[[1, 2, 3], [4, 5, 6], [7, 8, 9], [10, 11, 12]]> : tensor<4x3xi32>
+  %0 = linalg.matmul ins(%lhs, %weight : tensor<3x4xi32>, tensor<4x3xi32>) outs(%acc : tensor<3x3xi32>) -> tensor<3x3xi32>
+  return %0 : tensor<3x3xi32>
+}
+
+// -----
+
+// A transposed [N, K] weight, as linear layers read it, is packed the same
+// way. The rows of the lhs are only known at runtime, so they are padded.
+// CHECK-LABEL: func.func @matmul_transpose_b
+// CHECK-SAME:    %[[LHS:.*]]: tensor<?x4xf32>, %[[ACC:.*]]: tensor<?x2xf32>
+// CHECK-DAG:     %[[WEIGHT:.*]] = arith.constant dense<{{\[\[\[\[}}1.000000e+00, 2.000000e+00], [5.000000e+00, 6.000000e+00]], {{\[\[}}3.000000e+00, 4.000000e+00], [7.000000e+00, 8.000000e+00]]]]> : tensor<1x2x2x2xf32>
+// CHECK:         %[[PACKED_LHS:.*]] = linalg.pack %[[LHS]] padding_value(%{{.*}} : f32) inner_dims_pos = [0, 1] inner_tiles = [2, 2] into %{{.*}} : tensor<?x4xf32> -> tensor<?x2x2x2xf32>
+// CHECK:         %[[PACKED_ACC:.*]] = linalg.pack %[[ACC]] padding_value(%{{.*}} : f32) inner_dims_pos = [0, 1] inner_tiles = [2, 2] into %{{.*}} : tensor<?x2xf32> -> tensor<?x1x2x2xf32>
+// CHECK:         %[[PRODUCT:.*]] = linalg.mmt4d ins(%[[PACKED_LHS]], %[[WEIGHT]] : tensor<?x2x2x2xf32>, tensor<1x2x2x2xf32>) outs(%[[PACKED_ACC]] : tensor<?x1x2x2xf32>)
+// CHECK:         linalg.unpack %[[PRODUCT]] inner_dims_pos = [0, 1] inner_tiles = [2, 2] into %[[ACC]] : tensor<?x1x2x2xf32> -> tensor<?x2xf32>
+func.func @matmul_transpose_b(%lhs: tensor<?x4xf32>, %acc: tensor<?x2xf32>) -> tensor<?x2xf32> {
+  %weight = arith.constant dense<[[1.0, 2.0, 3.0, 4.0], [5.0, 6.0, 7.0, 8.0]]> : tensor<2x4xf32>
+  %0 = linalg.matmul indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d2)>, affine_map<(d0, d1, d2) -> (d1, d2)>, affine_map<(d0, d1, d2) -> (d0, d1)>] ins(%lhs, %weight : tensor<?x4xf32>, tensor<2x4xf32>) outs(%acc : tensor<?x2xf32>) -> tensor<?x2xf32>
+  return %0 : tensor<?x2xf32>
+}
+
+// -----
+
+// A weight with other users is not kept in both layouts.
+// CHECK-LABEL: func.func @shared_weight
+// CHECK-NOT:     linalg.pack
+// CHECK:         linalg.matmul
+// CHECK:         linalg.matmul
+func.func @shared_weight(%lhs: tensor<2x2xf32>, %acc: tensor<2x2xf32>) -> (tensor<2x2xf32>, tensor<2x2xf32>) {
+  %weight = arith.constant dense<[[1.0, 2.0], [3.0, 4.0]]> : tensor<2x2xf32>
+  %0 = linalg.matmul ins(%lhs, %weight : tensor<2x2xf32>, tensor<2x2xf32>) outs(%acc : tensor<2x2xf32>) -> tensor<2x2xf32>
+  %1 = linalg.matmul ins(%0, %weight : tensor<2x2xf32>, tensor<2x2xf32>) outs(%acc : tensor<2x2xf32>) -> tensor<2x2xf32>
+  return %0, %1 : tensor<2x2xf32>, tensor<2x2xf32>
+}
@@ -0,0 +1,60 @@
+// RUN: torch-mlir-opt %s '-pass-pipeline=builtin.module(func.func(torch-propagate-linalg-transposes))' -split-input-file | FileCheck %s
+
+// The transpose back to NCHW after the first convolution cancels with the one
+// to NHWC before the second, and the constant weight is pre-transposed.
+// CHECK-LABEL: func.func @conv_relu_conv
+// CHECK-SAME:    %[[ARG0:.*]]: tensor<1x8x8x4xf32>
+// CHECK-DAG:     %[[WEIGHT:.*]] = arith.constant dense<{{\[\[\[\[}}1.000000e+00, 3.000000e+00], [2.000000e+00, 4.000000e+00]]]]> : tensor<1x1x2x2xf32>
+// CHECK:         %[[RELU:.*]] = linalg.generic
+// CHECK-SAME:      ins(%[[ARG0]] : tensor<1x8x8x4xf32>)
+// CHECK:           arith.maximumf
+// CHECK:         } -> tensor<1x8x8x4xf32>
+// CHECK:         %[[PAD:.*]] = tensor.pad %[[RELU]] low[0, 1, 1, 0] high[0, 1, 1, 0]
+// CHECK-NOT:     linalg.transpose
+// CHECK:         linalg.conv_2d_nhwc_hwcf
+// CHECK-SAME:      ins(%[[PAD]], %[[WEIGHT]] : tensor<1x10x10x4xf32>, tensor<1x1x2x2xf32>)
+func.func @conv_relu_conv(%arg0: tensor<1x8x8x4xf32>, %out: tensor<1x10x10x2xf32>) -> tensor<1x10x10x2xf32> {
+  %zero = arith.constant 0.0 : f32
+  %weight = arith.constant dense<[[[[1.0]], [[2.0]]], [[[3.0]], [[4.0]]]]> : tensor<2x2x1x1xf32>
+  %e0 = tensor.empty() : tensor<1x4x8x8xf32>
+  %nchw = linalg.transpose ins(%arg0 : tensor<1x8x8x4xf32>) outs(%e0 : tensor<1x4x8x8xf32>) permutation = [0, 3, 1, 2]
+  %e1 = tensor.empty() : tensor<1x4x8x8xf32>
+  %relu = linalg.generic {indexing_maps = [affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>, affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%nchw : tensor<1x4x8x8xf32>) outs(%e1 : tensor<1x4x8x8xf32>) {
+  ^bb0(%in: f32, %o: f32):
+    %m = arith.maximumf %in, %zero : f32
+    linalg.yield %m : f32
+  } -> tensor<1x4x8x8xf32>
+  %padded = tensor.pad %relu low[0, 0, 1, 1] high[0, 0, 1, 1] {
+  ^bb0(%i0: index, %i1: index, %i2: index, %i3: index):
+    tensor.yield %zero : f32
+  } : tensor<1x4x8x8xf32> to tensor<1x4x10x10xf32>
+  %e2 = tensor.empty() : tensor<1x10x10x4xf32>
+  %nhwc = linalg.transpose ins(%padded : tensor<1x4x10x10xf32>) outs(%e2 : tensor<1x10x10x4xf32>) permutation = [0, 2, 3, 1]
+  %e3 = tensor.empty() : tensor<1x1x2x2xf32>
+  %hwcf = linalg.transpose ins(%weight : tensor<2x2x1x1xf32>) outs(%e3 : tensor<1x1x2x2xf32>) permutation = [2, 3, 1, 0]
+  %conv = linalg.conv_2d_nhwc_hwcf {dilations = dense<1> : vector<2xi64>, strides = dense<1> : vector<2xi64>} ins(%nhwc, %hwcf : tensor<1x10x10x4xf32>, tensor<1x1x2x2xf32>) outs(%out : tensor<1x10x10x2xf32>) -> tensor<1x10x10x2xf32>
+  return %conv : tensor<1x10x10x2xf32>
+}
+
+// -----
+
+// Operands that are not transposed are read through a permuted map.
+// CHECK-DAG:   #[[MAP0:.*]] = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+// CHECK-DAG:   #[[MAP1:.*]] = affine_map<(d0, d1, d2) -> (d2)>
+// CHECK-LABEL: func.func @bias_add
+// CHECK-SAME:    %[[ARG0:.*]]: tensor<2x5x3xf32>, %[[ARG1:.*]]: tensor<3xf32>
+// CHECK:         %[[ADD:.*]] = linalg.generic {indexing_maps = [#[[MAP0]], #[[MAP1]], #[[MAP0]]]
+// CHECK-SAME:      ins(%[[ARG0]], %[[ARG1]] : tensor<2x5x3xf32>, tensor<3xf32>)
+// CHECK:         %[[RESULT:.*]] = linalg.transpose ins(%[[ADD]] : tensor<2x5x3xf32>) outs(%{{.*}} : tensor<2x3x5xf32>) permutation = [0, 2, 1]
+// CHECK:         return %[[RESULT]]
+func.func @bias_add(%arg0: tensor<2x5x3xf32>, %arg1: tensor<3xf32>) -> tensor<2x3x5xf32> {
+  %e0 = tensor.empty() : tensor<2x3x5xf32>
+  %t = linalg.transpose ins(%arg0 : tensor<2x5x3xf32>) outs(%e0 : tensor<2x3x5xf32>) permutation = [0, 2, 1]
+  %e1 = tensor.empty() : tensor<2x3x5xf32>
+  %add = linalg.generic {indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d1, d2)>, affine_map<(d0, d1, d2) -> (d1)>, affine_map<(d0, d1, d2) -> (d0, d1, d2)>], iterator_types = ["parallel", "parallel", "parallel"]} ins(%t, %arg1 : tensor<2x3x5xf32>, tensor<3xf32>) outs(%e1 : tensor<2x3x5xf32>) {
+  ^bb0(%in: f32, %b: f32, %o: f32):
+    %s = arith.addf %in, %b : f32
+    linalg.yield %s : f32
+  } -> tensor<2x3x5xf32>
+  return %add : tensor<2x3x5xf32>
+}
@@ -0,0 +1,73 @@
+// RUN: torch-mlir-opt %s '-pass-pipeline=builtin.module(func.func(torch-propagate-tosa-transposes))' -split-input-file | FileCheck %s
+
+// The transpose out of one NHWC op cancels with the one into the next.
+// CHECK-LABEL: func.func @elementwise
+// CHECK-SAME:      %[[ARG0:.*]]: tensor<1x4x4x8xf32>
+// CHECK-NOT:     tosa.transpose
+// CHECK:         %[[SIGMOID:.*]] = tosa.sigmoid %[[ARG0]] : (tensor<1x4x4x8xf32>) -> tensor<1x4x4x8xf32>
+// CHECK-NOT:     tosa.transpose
+// CHECK:         return %[[SIGMOID]]
+func.func @elementwise(%arg0: tensor<1x4x4x8xf32>) -> tensor<1x4x4x8xf32> {
+  %0 = tosa.transpose %arg0 {perms = array<i32: 0, 3, 1, 2>} : (tensor<1x4x4x8xf32>) -> tensor<1x8x4x4xf32>
+  %1 = tosa.sigmoid %0 : (tensor<1x8x4x4xf32>) -> tensor<1x8x4x4xf32>
+  %2 = tosa.transpose %1 {perms = array<i32: 0, 2, 3, 1>} : (tensor<1x8x4x4xf32>) -> tensor<1x4x4x8xf32>
+  return %2 : tensor<1x4x4x8xf32>
+}
+
+// -----
+
+// An operand that is not transposed gets the inverse transpose, and the
+// transpose back to NCHW stays in front of the return.
+// CHECK-LABEL: func.func @elementwise_constant
+// CHECK-SAME:      %[[ARG0:.*]]: tensor<1x4x4x8xf32>
+// CHECK:         %[[BIAS:.*]] = "tosa.const"
+// CHECK:         %[[NHWC_BIAS:.*]] = tosa.transpose %[[BIAS]] {perms = array<i32: 0, 2, 3, 1>} : (tensor<1x8x1x1xf32>) -> tensor<1x1x1x8xf32>
+// CHECK:         %[[ADD:.*]] = tosa.add %[[ARG0]], %[[NHWC_BIAS]] : (tensor<1x4x4x8xf32>, tensor<1x1x1x8xf32>) -> tensor<1x4x4x8xf32>
+// CHECK:         %[[NCHW:.*]] = tosa.transpose %[[ADD]] {perms = array<i32: 0, 3, 1, 2>} : (tensor<1x4x4x8xf32>) -> tensor<1x8x4x4xf32>
+// CHECK:         return %[[NCHW]]
+func.func @elementwise_constant(%arg0: tensor<1x4x4x8xf32>) -> tensor<1x8x4x4xf32> {
+  %bias = "tosa.const"() <{values = dense<[[[[1.0]], [[2.0]], [[3.0]], [[4.0]], [[5.0]], [[6.0]], [[7.0]], [[8.0]]]]> : tensor<1x8x1x1xf32>}> : () -> tensor<1x8x1x1xf32>
+  %0 = tosa.transpose %arg0 {perms = array<i32: 0, 3, 1, 2>} : (tensor<1x4x4x8xf32>) -> tensor<1x8x4x4xf32>
+  %1 = tosa.add %0, %bias : (tensor<1x8x4x4xf32>, tensor<1x8x1x1xf32>) -> tensor<1x8x4x4xf32>
+  return %1 : tensor<1x8x4x4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @concat
+// CHECK-SAME:      %[[ARG0:.*]]: tensor<1x4x4x8xf32>, %[[ARG1:.*]]: tensor<1x4x4x8xf32>
+// CHECK:         %[[CONCAT:.*]] = tosa.concat %[[ARG0]], %[[ARG1]] {axis = 3 : i32} : (tensor<1x4x4x8xf32>, tensor<1x4x4x8xf32>) -> tensor<1x4x4x16xf32>
+// CHECK-NOT:     tosa.transpose
+// CHECK:         return %[[CONCAT]]
+func.func @concat(%arg0: tensor<1x4x4x8xf32>, %arg1: tensor<1x4x4x8xf32>) -> tensor<1x4x4x16xf32> {
+  %0 = tosa.transpose %arg0 {perms = array<i32: 0, 3, 1, 2>} : (tensor<1x4x4x8xf32>) -> tensor<1x8x4x4xf32>
+  %1 = tosa.transpose %arg1 {perms = array<i32: 0, 3, 1, 2>} : (tensor<1x4x4x8xf32>) -> tensor<1x8x4x4xf32>
+  %2 = tosa.concat %0, %1 {axis = 1 : i32} : (tensor<1x8x4x4xf32>, tensor<1x8x4x4xf32>) -> tensor<1x16x4x4xf32>
+  %3 = tosa.transpose %2 {perms = array<i32: 0, 2, 3, 1>} : (tensor<1x16x4x4xf32>) -> tensor<1x4x4x16xf32>
+  return %3 : tensor<1x4x4x16xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @reduction
+// CHECK-SAME:      %[[ARG0:.*]]: tensor<1x4x4x8xf32>
+// CHECK:         %[[SUM:.*]] = tosa.reduce_sum %[[ARG0]] {axis = 3 : i32} : (tensor<1x4x4x8xf32>) -> tensor<1x4x4x1xf32>
+// CHECK:         %[[NCHW:.*]] = tosa.transpose %[[SUM]] {perms = array<i32: 0, 3, 1, 2>} : (tensor<1x4x4x1xf32>) -> tensor<1x1x4x4xf32>
+// CHECK:         return %[[NCHW]]
+func.func @reduction(%arg0: tensor<1x4x4x8xf32>) -> tensor<1x1x4x4xf32> {
+  %0 = tosa.transpose %arg0 {perms = array<i32: 0, 3, 1, 2>} : (tensor<1x4x4x8xf32>) -> tensor<1x8x4x4xf32>
+  %1 = tosa.reduce_sum %0 {axis = 1 : i32} : (tensor<1x8x4x4xf32>) -> tensor<1x1x4x4xf32>
+  return %1 : tensor<1x1x4x4xf32>
+}
+
+// -----
+
+// A transpose with a user that does not absorb it is left in place.
+// CHECK-LABEL: func.func @other_user
+// CHECK:         %[[T:.*]] = tosa.transpose %arg0
+// CHECK:         tosa.sigmoid %[[T]]
+func.func @other_user(%arg0: tensor<1x4x4x8xf32>) -> (tensor<1x8x4x4xf32>, tensor<1x8x4x4xf32>) {
+  %0 = tosa.transpose %arg0 {perms = array<i32: 0, 3, 1, 2>} : (tensor<1x4x4x8xf32>) -> tensor<1x8x4x4xf32>
+  %1 = tosa.sigmoid %0 : (tensor<1x8x4x4xf32>) -> tensor<1x8x4x4xf32>
+  return %0, %1 : tensor<1x8x4x4xf32>, tensor<1x8x4x4xf32>
+}
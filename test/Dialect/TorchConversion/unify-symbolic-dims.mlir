@@ -0,0 +1,74 @@
+// RUN: torch-mlir-opt %s '-pass-pipeline=builtin.module(func.func(torch-unify-symbolic-dims,canonicalize,cse))' -split-input-file | FileCheck %s
+
+// The arguments are bound to the same symbols, so the check that their dims
+// agree before the elementwise add folds away.
+// CHECK-LABEL: func.func @same_symbols
+// CHECK-SAME:      %[[ARG0:[a-z0-9]+]]: !torch.vtensor<[?,?],f32>
+// CHECK:         %[[LHS:.*]] = torch_c.to_builtin_tensor %[[ARG0]]
+// CHECK-DAG:     %[[D0:.*]] = tensor.dim %[[LHS]], %c0
+// CHECK-DAG:     %[[D1:.*]] = tensor.dim %[[LHS]], %c1
+// CHECK-NOT:     tensor.dim
+// CHECK-NOT:     cf.assert
+// CHECK:         tensor.empty(%[[D0]], %[[D1]]) : tensor<?x?xf32>
+func.func @same_symbols(%arg0: !torch.vtensor<[?,?],f32>, %arg1: !torch.vtensor<[?,?],f32>) -> !torch.vtensor<[?,?],f32> {
+  %s0 = torch.symbolic_int "s0" {min_val = 1, max_val = 64} : !torch.int
+  %s1 = torch.symbolic_int "s1" {min_val = 1, max_val = 4096} : !torch.int
+  torch.bind_symbolic_shape %arg0, [%s0, %s1], affine_map<()[s0, s1] -> (s0, s1)> : !torch.vtensor<[?,?],f32>
+  torch.bind_symbolic_shape %arg1, [%s0, %s1], affine_map<()[s0, s1] -> (s0, s1)> : !torch.vtensor<[?,?],f32>
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %0 = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[?,?],f32> -> tensor<?x?xf32>
+  %1 = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[?,?],f32> -> tensor<?x?xf32>
+  %lhs0 = tensor.dim %0, %c0 : tensor<?x?xf32>
+  %lhs1 = tensor.dim %0, %c1 : tensor<?x?xf32>
+  %rhs0 = tensor.dim %1, %c0 : tensor<?x?xf32>
+  %rhs1 = tensor.dim %1, %c1 : tensor<?x?xf32>
+  %eq0 = arith.cmpi eq, %lhs0, %rhs0 : index
+  cf.assert %eq0, "mismatched size for broadcast"
+  %eq1 = arith.cmpi eq, %lhs1, %rhs1 : index
+  cf.assert %eq1, "mismatched size for broadcast"
+  %2 = tensor.empty(%lhs0, %lhs1) : tensor<?x?xf32>
+  %3 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%0, %1 : tensor<?x?xf32>, tensor<?x?xf32>) outs(%2 : tensor<?x?xf32>) {
+  ^bb0(%in: f32, %in_0: f32, %out: f32):
+    %4 = arith.addf %in, %in_0 : f32
+    linalg.yield %4 : f32
+  } -> tensor<?x?xf32>
+  %5 = torch_c.from_builtin_tensor %3 : tensor<?x?xf32> -> !torch.vtensor<[?,?],f32>
+  return %5 : !torch.vtensor<[?,?],f32>
+}
+
+// -----
+
+// The size of an intermediate is computed from the argument dims, and the
+// check against the other argument, which is bound to that size, folds away.
+// CHECK-LABEL: func.func @derived_size
+// CHECK-SAME:      %[[ARG0:[a-z0-9]+]]: !torch.vtensor<[?],f32>
+// CHECK:         %[[IN:.*]] = torch_c.to_builtin_tensor %[[ARG0]]
+// CHECK:         %[[D0:.*]] = tensor.dim %[[IN]], %c0
+// CHECK:         %[[SIZE:.*]] = arith.muli %[[D0]], %c2
+// CHECK-NOT:     tensor.dim
+// CHECK-NOT:     cf.assert
+// CHECK:         tensor.empty(%[[SIZE]]) : tensor<?xf32>
+func.func @derived_size(%arg0: !torch.vtensor<[?],f32>, %arg1: !torch.vtensor<[?],f32>) -> !torch.vtensor<[?],f32> {
+  %s0 = torch.symbolic_int "s0" {min_val = 1, max_val = 64} : !torch.int
+  torch.bind_symbolic_shape %arg0, [%s0], affine_map<()[s0] -> (s0)> : !torch.vtensor<[?],f32>
+  torch.bind_symbolic_shape %arg1, [%s0], affine_map<()[s0] -> (s0 * 2)> : !torch.vtensor<[?],f32>
+  %0 = torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[?],f32> -> tensor<?xf32>
+  %1 = tensor.concat dim(0) %0, %0 : (tensor<?xf32>, tensor<?xf32>) -> tensor<?xf32>
+  %2 = torch_c.from_builtin_tensor %1 : tensor<?xf32> -> !torch.vtensor<[?],f32>
+  torch.bind_symbolic_shape %2, [%s0], affine_map<()[s0] -> (s0 * 2)> : !torch.vtensor<[?],f32>
+  %c0 = arith.constant 0 : index
+  %3 = torch_c.to_builtin_tensor %arg1 : !torch.vtensor<[?],f32> -> tensor<?xf32>
+  %lhs = tensor.dim %1, %c0 : tensor<?xf32>
+  %rhs = tensor.dim %3, %c0 : tensor<?xf32>
+  %eq = arith.cmpi eq, %lhs, %rhs : index
+  cf.assert %eq, "mismatched size for broadcast"
+  %4 = tensor.empty(%lhs) : tensor<?xf32>
+  %5 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%1, %3 : tensor<?xf32>, tensor<?xf32>) outs(%4 : tensor<?xf32>) {
+  ^bb0(%in: f32, %in_0: f32, %out: f32):
+    %6 = arith.addf %in, %in_0 : f32
+    linalg.yield %6 : f32
+  } -> tensor<?xf32>
+  %7 = torch_c.from_builtin_tensor %5 : tensor<?xf32> -> !torch.vtensor<[?],f32>
+  return %7 : !torch.vtensor<[?],f32>
+}
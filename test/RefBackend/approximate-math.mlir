@@ -0,0 +1,19 @@
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(func.func(refback-approximate-math))' | FileCheck %s
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(func.func(refback-approximate-math{ops=sin}))' | FileCheck %s --check-prefix=SIN
+
+// By default, the f32 exp is approximated, but not the f64 exp, which has
+// no approximation, nor sin.
+// CHECK-LABEL: func.func @math(
+// CHECK-NOT:     math.exp {{.*}} : f32
+// CHECK:         math.exp {{.*}} : f64
+// CHECK:         math.sin {{.*}} : f32
+// SIN-LABEL:   func.func @math(
+// SIN:           math.exp {{.*}} : f32
+// SIN:           math.exp {{.*}} : f64
+// SIN-NOT:       math.sin
+func.func @math(%arg0: f32, %arg1: f64) -> (f32, f64, f32) {
+  %0 = math.exp %arg0 : f32
+  %1 = math.exp %arg1 : f64
+  %2 = math.sin %arg0 : f32
+  return %0, %1, %2 : f32, f64, f32
+}
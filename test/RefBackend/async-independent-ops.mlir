@@ -0,0 +1,62 @@
+// RUN: torch-mlir-opt %s -pass-pipeline='builtin.module(func.func(refback-async-independent-ops))' -split-input-file | FileCheck %s
+
+// The matmuls only read the arguments and run concurrently; the add waits
+// for both, and each deallocation for the users of its buffer.
+// CHECK-LABEL:   func.func @branches(
+// CHECK:           %[[B0:.*]] = memref.alloc()
+// CHECK:           %[[T0:.*]] = async.execute {
+// CHECK-NEXT:        linalg.matmul
+// CHECK-NEXT:        async.yield
+// CHECK:           %[[B1:.*]] = memref.alloc()
+// CHECK:           %[[T1:.*]] = async.execute {
+// CHECK-NEXT:        linalg.matmul
+// CHECK-NEXT:        async.yield
+// CHECK:           %[[B2:.*]] = memref.alloc()
+// CHECK:           %[[T2:.*]] = async.execute [%[[T0]], %[[T1]]] {
+// CHECK-NEXT:        linalg.add
+// CHECK-NEXT:        async.yield
+// CHECK:           async.await %[[T0]]
+// CHECK-NEXT:      async.await %[[T2]]
+// CHECK-NEXT:      memref.dealloc %[[B0]]
+// CHECK-NEXT:      async.await %[[T1]]
+// CHECK-NEXT:      memref.dealloc %[[B1]]
+// CHECK-NEXT:      return %[[B2]]
+func.func @branches(%arg0: memref<4x4xf32>, %arg1: memref<4x4xf32>) -> memref<4x4xf32> {
+  %0 = memref.alloc() : memref<4x4xf32>
+  linalg.matmul ins(%arg0, %arg1 : memref<4x4xf32>, memref<4x4xf32>) outs(%0 : memref<4x4xf32>)
+  %1 = memref.alloc() : memref<4x4xf32>
+  linalg.matmul ins(%arg1, %arg0 : memref<4x4xf32>, memref<4x4xf32>) outs(%1 : memref<4x4xf32>)
+  %2 = memref.alloc() : memref<4x4xf32>
+  linalg.add ins(%0, %1 : memref<4x4xf32>, memref<4x4xf32>) outs(%2 : memref<4x4xf32>)
+  memref.dealloc %0 : memref<4x4xf32>
+  memref.dealloc %1 : memref<4x4xf32>
+  return %2 : memref<4x4xf32>
+}
+
+// -----
+
+// The views at different offsets of the arena are different buffers, and
+// the call, whose effects are unknown, waits for all the tasks.
+// CHECK-LABEL:   func.func @arena(
+// CHECK:           %[[T0:.*]] = async.execute {
+// CHECK-NEXT:        linalg.fill
+// CHECK:           %[[T1:.*]] = async.execute {
+// CHECK-NEXT:        linalg.fill
+// CHECK:           async.await %[[T0]]
+// CHECK-NEXT:      async.await %[[T1]]
+// CHECK-NEXT:      call @consume
+// CHECK-NEXT:      memref.dealloc
+func.func private @consume(memref<4x4xf32>, memref<4x4xf32>)
+func.func @arena() {
+  %cst = arith.constant 0.0 : f32
+  %arena = memref.alloc() : memref<128xi8>
+  %c0 = arith.constant 0 : index
+  %0 = memref.view %arena[%c0][] : memref<128xi8> to memref<4x4xf32>
+  %c64 = arith.constant 64 : index
+  %1 = memref.view %arena[%c64][] : memref<128xi8> to memref<4x4xf32>
+  linalg.fill ins(%cst : f32) outs(%0 : memref<4x4xf32>)
+  linalg.fill ins(%cst : f32) outs(%1 : memref<4x4xf32>)
+  call @consume(%0, %1) : (memref<4x4xf32>, memref<4x4xf32>) -> ()
+  memref.dealloc %arena : memref<128xi8>
+  return
+}
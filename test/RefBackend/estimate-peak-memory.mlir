@@ -0,0 +1,46 @@
+// RUN: torch-mlir-opt %s -refback-estimate-peak-memory -o /dev/null -allow-unregistered-dialect | FileCheck %s
+
+// The global is read twice but counted once, and the subview keeps %0 live
+// until its deallocation. At the second use, the weight, %0, %1 and the
+// returned %2 are live, but the argument is dead.
+// CHECK:      "functions": {
+// CHECK-NEXT:   "forward": {
+// CHECK-NEXT:     "activations": 64,
+// CHECK-NEXT:     "live_at_peak": [
+// CHECK-NEXT:       {
+// CHECK-NEXT:         "bytes": 64,
+// CHECK-NEXT:         "kind": "weights",
+// CHECK-NEXT:         "loc": "{{.*}}",
+// CHECK-NEXT:         "op": "memref.get_global"
+// CHECK:              "kind": "temporaries",
+// CHECK-NEXT:         "loc": "{{.*}}",
+// CHECK-NEXT:         "op": "memref.alloc"
+// CHECK:              "kind": "temporaries",
+// CHECK-NEXT:         "loc": "{{.*}}",
+// CHECK-NEXT:         "op": "memref.alloc"
+// CHECK:              "kind": "activations",
+// CHECK-NEXT:         "loc": "{{.*}}",
+// CHECK-NEXT:         "op": "memref.alloc"
+// CHECK:          ],
+// CHECK-NEXT:     "peak_bytes": 256,
+// CHECK-NEXT:     "peak_op": {
+// CHECK-NEXT:       "loc": "{{.*}}",
+// CHECK-NEXT:       "op": "test.use"
+// CHECK-NEXT:     },
+// CHECK-NEXT:     "temporaries": 128,
+// CHECK-NEXT:     "unknown_sizes": 1,
+// CHECK-NEXT:     "weights": 64
+memref.global "private" constant @weight : memref<4x4xf32> = dense<1.0>
+func.func @forward(%arg0: memref<4x4xf32>, %arg1: memref<?xf32>) -> memref<4x4xf32> {
+  %weight = memref.get_global @weight : memref<4x4xf32>
+  %0 = memref.alloc() : memref<4x4xf32>
+  "test.use"(%arg0, %weight, %0) : (memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>) -> ()
+  %view = memref.subview %0[0, 0] [2, 4] [1, 1] : memref<4x4xf32> to memref<2x4xf32, strided<[4, 1]>>
+  %1 = memref.alloc() : memref<4x4xf32>
+  %2 = memref.alloc() : memref<4x4xf32>
+  %weight_0 = memref.get_global @weight : memref<4x4xf32>
+  "test.use"(%view, %1, %2, %weight_0) : (memref<2x4xf32, strided<[4, 1]>>, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>) -> ()
+  memref.dealloc %0 : memref<4x4xf32>
+  memref.dealloc %1 : memref<4x4xf32>
+  return %2 : memref<4x4xf32>
+}
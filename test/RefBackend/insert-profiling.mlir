@@ -0,0 +1,45 @@
+// RUN: torch-mlir-opt %s -refback-insert-profiling -split-input-file | FileCheck %s
+
+// The fused op is named after both torch ops, and the loop nested in the
+// linalg.generic is not timed on its own.
+// CHECK-LABEL: module attributes {refback.profile_names = ["torch.aten.mm", "torch.aten.add.Tensor+torch.aten.relu", "memref.copy"]}
+// CHECK:         func.func private @refbackend_profile_begin(i64) attributes {llvm.emit_c_interface}
+// CHECK:         func.func private @refbackend_profile_end(i64) attributes {llvm.emit_c_interface}
+// CHECK-LABEL:   func.func @forward(
+// CHECK:           %[[MM_ID:.*]] = arith.constant 0 : i64
+// CHECK-NEXT:      call @refbackend_profile_begin(%[[MM_ID]]) : (i64) -> ()
+// CHECK-NEXT:      linalg.matmul
+// CHECK-NEXT:      call @refbackend_profile_end(%[[MM_ID]]) : (i64) -> ()
+// CHECK:           %[[ADD_ID:.*]] = arith.constant 1 : i64
+// CHECK-NEXT:      call @refbackend_profile_begin(%[[ADD_ID]]) : (i64) -> ()
+// CHECK-NEXT:      linalg.generic
+// CHECK-NOT:         call
+// CHECK:           call @refbackend_profile_end(%[[ADD_ID]]) : (i64) -> ()
+// CHECK:           %[[COPY_ID:.*]] = arith.constant 2 : i64
+// CHECK-NEXT:      call @refbackend_profile_begin(%[[COPY_ID]]) : (i64) -> ()
+// CHECK-NEXT:      memref.copy
+// CHECK-NEXT:      call @refbackend_profile_end(%[[COPY_ID]]) : (i64) -> ()
+// CHECK:           return
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @forward(%arg0: memref<4x4xf32>, %arg1: memref<4x4xf32>, %arg2: memref<4x4xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<4x4xf32>, memref<4x4xf32>) outs(%arg2 : memref<4x4xf32>) loc(#loc_mm)
+  linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : memref<4x4xf32>) outs(%arg2 : memref<4x4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = arith.addf %in, %out : f32
+    linalg.yield %0 : f32
+  } loc(#loc_fused)
+  memref.copy %arg2, %arg1 : memref<4x4xf32> to memref<4x4xf32>
+  return
+}
+#loc = loc("model.py":1:0)
+#loc_mm = loc("torch.aten.mm"(#loc))
+#loc_fused = loc(fused[loc("torch.aten.add.Tensor"(#loc)), loc("torch.aten.relu"(#loc))])
+
+// -----
+
+// CHECK-NOT: refback.profile_names
+// CHECK-LABEL: func.func @no_ops(
+// CHECK-NOT:     call
+func.func @no_ops(%arg0: memref<4xf32>) -> memref<4xf32> {
+  return %arg0 : memref<4xf32>
+}
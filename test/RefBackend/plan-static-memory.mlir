@@ -0,0 +1,49 @@
+// RUN: torch-mlir-opt %s -refback-plan-static-memory -split-input-file -allow-unregistered-dialect | FileCheck %s
+
+// %0 and %2 are not live at the same time and share memory.
+// CHECK-LABEL:   func.func @reuse(
+// CHECK-SAME:                     %[[ARG:.*]]: memref<4x4xf32>) {
+// CHECK:           %[[ARENA:.*]] = memref.alloc() {alignment = 64 : i64} : memref<128xi8>
+// CHECK:           %[[C0:.*]] = arith.constant 0 : index
+// CHECK:           %[[B0:.*]] = memref.view %[[ARENA]][%[[C0]]][] : memref<128xi8> to memref<4x4xf32>
+// CHECK:           %[[C64:.*]] = arith.constant 64 : index
+// CHECK:           %[[B1:.*]] = memref.view %[[ARENA]][%[[C64]]][] : memref<128xi8> to memref<4x4xf32>
+// CHECK:           "test.use"(%[[B0]], %[[B1]])
+// CHECK:           %[[C0_0:.*]] = arith.constant 0 : index
+// CHECK:           %[[B2:.*]] = memref.view %[[ARENA]][%[[C0_0]]][] : memref<128xi8> to memref<4x4xf32>
+// CHECK:           "test.use"(%[[B1]], %[[B2]])
+// CHECK-NOT:       memref.dealloc
+// CHECK:           memref.dealloc %[[ARENA]] : memref<128xi8>
+// CHECK-NEXT:      return
+func.func @reuse(%arg0: memref<4x4xf32>) {
+  %0 = memref.alloc() : memref<4x4xf32>
+  %1 = memref.alloc() : memref<4x4xf32>
+  "test.use"(%0, %1) : (memref<4x4xf32>, memref<4x4xf32>) -> ()
+  memref.dealloc %0 : memref<4x4xf32>
+  %2 = memref.alloc() : memref<4x4xf32>
+  "test.use"(%1, %2) : (memref<4x4xf32>, memref<4x4xf32>) -> ()
+  memref.dealloc %1 : memref<4x4xf32>
+  memref.dealloc %2 : memref<4x4xf32>
+  return
+}
+
+// -----
+
+// Dynamically shaped buffers, buffers that are not deallocated and buffers
+// that are deallocated conditionally keep their own allocations.
+// CHECK-LABEL:   func.func @not_planned(
+// CHECK-NOT:       memref.view
+// CHECK:           memref.alloc(%{{.*}}) : memref<?xf32>
+// CHECK:           memref.alloc() : memref<4xf32>
+// CHECK:           memref.alloc() : memref<8xf32>
+func.func @not_planned(%arg0: index, %arg1: i1) -> memref<4xf32> {
+  %0 = memref.alloc(%arg0) : memref<?xf32>
+  %1 = memref.alloc() : memref<4xf32>
+  %2 = memref.alloc() : memref<8xf32>
+  "test.use"(%0, %1, %2) : (memref<?xf32>, memref<4xf32>, memref<8xf32>) -> ()
+  memref.dealloc %0 : memref<?xf32>
+  scf.if %arg1 {
+    memref.dealloc %2 : memref<8xf32>
+  }
+  return %1 : memref<4xf32>
+}
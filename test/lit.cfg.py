@@ -94,6 +94,8 @@ tools = [
     "torch-mlir-opt",
     ToolSubst("%PYTHON", config.python_executable, unresolved="ignore"),
 ]
+if config.enable_onnx_c_importer:
+    tools.append("torch-mlir-import-onnx")
 
 llvm_config.add_tool_substitutions(tools, tool_dirs)
 
@@ -0,0 +1,69 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s %t.onnx
+# RUN: torch-mlir-import-onnx %t.onnx \
+# RUN:   | FileCheck %s --check-prefix=DEFAULT \
+# RUN:       --implicit-check-not=small_b --implicit-check-not=large_b
+# RUN: torch-mlir-import-onnx --max-deduplicated-constant-bytes 256 %t.onnx \
+# RUN:   | FileCheck %s --check-prefix=THRESHOLD --implicit-check-not=small_b
+# RUN: torch-mlir-import-onnx --no-deduplicate-constants %t.onnx \
+# RUN:   | FileCheck %s --check-prefix=DISABLED
+
+"""Writes a model with two pairs of identical initializers: a pair of 256
+byte tensors and a pair of 512 byte tensors."""
+
+import sys
+
+import numpy as np
+import onnx
+from onnx import TensorProto, helper, numpy_helper
+
+
+def _initializer(name, size):
+    return numpy_helper.from_array(np.full([size], 0.5, dtype=np.float32), name)
+
+
+x = helper.make_tensor_value_info("x", TensorProto.FLOAT, [64])
+y = helper.make_tensor_value_info("y", TensorProto.FLOAT, [128])
+out_x = helper.make_tensor_value_info("out_x", TensorProto.FLOAT, [64])
+out_y = helper.make_tensor_value_info("out_y", TensorProto.FLOAT, [128])
+graph = helper.make_graph(
+    [
+        helper.make_node("Add", ["x", "small_a"], ["x_a"]),
+        helper.make_node("Add", ["x_a", "small_b"], ["out_x"]),
+        helper.make_node("Add", ["y", "large_a"], ["y_a"]),
+        helper.make_node("Add", ["y_a", "large_b"], ["out_y"]),
+    ],
+    "deduplicate_constants",
+    [x, y],
+    [out_x, out_y],
+    initializer=[
+        _initializer("small_a", 64),
+        _initializer("small_b", 64),
+        _initializer("large_a", 128),
+        _initializer("large_b", 128),
+    ],
+)
+model = helper.make_model(graph, opset_imports=[helper.make_opsetid("", 21)])
+onnx.save_model(model, sys.argv[1])
+
+# Identical tensors share a single resource and constant op.
+# DEFAULT: %[[SMALL:.*]] = torch.operator "onnx.Constant"() {torch.onnx.value = dense_resource<small_a> : tensor<64xf32>}
+# DEFAULT: %[[LARGE:.*]] = torch.operator "onnx.Constant"() {torch.onnx.value = dense_resource<large_a> : tensor<128xf32>}
+# DEFAULT: %[[X_A:.*]] = torch.operator "onnx.Add"(%arg0, %[[SMALL]])
+# DEFAULT: torch.operator "onnx.Add"(%[[X_A]], %[[SMALL]])
+# DEFAULT: %[[Y_A:.*]] = torch.operator "onnx.Add"(%arg1, %[[LARGE]])
+# DEFAULT: torch.operator "onnx.Add"(%[[Y_A]], %[[LARGE]])
+
+# Tensors above the threshold are imported as they are, without being read.
+# THRESHOLD: dense_resource<small_a> : tensor<64xf32>
+# THRESHOLD: dense_resource<large_a> : tensor<128xf32>
+# THRESHOLD: dense_resource<large_b> : tensor<128xf32>
+
+# DISABLED: dense_resource<small_a> : tensor<64xf32>
+# DISABLED: dense_resource<small_b> : tensor<64xf32>
+# DISABLED: dense_resource<large_a> : tensor<128xf32>
+# DISABLED: dense_resource<large_b> : tensor<128xf32>
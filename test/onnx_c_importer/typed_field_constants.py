@@ -0,0 +1,36 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s %t.onnx
+# RUN: torch-mlir-import-onnx %t.onnx | FileCheck %s
+
+"""Writes a model whose initializers hold their elements in the typed fields
+of the TensorProto rather than in raw_data."""
+
+import sys
+
+import onnx
+from onnx import TensorProto, helper
+
+x = helper.make_tensor_value_info("x", TensorProto.FLOAT, [4, 8])
+out = helper.make_tensor_value_info("out", TensorProto.FLOAT, [8, 4])
+shape = helper.make_tensor("shape", TensorProto.INT64, [2], [8, 4])
+bias = helper.make_tensor("bias", TensorProto.FLOAT, [8, 4], [0.5] * 32)
+graph = helper.make_graph(
+    [
+        helper.make_node("Reshape", ["x", "shape"], ["reshaped"]),
+        helper.make_node("Add", ["reshaped", "bias"], ["out"]),
+    ],
+    "typed_field_constants",
+    [x],
+    [out],
+    initializer=[shape, bias],
+)
+model = helper.make_model(graph, opset_imports=[helper.make_opsetid("", 21)])
+onnx.save_model(model, sys.argv[1])
+
+# Small tensors stay dense elements, larger ones reference the field.
+# CHECK: torch.operator "onnx.Constant"() {torch.onnx.value = dense<[8, 4]> : tensor<2xsi64>}
+# CHECK: torch.operator "onnx.Constant"() {torch.onnx.value = dense_resource<bias> : tensor<8x4xf32>}
@@ -0,0 +1,68 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import os
+import re
+
+from torch_mlir.compiler_utils import (
+    TorchMlirCompilerError,
+    run_pipeline_with_repro_report,
+)
+from torch_mlir.ir import Context, Module
+
+
+def run(f):
+    print(f"{f.__name__}")
+    print("-" * len(f.__name__))
+    f()
+    print()
+
+
+# The function has no ONNX opset version, which fails the conversion.
+_SOURCE = """
+module attributes {torch.debug_module_name = "ReproTest"} {
+  func.func @main(%arg0: i32) -> i32 {
+    %c0 = arith.constant 0 : i32
+    %0 = arith.addi %arg0, %c0 : i32
+    return %0 : i32
+  }
+}
+"""
+
+
+@run
+# CHECK-LABEL: test_repro_report
+# CHECK:       repro: ReproTest.mlirbc
+# CHECK-NEXT:  same as the input: True
+# CHECK-NEXT:  canonicalized
+# CHECK-NOT:     arith.addi
+# CHECK:         return %arg0 : i32
+def test_repro_report():
+    with Context():
+        module = Module.parse(_SOURCE)
+        try:
+            run_pipeline_with_repro_report(
+                module,
+                "builtin.module(func.func(convert-torch-onnx-to-torch))",
+                "Converting ONNX",
+            )
+        except TorchMlirCompilerError as e:
+            filename = re.search(r"-pass-pipeline='.*' (\S+)", str(e)).group(1)
+        print("repro:", os.path.basename(filename))
+        # The repro is written as bytecode, from the module before the
+        # pipeline ran.
+        with open(filename, "rb") as f:
+            repro = Module.parse(f.read())
+        os.remove(filename)
+        print("same as the input:", str(repro) == str(Module.parse(_SOURCE)))
+
+        # The module can still be lowered after a failed pipeline.
+        run_pipeline_with_repro_report(
+            module, "builtin.module(canonicalize)", "Canonicalizing"
+        )
+        print("canonicalized")
+        print(module)
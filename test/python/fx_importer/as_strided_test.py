@@ -46,12 +46,13 @@ def expect_reject(module, *args, **kwargs):
 @run
 # CHECK-LABEL: test_as_strided_after_transpose
 # CHECK: func.func @main(%arg0: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[2,2],f32>
-# CHECK: %[[T_INDEX0:.*]] = torch.vtensor.literal{{.*}}tensor<2x2xsi64>
-# CHECK: %[[T_INDEX1:.*]] = torch.vtensor.literal{{.*}}tensor<2x2xsi64>
-# CHECK: %[[T_INDICES:.*]] = torch.prim.ListConstruct %[[T_INDEX0]], %[[T_INDEX1]] : (!torch.vtensor<[2,2],si64>, !torch.vtensor<[2,2],si64>) -> !torch.list<optional<vtensor>>
 # CHECK-NOT: torch.aten.as_strided
-# CHECK: %[[T_RESULT:.*]] = torch.aten.index.Tensor %arg0, %[[T_INDICES]] : !torch.vtensor<[3,4],f32>, !torch.list<optional<vtensor>> -> !torch.vtensor<[2,2],f32>
+# CHECK: %[[T_FLAT:.*]] = torch.aten.view %arg0, {{.*}} -> !torch.vtensor<[12],f32>
+# CHECK: %[[T_ROWS:.*]] = torch.aten.slice.Tensor %[[T_FLAT]], {{.*}} -> !torch.vtensor<[8],f32>
+# CHECK: %[[T_VIEW:.*]] = torch.aten.view %[[T_ROWS]], {{.*}} -> !torch.vtensor<[2,4],f32>
+# CHECK: %[[T_RESULT:.*]] = torch.aten.slice.Tensor %[[T_VIEW]], {{.*}} -> !torch.vtensor<[2,2],f32>
 # CHECK-NOT: torch.aten.as_strided
+# CHECK-NOT: torch.aten.index.Tensor
 # CHECK: return %[[T_RESULT]] : !torch.vtensor<[2,2],f32>
 def test_as_strided_after_transpose():
     class M(nn.Module):
@@ -143,11 +144,11 @@ def test_as_strided_after_to_channels_last():
 # CHECK: func.func @main(%arg0: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[2,2],f32>
 # CHECK: %[[CONTIG_VIEW:.*]] = torch.aten.transpose.int %arg0
 # CHECK: %[[CONTIG_BASE:.*]] = torch.aten.clone %[[CONTIG_VIEW]]
-# CHECK: %[[CONTIG_INDEX0:.*]] = torch.vtensor.literal{{.*}}tensor<2x2xsi64>
-# CHECK: %[[CONTIG_INDEX1:.*]] = torch.vtensor.literal{{.*}}tensor<2x2xsi64>
-# CHECK: %[[CONTIG_INDICES:.*]] = torch.prim.ListConstruct %[[CONTIG_INDEX0]], %[[CONTIG_INDEX1]] : (!torch.vtensor<[2,2],si64>, !torch.vtensor<[2,2],si64>) -> !torch.list<optional<vtensor>>
 # CHECK-NOT: torch.aten.as_strided
-# CHECK: %[[CONTIG_RESULT:.*]] = torch.aten.index.Tensor %[[CONTIG_BASE]], %[[CONTIG_INDICES]] : !torch.vtensor<[4,3],f32>, !torch.list<optional<vtensor>> -> !torch.vtensor<[2,2],f32>
+# CHECK: %[[CONTIG_FLAT:.*]] = torch.aten.view %[[CONTIG_BASE]], {{.*}} -> !torch.vtensor<[12],f32>
+# CHECK: %[[CONTIG_ROWS:.*]] = torch.aten.slice.Tensor %[[CONTIG_FLAT]], {{.*}} -> !torch.vtensor<[6],f32>
+# CHECK: %[[CONTIG_VIEW2:.*]] = torch.aten.view %[[CONTIG_ROWS]], {{.*}} -> !torch.vtensor<[2,3],f32>
+# CHECK: %[[CONTIG_RESULT:.*]] = torch.aten.slice.Tensor %[[CONTIG_VIEW2]], {{.*}} -> !torch.vtensor<[2,2],f32>
 # CHECK-NOT: torch.aten.as_strided
 # CHECK: return %[[CONTIG_RESULT]] : !torch.vtensor<[2,2],f32>
 def test_as_strided_after_contiguous():
@@ -162,10 +163,8 @@ def test_as_strided_after_contiguous():
 @run
 # CHECK-LABEL: test_as_strided_after_slice_explicit_offset
 # CHECK: func.func @main(%arg0: !torch.vtensor<[8],f32>) -> !torch.vtensor<[2],f32>
-# CHECK: %[[SLICE_INDEX0:.*]] = torch.vtensor.literal{{.*}}tensor<2xsi64>
-# CHECK: %[[SLICE_INDICES:.*]] = torch.prim.ListConstruct %[[SLICE_INDEX0]] : (!torch.vtensor<[2],si64>) -> !torch.list<optional<vtensor>>
 # CHECK-NOT: torch.aten.as_strided
-# CHECK: %[[SLICE_RESULT:.*]] = torch.aten.index.Tensor %arg0, %[[SLICE_INDICES]] : !torch.vtensor<[8],f32>, !torch.list<optional<vtensor>> -> !torch.vtensor<[2],f32>
+# CHECK: %[[SLICE_RESULT:.*]] = torch.aten.slice.Tensor %arg0, {{.*}} : !torch.vtensor<[8],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.vtensor<[2],f32>
 # CHECK-NOT: torch.aten.as_strided
 # CHECK: return %[[SLICE_RESULT]] : !torch.vtensor<[2],f32>
 def test_as_strided_after_slice_explicit_offset():
@@ -180,10 +179,8 @@ def test_as_strided_after_slice_explicit_offset():
 @run
 # CHECK-LABEL: test_as_strided_nested_explicit_offset
 # CHECK: func.func @main(%arg0: !torch.vtensor<[10],f32>) -> !torch.vtensor<[2],f32>
-# CHECK: %[[NESTED_INDEX0:.*]] = torch.vtensor.literal{{.*}}tensor<2xsi64>
-# CHECK: %[[NESTED_INDICES:.*]] = torch.prim.ListConstruct %[[NESTED_INDEX0]] : (!torch.vtensor<[2],si64>) -> !torch.list<optional<vtensor>>
 # CHECK-NOT: torch.aten.as_strided
-# CHECK: %[[NESTED_RESULT:.*]] = torch.aten.index.Tensor %arg0, %[[NESTED_INDICES]] : !torch.vtensor<[10],f32>, !torch.list<optional<vtensor>> -> !torch.vtensor<[2],f32>
+# CHECK: %[[NESTED_RESULT:.*]] = torch.aten.slice.Tensor %arg0, {{.*}} : !torch.vtensor<[10],f32>, !torch.int, !torch.int, !torch.int, !torch.int -> !torch.vtensor<[2],f32>
 # CHECK-NOT: torch.aten.as_strided
 # CHECK: return %[[NESTED_RESULT]] : !torch.vtensor<[2],f32>
 def test_as_strided_nested_explicit_offset():
@@ -195,6 +192,37 @@ def test_as_strided_nested_explicit_offset():
     import_module(M(), torch.arange(10, dtype=torch.float32))
 
 
+@run
+# CHECK-LABEL: test_as_strided_sliding_window
+# CHECK: func.func @main(%arg0: !torch.vtensor<[8],f32>) -> !torch.vtensor<[6,3],f32>
+# CHECK-NOT: torch.aten.as_strided
+# CHECK: %[[WINDOW_RESULT:.*]] = torch.aten.unfold %arg0, {{.*}} : !torch.vtensor<[8],f32>, !torch.int, !torch.int, !torch.int -> !torch.vtensor<[6,3],f32>
+# CHECK-NOT: torch.aten.index.Tensor
+# CHECK: return %[[WINDOW_RESULT]] : !torch.vtensor<[6,3],f32>
+def test_as_strided_sliding_window():
+    class M(nn.Module):
+        def forward(self, x):
+            return torch.ops.aten.as_strided.default(x, [6, 3], [1, 1], 0)
+
+    import_module(M(), torch.arange(8, dtype=torch.float32))
+
+
+@run
+# CHECK-LABEL: test_as_strided_diagonal
+# CHECK: func.func @main(%arg0: !torch.vtensor<[3,3],f32>) -> !torch.vtensor<[3],f32>
+# CHECK-NOT: torch.aten.as_strided
+# CHECK: %[[DIAG_FLAT:.*]] = torch.aten.view %arg0, {{.*}} -> !torch.vtensor<[9],f32>
+# CHECK: %[[DIAG_RESULT:.*]] = torch.aten.slice.Tensor %[[DIAG_FLAT]], {{.*}} -> !torch.vtensor<[3],f32>
+# CHECK-NOT: torch.aten.index.Tensor
+# CHECK: return %[[DIAG_RESULT]] : !torch.vtensor<[3],f32>
+def test_as_strided_diagonal():
+    class M(nn.Module):
+        def forward(self, x):
+            return torch.ops.aten.as_strided.default(x, [3], [4], 0)
+
+    import_module(M(), torch.arange(9, dtype=torch.float32).reshape(3, 3))
+
+
 @run
 # CHECK-LABEL: test_as_strided_rejects_dynamic_input_metadata
 # CHECK: ValueError: aten.as_strided.default `base.shape` must be static before Torch IR import
@@ -287,11 +315,11 @@ def test_as_strided_rejects_unmappable_program_input():
 @run
 # CHECK-LABEL: test_as_strided_output_mutation_path
 # CHECK: func.func @main(%arg0: !torch.vtensor<[3,4],f32>) -> !torch.vtensor<[2,2],f32>
-# CHECK: %[[M_INDEX0:.*]] = torch.vtensor.literal{{.*}}tensor<2x2xsi64>
-# CHECK: %[[M_INDEX1:.*]] = torch.vtensor.literal{{.*}}tensor<2x2xsi64>
-# CHECK: %[[M_INDICES:.*]] = torch.prim.ListConstruct %[[M_INDEX0]], %[[M_INDEX1]] : (!torch.vtensor<[2,2],si64>, !torch.vtensor<[2,2],si64>) -> !torch.list<optional<vtensor>>
 # CHECK-NOT: torch.aten.as_strided
-# CHECK: %[[M_RESULT:.*]] = torch.aten.index.Tensor %arg0, %[[M_INDICES]] : !torch.vtensor<[3,4],f32>, !torch.list<optional<vtensor>> -> !torch.vtensor<[2,2],f32>
+# CHECK: %[[M_FLAT:.*]] = torch.aten.view %arg0, {{.*}} -> !torch.vtensor<[12],f32>
+# CHECK: %[[M_ROWS:.*]] = torch.aten.slice.Tensor %[[M_FLAT]], {{.*}} -> !torch.vtensor<[8],f32>
+# CHECK: %[[M_VIEW:.*]] = torch.aten.view %[[M_ROWS]], {{.*}} -> !torch.vtensor<[2,4],f32>
+# CHECK: %[[M_RESULT:.*]] = torch.aten.slice.Tensor %[[M_VIEW]], {{.*}} -> !torch.vtensor<[2,2],f32>
 # CHECK-NOT: torch.aten.as_strided
 # CHECK: return %[[M_RESULT]] : !torch.vtensor<[2,2],f32>
 def test_as_strided_output_mutation_path():
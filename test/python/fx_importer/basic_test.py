@@ -17,8 +17,10 @@ from torch._functorch.aot_autograd import (
     set_model_name,
 )
 
-from torch_mlir import fx
+from torch_mlir import fx, ir
 from torch_mlir.compiler_utils import run_pipeline_with_repro_report
+from torch_mlir.dialects import torch as torch_d
+from torch_mlir.extras.fx_importer import FxImporter
 
 
 def run(f):
@@ -460,3 +462,62 @@ def test_stack_trace():
     m = fx.export_and_import(Basic(), x, y, func_name="test_stack_trace")
     mlir_asm = m.operation.get_asm(enable_debug_info=True)
     print(mlir_asm)
+
+
+@run
+# CHECK-LABEL: test_op_overload_info_cache
+# CHECK:       torch.aten.mul.Scalar registered: True
+# CHECK-NEXT:  torch.aten.mul.Tensor registered: True
+# CHECK-NEXT:  torch.aten.tanh registered: True
+# CHECK-NEXT:  tanh ops: 3
+# CHECK-NEXT:  tanh locations: 1
+def test_op_overload_info_cache():
+    class Layers(nn.Module):
+        def forward(self, x, y):
+            for _ in range(3):
+                x = torch.tanh(x) * 2.0 * y
+            return x
+
+    context = ir.Context()
+    torch_d.register_dialect(context)
+    importer = FxImporter(context=context)
+    m = fx.export_and_import(
+        Layers(), torch.randn(3, 4), torch.randn(3, 4), fx_importer=importer
+    )
+    # One entry per overload, and per `.Scalar` variant, however many nodes
+    # call it.
+    for info in sorted(
+        importer._cc._op_overload_cache.values(), key=lambda i: i.mlir_op_name
+    ):
+        print(f"{info.mlir_op_name} registered: {info.is_registered}")
+    func_op = m.body.operations[0]
+    tanh_ops = [
+        op
+        for op in func_op.regions[0].blocks[0].operations
+        if op.name == "torch.aten.tanh"
+    ]
+    print("tanh ops:", len(tanh_ops))
+    # The layers are built by the same line, so they share a location.
+    print("tanh locations:", len({str(op.location) for op in tanh_ops}))
+
+
+@run
+# CHECK-LABEL: test_default_arguments_and_type_cache
+# CHECK:       %[[NONE:.+]] = torch.constant.str "none"
+# CHECK:       %[[GELU:.+]] = torch.aten.gelu %arg0, %[[NONE]] : !torch.vtensor<[3,4],f32>, !torch.str -> !torch.vtensor<[3,4],f32>
+# CHECK:       torch.aten.gelu %[[GELU]], %{{.+}}
+# CHECK:       tensor types: 1
+def test_default_arguments_and_type_cache():
+    class Layers(nn.Module):
+        def forward(self, x):
+            for _ in range(3):
+                x = nn.functional.gelu(x)
+            return x
+
+    context = ir.Context()
+    torch_d.register_dialect(context)
+    importer = FxImporter(context=context)
+    m = fx.export_and_import(Layers(), torch.randn(3, 4), fx_importer=importer)
+    print(m)
+    # Nodes of the same shape and dtype share a type, whatever their values.
+    print("tensor types:", len(importer._cc._tensor_metadata_cache))
@@ -0,0 +1,184 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import os
+import tempfile
+
+import torch
+import torch.nn as nn
+
+from torch_mlir import compiler_utils, fx
+from torch_mlir.compiler_utils import CompilationCache, run_pipeline_per_function
+from torch_mlir.ir import Context, Module
+
+
+def run(f):
+    print(f"{f.__name__}")
+    print("-" * len(f.__name__))
+    f()
+    print()
+
+
+_run_pipeline = compiler_utils.run_pipeline_with_repro_report
+
+
+def _print_lowering(module, pipeline, description, enable_ir_printing=False):
+    # Report the pipelines that actually lower, not the extraction of units.
+    if not description.startswith("Extracting"):
+        print(f"ran: {description}")
+    _run_pipeline(module, pipeline, description, enable_ir_printing)
+
+
+compiler_utils.run_pipeline_with_repro_report = _print_lowering
+
+
+def _lower(source, cache_dir, pipeline="builtin.module(canonicalize)"):
+    module = Module.parse(source)
+    run_pipeline_per_function(module, pipeline, "Lowering", CompilationCache(cache_dir))
+    return module
+
+
+_SHARED_CALLEE = """
+func.func @a(%arg0: i32) -> i32 {
+  %0 = call @shared(%arg0) : (i32) -> i32
+  return %0 : i32
+}
+func.func @b(%arg0: i32) -> i32 {
+  %c1 = arith.constant 1 : i32
+  %0 = call @shared(%arg0) : (i32) -> i32
+  %1 = arith.addi %0, %c1 : i32
+  return %1 : i32
+}
+func.func private @shared(%arg0: i32) -> i32 {
+  %c0 = arith.constant 0 : i32
+  %0 = arith.addi %arg0, %c0 : i32
+  return %0 : i32
+}
+"""
+
+
+@run
+# CHECK-LABEL: test_cache_hit
+# CHECK:       ran: Lowering (function a)
+# CHECK-NEXT:  ran: Lowering (function b)
+# CHECK-NEXT:  second run
+# CHECK-NEXT:  identical: True
+def test_cache_hit():
+    with Context(), tempfile.TemporaryDirectory() as cache_dir:
+        first = _lower(_SHARED_CALLEE, cache_dir)
+        print("second run")
+        second = _lower(_SHARED_CALLEE, cache_dir)
+        print("identical:", str(first) == str(second))
+
+
+@run
+# CHECK-LABEL: test_partial_hit
+# CHECK:       ran: Lowering (function a)
+# CHECK-NEXT:  ran: Lowering (function b)
+# CHECK-NEXT:  second run
+# CHECK-NEXT:  ran: Lowering (function b)
+# CHECK:       func.func @a
+# CHECK:       func.func @b
+# CHECK:         arith.constant 2 : i32
+def test_partial_hit():
+    with Context(), tempfile.TemporaryDirectory() as cache_dir:
+        _lower(_SHARED_CALLEE, cache_dir)
+        print("second run")
+        changed = _SHARED_CALLEE.replace("arith.constant 1", "arith.constant 2")
+        print(_lower(changed, cache_dir))
+
+
+@run
+# CHECK-LABEL: test_shared_private_symbol
+# CHECK:       func.func @a
+# CHECK:       func.func private @shared
+# CHECK-NEXT:    return %arg0 : i32
+# CHECK:       func.func @b
+# CHECK:       definitions of @shared: 1
+def test_shared_private_symbol():
+    with Context(), tempfile.TemporaryDirectory() as cache_dir:
+        module = str(_lower(_SHARED_CALLEE, cache_dir))
+        print(module)
+        print("definitions of @shared:", module.count("func.func private @shared"))
+
+
+@run
+# The result of @pair that each unit does not use is removed from it, so the
+# units define @pair differently and the whole module is lowered instead.
+# CHECK-LABEL: test_symbol_conflict_fallback
+# CHECK:       ran: Lowering (function a)
+# CHECK-NEXT:  ran: Lowering (function b)
+# CHECK-NEXT:  ran: Lowering
+# CHECK:       func.func private @pair(%arg0: i32) -> (i32, i32)
+def test_symbol_conflict_fallback():
+    source = """
+    func.func @a(%arg0: i32) -> i32 {
+      %0:2 = call @pair(%arg0) : (i32) -> (i32, i32)
+      return %0#0 : i32
+    }
+    func.func @b(%arg0: i32) -> i32 {
+      %0:2 = call @pair(%arg0) : (i32) -> (i32, i32)
+      return %0#1 : i32
+    }
+    func.func private @pair(%arg0: i32) -> (i32, i32) {
+      %c1 = arith.constant 1 : i32
+      %0 = arith.addi %arg0, %c1 : i32
+      %1 = arith.muli %arg0, %c1 : i32
+      return %0, %1 : i32, i32
+    }
+    """
+    with Context(), tempfile.TemporaryDirectory() as cache_dir:
+        print(_lower(source, cache_dir, "builtin.module(remove-dead-values)"))
+
+
+class _Basic(nn.Module):
+    def forward(self, x):
+        return torch.tanh(x) * 2.0
+
+
+def _import(cache_dir, x, output_type="torch"):
+    return str(
+        fx.export_and_import(
+            _Basic(), x, output_type=output_type, compile_cache_dir=cache_dir
+        )
+    )
+
+
+@run
+# CHECK-LABEL: test_export_and_import_cache
+# CHECK:       ran: Lowering TorchFX IR -> Torch Backend IR (function main)
+# CHECK-NEXT:  second import
+# CHECK-NEXT:  new entries: 0
+# CHECK-NEXT:  identical: True
+# CHECK-NEXT:  changed pipeline
+# CHECK:       ran: Lowering Torch Backend IR -> Linalg-on-Tensors Backend IR (function main)
+# CHECK:       invalidated: True
+# CHECK-NEXT:  changed inputs
+# CHECK-NEXT:  ran: Lowering TorchFX IR -> Torch Backend IR (function main)
+# CHECK-NEXT:  invalidated: True
+def test_export_and_import_cache():
+    with tempfile.TemporaryDirectory() as cache_dir:
+
+        def entries():
+            return len(os.listdir(cache_dir))
+
+        first = _import(cache_dir, torch.randn(3, 4))
+        before = entries()
+        print("second import")
+        second = _import(cache_dir, torch.randn(3, 4))
+        print("new entries:", entries() - before)
+        print("identical:", first == second)
+
+        # The whole module is lowered again, by another pipeline.
+        print("changed pipeline")
+        linalg = _import(cache_dir, torch.randn(3, 4), output_type="linalg-on-tensors")
+        print("invalidated:", entries() > before and linalg != first)
+
+        before = entries()
+        print("changed inputs")
+        reshaped = _import(cache_dir, torch.randn(5, 4))
+        print("invalidated:", entries() > before and reshaped != first)
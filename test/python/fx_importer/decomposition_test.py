@@ -0,0 +1,76 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import torch
+import torch.nn as nn
+
+from torch_mlir import fx
+from torch_mlir.extras.fx_decomp_util import (
+    get_backend_legal_ops,
+    get_decomposition_table,
+)
+
+
+def run(f):
+    print(f"{f.__name__}")
+    print("-" * len(f.__name__))
+    f()
+    print()
+
+
+_MASKED_FILL = torch.ops.aten.masked_fill.Scalar
+_LAYER_NORM = torch.ops.aten.native_layer_norm.default
+
+
+@run
+# CHECK-LABEL: test_decomposition_table_per_backend
+# CHECK:       raw: masked_fill True, layer_norm True
+# CHECK-NEXT:  linalg-on-tensors: masked_fill True, layer_norm False
+# CHECK-NEXT:  tosa: masked_fill False, layer_norm False
+# CHECK-NEXT:  stablehlo: masked_fill True, layer_norm False
+# CHECK-NEXT:  tosa with no legal ops: masked_fill True
+# CHECK-NEXT:  tosa legal ops: ['aten.native_layer_norm', 'aten.masked_fill.Tensor', 'aten.masked_fill.Scalar', 'aten.upsample_bilinear2d.vec']
+def test_decomposition_table_per_backend():
+    for output_type in ["raw", "linalg-on-tensors", "tosa", "stablehlo"]:
+        table = get_decomposition_table(output_type)
+        print(
+            f"{output_type}: masked_fill {_MASKED_FILL in table}, "
+            f"layer_norm {_LAYER_NORM in table}"
+        )
+    # The legal ops of the caller replace those of the backend.
+    table = get_decomposition_table("tosa", backend_legal_ops=[])
+    print("tosa with no legal ops: masked_fill", _MASKED_FILL in table)
+    print("tosa legal ops:", get_backend_legal_ops("tosa"))
+
+
+class _LayerNorm(nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.norm = nn.LayerNorm(4)
+
+    def forward(self, x):
+        return self.norm(x)
+
+
+@run
+# CHECK-LABEL: test_backend_legal_op_is_imported
+# CHECK:       raw
+# CHECK-NOT:   torch.aten.native_layer_norm
+# CHECK:       linalg-on-tensors
+# CHECK:       torch.aten.native_layer_norm
+def test_backend_legal_op_is_imported():
+    # Lowering to the backend would hide the op, so only the decompositions
+    # that export_and_import runs for each output type are run here.
+    for output_type in ["raw", "linalg-on-tensors"]:
+        print(output_type)
+        print(
+            fx.export_and_import(
+                _LayerNorm(),
+                torch.randn(3, 4),
+                decomposition_table=get_decomposition_table(output_type),
+            )
+        )
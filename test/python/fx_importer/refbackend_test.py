@@ -0,0 +1,141 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import gc
+
+import numpy as np
+import torch
+import torch.nn as nn
+
+from torch_mlir import fx
+from torch_mlir_e2e_test.linalg_on_tensors_backends import refbackend
+from torch_mlir_e2e_test.linalg_on_tensors_backends.refbackend import (
+    RefBackendLinalgOnTensorsBackend,
+)
+
+
+def run(f):
+    print(f"{f.__name__}")
+    print("-" * len(f.__name__))
+    f()
+    print()
+
+
+class _Basic(nn.Module):
+    def forward(self, x, y):
+        return torch.tanh(x) + y
+
+
+def _compile(backend, shape=(3, 4)):
+    module = fx.export_and_import(
+        _Basic(),
+        torch.randn(*shape),
+        torch.randn(*shape),
+        output_type="linalg-on-tensors",
+    )
+    return backend.compile(module)
+
+
+def _check_basic(invoker, shape=(3, 4)):
+    x = np.random.rand(*shape).astype(np.float32)
+    y = np.random.rand(*shape).astype(np.float32)
+    return np.allclose(invoker.main(x, y), np.tanh(x) + y, atol=1e-6)
+
+
+@run
+# CHECK-LABEL: test_invoker_cache
+# CHECK:       correct: True
+# CHECK-NEXT:  reused: True
+# CHECK-NEXT:  other opt level reused: False
+# CHECK-NEXT:  evicted: True
+def test_invoker_cache():
+    backend = RefBackendLinalgOnTensorsBackend(opt_level=0, invoker_cache_size=1)
+    compiled = _compile(backend)
+    invoker = backend.load(compiled)
+    print("correct:", _check_basic(invoker))
+    print("reused:", backend.load(compiled) is invoker)
+
+    other = RefBackendLinalgOnTensorsBackend(opt_level=3, invoker_cache_size=1)
+    other.invoker_cache = backend.invoker_cache
+    print("other opt level reused:", other.load(compiled) is invoker)
+    # The cache only holds one invoker, which is now that of opt level 3.
+    print("evicted:", backend.load(compiled) is not invoker)
+
+
+@run
+# CHECK-LABEL: test_vectorize
+# CHECK:       vector ops: True
+# CHECK-NEXT:  correct: True
+def test_vectorize():
+    backend = RefBackendLinalgOnTensorsBackend(vectorize=True)
+    # The innermost dim is a multiple of the vector size.
+    compiled = _compile(backend, shape=(4, 32))
+    print("vector ops:", "vector<8xf32>" in str(compiled))
+    print("correct:", _check_basic(backend.load(compiled), shape=(4, 32)))
+
+
+@run
+# CHECK-LABEL: test_async_runtime
+# CHECK:       async runtime calls: True
+# CHECK-NEXT:  serial async runtime calls: False
+def test_async_runtime():
+    # Compiling does not load the runtime library, so any path will do here.
+    backend = RefBackendLinalgOnTensorsBackend(
+        async_runtime_lib="libmlir_async_runtime.so"
+    )
+    compiled = str(_compile(backend))
+    print("async runtime calls:", "mlirAsyncRuntime" in compiled)
+    serial = str(_compile(RefBackendLinalgOnTensorsBackend()))
+    print("serial async runtime calls:", "mlirAsyncRuntime" in serial)
+
+
+class _TwoResults(nn.Module):
+    def forward(self, x):
+        y = torch.tanh(x)
+        return y, y
+
+
+@run
+# CHECK-LABEL: test_owned_results
+# CHECK:       owned: True
+# CHECK-NEXT:  unchanged by the next call: True
+# CHECK-NEXT:  each allocation freed once: True
+def test_owned_results():
+    frees = []
+    free = refbackend._MemRefAllocation.__del__
+
+    def counting_free(allocation):
+        frees.append(allocation.ptr)
+        free(allocation)
+
+    refbackend._MemRefAllocation.__del__ = counting_free
+    try:
+        backend = RefBackendLinalgOnTensorsBackend()
+        module = fx.export_and_import(
+            _TwoResults(), torch.randn(4), output_type="linalg-on-tensors"
+        )
+        invoker = backend.load(backend.compile(module))
+        x = np.random.rand(4).astype(np.float32)
+        first = invoker.main(x)
+        print(
+            "owned:",
+            all(isinstance(r.base, refbackend._MemRefView) for r in first),
+        )
+        expected = np.tanh(x)
+        invoker.main(np.zeros(4, dtype=np.float32))
+        print(
+            "unchanged by the next call:",
+            all(np.allclose(r, expected, atol=1e-6) for r in first),
+        )
+        # Results that share a buffer share its allocation.
+        allocated = {r.base.allocation.ptr for r in first}
+        frees.clear()
+        del first
+        gc.collect()
+        print("each allocation freed once:", sorted(frees) == sorted(allocated))
+    finally:
+        refbackend._MemRefAllocation.__del__ = free
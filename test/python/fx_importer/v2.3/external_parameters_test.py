@@ -0,0 +1,78 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+# Also available under a BSD-style license. See LICENSE.
+
+# RUN: %PYTHON %s | FileCheck %s
+
+import json
+import os
+import tempfile
+
+import torch
+import torch.nn as nn
+
+from torch_mlir import fx
+
+
+def run(f):
+    print(f"{f.__name__}")
+    print("-" * len(f.__name__))
+    f()
+    print()
+
+
+class Basic(nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.linear = nn.Linear(3, 2)
+        self.register_buffer("scale", torch.randn(2))
+
+    def forward(self, x):
+        return self.linear(x) * self.scale
+
+
+@run
+# CHECK-LABEL: test_external_parameters
+# CHECK-DAG: ml_program.global private @linear.weight(#ml_program.extern : !torch.vtensor<[2,3],f32>) : !torch.vtensor<[2,3],f32>
+# CHECK-DAG: ml_program.global private @linear.bias(#ml_program.extern : !torch.vtensor<[2],f32>) : !torch.vtensor<[2],f32>
+# CHECK-DAG: ml_program.global private @scale(#ml_program.extern : !torch.vtensor<[2],f32>) : !torch.vtensor<[2],f32>
+# CHECK:     func.func @main
+# CHECK-DAG: ml_program.global_load_const @linear.weight : !torch.vtensor<[2,3],f32>
+# CHECK-DAG: ml_program.global_load_const @linear.bias : !torch.vtensor<[2],f32>
+# CHECK-DAG: ml_program.global_load_const @scale : !torch.vtensor<[2],f32>
+# CHECK-NOT: torch.vtensor.literal
+# CHECK-NOT: dense_resource
+def test_external_parameters():
+    m = fx.export_and_import(Basic(), torch.randn(4, 3), external_parameters=True)
+    print(m)
+    m.operation.verify()
+
+
+@run
+# CHECK-LABEL: test_external_parameters_safetensors
+# CHECK-DAG: ml_program.global private @linear.weight{{.*}}torch.external_data = {file = "{{.*}}weights.safetensors", length = 24 : i64, offset = [[HEADER:[0-9]+]] : i64}
+# CHECK-DAG: ml_program.global private @linear.bias{{.*}}torch.external_data = {file = "{{.*}}weights.safetensors", length = 8 : i64, offset = {{[0-9]+}} : i64}
+# The buffer is not in the file.
+# CHECK-DAG: ml_program.global private @scale(#ml_program.extern : !torch.vtensor<[2],f32>) : !torch.vtensor<[2],f32>{{$}}
+def test_external_parameters_safetensors():
+    header = {
+        "__metadata__": {"format": "pt"},
+        "linear.weight": {"dtype": "F32", "shape": [2, 3], "data_offsets": [0, 24]},
+        "linear.bias": {"dtype": "F32", "shape": [2], "data_offsets": [24, 32]},
+    }
+    header_bytes = json.dumps(header).encode()
+    with tempfile.TemporaryDirectory() as temp_dir:
+        path = os.path.join(temp_dir, "weights.safetensors")
+        with open(path, "wb") as f:
+            f.write(len(header_bytes).to_bytes(8, "little"))
+            f.write(header_bytes)
+            f.write(bytes(32))
+        m = fx.export_and_import(
+            Basic(),
+            torch.randn(4, 3),
+            external_parameters=True,
+            external_parameters_file=path,
+        )
+    print(m)
+    m.operation.verify()
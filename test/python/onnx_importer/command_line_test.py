@@ -205,6 +205,33 @@ class CommandLineTest(unittest.TestCase):
                 with self.subTest("Explicit temp dir, implicit data dir"):
                     self.run_model_explicit_temp_implicit_data(model, model_name)
 
+    def test_external_data_left_in_files(self):
+        run_path = self.get_run_path("external_data_left_in_files")
+        model_file = run_path / "linear.onnx"
+        onnx.save(
+            linear_model(),
+            model_file,
+            save_as_external_data=True,
+            all_tensors_to_one_file=True,
+            location="linear.bin",
+            size_threshold=0,
+        )
+        with self.subTest("Memory-mapped by the importer"):
+            args = __main__.parse_arguments([str(model_file)])
+            model, data_dir = __main__.load_onnx_model(args)
+            self.assertEqual(data_dir, str(run_path))
+            for t in model.graph.initializer:
+                self.assertEqual(t.data_location, TensorProto.EXTERNAL)
+        with self.subTest("Loaded to rewrite the model"):
+            args = __main__.parse_arguments([str(model_file), "--clear-domain"])
+            model, _ = __main__.load_onnx_model(args)
+            for t in model.graph.initializer:
+                self.assertEqual(t.data_location, TensorProto.DEFAULT)
+        mlir_file = run_path / "linear.torch.mlir"
+        args = __main__.parse_arguments([str(model_file), "-o", str(mlir_file)])
+        __main__.main(args)
+        self.assertIn("dense_resource<A>", mlir_file.read_text())
+
 
 if __name__ == "__main__":
     logging.basicConfig(level=logging.DEBUG)
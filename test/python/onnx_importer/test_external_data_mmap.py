@@ -0,0 +1,64 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+# RUN: %PYTHON %s | FileCheck %s
+
+"""Initializers in external data files are imported from the memory-mapped
+files, without loading the external data into the model."""
+
+import os
+import tempfile
+
+import numpy as np
+import onnx
+from onnx import TensorProto, helper, numpy_helper
+
+from _torch_mlir_config import configure_context, ir, onnx_importer
+
+
+def _external_data_model() -> onnx.ModelProto:
+    inp = helper.make_tensor_value_info("x", TensorProto.FLOAT, [4])
+    out = helper.make_tensor_value_info("y", TensorProto.FLOAT, [4])
+    weight = numpy_helper.from_array(
+        np.array([1.0, 2.0, 3.0, 4.0], dtype=np.float32), name="weight"
+    )
+    bias = numpy_helper.from_array(
+        np.array([0.5, 0.5, 0.5, 0.5], dtype=np.float32), name="bias"
+    )
+    mul = helper.make_node("Mul", ["x", "weight"], ["xw"])
+    add = helper.make_node("Add", ["xw", "bias"], ["y"])
+    graph = helper.make_graph(
+        [mul, add], "external_data", [inp], [out], initializer=[weight, bias]
+    )
+    return helper.make_model(graph, opset_imports=[helper.make_opsetid("", 21)])
+
+
+with tempfile.TemporaryDirectory() as temp_dir:
+    model_path = os.path.join(temp_dir, "model.onnx")
+    onnx.save_model(
+        _external_data_model(),
+        model_path,
+        save_as_external_data=True,
+        all_tensors_to_one_file=True,
+        location="weights.bin",
+        size_threshold=0,
+    )
+    model = onnx.load(model_path, load_external_data=False)
+    assert all(
+        t.data_location == TensorProto.EXTERNAL for t in model.graph.initializer
+    )
+
+    ctx = ir.Context()
+    configure_context(ctx)
+    mi = onnx_importer.ModelInfo(model, external_data_dir=temp_dir)
+    m = mi.create_module(context=ctx).operation
+    onnx_importer.NodeImporter.define_function(mi.main_graph, m).import_all()
+    print(m)
+
+# CHECK-LABEL: func.func @external_data
+# CHECK-DAG: torch.operator "onnx.Constant"() {torch.onnx.value = dense_resource<weight> : tensor<4xf32>}
+# CHECK-DAG: torch.operator "onnx.Constant"() {torch.onnx.value = dense_resource<bias> : tensor<4xf32>}
+# CHECK: dialect_resources
+# CHECK-DAG: weight: "0x080000000000803F000000400000404000008040"
+# CHECK-DAG: bias: "0x080000000000003F0000003F0000003F0000003F"
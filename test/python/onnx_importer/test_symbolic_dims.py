@@ -0,0 +1,56 @@
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+# RUN: %PYTHON %s | FileCheck %s
+
+"""Named dims are imported as shared symbolic ints that the shapes of the
+tensors are bound to, when `bind_symbolic_dims` is set."""
+
+from onnx import TensorProto, helper
+
+from _torch_mlir_config import configure_context, ir, onnx_importer
+
+
+def _symbolic_dims_model():
+    x = helper.make_tensor_value_info("x", TensorProto.FLOAT, ["batch", 4])
+    y = helper.make_tensor_value_info("y", TensorProto.FLOAT, ["batch", "seq"])
+    out = helper.make_tensor_value_info("out", TensorProto.FLOAT, ["batch", 4])
+    # `t` has an anonymous dynamic dim, so its shape cannot be bound.
+    t = helper.make_tensor_value_info("t", TensorProto.FLOAT, [None, 4])
+    relu = helper.make_node("Relu", ["x"], ["t"])
+    add = helper.make_node("Add", ["t", "x"], ["out"])
+    graph = helper.make_graph(
+        [relu, add], "symbolic_dims", [x, y], [out], value_info=[t]
+    )
+    return helper.make_model(graph, opset_imports=[helper.make_opsetid("", 21)])
+
+
+def _import(config):
+    ctx = ir.Context()
+    configure_context(ctx)
+    mi = onnx_importer.ModelInfo(_symbolic_dims_model(), config=config)
+    m = mi.create_module(context=ctx).operation
+    onnx_importer.NodeImporter.define_function(mi.main_graph, m).import_all()
+    print(m)
+
+
+# CHECK-LABEL: func.func @symbolic_dims
+# CHECK-SAME: (%[[X:.*]]: !torch.vtensor<[?,4],f32>, %[[Y:.*]]: !torch.vtensor<[?,?],f32>)
+# CHECK: %[[BATCH:.*]] = torch.symbolic_int "batch" {min_val = 0, max_val = 9223372036854775807} : !torch.int
+# CHECK: %[[SEQ:.*]] = torch.symbolic_int "seq" {min_val = 0, max_val = 9223372036854775807} : !torch.int
+# CHECK: torch.bind_symbolic_shape %[[X]], [%[[BATCH]]], affine_map<()[s0] -> (s0, 4)> : !torch.vtensor<[?,4],f32>
+# CHECK: torch.bind_symbolic_shape %[[Y]], [%[[BATCH]], %[[SEQ]]], affine_map<()[s0, s1] -> (s0, s1)> : !torch.vtensor<[?,?],f32>
+# CHECK: %[[T:.*]] = torch.operator "onnx.Relu"(%[[X]])
+# CHECK-NOT: torch.bind_symbolic_shape %[[T]]
+# CHECK: %[[OUT:.*]] = torch.operator "onnx.Add"(%[[T]], %[[X]])
+# CHECK-NEXT: torch.bind_symbolic_shape %[[OUT]], [%[[BATCH]]], affine_map<()[s0] -> (s0, 4)> : !torch.vtensor<[?,4],f32>
+# CHECK: return %[[OUT]]
+_import(onnx_importer.Config(bind_symbolic_dims=True))
+
+# Without the option, named dims are imported as anonymous dynamic dims.
+# CHECK-LABEL: func.func @symbolic_dims
+# CHECK-NOT: torch.symbolic_int
+# CHECK-NOT: torch.bind_symbolic_shape
+# CHECK: return
+_import(onnx_importer.Config())
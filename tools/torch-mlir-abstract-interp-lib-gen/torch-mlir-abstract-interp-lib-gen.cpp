@@ -0,0 +1,75 @@
+//===- torch-mlir-abstract-interp-lib-gen.cpp -----------------------------===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// Also available under a BSD-style license. See LICENSE.
+//
+//===----------------------------------------------------------------------===//
+//
+// Build-time tool that serializes the abstract interpretation library to MLIR
+// bytecode and emits it as a comma-separated list of bytes, suitable for
+// `#include`-ing into an array initializer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/FileUtilities.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
+#include "torch-mlir/Dialect/Torch/Transforms/Passes.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/ToolOutputFile.h"
+
+using namespace mlir;
+
+static llvm::cl::opt<std::string>
+    outputFilename("o", llvm::cl::desc("Output filename"),
+                   llvm::cl::value_desc("filename"), llvm::cl::init("-"));
+
+int main(int argc, char **argv) {
+  llvm::InitLLVM y(argc, argv);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, "Torch-MLIR abstract interpretation library bytecode "
+                  "generator\n");
+
+  DialectRegistry registry;
+  registry.insert<func::FuncDialect, torch::Torch::TorchDialect>();
+  MLIRContext context(registry);
+
+  OwningOpRef<ModuleOp> library = parseSourceString<ModuleOp>(
+      torch::Torch::getAbstractInterpLibrary(), &context);
+  if (!library) {
+    llvm::errs() << "failed to parse the abstract interpretation library\n";
+    return 1;
+  }
+
+  std::string bytecode;
+  llvm::raw_string_ostream bytecodeStream(bytecode);
+  if (failed(writeBytecodeToFile(*library, bytecodeStream))) {
+    llvm::errs() << "failed to serialize the abstract interpretation library\n";
+    return 1;
+  }
+  bytecodeStream.flush();
+
+  std::string errorMessage;
+  std::unique_ptr<llvm::ToolOutputFile> output =
+      openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return 1;
+  }
+  for (size_t i = 0, e = bytecode.size(); i < e; ++i) {
+    output->os() << static_cast<unsigned>(static_cast<uint8_t>(bytecode[i]))
+                 << ",";
+    if (i % 16 == 15)
+      output->os() << "\n";
+  }
+  output->os() << "\n";
+  output->keep();
+  return 0;
+}
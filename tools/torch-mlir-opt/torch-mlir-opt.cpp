@@ -7,12 +7,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Dialect/Linalg/TransformOps/DialectExtension.h"
 #include "mlir/Dialect/MemRef/Transforms/Passes.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Transform/IR/TransformDialect.h"
+#include "mlir/Dialect/Transform/Transforms/Passes.h"
+#include "mlir/Support/FileUtilities.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 #include "mlir/Transforms/Passes.h"
 #include "torch-mlir/InitAll.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ToolOutputFile.h"
 
 #ifdef TORCH_MLIR_ENABLE_STABLEHLO
 #include "stablehlo/dialect/Register.h"
@@ -20,7 +28,25 @@
 
 using namespace mlir;
 
+// Maps `filename` into memory if it is a bytecode file, or returns null.
+// Bytecode needs no null terminator, unlike the text format, so the file is
+// mapped whatever its size rather than read into the heap. The reader then
+// keeps the `dense_resource` blobs as views of the mapping, and the passes
+// that change a weight create a new blob for it, so the pages of the file are
+// only read as the weights are used.
+static std::unique_ptr<llvm::MemoryBuffer> mapBytecodeFile(StringRef filename) {
+  if (filename == "-")
+    return nullptr;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> file =
+      llvm::MemoryBuffer::getFile(filename, /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false);
+  if (!file || !isBytecode((*file)->getMemBufferRef()))
+    return nullptr;
+  return std::move(*file);
+}
+
 int main(int argc, char **argv) {
+  llvm::InitLLVM y(argc, argv);
   mlir::torch::registerAllPasses();
 
   // Core Transforms
@@ -38,14 +64,44 @@ int main(int argc, char **argv) {
   memref::registerExpandOpsPass();
   memref::registerResolveShapedTypeResultDimsPass();
 
+  // The transform interpreter drives the tiling of the TMTensor ops in tests.
+  transform::registerInterpreterPass();
+
   DialectRegistry registry;
   mlir::torch::registerAllDialects(registry);
   mlir::torch::registerAllExtensions(registry);
   mlir::torch::registerOptionalInputDialects(registry);
+  registry.insert<transform::TransformDialect>();
+  linalg::registerTransformDialectExtension(registry);
 
 #ifdef TORCH_MLIR_ENABLE_STABLEHLO
   mlir::stablehlo::registerAllDialects(registry);
 #endif
-  return mlir::asMainReturnCode(mlir::MlirOptMain(
-      argc, argv, "MLIR modular optimizer driver\n", registry));
+  auto [inputFilename, outputFilename] = registerAndParseCLIOptions(
+      argc, argv, "MLIR modular optimizer driver\n", registry);
+  MlirOptMainConfig config = MlirOptMainConfig::createFromCLOptions();
+  // The upstream driver that takes argc and argv initializes LLVM again, so
+  // the input is opened here for both formats.
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> input;
+  if (!config.shouldShowDialects() && !config.shouldListPasses()) {
+    input = mapBytecodeFile(inputFilename);
+    if (!input)
+      input = openInputFile(inputFilename, &errorMessage);
+    if (!input) {
+      llvm::errs() << errorMessage << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  std::unique_ptr<llvm::ToolOutputFile> output =
+      openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return EXIT_FAILURE;
+  }
+  if (failed(mlir::MlirOptMain(output->os(), std::move(input), registry,
+                               config)))
+    return EXIT_FAILURE;
+  output->keep();
+  return EXIT_SUCCESS;
 }